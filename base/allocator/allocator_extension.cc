@@ -24,6 +24,13 @@ void ReleaseFreeMemory() {
     release_free_memory_function();
 }
 
+bool GetNumericProperty(const char* name, size_t* value) {
+  if (thunks::GetNumericPropertyFunction* get_numeric_property_function =
+          base::allocator::thunks::GetGetNumericPropertyFunction())
+    return get_numeric_property_function(name, value);
+  return false;
+}
+
 void SetGetStatsFunction(thunks::GetStatsFunction* get_stats_function) {
   DCHECK_EQ(base::allocator::thunks::GetGetStatsFunction(),
             reinterpret_cast<thunks::GetStatsFunction*>(NULL));
@@ -38,5 +45,21 @@ void SetReleaseFreeMemoryFunction(
       release_free_memory_function);
 }
 
+void SetGetNumericPropertyFunction(
+    thunks::GetNumericPropertyFunction* get_numeric_property_function) {
+  DCHECK_EQ(base::allocator::thunks::GetGetNumericPropertyFunction(),
+            reinterpret_cast<thunks::GetNumericPropertyFunction*>(NULL));
+  base::allocator::thunks::SetGetNumericPropertyFunction(
+      get_numeric_property_function);
+}
+
+void SetAllocationHooks(thunks::AllocationHookFunction* allocation_hook,
+                        thunks::FreeHookFunction* free_hook) {
+  // Hooks may only replace no hooks, or be removed.
+  DCHECK_EQ(!allocation_hook, !free_hook);
+  DCHECK(!allocation_hook || !base::allocator::thunks::GetAllocationHook());
+  base::allocator::thunks::SetAllocationHooks(allocation_hook, free_hook);
+}
+
 }  // namespace allocator
 }  // namespace base
@@ -25,6 +25,11 @@ BASE_EXPORT void GetStats(char* buffer, int buffer_length);
 // system.
 BASE_EXPORT void ReleaseFreeMemory();
 
+// Sets |value| to the numeric property |name| of the allocator, with the names
+// of tcmalloc's MallocExtension, such as "generic.current_allocated_bytes" or
+// "generic.heap_size".  Returns false if the allocator doesn't know |name|, or
+// doesn't report properties.
+BASE_EXPORT bool GetNumericProperty(const char* name, size_t* value);
 
 // These settings allow specifying a callback used to implement the allocator
 // extension functions.  These are optional, but if set they must only be set
@@ -39,6 +44,17 @@ BASE_EXPORT void SetGetStatsFunction(
 
 BASE_EXPORT void SetReleaseFreeMemoryFunction(
     thunks::ReleaseFreeMemoryFunction* release_free_memory_function);
+
+BASE_EXPORT void SetGetNumericPropertyFunction(
+    thunks::GetNumericPropertyFunction* get_numeric_property_function);
+
+// Installs hooks that the allocator runs on every allocation and free, or
+// removes them if both are NULL.  Only allocators that go through the
+// allocator shim call them.  Unlike the functions above, these may be set
+// while other threads allocate.
+BASE_EXPORT void SetAllocationHooks(
+    thunks::AllocationHookFunction* allocation_hook,
+    thunks::FreeHookFunction* free_hook);
 }  // namespace allocator
 }  // namespace base
 
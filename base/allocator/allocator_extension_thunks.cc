@@ -19,6 +19,11 @@ namespace thunks {
 
 static GetStatsFunction* g_get_stats_function = NULL;
 static ReleaseFreeMemoryFunction* g_release_free_memory_function = NULL;
+static GetNumericPropertyFunction* g_get_numeric_property_function = NULL;
+// These are read on every allocation, without a memory barrier; a thread may
+// keep calling the previous hooks for a little while after they change.
+static AllocationHookFunction* g_allocation_hook = NULL;
+static FreeHookFunction* g_free_hook = NULL;
 
 void SetGetStatsFunction(GetStatsFunction* get_stats_function) {
   g_get_stats_function = get_stats_function;
@@ -37,6 +42,29 @@ ReleaseFreeMemoryFunction* GetReleaseFreeMemoryFunction() {
   return g_release_free_memory_function;
 }
 
+void SetGetNumericPropertyFunction(
+    GetNumericPropertyFunction* get_numeric_property_function) {
+  g_get_numeric_property_function = get_numeric_property_function;
+}
+
+GetNumericPropertyFunction* GetGetNumericPropertyFunction() {
+  return g_get_numeric_property_function;
+}
+
+void SetAllocationHooks(AllocationHookFunction* allocation_hook,
+                        FreeHookFunction* free_hook) {
+  g_allocation_hook = allocation_hook;
+  g_free_hook = free_hook;
+}
+
+AllocationHookFunction* GetAllocationHook() {
+  return g_allocation_hook;
+}
+
+FreeHookFunction* GetFreeHook() {
+  return g_free_hook;
+}
+
 }  // namespace thunks
 }  // namespace allocator
 }  // namespace base
@@ -6,6 +6,8 @@
 #define BASE_ALLOCATOR_ALLOCATOR_THUNKS_EXTENSION_H
 #pragma once
 
+#include <stddef.h>
+
 namespace base {
 namespace allocator {
 namespace thunks {
@@ -23,6 +25,22 @@ void SetReleaseFreeMemoryFunction(
     ReleaseFreeMemoryFunction* release_free_memory_function);
 ReleaseFreeMemoryFunction* GetReleaseFreeMemoryFunction();
 
+typedef bool GetNumericPropertyFunction(const char*, size_t*);
+void SetGetNumericPropertyFunction(
+    GetNumericPropertyFunction* get_numeric_property_function);
+GetNumericPropertyFunction* GetGetNumericPropertyFunction();
+
+// The allocator calls these, when they are set, after every successful
+// allocation of |size| bytes at |ptr| and before every free of |ptr|.  They
+// run inside malloc and free, so they must not allocate memory of their own
+// without guarding against recursion.
+typedef void AllocationHookFunction(void* ptr, size_t size);
+typedef void FreeHookFunction(void* ptr);
+void SetAllocationHooks(AllocationHookFunction* allocation_hook,
+                        FreeHookFunction* free_hook);
+AllocationHookFunction* GetAllocationHook();
+FreeHookFunction* GetFreeHook();
+
 }  // namespace thunks
 }  // namespace allocator
 }  // namespace base
@@ -67,6 +67,22 @@ size_t je_msize(void* p);
 bool je_malloc_init_hard();
 }
 
+// Run the hooks of base::allocator::SetAllocationHooks(), if any.  They see
+// every allocator, so that switching allocators does not hide allocations.
+static inline void RunAllocationHook(void* ptr, size_t size) {
+  base::allocator::thunks::AllocationHookFunction* hook =
+      base::allocator::thunks::GetAllocationHook();
+  if (hook)
+    hook(ptr, size);
+}
+
+static inline void RunFreeHook(void* ptr) {
+  base::allocator::thunks::FreeHookFunction* hook =
+      base::allocator::thunks::GetFreeHook();
+  if (hook && ptr)
+    hook(ptr);
+}
+
 extern "C" {
 
 // Call the new handler, if one has been set.
@@ -130,8 +146,10 @@ void* malloc(size_t size) __THROW {
     // TCMalloc case.
     ptr = do_malloc(size);
 #endif
-    if (ptr)
+    if (ptr) {
+      RunAllocationHook(ptr, size);
       return ptr;
+    }
 
     if (!new_mode || !call_new_handler(true))
       break;
@@ -140,6 +158,7 @@ void* malloc(size_t size) __THROW {
 }
 
 void free(void* p) __THROW {
+  RunFreeHook(p);
 #ifdef ENABLE_DYNAMIC_ALLOCATOR_SWITCHING
   switch (allocator) {
     case JEMALLOC:
@@ -186,8 +205,15 @@ void* realloc(void* ptr, size_t size) __THROW {
     // Subtle warning:  NULL return does not alwas indicate out-of-memory.  If
     // the requested new size is zero, realloc should free the ptr and return
     // NULL.
-    if (new_ptr || !size)
+    if (new_ptr || !size) {
+      // The old block is gone either way.  Another thread may have been handed
+      // its address already, in which case the hooks lose track of that
+      // allocation; they only sample, so that is acceptable.
+      RunFreeHook(ptr);
+      if (new_ptr)
+        RunAllocationHook(new_ptr, size);
       return new_ptr;
+    }
     if (!new_mode || !call_new_handler(true))
       break;
   }
@@ -238,6 +264,10 @@ static void release_free_memory_thunk() {
   MallocExtension::instance()->ReleaseFreeMemory();
 }
 
+static bool get_numeric_property_thunk(const char* name, size_t* value) {
+  return MallocExtension::instance()->GetNumericProperty(name, value);
+}
+
 // The CRT heap initialization stub.
 extern "C" int _heap_init() {
 #ifdef ENABLE_DYNAMIC_ALLOCATOR_SWITCHING
@@ -286,6 +316,8 @@ extern "C" int _heap_init() {
   base::allocator::thunks::SetGetStatsFunction(get_stats_thunk);
   base::allocator::thunks::SetReleaseFreeMemoryFunction(
       release_free_memory_thunk);
+  base::allocator::thunks::SetGetNumericPropertyFunction(
+      get_numeric_property_thunk);
 
   return 1;
 }
@@ -163,6 +163,11 @@
               '-ldl',
             ],
           },
+        }, {  # OS != "linux"
+          'sources!': [
+            'message_pump_epoll.cc',
+            'message_pump_epoll.h',
+          ],
         }],
         ['OS == "mac"', {
           'link_settings': {
@@ -201,6 +206,8 @@
         'auto_reset.h',
         'base64.cc',
         'base64.h',
+        'base64_x86.cc',
+        'base64_x86.h',
         'event_recorder.h',
         'event_recorder_stubs.cc',
         'event_recorder_win.cc',
@@ -212,6 +219,8 @@
         'md5.h',
         'message_pump_android.cc',
         'message_pump_android.h',
+        'message_pump_epoll.cc',
+        'message_pump_epoll.h',
         'message_pump_glib.cc',
         'message_pump_glib.h',
         'message_pump_gtk.cc',
@@ -225,6 +234,8 @@
         'message_pump_mac.mm',
         'metrics/field_trial.cc',
         'metrics/field_trial.h',
+        'shared_memory_ring_buffer.cc',
+        'shared_memory_ring_buffer.h',
         'string16.cc',
         'string16.h',
         'sync_socket.h',
@@ -370,17 +381,25 @@
         'cancelable_callback_unittest.cc',
         'command_line_unittest.cc',
         'cpu_unittest.cc',
+        'debug/initialization_profiler_unittest.cc',
         'debug/leak_tracker_unittest.cc',
+        'debug/sampling_cpu_profiler_unittest.cc',
+        'debug/sampling_heap_profiler_unittest.cc',
+        'debug/stack_table_unittest.cc',
         'debug/stack_trace_unittest.cc',
+        'debug/trace_event_binary_unittest.cc',
         'debug/trace_event_unittest.cc',
         'debug/trace_event_win_unittest.cc',
         'dir_reader_posix_unittest.cc',
         'environment_unittest.cc',
+        'fast_dtoa_unittest.cc',
         'file_descriptor_shuffle_unittest.cc',
         'file_path_unittest.cc',
         'file_util_proxy_unittest.cc',
         'file_util_unittest.cc',
         'file_version_info_unittest.cc',
+        'flat_hash_map_unittest.cc',
+        'frozen_value_unittest.cc',
         'gmock_unittest.cc',
         'guid_unittest.cc',
         'hi_res_timer_manager_unittest.cc',
@@ -394,14 +413,18 @@
         'i18n/rtl_unittest.cc',
         'i18n/string_search_unittest.cc',
         'i18n/time_formatting_unittest.cc',
+        'json/json_file_value_writer_unittest.cc',
         'json/json_parser_unittest.cc',
         'json/json_reader_unittest.cc',
+        'json/json_stream_reader_unittest.cc',
         'json/json_value_converter_unittest.cc',
         'json/json_value_serializer_unittest.cc',
         'json/json_writer_unittest.cc',
         'json/string_escape_unittest.cc',
+        'json/string_scan_unittest.cc',
         'lazy_instance_unittest.cc',
         'linked_list_unittest.cc',
+        'lock_free_task_queue_unittest.cc',
         'logging_unittest.cc',
         'mac/closure_blocks_leopard_compat_unittest.cc',
         'mac/foundation_util_unittest.mm',
@@ -410,7 +433,10 @@
         'mac/scoped_sending_event_unittest.mm',
         'md5_unittest.cc',
         'memory/aligned_memory_unittest.cc',
+        'memory/arena_unittest.cc',
         'memory/linked_ptr_unittest.cc',
+        'memory/memory_pressure_listener_unittest.cc',
+        'memory/memory_pressure_monitor_linux_unittest.cc',
         'memory/mru_cache_unittest.cc',
         'memory/ref_counted_memory_unittest.cc',
         'memory/ref_counted_unittest.cc',
@@ -418,19 +444,23 @@
         'memory/scoped_ptr_unittest.cc',
         'memory/scoped_ptr_unittest.nc',
         'memory/scoped_vector_unittest.cc',
+        'memory/sharded_mru_cache_unittest.cc',
         'memory/singleton_unittest.cc',
         'memory/weak_ptr_unittest.cc',
         'memory/weak_ptr_unittest.nc',
         'message_loop_proxy_impl_unittest.cc',
         'message_loop_proxy_unittest.cc',
         'message_loop_unittest.cc',
+        'message_pump_epoll_unittest.cc',
         'message_pump_glib_unittest.cc',
         'message_pump_libevent_unittest.cc',
         'metrics/field_trial_unittest.cc',
         'metrics/histogram_unittest.cc',
+        'metrics/shared_histogram_table_unittest.cc',
         'metrics/stats_table_unittest.cc',
         'observer_list_unittest.cc',
         'path_service_unittest.cc',
+        'pending_task_unittest.cc',
         'pickle_unittest.cc',
         'platform_file_unittest.cc',
         'pr_time_unittest.cc',
@@ -443,8 +473,10 @@
         'scoped_native_library_unittest.cc',
         'scoped_temp_dir_unittest.cc',
         'sha1_unittest.cc',
+        'shared_memory_ring_buffer_unittest.cc',
         'shared_memory_unittest.cc',
         'stack_container_unittest.cc',
+        'strcat_unittest.cc',
         'string16_unittest.cc',
         'string_number_conversions_unittest.cc',
         'string_piece_unittest.cc',
@@ -456,19 +488,24 @@
         'synchronization/cancellation_flag_unittest.cc',
         'synchronization/condition_variable_unittest.cc',
         'synchronization/lock_unittest.cc',
+        'synchronization/rw_lock_unittest.cc',
         'synchronization/waitable_event_unittest.cc',
         'synchronization/waitable_event_watcher_unittest.cc',
         'sys_info_unittest.cc',
         'sys_string_conversions_mac_unittest.mm',
         'sys_string_conversions_unittest.cc',
         'system_monitor/system_monitor_unittest.cc',
+        'task_chain_unittest.cc',
         'task_runner_util_unittest.cc',
         'template_util_unittest.cc',
+        'test/benchmark_unittest.cc',
         'test/sequenced_worker_pool_owner.cc',
         'test/sequenced_worker_pool_owner.h',
+        'test/trace_budget_unittest.cc',
         'test/trace_event_analyzer_unittest.cc',
         'threading/non_thread_safe_unittest.cc',
         'threading/platform_thread_unittest.cc',
+        'threading/scoped_may_block_unittest.cc',
         'threading/sequenced_worker_pool_unittest.cc',
         'threading/simple_thread_unittest.cc',
         'threading/thread_checker_unittest.cc',
@@ -476,6 +513,7 @@
         'threading/thread_local_storage_unittest.cc',
         'threading/thread_local_unittest.cc',
         'threading/thread_unittest.cc',
+        'threading/hang_detector_unittest.cc',
         'threading/watchdog_unittest.cc',
         'threading/worker_pool_posix_unittest.cc',
         'threading/worker_pool_unittest.cc',
@@ -551,6 +589,11 @@
             }],
           ],
         }],
+        ['OS != "linux"', {
+          'sources!': [
+            'message_pump_epoll_unittest.cc',
+          ],
+        }],
         ['use_glib==1', {
           'sources!': [
             'file_version_info_unittest.cc',
@@ -657,6 +700,8 @@
       ],
       'sources': [
         'perftimer.cc',
+        'test/benchmark.cc',
+        'test/benchmark.h',
         'test/mock_chrome_application_mac.h',
         'test/mock_chrome_application_mac.mm',
         'test/mock_devices_changed_observer.cc',
@@ -691,6 +736,8 @@
         'test/test_timeouts.h',
         'test/thread_test_helper.cc',
         'test/thread_test_helper.h',
+        'test/trace_budget.cc',
+        'test/trace_budget.h',
         'test/trace_event_analyzer.cc',
         'test/trace_event_analyzer.h',
         'test/values_test_util.cc',
@@ -729,6 +776,28 @@
         },
       ],
     },
+    {
+      'target_name': 'base_perftests',
+      'type': 'executable',
+      'dependencies': [
+        'base',
+        'test_support_base',
+        'test_support_perf',
+        '../testing/gtest.gyp:gtest',
+      ],
+      'sources': [
+        'base64_perftest.cc',
+        'digest_perftest.cc',
+        'flat_hash_map_perftest.cc',
+        'json/json_perftest.cc',
+        'memory/arena_perftest.cc',
+        'message_loop_perftest.cc',
+        'process_util_perftest.cc',
+        'string_number_conversions_perftest.cc',
+        'synchronization/waitable_event_perftest.cc',
+        'utf_string_conversions_perftest.cc',
+      ],
+    },
     {
       'target_name': 'test_support_perf',
       'type': 'static_library',
@@ -4,35 +4,105 @@
 
 #include "base/base64.h"
 
+#include <string.h>
+
+#include "base/lazy_instance.h"
+#include "build/build_config.h"
 #include "third_party/modp_b64/modp_b64.h"
 
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+#include "base/base64_x86.h"
+#include "base/cpu.h"
+#endif
+
 namespace base {
 
-bool Base64Encode(const StringPiece& input, std::string* output) {
-  std::string temp;
-  temp.resize(modp_b64_encode_len(input.size()));  // makes room for null byte
+namespace {
 
-  // null terminates result since result is base64 text!
-  int input_size = static_cast<int>(input.size());
+const char kEncodeTable[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-  // modp_b64_encode_len() returns at least 1, so temp[0] is safe to use.
-  int output_size = modp_b64_encode(&(temp[0]), input.data(), input_size);
-  if (output_size < 0)
-    return false;
+// The vector codecs this processor can run, chosen once.  Each takes the
+// bulk of its input and returns how much it consumed; the rest is left to the
+// portable code.
+struct Base64Functions {
+  Base64Functions() : encode(NULL), decode(NULL) {
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+    CPU cpu;
+    if (cpu.has_avx2()) {
+      encode = &internal::Base64EncodeAVX2;
+      decode = &internal::Base64DecodeAVX2;
+    } else if (cpu.has_ssse3()) {
+      encode = &internal::Base64EncodeSSSE3;
+      decode = &internal::Base64DecodeSSSE3;
+    }
+#endif
+  }
 
-  temp.resize(output_size);  // strips off null byte
-  output->swap(temp);
+  size_t (*encode)(const uint8* input, size_t size, char* output);
+  size_t (*decode)(const char* input, size_t size, uint8* output);
+};
+
+LazyInstance<Base64Functions>::Leaky g_base64_functions =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Encodes the |size| bytes at |input|, padding the last group.
+void EncodePortable(const uint8* input, size_t size, char* output) {
+  for (; size >= 3; size -= 3, input += 3) {
+    uint32 group = (input[0] << 16) | (input[1] << 8) | input[2];
+    *output++ = kEncodeTable[group >> 18];
+    *output++ = kEncodeTable[(group >> 12) & 0x3f];
+    *output++ = kEncodeTable[(group >> 6) & 0x3f];
+    *output++ = kEncodeTable[group & 0x3f];
+  }
+  if (size == 0)
+    return;
+
+  uint32 group = input[0] << 16;
+  if (size == 2)
+    group |= input[1] << 8;
+  *output++ = kEncodeTable[group >> 18];
+  *output++ = kEncodeTable[(group >> 12) & 0x3f];
+  *output++ = size == 2 ? kEncodeTable[(group >> 6) & 0x3f] : '=';
+  *output = '=';
+}
+
+// Appends the encoding of |input|, which must not point into |output|.
+void AppendEncoded(const StringPiece& input, std::string* output) {
+  if (input.empty())
+    return;
+  size_t old_size = output->size();
+  output->resize(old_size + Base64EncodedSize(input.size()));
+  Base64EncodeToBuffer(input, &(*output)[old_size]);
+}
+
+}  // namespace
+
+bool Base64Encode(const StringPiece& input, std::string* output) {
+  // Resizing |output| would pull the rug out from under an |input| that
+  // points into it.
+  if (input.data() >= output->data() &&
+      input.data() < output->data() + output->size()) {
+    std::string temp;
+    AppendEncoded(input, &temp);
+    output->swap(temp);
+    return true;
+  }
+
+  output->clear();
+  AppendEncoded(input, output);
   return true;
 }
 
 bool Base64Decode(const StringPiece& input, std::string* output) {
   std::string temp;
-  temp.resize(modp_b64_decode_len(input.size()));
+  temp.resize(Base64DecodedSizeBound(input.size()));
 
-  // does not null terminate result since result is binary data!
-  int input_size = static_cast<int>(input.size());
-  int output_size = modp_b64_decode(&(temp[0]), input.data(), input_size);
-  if (output_size < 0)
+  // An input too short to hold a whole group is never written through, so
+  // the empty buffer it decodes into needs no storage.
+  size_t output_size;
+  if (!Base64DecodeToBuffer(input, temp.empty() ? NULL : &temp[0],
+                            &output_size))
     return false;
 
   temp.resize(output_size);
@@ -40,4 +110,66 @@ bool Base64Decode(const StringPiece& input, std::string* output) {
   return true;
 }
 
+size_t Base64EncodeToBuffer(const StringPiece& input, char* output) {
+  const uint8* data = reinterpret_cast<const uint8*>(input.data());
+  size_t done = 0;
+  if (g_base64_functions.Get().encode)
+    done = g_base64_functions.Get().encode(data, input.size(), output);
+  EncodePortable(data + done, input.size() - done, output + done / 3 * 4);
+  return Base64EncodedSize(input.size());
+}
+
+bool Base64DecodeToBuffer(const StringPiece& input,
+                          char* output,
+                          size_t* output_size) {
+  size_t done = 0;
+  if (g_base64_functions.Get().decode) {
+    done = g_base64_functions.Get().decode(input.data(), input.size(),
+                                           reinterpret_cast<uint8*>(output));
+  }
+
+  // modp_b64 checks the padding at the end, and reports any invalid character
+  // the vector code stopped at.  It stores whole words, but never past the
+  // end of the decoded data.
+  size_t written = done / 4 * 3;
+  int tail_size = modp_b64_decode(output + written, input.data() + done,
+                                  static_cast<int>(input.size() - done));
+  if (tail_size < 0)
+    return false;
+
+  *output_size = written + tail_size;
+  return true;
+}
+
+Base64Encoder::Base64Encoder() : pending_size_(0) {
+}
+
+void Base64Encoder::Update(const StringPiece& input, std::string* output) {
+  StringPiece rest(input);
+  if (pending_size_ > 0) {
+    if (pending_size_ + rest.size() < 3) {
+      memcpy(pending_ + pending_size_, rest.data(), rest.size());
+      pending_size_ += rest.size();
+      return;
+    }
+
+    char group[3];
+    size_t needed = 3 - pending_size_;
+    memcpy(group, pending_, pending_size_);
+    memcpy(group + pending_size_, rest.data(), needed);
+    rest.remove_prefix(needed);
+    AppendEncoded(StringPiece(group, 3), output);
+  }
+
+  size_t whole = rest.size() - rest.size() % 3;
+  AppendEncoded(rest.substr(0, whole), output);
+  pending_size_ = rest.size() - whole;
+  memcpy(pending_, rest.data() + whole, pending_size_);
+}
+
+void Base64Encoder::Finish(std::string* output) {
+  AppendEncoded(StringPiece(pending_, pending_size_), output);
+  pending_size_ = 0;
+}
+
 }  // namespace base
@@ -9,6 +9,7 @@
 #include <string>
 
 #include "base/base_export.h"
+#include "base/basictypes.h"
 #include "base/string_piece.h"
 
 namespace base {
@@ -21,6 +22,64 @@ BASE_EXPORT bool Base64Encode(const StringPiece& input, std::string* output);
 // otherwise.  The output string is only modified if successful.
 BASE_EXPORT bool Base64Decode(const StringPiece& input, std::string* output);
 
+// Returns the length of the base64 encoding of |input_size| bytes, padding
+// included.
+inline size_t Base64EncodedSize(size_t input_size) {
+  return (input_size + 2) / 3 * 4;
+}
+
+// Returns how many bytes decoding |input_size| characters of base64 can
+// produce.  The decoded data may be up to two bytes shorter.
+inline size_t Base64DecodedSizeBound(size_t input_size) {
+  return input_size / 4 * 3;
+}
+
+// Encodes |input| into the Base64EncodedSize(input.size()) bytes at
+// |output|, which is not null terminated.  Returns the number of bytes
+// written.
+BASE_EXPORT size_t Base64EncodeToBuffer(const StringPiece& input, char* output);
+
+// Decodes |input| into |output|, which must have room for
+// Base64DecodedSizeBound(input.size()) bytes, and sets |*output_size| to the
+// number of bytes decoded.  Returns false, leaving |output| holding garbage,
+// if |input| is not valid base64.
+BASE_EXPORT bool Base64DecodeToBuffer(const StringPiece& input,
+                                      char* output,
+                                      size_t* output_size);
+
+// Encodes a stream of data in pieces, so that a large input need not be held
+// in memory at once.  The output is the same as Base64Encode() of all the
+// pieces put together.
+//
+//   Base64Encoder encoder;
+//   std::string encoded;
+//   while (ReadChunk(&chunk)) {
+//     encoder.Update(chunk, &encoded);
+//     WriteOut(encoded);
+//     encoded.clear();
+//   }
+//   encoder.Finish(&encoded);
+//   WriteOut(encoded);
+class BASE_EXPORT Base64Encoder {
+ public:
+  Base64Encoder();
+
+  // Appends the encoding of as much of |input| as makes whole groups of three
+  // bytes, together with any left over from earlier calls, to |output|.
+  // Keeps the rest, at most two bytes, for the next call.
+  void Update(const StringPiece& input, std::string* output);
+
+  // Appends the encoding of the bytes left over, with padding, to |output|.
+  // The encoder can then be used for a new stream.
+  void Finish(std::string* output);
+
+ private:
+  char pending_[2];
+  size_t pending_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(Base64Encoder);
+};
+
 }  // namespace base
 
 #endif  // BASE_BASE64_H__
@@ -0,0 +1,67 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/base64.h"
+#include "base/perftimer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/modp_b64/modp_b64.h"
+
+namespace {
+
+const size_t kBytes = 32 * 1024 * 1024;
+
+double MegabytesPerSecond(base::TimeDelta elapsed) {
+  return static_cast<double>(kBytes) / (1024 * 1024) / elapsed.InSecondsF();
+}
+
+std::string MakeData() {
+  std::string data(kBytes, '\0');
+  for (size_t i = 0; i < kBytes; ++i)
+    data[i] = static_cast<char>(i * 37 + (i >> 3));
+  return data;
+}
+
+}  // namespace
+
+TEST(Base64PerfTest, Encode) {
+  std::string data = MakeData();
+  std::vector<char> encoded(modp_b64_encode_len(kBytes));
+
+  {
+    PerfTimer timer;
+    modp_b64_encode(&encoded[0], data.data(), static_cast<int>(kBytes));
+    LogPerfResult("Base64_Encode_modp", MegabytesPerSecond(timer.Elapsed()),
+                  "MB/s");
+  }
+  {
+    PerfTimer timer;
+    base::Base64EncodeToBuffer(data, &encoded[0]);
+    LogPerfResult("Base64_Encode", MegabytesPerSecond(timer.Elapsed()),
+                  "MB/s");
+  }
+}
+
+TEST(Base64PerfTest, Decode) {
+  std::string encoded;
+  base::Base64Encode(MakeData(), &encoded);
+  std::vector<char> decoded(modp_b64_decode_len(encoded.size()));
+
+  {
+    PerfTimer timer;
+    modp_b64_decode(&decoded[0], encoded.data(),
+                    static_cast<int>(encoded.size()));
+    LogPerfResult("Base64_Decode_modp", MegabytesPerSecond(timer.Elapsed()),
+                  "MB/s");
+  }
+  {
+    PerfTimer timer;
+    size_t decoded_size;
+    base::Base64DecodeToBuffer(encoded, &decoded[0], &decoded_size);
+    LogPerfResult("Base64_Decode", MegabytesPerSecond(timer.Elapsed()),
+                  "MB/s");
+  }
+}
@@ -3,13 +3,43 @@
 // found in the LICENSE file.
 
 #include "base/base64.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/modp_b64/modp_b64.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include "base/base64_x86.h"
+#include "base/cpu.h"
+#endif
 
 namespace {
 
 class Base64Test : public testing::Test {
 };
 
+// |size| bytes of data that use every character of the alphabet.
+std::string MakeData(size_t size) {
+  std::string data;
+  for (size_t i = 0; i < size; ++i)
+    data.push_back(static_cast<char>(i * 37 + (i >> 3)));
+  return data;
+}
+
+// The encoding modp_b64 makes, which the faster code must match.
+std::string ReferenceEncode(const std::string& data) {
+  std::string encoded(modp_b64_encode_len(data.size()), '\0');
+  int size = modp_b64_encode(&encoded[0], data.data(),
+                             static_cast<int>(data.size()));
+  encoded.resize(size);
+  return encoded;
+}
+
 }  // namespace
 
 TEST(Base64Test, Basic) {
@@ -27,3 +57,146 @@ TEST(Base64Test, Basic) {
   EXPECT_TRUE(ok);
   EXPECT_EQ(kText, decoded);
 }
+
+TEST(Base64Test, Lengths) {
+  // Long enough for every vector loop to run several times, with every
+  // length of tail.
+  for (size_t size = 0; size < 300; ++size) {
+    std::string data = MakeData(size);
+    std::string expected = ReferenceEncode(data);
+
+    std::string encoded;
+    EXPECT_TRUE(base::Base64Encode(data, &encoded));
+    EXPECT_EQ(expected, encoded) << size;
+    EXPECT_EQ(base::Base64EncodedSize(size), encoded.size());
+
+    std::string decoded;
+    EXPECT_TRUE(base::Base64Decode(encoded, &decoded)) << size;
+    EXPECT_EQ(data, decoded) << size;
+  }
+}
+
+TEST(Base64Test, Invalid) {
+  std::string encoded;
+  base::Base64Encode(MakeData(150), &encoded);
+
+  // A bad character anywhere, including in the middle of a long run the
+  // vector code handles, fails the whole decode and leaves |decoded| alone.
+  const char kBadCharacters[] = { ' ', '=', '-', '\0', '\x80', '\xff' };
+  for (size_t i = 0; i < encoded.size(); ++i) {
+    for (size_t j = 0; j < arraysize(kBadCharacters); ++j) {
+      // Padding is fine in the last place.
+      if (kBadCharacters[j] == '=' && i == encoded.size() - 1)
+        continue;
+      std::string bad = encoded;
+      bad[i] = kBadCharacters[j];
+      std::string decoded = "untouched";
+      EXPECT_FALSE(base::Base64Decode(bad, &decoded)) << i << " " << j;
+      EXPECT_EQ("untouched", decoded);
+    }
+  }
+
+  std::string decoded;
+  EXPECT_FALSE(base::Base64Decode("a", &decoded));
+  EXPECT_FALSE(base::Base64Decode("aGVsbG8", &decoded));
+  EXPECT_FALSE(base::Base64Decode(encoded.substr(1), &decoded));
+  EXPECT_TRUE(base::Base64Decode("", &decoded));
+  EXPECT_EQ("", decoded);
+}
+
+TEST(Base64Test, Aliased) {
+  std::string text = "hello world";
+  EXPECT_TRUE(base::Base64Encode(text, &text));
+  EXPECT_EQ("aGVsbG8gd29ybGQ=", text);
+}
+
+TEST(Base64Test, Buffers) {
+  std::string data = MakeData(100);
+  std::string expected = ReferenceEncode(data);
+
+  // Nothing is written past the sizes the header promises.
+  std::vector<char> encoded(base::Base64EncodedSize(data.size()) + 1, '#');
+  EXPECT_EQ(expected.size(), base::Base64EncodeToBuffer(data, &encoded[0]));
+  EXPECT_EQ(expected, std::string(&encoded[0], expected.size()));
+  EXPECT_EQ('#', encoded.back());
+
+  std::vector<char> decoded(base::Base64DecodedSizeBound(expected.size()) + 1,
+                            '#');
+  size_t decoded_size = 0;
+  EXPECT_TRUE(base::Base64DecodeToBuffer(expected, &decoded[0],
+                                         &decoded_size));
+  EXPECT_EQ(data, std::string(&decoded[0], decoded_size));
+  EXPECT_EQ('#', decoded.back());
+}
+
+TEST(Base64Test, Encoder) {
+  std::string data = MakeData(1000);
+  std::string expected = ReferenceEncode(data);
+
+  // Feed the data in pieces of every size from 1 to 40 bytes.
+  for (size_t piece = 1; piece <= 40; ++piece) {
+    base::Base64Encoder encoder;
+    std::string encoded;
+    for (size_t offset = 0; offset < data.size(); offset += piece)
+      encoder.Update(base::StringPiece(data).substr(offset, piece), &encoded);
+    encoder.Finish(&encoded);
+    EXPECT_EQ(expected, encoded) << piece;
+
+    // The encoder starts over after Finish().
+    encoded.clear();
+    encoder.Update("hello world", &encoded);
+    encoder.Finish(&encoded);
+    EXPECT_EQ("aGVsbG8gd29ybGQ=", encoded);
+  }
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+namespace {
+
+// Checks that |encode| and |decode| agree with modp_b64 on every length up
+// to 300 bytes, whichever the dispatcher picked.
+void CheckCodecs(size_t (*encode)(const uint8*, size_t, char*),
+                 size_t (*decode)(const char*, size_t, uint8*)) {
+  for (size_t size = 0; size < 300; ++size) {
+    std::string data = MakeData(size);
+    std::string expected = ReferenceEncode(data);
+
+    std::vector<char> encoded(expected.size() + 1);
+    size_t encoded_bytes = encode(
+        reinterpret_cast<const uint8*>(data.data()), size, &encoded[0]);
+    EXPECT_EQ(0u, encoded_bytes % 3);
+    EXPECT_LT(size - encoded_bytes, 16u);
+    EXPECT_EQ(expected.substr(0, encoded_bytes / 3 * 4),
+              std::string(&encoded[0], encoded_bytes / 3 * 4));
+
+    std::vector<uint8> decoded(size + 1);
+    size_t decoded_chars = decode(expected.data(), expected.size(),
+                                  &decoded[0]);
+    EXPECT_EQ(0u, decoded_chars % 4);
+    EXPECT_LT(expected.size() - decoded_chars, 20u);
+    EXPECT_GE(expected.size() - decoded_chars, std::min<size_t>(
+        4u, expected.size()));
+    EXPECT_EQ(data.substr(0, decoded_chars / 4 * 3),
+              std::string(reinterpret_cast<char*>(&decoded[0]),
+                          decoded_chars / 4 * 3));
+  }
+}
+
+}  // namespace
+
+TEST(Base64Test, SSSE3) {
+  if (!base::CPU().has_ssse3())
+    return;
+  CheckCodecs(&base::internal::Base64EncodeSSSE3,
+              &base::internal::Base64DecodeSSSE3);
+}
+
+TEST(Base64Test, AVX2) {
+  if (!base::CPU().has_avx2())
+    return;
+  CheckCodecs(&base::internal::Base64EncodeAVX2,
+              &base::internal::Base64DecodeAVX2);
+}
+
+#endif  // defined(ARCH_CPU_X86_FAMILY)
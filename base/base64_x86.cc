@@ -0,0 +1,248 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/base64_x86.h"
+
+#include <string.h>
+
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+#include <immintrin.h>
+
+// The functions here are compiled for instructions the rest of the build
+// may not assume, so GCC has to be told which each may use.
+#if defined(COMPILER_GCC)
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define SSSE3_TARGET
+#define AVX2_TARGET
+#endif
+
+// The codecs follow Wojciech Muła's vectorized base64
+// (http://0x80.pl/articles/index.html#base64-algorithm-new).  Each 32-bit
+// lane holds one group of three bytes or four characters; the AVX2 versions
+// are the SSSE3 ones run on two 128-bit halves at once.
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// Encoding -------------------------------------------------------------------
+
+// Spreads the twelve bytes at the bottom of |input| over four lanes, and
+// splits each lane's three bytes into four six-bit values, one per byte.
+SSSE3_TARGET inline __m128i SplitGroups(__m128i input) {
+  // Each lane gets bytes 1, 0, 2, 1 of its group, so that the multiplies
+  // below can shift the four values into place.
+  input = _mm_shuffle_epi8(input, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                                                7, 6, 8, 7, 10, 9, 11, 10));
+  __m128i first_and_third = _mm_mulhi_epu16(
+      _mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00)),
+      _mm_set1_epi32(0x04000040));
+  __m128i second_and_fourth = _mm_mullo_epi16(
+      _mm_and_si128(input, _mm_set1_epi32(0x003f03f0)),
+      _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(first_and_third, second_and_fourth);
+}
+
+// Maps six-bit values to their characters by adding an offset that depends
+// on which of the five ranges of the alphabet each falls in.
+SSSE3_TARGET inline __m128i ValuesToCharacters(__m128i values) {
+  // 0-25 map to index 13, 26-51 to 0, 52-61 to 1-10, 62 to 11, 63 to 12.
+  __m128i index = _mm_subs_epu8(values, _mm_set1_epi8(51));
+  __m128i below_26 = _mm_cmpgt_epi8(_mm_set1_epi8(26), values);
+  index = _mm_or_si128(index, _mm_and_si128(below_26, _mm_set1_epi8(13)));
+  const __m128i kOffsets = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  return _mm_add_epi8(values, _mm_shuffle_epi8(kOffsets, index));
+}
+
+AVX2_TARGET inline __m256i SplitGroups(__m256i input) {
+  input = _mm256_shuffle_epi8(input, _mm256_setr_epi8(
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+  __m256i first_and_third = _mm256_mulhi_epu16(
+      _mm256_and_si256(input, _mm256_set1_epi32(0x0fc0fc00)),
+      _mm256_set1_epi32(0x04000040));
+  __m256i second_and_fourth = _mm256_mullo_epi16(
+      _mm256_and_si256(input, _mm256_set1_epi32(0x003f03f0)),
+      _mm256_set1_epi32(0x01000010));
+  return _mm256_or_si256(first_and_third, second_and_fourth);
+}
+
+AVX2_TARGET inline __m256i ValuesToCharacters(__m256i values) {
+  __m256i index = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+  __m256i below_26 = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), values);
+  index = _mm256_or_si256(index,
+                          _mm256_and_si256(below_26, _mm256_set1_epi8(13)));
+  const __m256i kOffsets = _mm256_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  return _mm256_add_epi8(values, _mm256_shuffle_epi8(kOffsets, index));
+}
+
+// Decoding -------------------------------------------------------------------
+
+// Lookup tables, by the low and high nibble of a character, of bits whose
+// AND is non-zero exactly when the character is not in the alphabet.
+#define BASE64_VALID_LOW_NIBBLE \
+  0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, \
+  0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a
+#define BASE64_VALID_HIGH_NIBBLE \
+  0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, \
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+// What to add to a valid character to get its value, by its high nibble,
+// except that '/' uses entry 1.
+#define BASE64_OFFSETS \
+  0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+// Gathers the three bytes of each lane at the bottom of it, in order.
+#define BASE64_PACK_GROUPS \
+  2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+
+// Decodes the sixteen characters in |input| to the twelve bytes at the bottom
+// of |*output|.  Returns false if any character is not in the alphabet.
+SSSE3_TARGET inline bool DecodeGroups(__m128i input, __m128i* output) {
+  const __m128i kNibble = _mm_set1_epi8(0x0f);
+  __m128i high_nibbles = _mm_and_si128(_mm_srli_epi32(input, 4), kNibble);
+  __m128i low_nibbles = _mm_and_si128(input, kNibble);
+  __m128i invalid = _mm_and_si128(
+      _mm_shuffle_epi8(_mm_setr_epi8(BASE64_VALID_LOW_NIBBLE), low_nibbles),
+      _mm_shuffle_epi8(_mm_setr_epi8(BASE64_VALID_HIGH_NIBBLE),
+                       high_nibbles));
+  if (_mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) !=
+      0xffff) {
+    return false;
+  }
+
+  __m128i is_slash = _mm_cmpeq_epi8(input, _mm_set1_epi8('/'));
+  __m128i values = _mm_add_epi8(input, _mm_shuffle_epi8(
+      _mm_setr_epi8(BASE64_OFFSETS), _mm_add_epi8(is_slash, high_nibbles)));
+
+  // Pack each lane's four six-bit values into 24 bits, then put the bytes in
+  // order.
+  __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+  *output = _mm_shuffle_epi8(groups, _mm_setr_epi8(BASE64_PACK_GROUPS));
+  return true;
+}
+
+AVX2_TARGET inline bool DecodeGroups(__m256i input, __m256i* output) {
+  const __m256i kNibble = _mm256_set1_epi8(0x0f);
+  __m256i high_nibbles =
+      _mm256_and_si256(_mm256_srli_epi32(input, 4), kNibble);
+  __m256i low_nibbles = _mm256_and_si256(input, kNibble);
+  __m256i invalid = _mm256_and_si256(
+      _mm256_shuffle_epi8(_mm256_setr_epi8(BASE64_VALID_LOW_NIBBLE,
+                                           BASE64_VALID_LOW_NIBBLE),
+                          low_nibbles),
+      _mm256_shuffle_epi8(_mm256_setr_epi8(BASE64_VALID_HIGH_NIBBLE,
+                                           BASE64_VALID_HIGH_NIBBLE),
+                          high_nibbles));
+  if (_mm256_movemask_epi8(
+          _mm256_cmpeq_epi8(invalid, _mm256_setzero_si256())) != -1) {
+    return false;
+  }
+
+  __m256i is_slash = _mm256_cmpeq_epi8(input, _mm256_set1_epi8('/'));
+  __m256i values = _mm256_add_epi8(input, _mm256_shuffle_epi8(
+      _mm256_setr_epi8(BASE64_OFFSETS, BASE64_OFFSETS),
+      _mm256_add_epi8(is_slash, high_nibbles)));
+
+  __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+  __m256i groups = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+  *output = _mm256_shuffle_epi8(groups, _mm256_setr_epi8(BASE64_PACK_GROUPS,
+                                                         BASE64_PACK_GROUPS));
+  return true;
+}
+
+#undef BASE64_VALID_LOW_NIBBLE
+#undef BASE64_VALID_HIGH_NIBBLE
+#undef BASE64_OFFSETS
+#undef BASE64_PACK_GROUPS
+
+// Stores the twelve bytes at the bottom of |bytes| to |output|.
+SSSE3_TARGET inline void StoreTwelve(__m128i bytes, uint8* output) {
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(output), bytes);
+  uint32 last = _mm_cvtsi128_si32(_mm_srli_si128(bytes, 8));
+  memcpy(output + 8, &last, sizeof(last));
+}
+
+}  // namespace
+
+SSSE3_TARGET size_t Base64EncodeSSSE3(const uint8* input,
+                                      size_t size,
+                                      char* output) {
+  size_t done = 0;
+  // Each load reads sixteen bytes to use twelve.
+  for (; size - done >= 16; done += 12, output += 16) {
+    __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + done));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output),
+                     ValuesToCharacters(SplitGroups(bytes)));
+  }
+  return done;
+}
+
+AVX2_TARGET size_t Base64EncodeAVX2(const uint8* input,
+                                    size_t size,
+                                    char* output) {
+  size_t done = 0;
+  for (; size - done >= 28; done += 24, output += 32) {
+    const __m128i* from = reinterpret_cast<const __m128i*>(input + done);
+    __m256i bytes = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(from)),
+        _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(input + done + 12)),
+        1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output),
+                        ValuesToCharacters(SplitGroups(bytes)));
+  }
+  return done + Base64EncodeSSSE3(input + done, size - done, output);
+}
+
+SSSE3_TARGET size_t Base64DecodeSSSE3(const char* input,
+                                      size_t size,
+                                      uint8* output) {
+  size_t done = 0;
+  for (; size - done >= 16 + 4; done += 16, output += 12) {
+    __m128i bytes;
+    if (!DecodeGroups(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + done)),
+            &bytes)) {
+      break;
+    }
+    StoreTwelve(bytes, output);
+  }
+  return done;
+}
+
+AVX2_TARGET size_t Base64DecodeAVX2(const char* input,
+                                    size_t size,
+                                    uint8* output) {
+  size_t done = 0;
+  for (; size - done >= 32 + 4; done += 32, output += 24) {
+    __m256i bytes;
+    if (!DecodeGroups(_mm256_loadu_si256(
+                          reinterpret_cast<const __m256i*>(input + done)),
+                      &bytes)) {
+      // Let the SSSE3 code find which half holds the bad character.
+      break;
+    }
+    StoreTwelve(_mm256_castsi256_si128(bytes), output);
+    StoreTwelve(_mm256_extracti128_si256(bytes, 1), output + 12);
+  }
+  return done + Base64DecodeSSSE3(input + done, size - done, output);
+}
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // defined(ARCH_CPU_X86_FAMILY)
@@ -0,0 +1,36 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Base64 using x86 vector instructions.  These are the codecs
+// Base64EncodeToBuffer() and Base64DecodeToBuffer() pick from at run time;
+// callers must check base::CPU before calling them.
+
+#ifndef BASE_BASE64_X86_H_
+#define BASE_BASE64_X86_H_
+#pragma once
+
+#include "base/basictypes.h"
+
+namespace base {
+namespace internal {
+
+// Encodes whole groups of twelve bytes from the |size| bytes at |input|,
+// leaving fewer than sixteen for the caller.  Returns the number of bytes
+// encoded; their encoding, a third longer, is at |output|.  Need SSSE3 and
+// AVX2 respectively.
+size_t Base64EncodeSSSE3(const uint8* input, size_t size, char* output);
+size_t Base64EncodeAVX2(const uint8* input, size_t size, char* output);
+
+// Decodes whole groups of sixteen characters from the |size| at |input|,
+// always leaving the last four, which may hold padding, for the caller.
+// Stops early at a group with a character outside the base64 alphabet.
+// Returns the number of characters decoded; the bytes they decode to, a
+// quarter fewer, are at |output|.  Need SSSE3 and AVX2 respectively.
+size_t Base64DecodeSSSE3(const char* input, size_t size, uint8* output);
+size_t Base64DecodeAVX2(const char* input, size_t size, uint8* output);
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_BASE64_X86_H_
@@ -10,6 +10,11 @@
 
 #include "base/basictypes.h"
 #include "base/logging.h"
+#include "build/build_config.h"
+
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#endif
 
 namespace base {
 namespace bits {
@@ -42,6 +47,18 @@ inline int Log2Ceiling(uint32 n) {
   }
 }
 
+// Returns the index of the lowest set bit of |n|, which must not be zero.
+inline int LowestSetBit(uint32 n) {
+  DCHECK_NE(n, 0u);
+#if defined(COMPILER_MSVC)
+  unsigned long index;
+  _BitScanForward(&index, n);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(n);
+#endif
+}
+
 }  // namespace bits
 }  // namespace base
 
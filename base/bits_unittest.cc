@@ -44,5 +44,15 @@ TEST(BitsTest, Log2Ceiling) {
   EXPECT_EQ(32, Log2Ceiling(0xffffffffU));
 }
 
+TEST(BitsTest, LowestSetBit) {
+  EXPECT_EQ(0, LowestSetBit(1));
+  EXPECT_EQ(0, LowestSetBit(3));
+  EXPECT_EQ(1, LowestSetBit(6));
+  for (int i = 0; i < 32; ++i) {
+    EXPECT_EQ(i, LowestSetBit(1U << i));
+    EXPECT_EQ(i, LowestSetBit(0xffffffffU << i));
+  }
+}
+
 }  // namespace bits
 }  // namespace base
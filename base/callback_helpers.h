@@ -10,11 +10,16 @@
 // ResetAndReturn(&cb) is like cb.Reset() but allows executing a callback (via a
 // copy) after the original callback is Reset().  This can be handy if Run()
 // reads/writes the variable holding the Callback.
+//
+// OnceClosure is a move-only Closure for callbacks with a single owner.
 
 #ifndef BASE_CALLBACK_HELPERS_H_
 #define BASE_CALLBACK_HELPERS_H_
 
+#include <algorithm>
+
 #include "base/callback.h"
+#include "base/logging.h"
 
 namespace base {
 
@@ -25,6 +30,93 @@ base::Callback<Sig> ResetAndReturn(base::Callback<Sig>* cb) {
   return ret;
 }
 
+// Holds a Closure that is run at most once.  Copying a Closure costs an
+// atomic increment and, later, an atomic decrement of the BindState's
+// reference count.  A OnceClosure is handed along with Pass() instead, which
+// touches no reference count, and its constructor taking a Closure* adopts
+// the closure the same way.
+//
+//   OnceClosure done(&closure);  // |closure| is null now.
+//   queue.push_back(done.Pass());
+//   ...
+//   queue.front().Run();  // The closure is released as it runs.
+class OnceClosure {
+  // MOVE_ONLY_TYPE_FOR_CPP_03() spelled out: the macro derives RValue from
+  // the class inside its own definition, which only works for templates.
+  struct RValue;
+  OnceClosure(OnceClosure&);
+  void operator=(OnceClosure&);
+
+ public:
+  OnceClosure() {}
+
+  // Adopts |closure|, leaving it null.
+  explicit OnceClosure(Closure* closure) {
+    Swap(closure);
+  }
+
+  // Shares |closure| with its other owners.
+  explicit OnceClosure(const Closure& closure) : closure_(closure) {}
+
+  // Constructor for moving, used by Pass().
+  inline OnceClosure(RValue& other);
+
+  inline OnceClosure& operator=(RValue& other);
+
+  inline operator RValue&();
+  inline OnceClosure Pass();
+
+  bool is_null() const { return closure_.is_null(); }
+
+  void Reset() { closure_.Reset(); }
+
+  // Runs the closure and lets go of it.  The OnceClosure is null when the
+  // closure starts running, so the closure may safely reassign it.
+  void Run() {
+    DCHECK(!is_null());
+    Closure closure;
+    Swap(&closure);
+    closure.Run();
+  }
+
+ private:
+  // Exchanges |closure_| and |*other| without any reference counting.
+  void Swap(Closure* other) {
+    internal::CallbackBase* mine = &closure_;
+    internal::CallbackBase* theirs = other;
+    mine->bind_state_.swap(theirs->bind_state_);
+    std::swap(mine->polymorphic_invoke_, theirs->polymorphic_invoke_);
+  }
+
+  Closure closure_;
+};
+
+struct OnceClosure::RValue : public OnceClosure {
+  RValue();
+  ~RValue();
+  RValue(const RValue&);
+  void operator=(const RValue&);
+};
+
+OnceClosure::OnceClosure(RValue& other) {
+  Swap(&other.closure_);
+}
+
+OnceClosure& OnceClosure::operator=(RValue& other) {
+  Closure old;
+  Swap(&old);
+  Swap(&other.closure_);
+  return *this;
+}
+
+OnceClosure::operator OnceClosure::RValue&() {
+  return *reinterpret_cast<RValue*>(this);
+}
+
+OnceClosure OnceClosure::Pass() {
+  return OnceClosure(*reinterpret_cast<RValue*>(this));
+}
+
 }  // namespace base
 
 #endif  // BASE_CALLBACK_HELPERS_H_
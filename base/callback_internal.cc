@@ -4,11 +4,123 @@
 
 #include "base/callback_internal.h"
 
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/third_party/dynamic_annotations/dynamic_annotations.h"
+#include "base/threading/thread_local_storage.h"
 
 namespace base {
 namespace internal {
 
+namespace {
+
+// BindStates of up to kMaxPooledSize bytes are rounded up to a multiple of
+// kSizeClassGranularity and recycled through a free list per size class.
+const size_t kSizeClassGranularity = 16;
+const size_t kMaxPooledSize = 128;
+const size_t kNumSizeClasses = kMaxPooledSize / kSizeClassGranularity;
+
+// Callbacks are usually created on one thread and destroyed on another, so a
+// thread that mostly runs tasks would hoard blocks without this limit.
+const int kMaxFreeBlocksPerClass = 64;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct BindStatePool {
+  FreeBlock* free_lists[kNumSizeClasses];
+  int free_counts[kNumSizeClasses];
+  // False under Valgrind, which cannot see use-after-free in recycled blocks.
+  bool enabled;
+};
+
+void DestroyBindStatePool(void* value) {
+  BindStatePool* pool = static_cast<BindStatePool*>(value);
+  for (size_t i = 0; i < kNumSizeClasses; ++i) {
+    while (pool->free_lists[i]) {
+      FreeBlock* block = pool->free_lists[i];
+      pool->free_lists[i] = block->next;
+      ::operator delete(block);
+    }
+  }
+  delete pool;
+}
+
+struct BindStatePoolSlot {
+  BindStatePoolSlot() : slot(&DestroyBindStatePool) {}
+
+  ThreadLocalStorage::Slot slot;
+};
+
+LazyInstance<BindStatePoolSlot>::Leaky g_bind_state_pool_slot =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Returns the calling thread's pool, creating it if need be.  A BindState
+// freed by a TLS destructor that runs after the pool's own recreates the
+// pool, which the TLS implementation then destroys in its next round.
+BindStatePool* GetBindStatePool() {
+  ThreadLocalStorage::Slot& slot = g_bind_state_pool_slot.Get().slot;
+  BindStatePool* pool = static_cast<BindStatePool*>(slot.Get());
+  if (!pool) {
+    pool = new BindStatePool;
+    for (size_t i = 0; i < kNumSizeClasses; ++i) {
+      pool->free_lists[i] = NULL;
+      pool->free_counts[i] = 0;
+    }
+#if defined(ADDRESS_SANITIZER)
+    pool->enabled = false;
+#else
+    pool->enabled = !RunningOnValgrind();
+#endif
+    slot.Set(pool);
+  }
+  return pool;
+}
+
+size_t SizeClass(size_t size) {
+  return (size - 1) / kSizeClassGranularity;
+}
+
+}  // namespace
+
+// static
+void* BindStateBase::operator new(size_t size) {
+  if (size == 0 || size > kMaxPooledSize)
+    return ::operator new(size);
+
+  BindStatePool* pool = GetBindStatePool();
+  size_t size_class = SizeClass(size);
+  FreeBlock* block = pool->free_lists[size_class];
+  if (!block)
+    return ::operator new((size_class + 1) * kSizeClassGranularity);
+  pool->free_lists[size_class] = block->next;
+  --pool->free_counts[size_class];
+  return block;
+}
+
+// static
+void BindStateBase::operator delete(void* block, size_t size) {
+  if (!block)
+    return;
+  if (size == 0 || size > kMaxPooledSize) {
+    ::operator delete(block);
+    return;
+  }
+
+  BindStatePool* pool = GetBindStatePool();
+  size_t size_class = SizeClass(size);
+  if (!pool->enabled ||
+      pool->free_counts[size_class] >= kMaxFreeBlocksPerClass) {
+    ::operator delete(block);
+    return;
+  }
+  FreeBlock* free_block = static_cast<FreeBlock*>(block);
+  free_block->next = pool->free_lists[size_class];
+  pool->free_lists[size_class] = free_block;
+  ++pool->free_counts[size_class];
+}
+
 bool CallbackBase::is_null() const {
   return bind_state_.get() == NULL;
 }
@@ -19,6 +19,9 @@ template <typename T>
 class ScopedVector;
 
 namespace base {
+
+class OnceClosure;
+
 namespace internal {
 
 // BindStateBase is used to provide an opaque handle that the Callback
@@ -27,7 +30,17 @@ namespace internal {
 // DoInvoke function to perform the function execution.  This allows
 // us to shield the Callback class from the types of the bound argument via
 // "type erasure."
-class BindStateBase : public RefCountedThreadSafe<BindStateBase> {
+//
+// BindStates are allocated from per-thread free lists, sorted into a few size
+// classes, since nearly every PostTask() creates one and throws it away soon
+// after.  Larger ones go straight to the heap.
+class BASE_EXPORT BindStateBase : public RefCountedThreadSafe<BindStateBase> {
+ public:
+  static void* operator new(size_t size);
+  // The destructor is virtual, so |size| is the size of the most derived
+  // type.
+  static void operator delete(void* block, size_t size);
+
  protected:
   friend class RefCountedThreadSafe<BindStateBase>;
   virtual ~BindStateBase() {}
@@ -64,6 +77,9 @@ class BASE_EXPORT CallbackBase {
   // bloat.
   ~CallbackBase();
 
+  // Moves Closures in and out without touching their reference counts.
+  friend class base::OnceClosure;
+
   scoped_refptr<BindStateBase> bind_state_;
   InvokeFuncStorage polymorphic_invoke_;
 };
@@ -8,6 +8,7 @@
 #include "base/callback_internal.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/third_party/dynamic_annotations/dynamic_annotations.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -177,5 +178,61 @@ TEST_F(CallbackTest, CallbackHasLastRefOnContainingObject) {
   ASSERT_TRUE(deleted);
 }
 
+// Freed BindStates are handed out again for the next BindState of the same
+// size class on the same thread.
+TEST_F(CallbackTest, BindStatesAreRecycled) {
+#if !defined(ADDRESS_SANITIZER)
+  if (RunningOnValgrind())
+    return;
+  FakeBindState1* state = new FakeBindState1();
+  void* address = state;
+  Callback<void(void)>(state).Reset();
+  FakeBindState1* again = new FakeBindState1();
+  Callback<void(void)> holder(again);
+  EXPECT_EQ(address, static_cast<void*>(again));
+#endif
+}
+
+void Increment(int* value) {
+  ++*value;
+}
+
+TEST_F(CallbackTest, OnceClosureRunsOnce) {
+  int value = 0;
+  Closure closure = Bind(&Increment, &value);
+  OnceClosure once(&closure);
+  EXPECT_TRUE(closure.is_null());
+  ASSERT_FALSE(once.is_null());
+
+  OnceClosure moved = once.Pass();
+  EXPECT_TRUE(once.is_null());
+  ASSERT_FALSE(moved.is_null());
+  moved.Run();
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(moved.is_null());
+}
+
+TEST_F(CallbackTest, OnceClosureSharesCopiedClosure) {
+  int value = 0;
+  Closure closure = Bind(&Increment, &value);
+  OnceClosure once(closure);
+  once.Run();
+  closure.Run();
+  EXPECT_EQ(2, value);
+}
+
+TEST_F(CallbackTest, OnceClosureReleasesOnReset) {
+  bool deleted = false;
+  CallbackOwner* owner = new CallbackOwner(&deleted);
+  OnceClosure once(Bind(&CallbackOwner::Reset, owner));
+  owner->Reset();
+  EXPECT_FALSE(deleted);
+  OnceClosure other;
+  other = once.Pass();
+  EXPECT_FALSE(deleted);
+  other.Reset();
+  EXPECT_TRUE(deleted);
+}
+
 }  // namespace
 }  // namespace base
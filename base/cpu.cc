@@ -6,6 +6,7 @@
 
 #include <string.h>
 
+#include "base/basictypes.h"
 #include "build/build_config.h"
 
 #if defined(ARCH_CPU_X86_FAMILY)
@@ -30,6 +31,10 @@ CPU::CPU()
     has_ssse3_(false),
     has_sse41_(false),
     has_sse42_(false),
+    has_avx_(false),
+    has_avx2_(false),
+    has_sha_(false),
+    has_non_stop_time_stamp_counter_(false),
     cpu_vendor_("unknown") {
   Initialize();
 }
@@ -78,6 +83,16 @@ void __cpuidex(int cpu_info[4], int info_type, int info_index) {
 }
 
 #endif
+
+// _xgetbv returns the value of an Intel Extended Control Register.
+uint64 _xgetbv(uint32 xcr) {
+  uint32 eax, edx;
+
+  __asm__ volatile (
+    "xgetbv" : "=a"(eax), "=d"(edx) : "c"(xcr));
+  return (static_cast<uint64>(edx) << 32) | eax;
+}
+
 #endif  // _MSC_VER
 #endif  // ARCH_CPU_X86_FAMILY
 
@@ -118,6 +133,26 @@ void CPU::Initialize() {
     has_ssse3_ = (cpu_info[2] & 0x00000200) != 0;
     has_sse41_ = (cpu_info[2] & 0x00080000) != 0;
     has_sse42_ = (cpu_info[2] & 0x00100000) != 0;
+    // AVX needs both the instructions (bit 28) and an OS that saves the
+    // XMM and YMM state on context switches (OSXSAVE, bit 27, and bits 1
+    // and 2 of XCR0).
+    has_avx_ = (cpu_info[2] & 0x10000000) != 0 &&
+               (cpu_info[2] & 0x08000000) != 0 &&
+               (_xgetbv(0) & 6) == 6;
+  }
+
+  if (num_ids >= 7) {
+    __cpuidex(cpu_info, 7, 0);
+    has_avx2_ = has_avx_ && (cpu_info[1] & 0x00000020) != 0;
+    has_sha_ = (cpu_info[1] & 0x20000000) != 0;
+  }
+
+  // The invariant TSC is reported in the extended leaf 0x80000007.
+  __cpuid(cpu_info, 0x80000000);
+  unsigned int max_extended_id = cpu_info[0];
+  if (max_extended_id >= 0x80000007) {
+    __cpuid(cpu_info, 0x80000007);
+    has_non_stop_time_stamp_counter_ = (cpu_info[3] & 0x00000100) != 0;
   }
 #endif
 }
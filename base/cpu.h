@@ -33,6 +33,16 @@ class BASE_EXPORT CPU {
   bool has_ssse3() const { return has_ssse3_; }
   bool has_sse41() const { return has_sse41_; }
   bool has_sse42() const { return has_sse42_; }
+  // AVX and AVX2 are only reported when the OS saves the YMM registers.
+  bool has_avx() const { return has_avx_; }
+  bool has_avx2() const { return has_avx2_; }
+  // The SHA extensions (SHA1RNDS4 and friends).
+  bool has_sha() const { return has_sha_; }
+  // Whether the time stamp counter ticks at a constant rate in all the power
+  // and frequency states of the processor (the "invariant TSC").
+  bool has_non_stop_time_stamp_counter() const {
+    return has_non_stop_time_stamp_counter_;
+  }
 
  private:
   // Query the processor for CPUID information.
@@ -51,6 +61,10 @@ class BASE_EXPORT CPU {
   bool has_ssse3_;
   bool has_sse41_;
   bool has_sse42_;
+  bool has_avx_;
+  bool has_avx2_;
+  bool has_sha_;
+  bool has_non_stop_time_stamp_counter_;
   std::string cpu_vendor_;
 };
 
@@ -87,6 +87,21 @@ TEST(CPU, RunExtendedInstructions) {
     // Execute an SSE 4.2 instruction.
     __asm__ __volatile__("crc32 %%eax, %%eax\n" : : : "eax");
   }
+
+  if (cpu.has_avx()) {
+    // Execute an AVX instruction.
+    __asm__ __volatile__("vzeroupper\n" : : : "xmm0");
+  }
+
+  if (cpu.has_avx2()) {
+    // Execute an AVX 2 instruction.
+    __asm__ __volatile__("vpunpcklbw %%ymm0, %%ymm0, %%ymm0\n" : : : "xmm0");
+  }
+
+  if (cpu.has_sha()) {
+    // Execute a SHA instruction.
+    __asm__ __volatile__("sha1msg1 %%xmm0, %%xmm0\n" : : : "xmm0");
+  }
 #endif
 #endif
 }
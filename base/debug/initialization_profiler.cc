@@ -0,0 +1,294 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/initialization_profiler.h"
+
+#include <algorithm>
+#include <map>
+
+#include "base/at_exit.h"
+#include "base/atomicops.h"
+#include "base/debug/initialization_profiler_internal.h"
+#include "base/format_macros.h"
+#include "base/logging.h"
+#include "base/stringprintf.h"
+#include "base/synchronization/lock.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+// A construction, and perhaps a destruction, as recorded.
+struct Entry {
+  const void* key;
+  const char* signature;
+  PlatformThreadId thread_id;
+  std::string thread_name;
+  TimeTicks begin;
+  TimeTicks end;
+  bool destroyed;
+  TimeDelta destruction_time;
+};
+
+// LazyInstance and Singleton report here, so the profiler can use neither.
+// The data is made by the first Start() and never freed, so a report that
+// races with ResetForTesting() still finds it.
+struct ProfilerData {
+  Lock lock;
+  TimeTicks start;
+  std::vector<Entry> entries;
+  // The latest entry of each key.
+  std::map<const void*, size_t> entry_indices;
+};
+
+subtle::Atomic32 g_running = 0;
+ProfilerData* g_data = NULL;
+
+// Picks the type out of an InitializationSignature<Type>() signature.
+std::string TypeNameFromSignature(const std::string& signature) {
+  // GCC and Clang: "... InitializationSignature() [with Type = Foo]".
+  static const char kTypePrefix[] = "Type = ";
+  size_t begin = signature.find(kTypePrefix);
+  size_t end = signature.rfind(']');
+  if (begin != std::string::npos && end != std::string::npos) {
+    begin += arraysize(kTypePrefix) - 1;
+    if (begin <= end)
+      return signature.substr(begin, end - begin);
+  }
+
+  // MSVC: "... InitializationSignature<class Foo>(void)".
+  static const char kTemplatePrefix[] = "InitializationSignature<";
+  begin = signature.find(kTemplatePrefix);
+  end = signature.rfind(">(");
+  if (begin != std::string::npos && end != std::string::npos) {
+    begin += arraysize(kTemplatePrefix) - 1;
+    if (begin <= end)
+      return signature.substr(begin, end - begin);
+  }
+  return signature;
+}
+
+// Orders constructions so that each thread's come together, and each comes
+// before those that happened during it.
+class NestingOrder {
+ public:
+  explicit NestingOrder(const std::vector<Entry>& entries)
+      : entries_(entries) {}
+
+  bool operator()(size_t a, size_t b) const {
+    const Entry& x = entries_[a];
+    const Entry& y = entries_[b];
+    if (x.thread_id != y.thread_id)
+      return x.thread_id < y.thread_id;
+    if (x.begin != y.begin)
+      return x.begin < y.begin;
+    return x.end > y.end;
+  }
+
+ private:
+  const std::vector<Entry>& entries_;
+};
+
+bool BySelfConstructionTime(const InitializationProfiler::Record& a,
+                            const InitializationProfiler::Record& b) {
+  return a.self_construction_time > b.self_construction_time;
+}
+
+bool ByDestructionTime(const InitializationProfiler::Record& a,
+                       const InitializationProfiler::Record& b) {
+  return a.destruction_time > b.destruction_time;
+}
+
+void LogReport(void* unused) {
+  if (InitializationProfiler::IsRunning())
+    LOG(INFO) << InitializationProfiler::GetReport();
+}
+
+}  // namespace
+
+InitializationProfiler::Record::Record()
+    : thread_id(kInvalidThreadId),
+      destroyed(false) {
+}
+
+InitializationProfiler::Record::~Record() {
+}
+
+// static
+void InitializationProfiler::Start() {
+  if (!g_data)
+    g_data = new ProfilerData;
+  {
+    AutoLock lock(g_data->lock);
+    g_data->start = TimeTicks::Now();
+  }
+
+  // Runs after everything constructed from now on has been destroyed.
+  AtExitManager::RegisterCallback(&LogReport, NULL);
+
+  // Make the thread name storage now rather than in the middle of the first
+  // construction.
+  PlatformThread::GetName();
+
+  subtle::Release_Store(&g_running, 1);
+}
+
+// static
+bool InitializationProfiler::IsRunning() {
+  return subtle::Acquire_Load(&g_running) != 0;
+}
+
+// static
+void InitializationProfiler::GetRecords(std::vector<Record>* records) {
+  if (!g_data)
+    return;
+
+  AutoLock lock(g_data->lock);
+  const std::vector<Entry>& entries = g_data->entries;
+  size_t first = records->size();
+  records->resize(first + entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const Entry& entry = entries[i];
+    Record& record = (*records)[first + i];
+    record.type_name = TypeNameFromSignature(entry.signature);
+    record.thread_id = entry.thread_id;
+    record.thread_name = entry.thread_name;
+    record.start_time = entry.begin - g_data->start;
+    record.construction_time = entry.end - entry.begin;
+    record.self_construction_time = record.construction_time;
+    record.destroyed = entry.destroyed;
+    record.destruction_time = entry.destruction_time;
+  }
+
+  // Walk each thread's constructions in nesting order, keeping a stack of
+  // those still running, and take each one's time from its parent's.
+  std::vector<size_t> order(entries.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), NestingOrder(entries));
+  std::vector<size_t> open;
+  for (size_t i = 0; i < order.size(); ++i) {
+    const Entry& entry = entries[order[i]];
+    while (!open.empty()) {
+      const Entry& outer = entries[open.back()];
+      if (outer.thread_id == entry.thread_id && outer.end >= entry.end)
+        break;
+      open.pop_back();
+    }
+    if (!open.empty()) {
+      (*records)[first + open.back()].self_construction_time -=
+          entry.end - entry.begin;
+    }
+    open.push_back(order[i]);
+  }
+}
+
+// static
+std::string InitializationProfiler::GetReport() {
+  std::vector<Record> records;
+  GetRecords(&records);
+
+  TimeDelta total_construction;
+  TimeDelta total_destruction;
+  std::vector<Record> destroyed;
+  for (size_t i = 0; i < records.size(); ++i) {
+    total_construction += records[i].self_construction_time;
+    if (records[i].destroyed) {
+      total_destruction += records[i].destruction_time;
+      destroyed.push_back(records[i]);
+    }
+  }
+  std::stable_sort(records.begin(), records.end(), BySelfConstructionTime);
+  std::stable_sort(destroyed.begin(), destroyed.end(), ByDestructionTime);
+
+  std::string report;
+  StringAppendF(&report,
+                "Constructed %" PRIuS " instances in %.3f ms\n"
+                "      self     total        at  thread  type\n",
+                records.size(), total_construction.InMillisecondsF());
+  for (size_t i = 0; i < records.size(); ++i) {
+    const Record& record = records[i];
+    StringAppendF(&report, "%10.3f%10.3f%10.3f  %s (%d)  %s\n",
+                  record.self_construction_time.InMillisecondsF(),
+                  record.construction_time.InMillisecondsF(),
+                  record.start_time.InMillisecondsF(),
+                  record.thread_name.c_str(),
+                  static_cast<int>(record.thread_id),
+                  record.type_name.c_str());
+  }
+  StringAppendF(&report,
+                "Destroyed %" PRIuS " instances in %.3f ms\n"
+                "      time  type\n",
+                destroyed.size(), total_destruction.InMillisecondsF());
+  for (size_t i = 0; i < destroyed.size(); ++i) {
+    StringAppendF(&report, "%10.3f  %s\n",
+                  destroyed[i].destruction_time.InMillisecondsF(),
+                  destroyed[i].type_name.c_str());
+  }
+  return report;
+}
+
+// static
+void InitializationProfiler::ResetForTesting() {
+  subtle::Release_Store(&g_running, 0);
+  if (!g_data)
+    return;
+  AutoLock lock(g_data->lock);
+  g_data->entries.clear();
+  g_data->entry_indices.clear();
+}
+
+namespace internal {
+
+int64 InitializationTimerStart() {
+  if (!InitializationProfiler::IsRunning())
+    return 0;
+  return TimeTicks::Now().ToInternalValue();
+}
+
+void RecordConstruction(int64 start,
+                        const void* key,
+                        const char* signature) {
+  if (!start)
+    return;
+
+  Entry entry;
+  entry.key = key;
+  entry.signature = signature;
+  entry.begin = TimeTicks::FromInternalValue(start);
+  entry.end = TimeTicks::Now();
+  entry.thread_id = PlatformThread::CurrentId();
+  // Looked up before taking the lock, as it may construct an instance.
+  const char* thread_name = PlatformThread::GetName();
+  if (thread_name)
+    entry.thread_name = thread_name;
+  entry.destroyed = false;
+
+  AutoLock lock(g_data->lock);
+  g_data->entry_indices[key] = g_data->entries.size();
+  g_data->entries.push_back(entry);
+}
+
+void RecordDestruction(int64 start, const void* key) {
+  if (!start)
+    return;
+
+  TimeDelta destruction_time = TimeTicks::Now() -
+      TimeTicks::FromInternalValue(start);
+  AutoLock lock(g_data->lock);
+  std::map<const void*, size_t>::iterator it =
+      g_data->entry_indices.find(key);
+  if (it == g_data->entry_indices.end())
+    return;
+  Entry& entry = g_data->entries[it->second];
+  entry.destroyed = true;
+  entry.destruction_time = destruction_time;
+  g_data->entry_indices.erase(it);
+}
+
+}  // namespace internal
+
+}  // namespace debug
+}  // namespace base
@@ -0,0 +1,93 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// InitializationProfiler tells which LazyInstances and Singletons are
+// expensive to create, and on which threads, so that their construction can
+// be moved off the startup path.
+//
+// Once started, it times the first construction of every LazyInstance and
+// Singleton, attributing it to the instance's type, and the destruction of
+// those the AtExitManager destroys.  When an instance is constructed while
+// another one is, for example because a constructor calls GetInstance() of
+// some other class, its time is subtracted from the outer one's self time.
+// The profiler costs one call per construction and destruction while it is
+// stopped, and nothing when an existing instance is used.
+//
+// EXAMPLE:
+//
+//   int main(int argc, char** argv) {
+//     base::AtExitManager exit_manager;
+//     base::debug::InitializationProfiler::Start();
+//     ...
+//   }
+//
+// The report is logged when the AtExitManager has destroyed everything
+// constructed after Start(); GetReport() and GetRecords() give it earlier.
+
+#ifndef BASE_DEBUG_INITIALIZATION_PROFILER_H_
+#define BASE_DEBUG_INITIALIZATION_PROFILER_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/threading/platform_thread.h"
+#include "base/time.h"
+
+namespace base {
+namespace debug {
+
+class BASE_EXPORT InitializationProfiler {
+ public:
+  // The first construction of one instance.
+  struct BASE_EXPORT Record {
+    Record();
+    ~Record();
+
+    // The type of the instance, as the compiler spells it.
+    std::string type_name;
+    // The thread that constructed it.
+    PlatformThreadId thread_id;
+    // Empty if the thread had no name.
+    std::string thread_name;
+    // When construction started, since Start().
+    TimeDelta start_time;
+    TimeDelta construction_time;
+    // |construction_time| less the time spent constructing other instances
+    // meanwhile on the same thread.
+    TimeDelta self_construction_time;
+    // Whether the AtExitManager has destroyed the instance, and how long that
+    // took.
+    bool destroyed;
+    TimeDelta destruction_time;
+  };
+
+  // Starts recording, and arranges for the report to be logged at exit.
+  // Needs an AtExitManager.  Call as early as possible: instances that
+  // already exist are not seen.
+  static void Start();
+
+  static bool IsRunning();
+
+  // Appends a record for every instance constructed since Start(), in the
+  // order they were constructed.
+  static void GetRecords(std::vector<Record>* records);
+
+  // Returns the records as text: constructions by decreasing self time, then
+  // destructions by decreasing time.
+  static std::string GetReport();
+
+  // Stops recording and forgets all the records.
+  static void ResetForTesting();
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(InitializationProfiler);
+};
+
+}  // namespace debug
+}  // namespace base
+
+#endif  // BASE_DEBUG_INITIALIZATION_PROFILER_H_
@@ -0,0 +1,53 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// The hooks through which LazyInstance and Singleton report to
+// InitializationProfiler.  They are kept apart from
+// base/debug/initialization_profiler.h so that those widely included headers
+// pull in nothing more than this.
+
+#ifndef BASE_DEBUG_INITIALIZATION_PROFILER_INTERNAL_H_
+#define BASE_DEBUG_INITIALIZATION_PROFILER_INTERNAL_H_
+#pragma once
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+
+namespace base {
+namespace debug {
+namespace internal {
+
+// Returns the time at which a construction or destruction starts, as a
+// TimeTicks internal value, or 0 if the profiler is not running.
+BASE_EXPORT int64 InitializationTimerStart();
+
+// Records that the instance identified by |key| was constructed since
+// |start|.  |signature| is InitializationSignature<Type>() for its type.
+// Does nothing if |start| is 0.  Call only once the instance can be used:
+// recording may itself construct other instances.
+BASE_EXPORT void RecordConstruction(int64 start,
+                                    const void* key,
+                                    const char* signature);
+
+// Records that the instance identified by |key| was destroyed since |start|.
+// Does nothing if |start| is 0 or the construction was not recorded.
+BASE_EXPORT void RecordDestruction(int64 start, const void* key);
+
+// Returns a string naming Type, which needs no RTTI: the signature of this
+// function, as the compiler prints it.  InitializationProfiler picks the type
+// out of it.
+template <typename Type>
+const char* InitializationSignature() {
+#if defined(_MSC_VER)
+  return __FUNCSIG__;
+#else
+  return __PRETTY_FUNCTION__;
+#endif
+}
+
+}  // namespace internal
+}  // namespace debug
+}  // namespace base
+
+#endif  // BASE_DEBUG_INITIALIZATION_PROFILER_INTERNAL_H_
@@ -0,0 +1,142 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/initialization_profiler.h"
+
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/lazy_instance.h"
+#include "base/memory/singleton.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+const int kSleepMs = 20;
+
+class SlowToConstruct {
+ public:
+  SlowToConstruct() {
+    PlatformThread::Sleep(TimeDelta::FromMilliseconds(kSleepMs));
+  }
+};
+
+class SlowToDestroy {
+ public:
+  ~SlowToDestroy() {
+    PlatformThread::Sleep(TimeDelta::FromMilliseconds(kSleepMs));
+  }
+};
+
+// A Singleton whose constructor makes a SlowToConstruct.
+class ConstructsOthers {
+ public:
+  static ConstructsOthers* GetInstance() {
+    return Singleton<ConstructsOthers>::get();
+  }
+
+ private:
+  friend struct DefaultSingletonTraits<ConstructsOthers>;
+
+  ConstructsOthers();
+};
+
+LazyInstance<SlowToConstruct> g_slow_to_construct = LAZY_INSTANCE_INITIALIZER;
+LazyInstance<SlowToDestroy> g_slow_to_destroy = LAZY_INSTANCE_INITIALIZER;
+
+ConstructsOthers::ConstructsOthers() {
+  g_slow_to_construct.Get();
+}
+
+const InitializationProfiler::Record* FindRecord(
+    const std::vector<InitializationProfiler::Record>& records,
+    const char* type) {
+  for (size_t i = 0; i < records.size(); ++i) {
+    if (records[i].type_name.find(type) != std::string::npos)
+      return &records[i];
+  }
+  return NULL;
+}
+
+}  // namespace
+
+class InitializationProfilerTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    InitializationProfiler::ResetForTesting();
+  }
+
+  virtual void TearDown() OVERRIDE {
+    InitializationProfiler::ResetForTesting();
+  }
+};
+
+TEST_F(InitializationProfilerTest, NestedConstruction) {
+  ShadowingAtExitManager exit_manager;
+  InitializationProfiler::Start();
+  EXPECT_TRUE(InitializationProfiler::IsRunning());
+  ConstructsOthers::GetInstance();
+
+  std::vector<InitializationProfiler::Record> records;
+  InitializationProfiler::GetRecords(&records);
+  const InitializationProfiler::Record* outer =
+      FindRecord(records, "ConstructsOthers");
+  const InitializationProfiler::Record* inner =
+      FindRecord(records, "SlowToConstruct");
+  ASSERT_TRUE(outer);
+  ASSERT_TRUE(inner);
+
+  // The inner instance finishes first, and its time is taken out of the
+  // outer one's.
+  EXPECT_LT(inner, outer);
+  EXPECT_EQ(PlatformThread::CurrentId(), outer->thread_id);
+  EXPECT_EQ(PlatformThread::CurrentId(), inner->thread_id);
+  EXPECT_GE(inner->construction_time.InMilliseconds(), kSleepMs);
+  EXPECT_EQ(inner->construction_time, inner->self_construction_time);
+  EXPECT_GE(outer->construction_time, inner->construction_time);
+  EXPECT_EQ(outer->construction_time - inner->construction_time,
+            outer->self_construction_time);
+  EXPECT_LE(outer->start_time, inner->start_time);
+  EXPECT_FALSE(outer->destroyed);
+
+  std::string report = InitializationProfiler::GetReport();
+  EXPECT_NE(std::string::npos, report.find("ConstructsOthers"));
+  EXPECT_NE(std::string::npos, report.find("SlowToConstruct"));
+}
+
+TEST_F(InitializationProfilerTest, Destruction) {
+  {
+    ShadowingAtExitManager exit_manager;
+    InitializationProfiler::Start();
+    g_slow_to_destroy.Get();
+  }
+
+  std::vector<InitializationProfiler::Record> records;
+  InitializationProfiler::GetRecords(&records);
+  const InitializationProfiler::Record* record =
+      FindRecord(records, "SlowToDestroy");
+  ASSERT_TRUE(record);
+  EXPECT_TRUE(record->destroyed);
+  EXPECT_GE(record->destruction_time.InMilliseconds(), kSleepMs);
+
+  std::string report = InitializationProfiler::GetReport();
+  EXPECT_NE(std::string::npos, report.find("Destroyed 1 instances"));
+}
+
+TEST_F(InitializationProfilerTest, NotRunning) {
+  ShadowingAtExitManager exit_manager;
+  EXPECT_FALSE(InitializationProfiler::IsRunning());
+  g_slow_to_destroy.Get();
+
+  std::vector<InitializationProfiler::Record> records;
+  InitializationProfiler::GetRecords(&records);
+  EXPECT_TRUE(records.empty());
+}
+
+}  // namespace debug
+}  // namespace base
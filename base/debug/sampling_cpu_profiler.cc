@@ -0,0 +1,404 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/sampling_cpu_profiler.h"
+
+#include <algorithm>
+#include <string>
+
+#include "base/debug/stack_trace.h"
+#include "base/debug/trace_event.h"
+#include "base/logging.h"
+#include "base/memory/singleton.h"
+
+#if defined(OS_LINUX)
+#include <errno.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#endif
+
+namespace base {
+namespace debug {
+
+namespace {
+
+// How often the collector reports the samples.
+const int kCollectIntervalMs = 50;
+
+// The number of samples a thread can hold before the collector reports them,
+// a power of two so that the ring indices can wrap around.  With the
+// collector's interval, enough for one sample every 0.4 ms.
+const uint32 kRingSize = 128;
+
+#if defined(OS_LINUX)
+// The frames at the top of the stacks sampled in the handler that belong to
+// the sampling: the handler and the signal trampoline.
+const int kSignalFrames = 2;
+#else
+const int kSignalFrames = 0;
+#endif
+
+}  // namespace
+
+// static
+const char SamplingCpuProfiler::kTraceCategory[] = "cpu_profiler";
+
+// static
+const int SamplingCpuProfiler::kMaxStackDepth;
+
+// A sample on its way from a ring to the trace.
+struct SamplingCpuProfiler::PendingSample {
+  int thread_id;
+  TimeTicks timestamp;
+  // Innermost first.
+  std::vector<const void*> frames;
+};
+
+// The ring of samples of one registered thread.  The thread's signal handler
+// writes to it and the threads holding |lock_| read from it.  Neither side
+// locks: each slot is handed over by publishing the index past it.
+class SamplingCpuProfiler::ThreadSamples {
+ public:
+  struct Sample {
+    TimeTicks timestamp;
+    // The number of entries of |frames|, including the signal frames.
+    int depth;
+    void* frames[kSignalFrames + kMaxStackDepth];
+  };
+
+  ThreadSamples()
+      : thread_id_(static_cast<int>(PlatformThread::CurrentId())),
+        has_timer_(false),
+        write_index_(0),
+        read_index_(0) {
+  }
+
+  ~ThreadSamples() {
+#if defined(OS_LINUX)
+    if (has_timer_)
+      timer_delete(timer_);
+#endif
+  }
+
+  // Creates the timer of the thread.  Must be called on the thread.
+  bool Init() {
+#if defined(OS_LINUX)
+    // The timer measures the CPU time of the thread that creates it, and
+    // signals that thread only.  glibc has no name for the thread id field.
+    struct sigevent event;
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event._sigev_un._tid = thread_id_;
+    has_timer_ = timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer_) == 0;
+    DPLOG_IF(ERROR, !has_timer_) << "timer_create";
+#endif
+    return has_timer_;
+  }
+
+  // Signals the thread every |interval| of its CPU time, or never if
+  // |interval| is zero.
+  void SetInterval(const TimeDelta& interval) {
+#if defined(OS_LINUX)
+    if (!has_timer_)
+      return;
+    int64 interval_us = std::max<int64>(interval.InMicroseconds(), 0);
+    struct itimerspec spec;
+    spec.it_interval.tv_sec = interval_us / Time::kMicrosecondsPerSecond;
+    spec.it_interval.tv_nsec = (interval_us % Time::kMicrosecondsPerSecond) *
+                               Time::kNanosecondsPerMicrosecond;
+    spec.it_value = spec.it_interval;
+    timer_settime(timer_, 0, &spec, NULL);
+#endif
+  }
+
+  // Returns the slot for the next sample, or NULL if the ring is full.
+  // Called from the signal handler.
+  Sample* BeginSample() {
+    uint32 write = static_cast<uint32>(subtle::NoBarrier_Load(&write_index_));
+    uint32 read = static_cast<uint32>(subtle::Acquire_Load(&read_index_));
+    if (write - read >= kRingSize)
+      return NULL;
+    return &ring_[write % kRingSize];
+  }
+
+  // Hands the slot returned by BeginSample() to the readers.
+  void EndSample() {
+    subtle::Release_Store(&write_index_,
+                          subtle::NoBarrier_Load(&write_index_) + 1);
+  }
+
+  // Moves the samples of the ring to |samples|.  |lock_| must be held.
+  void TakeSamples(std::vector<PendingSample>* samples) {
+    uint32 read = static_cast<uint32>(subtle::NoBarrier_Load(&read_index_));
+    uint32 write = static_cast<uint32>(subtle::Acquire_Load(&write_index_));
+    for (; read != write; ++read) {
+      const Sample& sample = ring_[read % kRingSize];
+      samples->push_back(PendingSample());
+      PendingSample* pending = &samples->back();
+      pending->thread_id = thread_id_;
+      pending->timestamp = sample.timestamp;
+      if (sample.depth > kSignalFrames) {
+        pending->frames.assign(sample.frames + kSignalFrames,
+                               sample.frames + sample.depth);
+      }
+    }
+    subtle::Release_Store(&read_index_, static_cast<subtle::Atomic32>(read));
+  }
+
+ private:
+  const int thread_id_;
+#if defined(OS_LINUX)
+  timer_t timer_;
+#endif
+  bool has_timer_;
+
+  // The number of samples written and read, wrapping around.
+  subtle::Atomic32 write_index_;
+  subtle::Atomic32 read_index_;
+
+  Sample ring_[kRingSize];
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadSamples);
+};
+
+// Reports the samples every kCollectIntervalMs until |stop_collector_| is
+// signaled.
+class SamplingCpuProfiler::Collector : public PlatformThread::Delegate {
+ public:
+  explicit Collector(SamplingCpuProfiler* profiler) : profiler_(profiler) {}
+
+  virtual void ThreadMain() OVERRIDE {
+    PlatformThread::SetName("CpuProfilerCollector");
+    while (!profiler_->stop_collector_.TimedWait(
+               TimeDelta::FromMilliseconds(kCollectIntervalMs))) {
+      profiler_->FlushSamplesToTrace();
+    }
+  }
+
+ private:
+  SamplingCpuProfiler* profiler_;
+
+  DISALLOW_COPY_AND_ASSIGN(Collector);
+};
+
+// static
+SamplingCpuProfiler* SamplingCpuProfiler::GetInstance() {
+  // Leaky, as registered threads may still be signaled during exit.
+  return Singleton<SamplingCpuProfiler,
+                   LeakySingletonTraits<SamplingCpuProfiler> >::get();
+}
+
+// static
+bool SamplingCpuProfiler::IsSupported() {
+#if defined(OS_LINUX)
+  return true;
+#else
+  return false;
+#endif
+}
+
+void SamplingCpuProfiler::RegisterCurrentThread() {
+  if (!IsSupported() || current_thread_samples_.Get())
+    return;
+  ThreadSamples* samples = new ThreadSamples;
+  if (!samples->Init()) {
+    delete samples;
+    return;
+  }
+  AutoLock lock(lock_);
+  threads_.push_back(samples);
+  current_thread_samples_.Set(samples);
+  if (is_running())
+    samples->SetInterval(sampling_interval_);
+}
+
+void SamplingCpuProfiler::UnregisterCurrentThread() {
+  ThreadSamples* samples = current_thread_samples_.Get();
+  if (!samples)
+    return;
+  // The handler runs on this thread, so it can't be writing to the ring once
+  // the thread is forgotten here, even if a signal is still pending.
+  current_thread_samples_.Set(NULL);
+
+  std::vector<PendingSample> pending;
+  {
+    AutoLock lock(lock_);
+    threads_.erase(std::find(threads_.begin(), threads_.end(), samples));
+    samples->TakeSamples(&pending);
+  }
+  delete samples;
+  AddSamplesToTrace(pending);
+}
+
+bool SamplingCpuProfiler::Start(const TimeDelta& sampling_interval) {
+#if defined(OS_LINUX)
+  if (sampling_interval <= TimeDelta())
+    return false;
+
+  // The first backtrace() loads libgcc, and the first trace clock read sets
+  // the clock up, neither of which can be done from the signal handler.
+  StackTrace();
+  TimeTicks::NowFromSystemTraceTime();
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = SampleHandler;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  struct sigaction old_action;
+  if (sigaction(SIGPROF, &action, &old_action) != 0)
+    return false;
+  if (old_action.sa_handler != SIG_DFL && old_action.sa_handler != SIG_IGN &&
+      old_action.sa_handler != SampleHandler) {
+    // Another profiler owns SIGPROF.
+    sigaction(SIGPROF, &old_action, NULL);
+    return false;
+  }
+
+  AutoLock lock(lock_);
+  if (is_running())
+    return false;
+  collector_.reset(new Collector(this));
+  if (!PlatformThread::Create(0, collector_.get(), &collector_handle_)) {
+    collector_.reset();
+    return false;
+  }
+  sampling_interval_ = sampling_interval;
+  subtle::NoBarrier_Store(&running_, 1);
+  UpdateTimersLocked();
+  return true;
+#else
+  return false;
+#endif
+}
+
+void SamplingCpuProfiler::Stop() {
+  PlatformThreadHandle collector_handle;
+  {
+    AutoLock lock(lock_);
+    if (!is_running())
+      return;
+    subtle::NoBarrier_Store(&running_, 0);
+    UpdateTimersLocked();
+    collector_handle = collector_handle_;
+  }
+
+  // The collector takes |lock_| to report.
+  stop_collector_.Signal();
+  PlatformThread::Join(collector_handle);
+  stop_collector_.Reset();
+  collector_.reset();
+
+  FlushSamplesToTrace();
+}
+
+void SamplingCpuProfiler::SetSamplingInterval(
+    const TimeDelta& sampling_interval) {
+  if (sampling_interval <= TimeDelta())
+    return;
+  AutoLock lock(lock_);
+  sampling_interval_ = sampling_interval;
+  UpdateTimersLocked();
+}
+
+TimeDelta SamplingCpuProfiler::sampling_interval() {
+  AutoLock lock(lock_);
+  return sampling_interval_;
+}
+
+void SamplingCpuProfiler::SetMaxStackDepth(int max_stack_depth) {
+  subtle::NoBarrier_Store(&max_stack_depth_,
+                          std::max(1, std::min(max_stack_depth,
+                                               kMaxStackDepth)));
+}
+
+void SamplingCpuProfiler::FlushSamplesToTrace() {
+  std::vector<PendingSample> pending;
+  {
+    AutoLock lock(lock_);
+    for (size_t i = 0; i < threads_.size(); ++i)
+      threads_[i]->TakeSamples(&pending);
+  }
+  AddSamplesToTrace(pending);
+}
+
+SamplingCpuProfiler::SamplingCpuProfiler()
+    : running_(0),
+      max_stack_depth_(kMaxStackDepth),
+      dropped_sample_count_(0),
+      category_enabled_(TraceLog::GetCategoryEnabled(kTraceCategory)),
+      stop_collector_(false, false),
+      collector_handle_(kNullThreadHandle) {
+}
+
+SamplingCpuProfiler::~SamplingCpuProfiler() {
+}
+
+void SamplingCpuProfiler::UpdateTimersLocked() {
+  lock_.AssertAcquired();
+  TimeDelta interval = is_running() ? sampling_interval_ : TimeDelta();
+  for (size_t i = 0; i < threads_.size(); ++i)
+    threads_[i]->SetInterval(interval);
+}
+
+void SamplingCpuProfiler::AddSamplesToTrace(
+    const std::vector<PendingSample>& samples) {
+  // Symbolizing is the expensive part, so it is skipped for samples that
+  // would be dropped anyway.
+  if (samples.empty() || !*category_enabled_)
+    return;
+
+  TraceLog* trace_log = TraceLog::GetInstance();
+  std::vector<std::string> symbols;
+  for (size_t i = 0; i < samples.size(); ++i) {
+    const PendingSample& sample = samples[i];
+    std::string stack;
+    if (!sample.frames.empty()) {
+      StackTrace::SymbolizeAddresses(&sample.frames[0], sample.frames.size(),
+                                     &symbols);
+      for (size_t j = symbols.size(); j > 0; --j) {
+        stack.append(symbols[j - 1]);
+        if (j > 1)
+          stack.push_back(';');
+      }
+    }
+
+    const char* arg_names[] = { "stack" };
+    unsigned char arg_types[1];
+    unsigned long long arg_values[1];
+    trace_event_internal::SetTraceValue(stack, &arg_types[0], &arg_values[0]);
+    trace_log->AddTraceEventWithThreadIdAndTimestamp(
+        TRACE_EVENT_PHASE_INSTANT, category_enabled_, "Sample", 0,
+        sample.thread_id, sample.timestamp, 1, arg_names, arg_types,
+        arg_values, TRACE_EVENT_FLAG_NONE);
+  }
+}
+
+// static
+void SamplingCpuProfiler::SampleHandler(int signal) {
+#if defined(OS_LINUX)
+  SamplingCpuProfiler* profiler = GetInstance();
+  ThreadSamples* samples = profiler->current_thread_samples_.Get();
+  if (!samples)
+    return;
+  ThreadSamples::Sample* sample = samples->BeginSample();
+  if (!sample) {
+    subtle::NoBarrier_AtomicIncrement(&profiler->dropped_sample_count_, 1);
+    return;
+  }
+
+  int saved_errno = errno;
+  sample->timestamp = TimeTicks::NowFromSystemTraceTime();
+  sample->depth = backtrace(sample->frames,
+                            kSignalFrames + profiler->max_stack_depth());
+  samples->EndSample();
+  errno = saved_errno;
+#endif
+}
+
+}  // namespace debug
+}  // namespace base
@@ -0,0 +1,149 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// SamplingCpuProfiler samples the stacks of the threads registered with it as
+// they use the CPU, and adds the samples to the trace, so that where the CPU
+// went can be seen next to the TRACE_EVENTs of the same threads.
+//
+// Each registered thread gets a POSIX timer on its own CPU time clock, which
+// sends the thread SIGPROF every |sampling_interval| of CPU time it uses.  The
+// handler records the program counters of the stack into a ring buffer of the
+// thread, without locks or allocations.  A collector thread empties the rings
+// every 50 ms and, while the "cpu_profiler" category is traced, adds each
+// sample as an instant event of the sampled thread at the time it was taken,
+// with the symbolized stack, outermost frame first and frames separated by
+// ';', as its "stack" argument.  Samples taken while the category is not
+// traced are dropped.
+//
+// The overhead is one unwind of at most max_stack_depth() frames per
+// sample, and both the interval and the depth can be changed while the
+// profiler runs.  Samples are only taken on Linux; elsewhere Start() returns
+// false.  The profiler can't run along with the gperftools profiler of
+// base/debug/profiler.h, which also uses SIGPROF.
+//
+// EXAMPLE:
+//
+//   // On each thread to profile.
+//   SamplingCpuProfiler::GetInstance()->RegisterCurrentThread();
+//   ...
+//   TraceLog::GetInstance()->SetEnabled(std::string("cpu_profiler,gpu"));
+//   SamplingCpuProfiler::GetInstance()->Start(TimeDelta::FromMilliseconds(1));
+
+#ifndef BASE_DEBUG_SAMPLING_CPU_PROFILER_H_
+#define BASE_DEBUG_SAMPLING_CPU_PROFILER_H_
+#pragma once
+
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread_local.h"
+#include "base/time.h"
+
+template <typename T> struct DefaultSingletonTraits;
+
+namespace base {
+namespace debug {
+
+class BASE_EXPORT SamplingCpuProfiler {
+ public:
+  // The category of the sample events.
+  static const char kTraceCategory[];
+
+  // The deepest stacks that can be sampled, and the default depth.
+  static const int kMaxStackDepth = 64;
+
+  static SamplingCpuProfiler* GetInstance();
+
+  // Returns true if samples can be taken on this platform.
+  static bool IsSupported();
+
+  // Starts and stops sampling the current thread, if the profiler runs.  A
+  // registered thread must unregister before it exits.  Samples it has not
+  // reported yet are added to the trace on unregistering.
+  void RegisterCurrentThread();
+  void UnregisterCurrentThread();
+
+  // Starts sampling the registered threads every |sampling_interval| of the
+  // CPU time of each.  Returns false if the profiler already runs or can't
+  // run.
+  bool Start(const TimeDelta& sampling_interval);
+
+  // Stops sampling and adds the samples not reported yet to the trace.
+  void Stop();
+
+  bool is_running() const { return subtle::NoBarrier_Load(&running_) != 0; }
+
+  // Changes how often the threads are sampled, from their next sample on.
+  void SetSamplingInterval(const TimeDelta& sampling_interval);
+  TimeDelta sampling_interval();
+
+  // Limits the samples to the innermost |max_stack_depth| frames, from 1 to
+  // kMaxStackDepth, to make sampling cheaper.
+  void SetMaxStackDepth(int max_stack_depth);
+  int max_stack_depth() const {
+    return subtle::NoBarrier_Load(&max_stack_depth_);
+  }
+
+  // Adds the samples taken so far to the trace now, instead of on the next
+  // round of the collector.
+  void FlushSamplesToTrace();
+
+  // Returns how many samples were dropped because a thread took them faster
+  // than the collector reported them.
+  int dropped_sample_count() const {
+    return subtle::NoBarrier_Load(&dropped_sample_count_);
+  }
+
+ private:
+  friend struct DefaultSingletonTraits<SamplingCpuProfiler>;
+
+  class Collector;
+  class ThreadSamples;
+  struct PendingSample;
+
+  SamplingCpuProfiler();
+  ~SamplingCpuProfiler();
+
+  // Arms the timers of all the registered threads with the current interval,
+  // or disarms them if the profiler is stopped.  |lock_| must be held.
+  void UpdateTimersLocked();
+
+  // Adds |samples| to the trace, if the category is enabled.
+  void AddSamplesToTrace(const std::vector<PendingSample>& samples);
+
+  // The SIGPROF handler.
+  static void SampleHandler(int signal);
+
+  subtle::Atomic32 running_;
+  subtle::Atomic32 max_stack_depth_;
+  subtle::Atomic32 dropped_sample_count_;
+
+  // The samples of the current thread, if it is registered.
+  ThreadLocalPointer<ThreadSamples> current_thread_samples_;
+
+  const unsigned char* category_enabled_;
+
+  // Guards the members below.
+  Lock lock_;
+  TimeDelta sampling_interval_;
+  std::vector<ThreadSamples*> threads_;
+
+  // Signaled to stop the collector thread.
+  WaitableEvent stop_collector_;
+  scoped_ptr<Collector> collector_;
+  PlatformThreadHandle collector_handle_;
+
+  DISALLOW_COPY_AND_ASSIGN(SamplingCpuProfiler);
+};
+
+}  // namespace debug
+}  // namespace base
+
+#endif  // BASE_DEBUG_SAMPLING_CPU_PROFILER_H_
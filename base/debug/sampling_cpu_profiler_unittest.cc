@@ -0,0 +1,124 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/sampling_cpu_profiler.h"
+
+#include <string.h>
+
+#include <string>
+
+#include "base/debug/trace_event.h"
+#include "base/threading/platform_thread.h"
+#include "base/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+// Keeps the CPU busy for |duration| of wall time.
+void Spin(const TimeDelta& duration) {
+  volatile int sink = 0;
+  TimeTicks end = TimeTicks::Now() + duration;
+  while (TimeTicks::Now() < end) {
+    for (int i = 0; i < 10000; ++i)
+      sink += i;
+  }
+}
+
+// Returns the number of samples in the trace, checking that they were taken
+// between |start| and |end|.
+size_t CountSamples(TimeTicks start, TimeTicks end) {
+  TraceLog* trace_log = TraceLog::GetInstance();
+  size_t count = 0;
+  for (size_t i = 0; i < trace_log->GetEventsSize(); ++i) {
+    const TraceEvent& event = trace_log->GetEventAt(i);
+    if (strcmp(event.name(), "Sample") != 0)
+      continue;
+    EXPECT_EQ(TRACE_EVENT_PHASE_INSTANT, event.phase());
+    EXPECT_LE(start, event.timestamp());
+    EXPECT_GE(end, event.timestamp());
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
+class SamplingCpuProfilerTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    SamplingCpuProfiler::GetInstance()->RegisterCurrentThread();
+  }
+
+  virtual void TearDown() OVERRIDE {
+    SamplingCpuProfiler* profiler = SamplingCpuProfiler::GetInstance();
+    profiler->Stop();
+    profiler->UnregisterCurrentThread();
+    profiler->SetMaxStackDepth(SamplingCpuProfiler::kMaxStackDepth);
+    TraceLog::GetInstance()->SetEnabled(false);
+  }
+};
+
+TEST_F(SamplingCpuProfilerTest, SamplesBusyThread) {
+  if (!SamplingCpuProfiler::IsSupported())
+    return;
+
+  SamplingCpuProfiler* profiler = SamplingCpuProfiler::GetInstance();
+  TraceLog::GetInstance()->SetEnabled(
+      std::string(SamplingCpuProfiler::kTraceCategory));
+  TimeTicks start = TimeTicks::NowFromSystemTraceTime();
+  ASSERT_TRUE(profiler->Start(TimeDelta::FromMilliseconds(1)));
+  EXPECT_TRUE(profiler->is_running());
+  EXPECT_FALSE(profiler->Start(TimeDelta::FromMilliseconds(1)));
+
+  Spin(TimeDelta::FromMilliseconds(200));
+  profiler->Stop();
+  TimeTicks end = TimeTicks::NowFromSystemTraceTime();
+  EXPECT_FALSE(profiler->is_running());
+
+  // About 200 samples, but loaded bots give the thread less CPU.
+  EXPECT_LT(10u, CountSamples(start, end));
+}
+
+TEST_F(SamplingCpuProfilerTest, NoSamplesWithoutCategory) {
+  if (!SamplingCpuProfiler::IsSupported())
+    return;
+
+  SamplingCpuProfiler* profiler = SamplingCpuProfiler::GetInstance();
+  TraceLog::GetInstance()->SetEnabled(std::string("-cpu_profiler"));
+  TimeTicks start = TimeTicks::NowFromSystemTraceTime();
+  ASSERT_TRUE(profiler->Start(TimeDelta::FromMilliseconds(1)));
+  Spin(TimeDelta::FromMilliseconds(50));
+  profiler->Stop();
+  TimeTicks end = TimeTicks::NowFromSystemTraceTime();
+
+  EXPECT_EQ(0u, CountSamples(start, end));
+}
+
+TEST_F(SamplingCpuProfilerTest, RuntimeControls) {
+  SamplingCpuProfiler* profiler = SamplingCpuProfiler::GetInstance();
+  profiler->SetMaxStackDepth(0);
+  EXPECT_EQ(1, profiler->max_stack_depth());
+  profiler->SetMaxStackDepth(1000);
+  EXPECT_EQ(SamplingCpuProfiler::kMaxStackDepth, profiler->max_stack_depth());
+  profiler->SetMaxStackDepth(8);
+  EXPECT_EQ(8, profiler->max_stack_depth());
+
+  if (!SamplingCpuProfiler::IsSupported())
+    return;
+
+  ASSERT_TRUE(profiler->Start(TimeDelta::FromMilliseconds(10)));
+  EXPECT_EQ(10, profiler->sampling_interval().InMilliseconds());
+  profiler->SetSamplingInterval(TimeDelta::FromMilliseconds(2));
+  EXPECT_EQ(2, profiler->sampling_interval().InMilliseconds());
+
+  // Non-positive intervals are ignored.
+  profiler->SetSamplingInterval(TimeDelta());
+  EXPECT_EQ(2, profiler->sampling_interval().InMilliseconds());
+}
+
+}  // namespace debug
+}  // namespace base
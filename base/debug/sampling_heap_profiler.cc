@@ -0,0 +1,321 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/sampling_heap_profiler.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "base/allocator/allocator_extension.h"
+#include "base/debug/stack_trace.h"
+#include "base/debug/trace_event.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/format_macros.h"
+#include "base/logging.h"
+#include "base/memory/singleton.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+// Keeps the estimates of a sample representable; an interval this long is
+// as good as never sampling again.
+const intptr_t kMaxSampleInterval = 1 << 30;
+
+uint64 RoundEstimate(double estimate) {
+  return estimate > 0 ? static_cast<uint64>(estimate + 0.5) : 0;
+}
+
+void AppendSiteLine(uint64 live_count,
+                    uint64 live_bytes,
+                    uint64 total_count,
+                    uint64 total_bytes,
+                    std::string* out) {
+  StringAppendF(out, "%" PRIu64 ": %" PRIu64 " [%" PRIu64 ": %" PRIu64 "] @",
+                live_count, live_bytes, total_count, total_bytes);
+}
+
+}  // namespace
+
+// Marks the current thread as running profiler code for the lifetime of the
+// object.  Allocations and frees made meanwhile are neither sampled nor
+// looked up, which keeps them from recursing into the profiler, and from
+// deadlocking on |lock_|.
+class SamplingHeapProfiler::AutoInProfiler {
+ public:
+  explicit AutoInProfiler(SamplingHeapProfiler* profiler)
+      : profiler_(profiler),
+        saved_bytes_until_sample_(profiler->bytes_until_sample_.Get()) {
+    profiler_->in_profiler_.Set(this);
+    profiler_->bytes_until_sample_.Set(
+        reinterpret_cast<void*>(kMaxSampleInterval));
+  }
+
+  ~AutoInProfiler() {
+    profiler_->bytes_until_sample_.Set(saved_bytes_until_sample_);
+    profiler_->in_profiler_.Set(NULL);
+  }
+
+ private:
+  SamplingHeapProfiler* profiler_;
+  void* saved_bytes_until_sample_;
+
+  DISALLOW_COPY_AND_ASSIGN(AutoInProfiler);
+};
+
+SamplingHeapProfiler::Site::Site()
+    : live_count(0),
+      live_bytes(0),
+      total_count(0),
+      total_bytes(0) {
+}
+
+SamplingHeapProfiler::Site::~Site() {
+}
+
+SamplingHeapProfiler::SiteData::SiteData()
+    : live_count(0),
+      live_bytes(0),
+      total_count(0),
+      total_bytes(0) {
+}
+
+// static
+SamplingHeapProfiler* SamplingHeapProfiler::GetInstance() {
+  return Singleton<SamplingHeapProfiler,
+                   LeakySingletonTraits<SamplingHeapProfiler> >::get();
+}
+
+SamplingHeapProfiler::SamplingHeapProfiler()
+    : running_(0),
+      mean_sampling_interval_(0),
+      random_state_(1) {
+  memset(sampled_blocks_, 0, sizeof(sampled_blocks_));
+}
+
+SamplingHeapProfiler::~SamplingHeapProfiler() {
+}
+
+void SamplingHeapProfiler::Start(size_t mean_sampling_interval) {
+  DCHECK_GT(mean_sampling_interval, 0u);
+  DCHECK(!is_running());
+  mean_sampling_interval_ = mean_sampling_interval;
+  uint32 seed = static_cast<uint32>(TimeTicks::Now().ToInternalValue());
+  subtle::NoBarrier_Store(&random_state_,
+                          static_cast<subtle::Atomic32>(seed | 1));
+  // Other threads finish the countdown of the previous run first.
+  bytes_until_sample_.Set(NULL);
+  subtle::Release_Store(&running_, 1);
+  allocator::SetAllocationHooks(&SamplingHeapProfiler::AllocationHook,
+                                &SamplingHeapProfiler::FreeHook);
+}
+
+void SamplingHeapProfiler::Stop() {
+  if (!is_running())
+    return;
+  allocator::SetAllocationHooks(NULL, NULL);
+  subtle::Release_Store(&running_, 0);
+}
+
+void SamplingHeapProfiler::RecordAlloc(void* ptr, size_t size) {
+  if (!ptr || !subtle::NoBarrier_Load(&running_))
+    return;
+  // This is the fast path of every allocation: one TLS read and one write.
+  intptr_t bytes_until_sample =
+      reinterpret_cast<intptr_t>(bytes_until_sample_.Get());
+  if (!bytes_until_sample)
+    bytes_until_sample = NextSampleInterval();
+  if (size < static_cast<size_t>(bytes_until_sample)) {
+    bytes_until_sample -= static_cast<intptr_t>(size);
+    bytes_until_sample_.Set(reinterpret_cast<void*>(bytes_until_sample));
+    return;
+  }
+  // Code inside AutoInProfiler never gets here, as it counts down from
+  // kMaxSampleInterval.
+  {
+    AutoInProfiler in_profiler(this);
+    RecordSample(ptr, size);
+  }
+  // The intervals are memoryless, so the next one starts afresh.
+  bytes_until_sample_.Set(reinterpret_cast<void*>(NextSampleInterval()));
+}
+
+void SamplingHeapProfiler::RecordFree(void* ptr) {
+  if (!ptr || !subtle::NoBarrier_Load(&sampled_blocks_[FilterSlot(ptr)]))
+    return;
+  if (in_profiler_.Get())
+    return;
+  AutoInProfiler in_profiler(this);
+  AutoLock lock(lock_);
+  LiveSampleMap::iterator it =
+      live_samples_.find(reinterpret_cast<uintptr_t>(ptr));
+  if (it == live_samples_.end())
+    return;
+  SiteData& site = site_data_[it->second.site];
+  site.live_count -= it->second.count;
+  site.live_bytes -= it->second.bytes;
+  live_samples_.erase(it);
+  subtle::NoBarrier_AtomicIncrement(&sampled_blocks_[FilterSlot(ptr)], -1);
+}
+
+void SamplingHeapProfiler::GetSnapshot(std::vector<Site>* sites) {
+  AutoInProfiler in_profiler(this);
+  AutoLock lock(lock_);
+  for (size_t i = 0; i < site_data_.size(); ++i) {
+    sites->push_back(Site());
+    Site& site = sites->back();
+    stacks_.GetStack(i, &site.frames);
+    site.live_count = RoundEstimate(site_data_[i].live_count);
+    site.live_bytes = RoundEstimate(site_data_[i].live_bytes);
+    site.total_count = RoundEstimate(site_data_[i].total_count);
+    site.total_bytes = RoundEstimate(site_data_[i].total_bytes);
+  }
+}
+
+std::string SamplingHeapProfiler::GetSnapshotAsHeapProfile() {
+  std::vector<Site> sites;
+  GetSnapshot(&sites);
+
+  Site total;
+  for (size_t i = 0; i < sites.size(); ++i) {
+    total.live_count += sites[i].live_count;
+    total.live_bytes += sites[i].live_bytes;
+    total.total_count += sites[i].total_count;
+    total.total_bytes += sites[i].total_bytes;
+  }
+
+  std::string profile("heap profile: ");
+  AppendSiteLine(total.live_count, total.live_bytes, total.total_count,
+                 total.total_bytes, &profile);
+  profile += " heapprofile\n";
+  for (size_t i = 0; i < sites.size(); ++i) {
+    if (!sites[i].live_count)
+      continue;
+    AppendSiteLine(sites[i].live_count, sites[i].live_bytes,
+                   sites[i].total_count, sites[i].total_bytes, &profile);
+    for (size_t frame = 0; frame < sites[i].frames.size(); ++frame) {
+      StringAppendF(&profile, " 0x%" PRIx64, static_cast<uint64>(
+          reinterpret_cast<uintptr_t>(sites[i].frames[frame])));
+    }
+    profile += "\n";
+  }
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  std::string maps;
+  if (file_util::ReadFileToString(FilePath("/proc/self/maps"), &maps))
+    profile += "\nMAPPED_LIBRARIES:\n" + maps;
+#endif
+  return profile;
+}
+
+bool SamplingHeapProfiler::DumpToFile(const FilePath& path) {
+  std::string profile = GetSnapshotAsHeapProfile();
+  int size = static_cast<int>(profile.size());
+  return file_util::WriteFile(path, profile.data(), size) == size;
+}
+
+void SamplingHeapProfiler::AddSnapshotToTrace() {
+  std::vector<Site> sites;
+  GetSnapshot(&sites);
+  uint64 live_bytes = 0;
+  for (size_t i = 0; i < sites.size(); ++i)
+    live_bytes += sites[i].live_bytes;
+  std::string profile = GetSnapshotAsHeapProfile();
+  TRACE_EVENT_INSTANT2("memory", "SamplingHeapProfiler::Snapshot",
+                       "live_bytes",
+                       static_cast<unsigned long long>(live_bytes),
+                       "heap_profile", TRACE_STR_COPY(profile.c_str()));
+}
+
+void SamplingHeapProfiler::ClearForTesting() {
+  Stop();
+  AutoInProfiler in_profiler(this);
+  AutoLock lock(lock_);
+  site_data_.clear();
+  stacks_.Clear();
+  live_samples_.clear();
+  memset(sampled_blocks_, 0, sizeof(sampled_blocks_));
+}
+
+intptr_t SamplingHeapProfiler::NextSampleInterval() {
+  // xorshift32, which never reaches 0 from a non-zero state.
+  uint32 random = static_cast<uint32>(subtle::NoBarrier_Load(&random_state_));
+  random ^= random << 13;
+  random ^= random >> 17;
+  random ^= random << 5;
+  subtle::NoBarrier_Store(&random_state_,
+                          static_cast<subtle::Atomic32>(random));
+
+  // An exponentially distributed interval, from a uniform value in (0, 1].
+  double uniform = (static_cast<double>(random >> 8) + 1) / (1 << 24);
+  double interval = -log(uniform) * mean_sampling_interval_;
+  if (interval < 1)
+    return 1;
+  if (interval > kMaxSampleInterval)
+    return kMaxSampleInterval;
+  return static_cast<intptr_t>(interval);
+}
+
+void SamplingHeapProfiler::RecordSample(void* ptr, size_t size) {
+  double probability =
+      1 - exp(-static_cast<double>(size) / mean_sampling_interval_);
+  if (probability <= 0)
+    return;
+  LiveSample sample;
+  sample.count = 1 / probability;
+  sample.bytes = size * sample.count;
+
+  StackTrace trace;
+  size_t frame_count = 0;
+  const void* const* frames = trace.Addresses(&frame_count);
+
+  AutoLock lock(lock_);
+  sample.site = stacks_.Intern(frames, frame_count);
+  if (sample.site == site_data_.size())
+    site_data_.push_back(SiteData());
+
+  std::pair<LiveSampleMap::iterator, bool> inserted =
+      live_samples_.insert(
+          std::make_pair(reinterpret_cast<uintptr_t>(ptr), sample));
+  if (inserted.second) {
+    subtle::NoBarrier_AtomicIncrement(&sampled_blocks_[FilterSlot(ptr)], 1);
+  } else {
+    // We missed the free of the block that was here before.
+    LiveSample& stale = inserted.first->second;
+    site_data_[stale.site].live_count -= stale.count;
+    site_data_[stale.site].live_bytes -= stale.bytes;
+    stale = sample;
+  }
+
+  SiteData& site = site_data_[sample.site];
+  site.live_count += sample.count;
+  site.live_bytes += sample.bytes;
+  site.total_count += sample.count;
+  site.total_bytes += sample.bytes;
+}
+
+// static
+size_t SamplingHeapProfiler::FilterSlot(const void* ptr) {
+  // Fibonacci hashing of the block address, whose low bits are mostly zero.
+  COMPILE_ASSERT(kFilterSize == 1 << 16, filter_slot_takes_16_bits);
+  uint32 address = static_cast<uint32>(reinterpret_cast<uintptr_t>(ptr) >> 3);
+  return (address * 2654435769u) >> 16;
+}
+
+// static
+void SamplingHeapProfiler::AllocationHook(void* ptr, size_t size) {
+  GetInstance()->RecordAlloc(ptr, size);
+}
+
+// static
+void SamplingHeapProfiler::FreeHook(void* ptr) {
+  GetInstance()->RecordFree(ptr);
+}
+
+}  // namespace debug
+}  // namespace base
@@ -0,0 +1,179 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// SamplingHeapProfiler tells which call sites hold on to heap memory, cheaply
+// enough to leave running in the field.
+//
+// It samples allocations as a Poisson process over the allocated bytes: on
+// average one sample is taken every |mean_sampling_interval| bytes, so an
+// allocation of |size| bytes is sampled with probability
+// 1 - exp(-size / mean_sampling_interval), and each sample stands for
+// 1 / that probability allocations.  Allocations that are not sampled cost a
+// thread-local countdown; frees of unsampled blocks cost a lookup in a small
+// table of counters.  Each sample records a StackTrace, and samples are
+// aggregated per distinct stack into estimated live and total bytes.
+//
+// The allocator shim (base/allocator) calls the profiler for every allocation
+// once Start() has installed its hooks.  Allocators that bypass the shim can
+// call RecordAlloc() and RecordFree() themselves.
+//
+// EXAMPLE:
+//
+//   SamplingHeapProfiler::GetInstance()->Start(128 * 1024);
+//   ...
+//   SamplingHeapProfiler::GetInstance()->DumpToFile(path);
+
+#ifndef BASE_DEBUG_SAMPLING_HEAP_PROFILER_H_
+#define BASE_DEBUG_SAMPLING_HEAP_PROFILER_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/debug/stack_table.h"
+#include "base/hash_tables.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
+
+class FilePath;
+
+template <typename T> struct DefaultSingletonTraits;
+
+namespace base {
+namespace debug {
+
+class BASE_EXPORT SamplingHeapProfiler {
+ public:
+  // The estimated allocations of one call stack.
+  struct BASE_EXPORT Site {
+    Site();
+    ~Site();
+
+    // The program counters of the stack, innermost first.
+    std::vector<const void*> frames;
+    // Allocations that are still live.
+    uint64 live_count;
+    uint64 live_bytes;
+    // All allocations since Start().
+    uint64 total_count;
+    uint64 total_bytes;
+  };
+
+  static SamplingHeapProfiler* GetInstance();
+
+  // Starts sampling about one allocation in every |mean_sampling_interval|
+  // bytes, and hooks the profiler into the allocator shim.  Data from an
+  // earlier run is kept.
+  void Start(size_t mean_sampling_interval);
+
+  // Unhooks the profiler.  Blocks allocated while it ran are still reported
+  // as live until ClearForTesting(), since their frees are no longer seen.
+  void Stop();
+
+  bool is_running() const { return running_ != 0; }
+
+  // Report an allocation of |size| bytes at |ptr|, and the free of |ptr|.
+  // Called from inside the allocator, on any thread.
+  void RecordAlloc(void* ptr, size_t size);
+  void RecordFree(void* ptr);
+
+  // Appends the sites that have allocated since Start() to |sites|.
+  void GetSnapshot(std::vector<Site>* sites);
+
+  // Returns the live sites in the heap profile format of pprof (the
+  // "heap profile: ... @ heapprofile" text format), followed by the memory
+  // map of the process where the platform has one, so that pprof can
+  // symbolize it.
+  std::string GetSnapshotAsHeapProfile();
+
+  // Writes GetSnapshotAsHeapProfile() to |path|.  Returns false on failure.
+  bool DumpToFile(const FilePath& path);
+
+  // Adds the snapshot to the trace, as a "memory" category instant event
+  // with the heap profile and the estimated live bytes as arguments.
+  void AddSnapshotToTrace();
+
+  // Stops the profiler and forgets all the samples.
+  void ClearForTesting();
+
+ private:
+  friend struct DefaultSingletonTraits<SamplingHeapProfiler>;
+
+  class AutoInProfiler;
+
+  // What the profiler remembers about a sampled live block.
+  struct LiveSample {
+    size_t site;
+    double count;
+    double bytes;
+  };
+
+  // The unrounded estimates of a Site.
+  struct SiteData {
+    SiteData();
+
+    double live_count;
+    double live_bytes;
+    double total_count;
+    double total_bytes;
+  };
+
+  // Keyed by block address.
+  typedef base::hash_map<uintptr_t, LiveSample> LiveSampleMap;
+
+  SamplingHeapProfiler();
+  ~SamplingHeapProfiler();
+
+  // Draws the number of bytes until the next sample.
+  intptr_t NextSampleInterval();
+
+  // Records a sampled block, while the current thread is marked as being in
+  // the profiler.
+  void RecordSample(void* ptr, size_t size);
+
+  // The slot of the counter of |ptr| in |sampled_blocks_|.
+  static size_t FilterSlot(const void* ptr);
+
+  // Allocator hooks.
+  static void AllocationHook(void* ptr, size_t size);
+  static void FreeHook(void* ptr);
+
+  // Non-zero while the hooks are installed.
+  subtle::Atomic32 running_;
+  size_t mean_sampling_interval_;
+
+  // The state of the random number generator for the sampling intervals.
+  // Threads race on it, which only stirs it more.
+  subtle::Atomic32 random_state_;
+
+  // Per thread, the number of bytes until the next sample, or 0 if the
+  // thread has not allocated yet.
+  ThreadLocalStorage::Slot bytes_until_sample_;
+
+  // Per thread, non-NULL while the thread runs profiler code that may
+  // allocate, so that those allocations and frees are not recorded.
+  ThreadLocalStorage::Slot in_profiler_;
+
+  // For each of a fixed number of slots, how many sampled live blocks hash to
+  // it.  Frees of blocks whose slot is zero skip the lock.
+  static const size_t kFilterSize = 1 << 16;
+  subtle::Atomic32 sampled_blocks_[kFilterSize];
+
+  // Protects everything below.
+  Lock lock_;
+  // Indexed by the ids of |stacks_|.
+  std::vector<SiteData> site_data_;
+  StackTable stacks_;
+  LiveSampleMap live_samples_;
+
+  DISALLOW_COPY_AND_ASSIGN(SamplingHeapProfiler);
+};
+
+}  // namespace debug
+}  // namespace base
+
+#endif  // BASE_DEBUG_SAMPLING_HEAP_PROFILER_H_
@@ -0,0 +1,126 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/sampling_heap_profiler.h"
+
+#include <string>
+#include <vector>
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/scoped_temp_dir.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+// Blocks are reported with made up addresses, so that the test does not
+// depend on which allocator the binary uses.
+void* FakeBlock(uintptr_t index) {
+  return reinterpret_cast<void*>((index + 1) * 16);
+}
+
+uint64 LiveBytes(const std::vector<SamplingHeapProfiler::Site>& sites) {
+  uint64 live_bytes = 0;
+  for (size_t i = 0; i < sites.size(); ++i)
+    live_bytes += sites[i].live_bytes;
+  return live_bytes;
+}
+
+}  // namespace
+
+class SamplingHeapProfilerTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    SamplingHeapProfiler::GetInstance()->ClearForTesting();
+  }
+
+  virtual void TearDown() OVERRIDE {
+    SamplingHeapProfiler::GetInstance()->ClearForTesting();
+  }
+};
+
+// With a one byte interval every allocation is sampled, at a weight of about
+// one, so the estimates are exact.
+TEST_F(SamplingHeapProfilerTest, SampleEveryAllocation) {
+  SamplingHeapProfiler* profiler = SamplingHeapProfiler::GetInstance();
+  profiler->Start(1);
+  EXPECT_TRUE(profiler->is_running());
+  profiler->RecordAlloc(FakeBlock(0), 12345);
+  profiler->RecordAlloc(FakeBlock(1), 23456);
+
+  std::vector<SamplingHeapProfiler::Site> sites;
+  profiler->GetSnapshot(&sites);
+  ASSERT_FALSE(sites.empty());
+  uint64 total_bytes = 0;
+  uint64 total_count = 0;
+  for (size_t i = 0; i < sites.size(); ++i) {
+    EXPECT_FALSE(sites[i].frames.empty());
+    total_bytes += sites[i].total_bytes;
+    total_count += sites[i].total_count;
+  }
+  EXPECT_EQ(12345u + 23456u, total_bytes);
+  EXPECT_EQ(2u, total_count);
+  EXPECT_EQ(12345u + 23456u, LiveBytes(sites));
+
+  profiler->RecordFree(FakeBlock(1));
+  sites.clear();
+  profiler->GetSnapshot(&sites);
+  EXPECT_EQ(12345u, LiveBytes(sites));
+
+  // Frees of blocks that were never reported are ignored.
+  profiler->RecordFree(FakeBlock(2));
+  profiler->RecordFree(FakeBlock(0));
+  sites.clear();
+  profiler->GetSnapshot(&sites);
+  EXPECT_EQ(0u, LiveBytes(sites));
+
+  profiler->Stop();
+  EXPECT_FALSE(profiler->is_running());
+}
+
+// The weights of the samples make up for the allocations that were not
+// sampled.
+TEST_F(SamplingHeapProfilerTest, EstimateFromSamples) {
+  const int kAllocations = 100000;
+  const size_t kSize = 64;
+  SamplingHeapProfiler* profiler = SamplingHeapProfiler::GetInstance();
+  profiler->Start(1024);
+  for (int i = 0; i < kAllocations; ++i)
+    profiler->RecordAlloc(FakeBlock(i), kSize);
+
+  std::vector<SamplingHeapProfiler::Site> sites;
+  profiler->GetSnapshot(&sites);
+  double expected = static_cast<double>(kAllocations * kSize);
+  double estimated = static_cast<double>(LiveBytes(sites));
+  EXPECT_GT(estimated, expected * 0.9);
+  EXPECT_LT(estimated, expected * 1.1);
+
+  for (int i = 0; i < kAllocations; ++i)
+    profiler->RecordFree(FakeBlock(i));
+  sites.clear();
+  profiler->GetSnapshot(&sites);
+  EXPECT_EQ(0u, LiveBytes(sites));
+}
+
+TEST_F(SamplingHeapProfilerTest, DumpToFile) {
+  SamplingHeapProfiler* profiler = SamplingHeapProfiler::GetInstance();
+  profiler->Start(1);
+  profiler->RecordAlloc(FakeBlock(0), 100);
+
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath path = temp_dir.path().AppendASCII("heap.prof");
+  ASSERT_TRUE(profiler->DumpToFile(path));
+
+  std::string profile;
+  ASSERT_TRUE(file_util::ReadFileToString(path, &profile));
+  EXPECT_EQ(0u, profile.find("heap profile: 1: 100 [1: 100] @ heapprofile\n"));
+  EXPECT_NE(std::string::npos, profile.find("\n1: 100 [1: 100] @ 0x"));
+}
+
+}  // namespace debug
+}  // namespace base
@@ -0,0 +1,118 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/stack_table.h"
+
+#include "base/debug/stack_trace.h"
+#include "base/logging.h"
+
+namespace base {
+namespace debug {
+
+const size_t StackTable::kNoStack = static_cast<size_t>(-1);
+
+StackTable::StackTable() {
+}
+
+StackTable::~StackTable() {
+}
+
+size_t StackTable::Intern(const void* const* frames, size_t count) {
+  // Intern the frames first, so that stacks are compared by frame index.
+  size_t offset = stack_frames_.size();
+  size_t hash = count;
+  for (size_t i = 0; i < count; ++i) {
+    uint32 index = InternFrame(frames[i]);
+    stack_frames_.push_back(index);
+    hash = hash * 31 + index;
+  }
+  const uint32* indices = count ? &stack_frames_[offset] : NULL;
+
+  std::pair<base::hash_map<size_t, size_t>::iterator, bool> inserted =
+      stacks_by_hash_.insert(std::make_pair(hash, stacks_.size()));
+  size_t* link = NULL;
+  if (!inserted.second) {
+    size_t id = inserted.first->second;
+    while (true) {
+      if (stacks_[id].hash == hash && StackEquals(id, indices, count)) {
+        // Known stack; drop the copy of its frames.
+        stack_frames_.resize(offset);
+        return id;
+      }
+      if (stacks_[id].next == kNoStack)
+        break;
+      id = stacks_[id].next;
+    }
+    link = &stacks_[id].next;
+  }
+
+  Stack stack;
+  stack.hash = hash;
+  stack.offset = offset;
+  stack.length = count;
+  stack.next = kNoStack;
+  size_t id = stacks_.size();
+  if (link)
+    *link = id;
+  stacks_.push_back(stack);
+  return id;
+}
+
+void StackTable::GetStack(size_t id, std::vector<const void*>* frames) const {
+  DCHECK_LT(id, stacks_.size());
+  const Stack& stack = stacks_[id];
+  frames->resize(stack.length);
+  for (size_t i = 0; i < stack.length; ++i)
+    (*frames)[i] = frames_[stack_frames_[stack.offset + i]];
+}
+
+void StackTable::GetStackFrameIndices(
+    size_t id,
+    std::vector<uint32>* frame_indices) const {
+  DCHECK_LT(id, stacks_.size());
+  const Stack& stack = stacks_[id];
+  frame_indices->assign(stack_frames_.begin() + stack.offset,
+                        stack_frames_.begin() + stack.offset + stack.length);
+}
+
+void StackTable::Symbolize(std::vector<std::string>* symbols) const {
+  if (frames_.empty()) {
+    symbols->clear();
+    return;
+  }
+  StackTrace::SymbolizeAddresses(&frames_[0], frames_.size(), symbols);
+}
+
+void StackTable::Clear() {
+  frames_.clear();
+  frame_indices_.clear();
+  stack_frames_.clear();
+  stacks_.clear();
+  stacks_by_hash_.clear();
+}
+
+uint32 StackTable::InternFrame(const void* frame) {
+  std::pair<base::hash_map<uintptr_t, uint32>::iterator, bool> inserted =
+      frame_indices_.insert(std::make_pair(reinterpret_cast<uintptr_t>(frame),
+                                           static_cast<uint32>(frames_.size())));
+  if (inserted.second)
+    frames_.push_back(frame);
+  return inserted.first->second;
+}
+
+bool StackTable::StackEquals(size_t id,
+                             const uint32* indices,
+                             size_t count) const {
+  const Stack& stack = stacks_[id];
+  if (stack.length != count)
+    return false;
+  for (size_t i = 0; i < count; ++i) {
+    if (stack_frames_[stack.offset + i] != indices[i])
+      return false;
+  }
+  return true;
+}
+
+}  // namespace debug
+}  // namespace base
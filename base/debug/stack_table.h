@@ -0,0 +1,99 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// StackTable gives dense ids to distinct call stacks, and keeps each distinct
+// program counter once.  Profilers that capture many stacks record only the
+// raw addresses from StackTrace while they run, and symbolize the frames of
+// the table in one batch when they report, through the symbol cache of
+// StackTrace::SymbolizeAddresses().
+//
+// EXAMPLE:
+//
+//   StackTrace trace;
+//   size_t count = 0;
+//   const void* const* frames = trace.Addresses(&count);
+//   size_t id = table.Intern(frames, count);
+//   ...
+//   std::vector<std::string> symbols;
+//   table.Symbolize(&symbols);
+//
+// StackTable is not thread safe.
+
+#ifndef BASE_DEBUG_STACK_TABLE_H_
+#define BASE_DEBUG_STACK_TABLE_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/hash_tables.h"
+
+namespace base {
+namespace debug {
+
+class BASE_EXPORT StackTable {
+ public:
+  StackTable();
+  ~StackTable();
+
+  // Returns the id of the stack of the |count| program counters at |frames|,
+  // innermost first, adding it if it is new.  Ids are given out from 0 up.
+  size_t Intern(const void* const* frames, size_t count);
+
+  // The number of distinct stacks.
+  size_t stack_count() const { return stacks_.size(); }
+
+  // Replaces |frames| with the program counters of stack |id|.
+  void GetStack(size_t id, std::vector<const void*>* frames) const;
+
+  // Replaces |frame_indices| with the indices in frames() of the program
+  // counters of stack |id|.
+  void GetStackFrameIndices(size_t id,
+                            std::vector<uint32>* frame_indices) const;
+
+  // The distinct program counters of all the stacks.
+  const std::vector<const void*>& frames() const { return frames_; }
+
+  // Replaces |symbols| with the symbols of frames(), in the same order.
+  void Symbolize(std::vector<std::string>* symbols) const;
+
+  // Forgets all the stacks.
+  void Clear();
+
+ private:
+  // Where the frames of a stack are in |stack_frames_|.
+  struct Stack {
+    size_t hash;
+    size_t offset;
+    size_t length;
+    // The next stack whose hash falls in the same bucket, or kNoStack.
+    size_t next;
+  };
+
+  static const size_t kNoStack;
+
+  // Returns the index of |frame| in |frames_|, adding it if it is new.
+  uint32 InternFrame(const void* frame);
+
+  // Whether stack |id| is made of the |count| frame indices at |indices|.
+  bool StackEquals(size_t id, const uint32* indices, size_t count) const;
+
+  std::vector<const void*> frames_;
+  base::hash_map<uintptr_t, uint32> frame_indices_;
+
+  // The frame indices of all the stacks, one after the other.
+  std::vector<uint32> stack_frames_;
+  std::vector<Stack> stacks_;
+  // The first stack of each hash.
+  base::hash_map<size_t, size_t> stacks_by_hash_;
+
+  DISALLOW_COPY_AND_ASSIGN(StackTable);
+};
+
+}  // namespace debug
+}  // namespace base
+
+#endif  // BASE_DEBUG_STACK_TABLE_H_
@@ -0,0 +1,80 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/stack_table.h"
+
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+const void* Frame(uintptr_t pc) {
+  return reinterpret_cast<const void*>(pc);
+}
+
+}  // namespace
+
+TEST(StackTableTest, InternDeduplicatesStacks) {
+  const void* a[] = { Frame(0x1000), Frame(0x2000), Frame(0x3000) };
+  const void* b[] = { Frame(0x1000), Frame(0x2000), Frame(0x4000) };
+  const void* c[] = { Frame(0x1000), Frame(0x2000) };
+
+  StackTable table;
+  EXPECT_EQ(0u, table.Intern(a, arraysize(a)));
+  EXPECT_EQ(1u, table.Intern(b, arraysize(b)));
+  EXPECT_EQ(2u, table.Intern(c, arraysize(c)));
+  EXPECT_EQ(0u, table.Intern(a, arraysize(a)));
+  EXPECT_EQ(2u, table.Intern(c, arraysize(c)));
+  EXPECT_EQ(3u, table.Intern(NULL, 0));
+  EXPECT_EQ(3u, table.Intern(NULL, 0));
+  EXPECT_EQ(4u, table.stack_count());
+
+  // Frames shared by the stacks are kept once.
+  EXPECT_EQ(4u, table.frames().size());
+
+  std::vector<const void*> frames;
+  table.GetStack(1, &frames);
+  EXPECT_EQ(std::vector<const void*>(b, b + arraysize(b)), frames);
+  table.GetStack(3, &frames);
+  EXPECT_TRUE(frames.empty());
+
+  std::vector<uint32> indices;
+  table.GetStackFrameIndices(2, &indices);
+  ASSERT_EQ(2u, indices.size());
+  EXPECT_EQ(c[0], table.frames()[indices[0]]);
+  EXPECT_EQ(c[1], table.frames()[indices[1]]);
+
+  table.Clear();
+  EXPECT_EQ(0u, table.stack_count());
+  EXPECT_TRUE(table.frames().empty());
+  EXPECT_EQ(0u, table.Intern(b, arraysize(b)));
+}
+
+TEST(StackTableTest, Symbolize) {
+  const void* a[] = { Frame(0x1000), Frame(0x2000) };
+  const void* b[] = { Frame(0x2000), Frame(0x3000) };
+
+  StackTable table;
+  table.Intern(a, arraysize(a));
+  table.Intern(b, arraysize(b));
+
+  std::vector<std::string> symbols;
+  table.Symbolize(&symbols);
+  ASSERT_EQ(3u, symbols.size());
+  for (size_t i = 0; i < symbols.size(); ++i)
+    EXPECT_FALSE(symbols[i].empty());
+
+  // The second time the symbols come from the cache.
+  std::vector<std::string> cached;
+  table.Symbolize(&cached);
+  EXPECT_EQ(symbols, cached);
+}
+
+}  // namespace debug
+}  // namespace base
@@ -4,16 +4,31 @@
 
 #include "base/debug/stack_trace.h"
 
-#include "base/basictypes.h"
-
 #include <string.h>
 
 #include <algorithm>
 #include <sstream>
 
+#include "base/basictypes.h"
+#include "base/hash_tables.h"
+#include "base/lazy_instance.h"
+#include "base/synchronization/lock.h"
+
 namespace base {
 namespace debug {
 
+namespace {
+
+// The symbols of the addresses given to StackTrace::SymbolizeAddresses().
+struct SymbolCache {
+  Lock lock;
+  base::hash_map<uintptr_t, std::string> symbols;
+};
+
+LazyInstance<SymbolCache>::Leaky g_symbol_cache = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
 StackTrace::StackTrace(const void* const* trace, size_t count) {
   count = std::min(count, arraysize(trace_));
   if (count)
@@ -37,5 +52,44 @@ std::string StackTrace::ToString() const {
   return stream.str();
 }
 
+// static
+void StackTrace::SymbolizeAddresses(const void* const* addresses,
+                                    size_t count,
+                                    std::vector<std::string>* symbols) {
+  SymbolCache* cache = g_symbol_cache.Pointer();
+  symbols->assign(count, std::string());
+
+  // Look up every address under the lock, and symbolize the misses in one
+  // batch outside of it, as symbolization can be slow.
+  std::vector<size_t> misses;
+  std::vector<const void*> miss_addresses;
+  {
+    AutoLock lock(cache->lock);
+    for (size_t i = 0; i < count; ++i) {
+      base::hash_map<uintptr_t, std::string>::const_iterator it =
+          cache->symbols.find(reinterpret_cast<uintptr_t>(addresses[i]));
+      if (it != cache->symbols.end()) {
+        (*symbols)[i] = it->second;
+      } else {
+        misses.push_back(i);
+        miss_addresses.push_back(addresses[i]);
+      }
+    }
+  }
+  if (misses.empty())
+    return;
+
+  std::vector<std::string> resolved;
+  SymbolizeUncached(&miss_addresses[0], miss_addresses.size(), &resolved);
+  resolved.resize(misses.size());
+
+  AutoLock lock(cache->lock);
+  for (size_t i = 0; i < misses.size(); ++i) {
+    (*symbols)[misses[i]] = resolved[i];
+    cache->symbols[reinterpret_cast<uintptr_t>(miss_addresses[i])] =
+        resolved[i];
+  }
+}
+
 }  // namespace debug
 }  // namespace base
@@ -8,6 +8,7 @@
 
 #include <iosfwd>
 #include <string>
+#include <vector>
 
 #include "base/base_export.h"
 #include "build/build_config.h"
@@ -56,7 +57,23 @@ class BASE_EXPORT StackTrace {
   // Resolves backtrace to symbols and returns as string.
   std::string ToString() const;
 
+  // Replaces |symbols| with the symbols of the |count| instruction pointers
+  // at |addresses|, one string per address.  Symbols are cached for the life
+  // of the process, so that profilers which keep only the addresses of their
+  // stacks can symbolize them in batches when they report.  Not for use on
+  // the crash path, as it allocates and takes a lock.
+  static void SymbolizeAddresses(const void* const* addresses,
+                                 size_t count,
+                                 std::vector<std::string>* symbols);
+
  private:
+  // Appends the symbols of the |count| instruction pointers at |addresses|
+  // to |symbols|, bypassing the cache.
+  static void SymbolizeUncached(const void* const* addresses,
+                                size_t count,
+                                std::vector<std::string>* symbols);
+
+
   // From http://msdn.microsoft.com/en-us/library/bb204633.aspx,
   // the sum of FramesToSkip and FramesToCapture must be less than 63,
   // so set it to 62. Even if on POSIX it could be a larger value, it usually
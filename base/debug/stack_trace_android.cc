@@ -9,6 +9,7 @@
 #include <unistd.h>
 
 #include "base/logging.h"
+#include "base/stringprintf.h"
 
 namespace base {
 namespace debug {
@@ -60,5 +61,22 @@ std::string StackTrace::ToString() const {
   return "";
 }
 
+// static
+void StackTrace::SymbolizeAddresses(const void* const* addresses,
+                                    size_t count,
+                                    std::vector<std::string>* symbols) {
+  // Symbols are only available through debuggerd, so report raw addresses.
+  symbols->clear();
+  SymbolizeUncached(addresses, count, symbols);
+}
+
+// static
+void StackTrace::SymbolizeUncached(const void* const* addresses,
+                                   size_t count,
+                                   std::vector<std::string>* symbols) {
+  for (size_t i = 0; i < count; ++i)
+    symbols->push_back(base::StringPrintf("%p", addresses[i]));
+}
+
 }  // namespace debug
 }  // namespace base
@@ -193,5 +193,20 @@ void StackTrace::OutputToStream(std::ostream* os) const {
   }
 }
 
+// static
+void StackTrace::SymbolizeUncached(const void* const* addresses,
+                                   size_t count,
+                                   std::vector<std::string>* symbols) {
+#if defined(OS_MACOSX) && MAC_OS_X_VERSION_MIN_REQUIRED < MAC_OS_X_VERSION_10_5
+  if (backtrace_symbols == NULL) {
+    for (size_t i = 0; i < count; ++i)
+      symbols->push_back(base::StringPrintf("%p", addresses[i]));
+    return;
+  }
+#endif
+  GetBacktraceStrings(const_cast<void* const*>(addresses),
+                      static_cast<int>(count), symbols, NULL);
+}
+
 }  // namespace debug
 }  // namespace base
@@ -8,10 +8,12 @@
 #include <dbghelp.h>
 
 #include <iostream>
+#include <sstream>
 
 #include "base/basictypes.h"
 #include "base/logging.h"
 #include "base/memory/singleton.h"
+#include "base/string_util.h"
 #include "base/synchronization/lock.h"
 
 namespace base {
@@ -206,5 +208,24 @@ void StackTrace::OutputToStream(std::ostream* os) const {
   }
 }
 
+// static
+void StackTrace::SymbolizeUncached(const void* const* addresses,
+                                   size_t count,
+                                   std::vector<std::string>* symbols) {
+  SymbolContext* context = SymbolContext::GetInstance();
+  for (size_t i = 0; i < count; ++i) {
+    std::ostringstream stream;
+    if (context->init_error() != ERROR_SUCCESS) {
+      stream << addresses[i];
+    } else {
+      context->OutputTraceToStream(&addresses[i], 1, &stream);
+    }
+    // Strip the tab and newline framing the line of the trace.
+    std::string symbol = stream.str();
+    TrimString(symbol, "\t\n", &symbol);
+    symbols->push_back(symbol);
+  }
+}
+
 }  // namespace debug
 }  // namespace base
@@ -572,7 +572,7 @@
             TRACE_EVENT_PHASE_BEGIN, \
             INTERNAL_TRACE_EVENT_UID(catstatic), \
             name, trace_event_internal::kNoEventId, \
-            TRACE_EVENT_FLAG_NONE, ##__VA_ARGS__); \
+            TRACE_EVENT_FLAG_THRESHOLD_BEGIN, ##__VA_ARGS__); \
       INTERNAL_TRACE_EVENT_UID(profileScope).Initialize( \
           INTERNAL_TRACE_EVENT_UID(catstatic), name, \
           INTERNAL_TRACE_EVENT_UID(begin_event_id), threshold); \
@@ -615,6 +615,9 @@
 #define TRACE_EVENT_FLAG_COPY        (static_cast<unsigned char>(1 << 0))
 #define TRACE_EVENT_FLAG_HAS_ID      (static_cast<unsigned char>(1 << 1))
 #define TRACE_EVENT_FLAG_MANGLE_ID   (static_cast<unsigned char>(1 << 2))
+// The begin event of a TRACE_EVENT_IF_LONGER_THAN pair, which the end event
+// may remove again.
+#define TRACE_EVENT_FLAG_THRESHOLD_BEGIN (static_cast<unsigned char>(1 << 3))
 
 // Type values for identifying types in the TraceValue union.
 #define TRACE_VALUE_TYPE_BOOL         (static_cast<unsigned char>(1))
@@ -0,0 +1,471 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/trace_event_binary.h"
+
+#include <string.h>
+
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/format_macros.h"
+#include "base/logging.h"
+#include "base/stringprintf.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+enum RecordTag {
+  RECORD_HEADER = 0,
+  RECORD_STRING = 1,
+  RECORD_EVENT = 2
+};
+
+const char kStreamMagic[] = "TRB";
+const unsigned char kStreamVersion = 1;
+
+void AppendVarint(uint64 value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+// Maps signed values to unsigned ones so that small magnitudes of either sign
+// make short varints.
+void AppendZigZag(int64 value, std::string* out) {
+  AppendVarint((static_cast<uint64>(value) << 1) ^
+                   static_cast<uint64>(value >> 63),
+               out);
+}
+
+void AppendDouble(double value, std::string* out) {
+  uint64 bits;
+  memcpy(&bits, &value, sizeof(bits));
+  for (int i = 0; i < 8; ++i)
+    out->push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+}
+
+// Reads the records of a stream, failing once it runs past the end.
+class StreamReader {
+ public:
+  explicit StreamReader(const std::string& stream)
+      : data_(stream.data()),
+        end_(stream.data() + stream.size()) {
+  }
+
+  bool at_end() const { return data_ == end_; }
+
+  bool ReadByte(unsigned char* value) {
+    if (data_ == end_)
+      return false;
+    *value = static_cast<unsigned char>(*data_++);
+    return true;
+  }
+
+  bool ReadVarint(uint64* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      unsigned char byte;
+      if (!ReadByte(&byte))
+        return false;
+      *value |= static_cast<uint64>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  bool ReadZigZag(int64* value) {
+    uint64 encoded;
+    if (!ReadVarint(&encoded))
+      return false;
+    *value = static_cast<int64>(encoded >> 1) ^
+             -static_cast<int64>(encoded & 1);
+    return true;
+  }
+
+  bool ReadDouble(double* value) {
+    uint64 bits = 0;
+    for (int i = 0; i < 8; ++i) {
+      unsigned char byte;
+      if (!ReadByte(&byte))
+        return false;
+      bits |= static_cast<uint64>(byte) << (8 * i);
+    }
+    memcpy(value, &bits, sizeof(bits));
+    return true;
+  }
+
+  bool ReadBytes(size_t length, std::string* value) {
+    if (static_cast<size_t>(end_ - data_) < length)
+      return false;
+    value->assign(data_, length);
+    data_ += length;
+    return true;
+  }
+
+ private:
+  const char* data_;
+  const char* end_;
+};
+
+// The strings a stream has defined so far.
+class StringTable {
+ public:
+  void Define(const std::string& str) { strings_.push_back(str); }
+  void Clear() { strings_.clear(); }
+
+  bool Lookup(uint64 index, const char** str) const {
+    if (index >= strings_.size())
+      return false;
+    *str = strings_[index].c_str();
+    return true;
+  }
+
+ private:
+  std::vector<std::string> strings_;
+};
+
+bool ReadString(StreamReader* reader,
+                const StringTable& strings,
+                const char** str) {
+  uint64 index;
+  return reader->ReadVarint(&index) && strings.Lookup(index, str);
+}
+
+bool ReadArgValue(StreamReader* reader,
+                  const StringTable& strings,
+                  unsigned char type,
+                  TraceEvent::TraceValue* value) {
+  uint64 uint_value;
+  int64 int_value;
+  unsigned char byte;
+  switch (type) {
+    case TRACE_VALUE_TYPE_BOOL:
+      if (!reader->ReadByte(&byte))
+        return false;
+      value->as_bool = !!byte;
+      return true;
+    case TRACE_VALUE_TYPE_UINT:
+      if (!reader->ReadVarint(&uint_value))
+        return false;
+      value->as_uint = uint_value;
+      return true;
+    case TRACE_VALUE_TYPE_INT:
+      if (!reader->ReadZigZag(&int_value))
+        return false;
+      value->as_int = int_value;
+      return true;
+    case TRACE_VALUE_TYPE_DOUBLE:
+      return reader->ReadDouble(&value->as_double);
+    case TRACE_VALUE_TYPE_POINTER:
+      if (!reader->ReadVarint(&uint_value))
+        return false;
+      value->as_pointer =
+          reinterpret_cast<const void*>(static_cast<uintptr_t>(uint_value));
+      return true;
+    case TRACE_VALUE_TYPE_STRING:
+    case TRACE_VALUE_TYPE_COPY_STRING:
+      if (!reader->ReadVarint(&uint_value))
+        return false;
+      value->as_string = NULL;
+      return uint_value == 0 || strings.Lookup(uint_value - 1,
+                                               &value->as_string);
+    default:
+      return false;
+  }
+}
+
+// Appends the JSON of the event |reader| is at, the same as
+// TraceEvent::AppendAsJSON() does.
+bool ConvertEvent(StreamReader* reader,
+                  const StringTable& strings,
+                  int process_id,
+                  int64* timestamp,
+                  std::string* out) {
+  unsigned char phase;
+  unsigned char flags;
+  const char* category;
+  const char* name;
+  int64 thread_id;
+  int64 delta;
+  if (!reader->ReadByte(&phase) ||
+      !reader->ReadByte(&flags) ||
+      !ReadString(reader, strings, &category) ||
+      !ReadString(reader, strings, &name) ||
+      !reader->ReadZigZag(&thread_id) ||
+      !reader->ReadZigZag(&delta)) {
+    return false;
+  }
+  *timestamp += delta;
+  uint64 id = 0;
+  if ((flags & TRACE_EVENT_FLAG_HAS_ID) && !reader->ReadVarint(&id))
+    return false;
+
+  StringAppendF(out,
+      "{\"cat\":\"%s\",\"pid\":%i,\"tid\":%i,\"ts\":%" PRId64 ","
+      "\"ph\":\"%c\",\"name\":\"%s\",\"args\":{",
+      category,
+      process_id,
+      static_cast<int>(thread_id),
+      *timestamp,
+      phase,
+      name);
+
+  unsigned char num_args;
+  if (!reader->ReadByte(&num_args) || num_args > kTraceMaxNumArgs)
+    return false;
+  for (int i = 0; i < num_args; ++i) {
+    const char* arg_name;
+    unsigned char type;
+    TraceEvent::TraceValue value;
+    if (!ReadString(reader, strings, &arg_name) ||
+        !reader->ReadByte(&type) ||
+        !ReadArgValue(reader, strings, type, &value)) {
+      return false;
+    }
+    if (i > 0)
+      *out += ",";
+    *out += "\"";
+    *out += arg_name;
+    *out += "\":";
+    TraceEvent::AppendValueAsJSON(type, value, out);
+  }
+  *out += "}";
+
+  if (flags & TRACE_EVENT_FLAG_HAS_ID)
+    StringAppendF(out, ",\"id\":\"%" PRIx64 "\"", id);
+  *out += "}";
+  return true;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// TraceBinaryWriter
+//
+////////////////////////////////////////////////////////////////////////////////
+
+TraceBinaryWriter::TraceBinaryWriter(int process_id)
+    : process_id_(process_id),
+      wrote_header_(false),
+      previous_timestamp_(0) {
+}
+
+TraceBinaryWriter::~TraceBinaryWriter() {
+}
+
+void TraceBinaryWriter::AppendEvents(const std::vector<TraceEvent>& events,
+                                     size_t start,
+                                     size_t count,
+                                     std::string* out) {
+  if (!wrote_header_) {
+    out->push_back(static_cast<char>(RECORD_HEADER));
+    out->append(kStreamMagic, arraysize(kStreamMagic) - 1);
+    out->push_back(static_cast<char>(kStreamVersion));
+    AppendZigZag(process_id_, out);
+    wrote_header_ = true;
+  }
+  for (size_t i = 0; i < count && start + i < events.size(); ++i)
+    AppendEvent(events[start + i], out);
+}
+
+void TraceBinaryWriter::AppendEvent(const TraceEvent& event,
+                                    std::string* out) {
+  // Define the strings first, so that the event record is all in one piece.
+  uint64 category =
+      InternString(TraceLog::GetCategoryName(event.category_enabled_), out);
+  uint64 name = InternString(event.name_, out);
+  int num_args = 0;
+  uint64 arg_names[kTraceMaxNumArgs];
+  uint64 arg_strings[kTraceMaxNumArgs];
+  for (; num_args < kTraceMaxNumArgs && event.arg_names_[num_args];
+       ++num_args) {
+    arg_names[num_args] = InternString(event.arg_names_[num_args], out);
+    unsigned char type = event.arg_types_[num_args];
+    if (type == TRACE_VALUE_TYPE_STRING ||
+        type == TRACE_VALUE_TYPE_COPY_STRING) {
+      const char* value = event.arg_values_[num_args].as_string;
+      arg_strings[num_args] = value ? InternString(value, out) + 1 : 0;
+    }
+  }
+
+  int64 timestamp = event.timestamp_.ToInternalValue();
+  out->push_back(static_cast<char>(RECORD_EVENT));
+  out->push_back(event.phase_);
+  out->push_back(static_cast<char>(event.flags_));
+  AppendVarint(category, out);
+  AppendVarint(name, out);
+  AppendZigZag(event.thread_id_, out);
+  AppendZigZag(timestamp - previous_timestamp_, out);
+  previous_timestamp_ = timestamp;
+  if (event.flags_ & TRACE_EVENT_FLAG_HAS_ID)
+    AppendVarint(event.id_, out);
+
+  out->push_back(static_cast<char>(num_args));
+  for (int i = 0; i < num_args; ++i) {
+    unsigned char type = event.arg_types_[i];
+    const TraceEvent::TraceValue& value = event.arg_values_[i];
+    AppendVarint(arg_names[i], out);
+    out->push_back(static_cast<char>(type));
+    switch (type) {
+      case TRACE_VALUE_TYPE_BOOL:
+        out->push_back(value.as_bool ? 1 : 0);
+        break;
+      case TRACE_VALUE_TYPE_UINT:
+        AppendVarint(value.as_uint, out);
+        break;
+      case TRACE_VALUE_TYPE_INT:
+        AppendZigZag(value.as_int, out);
+        break;
+      case TRACE_VALUE_TYPE_DOUBLE:
+        AppendDouble(value.as_double, out);
+        break;
+      case TRACE_VALUE_TYPE_POINTER:
+        AppendVarint(reinterpret_cast<uintptr_t>(value.as_pointer), out);
+        break;
+      case TRACE_VALUE_TYPE_STRING:
+      case TRACE_VALUE_TYPE_COPY_STRING:
+        AppendVarint(arg_strings[i], out);
+        break;
+      default:
+        NOTREACHED() << "Don't know how to encode this value";
+        AppendVarint(0, out);
+        break;
+    }
+  }
+}
+
+uint64 TraceBinaryWriter::InternString(const char* str, std::string* out) {
+  std::pair<base::hash_map<std::string, uint64>::iterator, bool> result =
+      string_indices_.insert(std::make_pair(std::string(str),
+                                            string_indices_.size()));
+  if (result.second) {
+    size_t length = result.first->first.size();
+    out->push_back(static_cast<char>(RECORD_STRING));
+    AppendVarint(length, out);
+    out->append(str, length);
+  }
+  return result.first->second;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// ConvertBinaryTraceToJSON
+//
+////////////////////////////////////////////////////////////////////////////////
+
+bool ConvertBinaryTraceToJSON(const std::string& stream,
+                              std::string* json_out) {
+  StreamReader reader(stream);
+  StringTable strings;
+  bool has_header = false;
+  int process_id = 0;
+  int64 timestamp = 0;
+  bool append_comma = false;
+  std::string json("[");
+  while (!reader.at_end()) {
+    unsigned char tag;
+    reader.ReadByte(&tag);
+    switch (tag) {
+      case RECORD_HEADER: {
+        std::string magic;
+        unsigned char version;
+        int64 pid;
+        if (!reader.ReadBytes(arraysize(kStreamMagic) - 1, &magic) ||
+            magic != kStreamMagic ||
+            !reader.ReadByte(&version) || version != kStreamVersion ||
+            !reader.ReadZigZag(&pid)) {
+          return false;
+        }
+        has_header = true;
+        process_id = static_cast<int>(pid);
+        timestamp = 0;
+        strings.Clear();
+        break;
+      }
+      case RECORD_STRING: {
+        uint64 length;
+        std::string str;
+        if (!has_header || !reader.ReadVarint(&length) ||
+            !reader.ReadBytes(static_cast<size_t>(length), &str)) {
+          return false;
+        }
+        strings.Define(str);
+        break;
+      }
+      case RECORD_EVENT:
+        if (!has_header)
+          return false;
+        if (append_comma)
+          json += ",";
+        append_comma = true;
+        if (!ConvertEvent(&reader, strings, process_id, &timestamp, &json))
+          return false;
+        break;
+      default:
+        return false;
+    }
+  }
+  json += "]";
+  json_out->swap(json);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// TraceBinaryFileSink
+//
+////////////////////////////////////////////////////////////////////////////////
+
+TraceBinaryFileSink::TraceBinaryFileSink(FILE* file)
+    : file_(file),
+      failed_(false) {
+  DCHECK(file_);
+}
+
+TraceBinaryFileSink::~TraceBinaryFileSink() {
+  Stop();
+}
+
+void TraceBinaryFileSink::Start(const TimeDelta& flush_interval) {
+  TraceLog* trace_log = TraceLog::GetInstance();
+  trace_log->SetOutputFormat(TraceLog::OUTPUT_FORMAT_BINARY);
+  trace_log->SetOutputCallback(
+      Bind(&TraceBinaryFileSink::OnTraceDataCollected, Unretained(this)));
+  flush_timer_.Start(FROM_HERE, flush_interval, this,
+                     &TraceBinaryFileSink::FlushTraceLog);
+}
+
+void TraceBinaryFileSink::Stop() {
+  if (!flush_timer_.IsRunning())
+    return;
+  flush_timer_.Stop();
+  TraceLog* trace_log = TraceLog::GetInstance();
+  if (!trace_log)
+    return;
+  trace_log->SetOutputCallback(TraceLog::OutputCallback());
+  if (!trace_log->IsEnabled())
+    trace_log->SetOutputFormat(TraceLog::OUTPUT_FORMAT_JSON);
+}
+
+void TraceBinaryFileSink::FlushTraceLog() {
+  TraceLog::GetInstance()->Flush();
+}
+
+void TraceBinaryFileSink::OnTraceDataCollected(
+    const scoped_refptr<RefCountedString>& chunk) {
+  const std::string& data = chunk->data();
+  if (fwrite(data.data(), 1, data.size(), file_) != data.size() ||
+      fflush(file_) != 0) {
+    failed_ = true;
+  }
+}
+
+}  // namespace debug
+}  // namespace base
@@ -0,0 +1,128 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A compact binary encoding of trace events, for traces that are too large to
+// hold in memory or to serialize as JSON while tracing runs.
+//
+// A stream is a sequence of records, each starting with a tag byte:
+//   HEADER  "TRB" <version byte> <zigzag varint process id>
+//           Starts a stream and forgets all the strings defined so far.
+//   STRING  <varint length> <bytes>
+//           Defines the next string index, counting up from 0.
+//   EVENT   <phase byte> <flags byte> <varint category string>
+//           <varint name string> <zigzag varint thread id>
+//           <zigzag varint microseconds since the previous event>
+//           [<varint id> if TRACE_EVENT_FLAG_HAS_ID] <num args byte>
+//           then per argument <varint name string> <type byte> <value>
+// Strings are defined once, before the first record that uses them, and are
+// referred to by index from then on.  Argument values are a byte for bools,
+// varints for unsigned ints and pointers, zigzag varints for ints, eight
+// little-endian bytes for doubles, and a string index plus one for strings,
+// with 0 for NULL.
+//
+// TraceLog hands out a stream in chunks once it is asked to with
+// SetOutputFormat(TraceLog::OUTPUT_FORMAT_BINARY); the chunks concatenate
+// back to the stream.
+
+#ifndef BASE_DEBUG_TRACE_EVENT_BINARY_H_
+#define BASE_DEBUG_TRACE_EVENT_BINARY_H_
+#pragma once
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/debug/trace_event_impl.h"
+#include "base/hash_tables.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/time.h"
+#include "base/timer.h"
+
+namespace base {
+namespace debug {
+
+// Encodes TraceEvents as one binary stream.  Not thread safe.
+class BASE_EXPORT TraceBinaryWriter {
+ public:
+  explicit TraceBinaryWriter(int process_id);
+  ~TraceBinaryWriter();
+
+  // Appends the encoding of up to |count| events of |events| from |start| on
+  // to |out|, preceded by the stream header if this is the first call.
+  void AppendEvents(const std::vector<TraceEvent>& events,
+                    size_t start,
+                    size_t count,
+                    std::string* out);
+
+ private:
+  void AppendEvent(const TraceEvent& event, std::string* out);
+
+  // Returns the index of |str|, appending its definition to |out| if it has
+  // none yet.
+  uint64 InternString(const char* str, std::string* out);
+
+  int process_id_;
+  bool wrote_header_;
+  int64 previous_timestamp_;
+  base::hash_map<std::string, uint64> string_indices_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceBinaryWriter);
+};
+
+// Converts a binary |stream| to the JSON array TraceResultBuffer produces
+// from the JSON output of the same events.  Returns false if |stream| is
+// malformed or truncated.
+BASE_EXPORT bool ConvertBinaryTraceToJSON(const std::string& stream,
+                                          std::string* json_out);
+
+// Streams the binary trace to a file or a pipe as it is recorded.  Start()
+// points TraceLog's output callback at the sink and flushes the TraceLog
+// every |flush_interval| from the current thread's MessageLoop, so the trace
+// does not pile up in memory.
+//
+// EXAMPLE:
+//
+//   TraceBinaryFileSink sink(file);
+//   sink.Start(TimeDelta::FromSeconds(1));
+//   TraceLog::GetInstance()->SetEnabled(true);
+//   ...
+//   TraceLog::GetInstance()->SetEnabled(false);  // Writes the last chunk.
+//   sink.Stop();
+class BASE_EXPORT TraceBinaryFileSink {
+ public:
+  // |file| is not owned and must outlive the sink.
+  explicit TraceBinaryFileSink(FILE* file);
+  ~TraceBinaryFileSink();
+
+  // Must be called while tracing is disabled.
+  void Start(const TimeDelta& flush_interval);
+
+  // Stops the flushes and detaches the sink from TraceLog.  Call it after
+  // tracing was disabled to get the end of the trace.
+  void Stop();
+
+  // Whether writing to the file failed.  Only meaningful after Stop().
+  bool failed() const { return failed_; }
+
+ private:
+  void FlushTraceLog();
+  void OnTraceDataCollected(const scoped_refptr<RefCountedString>& chunk);
+
+  FILE* file_;
+  // Only written by OnTraceDataCollected(), which TraceLog runs one at a
+  // time.
+  bool failed_;
+  RepeatingTimer<TraceBinaryFileSink> flush_timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceBinaryFileSink);
+};
+
+}  // namespace debug
+}  // namespace base
+
+#endif  // BASE_DEBUG_TRACE_EVENT_BINARY_H_
@@ -0,0 +1,171 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/trace_event_binary.h"
+
+#include "base/at_exit.h"
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+class TraceEventBinaryTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    TraceLog::DeleteForTesting();
+    TraceLog::Resurrect();
+    ASSERT_TRUE(TraceLog::GetInstance());
+  }
+
+  // Logs events with all kinds of arguments and returns them.
+  void TraceSomeEvents(std::vector<TraceEvent>* events) {
+    TraceLog* trace_log = TraceLog::GetInstance();
+    trace_log->SetEnabled(true);
+    TRACE_EVENT_INSTANT0("binary", "no args");
+    TRACE_EVENT_INSTANT2("binary", "numbers", "int", -42, "uint", 1u << 31);
+    TRACE_EVENT_INSTANT2("binary", "mixed", "double", 3.25,
+                         "bool", true);
+    TRACE_EVENT_INSTANT2("binary", "strings", "static", "some \"text\"",
+                         "copied", std::string("copied text"));
+    TRACE_EVENT_INSTANT1("binary", "pointer", "this", this);
+    TRACE_EVENT_COPY_BEGIN0("binary", std::string("copied name").c_str());
+    TRACE_EVENT_ASYNC_BEGIN0("binary", "async", 0x1234);
+    TRACE_EVENT_ASYNC_END0("binary", "async", 0x1234);
+    TRACE_EVENT_INSTANT2("binary", "numbers", "int", 7, "uint", 0u);
+    for (size_t i = 0; i < trace_log->GetEventsSize(); ++i)
+      events->push_back(trace_log->GetEventAt(i));
+    trace_log->SetEnabled(false);
+  }
+
+ private:
+  // We want our singleton torn down after each test.
+  ShadowingAtExitManager at_exit_manager_;
+};
+
+std::string EventsAsJSON(const std::vector<TraceEvent>& events) {
+  std::string json("[");
+  TraceEvent::AppendEventsAsJSON(events, 0, events.size(), &json);
+  json += "]";
+  return json;
+}
+
+void QuitCurrentLoop() {
+  MessageLoop::current()->Quit();
+}
+
+}  // namespace
+
+TEST_F(TraceEventBinaryTest, ConvertsToTheSameJSON) {
+  std::vector<TraceEvent> events;
+  TraceSomeEvents(&events);
+  ASSERT_EQ(9u, events.size());
+
+  TraceBinaryWriter writer(TraceLog::GetInstance()->process_id());
+  std::string stream;
+  writer.AppendEvents(events, 0, events.size(), &stream);
+  std::string json;
+  ASSERT_TRUE(ConvertBinaryTraceToJSON(stream, &json));
+  EXPECT_EQ(EventsAsJSON(events), json);
+
+  // Strings are only written once.
+  EXPECT_EQ(std::string::npos,
+            stream.find("numbers", stream.find("numbers") + 1));
+}
+
+TEST_F(TraceEventBinaryTest, ChunksConcatenate) {
+  std::vector<TraceEvent> events;
+  TraceSomeEvents(&events);
+
+  TraceBinaryWriter writer(TraceLog::GetInstance()->process_id());
+  std::string stream;
+  for (size_t i = 0; i < events.size(); i += 2) {
+    std::string chunk;
+    writer.AppendEvents(events, i, 2, &chunk);
+    stream += chunk;
+  }
+  std::string json;
+  ASSERT_TRUE(ConvertBinaryTraceToJSON(stream, &json));
+  EXPECT_EQ(EventsAsJSON(events), json);
+
+  // A second stream may follow the first one.
+  TraceBinaryWriter second_writer(TraceLog::GetInstance()->process_id());
+  second_writer.AppendEvents(events, 0, events.size(), &stream);
+  std::vector<TraceEvent> both(events);
+  both.insert(both.end(), events.begin(), events.end());
+  ASSERT_TRUE(ConvertBinaryTraceToJSON(stream, &json));
+  EXPECT_EQ(EventsAsJSON(both), json);
+}
+
+TEST_F(TraceEventBinaryTest, RejectsMalformedStreams) {
+  std::vector<TraceEvent> events;
+  TraceSomeEvents(&events);
+
+  TraceBinaryWriter writer(TraceLog::GetInstance()->process_id());
+  std::string stream;
+  writer.AppendEvents(events, 0, events.size(), &stream);
+
+  std::string json;
+  EXPECT_FALSE(ConvertBinaryTraceToJSON(stream.substr(0, stream.size() - 1),
+                                        &json));
+  EXPECT_FALSE(ConvertBinaryTraceToJSON(stream.substr(1), &json));
+  EXPECT_TRUE(ConvertBinaryTraceToJSON(std::string(), &json));
+  EXPECT_EQ("[]", json);
+}
+
+TEST_F(TraceEventBinaryTest, FileSinkStreamsWhileTracing) {
+  MessageLoop loop;
+  FilePath path;
+  FILE* file = file_util::CreateAndOpenTemporaryFile(&path);
+  ASSERT_TRUE(file);
+
+  TraceBinaryFileSink sink(file);
+  sink.Start(TimeDelta::FromMilliseconds(1));
+  TraceLog::GetInstance()->SetEnabled(true);
+  TRACE_EVENT_INSTANT0("binary", "before flush");
+  loop.PostDelayedTask(FROM_HERE, Bind(&QuitCurrentLoop),
+                       TimeDelta::FromMilliseconds(50));
+  loop.Run();
+  // The trace was written out as tracing went on.
+  EXPECT_GT(ftell(file), 0);
+  TRACE_EVENT_INSTANT0("binary", "after flush");
+  TraceLog::GetInstance()->SetEnabled(false);
+  sink.Stop();
+  EXPECT_FALSE(sink.failed());
+  fclose(file);
+
+  std::string stream;
+  ASSERT_TRUE(file_util::ReadFileToString(path, &stream));
+  file_util::Delete(path, false);
+  std::string json;
+  ASSERT_TRUE(ConvertBinaryTraceToJSON(stream, &json));
+  scoped_ptr<Value> root(JSONReader::Read(json));
+  ASSERT_TRUE(root.get());
+  ListValue* events = NULL;
+  ASSERT_TRUE(root->GetAsList(&events));
+  bool found_before = false;
+  bool found_after = false;
+  for (size_t i = 0; i < events->GetSize(); ++i) {
+    DictionaryValue* event = NULL;
+    std::string name;
+    ASSERT_TRUE(events->GetDictionary(i, &event));
+    ASSERT_TRUE(event->GetString("name", &name));
+    found_before |= name == "before flush";
+    found_after |= name == "after flush";
+  }
+  EXPECT_TRUE(found_before);
+  EXPECT_TRUE(found_after);
+}
+
+}  // namespace debug
+}  // namespace base
@@ -8,6 +8,7 @@
 
 #include "base/bind.h"
 #include "base/debug/trace_event.h"
+#include "base/debug/trace_event_binary.h"
 #include "base/file_util.h"
 #include "base/format_macros.h"
 #include "base/lazy_instance.h"
@@ -15,8 +16,10 @@
 #include "base/process_util.h"
 #include "base/stringprintf.h"
 #include "base/string_tokenizer.h"
+#include "base/synchronization/rw_lock.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/thread_local.h"
+#include "base/threading/thread_local_storage.h"
 #include "base/utf_string_conversions.h"
 #include "base/stl_util.h"
 #include "base/sys_info.h"
@@ -42,6 +45,9 @@ namespace debug {
 // before throwing them away.
 const size_t kTraceEventBufferSize = 500000;
 const size_t kTraceEventBatchSize = 1000;
+// The number of events a thread buffers before it takes the TraceLog's lock
+// to hand them in.
+const int kTraceEventChunkSize = 64;
 
 #define TRACE_EVENT_MAX_CATEGORIES 100
 
@@ -68,50 +74,29 @@ int g_category_index = 3; // skip initial 3 categories
 LazyInstance<ThreadLocalPointer<const char> >::Leaky
     g_current_thread_name = LAZY_INSTANCE_INITIALIZER;
 
-void AppendValueAsJSON(unsigned char type,
-                       TraceEvent::TraceValue value,
-                       std::string* out) {
-  std::string::size_type start_pos;
-  switch (type) {
-    case TRACE_VALUE_TYPE_BOOL:
-      *out += value.as_bool ? "true" : "false";
-      break;
-    case TRACE_VALUE_TYPE_UINT:
-      StringAppendF(out, "%" PRIu64, static_cast<uint64>(value.as_uint));
-      break;
-    case TRACE_VALUE_TYPE_INT:
-      StringAppendF(out, "%" PRId64, static_cast<int64>(value.as_int));
-      break;
-    case TRACE_VALUE_TYPE_DOUBLE:
-      StringAppendF(out, "%f", value.as_double);
-      break;
-    case TRACE_VALUE_TYPE_POINTER:
-      // JSON only supports double and int numbers.
-      // So as not to lose bits from a 64-bit pointer, output as a hex string.
-      StringAppendF(out, "\"%" PRIx64 "\"", static_cast<uint64>(
-                                     reinterpret_cast<intptr_t>(
-                                     value.as_pointer)));
-      break;
-    case TRACE_VALUE_TYPE_STRING:
-    case TRACE_VALUE_TYPE_COPY_STRING:
-      *out += "\"";
-      start_pos = out->size();
-      *out += value.as_string ? value.as_string : "NULL";
-      // insert backslash before special characters for proper json format.
-      while ((start_pos = out->find_first_of("\\\"", start_pos)) !=
-             std::string::npos) {
-        out->insert(start_pos, 1, '\\');
-        // skip inserted escape character and following character.
-        start_pos += 2;
-      }
-      *out += "\"";
-      break;
-    default:
-      NOTREACHED() << "Don't know how to print this value";
-      break;
-  }
+// Source of TraceLog::generation_, shared by all the TraceLog instances that
+// tests create so that a thread never mistakes one for another.
+base::subtle::Atomic32 g_next_generation = 0;
+
+int NextGeneration() {
+  return base::subtle::NoBarrier_AtomicIncrement(&g_next_generation, 1);
 }
 
+// Matches the events that took place before |cutoff|.  Metadata events have
+// no timestamp and are always kept.
+class EventIsOlderThan {
+ public:
+  explicit EventIsOlderThan(TimeTicks cutoff) : cutoff_(cutoff) {}
+
+  bool operator()(const TraceEvent& event) const {
+    return event.phase() != TRACE_EVENT_PHASE_METADATA &&
+           event.timestamp() < cutoff_;
+  }
+
+ private:
+  TimeTicks cutoff_;
+};
+
 }  // namespace
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -234,6 +219,51 @@ void TraceEvent::AppendEventsAsJSON(const std::vector<TraceEvent>& events,
   }
 }
 
+// static
+void TraceEvent::AppendValueAsJSON(unsigned char type,
+                                   TraceValue value,
+                                   std::string* out) {
+  std::string::size_type start_pos;
+  switch (type) {
+    case TRACE_VALUE_TYPE_BOOL:
+      *out += value.as_bool ? "true" : "false";
+      break;
+    case TRACE_VALUE_TYPE_UINT:
+      StringAppendF(out, "%" PRIu64, static_cast<uint64>(value.as_uint));
+      break;
+    case TRACE_VALUE_TYPE_INT:
+      StringAppendF(out, "%" PRId64, static_cast<int64>(value.as_int));
+      break;
+    case TRACE_VALUE_TYPE_DOUBLE:
+      StringAppendF(out, "%f", value.as_double);
+      break;
+    case TRACE_VALUE_TYPE_POINTER:
+      // JSON only supports double and int numbers.
+      // So as not to lose bits from a 64-bit pointer, output as a hex string.
+      StringAppendF(out, "\"%" PRIx64 "\"", static_cast<uint64>(
+                                     reinterpret_cast<intptr_t>(
+                                     value.as_pointer)));
+      break;
+    case TRACE_VALUE_TYPE_STRING:
+    case TRACE_VALUE_TYPE_COPY_STRING:
+      *out += "\"";
+      start_pos = out->size();
+      *out += value.as_string ? value.as_string : "NULL";
+      // insert backslash before special characters for proper json format.
+      while ((start_pos = out->find_first_of("\\\"", start_pos)) !=
+             std::string::npos) {
+        out->insert(start_pos, 1, '\\');
+        // skip inserted escape character and following character.
+        start_pos += 2;
+      }
+      *out += "\"";
+      break;
+    default:
+      NOTREACHED() << "Don't know how to print this value";
+      break;
+  }
+}
+
 void TraceEvent::AppendAsJSON(std::string* out) const {
   int64 time_int64 = timestamp_.ToInternalValue();
   int process_id = TraceLog::GetInstance()->process_id();
@@ -310,6 +340,78 @@ void TraceResultBuffer::Finish() {
   output_callback_.Run("]");
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// ThreadLocalEventBuffer
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// A chunk of events that one thread logs to without taking any lock.  Only
+// that thread writes to the buffer.  TraceLog::lock_ guards the parts other
+// threads read: the events below |size_| that were not collected yet.
+class ThreadLocalEventBuffer {
+ public:
+  ThreadLocalEventBuffer() : size_(0), generation_(-1), num_collected_(0) {}
+
+  // Called on the owning thread only.
+  void Append(const TraceEvent& event) {
+    base::subtle::Atomic32 size = base::subtle::NoBarrier_Load(&size_);
+    DCHECK_LT(size, kTraceEventChunkSize);
+    events_[size] = event;
+    // Publishes the event to TraceLog::CollectEventsLocked().
+    base::subtle::Release_Store(&size_, size + 1);
+  }
+
+  bool IsFull() const {
+    return base::subtle::NoBarrier_Load(&size_) == kTraceEventChunkSize;
+  }
+
+  // ThreadLocalStorage destructor of the buffer.
+  static void OnThreadExit(void* buffer) {
+    ThreadLocalEventBuffer* event_buffer =
+        static_cast<ThreadLocalEventBuffer*>(buffer);
+    TraceLog* trace_log = TraceLog::GetInstance();
+    if (trace_log)
+      trace_log->ReleaseThreadLocalEventBuffer(event_buffer);
+    delete event_buffer;
+  }
+
+ private:
+  friend class TraceLog;
+
+  // Empties the buffer.  Called on the owning thread only, with
+  // TraceLog::lock_ held.
+  void Reset() {
+    base::subtle::Atomic32 size = base::subtle::NoBarrier_Load(&size_);
+    for (int i = 0; i < size; ++i)
+      events_[i] = TraceEvent();
+    base::subtle::NoBarrier_Store(&size_, 0);
+    num_collected_ = 0;
+  }
+
+  TraceEvent events_[kTraceEventChunkSize];
+  // The number of events logged to the buffer.
+  base::subtle::Atomic32 size_;
+  // The TraceLog::generation_ the buffer was set up for.
+  int generation_;
+  // The number of events already copied to TraceLog::logged_events_.
+  int num_collected_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadLocalEventBuffer);
+};
+
+namespace {
+
+struct ThreadLocalEventBufferSlot {
+  ThreadLocalEventBufferSlot() : slot(&ThreadLocalEventBuffer::OnThreadExit) {}
+  ThreadLocalStorage::Slot slot;
+};
+
+LazyInstance<ThreadLocalEventBufferSlot>::Leaky
+    g_thread_local_event_buffer = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // TraceLog
@@ -323,6 +425,14 @@ TraceLog* TraceLog::GetInstance() {
 
 TraceLog::TraceLog()
     : enabled_(false)
+    , output_format_(OUTPUT_FORMAT_JSON)
+    , binary_writer_generation_(-1)
+    , record_mode_(RECORD_UNTIL_FULL)
+    , num_dropped_events_(0)
+    , buffer_is_full_(0)
+    , generation_(NextGeneration())
+    , lock_contention_at_start_(0)
+    , rw_lock_contention_at_start_(0)
     , dispatching_to_observer_list_(false) {
   // Trace is enabled or disabled on one thread while other threads are
   // accessing the enabled flag. We don't care whether edge-case events are
@@ -448,6 +558,11 @@ void TraceLog::SetEnabled(const std::vector<std::string>& included_categories,
   dispatching_to_observer_list_ = false;
 
   logged_events_.reserve(1024);
+  num_dropped_events_ = 0;
+  base::subtle::NoBarrier_Store(&buffer_is_full_, 0);
+  // Threads set their buffers up again as they log their first event.
+  base::subtle::NoBarrier_Store(&generation_, NextGeneration());
+  thread_buffers_.clear();
   enabled_ = true;
   included_categories_ = included_categories;
   excluded_categories_ = excluded_categories;
@@ -457,6 +572,8 @@ void TraceLog::SetEnabled(const std::vector<std::string>& included_categories,
     EnableMatchingCategories(included_categories_, 1);
   else
     EnableMatchingCategories(excluded_categories_, 0);
+  lock_contention_at_start_ = Lock::GetContentionCount();
+  rw_lock_contention_at_start_ = RWLock::GetContentionCount();
 }
 
 void TraceLog::SetEnabled(const std::string& categories) {
@@ -491,6 +608,9 @@ void TraceLog::GetEnabledTraceCategories(
 }
 
 void TraceLog::SetDisabled() {
+  // This logs through the trace macros, so it must run before |lock_| is
+  // taken.
+  AddLockContentionCounterEvent();
   {
     AutoLock lock(lock_);
     if (!enabled_)
@@ -518,6 +638,13 @@ void TraceLog::SetDisabled() {
   Flush();
 }
 
+void TraceLog::SetRecordMode(RecordMode mode, const TimeDelta& window) {
+  AutoLock lock(lock_);
+  DCHECK(!enabled_) << "Cannot change the record mode while tracing";
+  record_mode_ = mode;
+  record_window_ = window;
+}
+
 void TraceLog::SetEnabled(bool enabled) {
   if (enabled)
     SetEnabled(std::vector<std::string>(), std::vector<std::string>());
@@ -543,33 +670,67 @@ void TraceLog::SetOutputCallback(const TraceLog::OutputCallback& cb) {
   output_callback_ = cb;
 }
 
+void TraceLog::SetOutputFormat(OutputFormat format) {
+  AutoLock lock(lock_);
+  DCHECK(!enabled_) << "Cannot change the output format while tracing";
+  output_format_ = format;
+}
+
 void TraceLog::SetBufferFullCallback(const TraceLog::BufferFullCallback& cb) {
   AutoLock lock(lock_);
   buffer_full_callback_ = cb;
 }
 
 void TraceLog::Flush() {
+  AutoLock flush_lock(flush_lock_);
   std::vector<TraceEvent> previous_logged_events;
   OutputCallback output_callback_copy;
+  OutputFormat output_format;
+  int generation;
   {
     AutoLock lock(lock_);
+    CollectAllEventsLocked();
+    if (record_mode_ == RECORD_CONTINUOUSLY) {
+      TimeTicks cutoff = TimeTicks::NowFromSystemTraceTime() - record_window_;
+      logged_events_.erase(std::remove_if(logged_events_.begin(),
+                                          logged_events_.end(),
+                                          EventIsOlderThan(cutoff)),
+                           logged_events_.end());
+    }
     previous_logged_events.swap(logged_events_);
+    num_dropped_events_ = 0;
+    base::subtle::NoBarrier_Store(&buffer_is_full_, 0);
     output_callback_copy = output_callback_;
+    output_format = output_format_;
+    generation = base::subtle::NoBarrier_Load(&generation_);
   }  // release lock
 
   if (output_callback_copy.is_null())
     return;
 
+  // Each session is a binary stream of its own, which starts with a header.
+  if (output_format == OUTPUT_FORMAT_BINARY &&
+      binary_writer_generation_ != generation) {
+    binary_writer_.reset(new TraceBinaryWriter(process_id_));
+    binary_writer_generation_ = generation;
+  }
+
   for (size_t i = 0;
        i < previous_logged_events.size();
        i += kTraceEventBatchSize) {
-    scoped_refptr<RefCountedString> json_events_str_ptr =
-        new RefCountedString();
-    TraceEvent::AppendEventsAsJSON(previous_logged_events,
+    scoped_refptr<RefCountedString> events_str_ptr = new RefCountedString();
+    if (output_format == OUTPUT_FORMAT_BINARY) {
+      binary_writer_->AppendEvents(previous_logged_events,
                                    i,
                                    kTraceEventBatchSize,
-                                   &(json_events_str_ptr->data()));
-    output_callback_copy.Run(json_events_str_ptr);
+                                   &(events_str_ptr->data()));
+    } else {
+      TraceEvent::AppendEventsAsJSON(previous_logged_events,
+                                     i,
+                                     kTraceEventBatchSize,
+                                     &(events_str_ptr->data()));
+    }
+    output_callback_copy.Run(events_str_ptr);
   }
 }
 
@@ -585,84 +746,249 @@ int TraceLog::AddTraceEvent(char phase,
                             long long threshold,
                             unsigned char flags) {
   DCHECK(name);
+  if (!*category_enabled)
+    return -1;
+  if (record_mode_ == RECORD_UNTIL_FULL &&
+      base::subtle::NoBarrier_Load(&buffer_is_full_)) {
+    return -1;
+  }
+
   TimeTicks now = TimeTicks::NowFromSystemTraceTime();
-  BufferFullCallback buffer_full_callback_copy;
+  int thread_id = static_cast<int>(PlatformThread::CurrentId());
+  UpdateThreadName(thread_id);
+
+  if (flags & TRACE_EVENT_FLAG_MANGLE_ID)
+    id ^= process_id_hash_;
+
+  TraceEvent event(thread_id,
+                   now, phase, category_enabled, name, id,
+                   num_args, arg_names, arg_types, arg_values,
+                   flags);
+  ThreadLocalEventBuffer* buffer = GetThreadLocalEventBuffer();
+  bool buffer_became_full = false;
   int ret_begin_id = -1;
-  {
+  if (threshold_begin_id > -1 || (flags & TRACE_EVENT_FLAG_THRESHOLD_BEGIN)) {
     AutoLock lock(lock_);
-    if (!*category_enabled)
-      return -1;
-    if (logged_events_.size() >= kTraceEventBufferSize)
-      return -1;
+    // Keep the events of this thread in order.
+    if (buffer->generation_ == base::subtle::NoBarrier_Load(&generation_))
+      CollectEventsLocked(buffer);
+    ret_begin_id = AddThresholdEventLocked(event, threshold_begin_id,
+                                           threshold);
+    buffer_became_full = CheckBufferFullLocked();
+  } else {
+    buffer->Append(event);
+    if (buffer->IsFull())
+      buffer_became_full = HandInThreadLocalEventBuffer(buffer);
+  }
 
-    int thread_id = static_cast<int>(PlatformThread::CurrentId());
-
-    const char* new_name = PlatformThread::GetName();
-    // Check if the thread name has been set or changed since the previous
-    // call (if any), but don't bother if the new name is empty. Note this will
-    // not detect a thread name change within the same char* buffer address: we
-    // favor common case performance over corner case correctness.
-    if (new_name != g_current_thread_name.Get().Get() &&
-        new_name && *new_name) {
-      g_current_thread_name.Get().Set(new_name);
-      base::hash_map<int, std::string>::iterator existing_name =
-          thread_names_.find(thread_id);
-      if (existing_name == thread_names_.end()) {
-        // This is a new thread id, and a new name.
-        thread_names_[thread_id] = new_name;
-      } else {
-        // This is a thread id that we've seen before, but potentially with a
-        // new name.
-        std::vector<base::StringPiece> existing_names;
-        Tokenize(existing_name->second, ",", &existing_names);
-        bool found = std::find(existing_names.begin(),
-                               existing_names.end(),
-                               new_name) != existing_names.end();
-        if (!found) {
-          existing_name->second.push_back(',');
-          existing_name->second.append(new_name);
-        }
-      }
-    }
+  if (buffer_became_full)
+    RunBufferFullCallback();
 
-    if (threshold_begin_id > -1) {
-      DCHECK(phase == TRACE_EVENT_PHASE_END);
-      size_t begin_i = static_cast<size_t>(threshold_begin_id);
-      // Return now if there has been a flush since the begin event was posted.
-      if (begin_i >= logged_events_.size())
-        return -1;
-      // Determine whether to drop the begin/end pair.
-      TimeDelta elapsed = now - logged_events_[begin_i].timestamp();
-      if (elapsed < TimeDelta::FromMicroseconds(threshold)) {
-        // Remove begin event and do not add end event.
-        // This will be expensive if there have been other events in the
-        // mean time (should be rare).
-        logged_events_.erase(logged_events_.begin() + begin_i);
-        return -1;
-      }
-    }
+  return ret_begin_id;
+}
 
-    if (flags & TRACE_EVENT_FLAG_MANGLE_ID)
-      id ^= process_id_hash_;
+void TraceLog::AddTraceEventWithThreadIdAndTimestamp(
+    char phase,
+    const unsigned char* category_enabled,
+    const char* name,
+    unsigned long long id,
+    int thread_id,
+    const TimeTicks& timestamp,
+    int num_args,
+    const char** arg_names,
+    const unsigned char* arg_types,
+    const unsigned long long* arg_values,
+    unsigned char flags) {
+  DCHECK(name);
+  if (!*category_enabled)
+    return;
+  if (record_mode_ == RECORD_UNTIL_FULL &&
+      base::subtle::NoBarrier_Load(&buffer_is_full_)) {
+    return;
+  }
 
-    ret_begin_id = static_cast<int>(logged_events_.size());
-    logged_events_.push_back(
-        TraceEvent(thread_id,
-                   now, phase, category_enabled, name, id,
+  if (flags & TRACE_EVENT_FLAG_MANGLE_ID)
+    id ^= process_id_hash_;
+
+  TraceEvent event(thread_id,
+                   timestamp, phase, category_enabled, name, id,
                    num_args, arg_names, arg_types, arg_values,
-                   flags));
+                   flags);
+  bool buffer_became_full = false;
+  {
+    AutoLock lock(lock_);
+    if (ReserveEventLocked())
+      logged_events_.push_back(event);
+    buffer_became_full = CheckBufferFullLocked();
+  }
 
-    if (logged_events_.size() == kTraceEventBufferSize) {
-      buffer_full_callback_copy = buffer_full_callback_;
-    }
-  }  // release lock
+  if (buffer_became_full)
+    RunBufferFullCallback();
+}
 
+void TraceLog::RunBufferFullCallback() {
+  BufferFullCallback buffer_full_callback_copy;
+  {
+    AutoLock lock(lock_);
+    buffer_full_callback_copy = buffer_full_callback_;
+  }  // release lock
   if (!buffer_full_callback_copy.is_null())
     buffer_full_callback_copy.Run();
+}
 
+void TraceLog::UpdateThreadName(int thread_id) {
+  const char* new_name = PlatformThread::GetName();
+  // Check if the thread name has been set or changed since the previous
+  // call (if any), but don't bother if the new name is empty. Note this will
+  // not detect a thread name change within the same char* buffer address: we
+  // favor common case performance over corner case correctness.
+  if (new_name == g_current_thread_name.Get().Get() || !new_name || !*new_name)
+    return;
+
+  g_current_thread_name.Get().Set(new_name);
+  AutoLock lock(lock_);
+  base::hash_map<int, std::string>::iterator existing_name =
+      thread_names_.find(thread_id);
+  if (existing_name == thread_names_.end()) {
+    // This is a new thread id, and a new name.
+    thread_names_[thread_id] = new_name;
+  } else {
+    // This is a thread id that we've seen before, but potentially with a
+    // new name.
+    std::vector<base::StringPiece> existing_names;
+    Tokenize(existing_name->second, ",", &existing_names);
+    bool found = std::find(existing_names.begin(),
+                           existing_names.end(),
+                           new_name) != existing_names.end();
+    if (!found) {
+      existing_name->second.push_back(',');
+      existing_name->second.append(new_name);
+    }
+  }
+}
+
+ThreadLocalEventBuffer* TraceLog::GetThreadLocalEventBuffer() {
+  ThreadLocalEventBuffer* buffer = static_cast<ThreadLocalEventBuffer*>(
+      g_thread_local_event_buffer.Get().slot.Get());
+  if (!buffer) {
+    buffer = new ThreadLocalEventBuffer;
+    g_thread_local_event_buffer.Get().slot.Set(buffer);
+  }
+  if (buffer->generation_ != base::subtle::NoBarrier_Load(&generation_)) {
+    // Events left from an earlier session were either collected then or
+    // are stale.
+    AutoLock lock(lock_);
+    buffer->Reset();
+    buffer->generation_ = base::subtle::NoBarrier_Load(&generation_);
+    thread_buffers_.push_back(buffer);
+  }
+  return buffer;
+}
+
+bool TraceLog::HandInThreadLocalEventBuffer(ThreadLocalEventBuffer* buffer) {
+  AutoLock lock(lock_);
+  // The buffer was dropped from |thread_buffers_| if a new session started
+  // since this thread checked, and will be set up again on its next event.
+  if (buffer->generation_ == base::subtle::NoBarrier_Load(&generation_))
+    CollectEventsLocked(buffer);
+  buffer->Reset();
+  return CheckBufferFullLocked();
+}
+
+void TraceLog::ReleaseThreadLocalEventBuffer(ThreadLocalEventBuffer* buffer) {
+  AutoLock lock(lock_);
+  std::vector<ThreadLocalEventBuffer*>::iterator it =
+      std::find(thread_buffers_.begin(), thread_buffers_.end(), buffer);
+  if (it == thread_buffers_.end())
+    return;
+  CollectEventsLocked(buffer);
+  thread_buffers_.erase(it);
+}
+
+void TraceLog::CollectEventsLocked(ThreadLocalEventBuffer* buffer) {
+  lock_.AssertAcquired();
+  // Pairs with the Release_Store() in ThreadLocalEventBuffer::Append().
+  int size = base::subtle::Acquire_Load(&buffer->size_);
+  for (; buffer->num_collected_ < size; ++buffer->num_collected_) {
+    if (!ReserveEventLocked()) {
+      buffer->num_collected_ = size;
+      break;
+    }
+    logged_events_.push_back(buffer->events_[buffer->num_collected_]);
+  }
+}
+
+void TraceLog::CollectAllEventsLocked() {
+  lock_.AssertAcquired();
+  for (size_t i = 0; i < thread_buffers_.size(); ++i)
+    CollectEventsLocked(thread_buffers_[i]);
+}
+
+bool TraceLog::ReserveEventLocked() {
+  lock_.AssertAcquired();
+  if (logged_events_.size() < kTraceEventBufferSize)
+    return true;
+  if (record_mode_ != RECORD_CONTINUOUSLY)
+    return false;
+  // Drop the oldest quarter at once so that the cost of moving the rest is
+  // spread over many events.
+  const size_t kNumEventsToDrop = kTraceEventBufferSize / 4;
+  logged_events_.erase(logged_events_.begin(),
+                       logged_events_.begin() + kNumEventsToDrop);
+  num_dropped_events_ += static_cast<int>(kNumEventsToDrop);
+  return true;
+}
+
+bool TraceLog::CheckBufferFullLocked() {
+  lock_.AssertAcquired();
+  if (record_mode_ != RECORD_UNTIL_FULL ||
+      logged_events_.size() < kTraceEventBufferSize ||
+      base::subtle::NoBarrier_Load(&buffer_is_full_)) {
+    return false;
+  }
+  base::subtle::NoBarrier_Store(&buffer_is_full_, 1);
+  return true;
+}
+
+int TraceLog::AddThresholdEventLocked(const TraceEvent& event,
+                                      int threshold_begin_id,
+                                      long long threshold) {
+  lock_.AssertAcquired();
+  if (threshold_begin_id > -1) {
+    DCHECK(event.phase() == TRACE_EVENT_PHASE_END);
+    // Return now if the begin event was dropped to make room.
+    if (threshold_begin_id < num_dropped_events_)
+      return -1;
+    size_t begin_i =
+        static_cast<size_t>(threshold_begin_id - num_dropped_events_);
+    // Return now if there has been a flush since the begin event was posted.
+    if (begin_i >= logged_events_.size())
+      return -1;
+    // Determine whether to drop the begin/end pair.
+    TimeDelta elapsed = event.timestamp() - logged_events_[begin_i].timestamp();
+    if (elapsed < TimeDelta::FromMicroseconds(threshold)) {
+      // Remove begin event and do not add end event.
+      // This will be expensive if there have been other events in the
+      // mean time (should be rare).
+      logged_events_.erase(logged_events_.begin() + begin_i);
+      return -1;
+    }
+  }
+
+  if (!ReserveEventLocked())
+    return -1;
+  int ret_begin_id =
+      num_dropped_events_ + static_cast<int>(logged_events_.size());
+  logged_events_.push_back(event);
   return ret_begin_id;
 }
 
+size_t TraceLog::GetEventsSize() {
+  AutoLock lock(lock_);
+  CollectAllEventsLocked();
+  return logged_events_.size();
+}
+
 void TraceLog::AddTraceEventEtw(char phase,
                                 const char* name,
                                 const void* id,
@@ -747,6 +1073,22 @@ void TraceLog::AddThreadNameMetadataEvents() {
   }
 }
 
+void TraceLog::AddLockContentionCounterEvent() {
+  int lock_contention;
+  int rw_lock_contention;
+  {
+    AutoLock lock(lock_);
+    if (!enabled_)
+      return;
+    lock_contention = Lock::GetContentionCount() - lock_contention_at_start_;
+    rw_lock_contention =
+        RWLock::GetContentionCount() - rw_lock_contention_at_start_;
+  }
+  TRACE_COUNTER2("lock", "LockContention",
+                 "lock", lock_contention,
+                 "rw_lock", rw_lock_contention);
+}
+
 void TraceLog::DeleteForTesting() {
   DeleteTraceLogForTesting::Delete();
 }
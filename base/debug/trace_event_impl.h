@@ -12,12 +12,15 @@
 #include <string>
 #include <vector>
 
+#include "base/atomicops.h"
 #include "base/callback.h"
 #include "base/hash_tables.h"
 #include "base/memory/ref_counted_memory.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/observer_list.h"
 #include "base/string_util.h"
 #include "base/synchronization/lock.h"
+#include "base/time.h"
 #include "base/timer.h"
 
 // Older style trace macros with explicit id and extra data
@@ -46,6 +49,8 @@ namespace debug {
 
 const int kTraceMaxNumArgs = 2;
 
+class TraceBinaryWriter;
+
 // Output records are "Events" and can be obtained via the
 // OutputCallback whenever the tracing system decides to flush. This
 // can happen at any time, on any thread, or you can programatically
@@ -82,7 +87,13 @@ class BASE_EXPORT TraceEvent {
                                  std::string* out);
   void AppendAsJSON(std::string* out) const;
 
+  // Appends |value| of TRACE_VALUE_TYPE_* |type| to |out| as JSON.
+  static void AppendValueAsJSON(unsigned char type,
+                                TraceValue value,
+                                std::string* out);
+
   TimeTicks timestamp() const { return timestamp_; }
+  char phase() const { return phase_; }
 
   // Exposed for unittesting:
 
@@ -93,6 +104,8 @@ class BASE_EXPORT TraceEvent {
   const char* name() const { return name_; }
 
  private:
+  friend class TraceBinaryWriter;
+
   // Note: these are ordered by size (largest first) for optimal packing.
   TimeTicks timestamp_;
   // id_ can be used to store phase-specific data.
@@ -153,10 +166,25 @@ class BASE_EXPORT TraceResultBuffer {
 };
 
 
+class ThreadLocalEventBuffer;
+
 class BASE_EXPORT TraceLog {
  public:
+  // What to do once the trace buffer is full.
+  enum RecordMode {
+    // Drop any further events.  This is the default.
+    RECORD_UNTIL_FULL,
+    // Keep going, dropping the oldest events.  Events older than the window
+    // given to SetRecordMode() are also dropped when the trace is flushed.
+    RECORD_CONTINUOUSLY
+  };
+
   static TraceLog* GetInstance();
 
+  // Sets what happens when the trace buffer fills up.  |window| is only used
+  // by RECORD_CONTINUOUSLY.  Must be called while tracing is disabled.
+  void SetRecordMode(RecordMode mode, const TimeDelta& window);
+
   // Get set of known categories. This can change as new code paths are reached.
   // The known categories are inserted into |categories|.
   void GetKnownCategories(std::vector<std::string>* categories);
@@ -223,9 +251,21 @@ class BASE_EXPORT TraceLog {
       OutputCallback;
   void SetOutputCallback(const OutputCallback& cb);
 
+  // The format of the strings handed to the output callback.
+  enum OutputFormat {
+    // JSON fragments for TraceResultBuffer.  This is the default.
+    OUTPUT_FORMAT_JSON,
+    // Chunks of the binary format of trace_event_binary.h.  The chunks of a
+    // tracing session concatenate to one stream, see ConvertBinaryTraceToJSON.
+    OUTPUT_FORMAT_BINARY
+  };
+  // Should only be changed while tracing is disabled.
+  void SetOutputFormat(OutputFormat format);
+
   // The trace buffer does not flush dynamically, so when it fills up,
-  // subsequent trace events will be dropped. This callback is generated when
-  // the trace buffer is full. The callback must be thread safe.
+  // subsequent trace events will be dropped, unless the record mode is
+  // RECORD_CONTINUOUSLY. This callback is generated when the trace buffer is
+  // full. The callback must be thread safe.
   typedef base::Callback<void(void)> BufferFullCallback;
   void SetBufferFullCallback(const BufferFullCallback& cb);
 
@@ -237,8 +277,12 @@ class BASE_EXPORT TraceLog {
   static const char* GetCategoryName(const unsigned char* category_enabled);
 
   // Called by TRACE_EVENT* macros, don't call this directly.
-  // Returns the index in the internal vector of the event if it was added, or
-  //         -1 if the event was not added.
+  // Events are first put in a buffer of the calling thread, which does not
+  // take any lock, and reach the TraceLog a chunk at a time or when it is
+  // flushed.
+  // For begin events flagged TRACE_EVENT_FLAG_THRESHOLD_BEGIN, returns an id
+  // to pass along with the end event, or -1 if the event was not added.
+  // Returns -1 for all other events.
   // On end events, the return value of the begin event can be specified along
   // with a threshold in microseconds. If the elapsed time between begin and end
   // is less than the threshold, the begin/end event pair is dropped.
@@ -255,6 +299,21 @@ class BASE_EXPORT TraceLog {
                     int threshold_begin_id,
                     long long threshold,
                     unsigned char flags);
+  // Adds an event on behalf of the thread |thread_id| that happened at
+  // |timestamp|, for events recorded where they could not be added, such as
+  // in signal handlers.  The event goes straight to the trace buffer.
+  void AddTraceEventWithThreadIdAndTimestamp(
+      char phase,
+      const unsigned char* category_enabled,
+      const char* name,
+      unsigned long long id,
+      int thread_id,
+      const TimeTicks& timestamp,
+      int num_args,
+      const char** arg_names,
+      const unsigned char* arg_types,
+      const unsigned long long* arg_values,
+      unsigned char flags);
   static void AddTraceEventEtw(char phase,
                                const char* name,
                                const void* id,
@@ -274,8 +333,9 @@ class BASE_EXPORT TraceLog {
   // Allows resurrecting our singleton instance post-AtExit processing.
   static void Resurrect();
 
-  // Allow tests to inspect TraceEvents.
-  size_t GetEventsSize() const { return logged_events_.size(); }
+  // Allow tests to inspect TraceEvents.  GetEventsSize() first collects the
+  // events the threads have buffered.
+  size_t GetEventsSize();
   const TraceEvent& GetEventAt(size_t index) const {
     DCHECK(index < logged_events_.size());
     return logged_events_[index];
@@ -288,21 +348,85 @@ class BASE_EXPORT TraceLog {
   // by the Singleton class.
   friend struct StaticMemorySingletonTraits<TraceLog>;
 
+  friend class ThreadLocalEventBuffer;
+
   TraceLog();
   ~TraceLog();
   const unsigned char* GetCategoryEnabledInternal(const char* name);
   void AddThreadNameMetadataEvents();
   void AddClockSyncMetadataEvents();
+  // Adds a "lock" category counter event with the number of times a Lock or
+  // an RWLock of the process was contended during the trace.
+  void AddLockContentionCounterEvent();
+
+  // Records the name of the current thread if it changed since its last event.
+  void UpdateThreadName(int thread_id);
+
+  // Returns the buffer of the calling thread, set up for the current tracing
+  // session.
+  ThreadLocalEventBuffer* GetThreadLocalEventBuffer();
+
+  // Moves the events of the calling thread's full |buffer| to
+  // |logged_events_| and empties it.  Returns true if that filled up the
+  // trace buffer.
+  bool HandInThreadLocalEventBuffer(ThreadLocalEventBuffer* buffer);
+
+  // Collects the events of a thread that is exiting and forgets its |buffer|.
+  void ReleaseThreadLocalEventBuffer(ThreadLocalEventBuffer* buffer);
+
+  // Copies the events of |buffer| that were not collected yet to
+  // |logged_events_|, or drops them if the trace buffer is full.
+  void CollectEventsLocked(ThreadLocalEventBuffer* buffer);
+  void CollectAllEventsLocked();
+
+  // Makes room for one more event in |logged_events_|.  Returns false if the
+  // event has to be dropped instead.
+  bool ReserveEventLocked();
+
+  // Returns true the first time the trace buffer is found full.
+  bool CheckBufferFullLocked();
+
+  // Runs |buffer_full_callback_|, if any, without holding |lock_|.
+  void RunBufferFullCallback();
+
+  // Adds either event of a TRACE_EVENT_IF_LONGER_THAN pair.  These go
+  // straight to |logged_events_| so that the end event can find its begin
+  // event there.
+  int AddThresholdEventLocked(const TraceEvent& event,
+                              int threshold_begin_id,
+                              long long threshold);
 
-  // TODO(nduca): switch to per-thread trace buffers to reduce thread
-  // synchronization.
   Lock lock_;
   bool enabled_;
   OutputCallback output_callback_;
+  OutputFormat output_format_;
+  // Held for the whole of Flush() so that the chunks reach the output callback
+  // in order.  Guards |binary_writer_| and |binary_writer_generation_|.
+  Lock flush_lock_;
+  // Encodes the binary stream of the session |binary_writer_generation_|.
+  scoped_ptr<TraceBinaryWriter> binary_writer_;
+  int binary_writer_generation_;
   BufferFullCallback buffer_full_callback_;
   std::vector<TraceEvent> logged_events_;
+  RecordMode record_mode_;
+  TimeDelta record_window_;
+  // Events removed from the front of |logged_events_| since the last flush to
+  // make room in RECORD_CONTINUOUSLY mode.  Threshold begin ids count them so
+  // that they keep pointing at their event.
+  int num_dropped_events_;
+  // Set once the trace buffer is full in RECORD_UNTIL_FULL mode, so that
+  // threads drop their events without taking |lock_|.
+  base::subtle::Atomic32 buffer_is_full_;
+  // Identifies the current tracing session.  A thread's buffer that was set up
+  // for an earlier one is emptied before it is used again.
+  base::subtle::Atomic32 generation_;
+  // The buffers of the threads that logged events in the current session.
+  std::vector<ThreadLocalEventBuffer*> thread_buffers_;
   std::vector<std::string> included_categories_;
   std::vector<std::string> excluded_categories_;
+  // The contention counts of Lock and RWLock when the trace started.
+  int lock_contention_at_start_;
+  int rw_lock_contention_at_start_;
   bool dispatching_to_observer_list_;
   ObserverList<EnabledStateChangedObserver> enabled_state_observer_list_;
 
@@ -723,6 +723,24 @@ TEST_F(TraceEventTestFixture, EnabledObserverFiresOnDisable) {
 }
 
 // Test that categories work.
+// The lock contention of the trace is recorded when tracing stops.
+TEST_F(TraceEventTestFixture, LockContentionCounter) {
+  ManualTestSetUp();
+  std::vector<std::string> included_categories;
+  included_categories.push_back("lock");
+  TraceLog::GetInstance()->SetEnabled(included_categories,
+                                      std::vector<std::string>());
+  TraceLog::GetInstance()->SetDisabled();
+
+  DictionaryValue* item = FindNamePhase("LockContention", "C");
+  ASSERT_TRUE(item);
+  int value = -1;
+  EXPECT_TRUE(item->GetInteger("args.lock", &value));
+  EXPECT_GE(value, 0);
+  EXPECT_TRUE(item->GetInteger("args.rw_lock", &value));
+  EXPECT_GE(value, 0);
+}
+
 TEST_F(TraceEventTestFixture, Categories) {
   ManualTestSetUp();
 
@@ -1108,6 +1126,61 @@ TEST_F(TraceEventTestFixture, DataCapturedManyThreads) {
                                            num_threads, num_events);
 }
 
+// Test that the events a thread has buffered are gathered when tracing is
+// disabled while the thread keeps running.
+TEST_F(TraceEventTestFixture, DataCapturedFromRunningThreads) {
+  ManualTestSetUp();
+  TraceLog::GetInstance()->SetEnabled(true);
+
+  // More events than a thread buffers at once, and a partial chunk.
+  const int num_threads = 2;
+  const int num_events = 100;
+  Thread* threads[num_threads];
+  WaitableEvent* task_complete_events[num_threads];
+  for (int i = 0; i < num_threads; i++) {
+    threads[i] = new Thread(StringPrintf("Thread %d", i).c_str());
+    task_complete_events[i] = new WaitableEvent(false, false);
+    threads[i]->Start();
+    threads[i]->message_loop()->PostTask(
+        FROM_HERE, base::Bind(&TraceManyInstantEvents,
+                              i, num_events, task_complete_events[i]));
+  }
+
+  for (int i = 0; i < num_threads; i++)
+    task_complete_events[i]->Wait();
+
+  TraceLog::GetInstance()->SetEnabled(false);
+
+  for (int i = 0; i < num_threads; i++) {
+    threads[i]->Stop();
+    delete threads[i];
+    delete task_complete_events[i];
+  }
+
+  ValidateInstantEventPresentOnEveryThread(trace_parsed_,
+                                           num_threads, num_events);
+}
+
+// Test that RECORD_CONTINUOUSLY drops the events that are older than the
+// window when the trace is flushed.
+TEST_F(TraceEventTestFixture, RecordContinuouslyDropsOldEvents) {
+  ManualTestSetUp();
+  TraceLog::GetInstance()->SetRecordMode(TraceLog::RECORD_CONTINUOUSLY,
+                                         TimeDelta::FromMilliseconds(200));
+  TraceLog::GetInstance()->SetEnabled(true);
+
+  TRACE_EVENT_INSTANT0("all", "old event");
+  PlatformThread::Sleep(TimeDelta::FromMilliseconds(400));
+  TRACE_EVENT_INSTANT0("all", "new event");
+
+  TraceLog::GetInstance()->SetEnabled(false);
+
+  DictionaryValue* item = NULL;
+  ListValue& trace_parsed = trace_parsed_;
+  EXPECT_NOT_FIND_("old event");
+  EXPECT_FIND_("new event");
+}
+
 // Test that thread and process names show up in the trace
 TEST_F(TraceEventTestFixture, ThreadNames) {
   ManualTestSetUp();
@@ -1217,6 +1290,39 @@ TEST_F(TraceEventTestFixture, ThreadNameChanges) {
   EXPECT_EQ(expected_name, tmp);
 }
 
+// Events added on behalf of another thread keep its id and their timestamp.
+TEST_F(TraceEventTestFixture, AddTraceEventWithThreadIdAndTimestamp) {
+  ManualTestSetUp();
+  TraceLog::GetInstance()->SetEnabled(true);
+
+  const int kThreadId = 4242;
+  const unsigned char* category_enabled =
+      TraceLog::GetCategoryEnabled("sampled");
+  const char* arg_names[] = { "stack" };
+  unsigned char arg_types[1];
+  unsigned long long arg_values[1];
+  trace_event_internal::SetTraceValue(std::string("main;Run"), &arg_types[0],
+                                      &arg_values[0]);
+  TraceLog::GetInstance()->AddTraceEventWithThreadIdAndTimestamp(
+      TRACE_EVENT_PHASE_INSTANT, category_enabled, "Sample", 0, kThreadId,
+      TimeTicks::FromInternalValue(12345), 1, arg_names, arg_types,
+      arg_values, TRACE_EVENT_FLAG_NONE);
+
+  TraceLog::GetInstance()->SetEnabled(false);
+
+  DictionaryValue* item = FindNamePhase("Sample", "I");
+  ASSERT_TRUE(item);
+  int tid;
+  EXPECT_TRUE(item->GetInteger("tid", &tid));
+  EXPECT_EQ(kThreadId, tid);
+  int ts;
+  EXPECT_TRUE(item->GetInteger("ts", &ts));
+  EXPECT_EQ(12345, ts);
+  std::string stack;
+  EXPECT_TRUE(item->GetString("args.stack", &stack));
+  EXPECT_EQ("main;Run", stack);
+}
+
 // Test trace calls made after tracing singleton shut down.
 //
 // The singleton is destroyed by our base::AtExitManager, but there can be
@@ -0,0 +1,117 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/md5.h"
+#include "base/perftimer.h"
+#include "base/sha1.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include "base/cpu.h"
+#include "base/digest_x86.h"
+#endif
+
+namespace {
+
+const size_t kBytes = 32 * 1024 * 1024;
+
+double MegabytesPerSecond(base::TimeDelta elapsed) {
+  return static_cast<double>(kBytes) / (1024 * 1024) / elapsed.InSecondsF();
+}
+
+// kBytes of data as |kBytes / size| inputs of |size| bytes each.
+class Inputs {
+ public:
+  explicit Inputs(size_t size) : buffer_(kBytes, 'x') {
+    for (size_t offset = 0; offset < kBytes; offset += size) {
+      data_.push_back(reinterpret_cast<const unsigned char*>(&buffer_[offset]));
+      lengths_.push_back(size);
+    }
+  }
+
+  size_t count() const { return data_.size(); }
+  const unsigned char* const* data() const { return &data_[0]; }
+  const void* const* void_data() const {
+    return reinterpret_cast<const void* const*>(&data_[0]);
+  }
+  const size_t* lengths() const { return &lengths_[0]; }
+
+ private:
+  std::string buffer_;
+  std::vector<const unsigned char*> data_;
+  std::vector<size_t> lengths_;
+};
+
+void TimeSHA1(const char* name,
+              void (*hash)(const unsigned char*, size_t, unsigned char*),
+              size_t size) {
+  Inputs inputs(size);
+  std::vector<unsigned char> hashes(inputs.count() * base::kSHA1Length);
+  PerfTimer timer;
+  for (size_t i = 0; i < inputs.count(); ++i)
+    hash(inputs.data()[i], size, &hashes[i * base::kSHA1Length]);
+  LogPerfResult(name, MegabytesPerSecond(timer.Elapsed()), "MB/s");
+}
+
+void TimeSHA1Many(const char* name,
+                  void (*hash_many)(const unsigned char* const*,
+                                    const size_t*, size_t, unsigned char*),
+                  size_t size) {
+  Inputs inputs(size);
+  std::vector<unsigned char> hashes(inputs.count() * base::kSHA1Length);
+  PerfTimer timer;
+  hash_many(inputs.data(), inputs.lengths(), inputs.count(), &hashes[0]);
+  LogPerfResult(name, MegabytesPerSecond(timer.Elapsed()), "MB/s");
+}
+
+void TimeMD5(const char* name, size_t size) {
+  Inputs inputs(size);
+  std::vector<base::MD5Digest> digests(inputs.count());
+  PerfTimer timer;
+  for (size_t i = 0; i < inputs.count(); ++i)
+    base::MD5Sum(inputs.data()[i], size, &digests[i]);
+  LogPerfResult(name, MegabytesPerSecond(timer.Elapsed()), "MB/s");
+}
+
+void TimeMD5Many(const char* name, size_t size) {
+  Inputs inputs(size);
+  std::vector<base::MD5Digest> digests(inputs.count());
+  PerfTimer timer;
+  base::MD5SumMany(inputs.void_data(), inputs.lengths(), inputs.count(),
+                   &digests[0]);
+  LogPerfResult(name, MegabytesPerSecond(timer.Elapsed()), "MB/s");
+}
+
+}  // namespace
+
+// One large input, which can only be hashed a block at a time.
+TEST(DigestPerfTest, SHA1Large) {
+  TimeSHA1("SHA1_Large_Portable", &base::internal::SHA1HashBytesPortable,
+           kBytes);
+  TimeSHA1("SHA1_Large", &base::SHA1HashBytes, kBytes);
+}
+
+// Many small inputs, one at a time and side by side.
+TEST(DigestPerfTest, SHA1Small) {
+  TimeSHA1("SHA1_Small_Portable", &base::internal::SHA1HashBytesPortable,
+           200);
+  TimeSHA1("SHA1_Small", &base::SHA1HashBytes, 200);
+  TimeSHA1Many("SHA1_Small_Many", &base::SHA1HashBytesMany, 200);
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (base::CPU().has_avx2()) {
+    TimeSHA1Many("SHA1_Small_Many_AVX2",
+                 &base::internal::SHA1HashBytesManyAVX2, 200);
+  }
+#endif
+}
+
+TEST(DigestPerfTest, MD5) {
+  TimeMD5("MD5_Large", kBytes);
+  TimeMD5("MD5_Small", 200);
+  TimeMD5Many("MD5_Small_Many", 200);
+}
@@ -0,0 +1,517 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/digest_x86.h"
+
+#include <string.h>
+
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+#include <immintrin.h>
+
+// The functions here are compiled for instructions the rest of the build
+// may not assume, so GCC has to be told which each may use.
+#if defined(COMPILER_GCC)
+#define SHA_TARGET __attribute__((target("sha,sse4.1")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define SHA_TARGET
+#define AVX2_TARGET
+#endif
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// SHA-1 with the SHA extensions ----------------------------------------------
+
+// Four rounds of group |g|, whose message words are in |msg[g % 4]|, from
+// |abcd| and the E of four rounds back, |e_source|.  Leaves the ABCD the
+// rounds started from in |e_source| for the next group.
+#define SHA1_ROUNDS(g) \
+  do { \
+    __m128i e = _mm_sha1nexte_epu32(e_source, msg[(g) % 4]); \
+    e_source = abcd; \
+    abcd = _mm_sha1rnds4_epu32(abcd, e, (g) / 5); \
+  } while (0)
+
+// Computes the message words for group |g| from those of the four groups
+// before it, overwriting those of group |g| - 4.
+#define SHA1_SCHEDULE(g) \
+  msg[(g) % 4] = _mm_sha1msg2_epu32( \
+      _mm_xor_si128(_mm_sha1msg1_epu32(msg[(g) % 4], msg[((g) + 1) % 4]), \
+                    msg[((g) + 2) % 4]), \
+      msg[((g) + 3) % 4])
+
+#define SHA1_SCHEDULED_ROUNDS(g) \
+  do { \
+    SHA1_SCHEDULE(g); \
+    SHA1_ROUNDS(g); \
+  } while (0)
+
+}  // namespace
+
+SHA_TARGET void SHA1TransformSHA(uint32 state[5],
+                                 const uint8* blocks,
+                                 size_t count) {
+  // The instructions want A in the top lane of the register, and the words
+  // of each block loaded big-endian.
+  const __m128i kByteSwap = _mm_set_epi64x(0x0001020304050607ULL,
+                                           0x08090a0b0c0d0e0fULL);
+  __m128i abcd = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+  __m128i e0 = _mm_set_epi32(state[4], 0, 0, 0);
+
+  for (; count; --count, blocks += 64) {
+    const __m128i abcd_start = abcd;
+    const __m128i e0_start = e0;
+    const __m128i* block = reinterpret_cast<const __m128i*>(blocks);
+    __m128i msg[4];
+    for (int i = 0; i < 4; ++i)
+      msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(block + i), kByteSwap);
+
+    // The first group adds E itself; the rest derive it from ABCD.
+    __m128i e_source = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, _mm_add_epi32(e0, msg[0]), 0);
+    SHA1_ROUNDS(1);
+    SHA1_ROUNDS(2);
+    SHA1_ROUNDS(3);
+    SHA1_SCHEDULED_ROUNDS(4);
+    SHA1_SCHEDULED_ROUNDS(5);
+    SHA1_SCHEDULED_ROUNDS(6);
+    SHA1_SCHEDULED_ROUNDS(7);
+    SHA1_SCHEDULED_ROUNDS(8);
+    SHA1_SCHEDULED_ROUNDS(9);
+    SHA1_SCHEDULED_ROUNDS(10);
+    SHA1_SCHEDULED_ROUNDS(11);
+    SHA1_SCHEDULED_ROUNDS(12);
+    SHA1_SCHEDULED_ROUNDS(13);
+    SHA1_SCHEDULED_ROUNDS(14);
+    SHA1_SCHEDULED_ROUNDS(15);
+    SHA1_SCHEDULED_ROUNDS(16);
+    SHA1_SCHEDULED_ROUNDS(17);
+    SHA1_SCHEDULED_ROUNDS(18);
+    SHA1_SCHEDULED_ROUNDS(19);
+
+    e0 = _mm_sha1nexte_epu32(e_source, e0_start);
+    abcd = _mm_add_epi32(abcd, abcd_start);
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state),
+                   _mm_shuffle_epi32(abcd, 0x1b));
+  state[4] = _mm_extract_epi32(e0, 3);
+}
+
+#undef SHA1_SCHEDULED_ROUNDS
+#undef SHA1_SCHEDULE
+#undef SHA1_ROUNDS
+
+namespace {
+
+// Eight inputs at a time -----------------------------------------------------
+
+const int kLanes = 8;
+
+// One input as the lane hashing it sees it: its whole blocks, read straight
+// from the input, and then one or two blocks holding the rest of it, the
+// padding and its length.
+struct Lane {
+  const uint8* blocks;
+  size_t whole_blocks;
+  uint8 tail[128];
+  size_t tail_blocks;
+  size_t next_block;
+  size_t input;
+};
+
+const uint8 kIdleBlock[64] = { 0 };
+
+// Sets |lane| up to hash |length| bytes at |data|, with the length in bits
+// at the end of the padding written big- or little-endian.
+void StartLane(Lane* lane, size_t input, const uint8* data, size_t length,
+               bool big_endian) {
+  lane->input = input;
+  lane->blocks = data;
+  lane->whole_blocks = length / 64;
+  lane->next_block = 0;
+
+  size_t rest = length % 64;
+  memcpy(lane->tail, data + length - rest, rest);
+  lane->tail[rest] = 0x80;
+  lane->tail_blocks = rest < 56 ? 1 : 2;
+  uint8* end = lane->tail + 64 * lane->tail_blocks;
+  memset(lane->tail + rest + 1, 0, end - 8 - (lane->tail + rest + 1));
+  uint64 bits = static_cast<uint64>(length) * 8;
+  for (int i = 0; i < 8; ++i) {
+    int shift = big_endian ? 56 - 8 * i : 8 * i;
+    end[i - 8] = static_cast<uint8>(bits >> shift);
+  }
+}
+
+const uint8* NextBlock(Lane* lane) {
+  size_t block = lane->next_block++;
+  if (block < lane->whole_blocks)
+    return lane->blocks + 64 * block;
+  return lane->tail + 64 * (block - lane->whole_blocks);
+}
+
+bool LaneDone(const Lane& lane) {
+  return lane.next_block == lane.whole_blocks + lane.tail_blocks;
+}
+
+// Hashes |count| inputs with |Hash|, which provides:
+//   kWords, kInitialState: the size and starting value of the state.
+//   kBigEndian: how the length at the end of the padding is written.
+//   Transform(): the compression function of eight lanes at once.
+//   Output(): writes the digest of one lane.
+// Whenever a lane finishes an input it starts on the next, so the lanes
+// are kept busy however the lengths vary.
+template <class Hash>
+void HashMany(const void* const* data,
+              const size_t* lengths,
+              size_t count,
+              uint8* digests) {
+  uint32 state[Hash::kWords][kLanes];
+  Lane lanes[kLanes];
+  bool busy[kLanes];
+  int busy_lanes = 0;
+  size_t next_input = 0;
+
+  for (int lane = 0; lane < kLanes; ++lane) {
+    busy[lane] = next_input < count;
+    if (!busy[lane])
+      continue;
+    StartLane(&lanes[lane], next_input,
+              static_cast<const uint8*>(data[next_input]),
+              lengths[next_input], Hash::kBigEndian);
+    for (int word = 0; word < Hash::kWords; ++word)
+      state[word][lane] = Hash::kInitialState[word];
+    ++next_input;
+    ++busy_lanes;
+  }
+
+  while (busy_lanes) {
+    const uint8* blocks[kLanes];
+    for (int lane = 0; lane < kLanes; ++lane)
+      blocks[lane] = busy[lane] ? NextBlock(&lanes[lane]) : kIdleBlock;
+    Hash::Transform(state, blocks);
+
+    for (int lane = 0; lane < kLanes; ++lane) {
+      if (!busy[lane] || !LaneDone(lanes[lane]))
+        continue;
+      Hash::Output(state, lane,
+                   digests + lanes[lane].input * Hash::kDigestLength);
+      if (next_input < count) {
+        StartLane(&lanes[lane], next_input,
+                  static_cast<const uint8*>(data[next_input]),
+                  lengths[next_input], Hash::kBigEndian);
+        for (int word = 0; word < Hash::kWords; ++word)
+          state[word][lane] = Hash::kInitialState[word];
+        ++next_input;
+      } else {
+        busy[lane] = false;
+        --busy_lanes;
+      }
+    }
+  }
+}
+
+// Loads |offset| to |offset| + 32 of each block, so that |words[i]| holds
+// the |i|th 32-bit word of that range from every lane.
+AVX2_TARGET inline void LoadWords(const uint8* const blocks[kLanes],
+                                  size_t offset,
+                                  __m256i words[8]) {
+  __m256i rows[8];
+  for (int lane = 0; lane < kLanes; ++lane) {
+    rows[lane] = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(blocks[lane] + offset));
+  }
+  // An 8x8 transpose: pairs of words, then pairs of pairs, then halves.
+  __m256i pairs[8];
+  for (int i = 0; i < 8; i += 4) {
+    pairs[i] = _mm256_unpacklo_epi32(rows[i], rows[i + 1]);
+    pairs[i + 1] = _mm256_unpackhi_epi32(rows[i], rows[i + 1]);
+    pairs[i + 2] = _mm256_unpacklo_epi32(rows[i + 2], rows[i + 3]);
+    pairs[i + 3] = _mm256_unpackhi_epi32(rows[i + 2], rows[i + 3]);
+  }
+  __m256i quads[8];
+  for (int i = 0; i < 8; i += 4) {
+    quads[i] = _mm256_unpacklo_epi64(pairs[i], pairs[i + 2]);
+    quads[i + 1] = _mm256_unpackhi_epi64(pairs[i], pairs[i + 2]);
+    quads[i + 2] = _mm256_unpacklo_epi64(pairs[i + 1], pairs[i + 3]);
+    quads[i + 3] = _mm256_unpackhi_epi64(pairs[i + 1], pairs[i + 3]);
+  }
+  for (int i = 0; i < 4; ++i) {
+    words[i] = _mm256_permute2x128_si256(quads[i], quads[i + 4], 0x20);
+    words[i + 4] = _mm256_permute2x128_si256(quads[i], quads[i + 4], 0x31);
+  }
+}
+
+AVX2_TARGET inline __m256i Add(__m256i a, __m256i b) {
+  return _mm256_add_epi32(a, b);
+}
+
+AVX2_TARGET inline __m256i Rotate(__m256i x, int bits) {
+  return _mm256_or_si256(_mm256_slli_epi32(x, bits),
+                         _mm256_srli_epi32(x, 32 - bits));
+}
+
+// SHA-1, eight lanes at a time ------------------------------------------------
+
+struct SHA1 {
+  static const int kWords = 5;
+  static const uint32 kInitialState[kWords];
+  static const bool kBigEndian = true;
+  static const size_t kDigestLength = 20;
+
+  AVX2_TARGET static void Transform(uint32 state[kWords][kLanes],
+                                    const uint8* const blocks[kLanes]);
+
+  static void Output(const uint32 state[kWords][kLanes], int lane,
+                     uint8* digest) {
+    for (int word = 0; word < kWords; ++word) {
+      uint32 value = state[word][lane];
+      digest[4 * word] = static_cast<uint8>(value >> 24);
+      digest[4 * word + 1] = static_cast<uint8>(value >> 16);
+      digest[4 * word + 2] = static_cast<uint8>(value >> 8);
+      digest[4 * word + 3] = static_cast<uint8>(value);
+    }
+  }
+};
+
+const uint32 SHA1::kInitialState[SHA1::kWords] = {
+  0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0
+};
+
+// Rounds |first| to |last| - 1 of SHA-1 with the round function |f|, the
+// way FIPS 180-3 describes them.
+#define SHA1_ROUNDS(first, last, f, k) \
+  for (int t = first; t < last; ++t) { \
+    if (t >= 16) { \
+      w[t & 15] = Rotate(_mm256_xor_si256( \
+          _mm256_xor_si256(w[(t - 3) & 15], w[(t - 8) & 15]), \
+          _mm256_xor_si256(w[(t - 14) & 15], w[t & 15])), 1); \
+    } \
+    __m256i temp = Add(Add(Rotate(a, 5), f), \
+                       Add(Add(e, w[t & 15]), _mm256_set1_epi32(k))); \
+    e = d; \
+    d = c; \
+    c = Rotate(b, 30); \
+    b = a; \
+    a = temp; \
+  }
+
+AVX2_TARGET void SHA1::Transform(uint32 state[kWords][kLanes],
+                                 const uint8* const blocks[kLanes]) {
+  const __m256i kByteSwap = _mm256_set_epi8(
+      12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+      12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+  __m256i w[16];
+  LoadWords(blocks, 0, w);
+  LoadWords(blocks, 32, w + 8);
+  for (int t = 0; t < 16; ++t)
+    w[t] = _mm256_shuffle_epi8(w[t], kByteSwap);
+
+  __m256i start[kWords];
+  for (int word = 0; word < kWords; ++word) {
+    start[word] = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(state[word]));
+  }
+  __m256i a = start[0], b = start[1], c = start[2], d = start[3],
+      e = start[4];
+
+  SHA1_ROUNDS(0, 20,
+              _mm256_xor_si256(d, _mm256_and_si256(b, _mm256_xor_si256(c, d))),
+              0x5a827999);
+  SHA1_ROUNDS(20, 40, _mm256_xor_si256(_mm256_xor_si256(b, c), d),
+              0x6ed9eba1);
+  SHA1_ROUNDS(40, 60,
+              _mm256_or_si256(_mm256_and_si256(b, c),
+                              _mm256_and_si256(d, _mm256_or_si256(b, c))),
+              0x8f1bbcdc);
+  SHA1_ROUNDS(60, 80, _mm256_xor_si256(_mm256_xor_si256(b, c), d),
+              0xca62c1d6);
+
+  start[0] = Add(start[0], a);
+  start[1] = Add(start[1], b);
+  start[2] = Add(start[2], c);
+  start[3] = Add(start[3], d);
+  start[4] = Add(start[4], e);
+  for (int word = 0; word < kWords; ++word) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(state[word]),
+                        start[word]);
+  }
+}
+
+#undef SHA1_ROUNDS
+
+// MD5, eight lanes at a time --------------------------------------------------
+
+// The round functions and step as md5.cc has them.
+AVX2_TARGET inline __m256i F1(__m256i x, __m256i y, __m256i z) {
+  return _mm256_xor_si256(z, _mm256_and_si256(x, _mm256_xor_si256(y, z)));
+}
+
+AVX2_TARGET inline __m256i F2(__m256i x, __m256i y, __m256i z) {
+  return F1(z, x, y);
+}
+
+AVX2_TARGET inline __m256i F3(__m256i x, __m256i y, __m256i z) {
+  return _mm256_xor_si256(_mm256_xor_si256(x, y), z);
+}
+
+AVX2_TARGET inline __m256i F4(__m256i x, __m256i y, __m256i z) {
+  return _mm256_xor_si256(
+      y, _mm256_or_si256(x, _mm256_xor_si256(z, _mm256_set1_epi32(-1))));
+}
+
+#define MD5_STEP(f, w, x, y, z, i, k, s) \
+  w = Add(Rotate(Add(Add(w, f(x, y, z)), \
+                     Add(in[i], _mm256_set1_epi32(k))), s), x)
+
+struct MD5 {
+  static const int kWords = 4;
+  static const uint32 kInitialState[kWords];
+  static const bool kBigEndian = false;
+  static const size_t kDigestLength = 16;
+
+  AVX2_TARGET static void Transform(uint32 state[kWords][kLanes],
+                                    const uint8* const blocks[kLanes]);
+
+  static void Output(const uint32 state[kWords][kLanes], int lane,
+                     uint8* digest) {
+    for (int word = 0; word < kWords; ++word) {
+      uint32 value = state[word][lane];
+      digest[4 * word] = static_cast<uint8>(value);
+      digest[4 * word + 1] = static_cast<uint8>(value >> 8);
+      digest[4 * word + 2] = static_cast<uint8>(value >> 16);
+      digest[4 * word + 3] = static_cast<uint8>(value >> 24);
+    }
+  }
+};
+
+const uint32 MD5::kInitialState[MD5::kWords] = {
+  0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476
+};
+
+AVX2_TARGET void MD5::Transform(uint32 state[kWords][kLanes],
+                                const uint8* const blocks[kLanes]) {
+  // MD5 reads its words little-endian, as x86 does.
+  __m256i in[16];
+  LoadWords(blocks, 0, in);
+  LoadWords(blocks, 32, in + 8);
+
+  __m256i start[kWords];
+  for (int word = 0; word < kWords; ++word) {
+    start[word] = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(state[word]));
+  }
+  __m256i a = start[0], b = start[1], c = start[2], d = start[3];
+
+  MD5_STEP(F1, a, b, c, d,  0, 0xd76aa478,  7);
+  MD5_STEP(F1, d, a, b, c,  1, 0xe8c7b756, 12);
+  MD5_STEP(F1, c, d, a, b,  2, 0x242070db, 17);
+  MD5_STEP(F1, b, c, d, a,  3, 0xc1bdceee, 22);
+  MD5_STEP(F1, a, b, c, d,  4, 0xf57c0faf,  7);
+  MD5_STEP(F1, d, a, b, c,  5, 0x4787c62a, 12);
+  MD5_STEP(F1, c, d, a, b,  6, 0xa8304613, 17);
+  MD5_STEP(F1, b, c, d, a,  7, 0xfd469501, 22);
+  MD5_STEP(F1, a, b, c, d,  8, 0x698098d8,  7);
+  MD5_STEP(F1, d, a, b, c,  9, 0x8b44f7af, 12);
+  MD5_STEP(F1, c, d, a, b, 10, 0xffff5bb1, 17);
+  MD5_STEP(F1, b, c, d, a, 11, 0x895cd7be, 22);
+  MD5_STEP(F1, a, b, c, d, 12, 0x6b901122,  7);
+  MD5_STEP(F1, d, a, b, c, 13, 0xfd987193, 12);
+  MD5_STEP(F1, c, d, a, b, 14, 0xa679438e, 17);
+  MD5_STEP(F1, b, c, d, a, 15, 0x49b40821, 22);
+
+  MD5_STEP(F2, a, b, c, d,  1, 0xf61e2562,  5);
+  MD5_STEP(F2, d, a, b, c,  6, 0xc040b340,  9);
+  MD5_STEP(F2, c, d, a, b, 11, 0x265e5a51, 14);
+  MD5_STEP(F2, b, c, d, a,  0, 0xe9b6c7aa, 20);
+  MD5_STEP(F2, a, b, c, d,  5, 0xd62f105d,  5);
+  MD5_STEP(F2, d, a, b, c, 10, 0x02441453,  9);
+  MD5_STEP(F2, c, d, a, b, 15, 0xd8a1e681, 14);
+  MD5_STEP(F2, b, c, d, a,  4, 0xe7d3fbc8, 20);
+  MD5_STEP(F2, a, b, c, d,  9, 0x21e1cde6,  5);
+  MD5_STEP(F2, d, a, b, c, 14, 0xc33707d6,  9);
+  MD5_STEP(F2, c, d, a, b,  3, 0xf4d50d87, 14);
+  MD5_STEP(F2, b, c, d, a,  8, 0x455a14ed, 20);
+  MD5_STEP(F2, a, b, c, d, 13, 0xa9e3e905,  5);
+  MD5_STEP(F2, d, a, b, c,  2, 0xfcefa3f8,  9);
+  MD5_STEP(F2, c, d, a, b,  7, 0x676f02d9, 14);
+  MD5_STEP(F2, b, c, d, a, 12, 0x8d2a4c8a, 20);
+
+  MD5_STEP(F3, a, b, c, d,  5, 0xfffa3942,  4);
+  MD5_STEP(F3, d, a, b, c,  8, 0x8771f681, 11);
+  MD5_STEP(F3, c, d, a, b, 11, 0x6d9d6122, 16);
+  MD5_STEP(F3, b, c, d, a, 14, 0xfde5380c, 23);
+  MD5_STEP(F3, a, b, c, d,  1, 0xa4beea44,  4);
+  MD5_STEP(F3, d, a, b, c,  4, 0x4bdecfa9, 11);
+  MD5_STEP(F3, c, d, a, b,  7, 0xf6bb4b60, 16);
+  MD5_STEP(F3, b, c, d, a, 10, 0xbebfbc70, 23);
+  MD5_STEP(F3, a, b, c, d, 13, 0x289b7ec6,  4);
+  MD5_STEP(F3, d, a, b, c,  0, 0xeaa127fa, 11);
+  MD5_STEP(F3, c, d, a, b,  3, 0xd4ef3085, 16);
+  MD5_STEP(F3, b, c, d, a,  6, 0x04881d05, 23);
+  MD5_STEP(F3, a, b, c, d,  9, 0xd9d4d039,  4);
+  MD5_STEP(F3, d, a, b, c, 12, 0xe6db99e5, 11);
+  MD5_STEP(F3, c, d, a, b, 15, 0x1fa27cf8, 16);
+  MD5_STEP(F3, b, c, d, a,  2, 0xc4ac5665, 23);
+
+  MD5_STEP(F4, a, b, c, d,  0, 0xf4292244,  6);
+  MD5_STEP(F4, d, a, b, c,  7, 0x432aff97, 10);
+  MD5_STEP(F4, c, d, a, b, 14, 0xab9423a7, 15);
+  MD5_STEP(F4, b, c, d, a,  5, 0xfc93a039, 21);
+  MD5_STEP(F4, a, b, c, d, 12, 0x655b59c3,  6);
+  MD5_STEP(F4, d, a, b, c,  3, 0x8f0ccc92, 10);
+  MD5_STEP(F4, c, d, a, b, 10, 0xffeff47d, 15);
+  MD5_STEP(F4, b, c, d, a,  1, 0x85845dd1, 21);
+  MD5_STEP(F4, a, b, c, d,  8, 0x6fa87e4f,  6);
+  MD5_STEP(F4, d, a, b, c, 15, 0xfe2ce6e0, 10);
+  MD5_STEP(F4, c, d, a, b,  6, 0xa3014314, 15);
+  MD5_STEP(F4, b, c, d, a, 13, 0x4e0811a1, 21);
+  MD5_STEP(F4, a, b, c, d,  4, 0xf7537e82,  6);
+  MD5_STEP(F4, d, a, b, c, 11, 0xbd3af235, 10);
+  MD5_STEP(F4, c, d, a, b,  2, 0x2ad7d2bb, 15);
+  MD5_STEP(F4, b, c, d, a,  9, 0xeb86d391, 21);
+
+  start[0] = Add(start[0], a);
+  start[1] = Add(start[1], b);
+  start[2] = Add(start[2], c);
+  start[3] = Add(start[3], d);
+  for (int word = 0; word < kWords; ++word) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(state[word]),
+                        start[word]);
+  }
+}
+
+#undef MD5_STEP
+
+}  // namespace
+
+void SHA1HashBytesManyAVX2(const unsigned char* const* data,
+                           const size_t* lengths,
+                           size_t count,
+                           unsigned char* hashes) {
+  HashMany<SHA1>(reinterpret_cast<const void* const*>(data), lengths, count,
+                 hashes);
+}
+
+void MD5SumManyAVX2(const void* const* data,
+                    const size_t* lengths,
+                    size_t count,
+                    MD5Digest* digests) {
+  COMPILE_ASSERT(sizeof(MD5Digest) == MD5::kDigestLength,
+                 md5_digest_has_no_padding);
+  HashMany<MD5>(data, lengths, count, reinterpret_cast<uint8*>(digests));
+}
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // defined(ARCH_CPU_X86_FAMILY)
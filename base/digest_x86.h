@@ -0,0 +1,37 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// SHA-1 and MD5 using x86 instruction set extensions.  These are the
+// implementations SHA1HashBytes(), SHA1HashBytesMany() and MD5SumMany() pick
+// from at run time; callers must check base::CPU before calling them.
+
+#ifndef BASE_DIGEST_X86_H_
+#define BASE_DIGEST_X86_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/md5.h"
+
+namespace base {
+namespace internal {
+
+// Runs the SHA-1 compression function over the |count| 64-byte blocks at
+// |blocks|, updating |state|.  Needs the SHA extensions and SSE4.1.
+void SHA1TransformSHA(uint32 state[5], const uint8* blocks, size_t count);
+
+// As SHA1HashBytesMany() and MD5SumMany(), hashing eight inputs at a time,
+// one in each 32-bit lane of the AVX2 registers.  Need AVX2.
+void SHA1HashBytesManyAVX2(const unsigned char* const* data,
+                           const size_t* lengths,
+                           size_t count,
+                           unsigned char* hashes);
+void MD5SumManyAVX2(const void* const* data,
+                    const size_t* lengths,
+                    size_t count,
+                    MD5Digest* digests);
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_DIGEST_X86_H_
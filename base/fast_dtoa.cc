@@ -0,0 +1,349 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/fast_dtoa.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "base/basictypes.h"
+#include "base/logging.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// A floating point number f * 2^e with a 64-bit significand and no
+// rounding, which is all Grisu needs.
+struct DiyFp {
+  DiyFp() : f(0), e(0) {}
+  DiyFp(uint64 f, int e) : f(f), e(e) {}
+
+  uint64 f;
+  int e;
+};
+
+const int kSignificandSize = 64;
+
+// The product of |a| and |b|, rounded to 64 bits of significand.
+DiyFp Multiply(const DiyFp& a, const DiyFp& b) {
+  const uint64 kMask32 = 0xFFFFFFFFu;
+  uint64 a_high = a.f >> 32;
+  uint64 a_low = a.f & kMask32;
+  uint64 b_high = b.f >> 32;
+  uint64 b_low = b.f & kMask32;
+  uint64 high_high = a_high * b_high;
+  uint64 low_high = a_low * b_high;
+  uint64 high_low = a_high * b_low;
+  uint64 low_low = a_low * b_low;
+  uint64 middle = (low_low >> 32) + (high_low & kMask32) +
+      (low_high & kMask32);
+  // Round the discarded low half.
+  middle += GG_UINT64_C(1) << 31;
+  return DiyFp(high_high + (high_low >> 32) + (low_high >> 32) +
+                   (middle >> 32),
+               a.e + b.e + kSignificandSize);
+}
+
+DiyFp Normalize(DiyFp value) {
+  DCHECK(value.f);
+  while (!(value.f & (GG_UINT64_C(1) << 63))) {
+    value.f <<= 1;
+    --value.e;
+  }
+  return value;
+}
+
+// The fields of a double.
+const uint64 kDoubleSignificandMask = GG_UINT64_C(0x000FFFFFFFFFFFFF);
+const uint64 kDoubleHiddenBit = GG_UINT64_C(0x0010000000000000);
+const int kDoubleExponentBias = 0x3FF + 52;
+const int kDoubleDenormalExponent = 1 - kDoubleExponentBias;
+
+// Sets |value| to |d| exactly, and |minus| and |plus| to the points half way
+// to its neighbours, with the exponent of the normalized |plus|.  Reading
+// back anything strictly between the two gives |d|.
+void DecomposeDouble(double d, DiyFp* value, DiyFp* minus, DiyFp* plus) {
+  uint64 bits;
+  memcpy(&bits, &d, sizeof(bits));
+  int biased_exponent = static_cast<int>(bits >> 52) & 0x7FF;
+  uint64 significand = bits & kDoubleSignificandMask;
+  if (biased_exponent) {
+    *value = DiyFp(significand + kDoubleHiddenBit,
+                   biased_exponent - kDoubleExponentBias);
+  } else {
+    *value = DiyFp(significand, kDoubleDenormalExponent);
+  }
+
+  *plus = Normalize(DiyFp((value->f << 1) + 1, value->e - 1));
+  // The next double down is nearer when |d| is a power of two, other than
+  // the smallest normal one.
+  if (!significand && biased_exponent > 1)
+    *minus = DiyFp((value->f << 2) - 1, value->e - 2);
+  else
+    *minus = DiyFp((value->f << 1) - 1, value->e - 1);
+  minus->f <<= minus->e - plus->e;
+  minus->e = plus->e;
+  *value = Normalize(*value);
+}
+
+// Normalized approximations of 10^k for every eighth k from -348 to 340,
+// rounded to nearest: 10^decimal_exponent ~= significand *
+// 2^binary_exponent.
+struct CachedPower {
+  uint64 significand;
+  int16 binary_exponent;
+  int16 decimal_exponent;
+};
+
+const CachedPower kCachedPowers[] = {
+  { GG_UINT64_C(0xfa8fd5a0081c0288), -1220, -348 },
+  { GG_UINT64_C(0xbaaee17fa23ebf76), -1193, -340 },
+  { GG_UINT64_C(0x8b16fb203055ac76), -1166, -332 },
+  { GG_UINT64_C(0xcf42894a5dce35ea), -1140, -324 },
+  { GG_UINT64_C(0x9a6bb0aa55653b2d), -1113, -316 },
+  { GG_UINT64_C(0xe61acf033d1a45df), -1087, -308 },
+  { GG_UINT64_C(0xab70fe17c79ac6ca), -1060, -300 },
+  { GG_UINT64_C(0xff77b1fcbebcdc4f), -1034, -292 },
+  { GG_UINT64_C(0xbe5691ef416bd60c), -1007, -284 },
+  { GG_UINT64_C(0x8dd01fad907ffc3c), -980, -276 },
+  { GG_UINT64_C(0xd3515c2831559a83), -954, -268 },
+  { GG_UINT64_C(0x9d71ac8fada6c9b5), -927, -260 },
+  { GG_UINT64_C(0xea9c227723ee8bcb), -901, -252 },
+  { GG_UINT64_C(0xaecc49914078536d), -874, -244 },
+  { GG_UINT64_C(0x823c12795db6ce57), -847, -236 },
+  { GG_UINT64_C(0xc21094364dfb5637), -821, -228 },
+  { GG_UINT64_C(0x9096ea6f3848984f), -794, -220 },
+  { GG_UINT64_C(0xd77485cb25823ac7), -768, -212 },
+  { GG_UINT64_C(0xa086cfcd97bf97f4), -741, -204 },
+  { GG_UINT64_C(0xef340a98172aace5), -715, -196 },
+  { GG_UINT64_C(0xb23867fb2a35b28e), -688, -188 },
+  { GG_UINT64_C(0x84c8d4dfd2c63f3b), -661, -180 },
+  { GG_UINT64_C(0xc5dd44271ad3cdba), -635, -172 },
+  { GG_UINT64_C(0x936b9fcebb25c996), -608, -164 },
+  { GG_UINT64_C(0xdbac6c247d62a584), -582, -156 },
+  { GG_UINT64_C(0xa3ab66580d5fdaf6), -555, -148 },
+  { GG_UINT64_C(0xf3e2f893dec3f126), -529, -140 },
+  { GG_UINT64_C(0xb5b5ada8aaff80b8), -502, -132 },
+  { GG_UINT64_C(0x87625f056c7c4a8b), -475, -124 },
+  { GG_UINT64_C(0xc9bcff6034c13053), -449, -116 },
+  { GG_UINT64_C(0x964e858c91ba2655), -422, -108 },
+  { GG_UINT64_C(0xdff9772470297ebd), -396, -100 },
+  { GG_UINT64_C(0xa6dfbd9fb8e5b88f), -369, -92 },
+  { GG_UINT64_C(0xf8a95fcf88747d94), -343, -84 },
+  { GG_UINT64_C(0xb94470938fa89bcf), -316, -76 },
+  { GG_UINT64_C(0x8a08f0f8bf0f156b), -289, -68 },
+  { GG_UINT64_C(0xcdb02555653131b6), -263, -60 },
+  { GG_UINT64_C(0x993fe2c6d07b7fac), -236, -52 },
+  { GG_UINT64_C(0xe45c10c42a2b3b06), -210, -44 },
+  { GG_UINT64_C(0xaa242499697392d3), -183, -36 },
+  { GG_UINT64_C(0xfd87b5f28300ca0e), -157, -28 },
+  { GG_UINT64_C(0xbce5086492111aeb), -130, -20 },
+  { GG_UINT64_C(0x8cbccc096f5088cc), -103, -12 },
+  { GG_UINT64_C(0xd1b71758e219652c), -77, -4 },
+  { GG_UINT64_C(0x9c40000000000000), -50, 4 },
+  { GG_UINT64_C(0xe8d4a51000000000), -24, 12 },
+  { GG_UINT64_C(0xad78ebc5ac620000), 3, 20 },
+  { GG_UINT64_C(0x813f3978f8940984), 30, 28 },
+  { GG_UINT64_C(0xc097ce7bc90715b3), 56, 36 },
+  { GG_UINT64_C(0x8f7e32ce7bea5c70), 83, 44 },
+  { GG_UINT64_C(0xd5d238a4abe98068), 109, 52 },
+  { GG_UINT64_C(0x9f4f2726179a2245), 136, 60 },
+  { GG_UINT64_C(0xed63a231d4c4fb27), 162, 68 },
+  { GG_UINT64_C(0xb0de65388cc8ada8), 189, 76 },
+  { GG_UINT64_C(0x83c7088e1aab65db), 216, 84 },
+  { GG_UINT64_C(0xc45d1df942711d9a), 242, 92 },
+  { GG_UINT64_C(0x924d692ca61be758), 269, 100 },
+  { GG_UINT64_C(0xda01ee641a708dea), 295, 108 },
+  { GG_UINT64_C(0xa26da3999aef774a), 322, 116 },
+  { GG_UINT64_C(0xf209787bb47d6b85), 348, 124 },
+  { GG_UINT64_C(0xb454e4a179dd1877), 375, 132 },
+  { GG_UINT64_C(0x865b86925b9bc5c2), 402, 140 },
+  { GG_UINT64_C(0xc83553c5c8965d3d), 428, 148 },
+  { GG_UINT64_C(0x952ab45cfa97a0b3), 455, 156 },
+  { GG_UINT64_C(0xde469fbd99a05fe3), 481, 164 },
+  { GG_UINT64_C(0xa59bc234db398c25), 508, 172 },
+  { GG_UINT64_C(0xf6c69a72a3989f5c), 534, 180 },
+  { GG_UINT64_C(0xb7dcbf5354e9bece), 561, 188 },
+  { GG_UINT64_C(0x88fcf317f22241e2), 588, 196 },
+  { GG_UINT64_C(0xcc20ce9bd35c78a5), 614, 204 },
+  { GG_UINT64_C(0x98165af37b2153df), 641, 212 },
+  { GG_UINT64_C(0xe2a0b5dc971f303a), 667, 220 },
+  { GG_UINT64_C(0xa8d9d1535ce3b396), 694, 228 },
+  { GG_UINT64_C(0xfb9b7cd9a4a7443c), 720, 236 },
+  { GG_UINT64_C(0xbb764c4ca7a44410), 747, 244 },
+  { GG_UINT64_C(0x8bab8eefb6409c1a), 774, 252 },
+  { GG_UINT64_C(0xd01fef10a657842c), 800, 260 },
+  { GG_UINT64_C(0x9b10a4e5e9913129), 827, 268 },
+  { GG_UINT64_C(0xe7109bfba19c0c9d), 853, 276 },
+  { GG_UINT64_C(0xac2820d9623bf429), 880, 284 },
+  { GG_UINT64_C(0x80444b5e7aa7cf85), 907, 292 },
+  { GG_UINT64_C(0xbf21e44003acdd2d), 933, 300 },
+  { GG_UINT64_C(0x8e679c2f5e44ff8f), 960, 308 },
+  { GG_UINT64_C(0xd433179d9c8cb841), 986, 316 },
+  { GG_UINT64_C(0x9e19db92b4e31ba9), 1013, 324 },
+  { GG_UINT64_C(0xeb96bf6ebadf77d9), 1039, 332 },
+  { GG_UINT64_C(0xaf87023b9bf0ee6b), 1066, 340 },
+};
+
+const int kCachedPowersOffset = 348;  // -kCachedPowers[0].decimal_exponent
+const int kDecimalExponentDistance = 8;
+const double kOneOverLog2Of10 = 0.30102999566398114;  // 1 / lg(10)
+
+// The range of binary exponents the scaled value is brought into, so that
+// its integer part fits in 32 bits and DigitGen() can work on that alone.
+const int kMinimalTargetExponent = -60;
+const int kMaximalTargetExponent = -32;
+
+// Finds a cached power of ten whose binary exponent is between
+// |min_exponent| and |max_exponent|.
+void GetCachedPower(int min_exponent, int* decimal_exponent, DiyFp* power) {
+  int k = static_cast<int>(
+      ceil((min_exponent + kSignificandSize - 1) * kOneOverLog2Of10));
+  int index = (kCachedPowersOffset + k - 1) / kDecimalExponentDistance + 1;
+  DCHECK_GE(index, 0);
+  DCHECK_LT(index, static_cast<int>(arraysize(kCachedPowers)));
+  const CachedPower& cached_power = kCachedPowers[index];
+  DCHECK_LE(min_exponent, cached_power.binary_exponent);
+  *decimal_exponent = cached_power.decimal_exponent;
+  *power = DiyFp(cached_power.significand, cached_power.binary_exponent);
+}
+
+// Sets |power| to the largest power of ten no greater than |number| and
+// |exponent_plus_one| to its exponent plus one, or both to 0 for 0.
+void BiggestPowerOfTen(uint32 number, uint32* power, int* exponent_plus_one) {
+  static const uint32 kPowersOfTen[] = {
+    0, 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000
+  };
+  int exponent = 0;
+  while (exponent + 1 < static_cast<int>(arraysize(kPowersOfTen)) &&
+         number >= kPowersOfTen[exponent + 1]) {
+    ++exponent;
+  }
+  *power = kPowersOfTen[exponent];
+  *exponent_plus_one = exponent;
+}
+
+// Moves the last of |length| digits in |buffer| towards the real value
+// while it stays inside the safe interval, and returns whether the result is
+// then certain to be the closest shortest representation.  |rest| is the
+// distance from the digits to too_high, |ten_kappa| the value of one in the
+// last digit and |unit| the uncertainty of the scaled values, all scaled by
+// the same power of two.
+bool RoundWeed(char* buffer,
+               int length,
+               uint64 distance_too_high_w,
+               uint64 unsafe_interval,
+               uint64 rest,
+               uint64 ten_kappa,
+               uint64 unit) {
+  uint64 small_distance = distance_too_high_w - unit;
+  uint64 big_distance = distance_too_high_w + unit;
+  while (rest < small_distance &&
+         unsafe_interval - rest >= ten_kappa &&
+         (rest + ten_kappa < small_distance ||
+          small_distance - rest >= rest + ten_kappa - small_distance)) {
+    --buffer[length - 1];
+    rest += ten_kappa;
+  }
+
+  // If the digits could still be brought closer the other way round, it is
+  // not known which is closest.
+  if (rest < big_distance &&
+      unsafe_interval - rest >= ten_kappa &&
+      (rest + ten_kappa < big_distance ||
+       big_distance - rest > rest + ten_kappa - big_distance)) {
+    return false;
+  }
+
+  return 2 * unit <= rest && rest <= unsafe_interval - 4 * unit;
+}
+
+// Generates the shortest digits of a number between |low| and |high|, which
+// are scaled so their exponent is in the target range, as close to |w| as
+// it can be sure of.  Sets |kappa| so that the digits times 10^kappa are the
+// scaled number.
+bool DigitGen(const DiyFp& low,
+              const DiyFp& w,
+              const DiyFp& high,
+              char* buffer,
+              int* length,
+              int* kappa) {
+  DCHECK(low.e == w.e && w.e == high.e);
+  DCHECK(kMinimalTargetExponent <= w.e && w.e <= kMaximalTargetExponent);
+  // |low|, |w| and |high| are each out by less than one unit.  Everything
+  // strictly between too_low and too_high may not read back as the double;
+  // everything in the unsafe interval might.
+  uint64 unit = 1;
+  DiyFp too_low(low.f - unit, low.e);
+  DiyFp too_high(high.f + unit, high.e);
+  uint64 unsafe_interval = too_high.f - too_low.f;
+  const int one_shift = -w.e;
+  const uint64 one = GG_UINT64_C(1) << one_shift;
+  uint32 integrals = static_cast<uint32>(too_high.f >> one_shift);
+  uint64 fractionals = too_high.f & (one - 1);
+
+  uint32 divisor;
+  BiggestPowerOfTen(integrals, &divisor, kappa);
+  *length = 0;
+  while (*kappa > 0) {
+    buffer[(*length)++] = static_cast<char>('0' + integrals / divisor);
+    integrals %= divisor;
+    --*kappa;
+    uint64 rest = (static_cast<uint64>(integrals) << one_shift) + fractionals;
+    if (rest < unsafe_interval) {
+      return RoundWeed(buffer, *length, too_high.f - w.f, unsafe_interval,
+                       rest, static_cast<uint64>(divisor) << one_shift, unit);
+    }
+    divisor /= 10;
+  }
+
+  // The integral digits were not enough; go on into the fraction, where the
+  // uncertainty grows with each digit.
+  while (true) {
+    DCHECK_LT(*length, kFastDtoaMaxDigits);
+    fractionals *= 10;
+    unit *= 10;
+    unsafe_interval *= 10;
+    buffer[(*length)++] = static_cast<char>('0' + (fractionals >> one_shift));
+    fractionals &= one - 1;
+    --*kappa;
+    if (fractionals < unsafe_interval) {
+      return RoundWeed(buffer, *length, (too_high.f - w.f) * unit,
+                       unsafe_interval, fractionals, one, unit);
+    }
+  }
+}
+
+}  // namespace
+
+bool FastDtoaShortest(double value,
+                      char* digits,
+                      int* length,
+                      int* decimal_exponent) {
+  DCHECK_GT(value, 0);
+  DiyFp w, boundary_minus, boundary_plus;
+  DecomposeDouble(value, &w, &boundary_minus, &boundary_plus);
+  DCHECK_EQ(boundary_plus.e, w.e);
+
+  // Scale by 10^-k so the exponent lands in the target range.
+  int minus_k;
+  DiyFp ten_minus_k;
+  GetCachedPower(kMinimalTargetExponent - (w.e + kSignificandSize),
+                 &minus_k, &ten_minus_k);
+  DiyFp scaled_w = Multiply(w, ten_minus_k);
+  DiyFp scaled_boundary_minus = Multiply(boundary_minus, ten_minus_k);
+  DiyFp scaled_boundary_plus = Multiply(boundary_plus, ten_minus_k);
+
+  int kappa;
+  bool result = DigitGen(scaled_boundary_minus, scaled_w,
+                         scaled_boundary_plus, digits, length, &kappa);
+  *decimal_exponent = -minus_k + kappa;
+  return result;
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,37 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Shortest round-trip digits for a double by Florian Loitsch's Grisu3
+// ("Printing Floating-Point Numbers Quickly and Accurately with Integers",
+// PLDI 2010).  It works in 64-bit integer arithmetic and, for about 99.5% of
+// doubles, gives the same digits as dmg_fp::dtoa() in mode 0 several times
+// faster.  For the rest it reports that it could not be sure, and dtoa() has
+// to be used instead.
+
+#ifndef BASE_FAST_DTOA_H_
+#define BASE_FAST_DTOA_H_
+#pragma once
+
+#include "base/base_export.h"
+
+namespace base {
+namespace internal {
+
+// The most digits FastDtoaShortest() writes.
+const int kFastDtoaMaxDigits = 17;
+
+// Finds the fewest decimal digits that read back as |value|, which must be
+// positive and finite, choosing the closest to |value| of those.  On success
+// |digits| holds |*length| digits, not NUL terminated, and |value| is
+// closest to digits * 10^|*decimal_exponent|.  |digits| must have room for
+// kFastDtoaMaxDigits characters.
+BASE_EXPORT bool FastDtoaShortest(double value,
+                                  char* digits,
+                                  int* length,
+                                  int* decimal_exponent);
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_FAST_DTOA_H_
@@ -0,0 +1,88 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/fast_dtoa.h"
+
+#include <string.h>
+
+#include <limits>
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/third_party/dmg_fp/dmg_fp.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+double DoubleFromBits(uint64 bits) {
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Checks that when FastDtoaShortest() succeeds for |value| it gives the same
+// digits and decimal point as dmg_fp::dtoa(), and returns whether it did.
+bool MatchesDtoa(double value) {
+  char digits[kFastDtoaMaxDigits];
+  int length = 0;
+  int decimal_exponent = 0;
+  if (!FastDtoaShortest(value, digits, &length, &decimal_exponent))
+    return false;
+
+  int decimal_point;
+  int sign;
+  char* end;
+  char* expected = dmg_fp::dtoa(value, 0, 0, &decimal_point, &sign, &end);
+  EXPECT_EQ(std::string(expected, end), std::string(digits, length))
+      << "for " << value;
+  EXPECT_EQ(decimal_point, decimal_exponent + length) << "for " << value;
+  dmg_fp::freedtoa(expected);
+  return true;
+}
+
+}  // namespace
+
+TEST(FastDtoaTest, Values) {
+  const double kValues[] = {
+    1.0, 0.1, 0.3, 1.25, 5e-324, 1e23, 9007199254740993.0, 123456789012.0,
+    1.33518e+012, 3.141592653589793, 2.2250738585072014e-308,
+    std::numeric_limits<double>::max(), std::numeric_limits<double>::min(),
+    std::numeric_limits<double>::denorm_min(),
+  };
+  for (size_t i = 0; i < arraysize(kValues); ++i)
+    MatchesDtoa(kValues[i]);
+
+  char digits[kFastDtoaMaxDigits];
+  int length = 0;
+  int decimal_exponent = 0;
+  ASSERT_TRUE(FastDtoaShortest(0.1, digits, &length, &decimal_exponent));
+  EXPECT_EQ("1", std::string(digits, length));
+  EXPECT_EQ(-1, decimal_exponent);
+  ASSERT_TRUE(FastDtoaShortest(1.5e300, digits, &length, &decimal_exponent));
+  EXPECT_EQ("15", std::string(digits, length));
+  EXPECT_EQ(299, decimal_exponent);
+}
+
+// Compares against dtoa() over doubles spread across the whole range, and
+// checks that the fast path is taken for almost all of them.
+TEST(FastDtoaTest, MatchesDtoa) {
+  const int kCount = 100000;
+  uint64 state = GG_UINT64_C(0x853c49e6748fea9b);
+  int fast = 0;
+  for (int i = 0; i < kCount; ++i) {
+    state = state * GG_UINT64_C(6364136223846793005) +
+        GG_UINT64_C(1442695040888963407);
+    // Any positive finite double.
+    uint64 bits = (state >> 1) % GG_UINT64_C(0x7FF0000000000000);
+    if (bits && MatchesDtoa(DoubleFromBits(bits)))
+      ++fast;
+  }
+  EXPECT_GT(fast, kCount * 99 / 100);
+}
+
+}  // namespace internal
+}  // namespace base
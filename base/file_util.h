@@ -509,7 +509,10 @@ class BASE_EXPORT FileEnumerator {
   // Returns an empty string if there are no more results.
   FilePath Next();
 
-  // Write the file info into |info|.
+  // Write the file info into |info|.  On POSIX, where the file type usually
+  // comes from the directory listing, this is the first point at which the
+  // file is stat()ed, so enumerations that only need names cost no more
+  // than reading the directories.
   void GetFindInfo(FindInfo* info);
 
   // Looks inside a FindInfo and determines if it's a directory.
@@ -534,12 +537,18 @@ class BASE_EXPORT FileEnumerator {
   struct DirectoryEntryInfo {
     FilePath filename;
     struct stat stat;
+    // False while |stat| holds only the file type from the directory listing.
+    bool has_stat;
   };
 
   // Read the filenames in source into the vector of DirectoryEntryInfo's
   static bool ReadDirectory(std::vector<DirectoryEntryInfo>* entries,
                             const FilePath& source, bool show_links);
 
+  // Fill in the stat of an entry of |source| read without one.
+  static void StatEntry(DirectoryEntryInfo* entry,
+                        const FilePath& source, bool show_links);
+
   // The files in the current directory
   std::vector<DirectoryEntryInfo> directory_entries_;
 
@@ -8,6 +8,8 @@
 #include "base/bind_helpers.h"
 #include "base/file_util.h"
 #include "base/location.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/message_loop_proxy.h"
 #include "base/task_runner.h"
 #include "base/task_runner_util.h"
@@ -187,6 +189,262 @@ class WriteHelper {
   DISALLOW_COPY_AND_ASSIGN(WriteHelper);
 };
 
+void DeleteMappedFile(file_util::MemoryMappedFile* mapped_file) {
+  delete mapped_file;
+}
+
+// The contents of a file mapped by ReadFile().  Unmapping counts as IO, so
+// the file is unmapped on the task runner that mapped it.
+class MappedFileMemory : public RefCountedMemory {
+ public:
+  MappedFileMemory(TaskRunner* task_runner,
+                   file_util::MemoryMappedFile* mapped_file)
+      : task_runner_(task_runner),
+        mapped_file_(mapped_file) {}
+
+  // Overridden from RefCountedMemory:
+  virtual const unsigned char* front() const OVERRIDE {
+    return mapped_file_->data();
+  }
+  virtual size_t size() const OVERRIDE {
+    return mapped_file_->length();
+  }
+
+ private:
+  virtual ~MappedFileMemory() {
+    task_runner_->PostTask(
+        FROM_HERE, Bind(&DeleteMappedFile, mapped_file_.release()));
+  }
+
+  scoped_refptr<TaskRunner> task_runner_;
+  scoped_ptr<file_util::MemoryMappedFile> mapped_file_;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedFileMemory);
+};
+
+class ReadFileHelper {
+ public:
+  explicit ReadFileHelper(TaskRunner* task_runner)
+      : task_runner_(task_runner),
+        error_(PLATFORM_FILE_OK) {}
+
+  void RunWork(const FilePath& file_path) {
+    PlatformFile file = CreatePlatformFile(
+        file_path, PLATFORM_FILE_OPEN | PLATFORM_FILE_READ, NULL, &error_);
+    if (error_ != PLATFORM_FILE_OK)
+      return;
+
+    PlatformFileInfo file_info;
+    if (!GetPlatformFileInfo(file, &file_info) || file_info.is_directory) {
+      error_ = file_info.is_directory ? PLATFORM_FILE_ERROR_NOT_A_FILE :
+                                        PLATFORM_FILE_ERROR_FAILED;
+      ClosePlatformFile(file);
+      return;
+    }
+
+    HintPlatformFileAccess(file, 0, 0, PLATFORM_FILE_ACCESS_SEQUENTIAL);
+    if (file_info.size >= FileUtilProxy::kMinMappedFileSize) {
+      // Start reading the whole file in now, rather than a page at a time as
+      // the caller touches it.
+      HintPlatformFileAccess(file, 0, 0, PLATFORM_FILE_ACCESS_WILL_NEED);
+      scoped_ptr<file_util::MemoryMappedFile> mapped_file(
+          new file_util::MemoryMappedFile);
+      // The mapped file owns |file| from here, even if mapping fails.
+      if (!mapped_file->Initialize(file)) {
+        error_ = PLATFORM_FILE_ERROR_FAILED;
+        return;
+      }
+      data_ = new MappedFileMemory(task_runner_, mapped_file.release());
+      return;
+    }
+
+    // Files like those in /proc report a size of 0 and are read to the end.
+    scoped_refptr<RefCountedString> contents(new RefCountedString);
+    std::string& buffer = contents->data();
+    size_t buffer_size =
+        file_info.size ? static_cast<size_t>(file_info.size) : 4096;
+    while (true) {
+      size_t offset = buffer.size();
+      buffer.resize(offset + buffer_size);
+      int bytes_read = ReadPlatformFile(file, offset, &buffer[offset],
+                                        static_cast<int>(buffer_size));
+      if (bytes_read < 0) {
+        error_ = PLATFORM_FILE_ERROR_FAILED;
+        break;
+      }
+      buffer.resize(offset + bytes_read);
+      // A read of a known size stops there, although the file may have
+      // grown since.
+      if (file_info.size || static_cast<size_t>(bytes_read) < buffer_size)
+        break;
+    }
+    ClosePlatformFile(file);
+    if (error_ == PLATFORM_FILE_OK)
+      data_ = contents;
+  }
+
+  void Reply(const FileUtilProxy::ReadFileCallback& callback) {
+    DCHECK(!callback.is_null());
+    callback.Run(error_, data_);
+  }
+
+ private:
+  scoped_refptr<TaskRunner> task_runner_;
+  PlatformFileError error_;
+  scoped_refptr<RefCountedMemory> data_;
+  DISALLOW_COPY_AND_ASSIGN(ReadFileHelper);
+};
+
+// Reads a file a chunk at a time for ReadInChunks(), going back and forth
+// between the task runner and the caller's thread.
+class ChunkReader : public RefCountedThreadSafe<ChunkReader> {
+ public:
+  ChunkReader(TaskRunner* task_runner,
+              PlatformFile file,
+              int64 offset,
+              char* buffer,
+              int buffer_size,
+              const FileUtilProxy::ReadChunkCallback& callback)
+      : task_runner_(task_runner),
+        file_(file),
+        offset_(offset),
+        buffer_(buffer),
+        buffer_size_(buffer_size),
+        callback_(callback),
+        bytes_read_(0) {}
+
+  bool ReadNextChunk() {
+    return task_runner_->PostTaskAndReply(
+        FROM_HERE,
+        Bind(&ChunkReader::RunWork, this),
+        Bind(&ChunkReader::Reply, this));
+  }
+
+ private:
+  friend class RefCountedThreadSafe<ChunkReader>;
+  ~ChunkReader() {}
+
+  void RunWork() {
+    if (!bytes_read_)
+      HintPlatformFileAccess(file_, offset_, 0,
+                             PLATFORM_FILE_ACCESS_SEQUENTIAL);
+    bytes_read_ = ReadPlatformFile(file_, offset_, buffer_, buffer_size_);
+    if (bytes_read_ == buffer_size_) {
+      offset_ += bytes_read_;
+      // Have the next chunk read in while the caller deals with this one.
+      HintPlatformFileAccess(file_, offset_, buffer_size_,
+                             PLATFORM_FILE_ACCESS_WILL_NEED);
+    }
+  }
+
+  void Reply() {
+    if (bytes_read_ < 0) {
+      callback_.Run(PLATFORM_FILE_ERROR_FAILED, 0, true);
+      return;
+    }
+    bool at_end = bytes_read_ < buffer_size_;
+    if (callback_.Run(PLATFORM_FILE_OK, bytes_read_, at_end) && !at_end &&
+        !ReadNextChunk()) {
+      callback_.Run(PLATFORM_FILE_ERROR_FAILED, 0, true);
+    }
+  }
+
+  scoped_refptr<TaskRunner> task_runner_;
+  PlatformFile file_;
+  // Only used on the task runner.
+  int64 offset_;
+  char* buffer_;
+  int buffer_size_;
+  FileUtilProxy::ReadChunkCallback callback_;
+  int bytes_read_;
+  DISALLOW_COPY_AND_ASSIGN(ChunkReader);
+};
+
+// Walks a directory tree for EnumerateDirectory(), one task for each
+// subdirectory of the root.
+class DirectoryEnumerator : public RefCountedThreadSafe<DirectoryEnumerator> {
+ public:
+  DirectoryEnumerator(TaskRunner* task_runner,
+                      const FilePath& root_path,
+                      file_util::FileEnumerator::FileType file_type,
+                      const FileUtilProxy::EnumerateCallback& entries_callback,
+                      const Closure& done_callback)
+      : task_runner_(task_runner),
+        root_path_(root_path),
+        file_type_(file_type),
+        entries_callback_(entries_callback),
+        done_callback_(done_callback),
+        pending_listings_(0) {}
+
+  bool Start() {
+    return PostListing(root_path_, false);
+  }
+
+ private:
+  friend class RefCountedThreadSafe<DirectoryEnumerator>;
+  ~DirectoryEnumerator() {}
+
+  struct Listing {
+    std::vector<FilePath> entries;
+    // The subdirectories still to be walked.
+    std::vector<FilePath> subdirectories;
+  };
+
+  bool PostListing(const FilePath& path, bool recursive) {
+    Listing* listing = new Listing;
+    if (!task_runner_->PostTaskAndReply(
+            FROM_HERE,
+            Bind(&DirectoryEnumerator::List, path, recursive, file_type_,
+                 listing),
+            Bind(&DirectoryEnumerator::DidList, this, Owned(listing)))) {
+      return false;
+    }
+    ++pending_listings_;
+    return true;
+  }
+
+  // Runs on the task runner.
+  static void List(const FilePath& path,
+                   bool recursive,
+                   file_util::FileEnumerator::FileType file_type,
+                   Listing* listing) {
+    if (!recursive) {
+      file_util::FileEnumerator subdirectories(
+          path, false,
+          static_cast<file_util::FileEnumerator::FileType>(
+              file_util::FileEnumerator::DIRECTORIES |
+              (file_type & ~file_util::FileEnumerator::FILES)));
+      for (FilePath subdirectory = subdirectories.Next();
+           !subdirectory.empty(); subdirectory = subdirectories.Next()) {
+        listing->subdirectories.push_back(subdirectory);
+      }
+    }
+    file_util::FileEnumerator entries(path, recursive, file_type);
+    for (FilePath entry = entries.Next(); !entry.empty();
+         entry = entries.Next()) {
+      listing->entries.push_back(entry);
+    }
+  }
+
+  void DidList(Listing* listing) {
+    --pending_listings_;
+    for (size_t i = 0; i < listing->subdirectories.size(); ++i)
+      PostListing(listing->subdirectories[i], true);
+    if (!listing->entries.empty())
+      entries_callback_.Run(listing->entries);
+    if (!pending_listings_)
+      done_callback_.Run();
+  }
+
+  scoped_refptr<TaskRunner> task_runner_;
+  const FilePath root_path_;
+  const file_util::FileEnumerator::FileType file_type_;
+  FileUtilProxy::EnumerateCallback entries_callback_;
+  Closure done_callback_;
+  // Only used on the thread EnumerateDirectory() was called on.
+  int pending_listings_;
+  DISALLOW_COPY_AND_ASSIGN(DirectoryEnumerator);
+};
 
 PlatformFileError CreateOrOpenAdapter(
     const FilePath& file_path, int file_flags,
@@ -224,6 +482,9 @@ PlatformFileError DeleteAdapter(const FilePath& file_path, bool recursive) {
 
 }  // namespace
 
+// static
+const int64 FileUtilProxy::kMinMappedFileSize = 256 * 1024;
+
 // static
 bool FileUtilProxy::CreateOrOpen(
     TaskRunner* task_runner,
@@ -326,6 +587,34 @@ bool FileUtilProxy::Read(
       Bind(&ReadHelper::Reply, Owned(helper), callback));
 }
 
+// static
+bool FileUtilProxy::ReadFile(
+    TaskRunner* task_runner,
+    const FilePath& file_path,
+    const ReadFileCallback& callback) {
+  ReadFileHelper* helper = new ReadFileHelper(task_runner);
+  return task_runner->PostTaskAndReply(
+      FROM_HERE,
+      Bind(&ReadFileHelper::RunWork, Unretained(helper), file_path),
+      Bind(&ReadFileHelper::Reply, Owned(helper), callback));
+}
+
+// static
+bool FileUtilProxy::ReadInChunks(
+    TaskRunner* task_runner,
+    PlatformFile file,
+    int64 offset,
+    char* buffer,
+    int buffer_size,
+    const ReadChunkCallback& callback) {
+  if (buffer_size <= 0 || buffer == NULL) {
+    return false;
+  }
+  scoped_refptr<ChunkReader> reader(new ChunkReader(
+      task_runner, file, offset, buffer, buffer_size, callback));
+  return reader->ReadNextChunk();
+}
+
 // static
 bool FileUtilProxy::Write(
     TaskRunner* task_runner,
@@ -399,6 +688,19 @@ bool FileUtilProxy::Flush(
       Bind(&CallWithTranslatedParameter, callback));
 }
 
+// static
+bool FileUtilProxy::EnumerateDirectory(
+    TaskRunner* task_runner,
+    const FilePath& root_path,
+    file_util::FileEnumerator::FileType file_type,
+    const EnumerateCallback& entries_callback,
+    const Closure& done_callback) {
+  DCHECK(!(file_type & file_util::FileEnumerator::INCLUDE_DOT_DOT));
+  scoped_refptr<DirectoryEnumerator> enumerator(new DirectoryEnumerator(
+      task_runner, root_path, file_type, entries_callback, done_callback));
+  return enumerator->Start();
+}
+
 // static
 bool FileUtilProxy::RelayFileTask(
     TaskRunner* task_runner,
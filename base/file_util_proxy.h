@@ -5,6 +5,8 @@
 #ifndef BASE_FILE_UTIL_PROXY_H_
 #define BASE_FILE_UTIL_PROXY_H_
 
+#include <vector>
+
 #include "base/base_export.h"
 #include "base/callback_forward.h"
 #include "base/file_path.h"
@@ -18,6 +20,7 @@ class Location;
 
 namespace base {
 
+class RefCountedMemory;
 class TaskRunner;
 class Time;
 
@@ -50,6 +53,14 @@ class BASE_EXPORT FileUtilProxy {
                         int /* bytes read */)> ReadCallback;
   typedef Callback<void(PlatformFileError,
                         int /* bytes written */)> WriteCallback;
+  typedef Callback<void(PlatformFileError,
+                        const scoped_refptr<RefCountedMemory>&)>
+      ReadFileCallback;
+  // Returns false to stop the read.
+  typedef Callback<bool(PlatformFileError,
+                        int /* bytes read */,
+                        bool /* at end */)> ReadChunkCallback;
+  typedef Callback<void(const std::vector<FilePath>&)> EnumerateCallback;
 
   typedef Callback<PlatformFileError(PlatformFile*, bool*)> CreateOrOpenTask;
   typedef Callback<PlatformFileError(PlatformFile)> CloseTask;
@@ -116,6 +127,35 @@ class BASE_EXPORT FileUtilProxy {
       int bytes_to_read,
       const ReadCallback& callback);
 
+  // Reads the whole of the file at |file_path|, telling the system to read it
+  // ahead.  Files of kMinMappedFileSize bytes or more are memory mapped, and
+  // smaller ones read in one go into a buffer of their size.  |callback|
+  // gets the contents, which stay valid for as long as it holds a reference.
+  // It is invalid to pass a null callback.
+  static bool ReadFile(
+      TaskRunner* task_runner,
+      const FilePath& file_path,
+      const ReadFileCallback& callback);
+
+  // Reads |file| from |offset| to its end, |buffer_size| bytes at a time into
+  // |buffer|, calling |callback| with each chunk; a chunk shorter than
+  // |buffer_size| is the last.  The next chunk is read ahead while the
+  // callback runs but only put in |buffer| after it returns, so |buffer| is
+  // the caller's until then.  |buffer| must stay valid until the callback
+  // has been told of the end or an error, or has returned false.  It is
+  // invalid to pass a null callback.
+  static bool ReadInChunks(
+      TaskRunner* task_runner,
+      PlatformFile file,
+      int64 offset,
+      char* buffer,
+      int buffer_size,
+      const ReadChunkCallback& callback);
+
+  // ReadFile() maps files of at least this many bytes rather than reading
+  // them.
+  static const int64 kMinMappedFileSize;
+
   // Writes to a file. If |offset| is greater than the length of the file,
   // |false| is returned. On success, the file pointer is moved to position
   // |offset + bytes_to_write| in the file. The callback can be null.
@@ -168,6 +208,20 @@ class BASE_EXPORT FileUtilProxy {
       PlatformFile file,
       const StatusCallback& callback);
 
+  // Lists everything under |root_path| that matches |file_type|, as a
+  // recursive file_util::FileEnumerator would.  |root_path| is listed first
+  // and each of its subdirectories then walked by a task of its own, so a
+  // SequencedWorkerPool walks them in parallel.  |entries_callback| is run
+  // with each batch of paths found, in no particular order, and
+  // |done_callback| once they have all been found.  INCLUDE_DOT_DOT may not
+  // be given.
+  static bool EnumerateDirectory(
+      TaskRunner* task_runner,
+      const FilePath& root_path,
+      file_util::FileEnumerator::FileType file_type,
+      const EnumerateCallback& entries_callback,
+      const Closure& done_callback);
+
   // Relay helpers.
   static bool RelayFileTask(
       TaskRunner* task_runner,
@@ -5,13 +5,16 @@
 #include "base/file_util_proxy.h"
 
 #include <map>
+#include <set>
 
 #include "base/bind.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/memory/weak_ptr.h"
 #include "base/message_loop.h"
 #include "base/platform_file.h"
 #include "base/scoped_temp_dir.h"
+#include "base/stringprintf.h"
 #include "base/threading/thread.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -26,6 +29,8 @@ class FileUtilProxyTest : public testing::Test {
         created_(false),
         file_(kInvalidPlatformFileValue),
         bytes_written_(-1),
+        chunks_(0),
+        chunks_wanted_(-1),
         weak_factory_(ALLOW_THIS_IN_INITIALIZER_LIST(this)) {}
 
   virtual void SetUp() OVERRIDE {
@@ -77,6 +82,31 @@ class FileUtilProxyTest : public testing::Test {
     MessageLoop::current()->Quit();
   }
 
+  void DidReadFile(PlatformFileError error,
+                   const scoped_refptr<RefCountedMemory>& data) {
+    error_ = error;
+    data_ = data;
+    MessageLoop::current()->Quit();
+  }
+
+  bool DidReadChunk(const char* chunk,
+                    PlatformFileError error,
+                    int bytes_read,
+                    bool at_end) {
+    error_ = error;
+    buffer_.insert(buffer_.end(), chunk, chunk + bytes_read);
+    ++chunks_;
+    bool more = !at_end && chunks_ != chunks_wanted_;
+    if (!more)
+      MessageLoop::current()->Quit();
+    return more;
+  }
+
+  void DidEnumerate(const std::vector<FilePath>& entries) {
+    for (size_t i = 0; i < entries.size(); ++i)
+      EXPECT_TRUE(entries_.insert(entries[i]).second);
+  }
+
   void DidWrite(PlatformFileError error,
                 int bytes_written) {
     error_ = error;
@@ -113,6 +143,10 @@ class FileUtilProxyTest : public testing::Test {
   PlatformFileInfo file_info_;
   std::vector<char> buffer_;
   int bytes_written_;
+  scoped_refptr<RefCountedMemory> data_;
+  int chunks_;
+  int chunks_wanted_;
+  std::set<FilePath> entries_;
   WeakPtrFactory<FileUtilProxyTest> weak_factory_;
 };
 
@@ -291,6 +325,153 @@ TEST_F(FileUtilProxyTest, Read) {
   }
 }
 
+TEST_F(FileUtilProxyTest, ReadFile) {
+  // One file small enough to be read, and one big enough to be mapped.
+  const int64 kSizes[] = { 1000, FileUtilProxy::kMinMappedFileSize + 1000 };
+  for (size_t i = 0; i < arraysize(kSizes); ++i) {
+    std::string expected_data;
+    for (int j = 0; j < kSizes[i]; ++j)
+      expected_data.push_back(static_cast<char>(j % 251));
+    FilePath path = test_dir_path().AppendASCII(i ? "mapped" : "read");
+    ASSERT_EQ(static_cast<int>(expected_data.size()),
+              file_util::WriteFile(path, expected_data.data(),
+                                   expected_data.size()));
+
+    FileUtilProxy::ReadFile(
+        file_task_runner(),
+        path,
+        Bind(&FileUtilProxyTest::DidReadFile, weak_factory_.GetWeakPtr()));
+    MessageLoop::current()->Run();
+
+    EXPECT_EQ(PLATFORM_FILE_OK, error_);
+    ASSERT_TRUE(data_.get());
+    ASSERT_EQ(expected_data.size(), data_->size());
+    EXPECT_EQ(0, memcmp(expected_data.data(), data_->front(),
+                        expected_data.size()));
+    data_ = NULL;
+  }
+}
+
+TEST_F(FileUtilProxyTest, ReadFile_Empty) {
+  file_util::WriteFile(test_path(), NULL, 0);
+  FileUtilProxy::ReadFile(
+      file_task_runner(),
+      test_path(),
+      Bind(&FileUtilProxyTest::DidReadFile, weak_factory_.GetWeakPtr()));
+  MessageLoop::current()->Run();
+
+  EXPECT_EQ(PLATFORM_FILE_OK, error_);
+  ASSERT_TRUE(data_.get());
+  EXPECT_EQ(0u, data_->size());
+}
+
+TEST_F(FileUtilProxyTest, ReadFile_Errors) {
+  FileUtilProxy::ReadFile(
+      file_task_runner(),
+      test_path(),
+      Bind(&FileUtilProxyTest::DidReadFile, weak_factory_.GetWeakPtr()));
+  MessageLoop::current()->Run();
+  EXPECT_EQ(PLATFORM_FILE_ERROR_NOT_FOUND, error_);
+  EXPECT_FALSE(data_.get());
+
+  FileUtilProxy::ReadFile(
+      file_task_runner(),
+      test_dir_path(),
+      Bind(&FileUtilProxyTest::DidReadFile, weak_factory_.GetWeakPtr()));
+  MessageLoop::current()->Run();
+  EXPECT_NE(PLATFORM_FILE_OK, error_);
+  EXPECT_FALSE(data_.get());
+}
+
+TEST_F(FileUtilProxyTest, ReadInChunks) {
+  std::string expected_data;
+  for (int i = 0; i < 1000; ++i)
+    expected_data.push_back(static_cast<char>(i));
+  ASSERT_EQ(static_cast<int>(expected_data.size()),
+            file_util::WriteFile(test_path(), expected_data.data(),
+                                 expected_data.size()));
+
+  char chunk[64];
+  FileUtilProxy::ReadInChunks(
+      file_task_runner(),
+      GetTestPlatformFile(PLATFORM_FILE_OPEN | PLATFORM_FILE_READ),
+      10,  // offset
+      chunk,
+      sizeof(chunk),
+      Bind(&FileUtilProxyTest::DidReadChunk, Unretained(this), chunk));
+  MessageLoop::current()->Run();
+
+  EXPECT_EQ(PLATFORM_FILE_OK, error_);
+  EXPECT_EQ(16, chunks_);
+  EXPECT_EQ(expected_data.substr(10),
+            std::string(buffer_.begin(), buffer_.end()));
+}
+
+TEST_F(FileUtilProxyTest, ReadInChunks_Stop) {
+  std::string expected_data(1000, 'x');
+  ASSERT_EQ(static_cast<int>(expected_data.size()),
+            file_util::WriteFile(test_path(), expected_data.data(),
+                                 expected_data.size()));
+
+  char chunk[100];
+  chunks_wanted_ = 3;
+  FileUtilProxy::ReadInChunks(
+      file_task_runner(),
+      GetTestPlatformFile(PLATFORM_FILE_OPEN | PLATFORM_FILE_READ),
+      0,  // offset
+      chunk,
+      sizeof(chunk),
+      Bind(&FileUtilProxyTest::DidReadChunk, Unretained(this), chunk));
+  MessageLoop::current()->Run();
+
+  EXPECT_EQ(PLATFORM_FILE_OK, error_);
+  EXPECT_EQ(3, chunks_);
+  EXPECT_EQ(300u, buffer_.size());
+}
+
+TEST_F(FileUtilProxyTest, EnumerateDirectory) {
+  std::set<FilePath> expected_files;
+  std::set<FilePath> expected_entries;
+  for (int i = 0; i < 4; ++i) {
+    FilePath dir = test_dir_path().AppendASCII(StringPrintf("dir%d", i));
+    ASSERT_TRUE(file_util::CreateDirectory(dir.AppendASCII("inner")));
+    expected_entries.insert(dir);
+    expected_entries.insert(dir.AppendASCII("inner"));
+    for (int j = 0; j < 3; ++j) {
+      FilePath file = (j ? dir.AppendASCII("inner") : dir).AppendASCII(
+          StringPrintf("file%d", j));
+      ASSERT_EQ(1, file_util::WriteFile(file, "x", 1));
+      expected_files.insert(file);
+      expected_entries.insert(file);
+    }
+  }
+  FilePath root_file = test_dir_path().AppendASCII("root_file");
+  ASSERT_EQ(1, file_util::WriteFile(root_file, "x", 1));
+  expected_files.insert(root_file);
+  expected_entries.insert(root_file);
+
+  EXPECT_TRUE(FileUtilProxy::EnumerateDirectory(
+      file_task_runner(),
+      test_dir_path(),
+      static_cast<file_util::FileEnumerator::FileType>(
+          file_util::FileEnumerator::FILES |
+          file_util::FileEnumerator::DIRECTORIES),
+      Bind(&FileUtilProxyTest::DidEnumerate, weak_factory_.GetWeakPtr()),
+      MessageLoop::QuitClosure()));
+  MessageLoop::current()->Run();
+  EXPECT_TRUE(expected_entries == entries_);
+
+  entries_.clear();
+  EXPECT_TRUE(FileUtilProxy::EnumerateDirectory(
+      file_task_runner(),
+      test_dir_path(),
+      file_util::FileEnumerator::FILES,
+      Bind(&FileUtilProxyTest::DidEnumerate, weak_factory_.GetWeakPtr()),
+      MessageLoop::QuitClosure()));
+  MessageLoop::current()->Run();
+  EXPECT_TRUE(expected_files == entries_);
+}
+
 TEST_F(FileUtilProxyTest, WriteAndFlush) {
   const char data[] = "foo!";
   int data_bytes = ARRAYSIZE_UNSAFE(data);
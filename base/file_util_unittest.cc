@@ -1790,6 +1790,47 @@ TEST_F(FileUtilTest, FileEnumeratorTest) {
                                             // (we don't care what).
 }
 
+#if defined(OS_POSIX)
+TEST_F(FileUtilTest, FileEnumeratorFindInfo) {
+  FilePath dir = temp_dir_.path().Append(FILE_PATH_LITERAL("dir"));
+  ASSERT_TRUE(file_util::CreateDirectory(dir));
+  FilePath file = temp_dir_.path().Append(FILE_PATH_LITERAL("file.txt"));
+  ASSERT_EQ(5, file_util::WriteFile(file, "12345", 5));
+  FilePath link = temp_dir_.path().Append(FILE_PATH_LITERAL("link"));
+  ASSERT_TRUE(file_util::CreateSymbolicLink(dir, link));
+
+  // The stat of each entry, filled in when asked for, is that of the file
+  // or of what the link points at.
+  file_util::FileEnumerator enumerator(temp_dir_.path(), false,
+                                       FILES_AND_DIRECTORIES);
+  int found = 0;
+  for (FilePath path = enumerator.Next(); !path.empty();
+       path = enumerator.Next(), ++found) {
+    file_util::FileEnumerator::FindInfo info;
+    enumerator.GetFindInfo(&info);
+    EXPECT_EQ(path.BaseName().value(), info.filename);
+    if (path == file) {
+      EXPECT_FALSE(file_util::FileEnumerator::IsDirectory(info));
+      EXPECT_EQ(5, file_util::FileEnumerator::GetFilesize(info));
+    } else {
+      EXPECT_TRUE(file_util::FileEnumerator::IsDirectory(info));
+      EXPECT_FALSE(file_util::FileEnumerator::IsLink(info));
+    }
+  }
+  EXPECT_EQ(3, found);
+
+  // Showing links, the link is a file of its own.
+  file_util::FileEnumerator links(temp_dir_.path(), false,
+      static_cast<file_util::FileEnumerator::FileType>(
+          file_util::FileEnumerator::FILES |
+          file_util::FileEnumerator::SHOW_SYM_LINKS));
+  FindResultCollector collector(links);
+  EXPECT_TRUE(collector.HasFile(file));
+  EXPECT_TRUE(collector.HasFile(link));
+  EXPECT_EQ(2, collector.size());
+}
+#endif  // defined(OS_POSIX)
+
 TEST_F(FileUtilTest, AppendToFile) {
   FilePath data_dir =
       temp_dir_.path().Append(FILE_PATH_LITERAL("FilePathTest"));
@@ -7,6 +7,9 @@
 
 #include "base/files/file_path_watcher.h"
 
+#include <map>
+
+#include "base/bind.h"
 #include "base/logging.h"
 #include "base/message_loop.h"
 
@@ -40,6 +43,82 @@ class FilePathWatcherDelegate : public base::files::FilePathWatcher::Delegate {
 
 }  // namespace
 
+// Collects the changes for a WatchForChanges() watch, on the thread it was
+// started on, and hands them to the callback a batch at a time until |impl|
+// is cancelled.
+class FilePathWatcher::ChangeCoalescer : public FilePathWatcher::Delegate {
+ public:
+  ChangeCoalescer(PlatformDelegate* impl,
+                  TimeDelta delay,
+                  const ChangesCallback& callback)
+      : impl_(impl),
+        delay_(delay),
+        callback_(callback),
+        flush_pending_(false) {}
+
+  // FilePathWatcher::Delegate implementation.
+  virtual void OnFilePathChanged(const FilePath& path) OVERRIDE {
+    OnFileChanged(path, CHANGE_MODIFIED);
+  }
+
+  virtual void OnFileChanged(const FilePath& path, ChangeType type) OVERRIDE {
+    std::map<FilePath, size_t>::iterator index = indices_.find(path);
+    if (index == indices_.end()) {
+      indices_[path] = changes_.size();
+      changes_.push_back(Change(path, type));
+    } else if (changes_[index->second].type != CHANGE_CREATED ||
+               type != CHANGE_MODIFIED) {
+      changes_[index->second].type = type;
+    }
+
+    if (!flush_pending_) {
+      flush_pending_ = true;
+      MessageLoop::current()->PostDelayedTask(
+          FROM_HERE, base::Bind(&ChangeCoalescer::Flush, this), delay_);
+    }
+  }
+
+  virtual void OnFilePathError(const FilePath& path) OVERRIDE {
+    Run(true);
+  }
+
+ private:
+  virtual ~ChangeCoalescer() {}
+
+  void Flush() {
+    flush_pending_ = false;
+    if (!changes_.empty())
+      Run(false);
+  }
+
+  void Run(bool error) {
+    ChangeList changes;
+    changes.swap(changes_);
+    indices_.clear();
+    if (!impl_->is_cancelled())
+      callback_.Run(changes, error);
+  }
+
+  // Dropped by |impl_| when it is cancelled, which breaks the cycle.
+  scoped_refptr<PlatformDelegate> impl_;
+  const TimeDelta delay_;
+  ChangesCallback callback_;
+
+  // The changes since the last batch, and where each path is in them.
+  ChangeList changes_;
+  std::map<FilePath, size_t> indices_;
+
+  // Whether a task to hand over |changes_| has been posted.
+  bool flush_pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(ChangeCoalescer);
+};
+
+FilePathWatcher::Change::Change(const FilePath& path, ChangeType type)
+    : path(path),
+      type(type) {
+}
+
 FilePathWatcher::~FilePathWatcher() {
   impl_->Cancel();
 }
@@ -62,9 +141,27 @@ FilePathWatcher::PlatformDelegate::~PlatformDelegate() {
   DCHECK(is_cancelled());
 }
 
+bool FilePathWatcher::PlatformDelegate::WatchForChanges(const FilePath& path,
+                                                        bool recursive,
+                                                        Delegate* delegate) {
+  if (recursive)
+    return false;
+  return Watch(path, delegate);
+}
+
 bool FilePathWatcher::Watch(const FilePath& path, const Callback& callback) {
   return Watch(path, new FilePathWatcherDelegate(callback));
 }
 
+bool FilePathWatcher::WatchForChanges(const FilePath& path,
+                                      bool recursive,
+                                      TimeDelta coalesce_delay,
+                                      const ChangesCallback& callback) {
+  DCHECK(path.IsAbsolute());
+  scoped_refptr<ChangeCoalescer> coalescer(
+      new ChangeCoalescer(impl_, coalesce_delay, callback));
+  return impl_->WatchForChanges(path, recursive, coalescer);
+}
+
 }  // namespace files
 }  // namespace base
@@ -8,12 +8,15 @@
 #define BASE_FILES_FILE_PATH_WATCHER_H_
 #pragma once
 
+#include <vector>
+
 #include "base/base_export.h"
 #include "base/basictypes.h"
 #include "base/callback.h"
 #include "base/file_path.h"
 #include "base/memory/ref_counted.h"
 #include "base/message_loop_proxy.h"
+#include "base/time.h"
 
 namespace base {
 namespace files {
@@ -34,6 +37,26 @@ class BASE_EXPORT FilePathWatcher {
   // that case, the callback won't be invoked again.
   typedef base::Callback<void(const FilePath& path, bool error)> Callback;
 
+  // How a path changed, as reported to a ChangesCallback.
+  enum ChangeType {
+    CHANGE_CREATED,
+    CHANGE_DELETED,
+    CHANGE_MODIFIED,
+  };
+
+  struct BASE_EXPORT Change {
+    Change(const FilePath& path, ChangeType type);
+
+    FilePath path;
+    ChangeType type;
+  };
+  typedef std::vector<Change> ChangeList;
+
+  // Callback type for WatchForChanges(). |changes| holds each path that
+  // changed since the last call, once, and |error| is as for Callback.
+  typedef base::Callback<void(const ChangeList& changes, bool error)>
+      ChangesCallback;
+
   // Declares the callback client code implements to receive notifications. Note
   // that implementations of this interface should not keep a reference to the
   // corresponding FileWatcher object to prevent a reference cycle.
@@ -45,6 +68,12 @@ class BASE_EXPORT FilePathWatcher {
     // Called when platform specific code detected an error. The watcher will
     // not call OnFilePathChanged for future changes.
     virtual void OnFilePathError(const FilePath& path) {}
+    // Called instead of OnFilePathChanged() for watches started with
+    // PlatformDelegate::WatchForChanges(), with the path that changed, which
+    // is inside the watched path when that is a directory, and how.
+    virtual void OnFileChanged(const FilePath& path, ChangeType type) {
+      OnFilePathChanged(path);
+    }
 
    protected:
     friend class base::RefCountedThreadSafe<Delegate>;
@@ -62,6 +91,14 @@ class BASE_EXPORT FilePathWatcher {
     virtual bool Watch(const FilePath& path,
                        Delegate* delegate) WARN_UNUSED_RESULT = 0;
 
+    // Start watching |path|, and everything under it if |recursive|, and
+    // notify |delegate| of each change through OnFileChanged(). The default
+    // implementation reports changes the way Watch() does, to |path| itself,
+    // and doesn't support |recursive|.
+    virtual bool WatchForChanges(const FilePath& path,
+                                 bool recursive,
+                                 Delegate* delegate) WARN_UNUSED_RESULT;
+
     // Stop watching. This is called from FilePathWatcher's dtor in order to
     // allow to shut down properly while the object is still alive.
     // It can be called from any thread.
@@ -124,7 +161,25 @@ class BASE_EXPORT FilePathWatcher {
   // be invoked on the same loop. Returns true on success.
   bool Watch(const FilePath& path, const Callback& callback);
 
+  // Invokes |callback| with batches of changes to |path|, or to anything
+  // below it when |path| is a directory and |recursive| is true. The first
+  // change starts a wait of |coalesce_delay|, and everything that changes in
+  // that time is reported in one call, each path once with its latest kind
+  // of change; a file created and then written in the same batch is
+  // CHANGE_CREATED. Even with no delay, the changes the system reports
+  // together are batched. Otherwise this is as the Watch() above, which it
+  // is used instead of. Only Linux detects the kind of change and supports
+  // |recursive|; elsewhere changes are to |path| and CHANGE_MODIFIED, and
+  // asking for |recursive| fails.
+  bool WatchForChanges(const FilePath& path,
+                       bool recursive,
+                       TimeDelta coalesce_delay,
+                       const ChangesCallback& callback);
+
  private:
+  // Batches the changes for WatchForChanges().
+  class ChangeCoalescer;
+
   scoped_refptr<PlatformDelegate> impl_;
 
   DISALLOW_COPY_AND_ASSIGN(FilePathWatcher);
@@ -4,6 +4,7 @@
 
 #include "base/files/file_path_watcher.h"
 
+#include <map>
 #include <set>
 
 #if defined(OS_WIN)
@@ -693,6 +694,144 @@ TEST_F(FilePathWatcherTest, LinkedDirectoryPart3) {
   ASSERT_TRUE(WaitForEvents());
 }
 
+// Collects the batches from WatchForChanges() on the test thread, and quits
+// its loop once an expected change comes in.
+class ChangeCollector : public base::RefCountedThreadSafe<ChangeCollector> {
+ public:
+  ChangeCollector()
+      : loop_(base::MessageLoopProxy::current()),
+        batches_(0),
+        expected_type_(FilePathWatcher::CHANGE_MODIFIED) {}
+
+  // Called on the file thread.
+  void OnChanges(const FilePathWatcher::ChangeList& changes, bool error) {
+    EXPECT_FALSE(error);
+    loop_->PostTask(FROM_HERE,
+                    base::Bind(&ChangeCollector::RecordChanges, this,
+                               changes));
+  }
+
+  void Expect(const FilePath& path, FilePathWatcher::ChangeType type) {
+    expected_path_ = path;
+    expected_type_ = type;
+  }
+
+  // The latest kind of change for each path.
+  const std::map<FilePath, FilePathWatcher::ChangeType>& changes() const {
+    return changes_;
+  }
+  int batches() const { return batches_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<ChangeCollector>;
+  ~ChangeCollector() {}
+
+  void RecordChanges(const FilePathWatcher::ChangeList& changes) {
+    ++batches_;
+    std::set<FilePath> paths;
+    for (size_t i = 0; i < changes.size(); ++i) {
+      // Each path is in a batch once.
+      EXPECT_TRUE(paths.insert(changes[i].path).second);
+      changes_[changes[i].path] = changes[i].type;
+    }
+    std::map<FilePath, FilePathWatcher::ChangeType>::const_iterator change =
+        changes_.find(expected_path_);
+    if (change != changes_.end() && change->second == expected_type_)
+      loop_->PostTask(FROM_HERE, MessageLoop::QuitClosure());
+  }
+
+  scoped_refptr<base::MessageLoopProxy> loop_;
+  std::map<FilePath, FilePathWatcher::ChangeType> changes_;
+  int batches_;
+  FilePath expected_path_;
+  FilePathWatcher::ChangeType expected_type_;
+};
+
+void SetupWatchForChanges(const FilePath& target,
+                          bool recursive,
+                          FilePathWatcher* watcher,
+                          ChangeCollector* collector,
+                          bool* result,
+                          base::WaitableEvent* completion) {
+  *result = watcher->WatchForChanges(
+      target, recursive, TimeDelta::FromMilliseconds(100),
+      base::Bind(&ChangeCollector::OnChanges, collector));
+  completion->Signal();
+}
+
+// Verify that a burst of changes to a directory comes in a few batches, each
+// naming what changed and how.
+TEST_F(FilePathWatcherTest, CoalescedChanges) {
+  FilePath dir(temp_dir_.path().AppendASCII("dir"));
+  ASSERT_TRUE(file_util::CreateDirectory(dir));
+  FilePathWatcher watcher;
+  scoped_refptr<ChangeCollector> changes(new ChangeCollector);
+  base::WaitableEvent completion(false, false);
+  bool result = false;
+  file_thread_.message_loop_proxy()->PostTask(
+      FROM_HERE,
+      base::Bind(SetupWatchForChanges, dir, false, &watcher, changes,
+                 &result, &completion));
+  completion.Wait();
+  ASSERT_TRUE(result);
+
+  const int kFiles = 100;
+  for (int i = 0; i < kFiles; ++i)
+    ASSERT_TRUE(WriteFile(dir.AppendASCII(StringPrintf("file%d", i)), "x"));
+  ASSERT_TRUE(file_util::Delete(dir.AppendASCII("file0"), false));
+  changes->Expect(dir.AppendASCII(StringPrintf("file%d", kFiles - 1)),
+                  FilePathWatcher::CHANGE_CREATED);
+  loop_.Run();
+
+  EXPECT_LT(changes->batches(), kFiles);
+  loop_.PostDelayedTask(FROM_HERE,
+                        MessageLoop::QuitClosure(),
+                        TestTimeouts::tiny_timeout());
+  loop_.Run();
+  ASSERT_EQ(static_cast<size_t>(kFiles), changes->changes().size());
+  EXPECT_EQ(FilePathWatcher::CHANGE_DELETED,
+            changes->changes().find(dir.AppendASCII("file0"))->second);
+  EXPECT_EQ(FilePathWatcher::CHANGE_CREATED,
+            changes->changes().find(dir.AppendASCII("file1"))->second);
+}
+
+// Verify that a recursive watch sees changes in new and old subdirectories.
+TEST_F(FilePathWatcherTest, RecursiveChanges) {
+  FilePath dir(temp_dir_.path().AppendASCII("dir"));
+  FilePath old_subdir(dir.AppendASCII("old"));
+  ASSERT_TRUE(file_util::CreateDirectory(old_subdir));
+  FilePathWatcher watcher;
+  scoped_refptr<ChangeCollector> changes(new ChangeCollector);
+  base::WaitableEvent completion(false, false);
+  bool result = false;
+  file_thread_.message_loop_proxy()->PostTask(
+      FROM_HERE,
+      base::Bind(SetupWatchForChanges, dir, true, &watcher, changes,
+                 &result, &completion));
+  completion.Wait();
+  ASSERT_TRUE(result);
+
+  FilePath old_file(old_subdir.AppendASCII("file"));
+  ASSERT_TRUE(WriteFile(old_file, "content"));
+  changes->Expect(old_file, FilePathWatcher::CHANGE_CREATED);
+  loop_.Run();
+
+  FilePath new_file(dir.AppendASCII("new").AppendASCII("inner")
+                       .AppendASCII("file"));
+  ASSERT_TRUE(file_util::CreateDirectory(new_file.DirName()));
+  ASSERT_TRUE(WriteFile(new_file, "content"));
+  changes->Expect(new_file, FilePathWatcher::CHANGE_CREATED);
+  loop_.Run();
+
+  ASSERT_TRUE(file_util::Delete(dir.AppendASCII("new"), true));
+  changes->Expect(new_file, FilePathWatcher::CHANGE_DELETED);
+  loop_.Run();
+
+  ASSERT_TRUE(WriteFile(old_file, "new content"));
+  changes->Expect(old_file, FilePathWatcher::CHANGE_MODIFIED);
+  loop_.Run();
+}
+
 #endif  // OS_LINUX
 
 enum Permission {
@@ -12,6 +12,7 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <map>
 #include <set>
 #include <utility>
 #include <vector>
@@ -37,7 +38,8 @@ namespace {
 
 class FilePathWatcherImpl;
 
-// Singleton to manage all inotify watches.
+// Singleton to manage all inotify watches. Watchers of the same directory
+// share its watch descriptor.
 // TODO(tony): It would be nice if this wasn't a singleton.
 // http://crbug.com/38174
 class InotifyReader {
@@ -91,16 +93,19 @@ class FilePathWatcherImpl : public FilePathWatcher::PlatformDelegate,
 
   // Called for each event coming from the watch. |fired_watch| identifies the
   // watch that fired, |child| indicates what has changed, and is relative to
-  // the currently watched path for |fired_watch|. The flag |created| is true if
-  // the object appears.
+  // the currently watched path for |fired_watch|. |mask| is the inotify event
+  // mask.
   void OnFilePathChanged(InotifyReader::Watch fired_watch,
                          const FilePath::StringType& child,
-                         bool created);
+                         uint32 mask);
 
   // Start watching |path| for changes and notify |delegate| on each change.
   // Returns true if watch for |path| has been added successfully.
   virtual bool Watch(const FilePath& path,
                      FilePathWatcher::Delegate* delegate) OVERRIDE;
+  virtual bool WatchForChanges(const FilePath& path,
+                               bool recursive,
+                               FilePathWatcher::Delegate* delegate) OVERRIDE;
 
   // Cancel the watch. This unregisters the instance with InotifyReader.
   virtual void Cancel() OVERRIDE;
@@ -132,13 +137,40 @@ class FilePathWatcherImpl : public FilePathWatcher::PlatformDelegate,
   };
   typedef std::vector<WatchEntry> WatchVector;
 
+  // The directories below |target_| watched in recursive mode, by watch.
+  typedef std::map<InotifyReader::Watch, FilePath> SubdirWatchMap;
+
+  bool StartWatching(const FilePath& path,
+                     bool recursive,
+                     bool report_changes,
+                     FilePathWatcher::Delegate* delegate) WARN_UNUSED_RESULT;
+
   // Reconfigure to watch for the most specific parent directory of |target_|
   // that exists. Updates |watched_path_|. Returns true on success.
   bool UpdateWatches() WARN_UNUSED_RESULT;
 
+  // Handles a change to |path|, one of the entries of the directories
+  // watched below |target_| in recursive mode or of |target_| itself.
+  // Returns false if the directories could not all be watched.
+  bool OnEntryChanged(const FilePath& path, uint32 mask) WARN_UNUSED_RESULT;
+
+  // Watches the directory |dir| and every directory below it, reporting
+  // everything in them as created if |report_entries|. Returns false if a
+  // directory that still exists could not be watched.
+  bool AddSubtreeWatches(const FilePath& dir,
+                         bool report_entries) WARN_UNUSED_RESULT;
+
+  // Stops watching |dir| and the directories below it.
+  void RemoveSubtreeWatches(const FilePath& dir);
+
   // Delegate to notify upon changes.
   scoped_refptr<FilePathWatcher::Delegate> delegate_;
 
+  // Whether changes are reported with their paths and kinds through
+  // OnFileChanged(), and whether the directories below |target_| are watched.
+  bool report_changes_;
+  bool recursive_;
+
   // The file or directory we're supposed to watch.
   FilePath target_;
 
@@ -147,9 +179,19 @@ class FilePathWatcherImpl : public FilePathWatcher::PlatformDelegate,
   // |target_| and always stores an empty next component name in |subdir_|.
   WatchVector watches_;
 
+  SubdirWatchMap subdir_watches_;
+
   DISALLOW_COPY_AND_ASSIGN(FilePathWatcherImpl);
 };
 
+FilePathWatcher::ChangeType ChangeTypeForMask(uint32 mask) {
+  if (mask & (IN_CREATE | IN_MOVED_TO))
+    return FilePathWatcher::CHANGE_CREATED;
+  if (mask & (IN_DELETE | IN_MOVED_FROM))
+    return FilePathWatcher::CHANGE_DELETED;
+  return FilePathWatcher::CHANGE_MODIFIED;
+}
+
 void InotifyReaderCallback(InotifyReader* reader, int inotify_fd,
                            int shutdown_fd) {
   // Make sure the file descriptors are good for use with select().
@@ -288,19 +330,19 @@ void InotifyReader::OnInotifyEvent(const inotify_event* event) {
   for (WatcherSet::iterator watcher = watchers_[event->wd].begin();
        watcher != watchers_[event->wd].end();
        ++watcher) {
-    (*watcher)->OnFilePathChanged(event->wd,
-                                  child,
-                                  event->mask & (IN_CREATE | IN_MOVED_TO));
+    (*watcher)->OnFilePathChanged(event->wd, child, event->mask);
   }
 }
 
 FilePathWatcherImpl::FilePathWatcherImpl()
-    : delegate_(NULL) {
+    : delegate_(NULL),
+      report_changes_(false),
+      recursive_(false) {
 }
 
 void FilePathWatcherImpl::OnFilePathChanged(InotifyReader::Watch fired_watch,
                                             const FilePath::StringType& child,
-                                            bool created) {
+                                            uint32 mask) {
   if (!message_loop()->BelongsToCurrentThread()) {
     // Switch to message_loop_ to access watches_ safely.
     message_loop()->PostTask(FROM_HERE,
@@ -308,12 +350,23 @@ void FilePathWatcherImpl::OnFilePathChanged(InotifyReader::Watch fired_watch,
                    this,
                    fired_watch,
                    child,
-                   created));
+                   mask));
     return;
   }
 
   DCHECK(MessageLoopForIO::current());
 
+  if (recursive_ && !child.empty()) {
+    SubdirWatchMap::const_iterator subdir = subdir_watches_.find(fired_watch);
+    if (subdir != subdir_watches_.end()) {
+      if (!OnEntryChanged(subdir->second.Append(child), mask))
+        delegate_->OnFilePathError(target_);
+      return;
+    }
+  }
+
+  bool created = (mask & (IN_CREATE | IN_MOVED_TO)) != 0;
+
   // Find the entry in |watches_| that corresponds to |fired_watch|.
   WatchVector::const_iterator watch_entry(watches_.begin());
   for ( ; watch_entry != watches_.end(); ++watch_entry) {
@@ -353,7 +406,16 @@ void FilePathWatcherImpl::OnFilePathChanged(InotifyReader::Watch fired_watch,
       if (target_changed ||
           (change_on_target_path && !created) ||
           (change_on_target_path && file_util::PathExists(target_))) {
-        delegate_->OnFilePathChanged(target_);
+        if (!report_changes_) {
+          delegate_->OnFilePathChanged(target_);
+        } else if (watch_entry->subdir_.empty() &&
+                   watch_entry->linkname_.empty() && !child.empty()) {
+          // An entry of the watched directory.
+          if (!OnEntryChanged(target_.Append(child), mask))
+            delegate_->OnFilePathError(target_);
+        } else {
+          delegate_->OnFileChanged(target_, ChangeTypeForMask(mask));
+        }
         return;
       }
     }
@@ -362,12 +424,27 @@ void FilePathWatcherImpl::OnFilePathChanged(InotifyReader::Watch fired_watch,
 
 bool FilePathWatcherImpl::Watch(const FilePath& path,
                                 FilePathWatcher::Delegate* delegate) {
+  return StartWatching(path, false, false, delegate);
+}
+
+bool FilePathWatcherImpl::WatchForChanges(const FilePath& path,
+                                          bool recursive,
+                                          FilePathWatcher::Delegate* delegate) {
+  return StartWatching(path, recursive, true, delegate);
+}
+
+bool FilePathWatcherImpl::StartWatching(const FilePath& path,
+                                        bool recursive,
+                                        bool report_changes,
+                                        FilePathWatcher::Delegate* delegate) {
   DCHECK(target_.empty());
   DCHECK(MessageLoopForIO::current());
 
   set_message_loop(base::MessageLoopProxy::current());
   delegate_ = delegate;
   target_ = path;
+  recursive_ = recursive;
+  report_changes_ = report_changes;
   MessageLoop::current()->AddDestructionObserver(this);
 
   std::vector<FilePath::StringType> comps;
@@ -414,6 +491,7 @@ void FilePathWatcherImpl::CancelOnMessageLoopThread() {
       g_inotify_reader.Get().RemoveWatch(watch_entry->watch_, this);
   }
   watches_.clear();
+  RemoveSubtreeWatches(target_);
   target_.clear();
 }
 
@@ -470,9 +548,79 @@ bool FilePathWatcherImpl::UpdateWatches() {
     path = path.Append(watch_entry->subdir_);
   }
 
+  if (recursive_) {
+    // Watch the directories below |target_| while it is there; they are then
+    // kept up to date as they come and go.
+    if (watches_.back().watch_ == InotifyReader::kInvalidWatch)
+      RemoveSubtreeWatches(target_);
+    else if (subdir_watches_.empty())
+      return AddSubtreeWatches(target_, false);
+  }
+
+  return true;
+}
+
+bool FilePathWatcherImpl::OnEntryChanged(const FilePath& path, uint32 mask) {
+  delegate_->OnFileChanged(path, ChangeTypeForMask(mask));
+  if (!recursive_ || !(mask & IN_ISDIR))
+    return true;
+  if (mask & (IN_CREATE | IN_MOVED_TO))
+    return AddSubtreeWatches(path, true);
+  if (mask & (IN_DELETE | IN_MOVED_FROM))
+    RemoveSubtreeWatches(path);
+  return true;
+}
+
+bool FilePathWatcherImpl::AddSubtreeWatches(const FilePath& dir,
+                                            bool report_entries) {
+  // |target_| itself is watched by the last of |watches_|.
+  if (dir != target_) {
+    InotifyReader::Watch watch = g_inotify_reader.Get().AddWatch(dir, this);
+    if (watch == InotifyReader::kInvalidWatch)
+      return !file_util::DirectoryExists(dir);
+    subdir_watches_[watch] = dir;
+  }
+
+  // Anything already in a new directory appeared before it could be watched.
+  if (report_entries) {
+    file_util::FileEnumerator entries(dir, true,
+        static_cast<file_util::FileEnumerator::FileType>(
+            file_util::FileEnumerator::FILES |
+            file_util::FileEnumerator::DIRECTORIES));
+    for (FilePath entry = entries.Next(); !entry.empty();
+         entry = entries.Next()) {
+      delegate_->OnFileChanged(entry, FilePathWatcher::CHANGE_CREATED);
+    }
+  }
+
+  file_util::FileEnumerator subdirs(dir, true,
+                                    file_util::FileEnumerator::DIRECTORIES);
+  for (FilePath subdir = subdirs.Next(); !subdir.empty();
+       subdir = subdirs.Next()) {
+    InotifyReader::Watch watch =
+        g_inotify_reader.Get().AddWatch(subdir, this);
+    if (watch == InotifyReader::kInvalidWatch) {
+      if (file_util::DirectoryExists(subdir))
+        return false;
+      continue;
+    }
+    subdir_watches_[watch] = subdir;
+  }
   return true;
 }
 
+void FilePathWatcherImpl::RemoveSubtreeWatches(const FilePath& dir) {
+  SubdirWatchMap::iterator subdir = subdir_watches_.begin();
+  while (subdir != subdir_watches_.end()) {
+    if (subdir->second == dir || dir.IsParent(subdir->second)) {
+      g_inotify_reader.Get().RemoveWatch(subdir->first, this);
+      subdir_watches_.erase(subdir++);
+    } else {
+      ++subdir;
+    }
+  }
+}
+
 }  // namespace
 
 FilePathWatcher::FilePathWatcher() {
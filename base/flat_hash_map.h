@@ -0,0 +1,492 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// FlatHashMap is a hash map that keeps its entries in one flat array instead
+// of a node per entry, for maps that are looked up far more than they are
+// iterated or changed.  It has the subset of the base::hash_map interface
+// that such maps use.
+//
+// Next to the array of entries is an array of one control byte per entry,
+// telling whether the entry is empty, deleted, or full, and if full, seven
+// bits of the hash of its key.  A lookup loads a group of eight or sixteen
+// control bytes at once and compares all of them to the seven bits of the
+// key's hash with a few SSE2 or integer instructions, and then looks at only
+// the entries that match, which are nearly always just the one it wants.  So
+// a lookup costs two cache misses at most and no pointer chasing, and an
+// insertion costs no allocation until the array has to grow.
+//
+// Unlike base::hash_map:
+//  - Any insertion may grow the array, which moves every entry and
+//    invalidates all iterators, pointers and references into the map.
+//    Erasing invalidates only iterators to the erased entry.
+//  - Keys and values are copied when the array grows, so they should be
+//    cheap to copy, such as integers and pointers.
+//  - The Hash functor should hash every bit of the key it cares about; the
+//    map mixes the result itself, so identity hashes of integers and
+//    pointers are fine.
+
+#ifndef BASE_FLAT_HASH_MAP_H_
+#define BASE_FLAT_HASH_MAP_H_
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+#include <utility>
+
+#include "base/basictypes.h"
+#include "base/hash_tables.h"
+#include "base/logging.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY) && (defined(__SSE2__) || \
+    defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define FLAT_HASH_MAP_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#endif
+
+namespace base {
+
+// The hash FlatHashMap uses unless given another: the one base::hash_map
+// uses.
+template <class Key>
+struct FlatHashMapDefaultHash {
+  size_t operator()(const Key& key) const {
+#if defined(COMPILER_MSVC)
+    return stdext::hash_value(key);
+#else
+    return BASE_HASH_NAMESPACE::hash<Key>()(key);
+#endif
+  }
+};
+
+namespace internal {
+
+// A control byte.  Full entries hold seven bits of their hash, 0 to 127;
+// the others are negative.
+typedef signed char FlatHashMapCtrl;
+const FlatHashMapCtrl kFlatHashMapEmpty = -128;
+const FlatHashMapCtrl kFlatHashMapDeleted = -2;
+
+inline int FlatHashMapCountTrailingZeros(uint64 mask) {
+#if defined(COMPILER_MSVC)
+  unsigned long index;
+  if (_BitScanForward(&index, static_cast<uint32>(mask)))
+    return index;
+  _BitScanForward(&index, static_cast<uint32>(mask >> 32));
+  return index + 32;
+#else
+  return __builtin_ctzll(mask);
+#endif
+}
+
+// A group of control bytes, compared all at once.  Each Match function
+// returns a mask with one bit set for each matching byte; shifting the
+// position of the lowest bit right by |kShift| gives the byte's index.
+#if defined(FLAT_HASH_MAP_USE_SSE2)
+class FlatHashMapGroup {
+ public:
+  enum { kWidth = 16, kShift = 0 };
+
+  explicit FlatHashMapGroup(const FlatHashMapCtrl* ctrl)
+      : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {
+  }
+
+  uint64 Match(FlatHashMapCtrl h2) const {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_));
+  }
+
+  uint64 MatchEmpty() const {
+    return _mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_set1_epi8(kFlatHashMapEmpty), ctrl_));
+  }
+
+  // Empty and deleted are the only bytes below -1.
+  uint64 MatchEmptyOrDeleted() const {
+    return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl_));
+  }
+
+ private:
+  __m128i ctrl_;
+};
+#else
+// Eight bytes in a uint64, compared with the carry tricks from "Bit Twiddling
+// Hacks".  Match() may report a byte next to a true match as matching too,
+// which only costs a key comparison.
+class FlatHashMapGroup {
+ public:
+  enum { kWidth = 8, kShift = 3 };
+
+  explicit FlatHashMapGroup(const FlatHashMapCtrl* ctrl) : ctrl_(0) {
+    for (int i = 0; i < kWidth; ++i)
+      ctrl_ |= static_cast<uint64>(static_cast<uint8>(ctrl[i])) << (i * 8);
+  }
+
+  uint64 Match(FlatHashMapCtrl h2) const {
+    uint64 x = ctrl_ ^ (kLsbs * static_cast<uint8>(h2));
+    return (x - kLsbs) & ~x & kMsbs;
+  }
+
+  // Empty is the only byte with the high bit set and bit 1 clear.
+  uint64 MatchEmpty() const {
+    return ctrl_ & (~ctrl_ << 6) & kMsbs;
+  }
+
+  uint64 MatchEmptyOrDeleted() const {
+    return ctrl_ & kMsbs;
+  }
+
+ private:
+  static const uint64 kLsbs = GG_UINT64_C(0x0101010101010101);
+  static const uint64 kMsbs = GG_UINT64_C(0x8080808080808080);
+
+  uint64 ctrl_;
+};
+#endif
+
+}  // namespace internal
+
+template <class Key, class Value, class Hash = FlatHashMapDefaultHash<Key> >
+class FlatHashMap {
+ public:
+  typedef Key key_type;
+  typedef Value mapped_type;
+  typedef std::pair<const Key, Value> value_type;
+  typedef size_t size_type;
+
+  class const_iterator;
+
+  class iterator {
+   public:
+    iterator() : map_(NULL), index_(0) {}
+
+    value_type& operator*() const { return map_->slots_[index_]; }
+    value_type* operator->() const { return &map_->slots_[index_]; }
+
+    iterator& operator++() {
+      index_ = map_->SkipEmpty(index_ + 1);
+      return *this;
+    }
+
+    bool operator==(const iterator& other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const iterator& other) const {
+      return index_ != other.index_;
+    }
+
+   private:
+    friend class FlatHashMap;
+    friend class const_iterator;
+
+    iterator(const FlatHashMap* map, size_t index)
+        : map_(map), index_(index) {
+    }
+
+    const FlatHashMap* map_;
+    size_t index_;
+  };
+
+  class const_iterator {
+   public:
+    const_iterator() : map_(NULL), index_(0) {}
+    const_iterator(const iterator& other)
+        : map_(other.map_), index_(other.index_) {
+    }
+
+    const value_type& operator*() const { return map_->slots_[index_]; }
+    const value_type* operator->() const { return &map_->slots_[index_]; }
+
+    const_iterator& operator++() {
+      index_ = map_->SkipEmpty(index_ + 1);
+      return *this;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return index_ != other.index_;
+    }
+
+   private:
+    friend class FlatHashMap;
+
+    const_iterator(const FlatHashMap* map, size_t index)
+        : map_(map), index_(index) {
+    }
+
+    const FlatHashMap* map_;
+    size_t index_;
+  };
+
+  FlatHashMap()
+      : ctrl_(NULL), slots_(NULL), capacity_(0), size_(0), growth_left_(0) {
+  }
+
+  FlatHashMap(const FlatHashMap& other)
+      : ctrl_(NULL), slots_(NULL), capacity_(0), size_(0), growth_left_(0) {
+    reserve(other.size());
+    for (const_iterator i = other.begin(); i != other.end(); ++i)
+      insert(*i);
+  }
+
+  ~FlatHashMap() {
+    DestroySlots();
+    delete[] ctrl_;
+    ::operator delete(slots_);
+  }
+
+  FlatHashMap& operator=(const FlatHashMap& other) {
+    if (this != &other) {
+      FlatHashMap copy(other);
+      swap(copy);
+    }
+    return *this;
+  }
+
+  void swap(FlatHashMap& other) {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growth_left_, other.growth_left_);
+    std::swap(hash_, other.hash_);
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  iterator begin() { return iterator(this, SkipEmpty(0)); }
+  const_iterator begin() const { return const_iterator(this, SkipEmpty(0)); }
+  iterator end() { return iterator(this, capacity_); }
+  const_iterator end() const { return const_iterator(this, capacity_); }
+
+  iterator find(const Key& key) {
+    return iterator(this, FindIndex(key, HashOf(key)));
+  }
+  const_iterator find(const Key& key) const {
+    return const_iterator(this, FindIndex(key, HashOf(key)));
+  }
+
+  size_t count(const Key& key) const {
+    return find(key) != end() ? 1 : 0;
+  }
+
+  // Inserts |value| unless its key is already there.  Returns the entry with
+  // the key, and whether it was inserted.
+  std::pair<iterator, bool> insert(const value_type& value) {
+    std::pair<size_t, bool> result = FindOrPrepareInsert(value.first);
+    if (result.second)
+      new (&slots_[result.first]) value_type(value);
+    return std::make_pair(iterator(this, result.first), result.second);
+  }
+
+  Value& operator[](const Key& key) {
+    std::pair<size_t, bool> result = FindOrPrepareInsert(key);
+    if (result.second)
+      new (&slots_[result.first]) value_type(key, Value());
+    return slots_[result.first].second;
+  }
+
+  void erase(iterator pos) {
+    EraseIndex(pos.index_);
+  }
+
+  size_t erase(const Key& key) {
+    size_t index = FindIndex(key, HashOf(key));
+    if (index == capacity_)
+      return 0;
+    EraseIndex(index);
+    return 1;
+  }
+
+  // Removes every entry, keeping the arrays for the entries to come.
+  void clear() {
+    DestroySlots();
+    if (capacity_)
+      memset(ctrl_, kEmpty, capacity_ + kWidth - 1);
+    size_ = 0;
+    growth_left_ = MaxSize(capacity_);
+  }
+
+  // Makes room for |count| entries in all without growing again.
+  void reserve(size_t count) {
+    if (!count)
+      return;
+    size_t capacity = kWidth;
+    while (MaxSize(capacity) < count)
+      capacity *= 2;
+    if (capacity > capacity_)
+      Resize(capacity);
+  }
+
+ private:
+  typedef internal::FlatHashMapCtrl Ctrl;
+  typedef internal::FlatHashMapGroup Group;
+
+  enum { kWidth = Group::kWidth };
+  static const Ctrl kEmpty = internal::kFlatHashMapEmpty;
+  static const Ctrl kDeleted = internal::kFlatHashMapDeleted;
+
+  // The most entries an array of |capacity| holds before it grows: 7/8.
+  static size_t MaxSize(size_t capacity) {
+    return capacity - capacity / 8;
+  }
+
+  // Spreads the bits of the hash over all 64, so that the low bits and the
+  // top seven both depend on all of them.
+  uint64 HashOf(const Key& key) const {
+    return static_cast<uint64>(hash_(key)) *
+        GG_UINT64_C(0x9E3779B97F4A7C15);
+  }
+
+  // Where the probe for |hash| starts, and the seven bits kept in the
+  // control byte.
+  static size_t H1(uint64 hash) {
+    return static_cast<size_t>((hash ^ (hash >> 32)) >> 7);
+  }
+  static Ctrl H2(uint64 hash) {
+    return static_cast<Ctrl>(hash >> 57);
+  }
+
+  // The first full entry at or after |index|, or |capacity_|.
+  size_t SkipEmpty(size_t index) const {
+    while (index < capacity_ && ctrl_[index] < 0)
+      ++index;
+    return index;
+  }
+
+  // Groups are loaded from any control byte, so the first kWidth - 1 bytes
+  // are repeated after the last one; a group starting near the end wraps
+  // around to the start.
+  void SetCtrl(size_t index, Ctrl ctrl) {
+    ctrl_[index] = ctrl;
+    ctrl_[((index - (kWidth - 1)) & (capacity_ - 1)) + (kWidth - 1)] = ctrl;
+  }
+
+  // The index of the entry with |key|, or |capacity_| if there is none.
+  // Probes one group after another, each further on than the last, until a
+  // group with an empty entry shows that the key was never put further on.
+  size_t FindIndex(const Key& key, uint64 hash) const {
+    if (!capacity_)
+      return capacity_;
+    size_t mask = capacity_ - 1;
+    size_t pos = H1(hash) & mask;
+    Ctrl h2 = H2(hash);
+    for (size_t step = kWidth; ; step += kWidth) {
+      Group group(ctrl_ + pos);
+      for (uint64 match = group.Match(h2); match; match &= match - 1) {
+        size_t index =
+            (pos + (internal::FlatHashMapCountTrailingZeros(match) >>
+                    Group::kShift)) & mask;
+        if (slots_[index].first == key)
+          return index;
+      }
+      if (group.MatchEmpty())
+        return capacity_;
+      pos = (pos + step) & mask;
+    }
+  }
+
+  // The first empty or deleted entry on the probe for |hash|.
+  size_t FindFirstNonFull(uint64 hash) const {
+    size_t mask = capacity_ - 1;
+    size_t pos = H1(hash) & mask;
+    for (size_t step = kWidth; ; step += kWidth) {
+      uint64 match = Group(ctrl_ + pos).MatchEmptyOrDeleted();
+      if (match) {
+        return (pos + (internal::FlatHashMapCountTrailingZeros(match) >>
+                       Group::kShift)) & mask;
+      }
+      pos = (pos + step) & mask;
+    }
+  }
+
+  // Returns the index of the entry with |key| and false, or if there is
+  // none, the index of a new entry for it to be constructed in and true.
+  std::pair<size_t, bool> FindOrPrepareInsert(const Key& key) {
+    uint64 hash = HashOf(key);
+    size_t index = FindIndex(key, hash);
+    if (index != capacity_)
+      return std::make_pair(index, false);
+
+    if (!growth_left_) {
+      // Deleted entries count against the growth left, so a map that mostly
+      // churns is cleaned up in place instead of growing forever.
+      Resize(capacity_ && size_ < MaxSize(capacity_) / 2 ?
+                 capacity_ : std::max<size_t>(capacity_ * 2, kWidth));
+    }
+    index = FindFirstNonFull(hash);
+    if (ctrl_[index] == kEmpty)
+      --growth_left_;
+    SetCtrl(index, H2(hash));
+    ++size_;
+    return std::make_pair(index, true);
+  }
+
+  void EraseIndex(size_t index) {
+    DCHECK_LT(index, capacity_);
+    DCHECK_GE(ctrl_[index], 0);
+    slots_[index].~value_type();
+    SetCtrl(index, kDeleted);
+    --size_;
+  }
+
+  void DestroySlots() {
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] >= 0)
+        slots_[i].~value_type();
+    }
+  }
+
+  // Moves every entry into new arrays of |capacity|, dropping the deleted
+  // ones.
+  void Resize(size_t capacity) {
+    DCHECK_GE(capacity, static_cast<size_t>(kWidth));
+    DCHECK_EQ(0u, capacity & (capacity - 1));
+    Ctrl* old_ctrl = ctrl_;
+    value_type* old_slots = slots_;
+    size_t old_capacity = capacity_;
+
+    ctrl_ = new Ctrl[capacity + kWidth - 1];
+    memset(ctrl_, kEmpty, capacity + kWidth - 1);
+    slots_ = static_cast<value_type*>(
+        ::operator new(capacity * sizeof(value_type)));
+    capacity_ = capacity;
+    growth_left_ = MaxSize(capacity) - size_;
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (old_ctrl[i] < 0)
+        continue;
+      uint64 hash = HashOf(old_slots[i].first);
+      size_t index = FindFirstNonFull(hash);
+      SetCtrl(index, H2(hash));
+      new (&slots_[index]) value_type(old_slots[i]);
+      old_slots[i].~value_type();
+    }
+    delete[] old_ctrl;
+    ::operator delete(old_slots);
+  }
+
+  // |capacity_| control bytes, and then copies of the first kWidth - 1.
+  Ctrl* ctrl_;
+  // |capacity_| entries, constructed where the control byte is full.
+  value_type* slots_;
+  // 0, or a power of two no less than kWidth.
+  size_t capacity_;
+  size_t size_;
+  // How many more empty entries may be filled before the arrays grow.
+  size_t growth_left_;
+  Hash hash_;
+};
+
+}  // namespace base
+
+#endif  // BASE_FLAT_HASH_MAP_H_
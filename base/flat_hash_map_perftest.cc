@@ -0,0 +1,77 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "base/flat_hash_map.h"
+#include "base/hash_tables.h"
+#include "base/perftimer.h"
+#include "base/rand_util.h"
+#include "base/stringprintf.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kLookups = 10000000;
+
+// Fills a map with |size| random keys, then times looking up keys of which
+// half are in it.
+template <class Map>
+void TimeLookups(const char* name, int size) {
+  Map map;
+  std::vector<int> keys;
+  for (int i = 0; i < size; ++i) {
+    int key = base::RandInt(0, kint32max);
+    map[key] = i;
+    keys.push_back(key);
+    keys.push_back(base::RandInt(0, kint32max));
+  }
+
+  int found = 0;
+  PerfTimer timer;
+  for (int i = 0; i < kLookups; ++i)
+    found += map.find(keys[i % keys.size()]) != map.end();
+  LogPerfResult(base::StringPrintf("%s_lookup_%d", name, size).c_str(),
+                timer.Elapsed().InMicroseconds() * 1000.0 / kLookups, "ns");
+  EXPECT_GE(found, kLookups / 2);
+}
+
+// Times inserting |size| keys into an empty map and erasing them again.
+template <class Map>
+void TimeInsertErase(const char* name, int size) {
+  std::vector<int> keys;
+  for (int i = 0; i < size; ++i)
+    keys.push_back(base::RandInt(0, kint32max));
+
+  int rounds = kLookups / size;
+  PerfTimer timer;
+  for (int round = 0; round < rounds; ++round) {
+    Map map;
+    for (int i = 0; i < size; ++i)
+      map[keys[i]] = i;
+    for (int i = 0; i < size; ++i)
+      map.erase(keys[i]);
+  }
+  LogPerfResult(base::StringPrintf("%s_insert_erase_%d", name, size).c_str(),
+                timer.Elapsed().InMicroseconds() * 1000.0 / (rounds * size),
+                "ns");
+}
+
+const int kSizes[] = { 1, 16, 1000, 1000000 };
+
+}  // namespace
+
+TEST(FlatHashMapPerfTest, Lookup) {
+  for (size_t i = 0; i < arraysize(kSizes); ++i) {
+    TimeLookups<base::hash_map<int, int> >("hash_map", kSizes[i]);
+    TimeLookups<base::FlatHashMap<int, int> >("FlatHashMap", kSizes[i]);
+  }
+}
+
+TEST(FlatHashMapPerfTest, InsertErase) {
+  for (size_t i = 0; i < arraysize(kSizes); ++i) {
+    TimeInsertErase<base::hash_map<int, int> >("hash_map", kSizes[i]);
+    TimeInsertErase<base::FlatHashMap<int, int> >("FlatHashMap", kSizes[i]);
+  }
+}
@@ -0,0 +1,160 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/flat_hash_map.h"
+
+#include <map>
+#include <string>
+
+#include "base/rand_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Sends every key down the same probe, to test the probing past full groups.
+struct ConstantHash {
+  size_t operator()(int key) const { return 42; }
+};
+
+// Checks that |map| holds exactly what |expected| does, by lookup and by
+// iteration.
+template <class Map>
+void ExpectSame(const std::map<int, int>& expected, const Map& map) {
+  ASSERT_EQ(expected.size(), map.size());
+  for (std::map<int, int>::const_iterator i = expected.begin();
+       i != expected.end(); ++i) {
+    typename Map::const_iterator found = map.find(i->first);
+    ASSERT_TRUE(found != map.end()) << i->first;
+    EXPECT_EQ(i->first, found->first);
+    EXPECT_EQ(i->second, found->second);
+  }
+  size_t visited = 0;
+  for (typename Map::const_iterator i = map.begin(); i != map.end(); ++i) {
+    EXPECT_EQ(1u, expected.count(i->first));
+    ++visited;
+  }
+  EXPECT_EQ(expected.size(), visited);
+}
+
+// Applies random insertions and erasures to a FlatHashMap and a std::map,
+// and checks that they agree.
+template <class Map>
+void RandomOperations(int key_range, int operations) {
+  Map map;
+  std::map<int, int> expected;
+  for (int i = 0; i < operations; ++i) {
+    int key = RandInt(0, key_range);
+    switch (RandInt(0, 3)) {
+      case 0:
+      case 1: {
+        std::pair<typename Map::iterator, bool> result =
+            map.insert(std::make_pair(key, i));
+        EXPECT_EQ(expected.insert(std::make_pair(key, i)).second,
+                  result.second);
+        EXPECT_EQ(expected[key], result.first->second);
+        break;
+      }
+      case 2:
+        EXPECT_EQ(expected.erase(key), map.erase(key));
+        break;
+      case 3:
+        map[key] = i;
+        expected[key] = i;
+        break;
+    }
+    if (i % 1000 == 0)
+      ExpectSame(expected, map);
+  }
+  ExpectSame(expected, map);
+}
+
+}  // namespace
+
+TEST(FlatHashMapTest, Basic) {
+  FlatHashMap<int, std::string> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.begin() == map.end());
+  EXPECT_TRUE(map.find(1) == map.end());
+  EXPECT_EQ(0u, map.erase(1));
+
+  EXPECT_TRUE(map.insert(std::make_pair(1, std::string("one"))).second);
+  EXPECT_FALSE(map.insert(std::make_pair(1, std::string("uno"))).second);
+  map[2] = "two";
+  EXPECT_EQ(2u, map.size());
+  EXPECT_EQ("one", map.find(1)->second);
+  EXPECT_EQ("two", map[2]);
+  EXPECT_EQ(1u, map.count(2));
+  EXPECT_EQ(0u, map.count(3));
+
+  map.erase(map.find(1));
+  EXPECT_TRUE(map.find(1) == map.end());
+  EXPECT_EQ(1u, map.size());
+  EXPECT_EQ(1u, map.erase(2));
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.begin() == map.end());
+}
+
+TEST(FlatHashMapTest, Grow) {
+  FlatHashMap<int, int> map;
+  std::map<int, int> expected;
+  for (int i = 0; i < 10000; ++i) {
+    map[i * 1024] = i;
+    expected[i * 1024] = i;
+  }
+  ExpectSame(expected, map);
+  EXPECT_TRUE(map.find(1) == map.end());
+  EXPECT_TRUE(map.find(10000 * 1024) == map.end());
+}
+
+TEST(FlatHashMapTest, CopyAndClear) {
+  FlatHashMap<int, int> map;
+  std::map<int, int> expected;
+  for (int i = 0; i < 100; ++i) {
+    map[i] = -i;
+    expected[i] = -i;
+  }
+
+  FlatHashMap<int, int> copy(map);
+  ExpectSame(expected, copy);
+  FlatHashMap<int, int> assigned;
+  assigned[1000] = 1;
+  assigned = map;
+  ExpectSame(expected, assigned);
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.begin() == map.end());
+  EXPECT_TRUE(map.find(5) == map.end());
+  map[5] = 6;
+  EXPECT_EQ(6, map[5]);
+  ExpectSame(expected, copy);
+}
+
+TEST(FlatHashMapTest, Random) {
+  RandomOperations<FlatHashMap<int, int> >(100, 100000);
+  RandomOperations<FlatHashMap<int, int> >(10000, 100000);
+}
+
+TEST(FlatHashMapTest, Collisions) {
+  RandomOperations<FlatHashMap<int, int, ConstantHash> >(200, 20000);
+}
+
+TEST(FlatHashMapTest, Churn) {
+  // Keys that come and go leave deleted entries behind; the map must clean
+  // them up instead of growing without bound or looping.
+  FlatHashMap<int, int> map;
+  for (int i = 0; i < 100000; ++i) {
+    map[i] = i;
+    if (i >= 10) {
+      EXPECT_EQ(1u, map.erase(i - 10));
+    }
+  }
+  EXPECT_EQ(10u, map.size());
+  for (int i = 99990; i < 100000; ++i)
+    EXPECT_EQ(i, map[i]);
+}
+
+}  // namespace base
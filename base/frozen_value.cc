@@ -0,0 +1,580 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/frozen_value.h"
+
+#include <string.h>
+
+#include <map>
+
+#include "base/logging.h"
+#include "base/memory/arena.h"
+#include "base/utf_string_conversions.h"
+
+namespace base {
+
+// A value.  Every node of the tree is one of these, in its parent's array of
+// items or members, or in the arena on its own for the root.
+struct FrozenValue::Node {
+  Value::Type type;
+  // The length of a string or binary value, or the number of items of a
+  // list or members of a dictionary.
+  uint32 size;
+  union {
+    bool boolean_value;
+    int integer_value;
+    double double_value;
+    const char* data;
+    const Node* items;
+    const Member* members;
+  };
+};
+
+// A dictionary entry.  |key| is shared by every member with the same key.
+struct FrozenValue::Member {
+  const char* key;
+  uint32 key_length;
+  Node value;
+};
+
+namespace {
+
+size_t AlignSize(size_t size) {
+  return (size + Arena::kAlignment - 1) & ~(Arena::kAlignment - 1);
+}
+
+}  // namespace
+
+// Lays a Value tree out in an arena.  Measure() works out how much memory
+// the tree needs, so that Fill() can take all of it from a single block.
+class FrozenValue::Builder {
+ public:
+  Builder();
+
+  void Measure(const Value& value);
+  size_t size() const { return size_; }
+
+  // Fills in |node| from |value|, taking its arrays and strings from
+  // |arena|, which must be fresh when the root is filled.
+  void Fill(const Value& value, Node* node, Arena* arena);
+
+ private:
+  void AddBytes(size_t size);
+
+  // Copies |size| bytes into the arena.
+  const char* CopyBytes(const char* data, size_t size, Arena* arena);
+
+  // Each distinct key, and where it is in the arena once it is there.
+  typedef std::map<std::string, const char*> KeyMap;
+  KeyMap keys_;
+
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(Builder);
+};
+
+FrozenValue::Builder::Builder() : size_(0) {
+}
+
+void FrozenValue::Builder::Measure(const Value& value) {
+  switch (value.GetType()) {
+    case Value::TYPE_STRING: {
+      std::string string_value;
+      value.GetAsString(&string_value);
+      AddBytes(string_value.size());
+      break;
+    }
+    case Value::TYPE_BINARY:
+      AddBytes(static_cast<const BinaryValue&>(value).GetSize());
+      break;
+    case Value::TYPE_DICTIONARY: {
+      const DictionaryValue& dictionary =
+          static_cast<const DictionaryValue&>(value);
+      AddBytes(dictionary.size() * sizeof(Member));
+      for (DictionaryValue::key_iterator it = dictionary.begin_keys();
+           it != dictionary.end_keys(); ++it) {
+        const std::string& key = *it;
+        if (keys_.insert(std::make_pair(key, static_cast<const char*>(NULL)))
+                .second) {
+          AddBytes(key.size());
+        }
+        Value* child = NULL;
+        dictionary.GetWithoutPathExpansion(key, &child);
+        Measure(*child);
+      }
+      break;
+    }
+    case Value::TYPE_LIST: {
+      const ListValue& list = static_cast<const ListValue&>(value);
+      AddBytes(list.GetSize() * sizeof(Node));
+      for (ListValue::const_iterator it = list.begin(); it != list.end();
+           ++it) {
+        Measure(**it);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void FrozenValue::Builder::Fill(const Value& value, Node* node,
+                                Arena* arena) {
+  node->type = value.GetType();
+  node->size = 0;
+  node->data = NULL;
+  switch (node->type) {
+    case Value::TYPE_NULL:
+      break;
+    case Value::TYPE_BOOLEAN:
+      value.GetAsBoolean(&node->boolean_value);
+      break;
+    case Value::TYPE_INTEGER:
+      value.GetAsInteger(&node->integer_value);
+      break;
+    case Value::TYPE_DOUBLE:
+      value.GetAsDouble(&node->double_value);
+      break;
+    case Value::TYPE_STRING: {
+      std::string string_value;
+      value.GetAsString(&string_value);
+      node->size = static_cast<uint32>(string_value.size());
+      node->data = CopyBytes(string_value.data(), string_value.size(), arena);
+      break;
+    }
+    case Value::TYPE_BINARY: {
+      const BinaryValue& binary = static_cast<const BinaryValue&>(value);
+      node->size = static_cast<uint32>(binary.GetSize());
+      node->data = CopyBytes(binary.GetBuffer(), binary.GetSize(), arena);
+      break;
+    }
+    case Value::TYPE_DICTIONARY: {
+      const DictionaryValue& dictionary =
+          static_cast<const DictionaryValue&>(value);
+      node->size = static_cast<uint32>(dictionary.size());
+      if (dictionary.empty())
+        break;
+      Member* members = static_cast<Member*>(
+          arena->Allocate(dictionary.size() * sizeof(Member)));
+      node->members = members;
+      // The map iterates in key order, which is the order FindMember()
+      // bisects in.
+      for (DictionaryValue::key_iterator it = dictionary.begin_keys();
+           it != dictionary.end_keys(); ++it, ++members) {
+        const std::string& key = *it;
+        const char*& interned_key = keys_[key];
+        if (!interned_key)
+          interned_key = CopyBytes(key.data(), key.size(), arena);
+        members->key = interned_key;
+        members->key_length = static_cast<uint32>(key.size());
+        Value* child = NULL;
+        dictionary.GetWithoutPathExpansion(key, &child);
+        Fill(*child, &members->value, arena);
+      }
+      break;
+    }
+    case Value::TYPE_LIST: {
+      const ListValue& list = static_cast<const ListValue&>(value);
+      node->size = static_cast<uint32>(list.GetSize());
+      if (list.empty())
+        break;
+      Node* items =
+          static_cast<Node*>(arena->Allocate(list.GetSize() * sizeof(Node)));
+      node->items = items;
+      for (ListValue::const_iterator it = list.begin(); it != list.end();
+           ++it, ++items) {
+        Fill(**it, items, arena);
+      }
+      break;
+    }
+    default:
+      NOTREACHED();
+  }
+}
+
+void FrozenValue::Builder::AddBytes(size_t size) {
+  if (size)
+    size_ += AlignSize(size);
+}
+
+const char* FrozenValue::Builder::CopyBytes(const char* data, size_t size,
+                                            Arena* arena) {
+  // Empty strings all point at the same place; the size says not to read it.
+  if (!size)
+    return "";
+  char* copy = static_cast<char*>(arena->Allocate(size));
+  memcpy(copy, data, size);
+  return copy;
+}
+
+FrozenValue::FrozenValue() : root_(NULL) {
+}
+
+FrozenValue::~FrozenValue() {
+}
+
+// static
+FrozenValue* FrozenValue::Freeze(const Value& value) {
+  Builder builder;
+  builder.Measure(value);
+  size_t size = AlignSize(sizeof(Node)) + builder.size();
+
+  FrozenValue* frozen = new FrozenValue;
+  frozen->arena_.reset(new Arena(size));
+  Node* root = static_cast<Node*>(frozen->arena_->Allocate(sizeof(Node)));
+  builder.Fill(value, root, frozen->arena_.get());
+  frozen->root_ = root;
+  DCHECK_EQ(size, frozen->arena_->bytes_allocated());
+  DCHECK_EQ(1u, frozen->arena_->block_count());
+  return frozen;
+}
+
+FrozenValueRef FrozenValue::root() const {
+  return FrozenValueRef(root_);
+}
+
+size_t FrozenValue::memory_size() const {
+  return arena_->bytes_allocated();
+}
+
+FrozenValueRef::FrozenValueRef() : node_(NULL) {
+}
+
+FrozenValueRef::FrozenValueRef(const FrozenValue::Node* node) : node_(node) {
+}
+
+Value::Type FrozenValueRef::GetType() const {
+  DCHECK(node_);
+  return node_->type;
+}
+
+bool FrozenValueRef::IsType(Value::Type type) const {
+  return node_ && node_->type == type;
+}
+
+bool FrozenValueRef::GetAsBoolean(bool* out_value) const {
+  if (!IsType(Value::TYPE_BOOLEAN))
+    return false;
+  if (out_value)
+    *out_value = node_->boolean_value;
+  return true;
+}
+
+bool FrozenValueRef::GetAsInteger(int* out_value) const {
+  if (!IsType(Value::TYPE_INTEGER))
+    return false;
+  if (out_value)
+    *out_value = node_->integer_value;
+  return true;
+}
+
+bool FrozenValueRef::GetAsDouble(double* out_value) const {
+  // Integers read as doubles, as FundamentalValue's do.
+  if (IsType(Value::TYPE_INTEGER)) {
+    if (out_value)
+      *out_value = node_->integer_value;
+    return true;
+  }
+  if (!IsType(Value::TYPE_DOUBLE))
+    return false;
+  if (out_value)
+    *out_value = node_->double_value;
+  return true;
+}
+
+bool FrozenValueRef::GetAsString(std::string* out_value) const {
+  if (!IsType(Value::TYPE_STRING))
+    return false;
+  if (out_value)
+    out_value->assign(node_->data, node_->size);
+  return true;
+}
+
+bool FrozenValueRef::GetAsString(string16* out_value) const {
+  if (!IsType(Value::TYPE_STRING))
+    return false;
+  if (out_value)
+    *out_value = UTF8ToUTF16(StringPiece(node_->data, node_->size));
+  return true;
+}
+
+bool FrozenValueRef::GetAsStringPiece(StringPiece* out_value) const {
+  if (!IsType(Value::TYPE_STRING) && !IsType(Value::TYPE_BINARY))
+    return false;
+  if (out_value)
+    out_value->set(node_->data, node_->size);
+  return true;
+}
+
+size_t FrozenValueRef::size() const {
+  if (!IsType(Value::TYPE_DICTIONARY) && !IsType(Value::TYPE_LIST))
+    return 0;
+  return node_->size;
+}
+
+bool FrozenValueRef::HasKey(const std::string& key) const {
+  return FindMember(key) != NULL;
+}
+
+bool FrozenValueRef::Get(const std::string& path,
+                         FrozenValueRef* out_value) const {
+  FrozenValueRef current(*this);
+  StringPiece remaining(path);
+  for (size_t delimiter = remaining.find('.');
+       delimiter != StringPiece::npos;
+       delimiter = remaining.find('.')) {
+    if (!current.GetWithoutPathExpansion(remaining.substr(0, delimiter),
+                                         &current)) {
+      return false;
+    }
+    remaining = remaining.substr(delimiter + 1);
+  }
+  return current.GetWithoutPathExpansion(remaining, out_value);
+}
+
+bool FrozenValueRef::GetBoolean(const std::string& path,
+                                bool* out_value) const {
+  FrozenValueRef value;
+  return Get(path, &value) && value.GetAsBoolean(out_value);
+}
+
+bool FrozenValueRef::GetInteger(const std::string& path,
+                                int* out_value) const {
+  FrozenValueRef value;
+  return Get(path, &value) && value.GetAsInteger(out_value);
+}
+
+bool FrozenValueRef::GetDouble(const std::string& path,
+                               double* out_value) const {
+  FrozenValueRef value;
+  return Get(path, &value) && value.GetAsDouble(out_value);
+}
+
+bool FrozenValueRef::GetString(const std::string& path,
+                               std::string* out_value) const {
+  FrozenValueRef value;
+  return Get(path, &value) && value.GetAsString(out_value);
+}
+
+bool FrozenValueRef::GetString(const std::string& path,
+                               string16* out_value) const {
+  FrozenValueRef value;
+  return Get(path, &value) && value.GetAsString(out_value);
+}
+
+bool FrozenValueRef::GetDictionary(const std::string& path,
+                                   FrozenValueRef* out_value) const {
+  FrozenValueRef value;
+  if (!Get(path, &value) || !value.IsType(Value::TYPE_DICTIONARY))
+    return false;
+  if (out_value)
+    *out_value = value;
+  return true;
+}
+
+bool FrozenValueRef::GetList(const std::string& path,
+                             FrozenValueRef* out_value) const {
+  FrozenValueRef value;
+  if (!Get(path, &value) || !value.IsType(Value::TYPE_LIST))
+    return false;
+  if (out_value)
+    *out_value = value;
+  return true;
+}
+
+bool FrozenValueRef::GetWithoutPathExpansion(const StringPiece& key,
+                                             FrozenValueRef* out_value) const {
+  const FrozenValue::Member* member = FindMember(key);
+  if (!member)
+    return false;
+  if (out_value)
+    *out_value = FrozenValueRef(&member->value);
+  return true;
+}
+
+StringPiece FrozenValueRef::GetKeyAt(size_t index) const {
+  DCHECK(IsType(Value::TYPE_DICTIONARY));
+  DCHECK_LT(index, node_->size);
+  const FrozenValue::Member& member = node_->members[index];
+  return StringPiece(member.key, member.key_length);
+}
+
+FrozenValueRef FrozenValueRef::GetValueAt(size_t index) const {
+  DCHECK(IsType(Value::TYPE_DICTIONARY));
+  DCHECK_LT(index, node_->size);
+  return FrozenValueRef(&node_->members[index].value);
+}
+
+bool FrozenValueRef::Get(size_t index, FrozenValueRef* out_value) const {
+  if (!IsType(Value::TYPE_LIST) || index >= node_->size)
+    return false;
+  if (out_value)
+    *out_value = FrozenValueRef(&node_->items[index]);
+  return true;
+}
+
+bool FrozenValueRef::GetBoolean(size_t index, bool* out_value) const {
+  FrozenValueRef value;
+  return Get(index, &value) && value.GetAsBoolean(out_value);
+}
+
+bool FrozenValueRef::GetInteger(size_t index, int* out_value) const {
+  FrozenValueRef value;
+  return Get(index, &value) && value.GetAsInteger(out_value);
+}
+
+bool FrozenValueRef::GetDouble(size_t index, double* out_value) const {
+  FrozenValueRef value;
+  return Get(index, &value) && value.GetAsDouble(out_value);
+}
+
+bool FrozenValueRef::GetString(size_t index, std::string* out_value) const {
+  FrozenValueRef value;
+  return Get(index, &value) && value.GetAsString(out_value);
+}
+
+bool FrozenValueRef::GetString(size_t index, string16* out_value) const {
+  FrozenValueRef value;
+  return Get(index, &value) && value.GetAsString(out_value);
+}
+
+bool FrozenValueRef::GetDictionary(size_t index,
+                                   FrozenValueRef* out_value) const {
+  FrozenValueRef value;
+  if (!Get(index, &value) || !value.IsType(Value::TYPE_DICTIONARY))
+    return false;
+  if (out_value)
+    *out_value = value;
+  return true;
+}
+
+bool FrozenValueRef::GetList(size_t index, FrozenValueRef* out_value) const {
+  FrozenValueRef value;
+  if (!Get(index, &value) || !value.IsType(Value::TYPE_LIST))
+    return false;
+  if (out_value)
+    *out_value = value;
+  return true;
+}
+
+Value* FrozenValueRef::Thaw() const {
+  if (!node_)
+    return NULL;
+  switch (node_->type) {
+    case Value::TYPE_NULL:
+      return Value::CreateNullValue();
+    case Value::TYPE_BOOLEAN:
+      return Value::CreateBooleanValue(node_->boolean_value);
+    case Value::TYPE_INTEGER:
+      return Value::CreateIntegerValue(node_->integer_value);
+    case Value::TYPE_DOUBLE:
+      return Value::CreateDoubleValue(node_->double_value);
+    case Value::TYPE_STRING:
+      return new StringValue(std::string(node_->data, node_->size));
+    case Value::TYPE_BINARY:
+      return BinaryValue::CreateWithCopiedBuffer(node_->data, node_->size);
+    case Value::TYPE_DICTIONARY: {
+      DictionaryValue* dictionary = new DictionaryValue;
+      for (size_t i = 0; i < node_->size; ++i) {
+        dictionary->SetWithoutPathExpansion(GetKeyAt(i).as_string(),
+                                            GetValueAt(i).Thaw());
+      }
+      return dictionary;
+    }
+    case Value::TYPE_LIST: {
+      ListValue* list = new ListValue;
+      for (size_t i = 0; i < node_->size; ++i)
+        list->Append(FrozenValueRef(&node_->items[i]).Thaw());
+      return list;
+    }
+    default:
+      NOTREACHED();
+      return NULL;
+  }
+}
+
+bool FrozenValueRef::Equals(const Value* other) const {
+  if (!node_ || !other || !other->IsType(node_->type))
+    return false;
+  switch (node_->type) {
+    case Value::TYPE_NULL:
+      return true;
+    case Value::TYPE_BOOLEAN: {
+      bool value;
+      return other->GetAsBoolean(&value) && value == node_->boolean_value;
+    }
+    case Value::TYPE_INTEGER: {
+      int value;
+      return other->GetAsInteger(&value) && value == node_->integer_value;
+    }
+    case Value::TYPE_DOUBLE: {
+      double value;
+      return other->GetAsDouble(&value) && value == node_->double_value;
+    }
+    case Value::TYPE_STRING: {
+      std::string value;
+      return other->GetAsString(&value) &&
+          StringPiece(value) == StringPiece(node_->data, node_->size);
+    }
+    case Value::TYPE_BINARY: {
+      const BinaryValue* binary = static_cast<const BinaryValue*>(other);
+      return binary->GetSize() == node_->size &&
+          !memcmp(binary->GetBuffer(), node_->data, node_->size);
+    }
+    case Value::TYPE_DICTIONARY: {
+      const DictionaryValue* dictionary =
+          static_cast<const DictionaryValue*>(other);
+      if (dictionary->size() != node_->size)
+        return false;
+      for (size_t i = 0; i < node_->size; ++i) {
+        Value* child = NULL;
+        if (!dictionary->GetWithoutPathExpansion(GetKeyAt(i).as_string(),
+                                                 &child) ||
+            !GetValueAt(i).Equals(child)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case Value::TYPE_LIST: {
+      const ListValue* list = static_cast<const ListValue*>(other);
+      if (list->GetSize() != node_->size)
+        return false;
+      for (size_t i = 0; i < node_->size; ++i) {
+        Value* child = NULL;
+        if (!list->Get(i, &child) ||
+            !FrozenValueRef(&node_->items[i]).Equals(child)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    default:
+      NOTREACHED();
+      return false;
+  }
+}
+
+const FrozenValue::Member* FrozenValueRef::FindMember(
+    const StringPiece& key) const {
+  if (!IsType(Value::TYPE_DICTIONARY))
+    return NULL;
+  const FrozenValue::Member* members = node_->members;
+  size_t low = 0;
+  size_t high = node_->size;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    int order = StringPiece(members[middle].key,
+                            members[middle].key_length).compare(key);
+    if (order == 0)
+      return &members[middle];
+    if (order < 0)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return NULL;
+}
+
+}  // namespace base
@@ -0,0 +1,144 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// FrozenValue is an immutable copy of a Value tree for data that is only read
+// after it is loaded.  The whole tree lives in one block of memory: each
+// dictionary is an array of members sorted by key and searched by bisection,
+// each list an array of items, and every distinct key is stored once however
+// many dictionaries use it.  A tree of N values costs one allocation rather
+// than N.
+//
+// A FrozenValueRef reads one node of the tree through the same accessors as
+// Value, DictionaryValue and ListValue.  Thaw() makes an ordinary, writable
+// Value tree from any node when one is needed.
+//
+//   scoped_ptr<FrozenValue> frozen(FrozenValue::Freeze(*manifest));
+//   std::string name;
+//   if (frozen->root().GetString("app.name", &name))
+//     ...
+
+#ifndef BASE_FROZEN_VALUE_H_
+#define BASE_FROZEN_VALUE_H_
+#pragma once
+
+#include <string>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/string16.h"
+#include "base/string_piece.h"
+#include "base/values.h"
+
+namespace base {
+
+class Arena;
+class FrozenValueRef;
+
+class BASE_EXPORT FrozenValue {
+ public:
+  ~FrozenValue();
+
+  // Returns a frozen copy of |value|.  The caller owns the result.
+  static FrozenValue* Freeze(const Value& value);
+
+  // The node for the value that was frozen.  It and the nodes read from it
+  // are valid for as long as this FrozenValue is.
+  FrozenValueRef root() const;
+
+  // The number of bytes the tree takes up.
+  size_t memory_size() const;
+
+ private:
+  friend class FrozenValueRef;
+
+  struct Member;
+  struct Node;
+  class Builder;
+
+  FrozenValue();
+
+  scoped_ptr<Arena> arena_;
+  const Node* root_;
+
+  DISALLOW_COPY_AND_ASSIGN(FrozenValue);
+};
+
+// A reference to one node of a FrozenValue, which is cheap to copy.  A
+// default constructed FrozenValueRef refers to nothing: IsType() is false for
+// every type and the other accessors fail.
+class BASE_EXPORT FrozenValueRef {
+ public:
+  FrozenValueRef();
+
+  // Whether this refers to a node at all.
+  bool is_valid() const { return node_ != NULL; }
+
+  // As for Value.
+  Value::Type GetType() const;
+  bool IsType(Value::Type type) const;
+  bool GetAsBoolean(bool* out_value) const;
+  bool GetAsInteger(int* out_value) const;
+  bool GetAsDouble(double* out_value) const;
+  bool GetAsString(std::string* out_value) const;
+  bool GetAsString(string16* out_value) const;
+  // Points |out_value| at the string in place, which lasts as long as the
+  // FrozenValue.  Binary values are read this way too.
+  bool GetAsStringPiece(StringPiece* out_value) const;
+
+  // The number of members of a dictionary or items of a list; 0 for any
+  // other type.
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+
+  // As for DictionaryValue.  A path has the form "<key>" or "<key>.<key>...",
+  // where "." indexes into the next dictionary down.
+  bool HasKey(const std::string& key) const;
+  bool Get(const std::string& path, FrozenValueRef* out_value) const;
+  bool GetBoolean(const std::string& path, bool* out_value) const;
+  bool GetInteger(const std::string& path, int* out_value) const;
+  bool GetDouble(const std::string& path, double* out_value) const;
+  bool GetString(const std::string& path, std::string* out_value) const;
+  bool GetString(const std::string& path, string16* out_value) const;
+  bool GetDictionary(const std::string& path,
+                     FrozenValueRef* out_value) const;
+  bool GetList(const std::string& path, FrozenValueRef* out_value) const;
+  bool GetWithoutPathExpansion(const StringPiece& key,
+                               FrozenValueRef* out_value) const;
+
+  // The |index|th member of a dictionary, in key order.
+  StringPiece GetKeyAt(size_t index) const;
+  FrozenValueRef GetValueAt(size_t index) const;
+
+  // As for ListValue.
+  bool Get(size_t index, FrozenValueRef* out_value) const;
+  bool GetBoolean(size_t index, bool* out_value) const;
+  bool GetInteger(size_t index, int* out_value) const;
+  bool GetDouble(size_t index, double* out_value) const;
+  bool GetString(size_t index, std::string* out_value) const;
+  bool GetString(size_t index, string16* out_value) const;
+  bool GetDictionary(size_t index, FrozenValueRef* out_value) const;
+  bool GetList(size_t index, FrozenValueRef* out_value) const;
+
+  // Returns a writable copy of this node and everything under it, which the
+  // caller owns, or NULL if this refers to nothing.
+  Value* Thaw() const;
+
+  // Whether this node holds the same data as |other|.
+  bool Equals(const Value* other) const;
+
+ private:
+  friend class FrozenValue;
+
+  explicit FrozenValueRef(const FrozenValue::Node* node);
+
+  // The member of a dictionary with the given key, or NULL.
+  const FrozenValue::Member* FindMember(const StringPiece& key) const;
+
+  const FrozenValue::Node* node_;
+};
+
+}  // namespace base
+
+#endif  // BASE_FROZEN_VALUE_H_
@@ -0,0 +1,196 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/frozen_value.h"
+
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/string16.h"
+#include "base/utf_string_conversions.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const char kDocument[] =
+    "{"
+    "  \"name\": \"frozen\","
+    "  \"version\": 3,"
+    "  \"ratio\": 0.5,"
+    "  \"enabled\": true,"
+    "  \"missing\": null,"
+    "  \"empty\": \"\","
+    "  \"nested\": {\"inner\": {\"name\": \"deep\"}, \"count\": 2},"
+    "  \"list\": [1, \"two\", {\"name\": \"three\"}, [], {}],"
+    "  \"dotted.key\": \"url\""
+    "}";
+
+}  // namespace
+
+TEST(FrozenValueTest, Accessors) {
+  scoped_ptr<Value> value(JSONReader::Read(kDocument));
+  ASSERT_TRUE(value.get());
+  scoped_ptr<FrozenValue> frozen(FrozenValue::Freeze(*value));
+  FrozenValueRef root = frozen->root();
+
+  ASSERT_TRUE(root.IsType(Value::TYPE_DICTIONARY));
+  EXPECT_EQ(9u, root.size());
+  EXPECT_TRUE(root.HasKey("name"));
+  EXPECT_FALSE(root.HasKey("nam"));
+  EXPECT_FALSE(root.HasKey("names"));
+
+  std::string string_value;
+  string16 string16_value;
+  int int_value = 0;
+  double double_value = 0;
+  bool bool_value = false;
+  EXPECT_TRUE(root.GetString("name", &string_value));
+  EXPECT_EQ("frozen", string_value);
+  EXPECT_TRUE(root.GetString("name", &string16_value));
+  EXPECT_EQ(ASCIIToUTF16("frozen"), string16_value);
+  EXPECT_TRUE(root.GetString("empty", &string_value));
+  EXPECT_EQ("", string_value);
+  EXPECT_TRUE(root.GetInteger("version", &int_value));
+  EXPECT_EQ(3, int_value);
+  EXPECT_TRUE(root.GetDouble("version", &double_value));
+  EXPECT_EQ(3.0, double_value);
+  EXPECT_TRUE(root.GetDouble("ratio", &double_value));
+  EXPECT_EQ(0.5, double_value);
+  EXPECT_FALSE(root.GetInteger("ratio", &int_value));
+  EXPECT_TRUE(root.GetBoolean("enabled", &bool_value));
+  EXPECT_TRUE(bool_value);
+  FrozenValueRef null_value;
+  EXPECT_TRUE(root.Get("missing", &null_value));
+  EXPECT_TRUE(null_value.IsType(Value::TYPE_NULL));
+
+  // Paths.
+  EXPECT_TRUE(root.GetString("nested.inner.name", &string_value));
+  EXPECT_EQ("deep", string_value);
+  EXPECT_TRUE(root.GetInteger("nested.count", &int_value));
+  EXPECT_EQ(2, int_value);
+  EXPECT_FALSE(root.Get("nested.inner.name.more", NULL));
+  EXPECT_FALSE(root.Get("dotted.key", NULL));
+  EXPECT_TRUE(root.GetWithoutPathExpansion("dotted.key", NULL));
+  FrozenValueRef nested;
+  EXPECT_TRUE(root.GetDictionary("nested", &nested));
+  EXPECT_TRUE(nested.GetString("inner.name", &string_value));
+  EXPECT_FALSE(root.GetList("nested", NULL));
+
+  // Lists.
+  FrozenValueRef list;
+  ASSERT_TRUE(root.GetList("list", &list));
+  EXPECT_EQ(5u, list.size());
+  EXPECT_TRUE(list.GetInteger(0, &int_value));
+  EXPECT_EQ(1, int_value);
+  EXPECT_TRUE(list.GetString(1, &string_value));
+  EXPECT_EQ("two", string_value);
+  FrozenValueRef item;
+  EXPECT_TRUE(list.GetDictionary(2, &item));
+  EXPECT_TRUE(item.GetString("name", &string_value));
+  EXPECT_EQ("three", string_value);
+  EXPECT_TRUE(list.GetList(3, &item));
+  EXPECT_TRUE(item.empty());
+  EXPECT_TRUE(list.GetDictionary(4, &item));
+  EXPECT_TRUE(item.empty());
+  EXPECT_FALSE(item.HasKey("name"));
+  EXPECT_FALSE(list.Get(5, NULL));
+  EXPECT_FALSE(list.HasKey("name"));
+
+  // Members come in key order, as DictionaryValue's keys do.
+  DictionaryValue* dictionary = NULL;
+  ASSERT_TRUE(value->GetAsDictionary(&dictionary));
+  size_t index = 0;
+  for (DictionaryValue::key_iterator it = dictionary->begin_keys();
+       it != dictionary->end_keys(); ++it, ++index) {
+    EXPECT_EQ(*it, root.GetKeyAt(index).as_string());
+    Value* child = NULL;
+    ASSERT_TRUE(dictionary->GetWithoutPathExpansion(*it, &child));
+    EXPECT_TRUE(root.GetValueAt(index).Equals(child));
+  }
+
+  // A reference to nothing fails everything.
+  FrozenValueRef invalid;
+  EXPECT_FALSE(invalid.is_valid());
+  EXPECT_FALSE(invalid.IsType(Value::TYPE_NULL));
+  EXPECT_FALSE(invalid.GetAsString(&string_value));
+  EXPECT_FALSE(invalid.Get("name", NULL));
+  EXPECT_FALSE(invalid.Get(0, NULL));
+  EXPECT_TRUE(invalid.Thaw() == NULL);
+}
+
+TEST(FrozenValueTest, Thaw) {
+  scoped_ptr<Value> value(JSONReader::Read(kDocument));
+  ASSERT_TRUE(value.get());
+  scoped_ptr<FrozenValue> frozen(FrozenValue::Freeze(*value));
+  EXPECT_TRUE(frozen->root().Equals(value.get()));
+
+  scoped_ptr<Value> thawed(frozen->root().Thaw());
+  ASSERT_TRUE(thawed.get());
+  EXPECT_TRUE(thawed->Equals(value.get()));
+
+  // The thawed tree is independent of the frozen one.
+  DictionaryValue* dictionary = NULL;
+  ASSERT_TRUE(thawed->GetAsDictionary(&dictionary));
+  dictionary->SetString("name", "thawed");
+  EXPECT_FALSE(frozen->root().Equals(thawed.get()));
+  frozen.reset();
+  std::string name;
+  EXPECT_TRUE(dictionary->GetString("name", &name));
+  EXPECT_EQ("thawed", name);
+
+  // Any node can be thawed on its own.
+  frozen.reset(FrozenValue::Freeze(*value));
+  FrozenValueRef nested;
+  ASSERT_TRUE(frozen->root().GetDictionary("nested", &nested));
+  thawed.reset(nested.Thaw());
+  Value* expected = NULL;
+  ASSERT_TRUE(static_cast<DictionaryValue*>(value.get())->Get("nested",
+                                                              &expected));
+  EXPECT_TRUE(thawed->Equals(expected));
+}
+
+TEST(FrozenValueTest, Scalars) {
+  scoped_ptr<Value> value(Value::CreateStringValue("just a string"));
+  scoped_ptr<FrozenValue> frozen(FrozenValue::Freeze(*value));
+  StringPiece piece;
+  EXPECT_TRUE(frozen->root().GetAsStringPiece(&piece));
+  EXPECT_EQ("just a string", piece);
+  EXPECT_EQ(0u, frozen->root().size());
+
+  const char kBytes[] = "\x00\x01\x02";
+  value.reset(BinaryValue::CreateWithCopiedBuffer(kBytes, 3));
+  frozen.reset(FrozenValue::Freeze(*value));
+  EXPECT_TRUE(frozen->root().IsType(Value::TYPE_BINARY));
+  EXPECT_FALSE(frozen->root().GetAsString(static_cast<std::string*>(NULL)));
+  EXPECT_TRUE(frozen->root().GetAsStringPiece(&piece));
+  EXPECT_EQ(StringPiece(kBytes, 3), piece);
+  scoped_ptr<Value> thawed(frozen->root().Thaw());
+  EXPECT_TRUE(thawed->Equals(value.get()));
+}
+
+TEST(FrozenValueTest, SharedKeys) {
+  // A thousand entries with the same three keys store each key once.
+  ListValue list;
+  for (int i = 0; i < 1000; ++i) {
+    DictionaryValue* entry = new DictionaryValue;
+    entry->SetInteger("identifier", i);
+    entry->SetBoolean("visible", true);
+    entry->SetString("description", "");
+    list.Append(entry);
+  }
+  scoped_ptr<FrozenValue> frozen(FrozenValue::Freeze(list));
+  FrozenValueRef first, last;
+  ASSERT_TRUE(frozen->root().GetDictionary(0, &first));
+  ASSERT_TRUE(frozen->root().GetDictionary(999, &last));
+  EXPECT_EQ(first.GetKeyAt(0).data(), last.GetKeyAt(0).data());
+  int identifier = 0;
+  EXPECT_TRUE(last.GetInteger("identifier", &identifier));
+  EXPECT_EQ(999, identifier);
+
+  EXPECT_TRUE(frozen->root().Equals(&list));
+}
+
+}  // namespace base
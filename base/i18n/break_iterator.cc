@@ -4,9 +4,14 @@
 
 #include "base/i18n/break_iterator.h"
 
+#include <algorithm>
+
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/threading/thread_local_storage.h"
 #include "unicode/ubrk.h"
 #include "unicode/uchar.h"
+#include "unicode/uloc.h"
 #include "unicode/ustring.h"
 
 namespace base {
@@ -14,43 +19,255 @@ namespace i18n {
 
 const size_t npos = -1;
 
+namespace {
+
+// Iterators released beyond this many per thread are closed instead.
+const size_t kMaxIdleIterators = 8;
+
+struct PooledIterator {
+  UBreakIteratorType type;
+  std::string locale;
+  UBreakIterator* iter;
+};
+
+// A thread's ICU iterators that are not in use, most recently released last,
+// and one prototype for each type and locale that new iterators are cloned
+// from.  Cloning shares the compiled rules, where ubrk_open() looks them up.
+struct BreakIteratorPool {
+  std::vector<PooledIterator> idle;
+  std::vector<PooledIterator> prototypes;
+};
+
+void DestroyBreakIteratorPool(void* value) {
+  BreakIteratorPool* pool = static_cast<BreakIteratorPool*>(value);
+  for (size_t i = 0; i < pool->idle.size(); ++i)
+    ubrk_close(pool->idle[i].iter);
+  for (size_t i = 0; i < pool->prototypes.size(); ++i)
+    ubrk_close(pool->prototypes[i].iter);
+  delete pool;
+}
+
+struct BreakIteratorPoolSlot {
+  BreakIteratorPoolSlot() : slot(&DestroyBreakIteratorPool) {}
+
+  ThreadLocalStorage::Slot slot;
+};
+
+LazyInstance<BreakIteratorPoolSlot>::Leaky g_break_iterator_pool_slot =
+    LAZY_INSTANCE_INITIALIZER;
+
+BreakIteratorPool* GetBreakIteratorPool() {
+  ThreadLocalStorage::Slot& slot = g_break_iterator_pool_slot.Get().slot;
+  BreakIteratorPool* pool = static_cast<BreakIteratorPool*>(slot.Get());
+  if (!pool) {
+    pool = new BreakIteratorPool;
+    slot.Set(pool);
+  }
+  return pool;
+}
+
+// Returns an iterator of |type| for |locale| with no text, from the pool if
+// it has one, or NULL if ICU fails.
+UBreakIterator* TakeIterator(UBreakIteratorType type,
+                             const std::string& locale) {
+  BreakIteratorPool* pool = GetBreakIteratorPool();
+  for (size_t i = pool->idle.size(); i-- > 0; ) {
+    if (pool->idle[i].type == type && pool->idle[i].locale == locale) {
+      UBreakIterator* iter = pool->idle[i].iter;
+      pool->idle.erase(pool->idle.begin() + i);
+      return iter;
+    }
+  }
+
+  UErrorCode status = U_ZERO_ERROR;
+  UBreakIterator* prototype = NULL;
+  for (size_t i = 0; i < pool->prototypes.size(); ++i) {
+    if (pool->prototypes[i].type == type &&
+        pool->prototypes[i].locale == locale) {
+      prototype = pool->prototypes[i].iter;
+      break;
+    }
+  }
+  if (!prototype) {
+    prototype = ubrk_open(type, locale.c_str(), NULL, 0, &status);
+    if (U_FAILURE(status))
+      return NULL;
+    PooledIterator entry = { type, locale, prototype };
+    pool->prototypes.push_back(entry);
+  }
+
+  // A buffer too small for any iterator makes ICU allocate the clone.
+  int32_t buffer_size = 1;
+  UBreakIterator* iter = ubrk_safeClone(prototype, NULL, &buffer_size,
+                                        &status);
+  if (U_FAILURE(status))
+    return NULL;
+  return iter;
+}
+
+void ReleaseIterator(UBreakIteratorType type,
+                     const std::string& locale,
+                     UBreakIterator* iter) {
+  BreakIteratorPool* pool = GetBreakIteratorPool();
+  if (pool->idle.size() >= kMaxIdleIterators) {
+    ubrk_close(pool->idle.front().iter);
+    pool->idle.erase(pool->idle.begin());
+  }
+  PooledIterator entry = { type, locale, iter };
+  pool->idle.push_back(entry);
+}
+
+bool GetICUBreakType(BreakIterator::BreakType break_type,
+                     UBreakIteratorType* icu_break_type) {
+  switch (break_type) {
+    case BreakIterator::BREAK_WORD:
+      *icu_break_type = UBRK_WORD;
+      return true;
+    case BreakIterator::BREAK_LINE:
+    case BreakIterator::BREAK_NEWLINE:
+      *icu_break_type = UBRK_LINE;
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsSoftLineBreak(int32_t status) {
+  return status >= UBRK_LINE_SOFT && status < UBRK_LINE_SOFT_LIMIT;
+}
+
+}  // namespace
+
 BreakIterator::BreakIterator(const string16& str, BreakType break_type)
     : iter_(NULL),
       string_(str),
       break_type_(break_type),
       prev_(npos),
-      pos_(0) {
+      pos_(0),
+      incremental_(false),
+      index_(0) {
 }
 
 BreakIterator::~BreakIterator() {
-  if (iter_)
-    ubrk_close(static_cast<UBreakIterator*>(iter_));
+  UBreakIteratorType break_type;
+  if (iter_ && GetICUBreakType(break_type_, &break_type)) {
+    ReleaseIterator(break_type, locale_,
+                    static_cast<UBreakIterator*>(iter_));
+  }
 }
 
 bool BreakIterator::Init() {
   UErrorCode status = U_ZERO_ERROR;
   UBreakIteratorType break_type;
-  switch (break_type_) {
-    case BREAK_WORD:
-      break_type = UBRK_WORD;
-      break;
-    case BREAK_LINE:
-    case BREAK_NEWLINE:
-      break_type = UBRK_LINE;
-      break;
-    default:
-      NOTREACHED() << "invalid break_type_";
-      return false;
+  if (!GetICUBreakType(break_type_, &break_type)) {
+    NOTREACHED() << "invalid break_type_";
+    return false;
   }
-  iter_ = ubrk_open(break_type, NULL,
-                    string_.data(), static_cast<int32_t>(string_.size()),
-                    &status);
-  if (U_FAILURE(status)) {
+  locale_ = uloc_getDefault();
+  UBreakIterator* iter = TakeIterator(break_type, locale_);
+  if (!iter) {
     NOTREACHED() << "ubrk_open failed";
     return false;
   }
+  iter_ = iter;
+  ubrk_setText(iter, string_.data(), static_cast<int32_t>(string_.size()),
+               &status);
+  if (U_FAILURE(status)) {
+    NOTREACHED() << "ubrk_setText failed";
+    return false;
+  }
   // Move the iterator to the beginning of the string.
-  ubrk_first(static_cast<UBreakIterator*>(iter_));
+  ubrk_first(iter);
+  return true;
+}
+
+bool BreakIterator::InitIncremental() {
+  if (!Init())
+    return false;
+
+  UBreakIterator* iter = static_cast<UBreakIterator*>(iter_);
+  incremental_ = true;
+  breaks_.clear();
+  statuses_.clear();
+  for (int32_t pos = ubrk_first(iter); pos != UBRK_DONE;
+       pos = ubrk_next(iter)) {
+    breaks_.push_back(pos);
+    statuses_.push_back(ubrk_getRuleStatus(iter));
+  }
+  index_ = 0;
+  return true;
+}
+
+bool BreakIterator::TextChanged(size_t position,
+                                size_t old_length,
+                                size_t new_length) {
+  DCHECK(incremental_);
+  UBreakIterator* iter = static_cast<UBreakIterator*>(iter_);
+  UErrorCode status = U_ZERO_ERROR;
+  ubrk_setText(iter, string_.data(), static_cast<int32_t>(string_.size()),
+               &status);
+  if (U_FAILURE(status)) {
+    incremental_ = false;
+    return false;
+  }
+
+  int32 edit_end = static_cast<int32>(position + new_length);
+  int32 delta = static_cast<int32>(new_length) - static_cast<int32>(old_length);
+
+  // Keep the breaks before the edit up to the first two in a row, going
+  // back from it, that are breaks of the new text with the same status.
+  // Rules look a little way past a break, so the edit may have moved some
+  // just before it.
+  size_t start = std::lower_bound(breaks_.begin(), breaks_.end(),
+                                  static_cast<int32>(position)) -
+      breaks_.begin();
+  int agreeing = 0;
+  while (start > 0 && agreeing < 2) {
+    --start;
+    if (ubrk_isBoundary(iter, breaks_[start]) &&
+        ubrk_getRuleStatus(iter) == statuses_[start]) {
+      ++agreeing;
+    } else {
+      agreeing = 0;
+    }
+  }
+
+  // Break the new text from there until a break past the edit is one the old
+  // text had too, with the same status; everything after it is unchanged.
+  std::vector<int32> new_breaks;
+  std::vector<int32> new_statuses;
+  size_t resume = breaks_.size();
+  size_t old_index = start + 1;
+  for (int32_t pos = ubrk_following(iter, breaks_[start]); pos != UBRK_DONE;
+       pos = ubrk_next(iter)) {
+    int32_t rule_status = ubrk_getRuleStatus(iter);
+    new_breaks.push_back(pos);
+    new_statuses.push_back(rule_status);
+    if (pos < edit_end)
+      continue;
+    int32 old_pos = pos - delta;
+    while (old_index < breaks_.size() && breaks_[old_index] < old_pos)
+      ++old_index;
+    if (old_index < breaks_.size() && breaks_[old_index] == old_pos &&
+        statuses_[old_index] == rule_status) {
+      resume = old_index + 1;
+      break;
+    }
+  }
+
+  for (size_t i = resume; i < breaks_.size(); ++i)
+    breaks_[i] += delta;
+  breaks_.erase(breaks_.begin() + start + 1, breaks_.begin() + resume);
+  breaks_.insert(breaks_.begin() + start + 1, new_breaks.begin(),
+                 new_breaks.end());
+  statuses_.erase(statuses_.begin() + start + 1, statuses_.begin() + resume);
+  statuses_.insert(statuses_.begin() + start + 1, new_statuses.begin(),
+                   new_statuses.end());
+
+  ubrk_first(iter);
+  prev_ = npos;
+  pos_ = 0;
+  index_ = 0;
   return true;
 }
 
@@ -58,6 +275,34 @@ bool BreakIterator::Advance() {
   int32_t pos;
   int32_t status;
   prev_ = pos_;
+  if (incremental_) {
+    switch (break_type_) {
+      case BREAK_WORD:
+      case BREAK_LINE:
+        if (index_ + 1 >= breaks_.size()) {
+          index_ = breaks_.size();
+          pos_ = npos;
+          return false;
+        }
+        pos_ = breaks_[++index_];
+        return true;
+      case BREAK_NEWLINE:
+        while (index_ + 1 < breaks_.size()) {
+          pos_ = breaks_[++index_];
+          if (!IsSoftLineBreak(statuses_[index_]))
+            return true;
+        }
+        if (prev_ == pos_) {
+          pos_ = npos;
+          return false;
+        }
+        return true;
+      default:
+        NOTREACHED() << "invalid break_type_";
+        return false;
+    }
+  }
+
   switch (break_type_) {
     case BREAK_WORD:
     case BREAK_LINE:
@@ -75,7 +320,7 @@ bool BreakIterator::Advance() {
           break;
         pos_ = static_cast<size_t>(pos);
         status = ubrk_getRuleStatus(static_cast<UBreakIterator*>(iter_));
-      } while (status >= UBRK_LINE_SOFT && status < UBRK_LINE_SOFT_LIMIT);
+      } while (IsSoftLineBreak(status));
       if (pos == UBRK_DONE && prev_ == pos_) {
         pos_ = npos;
         return false;
@@ -88,6 +333,10 @@ bool BreakIterator::Advance() {
 }
 
 bool BreakIterator::IsWord() const {
+  if (incremental_) {
+    return break_type_ == BREAK_WORD && index_ < breaks_.size() &&
+        statuses_[index_] != UBRK_WORD_NONE;
+  }
   int32_t status = ubrk_getRuleStatus(static_cast<UBreakIterator*>(iter_));
   return (break_type_ == BREAK_WORD && status != UBRK_WORD_NONE);
 }
@@ -96,6 +345,13 @@ bool BreakIterator::IsEndOfWord(size_t position) const {
   if (break_type_ != BREAK_WORD)
     return false;
 
+  if (incremental_) {
+    std::vector<int32>::const_iterator it = std::lower_bound(
+        breaks_.begin(), breaks_.end(), static_cast<int32>(position));
+    return it != breaks_.end() && *it == static_cast<int32>(position) &&
+        statuses_[it - breaks_.begin()] != UBRK_WORD_NONE;
+  }
+
   UBreakIterator* iter = static_cast<UBreakIterator*>(iter_);
   UBool boundary = ubrk_isBoundary(iter, static_cast<int32_t>(position));
   int32_t status = ubrk_getRuleStatus(iter);
@@ -106,6 +362,14 @@ bool BreakIterator::IsStartOfWord(size_t position) const {
   if (break_type_ != BREAK_WORD)
     return false;
 
+  if (incremental_) {
+    std::vector<int32>::const_iterator it = std::lower_bound(
+        breaks_.begin(), breaks_.end(), static_cast<int32>(position));
+    return it != breaks_.end() && it + 1 != breaks_.end() &&
+        *it == static_cast<int32>(position) &&
+        statuses_[it + 1 - breaks_.begin()] != UBRK_WORD_NONE;
+  }
+
   UBreakIterator* iter = static_cast<UBreakIterator*>(iter_);
   UBool boundary = ubrk_isBoundary(iter, static_cast<int32_t>(position));
   ubrk_next(iter);
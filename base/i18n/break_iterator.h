@@ -6,6 +6,9 @@
 #define BASE_I18N_BREAK_ITERATOR_H_
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "base/basictypes.h"
 #include "base/string16.h"
 #include "base/i18n/base_i18n_export.h"
@@ -52,6 +55,13 @@
 //       VLOG(1) << "word: " << iter.GetString();
 //     }
 //   }
+//
+// The ICU iterators behind BreakIterators are kept in a pool per thread when
+// they are destroyed, and reused by later ones of the same type and locale.
+//
+// For a string that is edited in place and queried between edits, like a
+// text field's, use InitIncremental() instead of Init() and report each edit
+// with TextChanged().
 
 namespace base {
 namespace i18n {
@@ -76,6 +86,19 @@ class BASE_I18N_EXPORT BreakIterator {
   // Returns false if ICU failed to initialize.
   bool Init();
 
+  // As Init(), but also finds every break in the string and keeps them.
+  // Advance(), IsWord(), IsEndOfWord() and IsStartOfWord() then look breaks
+  // up instead of asking ICU, and TextChanged() is available.
+  bool InitIncremental();
+
+  // After InitIncremental(), tells the iterator that the string was edited:
+  // the |old_length| characters at |position| were replaced with
+  // |new_length| others.  Only the breaks around the edit are found again,
+  // from the last ones before it that are still breaks up to the first after
+  // it that was one already.  The iterator starts over from the beginning of
+  // the string.  Returns false if ICU failed, leaving the iterator unusable.
+  bool TextChanged(size_t position, size_t old_length, size_t new_length);
+
   // Advance to the next break.  Returns false if we've run past the end of
   // the string.  (Note that the very last "break" is after the final
   // character in the string, and when we advance to that position it's the
@@ -122,6 +145,17 @@ class BASE_I18N_EXPORT BreakIterator {
   // Previous and current iterator positions.
   size_t prev_, pos_;
 
+  // The locale |iter_| was made for, so it can go back to the right pool.
+  std::string locale_;
+
+  // In incremental mode, every break in the string in order, including those
+  // at its ends, and the ICU rule status of the text before each.  pos() is
+  // |breaks_[index_]|.
+  bool incremental_;
+  std::vector<int32> breaks_;
+  std::vector<int32> statuses_;
+  size_t index_;
+
   DISALLOW_COPY_AND_ASSIGN(BreakIterator);
 };
 
@@ -4,6 +4,8 @@
 
 #include "base/i18n/break_iterator.h"
 
+#include <vector>
+
 #include "base/string_piece.h"
 #include "base/stringprintf.h"
 #include "base/utf_string_conversions.h"
@@ -310,5 +312,94 @@ TEST(BreakIteratorTest, BreakLineWide32) {
   EXPECT_FALSE(iter.IsWord());
 }
 
+TEST(BreakIteratorTest, PooledIterators) {
+  // Iterators of different types come back from the pool and are reused,
+  // each still breaking its own string.
+  string16 str(UTF8ToUTF16("foo bar\nbaz"));
+  for (int i = 0; i < 3; ++i) {
+    BreakIterator words(str, BreakIterator::BREAK_WORD);
+    BreakIterator lines(str, BreakIterator::BREAK_NEWLINE);
+    ASSERT_TRUE(words.Init());
+    ASSERT_TRUE(lines.Init());
+    EXPECT_TRUE(words.Advance());
+    EXPECT_EQ(UTF8ToUTF16("foo"), words.GetString());
+    EXPECT_TRUE(lines.Advance());
+    EXPECT_EQ(UTF8ToUTF16("foo bar\n"), lines.GetString());
+  }
+}
+
+namespace {
+
+// Checks that |iter|, in incremental mode over |str|, finds what a new
+// iterator over |str| does.
+void ExpectSameBreaks(BreakIterator* iter,
+                      const string16& str,
+                      BreakIterator::BreakType break_type) {
+  BreakIterator expected(str, break_type);
+  ASSERT_TRUE(expected.Init());
+  // What ICU reports at the very end of the string varies between versions.
+  for (size_t i = 0; i < str.size(); ++i) {
+    EXPECT_EQ(expected.IsStartOfWord(i), iter->IsStartOfWord(i)) << i;
+    EXPECT_EQ(expected.IsEndOfWord(i), iter->IsEndOfWord(i)) << i;
+  }
+
+  // IsStartOfWord() moved |expected| along; start it over.
+  BreakIterator walk(str, break_type);
+  ASSERT_TRUE(walk.Init());
+  bool more;
+  do {
+    more = walk.Advance();
+    EXPECT_EQ(more, iter->Advance());
+    EXPECT_EQ(walk.pos(), iter->pos());
+    if (more) {
+      EXPECT_EQ(walk.IsWord(), iter->IsWord());
+    }
+  } while (more);
+}
+
+}  // namespace
+
+TEST(BreakIteratorTest, Incremental) {
+  const BreakIterator::BreakType kTypes[] = {
+    BreakIterator::BREAK_WORD,
+    BreakIterator::BREAK_LINE,
+    BreakIterator::BREAK_NEWLINE,
+  };
+  // Edits that join and split words, add and remove spaces and newlines,
+  // and touch both ends of the string.
+  struct Edit {
+    size_t position;
+    size_t old_length;
+    const char* replacement;
+  } const kEdits[] = {
+    { 3, 1, "" },
+    { 3, 0, " " },
+    { 0, 0, "Well, " },
+    { 10, 0, "\n\n" },
+    { 5, 4, "x.y" },
+    { 20, 3, "  (42)  " },
+    { 0, 6, "" },
+    { 1, 0, "\xe4\xb8\x96\xe7\x95\x8c" },
+    { 8, 0, "can't" },
+  };
+
+  for (size_t t = 0; t < arraysize(kTypes); ++t) {
+    string16 str(UTF8ToUTF16("The quick brown fox.\nJumps over it!"));
+    BreakIterator iter(str, kTypes[t]);
+    ASSERT_TRUE(iter.InitIncremental());
+    ExpectSameBreaks(&iter, str, kTypes[t]);
+
+    // kEdits is of a local type, which arraysize() can't take.
+    for (size_t e = 0; e < ARRAYSIZE_UNSAFE(kEdits); ++e) {
+      string16 replacement = UTF8ToUTF16(kEdits[e].replacement);
+      str.replace(kEdits[e].position, kEdits[e].old_length, replacement);
+      ASSERT_TRUE(iter.TextChanged(kEdits[e].position, kEdits[e].old_length,
+                                   replacement.size()));
+      SCOPED_TRACE(UTF16ToUTF8(str));
+      ExpectSameBreaks(&iter, str, kTypes[t]);
+    }
+  }
+}
+
 }  // namespace i18n
 }  // namespace base
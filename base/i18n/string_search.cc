@@ -4,31 +4,137 @@
 
 #include "base/i18n/string_search.h"
 
+#include "build/build_config.h"
 #include "unicode/usearch.h"
+#include "unicode/uset.h"
+
+#if defined(ARCH_CPU_X86_FAMILY) && (defined(__SSE2__) || \
+    defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define STRING_SEARCH_USE_SSE2 1
+#include <emmintrin.h>
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#endif
+#endif
 
 namespace {
 
-bool CollationSensitiveStringSearch(const string16& find_this,
-                                    const string16& in_this,
-                                    UCollationStrength strength) {
-  UErrorCode status = U_ZERO_ERROR;
+bool IsPrintableASCII(char16 c) {
+  return c >= 0x20 && c <= 0x7e;
+}
 
-  UStringSearch* search = usearch_open(find_this.data(), -1, in_this.data(), -1,
-                                       uloc_getDefault(), NULL, &status);
+char16 ToLowerASCII(char16 c) {
+  return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
 
-  // Default to basic substring search if usearch fails. According to
-  // http://icu-project.org/apiref/icu4c/usearch_8h.html, usearch_open will fail
-  // if either |find_this| or |in_this| are empty. In either case basic
-  // substring search will give the correct return value.
-  if (!U_SUCCESS(status))
-    return in_this.find(find_this) != string16::npos;
+#if defined(STRING_SEARCH_USE_SSE2)
 
-  UCollator* collator = usearch_getCollator(search);
-  ucol_setStrength(collator, strength);
-  usearch_reset(search);
+// Lower-cases the ASCII letters among eight characters.
+inline __m128i ToLowerASCII(__m128i chars) {
+  __m128i is_upper =
+      _mm_and_si128(_mm_cmpgt_epi16(chars, _mm_set1_epi16('A' - 1)),
+                    _mm_cmplt_epi16(chars, _mm_set1_epi16('Z' + 1)));
+  return _mm_or_si128(chars, _mm_and_si128(is_upper, _mm_set1_epi16(0x20)));
+}
 
-  bool result = usearch_first(search, &status) != USEARCH_DONE;
-  usearch_close(search);
+inline int CountTrailingZeros(unsigned int bits) {
+#if defined(COMPILER_MSVC)
+  unsigned long index;
+  _BitScanForward(&index, bits);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(bits);
+#endif
+}
+
+#endif  // defined(STRING_SEARCH_USE_SSE2)
+
+bool IsAllPrintableASCII(const string16& text) {
+  const char16* chars = text.data();
+  size_t size = text.size();
+  size_t i = 0;
+#if defined(STRING_SEARCH_USE_SSE2)
+  // Everything from 0x8000 up is negative as a signed 16-bit value, so one
+  // signed comparison at each end rules out all the rest.
+  for (; i + 8 <= size; i += 8) {
+    __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + i));
+    __m128i outside = _mm_or_si128(
+        _mm_cmplt_epi16(block, _mm_set1_epi16(0x20)),
+        _mm_cmpgt_epi16(block, _mm_set1_epi16(0x7e)));
+    if (_mm_movemask_epi8(outside))
+      return false;
+  }
+#endif
+  for (; i < size; ++i) {
+    if (!IsPrintableASCII(chars[i]))
+      return false;
+  }
+  return true;
+}
+
+// Returns true if |pattern| at |text| matches ignoring ASCII case.
+// |pattern| is already in lower case.
+bool MatchesLowerASCII(const char16* pattern, const char16* text,
+                       size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    if (pattern[i] != ToLowerASCII(text[i]))
+      return false;
+  }
+  return true;
+}
+
+// Returns true if |text| contains |pattern|, which is in lower case and not
+// empty, ignoring ASCII case.
+bool FindLowerASCII(const string16& pattern, const string16& text) {
+  size_t pattern_size = pattern.size();
+  if (text.size() < pattern_size)
+    return false;
+  const char16* chars = text.data();
+  size_t last_start = text.size() - pattern_size;
+  size_t start = 0;
+#if defined(STRING_SEARCH_USE_SSE2)
+  // Look for the pattern's first and last characters at eight starting
+  // places at once, and compare the rest only where both match.
+  __m128i first = _mm_set1_epi16(pattern[0]);
+  __m128i last = _mm_set1_epi16(pattern[pattern_size - 1]);
+  for (; start + 8 <= last_start + 1; start += 8) {
+    __m128i first_block = ToLowerASCII(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + start)));
+    __m128i last_block = ToLowerASCII(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(chars + start + pattern_size - 1)));
+    // Two mask bits per character.
+    unsigned int candidates = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi16(first, first_block),
+                      _mm_cmpeq_epi16(last, last_block)));
+    while (candidates) {
+      int offset = CountTrailingZeros(candidates) / 2;
+      if (MatchesLowerASCII(pattern.data(), chars + start + offset,
+                            pattern_size)) {
+        return true;
+      }
+      candidates &= ~(3u << (offset * 2));
+    }
+  }
+#endif
+  for (; start <= last_start; ++start) {
+    if (MatchesLowerASCII(pattern.data(), chars + start, pattern_size))
+      return true;
+  }
+  return false;
+}
+
+// Returns true if the collator treats printable ASCII as the root collation
+// does at primary strength: every character distinct but for case.
+bool CollatorKeepsASCII(const UCollator* collator) {
+  UErrorCode status = U_ZERO_ERROR;
+  USet* tailored = ucol_getTailoredSet(collator, &status);
+  if (!U_SUCCESS(status))
+    return false;
+  USet* ascii = uset_open(0x20, 0x7e);
+  bool result = uset_containsNone(tailored, ascii);
+  uset_close(ascii);
+  uset_close(tailored);
   return result;
 }
 
@@ -39,7 +145,72 @@ namespace i18n {
 
 bool StringSearchIgnoringCaseAndAccents(const string16& find_this,
                                         const string16& in_this) {
-  return CollationSensitiveStringSearch(find_this, in_this, UCOL_PRIMARY);
+  return FixedPatternStringSearchIgnoringCaseAndAccents(find_this).Search(
+      in_this);
+}
+
+FixedPatternStringSearchIgnoringCaseAndAccents::
+    FixedPatternStringSearchIgnoringCaseAndAccents(const string16& find_this)
+    : find_this_(find_this),
+      search_(NULL) {
+  if (find_this_.empty())
+    return;
+
+  // usearch_open() needs some text to search, so start it on the pattern
+  // itself; Search() gives it the real text.
+  UErrorCode status = U_ZERO_ERROR;
+  int32_t size = static_cast<int32_t>(find_this_.size());
+  search_ = usearch_open(find_this_.data(), size, find_this_.data(), size,
+                         uloc_getDefault(), NULL, &status);
+  if (!U_SUCCESS(status)) {
+    search_ = NULL;
+    return;
+  }
+
+  UCollator* collator = usearch_getCollator(search_);
+  ucol_setStrength(collator, UCOL_PRIMARY);
+  usearch_reset(search_);
+
+  if (IsAllPrintableASCII(find_this_) && CollatorKeepsASCII(collator)) {
+    ascii_find_this_.reserve(find_this_.size());
+    for (size_t i = 0; i < find_this_.size(); ++i)
+      ascii_find_this_.push_back(ToLowerASCII(find_this_[i]));
+  }
+}
+
+FixedPatternStringSearchIgnoringCaseAndAccents::
+    ~FixedPatternStringSearchIgnoringCaseAndAccents() {
+  if (search_)
+    usearch_close(search_);
+}
+
+bool FixedPatternStringSearchIgnoringCaseAndAccents::Search(
+    const string16& in_this) {
+  // Default to basic substring search if usearch fails. According to
+  // http://icu-project.org/apiref/icu4c/usearch_8h.html, usearch_open will fail
+  // if either |find_this| or |in_this| are empty. In either case basic
+  // substring search will give the correct return value.
+  if (!search_ || in_this.empty())
+    return in_this.find(find_this_) != string16::npos;
+
+  if (!ascii_find_this_.empty() && IsAllPrintableASCII(in_this))
+    return FindLowerASCII(ascii_find_this_, in_this);
+
+  UErrorCode status = U_ZERO_ERROR;
+  usearch_setText(search_, in_this.data(),
+                  static_cast<int32_t>(in_this.size()), &status);
+  if (!U_SUCCESS(status))
+    return in_this.find(find_this_) != string16::npos;
+  return usearch_first(search_, &status) != USEARCH_DONE;
+}
+
+void FixedPatternStringSearchIgnoringCaseAndAccents::SearchAll(
+    const std::vector<string16>& in_these,
+    std::vector<size_t>* matches) {
+  for (size_t i = 0; i < in_these.size(); ++i) {
+    if (Search(in_these[i]))
+      matches->push_back(i);
+  }
 }
 
 }  // namespace i18n
@@ -3,10 +3,12 @@
 // found in the LICENSE file.
 
 #include <string>
+#include <vector>
 
 #include "base/i18n/rtl.h"
 #include "base/i18n/string_search.h"
 #include "base/string16.h"
+#include "base/string_util.h"
 #include "base/utf_string_conversions.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "unicode/usearch.h"
@@ -14,6 +16,27 @@
 namespace base {
 namespace i18n {
 
+namespace {
+
+// Searches with ICU alone, as StringSearchIgnoringCaseAndAccents() always
+// used to.
+bool ICUSearchIgnoringCaseAndAccents(const string16& find_this,
+                                     const string16& in_this) {
+  UErrorCode status = U_ZERO_ERROR;
+  UStringSearch* search = usearch_open(
+      find_this.data(), find_this.size(), in_this.data(), in_this.size(),
+      uloc_getDefault(), NULL, &status);
+  if (!U_SUCCESS(status))
+    return in_this.find(find_this) != string16::npos;
+  ucol_setStrength(usearch_getCollator(search), UCOL_PRIMARY);
+  usearch_reset(search);
+  bool result = usearch_first(search, &status) != USEARCH_DONE;
+  usearch_close(search);
+  return result;
+}
+
+}  // namespace
+
 // Note on setting default locale for testing: The current default locale on
 // the Mac trybot is en_US_POSIX, with which primary-level collation strength
 // string search is case-sensitive, when normally it should be
@@ -147,6 +170,82 @@ TEST(StringSearchTest, UnicodeLocaleDependent) {
   SetICUDefaultLocale(default_locale);
 }
 
+TEST(StringSearchTest, FixedPattern) {
+  std::string default_locale(uloc_getDefault());
+  SetICUDefaultLocale("en_US");
+
+  FixedPatternStringSearchIgnoringCaseAndAccents search(
+      ASCIIToUTF16("Hello"));
+  EXPECT_TRUE(search.Search(ASCIIToUTF16("hello world")));
+  EXPECT_TRUE(search.Search(ASCIIToUTF16("say HELLO")));
+  EXPECT_FALSE(search.Search(ASCIIToUTF16("help")));
+  EXPECT_FALSE(search.Search(string16()));
+  EXPECT_TRUE(search.Search(WideToUTF16(L"h\u00e9llo \u4e16\u754c")));
+
+  std::vector<string16> items;
+  items.push_back(ASCIIToUTF16("Othello"));
+  items.push_back(ASCIIToUTF16("Hamlet"));
+  items.push_back(WideToUTF16(L"h\u00c8ll\u00f6"));
+  items.push_back(string16());
+  items.push_back(ASCIIToUTF16("a much longer string ending in hello"));
+  std::vector<size_t> matches;
+  search.SearchAll(items, &matches);
+  ASSERT_EQ(3u, matches.size());
+  EXPECT_EQ(0u, matches[0]);
+  EXPECT_EQ(2u, matches[1]);
+  EXPECT_EQ(4u, matches[2]);
+
+  FixedPatternStringSearchIgnoringCaseAndAccents empty((string16()));
+  EXPECT_TRUE(empty.Search(ASCIIToUTF16("anything")));
+  EXPECT_TRUE(empty.Search(string16()));
+
+  SetICUDefaultLocale(default_locale.data());
+}
+
+TEST(StringSearchTest, FixedPatternMatchesICU) {
+  std::string default_locale(uloc_getDefault());
+  SetICUDefaultLocale("en_US");
+
+  // Every pattern at every position in texts long enough for the SSE2 loop,
+  // including punctuation and spaces, which the collator doesn't ignore.
+  const string16 text =
+      ASCIIToUTF16("The quick, brown fox; jumps over THE lazy dog's back!");
+  for (size_t size = 1; size <= 12; ++size) {
+    for (size_t start = 0; start + size <= text.size(); ++start) {
+      string16 pattern = text.substr(start, size);
+      if (start % 2)
+        pattern = StringToUpperASCII(pattern);
+      FixedPatternStringSearchIgnoringCaseAndAccents search(pattern);
+      for (size_t end = 0; end <= text.size(); end += 7) {
+        string16 in_this = text.substr(0, end);
+        EXPECT_EQ(ICUSearchIgnoringCaseAndAccents(pattern, in_this),
+                  search.Search(in_this))
+            << UTF16ToASCII(pattern) << " in " << UTF16ToASCII(in_this);
+      }
+    }
+  }
+
+  SetICUDefaultLocale(default_locale.data());
+}
+
+TEST(StringSearchTest, FixedPatternLocaleDependent) {
+  std::string default_locale(uloc_getDefault());
+
+  // Locales that give ASCII letters other than their root weights search
+  // with ICU, even when everything is ASCII.
+  SetICUDefaultLocale("tr");
+  EXPECT_FALSE(FixedPatternStringSearchIgnoringCaseAndAccents(
+      ASCIIToUTF16("i")).Search(ASCIIToUTF16("TITLE")));
+  SetICUDefaultLocale("en_US");
+  EXPECT_TRUE(FixedPatternStringSearchIgnoringCaseAndAccents(
+      ASCIIToUTF16("i")).Search(ASCIIToUTF16("TITLE")));
+  SetICUDefaultLocale("en_US_POSIX");
+  EXPECT_FALSE(FixedPatternStringSearchIgnoringCaseAndAccents(
+      ASCIIToUTF16("title")).Search(ASCIIToUTF16("TITLE")));
+
+  SetICUDefaultLocale(default_locale.data());
+}
+
 }  // namespace i18n
 }  // namespace base
 
@@ -9,7 +9,7 @@
 #include <set>
 
 #include "base/basictypes.h"
-#include "base/hash_tables.h"
+#include "base/flat_hash_map.h"
 #include "base/logging.h"
 #include "base/threading/non_thread_safe.h"
 
@@ -21,9 +21,9 @@ enum IDMapOwnershipSemantics {
 };
 
 // This object maintains a list of IDs that can be quickly converted to
-// pointers to objects. It is implemented as a hash table, optimized for
+// pointers to objects. It is implemented as a flat hash table, optimized for
 // relatively small data sets (in the common case, there will be exactly one
-// item in the list).
+// item in the list) that are looked up far more often than they change.
 //
 // Items can be inserted into the container with arbitrary ID, but the caller
 // must ensure they are unique. Inserting IDs and relying on automatically
@@ -35,7 +35,7 @@ template<typename T, IDMapOwnershipSemantics OS = IDMapExternalPointer>
 class IDMap : public base::NonThreadSafe {
  private:
   typedef int32 KeyType;
-  typedef base::hash_map<KeyType, T*> HashTable;
+  typedef base::FlatHashMap<KeyType, T*> HashTable;
 
  public:
   IDMap() : iteration_depth_(0), next_id_(1), check_on_null_data_(false) {
@@ -112,7 +112,8 @@ class IDMap : public base::NonThreadSafe {
   }
 
   // It is safe to remove elements from the map during iteration. All iterators
-  // will remain valid.
+  // will remain valid.  Elements added during iteration may or may not be
+  // visited, and may make the iteration visit others twice.
   template<class ReturnType>
   class Iterator {
    public:
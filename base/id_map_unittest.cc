@@ -4,6 +4,8 @@
 
 #include "base/id_map.h"
 
+#include <set>
+
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace {
@@ -94,32 +96,33 @@ TEST_F(IDMapTest, IteratorRemainsValidWhenRemovingOtherElements) {
   for (int i = 0; i < kCount; i++)
     ids[i] = map.Add(&obj[i]);
 
-  int counter = 0;
+  // The map does not iterate in any particular order, so go by what has been
+  // visited: each visit removes an element still to come, and the last one
+  // removes the first element visited.
+  std::set<int32> visited;
+  std::set<int32> removed;
   for (IDMap<TestObject>::const_iterator iter(&map);
        !iter.IsAtEnd(); iter.Advance()) {
-    switch (counter) {
-      case 0:
-        EXPECT_EQ(ids[0], iter.GetCurrentKey());
-        EXPECT_EQ(&obj[0], iter.GetCurrentValue());
-        map.Remove(ids[1]);
-        break;
-      case 1:
-        EXPECT_EQ(ids[2], iter.GetCurrentKey());
-        EXPECT_EQ(&obj[2], iter.GetCurrentValue());
-        map.Remove(ids[3]);
-        break;
-      case 2:
-        EXPECT_EQ(ids[4], iter.GetCurrentKey());
-        EXPECT_EQ(&obj[4], iter.GetCurrentValue());
-        map.Remove(ids[0]);
-        break;
-      default:
-        FAIL() << "should not have that many elements";
+    int32 id = iter.GetCurrentKey();
+    EXPECT_EQ(0u, removed.count(id));
+    EXPECT_TRUE(visited.insert(id).second);
+    EXPECT_EQ(&obj[id - ids[0]], iter.GetCurrentValue());
+    ASSERT_LE(visited.size(), 3u) << "should not have that many elements";
+
+    if (visited.size() == 3u) {
+      map.Remove(*visited.begin());
+      continue;
+    }
+    for (int i = 0; i < kCount; i++) {
+      if (!visited.count(ids[i]) && !removed.count(ids[i])) {
+        map.Remove(ids[i]);
+        removed.insert(ids[i]);
         break;
+      }
     }
-
-    counter++;
   }
+  EXPECT_EQ(3u, visited.size());
+  EXPECT_EQ(2u, map.size());
 }
 
 TEST_F(IDMapTest, OwningPointersDeletesThemOnRemove) {
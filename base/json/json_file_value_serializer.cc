@@ -5,9 +5,17 @@
 #include "base/json/json_file_value_serializer.h"
 
 #include "base/file_util.h"
+#include "base/json/json_stream_reader.h"
 #include "base/json/json_string_value_serializer.h"
 #include "base/logging.h"
 
+namespace {
+
+// The size of the reads DeserializeToHandler() makes.
+const size_t kReadChunkSize = 64 * 1024;
+
+}  // namespace
+
 const char* JSONFileValueSerializer::kAccessDenied = "Access denied.";
 const char* JSONFileValueSerializer::kCannotReadFile = "Can't read file.";
 const char* JSONFileValueSerializer::kFileLocked = "File locked.";
@@ -43,21 +51,24 @@ bool JSONFileValueSerializer::SerializeInternal(const Value& root,
 
 int JSONFileValueSerializer::ReadFileToString(std::string* json_string) {
   DCHECK(json_string);
-  if (!file_util::ReadFileToString(json_file_path_, json_string)) {
+  if (!file_util::ReadFileToString(json_file_path_, json_string))
+    return GetReadErrorCode();
+  return JSON_NO_ERROR;
+}
+
+int JSONFileValueSerializer::GetReadErrorCode() {
 #if defined(OS_WIN)
-    int error = ::GetLastError();
-    if (error == ERROR_SHARING_VIOLATION || error == ERROR_LOCK_VIOLATION) {
-      return JSON_FILE_LOCKED;
-    } else if (error == ERROR_ACCESS_DENIED) {
-      return JSON_ACCESS_DENIED;
-    }
-#endif
-    if (!file_util::PathExists(json_file_path_))
-      return JSON_NO_SUCH_FILE;
-    else
-      return JSON_CANNOT_READ_FILE;
+  int error = ::GetLastError();
+  if (error == ERROR_SHARING_VIOLATION || error == ERROR_LOCK_VIOLATION) {
+    return JSON_FILE_LOCKED;
+  } else if (error == ERROR_ACCESS_DENIED) {
+    return JSON_ACCESS_DENIED;
   }
-  return JSON_NO_ERROR;
+#endif
+  if (!file_util::PathExists(json_file_path_))
+    return JSON_NO_SUCH_FILE;
+  else
+    return JSON_CANNOT_READ_FILE;
 }
 
 const char* JSONFileValueSerializer::GetErrorMessageForCode(int error_code) {
@@ -94,3 +105,39 @@ Value* JSONFileValueSerializer::Deserialize(int* error_code,
   serializer.set_allow_trailing_comma(allow_trailing_comma_);
   return serializer.Deserialize(error_code, error_str);
 }
+
+bool JSONFileValueSerializer::DeserializeToHandler(
+    base::JSONStreamHandler* handler,
+    int* error_code,
+    std::string* error_str) {
+  base::JSONStreamReader reader(handler,
+      allow_trailing_comma_ ? base::JSON_ALLOW_TRAILING_COMMAS :
+          base::JSON_PARSE_RFC);
+
+  int error = JSON_NO_ERROR;
+  FILE* file = file_util::OpenFile(json_file_path_, "rb");
+  if (!file) {
+    error = GetReadErrorCode();
+  } else {
+    char buffer[kReadChunkSize];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+      reader.Append(base::StringPiece(buffer, length));
+    if (ferror(file))
+      error = GetReadErrorCode();
+    file_util::CloseFile(file);
+  }
+
+  if (error == JSON_NO_ERROR && !reader.Finish())
+    error = reader.error_code();
+  if (error == JSON_NO_ERROR)
+    return true;
+
+  if (error_code)
+    *error_code = error;
+  if (error_str) {
+    *error_str = error < JSON_ACCESS_DENIED ? reader.GetErrorMessage() :
+        GetErrorMessageForCode(error);
+  }
+  return false;
+}
@@ -13,6 +13,10 @@
 #include "base/file_path.h"
 #include "base/values.h"
 
+namespace base {
+class JSONStreamHandler;
+}
+
 class BASE_EXPORT JSONFileValueSerializer : public base::ValueSerializer {
  public:
   // json_file_patch is the path of a file that will be source of the
@@ -28,7 +32,7 @@ class BASE_EXPORT JSONFileValueSerializer : public base::ValueSerializer {
   // DO NOT USE except in unit tests to verify the file was written properly.
   // We should never serialize directly to a file since this will block the
   // thread. Instead, serialize to a string and write to the file you want on
-  // the file thread.
+  // the file thread, or use JSONFileValueWriter.
   //
   // Attempt to serialize the data structure represented by Value into
   // JSON.  If the return value is true, the result will have been written
@@ -49,6 +53,13 @@ class BASE_EXPORT JSONFileValueSerializer : public base::ValueSerializer {
   virtual Value* Deserialize(int* error_code,
                              std::string* error_message) OVERRIDE;
 
+  // Like Deserialize(), but reports the contents of the file to |handler|
+  // instead of building Values, reading the file in chunks.  Returns false on
+  // failure, setting |error_code| and |error_message| as Deserialize() does.
+  bool DeserializeToHandler(base::JSONStreamHandler* handler,
+                            int* error_code,
+                            std::string* error_message);
+
   // This enum is designed to safely overlap with JSONReader::JsonParseError.
   enum JsonFileError {
     JSON_NO_ERROR = 0,
@@ -82,6 +93,9 @@ class BASE_EXPORT JSONFileValueSerializer : public base::ValueSerializer {
   // JsonFileError if there were file errors.
   int ReadFileToString(std::string* json_string);
 
+  // Returns the JsonFileError for a failure to open or read the file.
+  int GetReadErrorCode();
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(JSONFileValueSerializer);
 };
 
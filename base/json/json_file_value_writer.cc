@@ -0,0 +1,165 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_file_value_writer.h"
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/json/json_string_value_serializer.h"
+#include "base/logging.h"
+#include "base/platform_file.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/values.h"
+
+namespace {
+
+// A WaitableEvent that stays alive until both the task signaling it and the
+// thread waiting on it are done with it, as Flush() may time out first.
+class FlushEvent : public base::RefCountedThreadSafe<FlushEvent> {
+ public:
+  FlushEvent() : event_(true, false) {}
+
+  base::WaitableEvent* event() { return &event_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<FlushEvent>;
+  ~FlushEvent() {}
+
+  base::WaitableEvent event_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlushEvent);
+};
+
+void SignalFlushEvent(scoped_refptr<FlushEvent> flush_event) {
+  flush_event->event()->Signal();
+}
+
+// Serializes |value| and writes it to |path|. Runs on the pool.
+void WriteValue(const FilePath& path, const base::Value* value) {
+  std::string json_string;
+  JSONStringValueSerializer serializer(&json_string);
+  serializer.set_pretty_print(true);
+  if (!serializer.Serialize(*value)) {
+    LOG(WARNING) << "Failed to serialize the data for " << path.value();
+    return;
+  }
+  if (!JSONFileValueWriter::WriteFileAtomically(path, json_string))
+    LOG(WARNING) << "Failed to write " << path.value();
+}
+
+}  // namespace
+
+const int JSONFileValueWriter::kDefaultCommitIntervalMs = 10000;
+
+JSONFileValueWriter::JSONFileValueWriter(
+    const FilePath& path,
+    base::SequencedWorkerPool* pool,
+    base::SequencedWorkerPool::SequenceToken sequence_token)
+    : path_(path),
+      pool_(pool),
+      sequence_token_(sequence_token),
+      serializer_(NULL),
+      commit_interval_(
+          base::TimeDelta::FromMilliseconds(kDefaultCommitIntervalMs)) {
+  DCHECK(pool_);
+}
+
+JSONFileValueWriter::~JSONFileValueWriter() {
+  DCHECK(CalledOnValidThread());
+  if (HasPendingWrite())
+    DoScheduledWrite();
+}
+
+bool JSONFileValueWriter::HasPendingWrite() const {
+  DCHECK(CalledOnValidThread());
+  return timer_.IsRunning();
+}
+
+void JSONFileValueWriter::WriteNow(base::Value* value) {
+  DCHECK(CalledOnValidThread());
+  DCHECK(value);
+  if (HasPendingWrite()) {
+    timer_.Stop();
+    serializer_ = NULL;
+  }
+
+  pool_->PostSequencedWorkerTaskWithShutdownBehavior(
+      sequence_token_,
+      FROM_HERE,
+      base::Bind(&WriteValue, path_, base::Owned(value)),
+      base::SequencedWorkerPool::BLOCK_SHUTDOWN);
+}
+
+void JSONFileValueWriter::ScheduleWrite(DataSerializer* serializer) {
+  DCHECK(CalledOnValidThread());
+  DCHECK(serializer);
+  serializer_ = serializer;
+  if (!timer_.IsRunning()) {
+    timer_.Start(FROM_HERE, commit_interval_, this,
+                 &JSONFileValueWriter::DoScheduledWrite);
+  }
+}
+
+void JSONFileValueWriter::DoScheduledWrite() {
+  DCHECK(CalledOnValidThread());
+  DCHECK(serializer_);
+  timer_.Stop();
+  DataSerializer* serializer = serializer_;
+  serializer_ = NULL;
+
+  base::Value* value = serializer->CreateSnapshot();
+  if (value)
+    WriteNow(value);
+}
+
+bool JSONFileValueWriter::Flush(base::TimeDelta max_wait) {
+  DCHECK(CalledOnValidThread());
+  if (HasPendingWrite())
+    DoScheduledWrite();
+
+  scoped_refptr<FlushEvent> flush_event(new FlushEvent);
+  if (!pool_->PostSequencedWorkerTaskWithShutdownBehavior(
+          sequence_token_,
+          FROM_HERE,
+          base::Bind(&SignalFlushEvent, flush_event),
+          base::SequencedWorkerPool::BLOCK_SHUTDOWN)) {
+    return false;
+  }
+  return flush_event->event()->TimedWait(max_wait);
+}
+
+// static
+bool JSONFileValueWriter::WriteFileAtomically(const FilePath& path,
+                                              const std::string& data) {
+  // The temporary file is made in the same directory, so that it can be
+  // renamed over |path|.
+  FilePath temp_path;
+  if (!file_util::CreateTemporaryFileInDir(path.DirName(), &temp_path))
+    return false;
+
+  base::PlatformFile file = base::CreatePlatformFile(
+      temp_path,
+      base::PLATFORM_FILE_OPEN | base::PLATFORM_FILE_WRITE,
+      NULL,
+      NULL);
+  if (file == base::kInvalidPlatformFileValue) {
+    file_util::Delete(temp_path, false);
+    return false;
+  }
+
+  int data_size = static_cast<int>(data.size());
+  bool written =
+      base::WritePlatformFile(file, 0, data.data(), data_size) == data_size;
+  // Flush before renaming, so that a crash can't leave the new name on
+  // contents that never reached the disk.
+  written = base::FlushPlatformFile(file) && written;
+  if (!base::ClosePlatformFile(file))
+    written = false;
+
+  if (!written || !file_util::ReplaceFile(temp_path, path)) {
+    file_util::Delete(temp_path, false);
+    return false;
+  }
+  return true;
+}
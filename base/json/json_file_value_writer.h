@@ -0,0 +1,102 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_JSON_JSON_FILE_VALUE_WRITER_H_
+#define BASE_JSON_JSON_FILE_VALUE_WRITER_H_
+#pragma once
+
+#include <string>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/threading/non_thread_safe.h"
+#include "base/threading/sequenced_worker_pool.h"
+#include "base/time.h"
+#include "base/timer.h"
+
+namespace base {
+class Value;
+}
+
+// JSONFileValueWriter writes Values to a JSON file from a SequencedWorkerPool
+// sequence, so that the thread changing the data never blocks on the disk.
+// Writes scheduled within the commit interval are coalesced into one, made
+// from a snapshot of the data taken when the interval ends. The file is
+// written to a temporary file in the same directory, flushed, and renamed
+// over the old one, so a crash leaves either the old or the new contents.
+//
+// Use a JSONFileValueWriter from a single thread with a MessageLoop. Writes
+// are posted with BLOCK_SHUTDOWN, so those already posted complete before the
+// pool shuts down; the destructor posts the write still pending, if any.
+class BASE_EXPORT JSONFileValueWriter : public base::NonThreadSafe {
+ public:
+  // Provides the data of scheduled writes.
+  class BASE_EXPORT DataSerializer {
+   public:
+    // Returns a snapshot of the data to write, which the writer takes
+    // ownership of, or NULL to skip the write.
+    virtual base::Value* CreateSnapshot() = 0;
+
+   protected:
+    virtual ~DataSerializer() {}
+  };
+
+  // The default commit interval.
+  static const int kDefaultCommitIntervalMs;
+
+  // Writes go to |path|, from tasks posted to |pool| with |sequence_token|.
+  JSONFileValueWriter(const FilePath& path,
+                      base::SequencedWorkerPool* pool,
+                      base::SequencedWorkerPool::SequenceToken sequence_token);
+
+  ~JSONFileValueWriter();
+
+  const FilePath& path() const { return path_; }
+
+  // Whether a write has been scheduled and not yet posted.
+  bool HasPendingWrite() const;
+
+  // Posts a write of |value| now, cancelling the scheduled write, if any.
+  // Takes ownership of |value|.
+  void WriteNow(base::Value* value);
+
+  // Writes a snapshot from |serializer| at the end of the commit interval,
+  // unless a write is already scheduled, in which case that one uses
+  // |serializer| instead. |serializer| must outlive the writer.
+  void ScheduleWrite(DataSerializer* serializer);
+
+  // Posts the scheduled write now.
+  void DoScheduledWrite();
+
+  // Posts the scheduled write, if any, and blocks until all the writes posted
+  // so far have completed, for up to |max_wait|. Returns false if they
+  // haven't completed by then. Meant for shutdown.
+  bool Flush(base::TimeDelta max_wait);
+
+  base::TimeDelta commit_interval() const { return commit_interval_; }
+  void set_commit_interval(base::TimeDelta interval) {
+    commit_interval_ = interval;
+  }
+
+  // Writes |data| to |path| through a temporary file and a rename. Blocks.
+  // Returns true on success.
+  static bool WriteFileAtomically(const FilePath& path,
+                                  const std::string& data);
+
+ private:
+  const FilePath path_;
+  scoped_refptr<base::SequencedWorkerPool> pool_;
+  const base::SequencedWorkerPool::SequenceToken sequence_token_;
+
+  // The source of the scheduled write, or NULL.
+  DataSerializer* serializer_;
+  base::OneShotTimer<JSONFileValueWriter> timer_;
+  base::TimeDelta commit_interval_;
+
+  DISALLOW_COPY_AND_ASSIGN(JSONFileValueWriter);
+};
+
+#endif  // BASE_JSON_JSON_FILE_VALUE_WRITER_H_
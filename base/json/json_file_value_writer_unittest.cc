@@ -0,0 +1,122 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_file_value_writer.h"
+
+#include <string>
+
+#include "base/compiler_specific.h"
+#include "base/file_util.h"
+#include "base/message_loop.h"
+#include "base/scoped_temp_dir.h"
+#include "base/test/sequenced_worker_pool_owner.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kFlushTimeoutMs = 10000;
+
+// Snapshots a dictionary holding the number of snapshots taken.
+class CountingSerializer : public JSONFileValueWriter::DataSerializer {
+ public:
+  CountingSerializer() : snapshot_count_(0) {}
+  virtual ~CountingSerializer() {}
+
+  int snapshot_count() const { return snapshot_count_; }
+
+  // Overridden from JSONFileValueWriter::DataSerializer:
+  virtual base::Value* CreateSnapshot() OVERRIDE {
+    base::DictionaryValue* value = new base::DictionaryValue;
+    value->SetInteger("snapshots", ++snapshot_count_);
+    return value;
+  }
+
+ private:
+  int snapshot_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingSerializer);
+};
+
+std::string ReadFile(const FilePath& path) {
+  std::string contents;
+  file_util::ReadFileToString(path, &contents);
+  return contents;
+}
+
+}  // namespace
+
+class JSONFileValueWriterTest : public testing::Test {
+ public:
+  JSONFileValueWriterTest()
+      : pool_owner_(1, "JSONFileValueWriterTest") {
+  }
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.path().AppendASCII("test.json");
+  }
+
+ protected:
+  base::SequencedWorkerPool* pool() { return pool_owner_.pool(); }
+
+  MessageLoop message_loop_;
+  base::SequencedWorkerPoolOwner pool_owner_;
+  ScopedTempDir temp_dir_;
+  FilePath path_;
+};
+
+TEST_F(JSONFileValueWriterTest, WriteFileAtomically) {
+  EXPECT_TRUE(JSONFileValueWriter::WriteFileAtomically(path_, "foo"));
+  EXPECT_EQ("foo", ReadFile(path_));
+  EXPECT_TRUE(JSONFileValueWriter::WriteFileAtomically(path_, "bar"));
+  EXPECT_EQ("bar", ReadFile(path_));
+
+  // Only the file itself is left in the directory.
+  file_util::FileEnumerator files(temp_dir_.path(), false,
+                                  file_util::FileEnumerator::FILES);
+  EXPECT_EQ(path_, files.Next());
+  EXPECT_TRUE(files.Next().empty());
+}
+
+TEST_F(JSONFileValueWriterTest, WriteNow) {
+  JSONFileValueWriter writer(path_, pool(), pool()->GetSequenceToken());
+  base::DictionaryValue* value = new base::DictionaryValue;
+  value->SetString("key", "value");
+  writer.WriteNow(value);
+  EXPECT_FALSE(writer.HasPendingWrite());
+  ASSERT_TRUE(writer.Flush(
+      base::TimeDelta::FromMilliseconds(kFlushTimeoutMs)));
+  EXPECT_NE(std::string::npos, ReadFile(path_).find("\"key\": \"value\""));
+}
+
+// Writes scheduled within the commit interval make one snapshot.
+TEST_F(JSONFileValueWriterTest, ScheduleWriteCoalesces) {
+  JSONFileValueWriter writer(path_, pool(), pool()->GetSequenceToken());
+  writer.set_commit_interval(base::TimeDelta());
+  CountingSerializer serializer;
+  writer.ScheduleWrite(&serializer);
+  writer.ScheduleWrite(&serializer);
+  EXPECT_TRUE(writer.HasPendingWrite());
+  EXPECT_EQ(0, serializer.snapshot_count());
+
+  message_loop_.RunAllPending();
+  EXPECT_FALSE(writer.HasPendingWrite());
+  EXPECT_EQ(1, serializer.snapshot_count());
+  ASSERT_TRUE(writer.Flush(
+      base::TimeDelta::FromMilliseconds(kFlushTimeoutMs)));
+  EXPECT_NE(std::string::npos, ReadFile(path_).find("\"snapshots\": 1"));
+}
+
+// Flush() writes the scheduled snapshot without waiting for the interval.
+TEST_F(JSONFileValueWriterTest, FlushWritesPendingWrite) {
+  CountingSerializer serializer;
+  JSONFileValueWriter writer(path_, pool(), pool()->GetSequenceToken());
+  writer.ScheduleWrite(&serializer);
+  ASSERT_TRUE(writer.Flush(
+      base::TimeDelta::FromMilliseconds(kFlushTimeoutMs)));
+  EXPECT_FALSE(writer.HasPendingWrite());
+  EXPECT_EQ(1, serializer.snapshot_count());
+  EXPECT_TRUE(file_util::PathExists(path_));
+}
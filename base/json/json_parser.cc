@@ -5,8 +5,10 @@
 #include "base/json/json_parser.h"
 
 #include "base/float_util.h"
+#include "base/json/json_stream_reader.h"
+#include "base/json/string_scan.h"
 #include "base/logging.h"
-#include "base/memory/scoped_ptr.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/string_number_conversions.h"
 #include "base/string_piece.h"
 #include "base/string_util.h"
@@ -25,119 +27,17 @@ const int kStackMaxDepth = 100;
 
 const int32 kExtendedASCIIStart = 0x80;
 
-// This and the class below are used to own the JSON input string for when
-// string tokens are stored as StringPiece instead of std::string. This
-// optimization avoids about 2/3rds of string memory copies. The constructor
-// takes the input string and swaps its data into the new instance. The real
-// root value is also Swap()ed into the new instance.
-class DictionaryHiddenRootValue : public base::DictionaryValue {
- public:
-  DictionaryHiddenRootValue(std::string* json, Value* root) {
-    DCHECK(root->IsType(Value::TYPE_DICTIONARY));
-    DictionaryValue::Swap(static_cast<DictionaryValue*>(root));
-    json->swap(json_);
-  }
-
-  virtual void Swap(DictionaryValue* other) OVERRIDE {
-    DVLOG(1) << "Swap()ing a DictionaryValue inefficiently.";
-
-    // First deep copy to convert JSONStringValue to std::string and swap that
-    // copy with |other|, which contains the new contents of |this|.
-    scoped_ptr<base::DictionaryValue> copy(DeepCopy());
-    copy->Swap(other);
-
-    // Then erase the contents of the current dictionary and swap in the
-    // new contents, originally from |other|.
-    Clear();
-    json_.clear();
-    DictionaryValue::Swap(copy.get());
-  }
-
-  // Not overriding DictionaryValue::Remove because it just calls through to
-  // the method below.
-
-  virtual bool RemoveWithoutPathExpansion(const std::string& key,
-                                          Value** out) OVERRIDE {
-    // If the caller won't take ownership of the removed value, just call up.
-    if (!out)
-      return DictionaryValue::RemoveWithoutPathExpansion(key, out);
-
-    DVLOG(1) << "Remove()ing from a DictionaryValue inefficiently.";
-
-    // Otherwise, remove the value while its still "owned" by this and copy it
-    // to convert any JSONStringValues to std::string.
-    Value* out_owned = NULL;
-    if (!DictionaryValue::RemoveWithoutPathExpansion(key, &out_owned))
-      return false;
-
-    *out = out_owned->DeepCopy();
-    delete out_owned;
-
-    return true;
-  }
-
- private:
-  std::string json_;
-
-  DISALLOW_COPY_AND_ASSIGN(DictionaryHiddenRootValue);
-};
-
-class ListHiddenRootValue : public base::ListValue {
- public:
-  ListHiddenRootValue(std::string* json, Value* root) {
-    DCHECK(root->IsType(Value::TYPE_LIST));
-    ListValue::Swap(static_cast<ListValue*>(root));
-    json->swap(json_);
-  }
-
-  virtual void Swap(ListValue* other) OVERRIDE {
-    DVLOG(1) << "Swap()ing a ListValue inefficiently.";
-
-    // First deep copy to convert JSONStringValue to std::string and swap that
-    // copy with |other|, which contains the new contents of |this|.
-    scoped_ptr<base::ListValue> copy(DeepCopy());
-    copy->Swap(other);
-
-    // Then erase the contents of the current list and swap in the new contents,
-    // originally from |other|.
-    Clear();
-    json_.clear();
-    ListValue::Swap(copy.get());
-  }
-
-  virtual bool Remove(size_t index, Value** out) OVERRIDE {
-    // If the caller won't take ownership of the removed value, just call up.
-    if (!out)
-      return ListValue::Remove(index, out);
-
-    DVLOG(1) << "Remove()ing from a ListValue inefficiently.";
-
-    // Otherwise, remove the value while its still "owned" by this and copy it
-    // to convert any JSONStringValues to std::string.
-    Value* out_owned = NULL;
-    if (!ListValue::Remove(index, &out_owned))
-      return false;
-
-    *out = out_owned->DeepCopy();
-    delete out_owned;
-
-    return true;
-  }
-
- private:
-  std::string json_;
-
-  DISALLOW_COPY_AND_ASSIGN(ListHiddenRootValue);
-};
-
 // A variant on StringValue that uses StringPiece instead of copying the string
-// into the Value. This can only be stored in a child of hidden root (above),
-// otherwise the referenced string will not be guaranteed to outlive it.
+// into the Value. It holds a reference to the copy of the input that |piece|
+// points into, so it can outlive the root of the tree and be shared by the
+// copies that DeepCopy() makes of its dictionary or list.
 class JSONStringValue : public base::Value {
  public:
-  explicit JSONStringValue(const base::StringPiece& piece)
+  JSONStringValue(const base::StringPiece& piece,
+                  base::RefCountedString* input)
       : Value(TYPE_STRING),
-        string_piece_(piece) {
+        string_piece_(piece),
+        input_(input) {
   }
 
   // Value:
@@ -161,10 +61,36 @@ class JSONStringValue : public base::Value {
  private:
   // The location in the original input stream.
   base::StringPiece string_piece_;
+  scoped_refptr<base::RefCountedString> input_;
 
   DISALLOW_COPY_AND_ASSIGN(JSONStringValue);
 };
 
+// Builds the Value tree for JSONParser::Parse(). Strings that appear verbatim
+// in |input| become JSONStringValues referring to it, unless |input| is NULL.
+class TreeBuilder : public JSONValueBuilder {
+ public:
+  explicit TreeBuilder(RefCountedString* input) : input_(input) {
+  }
+
+ protected:
+  virtual Value* CreateStringValue(const StringPiece& value) OVERRIDE {
+    if (input_.get()) {
+      const std::string& input = input_->data();
+      if (value.data() >= input.data() &&
+          value.data() + value.size() <= input.data() + input.size()) {
+        return new JSONStringValue(value, input_.get());
+      }
+    }
+    return JSONValueBuilder::CreateStringValue(value);
+  }
+
+ private:
+  scoped_refptr<RefCountedString> input_;
+
+  DISALLOW_COPY_AND_ASSIGN(TreeBuilder);
+};
+
 // Simple class that checks for maximum recursion/"stack overflow."
 class StackMarker {
  public:
@@ -190,6 +116,7 @@ class StackMarker {
 
 JSONParser::JSONParser(int options)
     : options_(options),
+      handler_(NULL),
       start_pos_(NULL),
       pos_(NULL),
       end_pos_(NULL),
@@ -212,16 +139,28 @@ Value* JSONParser::Parse(const StringPiece& input) {
   options_ |= JSON_DETACHABLE_CHILDREN;
 #endif
 
-  std::string input_copy;
-  // If the children of a JSON root can be detached, then hidden roots cannot
-  // be used, so do not bother copying the input because StringPiece will not
-  // be used anywhere.
+  // Strings point into a copy of the input that they keep alive, unless the
+  // children must be detachable, in which case they are copied.
+  scoped_refptr<RefCountedString> input_copy;
+  StringPiece json(input);
   if (!(options_ & JSON_DETACHABLE_CHILDREN)) {
-    input_copy = input.as_string();
-    start_pos_ = input_copy.data();
-  } else {
-    start_pos_ = input.data();
+    input_copy = new RefCountedString;
+    input.CopyToString(&input_copy->data());
+    json = input_copy->data();
   }
+
+  TreeBuilder builder(input_copy.get());
+  if (!Parse(json, &builder))
+    return NULL;
+  Value* root = builder.Release();
+  DCHECK(root);
+  return root;
+}
+
+bool JSONParser::Parse(const StringPiece& input, JSONStreamHandler* handler) {
+  DCHECK(handler);
+  handler_ = handler;
+  start_pos_ = input.data();
   pos_ = start_pos_;
   end_pos_ = start_pos_ + input.length();
   index_ = 0;
@@ -243,35 +182,18 @@ Value* JSONParser::Parse(const StringPiece& input) {
   }
 
   // Parse the first and any nested tokens.
-  scoped_ptr<Value> root(ParseNextToken());
-  if (!root.get())
-    return NULL;
+  bool result = ParseNextToken();
 
   // Make sure the input stream is at an end.
-  if (GetNextToken() != T_END_OF_INPUT) {
+  if (result && GetNextToken() != T_END_OF_INPUT) {
     if (!CanConsume(1) || (NextChar() && GetNextToken() != T_END_OF_INPUT)) {
       ReportError(JSONReader::JSON_UNEXPECTED_DATA_AFTER_ROOT, 1);
-      return NULL;
-    }
-  }
-
-  // Dictionaries and lists can contain JSONStringValues, so wrap them in a
-  // hidden root.
-  if (!(options_ & JSON_DETACHABLE_CHILDREN)) {
-    if (root->IsType(Value::TYPE_DICTIONARY)) {
-      return new DictionaryHiddenRootValue(&input_copy, root.get());
-    } else if (root->IsType(Value::TYPE_LIST)) {
-      return new ListHiddenRootValue(&input_copy, root.get());
-    } else if (root->IsType(Value::TYPE_STRING)) {
-      // A string type could be a JSONStringValue, but because there's no
-      // corresponding HiddenRootValue, the memory will be lost. Deep copy to
-      // preserve it.
-      return root->DeepCopy();
+      result = false;
     }
   }
 
-  // All other values can be returned directly.
-  return root.release();
+  handler_ = NULL;
+  return result;
 }
 
 JSONReader::JsonParseError JSONParser::error_code() const {
@@ -322,6 +244,15 @@ void JSONParser::StringBuilder::AppendString(const std::string& str) {
   string_->append(str);
 }
 
+void JSONParser::StringBuilder::AppendRun(const char* str, size_t length) {
+  if (string_) {
+    string_->append(str, length);
+  } else {
+    DCHECK_EQ(pos_ + length_, str);
+    length_ += length;
+  }
+}
+
 void JSONParser::StringBuilder::Convert() {
   if (string_)
     return;
@@ -344,6 +275,12 @@ const std::string& JSONParser::StringBuilder::AsString() {
   return *string_;
 }
 
+StringPiece JSONParser::StringBuilder::AsAnyStringPiece() {
+  if (string_)
+    return *string_;
+  return StringPiece(pos_, length_);
+}
+
 // JSONParser private //////////////////////////////////////////////////////////
 
 inline bool JSONParser::CanConsume(int length) {
@@ -458,11 +395,11 @@ bool JSONParser::EatComment() {
   return false;
 }
 
-Value* JSONParser::ParseNextToken() {
+bool JSONParser::ParseNextToken() {
   return ParseToken(GetNextToken());
 }
 
-Value* JSONParser::ParseToken(Token token) {
+bool JSONParser::ParseToken(Token token) {
   switch (token) {
     case T_OBJECT_BEGIN:
       return ConsumeDictionary();
@@ -478,36 +415,37 @@ Value* JSONParser::ParseToken(Token token) {
       return ConsumeLiteral();
     default:
       ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
-      return NULL;
+      return false;
   }
 }
 
-Value* JSONParser::ConsumeDictionary() {
+bool JSONParser::ConsumeDictionary() {
   if (*pos_ != '{') {
     ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
-    return NULL;
+    return false;
   }
 
   StackMarker depth_check(&stack_depth_);
   if (depth_check.IsTooDeep()) {
     ReportError(JSONReader::JSON_TOO_MUCH_NESTING, 1);
-    return NULL;
+    return false;
   }
 
-  scoped_ptr<DictionaryValue> dict(new DictionaryValue);
+  if (!CheckHandler(handler_->OnDictionaryBegin()))
+    return false;
 
   NextChar();
   Token token = GetNextToken();
   while (token != T_OBJECT_END) {
     if (token != T_STRING) {
       ReportError(JSONReader::JSON_UNQUOTED_DICTIONARY_KEY, 1);
-      return NULL;
+      return false;
     }
 
     // First consume the key.
     StringBuilder key;
     if (!ConsumeStringRaw(&key)) {
-      return NULL;
+      return false;
     }
 
     // Read the separator.
@@ -515,19 +453,19 @@ Value* JSONParser::ConsumeDictionary() {
     token = GetNextToken();
     if (token != T_OBJECT_PAIR_SEPARATOR) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
 
-    // The next token is the value. Ownership transfers to |dict|.
+    if (!CheckHandler(handler_->OnDictionaryKey(key.AsAnyStringPiece())))
+      return false;
+
+    // The next token is the value.
     NextChar();
-    Value* value = ParseNextToken();
-    if (!value) {
+    if (!ParseNextToken()) {
       // ReportError from deeper level.
-      return NULL;
+      return false;
     }
 
-    dict->SetWithoutPathExpansion(key.AsString(), value);
-
     NextChar();
     token = GetNextToken();
     if (token == T_LIST_SEPARATOR) {
@@ -535,42 +473,40 @@ Value* JSONParser::ConsumeDictionary() {
       token = GetNextToken();
       if (token == T_OBJECT_END && !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
         ReportError(JSONReader::JSON_TRAILING_COMMA, 1);
-        return NULL;
+        return false;
       }
     } else if (token != T_OBJECT_END) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 0);
-      return NULL;
+      return false;
     }
   }
 
-  return dict.release();
+  return CheckHandler(handler_->OnDictionaryEnd());
 }
 
-Value* JSONParser::ConsumeList() {
+bool JSONParser::ConsumeList() {
   if (*pos_ != '[') {
     ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
-    return NULL;
+    return false;
   }
 
   StackMarker depth_check(&stack_depth_);
   if (depth_check.IsTooDeep()) {
     ReportError(JSONReader::JSON_TOO_MUCH_NESTING, 1);
-    return NULL;
+    return false;
   }
 
-  scoped_ptr<ListValue> list(new ListValue);
+  if (!CheckHandler(handler_->OnListBegin()))
+    return false;
 
   NextChar();
   Token token = GetNextToken();
   while (token != T_ARRAY_END) {
-    Value* item = ParseToken(token);
-    if (!item) {
+    if (!ParseToken(token)) {
       // ReportError from deeper level.
-      return NULL;
+      return false;
     }
 
-    list->Append(item);
-
     NextChar();
     token = GetNextToken();
     if (token == T_LIST_SEPARATOR) {
@@ -578,31 +514,25 @@ Value* JSONParser::ConsumeList() {
       token = GetNextToken();
       if (token == T_ARRAY_END && !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
         ReportError(JSONReader::JSON_TRAILING_COMMA, 1);
-        return NULL;
+        return false;
       }
     } else if (token != T_ARRAY_END) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
   }
 
-  return list.release();
+  return CheckHandler(handler_->OnListEnd());
 }
 
-Value* JSONParser::ConsumeString() {
+bool JSONParser::ConsumeString() {
   StringBuilder string;
   if (!ConsumeStringRaw(&string))
-    return NULL;
+    return false;
 
-  // Create the Value representation, using a hidden root, if configured
-  // to do so, and if the string can be represented by StringPiece.
-  if (string.CanBeStringPiece() && !(options_ & JSON_DETACHABLE_CHILDREN)) {
-    return new JSONStringValue(string.AsStringPiece());
-  } else {
-    if (string.CanBeStringPiece())
-      string.Convert();
-    return new StringValue(string.AsString());
-  }
+  // A string which can be represented by StringPiece points into the input,
+  // which lets the tree builder avoid copying it.
+  return CheckHandler(handler_->OnString(string.AsAnyStringPiece()));
 }
 
 bool JSONParser::ConsumeStringRaw(StringBuilder* out) {
@@ -621,6 +551,18 @@ bool JSONParser::ConsumeStringRaw(StringBuilder* out) {
 
   while (CanConsume(1)) {
     pos_ = start_pos_ + index_;  // CBU8_NEXT is postcrement.
+
+    // Plain ASCII needs neither decoding nor unescaping, so take any run of it
+    // in one go.
+    size_t run = CountPlainJSONChars(pos_, end_pos_ - pos_);
+    if (run) {
+      string.AppendRun(pos_, run);
+      index_ += run;
+      pos_ += run;
+      if (!CanConsume(1))
+        break;
+    }
+
     CBU8_NEXT(start_pos_, index_, length, next_char);
     if (next_char < 0 || !IsValidCharacter(next_char)) {
       ReportError(JSONReader::JSON_UNSUPPORTED_ENCODING, 1);
@@ -808,7 +750,7 @@ void JSONParser::DecodeUTF8(const int32& point, StringBuilder* dest) {
   }
 }
 
-Value* JSONParser::ConsumeNumber() {
+bool JSONParser::ConsumeNumber() {
   const char* num_start = pos_;
   const int start_index = index_;
   int end_index = start_index;
@@ -818,7 +760,7 @@ Value* JSONParser::ConsumeNumber() {
 
   if (!ReadInt(false)) {
     ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-    return NULL;
+    return false;
   }
   end_index = index_;
 
@@ -826,12 +768,12 @@ Value* JSONParser::ConsumeNumber() {
   if (*pos_ == '.') {
     if (!CanConsume(1)) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
     NextChar();
     if (!ReadInt(true)) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
     end_index = index_;
   }
@@ -843,7 +785,7 @@ Value* JSONParser::ConsumeNumber() {
       NextChar();
     if (!ReadInt(true)) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
     end_index = index_;
   }
@@ -863,7 +805,7 @@ Value* JSONParser::ConsumeNumber() {
       break;
     default:
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
   }
 
   pos_ = exit_pos;
@@ -873,15 +815,15 @@ Value* JSONParser::ConsumeNumber() {
 
   int num_int;
   if (StringToInt(num_string, &num_int))
-    return Value::CreateIntegerValue(num_int);
+    return CheckHandler(handler_->OnInteger(num_int));
 
   double num_double;
   if (base::StringToDouble(num_string.as_string(), &num_double) &&
       IsFinite(num_double)) {
-    return Value::CreateDoubleValue(num_double);
+    return CheckHandler(handler_->OnDouble(num_double));
   }
 
-  return NULL;
+  return false;
 }
 
 bool JSONParser::ReadInt(bool allow_leading_zeros) {
@@ -903,7 +845,7 @@ bool JSONParser::ReadInt(bool allow_leading_zeros) {
   return true;
 }
 
-Value* JSONParser::ConsumeLiteral() {
+bool JSONParser::ConsumeLiteral() {
   switch (*pos_) {
     case 't': {
       const char* kTrueLiteral = "true";
@@ -911,10 +853,10 @@ Value* JSONParser::ConsumeLiteral() {
       if (!CanConsume(kTrueLen - 1) ||
           !StringsAreEqual(pos_, kTrueLiteral, kTrueLen)) {
         ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-        return NULL;
+        return false;
       }
       NextNChars(kTrueLen - 1);
-      return Value::CreateBooleanValue(true);
+      return CheckHandler(handler_->OnBoolean(true));
     }
     case 'f': {
       const char* kFalseLiteral = "false";
@@ -922,10 +864,10 @@ Value* JSONParser::ConsumeLiteral() {
       if (!CanConsume(kFalseLen - 1) ||
           !StringsAreEqual(pos_, kFalseLiteral, kFalseLen)) {
         ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-        return NULL;
+        return false;
       }
       NextNChars(kFalseLen - 1);
-      return Value::CreateBooleanValue(false);
+      return CheckHandler(handler_->OnBoolean(false));
     }
     case 'n': {
       const char* kNullLiteral = "null";
@@ -933,17 +875,23 @@ Value* JSONParser::ConsumeLiteral() {
       if (!CanConsume(kNullLen - 1) ||
           !StringsAreEqual(pos_, kNullLiteral, kNullLen)) {
         ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-        return NULL;
+        return false;
       }
       NextNChars(kNullLen - 1);
-      return Value::CreateNullValue();
+      return CheckHandler(handler_->OnNull());
     }
     default:
       ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
-      return NULL;
+      return false;
   }
 }
 
+bool JSONParser::CheckHandler(bool handler_result) {
+  if (!handler_result)
+    ReportError(JSONReader::JSON_PARSE_ABORTED, 1);
+  return handler_result;
+}
+
 // static
 bool JSONParser::StringsAreEqual(const char* one, const char* two, size_t len) {
   return strncmp(one, two, len) == 0;
@@ -19,6 +19,7 @@
 #endif
 
 namespace base {
+class JSONStreamHandler;
 class Value;
 }
 
@@ -46,7 +47,8 @@ class JSONParserTest;
 //
 // This parser guarantees O(n) time through the input string. It also optimizes
 // base::StringValue by using StringPiece where possible when returning Value
-// objects by using "hidden roots," discussed in the implementation.
+// objects, pointing into a refcounted copy of the input; see the
+// implementation.
 //
 // Iteration happens on the byte level, with the functions CanConsume and
 // NextChar. The conversion from byte to JSON token happens without advancing
@@ -59,6 +61,9 @@ class JSONParserTest;
 // of a token, such that the next iteration of the parser will be at the byte
 // immediately following the token, which would likely be the first byte of the
 // next token.
+//
+// The Consume functions report what they find to a JSONStreamHandler. When a
+// Value is wanted, the handler is a builder which assembles the tree.
 class BASE_EXPORT_PRIVATE JSONParser {
  public:
   explicit JSONParser(int options);
@@ -68,6 +73,11 @@ class BASE_EXPORT_PRIVATE JSONParser {
   // result as a Value owned by the caller.
   Value* Parse(const StringPiece& input);
 
+  // Parses the input string according to the set options, reporting it to
+  // |handler|. Returns false if the input is not valid or the handler stopped
+  // the parse. |input| need only outlive the call.
+  bool Parse(const StringPiece& input, JSONStreamHandler* handler);
+
   // Returns the error code.
   JSONReader::JsonParseError error_code() const;
 
@@ -118,6 +128,10 @@ class BASE_EXPORT_PRIVATE JSONParser {
     // Appends a string to the std::string. Must be Convert()ed to use.
     void AppendString(const std::string& str);
 
+    // Appends the |length| ASCII characters at |str|. Unless the builder has
+    // been converted, they must be the next characters of the input string.
+    void AppendRun(const char* str, size_t length);
+
     // Converts the builder from its default StringPiece to a full std::string,
     // performing a copy. Once a builder is converted, it cannot be made a
     // StringPiece again.
@@ -133,6 +147,10 @@ class BASE_EXPORT_PRIVATE JSONParser {
     // Returns the builder as a std::string.
     const std::string& AsString();
 
+    // Returns the string built, as a StringPiece into the input if possible
+    // and into the converted copy otherwise. Valid as long as the builder.
+    StringPiece AsAnyStringPiece();
+
    private:
     // The beginning of the input string.
     const char* pos_;
@@ -166,24 +184,23 @@ class BASE_EXPORT_PRIVATE JSONParser {
   // currently wound to a '/'.
   bool EatComment();
 
-  // Calls GetNextToken() and then ParseToken(). Caller owns the result.
-  Value* ParseNextToken();
+  // Calls GetNextToken() and then ParseToken().
+  bool ParseNextToken();
 
   // Takes a token that represents the start of a Value ("a structural token"
-  // in RFC terms) and consumes it, returning the result as an object the
-  // caller owns.
-  Value* ParseToken(Token token);
+  // in RFC terms) and consumes it, reporting it to |handler_|. Returns false
+  // on error.
+  bool ParseToken(Token token);
 
   // Assuming that the parser is currently wound to '{', this parses a JSON
-  // object into a DictionaryValue.
-  Value* ConsumeDictionary();
+  // object.
+  bool ConsumeDictionary();
 
-  // Assuming that the parser is wound to '[', this parses a JSON list into a
-  // ListValue.
-  Value* ConsumeList();
+  // Assuming that the parser is wound to '[', this parses a JSON list.
+  bool ConsumeList();
 
-  // Calls through ConsumeStringRaw and wraps it in a value.
-  Value* ConsumeString();
+  // Calls through ConsumeStringRaw and reports the string.
+  bool ConsumeString();
 
   // Assuming that the parser is wound to a double quote, this parses a string,
   // decoding any escape sequences and converts UTF-16 to UTF-8. Returns true on
@@ -203,14 +220,18 @@ class BASE_EXPORT_PRIVATE JSONParser {
 
   // Assuming that the parser is wound to the start of a valid JSON number,
   // this parses and converts it to either an int or double value.
-  Value* ConsumeNumber();
+  bool ConsumeNumber();
   // Helper that reads characters that are ints. Returns true if a number was
   // read and false on error.
   bool ReadInt(bool allow_leading_zeros);
 
   // Consumes the literal values of |true|, |false|, and |null|, assuming the
   // parser is wound to the first character of any of those.
-  Value* ConsumeLiteral();
+  bool ConsumeLiteral();
+
+  // Passes through the result of a |handler_| call, reporting an error if the
+  // handler stopped the parse.
+  bool CheckHandler(bool handler_result);
 
   // Compares two string buffers of a given length.
   static bool StringsAreEqual(const char* left, const char* right, size_t len);
@@ -228,6 +249,9 @@ class BASE_EXPORT_PRIVATE JSONParser {
   // base::JSONParserOptions that control parsing.
   int options_;
 
+  // Receives the parse. Weak, and only set during Parse().
+  JSONStreamHandler* handler_;
+
   // Pointer to the start of the input data.
   const char* start_pos_;
 
@@ -5,6 +5,7 @@
 #include "base/json/json_parser.h"
 
 #include "base/json/json_reader.h"
+#include "base/json/json_stream_reader.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/values.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -22,6 +23,16 @@ class JSONParserTest : public testing::Test {
     return parser;
   }
 
+  // Runs one of the parser's Consume functions, returning what it consumed
+  // as a Value owned by the caller, or NULL on error.
+  Value* Consume(JSONParser* parser, bool (JSONParser::*consume)()) {
+    JSONValueBuilder builder;
+    parser->handler_ = &builder;
+    bool result = (parser->*consume)();
+    parser->handler_ = NULL;
+    return result ? builder.Release() : NULL;
+  }
+
   void TestLastThree(JSONParser* parser) {
     EXPECT_EQ(',', *parser->NextChar());
     EXPECT_EQ('|', *parser->NextChar());
@@ -44,7 +55,7 @@ TEST_F(JSONParserTest, NextChar) {
 TEST_F(JSONParserTest, ConsumeString) {
   std::string input("\"test\",|");
   scoped_ptr<JSONParser> parser(NewTestParser(input));
-  scoped_ptr<Value> value(parser->ConsumeString());
+  scoped_ptr<Value> value(Consume(parser.get(), &JSONParser::ConsumeString));
   EXPECT_EQ('"', *parser->pos_);
 
   TestLastThree(parser.get());
@@ -58,7 +69,7 @@ TEST_F(JSONParserTest, ConsumeString) {
 TEST_F(JSONParserTest, ConsumeList) {
   std::string input("[true, false],|");
   scoped_ptr<JSONParser> parser(NewTestParser(input));
-  scoped_ptr<Value> value(parser->ConsumeList());
+  scoped_ptr<Value> value(Consume(parser.get(), &JSONParser::ConsumeList));
   EXPECT_EQ(']', *parser->pos_);
 
   TestLastThree(parser.get());
@@ -72,7 +83,8 @@ TEST_F(JSONParserTest, ConsumeList) {
 TEST_F(JSONParserTest, ConsumeDictionary) {
   std::string input("{\"abc\":\"def\"},|");
   scoped_ptr<JSONParser> parser(NewTestParser(input));
-  scoped_ptr<Value> value(parser->ConsumeDictionary());
+  scoped_ptr<Value> value(
+      Consume(parser.get(), &JSONParser::ConsumeDictionary));
   EXPECT_EQ('}', *parser->pos_);
 
   TestLastThree(parser.get());
@@ -89,7 +101,7 @@ TEST_F(JSONParserTest, ConsumeLiterals) {
   // Literal |true|.
   std::string input("true,|");
   scoped_ptr<JSONParser> parser(NewTestParser(input));
-  scoped_ptr<Value> value(parser->ConsumeLiteral());
+  scoped_ptr<Value> value(Consume(parser.get(), &JSONParser::ConsumeLiteral));
   EXPECT_EQ('e', *parser->pos_);
 
   TestLastThree(parser.get());
@@ -102,7 +114,7 @@ TEST_F(JSONParserTest, ConsumeLiterals) {
   // Literal |false|.
   input = "false,|";
   parser.reset(NewTestParser(input));
-  value.reset(parser->ConsumeLiteral());
+  value.reset(Consume(parser.get(), &JSONParser::ConsumeLiteral));
   EXPECT_EQ('e', *parser->pos_);
 
   TestLastThree(parser.get());
@@ -114,7 +126,7 @@ TEST_F(JSONParserTest, ConsumeLiterals) {
   // Literal |null|.
   input = "null,|";
   parser.reset(NewTestParser(input));
-  value.reset(parser->ConsumeLiteral());
+  value.reset(Consume(parser.get(), &JSONParser::ConsumeLiteral));
   EXPECT_EQ('l', *parser->pos_);
 
   TestLastThree(parser.get());
@@ -127,7 +139,7 @@ TEST_F(JSONParserTest, ConsumeNumbers) {
   // Integer.
   std::string input("1234,|");
   scoped_ptr<JSONParser> parser(NewTestParser(input));
-  scoped_ptr<Value> value(parser->ConsumeNumber());
+  scoped_ptr<Value> value(Consume(parser.get(), &JSONParser::ConsumeNumber));
   EXPECT_EQ('4', *parser->pos_);
 
   TestLastThree(parser.get());
@@ -140,7 +152,7 @@ TEST_F(JSONParserTest, ConsumeNumbers) {
   // Negative integer.
   input = "-1234,|";
   parser.reset(NewTestParser(input));
-  value.reset(parser->ConsumeNumber());
+  value.reset(Consume(parser.get(), &JSONParser::ConsumeNumber));
   EXPECT_EQ('4', *parser->pos_);
 
   TestLastThree(parser.get());
@@ -152,7 +164,7 @@ TEST_F(JSONParserTest, ConsumeNumbers) {
   // Double.
   input = "12.34,|";
   parser.reset(NewTestParser(input));
-  value.reset(parser->ConsumeNumber());
+  value.reset(Consume(parser.get(), &JSONParser::ConsumeNumber));
   EXPECT_EQ('4', *parser->pos_);
 
   TestLastThree(parser.get());
@@ -165,7 +177,7 @@ TEST_F(JSONParserTest, ConsumeNumbers) {
   // Scientific.
   input = "42e3,|";
   parser.reset(NewTestParser(input));
-  value.reset(parser->ConsumeNumber());
+  value.reset(Consume(parser.get(), &JSONParser::ConsumeNumber));
   EXPECT_EQ('3', *parser->pos_);
 
   TestLastThree(parser.get());
@@ -177,7 +189,7 @@ TEST_F(JSONParserTest, ConsumeNumbers) {
   // Negative scientific.
   input = "314159e-5,|";
   parser.reset(NewTestParser(input));
-  value.reset(parser->ConsumeNumber());
+  value.reset(Consume(parser.get(), &JSONParser::ConsumeNumber));
   EXPECT_EQ('5', *parser->pos_);
 
   TestLastThree(parser.get());
@@ -189,7 +201,7 @@ TEST_F(JSONParserTest, ConsumeNumbers) {
   // Positive scientific.
   input = "0.42e+3,|";
   parser.reset(NewTestParser(input));
-  value.reset(parser->ConsumeNumber());
+  value.reset(Consume(parser.get(), &JSONParser::ConsumeNumber));
   EXPECT_EQ('3', *parser->pos_);
 
   TestLastThree(parser.get());
@@ -0,0 +1,114 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/json/string_scan.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "base/utf_string_conversions.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kIterations = 20;
+
+// A document shaped like the bookmarks and manifests we read: entries with
+// mostly prose strings, the occasional escape and a little non-ASCII text.
+std::string MakeDocument() {
+  const char kDescription[] =
+      "A long description of the entry, written in plain sentences the way "
+      "people describe things, with the odd \\\"quoted\\\" phrase, a line "
+      "break\\nand a caf\\u00e9 here or there. It goes on for a while so "
+      "that it looks like the text we actually store in these files.";
+  std::string json("[");
+  for (int i = 0; i < 2000; ++i) {
+    if (i)
+      json += ",";
+    base::StringAppendF(&json,
+        "{\"id\": %d, \"title\": \"The title of entry number %d\", "
+        "\"url\": \"http://www.example.com/some/path/to/entry/%d.html\", "
+        "\"description\": \"%s\", "
+        "\"tags\": [\"first tag\", \"second tag\", \"third\"]}",
+        i, i, i, kDescription);
+  }
+  json += "]";
+  return json;
+}
+
+double MegabytesPerSecond(size_t bytes, int iterations,
+                          base::TimeDelta elapsed) {
+  return static_cast<double>(bytes) * iterations / (1024 * 1024) /
+      elapsed.InSecondsF();
+}
+
+// Times |scan| over |text|, which ends in the only character it stops at.
+template <class STR>
+void TimeScan(const char* name,
+              size_t (*scan)(const typename STR::value_type*, size_t),
+              const STR& text) {
+  const int kScans = 200;
+  size_t total = 0;
+  PerfTimer timer;
+  for (int i = 0; i < kScans; ++i)
+    total += scan(text.data(), text.size());
+  LogPerfResult(name,
+                MegabytesPerSecond(text.size() * sizeof(text[0]), kScans,
+                                   timer.Elapsed()),
+                "MB/s");
+  EXPECT_EQ(kScans * (text.size() - 1), total);
+}
+
+}  // namespace
+
+TEST(JSONPerfTest, Read) {
+  std::string json(MakeDocument());
+  PerfTimer timer;
+  for (int i = 0; i < kIterations; ++i) {
+    scoped_ptr<base::Value> value(base::JSONReader::Read(json));
+    ASSERT_TRUE(value.get());
+  }
+  LogPerfResult("JSON_Read",
+                MegabytesPerSecond(json.size(), kIterations, timer.Elapsed()),
+                "MB/s");
+}
+
+TEST(JSONPerfTest, Write) {
+  std::string json(MakeDocument());
+  scoped_ptr<base::Value> value(base::JSONReader::Read(json));
+  ASSERT_TRUE(value.get());
+  std::string output;
+  PerfTimer timer;
+  for (int i = 0; i < kIterations; ++i)
+    base::JSONWriter::Write(value.get(), &output);
+  LogPerfResult("JSON_Write",
+                MegabytesPerSecond(output.size(), kIterations,
+                                   timer.Elapsed()),
+                "MB/s");
+}
+
+// The scans alone, vector against one character at a time, over a long run
+// of prose.
+TEST(JSONPerfTest, Scan) {
+  std::string text;
+  for (int i = 0; i < 20000; ++i)
+    text += "A long description of the entry, written in plain sentences. ";
+  text += "\"";
+  string16 text16(ASCIIToUTF16(text));
+
+  TimeScan("JSON_ScanPlain", &base::internal::CountPlainJSONChars, text);
+  TimeScan("JSON_ScanPlain_C", &base::internal::CountPlainJSONChars_C, text);
+  TimeScan("JSON_ScanUnescaped", &base::internal::CountUnescapedJSONChars,
+           text);
+  TimeScan("JSON_ScanUnescaped_C", &base::internal::CountUnescapedJSONChars_C,
+           text);
+  TimeScan("JSON_ScanUnescaped16", &base::internal::CountUnescapedJSONChars,
+           text16);
+  TimeScan("JSON_ScanUnescaped16_C",
+           &base::internal::CountUnescapedJSONChars_C, text16);
+}
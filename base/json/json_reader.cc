@@ -25,6 +25,8 @@ const char* JSONReader::kUnsupportedEncoding =
     "Unsupported encoding. JSON must be UTF-8.";
 const char* JSONReader::kUnquotedDictionaryKey =
     "Dictionary keys must be quoted.";
+const char* JSONReader::kParseAborted =
+    "Parsing was stopped by the handler.";
 
 JSONReader::JSONReader()
     : parser_(new internal::JSONParser(JSON_PARSE_RFC)) {
@@ -89,6 +91,8 @@ std::string JSONReader::ErrorCodeToString(JsonParseError error_code) {
       return kUnsupportedEncoding;
     case JSON_UNQUOTED_DICTIONARY_KEY:
       return kUnquotedDictionaryKey;
+    case JSON_PARSE_ABORTED:
+      return kParseAborted;
     default:
       NOTREACHED();
       return std::string();
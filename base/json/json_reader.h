@@ -54,10 +54,10 @@ enum JSONParserOptions {
   // Allows commas to exist after the last element in structures.
   JSON_ALLOW_TRAILING_COMMAS = 1 << 0,
 
-  // The parser can perform optimizations by placing hidden data in the root of
-  // the JSON object, which speeds up certain operations on children. However,
-  // if the child is Remove()d from root, it would result in use-after-free
-  // unless it is DeepCopy()ed or this option is used.
+  // The parser avoids copying strings by pointing them into a refcounted copy
+  // of the input, which they keep alive.  This option copies them instead, so
+  // that the children don't hold on to the whole input once Remove()d from
+  // the root.
   JSON_DETACHABLE_CHILDREN = 1 << 1,
 };
 
@@ -74,6 +74,7 @@ class BASE_EXPORT JSONReader {
     JSON_UNEXPECTED_DATA_AFTER_ROOT,
     JSON_UNSUPPORTED_ENCODING,
     JSON_UNQUOTED_DICTIONARY_KEY,
+    JSON_PARSE_ABORTED,
   };
 
   // String versions of parse error codes.
@@ -85,6 +86,7 @@ class BASE_EXPORT JSONReader {
   static const char* kUnexpectedDataAfterRoot;
   static const char* kUnsupportedEncoding;
   static const char* kUnquotedDictionaryKey;
+  static const char* kParseAborted;
 
   // Constructs a reader with the default options, JSON_PARSE_RFC.
   JSONReader();
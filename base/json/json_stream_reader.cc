@@ -0,0 +1,179 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_stream_reader.h"
+
+#include "base/json/json_parser.h"
+#include "base/logging.h"
+#include "base/values.h"
+
+namespace base {
+
+// JSONValueBuilder ////////////////////////////////////////////////////////////
+
+JSONValueBuilder::JSONValueBuilder() {
+}
+
+JSONValueBuilder::~JSONValueBuilder() {
+}
+
+bool JSONValueBuilder::IsComplete() const {
+  return root_.get() && open_containers_.empty();
+}
+
+Value* JSONValueBuilder::Release() {
+  if (!IsComplete())
+    return NULL;
+  return root_.release();
+}
+
+bool JSONValueBuilder::OnDictionaryBegin() {
+  DictionaryValue* dictionary = new DictionaryValue;
+  if (!AddValue(dictionary))
+    return false;
+  open_containers_.push_back(dictionary);
+  return true;
+}
+
+bool JSONValueBuilder::OnDictionaryKey(const StringPiece& key) {
+  if (open_containers_.empty() ||
+      !open_containers_.back()->IsType(Value::TYPE_DICTIONARY)) {
+    NOTREACHED();
+    return false;
+  }
+  keys_.push_back(key.as_string());
+  return true;
+}
+
+bool JSONValueBuilder::OnDictionaryEnd() {
+  if (open_containers_.empty() ||
+      !open_containers_.back()->IsType(Value::TYPE_DICTIONARY)) {
+    NOTREACHED();
+    return false;
+  }
+  open_containers_.pop_back();
+  return true;
+}
+
+bool JSONValueBuilder::OnListBegin() {
+  ListValue* list = new ListValue;
+  if (!AddValue(list))
+    return false;
+  open_containers_.push_back(list);
+  return true;
+}
+
+bool JSONValueBuilder::OnListEnd() {
+  if (open_containers_.empty() ||
+      !open_containers_.back()->IsType(Value::TYPE_LIST)) {
+    NOTREACHED();
+    return false;
+  }
+  open_containers_.pop_back();
+  return true;
+}
+
+bool JSONValueBuilder::OnString(const StringPiece& value) {
+  return AddValue(CreateStringValue(value));
+}
+
+bool JSONValueBuilder::OnInteger(int value) {
+  return AddValue(Value::CreateIntegerValue(value));
+}
+
+bool JSONValueBuilder::OnDouble(double value) {
+  return AddValue(Value::CreateDoubleValue(value));
+}
+
+bool JSONValueBuilder::OnBoolean(bool value) {
+  return AddValue(Value::CreateBooleanValue(value));
+}
+
+bool JSONValueBuilder::OnNull() {
+  return AddValue(Value::CreateNullValue());
+}
+
+Value* JSONValueBuilder::CreateStringValue(const StringPiece& value) {
+  return Value::CreateStringValue(value.as_string());
+}
+
+bool JSONValueBuilder::AddValue(Value* value) {
+  if (open_containers_.empty()) {
+    if (root_.get()) {
+      // A second root; the handler was given more than one document.
+      NOTREACHED();
+      delete value;
+      return false;
+    }
+    root_.reset(value);
+    return true;
+  }
+
+  Value* container = open_containers_.back();
+  if (container->IsType(Value::TYPE_DICTIONARY)) {
+    if (keys_.empty()) {
+      NOTREACHED();
+      delete value;
+      return false;
+    }
+    static_cast<DictionaryValue*>(container)->SetWithoutPathExpansion(
+        keys_.back(), value);
+    keys_.pop_back();
+  } else {
+    static_cast<ListValue*>(container)->Append(value);
+  }
+  return true;
+}
+
+// JSONStreamReader ////////////////////////////////////////////////////////////
+
+JSONStreamReader::JSONStreamReader(JSONStreamHandler* handler, int options)
+    : handler_(handler),
+      parser_(new internal::JSONParser(options)),
+      finished_(false) {
+  DCHECK(handler_);
+}
+
+JSONStreamReader::~JSONStreamReader() {
+}
+
+void JSONStreamReader::Append(const StringPiece& chunk) {
+  DCHECK(!finished_);
+  chunk.AppendToString(&input_);
+}
+
+bool JSONStreamReader::Finish() {
+  DCHECK(!finished_);
+  finished_ = true;
+  bool result = parser_->Parse(input_, handler_);
+  std::string().swap(input_);
+  return result;
+}
+
+// static
+bool JSONStreamReader::Parse(const StringPiece& json,
+                             int options,
+                             JSONStreamHandler* handler,
+                             int* error_code_out,
+                             std::string* error_msg_out) {
+  internal::JSONParser parser(options);
+  if (parser.Parse(json, handler))
+    return true;
+
+  if (error_code_out)
+    *error_code_out = parser.error_code();
+  if (error_msg_out)
+    *error_msg_out = parser.GetErrorMessage();
+  return false;
+}
+
+JSONReader::JsonParseError JSONStreamReader::error_code() const {
+  return parser_->error_code();
+}
+
+std::string JSONStreamReader::GetErrorMessage() const {
+  return parser_->GetErrorMessage();
+}
+
+}  // namespace base
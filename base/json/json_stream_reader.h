@@ -0,0 +1,161 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// An event based interface to the JSON parser.  Instead of building a Value
+// tree, JSONStreamReader reports the structure of the input to a
+// JSONStreamHandler as it goes, so a caller that only needs some of a large
+// document, or that stores it in its own structures, never holds the whole
+// document as Values.
+//
+// Usage:
+//   class KeyCounter : public base::JSONStreamHandler {
+//     ...
+//     virtual bool OnDictionaryKey(const base::StringPiece& key) OVERRIDE {
+//       ++keys_;
+//       return true;
+//     }
+//   };
+//
+//   KeyCounter counter;
+//   base::JSONStreamReader reader(&counter, base::JSON_PARSE_RFC);
+//   while (ReadChunk(&chunk))
+//     reader.Append(chunk);
+//   if (!reader.Finish())
+//     LOG(ERROR) << reader.GetErrorMessage();
+
+#ifndef BASE_JSON_JSON_STREAM_READER_H_
+#define BASE_JSON_JSON_STREAM_READER_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/string_piece.h"
+
+namespace base {
+
+class Value;
+
+// Receives the parts of a JSON document in document order.  A dictionary is
+// reported as OnDictionaryBegin(), then a key followed by its value for each
+// entry, then OnDictionaryEnd(); a list is reported likewise without keys.
+// The StringPieces passed in are only valid for the duration of the call.
+//
+// Each method returns false to stop the parse, which then fails with
+// JSONReader::JSON_PARSE_ABORTED.  The events up to the point of an error
+// have been delivered by the time the parse fails.
+class BASE_EXPORT JSONStreamHandler {
+ public:
+  virtual ~JSONStreamHandler() {}
+
+  virtual bool OnDictionaryBegin() = 0;
+  virtual bool OnDictionaryKey(const StringPiece& key) = 0;
+  virtual bool OnDictionaryEnd() = 0;
+
+  virtual bool OnListBegin() = 0;
+  virtual bool OnListEnd() = 0;
+
+  virtual bool OnString(const StringPiece& value) = 0;
+  virtual bool OnInteger(int value) = 0;
+  virtual bool OnDouble(double value) = 0;
+  virtual bool OnBoolean(bool value) = 0;
+  virtual bool OnNull() = 0;
+};
+
+// A handler which builds the Value that JSONReader::Read() would have
+// returned.  Use it to keep the parts of a streamed document that are wanted
+// as Values, by passing it the events for those parts only.
+class BASE_EXPORT JSONValueBuilder : public JSONStreamHandler {
+ public:
+  JSONValueBuilder();
+  virtual ~JSONValueBuilder();
+
+  // Returns true once a whole value has been built.
+  bool IsComplete() const;
+
+  // Returns the value built, which the caller owns, and resets the builder.
+  // Returns NULL unless IsComplete().
+  Value* Release();
+
+  // JSONStreamHandler:
+  virtual bool OnDictionaryBegin() OVERRIDE;
+  virtual bool OnDictionaryKey(const StringPiece& key) OVERRIDE;
+  virtual bool OnDictionaryEnd() OVERRIDE;
+  virtual bool OnListBegin() OVERRIDE;
+  virtual bool OnListEnd() OVERRIDE;
+  virtual bool OnString(const StringPiece& value) OVERRIDE;
+  virtual bool OnInteger(int value) OVERRIDE;
+  virtual bool OnDouble(double value) OVERRIDE;
+  virtual bool OnBoolean(bool value) OVERRIDE;
+  virtual bool OnNull() OVERRIDE;
+
+ protected:
+  // Creates the Value for a string; the parser overrides this to refer to
+  // its input instead of copying it.
+  virtual Value* CreateStringValue(const StringPiece& value);
+
+ private:
+  // Places |value| in the innermost open container, or makes it the root.
+  bool AddValue(Value* value);
+
+  scoped_ptr<Value> root_;
+
+  // The dictionaries and lists which have begun but not ended, innermost
+  // last, and the keys of the entries whose values are being read.
+  std::vector<Value*> open_containers_;
+  std::vector<std::string> keys_;
+
+  DISALLOW_COPY_AND_ASSIGN(JSONValueBuilder);
+};
+
+// Parses JSON which may arrive in several chunks, reporting it to a
+// JSONStreamHandler.  The chunks are kept until Finish() parses them, so the
+// input is held once; the Value tree JSONReader would build, several times
+// the size of the input, is never built.
+class BASE_EXPORT JSONStreamReader {
+ public:
+  // |handler| must outlive the reader.  |options| are JSONParserOptions;
+  // JSON_DETACHABLE_CHILDREN has no effect since no Values are made.
+  JSONStreamReader(JSONStreamHandler* handler, int options);
+  ~JSONStreamReader();
+
+  // Adds the next part of the input.  May not be called after Finish().
+  void Append(const StringPiece& chunk);
+
+  // Parses the input appended so far as a whole document.  Returns false if
+  // it is not well formed or the handler stopped the parse.
+  bool Finish();
+
+  // Parses |json| in one go.  |error_code_out| and |error_msg_out| are
+  // optional, and are set only on failure.
+  static bool Parse(const StringPiece& json,
+                    int options,  // JSONParserOptions
+                    JSONStreamHandler* handler,
+                    int* error_code_out,
+                    std::string* error_msg_out);
+
+  // Returns the error code if Finish() failed, JSON_NO_ERROR otherwise.
+  JSONReader::JsonParseError error_code() const;
+
+  // Converts error_code() to a human-readable string, including line and
+  // column numbers if appropriate.
+  std::string GetErrorMessage() const;
+
+ private:
+  JSONStreamHandler* handler_;
+  scoped_ptr<internal::JSONParser> parser_;
+  std::string input_;
+  bool finished_;
+
+  DISALLOW_COPY_AND_ASSIGN(JSONStreamReader);
+};
+
+}  // namespace base
+
+#endif  // BASE_JSON_JSON_STREAM_READER_H_
@@ -0,0 +1,134 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_stream_reader.h"
+
+#include <string>
+
+#include "base/compiler_specific.h"
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/string_number_conversions.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Records the events it is given as a string, and optionally stops the parse
+// at the |stop_at|th event.
+class EventRecorder : public JSONStreamHandler {
+ public:
+  explicit EventRecorder(int stop_at) : stop_at_(stop_at), count_(0) {}
+  virtual ~EventRecorder() {}
+
+  const std::string& events() const { return events_; }
+
+  virtual bool OnDictionaryBegin() OVERRIDE { return Record("{"); }
+  virtual bool OnDictionaryKey(const StringPiece& key) OVERRIDE {
+    return Record(key.as_string() + ":");
+  }
+  virtual bool OnDictionaryEnd() OVERRIDE { return Record("}"); }
+  virtual bool OnListBegin() OVERRIDE { return Record("["); }
+  virtual bool OnListEnd() OVERRIDE { return Record("]"); }
+  virtual bool OnString(const StringPiece& value) OVERRIDE {
+    return Record("'" + value.as_string() + "'");
+  }
+  virtual bool OnInteger(int value) OVERRIDE {
+    return Record("i" + IntToString(value));
+  }
+  virtual bool OnDouble(double value) OVERRIDE {
+    return Record("d" + DoubleToString(value));
+  }
+  virtual bool OnBoolean(bool value) OVERRIDE {
+    return Record(value ? "true" : "false");
+  }
+  virtual bool OnNull() OVERRIDE { return Record("null"); }
+
+ private:
+  bool Record(const std::string& event) {
+    if (!events_.empty())
+      events_ += " ";
+    events_ += event;
+    return ++count_ != stop_at_;
+  }
+
+  const int stop_at_;
+  int count_;
+  std::string events_;
+
+  DISALLOW_COPY_AND_ASSIGN(EventRecorder);
+};
+
+const char kDocument[] =
+    "{\"a\": [1, 2.5, \"x\\ty\"], \"b\": {\"c\": null}, \"d\": true}";
+
+}  // namespace
+
+TEST(JSONStreamReaderTest, Events) {
+  EventRecorder recorder(0);
+  EXPECT_TRUE(JSONStreamReader::Parse(kDocument, JSON_PARSE_RFC, &recorder,
+                                      NULL, NULL));
+  EXPECT_EQ("{ a: [ i1 d2.5 'x\ty' ] b: { c: null } d: true }",
+            recorder.events());
+}
+
+TEST(JSONStreamReaderTest, Chunks) {
+  // Any split of the input parses the same as the whole.
+  std::string document(kDocument);
+  for (size_t split = 0; split <= document.size(); ++split) {
+    EventRecorder recorder(0);
+    JSONStreamReader reader(&recorder, JSON_PARSE_RFC);
+    reader.Append(document.substr(0, split));
+    reader.Append(document.substr(split));
+    EXPECT_TRUE(reader.Finish());
+    EXPECT_EQ("{ a: [ i1 d2.5 'x\ty' ] b: { c: null } d: true }",
+              recorder.events());
+  }
+}
+
+TEST(JSONStreamReaderTest, Errors) {
+  // The events before a syntax error are delivered.
+  EventRecorder recorder(0);
+  JSONStreamReader reader(&recorder, JSON_PARSE_RFC);
+  reader.Append("[1, 2,]");
+  EXPECT_FALSE(reader.Finish());
+  EXPECT_EQ(JSONReader::JSON_TRAILING_COMMA, reader.error_code());
+  EXPECT_EQ("[ i1 i2", recorder.events());
+
+  // A handler can stop the parse.
+  EventRecorder stopper(3);
+  int error_code = 0;
+  std::string error_message;
+  EXPECT_FALSE(JSONStreamReader::Parse(kDocument, JSON_PARSE_RFC, &stopper,
+                                       &error_code, &error_message));
+  EXPECT_EQ(JSONReader::JSON_PARSE_ABORTED, error_code);
+  EXPECT_FALSE(error_message.empty());
+  EXPECT_EQ("{ a: [", stopper.events());
+}
+
+TEST(JSONStreamReaderTest, ValueBuilder) {
+  JSONValueBuilder builder;
+  EXPECT_FALSE(builder.IsComplete());
+  EXPECT_TRUE(JSONStreamReader::Parse(kDocument, JSON_PARSE_RFC, &builder,
+                                      NULL, NULL));
+  ASSERT_TRUE(builder.IsComplete());
+  scoped_ptr<Value> value(builder.Release());
+  scoped_ptr<Value> expected(JSONReader::Read(kDocument));
+  ASSERT_TRUE(value.get());
+  EXPECT_TRUE(value->Equals(expected.get()));
+  EXPECT_FALSE(builder.IsComplete());
+
+  // A scalar is a whole value too.
+  EXPECT_TRUE(JSONStreamReader::Parse("\"string\"", JSON_PARSE_RFC, &builder,
+                                      NULL, NULL));
+  value.reset(builder.Release());
+  std::string string_value;
+  ASSERT_TRUE(value.get());
+  EXPECT_TRUE(value->GetAsString(&string_value));
+  EXPECT_EQ("string", string_value);
+}
+
+}  // namespace base
@@ -0,0 +1,102 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_value_converter.h"
+
+namespace base {
+namespace internal {
+
+DictionaryMemberCollector::DictionaryMemberCollector(
+    const std::set<std::string>* keys)
+    : keys_(keys),
+      depth_(0) {
+}
+
+DictionaryMemberCollector::~DictionaryMemberCollector() {
+}
+
+bool DictionaryMemberCollector::OnDictionaryBegin() {
+  if (depth_++ == 0)
+    return true;
+  return !builder_.get() || builder_->OnDictionaryBegin();
+}
+
+bool DictionaryMemberCollector::OnDictionaryKey(const StringPiece& key) {
+  if (depth_ == 1) {
+    key.CopyToString(&key_);
+    if (keys_->count(key_))
+      builder_.reset(new JSONValueBuilder);
+    return true;
+  }
+  return !builder_.get() || builder_->OnDictionaryKey(key);
+}
+
+bool DictionaryMemberCollector::OnDictionaryEnd() {
+  if (--depth_ == 0)
+    return true;
+  if (builder_.get() && !builder_->OnDictionaryEnd())
+    return false;
+  MaybeFinishMember();
+  return true;
+}
+
+bool DictionaryMemberCollector::OnListBegin() {
+  // The top-level value must be a dictionary.
+  if (depth_++ == 0)
+    return false;
+  return !builder_.get() || builder_->OnListBegin();
+}
+
+bool DictionaryMemberCollector::OnListEnd() {
+  --depth_;
+  if (builder_.get() && !builder_->OnListEnd())
+    return false;
+  MaybeFinishMember();
+  return true;
+}
+
+bool DictionaryMemberCollector::OnString(const StringPiece& value) {
+  if (depth_ == 0 || (builder_.get() && !builder_->OnString(value)))
+    return false;
+  MaybeFinishMember();
+  return true;
+}
+
+bool DictionaryMemberCollector::OnInteger(int value) {
+  if (depth_ == 0 || (builder_.get() && !builder_->OnInteger(value)))
+    return false;
+  MaybeFinishMember();
+  return true;
+}
+
+bool DictionaryMemberCollector::OnDouble(double value) {
+  if (depth_ == 0 || (builder_.get() && !builder_->OnDouble(value)))
+    return false;
+  MaybeFinishMember();
+  return true;
+}
+
+bool DictionaryMemberCollector::OnBoolean(bool value) {
+  if (depth_ == 0 || (builder_.get() && !builder_->OnBoolean(value)))
+    return false;
+  MaybeFinishMember();
+  return true;
+}
+
+bool DictionaryMemberCollector::OnNull() {
+  if (depth_ == 0 || (builder_.get() && !builder_->OnNull()))
+    return false;
+  MaybeFinishMember();
+  return true;
+}
+
+void DictionaryMemberCollector::MaybeFinishMember() {
+  if (depth_ != 1 || !builder_.get())
+    return;
+  members_.SetWithoutPathExpansion(key_, builder_->Release());
+  builder_.reset();
+}
+
+}  // namespace internal
+}  // namespace base
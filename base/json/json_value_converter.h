@@ -6,10 +6,14 @@
 #define BASE_JSON_JSON_VALUE_CONVERTER_H_
 #pragma once
 
+#include <set>
 #include <string>
 #include <vector>
 
+#include "base/base_export.h"
 #include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/json/json_stream_reader.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
@@ -47,6 +51,12 @@
 //   JSONValueConverter<Message> converter;
 //   converter.Convert(json, &message);
 //
+// To convert JSON text without parsing it into a Value first, call
+// ConvertJSON() instead.  Only the members of the top-level dictionary that
+// fields are registered for are turned into Values; the rest of the input is
+// skipped as it is parsed.
+//   converter.ConvertJSON(json_string, &message);
+//
 // Convert() returns false when it fails.  Here "fail" means that the value is
 // structurally different from expected, such like a string value appears
 // for an int field.  Do not report failures for missing fields.
@@ -105,6 +115,45 @@ class FieldConverterBase {
   DISALLOW_COPY_AND_ASSIGN(FieldConverterBase);
 };
 
+// Collects the members of a top-level JSON dictionary whose keys are in
+// |keys|, skipping the others, for JSONValueConverter::ConvertJSON().
+class BASE_EXPORT DictionaryMemberCollector : public JSONStreamHandler {
+ public:
+  explicit DictionaryMemberCollector(const std::set<std::string>* keys);
+  virtual ~DictionaryMemberCollector();
+
+  // The members collected.  Only complete once the parse succeeds.
+  const DictionaryValue& members() const { return members_; }
+
+  // JSONStreamHandler:
+  virtual bool OnDictionaryBegin() OVERRIDE;
+  virtual bool OnDictionaryKey(const StringPiece& key) OVERRIDE;
+  virtual bool OnDictionaryEnd() OVERRIDE;
+  virtual bool OnListBegin() OVERRIDE;
+  virtual bool OnListEnd() OVERRIDE;
+  virtual bool OnString(const StringPiece& value) OVERRIDE;
+  virtual bool OnInteger(int value) OVERRIDE;
+  virtual bool OnDouble(double value) OVERRIDE;
+  virtual bool OnBoolean(bool value) OVERRIDE;
+  virtual bool OnNull() OVERRIDE;
+
+ private:
+  // Called after each event within a member; stores the member once its
+  // value is complete.
+  void MaybeFinishMember();
+
+  const std::set<std::string>* keys_;
+  DictionaryValue members_;
+
+  // The depth of the parse, the top-level dictionary being 1.
+  int depth_;
+  // The key of the member being read, and its builder if it is to be kept.
+  std::string key_;
+  scoped_ptr<JSONValueBuilder> builder_;
+
+  DISALLOW_COPY_AND_ASSIGN(DictionaryMemberCollector);
+};
+
 template <typename FieldType>
 class ValueConverter {
  public:
@@ -517,6 +566,21 @@ class JSONValueConverter {
     return true;
   }
 
+  // Parses |json| and converts it like Convert() does, without building a
+  // Value for the members of the top-level dictionary no field refers to.
+  bool ConvertJSON(const StringPiece& json, StructType* output) const {
+    std::set<std::string> keys;
+    for (size_t i = 0; i < fields_.size(); ++i) {
+      const std::string& path = fields_[i]->field_path();
+      keys.insert(path.substr(0, path.find('.')));
+    }
+
+    internal::DictionaryMemberCollector collector(&keys);
+    if (!JSONStreamReader::Parse(json, JSON_PARSE_RFC, &collector, NULL, NULL))
+      return false;
+    return Convert(collector.members(), output);
+  }
+
  private:
   ScopedVector<internal::FieldConverterBase<StructType> > fields_;
 
@@ -253,4 +253,35 @@ TEST(JSONValueConverterTest, RepeatedValueErrorInTheMiddle) {
   // No check the values as mentioned above.
 }
 
+TEST(JSONValueConverterTest, ConvertJSON) {
+  const char normal_data[] =
+      "{\n"
+      "  \"foo\": 1.0,\n"
+      "  \"unused\": [{\"deeply\": [\"nested\", {\"foo\": 2}]}],\n"
+      "  \"child\": {\n"
+      "    \"foo\": 1,\n"
+      "    \"bar\": \"bar\",\n"
+      "    \"ints\": [3, 4]\n"
+      "  },\n"
+      "  \"children\": [{\"foo\": 2}, {\"foo\": 3}]\n"
+      "}\n";
+
+  NestedMessage message;
+  base::JSONValueConverter<NestedMessage> converter;
+  EXPECT_TRUE(converter.ConvertJSON(normal_data, &message));
+
+  EXPECT_EQ(1.0, message.foo);
+  EXPECT_EQ(1, message.child.foo);
+  EXPECT_EQ("bar", message.child.bar);
+  ASSERT_EQ(2U, message.child.ints.size());
+  EXPECT_EQ(4, *message.child.ints[1]);
+  ASSERT_EQ(2U, message.children.size());
+  EXPECT_EQ(3, message.children[1]->foo);
+
+  // Failures are reported as by Convert(), as is malformed JSON.
+  EXPECT_FALSE(converter.ConvertJSON("{\"foo\": \"string\"}", &message));
+  EXPECT_FALSE(converter.ConvertJSON("[1.0]", &message));
+  EXPECT_FALSE(converter.ConvertJSON("{\"foo\": 1.0", &message));
+}
+
 }  // namespace base
@@ -7,6 +7,7 @@
 #include "base/file_util.h"
 #include "base/json/json_file_value_serializer.h"
 #include "base/json/json_reader.h"
+#include "base/json/json_stream_reader.h"
 #include "base/json/json_string_value_serializer.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/scoped_temp_dir.h"
@@ -150,6 +151,42 @@ TEST(JSONValueSerializerTest, ReadJSONWithCommasFromFile) {
   CheckJSONIsStillTheSame(*value);
 }
 
+// Test that a file can be streamed to a handler.
+TEST(JSONValueSerializerTest, DeserializeToHandler) {
+  ScopedTempDir tempdir;
+  ASSERT_TRUE(tempdir.CreateUniqueTempDir());
+  FilePath temp_file(tempdir.path().AppendASCII("test.json"));
+  ASSERT_EQ(static_cast<int>(strlen(kProperJSONWithCommas)),
+            file_util::WriteFile(temp_file,
+                                 kProperJSONWithCommas,
+                                 strlen(kProperJSONWithCommas)));
+
+  JSONFileValueSerializer file_deserializer(temp_file);
+  int error_code = 0;
+  std::string error_message;
+  JSONValueBuilder builder;
+  ASSERT_FALSE(file_deserializer.DeserializeToHandler(&builder, &error_code,
+                                                      &error_message));
+  ASSERT_EQ(JSONReader::JSON_TRAILING_COMMA, error_code);
+  ASSERT_FALSE(error_message.empty());
+
+  file_deserializer.set_allow_trailing_comma(true);
+  JSONValueBuilder comma_builder;
+  ASSERT_TRUE(file_deserializer.DeserializeToHandler(&comma_builder, NULL,
+                                                     NULL));
+  scoped_ptr<Value> value(comma_builder.Release());
+  ASSERT_TRUE(value.get());
+  CheckJSONIsStillTheSame(*value);
+
+  // A missing file is reported as one.
+  JSONFileValueSerializer missing(tempdir.path().AppendASCII("missing.json"));
+  JSONValueBuilder missing_builder;
+  ASSERT_FALSE(missing.DeserializeToHandler(&missing_builder, &error_code,
+                                            &error_message));
+  ASSERT_EQ(JSONFileValueSerializer::JSON_NO_SUCH_FILE, error_code);
+  ASSERT_EQ(JSONFileValueSerializer::kNoSuchFile, error_message);
+}
+
 }  // namespace
 
 }  // namespace base
@@ -4,12 +4,14 @@
 
 #include "base/json/json_writer.h"
 
+#include <string.h>
+
 #include <cmath>
 
 #include "base/json/string_escape.h"
 #include "base/logging.h"
-#include "base/stringprintf.h"
 #include "base/string_number_conversions.h"
+#include "base/string_util.h"
 #include "base/values.h"
 #include "base/utf_string_conversions.h"
 
@@ -81,7 +83,8 @@ void JSONWriter::BuildJSONString(const Value* const node, int depth) {
         int value;
         bool result = node->GetAsInteger(&value);
         DCHECK(result);
-        base::StringAppendF(json_string_, "%d", value);
+        char buffer[kInt64BufferSize];
+        json_string_->append(buffer, Int64ToBuffer(value, buffer));
         break;
       }
 
@@ -94,27 +97,36 @@ void JSONWriter::BuildJSONString(const Value* const node, int depth) {
             value <= kint64max &&
             value >= kint64min &&
             std::floor(value) == value) {
-          json_string_->append(Int64ToString(static_cast<int64>(value)));
+          char buffer[kInt64BufferSize];
+          json_string_->append(
+              buffer, Int64ToBuffer(static_cast<int64>(value), buffer));
           break;
         }
-        std::string real = DoubleToString(value);
+        // Room for a leading "0" and a trailing ".0" besides the number.
+        char buffer[kDoubleBufferSize + 3];
+        char* real = buffer + 1;
+        size_t length = DoubleToBuffer(value, real);
         // Ensure that the number has a .0 if there's no decimal or 'e'.  This
         // makes sure that when we read the JSON back, it's interpreted as a
         // real rather than an int.
-        if (real.find('.') == std::string::npos &&
-            real.find('e') == std::string::npos &&
-            real.find('E') == std::string::npos) {
-          real.append(".0");
+        if (!memchr(real, '.', length) &&
+            !memchr(real, 'e', length) &&
+            !memchr(real, 'E', length)) {
+          real[length++] = '.';
+          real[length++] = '0';
         }
         // The JSON spec requires that non-integer values in the range (-1,1)
         // have a zero before the decimal point - ".52" is not valid, "0.52" is.
         if (real[0] == '.') {
-          real.insert(0, "0");
-        } else if (real.length() > 1 && real[0] == '-' && real[1] == '.') {
+          *--real = '0';
+          ++length;
+        } else if (length > 1 && real[0] == '-' && real[1] == '.') {
           // "-.1" bad "-0.1" good
-          real.insert(1, "0");
+          *--real = '-';
+          real[1] = '0';
+          ++length;
         }
-        json_string_->append(real);
+        json_string_->append(real, length);
         break;
       }
 
@@ -124,7 +136,7 @@ void JSONWriter::BuildJSONString(const Value* const node, int depth) {
         bool result = node->GetAsString(&value);
         DCHECK(result);
         if (escape_) {
-          JsonDoubleQuote(UTF8ToUTF16(value), true, json_string_);
+          AppendQuotedString(value);
         } else {
           JsonDoubleQuote(value, true, json_string_);
         }
@@ -222,6 +234,11 @@ void JSONWriter::BuildJSONString(const Value* const node, int depth) {
 }
 
 void JSONWriter::AppendQuotedString(const std::string& str) {
+  // ASCII escapes the same either way, so only convert the other strings.
+  if (IsStringASCII(str)) {
+    JsonDoubleQuote(str, true, json_string_);
+    return;
+  }
   // TODO(viettrungluu): |str| is UTF-8, not ASCII, so to properly escape it we
   // have to convert it to UTF-16. This round-trip is suboptimal.
   JsonDoubleQuote(UTF8ToUTF16(str), true, json_string_);
@@ -6,6 +6,7 @@
 
 #include <string>
 
+#include "base/json/string_scan.h"
 #include "base/stringprintf.h"
 #include "base/string_util.h"
 
@@ -49,6 +50,15 @@ static bool JsonSingleEscapeChar(const CHAR c, std::string* dst) {
   return true;
 }
 
+// Appends |length| characters of printable ASCII to |dst|.
+void AppendUnescaped(const char* str, size_t length, std::string* dst) {
+  dst->append(str, length);
+}
+
+void AppendUnescaped(const char16* str, size_t length, std::string* dst) {
+  dst->append(str, str + length);
+}
+
 template <class STR>
 void JsonDoubleQuoteT(const STR& str,
                       bool put_in_quotes,
@@ -56,8 +66,19 @@ void JsonDoubleQuoteT(const STR& str,
   if (put_in_quotes)
     dst->push_back('"');
 
-  for (typename STR::const_iterator it = str.begin(); it != str.end(); ++it) {
-    typename ToUnsigned<typename STR::value_type>::Unsigned c = *it;
+  const typename STR::value_type* data = str.data();
+  const size_t length = str.length();
+  for (size_t i = 0; i < length; ++i) {
+    // Copy any run of characters which need no escaping in one go.
+    size_t run = internal::CountUnescapedJSONChars(data + i, length - i);
+    if (run) {
+      AppendUnescaped(data + i, run, dst);
+      i += run;
+      if (i == length)
+        break;
+    }
+
+    typename ToUnsigned<typename STR::value_type>::Unsigned c = data[i];
     if (!JsonSingleEscapeChar(c, dst)) {
       if (c < 32 || c > 126 || c == '<' || c == '>') {
         // 1. Escaping <, > to prevent script execution.
@@ -66,7 +87,7 @@ void JsonDoubleQuoteT(const STR& str,
         unsigned int as_uint = static_cast<unsigned int>(c);
         base::StringAppendF(dst, "\\u%04X", as_uint);
       } else {
-        unsigned char ascii = static_cast<unsigned char>(*it);
+        unsigned char ascii = static_cast<unsigned char>(data[i]);
         dst->push_back(ascii);
       }
     }
@@ -0,0 +1,140 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/string_scan.h"
+
+#include "base/bits.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY) && (defined(__SSE2__) || \
+    defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define JSON_SCAN_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace base {
+namespace internal {
+
+namespace {
+
+inline bool IsPlainJSONChar(unsigned char c) {
+  return c < 0x80 && c != '"' && c != '\\';
+}
+
+template <typename CHAR>
+inline bool IsUnescapedJSONChar(CHAR c) {
+  return c >= 32 && c <= 126 && c != '"' && c != '\\' && c != '<' && c != '>';
+}
+
+#if defined(JSON_SCAN_USE_SSE2)
+
+inline __m128i LoadChars(const void* str) {
+  return _mm_loadu_si128(static_cast<const __m128i*>(str));
+}
+
+#endif  // defined(JSON_SCAN_USE_SSE2)
+
+}  // namespace
+
+size_t CountPlainJSONChars(const char* str, size_t length) {
+  size_t i = 0;
+#if defined(JSON_SCAN_USE_SSE2)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  for (; i + 16 <= length; i += 16) {
+    __m128i chars = LoadChars(str + i);
+    // Non-ASCII bytes have their top bit set already, which is the bit
+    // _mm_movemask_epi8() takes.
+    __m128i stops = _mm_or_si128(chars,
+        _mm_or_si128(_mm_cmpeq_epi8(chars, quote),
+                     _mm_cmpeq_epi8(chars, backslash)));
+    int mask = _mm_movemask_epi8(stops);
+    if (mask)
+      return i + bits::LowestSetBit(mask);
+  }
+#endif
+  return i + CountPlainJSONChars_C(str + i, length - i);
+}
+
+size_t CountUnescapedJSONChars(const char* str, size_t length) {
+  size_t i = 0;
+#if defined(JSON_SCAN_USE_SSE2)
+  const __m128i below_space = _mm_set1_epi8(31);
+  const __m128i delete_char = _mm_set1_epi8(127);
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i less_than = _mm_set1_epi8('<');
+  const __m128i greater_than = _mm_set1_epi8('>');
+  for (; i + 16 <= length; i += 16) {
+    __m128i chars = LoadChars(str + i);
+    // As signed bytes, non-ASCII is negative and so fails the first test.
+    __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(chars, below_space),
+                                      _mm_cmplt_epi8(chars, delete_char));
+    __m128i special = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chars, quote),
+                     _mm_cmpeq_epi8(chars, backslash)),
+        _mm_or_si128(_mm_cmpeq_epi8(chars, less_than),
+                     _mm_cmpeq_epi8(chars, greater_than)));
+    int mask = (_mm_movemask_epi8(printable) ^ 0xFFFF) |
+        _mm_movemask_epi8(special);
+    if (mask)
+      return i + bits::LowestSetBit(mask);
+  }
+#endif
+  return i + CountUnescapedJSONChars_C(str + i, length - i);
+}
+
+size_t CountUnescapedJSONChars(const char16* str, size_t length) {
+  size_t i = 0;
+#if defined(JSON_SCAN_USE_SSE2)
+  const __m128i below_space = _mm_set1_epi16(31);
+  const __m128i delete_char = _mm_set1_epi16(127);
+  const __m128i quote = _mm_set1_epi16('"');
+  const __m128i backslash = _mm_set1_epi16('\\');
+  const __m128i less_than = _mm_set1_epi16('<');
+  const __m128i greater_than = _mm_set1_epi16('>');
+  for (; i + 8 <= length; i += 8) {
+    __m128i chars = LoadChars(str + i);
+    __m128i printable = _mm_and_si128(_mm_cmpgt_epi16(chars, below_space),
+                                      _mm_cmplt_epi16(chars, delete_char));
+    __m128i special = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi16(chars, quote),
+                     _mm_cmpeq_epi16(chars, backslash)),
+        _mm_or_si128(_mm_cmpeq_epi16(chars, less_than),
+                     _mm_cmpeq_epi16(chars, greater_than)));
+    // Each character sets two bits of the mask.
+    int mask = (_mm_movemask_epi8(printable) ^ 0xFFFF) |
+        _mm_movemask_epi8(special);
+    if (mask)
+      return i + bits::LowestSetBit(mask) / 2;
+  }
+#endif
+  return i + CountUnescapedJSONChars_C(str + i, length - i);
+}
+
+size_t CountPlainJSONChars_C(const char* str, size_t length) {
+  size_t i = 0;
+  while (i < length && IsPlainJSONChar(static_cast<unsigned char>(str[i])))
+    ++i;
+  return i;
+}
+
+size_t CountUnescapedJSONChars_C(const char* str, size_t length) {
+  size_t i = 0;
+  while (i < length &&
+         IsUnescapedJSONChar(static_cast<unsigned char>(str[i]))) {
+    ++i;
+  }
+  return i;
+}
+
+size_t CountUnescapedJSONChars_C(const char16* str, size_t length) {
+  size_t i = 0;
+  while (i < length && IsUnescapedJSONChar(str[i]))
+    ++i;
+  return i;
+}
+
+}  // namespace internal
+}  // namespace base
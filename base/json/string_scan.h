@@ -0,0 +1,45 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Scans for the characters the JSON parser and JsonDoubleQuote() have to
+// look at one by one, so that they can pass over the runs of plain ASCII in
+// between in bulk. On x86 with SSE2 these check 16 bytes at a time.
+
+#ifndef BASE_JSON_STRING_SCAN_H_
+#define BASE_JSON_STRING_SCAN_H_
+#pragma once
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+#include "base/string16.h"
+
+namespace base {
+namespace internal {
+
+// Returns the number of characters at the start of |str| which a JSON string
+// literal holds as they are: ASCII other than '"' and '\\'.
+BASE_EXPORT_PRIVATE size_t CountPlainJSONChars(const char* str,
+                                               size_t length);
+
+// Returns the number of characters at the start of |str| which
+// JsonDoubleQuote() copies without escaping: printable ASCII other than '"',
+// '\\', '<' and '>'.
+BASE_EXPORT_PRIVATE size_t CountUnescapedJSONChars(const char* str,
+                                                   size_t length);
+BASE_EXPORT_PRIVATE size_t CountUnescapedJSONChars(const char16* str,
+                                                   size_t length);
+
+// Character at a time versions of the above, for comparison in tests.
+BASE_EXPORT_PRIVATE size_t CountPlainJSONChars_C(const char* str,
+                                                 size_t length);
+BASE_EXPORT_PRIVATE size_t CountUnescapedJSONChars_C(const char* str,
+                                                     size_t length);
+BASE_EXPORT_PRIVATE size_t CountUnescapedJSONChars_C(const char16* str,
+                                                     size_t length);
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_JSON_STRING_SCAN_H_
@@ -0,0 +1,72 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/string_scan.h"
+
+#include <string>
+
+#include "base/string16.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// Characters on either side of each boundary the scans test for.
+const unsigned char kInterestingChars[] = {
+  0, 1, 31, 32, '"', '\\', '<', '>', 'a', 126, 127, 128, 0xC3, 0xFF,
+};
+
+}  // namespace
+
+// Every interesting character at every position, in strings long enough to
+// use the vector loops, scans as it does one character at a time.
+TEST(JSONStringScanTest, MatchesPortableVersion) {
+  for (size_t length = 0; length < 40; ++length) {
+    for (size_t position = 0; position < length; ++position) {
+      for (size_t i = 0; i < arraysize(kInterestingChars); ++i) {
+        std::string str(length, 'x');
+        str[position] = kInterestingChars[i];
+        EXPECT_EQ(CountPlainJSONChars_C(str.data(), length),
+                  CountPlainJSONChars(str.data(), length))
+            << "length " << length << " position " << position;
+        EXPECT_EQ(CountUnescapedJSONChars_C(str.data(), length),
+                  CountUnescapedJSONChars(str.data(), length))
+            << "length " << length << " position " << position;
+
+        string16 str16(length, 'x');
+        str16[position] = kInterestingChars[i];
+        EXPECT_EQ(CountUnescapedJSONChars_C(str16.data(), length),
+                  CountUnescapedJSONChars(str16.data(), length))
+            << "length " << length << " position " << position;
+        str16[position] = 0x100 + kInterestingChars[i];
+        EXPECT_EQ(position, CountUnescapedJSONChars(str16.data(), length));
+        str16[position] = 0x8000 + kInterestingChars[i];
+        EXPECT_EQ(position, CountUnescapedJSONChars(str16.data(), length));
+      }
+    }
+  }
+}
+
+TEST(JSONStringScanTest, Counts) {
+  const std::string plain("a plain run of text that is long enough\\n");
+  EXPECT_EQ(plain.length() - 2,
+            CountPlainJSONChars(plain.data(), plain.length()));
+  EXPECT_EQ(plain.length() - 2,
+            CountUnescapedJSONChars(plain.data(), plain.length()));
+
+  // Control characters are plain in a JSON string, though they are escaped
+  // on the way out.
+  const std::string tab("a\tb");
+  EXPECT_EQ(3u, CountPlainJSONChars(tab.data(), tab.length()));
+  EXPECT_EQ(1u, CountUnescapedJSONChars(tab.data(), tab.length()));
+
+  const std::string html("<b>");
+  EXPECT_EQ(3u, CountPlainJSONChars(html.data(), html.length()));
+  EXPECT_EQ(0u, CountUnescapedJSONChars(html.data(), html.length()));
+}
+
+}  // namespace internal
+}  // namespace base
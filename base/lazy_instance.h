@@ -41,6 +41,7 @@
 #include "base/atomicops.h"
 #include "base/base_export.h"
 #include "base/basictypes.h"
+#include "base/debug/initialization_profiler_internal.h"
 #include "base/logging.h"
 #include "base/memory/aligned_memory.h"
 #include "base/third_party/dynamic_annotations/dynamic_annotations.h"
@@ -156,10 +157,13 @@ class LazyInstance {
     if (!(value & kLazyInstanceCreatedMask) &&
         internal::NeedsLazyInstance(&private_instance_)) {
       // Create the instance in the space provided by |private_buf_|.
+      int64 start = debug::internal::InitializationTimerStart();
       value = reinterpret_cast<subtle::AtomicWord>(
           Traits::New(private_buf_.void_data()));
       internal::CompleteLazyInstance(&private_instance_, value, this,
                                      Traits::kRegisterOnExit ? OnExit : NULL);
+      debug::internal::RecordConstruction(
+          start, this, debug::internal::InitializationSignature<Type>());
     }
 
     // This annotation helps race detectors recognize correct lock-less
@@ -201,8 +205,10 @@ class LazyInstance {
   static void OnExit(void* lazy_instance) {
     LazyInstance<Type, Traits>* me =
         reinterpret_cast<LazyInstance<Type, Traits>*>(lazy_instance);
+    int64 start = debug::internal::InitializationTimerStart();
     Traits::Delete(me->instance());
     subtle::NoBarrier_Store(&me->private_instance_, 0);
+    debug::internal::RecordDestruction(start, lazy_instance);
   }
 };
 
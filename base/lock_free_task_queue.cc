@@ -0,0 +1,97 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/lock_free_task_queue.h"
+
+#include "base/logging.h"
+
+namespace base {
+
+struct LockFreeTaskQueue::Node {
+  explicit Node(const PendingTask& pending_task)
+      : pending_task(pending_task),
+        next(NULL) {
+  }
+
+  PendingTask pending_task;
+  Node* next;
+};
+
+LockFreeTaskQueue::LockFreeTaskQueue() : head_(0) {
+}
+
+LockFreeTaskQueue::~LockFreeTaskQueue() {
+  Node* node = reinterpret_cast<Node*>(subtle::Acquire_Load(&head_));
+  while (node) {
+    Node* next = node->next;
+    delete node;
+    node = next;
+  }
+}
+
+bool LockFreeTaskQueue::Push(PendingTask* pending_task) {
+  return PushBatch(pending_task, 1);
+}
+
+bool LockFreeTaskQueue::PushBatch(PendingTask* pending_tasks, size_t count) {
+  DCHECK_GT(count, 0u);
+  // Build the chain newest first, the same order the stack keeps.
+  Node* newest = NULL;
+  Node* oldest = NULL;
+  for (size_t i = 0; i < count; ++i) {
+    Node* node = new Node(pending_tasks[i]);
+    pending_tasks[i].task.Reset();
+    node->next = newest;
+    newest = node;
+    if (!oldest)
+      oldest = node;
+  }
+
+  subtle::AtomicWord old_head = subtle::NoBarrier_Load(&head_);
+  for (;;) {
+    oldest->next = reinterpret_cast<Node*>(old_head);
+    // The release barrier publishes the nodes and their contents to the
+    // consumer.
+    subtle::AtomicWord previous = subtle::Release_CompareAndSwap(
+        &head_, old_head, reinterpret_cast<subtle::AtomicWord>(newest));
+    if (previous == old_head)
+      return old_head == 0;
+    old_head = previous;
+  }
+}
+
+void LockFreeTaskQueue::TakeAll(TaskQueue* queue) {
+  DCHECK(queue);
+  subtle::AtomicWord head = subtle::NoBarrier_Load(&head_);
+  while (head) {
+    subtle::AtomicWord previous =
+        subtle::Acquire_CompareAndSwap(&head_, head, 0);
+    if (previous == head)
+      break;
+    head = previous;
+  }
+
+  // The detached list is newest first; reverse it so tasks run in post order.
+  Node* oldest = NULL;
+  Node* node = reinterpret_cast<Node*>(head);
+  while (node) {
+    Node* next = node->next;
+    node->next = oldest;
+    oldest = node;
+    node = next;
+  }
+
+  while (oldest) {
+    queue->push(oldest->pending_task);
+    Node* next = oldest->next;
+    delete oldest;
+    oldest = next;
+  }
+}
+
+bool LockFreeTaskQueue::IsEmpty() const {
+  return subtle::NoBarrier_Load(&head_) == 0;
+}
+
+}  // namespace base
@@ -0,0 +1,62 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_LOCK_FREE_TASK_QUEUE_H_
+#define BASE_LOCK_FREE_TASK_QUEUE_H_
+#pragma once
+
+#include "base/atomicops.h"
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/pending_task.h"
+
+namespace base {
+
+// A multi-producer, single-consumer queue of PendingTasks that never takes a
+// lock.  Push() may be called on any thread.  TakeAll() must only be called on
+// the one thread that consumes the queue.
+//
+// Internally this is an intrusive singly linked stack.  Producers prepend a
+// node with a compare-and-swap on the head pointer, and the consumer detaches
+// the whole stack with a single compare-and-swap and reverses it to restore
+// FIFO order.  Nodes are never removed individually, so there is no ABA
+// hazard.
+class BASE_EXPORT LockFreeTaskQueue {
+ public:
+  LockFreeTaskQueue();
+
+  // Deletes any tasks that were never taken.
+  ~LockFreeTaskQueue();
+
+  // Appends the contents of |pending_task| to the queue.  The task closure is
+  // reset before the task becomes visible to the consumer, so the posting
+  // call stack never holds the last reference to it.  Returns true if the
+  // queue was empty, in which case the caller is responsible for waking up the
+  // consumer.
+  bool Push(PendingTask* pending_task);
+
+  // Like Push(), but for the |count| tasks starting at |pending_tasks|, which
+  // become visible to the consumer all at once, in order, with a single
+  // compare-and-swap.
+  bool PushBatch(PendingTask* pending_tasks, size_t count);
+
+  // Moves every queued task onto the back of |queue|, oldest first.
+  void TakeAll(TaskQueue* queue);
+
+  // Returns true if nothing is queued.  The answer may be stale by the time it
+  // is returned if producers are active.
+  bool IsEmpty() const;
+
+ private:
+  struct Node;
+
+  // The most recently pushed Node, or 0 if the queue is empty.
+  subtle::AtomicWord head_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockFreeTaskQueue);
+};
+
+}  // namespace base
+
+#endif  // BASE_LOCK_FREE_TASK_QUEUE_H_
@@ -0,0 +1,194 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/lock_free_task_queue.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/compiler_specific.h"
+#include "base/location.h"
+#include "base/memory/ref_counted.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace {
+
+void RecordValue(std::vector<int>* values, int value) {
+  values->push_back(value);
+}
+
+class DeletionProbe : public RefCountedThreadSafe<DeletionProbe> {
+ public:
+  explicit DeletionProbe(bool* deleted) : deleted_(deleted) {}
+
+  void Run() {}
+
+ private:
+  friend class RefCountedThreadSafe<DeletionProbe>;
+  ~DeletionProbe() { *deleted_ = true; }
+
+  bool* deleted_;
+};
+
+void PushTask(LockFreeTaskQueue* queue, const Closure& task) {
+  PendingTask pending_task(FROM_HERE, task);
+  queue->Push(&pending_task);
+}
+
+void RunAll(TaskQueue* queue) {
+  while (!queue->empty()) {
+    queue->front().task.Run();
+    queue->pop();
+  }
+}
+
+// Pushes |count| tasks that each record |id| * |count| + their index.
+class ProducerThread : public PlatformThread::Delegate {
+ public:
+  ProducerThread(LockFreeTaskQueue* queue,
+                 std::vector<int>* values,
+                 int id,
+                 int count)
+      : queue_(queue),
+        values_(values),
+        id_(id),
+        count_(count) {
+  }
+
+  virtual void ThreadMain() OVERRIDE {
+    for (int i = 0; i < count_; ++i)
+      PushTask(queue_, Bind(&RecordValue, values_, id_ * count_ + i));
+  }
+
+ private:
+  LockFreeTaskQueue* queue_;
+  std::vector<int>* values_;
+  int id_;
+  int count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProducerThread);
+};
+
+}  // namespace
+
+TEST(LockFreeTaskQueueTest, FifoOrder) {
+  LockFreeTaskQueue queue;
+  EXPECT_TRUE(queue.IsEmpty());
+
+  std::vector<int> values;
+  PendingTask first(FROM_HERE, Bind(&RecordValue, &values, 1));
+  EXPECT_TRUE(queue.Push(&first));
+  EXPECT_TRUE(first.task.is_null());
+  PendingTask second(FROM_HERE, Bind(&RecordValue, &values, 2));
+  EXPECT_FALSE(queue.Push(&second));
+  PushTask(&queue, Bind(&RecordValue, &values, 3));
+  EXPECT_FALSE(queue.IsEmpty());
+
+  TaskQueue work_queue;
+  queue.TakeAll(&work_queue);
+  EXPECT_TRUE(queue.IsEmpty());
+  ASSERT_EQ(3u, work_queue.size());
+  RunAll(&work_queue);
+
+  ASSERT_EQ(3u, values.size());
+  EXPECT_EQ(1, values[0]);
+  EXPECT_EQ(2, values[1]);
+  EXPECT_EQ(3, values[2]);
+
+  // The queue reports empty again once it has been drained.
+  PendingTask fourth(FROM_HERE, Bind(&RecordValue, &values, 4));
+  EXPECT_TRUE(queue.Push(&fourth));
+}
+
+TEST(LockFreeTaskQueueTest, TakeAllAppends) {
+  LockFreeTaskQueue queue;
+  std::vector<int> values;
+  TaskQueue work_queue;
+  work_queue.push(PendingTask(FROM_HERE, Bind(&RecordValue, &values, 1)));
+  PushTask(&queue, Bind(&RecordValue, &values, 2));
+  queue.TakeAll(&work_queue);
+  RunAll(&work_queue);
+
+  ASSERT_EQ(2u, values.size());
+  EXPECT_EQ(1, values[0]);
+  EXPECT_EQ(2, values[1]);
+}
+
+TEST(LockFreeTaskQueueTest, PushBatch) {
+  LockFreeTaskQueue queue;
+  std::vector<int> values;
+  PushTask(&queue, Bind(&RecordValue, &values, 1));
+  PendingTask batch[] = {
+    PendingTask(FROM_HERE, Bind(&RecordValue, &values, 2)),
+    PendingTask(FROM_HERE, Bind(&RecordValue, &values, 3)),
+    PendingTask(FROM_HERE, Bind(&RecordValue, &values, 4)),
+  };
+  EXPECT_FALSE(queue.PushBatch(batch, arraysize(batch)));
+  EXPECT_TRUE(batch[0].task.is_null());
+  PushTask(&queue, Bind(&RecordValue, &values, 5));
+
+  TaskQueue work_queue;
+  queue.TakeAll(&work_queue);
+  RunAll(&work_queue);
+  ASSERT_EQ(5u, values.size());
+  for (int i = 0; i < 5; ++i)
+    EXPECT_EQ(i + 1, values[i]);
+
+  PendingTask single(FROM_HERE, Bind(&RecordValue, &values, 6));
+  EXPECT_TRUE(queue.PushBatch(&single, 1));
+}
+
+TEST(LockFreeTaskQueueTest, DeletesUntakenTasks) {
+  bool deleted = false;
+  {
+    LockFreeTaskQueue queue;
+    PushTask(&queue, Bind(&DeletionProbe::Run, new DeletionProbe(&deleted)));
+    EXPECT_FALSE(deleted);
+  }
+  EXPECT_TRUE(deleted);
+}
+
+TEST(LockFreeTaskQueueTest, MultipleProducers) {
+  const int kNumProducers = 8;
+  const int kTasksPerProducer = 1000;
+
+  LockFreeTaskQueue queue;
+  std::vector<int> values;
+  std::vector<ProducerThread*> producers;
+  std::vector<PlatformThreadHandle> handles;
+  for (int i = 0; i < kNumProducers; ++i) {
+    producers.push_back(
+        new ProducerThread(&queue, &values, i, kTasksPerProducer));
+    PlatformThreadHandle handle;
+    ASSERT_TRUE(PlatformThread::Create(0, producers.back(), &handle));
+    handles.push_back(handle);
+  }
+
+  // Drain concurrently with the producers.
+  TaskQueue work_queue;
+  while (values.size() <
+         static_cast<size_t>(kNumProducers * kTasksPerProducer)) {
+    queue.TakeAll(&work_queue);
+    RunAll(&work_queue);
+    PlatformThread::YieldCurrentThread();
+  }
+
+  for (int i = 0; i < kNumProducers; ++i) {
+    PlatformThread::Join(handles[i]);
+    delete producers[i];
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+
+  // Tasks from any one producer must come out in the order they were pushed.
+  std::vector<int> next_expected(kNumProducers);
+  for (size_t i = 0; i < values.size(); ++i) {
+    int producer = values[i] / kTasksPerProducer;
+    EXPECT_EQ(next_expected[producer], values[i] % kTasksPerProducer);
+    ++next_expected[producer];
+  }
+}
+
+}  // namespace base
@@ -43,9 +43,11 @@ typedef pthread_mutex_t* MutexHandle;
 #include <ctime>
 #include <iomanip>
 #include <ostream>
+#include <string>
 
 #include "base/base_switches.h"
 #include "base/command_line.h"
+#include "base/compiler_specific.h"
 #include "base/debug/alias.h"
 #include "base/debug/debugger.h"
 #include "base/debug/stack_trace.h"
@@ -67,6 +69,9 @@ namespace logging {
 
 DcheckState g_dcheck_state = DISABLE_DCHECK_FOR_NON_OFFICIAL_RELEASE_BUILDS;
 
+// Starts at 1 so that zeroed VLOG_IS_ON() caches are stale.
+int g_vlog_generation = 1;
+
 namespace {
 
 VlogInfo* g_vlog_info = NULL;
@@ -340,6 +345,107 @@ bool InitializeLogFileHandle() {
   return true;
 }
 
+// Writes |str| to stderr.
+void WriteToStderr(const std::string& str) {
+  fprintf(stderr, "%s", str.c_str());
+  fflush(stderr);
+}
+
+// Writes |str| to the log file, opening it if needed.
+void WriteToLogFile(const std::string& str) {
+  LoggingLock logging_lock;
+  if (!InitializeLogFileHandle())
+    return;
+#if defined(OS_WIN)
+  SetFilePointer(log_file, 0, 0, SEEK_END);
+  DWORD num_written;
+  WriteFile(log_file,
+            static_cast<const void*>(str.c_str()),
+            static_cast<DWORD>(str.length()),
+            &num_written,
+            NULL);
+#else
+  fprintf(log_file, "%s", str.c_str());
+  fflush(log_file);
+#endif
+}
+
+// Collects messages in WRITE_LOGS_ASYNCHRONOUSLY mode, and writes them in
+// batches from its own thread. Logging threads only hold |lock_| to append
+// to the batch; |flush_lock_| keeps the batches in order when a logging
+// thread flushes too. Like the other locks here, these are LockImpls, because
+// Lock makes logging calls.
+class AsyncLogWriter : public base::PlatformThread::Delegate {
+ public:
+  AsyncLogWriter() {}
+
+  // Adds |str| to the batch for stderr and/or the log file.
+  void Append(const std::string& str, bool to_stderr, bool to_file) {
+    lock_.Lock();
+    if (to_stderr)
+      stderr_batch_.append(str);
+    if (to_file)
+      file_batch_.append(str);
+    bool batch_full =
+        stderr_batch_.size() + file_batch_.size() > kMaxBatchSize;
+    lock_.Unlock();
+
+    // Don't let the batch grow without bound when messages come faster than
+    // the disk takes them.
+    if (batch_full)
+      Flush();
+  }
+
+  // Writes the batch.
+  void Flush() {
+    flush_lock_.Lock();
+    std::string stderr_batch;
+    std::string file_batch;
+    lock_.Lock();
+    stderr_batch.swap(stderr_batch_);
+    file_batch.swap(file_batch_);
+    lock_.Unlock();
+
+    if (!stderr_batch.empty())
+      WriteToStderr(stderr_batch);
+    if (!file_batch.empty())
+      WriteToLogFile(file_batch);
+    flush_lock_.Unlock();
+  }
+
+  // base::PlatformThread::Delegate:
+  virtual void ThreadMain() OVERRIDE {
+    base::PlatformThread::SetName("LogWriter");
+    for (;;) {
+      base::PlatformThread::Sleep(
+          base::TimeDelta::FromMilliseconds(kAsyncLogFlushIntervalMs));
+      Flush();
+    }
+  }
+
+ private:
+  // The batch size past which a logging thread writes it itself.
+  static const size_t kMaxBatchSize = 1024 * 1024;
+
+  base::internal::LockImpl lock_;
+  base::internal::LockImpl flush_lock_;
+  std::string stderr_batch_;
+  std::string file_batch_;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncLogWriter);
+};
+
+// Set once WRITE_LOGS_ASYNCHRONOUSLY is asked for, and never deleted, as
+// its thread runs until the process exits.
+AsyncLogWriter* g_async_log_writer = NULL;
+
+// Whether messages go to |g_async_log_writer|.
+bool write_logs_asynchronously = false;
+
+void FlushLogsAtExit() {
+  FlushLogs();
+}
+
 }  // namespace
 
 
@@ -347,7 +453,8 @@ bool BaseInitLoggingImpl(const PathChar* new_log_file,
                          LoggingDestination logging_dest,
                          LogLockingState lock_log,
                          OldFileDeletionState delete_old,
-                         DcheckState dcheck_state) {
+                         DcheckState dcheck_state,
+                         LogWriteMode write_mode) {
   g_dcheck_state = dcheck_state;
 // TODO(bbudge) Hook this up to NaCl logging.
 #if !defined(OS_NACL)
@@ -366,10 +473,25 @@ bool BaseInitLoggingImpl(const PathChar* new_log_file,
         new VlogInfo(command_line->GetSwitchValueASCII(switches::kV),
                      command_line->GetSwitchValueASCII(switches::kVModule),
                      &min_log_level);
+    ++g_vlog_generation;
   }
 
   LoggingLock::Init(lock_log, new_log_file);
 
+  // Messages waiting to be written belong to the old log file.
+  FlushLogs();
+  if (write_mode == WRITE_LOGS_ASYNCHRONOUSLY && !g_async_log_writer) {
+    AsyncLogWriter* writer = new AsyncLogWriter;
+    if (base::PlatformThread::CreateNonJoinable(0, writer)) {
+      g_async_log_writer = writer;
+      atexit(&FlushLogsAtExit);
+    } else {
+      delete writer;
+    }
+  }
+  write_logs_asynchronously =
+      g_async_log_writer && write_mode == WRITE_LOGS_ASYNCHRONOUSLY;
+
   LoggingLock logging_lock;
 
   if (log_file) {
@@ -400,6 +522,7 @@ bool BaseInitLoggingImpl(const PathChar* new_log_file,
 
 void SetMinLogLevel(int level) {
   min_log_level = std::min(LOG_ERROR_REPORT, level);
+  ++g_vlog_generation;
 }
 
 int GetMinLogLevel() {
@@ -420,6 +543,16 @@ int GetVlogLevelHelper(const char* file, size_t N) {
       GetVlogVerbosity();
 }
 
+int CacheVlogLevel(int* site, const char* file, size_t N) {
+  // Read the generation first, so that a change while resolving the level
+  // leaves the cache stale rather than wrong.
+  int generation = g_vlog_generation & kVlogSiteGenerationMask;
+  int level = GetVlogLevelHelper(file, N);
+  if (level >= -128 && level <= 127)
+    *site = (generation << kVlogSiteLevelBits) | (level & 0xff);
+  return level;
+}
+
 void SetLogItems(bool enable_process_id, bool enable_thread_id,
                  bool enable_timestamp, bool enable_tickcount) {
   log_process_id = enable_process_id;
@@ -575,8 +708,18 @@ LogMessage::~LogMessage() {
     return;
   }
 
-  if (logging_destination == LOG_ONLY_TO_SYSTEM_DEBUG_LOG ||
-      logging_destination == LOG_TO_BOTH_FILE_AND_SYSTEM_DEBUG_LOG) {
+  bool to_system_debug_log =
+      logging_destination == LOG_ONLY_TO_SYSTEM_DEBUG_LOG ||
+      logging_destination == LOG_TO_BOTH_FILE_AND_SYSTEM_DEBUG_LOG;
+  // When we're only outputting to a log file, above a certain log level, we
+  // should still output to stderr so that we can better detect and diagnose
+  // problems with unit tests, especially on the buildbots.
+  bool to_stderr =
+      to_system_debug_log || severity_ >= kAlwaysPrintErrorLevel;
+  bool to_file = logging_destination != LOG_NONE &&
+      logging_destination != LOG_ONLY_TO_SYSTEM_DEBUG_LOG;
+
+  if (to_system_debug_log) {
 #if defined(OS_WIN)
     OutputDebugStringA(str_newline.c_str());
 #elif defined(OS_ANDROID)
@@ -598,14 +741,6 @@ LogMessage::~LogMessage() {
     }
     __android_log_write(priority, "chromium", str_newline.c_str());
 #endif
-    fprintf(stderr, "%s", str_newline.c_str());
-    fflush(stderr);
-  } else if (severity_ >= kAlwaysPrintErrorLevel) {
-    // When we're only outputting to a log file, above a certain log level, we
-    // should still output to stderr so that we can better detect and diagnose
-    // problems with unit tests, especially on the buildbots.
-    fprintf(stderr, "%s", str_newline.c_str());
-    fflush(stderr);
   }
 
   // We can have multiple threads and/or processes, so try to prevent them
@@ -616,24 +751,17 @@ LogMessage::~LogMessage() {
   // the lock. This is why InitLogging should be called from the main
   // thread at the beginning of execution.
   LoggingLock::Init(LOCK_LOG_FILE, NULL);
-  // write to log file
-  if (logging_destination != LOG_NONE &&
-      logging_destination != LOG_ONLY_TO_SYSTEM_DEBUG_LOG) {
-    LoggingLock logging_lock;
-    if (InitializeLogFileHandle()) {
-#if defined(OS_WIN)
-      SetFilePointer(log_file, 0, 0, SEEK_END);
-      DWORD num_written;
-      WriteFile(log_file,
-                static_cast<const void*>(str_newline.c_str()),
-                static_cast<DWORD>(str_newline.length()),
-                &num_written,
-                NULL);
-#else
-      fprintf(log_file, "%s", str_newline.c_str());
-      fflush(log_file);
-#endif
-    }
+
+  if (write_logs_asynchronously && severity_ != LOG_FATAL) {
+    g_async_log_writer->Append(str_newline, to_stderr, to_file);
+  } else {
+    // A fatal message comes after the ones still waiting to be written, and
+    // must be out before the process goes down.
+    FlushLogs();
+    if (to_stderr)
+      WriteToStderr(str_newline);
+    if (to_file)
+      WriteToLogFile(str_newline);
   }
 
   if (severity_ == LOG_FATAL) {
@@ -810,6 +938,8 @@ ErrnoLogMessage::~ErrnoLogMessage() {
 #endif  // OS_WIN
 
 void CloseLogFile() {
+  FlushLogs();
+
   LoggingLock logging_lock;
 
   if (!log_file)
@@ -819,6 +949,11 @@ void CloseLogFile() {
   log_file = NULL;
 }
 
+void FlushLogs() {
+  if (g_async_log_writer)
+    g_async_log_writer->Flush();
+}
+
 void RawLog(int level, const char* message) {
   if (level >= min_log_level) {
     size_t bytes_written = 0;
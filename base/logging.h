@@ -174,6 +174,19 @@ enum DcheckState {
   ENABLE_DCHECK_FOR_NON_OFFICIAL_RELEASE_BUILDS
 };
 
+// Should log messages be written by the thread logging them, or handed to a
+// background thread that writes them in batches? Asynchronous writes keep
+// threads logging at the same time from waiting on each other's disk writes,
+// at the cost of messages reaching the log file and stderr up to
+// kAsyncLogFlushIntervalMs late. FATAL messages are always written
+// synchronously, after the ones before them. Defaults to
+// WRITE_LOGS_SYNCHRONOUSLY.
+enum LogWriteMode { WRITE_LOGS_SYNCHRONOUSLY, WRITE_LOGS_ASYNCHRONOUSLY };
+
+// How often the background thread writes messages in
+// WRITE_LOGS_ASYNCHRONOUSLY mode.
+const int kAsyncLogFlushIntervalMs = 50;
+
 // TODO(avi): do we want to do a unification of character types here?
 #if defined(OS_WIN)
 typedef wchar_t PathChar;
@@ -198,7 +211,8 @@ BASE_EXPORT bool BaseInitLoggingImpl(const PathChar* log_file,
                                      LoggingDestination logging_dest,
                                      LogLockingState lock_log,
                                      OldFileDeletionState delete_old,
-                                     DcheckState dcheck_state);
+                                     DcheckState dcheck_state,
+                                     LogWriteMode write_mode);
 
 // Sets the log file name and other global logging state. Calling this function
 // is recommended, and is normally done at the beginning of application init.
@@ -218,9 +232,10 @@ inline bool InitLogging(const PathChar* log_file,
                         LoggingDestination logging_dest,
                         LogLockingState lock_log,
                         OldFileDeletionState delete_old,
-                        DcheckState dcheck_state) {
+                        DcheckState dcheck_state,
+                        LogWriteMode write_mode = WRITE_LOGS_SYNCHRONOUSLY) {
   return BaseInitLoggingImpl(log_file, logging_dest, lock_log,
-                             delete_old, dcheck_state);
+                             delete_old, dcheck_state, write_mode);
 }
 
 // Sets the log level. Anything at or above this level will be written to the
@@ -248,6 +263,32 @@ int GetVlogLevel(const char (&file)[N]) {
   return GetVlogLevelHelper(file, N);
 }
 
+// Bumped whenever the vlog level of some file may have changed, that is, on
+// SetMinLogLevel() and on InitLogging() with --v or --vmodule. VLOG_IS_ON()
+// caches the level of each call site along with this generation.
+BASE_EXPORT extern int g_vlog_generation;
+
+// A VLOG_IS_ON() call site cache holds the generation it was resolved in,
+// shifted left by kVlogSiteLevelBits, over the vlog level. Levels that don't
+// fit in kVlogSiteLevelBits bits aren't cached.
+const int kVlogSiteLevelBits = 8;
+const int kVlogSiteGenerationMask = 0x7fffff;
+
+// Resolves the vlog level of |file| and caches it in |site|.
+BASE_EXPORT int CacheVlogLevel(int* site, const char* file_start, size_t N);
+
+// Returns the vlog level of |file| cached in |site|, resolving it if the
+// cache is from an older generation.
+template <size_t N>
+inline int GetCachedVlogLevel(int* site, const char (&file)[N]) {
+  int cached = *site;
+  if ((cached >> kVlogSiteLevelBits) ==
+      (g_vlog_generation & kVlogSiteGenerationMask)) {
+    return static_cast<int8>(cached & 0xff);
+  }
+  return CacheVlogLevel(site, file, N);
+}
+
 // Sets the common items you want to be prepended to each log message.
 // process and thread IDs default to off, the timestamp defaults to on.
 // If this function is not called, logging defaults to writing the timestamp
@@ -350,12 +391,22 @@ const LogSeverity LOG_0 = LOG_ERROR;
 #define LOG_IS_ON(severity) \
   ((::logging::LOG_ ## severity) >= ::logging::GetMinLogLevel())
 
-// We can't do any caching tricks with VLOG_IS_ON() like the
-// google-glog version since it requires GCC extensions.  This means
-// that using the v-logging functions in conjunction with --vmodule
-// may be slow.
+// With GCC, VLOG_IS_ON() caches the vlog level of each call site like the
+// google-glog version, so that a disabled VLOG costs a compare even with
+// --vmodule. The cache needs a static in an expression, which takes a GCC
+// extension; elsewhere, using the v-logging functions in conjunction with
+// --vmodule may be slow.
+#if defined(COMPILER_GCC)
+#define VLOG_IS_ON(verboselevel)                                        \
+  __extension__ ({                                                      \
+    static int vlog_site_cache = 0;                                     \
+    (verboselevel) <=                                                   \
+        ::logging::GetCachedVlogLevel(&vlog_site_cache, __FILE__);      \
+  })
+#else
 #define VLOG_IS_ON(verboselevel) \
   ((verboselevel) <= ::logging::GetVlogLevel(__FILE__))
+#endif
 
 // Helper macro which avoids evaluating the arguments to a stream if
 // the condition doesn't hold.
@@ -914,6 +965,10 @@ class BASE_EXPORT ErrnoLogMessage {
 //       after this call.
 BASE_EXPORT void CloseLogFile();
 
+// Writes the messages waiting for the background thread, in
+// WRITE_LOGS_ASYNCHRONOUSLY mode. Does nothing otherwise.
+BASE_EXPORT void FlushLogs();
+
 // Async signal safe logging mechanism.
 BASE_EXPORT void RawLog(int level, const char* message);
 
@@ -21,6 +21,11 @@ void LogSink(const std::string& str) {
   ++log_sink_call_count;
 }
 
+// One VLOG_IS_ON() call site, so that its cached level is reused.
+bool Vlog2IsOn() {
+  return VLOG_IS_ON(2);
+}
+
 // Class to make sure any manipulations we do to the min log level are
 // contained (i.e., do not affect other unit tests).
 class LogStateSaver {
@@ -141,6 +146,20 @@ TEST_F(LoggingTest, LogIsOn) {
   EXPECT_EQ(kDfatalIsFatal, LOG_IS_ON(DFATAL));
 }
 
+// The level cached by a VLOG_IS_ON() call site follows SetMinLogLevel().
+TEST_F(LoggingTest, VlogIsOnFollowsMinLogLevel) {
+  SetMinLogLevel(-1);
+  EXPECT_FALSE(Vlog2IsOn());
+  EXPECT_FALSE(Vlog2IsOn());
+
+  SetMinLogLevel(-2);
+  EXPECT_TRUE(Vlog2IsOn());
+  EXPECT_TRUE(Vlog2IsOn());
+
+  SetMinLogLevel(LOG_INFO);
+  EXPECT_FALSE(Vlog2IsOn());
+}
+
 TEST_F(LoggingTest, LoggingIsLazy) {
   MockLogSource mock_log_source;
   EXPECT_CALL(mock_log_source, Log()).Times(0);
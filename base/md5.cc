@@ -24,6 +24,13 @@
 #include "base/md5.h"
 
 #include "base/basictypes.h"
+#include "base/lazy_instance.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+#include "base/cpu.h"
+#include "base/digest_x86.h"
+#endif
 
 namespace {
 
@@ -283,6 +290,44 @@ void MD5Sum(const void* data, size_t length, MD5Digest* digest) {
   MD5Final(digest, &ctx);
 }
 
+namespace {
+
+typedef void (*MD5SumManyFunction)(const void* const* data,
+                                   const size_t* lengths,
+                                   size_t count,
+                                   MD5Digest* digests);
+
+void MD5SumManyPortable(const void* const* data,
+                        const size_t* lengths,
+                        size_t count,
+                        MD5Digest* digests) {
+  for (size_t i = 0; i < count; ++i)
+    MD5Sum(data[i], lengths[i], &digests[i]);
+}
+
+// The fastest MD5SumMany() this processor can run, chosen once.
+struct MD5Functions {
+  MD5Functions() : sum_many(&MD5SumManyPortable) {
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+    if (CPU().has_avx2())
+      sum_many = &internal::MD5SumManyAVX2;
+#endif
+  }
+
+  MD5SumManyFunction sum_many;
+};
+
+LazyInstance<MD5Functions>::Leaky g_md5_functions = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+void MD5SumMany(const void* const* data,
+                const size_t* lengths,
+                size_t count,
+                MD5Digest* digests) {
+  g_md5_functions.Get().sum_many(data, lengths, count, digests);
+}
+
 std::string MD5String(const StringPiece& str) {
   MD5Digest digest;
   MD5Sum(str.data(), str.length(), &digest);
@@ -47,6 +47,15 @@ typedef char MD5Context[88];
 // The given 'digest' structure will be filled with the result data.
 BASE_EXPORT void MD5Sum(const void* data, size_t length, MD5Digest* digest);
 
+// Computes the MD5 sums of |count| buffers, the |i|th being the |lengths[i]|
+// bytes at |data[i]|, into |digests[i]|.  Where the processor allows,
+// several buffers are summed side by side, which is much faster than calling
+// MD5Sum() on each of many small buffers.
+BASE_EXPORT void MD5SumMany(const void* const* data,
+                            const size_t* lengths,
+                            size_t count,
+                            MD5Digest* digests);
+
 // Initializes the given MD5 context structure for subsequent calls to
 // MD5Update().
 BASE_EXPORT void MD5Init(MD5Context* context);
@@ -4,6 +4,7 @@
 
 #include <string.h>
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
@@ -204,4 +205,29 @@ TEST(MD5, ContextWithStringData) {
   EXPECT_EQ(expected, actual);
 }
 
+TEST(MD5, MD5SumMany) {
+  std::vector<std::string> inputs;
+  for (int i = 0; i < 300; ++i)
+    inputs.push_back(std::string(i, static_cast<char>('a' + i % 26)));
+  inputs.push_back(std::string(100000, 'z'));
+
+  std::vector<const void*> data;
+  std::vector<size_t> lengths;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    data.push_back(inputs[i].data());
+    lengths.push_back(inputs[i].length());
+  }
+  for (size_t count = inputs.size(); count > 0; count /= 3) {
+    std::vector<MD5Digest> digests(count);
+    MD5SumMany(&data[0], &lengths[0], count, &digests[0]);
+    for (size_t i = 0; i < count; ++i) {
+      MD5Digest expected;
+      MD5Sum(data[i], lengths[i], &expected);
+      EXPECT_EQ(MD5DigestToBase16(expected), MD5DigestToBase16(digests[i]))
+          << count << " " << i;
+    }
+  }
+  MD5SumMany(NULL, NULL, 0, NULL);
+}
+
 }  // namespace base
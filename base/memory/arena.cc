@@ -0,0 +1,120 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/arena.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/threading/thread_local_storage.h"
+
+namespace base {
+
+namespace {
+
+// The block size of the per-thread arenas.  A paint of a typical window fits
+// in a couple of blocks.
+const size_t kThreadArenaBlockSize = 16 * 1024;
+
+inline size_t AlignSize(size_t size) {
+  return (size + Arena::kAlignment - 1) & ~(Arena::kAlignment - 1);
+}
+
+void DeleteThreadArena(void* arena) {
+  delete static_cast<Arena*>(arena);
+}
+
+class ThreadArenaSlot {
+ public:
+  ThreadArenaSlot() : slot_(&DeleteThreadArena) {
+  }
+
+  Arena* Get() {
+    Arena* arena = static_cast<Arena*>(slot_.Get());
+    if (!arena) {
+      arena = new Arena(kThreadArenaBlockSize);
+      slot_.Set(arena);
+    }
+    return arena;
+  }
+
+ private:
+  ThreadLocalStorage::Slot slot_;
+};
+
+LazyInstance<ThreadArenaSlot>::Leaky g_thread_arena = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+Arena::Arena(size_t block_size)
+    : block_size_(AlignSize(block_size)),
+      current_block_(0),
+      offset_(0),
+      bytes_allocated_(0),
+      frame_depth_(0) {
+  DCHECK_GT(block_size, 0u);
+}
+
+Arena::~Arena() {
+  DCHECK_EQ(0, frame_depth_);
+  for (size_t i = 0; i < blocks_.size(); ++i)
+    free(blocks_[i].data);
+}
+
+// static
+Arena* Arena::GetForCurrentThread() {
+  return g_thread_arena.Get().Get();
+}
+
+void* Arena::Allocate(size_t size) {
+  size = AlignSize(std::max(size, static_cast<size_t>(1)));
+  if (current_block_ >= blocks_.size() ||
+      size > blocks_[current_block_].size - offset_) {
+    NextBlock(size);
+  }
+  void* memory = blocks_[current_block_].data + offset_;
+  offset_ += size;
+  bytes_allocated_ += size;
+  return memory;
+}
+
+void Arena::Reset() {
+  current_block_ = 0;
+  offset_ = 0;
+  bytes_allocated_ = 0;
+}
+
+void Arena::NextBlock(size_t size) {
+  // The rest of the current block is left unused until the next Reset().
+  if (current_block_ < blocks_.size())
+    ++current_block_;
+  offset_ = 0;
+  while (current_block_ < blocks_.size()) {
+    if (blocks_[current_block_].size >= size)
+      return;
+    ++current_block_;
+  }
+
+  Block block;
+  block.size = std::max(size, block_size_);
+  block.data = static_cast<char*>(malloc(block.size));
+  CHECK(block.data);
+  blocks_.push_back(block);
+  current_block_ = blocks_.size() - 1;
+}
+
+ScopedArenaFrame::ScopedArenaFrame(Arena* arena) : arena_(arena) {
+  ++arena_->frame_depth_;
+}
+
+ScopedArenaFrame::~ScopedArenaFrame() {
+  DCHECK_GT(arena_->frame_depth_, 0);
+  if (--arena_->frame_depth_ == 0)
+    arena_->Reset();
+}
+
+}  // namespace base
@@ -0,0 +1,150 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// An Arena hands out memory by bumping a pointer through large blocks, and
+// frees all of it at once in Reset().  It suits the many small, short-lived
+// allocations of a single pass over some data, such as a layout or a paint:
+// once the arena has grown to the size of a pass, later passes allocate
+// without calling malloc at all.
+//
+// Objects placed in an arena are never destroyed by it, so it should only
+// hold memory whose destructors have already run when Reset() is called.
+//
+// EXAMPLE:
+//
+//   base::ScopedArenaFrame frame(base::Arena::GetForCurrentThread());
+//   base::ArenaVector<gfx::Rect>::Type rects(
+//       base::ArenaAllocator<gfx::Rect>(frame.arena()));
+//   ...
+
+#ifndef BASE_MEMORY_ARENA_H_
+#define BASE_MEMORY_ARENA_H_
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+
+namespace base {
+
+class BASE_EXPORT Arena {
+ public:
+  // Every allocation is aligned to this many bytes.
+  static const size_t kAlignment = 8;
+
+  // Blocks are |block_size| bytes, except those made for larger allocations.
+  explicit Arena(size_t block_size);
+  ~Arena();
+
+  // The arena of the current thread, for scratch memory that lives no longer
+  // than one ScopedArenaFrame.  It is deleted when the thread exits.
+  static Arena* GetForCurrentThread();
+
+  // Returns |size| bytes of uninitialized memory.  Never returns NULL.
+  void* Allocate(size_t size);
+
+  // Makes all the memory allocated so far available again.  The blocks are
+  // kept for the next pass.
+  void Reset();
+
+  // The number of bytes allocated since the last Reset().
+  size_t bytes_allocated() const { return bytes_allocated_; }
+
+  // The number of blocks the arena has obtained from malloc.
+  size_t block_count() const { return blocks_.size(); }
+
+ private:
+  friend class ScopedArenaFrame;
+
+  struct Block {
+    char* data;
+    size_t size;
+  };
+
+  // Moves on to a block with room for |size| bytes, making one if needed.
+  void NextBlock(size_t size);
+
+  const size_t block_size_;
+  std::vector<Block> blocks_;
+  // The block being allocated from, and the offset of its first free byte.
+  size_t current_block_;
+  size_t offset_;
+  size_t bytes_allocated_;
+  // The number of ScopedArenaFrames open on this arena.
+  int frame_depth_;
+
+  DISALLOW_COPY_AND_ASSIGN(Arena);
+};
+
+// Resets |arena| when the outermost ScopedArenaFrame on it goes out of scope,
+// so that nested passes can share the arena of their thread.
+class BASE_EXPORT ScopedArenaFrame {
+ public:
+  explicit ScopedArenaFrame(Arena* arena);
+  ~ScopedArenaFrame();
+
+  Arena* arena() const { return arena_; }
+
+ private:
+  Arena* arena_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedArenaFrame);
+};
+
+// This allocator can be used with STL containers to allocate from an Arena.
+// Like StackAllocator, copies of the allocator share the arena, which must
+// outlive every container that uses it.  Freed memory is only given back when
+// the arena is reset, so containers should reserve() their size up front
+// where they can.
+template<typename T>
+class ArenaAllocator : public std::allocator<T> {
+ public:
+  typedef typename std::allocator<T>::pointer pointer;
+  typedef typename std::allocator<T>::size_type size_type;
+
+  // Used by containers when they want to refer to an allocator of type U.
+  template<typename U>
+  struct rebind {
+    typedef ArenaAllocator<U> other;
+  };
+
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {
+  }
+
+  ArenaAllocator(const ArenaAllocator<T>& rhs)
+      : std::allocator<T>(), arena_(rhs.arena_) {
+  }
+
+  // Unlike StackAllocator, an arena is not typed, so rebound copies share it.
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {
+  }
+
+  pointer allocate(size_type n, const void* hint = 0) {
+    COMPILE_ASSERT(ALIGNOF(T) <= Arena::kAlignment,
+                   arena_alignment_too_small);
+    return static_cast<pointer>(arena_->Allocate(n * sizeof(T)));
+  }
+
+  void deallocate(pointer p, size_type n) {
+  }
+
+  Arena* arena() const { return arena_; }
+
+ private:
+  Arena* arena_;
+};
+
+// Shorthand for a std::vector that allocates from an arena.
+template<typename T>
+struct ArenaVector {
+  typedef std::vector<T, ArenaAllocator<T> > Type;
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_ARENA_H_
@@ -0,0 +1,98 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "base/memory/arena.h"
+#include "base/perftimer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kFrames = 10000;
+const int kVectorsPerFrame = 50;
+const int kElementsPerVector = 20;
+
+// A std::allocator that counts its calls to allocate().
+template<typename T>
+class CountingAllocator : public std::allocator<T> {
+ public:
+  typedef typename std::allocator<T>::pointer pointer;
+  typedef typename std::allocator<T>::size_type size_type;
+
+  template<typename U>
+  struct rebind {
+    typedef CountingAllocator<U> other;
+  };
+
+  explicit CountingAllocator(int* allocations) : allocations_(allocations) {
+  }
+
+  CountingAllocator(const CountingAllocator<T>& rhs)
+      : std::allocator<T>(), allocations_(rhs.allocations_) {
+  }
+
+  template<typename U>
+  CountingAllocator(const CountingAllocator<U>& other)
+      : allocations_(other.allocations()) {
+  }
+
+  pointer allocate(size_type n, const void* hint = 0) {
+    ++*allocations_;
+    return std::allocator<T>::allocate(n, hint);
+  }
+
+  int* allocations() const { return allocations_; }
+
+ private:
+  int* allocations_;
+};
+
+// Builds the vectors of one frame the way a paint pass does, without knowing
+// their final size up front.
+template<typename Allocator>
+int RunFrame(const Allocator& allocator) {
+  int sum = 0;
+  for (int i = 0; i < kVectorsPerFrame; ++i) {
+    std::vector<int, Allocator> positions(allocator);
+    for (int j = 0; j < kElementsPerVector; ++j)
+      positions.push_back(j);
+    sum += positions.back();
+  }
+  return sum;
+}
+
+}  // namespace
+
+TEST(ArenaPerfTest, HeapVectors) {
+  int allocations = 0;
+  CountingAllocator<int> allocator(&allocations);
+  int sum = 0;
+  PerfTimer timer;
+  for (int frame = 0; frame < kFrames; ++frame)
+    sum += RunFrame(allocator);
+  LogPerfResult("Arena_HeapVectors_time",
+                timer.Elapsed().InMillisecondsF(), "ms");
+  LogPerfResult("Arena_HeapVectors_mallocs",
+                static_cast<double>(allocations) / kFrames, "mallocs/frame");
+  EXPECT_GT(sum, 0);
+}
+
+TEST(ArenaPerfTest, ArenaVectors) {
+  base::Arena arena(16 * 1024);
+  base::ArenaAllocator<int> allocator(&arena);
+  int sum = 0;
+  PerfTimer timer;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    base::ScopedArenaFrame scoped_frame(&arena);
+    sum += RunFrame(allocator);
+  }
+  LogPerfResult("Arena_ArenaVectors_time",
+                timer.Elapsed().InMillisecondsF(), "ms");
+  // The arena's blocks are the only calls to malloc.
+  LogPerfResult("Arena_ArenaVectors_mallocs",
+                static_cast<double>(arena.block_count()) / kFrames,
+                "mallocs/frame");
+  EXPECT_GT(sum, 0);
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/arena.h"
+
+#include <map>
+#include <string>
+
+#include "base/bind.h"
+#include "base/threading/thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+void GetThreadArena(Arena** arena) {
+  *arena = Arena::GetForCurrentThread();
+}
+
+}  // namespace
+
+TEST(ArenaTest, AllocateAndReset) {
+  Arena arena(1024);
+  EXPECT_EQ(0u, arena.block_count());
+
+  char* first = static_cast<char*>(arena.Allocate(1));
+  char* second = static_cast<char*>(arena.Allocate(10));
+  EXPECT_EQ(1u, arena.block_count());
+  EXPECT_EQ(first + Arena::kAlignment, second);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(second) % Arena::kAlignment);
+  EXPECT_EQ(Arena::kAlignment * 3, arena.bytes_allocated());
+
+  // Filling the block moves on to another one.
+  arena.Allocate(1001);
+  EXPECT_EQ(2u, arena.block_count());
+
+  // Allocations larger than a block get a block of their own.
+  char* large = static_cast<char*>(arena.Allocate(4000));
+  memset(large, 0, 4000);
+  EXPECT_EQ(3u, arena.block_count());
+
+  // After a reset the same blocks are handed out again.
+  arena.Reset();
+  EXPECT_EQ(0u, arena.bytes_allocated());
+  EXPECT_EQ(first, arena.Allocate(1));
+  arena.Allocate(1001);
+  arena.Allocate(4000);
+  EXPECT_EQ(3u, arena.block_count());
+}
+
+TEST(ArenaTest, Containers) {
+  Arena arena(256);
+  ArenaVector<int>::Type ints((ArenaAllocator<int>(&arena)));
+  for (int i = 0; i < 1000; ++i)
+    ints.push_back(i);
+  EXPECT_EQ(999, ints.back());
+  EXPECT_GE(arena.bytes_allocated(), 1000 * sizeof(int));
+
+  // Node based containers rebind the allocator to their node type, which
+  // shares the arena.
+  typedef std::map<int, int, std::less<int>,
+                   ArenaAllocator<std::pair<const int, int> > > ArenaMap;
+  size_t before = arena.bytes_allocated();
+  std::less<int> less;
+  ArenaMap map(less, ArenaAllocator<std::pair<const int, int> >(&arena));
+  map[1] = 2;
+  map[3] = 4;
+  EXPECT_EQ(2, map[1]);
+  EXPECT_GT(arena.bytes_allocated(), before);
+
+  typedef std::basic_string<char, std::char_traits<char>,
+                            ArenaAllocator<char> > ArenaString;
+  ArenaString string("a string that is too long to be stored inline",
+                     ArenaAllocator<char>(&arena));
+  string += " and then some more";
+  EXPECT_EQ('a', string[0]);
+}
+
+TEST(ArenaTest, ScopedArenaFrame) {
+  Arena arena(1024);
+  {
+    ScopedArenaFrame outer(&arena);
+    arena.Allocate(100);
+    {
+      ScopedArenaFrame inner(&arena);
+      arena.Allocate(100);
+    }
+    // Only the outermost frame resets the arena.
+    EXPECT_EQ(208u, arena.bytes_allocated());
+  }
+  EXPECT_EQ(0u, arena.bytes_allocated());
+}
+
+TEST(ArenaTest, GetForCurrentThread) {
+  Arena* arena = Arena::GetForCurrentThread();
+  ASSERT_TRUE(arena);
+  EXPECT_EQ(arena, Arena::GetForCurrentThread());
+
+  Thread thread("ArenaTestThread");
+  ASSERT_TRUE(thread.Start());
+  Arena* thread_arena = NULL;
+  thread.message_loop()->PostTask(FROM_HERE,
+                                  Bind(&GetThreadArena, &thread_arena));
+  thread.Stop();
+  EXPECT_TRUE(thread_arena);
+  EXPECT_NE(arena, thread_arena);
+}
+
+}  // namespace base
@@ -0,0 +1,72 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/memory_pressure_listener.h"
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/observer_list_threadsafe.h"
+
+namespace base {
+
+namespace {
+
+// The listeners of the process. Leaky, since listeners may outlive the
+// AtExitManager.
+class MemoryPressureObservers {
+ public:
+  MemoryPressureObservers()
+      : observers_(new ObserverListThreadSafe<MemoryPressureListener>) {
+  }
+
+  ObserverListThreadSafe<MemoryPressureListener>* observers() {
+    return observers_.get();
+  }
+
+ private:
+  scoped_refptr<ObserverListThreadSafe<MemoryPressureListener> > observers_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryPressureObservers);
+};
+
+LazyInstance<MemoryPressureObservers>::Leaky g_observers =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+MemoryPressureListener::MemoryPressureListener(
+    const MemoryPressureCallback& callback)
+    : callback_(callback) {
+  DCHECK(!callback_.is_null());
+  g_observers.Get().observers()->AddObserver(this);
+}
+
+MemoryPressureListener::~MemoryPressureListener() {
+  g_observers.Get().observers()->RemoveObserver(this);
+}
+
+// static
+void MemoryPressureListener::NotifyMemoryPressure(MemoryPressureLevel level) {
+  g_observers.Get().observers()->Notify(&MemoryPressureListener::Notify,
+                                        level);
+}
+
+// static
+size_t MemoryPressureListener::GetTrimmedBudget(size_t budget,
+                                                MemoryPressureLevel level) {
+  switch (level) {
+    case MEMORY_PRESSURE_MODERATE:
+      return budget / 4;
+    case MEMORY_PRESSURE_CRITICAL:
+      return 0;
+  }
+  NOTREACHED();
+  return budget;
+}
+
+void MemoryPressureListener::Notify(MemoryPressureLevel level) {
+  callback_.Run(level);
+}
+
+}  // namespace base
@@ -0,0 +1,74 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// MemoryPressureListener lets the caches of a process hear that the system is
+// short of memory, so they can give some of theirs back. A cache makes a
+// listener with a callback, and keeps it as long as it wants to hear:
+//
+//   void OnMemoryPressure(
+//       base::MemoryPressureListener::MemoryPressureLevel level) {
+//     base::AutoLock lock(lock_);
+//     EvictToByteCount(
+//         base::MemoryPressureListener::GetTrimmedBudget(byte_budget_, level));
+//   }
+//
+//   memory_pressure_listener_.reset(new base::MemoryPressureListener(
+//       base::Bind(&MyCache::OnMemoryPressure, base::Unretained(this))));
+//
+// The callback runs on the thread that made the listener, which must have a
+// MessageLoop; a listener made on a thread without one is never called. It
+// must be destroyed on that thread too.
+//
+// Anything may call NotifyMemoryPressure(); MemoryPressureMonitor calls it
+// from what the system says about its memory.
+
+#ifndef BASE_MEMORY_MEMORY_PRESSURE_LISTENER_H_
+#define BASE_MEMORY_MEMORY_PRESSURE_LISTENER_H_
+#pragma once
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/callback.h"
+
+namespace base {
+
+class BASE_EXPORT MemoryPressureListener {
+ public:
+  enum MemoryPressureLevel {
+    // Memory is getting short: caches should drop what is cheap to make
+    // again.
+    MEMORY_PRESSURE_MODERATE,
+
+    // The system is about to start killing processes or swapping: caches
+    // should drop everything they can.
+    MEMORY_PRESSURE_CRITICAL,
+  };
+
+  typedef base::Callback<void(MemoryPressureLevel)> MemoryPressureCallback;
+
+  explicit MemoryPressureListener(const MemoryPressureCallback& callback);
+  ~MemoryPressureListener();
+
+  // Runs the callbacks of all the listeners, each on its own thread. The
+  // callbacks run later, even the ones on the calling thread.
+  static void NotifyMemoryPressure(MemoryPressureLevel level);
+
+  // Returns how much of its |budget|, in bytes or in entries, a cache should
+  // keep under |level|: a quarter when moderate, nothing when critical. The
+  // cache keeps its budget; it only trims to this once.
+  static size_t GetTrimmedBudget(size_t budget, MemoryPressureLevel level);
+
+ private:
+  void Notify(MemoryPressureLevel level);
+
+  MemoryPressureCallback callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryPressureListener);
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_MEMORY_PRESSURE_LISTENER_H_
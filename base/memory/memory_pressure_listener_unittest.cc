@@ -0,0 +1,61 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/memory_pressure_listener.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+void RecordLevel(
+    std::vector<MemoryPressureListener::MemoryPressureLevel>* levels,
+    MemoryPressureListener::MemoryPressureLevel level) {
+  levels->push_back(level);
+}
+
+}  // namespace
+
+TEST(MemoryPressureListenerTest, Notify) {
+  MessageLoop message_loop;
+  std::vector<MemoryPressureListener::MemoryPressureLevel> levels;
+  scoped_ptr<MemoryPressureListener> listener(new MemoryPressureListener(
+      Bind(&RecordLevel, &levels)));
+
+  // Listeners hear it later, not from NotifyMemoryPressure().
+  MemoryPressureListener::NotifyMemoryPressure(
+      MemoryPressureListener::MEMORY_PRESSURE_MODERATE);
+  EXPECT_TRUE(levels.empty());
+  message_loop.RunAllPending();
+  ASSERT_EQ(1u, levels.size());
+  EXPECT_EQ(MemoryPressureListener::MEMORY_PRESSURE_MODERATE, levels[0]);
+
+  MemoryPressureListener::NotifyMemoryPressure(
+      MemoryPressureListener::MEMORY_PRESSURE_CRITICAL);
+  message_loop.RunAllPending();
+  ASSERT_EQ(2u, levels.size());
+  EXPECT_EQ(MemoryPressureListener::MEMORY_PRESSURE_CRITICAL, levels[1]);
+
+  // A destroyed listener doesn't hear what was on its way.
+  MemoryPressureListener::NotifyMemoryPressure(
+      MemoryPressureListener::MEMORY_PRESSURE_CRITICAL);
+  listener.reset();
+  message_loop.RunAllPending();
+  EXPECT_EQ(2u, levels.size());
+}
+
+TEST(MemoryPressureListenerTest, GetTrimmedBudget) {
+  EXPECT_EQ(1024u, MemoryPressureListener::GetTrimmedBudget(
+      4096, MemoryPressureListener::MEMORY_PRESSURE_MODERATE));
+  EXPECT_EQ(0u, MemoryPressureListener::GetTrimmedBudget(
+      4096, MemoryPressureListener::MEMORY_PRESSURE_CRITICAL));
+}
+
+}  // namespace base
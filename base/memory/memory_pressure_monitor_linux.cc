@@ -0,0 +1,288 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/memory_pressure_monitor_linux.h"
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "base/allocator/allocator_extension.h"
+#include "base/bind.h"
+#include "base/eintr_wrapper.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/process_util.h"
+#include "base/string_split.h"
+#include "base/stringprintf.h"
+#include "base/threading/thread_restrictions.h"
+
+namespace base {
+
+namespace {
+
+// How often /proc/meminfo and the heap are polled.
+const int kPollIntervalSeconds = 5;
+
+// How long the listeners don't hear the same level again.
+const int kRenotifyIntervalSeconds = 10;
+
+// Returns true if the comma separated |list| has |item|.
+bool ListHas(const std::string& list, const std::string& item) {
+  std::vector<std::string> items;
+  SplitString(list, ',', &items);
+  for (size_t i = 0; i < items.size(); ++i) {
+    if (items[i] == item)
+      return true;
+  }
+  return false;
+}
+
+void CloseFD(int* fd) {
+  if (*fd < 0)
+    return;
+  if (HANDLE_EINTR(close(*fd)) < 0)
+    DPLOG(ERROR) << "close";
+  *fd = -1;
+}
+
+}  // namespace
+
+const int MemoryPressureMonitor::kModerateAvailablePercent = 15;
+const int MemoryPressureMonitor::kCriticalAvailablePercent = 5;
+
+MemoryPressureMonitor::MemoryPressureMonitor()
+    : started_(false),
+      heap_limit_bytes_(0),
+      pressure_level_fd_(-1),
+      moderate_event_fd_(-1),
+      critical_event_fd_(-1),
+      last_level_(MemoryPressureListener::MEMORY_PRESSURE_MODERATE) {
+}
+
+MemoryPressureMonitor::~MemoryPressureMonitor() {
+  Stop();
+}
+
+void MemoryPressureMonitor::Start() {
+  if (started_)
+    return;
+  started_ = true;
+
+  std::string proc_self_cgroup;
+  std::string proc_mounts;
+  FilePath cgroup_path;
+  {
+    // Reading files in /proc doesn't block.
+    ThreadRestrictions::ScopedAllowIO allow_io;
+    file_util::ReadFileToString(FilePath("/proc/self/cgroup"),
+                                &proc_self_cgroup);
+    file_util::ReadFileToString(FilePath("/proc/mounts"), &proc_mounts);
+  }
+  if (GetMemoryCgroupPath(proc_self_cgroup, proc_mounts, &cgroup_path)) {
+    // The kernel's "medium" is when it has to swap or drop caches, which is
+    // the moderate pressure of the listeners; "low" is routine reclaim.
+    if (!ListenToCgroup(cgroup_path, "medium", &moderate_event_fd_,
+                        &moderate_watcher_) ||
+        !ListenToCgroup(cgroup_path, "critical", &critical_event_fd_,
+                        &critical_watcher_)) {
+      moderate_watcher_.StopWatchingFileDescriptor();
+      CloseFD(&moderate_event_fd_);
+      CloseFD(&pressure_level_fd_);
+    }
+  }
+
+  poll_timer_.Start(FROM_HERE, TimeDelta::FromSeconds(kPollIntervalSeconds),
+                    this, &MemoryPressureMonitor::Poll);
+}
+
+void MemoryPressureMonitor::Stop() {
+  if (!started_)
+    return;
+  started_ = false;
+  poll_timer_.Stop();
+  moderate_watcher_.StopWatchingFileDescriptor();
+  critical_watcher_.StopWatchingFileDescriptor();
+  CloseFD(&moderate_event_fd_);
+  CloseFD(&critical_event_fd_);
+  CloseFD(&pressure_level_fd_);
+  last_notified_ = TimeTicks();
+}
+
+// static
+bool MemoryPressureMonitor::GetLevelForMemoryInfo(
+    const SystemMemoryInfoKB& meminfo,
+    MemoryPressureListener::MemoryPressureLevel* level) {
+  if (meminfo.total <= 0)
+    return false;
+  // Caches of files are dropped before anything is swapped.
+  int64 available_percent =
+      100 * static_cast<int64>(meminfo.free + meminfo.buffers +
+                               meminfo.cached) / meminfo.total;
+  if (available_percent < kCriticalAvailablePercent) {
+    *level = MemoryPressureListener::MEMORY_PRESSURE_CRITICAL;
+    return true;
+  }
+  if (available_percent < kModerateAvailablePercent) {
+    *level = MemoryPressureListener::MEMORY_PRESSURE_MODERATE;
+    return true;
+  }
+  return false;
+}
+
+// static
+bool MemoryPressureMonitor::GetLevelForHeapSize(
+    size_t heap_bytes,
+    size_t heap_limit_bytes,
+    MemoryPressureListener::MemoryPressureLevel* level) {
+  if (!heap_limit_bytes || heap_bytes <= heap_limit_bytes)
+    return false;
+  *level = heap_bytes / 2 > heap_limit_bytes ?
+      MemoryPressureListener::MEMORY_PRESSURE_CRITICAL :
+      MemoryPressureListener::MEMORY_PRESSURE_MODERATE;
+  return true;
+}
+
+// static
+bool MemoryPressureMonitor::GetMemoryCgroupPath(
+    const std::string& proc_self_cgroup,
+    const std::string& proc_mounts,
+    FilePath* path) {
+  // The lines of /proc/self/cgroup are "<id>:<controllers>:<path>"; cgroup v2
+  // has an empty list of controllers, and no pressure_level.
+  std::string relative_path;
+  bool found = false;
+  std::vector<std::string> lines;
+  SplitString(proc_self_cgroup, '\n', &lines);
+  for (size_t i = 0; i < lines.size() && !found; ++i) {
+    size_t first = lines[i].find(':');
+    size_t second = first == std::string::npos ?
+        std::string::npos : lines[i].find(':', first + 1);
+    if (second == std::string::npos)
+      continue;
+    if (ListHas(lines[i].substr(first + 1, second - first - 1), "memory")) {
+      relative_path = lines[i].substr(second + 1);
+      found = true;
+    }
+  }
+  if (!found)
+    return false;
+
+  // The lines of /proc/mounts are "<device> <dir> <type> <options> 0 0".
+  SplitString(proc_mounts, '\n', &lines);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    std::vector<std::string> fields;
+    SplitStringAlongWhitespace(lines[i], &fields);
+    if (fields.size() < 4 || fields[2] != "cgroup" ||
+        !ListHas(fields[3], "memory")) {
+      continue;
+    }
+    FilePath mount_point(fields[1]);
+    while (!relative_path.empty() && relative_path[0] == '/')
+      relative_path.erase(0, 1);
+    *path = relative_path.empty() ? mount_point :
+        mount_point.Append(relative_path);
+    return true;
+  }
+  return false;
+}
+
+bool MemoryPressureMonitor::ListenToCgroup(
+    const FilePath& cgroup_path,
+    const char* kernel_level,
+    int* event_fd,
+    MessageLoopForIO::FileDescriptorWatcher* watcher) {
+  ThreadRestrictions::ScopedAllowIO allow_io;
+  if (pressure_level_fd_ < 0) {
+    pressure_level_fd_ = HANDLE_EINTR(open(
+        cgroup_path.Append("memory.pressure_level").value().c_str(),
+        O_RDONLY));
+    if (pressure_level_fd_ < 0)
+      return false;
+  }
+
+  *event_fd = eventfd(0, EFD_NONBLOCK);
+  if (*event_fd < 0) {
+    DPLOG(ERROR) << "eventfd";
+    return false;
+  }
+
+  // Writing "<event_fd> <pressure_level_fd> <level>" to cgroup.event_control
+  // asks the kernel to signal the eventfd at that level.
+  std::string control = StringPrintf("%d %d %s", *event_fd,
+                                     pressure_level_fd_, kernel_level);
+  int written = file_util::WriteFile(
+      cgroup_path.Append("cgroup.event_control"), control.data(),
+      control.size());
+  if (written != static_cast<int>(control.size()) ||
+      !MessageLoopForIO::current()->WatchFileDescriptor(
+          *event_fd, true, MessageLoopForIO::WATCH_READ, watcher, this)) {
+    CloseFD(event_fd);
+    return false;
+  }
+  return true;
+}
+
+void MemoryPressureMonitor::Poll() {
+  bool under_pressure = false;
+  MemoryPressureListener::MemoryPressureLevel level =
+      MemoryPressureListener::MEMORY_PRESSURE_MODERATE;
+
+  SystemMemoryInfoKB meminfo;
+  if (GetSystemMemoryInfo(&meminfo))
+    under_pressure = GetLevelForMemoryInfo(meminfo, &level);
+
+  size_t heap_bytes = 0;
+  MemoryPressureListener::MemoryPressureLevel heap_level;
+  if (heap_limit_bytes_ &&
+      allocator::GetNumericProperty("generic.heap_size", &heap_bytes) &&
+      GetLevelForHeapSize(heap_bytes, heap_limit_bytes_, &heap_level)) {
+    if (!under_pressure || heap_level > level)
+      level = heap_level;
+    under_pressure = true;
+  }
+
+  if (under_pressure) {
+    OnMemoryPressure(level);
+  } else {
+    // The next pressure is news.
+    last_notified_ = TimeTicks();
+  }
+}
+
+void MemoryPressureMonitor::OnMemoryPressure(
+    MemoryPressureListener::MemoryPressureLevel level) {
+  TimeTicks now = TimeTicks::Now();
+  if (!last_notified_.is_null() && level <= last_level_ &&
+      now - last_notified_ < TimeDelta::FromSeconds(kRenotifyIntervalSeconds)) {
+    return;
+  }
+  last_level_ = level;
+  last_notified_ = now;
+  MemoryPressureListener::NotifyMemoryPressure(level);
+  // After the listeners of this thread, at least, have freed what they can.
+  if (level == MemoryPressureListener::MEMORY_PRESSURE_CRITICAL) {
+    MessageLoop::current()->PostTask(FROM_HERE,
+                                     Bind(&allocator::ReleaseFreeMemory));
+  }
+}
+
+void MemoryPressureMonitor::OnFileCanReadWithoutBlocking(int fd) {
+  // Reading resets the count of the eventfd.
+  uint64 count;
+  if (HANDLE_EINTR(read(fd, &count, sizeof(count))) < 0)
+    return;
+  OnMemoryPressure(fd == critical_event_fd_ ?
+      MemoryPressureListener::MEMORY_PRESSURE_CRITICAL :
+      MemoryPressureListener::MEMORY_PRESSURE_MODERATE);
+}
+
+void MemoryPressureMonitor::OnFileCanWriteWithoutBlocking(int fd) {
+  NOTREACHED();
+}
+
+}  // namespace base
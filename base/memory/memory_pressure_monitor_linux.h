@@ -0,0 +1,123 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_MEMORY_PRESSURE_MONITOR_LINUX_H_
+#define BASE_MEMORY_MEMORY_PRESSURE_MONITOR_LINUX_H_
+#pragma once
+
+#include <string>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/message_loop.h"
+#include "base/time.h"
+#include "base/timer.h"
+
+class FilePath;
+
+namespace base {
+
+struct SystemMemoryInfoKB;
+
+// MemoryPressureMonitor tells the MemoryPressureListeners of the process when
+// the system runs short of memory. It hears it from three sources:
+//
+//  - The memory.pressure_level events of the memory cgroup of the process,
+//    when the kernel has cgroup v1 memory control. The kernel signals them
+//    as soon as reclaim gets hard, before polling could see it.
+//  - /proc/meminfo, polled every few seconds: the memory that is free or
+//    only caches files, as a share of all of it.
+//  - The heap of the allocator, when a heap limit is set and the allocator
+//    reports "generic.heap_size" through base::allocator.
+//
+// The same level is reported at most once every few seconds, however many
+// sources see it; a higher level is reported at once. After critical
+// pressure, the allocator is asked to give its free memory back.
+//
+// The monitor must be started and destroyed on a thread with an IO
+// MessageLoop.
+class BASE_EXPORT MemoryPressureMonitor : public MessageLoopForIO::Watcher {
+ public:
+  // Below these percentages of available memory, the pressure is moderate
+  // and critical.
+  static const int kModerateAvailablePercent;
+  static const int kCriticalAvailablePercent;
+
+  MemoryPressureMonitor();
+  virtual ~MemoryPressureMonitor();
+
+  // Starts listening to the cgroup and polling. Does nothing if started.
+  void Start();
+  void Stop();
+
+  // Sets the size the heap of the allocator may reach before the pressure is
+  // moderate; it is critical at twice that. 0, the default, doesn't watch the
+  // heap.
+  void set_heap_limit_bytes(size_t heap_limit_bytes) {
+    heap_limit_bytes_ = heap_limit_bytes;
+  }
+
+  // Sets |level| to the pressure |meminfo| shows. Returns false if there is
+  // none.
+  static bool GetLevelForMemoryInfo(
+      const SystemMemoryInfoKB& meminfo,
+      MemoryPressureListener::MemoryPressureLevel* level);
+
+  // Sets |level| to the pressure of a heap of |heap_bytes| that may take
+  // |heap_limit_bytes|. Returns false if there is none.
+  static bool GetLevelForHeapSize(
+      size_t heap_bytes,
+      size_t heap_limit_bytes,
+      MemoryPressureListener::MemoryPressureLevel* level);
+
+  // Sets |path| to the directory of the memory cgroup of the process, from
+  // the contents of /proc/self/cgroup and /proc/mounts. Returns false if
+  // cgroup v1 memory control isn't mounted.
+  static bool GetMemoryCgroupPath(const std::string& proc_self_cgroup,
+                                  const std::string& proc_mounts,
+                                  FilePath* path);
+
+ private:
+  // Opens an eventfd the kernel signals at |kernel_level| of the pressure in
+  // |cgroup_path|, and watches it. Returns false if the cgroup can't.
+  bool ListenToCgroup(const FilePath& cgroup_path,
+                      const char* kernel_level,
+                      int* event_fd,
+                      MessageLoopForIO::FileDescriptorWatcher* watcher);
+
+  // Polls /proc/meminfo and the heap.
+  void Poll();
+
+  // Notifies the listeners of |level|, unless they heard it lately.
+  void OnMemoryPressure(MemoryPressureListener::MemoryPressureLevel level);
+
+  // MessageLoopForIO::Watcher:
+  virtual void OnFileCanReadWithoutBlocking(int fd) OVERRIDE;
+  virtual void OnFileCanWriteWithoutBlocking(int fd) OVERRIDE;
+
+  bool started_;
+  size_t heap_limit_bytes_;
+
+  // The memory.pressure_level file of the cgroup, and the eventfds the
+  // kernel signals at medium and critical pressure; -1 when closed.
+  int pressure_level_fd_;
+  int moderate_event_fd_;
+  int critical_event_fd_;
+  MessageLoopForIO::FileDescriptorWatcher moderate_watcher_;
+  MessageLoopForIO::FileDescriptorWatcher critical_watcher_;
+
+  RepeatingTimer<MemoryPressureMonitor> poll_timer_;
+
+  // The level last reported and when; null if there was no pressure at the
+  // last poll.
+  MemoryPressureListener::MemoryPressureLevel last_level_;
+  TimeTicks last_notified_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryPressureMonitor);
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_MEMORY_PRESSURE_MONITOR_LINUX_H_
@@ -0,0 +1,70 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/memory_pressure_monitor_linux.h"
+
+#include "base/file_path.h"
+#include "base/process_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(MemoryPressureMonitorTest, GetLevelForMemoryInfo) {
+  SystemMemoryInfoKB meminfo;
+  MemoryPressureListener::MemoryPressureLevel level;
+  EXPECT_FALSE(MemoryPressureMonitor::GetLevelForMemoryInfo(meminfo, &level));
+
+  // Free memory and the caches of files are both available.
+  meminfo.total = 1000;
+  meminfo.free = 100;
+  meminfo.cached = 100;
+  EXPECT_FALSE(MemoryPressureMonitor::GetLevelForMemoryInfo(meminfo, &level));
+
+  meminfo.cached = 10;
+  meminfo.buffers = 10;
+  ASSERT_TRUE(MemoryPressureMonitor::GetLevelForMemoryInfo(meminfo, &level));
+  EXPECT_EQ(MemoryPressureListener::MEMORY_PRESSURE_MODERATE, level);
+
+  meminfo.free = 20;
+  ASSERT_TRUE(MemoryPressureMonitor::GetLevelForMemoryInfo(meminfo, &level));
+  EXPECT_EQ(MemoryPressureListener::MEMORY_PRESSURE_CRITICAL, level);
+}
+
+TEST(MemoryPressureMonitorTest, GetLevelForHeapSize) {
+  MemoryPressureListener::MemoryPressureLevel level;
+  // Without a limit, the heap is never under pressure.
+  EXPECT_FALSE(MemoryPressureMonitor::GetLevelForHeapSize(100, 0, &level));
+  EXPECT_FALSE(MemoryPressureMonitor::GetLevelForHeapSize(100, 100, &level));
+  ASSERT_TRUE(MemoryPressureMonitor::GetLevelForHeapSize(101, 100, &level));
+  EXPECT_EQ(MemoryPressureListener::MEMORY_PRESSURE_MODERATE, level);
+  ASSERT_TRUE(MemoryPressureMonitor::GetLevelForHeapSize(202, 100, &level));
+  EXPECT_EQ(MemoryPressureListener::MEMORY_PRESSURE_CRITICAL, level);
+}
+
+TEST(MemoryPressureMonitorTest, GetMemoryCgroupPath) {
+  const char kMounts[] =
+      "proc /proc proc rw,nosuid,nodev,noexec,relatime 0 0\n"
+      "cgroup /sys/fs/cgroup/cpu,cpuacct cgroup rw,cpu,cpuacct 0 0\n"
+      "cgroup /sys/fs/cgroup/memory cgroup rw,nosuid,memory 0 0\n";
+  FilePath path;
+  EXPECT_TRUE(MemoryPressureMonitor::GetMemoryCgroupPath(
+      "5:cpu,cpuacct:/user\n"
+      "4:memory:/user/1000.user/c2.session\n",
+      kMounts, &path));
+  EXPECT_EQ("/sys/fs/cgroup/memory/user/1000.user/c2.session", path.value());
+
+  EXPECT_TRUE(MemoryPressureMonitor::GetMemoryCgroupPath(
+      "4:memory:/\n", kMounts, &path));
+  EXPECT_EQ("/sys/fs/cgroup/memory", path.value());
+
+  // cgroup v2 has no memory.pressure_level.
+  EXPECT_FALSE(MemoryPressureMonitor::GetMemoryCgroupPath(
+      "0::/user.slice\n",
+      "cgroup2 /sys/fs/cgroup cgroup2 rw,nosuid 0 0\n", &path));
+  // Nor does a memory controller that isn't mounted.
+  EXPECT_FALSE(MemoryPressureMonitor::GetMemoryCgroupPath(
+      "4:memory:/user\n", "proc /proc proc rw 0 0\n", &path));
+}
+
+}  // namespace base
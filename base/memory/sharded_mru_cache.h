@@ -0,0 +1,307 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// ShardedMRUCache is a Most Recently Used cache that many threads can use at
+// once, limited by the total cost of its entries rather than by their number.
+// Image and font caches, for example, charge each entry its size in bytes.
+//
+// Keys are spread over a number of shards by their hash, and each shard has
+// its own lock, its own index and its own recency list, so threads working on
+// different keys rarely wait for each other.  Each shard gets an equal part
+// of the budget and evicts its own least recently used entries when it goes
+// over, so recency is only kept within a shard.
+//
+// Each entry takes a single allocation: the links of the recency list live in
+// the index's node, next to the key and the payload.  The key is stored once.
+//
+// Since entries can be evicted by another thread at any time, payloads are
+// copied in and out; use a cheaply copyable type such as scoped_refptr<>.
+//
+// Example:
+//
+//   struct BitmapCost {
+//     size_t operator()(const scoped_refptr<Bitmap>& bitmap) const {
+//       return bitmap->size_in_bytes();
+//     }
+//   };
+//   base::ShardedMRUCache<GURL, scoped_refptr<Bitmap>, BitmapCost> cache(
+//       32 * 1024 * 1024, 16, "ImageCache");
+//   cache.Put(url, bitmap);
+//   ...
+//   scoped_refptr<Bitmap> cached;
+//   if (cache.Get(url, &cached))
+//     ...
+
+#ifndef BASE_MEMORY_SHARDED_MRU_CACHE_H_
+#define BASE_MEMORY_SHARDED_MRU_CACHE_H_
+#pragma once
+
+#include <string>
+#include <utility>
+
+#include "base/basictypes.h"
+#include "base/hash_tables.h"
+#include "base/linked_list.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/metrics/stats_counters.h"
+#include "base/synchronization/lock.h"
+
+namespace base {
+
+// Charges every entry 1, so that the budget of a cache using it is a number
+// of entries.
+template <class PayloadType>
+struct ShardedMRUCacheUnitCost {
+  size_t operator()(const PayloadType& payload) const {
+    return 1;
+  }
+};
+
+// The counts a ShardedMRUCache keeps, summed over its shards.
+struct ShardedMRUCacheStats {
+  ShardedMRUCacheStats() : hits(0), misses(0), evictions(0) {}
+
+  int64 hits;
+  int64 misses;
+  // Entries pushed out to make room, not counting the ones erased or
+  // replaced by the caller.
+  int64 evictions;
+};
+
+// |CostType| is a functor giving the cost of a payload, which must not change
+// while the payload is in the cache.  KeyType must be hashable.
+template <class KeyType, class PayloadType,
+          class CostType = ShardedMRUCacheUnitCost<PayloadType> >
+class ShardedMRUCache {
+ public:
+  // Makes a cache whose entries cost at most |max_cost| in all, spread over
+  // |shard_count| shards.  If |stats_name| is not empty, hits, misses and
+  // evictions are also counted in the StatsTable, as the StatsCounters
+  // "<stats_name>.Hits", "<stats_name>.Misses" and "<stats_name>.Evictions".
+  ShardedMRUCache(size_t max_cost,
+                  size_t shard_count,
+                  const std::string& stats_name)
+      : shards_(new Shard[shard_count]),
+        shard_count_(shard_count),
+        max_shard_cost_(max_cost / shard_count),
+        stats_enabled_(!stats_name.empty()),
+        hit_counter_(stats_name + ".Hits"),
+        miss_counter_(stats_name + ".Misses"),
+        eviction_counter_(stats_name + ".Evictions") {
+    DCHECK_GT(shard_count, 0u);
+  }
+
+  ShardedMRUCache(size_t max_cost,
+                  size_t shard_count,
+                  const std::string& stats_name,
+                  const CostType& cost)
+      : shards_(new Shard[shard_count]),
+        shard_count_(shard_count),
+        max_shard_cost_(max_cost / shard_count),
+        cost_(cost),
+        stats_enabled_(!stats_name.empty()),
+        hit_counter_(stats_name + ".Hits"),
+        miss_counter_(stats_name + ".Misses"),
+        eviction_counter_(stats_name + ".Evictions") {
+    DCHECK_GT(shard_count, 0u);
+  }
+
+  ~ShardedMRUCache() {
+  }
+
+  // The most that the entries of one shard may cost together.
+  size_t max_shard_cost() const { return max_shard_cost_; }
+
+  // Inserts a copy of |payload| under |key|, replacing whatever was there,
+  // and evicts the least recently used entries of its shard until it fits.
+  // Returns false, leaving |key| out of the cache, if |payload| alone costs
+  // more than a shard may hold.
+  bool Put(const KeyType& key, const PayloadType& payload) {
+    size_t cost = cost_(payload);
+    Shard* shard = ShardFor(key);
+    int evictions = 0;
+    bool inserted;
+    {
+      AutoLock lock(shard->lock);
+      typename Index::iterator it = shard->index.find(key);
+      if (it != shard->index.end())
+        shard->Erase(it);
+      inserted = cost <= max_shard_cost_;
+      if (inserted) {
+        while (shard->cost + cost > max_shard_cost_) {
+          shard->Erase(
+              shard->index.find(*shard->ordering.head()->value()->key));
+          ++evictions;
+        }
+        it = shard->index.insert(
+            std::make_pair(key, Entry(payload, cost))).first;
+        it->second.key = &it->first;
+        shard->ordering.Append(&it->second);
+        shard->cost += cost;
+      }
+      shard->stats.evictions += evictions;
+    }
+    if (evictions && stats_enabled_)
+      eviction_counter_.Add(evictions);
+    return inserted;
+  }
+
+  // Copies the payload under |key| into |payload|, making it the most
+  // recently used entry of its shard.  Returns false if there is none.
+  bool Get(const KeyType& key, PayloadType* payload) {
+    Shard* shard = ShardFor(key);
+    bool found;
+    {
+      AutoLock lock(shard->lock);
+      typename Index::iterator it = shard->index.find(key);
+      found = it != shard->index.end();
+      if (found) {
+        Entry* entry = &it->second;
+        entry->RemoveFromList();
+        shard->ordering.Append(entry);
+        *payload = entry->payload;
+        ++shard->stats.hits;
+      } else {
+        ++shard->stats.misses;
+      }
+    }
+    if (stats_enabled_)
+      (found ? hit_counter_ : miss_counter_).Increment();
+    return found;
+  }
+
+  // Removes the entry under |key|.  Returns false if there was none.
+  bool Erase(const KeyType& key) {
+    Shard* shard = ShardFor(key);
+    AutoLock lock(shard->lock);
+    typename Index::iterator it = shard->index.find(key);
+    if (it == shard->index.end())
+      return false;
+    shard->Erase(it);
+    return true;
+  }
+
+  // Evicts the least recently used entries of each shard until the entries
+  // cost at most |max_cost| in all, as when memory is short.  Later puts may
+  // fill the cache up to its own limit again.
+  void EvictToCost(size_t max_cost) {
+    const size_t max_shard_cost = max_cost / shard_count_;
+    int evictions = 0;
+    for (size_t i = 0; i < shard_count_; ++i) {
+      Shard* shard = &shards_[i];
+      AutoLock lock(shard->lock);
+      int shard_evictions = 0;
+      while (shard->cost > max_shard_cost) {
+        shard->Erase(
+            shard->index.find(*shard->ordering.head()->value()->key));
+        ++shard_evictions;
+      }
+      shard->stats.evictions += shard_evictions;
+      evictions += shard_evictions;
+    }
+    if (evictions && stats_enabled_)
+      eviction_counter_.Add(evictions);
+  }
+
+  // Removes every entry.  The counts are kept.
+  void Clear() {
+    for (size_t i = 0; i < shard_count_; ++i) {
+      AutoLock lock(shards_[i].lock);
+      shards_[i].Clear();
+    }
+  }
+
+  // The number of entries and their total cost.  Other threads may change
+  // both while these add up the shards.
+  size_t size() const {
+    size_t size = 0;
+    for (size_t i = 0; i < shard_count_; ++i) {
+      AutoLock lock(shards_[i].lock);
+      size += shards_[i].index.size();
+    }
+    return size;
+  }
+
+  size_t cost() const {
+    size_t cost = 0;
+    for (size_t i = 0; i < shard_count_; ++i) {
+      AutoLock lock(shards_[i].lock);
+      cost += shards_[i].cost;
+    }
+    return cost;
+  }
+
+  ShardedMRUCacheStats GetStats() const {
+    ShardedMRUCacheStats stats;
+    for (size_t i = 0; i < shard_count_; ++i) {
+      AutoLock lock(shards_[i].lock);
+      stats.hits += shards_[i].stats.hits;
+      stats.misses += shards_[i].stats.misses;
+      stats.evictions += shards_[i].stats.evictions;
+    }
+    return stats;
+  }
+
+ private:
+  // The value of the index.  It is linked into the recency list where the
+  // index put it, and points back at the key the index keeps.
+  struct Entry : public LinkNode<Entry> {
+    Entry(const PayloadType& payload, size_t cost)
+        : key(NULL), payload(payload), cost(cost) {
+    }
+
+    const KeyType* key;
+    PayloadType payload;
+    size_t cost;
+  };
+
+  typedef hash_map<KeyType, Entry> Index;
+
+  struct Shard {
+    Shard() : cost(0) {}
+    ~Shard() { Clear(); }
+
+    void Erase(typename Index::iterator it) {
+      it->second.RemoveFromList();
+      cost -= it->second.cost;
+      index.erase(it);
+    }
+
+    void Clear() {
+      // The list's root points into the index, so empty it first.
+      while (ordering.head() != ordering.end())
+        ordering.head()->RemoveFromList();
+      index.clear();
+      cost = 0;
+    }
+
+    mutable Lock lock;
+    Index index;
+    // From least to most recently used.
+    LinkedList<Entry> ordering;
+    size_t cost;
+    ShardedMRUCacheStats stats;
+  };
+
+  Shard* ShardFor(const KeyType& key) {
+    return &shards_[BASE_HASH_NAMESPACE::hash<KeyType>()(key) % shard_count_];
+  }
+
+  scoped_array<Shard> shards_;
+  const size_t shard_count_;
+  const size_t max_shard_cost_;
+  CostType cost_;
+
+  const bool stats_enabled_;
+  StatsCounter hit_counter_;
+  StatsCounter miss_counter_;
+  StatsCounter eviction_counter_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedMRUCache);
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_SHARDED_MRU_CACHE_H_
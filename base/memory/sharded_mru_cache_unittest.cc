@@ -0,0 +1,197 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/sharded_mru_cache.h"
+
+#include <string>
+
+#include "base/metrics/stats_table.h"
+#include "base/shared_memory.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Charges a string its length.
+struct StringCost {
+  size_t operator()(const std::string& payload) const {
+    return payload.size();
+  }
+};
+
+typedef ShardedMRUCache<int, std::string, StringCost> StringCache;
+
+// Puts and gets keys of its own and of the other threads.
+class CacheThread : public SimpleThread {
+ public:
+  CacheThread(StringCache* cache, int id)
+      : SimpleThread("CacheThread"), cache_(cache), id_(id) {}
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < 10000; ++i) {
+      int key = (i * 7 + id_) % 500;
+      std::string payload;
+      if (cache_->Get(key, &payload))
+        EXPECT_EQ(std::string(key % 10 + 1, 'a' + key % 26), payload);
+      else
+        cache_->Put(key, std::string(key % 10 + 1, 'a' + key % 26));
+      if (i % 100 == id_)
+        cache_->Erase(key);
+    }
+  }
+
+ private:
+  StringCache* cache_;
+  int id_;
+
+  DISALLOW_COPY_AND_ASSIGN(CacheThread);
+};
+
+}  // namespace
+
+TEST(ShardedMRUCacheTest, Basic) {
+  ShardedMRUCache<int, int> cache(100, 4, "");
+  EXPECT_EQ(25u, cache.max_shard_cost());
+
+  int payload = 0;
+  EXPECT_FALSE(cache.Get(1, &payload));
+  EXPECT_TRUE(cache.Put(1, 10));
+  EXPECT_TRUE(cache.Put(2, 20));
+  EXPECT_TRUE(cache.Get(1, &payload));
+  EXPECT_EQ(10, payload);
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(2u, cache.cost());
+
+  // Replacing keeps one entry.
+  EXPECT_TRUE(cache.Put(1, 11));
+  EXPECT_TRUE(cache.Get(1, &payload));
+  EXPECT_EQ(11, payload);
+  EXPECT_EQ(2u, cache.size());
+
+  EXPECT_TRUE(cache.Erase(2));
+  EXPECT_FALSE(cache.Erase(2));
+  EXPECT_FALSE(cache.Get(2, &payload));
+  EXPECT_EQ(1u, cache.size());
+
+  ShardedMRUCacheStats stats = cache.GetStats();
+  EXPECT_EQ(2, stats.hits);
+  EXPECT_EQ(2, stats.misses);
+  EXPECT_EQ(0, stats.evictions);
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_EQ(0u, cache.cost());
+  EXPECT_FALSE(cache.Get(1, &payload));
+  EXPECT_EQ(2, cache.GetStats().hits);
+}
+
+TEST(ShardedMRUCacheTest, EvictByCost) {
+  StringCache cache(10, 1, "");
+
+  EXPECT_TRUE(cache.Put(1, "aaa"));
+  EXPECT_TRUE(cache.Put(2, "bbb"));
+  EXPECT_TRUE(cache.Put(3, "ccc"));
+  EXPECT_EQ(9u, cache.cost());
+
+  // Touch 1 so that 2 is the least recently used, and make room for four
+  // more.
+  std::string payload;
+  EXPECT_TRUE(cache.Get(1, &payload));
+  EXPECT_TRUE(cache.Put(4, "dddd"));
+  EXPECT_FALSE(cache.Get(2, &payload));
+  EXPECT_TRUE(cache.Get(3, &payload));
+  EXPECT_TRUE(cache.Get(1, &payload));
+  EXPECT_TRUE(cache.Get(4, &payload));
+  EXPECT_EQ("dddd", payload);
+  EXPECT_EQ(10u, cache.cost());
+  EXPECT_EQ(1, cache.GetStats().evictions);
+
+  // Growing an entry in place can push out others too.
+  EXPECT_TRUE(cache.Put(4, "ddddddd"));
+  EXPECT_FALSE(cache.Get(3, &payload));
+  EXPECT_EQ(10u, cache.cost());
+  EXPECT_TRUE(cache.Put(4, "dddddddd"));
+  EXPECT_FALSE(cache.Get(1, &payload));
+  EXPECT_EQ(8u, cache.cost());
+  EXPECT_EQ(3, cache.GetStats().evictions);
+
+  // What could never fit is not cached, and takes out the old payload.
+  EXPECT_FALSE(cache.Put(4, "eeeeeeeeeee"));
+  EXPECT_FALSE(cache.Get(4, &payload));
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_EQ(0u, cache.cost());
+}
+
+TEST(ShardedMRUCacheTest, EvictToCost) {
+  StringCache cache(12, 2, "");
+  EXPECT_TRUE(cache.Put(0, "aa"));
+  EXPECT_TRUE(cache.Put(2, "cc"));
+  EXPECT_TRUE(cache.Put(4, "ee"));
+  EXPECT_TRUE(cache.Put(1, "bbb"));
+  std::string payload;
+  EXPECT_TRUE(cache.Get(0, &payload));
+  EXPECT_EQ(9u, cache.cost());
+
+  // Each shard keeps its most recently used entries within its share.
+  cache.EvictToCost(8);
+  EXPECT_TRUE(cache.Get(0, &payload));
+  EXPECT_TRUE(cache.Get(4, &payload));
+  EXPECT_FALSE(cache.Get(2, &payload));
+  EXPECT_TRUE(cache.Get(1, &payload));
+  EXPECT_EQ(7u, cache.cost());
+  EXPECT_EQ(1, cache.GetStats().evictions);
+
+  // The cache may fill up to its own limit again.
+  EXPECT_TRUE(cache.Put(2, "cc"));
+  EXPECT_EQ(9u, cache.cost());
+
+  cache.EvictToCost(0);
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_EQ(5, cache.GetStats().evictions);
+}
+
+TEST(ShardedMRUCacheTest, Threads) {
+  StringCache cache(1000, 8, "");
+  const int kThreads = 8;
+  CacheThread* threads[kThreads];
+  for (int i = 0; i < kThreads; ++i) {
+    threads[i] = new CacheThread(&cache, i);
+    threads[i]->Start();
+  }
+  for (int i = 0; i < kThreads; ++i) {
+    threads[i]->Join();
+    delete threads[i];
+  }
+
+  EXPECT_LE(cache.cost(), 1000u);
+  ShardedMRUCacheStats stats = cache.GetStats();
+  EXPECT_EQ(kThreads * 10000, stats.hits + stats.misses);
+  EXPECT_GT(stats.hits, 0);
+  EXPECT_GT(stats.evictions, 0);
+}
+
+TEST(ShardedMRUCacheTest, StatsCounters) {
+  const std::string kTableName = "ShardedMRUCacheStatsTable";
+  SharedMemory().Delete(kTableName);
+  StatsTable table(kTableName, 2, 10);
+  StatsTable::set_current(&table);
+  {
+    ShardedMRUCache<int, int> cache(1, 1, "TestCache");
+    int payload;
+    cache.Put(1, 1);
+    cache.Get(1, &payload);
+    cache.Get(1, &payload);
+    cache.Get(2, &payload);
+    cache.Put(2, 2);
+    EXPECT_EQ(2, table.GetCounterValue("c:TestCache.Hits"));
+    EXPECT_EQ(1, table.GetCounterValue("c:TestCache.Misses"));
+    EXPECT_EQ(1, table.GetCounterValue("c:TestCache.Evictions"));
+  }
+  StatsTable::set_current(NULL);
+  SharedMemory().Delete(kTableName);
+}
+
+}  // namespace base
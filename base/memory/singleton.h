@@ -23,6 +23,7 @@
 #include "base/at_exit.h"
 #include "base/atomicops.h"
 #include "base/base_export.h"
+#include "base/debug/initialization_profiler_internal.h"
 #include "base/memory/aligned_memory.h"
 #include "base/third_party/dynamic_annotations/dynamic_annotations.h"
 #include "base/threading/thread_restrictions.h"
@@ -242,6 +243,7 @@ class Singleton {
       // instance_ was NULL and is now kBeingCreatedMarker.  Only one thread
       // will ever get here.  Threads might be spinning on us, and they will
       // stop right after we do this store.
+      int64 start = base::debug::internal::InitializationTimerStart();
       Type* newval = Traits::New();
 
       // This annotation helps race detectors recognize correct lock-less
@@ -254,6 +256,11 @@ class Singleton {
       if (newval != NULL && Traits::kRegisterAtExit)
         base::AtExitManager::RegisterCallback(OnExit, NULL);
 
+      if (newval != NULL) {
+        base::debug::internal::RecordConstruction(
+            start, &instance_,
+            base::debug::internal::InitializationSignature<Type>());
+      }
       return newval;
     }
 
@@ -271,9 +278,11 @@ class Singleton {
   static void OnExit(void* /*unused*/) {
     // AtExit should only ever be register after the singleton instance was
     // created.  We should only ever get here with a valid instance_ pointer.
+    int64 start = base::debug::internal::InitializationTimerStart();
     Traits::Delete(
         reinterpret_cast<Type*>(base::subtle::NoBarrier_Load(&instance_)));
     instance_ = 0;
+    base::debug::internal::RecordDestruction(start, &instance_);
   }
   static base::subtle::AtomicWord instance_;
 };
@@ -7,7 +7,16 @@
 namespace base {
 namespace internal {
 
-WeakReference::Flag::Flag() : is_valid_(true) {
+WeakReference::Flag::Flag(bool thread_safe)
+    : thread_safe_(thread_safe),
+      ref_count_(0),
+      is_valid_(true) {
+}
+
+bool WeakReference::Flag::HasOneRef() const {
+  if (thread_safe_)
+    return AtomicRefCountIsOne(&ref_count_);
+  return ref_count_ == 1;
 }
 
 void WeakReference::Flag::Invalidate() {
@@ -38,7 +47,8 @@ bool WeakReference::is_valid() const {
   return flag_ && flag_->IsValid();
 }
 
-WeakReferenceOwner::WeakReferenceOwner() {
+WeakReferenceOwner::WeakReferenceOwner(bool thread_safe)
+    : thread_safe_(thread_safe) {
 }
 
 WeakReferenceOwner::~WeakReferenceOwner() {
@@ -49,7 +59,7 @@ WeakReference WeakReferenceOwner::GetRef() const {
   // We also want to reattach to the current thread if all previous references
   // have gone away.
   if (!HasRefs())
-    flag_ = new WeakReference::Flag();
+    flag_ = new WeakReference::Flag(thread_safe_);
   return WeakReference(flag_);
 }
 
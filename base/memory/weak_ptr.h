@@ -15,6 +15,12 @@
 // Since a WeakPtr object may be destroyed on a background thread,
 // querying WeakPtrFactory's HasWeakPtrs() method can be racy.
 //
+// That is why each copy of a WeakPtr counts its reference atomically.  Where
+// the weak pointers never leave their thread, not even to be destroyed, use
+// SingleThreadWeakPtrFactory or SupportsSingleThreadWeakPtr instead: their
+// weak pointers count references with plain increments, and debug builds
+// check that they stay on their thread.
+//
 //
 // A common alternative to weak pointers is to have the shared object hold a
 // list of all referrers, and then when the shared object is destroyed, it
@@ -60,6 +66,7 @@
 #pragma once
 
 #include "base/basictypes.h"
+#include "base/atomic_ref_count.h"
 #include "base/base_export.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
@@ -78,10 +85,36 @@ namespace internal {
 class BASE_EXPORT WeakReference {
  public:
   // While Flag is bound to a specific thread, it may be deleted from another
-  // via base::WeakPtr::~WeakPtr().
-  class Flag : public RefCountedThreadSafe<Flag> {
+  // via base::WeakPtr::~WeakPtr(), unless it is not |thread_safe|: then all
+  // its references are counted on its thread, without atomic operations.
+  class BASE_EXPORT Flag {
    public:
-    Flag();
+    explicit Flag(bool thread_safe);
+
+    void AddRef() const {
+      if (thread_safe_) {
+        AtomicRefCountInc(&ref_count_);
+      } else {
+        DCHECK(thread_checker_.CalledOnValidThread());
+        ++ref_count_;
+      }
+    }
+
+    void Release() const {
+      bool last;
+      if (thread_safe_) {
+        last = !AtomicRefCountDec(&ref_count_);
+      } else {
+        // The owner may drop the last reference from anywhere, as in
+        // Invalidate().
+        DCHECK(thread_checker_.CalledOnValidThread() || ref_count_ == 1);
+        last = --ref_count_ == 0;
+      }
+      if (last)
+        delete this;
+    }
+
+    bool HasOneRef() const;
 
     void Invalidate();
     bool IsValid() const;
@@ -89,12 +122,14 @@ class BASE_EXPORT WeakReference {
     void DetachFromThread() { thread_checker_.DetachFromThread(); }
 
    private:
-    friend class base::RefCountedThreadSafe<Flag>;
-
     ~Flag();
 
+    const bool thread_safe_;
+    mutable AtomicRefCount ref_count_;
     ThreadChecker thread_checker_;
     bool is_valid_;
+
+    DISALLOW_COPY_AND_ASSIGN(Flag);
   };
 
   WeakReference();
@@ -109,7 +144,9 @@ class BASE_EXPORT WeakReference {
 
 class BASE_EXPORT WeakReferenceOwner {
  public:
-  WeakReferenceOwner();
+  // The references of an owner that isn't |thread_safe| must all be made and
+  // dropped on one thread.
+  explicit WeakReferenceOwner(bool thread_safe);
   ~WeakReferenceOwner();
 
   WeakReference GetRef() const;
@@ -126,6 +163,7 @@ class BASE_EXPORT WeakReferenceOwner {
   }
 
  private:
+  const bool thread_safe_;
   mutable scoped_refptr<WeakReference::Flag> flag_;
 };
 
@@ -240,7 +278,7 @@ class WeakPtr : public internal::WeakPtrBase {
 template <class T>
 class SupportsWeakPtr : public internal::SupportsWeakPtrBase {
  public:
-  SupportsWeakPtr() {}
+  SupportsWeakPtr() : weak_reference_owner_(true) {}
 
   WeakPtr<T> AsWeakPtr() {
     return WeakPtr<T>(weak_reference_owner_.GetRef(), static_cast<T*>(this));
@@ -251,11 +289,28 @@ class SupportsWeakPtr : public internal::SupportsWeakPtrBase {
     weak_reference_owner_.DetachFromThread();
   }
 
+ protected:
+  explicit SupportsWeakPtr(bool thread_safe)
+      : weak_reference_owner_(thread_safe) {
+  }
+
  private:
   internal::WeakReferenceOwner weak_reference_owner_;
   DISALLOW_COPY_AND_ASSIGN(SupportsWeakPtr);
 };
 
+// As SupportsWeakPtr, for a class whose weak pointers are only ever copied,
+// used and destroyed on the thread they were made on.  That lets the weak
+// pointers count their references without atomic operations.
+template <class T>
+class SupportsSingleThreadWeakPtr : public SupportsWeakPtr<T> {
+ public:
+  SupportsSingleThreadWeakPtr() : SupportsWeakPtr<T>(false) {}
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SupportsSingleThreadWeakPtr);
+};
+
 // Helper function that uses type deduction to safely return a WeakPtr<Derived>
 // when Derived doesn't directly extend SupportsWeakPtr<Derived>, instead it
 // extends a Base that extends SupportsWeakPtr<Base>.
@@ -287,7 +342,7 @@ WeakPtr<Derived> AsWeakPtr(Derived* t) {
 template <class T>
 class WeakPtrFactory {
  public:
-  explicit WeakPtrFactory(T* ptr) : ptr_(ptr) {
+  explicit WeakPtrFactory(T* ptr) : weak_reference_owner_(true), ptr_(ptr) {
   }
 
   ~WeakPtrFactory() {
@@ -317,12 +372,32 @@ class WeakPtrFactory {
     weak_reference_owner_.DetachFromThread();
   }
 
+ protected:
+  WeakPtrFactory(T* ptr, bool thread_safe)
+      : weak_reference_owner_(thread_safe), ptr_(ptr) {
+  }
+
  private:
   internal::WeakReferenceOwner weak_reference_owner_;
   T* ptr_;
   DISALLOW_IMPLICIT_CONSTRUCTORS(WeakPtrFactory);
 };
 
+// As WeakPtrFactory, for weak pointers that are only ever copied, used and
+// destroyed on the thread they were made on, such as the ones a UI object
+// binds into the callbacks it posts to its own thread.  They count their
+// references without atomic operations; debug builds check that they stay
+// on their thread.  DetachFromThread() still moves them all to another.
+template <class T>
+class SingleThreadWeakPtrFactory : public WeakPtrFactory<T> {
+ public:
+  explicit SingleThreadWeakPtrFactory(T* ptr) : WeakPtrFactory<T>(ptr, false) {
+  }
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(SingleThreadWeakPtrFactory);
+};
+
 }  // namespace base
 
 #endif  // BASE_MEMORY_WEAK_PTR_H_
@@ -44,6 +44,15 @@ struct Producer : SupportsWeakPtr<Producer> {};
 struct DerivedProducer : Producer {};
 struct Consumer { WeakPtr<Producer> producer; };
 
+struct SingleThreadProducer
+    : SupportsSingleThreadWeakPtr<SingleThreadProducer> {
+};
+struct DerivedSingleThreadProducer : SingleThreadProducer {};
+
+int* GetPointer(const WeakPtr<int>& ptr) {
+  return ptr.get();
+}
+
 // Helper class to create and destroy weak pointer copies
 // and delete objects on a background thread.
 class BackgroundThread : public Thread {
@@ -230,6 +239,54 @@ TEST(WeakPtrTest, HasWeakPtrs) {
   EXPECT_FALSE(factory.HasWeakPtrs());
 }
 
+TEST(WeakPtrTest, SingleThreadWeakPtrFactory) {
+  int data;
+  SingleThreadWeakPtrFactory<int> factory(&data);
+  EXPECT_FALSE(factory.HasWeakPtrs());
+  {
+    WeakPtr<int> ptr = factory.GetWeakPtr();
+    WeakPtr<int> copy = ptr;
+    Callback<int*(void)> bound = Bind(&GetPointer, copy);
+    EXPECT_EQ(&data, bound.Run());
+    EXPECT_TRUE(factory.HasWeakPtrs());
+    factory.InvalidateWeakPtrs();
+    EXPECT_TRUE(ptr.get() == NULL);
+    EXPECT_TRUE(copy.get() == NULL);
+    EXPECT_TRUE(bound.Run() == NULL);
+    EXPECT_FALSE(factory.HasWeakPtrs());
+
+    ptr = factory.GetWeakPtr();
+    EXPECT_EQ(&data, ptr.get());
+  }
+  EXPECT_FALSE(factory.HasWeakPtrs());
+}
+
+TEST(WeakPtrTest, SupportsSingleThreadWeakPtr) {
+  WeakPtr<DerivedSingleThreadProducer> ptr;
+  {
+    DerivedSingleThreadProducer f;
+    ptr = AsWeakPtr(&f);
+    EXPECT_EQ(&f, ptr.get());
+  }
+  EXPECT_TRUE(ptr.get() == NULL);
+}
+
+TEST(WeakPtrTest, SingleThreadOwnerOnOtherThread) {
+  // An object with single-thread weak pointers may still be made and
+  // destroyed on another thread, as long as its weak pointers are not.
+  scoped_ptr<SingleThreadProducer> producer(
+      OffThreadObjectCreator<SingleThreadProducer>::NewObject());
+  {
+    WeakPtr<SingleThreadProducer> ptr = producer->AsWeakPtr();
+    EXPECT_EQ(producer.get(), ptr.get());
+  }
+  producer->DetachFromThread();
+  Thread thread("deleter_thread");
+  thread.Start();
+  thread.message_loop()->DeleteSoon(FROM_HERE, producer.release());
+  thread.Stop();
+}
+
 TEST(WeakPtrTest, SingleThreaded1) {
   // Test that it is OK to create a class that supports weak references on one
   // thread, but use it on another.  This tests that we do not trip runtime
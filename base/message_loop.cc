@@ -25,7 +25,9 @@
 #if defined(OS_MACOSX)
 #include "base/message_pump_mac.h"
 #endif
-#if defined(OS_POSIX)
+#if defined(USE_EPOLL_MESSAGE_PUMP)
+#include "base/message_pump_epoll.h"
+#elif defined(OS_POSIX)
 #include "base/message_pump_libevent.h"
 #endif
 #if defined(OS_ANDROID)
@@ -87,8 +89,14 @@ const base::LinearHistogram::DescriptionPair event_descriptions_[] = {
 
 bool enable_histogrammer_ = false;
 
+bool enable_lock_free_incoming_queue_ = false;
+
 MessageLoop::MessagePumpFactory* message_pump_for_ui_factory_ = NULL;
 
+// A lane with work gets the next turn once this many tasks in a row came from
+// more urgent lanes.
+const int kMaxTasksPassedOver = 8;
+
 }  // namespace
 
 //------------------------------------------------------------------------------
@@ -129,8 +137,14 @@ MessageLoop::DestructionObserver::~DestructionObserver() {
 MessageLoop::MessageLoop(Type type)
     : type_(type),
       nestable_tasks_allowed_(true),
+      current_pending_task_(NULL),
       exception_restoration_(false),
       message_histogram_(NULL),
+      queueing_delay_histogram_(NULL),
+      run_time_histogram_(NULL),
+      delayed_task_lateness_histogram_(NULL),
+      has_priority_incoming_tasks_(0),
+      use_lock_free_incoming_queue_(enable_lock_free_incoming_queue_),
       state_(NULL),
 #ifdef OS_WIN
       os_modal_loop_(false),
@@ -139,6 +153,9 @@ MessageLoop::MessageLoop(Type type)
   DCHECK(!current()) << "should only have one message loop per thread";
   lazy_tls_ptr.Pointer()->Set(this);
 
+  for (int i = 0; i < base::TASK_PRIORITY_COUNT; ++i)
+    tasks_passed_over_[i] = 0;
+
   message_loop_proxy_ = new base::MessageLoopProxyImpl();
   thread_task_runner_handle_.reset(
       new base::ThreadTaskRunnerHandle(message_loop_proxy_));
@@ -159,7 +176,11 @@ MessageLoop::MessageLoop(Type type)
 #define MESSAGE_PUMP_IO new base::MessagePumpDefault();
 #elif defined(OS_POSIX)  // POSIX but not MACOSX.
 #define MESSAGE_PUMP_UI new base::MessagePumpForUI()
+#if defined(USE_EPOLL_MESSAGE_PUMP)
+#define MESSAGE_PUMP_IO new base::MessagePumpEpoll()
+#else
 #define MESSAGE_PUMP_IO new base::MessagePumpLibevent()
+#endif
 #else
 #error Not implemented
 #endif
@@ -191,6 +212,7 @@ MessageLoop::~MessageLoop() {
   bool did_work;
   for (int i = 0; i < 100; ++i) {
     DeletePendingTasks();
+    ReloadPriorityWorkQueues();
     ReloadWorkQueue();
     // If we end up with empty queues, then break out of the loop.
     did_work = DeletePendingTasks();
@@ -237,6 +259,11 @@ void MessageLoop::EnableHistogrammer(bool enable) {
   enable_histogrammer_ = enable;
 }
 
+// static
+void MessageLoop::EnableLockFreeIncomingQueue(bool enable) {
+  enable_lock_free_incoming_queue_ = enable;
+}
+
 // static
 void MessageLoop::InitMessagePumpForUIFactory(MessagePumpFactory* factory) {
   DCHECK(!message_pump_for_ui_factory_);
@@ -302,6 +329,77 @@ void MessageLoop::PostNonNestableDelayedTask(
   PostNonNestableDelayedTask(from_here, task, delay.InMillisecondsRoundedUp());
 }
 
+void MessageLoop::PostTasks(
+    const tracked_objects::Location& from_here,
+    const std::vector<base::Closure>& tasks) {
+  PostTaskBatch(from_here, tasks, true);
+}
+
+void MessageLoop::PostNonNestableTasks(
+    const tracked_objects::Location& from_here,
+    const std::vector<base::Closure>& tasks) {
+  PostTaskBatch(from_here, tasks, false);
+}
+
+void MessageLoop::PostTaskWithPriority(
+    const tracked_objects::Location& from_here,
+    const base::Closure& task,
+    base::TaskPriority priority) {
+  DCHECK(!task.is_null()) << from_here.ToString();
+  DCHECK_GE(priority, 0);
+  DCHECK_LT(priority, base::TASK_PRIORITY_COUNT);
+  if (priority == base::TASK_PRIORITY_NORMAL) {
+    PostTask(from_here, task);
+    return;
+  }
+
+  PendingTask pending_task(from_here, task, CalculateDelayedRuntime(0), true);
+  pending_task.priority = priority;
+  scoped_refptr<base::MessagePump> pump;
+  {
+    base::AutoLock locked(incoming_queue_lock_);
+    bool was_empty = priority_incoming_queue_.empty();
+    priority_incoming_queue_.push(pending_task);
+    pending_task.task.Reset();
+    base::subtle::Release_Store(&has_priority_incoming_tasks_, 1);
+    if (!was_empty)
+      return;  // Someone else should have started the sub-pump.
+
+    pump = pump_;
+  }
+  // As in AddBatchToIncomingQueue(), |this| may be gone by now.
+  pump->ScheduleWork();
+}
+
+int MessageLoop::PostCancelableDelayedTask(
+    const tracked_objects::Location& from_here,
+    const base::Closure& task,
+    base::TimeDelta delay) {
+  DCHECK_EQ(this, current());
+  DCHECK(!task.is_null()) << from_here.ToString();
+  TimeTicks delayed_run_time =
+      CalculateDelayedRuntime(delay.InMillisecondsRoundedUp());
+  // A null run time would mean "run now" to DoWork, but this task goes
+  // straight to the delayed work queue, which needs a real time.
+  if (delayed_run_time.is_null())
+    delayed_run_time = TimeTicks::Now();
+  PendingTask pending_task(from_here, task, delayed_run_time, true);
+
+  // We are on the loop's thread, so there's no need to go through the incoming
+  // queue.
+  int delayed_task_id = AddToDelayedWorkQueue(pending_task);
+  if (delayed_work_queue_.top().sequence_num == delayed_task_id)
+    pump_->ScheduleDelayedWork(delayed_run_time);
+  return delayed_task_id;
+}
+
+void MessageLoop::CancelDelayedTask(int delayed_task_id) {
+  DCHECK_EQ(this, current());
+  // The pump may wake up early for a canceled task; DoDelayedWork copes with
+  // that by rescheduling for the new top of the queue.
+  delayed_work_queue_.Remove(delayed_task_id);
+}
+
 void MessageLoop::Run() {
   AutoRunState save_state(this);
   RunHandler();
@@ -370,6 +468,10 @@ void MessageLoop::RemoveTaskObserver(TaskObserver* task_observer) {
 
 void MessageLoop::AssertIdle() const {
   // We only check |incoming_queue_|, since we don't want to lock |work_queue_|.
+  if (use_lock_free_incoming_queue_) {
+    DCHECK(lock_free_incoming_queue_.IsEmpty());
+    return;
+  }
   base::AutoLock lock(incoming_queue_lock_);
   DCHECK(incoming_queue_.empty());
 }
@@ -412,6 +514,7 @@ void MessageLoop::RunInternal() {
   DCHECK_EQ(this, current());
 
   StartHistogrammer();
+  StartTaskHistograms();
 
 #if !defined(OS_MACOSX) && !defined(OS_ANDROID)
   if (state_->dispatcher && type() == TYPE_UI) {
@@ -460,14 +563,41 @@ void MessageLoop::RunTask(const PendingTask& pending_task) {
   tracked_objects::TrackedTime start_time =
       tracked_objects::ThreadData::NowForStartOfRun(pending_task.birth_tally);
 
+  // Held in a local in case the task runs a nested loop that starts the
+  // histograms.
+  base::Histogram* run_time_histogram = run_time_histogram_;
+  TimeTicks start_ticks;
+  if (run_time_histogram) {
+    start_ticks = TimeTicks::NowFast();
+    if (pending_task.delayed_run_time.is_null()) {
+      queueing_delay_histogram_->AddTime(
+          start_ticks - pending_task.time_posted);
+    } else {
+      // The delayed run time comes from Now(), which NowFast() may be a
+      // millisecond off from; don't mix the two clocks.
+      delayed_task_lateness_histogram_->AddTime(
+          TimeTicks::Now() - pending_task.delayed_run_time);
+    }
+  }
+
+  const PendingTask* outer_pending_task = current_pending_task_;
+  current_pending_task_ = &pending_task;
   FOR_EACH_OBSERVER(TaskObserver, task_observers_,
                     WillProcessTask(pending_task.time_posted));
   pending_task.task.Run();
   FOR_EACH_OBSERVER(TaskObserver, task_observers_,
                     DidProcessTask(pending_task.time_posted));
+  current_pending_task_ = outer_pending_task;
+
+  if (run_time_histogram)
+    run_time_histogram->AddTime(TimeTicks::NowFast() - start_ticks);
 
-  tracked_objects::ThreadData::TallyRunOnNamedThreadIfTracking(pending_task,
-      start_time, tracked_objects::ThreadData::NowForEndOfRun());
+  // Tasks that the profiler did not sample have no birth tally; skip reading
+  // the clock for them.
+  if (pending_task.birth_tally) {
+    tracked_objects::ThreadData::TallyRunOnNamedThreadIfTracking(pending_task,
+        start_time, tracked_objects::ThreadData::NowForEndOfRun());
+  }
 
   nestable_tasks_allowed_ = true;
 }
@@ -486,14 +616,15 @@ bool MessageLoop::DeferOrRunPendingTask(const PendingTask& pending_task) {
   return false;
 }
 
-void MessageLoop::AddToDelayedWorkQueue(const PendingTask& pending_task) {
+int MessageLoop::AddToDelayedWorkQueue(const PendingTask& pending_task) {
   // Move to the delayed work queue.  Initialize the sequence number
   // before inserting into the delayed_work_queue_.  The sequence number
   // is used to faciliate FIFO sorting when two tasks have the same
-  // delayed_run_time value.
+  // delayed_run_time value, and to identify the task for removal.
   PendingTask new_pending_task(pending_task);
   new_pending_task.sequence_num = next_sequence_num_++;
   delayed_work_queue_.push(new_pending_task);
+  return new_pending_task.sequence_num;
 }
 
 void MessageLoop::ReloadWorkQueue() {
@@ -504,6 +635,11 @@ void MessageLoop::ReloadWorkQueue() {
   if (!work_queue_.empty())
     return;  // Wait till we *really* need to lock and load.
 
+  if (use_lock_free_incoming_queue_) {
+    lock_free_incoming_queue_.TakeAll(&work_queue_);
+    return;
+  }
+
   // Acquire all we can from the inter-thread queue with one lock acquisition.
   {
     base::AutoLock lock(incoming_queue_lock_);
@@ -514,6 +650,49 @@ void MessageLoop::ReloadWorkQueue() {
   }
 }
 
+void MessageLoop::ReloadPriorityWorkQueues() {
+  if (!base::subtle::Acquire_Load(&has_priority_incoming_tasks_))
+    return;
+
+  base::TaskQueue incoming;
+  {
+    base::AutoLock lock(incoming_queue_lock_);
+    priority_incoming_queue_.Swap(&incoming);
+    base::subtle::NoBarrier_Store(&has_priority_incoming_tasks_, 0);
+  }
+  while (!incoming.empty()) {
+    GetWorkQueue(incoming.front().priority)->push(incoming.front());
+    incoming.pop();
+  }
+}
+
+base::TaskQueue* MessageLoop::GetWorkQueue(base::TaskPriority priority) {
+  if (priority == base::TASK_PRIORITY_NORMAL)
+    return &work_queue_;
+  return &priority_work_queues_[priority];
+}
+
+base::TaskQueue* MessageLoop::SelectWorkQueue() {
+  // The most urgent lane with work goes first, unless a less urgent one has
+  // waited long enough.
+  int selected = -1;
+  for (int i = 0; i < base::TASK_PRIORITY_IDLE; ++i) {
+    if (GetWorkQueue(static_cast<base::TaskPriority>(i))->empty())
+      continue;
+    if (selected == -1 || tasks_passed_over_[i] >= kMaxTasksPassedOver)
+      selected = i;
+  }
+  if (selected == -1)
+    return NULL;
+
+  for (int i = selected + 1; i < base::TASK_PRIORITY_IDLE; ++i) {
+    if (!GetWorkQueue(static_cast<base::TaskPriority>(i))->empty())
+      tasks_passed_over_[i]++;
+  }
+  tasks_passed_over_[selected] = 0;
+  return GetWorkQueue(static_cast<base::TaskPriority>(selected));
+}
+
 bool MessageLoop::DeletePendingTasks() {
   bool did_work = !work_queue_.empty();
   while (!work_queue_.empty()) {
@@ -526,6 +705,11 @@ bool MessageLoop::DeletePendingTasks() {
       AddToDelayedWorkQueue(pending_task);
     }
   }
+  for (int i = 0; i < base::TASK_PRIORITY_COUNT; ++i) {
+    did_work |= !priority_work_queues_[i].empty();
+    while (!priority_work_queues_[i].empty())
+      priority_work_queues_[i].pop();
+  }
   did_work |= !deferred_non_nestable_work_queue_.empty();
   while (!deferred_non_nestable_work_queue_.empty()) {
     deferred_non_nestable_work_queue_.pop();
@@ -584,17 +768,35 @@ TimeTicks MessageLoop::CalculateDelayedRuntime(int64 delay_ms) {
 
 // Possibly called on a background thread!
 void MessageLoop::AddToIncomingQueue(PendingTask* pending_task) {
+  AddBatchToIncomingQueue(pending_task, 1);
+}
+
+// Possibly called on a background thread!
+void MessageLoop::AddBatchToIncomingQueue(PendingTask* pending_tasks,
+                                          size_t count) {
   // Warning: Don't try to short-circuit, and handle this thread's tasks more
   // directly, as it could starve handling of foreign threads.  Put every task
   // into this queue.
 
   scoped_refptr<base::MessagePump> pump;
+  if (use_lock_free_incoming_queue_) {
+    // There is no lock to keep |this| alive: the task may run, and destroy
+    // this message loop, as soon as it has been pushed.  Take the reference
+    // to the pump first.
+    pump = pump_;
+    if (lock_free_incoming_queue_.PushBatch(pending_tasks, count))
+      pump->ScheduleWork();
+    return;
+  }
+
   {
     base::AutoLock locked(incoming_queue_lock_);
 
     bool was_empty = incoming_queue_.empty();
-    incoming_queue_.push(*pending_task);
-    pending_task->task.Reset();
+    for (size_t i = 0; i < count; ++i) {
+      incoming_queue_.push(pending_tasks[i]);
+      pending_tasks[i].task.Reset();
+    }
     if (!was_empty)
       return;  // Someone else should have started the sub-pump.
 
@@ -608,6 +810,21 @@ void MessageLoop::AddToIncomingQueue(PendingTask* pending_task) {
   pump->ScheduleWork();
 }
 
+void MessageLoop::PostTaskBatch(const tracked_objects::Location& from_here,
+                                const std::vector<base::Closure>& tasks,
+                                bool nestable) {
+  if (tasks.empty())
+    return;
+  std::vector<PendingTask> pending_tasks;
+  pending_tasks.reserve(tasks.size());
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    DCHECK(!tasks[i].is_null()) << from_here.ToString();
+    pending_tasks.push_back(PendingTask(
+        from_here, tasks[i], CalculateDelayedRuntime(0), nestable));
+  }
+  AddBatchToIncomingQueue(&pending_tasks[0], pending_tasks.size());
+}
+
 //------------------------------------------------------------------------------
 // Method and data for histogramming events and actions taken by each instance
 // on each thread.
@@ -630,6 +847,27 @@ void MessageLoop::HistogramEvent(int event) {
     message_histogram_->Add(event);
 }
 
+void MessageLoop::StartTaskHistograms() {
+  if (run_time_histogram_ || thread_name_.empty() ||
+      !base::StatisticsRecorder::IsActive()) {
+    return;
+  }
+  // Same layout as UMA_HISTOGRAM_TIMES.
+  const TimeDelta kMin = TimeDelta::FromMilliseconds(1);
+  const TimeDelta kMax = TimeDelta::FromSeconds(10);
+  const size_t kBucketCount = 50;
+  queueing_delay_histogram_ = base::Histogram::FactoryTimeGet(
+      "MessageLoop.QueueingDelay." + thread_name_, kMin, kMax, kBucketCount,
+      base::Histogram::kUmaTargetedHistogramFlag);
+  delayed_task_lateness_histogram_ = base::Histogram::FactoryTimeGet(
+      "MessageLoop.DelayedTaskLateness." + thread_name_, kMin, kMax,
+      kBucketCount, base::Histogram::kUmaTargetedHistogramFlag);
+  // Set last, as RunTask() goes by it.
+  run_time_histogram_ = base::Histogram::FactoryTimeGet(
+      "MessageLoop.RunTime." + thread_name_, kMin, kMax, kBucketCount,
+      base::Histogram::kUmaTargetedHistogramFlag);
+}
+
 bool MessageLoop::DoWork() {
   if (!nestable_tasks_allowed_) {
     // Task can't be executed right now.
@@ -637,24 +875,31 @@ bool MessageLoop::DoWork() {
   }
 
   for (;;) {
+    ReloadPriorityWorkQueues();
     ReloadWorkQueue();
-    if (work_queue_.empty())
-      break;
 
-    // Execute oldest task.
-    do {
+    // Delayed tasks pass through work_queue_ on their way to
+    // delayed_work_queue_.  Move them along first, so that they never count
+    // as work in the normal lane.
+    if (!work_queue_.empty() &&
+        !work_queue_.front().delayed_run_time.is_null()) {
       PendingTask pending_task = work_queue_.front();
       work_queue_.pop();
-      if (!pending_task.delayed_run_time.is_null()) {
-        AddToDelayedWorkQueue(pending_task);
-        // If we changed the topmost task, then it is time to reschedule.
-        if (delayed_work_queue_.top().task.Equals(pending_task.task))
-          pump_->ScheduleDelayedWork(pending_task.delayed_run_time);
-      } else {
-        if (DeferOrRunPendingTask(pending_task))
-          return true;
-      }
-    } while (!work_queue_.empty());
+      int sequence_num = AddToDelayedWorkQueue(pending_task);
+      // If we changed the topmost task, then it is time to reschedule.
+      if (delayed_work_queue_.top().sequence_num == sequence_num)
+        pump_->ScheduleDelayedWork(pending_task.delayed_run_time);
+      continue;
+    }
+
+    // Execute the oldest task of the chosen lane.
+    base::TaskQueue* queue = SelectWorkQueue();
+    if (!queue)
+      break;
+    PendingTask pending_task = queue->front();
+    queue->pop();
+    if (DeferOrRunPendingTask(pending_task))
+      return true;
   }
 
   // Nothing happened.
@@ -696,6 +941,19 @@ bool MessageLoop::DoIdleWork() {
   if (ProcessNextDelayedNonNestableTask())
     return true;
 
+  // The pump only gets here once DoWork() and DoDelayedWork() found nothing
+  // to do, which is when the idle lane gets to run.
+  if (nestable_tasks_allowed_) {
+    ReloadPriorityWorkQueues();
+    base::TaskQueue* idle_queue = GetWorkQueue(base::TASK_PRIORITY_IDLE);
+    if (!idle_queue->empty()) {
+      PendingTask pending_task = idle_queue->front();
+      idle_queue->pop();
+      RunTask(pending_task);
+      return true;
+    }
+  }
+
   if (state_->quit_received)
     pump_->Quit();
 
@@ -799,10 +1057,10 @@ bool MessageLoopForIO::WatchFileDescriptor(int fd,
                                            Mode mode,
                                            FileDescriptorWatcher *controller,
                                            Watcher *delegate) {
-  return pump_libevent()->WatchFileDescriptor(
+  return pump_io()->WatchFileDescriptor(
       fd,
       persistent,
-      static_cast<base::MessagePumpLibevent::Mode>(mode),
+      static_cast<MessagePumpForIO::Mode>(mode),
       controller,
       delegate);
 }
@@ -8,11 +8,14 @@
 
 #include <queue>
 #include <string>
+#include <vector>
 
+#include "base/atomicops.h"
 #include "base/base_export.h"
 #include "base/basictypes.h"
 #include "base/callback_forward.h"
 #include "base/location.h"
+#include "base/lock_free_task_queue.h"
 #include "base/memory/ref_counted.h"
 #include "base/message_loop_proxy.h"
 #include "base/message_pump.h"
@@ -20,6 +23,7 @@
 #include "base/pending_task.h"
 #include "base/sequenced_task_runner_helpers.h"
 #include "base/synchronization/lock.h"
+#include "base/task_priority.h"
 #include "base/tracking_info.h"
 #include "base/time.h"
 
@@ -28,7 +32,11 @@
 // really just eliminate.
 #include "base/message_pump_win.h"
 #elif defined(OS_POSIX)
+#if defined(USE_EPOLL_MESSAGE_PUMP)
+#include "base/message_pump_epoll.h"
+#else
 #include "base/message_pump_libevent.h"
+#endif
 #if !defined(OS_MACOSX) && !defined(OS_ANDROID)
 
 #if defined(USE_AURA)
@@ -114,6 +122,13 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
 
   static void EnableHistogrammer(bool enable_histogrammer);
 
+  // When enabled, MessageLoops constructed afterwards collect tasks posted
+  // from other threads in a lock-free multi-producer queue instead of a
+  // lock-protected one.  This removes the contention on
+  // |incoming_queue_lock_| for loops that many threads post to at high rates.
+  // Loops that already exist are not affected.
+  static void EnableLockFreeIncomingQueue(bool enable);
+
   typedef base::MessagePump* (MessagePumpFactory)();
   // Using the given base::MessagePumpForUIFactory to override the default
   // MessagePump implementation for 'TYPE_UI'.
@@ -185,6 +200,43 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
       const base::Closure& task,
       base::TimeDelta delay);
 
+  // Posts all of |tasks|, in order, as if by PostTask or PostNonNestableTask.
+  // The incoming queue is locked once for the whole batch, and the pump is
+  // woken up at most once, which makes these much cheaper than separate calls
+  // for producers that post bursts of tasks.
+  void PostTasks(
+      const tracked_objects::Location& from_here,
+      const std::vector<base::Closure>& tasks);
+
+  void PostNonNestableTasks(
+      const tracked_objects::Location& from_here,
+      const std::vector<base::Closure>& tasks);
+
+  // Posts |task| to the lane for |priority|.  The loop takes its next task
+  // from the most urgent lane that has one, except that a lane which has been
+  // passed over for several tasks in a row gets the next turn, so a burst of
+  // input or display work cannot starve normal tasks.  TASK_PRIORITY_IDLE
+  // tasks only run from DoIdleWork(), once there is no other work.  Tasks
+  // posted this way are nestable, and TASK_PRIORITY_NORMAL is just PostTask().
+  void PostTaskWithPriority(
+      const tracked_objects::Location& from_here,
+      const base::Closure& task,
+      base::TaskPriority priority);
+
+  // Like PostDelayedTask, but returns an id that can be passed to
+  // CancelDelayedTask() to remove the task from the queue before it runs.
+  // Unlike the methods above, this must be called on the thread that runs
+  // this loop.
+  int PostCancelableDelayedTask(
+      const tracked_objects::Location& from_here,
+      const base::Closure& task,
+      base::TimeDelta delay);
+
+  // Removes the task returned by PostCancelableDelayedTask() and deletes it
+  // right away.  Does nothing if the task has already run or been deleted.
+  // Must be called on the thread that runs this loop.
+  void CancelDelayedTask(int delayed_task_id);
+
   // A variant on PostTask that deletes the given object.  This is useful
   // if the object needs to live until the next run of the MessageLoop (for
   // example, deleting a RenderProcessHost from within an IPC callback is not
@@ -245,7 +297,11 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   // Returns the type passed to the constructor.
   Type type() const { return type_; }
 
-  // Optional call to connect the thread name with this loop.
+  // Optional call to connect the thread name with this loop.  A named loop
+  // that starts running while a StatisticsRecorder is active records how long
+  // its tasks wait, run, and, for delayed tasks, how late they start, in the
+  // "MessageLoop.QueueingDelay.<name>", "MessageLoop.RunTime.<name>" and
+  // "MessageLoop.DelayedTaskLateness.<name>" histograms.
   void set_thread_name(const std::string& thread_name) {
     DCHECK(thread_name_.empty()) << "Should not rename this thread!";
     thread_name_ = thread_name;
@@ -360,6 +416,14 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   // Can only be called from the thread that owns the MessageLoop.
   bool is_running() const;
 
+  // Returns where the task being run was posted from, or NULL if no task is
+  // running. Inside a nested loop this is the innermost task. Can only be
+  // called from the thread that owns the MessageLoop, typically by a
+  // TaskObserver.
+  const tracked_objects::Location* current_task_location() const {
+    return current_pending_task_ ? &current_pending_task_->posted_from : NULL;
+  }
+
   //----------------------------------------------------------------------------
  protected:
   struct RunState {
@@ -396,10 +460,6 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   base::MessagePumpWin* pump_win() {
     return static_cast<base::MessagePumpWin*>(pump_.get());
   }
-#elif defined(OS_POSIX)
-  base::MessagePumpLibevent* pump_libevent() {
-    return static_cast<base::MessagePumpLibevent*>(pump_.get());
-  }
 #endif
 
   // A function to encapsulate all the exception handling capability in the
@@ -427,10 +487,12 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   // cannot be run right now.  Returns true if the task was run.
   bool DeferOrRunPendingTask(const base::PendingTask& pending_task);
 
-  // Adds the pending task to delayed_work_queue_.
-  void AddToDelayedWorkQueue(const base::PendingTask& pending_task);
+  // Adds the pending task to delayed_work_queue_ and returns the sequence
+  // number it was given.
+  int AddToDelayedWorkQueue(const base::PendingTask& pending_task);
 
-  // Adds the pending task to our incoming_queue_.
+  // Adds the pending task to our incoming_queue_, or to
+  // lock_free_incoming_queue_ if the lock-free mode is in use.
   //
   // Caller retains ownership of |pending_task|, but this function will
   // reset the value of pending_task->task.  This is needed to ensure
@@ -438,11 +500,32 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   // beyond this function call.
   void AddToIncomingQueue(base::PendingTask* pending_task);
 
+  // Like AddToIncomingQueue, but for |count| tasks starting at
+  // |pending_tasks|.  Takes the lock and wakes up the pump at most once.
+  void AddBatchToIncomingQueue(base::PendingTask* pending_tasks, size_t count);
+
+  // Builds PendingTasks for |tasks| and adds them with
+  // AddBatchToIncomingQueue.
+  void PostTaskBatch(const tracked_objects::Location& from_here,
+                     const std::vector<base::Closure>& tasks,
+                     bool nestable);
+
   // Load tasks from the incoming_queue_ into work_queue_ if the latter is
   // empty.  The former requires a lock to access, while the latter is directly
   // accessible on this thread.
   void ReloadWorkQueue();
 
+  // Sorts the tasks in priority_incoming_queue_ into their lanes.
+  void ReloadPriorityWorkQueues();
+
+  // Returns the lane of the given priority; work_queue_ for
+  // TASK_PRIORITY_NORMAL.
+  base::TaskQueue* GetWorkQueue(base::TaskPriority priority);
+
+  // Picks the lane, other than the idle one, to run the next task from and
+  // updates the starvation counts.  Returns NULL if those lanes are all empty.
+  base::TaskQueue* SelectWorkQueue();
+
   // Delete tasks that haven't run yet without running them.  Used in the
   // destructor to make sure all the task's destructors get called.  Returns
   // true if some work was done.
@@ -460,6 +543,10 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   // If message_histogram_ is NULL, this is a no-op.
   void HistogramEvent(int event);
 
+  // Creates the task timing histograms for this thread if it is named and
+  // the statistics recorder is active.
+  void StartTaskHistograms();
+
   // base::MessagePump::Delegate methods:
   virtual bool DoWork() OVERRIDE;
   virtual bool DoDelayedWork(base::TimeTicks* next_delayed_work_time) OVERRIDE;
@@ -471,7 +558,16 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   // this queue is only accessed (push/pop) by our current thread.
   base::TaskQueue work_queue_;
 
+  // The other lanes, see PostTaskWithPriority().  work_queue_ is the
+  // TASK_PRIORITY_NORMAL lane, so that slot is unused.
+  base::TaskQueue priority_work_queues_[base::TASK_PRIORITY_COUNT];
+
+  // For each lane, how many tasks in a row were taken from more urgent lanes
+  // while it had work.
+  int tasks_passed_over_[base::TASK_PRIORITY_COUNT];
+
   // Contains delayed tasks, sorted by their 'delayed_run_time' property.
+  // Tasks can be removed early by their sequence number.
   base::DelayedTaskQueue delayed_work_queue_;
 
   // A recent snapshot of Time::Now(), used to check delayed_work_queue_.
@@ -490,20 +586,39 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   // insider a (accidentally induced?) nested message pump.
   bool nestable_tasks_allowed_;
 
+  // The task being run, or NULL.
+  const base::PendingTask* current_pending_task_;
+
   bool exception_restoration_;
 
   std::string thread_name_;
   // A profiling histogram showing the counts of various messages and events.
   base::Histogram* message_histogram_;
+  // Task timing histograms, all NULL until StartTaskHistograms() sets them.
+  base::Histogram* queueing_delay_histogram_;
+  base::Histogram* run_time_histogram_;
+  base::Histogram* delayed_task_lateness_histogram_;
 
   // A null terminated list which creates an incoming_queue of tasks that are
   // acquired under a mutex for processing on this instance's thread. These
   // tasks have not yet been sorted out into items for our work_queue_ vs items
   // that will be handled by the TimerManager.
   base::TaskQueue incoming_queue_;
-  // Protect access to incoming_queue_.
+  // Protect access to incoming_queue_ and priority_incoming_queue_.
   mutable base::Lock incoming_queue_lock_;
 
+  // Tasks from PostTaskWithPriority() that are not in their lanes yet.  It is
+  // guarded by incoming_queue_lock_ in the lock-free mode too.
+  base::TaskQueue priority_incoming_queue_;
+  // Non-zero while priority_incoming_queue_ may have tasks, so that DoWork()
+  // only takes the lock for it when there is something to take.
+  base::subtle::Atomic32 has_priority_incoming_tasks_;
+
+  // Used in place of incoming_queue_ and incoming_queue_lock_ when
+  // |use_lock_free_incoming_queue_| is true.  Chosen once at construction.
+  bool use_lock_free_incoming_queue_;
+  base::LockFreeTaskQueue lock_free_incoming_queue_;
+
   RunState* state_;
 
 #if defined(OS_WIN)
@@ -602,15 +717,21 @@ class BASE_EXPORT MessageLoopForIO : public MessageLoop {
   typedef base::MessagePumpForIO::IOContext IOContext;
   typedef base::MessagePumpForIO::IOObserver IOObserver;
 #elif defined(OS_POSIX)
-  typedef base::MessagePumpLibevent::Watcher Watcher;
-  typedef base::MessagePumpLibevent::FileDescriptorWatcher
-      FileDescriptorWatcher;
-  typedef base::MessagePumpLibevent::IOObserver IOObserver;
+  // The pump behind TYPE_IO loops; both have the same interface.
+#if defined(USE_EPOLL_MESSAGE_PUMP)
+  typedef base::MessagePumpEpoll MessagePumpForIO;
+#else
+  typedef base::MessagePumpLibevent MessagePumpForIO;
+#endif
+
+  typedef MessagePumpForIO::Watcher Watcher;
+  typedef MessagePumpForIO::FileDescriptorWatcher FileDescriptorWatcher;
+  typedef MessagePumpForIO::IOObserver IOObserver;
 
   enum Mode {
-    WATCH_READ = base::MessagePumpLibevent::WATCH_READ,
-    WATCH_WRITE = base::MessagePumpLibevent::WATCH_WRITE,
-    WATCH_READ_WRITE = base::MessagePumpLibevent::WATCH_READ_WRITE
+    WATCH_READ = MessagePumpForIO::WATCH_READ,
+    WATCH_WRITE = MessagePumpForIO::WATCH_WRITE,
+    WATCH_READ_WRITE = MessagePumpForIO::WATCH_READ_WRITE
   };
 
 #endif
@@ -653,8 +774,8 @@ class BASE_EXPORT MessageLoopForIO : public MessageLoop {
                            Watcher* delegate);
 
  private:
-  base::MessagePumpLibevent* pump_io() {
-    return static_cast<base::MessagePumpLibevent*>(pump_.get());
+  MessagePumpForIO* pump_io() {
+    return static_cast<MessagePumpForIO*>(pump_.get());
   }
 #endif  // defined(OS_POSIX)
 };
@@ -0,0 +1,98 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/memory/scoped_vector.h"
+#include "base/message_loop.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kTasksPerProducer = 100000;
+
+// Runs on the consumer thread only.
+class TaskCounter {
+ public:
+  TaskCounter(int expected, base::WaitableEvent* done)
+      : count_(0),
+        expected_(expected),
+        done_(done) {
+  }
+
+  void Increment() {
+    if (++count_ == expected_)
+      done_->Signal();
+  }
+
+ private:
+  int count_;
+  int expected_;
+  base::WaitableEvent* done_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskCounter);
+};
+
+void PostTasks(base::WaitableEvent* start,
+               MessageLoop* target,
+               TaskCounter* counter) {
+  start->Wait();
+  for (int i = 0; i < kTasksPerProducer; ++i) {
+    target->PostTask(FROM_HERE, base::Bind(&TaskCounter::Increment,
+                                           base::Unretained(counter)));
+  }
+}
+
+// Measures how many tasks per second |num_producers| threads can post to one
+// consumer MessageLoop.
+void RunPostTaskPerfTest(int num_producers, bool lock_free) {
+  MessageLoop::EnableLockFreeIncomingQueue(lock_free);
+
+  base::Thread consumer("PostTaskPerfConsumer");
+  ASSERT_TRUE(consumer.Start());
+  MessageLoop::EnableLockFreeIncomingQueue(false);
+
+  base::WaitableEvent start(true, false);
+  base::WaitableEvent done(false, false);
+  TaskCounter counter(num_producers * kTasksPerProducer, &done);
+
+  ScopedVector<base::Thread> producers;
+  for (int i = 0; i < num_producers; ++i) {
+    producers.push_back(new base::Thread("PostTaskPerfProducer"));
+    ASSERT_TRUE(producers.back()->Start());
+    producers.back()->message_loop()->PostTask(FROM_HERE, base::Bind(
+        &PostTasks, &start, consumer.message_loop(), &counter));
+  }
+
+  PerfTimer timer;
+  start.Signal();
+  done.Wait();
+  base::TimeDelta elapsed = timer.Elapsed();
+
+  std::string name = base::StringPrintf(
+      "MessageLoop_PostTask_%s_%d_producers",
+      lock_free ? "lock_free" : "locked", num_producers);
+  LogPerfResult(name.c_str(),
+                num_producers * kTasksPerProducer / elapsed.InSecondsF(),
+                "posts/s");
+}
+
+const int kProducerCounts[] = { 1, 2, 4, 8, 16 };
+
+}  // namespace
+
+TEST(MessageLoopPerfTest, PostTaskLocked) {
+  for (size_t i = 0; i < arraysize(kProducerCounts); ++i)
+    RunPostTaskPerfTest(kProducerCounts[i], false);
+}
+
+TEST(MessageLoopPerfTest, PostTaskLockFree) {
+  for (size_t i = 0; i < arraysize(kProducerCounts); ++i)
+    RunPostTaskPerfTest(kProducerCounts[i], true);
+}
@@ -44,6 +44,37 @@ bool MessageLoopProxyImpl::PostNonNestableDelayedTask(
   return PostTaskHelper(from_here, task, delay, false);
 }
 
+bool MessageLoopProxyImpl::PostTasks(
+    const tracked_objects::Location& from_here,
+    const std::vector<base::Closure>& tasks) {
+  AutoLock lock(message_loop_lock_);
+  if (!target_message_loop_)
+    return false;
+  target_message_loop_->PostTasks(from_here, tasks);
+  return true;
+}
+
+bool MessageLoopProxyImpl::PostNonNestableTasks(
+    const tracked_objects::Location& from_here,
+    const std::vector<base::Closure>& tasks) {
+  AutoLock lock(message_loop_lock_);
+  if (!target_message_loop_)
+    return false;
+  target_message_loop_->PostNonNestableTasks(from_here, tasks);
+  return true;
+}
+
+bool MessageLoopProxyImpl::PostTaskWithPriority(
+    const tracked_objects::Location& from_here,
+    const base::Closure& task,
+    TaskPriority priority) {
+  AutoLock lock(message_loop_lock_);
+  if (!target_message_loop_)
+    return false;
+  target_message_loop_->PostTaskWithPriority(from_here, task, priority);
+  return true;
+}
+
 bool MessageLoopProxyImpl::RunsTasksOnCurrentThread() const {
   // We shouldn't use MessageLoop::current() since it uses LazyInstance which
   // may be deleted by ~AtExitManager when a WorkerPool thread calls this
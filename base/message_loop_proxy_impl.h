@@ -33,6 +33,14 @@ class BASE_EXPORT MessageLoopProxyImpl : public MessageLoopProxy {
       const tracked_objects::Location& from_here,
       const base::Closure& task,
       base::TimeDelta delay) OVERRIDE;
+  virtual bool PostTasks(const tracked_objects::Location& from_here,
+                         const std::vector<base::Closure>& tasks) OVERRIDE;
+  virtual bool PostNonNestableTasks(
+      const tracked_objects::Location& from_here,
+      const std::vector<base::Closure>& tasks) OVERRIDE;
+  virtual bool PostTaskWithPriority(const tracked_objects::Location& from_here,
+                                    const base::Closure& task,
+                                    TaskPriority priority) OVERRIDE;
   virtual bool RunsTasksOnCurrentThread() const OVERRIDE;
 
  protected:
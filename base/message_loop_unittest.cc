@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <vector>
 
 #include "base/bind.h"
@@ -10,7 +11,9 @@
 #include "base/eintr_wrapper.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/scoped_vector.h"
 #include "base/message_loop.h"
+#include "base/metrics/histogram.h"
 #include "base/thread_task_runner_handle.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/thread.h"
@@ -111,6 +114,75 @@ void RunTest_PostTask(MessageLoop::Type message_loop_type) {
   EXPECT_EQ(foo->result(), "abacad");
 }
 
+void PostTestTasks(MessageLoop* loop, Foo* foo, int count) {
+  for (int i = 0; i < count; ++i)
+    loop->PostTask(FROM_HERE, base::Bind(
+        &Foo::Test1Int, base::Unretained(foo), 1));
+}
+
+void RunTest_PostTaskFromOtherThreads(MessageLoop::Type message_loop_type) {
+  const int kNumThreads = 4;
+  const int kTasksPerThread = 100;
+
+  MessageLoop loop(message_loop_type);
+  scoped_refptr<Foo> foo(new Foo());
+  {
+    ScopedVector<Thread> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+      threads.push_back(new Thread("PostTaskFromOtherThreads"));
+      ASSERT_TRUE(threads.back()->Start());
+      threads.back()->message_loop()->PostTask(FROM_HERE, base::Bind(
+          &PostTestTasks, &loop, base::Unretained(foo.get()),
+          kTasksPerThread));
+    }
+    // Joining the threads guarantees that every task has been posted.
+  }
+  loop.PostTask(FROM_HERE, MessageLoop::QuitClosure());
+  loop.Run();
+
+  EXPECT_EQ(kNumThreads * kTasksPerThread, foo->test_count());
+}
+
+void PostTestTaskBatch(scoped_refptr<base::MessageLoopProxy> proxy,
+                       Foo* foo,
+                       std::string* a,
+                       std::string* b) {
+  std::vector<base::Closure> tasks;
+  tasks.push_back(base::Bind(&Foo::Test1Ptr, base::Unretained(foo), a));
+  tasks.push_back(base::Bind(&Foo::Test1Ptr, base::Unretained(foo), b));
+  tasks.push_back(base::Bind(&Foo::Test1Int, base::Unretained(foo), 100));
+  EXPECT_TRUE(proxy->PostTasks(FROM_HERE, tasks));
+}
+
+void RunTest_PostTasks(MessageLoop::Type message_loop_type) {
+  MessageLoop loop(message_loop_type);
+
+  // Batches run in order, interleaved correctly with single posts.
+  scoped_refptr<Foo> foo(new Foo());
+  std::string a("a"), b("b"), c("c");
+  std::vector<base::Closure> tasks;
+  tasks.push_back(base::Bind(&Foo::Test1Ptr, foo.get(), &a));
+  tasks.push_back(base::Bind(&Foo::Test1Ptr, foo.get(), &b));
+  loop.PostTasks(FROM_HERE, tasks);
+  loop.PostTask(FROM_HERE, base::Bind(&Foo::Test1Ptr, foo.get(), &c));
+  loop.PostNonNestableTasks(FROM_HERE, tasks);
+  loop.PostTasks(FROM_HERE, std::vector<base::Closure>());
+
+  // A batch posted through the proxy from another thread.
+  {
+    Thread thread("PostTasks");
+    ASSERT_TRUE(thread.Start());
+    thread.message_loop()->PostTask(FROM_HERE, base::Bind(
+        &PostTestTaskBatch, loop.message_loop_proxy(),
+        base::Unretained(foo.get()), &c, &a));
+  }
+  loop.PostTask(FROM_HERE, MessageLoop::QuitClosure());
+  loop.Run();
+
+  EXPECT_EQ(107, foo->test_count());
+  EXPECT_EQ("abcabca", foo->result());
+}
+
 void RunTest_PostTask_SEH(MessageLoop::Type message_loop_type) {
   MessageLoop loop(message_loop_type);
 
@@ -451,6 +523,41 @@ void RunTest_EnsureDeletion_Chain(MessageLoop::Type message_loop_type) {
   EXPECT_TRUE(c_was_deleted);
 }
 
+void RunTest_CancelDelayedTask(MessageLoop::Type message_loop_type) {
+  MessageLoop loop(message_loop_type);
+
+  // Test that a canceled task is deleted right away and never runs, while the
+  // tasks around it still run in order.
+  bool was_deleted = false;
+  int canceled_id = loop.PostCancelableDelayedTask(
+      FROM_HERE,
+      base::Bind(&RecordDeletionProbe::Run,
+                 new RecordDeletionProbe(NULL, &was_deleted)),
+      TimeDelta::FromMilliseconds(10));
+
+  int num_tasks = 2;
+  Time run_time1, run_time2;
+  loop.PostCancelableDelayedTask(
+      FROM_HERE,
+      base::Bind(&RecordRunTimeFunc, &run_time2, &num_tasks),
+      TimeDelta::FromMilliseconds(20));
+  loop.PostCancelableDelayedTask(
+      FROM_HERE,
+      base::Bind(&RecordRunTimeFunc, &run_time1, &num_tasks),
+      TimeDelta());
+
+  EXPECT_FALSE(was_deleted);
+  loop.CancelDelayedTask(canceled_id);
+  EXPECT_TRUE(was_deleted);
+
+  loop.Run();
+  EXPECT_EQ(0, num_tasks);
+  EXPECT_TRUE(run_time1 < run_time2);
+
+  // Canceling a task that is gone is harmless.
+  loop.CancelDelayedTask(canceled_id);
+}
+
 void NestingFunc(int* depth) {
   if (*depth > 0) {
     *depth -= 1;
@@ -1298,6 +1405,31 @@ TEST(MessageLoopTest, PostTask) {
   RunTest_PostTask(MessageLoop::TYPE_IO);
 }
 
+// Runs the basic PostTask test, plus a cross-thread posting test, with the
+// lock-free incoming queue enabled.
+TEST(MessageLoopTest, PostTask_LockFreeIncomingQueue) {
+  MessageLoop::EnableLockFreeIncomingQueue(true);
+  RunTest_PostTask(MessageLoop::TYPE_DEFAULT);
+  RunTest_PostTask(MessageLoop::TYPE_UI);
+  RunTest_PostTask(MessageLoop::TYPE_IO);
+  RunTest_PostTaskFromOtherThreads(MessageLoop::TYPE_DEFAULT);
+  RunTest_PostTaskFromOtherThreads(MessageLoop::TYPE_IO);
+  MessageLoop::EnableLockFreeIncomingQueue(false);
+}
+
+TEST(MessageLoopTest, PostTasks) {
+  RunTest_PostTasks(MessageLoop::TYPE_DEFAULT);
+  RunTest_PostTasks(MessageLoop::TYPE_UI);
+  RunTest_PostTasks(MessageLoop::TYPE_IO);
+}
+
+TEST(MessageLoopTest, PostTasks_LockFreeIncomingQueue) {
+  MessageLoop::EnableLockFreeIncomingQueue(true);
+  RunTest_PostTasks(MessageLoop::TYPE_DEFAULT);
+  RunTest_PostTasks(MessageLoop::TYPE_IO);
+  MessageLoop::EnableLockFreeIncomingQueue(false);
+}
+
 TEST(MessageLoopTest, PostTask_SEH) {
   RunTest_PostTask_SEH(MessageLoop::TYPE_DEFAULT);
   RunTest_PostTask_SEH(MessageLoop::TYPE_UI);
@@ -1340,6 +1472,12 @@ TEST(MessageLoopTest, PostDelayedTask_SharedTimer) {
   RunTest_PostDelayedTask_SharedTimer(MessageLoop::TYPE_IO);
 }
 
+TEST(MessageLoopTest, CancelDelayedTask) {
+  RunTest_CancelDelayedTask(MessageLoop::TYPE_DEFAULT);
+  RunTest_CancelDelayedTask(MessageLoop::TYPE_UI);
+  RunTest_CancelDelayedTask(MessageLoop::TYPE_IO);
+}
+
 #if defined(OS_WIN)
 TEST(MessageLoopTest, PostDelayedTask_SharedTimer_SubPump) {
   RunTest_PostDelayedTask_SharedTimer_SubPump();
@@ -1712,3 +1850,87 @@ TEST(MessageLoopTest, ThreadMainTaskRunner) {
   EXPECT_EQ(foo->test_count(), 1);
   EXPECT_EQ(foo->result(), "a");
 }
+
+namespace {
+
+base::Histogram::Count HistogramTotalCount(const std::string& name) {
+  base::Histogram* histogram = NULL;
+  if (!base::StatisticsRecorder::FindHistogram(name, &histogram))
+    return 0;
+  base::Histogram::SampleSet samples;
+  histogram->SnapshotSample(&samples);
+  return samples.TotalCount();
+}
+
+}  // namespace
+
+// Verify that a named loop records the timing of its tasks.
+TEST(MessageLoopTest, TaskHistograms) {
+  base::StatisticsRecorder recorder;
+  MessageLoop loop;
+  loop.set_thread_name("TaskHistogramsTest");
+
+  loop.PostTask(FROM_HERE, base::Bind(&base::DoNothing));
+  loop.PostDelayedTask(FROM_HERE, MessageLoop::QuitClosure(),
+                       TimeDelta::FromMilliseconds(1));
+  loop.Run();
+
+  EXPECT_EQ(1, HistogramTotalCount(
+      "MessageLoop.QueueingDelay.TaskHistogramsTest"));
+  EXPECT_EQ(1, HistogramTotalCount(
+      "MessageLoop.DelayedTaskLateness.TaskHistogramsTest"));
+  EXPECT_EQ(2, HistogramTotalCount("MessageLoop.RunTime.TaskHistogramsTest"));
+}
+
+namespace {
+
+void RecordRunOrder(std::vector<int>* order, int id) {
+  order->push_back(id);
+}
+
+}  // namespace
+
+// Verify that tasks run by lane, and in posting order within a lane.
+TEST(MessageLoopTest, PriorityLanes) {
+  MessageLoop loop;
+  std::vector<int> order;
+
+  loop.PostTask(FROM_HERE, base::Bind(&RecordRunOrder, &order, 3));
+  loop.PostTaskWithPriority(FROM_HERE, base::Bind(&RecordRunOrder, &order, 5),
+                            base::TASK_PRIORITY_IDLE);
+  loop.PostTaskWithPriority(FROM_HERE, base::Bind(&RecordRunOrder, &order, 2),
+                            base::TASK_PRIORITY_DISPLAY);
+  loop.message_loop_proxy()->PostTaskWithPriority(
+      FROM_HERE, base::Bind(&RecordRunOrder, &order, 1),
+      base::TASK_PRIORITY_INPUT);
+  loop.PostTaskWithPriority(FROM_HERE, base::Bind(&RecordRunOrder, &order, 4),
+                            base::TASK_PRIORITY_NORMAL);
+  loop.RunAllPending();
+
+  ASSERT_EQ(5u, order.size());
+  for (int i = 0; i < 5; ++i)
+    EXPECT_EQ(i + 1, order[i]);
+}
+
+// Verify that a burst of urgent tasks does not starve normal ones.
+TEST(MessageLoopTest, PriorityLanesDoNotStarve) {
+  MessageLoop loop;
+  std::vector<int> order;
+
+  const int kNormalTask = -1;
+  loop.PostTask(FROM_HERE, base::Bind(&RecordRunOrder, &order, kNormalTask));
+  for (int i = 0; i < 50; ++i) {
+    loop.PostTaskWithPriority(FROM_HERE,
+                              base::Bind(&RecordRunOrder, &order, i),
+                              base::TASK_PRIORITY_INPUT);
+  }
+  loop.RunAllPending();
+
+  ASSERT_EQ(51u, order.size());
+  // The normal task waits through some input tasks, but not all of them.
+  size_t normal_position =
+      std::find(order.begin(), order.end(), kNormalTask) - order.begin();
+  EXPECT_GT(normal_position, 0u);
+  EXPECT_LT(normal_position, 50u);
+}
+
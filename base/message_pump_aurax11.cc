@@ -6,13 +6,30 @@
 
 #include <X11/extensions/XInput2.h>
 
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <vector>
+
 #include "base/basictypes.h"
+#include "base/lazy_instance.h"
 #include "base/message_loop.h"
+#include "base/metrics/histogram.h"
 
 namespace {
 
+// The events read from the connection but not dispatched yet, oldest first.
+// A nested loop run while dispatching continues with them.
+base::LazyInstance<std::deque<XEvent> > g_pending_events =
+    LAZY_INSTANCE_INITIALIZER;
+
+bool HasPendingXEvents() {
+  return !g_pending_events.Get().empty() ||
+      XPending(base::MessagePumpAuraX11::GetDefaultXDisplay());
+}
+
 gboolean XSourcePrepare(GSource* source, gint* timeout_ms) {
-  if (XPending(base::MessagePumpAuraX11::GetDefaultXDisplay()))
+  if (HasPendingXEvents())
     *timeout_ms = 0;
   else
     *timeout_ms = -1;
@@ -20,7 +37,7 @@ gboolean XSourcePrepare(GSource* source, gint* timeout_ms) {
 }
 
 gboolean XSourceCheck(GSource* source) {
-  return XPending(base::MessagePumpAuraX11::GetDefaultXDisplay());
+  return HasPendingXEvents();
 }
 
 gboolean XSourceDispatch(GSource* source,
@@ -83,6 +100,111 @@ bool InitializeXInput2() {
   return xinput2_supported;
 }
 
+// Frees the data ReadXEvents() claimed for |xev|, if any.
+void FreeXEventData(XEvent* xev) {
+  if (xev->type == GenericEvent && xev->xcookie.data)
+    XFreeEventData(xev->xgeneric.display, &xev->xcookie);
+}
+
+// Returns true if the event at |index| of |events| is made redundant by the
+// event at |next|, the next event of |events| for the same window.
+bool IsSupersededBy(const std::vector<XEvent>& events,
+                    size_t index,
+                    size_t next) {
+  const XEvent& event = events[index];
+  const XEvent& later = events[next];
+  if (event.type != later.type)
+    return false;
+
+  switch (event.type) {
+    case MotionNotify:
+      // Only moves with nothing in between are dropped, so that the pointer
+      // is where it was for every other event. XI2 moves are GenericEvents,
+      // which are coalesced by the dispatcher.
+      return next == index + 1 &&
+          event.xmotion.subwindow == later.xmotion.subwindow &&
+          event.xmotion.state == later.xmotion.state &&
+          event.xmotion.same_screen == later.xmotion.same_screen;
+    case ConfigureNotify:
+      // A configure carries the whole geometry of the window.
+      return event.xconfigure.window == later.xconfigure.window;
+    case Expose:
+      return true;
+  }
+  return false;
+}
+
+// Marks the events of |events| that later events of the same window make
+// redundant in |superseded|: moves followed by moves, configures followed by
+// configures of the same window, and exposes followed by exposes, whose areas
+// are merged into the later expose.
+void CoalesceXEvents(std::vector<XEvent>* events,
+                     std::vector<bool>* superseded) {
+  superseded->assign(events->size(), false);
+
+  // The next event kept for each window, found walking the events backwards.
+  std::map<Window, size_t> next_for_window;
+  for (size_t i = events->size(); i-- > 0;) {
+    XEvent* event = &(*events)[i];
+    if (event->type == GenericEvent)
+      continue;
+
+    std::map<Window, size_t>::iterator next =
+        next_for_window.find(event->xany.window);
+    if (next == next_for_window.end()) {
+      next_for_window[event->xany.window] = i;
+      continue;
+    }
+    if (!IsSupersededBy(*events, i, next->second)) {
+      next->second = i;
+      continue;
+    }
+
+    (*superseded)[i] = true;
+    if (event->type == Expose) {
+      XExposeEvent* later = &(*events)[next->second].xexpose;
+      int right = std::max(event->xexpose.x + event->xexpose.width,
+                           later->x + later->width);
+      int bottom = std::max(event->xexpose.y + event->xexpose.height,
+                            later->y + later->height);
+      later->x = std::min(event->xexpose.x, later->x);
+      later->y = std::min(event->xexpose.y, later->y);
+      later->width = right - later->x;
+      later->height = bottom - later->y;
+    }
+  }
+}
+
+// Reads the events Xlib has queued or can read from the connection without
+// blocking into |g_pending_events|, less those that later events make
+// redundant. Returns false if there were none.
+bool ReadXEvents(Display* display) {
+  std::deque<XEvent>* pending_events = g_pending_events.Pointer();
+  DCHECK(pending_events->empty());
+  int count = XEventsQueued(display, QueuedAfterReading);
+  if (count <= 0)
+    return false;
+
+  // The data of an XI2 event is freed by the next XNextEvent() unless it is
+  // claimed first, so it is claimed as the event is read, and freed by
+  // ProcessXEvent().
+  std::vector<XEvent> batch(count);
+  for (int i = 0; i < count; ++i) {
+    XNextEvent(display, &batch[i]);
+    if (batch[i].type == GenericEvent)
+      XGetEventData(display, &batch[i].xcookie);
+  }
+  UMA_HISTOGRAM_COUNTS_100("Event.XEventBatchSize", count);
+
+  std::vector<bool> superseded;
+  CoalesceXEvents(&batch, &superseded);
+  for (int i = 0; i < count; ++i) {
+    if (!superseded[i])
+      pending_events->push_back(batch[i]);
+  }
+  return true;
+}
+
 }  // namespace
 
 namespace base {
@@ -119,11 +241,19 @@ gboolean MessagePumpAuraX11::DispatchXEvents() {
       GetDispatcher() ? GetDispatcher() : g_default_dispatcher;
 
   // In the general case, we want to handle all pending events before running
-  // the tasks. This is what happens in the message_pump_glib case.
-  while (XPending(display)) {
-    XEvent xev;
-    XNextEvent(display, &xev);
-    if (dispatcher && ProcessXEvent(dispatcher, &xev))
+  // the tasks. This is what happens in the message_pump_glib case. Events are
+  // read a batch at a time, reading the connection once per batch rather than
+  // flushing and polling it for every event as XPending() does.
+  std::deque<XEvent>* pending_events = g_pending_events.Pointer();
+  while (!pending_events->empty() || ReadXEvents(display)) {
+    XEvent xev = pending_events->front();
+    pending_events->pop_front();
+    if (!dispatcher) {
+      FreeXEventData(&xev);
+      continue;
+    }
+    // The events not dispatched yet are left for the next loop.
+    if (ProcessXEvent(dispatcher, &xev))
       return TRUE;
   }
   return TRUE;
@@ -132,6 +262,10 @@ gboolean MessagePumpAuraX11::DispatchXEvents() {
 MessagePumpAuraX11::~MessagePumpAuraX11() {
   g_source_destroy(x_source_);
   g_source_unref(x_source_);
+  std::deque<XEvent>* pending_events = g_pending_events.Pointer();
+  for (size_t i = 0; i < pending_events->size(); ++i)
+    FreeXEventData(&(*pending_events)[i]);
+  pending_events->clear();
   XCloseDisplay(g_xdisplay);
   g_xdisplay = NULL;
 }
@@ -157,12 +291,6 @@ bool MessagePumpAuraX11::ProcessXEvent(MessagePumpDispatcher* dispatcher,
                                        XEvent* xev) {
   bool should_quit = false;
 
-  bool have_cookie = false;
-  if (xev->type == GenericEvent &&
-      XGetEventData(xev->xgeneric.display, &xev->xcookie)) {
-    have_cookie = true;
-  }
-
   if (!WillProcessXEvent(xev)) {
     if (!dispatcher->Dispatch(xev)) {
       should_quit = true;
@@ -171,10 +299,7 @@ bool MessagePumpAuraX11::ProcessXEvent(MessagePumpDispatcher* dispatcher,
     DidProcessXEvent(xev);
   }
 
-  if (have_cookie) {
-    XFreeEventData(xev->xgeneric.display, &xev->xcookie);
-  }
-
+  FreeXEventData(xev);
   return should_quit;
 }
 
@@ -0,0 +1,455 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_pump_epoll.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "base/auto_reset.h"
+#include "base/eintr_wrapper.h"
+#include "base/logging.h"
+
+namespace base {
+
+namespace {
+
+// How many events a single epoll_wait() call can return.  Anything beyond this
+// is picked up by the next call.
+const int kMaxEvents = 32;
+
+// Translates epoll readiness into the Mode values watchers register for.
+// Errors and hang-ups are reported to both readers and writers, who then find
+// out about them from their next read() or write(), as with libevent.
+int ReadyMode(uint32 events) {
+  int mode = 0;
+  if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+    mode |= MessagePumpEpoll::WATCH_READ;
+  if (events & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+    mode |= MessagePumpEpoll::WATCH_WRITE;
+  return mode;
+}
+
+void CloseDescriptor(int fd) {
+  if (fd >= 0 && HANDLE_EINTR(close(fd)) < 0)
+    DPLOG(ERROR) << "close";
+}
+
+}  // namespace
+
+MessagePumpEpoll::FileDescriptorWatcher::FileDescriptorWatcher()
+    : fd_(-1),
+      mode_(0),
+      persistent_(false),
+      registered_(false),
+      dispatch_id_(0),
+      next_(NULL),
+      pump_(NULL),
+      watcher_(NULL),
+      was_destroyed_(NULL) {
+}
+
+MessagePumpEpoll::FileDescriptorWatcher::~FileDescriptorWatcher() {
+  if (was_destroyed_)
+    *was_destroyed_ = true;
+  if (fd_ != -1)
+    StopWatchingFileDescriptor();
+}
+
+bool MessagePumpEpoll::FileDescriptorWatcher::StopWatchingFileDescriptor() {
+  if (fd_ == -1)
+    return true;
+
+  // |pump_| is NULL if the pump went away first.
+  bool rv = pump_ ? pump_->Unregister(this) : true;
+  fd_ = -1;
+  mode_ = 0;
+  persistent_ = false;
+  pump_ = NULL;
+  watcher_ = NULL;
+  return rv;
+}
+
+void MessagePumpEpoll::FileDescriptorWatcher::OnEpollEvent(int ready_mode) {
+  MessagePumpEpoll* pump = pump_;
+  int fd = fd_;
+
+  // A nested loop may dispatch to this controller again from inside one of
+  // the callbacks, so chain to any outer flag rather than replacing it.
+  bool destroyed = false;
+  bool* outer_was_destroyed = was_destroyed_;
+  was_destroyed_ = &destroyed;
+
+  if (ready_mode & WATCH_WRITE) {
+    pump->WillProcessIOEvent();
+    watcher_->OnFileCanWriteWithoutBlocking(fd);
+    pump->DidProcessIOEvent();
+  }
+  // The write callback may have deleted |this| or stopped watching.
+  if (!destroyed && (ready_mode & WATCH_READ) && watcher_) {
+    pump->WillProcessIOEvent();
+    watcher_->OnFileCanReadWithoutBlocking(fd);
+    pump->DidProcessIOEvent();
+  }
+
+  if (destroyed) {
+    if (outer_was_destroyed)
+      *outer_was_destroyed = true;
+    return;
+  }
+  was_destroyed_ = outer_was_destroyed;
+}
+
+MessagePumpEpoll::MessagePumpEpoll()
+    : keep_running_(true),
+      in_run_(false),
+      epoll_fd_(-1),
+      wakeup_fd_(-1),
+      timer_fd_(-1),
+      last_dispatch_id_(0) {
+  if (!Init())
+     NOTREACHED();
+}
+
+MessagePumpEpoll::~MessagePumpEpoll() {
+  // Detach controllers that outlive the pump so that stopping them later is
+  // harmless.
+  for (ControllerMap::iterator it = controllers_.begin();
+       it != controllers_.end(); ++it) {
+    FileDescriptorWatcher* controller = it->second;
+    while (controller) {
+      FileDescriptorWatcher* next = controller->next_;
+      controller->registered_ = false;
+      controller->next_ = NULL;
+      controller->pump_ = NULL;
+      controller = next;
+    }
+  }
+  CloseDescriptor(timer_fd_);
+  CloseDescriptor(wakeup_fd_);
+  CloseDescriptor(epoll_fd_);
+}
+
+bool MessagePumpEpoll::WatchFileDescriptor(int fd,
+                                           bool persistent,
+                                           Mode mode,
+                                           FileDescriptorWatcher* controller,
+                                           Watcher* delegate) {
+  DCHECK_GE(fd, 0);
+  DCHECK(controller);
+  DCHECK(delegate);
+  DCHECK(mode == WATCH_READ || mode == WATCH_WRITE || mode == WATCH_READ_WRITE);
+  // WatchFileDescriptor should be called on the pump thread. It is not
+  // threadsafe, and your watcher may never be registered.
+  DCHECK(watch_file_descriptor_caller_checker_.CalledOnValidThread());
+
+  int new_mode = mode;
+  if (controller->fd_ != -1) {
+    // It's illegal to use this function to listen on 2 separate fds with the
+    // same |controller|.
+    if (controller->fd_ != fd) {
+      NOTREACHED() << "FDs don't match" << controller->fd_ << "!=" << fd;
+      return false;
+    }
+    DCHECK_EQ(this, controller->pump_);
+    new_mode |= controller->mode_;
+    persistent |= controller->persistent_;
+  }
+
+  std::pair<ControllerMap::iterator, bool> result = controllers_.insert(
+      std::make_pair(fd, static_cast<FileDescriptorWatcher*>(NULL)));
+  if (!controller->registered_) {
+    controller->next_ = result.first->second;
+    result.first->second = controller;
+    controller->registered_ = true;
+    // Keeps a dispatch that is already under way from calling the controller.
+    controller->dispatch_id_ = last_dispatch_id_;
+  }
+  controller->fd_ = fd;
+  controller->mode_ = new_mode;
+  controller->persistent_ = persistent;
+  controller->pump_ = this;
+  controller->watcher_ = delegate;
+
+  // EPOLL_CTL_MOD also reports readiness that the descriptor already has, so
+  // re-arming never misses an edge.
+  if (!UpdateInterest(fd, result.second ? EPOLL_CTL_ADD : EPOLL_CTL_MOD)) {
+    controller->StopWatchingFileDescriptor();
+    return false;
+  }
+  return true;
+}
+
+void MessagePumpEpoll::AddIOObserver(IOObserver *obs) {
+  io_observers_.AddObserver(obs);
+}
+
+void MessagePumpEpoll::RemoveIOObserver(IOObserver *obs) {
+  io_observers_.RemoveObserver(obs);
+}
+
+// Reentrant!
+void MessagePumpEpoll::Run(Delegate* delegate) {
+  DCHECK(keep_running_) << "Quit must have been called outside of Run!";
+  AutoReset<bool> auto_reset_in_run(&in_run_, true);
+
+  for (;;) {
+    bool did_work = delegate->DoWork();
+    if (!keep_running_)
+      break;
+
+    did_work |= ProcessEvents(0);
+    if (!keep_running_)
+      break;
+
+    did_work |= delegate->DoDelayedWork(&delayed_work_time_);
+    if (!keep_running_)
+      break;
+
+    if (did_work)
+      continue;
+
+    did_work = delegate->DoIdleWork();
+    if (!keep_running_)
+      break;
+
+    if (did_work)
+      continue;
+
+    if (!delayed_work_time_.is_null() &&
+        delayed_work_time_ <= TimeTicks::Now()) {
+      // It looks like delayed_work_time_ indicates a time in the past, so we
+      // need to call DoDelayedWork now.
+      delayed_work_time_ = TimeTicks();
+      continue;
+    }
+
+    ArmTimer();
+    ProcessEvents(-1);
+  }
+
+  keep_running_ = true;
+}
+
+void MessagePumpEpoll::Quit() {
+  DCHECK(in_run_);
+  // Tell both epoll_wait() and Run that they should break out of their loops.
+  keep_running_ = false;
+  ScheduleWork();
+}
+
+void MessagePumpEpoll::ScheduleWork() {
+  // Adding to the eventfd counter is threadsafe and makes it readable.
+  uint64 value = 1;
+  int nwrite = HANDLE_EINTR(write(wakeup_fd_, &value, sizeof(value)));
+  DCHECK(nwrite == sizeof(value) || errno == EAGAIN)
+      << "[nwrite:" << nwrite << "] [errno:" << errno << "]";
+}
+
+void MessagePumpEpoll::ScheduleDelayedWork(
+    const TimeTicks& delayed_work_time) {
+  // We know that we can't be blocked on Wait right now since this method can
+  // only be called on the same thread as Run, so we only need to update our
+  // record of how long to sleep when we do sleep.
+  delayed_work_time_ = delayed_work_time;
+}
+
+void MessagePumpEpoll::WillProcessIOEvent() {
+  FOR_EACH_OBSERVER(IOObserver, io_observers_, WillProcessIOEvent());
+}
+
+void MessagePumpEpoll::DidProcessIOEvent() {
+  FOR_EACH_OBSERVER(IOObserver, io_observers_, DidProcessIOEvent());
+}
+
+bool MessagePumpEpoll::Init() {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    DPLOG(ERROR) << "epoll_create1";
+    return false;
+  }
+  wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wakeup_fd_ < 0) {
+    DPLOG(ERROR) << "eventfd";
+    return false;
+  }
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (timer_fd_ < 0) {
+    DPLOG(ERROR) << "timerfd_create";
+    return false;
+  }
+
+  // Both are level-triggered; they are drained whenever they fire.
+  epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = wakeup_fd_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &event) != 0) {
+    DPLOG(ERROR) << "epoll_ctl";
+    return false;
+  }
+  event.data.fd = timer_fd_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &event) != 0) {
+    DPLOG(ERROR) << "epoll_ctl";
+    return false;
+  }
+  return true;
+}
+
+void MessagePumpEpoll::Unlink(FileDescriptorWatcher* controller) {
+  DCHECK(controller->registered_);
+  ControllerMap::iterator it = controllers_.find(controller->fd_);
+  DCHECK(it != controllers_.end());
+  FileDescriptorWatcher** link = &it->second;
+  while (*link != controller)
+    link = &(*link)->next_;
+  *link = controller->next_;
+  controller->next_ = NULL;
+  controller->registered_ = false;
+}
+
+bool MessagePumpEpoll::Unregister(FileDescriptorWatcher* controller) {
+  int fd = controller->fd_;
+  if (controller->registered_)
+    Unlink(controller);
+  ControllerMap::iterator it = controllers_.find(fd);
+  if (it == controllers_.end())
+    return true;
+  if (it->second)
+    return UpdateInterest(fd, EPOLL_CTL_MOD);
+
+  controllers_.erase(it);
+  // Closing a descriptor drops it from the epoll set implicitly, so it may be
+  // gone already.
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, NULL) == 0 ||
+      errno == EBADF || errno == ENOENT) {
+    return true;
+  }
+  DPLOG(ERROR) << "epoll_ctl";
+  return false;
+}
+
+bool MessagePumpEpoll::UpdateInterest(int fd, int op) {
+  ControllerMap::iterator it = controllers_.find(fd);
+  DCHECK(it != controllers_.end());
+  int mode = 0;
+  for (FileDescriptorWatcher* controller = it->second; controller;
+       controller = controller->next_) {
+    mode |= controller->mode_;
+  }
+
+  epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLET;
+  if (mode & WATCH_READ)
+    event.events |= EPOLLIN;
+  if (mode & WATCH_WRITE)
+    event.events |= EPOLLOUT;
+  event.data.fd = fd;
+  if (epoll_ctl(epoll_fd_, op, fd, &event) == 0)
+    return true;
+
+  // The descriptor may have been closed and its number reused since it was
+  // added, in which case the epoll set's view of it is out of date.
+  if (op == EPOLL_CTL_MOD && errno == ENOENT)
+    op = EPOLL_CTL_ADD;
+  else if (op == EPOLL_CTL_ADD && errno == EEXIST)
+    op = EPOLL_CTL_MOD;
+  else
+    op = -1;
+  if (op != -1 && epoll_ctl(epoll_fd_, op, fd, &event) == 0)
+    return true;
+
+  DPLOG(ERROR) << "epoll_ctl";
+  if (!it->second) {
+    // Nobody is left to clean up the entry later.
+    controllers_.erase(it);
+  }
+  return false;
+}
+
+void MessagePumpEpoll::ArmTimer() {
+  if (delayed_work_time_ == armed_time_)
+    return;
+
+  // TimeTicks counts microseconds of CLOCK_MONOTONIC, so the deadline can be
+  // handed to the timerfd as is.  A zero value disarms it.
+  itimerspec spec;
+  memset(&spec, 0, sizeof(spec));
+  if (!delayed_work_time_.is_null()) {
+    int64 deadline = delayed_work_time_.ToInternalValue();
+    spec.it_value.tv_sec = deadline / Time::kMicrosecondsPerSecond;
+    spec.it_value.tv_nsec = (deadline % Time::kMicrosecondsPerSecond) *
+                            Time::kNanosecondsPerMicrosecond;
+  }
+  if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, NULL) != 0) {
+    DPLOG(ERROR) << "timerfd_settime";
+    return;
+  }
+  armed_time_ = delayed_work_time_;
+}
+
+bool MessagePumpEpoll::ProcessEvents(int timeout_ms) {
+  // Kept on the stack because a nested Run() may reenter this from one of the
+  // callbacks.
+  epoll_event events[kMaxEvents];
+  int count = HANDLE_EINTR(epoll_wait(epoll_fd_, events, kMaxEvents,
+                                      timeout_ms));
+  if (count < 0) {
+    DPLOG(ERROR) << "epoll_wait";
+    return false;
+  }
+
+  for (int i = 0; i < count; ++i) {
+    int fd = events[i].data.fd;
+    uint64 value;
+    if (fd == wakeup_fd_) {
+      // Resets the counter; ScheduleWork() calls since then are covered by
+      // the DoWork() that follows.
+      ignore_result(HANDLE_EINTR(read(wakeup_fd_, &value, sizeof(value))));
+    } else if (fd == timer_fd_) {
+      ignore_result(HANDLE_EINTR(read(timer_fd_, &value, sizeof(value))));
+      // The timer is one-shot, so it needs arming again even for the same
+      // deadline.
+      armed_time_ = TimeTicks();
+    } else {
+      DispatchEvent(fd, events[i].events);
+    }
+  }
+  return count > 0;
+}
+
+void MessagePumpEpoll::DispatchEvent(int fd, uint32 events) {
+  int ready_mode = ReadyMode(events);
+  uint64 dispatch_id = ++last_dispatch_id_;
+
+  // Every callback may watch or stop watching any descriptor, or delete any
+  // controller, so look the list up afresh for each controller called.  There
+  // are rarely more than two controllers per descriptor.
+  for (;;) {
+    ControllerMap::iterator it = controllers_.find(fd);
+    if (it == controllers_.end())
+      return;
+    FileDescriptorWatcher* controller = it->second;
+    while (controller && (controller->dispatch_id_ == dispatch_id ||
+                          !(controller->mode_ & ready_mode))) {
+      controller = controller->next_;
+    }
+    if (!controller)
+      return;
+
+    controller->dispatch_id_ = dispatch_id;
+    // Like a non-persistent libevent event, this fires only once.  The epoll
+    // registration stays in place until the controller re-arms or stops.
+    if (!controller->persistent_)
+      Unlink(controller);
+    controller->OnEpollEvent(controller->mode_ & ready_mode);
+  }
+}
+
+}  // namespace base
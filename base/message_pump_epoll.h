@@ -0,0 +1,212 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MESSAGE_PUMP_EPOLL_H_
+#define BASE_MESSAGE_PUMP_EPOLL_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/hash_tables.h"
+#include "base/message_pump.h"
+#include "base/observer_list.h"
+#include "base/threading/thread_checker.h"
+#include "base/time.h"
+
+namespace base {
+
+// A MessagePump for TYPE_IO loops on Linux that talks to epoll directly
+// instead of going through libevent.  It offers the same interface as
+// MessagePumpLibevent, so MessageLoopForIO can use either one.
+//
+// Wake-ups from ScheduleWork() go through an eventfd and the delayed work
+// deadline is kept in a timerfd, so both are just more descriptors in the same
+// epoll set.  File descriptors are registered edge-triggered: a persistent
+// watcher is only notified again once the descriptor has become ready anew,
+// so it must read or write until it sees EAGAIN.  Non-persistent watchers
+// behave exactly as they do with libevent, because re-arming a descriptor
+// reports its current readiness.
+//
+// Each watched descriptor costs one hash table entry for as long as it is
+// watched; dispatching an event allocates nothing.
+class BASE_EXPORT MessagePumpEpoll : public MessagePump {
+ public:
+  class IOObserver {
+   public:
+    IOObserver() {}
+
+    // An IOObserver is an object that receives IO notifications from the
+    // MessagePump.
+    //
+    // NOTE: An IOObserver implementation should be extremely fast!
+    virtual void WillProcessIOEvent() = 0;
+    virtual void DidProcessIOEvent() = 0;
+
+   protected:
+    virtual ~IOObserver() {}
+  };
+
+  // Used with WatchFileDescriptor to asynchronously monitor the I/O readiness
+  // of a file descriptor.
+  class Watcher {
+   public:
+    virtual ~Watcher() {}
+    // Called from MessageLoop::Run when an FD can be read from/written to
+    // without blocking
+    virtual void OnFileCanReadWithoutBlocking(int fd) = 0;
+    virtual void OnFileCanWriteWithoutBlocking(int fd) = 0;
+  };
+
+  // Object returned by WatchFileDescriptor to manage further watching.  It is
+  // also the registration record itself, so watching allocates nothing beyond
+  // the pump's per-descriptor table entry.
+  class FileDescriptorWatcher {
+   public:
+    FileDescriptorWatcher();
+    ~FileDescriptorWatcher();  // Implicitly calls StopWatchingFileDescriptor.
+
+    // Stop watching the FD, always safe to call.  No-op if there's nothing
+    // to do.
+    bool StopWatchingFileDescriptor();
+
+   private:
+    friend class MessagePumpEpoll;
+    friend class MessagePumpEpollTest;
+
+    // Runs the watcher callbacks for |ready_mode|, a bitwise OR of Mode
+    // values.  May delete |this|.
+    void OnEpollEvent(int ready_mode);
+
+    // The watched descriptor, or -1.
+    int fd_;
+
+    // Bitwise OR of Mode values this controller is interested in.
+    int mode_;
+    bool persistent_;
+
+    // True while the controller is linked into its pump's list for |fd_|.
+    // A non-persistent controller is unlinked as soon as it fires, but keeps
+    // |fd_| and |mode_| so that a later WatchFileDescriptor() call is
+    // cumulative, as it is with libevent.
+    bool registered_;
+
+    // The last event dispatch this controller took part in, see
+    // MessagePumpEpoll::DispatchEvent().
+    uint64 dispatch_id_;
+
+    // Next controller watching the same descriptor.
+    FileDescriptorWatcher* next_;
+
+    MessagePumpEpoll* pump_;
+    Watcher* watcher_;
+
+    // Points at a flag on the stack of OnEpollEvent() while it runs, so that it
+    // can tell whether a callback deleted |this|.
+    bool* was_destroyed_;
+
+    DISALLOW_COPY_AND_ASSIGN(FileDescriptorWatcher);
+  };
+
+  enum Mode {
+    WATCH_READ = 1 << 0,
+    WATCH_WRITE = 1 << 1,
+    WATCH_READ_WRITE = WATCH_READ | WATCH_WRITE
+  };
+
+  MessagePumpEpoll();
+
+  // Same contract as MessagePumpLibevent::WatchFileDescriptor(): watches |fd|
+  // for the readiness in |mode| and calls |delegate| when it happens.  If
+  // |controller| is already watching |fd| the effect is cumulative.  Several
+  // controllers may watch the same descriptor, e.g. one for reading and one
+  // for writing.  Returns true on success.
+  // Must be called on the same thread the message_pump is running on.
+  bool WatchFileDescriptor(int fd,
+                           bool persistent,
+                           Mode mode,
+                           FileDescriptorWatcher* controller,
+                           Watcher* delegate);
+
+  void AddIOObserver(IOObserver* obs);
+  void RemoveIOObserver(IOObserver* obs);
+
+  // MessagePump methods:
+  virtual void Run(Delegate* delegate) OVERRIDE;
+  virtual void Quit() OVERRIDE;
+  virtual void ScheduleWork() OVERRIDE;
+  virtual void ScheduleDelayedWork(const TimeTicks& delayed_work_time) OVERRIDE;
+
+ protected:
+  virtual ~MessagePumpEpoll();
+
+ private:
+  friend class MessagePumpEpollTest;
+
+  // Head of the list of controllers watching each descriptor.  A descriptor
+  // has an entry exactly when it is in the epoll set; the list may be empty
+  // after a non-persistent controller fired, which saves a pair of epoll_ctl()
+  // calls when the controller re-arms right away, as it usually does.
+  typedef hash_map<int, FileDescriptorWatcher*> ControllerMap;
+
+  void WillProcessIOEvent();
+  void DidProcessIOEvent();
+
+  // Risky part of constructor.  Returns true on success.
+  bool Init();
+
+  // Removes |controller| from the list for its descriptor without touching
+  // the epoll set.
+  void Unlink(FileDescriptorWatcher* controller);
+
+  // Unlinks |controller| and updates or drops the epoll registration of its
+  // descriptor accordingly.  Returns false if epoll rejected the update.
+  bool Unregister(FileDescriptorWatcher* controller);
+
+  // Makes the epoll interest set for |fd| match the controllers on its list,
+  // using |op| (EPOLL_CTL_ADD or EPOLL_CTL_MOD).
+  bool UpdateInterest(int fd, int op);
+
+  // Points |timer_fd_| at |delayed_work_time_| if it isn't already.
+  void ArmTimer();
+
+  // Waits up to |timeout_ms| (-1 for forever) for events and dispatches them.
+  // Returns true if any descriptor, including the wake-up ones, was ready.
+  bool ProcessEvents(int timeout_ms);
+
+  // Calls every controller on |fd|'s list that is interested in |events|.
+  void DispatchEvent(int fd, uint32 events);
+
+  // This flag is set to false when Run should return.
+  bool keep_running_;
+
+  // This flag is set when inside Run.
+  bool in_run_;
+
+  // The time at which we should call DoDelayedWork.
+  TimeTicks delayed_work_time_;
+
+  // The deadline |timer_fd_| is currently set to, null if it is disarmed.
+  TimeTicks armed_time_;
+
+  int epoll_fd_;
+
+  // ScheduleWork() adds to this eventfd to interrupt epoll_wait().
+  int wakeup_fd_;
+
+  // Becomes readable when |armed_time_| is reached.
+  int timer_fd_;
+
+  ControllerMap controllers_;
+
+  // Incremented for every dispatched event.
+  uint64 last_dispatch_id_;
+
+  ObserverList<IOObserver> io_observers_;
+  ThreadChecker watch_file_descriptor_caller_checker_;
+  DISALLOW_COPY_AND_ASSIGN(MessagePumpEpoll);
+};
+
+}  // namespace base
+
+#endif  // BASE_MESSAGE_PUMP_EPOLL_H_
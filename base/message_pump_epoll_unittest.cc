@@ -0,0 +1,327 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_pump_epoll.h"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "base/bind.h"
+#include "base/eintr_wrapper.h"
+#include "base/message_loop.h"
+#include "base/threading/thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+class MessagePumpEpollTest : public testing::Test {
+ protected:
+  MessagePumpEpollTest()
+      : pump_(new MessagePumpEpoll),
+        io_thread_("MessagePumpEpollTestIOThread") {}
+  virtual ~MessagePumpEpollTest() {}
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_EQ(0, pipe(pipe_fds_));
+    Thread::Options options(MessageLoop::TYPE_IO, 0);
+    ASSERT_TRUE(io_thread_.StartWithOptions(options));
+    ASSERT_EQ(MessageLoop::TYPE_IO, io_thread_.message_loop()->type());
+  }
+
+  virtual void TearDown() OVERRIDE {
+    EXPECT_EQ(0, HANDLE_EINTR(close(pipe_fds_[0])));
+    EXPECT_EQ(0, HANDLE_EINTR(close(pipe_fds_[1])));
+  }
+
+  MessageLoopForIO* io_loop() const {
+    return static_cast<MessageLoopForIO*>(io_thread_.message_loop());
+  }
+
+  int read_fd() const { return pipe_fds_[0]; }
+  int write_fd() const { return pipe_fds_[1]; }
+
+  // Spoofs an epoll notification for |fd|.
+  void DispatchEvent(int fd, uint32 events) {
+    pump_->DispatchEvent(fd, events);
+  }
+
+  size_t watched_fd_count() const { return pump_->controllers_.size(); }
+
+  scoped_refptr<MessagePumpEpoll> pump_;
+  Thread io_thread_;
+  int pipe_fds_[2];
+};
+
+namespace {
+
+// Concrete implementation of MessagePumpEpoll::Watcher that does nothing
+// useful.
+class StupidWatcher : public MessagePumpEpoll::Watcher {
+ public:
+  virtual ~StupidWatcher() {}
+
+  // base:MessagePumpEpoll::Watcher interface
+  virtual void OnFileCanReadWithoutBlocking(int fd) OVERRIDE {}
+  virtual void OnFileCanWriteWithoutBlocking(int fd) OVERRIDE {}
+};
+
+#if defined(USE_EPOLL_MESSAGE_PUMP) && GTEST_HAS_DEATH_TEST && \
+    !defined(NDEBUG)
+
+// Test to make sure that we catch calling WatchFileDescriptor off of the
+// wrong thread.
+TEST_F(MessagePumpEpollTest, TestWatchingFromBadThread) {
+  MessagePumpEpoll::FileDescriptorWatcher watcher;
+  StupidWatcher delegate;
+
+  ASSERT_DEATH(io_loop()->WatchFileDescriptor(
+      read_fd(), false, MessageLoopForIO::WATCH_READ, &watcher, &delegate),
+      "Check failed: "
+      "watch_file_descriptor_caller_checker_.CalledOnValidThread()");
+}
+
+#endif  // USE_EPOLL_MESSAGE_PUMP && GTEST_HAS_DEATH_TEST && !NDEBUG
+
+class DeleteWatcher : public MessagePumpEpoll::Watcher {
+ public:
+  explicit DeleteWatcher(MessagePumpEpoll::FileDescriptorWatcher* controller)
+      : controller_(controller) {
+    DCHECK(controller_);
+  }
+  virtual ~DeleteWatcher() {
+    DCHECK(!controller_);
+  }
+
+  // base:MessagePumpEpoll::Watcher interface
+  virtual void OnFileCanReadWithoutBlocking(int /* fd */) OVERRIDE {
+    NOTREACHED();
+  }
+  virtual void OnFileCanWriteWithoutBlocking(int /* fd */) OVERRIDE {
+    DCHECK(controller_);
+    delete controller_;
+    controller_ = NULL;
+  }
+
+ private:
+  MessagePumpEpoll::FileDescriptorWatcher* controller_;
+};
+
+TEST_F(MessagePumpEpollTest, DeleteWatcher) {
+  MessagePumpEpoll::FileDescriptorWatcher* watcher =
+      new MessagePumpEpoll::FileDescriptorWatcher;
+  DeleteWatcher delegate(watcher);
+  ASSERT_TRUE(pump_->WatchFileDescriptor(
+      read_fd(), false, MessagePumpEpoll::WATCH_READ_WRITE, watcher,
+      &delegate));
+
+  DispatchEvent(read_fd(), EPOLLOUT | EPOLLIN);
+  EXPECT_EQ(0u, watched_fd_count());
+}
+
+class StopWatcher : public MessagePumpEpoll::Watcher {
+ public:
+  explicit StopWatcher(MessagePumpEpoll::FileDescriptorWatcher* controller)
+      : controller_(controller) {
+    DCHECK(controller_);
+  }
+  virtual ~StopWatcher() {}
+
+  // base:MessagePumpEpoll::Watcher interface
+  virtual void OnFileCanReadWithoutBlocking(int /* fd */) OVERRIDE {
+    NOTREACHED();
+  }
+  virtual void OnFileCanWriteWithoutBlocking(int /* fd */) OVERRIDE {
+    controller_->StopWatchingFileDescriptor();
+  }
+
+ private:
+  MessagePumpEpoll::FileDescriptorWatcher* const controller_;
+};
+
+TEST_F(MessagePumpEpollTest, StopWatcher) {
+  MessagePumpEpoll::FileDescriptorWatcher watcher;
+  StopWatcher delegate(&watcher);
+  ASSERT_TRUE(pump_->WatchFileDescriptor(
+      read_fd(), false, MessagePumpEpoll::WATCH_READ_WRITE, &watcher,
+      &delegate));
+
+  DispatchEvent(read_fd(), EPOLLOUT | EPOLLIN);
+  EXPECT_EQ(0u, watched_fd_count());
+}
+
+// Counts notifications and optionally quits the pump on the first one.
+class CountingWatcher : public MessagePumpEpoll::Watcher {
+ public:
+  explicit CountingWatcher(MessagePump* pump_to_quit)
+      : pump_to_quit_(pump_to_quit),
+        reads_(0),
+        writes_(0) {
+  }
+  virtual ~CountingWatcher() {}
+
+  // base:MessagePumpEpoll::Watcher interface
+  virtual void OnFileCanReadWithoutBlocking(int fd) OVERRIDE {
+    ++reads_;
+    char buf;
+    EXPECT_EQ(1, HANDLE_EINTR(read(fd, &buf, 1)));
+    if (pump_to_quit_)
+      pump_to_quit_->Quit();
+  }
+  virtual void OnFileCanWriteWithoutBlocking(int fd) OVERRIDE {
+    ++writes_;
+    if (pump_to_quit_)
+      pump_to_quit_->Quit();
+  }
+
+  int reads() const { return reads_; }
+  int writes() const { return writes_; }
+
+ private:
+  MessagePump* pump_to_quit_;
+  int reads_;
+  int writes_;
+};
+
+// A MessagePump::Delegate with no work of its own other than an optional
+// deadline after which it quits the pump.
+class QuitDelegate : public MessagePump::Delegate {
+ public:
+  explicit QuitDelegate(MessagePump* pump) : pump_(pump) {}
+  virtual ~QuitDelegate() {}
+
+  void set_quit_time(const TimeTicks& quit_time) { quit_time_ = quit_time; }
+
+  // base::MessagePump::Delegate interface
+  virtual bool DoWork() OVERRIDE { return false; }
+  virtual bool DoDelayedWork(TimeTicks* next_delayed_work_time) OVERRIDE {
+    if (quit_time_.is_null() || TimeTicks::Now() < quit_time_) {
+      *next_delayed_work_time = quit_time_;
+      return false;
+    }
+    quit_time_ = TimeTicks();
+    *next_delayed_work_time = TimeTicks();
+    pump_->Quit();
+    return true;
+  }
+  virtual bool DoIdleWork() OVERRIDE { return false; }
+
+ private:
+  MessagePump* pump_;
+  TimeTicks quit_time_;
+};
+
+TEST_F(MessagePumpEpollTest, ReadReadiness) {
+  MessagePumpEpoll::FileDescriptorWatcher watcher;
+  CountingWatcher delegate(pump_);
+  ASSERT_TRUE(pump_->WatchFileDescriptor(
+      read_fd(), true, MessagePumpEpoll::WATCH_READ, &watcher, &delegate));
+
+  char buf = 0;
+  ASSERT_EQ(1, HANDLE_EINTR(write(write_fd(), &buf, 1)));
+  QuitDelegate quit_delegate(pump_);
+  pump_->Run(&quit_delegate);
+  EXPECT_EQ(1, delegate.reads());
+  EXPECT_EQ(0, delegate.writes());
+  EXPECT_EQ(1u, watched_fd_count());
+
+  EXPECT_TRUE(watcher.StopWatchingFileDescriptor());
+  EXPECT_EQ(0u, watched_fd_count());
+}
+
+// A non-persistent watcher that re-arms is told about readiness that arrived
+// while it was not watching, even though watchers are edge-triggered.
+TEST_F(MessagePumpEpollTest, NonPersistentRearm) {
+  MessagePumpEpoll::FileDescriptorWatcher watcher;
+  CountingWatcher delegate(pump_);
+  char buf = 0;
+  for (int i = 1; i <= 3; ++i) {
+    ASSERT_TRUE(pump_->WatchFileDescriptor(
+        read_fd(), false, MessagePumpEpoll::WATCH_READ, &watcher, &delegate));
+    ASSERT_EQ(1, HANDLE_EINTR(write(write_fd(), &buf, 1)));
+    QuitDelegate quit_delegate(pump_);
+    pump_->Run(&quit_delegate);
+    EXPECT_EQ(i, delegate.reads());
+  }
+
+  // Write before re-arming this time.
+  ASSERT_EQ(1, HANDLE_EINTR(write(write_fd(), &buf, 1)));
+  ASSERT_TRUE(pump_->WatchFileDescriptor(
+      read_fd(), false, MessagePumpEpoll::WATCH_READ, &watcher, &delegate));
+  QuitDelegate quit_delegate(pump_);
+  pump_->Run(&quit_delegate);
+  EXPECT_EQ(4, delegate.reads());
+}
+
+// Separate controllers for reading and writing may share a descriptor.
+TEST_F(MessagePumpEpollTest, TwoControllersOneDescriptor) {
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  int fd = fds[1];
+  MessagePumpEpoll::FileDescriptorWatcher write_watcher;
+  CountingWatcher write_delegate(pump_);
+  MessagePumpEpoll::FileDescriptorWatcher read_watcher;
+  CountingWatcher read_delegate(NULL);
+  ASSERT_TRUE(pump_->WatchFileDescriptor(
+      fd, true, MessagePumpEpoll::WATCH_READ, &read_watcher, &read_delegate));
+  ASSERT_TRUE(pump_->WatchFileDescriptor(
+      fd, true, MessagePumpEpoll::WATCH_WRITE, &write_watcher,
+      &write_delegate));
+  EXPECT_EQ(1u, watched_fd_count());
+
+  // The write end of an empty pipe is writable.
+  QuitDelegate quit_delegate(pump_);
+  pump_->Run(&quit_delegate);
+  EXPECT_EQ(1, write_delegate.writes());
+  EXPECT_EQ(0, read_delegate.reads());
+
+  EXPECT_TRUE(write_watcher.StopWatchingFileDescriptor());
+  EXPECT_EQ(1u, watched_fd_count());
+  EXPECT_TRUE(read_watcher.StopWatchingFileDescriptor());
+  EXPECT_EQ(0u, watched_fd_count());
+  EXPECT_EQ(0, HANDLE_EINTR(close(fds[0])));
+  EXPECT_EQ(0, HANDLE_EINTR(close(fds[1])));
+}
+
+TEST_F(MessagePumpEpollTest, DelayedWork) {
+  QuitDelegate quit_delegate(pump_);
+  TimeTicks start = TimeTicks::Now();
+  quit_delegate.set_quit_time(start + TimeDelta::FromMilliseconds(20));
+  pump_->ScheduleDelayedWork(start + TimeDelta::FromMilliseconds(20));
+  pump_->Run(&quit_delegate);
+  EXPECT_GE(TimeTicks::Now() - start, TimeDelta::FromMilliseconds(20));
+}
+
+// Quits on the second DoWork() call, which only happens once ScheduleWork()
+// has woken up the blocked pump.
+class ScheduleWorkDelegate : public QuitDelegate {
+ public:
+  explicit ScheduleWorkDelegate(MessagePump* pump)
+      : QuitDelegate(pump),
+        pump_(pump),
+        work_calls_(0) {
+  }
+
+  virtual bool DoWork() OVERRIDE {
+    if (++work_calls_ == 2)
+      pump_->Quit();
+    return false;
+  }
+
+ private:
+  MessagePump* pump_;
+  int work_calls_;
+};
+
+TEST_F(MessagePumpEpollTest, ScheduleWorkFromOtherThread) {
+  ScheduleWorkDelegate delegate(pump_);
+  io_loop()->PostDelayedTask(
+      FROM_HERE,
+      Bind(&MessagePumpEpoll::ScheduleWork, pump_),
+      TimeDelta::FromMilliseconds(10));
+  pump_->Run(&delegate);
+}
+
+}  // namespace
+
+}  // namespace base
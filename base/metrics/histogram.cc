@@ -10,12 +10,15 @@
 #include "base/metrics/histogram.h"
 
 #include <math.h>
+#include <string.h>
 
 #include <algorithm>
 #include <string>
 
 #include "base/debug/leak_annotations.h"
 #include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/metrics/shared_histogram_table.h"
 #include "base/pickle.h"
 #include "base/stringprintf.h"
 #include "base/synchronization/lock.h"
@@ -74,6 +77,57 @@ typedef Histogram::Count Count;
 // static
 const size_t Histogram::kBucketCount_MAX = 16384u;
 
+namespace {
+
+// Adds |delta| to |*total| without a lock.  32-bit builds lack 64-bit atomics,
+// so there an update that races with another one may get lost.  The bucket
+// counts are always exact.
+void AtomicAdd64(int64* total, int64 delta) {
+#if defined(ARCH_CPU_64_BITS)
+  subtle::NoBarrier_AtomicIncrement(
+      reinterpret_cast<volatile subtle::Atomic64*>(total), delta);
+#else
+  *total += delta;
+#endif
+}
+
+int64 AtomicLoad64(const int64* total) {
+#if defined(ARCH_CPU_64_BITS)
+  return subtle::NoBarrier_Load(
+      reinterpret_cast<volatile const subtle::Atomic64*>(total));
+#else
+  return *total;
+#endif
+}
+
+// The counterparts of SampleSet::Accumulate() and SampleSet::Add() for a
+// histogram whose samples live in a SharedHistogramTable.
+void AccumulateToSharedRecord(Histogram::Sample value,
+                              Histogram::Count count,
+                              size_t index,
+                              SharedHistogramRecord* record) {
+  DCHECK(count == 1 || count == -1);
+  Histogram::Count new_count =
+      subtle::NoBarrier_AtomicIncrement(&record->counts()[index], count);
+  AtomicAdd64(&record->sum, static_cast<int64>(count) * value);
+  AtomicAdd64(&record->redundant_count, count);
+  DCHECK_GE(new_count, 0);
+}
+
+void AddToSharedRecord(const Histogram::SampleSet& sample,
+                       SharedHistogramRecord* record) {
+  AtomicAdd64(&record->sum, sample.sum());
+  AtomicAdd64(&record->redundant_count, sample.redundant_count());
+  subtle::Atomic32* counts = record->counts();
+  for (int index = 0; index < record->bucket_count; ++index)
+    subtle::NoBarrier_AtomicIncrement(&counts[index], sample.counts(index));
+}
+
+// The number of slots of the first StatisticsRecorder::LookupTable.
+const size_t kInitialLookupTableCapacity = 512;
+
+}  // namespace
+
 // Collect the number of histograms created.
 static uint32 number_of_histograms_ = 0;
 // Collect the number of vectors saved because of caching ranges.
@@ -149,6 +203,10 @@ void Histogram::AddBoolean(bool value) {
 }
 
 void Histogram::AddSampleSet(const SampleSet& sample) {
+  if (shared_record_) {
+    AddToSharedRecord(sample, shared_record_);
+    return;
+  }
   sample_.Add(sample);
 }
 
@@ -396,8 +454,11 @@ size_t Histogram::bucket_count() const {
 // Do a safe atomic snapshot of sample data.
 // This implementation assumes we are on a safe single thread.
 void Histogram::SnapshotSample(SampleSet* sample) const {
-  // Note locking not done in this version!!!
-  *sample = sample_;
+  if (shared_record_) {
+    sample->SnapshotFrom(*shared_record_);
+    return;
+  }
+  sample->SnapshotFrom(sample_);
 }
 
 bool Histogram::HasConstructorArguments(Sample minimum,
@@ -428,7 +489,8 @@ Histogram::Histogram(const std::string& name, Sample minimum,
     flags_(kNoFlags),
     cached_ranges_(new CachedRanges(bucket_count + 1, 0)),
     range_checksum_(0),
-    sample_() {
+    sample_(),
+    shared_record_(NULL) {
   Initialize();
 }
 
@@ -441,7 +503,8 @@ Histogram::Histogram(const std::string& name, TimeDelta minimum,
     flags_(kNoFlags),
     cached_ranges_(new CachedRanges(bucket_count + 1, 0)),
     range_checksum_(0),
-    sample_() {
+    sample_(),
+    shared_record_(NULL) {
   Initialize();
 }
 
@@ -553,7 +616,10 @@ const std::string Histogram::GetAsciiBucketRange(size_t i) const {
 
 // Update histogram data with new sample.
 void Histogram::Accumulate(Sample value, Count count, size_t index) {
-  // Note locking not done in this version!!!
+  if (shared_record_) {
+    AccumulateToSharedRecord(value, count, index, shared_record_);
+    return;
+  }
   sample_.Accumulate(value, count, index);
 }
 
@@ -721,12 +787,27 @@ void Histogram::SampleSet::CheckSize(const Histogram& histogram) const {
 void Histogram::SampleSet::Accumulate(Sample value,  Count count,
                                       size_t index) {
   DCHECK(count == 1 || count == -1);
-  counts_[index] += count;
-  sum_ += count * value;
-  redundant_count_ += count;
-  DCHECK_GE(counts_[index], 0);
-  DCHECK_GE(sum_, 0);
-  DCHECK_GE(redundant_count_, 0);
+  Count new_count = subtle::NoBarrier_AtomicIncrement(&counts_[index], count);
+  AtomicAdd64(&sum_, static_cast<int64>(count) * value);
+  AtomicAdd64(&redundant_count_, count);
+  DCHECK_GE(new_count, 0);
+}
+
+void Histogram::SampleSet::SnapshotFrom(const SampleSet& other) {
+  counts_.resize(other.counts_.size());
+  for (size_t index = 0; index < counts_.size(); ++index)
+    counts_[index] = subtle::NoBarrier_Load(&other.counts_[index]);
+  sum_ = AtomicLoad64(&other.sum_);
+  redundant_count_ = AtomicLoad64(&other.redundant_count_);
+}
+
+void Histogram::SampleSet::SnapshotFrom(const SharedHistogramRecord& other) {
+  counts_.resize(other.bucket_count);
+  const subtle::Atomic32* counts = other.counts();
+  for (size_t index = 0; index < counts_.size(); ++index)
+    counts_[index] = subtle::NoBarrier_Load(&counts[index]);
+  sum_ = AtomicLoad64(&other.sum);
+  redundant_count_ = AtomicLoad64(&other.redundant_count);
 }
 
 Count Histogram::SampleSet::TotalCount() const {
@@ -741,10 +822,10 @@ Count Histogram::SampleSet::TotalCount() const {
 
 void Histogram::SampleSet::Add(const SampleSet& other) {
   DCHECK_EQ(counts_.size(), other.counts_.size());
-  sum_ += other.sum_;
-  redundant_count_ += other.redundant_count_;
+  AtomicAdd64(&sum_, other.sum_);
+  AtomicAdd64(&redundant_count_, other.redundant_count_);
   for (size_t index = 0; index < counts_.size(); ++index)
-    counts_[index] += other.counts_[index];
+    subtle::NoBarrier_AtomicIncrement(&counts_[index], other.counts_[index]);
 }
 
 void Histogram::SampleSet::Subtract(const SampleSet& other) {
@@ -1042,6 +1123,66 @@ double CustomHistogram::GetBucketSize(Count current, size_t i) const {
 // as startup/teardown of this service.
 //------------------------------------------------------------------------------
 
+// An open addressed hash table of histograms, keyed by name.  Writers hold
+// StatisticsRecorder::lock_ and publish a histogram with a release store, so
+// that readers may probe the table at any time.  Histograms are never removed,
+// and the table is kept at most half full, so that probes are short and always
+// find an empty slot.
+class StatisticsRecorder::LookupTable {
+ public:
+  explicit LookupTable(size_t capacity)
+      : capacity_(capacity),
+        size_(0),
+        slots_(new subtle::AtomicWord[capacity]) {
+    DCHECK_EQ(0u, capacity_ & (capacity_ - 1)) << "Not a power of two";
+    memset(slots_.get(), 0, capacity_ * sizeof(slots_[0]));
+  }
+
+  size_t capacity() const { return capacity_; }
+
+  // Whether another histogram would make the table more than half full.
+  bool IsFull() const { return 2 * (size_ + 1) > capacity_; }
+
+  Histogram* Find(const std::string& name) const {
+    for (size_t i = Hash(name); ; i = (i + 1) & (capacity_ - 1)) {
+      Histogram* histogram =
+          reinterpret_cast<Histogram*>(subtle::Acquire_Load(&slots_[i]));
+      if (!histogram)
+        return NULL;
+      if (histogram->histogram_name() == name)
+        return histogram;
+    }
+  }
+
+  void Insert(Histogram* histogram) {
+    DCHECK(!IsFull());
+    size_t i = Hash(histogram->histogram_name());
+    while (subtle::NoBarrier_Load(&slots_[i]))
+      i = (i + 1) & (capacity_ - 1);
+    // Makes the histogram visible to Find() only once it is all written.
+    subtle::Release_Store(&slots_[i],
+                          reinterpret_cast<subtle::AtomicWord>(histogram));
+    ++size_;
+  }
+
+ private:
+  // FNV-1a, reduced to a slot index.
+  size_t Hash(const std::string& name) const {
+    uint32 hash = 2166136261u;
+    for (size_t i = 0; i < name.size(); ++i) {
+      hash ^= static_cast<unsigned char>(name[i]);
+      hash *= 16777619u;
+    }
+    return hash & (capacity_ - 1);
+  }
+
+  const size_t capacity_;
+  size_t size_;
+  scoped_array<subtle::AtomicWord> slots_;
+
+  DISALLOW_COPY_AND_ASSIGN(LookupTable);
+};
+
 // This singleton instance should be started during the single threaded portion
 // of main(), and hence it is not thread safe.  It initializes globals to
 // provide support for all future calls.
@@ -1059,6 +1200,8 @@ StatisticsRecorder::StatisticsRecorder() {
   base::AutoLock auto_lock(*lock_);
   histograms_ = new HistogramMap;
   ranges_ = new RangesMap;
+  subtle::Release_Store(&lookup_table_, reinterpret_cast<subtle::AtomicWord>(
+      new LookupTable(kInitialLookupTableCapacity)));
 }
 
 StatisticsRecorder::~StatisticsRecorder() {
@@ -1075,6 +1218,10 @@ StatisticsRecorder::~StatisticsRecorder() {
     base::AutoLock auto_lock(*lock_);
     histograms = histograms_;
     histograms_ = NULL;
+    // Readers may still be probing the table, so it is leaked.
+    ANNOTATE_LEAKING_OBJECT_PTR(
+        reinterpret_cast<LookupTable*>(subtle::NoBarrier_Load(&lookup_table_)));
+    subtle::NoBarrier_Store(&lookup_table_, 0);
   }
   RangesMap* ranges = NULL;
   {
@@ -1091,10 +1238,7 @@ StatisticsRecorder::~StatisticsRecorder() {
 
 // static
 bool StatisticsRecorder::IsActive() {
-  if (lock_ == NULL)
-    return false;
-  base::AutoLock auto_lock(*lock_);
-  return NULL != histograms_;
+  return subtle::Acquire_Load(&lookup_table_) != 0;
 }
 
 Histogram* StatisticsRecorder::RegisterOrDeleteDuplicate(Histogram* histogram) {
@@ -1117,7 +1261,15 @@ Histogram* StatisticsRecorder::RegisterOrDeleteDuplicate(Histogram* histogram) {
   HistogramMap::iterator it = histograms_->find(name);
   // Avoid overwriting a previous registration.
   if (histograms_->end() == it) {
+    // Move the samples to the shared table before other threads can find the
+    // histogram.
+    SharedHistogramTable* shared_table = SharedHistogramTable::current();
+    if (shared_table) {
+      histogram->shared_record_ =
+          shared_table->AllocateRecord(*histogram, histogram->sample_);
+    }
     (*histograms_)[name] = histogram;
+    AddToLookupTable(histogram);
     ANNOTATE_LEAKING_OBJECT_PTR(histogram);  // see crbug.com/79322
     RegisterOrDeleteDuplicateRanges(histogram);
     ++number_of_histograms_;
@@ -1170,6 +1322,27 @@ void StatisticsRecorder::RegisterOrDeleteDuplicateRanges(Histogram* histogram) {
   checksum_matching_list->push_front(histogram_ranges);
 }
 
+// static
+void StatisticsRecorder::AddToLookupTable(Histogram* histogram) {
+  lock_->AssertAcquired();
+  LookupTable* table =
+      reinterpret_cast<LookupTable*>(subtle::NoBarrier_Load(&lookup_table_));
+  if (!table->IsFull()) {
+    table->Insert(histogram);
+    return;
+  }
+  // |histograms_| already holds |histogram|.
+  LookupTable* larger_table = new LookupTable(2 * table->capacity());
+  for (HistogramMap::iterator it = histograms_->begin();
+       histograms_->end() != it;
+       ++it) {
+    larger_table->Insert(it->second);
+  }
+  ANNOTATE_LEAKING_OBJECT_PTR(table);
+  subtle::Release_Store(&lookup_table_,
+                        reinterpret_cast<subtle::AtomicWord>(larger_table));
+}
+
 // static
 void StatisticsRecorder::CollectHistogramStats(const std::string& suffix) {
   static int uma_upload_attempt = 0;
@@ -1268,15 +1441,14 @@ void StatisticsRecorder::GetHistograms(Histograms* output) {
 
 bool StatisticsRecorder::FindHistogram(const std::string& name,
                                        Histogram** histogram) {
-  if (lock_ == NULL)
+  LookupTable* table =
+      reinterpret_cast<LookupTable*>(subtle::Acquire_Load(&lookup_table_));
+  if (!table)
     return false;
-  base::AutoLock auto_lock(*lock_);
-  if (!histograms_)
+  Histogram* found = table->Find(name);
+  if (!found)
     return false;
-  HistogramMap::iterator it = histograms_->find(name);
-  if (histograms_->end() == it)
-    return false;
-  *histogram = it->second;
+  *histogram = found;
   return true;
 }
 
@@ -1329,5 +1501,7 @@ StatisticsRecorder::RangesMap* StatisticsRecorder::ranges_ = NULL;
 // static
 base::Lock* StatisticsRecorder::lock_ = NULL;
 // static
+subtle::AtomicWord StatisticsRecorder::lookup_table_ = 0;
+// static
 bool StatisticsRecorder::dump_on_exit_ = false;
 }  // namespace base
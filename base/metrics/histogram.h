@@ -59,6 +59,7 @@ class PickleIterator;
 namespace base {
 
 class Lock;
+struct SharedHistogramRecord;
 //------------------------------------------------------------------------------
 // Histograms are often put in areas where they are called many many times, and
 // performance is critical.  As a result, they are designed to have a very low
@@ -391,16 +392,24 @@ class BASE_EXPORT Histogram {
     void Resize(const Histogram& histogram);
     void CheckSize(const Histogram& histogram) const;
 
-    // Accessor for histogram to make routine additions.
+    // Accessor for histogram to make routine additions.  Safe to call from
+    // several threads at once without a lock.
     void Accumulate(Sample value, Count count, size_t index);
 
+    // Copies |other|, which other threads may be accumulating into meanwhile.
+    void SnapshotFrom(const SampleSet& other);
+    // Same, from a histogram's record in a SharedHistogramTable, which other
+    // processes may be accumulating into meanwhile.
+    void SnapshotFrom(const SharedHistogramRecord& other);
+
     // Accessor methods.
     Count counts(size_t i) const { return counts_[i]; }
     Count TotalCount() const;
     int64 sum() const { return sum_; }
     int64 redundant_count() const { return redundant_count_; }
 
-    // Arithmetic manipulation of corresponding elements of the set.
+    // Arithmetic manipulation of corresponding elements of the set.  Add() is
+    // as thread safe as Accumulate().
     void Add(const SampleSet& other);
     void Subtract(const SampleSet& other);
 
@@ -423,10 +432,9 @@ class BASE_EXPORT Histogram {
     // To help identify memory corruption, we reduntantly save the number of
     // samples we've accumulated into all of our buckets.  We can compare this
     // count to the sum of the counts in all buckets, and detect problems.  Note
-    // that due to races in histogram accumulation (if a histogram is indeed
-    // updated on several threads simultaneously), the tallies might mismatch,
-    // and also the snapshotting code may asynchronously get a mismatch (though
-    // generally either race based mismatch cause is VERY rare).
+    // that the snapshotting code may asynchronously get a mismatch if a
+    // histogram is updated on other threads while it is copied (though this is
+    // VERY rare).
     int64 redundant_count_;
   };
 
@@ -519,7 +527,8 @@ class BASE_EXPORT Histogram {
     cached_ranges_ = cached_ranges;
   }
   // Snapshot the current complete set of sample data.
-  // Override with atomic/locked snapshot if needed.
+  // Each bucket is read atomically, but samples that are being added meanwhile
+  // may be missing from some of the totals.
   virtual void SnapshotSample(SampleSet* sample) const;
 
   virtual bool HasConstructorArguments(Sample minimum, Sample maximum,
@@ -657,6 +666,11 @@ class BASE_EXPORT Histogram {
   // sample.
   SampleSet sample_;
 
+  // The record of the histogram in SharedHistogramTable::current(), if it got
+  // one when it was registered.  The record then holds the samples instead of
+  // |sample_|.
+  SharedHistogramRecord* shared_record_;
+
   DISALLOW_COPY_AND_ASSIGN(Histogram);
 };
 
@@ -820,8 +834,8 @@ class BASE_EXPORT StatisticsRecorder {
   static void GetHistograms(Histograms* output);
 
   // Find a histogram by name. It matches the exact name. This method is thread
-  // safe.  If a matching histogram is not found, then the |histogram| is
-  // not changed.
+  // safe, and does not take a lock.  If a matching histogram is not found,
+  // then the |histogram| is not changed.
   static bool FindHistogram(const std::string& query, Histogram** histogram);
 
   static bool dump_on_exit() { return dump_on_exit_; }
@@ -839,6 +853,14 @@ class BASE_EXPORT StatisticsRecorder {
   // We keep all registered histograms in a map, from name to histogram.
   typedef std::map<std::string, Histogram*> HistogramMap;
 
+  // An index of |histograms_| that FindHistogram() probes without taking
+  // |lock_|.
+  class LookupTable;
+
+  // Adds |histogram| to |lookup_table_|, replacing the table with a larger one
+  // if it is getting full.  |lock_| must be held.
+  static void AddToLookupTable(Histogram* histogram);
+
   // We keep all |cached_ranges_| in a map, from checksum to a list of
   // |cached_ranges_|.  Checksum is calculated from the |ranges_| in
   // |cached_ranges_|.
@@ -851,6 +873,12 @@ class BASE_EXPORT StatisticsRecorder {
   // lock protects access to the above map.
   static base::Lock* lock_;
 
+  // The LookupTable of the registered histograms, or 0 while there is no
+  // StatisticsRecorder.  Only ever replaced under |lock_|.  Replaced tables
+  // are leaked, because a reader may still be probing them, like the
+  // histograms they point to.
+  static base::subtle::AtomicWord lookup_table_;
+
   // Dump all known histograms to log.
   static bool dump_on_exit_;
 
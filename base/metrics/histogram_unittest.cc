@@ -9,6 +9,8 @@
 
 #include "base/memory/scoped_ptr.h"
 #include "base/metrics/histogram.h"
+#include "base/stringprintf.h"
+#include "base/threading/simple_thread.h"
 #include "base/time.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -347,6 +349,77 @@ TEST(HistogramTest, BucketPlacementTest) {
     EXPECT_EQ(i + 1, sample.counts(i));
 }
 
+// Adds |num_samples| samples, 0 to 63 over and over, to a histogram.
+class AddSamplesDelegate : public DelegateSimpleThread::Delegate {
+ public:
+  AddSamplesDelegate(Histogram* histogram, int num_samples)
+      : histogram_(histogram),
+        num_samples_(num_samples) {
+  }
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < num_samples_; ++i)
+      histogram_->Add(i % 64);
+  }
+
+ private:
+  Histogram* histogram_;
+  int num_samples_;
+};
+
+// Samples that several threads add at once are all counted.
+TEST(HistogramTest, ConcurrentAddTest) {
+  Histogram* histogram(LinearHistogram::FactoryGet(
+      "ConcurrentHistogram", 1, 64, 65, Histogram::kNoFlags));
+
+  const int kNumThreads = 4;
+  const int kNumSamples = 64 * 10000;
+  AddSamplesDelegate delegate(histogram, kNumSamples);
+  std::vector<DelegateSimpleThread*> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(new DelegateSimpleThread(&delegate, "AddSamples"));
+    threads.back()->Start();
+  }
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads[i]->Join();
+    delete threads[i];
+  }
+
+  Histogram::SampleSet snapshot;
+  histogram->SnapshotSample(&snapshot);
+  EXPECT_EQ(Histogram::NO_INCONSISTENCIES, histogram->FindCorruption(snapshot));
+  EXPECT_EQ(kNumThreads * kNumSamples, snapshot.TotalCount());
+  EXPECT_EQ(kNumThreads * kNumSamples, snapshot.redundant_count());
+  for (size_t i = 0; i < 64; ++i)
+    EXPECT_EQ(kNumThreads * kNumSamples / 64, snapshot.counts(i));
+#if defined(ARCH_CPU_64_BITS)
+  // 32-bit builds may lose updates of the sum.
+  EXPECT_EQ(kNumThreads * (kNumSamples / 64) * (63 * 64 / 2), snapshot.sum());
+#endif
+}
+
+// FindHistogram() keeps finding histograms as the registry grows.
+TEST(HistogramTest, FindHistogramTest) {
+  StatisticsRecorder recorder;
+  Histogram* found = NULL;
+  EXPECT_FALSE(StatisticsRecorder::FindHistogram("FindHistogram0", &found));
+
+  const int kNumHistograms = 2000;
+  std::vector<Histogram*> histograms;
+  for (int i = 0; i < kNumHistograms; ++i) {
+    histograms.push_back(Histogram::FactoryGet(
+        StringPrintf("FindHistogram%d", i), 1, 64, 8, Histogram::kNoFlags));
+  }
+  for (int i = 0; i < kNumHistograms; ++i) {
+    found = NULL;
+    EXPECT_TRUE(StatisticsRecorder::FindHistogram(
+        StringPrintf("FindHistogram%d", i), &found));
+    EXPECT_EQ(histograms[i], found);
+  }
+  EXPECT_FALSE(StatisticsRecorder::FindHistogram("FindHistogram", &found));
+  EXPECT_EQ(histograms.back(), found);
+}
+
 }  // namespace
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,307 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/shared_histogram_table.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/process_util.h"
+#include "base/shared_memory.h"
+
+namespace base {
+
+// The SharedHistogramTable uses a shared memory segment that is laid out as
+// follows
+//
+// +-----------------------------------------------------------------+
+// | Version | Size | MaxHistograms | DataSize | NumRecords | UsedSize |
+// +-----------------------------------------------------------------+
+// | Record offsets table                                            |
+// +-----------------------------------------------------------------+
+// | Data                                                            |
+// +-----------------------------------------------------------------+
+//
+// Records are carved out of the data area one after the other.  The offsets
+// table holds the offset of every record in the data area, in the order they
+// were allocated.  A record is set up completely before NumRecords is raised
+// with a release store, so that readers never see a partial record.
+
+namespace {
+
+// An internal version in case we ever change the format of this
+// file, and so that we can identify our table.
+const int kTableVersion = 0x48495354;
+
+// Calculates delta to align an offset to 8 bytes, for the int64 fields of the
+// records.
+inline int AlignOffset(int offset) {
+  return (8 - (offset % 8)) % 8;
+}
+
+inline int AlignedSize(int size) {
+  return size + AlignOffset(size);
+}
+
+// The number of bytes a record with |bucket_count| buckets uses.
+inline int RecordSize(size_t bucket_count) {
+  return AlignedSize(sizeof(SharedHistogramRecord) +
+                     (bucket_count + 1) * sizeof(Histogram::Sample) +
+                     bucket_count * sizeof(subtle::Atomic32));
+}
+
+}  // namespace
+
+// The SharedHistogramTable::Private maintains convenience pointers into the
+// shared memory segment.
+class SharedHistogramTable::Private {
+ public:
+  // Various header information contained in the memory mapped segment.
+  struct TableHeader {
+    int version;
+    int size;
+    int max_histograms;
+    int data_size;
+    subtle::Atomic32 num_records;
+    int used_size;
+  };
+
+  // Construct a new Private based on expected size parameters, or
+  // return NULL on failure.
+  static Private* New(const std::string& name, int size, int max_histograms,
+                      int data_size);
+
+  SharedMemory* shared_memory() { return &shared_memory_; }
+
+  TableHeader* table_header() const { return table_header_; }
+  int max_histograms() const { return table_header_->max_histograms; }
+
+  SharedHistogramRecord* record(int index) const {
+    return reinterpret_cast<SharedHistogramRecord*>(
+        data_ + record_offsets_[index]);
+  }
+
+  // Carves a record of |record_size| bytes out of the data area and returns
+  // its index, or -1 if there is no room.  The shared memory must be locked.
+  int AddRecord(int record_size);
+
+ private:
+  // Constructor is private because you should use New() instead.
+  Private()
+      : table_header_(NULL),
+        record_offsets_(NULL),
+        data_(NULL) {
+  }
+
+  // Initializes the table on first access.  Sets header values
+  // appropriately and zeroes everything else.
+  void InitializeTable(void* memory, int size, int max_histograms,
+                       int data_size);
+
+  // Initializes our in-memory pointers into a pre-created table.
+  void ComputeMappedPointers(void* memory);
+
+  SharedMemory shared_memory_;
+  TableHeader* table_header_;
+  int* record_offsets_;
+  char* data_;
+};
+
+// static
+SharedHistogramTable::Private* SharedHistogramTable::Private::New(
+    const std::string& name,
+    int size,
+    int max_histograms,
+    int data_size) {
+  scoped_ptr<Private> priv(new Private());
+  if (!priv->shared_memory_.CreateNamed(name, true, size))
+    return NULL;
+  if (!priv->shared_memory_.Map(size))
+    return NULL;
+  void* memory = priv->shared_memory_.memory();
+
+  // If the version does not match, then assume the table needs to be
+  // initialized.  The lock keeps two processes from doing it at once.
+  int table_size = size;
+  {
+    SharedMemoryAutoLock lock(&priv->shared_memory_);
+    TableHeader* header = static_cast<TableHeader*>(memory);
+    if (header->version != kTableVersion)
+      priv->InitializeTable(memory, size, max_histograms, data_size);
+    else
+      table_size = header->size;
+  }
+
+  // A table that another process created keeps the size it was created with.
+  if (table_size != size) {
+    priv->shared_memory_.Unmap();
+    if (!priv->shared_memory_.Map(table_size))
+      return NULL;
+    memory = priv->shared_memory_.memory();
+  }
+
+  // We have a valid table, so compute our pointers.
+  priv->ComputeMappedPointers(memory);
+
+  return priv.release();
+}
+
+int SharedHistogramTable::Private::AddRecord(int record_size) {
+  int index = table_header_->num_records;
+  if (index >= max_histograms() ||
+      record_size > table_header_->data_size - table_header_->used_size)
+    return -1;
+  record_offsets_[index] = table_header_->used_size;
+  table_header_->used_size += record_size;
+  return index;
+}
+
+void SharedHistogramTable::Private::InitializeTable(void* memory, int size,
+                                                    int max_histograms,
+                                                    int data_size) {
+  // Zero everything.
+  memset(memory, 0, size);
+
+  // Initialize the header.
+  TableHeader* header = static_cast<TableHeader*>(memory);
+  header->version = kTableVersion;
+  header->size = size;
+  header->max_histograms = max_histograms;
+  header->data_size = data_size;
+}
+
+void SharedHistogramTable::Private::ComputeMappedPointers(void* memory) {
+  char* data = static_cast<char*>(memory);
+  int offset = 0;
+
+  table_header_ = reinterpret_cast<TableHeader*>(data);
+  offset += sizeof(*table_header_);
+  offset += AlignOffset(offset);
+
+  // Verify we're looking at a valid table.
+  DCHECK_EQ(table_header_->version, kTableVersion);
+
+  record_offsets_ = reinterpret_cast<int*>(data + offset);
+  offset += sizeof(int) * max_histograms();
+  offset += AlignOffset(offset);
+
+  data_ = data + offset;
+  offset += table_header_->data_size;
+
+  DCHECK_EQ(offset, table_header_->size);
+}
+
+SharedHistogramTable::HistogramData::HistogramData()
+    : process_id(0),
+      histogram_type(Histogram::HISTOGRAM),
+      declared_min(0),
+      declared_max(0),
+      sum(0),
+      redundant_count(0) {
+}
+
+SharedHistogramTable::HistogramData::~HistogramData() {
+}
+
+// We keep a singleton table which can be easily accessed.
+SharedHistogramTable* SharedHistogramTable::global_table_ = NULL;
+
+SharedHistogramTable::SharedHistogramTable(const std::string& name,
+                                           int max_histograms,
+                                           int data_size)
+    : impl_(NULL) {
+  data_size = AlignedSize(data_size);
+  int table_size =
+      AlignedSize(sizeof(Private::TableHeader)) +
+      AlignedSize(max_histograms * sizeof(int)) +
+      data_size;
+
+  impl_ = Private::New(name, table_size, max_histograms, data_size);
+
+  if (!impl_)
+    DPLOG(ERROR) << "SharedHistogramTable did not initialize";
+}
+
+SharedHistogramTable::~SharedHistogramTable() {
+  // Cleanup our shared memory.  Histograms that still point into it must be
+  // gone by now, so in practice the current table is never deleted.
+  delete impl_;
+
+  // If we are the global table, unregister ourselves.
+  if (global_table_ == this)
+    global_table_ = NULL;
+}
+
+SharedHistogramRecord* SharedHistogramTable::AllocateRecord(
+    const Histogram& histogram,
+    const Histogram::SampleSet& samples) {
+  if (!impl_)
+    return NULL;
+
+  size_t bucket_count = histogram.bucket_count();
+  SharedMemoryAutoLock lock(impl_->shared_memory());
+  int index = impl_->AddRecord(RecordSize(bucket_count));
+  if (index < 0)
+    return NULL;
+
+  // The data area was zeroed when the table was set up, and no other process
+  // sees the record before |num_records| covers it.
+  SharedHistogramRecord* record = impl_->record(index);
+  record->process_id = GetCurrentProcId();
+  record->histogram_type = histogram.histogram_type();
+  record->declared_min = histogram.declared_min();
+  record->declared_max = histogram.declared_max();
+  record->bucket_count = static_cast<int32>(bucket_count);
+  record->range_checksum = histogram.range_checksum();
+  strncpy(record->name, histogram.histogram_name().c_str(),
+          SharedHistogramRecord::kMaxNameLength);
+  record->name[SharedHistogramRecord::kMaxNameLength - 1] = '\0';
+  record->sum = samples.sum();
+  record->redundant_count = samples.redundant_count();
+  Histogram::Sample* ranges = record->ranges();
+  for (size_t i = 0; i <= bucket_count; ++i)
+    ranges[i] = histogram.ranges(i);
+  subtle::Atomic32* counts = record->counts();
+  for (size_t i = 0; i < bucket_count; ++i)
+    counts[i] = samples.counts(i);
+
+  subtle::Release_Store(&impl_->table_header()->num_records, index + 1);
+  return record;
+}
+
+void SharedHistogramTable::GetHistograms(
+    std::vector<HistogramData>* histograms) const {
+  int num_records = GetRecordCount();
+  for (int index = 0; index < num_records; ++index) {
+    const SharedHistogramRecord* record = impl_->record(index);
+    histograms->push_back(HistogramData());
+    HistogramData& data = histograms->back();
+    data.name.assign(record->name,
+                     strnlen(record->name,
+                             SharedHistogramRecord::kMaxNameLength));
+    data.process_id = record->process_id;
+    data.histogram_type =
+        static_cast<Histogram::ClassType>(record->histogram_type);
+    data.declared_min = record->declared_min;
+    data.declared_max = record->declared_max;
+    const Histogram::Sample* ranges = record->ranges();
+    data.ranges.assign(ranges, ranges + record->bucket_count + 1);
+    Histogram::SampleSet snapshot;
+    snapshot.SnapshotFrom(*record);
+    data.counts.resize(record->bucket_count);
+    for (int i = 0; i < record->bucket_count; ++i)
+      data.counts[i] = snapshot.counts(i);
+    data.sum = snapshot.sum();
+    data.redundant_count = snapshot.redundant_count();
+  }
+}
+
+int SharedHistogramTable::GetRecordCount() const {
+  if (!impl_)
+    return 0;
+  return subtle::Acquire_Load(&impl_->table_header()->num_records);
+}
+
+}  // namespace base
@@ -0,0 +1,133 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A SharedHistogramTable keeps the samples of histograms in a shared memory
+// segment, so that a collector process can read the histograms of every
+// process that uses the table without any IPC, and without losing the samples
+// of a process that crashes.
+//
+// Like StatsTable, the table has a fixed size, set by whichever process
+// creates it, and space is never given back: each process allocates a record
+// for every histogram it registers, and records outlive their process.
+//
+// A process opts in with:
+//
+//   SharedHistogramTable* table = new SharedHistogramTable("Histograms",
+//                                                          1000, 1 << 20);
+//   SharedHistogramTable::set_current(table);
+//
+// Histograms that register with the StatisticsRecorder from then on add their
+// samples straight to the table.  Histograms that registered earlier, or that
+// find the table full, stay on the heap.
+
+#ifndef BASE_METRICS_SHARED_HISTOGRAM_TABLE_H_
+#define BASE_METRICS_SHARED_HISTOGRAM_TABLE_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/metrics/histogram.h"
+
+namespace base {
+
+// The record of one histogram in the shared memory.  It is followed by
+// |bucket_count| + 1 bucket ranges and |bucket_count| counts.  Only the
+// fields below the comment change once the record is set up.
+struct SharedHistogramRecord {
+  // The longest name that is stored, including the null terminator.  Longer
+  // names are truncated.
+  static const int kMaxNameLength = 128;
+
+  int32 process_id;
+  int32 histogram_type;
+  int32 declared_min;
+  int32 declared_max;
+  int32 bucket_count;
+  uint32 range_checksum;
+  char name[kMaxNameLength];
+
+  // Updated atomically, except for the 64-bit fields on 32-bit builds.
+  int64 sum;
+  int64 redundant_count;
+
+  const Histogram::Sample* ranges() const {
+    return reinterpret_cast<const Histogram::Sample*>(this + 1);
+  }
+  Histogram::Sample* ranges() {
+    return reinterpret_cast<Histogram::Sample*>(this + 1);
+  }
+  const subtle::Atomic32* counts() const {
+    return reinterpret_cast<const subtle::Atomic32*>(ranges() +
+                                                     bucket_count + 1);
+  }
+  subtle::Atomic32* counts() {
+    return reinterpret_cast<subtle::Atomic32*>(ranges() + bucket_count + 1);
+  }
+};
+
+class BASE_EXPORT SharedHistogramTable {
+ public:
+  // The data of a histogram as read from the table.
+  struct BASE_EXPORT HistogramData {
+    HistogramData();
+    ~HistogramData();
+
+    std::string name;
+    int process_id;
+    Histogram::ClassType histogram_type;
+    Histogram::Sample declared_min;
+    Histogram::Sample declared_max;
+    // The bucket_count() + 1 ranges of the histogram.
+    std::vector<Histogram::Sample> ranges;
+    Histogram::Counts counts;
+    int64 sum;
+    int64 redundant_count;
+  };
+
+  // Create a new SharedHistogramTable, or attach to the one that another
+  // process created under |name|.  |max_histograms| is the number of records
+  // and |data_size| the number of bytes for their contents.  Both are ignored
+  // if the table exists already.
+  SharedHistogramTable(const std::string& name,
+                       int max_histograms,
+                       int data_size);
+  ~SharedHistogramTable();
+
+  // Whether the shared memory could be set up.
+  bool is_valid() const { return impl_ != NULL; }
+
+  // The table that newly registered histograms of this process use, if any.
+  static SharedHistogramTable* current() { return global_table_; }
+  static void set_current(SharedHistogramTable* value) {
+    global_table_ = value;
+  }
+
+  // Sets up a record for |histogram| in this process, with its samples so
+  // far.  Returns NULL if the table is full.
+  SharedHistogramRecord* AllocateRecord(const Histogram& histogram,
+                                        const Histogram::SampleSet& samples);
+
+  // Appends the data of all the histograms in the table, of every process.
+  void GetHistograms(std::vector<HistogramData>* histograms) const;
+
+  // Returns the number of histogram records in the table.
+  int GetRecordCount() const;
+
+ private:
+  class Private;
+
+  Private* impl_;
+
+  static SharedHistogramTable* global_table_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedHistogramTable);
+};
+
+}  // namespace base
+
+#endif  // BASE_METRICS_SHARED_HISTOGRAM_TABLE_H_
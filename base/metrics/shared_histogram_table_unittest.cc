@@ -0,0 +1,120 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/shared_histogram_table.h"
+
+#include <string>
+#include <vector>
+
+#include "base/metrics/histogram.h"
+#include "base/process_util.h"
+#include "base/shared_memory.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+class SharedHistogramTableTest : public testing::Test {
+ public:
+  void DeleteShmem(const std::string& name) {
+    SharedMemory mem;
+    mem.Delete(name);
+  }
+};
+
+// Histograms registered while a table is current record into it, and another
+// table object attached to the same memory, as in a collector process, sees
+// their samples.
+TEST_F(SharedHistogramTableTest, RecordAndCollect) {
+  const std::string kTableName = "RecordAndCollectHistogramTable";
+  DeleteShmem(kTableName);
+  SharedHistogramTable table(kTableName, 10, 4096);
+  ASSERT_TRUE(table.is_valid());
+  SharedHistogramTable::set_current(&table);
+
+  {
+    StatisticsRecorder recorder;
+    Histogram* histogram = Histogram::FactoryGet(
+        "SharedHistogram", 1, 1000, 10, Histogram::kNoFlags);
+    Histogram* linear_histogram = LinearHistogram::FactoryGet(
+        "SharedLinearHistogram", 1, 7, 8, Histogram::kNoFlags);
+    histogram->Add(5);
+    histogram->Add(5);
+    histogram->Add(500);
+    linear_histogram->Add(3);
+
+    // The histogram reads its samples back from the table.
+    Histogram::SampleSet snapshot;
+    histogram->SnapshotSample(&snapshot);
+    EXPECT_EQ(3, snapshot.TotalCount());
+    EXPECT_EQ(510, snapshot.sum());
+  }
+  SharedHistogramTable::set_current(NULL);
+
+  SharedHistogramTable collector(kTableName, 0, 0);
+  ASSERT_TRUE(collector.is_valid());
+  EXPECT_EQ(2, collector.GetRecordCount());
+  std::vector<SharedHistogramTable::HistogramData> histograms;
+  collector.GetHistograms(&histograms);
+  ASSERT_EQ(2u, histograms.size());
+
+  const SharedHistogramTable::HistogramData& data = histograms[0];
+  EXPECT_EQ("SharedHistogram", data.name);
+  EXPECT_EQ(GetCurrentProcId(), data.process_id);
+  EXPECT_EQ(Histogram::HISTOGRAM, data.histogram_type);
+  EXPECT_EQ(1, data.declared_min);
+  EXPECT_EQ(1000, data.declared_max);
+  ASSERT_EQ(11u, data.ranges.size());
+  EXPECT_EQ(0, data.ranges[0]);
+  EXPECT_EQ(1, data.ranges[1]);
+  EXPECT_EQ(1000, data.ranges[9]);
+  ASSERT_EQ(10u, data.counts.size());
+  int total = 0;
+  for (size_t i = 0; i < data.counts.size(); ++i)
+    total += data.counts[i];
+  EXPECT_EQ(3, total);
+  EXPECT_EQ(510, data.sum);
+  EXPECT_EQ(3, data.redundant_count);
+
+  EXPECT_EQ("SharedLinearHistogram", histograms[1].name);
+  EXPECT_EQ(Histogram::LINEAR_HISTOGRAM, histograms[1].histogram_type);
+  EXPECT_EQ(1, histograms[1].counts[3]);
+
+  DeleteShmem(kTableName);
+}
+
+// Once the table is full, histograms keep their samples on the heap.
+TEST_F(SharedHistogramTableTest, FullTable) {
+  const std::string kTableName = "FullHistogramTable";
+  DeleteShmem(kTableName);
+  SharedHistogramTable table(kTableName, 1, 4096);
+  ASSERT_TRUE(table.is_valid());
+  SharedHistogramTable::set_current(&table);
+
+  {
+    StatisticsRecorder recorder;
+    Histogram* first = Histogram::FactoryGet(
+        "FirstSharedHistogram", 1, 1000, 10, Histogram::kNoFlags);
+    Histogram* second = Histogram::FactoryGet(
+        "SecondSharedHistogram", 1, 1000, 10, Histogram::kNoFlags);
+    first->Add(1);
+    second->Add(2);
+    second->Add(3);
+
+    Histogram::SampleSet snapshot;
+    second->SnapshotSample(&snapshot);
+    EXPECT_EQ(2, snapshot.TotalCount());
+    EXPECT_EQ(5, snapshot.sum());
+  }
+  SharedHistogramTable::set_current(NULL);
+
+  std::vector<SharedHistogramTable::HistogramData> histograms;
+  table.GetHistograms(&histograms);
+  ASSERT_EQ(1u, histograms.size());
+  EXPECT_EQ("FirstSharedHistogram", histograms[0].name);
+  EXPECT_EQ(1, histograms[0].sum);
+
+  DeleteShmem(kTableName);
+}
+
+}  // namespace base
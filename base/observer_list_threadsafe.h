@@ -8,7 +8,9 @@
 
 #include <algorithm>
 #include <map>
+#include <vector>
 
+#include "base/atomicops.h"
 #include "base/basictypes.h"
 #include "base/bind.h"
 #include "base/location.h"
@@ -17,6 +19,8 @@
 #include "base/message_loop.h"
 #include "base/message_loop_proxy.h"
 #include "base/observer_list.h"
+#include "base/stl_util.h"
+#include "base/synchronization/lock.h"
 #include "base/threading/platform_thread.h"
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -50,6 +54,13 @@
 //   we simply call PostTask to each registered thread, and then each thread
 //   will notify its regular ObserverList.
 //
+//   Notify() does not take a lock.  The per-thread lists are published as
+//   an immutable snapshot which AddObserver() and RemoveObserver() replace
+//   under a lock whenever a thread's first observer is added or its last
+//   one removed.  A replaced snapshot is deleted once no Notify() call can
+//   still be reading it, which AddObserver() and RemoveObserver() tell by
+//   a count of the Notify() calls in progress.
+//
 ///////////////////////////////////////////////////////////////////////////////
 
 // Forward declaration for ObserverListThreadSafeTraits.
@@ -69,6 +80,7 @@ class UnboundMethod {
   void Run(T* obj) const {
     DispatchToMethod(obj, m_, p_);
   }
+  Method method() const { return m_; }
  private:
   Method m_;
   Params p_;
@@ -99,9 +111,17 @@ class ObserverListThreadSafe
   typedef typename ObserverList<ObserverType>::NotificationType
       NotificationType;
 
+  // The methods which NotifyCoalesced() can deliver.
+  typedef void (ObserverType::*CoalescedMethod)();
+
   ObserverListThreadSafe()
-      : type_(ObserverListBase<ObserverType>::NOTIFY_ALL) {}
-  explicit ObserverListThreadSafe(NotificationType type) : type_(type) {}
+      : type_(ObserverListBase<ObserverType>::NOTIFY_ALL),
+        snapshot_(0),
+        active_notifies_(0) {}
+  explicit ObserverListThreadSafe(NotificationType type)
+      : type_(type),
+        snapshot_(0),
+        active_notifies_(0) {}
 
   // Add an observer to the list.  An observer should not be added to
   // the same list more than once.
@@ -115,9 +135,14 @@ class ObserverListThreadSafe
     base::PlatformThreadId thread_id = base::PlatformThread::CurrentId();
     {
       base::AutoLock lock(list_lock_);
-      if (observer_lists_.find(thread_id) == observer_lists_.end())
-        observer_lists_[thread_id] = new ObserverListContext(type_);
-      list = &(observer_lists_[thread_id]->list);
+      typename ObserversListMap::iterator it = observer_lists_.find(thread_id);
+      if (it == observer_lists_.end()) {
+        it = observer_lists_.insert(std::make_pair(
+            thread_id, make_scoped_refptr(new ObserverListContext(type_))))
+                .first;
+        PublishSnapshotLocked();
+      }
+      list = &it->second->list;
     }
     list->AddObserver(obs);
   }
@@ -128,8 +153,7 @@ class ObserverListThreadSafe
   // If the observer to be removed is in the list, RemoveObserver MUST
   // be called from the same thread which called AddObserver.
   void RemoveObserver(ObserverType* obs) {
-    ObserverListContext* context = NULL;
-    ObserverList<ObserverType>* list = NULL;
+    scoped_refptr<ObserverListContext> context;
     base::PlatformThreadId thread_id = base::PlatformThread::CurrentId();
     {
       base::AutoLock lock(list_lock_);
@@ -140,20 +164,19 @@ class ObserverListThreadSafe
         return;
       }
       context = it->second;
-      list = &context->list;
 
       // If we're about to remove the last observer from the list,
       // then we can remove this observer_list entirely.
-      if (list->HasObserver(obs) && list->size() == 1)
+      if (context->list.HasObserver(obs) && context->list.size() == 1) {
+        context->removed = true;
         observer_lists_.erase(it);
+        PublishSnapshotLocked();
+      }
     }
-    list->RemoveObserver(obs);
-
-    // If RemoveObserver is called from a notification, the size will be
-    // nonzero.  Instead of deleting here, the NotifyWrapper will delete
-    // when it finishes iterating.
-    if (list->size() == 0)
-      delete context;
+    // If RemoveObserver is called from a notification, the list keeps its
+    // size until the NotifyWrapper finishes iterating, and the last
+    // reference to the context may be the one the NotifyWrapper holds.
+    context->list.RemoveObserver(obs);
   }
 
   // Verifies that the list is currently empty (i.e. there are no observers).
@@ -202,62 +225,125 @@ class ObserverListThreadSafe
 
   // TODO(mbelshe):  Add more wrappers for Notify() with more arguments.
 
+  // Like Notify(m), except that a thread which still has a notification of
+  // |m| pending from an earlier NotifyCoalesced() call is not posted another
+  // one.  Use it for "something changed" notifications, which observers
+  // only need to see once however often the change happens.
+  void NotifyCoalesced(CoalescedMethod m) {
+    UnboundMethod<ObserverType, CoalescedMethod, Tuple0> method(m,
+                                                                MakeTuple());
+    base::subtle::Barrier_AtomicIncrement(&active_notifies_, 1);
+    const ContextList* contexts = GetSnapshot();
+    for (size_t i = 0; contexts && i < contexts->size(); ++i) {
+      ObserverListContext* context = (*contexts)[i].get();
+      {
+        base::AutoLock lock(context->pending_lock);
+        if (std::find(context->pending.begin(), context->pending.end(), m) !=
+            context->pending.end()) {
+          continue;
+        }
+        context->pending.push_back(m);
+      }
+      context->loop->PostTask(
+          FROM_HERE,
+          base::Bind(&ObserverListThreadSafe<ObserverType>::
+              NotifyCoalescedWrapper, this, make_scoped_refptr(context),
+              method));
+    }
+    base::subtle::Barrier_AtomicIncrement(&active_notifies_, -1);
+  }
+
  private:
   // See comment above ObserverListThreadSafeTraits' definition.
   friend struct ObserverListThreadSafeTraits<ObserverType>;
 
-  struct ObserverListContext {
+  struct ObserverListContext
+      : public base::RefCountedThreadSafe<ObserverListContext> {
     explicit ObserverListContext(NotificationType type)
         : loop(base::MessageLoopProxy::current()),
-          list(type) {
+          list(type),
+          removed(false) {
     }
 
     scoped_refptr<base::MessageLoopProxy> loop;
     ObserverList<ObserverType> list;
 
+    // Set, on the list's thread, once the context is no longer in
+    // |observer_lists_|; notifications still in flight are then dropped.
+    bool removed;
+
+    // The NotifyCoalesced() methods posted to |loop| but not yet run.
+    base::Lock pending_lock;
+    std::vector<CoalescedMethod> pending;
+
+   private:
+    friend class base::RefCountedThreadSafe<ObserverListContext>;
+    ~ObserverListContext() {}
+
     DISALLOW_COPY_AND_ASSIGN(ObserverListContext);
   };
 
+  typedef std::vector<scoped_refptr<ObserverListContext> > ContextList;
+
   ~ObserverListThreadSafe() {
+    delete GetSnapshot();
+    STLDeleteElements(&retired_snapshots_);
+  }
+
+  const ContextList* GetSnapshot() const {
+    return reinterpret_cast<const ContextList*>(
+        base::subtle::Acquire_Load(&snapshot_));
+  }
+
+  // Replaces the snapshot Notify() reads with the contents of
+  // |observer_lists_|.  Must be called with |list_lock_| held.
+  void PublishSnapshotLocked() {
+    list_lock_.AssertAcquired();
+    ContextList* snapshot = new ContextList;
+    snapshot->reserve(observer_lists_.size());
     typename ObserversListMap::const_iterator it;
     for (it = observer_lists_.begin(); it != observer_lists_.end(); ++it)
-      delete (*it).second;
-    observer_lists_.clear();
+      snapshot->push_back(it->second);
+
+    const ContextList* old_snapshot = GetSnapshot();
+    base::subtle::Release_Store(
+        &snapshot_, reinterpret_cast<base::subtle::AtomicWord>(snapshot));
+    if (old_snapshot)
+      retired_snapshots_.push_back(old_snapshot);
+
+    // A Notify() which starts after the store above reads the new snapshot,
+    // so with none in progress the retired ones are free to go.
+    base::subtle::MemoryBarrier();
+    if (base::subtle::Acquire_Load(&active_notifies_) == 0)
+      STLDeleteElements(&retired_snapshots_);
   }
 
   template <class Method, class Params>
   void Notify(const UnboundMethod<ObserverType, Method, Params>& method) {
-    base::AutoLock lock(list_lock_);
-    typename ObserversListMap::iterator it;
-    for (it = observer_lists_.begin(); it != observer_lists_.end(); ++it) {
-      ObserverListContext* context = (*it).second;
+    base::subtle::Barrier_AtomicIncrement(&active_notifies_, 1);
+    const ContextList* contexts = GetSnapshot();
+    for (size_t i = 0; contexts && i < contexts->size(); ++i) {
+      const scoped_refptr<ObserverListContext>& context = (*contexts)[i];
       context->loop->PostTask(
           FROM_HERE,
           base::Bind(&ObserverListThreadSafe<ObserverType>::
               template NotifyWrapper<Method, Params>, this, context, method));
     }
+    base::subtle::Barrier_AtomicIncrement(&active_notifies_, -1);
   }
 
   // Wrapper which is called to fire the notifications for each thread's
   // ObserverList.  This function MUST be called on the thread which owns
   // the unsafe ObserverList.
   template <class Method, class Params>
-  void NotifyWrapper(ObserverListContext* context,
+  void NotifyWrapper(
+      const scoped_refptr<ObserverListContext>& context,
       const UnboundMethod<ObserverType, Method, Params>& method) {
-
-    // Check that this list still needs notifications.
-    {
-      base::AutoLock lock(list_lock_);
-      typename ObserversListMap::iterator it =
-          observer_lists_.find(base::PlatformThread::CurrentId());
-
-      // The ObserverList could have been removed already.  In fact, it could
-      // have been removed and then re-added!  If the master list's loop
-      // does not match this one, then we do not need to finish this
-      // notification.
-      if (it == observer_lists_.end() || it->second != context)
-        return;
-    }
+    // The ObserverList could have been removed already.  In fact, it could
+    // have been removed and then re-added, in which case this notification
+    // was meant for the old one.
+    if (context->removed)
+      return;
 
     {
       typename ObserverList<ObserverType>::Iterator it(context->list);
@@ -266,32 +352,55 @@ class ObserverListThreadSafe
         method.Run(obs);
     }
 
-    // If there are no more observers on the list, we can now delete it.
-    if (context->list.size() == 0) {
-      {
-        base::AutoLock lock(list_lock_);
-        // Remove |list| if it's not already removed.
-        // This can happen if multiple observers got removed in a notification.
-        // See http://crbug.com/55725.
-        typename ObserversListMap::iterator it =
-            observer_lists_.find(base::PlatformThread::CurrentId());
-        if (it != observer_lists_.end() && it->second == context)
-          observer_lists_.erase(it);
+    // If there are no more observers on the list, we can now remove it.
+    if (context->list.size() == 0 && !context->removed) {
+      base::AutoLock lock(list_lock_);
+      // Remove |list| if it's not already removed.
+      // This can happen if multiple observers got removed in a notification.
+      // See http://crbug.com/55725.
+      typename ObserversListMap::iterator it =
+          observer_lists_.find(base::PlatformThread::CurrentId());
+      if (it != observer_lists_.end() && it->second == context) {
+        context->removed = true;
+        observer_lists_.erase(it);
+        PublishSnapshotLocked();
       }
-      delete context;
     }
   }
 
+  void NotifyCoalescedWrapper(
+      const scoped_refptr<ObserverListContext>& context,
+      const UnboundMethod<ObserverType, CoalescedMethod, Tuple0>& method) {
+    // Clear the pending entry before running the observers, so that one
+    // which triggers the same notification again is notified again.
+    {
+      base::AutoLock lock(context->pending_lock);
+      typename std::vector<CoalescedMethod>::iterator it = std::find(
+          context->pending.begin(), context->pending.end(), method.method());
+      DCHECK(it != context->pending.end());
+      context->pending.erase(it);
+    }
+    NotifyWrapper<CoalescedMethod, Tuple0>(context, method);
+  }
+
   // Key by PlatformThreadId because in tests, clients can attempt to remove
   // observers without a MessageLoop. If this were keyed by MessageLoop, that
   // operation would be silently ignored, leaving garbage in the ObserverList.
-  typedef std::map<base::PlatformThreadId, ObserverListContext*>
-      ObserversListMap;
+  typedef std::map<base::PlatformThreadId,
+                   scoped_refptr<ObserverListContext> > ObserversListMap;
 
-  mutable base::Lock list_lock_;  // Protects the observer_lists_.
+  mutable base::Lock list_lock_;  // Protects the following members.
   ObserversListMap observer_lists_;
+  // Snapshots which Notify() calls in progress may still be reading.
+  std::vector<const ContextList*> retired_snapshots_;
+
   const NotificationType type_;
 
+  // The ContextList which Notify() reads, and the number of Notify() calls
+  // reading it.
+  base::subtle::AtomicWord snapshot_;
+  base::subtle::Atomic32 active_notifies_;
+
   DISALLOW_COPY_AND_ASSIGN(ObserverListThreadSafe);
 };
 
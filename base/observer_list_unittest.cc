@@ -476,6 +476,94 @@ TEST(ObserverListThreadSafeTest, Existing) {
   EXPECT_EQ(1, b.adder.total);
 }
 
+class Changeable {
+ public:
+  virtual void OnChanged() = 0;
+  virtual void OnOtherChanged() = 0;
+  virtual ~Changeable() {}
+};
+
+class ChangeCounter : public Changeable {
+ public:
+  explicit ChangeCounter(ObserverListThreadSafe<Changeable>* list)
+      : changes(0), other_changes(0), list_(list), renotify_(false) {}
+  virtual ~ChangeCounter() {}
+
+  virtual void OnChanged() OVERRIDE {
+    changes++;
+    if (renotify_) {
+      renotify_ = false;
+      list_->NotifyCoalesced(&Changeable::OnChanged);
+    }
+  }
+  virtual void OnOtherChanged() OVERRIDE {
+    other_changes++;
+  }
+
+  void RenotifyOnce() { renotify_ = true; }
+
+  int changes;
+  int other_changes;
+
+ private:
+  ObserverListThreadSafe<Changeable>* list_;
+  bool renotify_;
+};
+
+TEST(ObserverListThreadSafeTest, NotifyCoalesced) {
+  MessageLoop loop;
+  scoped_refptr<ObserverListThreadSafe<Changeable> > observer_list(
+      new ObserverListThreadSafe<Changeable>);
+  ChangeCounter a(observer_list.get());
+  observer_list->AddObserver(&a);
+
+  // Pending notifications of the same method are posted once.
+  observer_list->NotifyCoalesced(&Changeable::OnChanged);
+  observer_list->NotifyCoalesced(&Changeable::OnChanged);
+  observer_list->NotifyCoalesced(&Changeable::OnOtherChanged);
+  observer_list->NotifyCoalesced(&Changeable::OnChanged);
+  loop.RunAllPending();
+  EXPECT_EQ(1, a.changes);
+  EXPECT_EQ(1, a.other_changes);
+
+  // Once delivered, the method may be posted again, even by an observer.
+  a.RenotifyOnce();
+  observer_list->NotifyCoalesced(&Changeable::OnChanged);
+  loop.RunAllPending();
+  EXPECT_EQ(3, a.changes);
+
+  // Plain notifications are never coalesced.
+  observer_list->Notify(&Changeable::OnChanged);
+  observer_list->Notify(&Changeable::OnChanged);
+  loop.RunAllPending();
+  EXPECT_EQ(5, a.changes);
+
+  observer_list->RemoveObserver(&a);
+  observer_list->AssertEmpty();
+}
+
+// Notifications in flight when a thread drops its last observer are not
+// delivered to observers that thread adds afterwards.
+TEST(ObserverListThreadSafeTest, RemoveAndReAdd) {
+  MessageLoop loop;
+  scoped_refptr<ObserverListThreadSafe<Foo> > observer_list(
+      new ObserverListThreadSafe<Foo>);
+  Adder a(1);
+
+  observer_list->AddObserver(&a);
+  observer_list->Notify(&Foo::Observe, 1);
+  observer_list->RemoveObserver(&a);
+  observer_list->AddObserver(&a);
+  observer_list->Notify(&Foo::Observe, 10);
+  loop.RunAllPending();
+  EXPECT_EQ(10, a.total);
+
+  observer_list->RemoveObserver(&a);
+  observer_list->Notify(&Foo::Observe, 100);
+  loop.RunAllPending();
+  EXPECT_EQ(10, a.total);
+}
+
 class AddInClearObserve : public Foo {
  public:
   explicit AddInClearObserve(ObserverList<Foo>* list)
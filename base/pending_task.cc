@@ -4,6 +4,9 @@
 
 #include "base/pending_task.h"
 
+#include <algorithm>
+
+#include "base/logging.h"
 #include "base/tracked_objects.h"
 
 namespace base {
@@ -14,7 +17,8 @@ PendingTask::PendingTask(const tracked_objects::Location& posted_from,
       task(task),
       posted_from(posted_from),
       sequence_num(0),
-      nestable(true) {
+      nestable(true),
+      priority(TASK_PRIORITY_NORMAL) {
 }
 
 PendingTask::PendingTask(const tracked_objects::Location& posted_from,
@@ -25,7 +29,8 @@ PendingTask::PendingTask(const tracked_objects::Location& posted_from,
       task(task),
       posted_from(posted_from),
       sequence_num(0),
-      nestable(nestable) {
+      nestable(nestable),
+      priority(TASK_PRIORITY_NORMAL) {
 }
 
 PendingTask::~PendingTask() {
@@ -51,4 +56,108 @@ void TaskQueue::Swap(TaskQueue* queue) {
   c.swap(queue->c);  // Calls std::deque::swap.
 }
 
+struct DelayedTaskQueue::Node {
+  Node(const PendingTask& pending_task, size_t heap_index)
+      : pending_task(pending_task),
+        heap_index(heap_index) {
+  }
+
+  PendingTask pending_task;
+
+  // Position of this node in |heap_|.
+  size_t heap_index;
+};
+
+DelayedTaskQueue::DelayedTaskQueue() {
+}
+
+DelayedTaskQueue::~DelayedTaskQueue() {
+  while (!empty())
+    pop();
+}
+
+const PendingTask& DelayedTaskQueue::top() const {
+  DCHECK(!empty());
+  return heap_.front()->pending_task;
+}
+
+void DelayedTaskQueue::push(const PendingTask& pending_task) {
+  Node* node = new Node(pending_task, heap_.size());
+  bool inserted =
+      nodes_.insert(std::make_pair(pending_task.sequence_num, node)).second;
+  DCHECK(inserted) << "Duplicate sequence_num " << pending_task.sequence_num;
+  heap_.push_back(node);
+  SiftUp(node->heap_index);
+}
+
+void DelayedTaskQueue::pop() {
+  DCHECK(!empty());
+  delete Detach(0);
+}
+
+bool DelayedTaskQueue::Remove(int sequence_num) {
+  NodeMap::iterator found = nodes_.find(sequence_num);
+  if (found == nodes_.end())
+    return false;
+  delete Detach(found->second->heap_index);
+  return true;
+}
+
+DelayedTaskQueue::Node* DelayedTaskQueue::Detach(size_t index) {
+  DCHECK_LT(index, heap_.size());
+  Node* node = heap_[index];
+  nodes_.erase(node->pending_task.sequence_num);
+
+  size_t last = heap_.size() - 1;
+  if (index != last) {
+    SwapNodes(index, last);
+    heap_.pop_back();
+    // The node moved into |index| may belong either above or below it.
+    Node* moved = heap_[index];
+    SiftUp(index);
+    SiftDown(moved->heap_index);
+  } else {
+    heap_.pop_back();
+  }
+  return node;
+}
+
+void DelayedTaskQueue::SiftUp(size_t index) {
+  while (index > 0) {
+    size_t parent = (index - 1) / 2;
+    if (!RunsBefore(index, parent))
+      return;
+    SwapNodes(index, parent);
+    index = parent;
+  }
+}
+
+void DelayedTaskQueue::SiftDown(size_t index) {
+  for (;;) {
+    size_t first = index;
+    size_t left = 2 * index + 1;
+    size_t right = left + 1;
+    if (left < heap_.size() && RunsBefore(left, first))
+      first = left;
+    if (right < heap_.size() && RunsBefore(right, first))
+      first = right;
+    if (first == index)
+      return;
+    SwapNodes(index, first);
+    index = first;
+  }
+}
+
+void DelayedTaskQueue::SwapNodes(size_t a, size_t b) {
+  std::swap(heap_[a], heap_[b]);
+  heap_[a]->heap_index = a;
+  heap_[b]->heap_index = b;
+}
+
+bool DelayedTaskQueue::RunsBefore(size_t a, size_t b) const {
+  // PendingTask::operator< is inverted for std::priority_queue, so the task
+  // that runs first compares greater.
+  return heap_[b]->pending_task < heap_[a]->pending_task;
+}
+
 }  // namespace base
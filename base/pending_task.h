@@ -7,10 +7,14 @@
 #pragma once
 
 #include <queue>
+#include <vector>
 
 #include "base/base_export.h"
+#include "base/basictypes.h"
 #include "base/callback.h"
+#include "base/hash_tables.h"
 #include "base/location.h"
+#include "base/task_priority.h"
 #include "base/time.h"
 #include "base/tracking_info.h"
 
@@ -41,6 +45,9 @@ struct BASE_EXPORT PendingTask : public TrackingInfo {
 
   // OK to dispatch from a nested loop.
   bool nestable;
+
+  // The lane the task waits in, TASK_PRIORITY_NORMAL unless changed.
+  TaskPriority priority;
 };
 
 // Wrapper around std::queue specialized for PendingTask which adds a Swap
@@ -50,8 +57,59 @@ class BASE_EXPORT TaskQueue : public std::queue<PendingTask> {
   void Swap(TaskQueue* queue);
 };
 
-// PendingTasks are sorted by their |delayed_run_time| property.
-typedef std::priority_queue<base::PendingTask> DelayedTaskQueue;
+// A priority queue of PendingTasks sorted by their |delayed_run_time|
+// property, with ties broken by |sequence_num|.  Unlike std::priority_queue
+// it can remove any task by its |sequence_num|, which must be unique among
+// the queued tasks.
+//
+// Each task is copied once into a heap-allocated node, and the heap itself
+// only moves node pointers around, so reordering never copies a Closure.
+// Remove() takes O(log n).
+class BASE_EXPORT DelayedTaskQueue {
+ public:
+  DelayedTaskQueue();
+  ~DelayedTaskQueue();
+
+  bool empty() const { return heap_.empty(); }
+  size_t size() const { return heap_.size(); }
+
+  // Returns the task that should run first.  The queue must not be empty.
+  const PendingTask& top() const;
+
+  void push(const PendingTask& pending_task);
+  void pop();
+
+  // Removes the task with the given |sequence_num| and destroys it.  Returns
+  // false if no such task is queued.
+  bool Remove(int sequence_num);
+
+ private:
+  struct Node;
+
+  // Detaches the node at |index| from the heap and the lookup table, and
+  // returns it.  The queue is consistent again by the time the caller deletes
+  // the node, so a task's destructor may safely touch the queue.
+  Node* Detach(size_t index);
+
+  // Restore the heap order around the node at |index|.
+  void SiftUp(size_t index);
+  void SiftDown(size_t index);
+
+  // Swaps the heap slots |a| and |b|, keeping the nodes' indices in sync.
+  void SwapNodes(size_t a, size_t b);
+
+  // Returns true if the node at |a| should run before the node at |b|.
+  bool RunsBefore(size_t a, size_t b) const;
+
+  // Binary min-heap, ordered by RunsBefore().  Owns the nodes.
+  std::vector<Node*> heap_;
+
+  // Maps each queued task's sequence_num to its node.
+  typedef base::hash_map<int, Node*> NodeMap;
+  NodeMap nodes_;
+
+  DISALLOW_COPY_AND_ASSIGN(DelayedTaskQueue);
+};
 
 }  // namespace base
 
@@ -0,0 +1,115 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/pending_task.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/memory/ref_counted.h"
+#include "base/rand_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace {
+
+void DoNothing() {
+}
+
+PendingTask MakeTask(int64 delay_ms, int sequence_num) {
+  PendingTask task(FROM_HERE, Bind(&DoNothing),
+                   TimeTicks() + TimeDelta::FromMilliseconds(delay_ms), true);
+  task.sequence_num = sequence_num;
+  return task;
+}
+
+class DeletionProbe : public RefCounted<DeletionProbe> {
+ public:
+  explicit DeletionProbe(bool* deleted) : deleted_(deleted) {}
+
+  void Run() {}
+
+ private:
+  friend class RefCounted<DeletionProbe>;
+  ~DeletionProbe() { *deleted_ = true; }
+
+  bool* deleted_;
+};
+
+}  // namespace
+
+TEST(DelayedTaskQueueTest, Order) {
+  DelayedTaskQueue queue;
+  EXPECT_TRUE(queue.empty());
+  queue.push(MakeTask(30, 0));
+  queue.push(MakeTask(10, 1));
+  queue.push(MakeTask(20, 2));
+  // Ties are broken by sequence number.
+  queue.push(MakeTask(10, 3));
+  EXPECT_EQ(4u, queue.size());
+
+  const int kExpected[] = { 1, 3, 2, 0 };
+  for (size_t i = 0; i < arraysize(kExpected); ++i) {
+    ASSERT_FALSE(queue.empty());
+    EXPECT_EQ(kExpected[i], queue.top().sequence_num);
+    queue.pop();
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(DelayedTaskQueueTest, Remove) {
+  DelayedTaskQueue queue;
+  bool deleted = false;
+  PendingTask task(FROM_HERE,
+                   Bind(&DeletionProbe::Run, new DeletionProbe(&deleted)),
+                   TimeTicks() + TimeDelta::FromMilliseconds(20), true);
+  task.sequence_num = 1;
+  queue.push(task);
+  task.task.Reset();
+  queue.push(MakeTask(10, 2));
+  queue.push(MakeTask(30, 3));
+
+  EXPECT_FALSE(queue.Remove(4));
+  EXPECT_FALSE(deleted);
+  EXPECT_TRUE(queue.Remove(1));
+  EXPECT_TRUE(deleted);
+  EXPECT_FALSE(queue.Remove(1));
+
+  EXPECT_TRUE(queue.Remove(2));
+  ASSERT_EQ(1u, queue.size());
+  EXPECT_EQ(3, queue.top().sequence_num);
+}
+
+// Interleaves pushes, pops and removals of random tasks and checks that the
+// queue always hands out the earliest remaining task.
+TEST(DelayedTaskQueueTest, RandomOperations) {
+  DelayedTaskQueue queue;
+  std::vector<int64> delays;  // Indexed by sequence number; -1 once gone.
+  for (int i = 0; i < 2000; ++i) {
+    int sequence_num = static_cast<int>(delays.size());
+    delays.push_back(RandInt(0, 100));
+    queue.push(MakeTask(delays.back(), sequence_num));
+
+    if (i % 3 == 0) {
+      int victim = RandInt(0, sequence_num);
+      EXPECT_EQ(delays[victim] != -1, queue.Remove(victim));
+      delays[victim] = -1;
+    }
+    if (i % 2 == 0 && !queue.empty()) {
+      int top = queue.top().sequence_num;
+      for (size_t j = 0; j < delays.size(); ++j) {
+        if (delays[j] == -1)
+          continue;
+        EXPECT_TRUE(delays[top] < delays[j] ||
+                    (delays[top] == delays[j] &&
+                     top <= static_cast<int>(j)));
+      }
+      delays[top] = -1;
+      queue.pop();
+    }
+  }
+}
+
+}  // namespace base
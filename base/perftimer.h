@@ -31,6 +31,8 @@ void LogPerfResult(const char* test_name, double value, const char* units);
 // ----------------------------------------------------------------------
 // PerfTimer
 //   A simple wrapper around Now()
+//   For microbenchmarks that need warmup, repetition and statistics, see
+//   base/test/benchmark.h instead.
 // ----------------------------------------------------------------------
 class PerfTimer {
  public:
@@ -8,6 +8,8 @@
 
 #include <algorithm>  // for max()
 
+#include "base/memory/ref_counted_memory.h"
+
 //------------------------------------------------------------------------------
 
 // static
@@ -15,6 +17,9 @@ const int Pickle::kPayloadUnit = 64;
 
 static const size_t kCapacityReadOnly = static_cast<size_t>(-1);
 
+// Pads external data out to a multiple of four bytes.
+static const char kPadding[sizeof(uint32)] = { 0 };
+
 PickleIterator::PickleIterator(const Pickle& pickle)
     : read_ptr_(pickle.payload()),
       read_end_ptr_(pickle.end_of_payload()) {
@@ -126,6 +131,31 @@ bool PickleIterator::ReadString16(string16* result) {
   return true;
 }
 
+bool PickleIterator::ReadStringPiece(base::StringPiece* result) {
+  int len;
+  if (!ReadInt(&len))
+    return false;
+  const char* read_from = GetReadPointerAndAdvance(len);
+  if (!read_from)
+    return false;
+
+  result->set(read_from, len);
+  return true;
+}
+
+bool PickleIterator::ReadStringPiece16(base::StringPiece16* result) {
+  int len;
+  if (!ReadInt(&len))
+    return false;
+  const char* read_from = GetReadPointerAndAdvance(len, sizeof(char16));
+  if (!read_from)
+    return false;
+
+  *result = base::StringPiece16(reinterpret_cast<const char16*>(read_from),
+                                len);
+  return true;
+}
+
 bool PickleIterator::ReadData(const char** data, int* length) {
   *length = 0;
   *data = 0;
@@ -146,11 +176,18 @@ bool PickleIterator::ReadBytes(const char** data, int length) {
 
 // Payload is uint32 aligned.
 
+Pickle::ExternalData::ExternalData() : offset(0) {
+}
+
+Pickle::ExternalData::~ExternalData() {
+}
+
 Pickle::Pickle()
     : header_(NULL),
       header_size_(sizeof(Header)),
       capacity_(0),
-      variable_buffer_offset_(0) {
+      variable_buffer_offset_(0),
+      external_size_(0) {
   Resize(kPayloadUnit);
   header_->payload_size = 0;
 }
@@ -159,7 +196,8 @@ Pickle::Pickle(int header_size)
     : header_(NULL),
       header_size_(AlignInt(header_size, sizeof(uint32))),
       capacity_(0),
-      variable_buffer_offset_(0) {
+      variable_buffer_offset_(0),
+      external_size_(0) {
   DCHECK_GE(static_cast<size_t>(header_size), sizeof(Header));
   DCHECK_LE(header_size, kPayloadUnit);
   Resize(kPayloadUnit);
@@ -170,7 +208,8 @@ Pickle::Pickle(const char* data, int data_len)
     : header_(reinterpret_cast<Header*>(const_cast<char*>(data))),
       header_size_(0),
       capacity_(kCapacityReadOnly),
-      variable_buffer_offset_(0) {
+      variable_buffer_offset_(0),
+      external_size_(0) {
   if (data_len >= static_cast<int>(sizeof(Header)))
     header_size_ = data_len - header_->payload_size;
 
@@ -189,8 +228,10 @@ Pickle::Pickle(const Pickle& other)
     : header_(NULL),
       header_size_(other.header_size_),
       capacity_(0),
-      variable_buffer_offset_(other.variable_buffer_offset_) {
-  size_t payload_size = header_size_ + other.header_->payload_size;
+      variable_buffer_offset_(other.variable_buffer_offset_),
+      external_data_(other.external_data_),
+      external_size_(other.external_size_) {
+  size_t payload_size = header_size_ + other.inline_payload_size();
   bool resized = Resize(payload_size);
   CHECK(resized);  // Realloc failed.
   memcpy(header_, other.header_, payload_size);
@@ -215,14 +256,84 @@ Pickle& Pickle::operator=(const Pickle& other) {
     header_ = NULL;
     header_size_ = other.header_size_;
   }
-  bool resized = Resize(other.header_size_ + other.header_->payload_size);
+  bool resized = Resize(other.header_size_ + other.inline_payload_size());
   CHECK(resized);  // Realloc failed.
   memcpy(header_, other.header_,
-         other.header_size_ + other.header_->payload_size);
+         other.header_size_ + other.inline_payload_size());
   variable_buffer_offset_ = other.variable_buffer_offset_;
+  external_data_ = other.external_data_;
+  external_size_ = other.external_size_;
   return *this;
 }
 
+bool Pickle::Reserve(size_t length) {
+  size_t needed_size = header_size_ +
+      AlignInt(inline_payload_size(), sizeof(uint32)) + length;
+  return needed_size <= capacity_ || Resize(needed_size);
+}
+
+void Pickle::GetSegments(std::vector<Segment>* segments) const {
+  segments->clear();
+  const char* buffer = reinterpret_cast<const char*>(header_);
+  size_t offset = 0;
+  for (size_t i = 0; i < external_data_.size(); ++i) {
+    const ExternalData& external = external_data_[i];
+    if (external.offset > offset) {
+      Segment inline_segment = { buffer + offset, external.offset - offset };
+      segments->push_back(inline_segment);
+    }
+    size_t size = external.memory->size();
+    if (size) {
+      Segment external_segment = {
+        reinterpret_cast<const char*>(external.memory->front()), size
+      };
+      segments->push_back(external_segment);
+    }
+    if (size % sizeof(uint32)) {
+      Segment padding = { kPadding, sizeof(uint32) - size % sizeof(uint32) };
+      segments->push_back(padding);
+    }
+    offset = external.offset;
+  }
+  Segment last = { buffer + offset, header_size_ + inline_payload_size() -
+                                    offset };
+  segments->push_back(last);
+}
+
+void Pickle::Flatten() {
+  if (!has_external_data())
+    return;
+
+  std::vector<Segment> segments;
+  GetSegments(&segments);
+  size_t size = header_size_ + header_->payload_size;
+  char* flat = static_cast<char*>(malloc(AlignInt(size, kPayloadUnit)));
+  CHECK(flat);
+  char* dest = flat;
+  for (size_t i = 0; i < segments.size(); ++i) {
+    memcpy(dest, segments[i].data, segments[i].size);
+    dest += segments[i].size;
+  }
+  DCHECK_EQ(size, static_cast<size_t>(dest - flat));
+
+  // The variable buffer moves along by the external data before it.
+  size_t variable_buffer_offset = variable_buffer_offset_;
+  for (size_t i = 0; i < external_data_.size(); ++i) {
+    if (variable_buffer_offset_ && external_data_[i].offset <=
+        variable_buffer_offset_) {
+      variable_buffer_offset +=
+          AlignInt(external_data_[i].memory->size(), sizeof(uint32));
+    }
+  }
+
+  free(header_);
+  header_ = reinterpret_cast<Header*>(flat);
+  capacity_ = AlignInt(size, kPayloadUnit);
+  variable_buffer_offset_ = variable_buffer_offset;
+  external_data_.clear();
+  external_size_ = 0;
+}
+
 bool Pickle::WriteString(const std::string& value) {
   if (!WriteInt(static_cast<int>(value.size())))
     return false;
@@ -263,6 +374,25 @@ bool Pickle::WriteBytes(const void* data, int data_len) {
   return true;
 }
 
+bool Pickle::WriteExternalData(base::RefCountedMemory* data) {
+  DCHECK_NE(kCapacityReadOnly, capacity_) << "oops: pickle is readonly";
+
+  size_t size = data->size();
+  if (size > static_cast<size_t>(kint32max) ||
+      !WriteInt(static_cast<int>(size))) {
+    return false;
+  }
+
+  ExternalData external;
+  external.offset = header_size_ + inline_payload_size();
+  external.memory = data;
+  external_data_.push_back(external);
+  size_t padded_size = AlignInt(size, sizeof(uint32));
+  external_size_ += padded_size;
+  header_->payload_size += static_cast<uint32>(padded_size);
+  return true;
+}
+
 char* Pickle::BeginWriteData(int length) {
   DCHECK_EQ(variable_buffer_offset_, 0U) <<
     "There can only be one variable buffer in a Pickle";
@@ -302,7 +432,7 @@ void Pickle::TrimWriteData(int new_length) {
 
 char* Pickle::BeginWrite(size_t length) {
   // write at a uint32-aligned offset from the beginning of the header
-  size_t offset = AlignInt(header_->payload_size, sizeof(uint32));
+  size_t offset = AlignInt(inline_payload_size(), sizeof(uint32));
 
   size_t new_size = offset + length;
   size_t needed_size = header_size_ + new_size;
@@ -313,7 +443,7 @@ char* Pickle::BeginWrite(size_t length) {
   DCHECK_LE(length, kuint32max);
 #endif
 
-  header_->payload_size = static_cast<uint32>(new_size);
+  header_->payload_size = static_cast<uint32>(new_size + external_size_);
   return payload() + offset;
 }
 
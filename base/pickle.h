@@ -7,13 +7,20 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
 #include "base/gtest_prod_util.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted.h"
 #include "base/string16.h"
+#include "base/string_piece.h"
+
+namespace base {
+class RefCountedMemory;
+}
 
 class Pickle;
 
@@ -41,6 +48,12 @@ class BASE_EXPORT PickleIterator {
   bool ReadData(const char** data, int* length) WARN_UNUSED_RESULT;
   bool ReadBytes(const char** data, int length) WARN_UNUSED_RESULT;
 
+  // Like ReadString() and ReadString16(), but point |result| at the string
+  // in the Pickle rather than copying it out.  |result| is valid for as long
+  // as the Pickle's data is.
+  bool ReadStringPiece(base::StringPiece* result) WARN_UNUSED_RESULT;
+  bool ReadStringPiece16(base::StringPiece16* result) WARN_UNUSED_RESULT;
+
   // Safer version of ReadInt() checks for the result not being negative.
   // Use it for reading the object sizes.
   bool ReadLength(int* result) WARN_UNUSED_RESULT {
@@ -130,10 +143,40 @@ class BASE_EXPORT Pickle {
   Pickle& operator=(const Pickle& other);
 
   // Returns the size of the Pickle's data.
-  size_t size() const { return header_size_ + header_->payload_size; }
+  size_t size() const {
+    DCHECK(!has_external_data()) << "Flatten() the pickle first";
+    return header_size_ + header_->payload_size;
+  }
 
   // Returns the data for this Pickle.
-  const void* data() const { return header_; }
+  const void* data() const {
+    DCHECK(!has_external_data()) << "Flatten() the pickle first";
+    return header_;
+  }
+
+  // Makes room for |length| more bytes of payload, so that writing that much
+  // does not reallocate the buffer.  Every write takes a multiple of four
+  // bytes, and strings and data take four more for their length.
+  bool Reserve(size_t length);
+
+  // A run of bytes of the Pickle's data.  See GetSegments().
+  struct Segment {
+    const char* data;
+    size_t size;
+  };
+
+  // Whether WriteExternalData() has been used since the last Flatten().
+  bool has_external_data() const { return !external_data_.empty(); }
+
+  // Fills |segments| with the runs of bytes which, one after the other, are
+  // the Pickle's data.  Unlike data() this works while the Pickle holds
+  // external data, so the Pickle can be written out with writev() or the like
+  // without copying that data.  The segments are valid until the next write.
+  void GetSegments(std::vector<Segment>* segments) const;
+
+  // Copies any external data into the Pickle's own buffer, so that data() and
+  // size() may be used and the Pickle read from.
+  void Flatten();
 
   // For compatibility, these older style read methods pass through to the
   // PickleIterator methods.
@@ -217,6 +260,11 @@ class BASE_EXPORT Pickle {
   bool WriteData(const char* data, int length);
   bool WriteBytes(const void* data, int data_len);
 
+  // Writes |data| as WriteData() would, but keeps a reference to it in place
+  // of copying it.  The Pickle must be written out with GetSegments(), or
+  // flattened, before it is read.
+  bool WriteExternalData(base::RefCountedMemory* data);
+
   // Same as WriteData, but allows the caller to write directly into the
   // Pickle. This saves a copy in cases where the data is not already
   // available in a buffer. The caller should take care to not write more
@@ -257,7 +305,8 @@ class BASE_EXPORT Pickle {
     return static_cast<const T*>(header_);
   }
 
-  // The payload is the pickle data immediately following the header.
+  // The payload is the pickle data immediately following the header.  The
+  // size includes any external data.
   size_t payload_size() const { return header_->payload_size; }
   const char* payload() const {
     return reinterpret_cast<const char*>(header_) + header_size_;
@@ -272,10 +321,12 @@ class BASE_EXPORT Pickle {
   // header + payload.
   char* end_of_payload() {
     // We must have a valid header_.
+    DCHECK(!has_external_data());
     return payload() + payload_size();
   }
   const char* end_of_payload() const {
     // This object may be invalid.
+    DCHECK(!has_external_data());
     return header_ ? payload() + payload_size() : NULL;
   }
 
@@ -317,11 +368,30 @@ class BASE_EXPORT Pickle {
  private:
   friend class PickleIterator;
 
+  // Memory written with WriteExternalData().  Its bytes belong at |offset|
+  // in the buffer, which is where the buffer continues after them.
+  struct ExternalData {
+    ExternalData();
+    ~ExternalData();
+
+    size_t offset;
+    scoped_refptr<base::RefCountedMemory> memory;
+  };
+
+  // The number of bytes of the payload in the buffer, the rest being
+  // external.
+  size_t inline_payload_size() const {
+    return header_->payload_size - external_size_;
+  }
+
   Header* header_;
   size_t header_size_;  // Supports extra data between header and payload.
   // Allocation size of payload (or -1 if allocation is const).
   size_t capacity_;
   size_t variable_buffer_offset_;  // IF non-zero, then offset to a buffer.
+  std::vector<ExternalData> external_data_;
+  // The padded size of all of |external_data_|.
+  size_t external_size_;
 
   FRIEND_TEST_ALL_PREFIXES(PickleTest, Resize);
   FRIEND_TEST_ALL_PREFIXES(PickleTest, FindNext);
@@ -5,9 +5,11 @@
 #include <string>
 
 #include "base/basictypes.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/pickle.h"
 #include "base/string16.h"
+#include "base/utf_string_conversions.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace {
@@ -334,3 +336,105 @@ TEST(PickleTest, ReadBytes) {
   memcpy(&outdata, outdata_char, sizeof(outdata));
   EXPECT_EQ(data, outdata);
 }
+
+// The StringPiece reads point into the pickle.
+TEST(PickleTest, ReadStringPiece) {
+  Pickle pickle;
+  EXPECT_TRUE(pickle.WriteString(teststr));
+  EXPECT_TRUE(pickle.WriteString16(ASCIIToUTF16(teststr)));
+  EXPECT_TRUE(pickle.WriteString(std::string()));
+
+  PickleIterator iter(pickle);
+  base::StringPiece piece;
+  EXPECT_TRUE(iter.ReadStringPiece(&piece));
+  EXPECT_EQ(teststr, piece.as_string());
+  const char* data = static_cast<const char*>(pickle.data());
+  EXPECT_GE(piece.data(), data);
+  EXPECT_LT(piece.data(), data + pickle.size());
+  base::StringPiece16 piece16;
+  EXPECT_TRUE(iter.ReadStringPiece16(&piece16));
+  EXPECT_EQ(ASCIIToUTF16(teststr), piece16.as_string());
+  EXPECT_TRUE(iter.ReadStringPiece(&piece));
+  EXPECT_TRUE(piece.empty());
+  EXPECT_FALSE(iter.ReadStringPiece(&piece));
+}
+
+// A pickle with external data has the same bytes as one with the data
+// written in place, whether gathered from its segments or flattened.
+TEST(PickleTest, ExternalData) {
+  scoped_refptr<base::RefCountedString> odd(new base::RefCountedString);
+  odd->data() = "abcde";
+  scoped_refptr<base::RefCountedString> empty(new base::RefCountedString);
+  scoped_refptr<base::RefCountedString> even(new base::RefCountedString);
+  even->data() = "12345678";
+
+  Pickle expected;
+  EXPECT_TRUE(expected.WriteInt(testint));
+  EXPECT_TRUE(expected.WriteData(odd->data().data(), odd->data().size()));
+  EXPECT_TRUE(expected.WriteString(teststr));
+  EXPECT_TRUE(expected.WriteData(NULL, 0));
+  EXPECT_TRUE(expected.WriteData(even->data().data(), even->data().size()));
+  EXPECT_TRUE(expected.WriteData(even->data().data(), even->data().size()));
+  EXPECT_TRUE(expected.WriteBool(testbool2));
+  std::string expected_bytes(static_cast<const char*>(expected.data()),
+                             expected.size());
+
+  Pickle pickle;
+  EXPECT_TRUE(pickle.WriteInt(testint));
+  EXPECT_TRUE(pickle.WriteExternalData(odd));
+  EXPECT_TRUE(pickle.WriteString(teststr));
+  EXPECT_TRUE(pickle.WriteExternalData(empty));
+  EXPECT_TRUE(pickle.WriteExternalData(even));
+  EXPECT_TRUE(pickle.WriteExternalData(even));
+  EXPECT_TRUE(pickle.WriteBool(testbool2));
+  EXPECT_TRUE(pickle.has_external_data());
+  EXPECT_EQ(expected.payload_size(), pickle.payload_size());
+
+  std::vector<Pickle::Segment> segments;
+  pickle.GetSegments(&segments);
+  std::string gathered;
+  for (size_t i = 0; i < segments.size(); ++i)
+    gathered.append(segments[i].data, segments[i].size);
+  EXPECT_EQ(expected_bytes, gathered);
+
+  // Copies share the external data too.
+  Pickle copy(pickle);
+  EXPECT_TRUE(copy.has_external_data());
+  copy.Flatten();
+  EXPECT_FALSE(copy.has_external_data());
+  EXPECT_EQ(expected_bytes,
+            std::string(static_cast<const char*>(copy.data()), copy.size()));
+
+  // Writes after flattening carry on at the end.
+  pickle.Flatten();
+  EXPECT_TRUE(pickle.WriteInt(testint));
+  PickleIterator iter(pickle);
+  int outint;
+  base::StringPiece piece;
+  bool outbool;
+  EXPECT_TRUE(iter.ReadInt(&outint));
+  EXPECT_TRUE(iter.ReadStringPiece(&piece));
+  EXPECT_EQ("abcde", piece.as_string());
+  EXPECT_TRUE(iter.ReadStringPiece(&piece));
+  EXPECT_EQ(teststr, piece.as_string());
+  EXPECT_TRUE(iter.ReadStringPiece(&piece));
+  EXPECT_TRUE(piece.empty());
+  EXPECT_TRUE(iter.ReadStringPiece(&piece));
+  EXPECT_EQ("12345678", piece.as_string());
+  EXPECT_TRUE(iter.ReadStringPiece(&piece));
+  EXPECT_TRUE(iter.ReadBool(&outbool));
+  EXPECT_EQ(testbool2, outbool);
+  EXPECT_TRUE(iter.ReadInt(&outint));
+  EXPECT_EQ(testint, outint);
+}
+
+// Writing no more than was reserved keeps the buffer where it is.
+TEST(PickleTest, Reserve) {
+  Pickle pickle;
+  std::string big(1000, 'x');
+  EXPECT_TRUE(pickle.Reserve(2 * (sizeof(int) + big.size())));
+  const void* data = pickle.data();
+  EXPECT_TRUE(pickle.WriteString(big));
+  EXPECT_TRUE(pickle.WriteString(big));
+  EXPECT_EQ(data, pickle.data());
+}
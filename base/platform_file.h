@@ -164,6 +164,23 @@ BASE_EXPORT bool TouchPlatformFile(PlatformFile file,
 // Returns some information for the given file.
 BASE_EXPORT bool GetPlatformFileInfo(PlatformFile file, PlatformFileInfo* info);
 
+// How a file is about to be read, for HintPlatformFileAccess().
+enum PlatformFileAccessHint {
+  // The range will be read from start to end, so read ahead aggressively.
+  PLATFORM_FILE_ACCESS_SEQUENTIAL,
+  // The range will be read soon, so start reading it into the cache now.
+  PLATFORM_FILE_ACCESS_WILL_NEED
+};
+
+// Tells the system how |length| bytes of |file| from |offset| will be read;
+// a |length| of 0 means to the end of the file.  This only affects speed.
+// Returns false if the hint could not be given, which includes platforms
+// that have no way to give it.
+BASE_EXPORT bool HintPlatformFileAccess(PlatformFile file,
+                                        int64 offset,
+                                        int64 length,
+                                        PlatformFileAccessHint hint);
+
 // Use this class to pass ownership of a PlatformFile to a receiver that may or
 // may not want to accept it.  This class does not own the storage for the
 // PlatformFile.
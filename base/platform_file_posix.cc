@@ -9,6 +9,8 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "base/eintr_wrapper.h"
 #include "base/file_path.h"
 #include "base/logging.h"
@@ -283,4 +285,34 @@ bool GetPlatformFileInfo(PlatformFile file, PlatformFileInfo* info) {
   return true;
 }
 
+bool HintPlatformFileAccess(PlatformFile file,
+                            int64 offset,
+                            int64 length,
+                            PlatformFileAccessHint hint) {
+  if (file < 0 || offset < 0 || length < 0)
+    return false;
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  int advice = (hint == PLATFORM_FILE_ACCESS_SEQUENTIAL) ?
+      POSIX_FADV_SEQUENTIAL : POSIX_FADV_WILLNEED;
+  return !posix_fadvise(file, offset, length, advice);
+#elif defined(OS_MACOSX)
+  if (hint == PLATFORM_FILE_ACCESS_SEQUENTIAL)
+    return HANDLE_EINTR(fcntl(file, F_RDAHEAD, 1)) != -1;
+  // F_RDADVISE wants an explicit count, so it cannot hint "to the end".
+  if (!length) {
+    stat_wrapper_t file_info;
+    if (CallFstat(file, &file_info) || file_info.st_size <= offset)
+      return false;
+    length = file_info.st_size - offset;
+  }
+  struct radvisory advisory;
+  advisory.ra_offset = offset;
+  advisory.ra_count = static_cast<int>(std::min<int64>(length, kint32max));
+  return HANDLE_EINTR(fcntl(file, F_RDADVISE, &advisory)) != -1;
+#else
+  return false;
+#endif
+}
+
 }  // namespace base
@@ -209,6 +209,44 @@ TEST(PlatformFile, ReadWritePlatformFile) {
   base::ClosePlatformFile(file);
 }
 
+TEST(PlatformFile, HintPlatformFileAccess) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath file_path = temp_dir.path().AppendASCII("hinted_file");
+  base::PlatformFile file = base::CreatePlatformFile(
+      file_path,
+      base::PLATFORM_FILE_CREATE |
+      base::PLATFORM_FILE_READ |
+      base::PLATFORM_FILE_WRITE,
+      NULL, NULL);
+  EXPECT_NE(base::kInvalidPlatformFileValue, file);
+
+  char data_to_write[] = "test";
+  const int kTestDataSize = 4;
+  EXPECT_EQ(kTestDataSize, WriteFully(file, 0, data_to_write, kTestDataSize));
+
+  // Hints may be unsupported, but must never change what is read.
+#if defined(OS_LINUX) || defined(OS_ANDROID) || defined(OS_MACOSX)
+  EXPECT_TRUE(base::HintPlatformFileAccess(
+      file, 0, 0, base::PLATFORM_FILE_ACCESS_SEQUENTIAL));
+  EXPECT_TRUE(base::HintPlatformFileAccess(
+      file, 0, kTestDataSize, base::PLATFORM_FILE_ACCESS_WILL_NEED));
+#else
+  base::HintPlatformFileAccess(
+      file, 0, 0, base::PLATFORM_FILE_ACCESS_SEQUENTIAL);
+  base::HintPlatformFileAccess(
+      file, 0, kTestDataSize, base::PLATFORM_FILE_ACCESS_WILL_NEED);
+#endif
+  char data_read[32];
+  EXPECT_EQ(kTestDataSize, ReadFully(file, 0, data_read, kTestDataSize));
+  EXPECT_EQ(0, memcmp(data_to_write, data_read, kTestDataSize));
+
+  EXPECT_FALSE(base::HintPlatformFileAccess(
+      base::kInvalidPlatformFileValue, 0, 0,
+      base::PLATFORM_FILE_ACCESS_SEQUENTIAL));
+  base::ClosePlatformFile(file);
+}
+
 TEST(PlatformFile, TruncatePlatformFile) {
   ScopedTempDir temp_dir;
   ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
@@ -233,4 +233,13 @@ bool GetPlatformFileInfo(PlatformFile file, PlatformFileInfo* info) {
   return true;
 }
 
+bool HintPlatformFileAccess(PlatformFile file,
+                            int64 offset,
+                            int64 length,
+                            PlatformFileAccessHint hint) {
+  // Windows only takes access hints when a file is opened, as
+  // FILE_FLAG_SEQUENTIAL_SCAN.
+  return false;
+}
+
 }  // namespace base
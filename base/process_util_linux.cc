@@ -5,13 +5,18 @@
 #include "base/process_util.h"
 
 #include <dirent.h>
+#include <fcntl.h>
 #include <malloc.h>
+#include <string.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "base/eintr_wrapper.h"
 #include "base/file_util.h"
 #include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/stl_util.h"
 #include "base/string_number_conversions.h"
 #include "base/string_split.h"
 #include "base/string_tokenizer.h"
@@ -91,10 +96,12 @@ bool ParseProcStats(const std::string& stats_data,
                         close_parens_idx - (open_parens_idx + 1)));
 
   // Split the rest.
-  std::vector<std::string> other_stats;
-  base::SplitString(stats_data.substr(close_parens_idx + 2), ' ', &other_stats);
+  std::vector<base::StringPiece> other_stats;
+  base::SplitStringPiece(
+      base::StringPiece(stats_data).substr(close_parens_idx + 2), ' ',
+      &other_stats);
   for (size_t i = 0; i < other_stats.size(); ++i)
-    proc_stats->push_back(other_stats[i]);
+    proc_stats->push_back(other_stats[i].as_string());
   return true;
 }
 
@@ -274,6 +281,142 @@ int ReadProcStatusAndGetFieldAsInt(pid_t pid, const std::string& field) {
   return 0;
 }
 
+// Reads the /proc file open as |fd| from the start into |buffer|, which holds
+// |size| bytes.  The kernel writes the contents afresh for each read from
+// offset 0, so an open file can be read again and again.  Returns the number
+// of bytes read, or -1 on error.
+ssize_t ReadProcFile(int fd, char* buffer, size_t size) {
+  size_t length = 0;
+  while (length < size) {
+    ssize_t result = HANDLE_EINTR(pread(fd, buffer + length, size - length,
+                                        length));
+    if (result < 0)
+      return -1;
+    if (result == 0)
+      break;
+    length += result;
+  }
+  return length;
+}
+
+// Parses the decimal number in [|*pos|, |end|), after any spaces, and moves
+// |*pos| past it.  Returns false if there is no number there.
+bool ConsumeNumber(const char** pos, const char* end, uint64* value) {
+  const char* p = *pos;
+  while (p != end && *p == ' ')
+    ++p;
+  if (p == end || *p < '0' || *p > '9')
+    return false;
+  uint64 result = 0;
+  for (; p != end && *p >= '0' && *p <= '9'; ++p)
+    result = result * 10 + (*p - '0');
+  *pos = p;
+  *value = result;
+  return true;
+}
+
+// Moves |*pos|, which is in field |*field| of a /proc/<pid>/stat line, to the
+// start of field |target|.
+bool SkipToField(const char** pos, const char* end, int* field, int target) {
+  while (*field < target) {
+    const char* space =
+        static_cast<const char*>(memchr(*pos, ' ', end - *pos));
+    if (!space)
+      return false;
+    *pos = space + 1;
+    ++*field;
+  }
+  return true;
+}
+
+// Parses the user plus system time and the virtual size out of the
+// /proc/<pid>/stat line in [|data|, |data| + |length|).
+bool ParseProcStatBuffer(const char* data, size_t length,
+                         uint64* cpu_ticks, uint64* virtual_bytes) {
+  // The executable name may hold spaces and parentheses itself, so count
+  // the fields from the last ')'.
+  const char* end = data + length;
+  const char* pos = end;
+  while (pos != data && pos[-1] != ')')
+    --pos;
+  if (pos == data)
+    return false;
+
+  int field = VM_COMM;
+  uint64 utime, stime;
+  if (!SkipToField(&pos, end, &field, VM_UTIME) ||
+      !ConsumeNumber(&pos, end, &utime) ||
+      !SkipToField(&pos, end, &field, VM_STIME) ||
+      !ConsumeNumber(&pos, end, &stime) ||
+      !SkipToField(&pos, end, &field, VM_VSIZE) ||
+      !ConsumeNumber(&pos, end, virtual_bytes)) {
+    return false;
+  }
+  *cpu_ticks = utime + stime;
+  return true;
+}
+
+// Parses the resident and shared page counts out of the /proc/<pid>/statm
+// line in [|data|, |data| + |length|).
+bool ParseProcStatmBuffer(const char* data, size_t length,
+                          uint64* resident_pages, uint64* shared_pages) {
+  const char* end = data + length;
+  uint64 size;
+  return ConsumeNumber(&data, end, &size) &&
+         ConsumeNumber(&data, end, resident_pages) &&
+         ConsumeNumber(&data, end, shared_pages);
+}
+
+// Parses the totals of /proc/<pid>/smaps_rollup in [|data|, |data| +
+// |length|), which come one to a line as "Name:   1234 kB", into |snapshot|.
+bool ParseSmapsRollupBuffer(const char* data, size_t length,
+                            base::ProcessMetricsSnapshot* snapshot) {
+  uint64 rss = 0, pss = 0, shared_clean = 0, shared_dirty = 0;
+  uint64 private_clean = 0, private_dirty = 0, swap = 0;
+  const struct {
+    const char* name;
+    uint64* value;
+  } kFields[] = {
+    { "Rss:", &rss },
+    { "Pss:", &pss },
+    { "Shared_Clean:", &shared_clean },
+    { "Shared_Dirty:", &shared_dirty },
+    { "Private_Clean:", &private_clean },
+    { "Private_Dirty:", &private_dirty },
+    { "Swap:", &swap },
+  };
+
+  const char* end = data + length;
+  size_t found = 0;
+  for (const char* line = data; line < end; ) {
+    const char* line_end =
+        static_cast<const char*>(memchr(line, '\n', end - line));
+    if (!line_end)
+      line_end = end;
+    for (size_t i = 0; i < ARRAYSIZE_UNSAFE(kFields); ++i) {
+      size_t name_length = strlen(kFields[i].name);
+      if (static_cast<size_t>(line_end - line) > name_length &&
+          memcmp(line, kFields[i].name, name_length) == 0) {
+        const char* pos = line + name_length;
+        if (!ConsumeNumber(&pos, line_end, kFields[i].value))
+          return false;
+        ++found;
+        break;
+      }
+    }
+    line = line_end + 1;
+  }
+  if (found != ARRAYSIZE_UNSAFE(kFields))
+    return false;
+
+  snapshot->resident_bytes = rss * 1024;
+  snapshot->proportional_bytes = pss * 1024;
+  snapshot->shared_bytes = (shared_clean + shared_dirty) * 1024;
+  snapshot->private_bytes = (private_clean + private_dirty) * 1024;
+  snapshot->swap_bytes = swap * 1024;
+  return true;
+}
+
 }  // namespace
 
 namespace base {
@@ -444,14 +587,11 @@ bool ProcessMetrics::GetWorkingSetKBytes(WorkingSetKBytes* ws_usage) const {
       return false;
   }
 
-  std::vector<std::string> statm_vec;
-  base::SplitString(statm, ' ', &statm_vec);
-  if (statm_vec.size() != 7)
+  uint64 statm_rss, statm_shared;
+  if (!ParseProcStatmBuffer(statm.data(), statm.size(), &statm_rss,
+                            &statm_shared)) {
     return false;  // Not the format we expect.
-
-  int statm_rss, statm_shared;
-  base::StringToInt(statm_vec[1], &statm_rss);
-  base::StringToInt(statm_vec[2], &statm_shared);
+  }
 
   ws_usage->priv = (statm_rss - statm_shared) * page_size_kb;
   ws_usage->shared = statm_shared * page_size_kb;
@@ -665,6 +805,158 @@ size_t GetSystemCommitCharge() {
   return meminfo.total - meminfo.free - meminfo.buffers - meminfo.cached;
 }
 
+ProcessMetricsSnapshot::ProcessMetricsSnapshot()
+    : pid(0),
+      valid(false),
+      virtual_bytes(0),
+      resident_bytes(0),
+      private_bytes(0),
+      shared_bytes(0),
+      proportional_bytes(0),
+      swap_bytes(0),
+      cpu_ticks(0),
+      cpu_usage(0) {
+}
+
+struct ProcessMetricsSampler::ProcessFiles {
+  ProcessFiles()
+      : stat_fd(-1),
+        statm_fd(-1),
+        smaps_rollup_fd(-1),
+        last_cpu_ticks(0) {
+  }
+
+  ~ProcessFiles() {
+    int fds[] = { stat_fd, statm_fd, smaps_rollup_fd };
+    for (size_t i = 0; i < arraysize(fds); ++i) {
+      if (fds[i] >= 0 && HANDLE_EINTR(close(fds[i])) < 0)
+        DPLOG(ERROR) << "close";
+    }
+  }
+
+  int stat_fd;
+  int statm_fd;
+  // -1 on kernels without smaps_rollup, which are read through statm only.
+  int smaps_rollup_fd;
+
+  // What cpu_usage is computed from.
+  uint64 last_cpu_ticks;
+  TimeTicks last_time;
+};
+
+ProcessMetricsSampler::ProcessMetricsSampler() {
+}
+
+ProcessMetricsSampler::~ProcessMetricsSampler() {
+  STLDeleteValues(&files_);
+}
+
+void ProcessMetricsSampler::Sample(
+    const std::vector<ProcessId>& pids,
+    std::vector<ProcessMetricsSnapshot>* snapshots) {
+  // Synchronously reading files in /proc is safe.
+  ThreadRestrictions::ScopedAllowIO allow_io;
+
+  TimeTicks now = TimeTicks::Now();
+  FilesMap sampled;
+  snapshots->assign(pids.size(), ProcessMetricsSnapshot());
+  for (size_t i = 0; i < pids.size(); ++i) {
+    ProcessMetricsSnapshot* snapshot = &(*snapshots)[i];
+    snapshot->pid = pids[i];
+
+    ProcessFiles* files;
+    FilesMap::iterator it = files_.find(pids[i]);
+    if (it != files_.end()) {
+      files = it->second;
+      files_.erase(it);
+    } else {
+      files = OpenProcessFiles(pids[i]);
+      if (!files)
+        continue;
+    }
+
+    if (!SampleProcess(files, now, snapshot) ||
+        !sampled.insert(std::make_pair(pids[i], files)).second) {
+      delete files;
+    }
+  }
+
+  // Whatever is left is for processes the caller no longer asks about.
+  STLDeleteValues(&files_);
+  files_.swap(sampled);
+}
+
+// static
+ProcessMetricsSampler::ProcessFiles* ProcessMetricsSampler::OpenProcessFiles(
+    ProcessId pid) {
+  std::string dir = GetProcPidDir(pid).value();
+  scoped_ptr<ProcessFiles> files(new ProcessFiles);
+  files->stat_fd = HANDLE_EINTR(open((dir + "/stat").c_str(), O_RDONLY));
+  files->statm_fd = HANDLE_EINTR(open((dir + "/statm").c_str(), O_RDONLY));
+  if (files->stat_fd < 0 || files->statm_fd < 0)
+    return NULL;
+  files->smaps_rollup_fd =
+      HANDLE_EINTR(open((dir + "/smaps_rollup").c_str(), O_RDONLY));
+  return files.release();
+}
+
+// static
+bool ProcessMetricsSampler::SampleProcess(ProcessFiles* files,
+                                          TimeTicks now,
+                                          ProcessMetricsSnapshot* snapshot) {
+  // Big enough for any stat line, and for smaps_rollup with room to spare.
+  char buffer[4096];
+
+  ssize_t length = ReadProcFile(files->stat_fd, buffer, sizeof(buffer));
+  uint64 cpu_ticks, virtual_bytes;
+  if (length <= 0 ||
+      !ParseProcStatBuffer(buffer, length, &cpu_ticks, &virtual_bytes)) {
+    return false;
+  }
+
+  if (files->smaps_rollup_fd >= 0) {
+    length = ReadProcFile(files->smaps_rollup_fd, buffer, sizeof(buffer));
+    if (length <= 0 || !ParseSmapsRollupBuffer(buffer, length, snapshot)) {
+      // A zombie has no memory left to walk and reads back nothing here;
+      // statm still reads, so go on with that.
+      if (HANDLE_EINTR(close(files->smaps_rollup_fd)) < 0)
+        DPLOG(ERROR) << "close";
+      files->smaps_rollup_fd = -1;
+    }
+  }
+  if (files->smaps_rollup_fd < 0) {
+    length = ReadProcFile(files->statm_fd, buffer, sizeof(buffer));
+    uint64 resident_pages, shared_pages;
+    if (length <= 0 ||
+        !ParseProcStatmBuffer(buffer, length, &resident_pages,
+                              &shared_pages)) {
+      return false;
+    }
+    static const size_t kPageSize = getpagesize();
+    snapshot->resident_bytes = resident_pages * kPageSize;
+    snapshot->shared_bytes = shared_pages * kPageSize;
+    snapshot->private_bytes = (resident_pages - shared_pages) * kPageSize;
+    snapshot->proportional_bytes = 0;
+    snapshot->swap_bytes = 0;
+  }
+
+  // As in ProcessMetrics::GetCPUUsage().
+  static const int kHertz = sysconf(_SC_CLK_TCK);
+  if (!files->last_time.is_null()) {
+    TimeDelta time_delta = now - files->last_time;
+    if (time_delta > TimeDelta()) {
+      snapshot->cpu_usage = 100.0 * (cpu_ticks - files->last_cpu_ticks) /
+          (kHertz * time_delta.InSecondsF());
+    }
+  }
+  snapshot->virtual_bytes = virtual_bytes;
+  snapshot->cpu_ticks = cpu_ticks;
+  files->last_cpu_ticks = cpu_ticks;
+  files->last_time = now;
+  snapshot->valid = true;
+  return true;
+}
+
 namespace {
 
 void OnNoMemorySize(size_t size) {
@@ -0,0 +1,65 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <signal.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/process_util.h"
+#include "base/stringprintf.h"
+#include "base/test/benchmark.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// The memory the parent touches before it launches, in megabytes, since
+// fork() copies the page tables of all of it.
+const int kResidentMegabytes[] = { 0, 64, 256, 1024 };
+
+void LaunchAndWait(const base::LaunchOptions* options) {
+  std::vector<std::string> argv;
+  argv.push_back("/bin/true");
+  EXPECT_TRUE(base::LaunchProcess(argv, *options, NULL));
+}
+
+// Measures how long launching /bin/true and waiting for it takes, for each
+// amount of resident memory of the parent.
+void RunLaunchPerfTest(const char* name, const base::LaunchOptions& options) {
+  base::BenchmarkOptions benchmark_options;
+  benchmark_options.min_samples = 5;
+  benchmark_options.max_samples = 100;
+  benchmark_options.target_relative_error = 0.05;
+
+  for (size_t i = 0; i < arraysize(kResidentMegabytes); ++i) {
+    std::vector<char> resident(kResidentMegabytes[i] << 20);
+    if (!resident.empty())
+      memset(&resident[0], 1, resident.size());
+    base::RunBenchmark(
+        base::StringPrintf("LaunchProcess_%s_%dMB", name,
+                           kResidentMegabytes[i]),
+        base::Bind(&LaunchAndWait, &options), benchmark_options);
+  }
+}
+
+}  // namespace
+
+TEST(ProcessUtilPerfTest, LaunchProcess) {
+  base::LaunchOptions options;
+  options.wait = true;
+  RunLaunchPerfTest("default", options);
+}
+
+#if defined(OS_LINUX)
+TEST(ProcessUtilPerfTest, LaunchProcessFork) {
+  // clone() with just SIGCHLD is fork(), which LaunchProcess() uses as it
+  // would without the vfork path.
+  base::LaunchOptions options;
+  options.wait = true;
+  options.clone_flags = SIGCHLD;
+  RunLaunchPerfTest("fork", options);
+}
+#endif  // defined(OS_LINUX)
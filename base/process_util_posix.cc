@@ -37,6 +37,12 @@
 #include <sys/ioctl.h>
 #endif
 
+#if defined(OS_LINUX)
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
 #if defined(OS_FREEBSD)
 #include <sys/event.h>
 #include <sys/ucontext.h>
@@ -340,6 +346,51 @@ typedef scoped_ptr_malloc<DIR, ScopedDIRClose> ScopedDIR;
   static const char kFDDir[] = "/proc/self/fd";
 #endif
 
+#if defined(OS_LINUX) && !defined(__NR_close_range) && \
+    (defined(ARCH_CPU_X86_FAMILY) || defined(ARCH_CPU_ARM_FAMILY))
+// close_range() came in Linux 5.9, with the same number on these
+// architectures; older headers don't have it.
+#define __NR_close_range 436
+#endif
+
+#if defined(__NR_close_range)
+namespace {
+
+// Closes the fds above stderr and below |max_fds| that aren't the dest of any
+// arc of |saved_mapping|, with a close_range() for each gap between them
+// instead of a close() for each fd. The fds Valgrind keeps for itself are
+// above |max_fds| and stay open. Returns false if the kernel doesn't have
+// close_range(), in which case some of the fds may be closed.
+bool CloseFdRanges(const base::InjectiveMultimap& saved_mapping,
+                   rlim_t max_fds) {
+  // DANGER: no calls to malloc are allowed from now on:
+  // http://crbug.com/36678
+  rlim_t first = STDERR_FILENO + 1;
+  while (first < max_fds) {
+    // The lowest fd to keep from |first| on, found again each time since
+    // |saved_mapping| can't be sorted here.
+    rlim_t next_kept = max_fds;
+    for (InjectiveMultimap::const_iterator i = saved_mapping.begin();
+         i != saved_mapping.end(); ++i) {
+      if (i->dest < 0)
+        continue;
+      rlim_t dest = static_cast<rlim_t>(i->dest);
+      if (dest >= first && dest < next_kept)
+        next_kept = dest;
+    }
+    if (next_kept > first &&
+        syscall(__NR_close_range, static_cast<unsigned int>(first),
+                static_cast<unsigned int>(next_kept - 1), 0) != 0) {
+      return false;
+    }
+    first = next_kept + 1;
+  }
+  return true;
+}
+
+}  // namespace
+#endif  // defined(__NR_close_range)
+
 void CloseSuperfluousFds(const base::InjectiveMultimap& saved_mapping) {
   // DANGER: no calls to malloc are allowed from now on:
   // http://crbug.com/36678
@@ -358,6 +409,11 @@ void CloseSuperfluousFds(const base::InjectiveMultimap& saved_mapping) {
   if (max_fds > INT_MAX)
     max_fds = INT_MAX;
 
+#if defined(__NR_close_range)
+  if (CloseFdRanges(saved_mapping, max_fds))
+    return;
+#endif
+
   DirReaderPosix fd_dir(kFDDir);
 
   if (!fd_dir.IsValid()) {
@@ -538,6 +594,205 @@ char** AlterEnvironment(const EnvironmentVector& changes,
   return ret;
 }
 
+namespace {
+
+// What the child of LaunchProcess() needs before it execs, all made by the
+// parent so that the child doesn't have to allocate.
+struct ChildLaunchState {
+  const LaunchOptions* options;
+  char* const* argv;
+  // The environment to exec with, or NULL to keep the one of the parent.
+  char** new_environ;
+  // fd_shuffle1 is mutated by ShuffleFileDescriptors().
+  InjectiveMultimap* fd_shuffle1;
+  const InjectiveMultimap* fd_shuffle2;
+#if defined(OS_LINUX)
+  // The signal mask of the parent, which blocks all signals while a vforked
+  // child runs in its memory.
+  sigset_t old_signal_mask;
+#endif
+};
+
+// Sets up the child of LaunchProcess() for its exec: stdin, the process group,
+// the rlimits, the signal handlers, the controlling terminal and the fds.
+// Calls _exit() if it can't.
+void PrepareChild(const ChildLaunchState& state) {
+  const LaunchOptions& options = *state.options;
+
+  // If a child process uses the readline library, the process block forever.
+  // In BSD like OSes including OS X it is safe to assign /dev/null as stdin.
+  // See http://crbug.com/56596.
+  int null_fd = HANDLE_EINTR(open("/dev/null", O_RDONLY));
+  if (null_fd < 0) {
+    RAW_LOG(ERROR, "Failed to open /dev/null");
+    _exit(127);
+  }
+
+  int new_fd = HANDLE_EINTR(dup2(null_fd, STDIN_FILENO));
+  if (new_fd != STDIN_FILENO) {
+    RAW_LOG(ERROR, "Failed to dup /dev/null for stdin");
+    _exit(127);
+  }
+  if (null_fd != STDIN_FILENO)
+    ignore_result(HANDLE_EINTR(close(null_fd)));
+
+  if (options.new_process_group) {
+    // Instead of inheriting the process group ID of the parent, the child
+    // starts off a new process group with pgid equal to its process ID.
+    if (setpgid(0, 0) < 0) {
+      RAW_LOG(ERROR, "setpgid failed");
+      _exit(127);
+    }
+  }
+
+  if (options.maximize_rlimits) {
+    // Some resource limits need to be maximal in this child.
+    std::set<int>::const_iterator resource;
+    for (resource = options.maximize_rlimits->begin();
+         resource != options.maximize_rlimits->end();
+         ++resource) {
+      struct rlimit limit;
+      if (getrlimit(*resource, &limit) < 0) {
+        RAW_LOG(WARNING, "getrlimit failed");
+      } else if (limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        if (setrlimit(*resource, &limit) < 0) {
+          RAW_LOG(WARNING, "setrlimit failed");
+        }
+      }
+    }
+  }
+
+#if defined(OS_MACOSX)
+  RestoreDefaultExceptionHandler();
+#endif  // defined(OS_MACOSX)
+
+  ResetChildSignalHandlersToDefaults();
+
+#if 0
+  // When debugging it can be helpful to check that we really aren't making
+  // any hidden calls to malloc.
+  void *malloc_thunk =
+      reinterpret_cast<void*>(reinterpret_cast<intptr_t>(malloc) & ~4095);
+  mprotect(malloc_thunk, 4096, PROT_READ | PROT_WRITE | PROT_EXEC);
+  memset(reinterpret_cast<void*>(malloc), 0xff, 8);
+#endif  // 0
+
+  // DANGER: no calls to malloc are allowed from now on:
+  // http://crbug.com/36678
+
+#if defined(OS_CHROMEOS)
+  if (options.ctrl_terminal_fd >= 0) {
+    // Set process' controlling terminal.
+    if (HANDLE_EINTR(setsid()) != -1) {
+      if (HANDLE_EINTR(
+              ioctl(options.ctrl_terminal_fd, TIOCSCTTY, NULL)) == -1) {
+        RAW_LOG(WARNING, "ioctl(TIOCSCTTY), ctrl terminal not set");
+      }
+    } else {
+      RAW_LOG(WARNING, "setsid failed, ctrl terminal not set");
+    }
+  }
+#endif  // defined(OS_CHROMEOS)
+
+  if (!ShuffleFileDescriptors(state.fd_shuffle1))
+    _exit(127);
+
+  CloseSuperfluousFds(*state.fd_shuffle2);
+}
+
+#if defined(OS_LINUX)
+// The stack of a vforked child, besides the pointers execvpe() may copy argv
+// into.
+const size_t kVforkStackSize = 64 * 1024;
+
+// Returns true if LaunchProcess() can start the child with vfork semantics:
+// the child runs in the memory of the parent until it execs, so starting it
+// doesn't copy the page tables of the parent, which takes longer the more
+// memory the parent has.
+bool CanLaunchWithVfork(const LaunchOptions& options) {
+  // clone_flags asks for a clone() of its own. Valgrind runs a
+  // clone(CLONE_VM | CLONE_VFORK) as a fork() anyway.
+  if (options.clone_flags || RunningOnValgrind())
+    return false;
+  // The child can't set |environ| of the parent, so it execs with execvpe(),
+  // which searches the PATH of the parent rather than the one it is given.
+  if (options.environ) {
+    for (EnvironmentVector::const_iterator i = options.environ->begin();
+         i != options.environ->end(); ++i) {
+      if (i->first == "PATH")
+        return false;
+    }
+  }
+  return true;
+}
+
+// Resets the handler of every signal that has one to the default, as exec
+// would, so that no handler of the parent runs in its memory.
+void ResetCaughtSignalHandlersToDefaults() {
+  for (int sig = 1; sig < NSIG; ++sig) {
+    struct sigaction action;
+    if (sigaction(sig, NULL, &action) != 0 ||
+        action.sa_handler == SIG_DFL || action.sa_handler == SIG_IGN) {
+      continue;
+    }
+    action.sa_handler = SIG_DFL;
+    action.sa_flags = 0;
+    sigaction(sig, &action, NULL);
+  }
+}
+
+// The child of a clone(CLONE_VM | CLONE_VFORK). It runs on a stack of its own
+// but in the memory of the parent, whose thread waits until it execs or
+// exits; it must not write anything the parent still uses.
+int VforkChild(void* arg) {
+  const ChildLaunchState& state = *static_cast<ChildLaunchState*>(arg);
+
+  // The parent blocked all signals until their handlers are reset.
+  ResetCaughtSignalHandlersToDefaults();
+  sigprocmask(SIG_SETMASK, &state.old_signal_mask, NULL);
+
+  PrepareChild(state);
+
+  execvpe(state.argv[0], state.argv,
+          state.new_environ ? state.new_environ : GetEnvironment());
+
+  RAW_LOG(ERROR, "LaunchProcess: failed to execvp:");
+  RAW_LOG(ERROR, state.argv[0]);
+  _exit(127);
+  return 127;
+}
+
+// Starts the child of LaunchProcess() with vfork semantics. Returns its pid,
+// or -1 with errno set.
+pid_t LaunchVforkChild(ChildLaunchState* state, size_t argc) {
+  const size_t page_size = getpagesize();
+  const size_t stack_size =
+      (kVforkStackSize + (argc + 2) * sizeof(char*) + page_size - 1) &
+      ~(page_size - 1);
+  void* stack = mmap(NULL, stack_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (stack == MAP_FAILED)
+    return -1;
+
+  sigset_t all_signals;
+  sigfillset(&all_signals);
+  pthread_sigmask(SIG_SETMASK, &all_signals, &state->old_signal_mask);
+
+  // The stack grows down on all the architectures Linux Chrome runs on.
+  pid_t pid = clone(&VforkChild, static_cast<char*>(stack) + stack_size,
+                    CLONE_VM | CLONE_VFORK | SIGCHLD, state);
+  int clone_errno = errno;
+
+  pthread_sigmask(SIG_SETMASK, &state->old_signal_mask, NULL);
+  munmap(stack, stack_size);
+  errno = clone_errno;
+  return pid;
+}
+#endif  // defined(OS_LINUX)
+
+}  // namespace
+
 bool LaunchProcess(const std::vector<std::string>& argv,
                    const LaunchOptions& options,
                    ProcessHandle* process_handle) {
@@ -560,7 +815,20 @@ bool LaunchProcess(const std::vector<std::string>& argv,
   fd_shuffle1.reserve(fd_shuffle_size);
   fd_shuffle2.reserve(fd_shuffle_size);
 
+  if (options.fds_to_remap) {
+    for (FileHandleMappingVector::const_iterator
+             it = options.fds_to_remap->begin();
+         it != options.fds_to_remap->end(); ++it) {
+      fd_shuffle1.push_back(InjectionArc(it->first, it->second, false));
+      fd_shuffle2.push_back(InjectionArc(it->first, it->second, false));
+    }
+  }
+
   scoped_array<char*> argv_cstr(new char*[argv.size() + 1]);
+  for (size_t i = 0; i < argv.size(); i++)
+    argv_cstr[i] = const_cast<char*>(argv[i].c_str());
+  argv_cstr[argv.size()] = NULL;
+
   scoped_array<char*> new_environ;
   if (options.environ)
     new_environ.reset(AlterEnvironment(*options.environ, GetEnvironment()));
@@ -590,12 +858,27 @@ bool LaunchProcess(const std::vector<std::string>& argv,
     // the write side can be closed as soon as it has forked.
     synchronization_read_fd.reset(&synchronization_pipe_fds[0]);
     synchronization_write_fd.reset(&synchronization_pipe_fds[1]);
+
+    // Remap the read side of the synchronization pipe back onto itself,
+    // ensuring that it won't be closed by CloseSuperfluousFds.
+    int keep_fd = *synchronization_read_fd.get();
+    fd_shuffle1.push_back(InjectionArc(keep_fd, keep_fd, false));
+    fd_shuffle2.push_back(InjectionArc(keep_fd, keep_fd, false));
   }
 #endif  // OS_MACOSX
 
+  ChildLaunchState child_state;
+  child_state.options = &options;
+  child_state.argv = argv_cstr.get();
+  child_state.new_environ = new_environ.get();
+  child_state.fd_shuffle1 = &fd_shuffle1;
+  child_state.fd_shuffle2 = &fd_shuffle2;
+
   pid_t pid;
 #if defined(OS_LINUX)
-  if (options.clone_flags) {
+  if (CanLaunchWithVfork(options)) {
+    pid = LaunchVforkChild(&child_state, argv.size());
+  } else if (options.clone_flags) {
     pid = syscall(__NR_clone, options.clone_flags, 0, 0, 0);
   } else
 #endif
@@ -615,55 +898,6 @@ bool LaunchProcess(const std::vector<std::string>& argv,
     // might do things like block waiting for threads that don't even exist
     // in the child.
 
-    // If a child process uses the readline library, the process block forever.
-    // In BSD like OSes including OS X it is safe to assign /dev/null as stdin.
-    // See http://crbug.com/56596.
-    int null_fd = HANDLE_EINTR(open("/dev/null", O_RDONLY));
-    if (null_fd < 0) {
-      RAW_LOG(ERROR, "Failed to open /dev/null");
-      _exit(127);
-    }
-
-    file_util::ScopedFD null_fd_closer(&null_fd);
-    int new_fd = HANDLE_EINTR(dup2(null_fd, STDIN_FILENO));
-    if (new_fd != STDIN_FILENO) {
-      RAW_LOG(ERROR, "Failed to dup /dev/null for stdin");
-      _exit(127);
-    }
-
-    if (options.new_process_group) {
-      // Instead of inheriting the process group ID of the parent, the child
-      // starts off a new process group with pgid equal to its process ID.
-      if (setpgid(0, 0) < 0) {
-        RAW_LOG(ERROR, "setpgid failed");
-        _exit(127);
-      }
-    }
-
-    if (options.maximize_rlimits) {
-      // Some resource limits need to be maximal in this child.
-      std::set<int>::const_iterator resource;
-      for (resource = options.maximize_rlimits->begin();
-           resource != options.maximize_rlimits->end();
-           ++resource) {
-        struct rlimit limit;
-        if (getrlimit(*resource, &limit) < 0) {
-          RAW_LOG(WARNING, "getrlimit failed");
-        } else if (limit.rlim_cur < limit.rlim_max) {
-          limit.rlim_cur = limit.rlim_max;
-          if (setrlimit(*resource, &limit) < 0) {
-            RAW_LOG(WARNING, "setrlimit failed");
-          }
-        }
-      }
-    }
-
-#if defined(OS_MACOSX)
-    RestoreDefaultExceptionHandler();
-#endif  // defined(OS_MACOSX)
-
-    ResetChildSignalHandlersToDefaults();
-
 #if defined(OS_MACOSX)
     if (options.synchronize) {
       // The "write" side of the synchronization pipe belongs to the parent.
@@ -671,60 +905,11 @@ bool LaunchProcess(const std::vector<std::string>& argv,
     }
 #endif  // defined(OS_MACOSX)
 
-#if 0
-    // When debugging it can be helpful to check that we really aren't making
-    // any hidden calls to malloc.
-    void *malloc_thunk =
-        reinterpret_cast<void*>(reinterpret_cast<intptr_t>(malloc) & ~4095);
-    mprotect(malloc_thunk, 4096, PROT_READ | PROT_WRITE | PROT_EXEC);
-    memset(reinterpret_cast<void*>(malloc), 0xff, 8);
-#endif  // 0
-
-    // DANGER: no calls to malloc are allowed from now on:
-    // http://crbug.com/36678
-
-#if defined(OS_CHROMEOS)
-    if (options.ctrl_terminal_fd >= 0) {
-      // Set process' controlling terminal.
-      if (HANDLE_EINTR(setsid()) != -1) {
-        if (HANDLE_EINTR(
-                ioctl(options.ctrl_terminal_fd, TIOCSCTTY, NULL)) == -1) {
-          RAW_LOG(WARNING, "ioctl(TIOCSCTTY), ctrl terminal not set");
-        }
-      } else {
-        RAW_LOG(WARNING, "setsid failed, ctrl terminal not set");
-      }
-    }
-#endif  // defined(OS_CHROMEOS)
-
-    if (options.fds_to_remap) {
-      for (FileHandleMappingVector::const_iterator
-               it = options.fds_to_remap->begin();
-           it != options.fds_to_remap->end(); ++it) {
-        fd_shuffle1.push_back(InjectionArc(it->first, it->second, false));
-        fd_shuffle2.push_back(InjectionArc(it->first, it->second, false));
-      }
-    }
-
-#if defined(OS_MACOSX)
-    if (options.synchronize) {
-      // Remap the read side of the synchronization pipe back onto itself,
-      // ensuring that it won't be closed by CloseSuperfluousFds.
-      int keep_fd = *synchronization_read_fd.get();
-      fd_shuffle1.push_back(InjectionArc(keep_fd, keep_fd, false));
-      fd_shuffle2.push_back(InjectionArc(keep_fd, keep_fd, false));
-    }
-#endif  // defined(OS_MACOSX)
+    PrepareChild(child_state);
 
     if (options.environ)
       SetEnvironment(new_environ.get());
 
-    // fd_shuffle1 is mutated by this call because it cannot malloc.
-    if (!ShuffleFileDescriptors(&fd_shuffle1))
-      _exit(127);
-
-    CloseSuperfluousFds(fd_shuffle2);
-
 #if defined(OS_MACOSX)
     if (options.synchronize) {
       // Do a blocking read to wait until the parent says it's OK to proceed.
@@ -743,9 +928,6 @@ bool LaunchProcess(const std::vector<std::string>& argv,
     }
 #endif  // defined(OS_MACOSX)
 
-    for (size_t i = 0; i < argv.size(); i++)
-      argv_cstr[i] = const_cast<char*>(argv[i].c_str());
-    argv_cstr[argv.size()] = NULL;
     execvp(argv_cstr[0], argv_cstr.get());
 
     RAW_LOG(ERROR, "LaunchProcess: failed to execvp:");
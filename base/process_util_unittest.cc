@@ -702,6 +702,25 @@ TEST_F(ProcessUtilTest, LaunchProcess) {
 #endif
 }
 
+TEST_F(ProcessUtilTest, LaunchProcessSearchesPathOfEnviron) {
+  // The shell is found through the PATH of the child, which has no shell.
+  base::EnvironmentVector env_changes;
+  env_changes.push_back(std::make_pair(std::string("PATH"),
+                                       std::string("/nonexistent")));
+  std::vector<std::string> args;
+  args.push_back("sh");
+  args.push_back("-c");
+  args.push_back("exit 0");
+
+  base::LaunchOptions options;
+  options.environ = &env_changes;
+  base::ProcessHandle handle;
+  ASSERT_TRUE(base::LaunchProcess(args, options, &handle));
+  int exit_code = 0;
+  EXPECT_TRUE(base::WaitForExitCode(handle, &exit_code));
+  EXPECT_EQ(127, exit_code);
+}
+
 TEST_F(ProcessUtilTest, AlterEnvironment) {
   const char* const empty[] = { NULL };
   const char* const a2[] = { "A=2", NULL };
@@ -914,6 +933,61 @@ TEST_F(ProcessUtilTest, ParseProcStatCPU) {
 
   EXPECT_EQ(0, base::ParseProcStatCPU(kSelfStat));
 }
+
+TEST_F(ProcessUtilTest, ProcessMetricsSampler) {
+  base::ProcessHandle child = SpawnChild("process_util_test_never_die", false);
+  ASSERT_NE(base::kNullProcessHandle, child);
+
+  std::vector<base::ProcessId> pids;
+  pids.push_back(base::GetCurrentProcId());
+  pids.push_back(child);
+  base::ProcessMetricsSampler sampler;
+  std::vector<base::ProcessMetricsSnapshot> snapshots;
+  sampler.Sample(pids, &snapshots);
+  ASSERT_EQ(2u, snapshots.size());
+  for (size_t i = 0; i < snapshots.size(); ++i) {
+    EXPECT_EQ(pids[i], snapshots[i].pid);
+    EXPECT_TRUE(snapshots[i].valid);
+    EXPECT_GT(snapshots[i].virtual_bytes, snapshots[i].resident_bytes);
+    EXPECT_GT(snapshots[i].resident_bytes, 0u);
+    EXPECT_LE(snapshots[i].private_bytes, snapshots[i].resident_bytes);
+    EXPECT_EQ(0, snapshots[i].cpu_usage);
+  }
+
+  // The figures agree with the ones ProcessMetrics reads.
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(child));
+  EXPECT_EQ(metrics->GetPagefileUsage(), snapshots[1].virtual_bytes);
+  if (!snapshots[1].proportional_bytes) {
+    EXPECT_EQ(metrics->GetWorkingSetSize(), snapshots[1].resident_bytes);
+  }
+
+  // Burn some CPU so that there is usage to see the second time.
+  base::TimeTicks start = base::TimeTicks::Now();
+  while (base::TimeTicks::Now() - start <
+         base::TimeDelta::FromMilliseconds(100)) {
+  }
+  sampler.Sample(pids, &snapshots);
+  ASSERT_EQ(2u, snapshots.size());
+  EXPECT_TRUE(snapshots[0].valid);
+  EXPECT_GT(snapshots[0].cpu_ticks, 0u);
+  EXPECT_GT(snapshots[0].cpu_usage, 0);
+
+  // A process that exited is not valid, and neither is one that never was.
+  EXPECT_TRUE(base::KillProcess(child, 0, true));
+  base::CloseProcessHandle(child);
+  sampler.Sample(pids, &snapshots);
+  EXPECT_TRUE(snapshots[0].valid);
+  EXPECT_EQ(child, snapshots[1].pid);
+  EXPECT_FALSE(snapshots[1].valid);
+  EXPECT_EQ(0u, snapshots[1].resident_bytes);
+
+  pids.clear();
+  pids.push_back(child);
+  sampler.Sample(pids, &snapshots);
+  ASSERT_EQ(1u, snapshots.size());
+  EXPECT_FALSE(snapshots[0].valid);
+}
 #endif  // defined(OS_LINUX) || defined(OS_ANDROID)
 
 // TODO(port): port those unit tests.
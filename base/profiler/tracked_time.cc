@@ -8,6 +8,8 @@
 
 #if defined(OS_WIN)
 #include <mmsystem.h>  // Declare timeGetTime()... after including build_config.
+#elif defined(OS_LINUX)
+#include <time.h>
 #endif
 
 namespace tracked_objects {
@@ -58,11 +60,30 @@ TrackedTime TrackedTime::Now() {
   // TODO(jar): Surface this interface via something in base/time.h.
   return TrackedTime(static_cast<int32>(timeGetTime()));
 #else
-  // Posix has nice cheap 64 bit times, so we just down-convert it.
-  return TrackedTime(base::TimeTicks::Now());
+  // NowFast() reads the time stamp counter where it can, so we just
+  // down-convert it.
+  return TrackedTime(base::TimeTicks::NowFast());
 #endif  // OS_WIN
 }
 
+// static
+TrackedTime TrackedTime::CoarseNow() {
+#if defined(OS_LINUX) && defined(CLOCK_MONOTONIC_COARSE)
+  // The coarse clock is read from the vDSO without touching the TSC, and it
+  // shares its epoch with the CLOCK_MONOTONIC that TimeTicks::Now() uses.
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC_COARSE, &ts) == 0) {
+    int64 ms = static_cast<int64>(ts.tv_sec) *
+        base::Time::kMillisecondsPerSecond +
+        ts.tv_nsec / (base::Time::kNanosecondsPerMicrosecond *
+                      base::Time::kMicrosecondsPerMillisecond);
+    return TrackedTime(static_cast<int32>(ms));
+  }
+#endif
+  // timeGetTime() is already cheap on Windows.
+  return Now();
+}
+
 Duration TrackedTime::operator-(const TrackedTime& other) const {
   return Duration(ms_ - other.ms_);
 }
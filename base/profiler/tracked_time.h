@@ -52,6 +52,10 @@ class BASE_EXPORT TrackedTime {  // Similar to base::TimeTicks.
   explicit TrackedTime(const base::TimeTicks& time);
 
   static TrackedTime Now();
+  // Like Now(), but may lag behind it by up to a scheduler tick (a few
+  // milliseconds).  Where the platform has such a clock, reading it costs a
+  // fraction of Now(); elsewhere this is Now().
+  static TrackedTime CoarseNow();
   Duration operator-(const TrackedTime& other) const;
   TrackedTime operator+(const Duration& other) const;
   bool is_null() const;
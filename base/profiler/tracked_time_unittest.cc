@@ -67,6 +67,19 @@ TEST(TrackedTimeTest, TrackedTimerVsTimeTicks) {
   EXPECT_GE(0, after.InMilliseconds());
 }
 
+TEST(TrackedTimeTest, CoarseTimerVsTimeTicks) {
+  // The coarse timer may lag behind TimeTicks, but only by a scheduler tick.
+  const int kMaxLagMilliseconds = 50;
+  base::TimeTicks ticks_before = base::TimeTicks::Now();
+  TrackedTime now = TrackedTime::CoarseNow();
+  base::TimeTicks ticks_after = base::TimeTicks::Now();
+
+  Duration before = now - TrackedTime(ticks_before);
+  EXPECT_LE(-kMaxLagMilliseconds, before.InMilliseconds());
+  Duration after = now - TrackedTime(ticks_after);
+  EXPECT_GE(0, after.InMilliseconds());
+}
+
 TEST(TrackedTimeTest, TrackedTimerDisabled) {
   // Check to be sure disabling the collection of data induces a null time
   // (which we know will return much faster).
@@ -14,6 +14,15 @@ bool SequencedTaskRunner::PostNonNestableTask(
   return PostNonNestableDelayedTask(from_here, task, 0);
 }
 
+bool SequencedTaskRunner::PostNonNestableTasks(
+    const tracked_objects::Location& from_here,
+    const std::vector<Closure>& tasks) {
+  bool all_posted = true;
+  for (size_t i = 0; i < tasks.size(); ++i)
+    all_posted &= PostNonNestableTask(from_here, tasks[i]);
+  return all_posted;
+}
+
 bool SequencedTaskRunner::DeleteSoonInternal(
     const tracked_objects::Location& from_here,
     void(*deleter)(const void*),
@@ -121,6 +121,13 @@ class BASE_EXPORT SequencedTaskRunner : public TaskRunner {
       const Closure& task,
       base::TimeDelta delay) = 0;
 
+  // The non-nestable counterpart of TaskRunner::PostTasks(): posts
+  // each of |tasks| as if by PostNonNestableTask(), in order.  The
+  // default implementation calls PostNonNestableTask() for each task.
+  virtual bool PostNonNestableTasks(
+      const tracked_objects::Location& from_here,
+      const std::vector<Closure>& tasks);
+
   // Submits a non-nestable task to delete the given object.  Returns
   // true if the object may be deleted at some point in the future,
   // and false if the object definitely will not be deleted.
@@ -25,6 +25,25 @@ BASE_EXPORT std::string SHA1HashString(const std::string& str);
 BASE_EXPORT void SHA1HashBytes(const unsigned char* data, size_t len,
                                unsigned char* hash);
 
+// Computes the SHA-1 hashes of |count| inputs, the |i|th being the
+// |lengths[i]| bytes at |data[i]|, and puts them one after another in
+// |hashes|, which must be |count| * kSHA1Length bytes long.  Where the
+// processor allows, several inputs are hashed side by side, which is much
+// faster than calling SHA1HashBytes() on each of many small inputs.
+BASE_EXPORT void SHA1HashBytesMany(const unsigned char* const* data,
+                                   const size_t* lengths,
+                                   size_t count,
+                                   unsigned char* hashes);
+
+namespace internal {
+
+// SHA1HashBytes() using only the portable code, whatever the processor
+// offers.  For tests and benchmarks.
+BASE_EXPORT void SHA1HashBytesPortable(const unsigned char* data, size_t len,
+                                       unsigned char* hash);
+
+}  // namespace internal
+
 }  // namespace base
 
 #endif  // BASE_SHA1_H_
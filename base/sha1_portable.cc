@@ -6,7 +6,16 @@
 
 #include <string.h>
 
+#include <algorithm>
+
 #include "base/basictypes.h"
+#include "base/lazy_instance.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+#include "base/cpu.h"
+#include "base/digest_x86.h"
+#endif
 
 namespace base {
 
@@ -19,7 +28,7 @@ namespace base {
 
 // Usage example:
 //
-// SecureHashAlgorithm sha;
+// SecureHashAlgorithm sha(&SecureHashAlgorithm::Transform);
 // while(there is data to hash)
 //   sha.Update(moredata, size of data);
 // sha.Final();
@@ -33,7 +42,14 @@ namespace base {
 
 class SecureHashAlgorithm {
  public:
-  SecureHashAlgorithm() { Init(); }
+  // Runs the compression function over |count| 64-byte blocks.
+  typedef void (*TransformFunction)(uint32 H[5], const uint8* blocks,
+                                    size_t count);
+
+  explicit SecureHashAlgorithm(TransformFunction transform)
+      : transform_(transform) {
+    Init();
+  }
 
   static const int kDigestSizeBytes;
 
@@ -46,21 +62,21 @@ class SecureHashAlgorithm {
     return reinterpret_cast<const unsigned char*>(H);
   }
 
+  // The portable compression function.
+  static void Transform(uint32 H[5], const uint8* blocks, size_t count);
+
  private:
   void Pad();
   void Process();
 
-  uint32 A, B, C, D, E;
+  TransformFunction transform_;
 
   uint32 H[5];
 
-  union {
-    uint32 W[80];
-    uint8 M[64];
-  };
+  uint8 M[64];
 
   uint32 cursor;
-  uint32 l;
+  uint64 l;
 };
 
 static inline uint32 f(uint32 t, uint32 B, uint32 C, uint32 D) {
@@ -101,11 +117,6 @@ static inline void swapends(uint32* t) {
 const int SecureHashAlgorithm::kDigestSizeBytes = 20;
 
 void SecureHashAlgorithm::Init() {
-  A = 0;
-  B = 0;
-  C = 0;
-  D = 0;
-  E = 0;
   cursor = 0;
   l = 0;
   H[0] = 0x67452301;
@@ -125,11 +136,23 @@ void SecureHashAlgorithm::Final() {
 
 void SecureHashAlgorithm::Update(const void* data, size_t nbytes) {
   const uint8* d = reinterpret_cast<const uint8*>(data);
-  while (nbytes--) {
-    M[cursor++] = *d++;
+  l += static_cast<uint64>(nbytes) * 8;
+  while (nbytes) {
+    // Whole blocks go straight from |data| when nothing is buffered.
+    if (cursor == 0 && nbytes >= 64) {
+      size_t blocks = nbytes / 64;
+      transform_(H, d, blocks);
+      d += blocks * 64;
+      nbytes -= blocks * 64;
+      continue;
+    }
+    size_t n = std::min(nbytes, static_cast<size_t>(64 - cursor));
+    memcpy(M + cursor, d, n);
+    cursor += n;
+    d += n;
+    nbytes -= n;
     if (cursor >= 64)
       Process();
-    l += 8;
   }
 }
 
@@ -144,58 +167,100 @@ void SecureHashAlgorithm::Pad() {
     Process();
   }
 
-  while (cursor < 64-4)
+  while (cursor < 64-8)
     M[cursor++] = 0;
 
-  M[64-4] = (l & 0xff000000) >> 24;
-  M[64-3] = (l & 0xff0000) >> 16;
-  M[64-2] = (l & 0xff00) >> 8;
-  M[64-1] = (l & 0xff);
+  for (int i = 0; i < 8; ++i)
+    M[64-8+i] = static_cast<uint8>(l >> (56 - 8 * i));
 }
 
 void SecureHashAlgorithm::Process() {
-  uint32 t;
-
-  // Each a...e corresponds to a section in the FIPS 180-3 algorithm.
-
-  // a.
-  //
-  // W and M are in a union, so no need to memcpy.
-  // memcpy(W, M, sizeof(M));
-  for (t = 0; t < 16; ++t)
-    swapends(&W[t]);
-
-  // b.
-  for (t = 16; t < 80; ++t)
-    W[t] = S(1, W[t - 3] ^ W[t - 8] ^ W[t - 14] ^ W[t - 16]);
-
-  // c.
-  A = H[0];
-  B = H[1];
-  C = H[2];
-  D = H[3];
-  E = H[4];
-
-  // d.
-  for (t = 0; t < 80; ++t) {
-    uint32 TEMP = S(5, A) + f(t, B, C, D) + E + W[t] + K(t);
-    E = D;
-    D = C;
-    C = S(30, B);
-    B = A;
-    A = TEMP;
+  transform_(H, M, 1);
+  cursor = 0;
+}
+
+// static
+void SecureHashAlgorithm::Transform(uint32 H[5], const uint8* blocks,
+                                    size_t count) {
+  for (; count; --count, blocks += 64) {
+    uint32 t;
+    uint32 W[80];
+
+    // Each a...e corresponds to a section in the FIPS 180-3 algorithm.
+
+    // a.
+    memcpy(W, blocks, 64);
+    for (t = 0; t < 16; ++t)
+      swapends(&W[t]);
+
+    // b.
+    for (t = 16; t < 80; ++t)
+      W[t] = S(1, W[t - 3] ^ W[t - 8] ^ W[t - 14] ^ W[t - 16]);
+
+    // c.
+    uint32 A = H[0];
+    uint32 B = H[1];
+    uint32 C = H[2];
+    uint32 D = H[3];
+    uint32 E = H[4];
+
+    // d.
+    for (t = 0; t < 80; ++t) {
+      uint32 TEMP = S(5, A) + f(t, B, C, D) + E + W[t] + K(t);
+      E = D;
+      D = C;
+      C = S(30, B);
+      B = A;
+      A = TEMP;
+    }
+
+    // e.
+    H[0] += A;
+    H[1] += B;
+    H[2] += C;
+    H[3] += D;
+    H[4] += E;
+  }
+}
+
+namespace {
+
+// The fastest implementations this processor can run, chosen once.
+struct SHA1Functions {
+  SHA1Functions()
+      : transform(&SecureHashAlgorithm::Transform),
+        hash_many(NULL) {
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+    CPU cpu;
+    if (cpu.has_sha() && cpu.has_sse41())
+      transform = &internal::SHA1TransformSHA;
+    // Eight lanes of AVX2 keep up with the SHA extensions hashing small
+    // inputs one at a time, and are far ahead of the portable code.
+    if (cpu.has_avx2())
+      hash_many = &internal::SHA1HashBytesManyAVX2;
+#endif
   }
 
-  // e.
-  H[0] += A;
-  H[1] += B;
-  H[2] += C;
-  H[3] += D;
-  H[4] += E;
+  SecureHashAlgorithm::TransformFunction transform;
+  void (*hash_many)(const unsigned char* const* data, const size_t* lengths,
+                    size_t count, unsigned char* hashes);
+};
 
-  cursor = 0;
+LazyInstance<SHA1Functions>::Leaky g_sha1_functions =
+    LAZY_INSTANCE_INITIALIZER;
+
+void HashBytesWith(SecureHashAlgorithm::TransformFunction transform,
+                   const unsigned char* data, size_t len,
+                   unsigned char* hash) {
+  SecureHashAlgorithm sha(transform);
+  sha.Update(data, len);
+  sha.Final();
+
+  memcpy(hash, sha.Digest(), SecureHashAlgorithm::kDigestSizeBytes);
 }
 
+}  // namespace
+
 std::string SHA1HashString(const std::string& str) {
   char hash[SecureHashAlgorithm::kDigestSizeBytes];
   SHA1HashBytes(reinterpret_cast<const unsigned char*>(str.c_str()),
@@ -205,11 +270,30 @@ std::string SHA1HashString(const std::string& str) {
 
 void SHA1HashBytes(const unsigned char* data, size_t len,
                    unsigned char* hash) {
-  SecureHashAlgorithm sha;
-  sha.Update(data, len);
-  sha.Final();
+  HashBytesWith(g_sha1_functions.Get().transform, data, len, hash);
+}
 
-  memcpy(hash, sha.Digest(), SecureHashAlgorithm::kDigestSizeBytes);
+void SHA1HashBytesMany(const unsigned char* const* data,
+                       const size_t* lengths,
+                       size_t count,
+                       unsigned char* hashes) {
+  const SHA1Functions& functions = g_sha1_functions.Get();
+  if (functions.hash_many) {
+    functions.hash_many(data, lengths, count, hashes);
+    return;
+  }
+  for (size_t i = 0; i < count; ++i)
+    HashBytesWith(functions.transform, data[i], lengths[i],
+                  hashes + i * kSHA1Length);
 }
 
+namespace internal {
+
+void SHA1HashBytesPortable(const unsigned char* data, size_t len,
+                           unsigned char* hash) {
+  HashBytesWith(&SecureHashAlgorithm::Transform, data, len, hash);
+}
+
+}  // namespace internal
+
 }  // namespace base
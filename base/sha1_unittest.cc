@@ -4,11 +4,20 @@
 
 #include "base/sha1.h"
 
+#include <string.h>
+
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
+#include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+#if defined(ARCH_CPU_X86_FAMILY)
+#include "base/cpu.h"
+#include "base/digest_x86.h"
+#endif
+
 TEST(SHA1Test, Test1) {
   // Example A.1 from FIPS 180-2: one-block message.
   std::string input = "abc";
@@ -106,3 +115,61 @@ TEST(SHA1Test, Test3Bytes) {
   for (size_t i = 0; i < base::kSHA1Length; i++)
     EXPECT_EQ(expected[i], output[i]);
 }
+
+TEST(SHA1Test, Portable) {
+  // Whatever SHA1HashBytes picks agrees with the portable code.
+  std::string input;
+  for (int i = 0; i < 300; ++i) {
+    unsigned char expected[base::kSHA1Length];
+    unsigned char output[base::kSHA1Length];
+    base::internal::SHA1HashBytesPortable(
+        reinterpret_cast<const unsigned char*>(input.data()), input.length(),
+        expected);
+    base::SHA1HashBytes(reinterpret_cast<const unsigned char*>(input.data()),
+                        input.length(), output);
+    EXPECT_EQ(0, memcmp(expected, output, base::kSHA1Length)) << i;
+    input.push_back(static_cast<char>(i * 7));
+  }
+}
+
+namespace {
+
+// Hashes inputs of every length from 0 to 299 bytes, and a long one, with
+// |hash_many| and checks them against the portable code.
+void CheckHashMany(void (*hash_many)(const unsigned char* const*,
+                                     const size_t*, size_t,
+                                     unsigned char*)) {
+  std::vector<std::string> inputs;
+  for (int i = 0; i < 300; ++i)
+    inputs.push_back(std::string(i, static_cast<char>('a' + i % 26)));
+  inputs.push_back(std::string(100000, 'z'));
+
+  std::vector<const unsigned char*> data;
+  std::vector<size_t> lengths;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    data.push_back(reinterpret_cast<const unsigned char*>(inputs[i].data()));
+    lengths.push_back(inputs[i].length());
+  }
+  // Shrinking counts exercise lanes left idle at the end.
+  for (size_t count = inputs.size(); count > 0; count /= 3) {
+    std::vector<unsigned char> hashes(count * base::kSHA1Length);
+    hash_many(&data[0], &lengths[0], count, &hashes[0]);
+    for (size_t i = 0; i < count; ++i) {
+      unsigned char expected[base::kSHA1Length];
+      base::internal::SHA1HashBytesPortable(data[i], lengths[i], expected);
+      EXPECT_EQ(0, memcmp(expected, &hashes[i * base::kSHA1Length],
+                          base::kSHA1Length)) << count << " " << i;
+    }
+  }
+  hash_many(NULL, NULL, 0, NULL);
+}
+
+}  // namespace
+
+TEST(SHA1Test, HashBytesMany) {
+  CheckHashMany(&base::SHA1HashBytesMany);
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (base::CPU().has_avx2())
+    CheckHashMany(&base::internal::SHA1HashBytesManyAVX2);
+#endif
+}
@@ -46,7 +46,8 @@ typedef ino_t SharedMemoryId;
 // Options for creating a shared memory object.
 struct SharedMemoryCreateOptions {
   SharedMemoryCreateOptions() : name(NULL), size(0), open_existing(false),
-                                executable(false) {}
+                                executable(false), huge_pages(false),
+                                prefault(false), numa_local(false) {}
 
   // If NULL, the object is anonymous.  This pointer is owned by the caller
   // and must live through the call to Create().
@@ -64,6 +65,21 @@ struct SharedMemoryCreateOptions {
 
   // If true, mappings might need to be made executable later.
   bool executable;
+
+  // Hints for large buffers, which otherwise fault in a small page at a
+  // time.  They apply to the mappings the creating SharedMemory makes (other
+  // processes mapping the memory choose for themselves), only on Linux for
+  // now, and are quietly dropped where the kernel can't honor them.
+
+  // Back the mappings with transparent huge pages.
+  bool huge_pages;
+
+  // Fault every page in when mapping rather than on first touch.
+  bool prefault;
+
+  // Place the pages on the NUMA node of the thread that maps (with prefault)
+  // or first touches them, whatever the process's memory policy.
+  bool numa_local;
 };
 
 // Platform abstraction for shared memory.  Provides a C++ wrapper
@@ -165,6 +181,10 @@ class BASE_EXPORT SharedMemory {
   // Mapped via Map().  Returns NULL if it is not mapped.
   void *memory() const { return memory_; }
 
+  // The number of bytes mapped by Map(), or 0 if it is not mapped.  Unlike
+  // created_size(), this is known in every process that maps the segment.
+  uint32 mapped_size() const { return mapped_size_; }
+
   // Returns the underlying OS handle for this segment.
   // Use of this handle for anything other than an opaque
   // identifier is not portable.
@@ -236,6 +256,7 @@ class BASE_EXPORT SharedMemory {
 #if defined(OS_WIN)
   std::wstring       name_;
   HANDLE             mapped_file_;
+  uint32             mapped_size_;
 #elif defined(OS_POSIX)
   int                mapped_file_;
   uint32             mapped_size_;
@@ -247,6 +268,9 @@ class BASE_EXPORT SharedMemory {
 #if !defined(OS_POSIX)
   SharedMemoryLock   lock_;
 #endif
+  bool               huge_pages_;
+  bool               prefault_;
+  bool               numa_local_;
 
   DISALLOW_COPY_AND_ASSIGN(SharedMemory);
 };
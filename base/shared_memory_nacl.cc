@@ -20,7 +20,10 @@ SharedMemory::SharedMemory()
       inode_(0),
       memory_(NULL),
       read_only_(false),
-      created_size_(0) {
+      created_size_(0),
+      huge_pages_(false),
+      prefault_(false),
+      numa_local_(false) {
   NOTREACHED();
 }
 
@@ -30,7 +33,10 @@ SharedMemory::SharedMemory(SharedMemoryHandle handle, bool read_only)
       inode_(0),
       memory_(NULL),
       read_only_(read_only),
-      created_size_(0) {
+      created_size_(0),
+      huge_pages_(false),
+      prefault_(false),
+      numa_local_(false) {
   NOTREACHED();
 }
 
@@ -41,7 +47,10 @@ SharedMemory::SharedMemory(SharedMemoryHandle handle, bool read_only,
       inode_(0),
       memory_(NULL),
       read_only_(read_only),
-      created_size_(0) {
+      created_size_(0),
+      huge_pages_(false),
+      prefault_(false),
+      numa_local_(false) {
   NOTREACHED();
 }
 
@@ -10,6 +10,10 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#if defined(OS_LINUX)
+#include <sys/syscall.h>
+#endif
+
 #include "base/file_util.h"
 #include "base/lazy_instance.h"
 #include "base/logging.h"
@@ -38,6 +42,37 @@ const char kSemaphoreSuffix[] = "-sem";
 
 LazyInstance<Lock>::Leaky g_thread_lock_ = LAZY_INSTANCE_INITIALIZER;
 
+#if defined(OS_LINUX)
+// From <linux/memfd.h> and <numaif.h>, which older headers lack.
+const unsigned int kMemfdCloexec = 0x0001;
+const int kMpolPreferred = 1;
+
+// Returns an anonymous file that lives in memory, created without going
+// through any file system, or NULL if the kernel is too old to make one.
+FILE* CreateMemfdFile() {
+#if defined(__NR_memfd_create)
+  int fd = syscall(__NR_memfd_create, "chromium_shmem", kMemfdCloexec);
+  if (fd < 0)
+    return NULL;
+  FILE* fp = fdopen(fd, "w+");
+  if (!fp)
+    ignore_result(HANDLE_EINTR(close(fd)));
+  return fp;
+#else
+  return NULL;
+#endif
+}
+
+// Reads a byte of every page of the |length| bytes at |memory|, which
+// faults them all in, following whatever policy the mapping has by then.
+void TouchPages(const void* memory, size_t length) {
+  const volatile char* bytes = static_cast<const volatile char*>(memory);
+  const size_t page_size = getpagesize();
+  for (size_t offset = 0; offset < length; offset += page_size)
+    bytes[offset];
+}
+#endif  // defined(OS_LINUX)
+
 }
 
 SharedMemory::SharedMemory()
@@ -46,7 +81,10 @@ SharedMemory::SharedMemory()
       inode_(0),
       memory_(NULL),
       read_only_(false),
-      created_size_(0) {
+      created_size_(0),
+      huge_pages_(false),
+      prefault_(false),
+      numa_local_(false) {
 }
 
 SharedMemory::SharedMemory(SharedMemoryHandle handle, bool read_only)
@@ -55,7 +93,10 @@ SharedMemory::SharedMemory(SharedMemoryHandle handle, bool read_only)
       inode_(0),
       memory_(NULL),
       read_only_(read_only),
-      created_size_(0) {
+      created_size_(0),
+      huge_pages_(false),
+      prefault_(false),
+      numa_local_(false) {
   struct stat st;
   if (fstat(handle.fd, &st) == 0) {
     // If fstat fails, then the file descriptor is invalid and we'll learn this
@@ -71,7 +112,10 @@ SharedMemory::SharedMemory(SharedMemoryHandle handle, bool read_only,
       inode_(0),
       memory_(NULL),
       read_only_(read_only),
-      created_size_(0) {
+      created_size_(0),
+      huge_pages_(false),
+      prefault_(false),
+      numa_local_(false) {
   // We don't handle this case yet (note the ignored parameter); let's die if
   // someone comes calling.
   NOTREACHED();
@@ -125,15 +169,24 @@ bool SharedMemory::Create(const SharedMemoryCreateOptions& options) {
   if (options.name == NULL || options.name->empty()) {
     // It doesn't make sense to have a open-existing private piece of shmem
     DCHECK(!options.open_existing);
-    // Q: Why not use the shm_open() etc. APIs?
-    // A: Because they're limited to 4mb on OS X.  FFFFFFFUUUUUUUUUUU
-    fp = file_util::CreateAndOpenTemporaryShmemFile(&path, options.executable);
-
-    // Deleting the file prevents anyone else from mapping it in
-    // (making it private), and prevents the need for cleanup (once
-    // the last fd is closed, it is truly freed).
-    if (fp)
-      file_util::Delete(path, false);
+    fp = NULL;
+#if defined(OS_LINUX)
+    // A memfd is private from the start and needs no file created and
+    // deleted in /dev/shm.
+    fp = CreateMemfdFile();
+#endif
+    if (!fp) {
+      // Q: Why not use the shm_open() etc. APIs?
+      // A: Because they're limited to 4mb on OS X.  FFFFFFFUUUUUUUUUUU
+      fp = file_util::CreateAndOpenTemporaryShmemFile(&path,
+                                                      options.executable);
+
+      // Deleting the file prevents anyone else from mapping it in
+      // (making it private), and prevents the need for cleanup (once
+      // the last fd is closed, it is truly freed).
+      if (fp)
+        file_util::Delete(path, false);
+    }
 
   } else {
     if (!FilePathForMemoryName(*options.name, &path))
@@ -183,6 +236,9 @@ bool SharedMemory::Create(const SharedMemoryCreateOptions& options) {
     return false;
   }
 
+  huge_pages_ = options.huge_pages;
+  prefault_ = options.prefault;
+  numa_local_ = options.numa_local;
   return PrepareMapFile(fp);
 }
 
@@ -236,8 +292,17 @@ bool SharedMemory::Map(uint32 bytes) {
   }
 #endif
 
+  int flags = MAP_SHARED;
+#if defined(OS_LINUX)
+  // The placement hints have to be in force before the pages are faulted
+  // in; without them the kernel can fault the pages in as it maps them.
+  const bool has_placement_hints = huge_pages_ || numa_local_;
+  if (prefault_ && !has_placement_hints)
+    flags |= MAP_POPULATE;
+#endif
+
   memory_ = mmap(NULL, bytes, PROT_READ | (read_only_ ? 0 : PROT_WRITE),
-                 MAP_SHARED, mapped_file_, 0);
+                 flags, mapped_file_, 0);
 
   bool mmap_succeeded = memory_ != (void*)-1 && memory_ != NULL;
   if (mmap_succeeded)
@@ -245,6 +310,24 @@ bool SharedMemory::Map(uint32 bytes) {
   else
     memory_ = NULL;
 
+#if defined(OS_LINUX)
+  if (mmap_succeeded && has_placement_hints) {
+    // These are hints: a kernel without huge pages for shared memory, or
+    // without NUMA, refuses them and the mapping works as it would have.
+#if defined(MADV_HUGEPAGE)
+    if (huge_pages_)
+      madvise(memory_, bytes, MADV_HUGEPAGE);
+#endif
+#if defined(__NR_mbind)
+    // A preferred node of none means the node of the allocating thread.
+    if (numa_local_)
+      syscall(__NR_mbind, memory_, bytes, kMpolPreferred, NULL, 0, 0);
+#endif
+    if (prefault_)
+      TouchPages(memory_, bytes);
+  }
+#endif
+
   return mmap_succeeded;
 }
 
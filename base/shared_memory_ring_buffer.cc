@@ -0,0 +1,216 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/shared_memory_ring_buffer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/shared_memory.h"
+#include "base/sync_socket.h"
+
+namespace base {
+
+using subtle::Atomic32;
+
+namespace {
+
+const size_t kCacheLineSize = 64;
+
+// Rings are at most this big, so that positions can wrap around uint32.
+const size_t kMaxCapacity = 1 << 30;
+
+bool IsPowerOfTwo(size_t value) {
+  return value && (value & (value - 1)) == 0;
+}
+
+}  // namespace
+
+// The start of the shared memory.  The positions count every byte ever
+// written and read, wrapping around, so the ring is empty when they are equal
+// and full when they are |capacity| apart.  Each end writes only its own
+// cache line, so the two do not fight over one.
+struct SharedMemoryRingBuffer::Header {
+  // Written by the writing end.
+  volatile Atomic32 write_position;
+  volatile Atomic32 writer_waiting;
+  char writer_padding[kCacheLineSize - 2 * sizeof(Atomic32)];
+
+  // Written by the reading end.
+  volatile Atomic32 read_position;
+  volatile Atomic32 reader_waiting;
+  char reader_padding[kCacheLineSize - 2 * sizeof(Atomic32)];
+
+  // Fixed by InitializeMemory().
+  uint32 capacity;
+  char capacity_padding[kCacheLineSize - sizeof(uint32)];
+};
+
+SharedMemoryRingBuffer::SharedMemoryRingBuffer(SharedMemory* memory,
+                                               SyncSocket* socket)
+    : header_(static_cast<Header*>(memory->memory())),
+      data_(static_cast<char*>(memory->memory()) + sizeof(Header)),
+      capacity_(0),
+      socket_(socket) {
+  DCHECK(header_);
+  uint32 capacity = header_->capacity;
+  if (memory->mapped_size() >= sizeof(Header) &&
+      IsPowerOfTwo(capacity) && capacity <= kMaxCapacity &&
+      RequiredSize(capacity) <= memory->mapped_size()) {
+    capacity_ = capacity;
+  }
+}
+
+SharedMemoryRingBuffer::~SharedMemoryRingBuffer() {
+}
+
+// static
+size_t SharedMemoryRingBuffer::RequiredSize(size_t capacity) {
+  return sizeof(Header) + capacity;
+}
+
+// static
+bool SharedMemoryRingBuffer::InitializeMemory(SharedMemory* memory,
+                                              size_t capacity) {
+  if (!memory->memory() || !IsPowerOfTwo(capacity) ||
+      capacity > kMaxCapacity ||
+      memory->mapped_size() < RequiredSize(capacity)) {
+    return false;
+  }
+  Header* header = static_cast<Header*>(memory->memory());
+  memset(header, 0, sizeof(*header));
+  header->capacity = static_cast<uint32>(capacity);
+  return true;
+}
+
+size_t SharedMemoryRingBuffer::Write(const void* data, size_t length) {
+  uint32 used = Used();
+  if (used > capacity_)
+    return 0;
+
+  uint32 write_position = subtle::NoBarrier_Load(&header_->write_position);
+  size_t written = std::min(length, static_cast<size_t>(capacity_ - used));
+  if (!written)
+    return 0;
+  size_t offset = write_position & (capacity_ - 1);
+  size_t first = std::min(written, capacity_ - offset);
+  memcpy(data_ + offset, data, first);
+  memcpy(data_, static_cast<const char*>(data) + first, written - first);
+
+  // The bytes must be in place before the reader can see the new position.
+  subtle::Release_Store(&header_->write_position,
+                        write_position + static_cast<uint32>(written));
+  Wake(&header_->reader_waiting);
+  return written;
+}
+
+size_t SharedMemoryRingBuffer::Send(const void* data, size_t length) {
+  const char* bytes = static_cast<const char*>(data);
+  size_t sent = 0;
+  while (sent < length) {
+    sent += Write(bytes + sent, length - sent);
+    if (sent < length &&
+        !Wait(&header_->writer_waiting, &SharedMemoryRingBuffer::HasRoom)) {
+      break;
+    }
+  }
+  return sent;
+}
+
+size_t SharedMemoryRingBuffer::Read(void* buffer, size_t length) {
+  uint32 used = Used();
+  if (used > capacity_)
+    return 0;
+
+  uint32 read_position = subtle::NoBarrier_Load(&header_->read_position);
+  size_t read = std::min(length, static_cast<size_t>(used));
+  if (!read)
+    return 0;
+  size_t offset = read_position & (capacity_ - 1);
+  size_t first = std::min(read, capacity_ - offset);
+  memcpy(buffer, data_ + offset, first);
+  memcpy(static_cast<char*>(buffer) + first, data_, read - first);
+
+  // The bytes must be copied out before the writer can reuse their space.
+  subtle::Release_Store(&header_->read_position,
+                        read_position + static_cast<uint32>(read));
+  Wake(&header_->writer_waiting);
+  return read;
+}
+
+size_t SharedMemoryRingBuffer::Receive(void* buffer, size_t length) {
+  char* bytes = static_cast<char*>(buffer);
+  size_t received = 0;
+  while (received < length) {
+    received += Read(bytes + received, length - received);
+    if (received < length &&
+        !Wait(&header_->reader_waiting, &SharedMemoryRingBuffer::HasData)) {
+      break;
+    }
+  }
+  return received;
+}
+
+size_t SharedMemoryRingBuffer::Available() const {
+  uint32 used = Used();
+  return used > capacity_ ? 0 : used;
+}
+
+uint32 SharedMemoryRingBuffer::Used() const {
+  if (!capacity_)
+    return 1;
+  // Each end calls this, and each needs an acquire load of the position the
+  // other end writes.  Loading both that way costs nothing extra on the
+  // processors we run on.
+  return subtle::Acquire_Load(&header_->write_position) -
+      subtle::Acquire_Load(&header_->read_position);
+}
+
+bool SharedMemoryRingBuffer::HasData() const {
+  return Available() != 0;
+}
+
+bool SharedMemoryRingBuffer::HasRoom() const {
+  return Used() < capacity_;
+}
+
+bool SharedMemoryRingBuffer::Wait(
+    volatile Atomic32* waiting,
+    bool (SharedMemoryRingBuffer::*ready)() const) {
+  if (!IsValid())
+    return false;
+
+  // Say this end is going to sleep before looking once more, so that the
+  // other end either sees the flag after it moves its position or moved it
+  // before the look below.
+  subtle::NoBarrier_Store(waiting, 1);
+  subtle::MemoryBarrier();
+  if ((this->*ready)()) {
+    // Take the flag back.  If the other end took it first, its wake-up byte
+    // is on the way and has to be read to keep the socket empty.
+    if (subtle::NoBarrier_CompareAndSwap(waiting, 1, 0) == 1)
+      return true;
+  }
+
+  char token;
+  if (socket_->Receive(&token, 1) == 1)
+    return true;
+  // Nobody is coming; don't leave the other end sending to a dead socket.
+  subtle::NoBarrier_Store(waiting, 0);
+  return false;
+}
+
+void SharedMemoryRingBuffer::Wake(volatile Atomic32* waiting) {
+  // Pairs with the barrier in Wait(): the new position is visible before the
+  // flag is read.
+  subtle::MemoryBarrier();
+  if (subtle::NoBarrier_CompareAndSwap(waiting, 1, 0) != 1)
+    return;
+  char token = 0;
+  socket_->Send(&token, 1);
+}
+
+}  // namespace base
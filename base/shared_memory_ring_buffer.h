@@ -0,0 +1,110 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// SharedMemoryRingBuffer moves bytes from one thread or process to another
+// through a single-producer, single-consumer ring in shared memory.  Data
+// never goes through the kernel: each side only touches its own position in
+// the ring, with acquire and release ordering.  A SyncSocket pair carries one
+// byte to wake a side that went to sleep waiting for data or for room, and
+// nothing otherwise, so a steady stream costs no system calls at all.
+//
+// One process creates the memory and the sockets, and lays out the ring:
+//
+//   SharedMemory memory;
+//   memory.CreateAndMapAnonymous(
+//       SharedMemoryRingBuffer::RequiredSize(kCapacity));
+//   SharedMemoryRingBuffer::InitializeMemory(&memory, kCapacity);
+//   CancelableSyncSocket::CreatePair(&writer_socket, &reader_socket);
+//
+// then each end, in whichever process, maps the memory and wraps its socket:
+//
+//   SharedMemoryRingBuffer ring(&memory, &writer_socket);
+//   ring.Send(frame, frame_size);
+//
+// Closing or shutting down either socket makes a blocked Send() or Receive()
+// on the other end return.
+
+#ifndef BASE_SHARED_MEMORY_RING_BUFFER_H_
+#define BASE_SHARED_MEMORY_RING_BUFFER_H_
+#pragma once
+
+#include "base/atomicops.h"
+#include "base/base_export.h"
+#include "base/basictypes.h"
+
+namespace base {
+
+class SharedMemory;
+class SyncSocket;
+
+class BASE_EXPORT SharedMemoryRingBuffer {
+ public:
+  // Wraps the ring laid out in |memory| by InitializeMemory().  |socket| is
+  // this end of a pair whose other end the other side of the ring uses.
+  // Neither is owned, and both must outlive this object.
+  SharedMemoryRingBuffer(SharedMemory* memory, SyncSocket* socket);
+  ~SharedMemoryRingBuffer();
+
+  // The bytes of shared memory a ring of |capacity| bytes takes up.
+  static size_t RequiredSize(size_t capacity);
+
+  // Lays out an empty ring of |capacity| bytes, which must be a power of two,
+  // in the mapped |memory|.  Must be done once, before either end uses it.
+  // Returns false if |capacity| is not valid or does not fit.
+  static bool InitializeMemory(SharedMemory* memory, size_t capacity);
+
+  // Whether the memory held a ring that fits in it.  The other process could
+  // have written anything there, so this is worth checking before use; every
+  // call fails if it is false.
+  bool IsValid() const { return capacity_ != 0; }
+
+  size_t capacity() const { return capacity_; }
+
+  // For the writing end.  Write() copies as much of |data| as there is room
+  // for and returns the number of bytes written.  Send() blocks until all of
+  // |data| is written, in as many pieces as it takes, and returns |length|,
+  // or fewer if the reading end went away.
+  size_t Write(const void* data, size_t length);
+  size_t Send(const void* data, size_t length);
+
+  // For the reading end.  Read() copies out as much as is available, up to
+  // |length| bytes, and returns the number of bytes read.  Receive() blocks
+  // until |length| bytes have been read, and returns |length|, or fewer if
+  // the writing end went away.
+  size_t Read(void* buffer, size_t length);
+  size_t Receive(void* buffer, size_t length);
+
+  // The number of bytes waiting to be read.  Receive() of up to that many
+  // will not block.
+  size_t Available() const;
+
+ private:
+  struct Header;
+
+  // The number of bytes written but not yet read, or more than |capacity_|
+  // if the positions in shared memory make no sense.
+  uint32 Used() const;
+
+  bool HasData() const;
+  bool HasRoom() const;
+
+  // Sleeps until |ready| is true or the other end wakes this one through
+  // |waiting|.  Returns false if the other end went away.
+  bool Wait(volatile subtle::Atomic32* waiting,
+            bool (SharedMemoryRingBuffer::*ready)() const);
+
+  // Wakes the other end if it is asleep in Wait() on |waiting|.
+  void Wake(volatile subtle::Atomic32* waiting);
+
+  Header* header_;
+  char* data_;
+  uint32 capacity_;
+  SyncSocket* socket_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryRingBuffer);
+};
+
+}  // namespace base
+
+#endif  // BASE_SHARED_MEMORY_RING_BUFFER_H_
@@ -0,0 +1,165 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/shared_memory_ring_buffer.h"
+
+#include <algorithm>
+#include <string>
+
+#include "base/shared_memory.h"
+#include "base/sync_socket.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const size_t kCapacity = 256;
+
+class SharedMemoryRingBufferTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(memory_.CreateAndMapAnonymous(
+        SharedMemoryRingBuffer::RequiredSize(kCapacity)));
+    ASSERT_TRUE(SharedMemoryRingBuffer::InitializeMemory(&memory_,
+                                                         kCapacity));
+    ASSERT_TRUE(CancelableSyncSocket::CreatePair(&writer_socket_,
+                                                 &reader_socket_));
+  }
+
+  SharedMemory memory_;
+  CancelableSyncSocket writer_socket_;
+  CancelableSyncSocket reader_socket_;
+};
+
+// Sends |data| through |ring| in pieces of various sizes.
+class Sender : public PlatformThread::Delegate {
+ public:
+  Sender(SharedMemoryRingBuffer* ring, const std::string& data)
+      : ring_(ring), data_(data), sent_(0) {}
+
+  virtual void ThreadMain() OVERRIDE {
+    for (size_t piece = 1; sent_ < data_.size(); piece = piece * 3 % 1000) {
+      size_t length = std::min(piece, data_.size() - sent_);
+      size_t sent = ring_->Send(data_.data() + sent_, length);
+      sent_ += sent;
+      if (sent < length)
+        break;
+    }
+  }
+
+  size_t sent() const { return sent_; }
+
+ private:
+  SharedMemoryRingBuffer* ring_;
+  std::string data_;
+  size_t sent_;
+
+  DISALLOW_COPY_AND_ASSIGN(Sender);
+};
+
+}  // namespace
+
+TEST_F(SharedMemoryRingBufferTest, ReadWrite) {
+  SharedMemoryRingBuffer writer(&memory_, &writer_socket_);
+  SharedMemoryRingBuffer reader(&memory_, &reader_socket_);
+  ASSERT_TRUE(writer.IsValid());
+  EXPECT_EQ(kCapacity, reader.capacity());
+
+  char buffer[kCapacity * 2];
+  EXPECT_EQ(0u, reader.Available());
+  EXPECT_EQ(0u, reader.Read(buffer, sizeof(buffer)));
+
+  // Fill the ring past the end a few times, so the data wraps around.
+  std::string data;
+  for (size_t i = 0; i < kCapacity * 2; ++i)
+    data.push_back(static_cast<char>(i * 7));
+  size_t offset = 0;
+  for (int round = 0; round < 5; ++round) {
+    EXPECT_EQ(100u, writer.Write(data.data() + offset, 100));
+    EXPECT_EQ(100u, reader.Available());
+    EXPECT_EQ(30u, reader.Read(buffer, 30));
+    EXPECT_EQ(data.substr(offset, 30), std::string(buffer, 30));
+    EXPECT_EQ(70u, reader.Read(buffer, sizeof(buffer)));
+    EXPECT_EQ(data.substr(offset + 30, 70), std::string(buffer, 70));
+    offset = (offset + 100) % kCapacity;
+  }
+
+  // No more than the capacity goes in.
+  EXPECT_EQ(kCapacity, writer.Write(data.data(), data.size()));
+  EXPECT_EQ(0u, writer.Write(data.data(), 1));
+  EXPECT_EQ(kCapacity, reader.Receive(buffer, kCapacity));
+  EXPECT_EQ(data.substr(0, kCapacity), std::string(buffer, kCapacity));
+
+  // Nothing woke anybody, so nothing went through the sockets.
+  EXPECT_EQ(0u, reader_socket_.Peek());
+  EXPECT_EQ(0u, writer_socket_.Peek());
+}
+
+TEST_F(SharedMemoryRingBufferTest, Invalid) {
+  EXPECT_FALSE(SharedMemoryRingBuffer::InitializeMemory(&memory_, 100));
+  EXPECT_FALSE(SharedMemoryRingBuffer::InitializeMemory(&memory_,
+                                                        kCapacity * 2));
+
+  // A capacity the memory cannot hold, as a bad process might write.
+  SharedMemory small;
+  ASSERT_TRUE(small.CreateAndMapAnonymous(
+      SharedMemoryRingBuffer::RequiredSize(kCapacity)));
+  ASSERT_TRUE(SharedMemoryRingBuffer::InitializeMemory(&small, kCapacity));
+  static_cast<uint32*>(small.memory())[32] = kCapacity * 4;
+  SharedMemoryRingBuffer ring(&small, &writer_socket_);
+  EXPECT_FALSE(ring.IsValid());
+  EXPECT_EQ(0u, ring.Write("x", 1));
+  EXPECT_EQ(0u, ring.Send("x", 1));
+}
+
+TEST_F(SharedMemoryRingBufferTest, SendReceive) {
+  SharedMemoryRingBuffer writer(&memory_, &writer_socket_);
+  SharedMemoryRingBuffer reader(&memory_, &reader_socket_);
+
+  std::string data;
+  for (int i = 0; i < 1000000; ++i)
+    data.push_back(static_cast<char>(i % 251));
+  Sender sender(&writer, data);
+  PlatformThreadHandle thread;
+  ASSERT_TRUE(PlatformThread::Create(0, &sender, &thread));
+
+  // Receive in pieces of sizes that do not line up with the sender's.
+  std::string received;
+  char buffer[1000];
+  for (size_t piece = 1; received.size() < data.size();
+       piece = piece * 7 % sizeof(buffer) + 1) {
+    size_t length = std::min(piece, data.size() - received.size());
+    ASSERT_EQ(length, reader.Receive(buffer, length));
+    received.append(buffer, length);
+  }
+  PlatformThread::Join(thread);
+  EXPECT_EQ(data.size(), sender.sent());
+  EXPECT_TRUE(data == received);
+  EXPECT_EQ(0u, reader.Available());
+}
+
+TEST_F(SharedMemoryRingBufferTest, Shutdown) {
+  SharedMemoryRingBuffer writer(&memory_, &writer_socket_);
+  SharedMemoryRingBuffer reader(&memory_, &reader_socket_);
+
+  // The writer fills the ring and blocks; shutting down its peer's socket
+  // lets it go.
+  std::string data(kCapacity * 4, 'x');
+  Sender sender(&writer, data);
+  PlatformThreadHandle thread;
+  ASSERT_TRUE(PlatformThread::Create(0, &sender, &thread));
+  char buffer[kCapacity];
+  ASSERT_EQ(10u, reader.Receive(buffer, 10));
+  EXPECT_TRUE(reader_socket_.Shutdown());
+  PlatformThread::Join(thread);
+  EXPECT_LT(sender.sent(), data.size());
+
+  // A reader waiting for more than will come gets what there was.
+  size_t available = reader.Available();
+  EXPECT_EQ(available, reader.Receive(buffer, sizeof(buffer)));
+}
+
+}  // namespace base
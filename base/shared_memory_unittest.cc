@@ -357,6 +357,39 @@ TEST(SharedMemoryTest, AnonymousExecutable) {
 }
 #endif
 
+// Memory created with each of the mapping hints, and all of them, works like
+// any other and is shared with other mappings of it.
+TEST(SharedMemoryTest, MappingHints) {
+  const uint32 kTestSize = 4 << 20;
+
+  for (int hints = 0; hints < 8; ++hints) {
+    SharedMemoryCreateOptions options;
+    options.size = kTestSize;
+    options.huge_pages = (hints & 1) != 0;
+    options.prefault = (hints & 2) != 0;
+    options.numa_local = (hints & 4) != 0;
+    SharedMemory shared_memory;
+    ASSERT_TRUE(shared_memory.Create(options));
+    ASSERT_TRUE(shared_memory.Map(kTestSize));
+    EXPECT_EQ(kTestSize, shared_memory.mapped_size());
+
+    uint32* words = static_cast<uint32*>(shared_memory.memory());
+    for (uint32 i = 0; i < kTestSize / sizeof(*words); i += 1000) {
+      EXPECT_EQ(0u, words[i]);
+      words[i] = i;
+    }
+
+    SharedMemoryHandle handle;
+    ASSERT_TRUE(shared_memory.ShareToProcess(GetCurrentProcessHandle(),
+                                             &handle));
+    SharedMemory other(handle, true);
+    ASSERT_TRUE(other.Map(kTestSize));
+    const uint32* other_words = static_cast<const uint32*>(other.memory());
+    for (uint32 i = 0; i < kTestSize / sizeof(*words); i += 1000)
+      EXPECT_EQ(i, other_words[i]);
+  }
+}
+
 // On POSIX it is especially important we test shmem across processes,
 // not just across threads.  But the test is enabled on all platforms.
 class SharedMemoryProcessTest : public MultiProcessTest {
@@ -11,36 +11,52 @@ namespace base {
 
 SharedMemory::SharedMemory()
     : mapped_file_(NULL),
+      mapped_size_(0),
       memory_(NULL),
       read_only_(false),
       created_size_(0),
-      lock_(NULL) {
+      lock_(NULL),
+      huge_pages_(false),
+      prefault_(false),
+      numa_local_(false) {
 }
 
 SharedMemory::SharedMemory(const std::wstring& name)
     : mapped_file_(NULL),
+      mapped_size_(0),
       memory_(NULL),
       read_only_(false),
       created_size_(0),
       lock_(NULL),
+      huge_pages_(false),
+      prefault_(false),
+      numa_local_(false),
       name_(name) {
 }
 
 SharedMemory::SharedMemory(SharedMemoryHandle handle, bool read_only)
     : mapped_file_(handle),
+      mapped_size_(0),
       memory_(NULL),
       read_only_(read_only),
       created_size_(0),
-      lock_(NULL) {
+      lock_(NULL),
+      huge_pages_(false),
+      prefault_(false),
+      numa_local_(false) {
 }
 
 SharedMemory::SharedMemory(SharedMemoryHandle handle, bool read_only,
                            ProcessHandle process)
     : mapped_file_(NULL),
+      mapped_size_(0),
       memory_(NULL),
       read_only_(read_only),
       created_size_(0),
-      lock_(NULL) {
+      lock_(NULL),
+      huge_pages_(false),
+      prefault_(false),
+      numa_local_(false) {
   ::DuplicateHandle(process, handle,
                     GetCurrentProcess(), &mapped_file_,
                     STANDARD_RIGHTS_REQUIRED |
@@ -136,6 +152,7 @@ bool SharedMemory::Map(uint32 bytes) {
   memory_ = MapViewOfFile(mapped_file_,
       read_only_ ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS, 0, 0, bytes);
   if (memory_ != NULL) {
+    mapped_size_ = bytes;
     return true;
   }
   return false;
@@ -147,6 +164,7 @@ bool SharedMemory::Unmap() {
 
   UnmapViewOfFile(memory_);
   memory_ = NULL;
+  mapped_size_ = 0;
   return true;
 }
 
@@ -0,0 +1,16 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/single_thread_task_runner.h"
+
+namespace base {
+
+bool SingleThreadTaskRunner::PostTaskWithPriority(
+    const tracked_objects::Location& from_here,
+    const Closure& task,
+    TaskPriority priority) {
+  return PostTask(from_here, task);
+}
+
+}  // namespace base
@@ -8,6 +8,7 @@
 
 #include "base/base_export.h"
 #include "base/sequenced_task_runner.h"
+#include "base/task_priority.h"
 
 namespace base {
 
@@ -32,6 +33,15 @@ class BASE_EXPORT SingleThreadTaskRunner : public SequencedTaskRunner {
     return RunsTasksOnCurrentThread();
   }
 
+  // Like PostTask(), but lets |task| get ahead of less urgent tasks, or wait
+  // for the thread to be idle if |priority| is TASK_PRIORITY_IDLE.  Tasks in
+  // the same lane still run in the order they were posted.  Runners without
+  // lanes treat every task as TASK_PRIORITY_NORMAL, which is what the default
+  // implementation does.
+  virtual bool PostTaskWithPriority(const tracked_objects::Location& from_here,
+                                    const Closure& task,
+                                    TaskPriority priority);
+
  protected:
   virtual ~SingleThreadTaskRunner() {}
 };
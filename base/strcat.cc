@@ -0,0 +1,138 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strcat.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+
+namespace base {
+
+namespace {
+
+// Appends the first |count| of |pieces| to |dest| with one allocation at
+// most.
+void AppendPieces(std::string* dest, const AlphaNum* const* pieces,
+                  size_t count) {
+  size_t length = dest->size();
+  for (size_t i = 0; i < count; ++i)
+    length += pieces[i]->piece().size();
+  dest->reserve(length);
+  for (size_t i = 0; i < count; ++i) {
+    const StringPiece& piece = pieces[i]->piece();
+    // A piece of |dest| itself would be moved by the reserve().
+    DCHECK(piece.empty() || piece.data() < dest->data() ||
+           piece.data() >= dest->data() + dest->capacity());
+    dest->append(piece.data(), piece.size());
+  }
+}
+
+std::string CatPieces(const AlphaNum* const* pieces, size_t count) {
+  std::string result;
+  AppendPieces(&result, pieces, count);
+  return result;
+}
+
+}  // namespace
+
+AlphaNum::AlphaNum(int value)
+    : piece_(digits_, Int64ToBuffer(value, digits_)) {
+}
+
+AlphaNum::AlphaNum(unsigned int value)
+    : piece_(digits_, Uint64ToBuffer(value, digits_)) {
+}
+
+AlphaNum::AlphaNum(long value)
+    : piece_(digits_, Int64ToBuffer(value, digits_)) {
+}
+
+AlphaNum::AlphaNum(unsigned long value)
+    : piece_(digits_, Uint64ToBuffer(value, digits_)) {
+}
+
+AlphaNum::AlphaNum(long long value)
+    : piece_(digits_, Int64ToBuffer(value, digits_)) {
+}
+
+AlphaNum::AlphaNum(unsigned long long value)
+    : piece_(digits_, Uint64ToBuffer(value, digits_)) {
+}
+
+AlphaNum::AlphaNum(double value)
+    : piece_(digits_, DoubleToBuffer(value, digits_)) {
+}
+
+AlphaNum::AlphaNum(const AlphaNum& other) : piece_(other.piece_) {
+  if (piece_.data() == other.digits_) {
+    memcpy(digits_, other.digits_, piece_.size());
+    piece_.set(digits_, piece_.size());
+  }
+}
+
+std::string StrCat(const AlphaNum& a, const AlphaNum& b) {
+  const AlphaNum* pieces[] = { &a, &b };
+  return CatPieces(pieces, arraysize(pieces));
+}
+
+std::string StrCat(const AlphaNum& a, const AlphaNum& b, const AlphaNum& c) {
+  const AlphaNum* pieces[] = { &a, &b, &c };
+  return CatPieces(pieces, arraysize(pieces));
+}
+
+std::string StrCat(const AlphaNum& a, const AlphaNum& b, const AlphaNum& c,
+                   const AlphaNum& d) {
+  const AlphaNum* pieces[] = { &a, &b, &c, &d };
+  return CatPieces(pieces, arraysize(pieces));
+}
+
+std::string StrCat(const AlphaNum& a, const AlphaNum& b, const AlphaNum& c,
+                   const AlphaNum& d, const AlphaNum& e) {
+  const AlphaNum* pieces[] = { &a, &b, &c, &d, &e };
+  return CatPieces(pieces, arraysize(pieces));
+}
+
+std::string StrCat(const AlphaNum& a, const AlphaNum& b, const AlphaNum& c,
+                   const AlphaNum& d, const AlphaNum& e, const AlphaNum& f) {
+  const AlphaNum* pieces[] = { &a, &b, &c, &d, &e, &f };
+  return CatPieces(pieces, arraysize(pieces));
+}
+
+void StrAppend(std::string* dest, const AlphaNum& a) {
+  const AlphaNum* pieces[] = { &a };
+  AppendPieces(dest, pieces, arraysize(pieces));
+}
+
+void StrAppend(std::string* dest, const AlphaNum& a, const AlphaNum& b) {
+  const AlphaNum* pieces[] = { &a, &b };
+  AppendPieces(dest, pieces, arraysize(pieces));
+}
+
+void StrAppend(std::string* dest, const AlphaNum& a, const AlphaNum& b,
+               const AlphaNum& c) {
+  const AlphaNum* pieces[] = { &a, &b, &c };
+  AppendPieces(dest, pieces, arraysize(pieces));
+}
+
+void StrAppend(std::string* dest, const AlphaNum& a, const AlphaNum& b,
+               const AlphaNum& c, const AlphaNum& d) {
+  const AlphaNum* pieces[] = { &a, &b, &c, &d };
+  AppendPieces(dest, pieces, arraysize(pieces));
+}
+
+void StrAppend(std::string* dest, const AlphaNum& a, const AlphaNum& b,
+               const AlphaNum& c, const AlphaNum& d, const AlphaNum& e) {
+  const AlphaNum* pieces[] = { &a, &b, &c, &d, &e };
+  AppendPieces(dest, pieces, arraysize(pieces));
+}
+
+void StrAppend(std::string* dest, const AlphaNum& a, const AlphaNum& b,
+               const AlphaNum& c, const AlphaNum& d, const AlphaNum& e,
+               const AlphaNum& f) {
+  const AlphaNum* pieces[] = { &a, &b, &c, &d, &e, &f };
+  AppendPieces(dest, pieces, arraysize(pieces));
+}
+
+}  // namespace base
@@ -0,0 +1,94 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// StrCat() joins strings and numbers into a new string, and StrAppend()
+// adds them to the end of one, working out the whole length first so that
+// the result is allocated once.  Numbers are formatted as IntToString() and
+// DoubleToString() do, without going through printf or the locale.
+//
+//   std::string path = base::StrCat("/cache/", key, ".", generation);
+//   base::StrAppend(&log, "took ", elapsed_ms, "ms");
+//
+// Characters are not numbers: a char argument is rejected at compile time
+// rather than being printed as its code.
+
+#ifndef BASE_STRCAT_H_
+#define BASE_STRCAT_H_
+#pragma once
+
+#include <string>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/string_number_conversions.h"
+#include "base/string_piece.h"
+
+namespace base {
+
+// One argument to StrCat() or StrAppend(): a string, or a number formatted
+// into a buffer of its own.  These are meant to be made implicitly for the
+// call and not kept.
+class BASE_EXPORT AlphaNum {
+ public:
+  AlphaNum(int value);  // NOLINT(runtime/explicit)
+  AlphaNum(unsigned int value);  // NOLINT(runtime/explicit)
+  AlphaNum(long value);  // NOLINT(runtime/explicit)
+  AlphaNum(unsigned long value);  // NOLINT(runtime/explicit)
+  AlphaNum(long long value);  // NOLINT(runtime/explicit)
+  AlphaNum(unsigned long long value);  // NOLINT(runtime/explicit)
+  AlphaNum(double value);  // NOLINT(runtime/explicit)
+
+  AlphaNum(const char* value)  // NOLINT(runtime/explicit)
+      : piece_(value) {}
+  AlphaNum(const std::string& value)  // NOLINT(runtime/explicit)
+      : piece_(value) {}
+  AlphaNum(const StringPiece& value)  // NOLINT(runtime/explicit)
+      : piece_(value) {}
+
+  // Binding an argument to a const reference may copy it at the compiler's
+  // whim, and a copy's number has to be in its own buffer.
+  AlphaNum(const AlphaNum& other);
+
+  const StringPiece& piece() const { return piece_; }
+
+ private:
+  // Not defined, so that a char is not taken for a number.
+  AlphaNum(char value);
+  void operator=(const AlphaNum&);
+
+  StringPiece piece_;
+  char digits_[kDoubleBufferSize];
+};
+
+BASE_EXPORT std::string StrCat(const AlphaNum& a, const AlphaNum& b);
+BASE_EXPORT std::string StrCat(const AlphaNum& a, const AlphaNum& b,
+                               const AlphaNum& c);
+BASE_EXPORT std::string StrCat(const AlphaNum& a, const AlphaNum& b,
+                               const AlphaNum& c, const AlphaNum& d);
+BASE_EXPORT std::string StrCat(const AlphaNum& a, const AlphaNum& b,
+                               const AlphaNum& c, const AlphaNum& d,
+                               const AlphaNum& e);
+BASE_EXPORT std::string StrCat(const AlphaNum& a, const AlphaNum& b,
+                               const AlphaNum& c, const AlphaNum& d,
+                               const AlphaNum& e, const AlphaNum& f);
+
+BASE_EXPORT void StrAppend(std::string* dest, const AlphaNum& a);
+BASE_EXPORT void StrAppend(std::string* dest, const AlphaNum& a,
+                           const AlphaNum& b);
+BASE_EXPORT void StrAppend(std::string* dest, const AlphaNum& a,
+                           const AlphaNum& b, const AlphaNum& c);
+BASE_EXPORT void StrAppend(std::string* dest, const AlphaNum& a,
+                           const AlphaNum& b, const AlphaNum& c,
+                           const AlphaNum& d);
+BASE_EXPORT void StrAppend(std::string* dest, const AlphaNum& a,
+                           const AlphaNum& b, const AlphaNum& c,
+                           const AlphaNum& d, const AlphaNum& e);
+BASE_EXPORT void StrAppend(std::string* dest, const AlphaNum& a,
+                           const AlphaNum& b, const AlphaNum& c,
+                           const AlphaNum& d, const AlphaNum& e,
+                           const AlphaNum& f);
+
+}  // namespace base
+
+#endif  // BASE_STRCAT_H_
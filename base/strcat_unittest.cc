@@ -0,0 +1,51 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strcat.h"
+
+#include <limits>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(StrCatTest, Strings) {
+  std::string one("one");
+  StringPiece two("two");
+  EXPECT_EQ("onetwo", StrCat(one, two));
+  EXPECT_EQ("one two three", StrCat(one, " ", two, " ", "three"));
+  EXPECT_EQ("a", StrCat("a", ""));
+  EXPECT_EQ("", StrCat("", std::string()));
+  EXPECT_EQ("abcdef", StrCat("a", "b", "c", "d", "e", "f"));
+}
+
+TEST(StrCatTest, Numbers) {
+  EXPECT_EQ("-1 2", StrCat(-1, " ", 2u));
+  EXPECT_EQ("-9223372036854775808",
+            StrCat("", std::numeric_limits<int64>::min()));
+  EXPECT_EQ("18446744073709551615",
+            StrCat("", std::numeric_limits<uint64>::max()));
+  EXPECT_EQ("size 42", StrCat("size ", static_cast<size_t>(42)));
+  EXPECT_EQ("1.25/.5/1e+100", StrCat(1.25, "/", 0.5, "/", 1e100));
+
+  // An argument copied into a temporary keeps its digits.
+  AlphaNum number(12345);
+  AlphaNum copy(number);
+  EXPECT_EQ("12345", copy.piece());
+  EXPECT_NE(number.piece().data(), copy.piece().data());
+}
+
+TEST(StrCatTest, Append) {
+  std::string result("x=");
+  StrAppend(&result, 1);
+  EXPECT_EQ("x=1", result);
+  StrAppend(&result, ", y=", 2.5);
+  EXPECT_EQ("x=1, y=2.5", result);
+  StrAppend(&result, "", "", "", "", "", "");
+  EXPECT_EQ("x=1, y=2.5", result);
+  StrAppend(&result, ", z=", -3, ", w=", 4u, "!");
+  EXPECT_EQ("x=1, y=2.5, z=-3, w=4!", result);
+}
+
+}  // namespace base
@@ -7,10 +7,12 @@
 #include <ctype.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <wctype.h>
 
 #include <limits>
 
+#include "base/fast_dtoa.h"
 #include "base/logging.h"
 #include "base/third_party/dmg_fp/dmg_fp.h"
 #include "base/utf_string_conversions.h"
@@ -19,6 +21,34 @@ namespace base {
 
 namespace {
 
+// The two digits of each number from 0 to 99.
+const char kDigitPairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Writes the decimal digits of |value| to the characters before |end|, two
+// at a time, and returns the first of them.
+template <typename CHAR, typename UINT>
+CHAR* WriteDigitsBackwards(UINT value, CHAR* end) {
+  while (value >= 100) {
+    const char* pair = &kDigitPairs[(value % 100) * 2];
+    value /= 100;
+    *--end = pair[1];
+    *--end = pair[0];
+  }
+  if (value >= 10) {
+    const char* pair = &kDigitPairs[value * 2];
+    *--end = pair[1];
+    *--end = pair[0];
+  } else {
+    *--end = static_cast<CHAR>('0' + value);
+  }
+  return end;
+}
+
 template <typename STR, typename INT, typename UINT, bool NEG>
 struct IntToStringT {
   // This is to avoid a compiler warning about unary minus on unsigned type.
@@ -68,33 +98,21 @@ struct IntToStringT {
     // So round up to allocate 3 output characters per byte, plus 1 for '-'.
     const int kOutputBufSize = 3 * sizeof(INT) + 1;
 
-    // Allocate the whole string right away, we will right back to front, and
-    // then return the substr of what we ended up using.
-    STR outbuf(kOutputBufSize, 0);
+    // Write back to front into a buffer on the stack, and then make the
+    // string of what we ended up using.
+    typename STR::value_type outbuf[kOutputBufSize];
+    typename STR::value_type* end = outbuf + kOutputBufSize;
 
     bool is_neg = TestNegT<INT, NEG>::TestNeg(value);
     // Even though is_neg will never be true when INT is parameterized as
     // unsigned, even the presence of the unary operation causes a warning.
     UINT res = ToUnsignedT<INT, UINT, NEG>::ToUnsigned(value);
 
-    for (typename STR::iterator it = outbuf.end();;) {
-      --it;
-      DCHECK(it != outbuf.begin());
-      *it = static_cast<typename STR::value_type>((res % 10) + '0');
-      res /= 10;
-
-      // We're done..
-      if (res == 0) {
-        if (is_neg) {
-          --it;
-          DCHECK(it != outbuf.begin());
-          *it = static_cast<typename STR::value_type>('-');
-        }
-        return STR(it, outbuf.end());
-      }
-    }
-    NOTREACHED();
-    return STR();
+    typename STR::value_type* begin = WriteDigitsBackwards(res, end);
+    if (is_neg)
+      *--begin = static_cast<typename STR::value_type>('-');
+    DCHECK(begin >= outbuf);
+    return STR(begin, end);
   }
 };
 
@@ -388,10 +406,112 @@ string16 Uint64ToString16(uint64 value) {
 }
 
 std::string DoubleToString(double value) {
-  // According to g_fmt.cc, it is sufficient to declare a buffer of size 32.
-  char buffer[32];
-  dmg_fp::g_fmt(buffer, value);
-  return std::string(buffer);
+  char buffer[kDoubleBufferSize];
+  return std::string(buffer, DoubleToBuffer(value, buffer));
+}
+
+size_t Int64ToBuffer(int64 value, char* buffer) {
+  char digits[kInt64BufferSize];
+  char* end = digits + kInt64BufferSize;
+  // Negate in unsigned arithmetic, which is defined for kint64min too.
+  char* begin = WriteDigitsBackwards(
+      value < 0 ? 0 - static_cast<uint64>(value) : static_cast<uint64>(value),
+      end);
+  if (value < 0)
+    *--begin = '-';
+  memcpy(buffer, begin, end - begin);
+  return end - begin;
+}
+
+size_t Uint64ToBuffer(uint64 value, char* buffer) {
+  char digits[kInt64BufferSize];
+  char* end = digits + kInt64BufferSize;
+  char* begin = WriteDigitsBackwards(value, end);
+  memcpy(buffer, begin, end - begin);
+  return end - begin;
+}
+
+size_t DoubleToBuffer(double value, char* buffer) {
+  char* out = buffer;
+  if (value != value || value - value != 0) {
+    // NaN or infinity: dtoa() spells these out.
+    dmg_fp::g_fmt(buffer, value);
+    return strlen(buffer);
+  }
+  if (value < 0 || (value == 0 && 1 / value < 0)) {
+    *out++ = '-';
+    value = -value;
+  }
+  if (value == 0) {
+    *out++ = '0';
+    return out - buffer;
+  }
+
+  // Find the shortest digits that read back as |value|, and where the
+  // decimal point goes in them, with dtoa() for the few that Grisu3 can't
+  // be sure of.
+  char fast_digits[internal::kFastDtoaMaxDigits + 1];
+  char* digits = fast_digits;
+  char* dtoa_digits = NULL;
+  int length;
+  int decimal_point;
+  if (internal::FastDtoaShortest(value, fast_digits, &length, &decimal_point)) {
+    decimal_point += length;
+  } else {
+    int sign;
+    char* digits_end;
+    dtoa_digits = dmg_fp::dtoa(value, 0, 0, &decimal_point, &sign,
+                               &digits_end);
+    digits = dtoa_digits;
+    length = static_cast<int>(digits_end - dtoa_digits);
+  }
+
+  // Lay them out as dmg_fp::g_fmt() does.
+  if (decimal_point <= -4 || decimal_point > length + 5) {
+    *out++ = digits[0];
+    if (length > 1) {
+      *out++ = '.';
+      memcpy(out, digits + 1, length - 1);
+      out += length - 1;
+    }
+    *out++ = 'e';
+    int exponent = decimal_point - 1;
+    if (exponent < 0) {
+      *out++ = '-';
+      exponent = -exponent;
+    } else {
+      *out++ = '+';
+    }
+    if (exponent < 10)
+      *out++ = '0';
+    char exponent_digits[3];
+    char* exponent_end = exponent_digits + arraysize(exponent_digits);
+    char* exponent_begin = WriteDigitsBackwards(exponent, exponent_end);
+    memcpy(out, exponent_begin, exponent_end - exponent_begin);
+    out += exponent_end - exponent_begin;
+  } else if (decimal_point <= 0) {
+    *out++ = '.';
+    memset(out, '0', -decimal_point);
+    out += -decimal_point;
+    memcpy(out, digits, length);
+    out += length;
+  } else if (decimal_point < length) {
+    memcpy(out, digits, decimal_point);
+    out += decimal_point;
+    *out++ = '.';
+    memcpy(out, digits + decimal_point, length - decimal_point);
+    out += length - decimal_point;
+  } else {
+    memcpy(out, digits, length);
+    out += length;
+    memset(out, '0', decimal_point - length);
+    out += decimal_point - length;
+  }
+
+  if (dtoa_digits)
+    dmg_fp::freedtoa(dtoa_digits);
+  DCHECK_LE(static_cast<size_t>(out - buffer), kDoubleBufferSize);
+  return out - buffer;
 }
 
 bool StringToInt(const StringPiece& input, int* output) {
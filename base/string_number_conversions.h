@@ -45,6 +45,17 @@ BASE_EXPORT string16 Uint64ToString16(uint64 value);
 // locale. If you want to use locale specific formatting, use ICU.
 BASE_EXPORT std::string DoubleToString(double value);
 
+// These write |value| to |buffer|, the way the functions above format it,
+// without a terminating NUL, and return the number of characters written.
+// They are for formatting many numbers without a string for each.
+const size_t kInt64BufferSize = 20;
+const size_t kDoubleBufferSize = 32;
+// |buffer| must have room for kInt64BufferSize characters.
+BASE_EXPORT size_t Int64ToBuffer(int64 value, char* buffer);
+BASE_EXPORT size_t Uint64ToBuffer(uint64 value, char* buffer);
+// |buffer| must have room for kDoubleBufferSize characters.
+BASE_EXPORT size_t DoubleToBuffer(double value, char* buffer);
+
 // String -> number conversions ------------------------------------------------
 
 // Perform a best-effort conversion of the input string to a numeric type,
@@ -0,0 +1,64 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/perftimer.h"
+#include "base/string_number_conversions.h"
+#include "base/stringprintf.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kIterations = 200000;
+
+double MillionsPerSecond(base::TimeDelta elapsed) {
+  return kIterations / 1e6 / elapsed.InSecondsF();
+}
+
+}  // namespace
+
+TEST(StringNumberConversionsPerfTest, Integers) {
+  size_t total = 0;
+  PerfTimer to_string_timer;
+  for (int i = 0; i < kIterations; ++i)
+    total += base::IntToString(i * 7919).size();
+  LogPerfResult("IntToString", MillionsPerSecond(to_string_timer.Elapsed()),
+                "M/s");
+
+  char buffer[base::kInt64BufferSize];
+  PerfTimer to_buffer_timer;
+  for (int i = 0; i < kIterations; ++i)
+    total -= base::Int64ToBuffer(i * 7919, buffer);
+  LogPerfResult("Int64ToBuffer", MillionsPerSecond(to_buffer_timer.Elapsed()),
+                "M/s");
+  EXPECT_EQ(0u, total);
+}
+
+TEST(StringNumberConversionsPerfTest, Doubles) {
+  size_t total = 0;
+  PerfTimer to_string_timer;
+  for (int i = 0; i < kIterations; ++i)
+    total += base::DoubleToString(i / 7.0).size();
+  LogPerfResult("DoubleToString", MillionsPerSecond(to_string_timer.Elapsed()),
+                "M/s");
+
+  char buffer[base::kDoubleBufferSize];
+  PerfTimer to_buffer_timer;
+  for (int i = 0; i < kIterations; ++i)
+    total -= base::DoubleToBuffer(i / 7.0, buffer);
+  LogPerfResult("DoubleToBuffer", MillionsPerSecond(to_buffer_timer.Elapsed()),
+                "M/s");
+  EXPECT_EQ(0u, total);
+}
+
+TEST(StringNumberConversionsPerfTest, StringAppendF) {
+  std::string output;
+  PerfTimer timer;
+  for (int i = 0; i < kIterations; ++i) {
+    output.clear();
+    base::StringAppendF(&output, "%d: %s", i, "a short line of text");
+  }
+  LogPerfResult("StringAppendF", MillionsPerSecond(timer.Elapsed()), "M/s");
+}
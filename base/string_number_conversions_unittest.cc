@@ -54,6 +54,12 @@ TEST(StringNumberConversionsTest, IntToString) {
     EXPECT_EQ(Int64ToString16(test->num), UTF8ToUTF16(test->sexpected));
     EXPECT_EQ(Uint64ToString(test->num), test->uexpected);
     EXPECT_EQ(Uint64ToString16(test->num), UTF8ToUTF16(test->uexpected));
+
+    char buffer[kInt64BufferSize];
+    EXPECT_EQ(test->sexpected,
+              std::string(buffer, Int64ToBuffer(test->num, buffer)));
+    EXPECT_EQ(test->uexpected,
+              std::string(buffer, Uint64ToBuffer(test->num, buffer)));
   }
 }
 
@@ -372,6 +378,36 @@ TEST(StringNumberConversionsTest, DoubleToString) {
   input = 0;
   memcpy(&input, input_bytes2, arraysize(input_bytes2));
   EXPECT_EQ("1334890332160", DoubleToString(input));
+
+  EXPECT_EQ("-0", DoubleToString(-0.0));
+  EXPECT_EQ(".001", DoubleToString(0.001));
+  EXPECT_EQ("1e-05", DoubleToString(0.00001));
+  EXPECT_EQ("-1.5e+300", DoubleToString(-1.5e300));
+  EXPECT_EQ("1.7976931348623157e+308",
+            DoubleToString(std::numeric_limits<double>::max()));
+  EXPECT_EQ("5e-324",
+            DoubleToString(std::numeric_limits<double>::denorm_min()));
+  EXPECT_EQ("Infinity",
+            DoubleToString(std::numeric_limits<double>::infinity()));
+}
+
+// DoubleToString() reads back as the same double, whichever way it found the
+// digits.
+TEST(StringNumberConversionsTest, DoubleToStringRoundTrip) {
+  uint64 state = GG_UINT64_C(0x853c49e6748fea9b);
+  for (int i = 0; i < 10000; ++i) {
+    state = state * GG_UINT64_C(6364136223846793005) +
+        GG_UINT64_C(1442695040888963407);
+    // Any normal double; StringToDouble() fails on underflow.
+    uint64 bits = GG_UINT64_C(0x0010000000000000) +
+        state % GG_UINT64_C(0x7FE0000000000000);
+    double input;
+    memcpy(&input, &bits, sizeof(input));
+    std::string output(DoubleToString(input));
+    double read_back = 0;
+    ASSERT_TRUE(StringToDouble(output, &read_back)) << output;
+    EXPECT_EQ(input, read_back) << output;
+  }
 }
 
 TEST(StringNumberConversionsTest, HexEncode) {
@@ -4,6 +4,8 @@
 
 #include "base/string_split.h"
 
+#include <string.h>
+
 #include "base/logging.h"
 #include "base/string_util.h"
 #include "base/third_party/icu/icu_utf.h"
@@ -11,6 +13,92 @@
 
 namespace base {
 
+namespace {
+
+// Returns the position of the first |c| in |str| at or after |pos|, or the
+// size of |str| if there is none.  memchr() compares a word or a vector
+// register at a time.
+size_t FindChar(const StringPiece& str, size_t pos, char c) {
+  if (pos >= str.size())
+    return str.size();
+  const void* found = memchr(str.data() + pos, c, str.size() - pos);
+  return found ? static_cast<const char*>(found) - str.data() : str.size();
+}
+
+size_t FindChar(const StringPiece16& str, size_t pos, char16 c) {
+  while (pos < str.size() && str[pos] != c)
+    ++pos;
+  return pos;
+}
+
+template <typename CHAR>
+bool IsInSet(CHAR c, const CHAR set[]) {
+  for (; *set; ++set) {
+    if (*set == c)
+      return true;
+  }
+  return false;
+}
+
+// Returns |piece| without the characters of |trim_chars| at either end.
+template <typename PIECE>
+PIECE TrimPiece(const PIECE& piece,
+                const typename PIECE::value_type trim_chars[]) {
+  size_t begin = 0;
+  size_t end = piece.size();
+  while (begin < end && IsInSet(piece[begin], trim_chars))
+    ++begin;
+  while (end > begin && IsInSet(piece[end - 1], trim_chars))
+    --end;
+  return PIECE(piece.data() + begin, end - begin);
+}
+
+// Splits like SplitStringT() below, trimming the characters of |trim_chars|
+// off the pieces unless it is NULL.
+template <typename PIECE>
+void SplitStringPieceT(const PIECE& str,
+                       typename PIECE::value_type c,
+                       const typename PIECE::value_type trim_chars[],
+                       std::vector<PIECE>* r) {
+  r->clear();
+  size_t begin = 0;
+  while (true) {
+    size_t end = FindChar(str, begin, c);
+    PIECE piece(str.data() + begin, end - begin);
+    if (trim_chars)
+      piece = TrimPiece(piece, trim_chars);
+    // Avoid converting an empty or all-whitespace source string into a vector
+    // of one empty string.
+    if (end != str.size() || !r->empty() || !piece.empty())
+      r->push_back(piece);
+    if (end == str.size())
+      return;
+    begin = end + 1;
+  }
+}
+
+// Splits |pair| at the first run of |delimiter| like SplitStringIntoKeyValues.
+bool SplitStringPieceIntoKeyValue(const StringPiece& pair,
+                                  char delimiter,
+                                  StringPiece* key,
+                                  StringPiece* value) {
+  size_t end_key_pos = FindChar(pair, 0, delimiter);
+  if (end_key_pos == pair.size())
+    return false;  // No key.
+  *key = StringPiece(pair.data(), end_key_pos);
+
+  size_t begin_value_pos = end_key_pos;
+  while (begin_value_pos < pair.size() && pair[begin_value_pos] == delimiter)
+    ++begin_value_pos;
+  if (begin_value_pos == pair.size())
+    return false;  // No value.
+  *value = StringPiece(pair.data() + begin_value_pos,
+                       pair.size() - begin_value_pos);
+  return true;
+}
+
+}  // namespace
+
 template<typename STR>
 static void SplitStringT(const STR& str,
                          const typename STR::value_type s,
@@ -49,6 +137,23 @@ void SplitString(const std::string& str,
   SplitStringT(str, c, true, r);
 }
 
+void SplitStringPiece(const StringPiece16& str,
+                      char16 c,
+                      std::vector<StringPiece16>* r) {
+  DCHECK(CBU16_IS_SINGLE(c));
+  SplitStringPieceT(str, c, kWhitespaceUTF16, r);
+}
+
+void SplitStringPiece(const StringPiece& str,
+                      char c,
+                      std::vector<StringPiece>* r) {
+#if CHAR_MIN < 0
+  DCHECK(c >= 0);
+#endif
+  DCHECK(c < 0x7F);
+  SplitStringPieceT(str, c, kWhitespaceASCII, r);
+}
+
 bool SplitStringIntoKeyValues(
     const std::string& line,
     char key_value_delimiter,
@@ -84,31 +189,49 @@ bool SplitStringIntoKeyValuePairs(
     char key_value_delimiter,
     char key_value_pair_delimiter,
     std::vector<std::pair<std::string, std::string> >* kv_pairs) {
+  std::vector<std::pair<StringPiece, StringPiece> > pieces;
+  bool success = SplitStringPieceIntoKeyValuePairs(
+      line, key_value_delimiter, key_value_pair_delimiter, &pieces);
+
   kv_pairs->clear();
+  kv_pairs->reserve(pieces.size());
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    kv_pairs->push_back(std::make_pair(pieces[i].first.as_string(),
+                                       pieces[i].second.as_string()));
+  }
+  return success;
+}
 
-  std::vector<std::string> pairs;
-  SplitString(line, key_value_pair_delimiter, &pairs);
+bool SplitStringPieceIntoKeyValuePairs(
+    const StringPiece& line,
+    char key_value_delimiter,
+    char key_value_pair_delimiter,
+    std::vector<std::pair<StringPiece, StringPiece> >* kv_pairs) {
+  kv_pairs->clear();
 
   bool success = true;
-  for (size_t i = 0; i < pairs.size(); ++i) {
+  size_t begin = 0;
+  while (true) {
+    size_t end = FindChar(line, begin, key_value_pair_delimiter);
+    StringPiece pair = TrimPiece(StringPiece(line.data() + begin, end - begin),
+                                 kWhitespaceASCII);
     // Empty pair. SplitStringIntoKeyValues is more strict about an empty pair
     // line, so continue with the next pair.
-    if (pairs[i].empty())
-      continue;
-
-    std::string key;
-    std::vector<std::string> value;
-    if (!SplitStringIntoKeyValues(pairs[i],
-                                  key_value_delimiter,
-                                  &key, &value)) {
-      // Don't return here, to allow for keys without associated
-      // values; just record that our split failed.
-      success = false;
+    if (!pair.empty()) {
+      StringPiece key;
+      StringPiece value;
+      if (!SplitStringPieceIntoKeyValue(pair, key_value_delimiter,
+                                        &key, &value)) {
+        // Don't return here, to allow for keys without associated
+        // values; just record that our split failed.
+        success = false;
+      }
+      kv_pairs->push_back(std::make_pair(key, value));
     }
-    DCHECK_LE(value.size(), 1U);
-    kv_pairs->push_back(make_pair(key, value.empty()? "" : value[0]));
+    if (end == line.size())
+      return success;
+    begin = end + 1;
   }
-  return success;
 }
 
 template <typename STR>
@@ -163,6 +286,23 @@ void SplitStringDontTrim(const std::string& str,
   SplitStringT(str, c, false, r);
 }
 
+void SplitStringPieceDontTrim(const StringPiece16& str,
+                              char16 c,
+                              std::vector<StringPiece16>* r) {
+  DCHECK(CBU16_IS_SINGLE(c));
+  SplitStringPieceT<StringPiece16>(str, c, NULL, r);
+}
+
+void SplitStringPieceDontTrim(const StringPiece& str,
+                              char c,
+                              std::vector<StringPiece>* r) {
+#if CHAR_MIN < 0
+  DCHECK(c >= 0);
+#endif
+  DCHECK(c < 0x7F);
+  SplitStringPieceT<StringPiece>(str, c, NULL, r);
+}
+
 template<typename STR>
 void SplitStringAlongWhitespaceT(const STR& str, std::vector<STR>* result) {
   const size_t length = str.length();
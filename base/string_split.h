@@ -12,6 +12,7 @@
 
 #include "base/base_export.h"
 #include "base/string16.h"
+#include "base/string_piece.h"
 
 namespace base {
 
@@ -32,6 +33,19 @@ BASE_EXPORT void SplitString(const std::string& str,
                              char c,
                              std::vector<std::string>* r);
 
+// The same as SplitString, but fills |r| with pieces of |str| instead of
+// copies, so nothing is allocated once |r| has grown to fit.  |r| is cleared
+// first, so it can be reused across calls.  The pieces point into |str|,
+// which must outlive them.
+// NOTE: |c| must be in BMP (Basic Multilingual Plane)
+BASE_EXPORT void SplitStringPiece(const StringPiece16& str,
+                                  char16 c,
+                                  std::vector<StringPiece16>* r);
+// Note: |c| must be in the ASCII range.
+BASE_EXPORT void SplitStringPiece(const StringPiece& str,
+                                  char c,
+                                  std::vector<StringPiece>* r);
+
 BASE_EXPORT bool SplitStringIntoKeyValues(
     const std::string& line,
     char key_value_delimiter,
@@ -43,6 +57,14 @@ BASE_EXPORT bool SplitStringIntoKeyValuePairs(
     char key_value_pair_delimiter,
     std::vector<std::pair<std::string, std::string> >* kv_pairs);
 
+// The same as SplitStringIntoKeyValuePairs, but fills |kv_pairs| with pieces
+// of |line|, like SplitStringPiece.
+BASE_EXPORT bool SplitStringPieceIntoKeyValuePairs(
+    const StringPiece& line,
+    char key_value_delimiter,
+    char key_value_pair_delimiter,
+    std::vector<std::pair<StringPiece, StringPiece> >* kv_pairs);
+
 // The same as SplitString, but use a substring delimiter instead of a char.
 BASE_EXPORT void SplitStringUsingSubstr(const string16& str,
                                         const string16& s,
@@ -64,6 +86,14 @@ BASE_EXPORT void SplitStringDontTrim(const std::string& str,
                                      char c,
                                      std::vector<std::string>* r);
 
+// The same as SplitStringPiece, but don't trim white space.
+BASE_EXPORT void SplitStringPieceDontTrim(const StringPiece16& str,
+                                          char16 c,
+                                          std::vector<StringPiece16>* r);
+BASE_EXPORT void SplitStringPieceDontTrim(const StringPiece& str,
+                                          char c,
+                                          std::vector<StringPiece>* r);
+
 // WARNING: this uses whitespace as defined by the HTML5 spec. If you need
 // a function similar to this but want to trim all types of whitespace, then
 // factor this out into a function that takes a string containing the characters
@@ -316,4 +316,66 @@ TEST(StringSplitTest, SplitStringAlongWhitespace) {
   }
 }
 
+TEST(StringSplitTest, SplitStringPiece) {
+  std::string input("a, b ,,  c  ,");
+  std::vector<StringPiece> pieces;
+  SplitStringPiece(input, ',', &pieces);
+  ASSERT_EQ(5u, pieces.size());
+  EXPECT_EQ("a", pieces[0]);
+  EXPECT_EQ("b", pieces[1]);
+  EXPECT_EQ("", pieces[2]);
+  EXPECT_EQ("c", pieces[3]);
+  EXPECT_EQ("", pieces[4]);
+  // The pieces point into the input.
+  EXPECT_EQ(input.data() + 3, pieces[1].data());
+
+  // The vector is cleared, so it can be reused.
+  SplitStringPiece("x", ',', &pieces);
+  ASSERT_EQ(1u, pieces.size());
+  EXPECT_EQ("x", pieces[0]);
+
+  SplitStringPiece("", ',', &pieces);
+  EXPECT_TRUE(pieces.empty());
+  SplitStringPiece("  ", ',', &pieces);
+  EXPECT_TRUE(pieces.empty());
+
+  SplitStringPieceDontTrim(" a ,b", ',', &pieces);
+  ASSERT_EQ(2u, pieces.size());
+  EXPECT_EQ(" a ", pieces[0]);
+  EXPECT_EQ("b", pieces[1]);
+
+  string16 input16(ASCIIToUTF16(" a |b|| c "));
+  std::vector<StringPiece16> pieces16;
+  SplitStringPiece(input16, '|', &pieces16);
+  ASSERT_EQ(4u, pieces16.size());
+  EXPECT_EQ(ASCIIToUTF16("a"), pieces16[0].as_string());
+  EXPECT_EQ(ASCIIToUTF16("b"), pieces16[1].as_string());
+  EXPECT_EQ(string16(), pieces16[2].as_string());
+  EXPECT_EQ(ASCIIToUTF16("c"), pieces16[3].as_string());
+
+  SplitStringPieceDontTrim(input16, '|', &pieces16);
+  ASSERT_EQ(4u, pieces16.size());
+  EXPECT_EQ(ASCIIToUTF16(" a "), pieces16[0].as_string());
+  EXPECT_EQ(ASCIIToUTF16(" c "), pieces16[3].as_string());
+}
+
+TEST(StringSplitTest, SplitStringPieceIntoKeyValuePairs) {
+  std::vector<std::pair<StringPiece, StringPiece> > kv_pairs;
+  EXPECT_TRUE(SplitStringPieceIntoKeyValuePairs("k1:v1,, k2::v:2 ", ':', ',',
+                                                &kv_pairs));
+  ASSERT_EQ(2u, kv_pairs.size());
+  EXPECT_EQ("k1", kv_pairs[0].first);
+  EXPECT_EQ("v1", kv_pairs[0].second);
+  EXPECT_EQ("k2", kv_pairs[1].first);
+  EXPECT_EQ("v:2", kv_pairs[1].second);
+
+  EXPECT_FALSE(SplitStringPieceIntoKeyValuePairs("novalue,k:", ':', ',',
+                                                 &kv_pairs));
+  ASSERT_EQ(2u, kv_pairs.size());
+  EXPECT_EQ("", kv_pairs[0].first);
+  EXPECT_EQ("", kv_pairs[0].second);
+  EXPECT_EQ("k", kv_pairs[1].first);
+  EXPECT_EQ("", kv_pairs[1].second);
+}
+
 }  // namespace base
@@ -454,7 +454,7 @@ bool IsStringASCII(const std::wstring& str) {
 }
 
 #if !defined(WCHAR_T_IS_UTF16)
-bool IsStringASCII(const string16& str) {
+bool IsStringASCII(const base::StringPiece16& str) {
   return DoIsStringASCII(str);
 }
 #endif
@@ -547,7 +547,7 @@ bool LowerCaseEqualsASCII(const char16* a_begin,
 
 #endif  // !defined(OS_ANDROID)
 
-bool EqualsASCII(const string16& a, const base::StringPiece& b) {
+bool EqualsASCII(const base::StringPiece16& a, const base::StringPiece& b) {
   if (a.length() != b.length())
     return false;
   return std::equal(b.begin(), b.end(), a.begin());
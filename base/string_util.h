@@ -297,7 +297,11 @@ BASE_EXPORT bool WideToLatin1(const std::wstring& wide, std::string* latin1);
 BASE_EXPORT bool IsStringUTF8(const std::string& str);
 BASE_EXPORT bool IsStringASCII(const std::wstring& str);
 BASE_EXPORT bool IsStringASCII(const base::StringPiece& str);
-BASE_EXPORT bool IsStringASCII(const string16& str);
+// Where string16 is std::wstring, the overload above for std::wstring covers
+// it.
+#if !defined(WCHAR_T_IS_UTF16)
+BASE_EXPORT bool IsStringASCII(const base::StringPiece16& str);
+#endif
 
 // Converts the elements of the given string.  This version uses a pointer to
 // clearly differentiate it from the non-pointer variant.
@@ -357,7 +361,8 @@ BASE_EXPORT bool LowerCaseEqualsASCII(const char16* a_begin,
 
 // Performs a case-sensitive string compare. The behavior is undefined if both
 // strings are not ASCII.
-BASE_EXPORT bool EqualsASCII(const string16& a, const base::StringPiece& b);
+BASE_EXPORT bool EqualsASCII(const base::StringPiece16& a,
+                             const base::StringPiece& b);
 
 // Returns true if str starts with search, or false otherwise.
 BASE_EXPORT bool StartsWithASCII(const std::string& str,
@@ -428,6 +428,16 @@ TEST(StringUtilTest, ConvertASCII) {
   EXPECT_FALSE(IsStringASCII("Google \x80Video"));
   EXPECT_FALSE(IsStringASCII(L"Google \x80Video"));
 
+  // Parts of a string16 are checked in place.
+  string16 mixed = ASCIIToUTF16("Google Video");
+  mixed.push_back(0x80);
+#if !defined(WCHAR_T_IS_UTF16)
+  EXPECT_TRUE(IsStringASCII(base::StringPiece16(mixed.data(), 6)));
+  EXPECT_FALSE(IsStringASCII(base::StringPiece16(mixed)));
+#endif
+  EXPECT_TRUE(EqualsASCII(base::StringPiece16(mixed.data(), 6), "Google"));
+  EXPECT_FALSE(EqualsASCII(mixed, "Google Video"));
+
   // Convert empty strings.
   std::wstring wempty;
   std::string empty;
@@ -59,7 +59,11 @@ static void StringAppendVT(StringType* dst,
     return;
   }
 
-  // Repeatedly increase buffer size until it fits.
+  // Repeatedly increase buffer size until it fits.  Each attempt formats
+  // straight into the end of a copy of |dst|, which is swapped in once it
+  // fits, rather than into a buffer that would then be copied.  |dst| itself
+  // is left alone until then in case the arguments point into it.
+  const size_t old_size = dst->size();
   int mem_length = arraysize(stack_buf);
   while (true) {
     if (result < 0) {
@@ -89,17 +93,21 @@ static void StringAppendVT(StringType* dst,
       return;
     }
 
-    std::vector<typename StringType::value_type> mem_buf(mem_length);
+    StringType formatted;
+    formatted.reserve(old_size + mem_length);
+    formatted.assign(*dst);
+    formatted.resize(old_size + mem_length);
 
     // NOTE: You can only use a va_list once.  Since we're in a while loop, we
     // need to make a new copy each time so we don't use up the original.
     GG_VA_COPY(ap_copy, ap);
-    result = vsnprintfT(&mem_buf[0], mem_length, format, ap_copy);
+    result = vsnprintfT(&formatted[old_size], mem_length, format, ap_copy);
     va_end(ap_copy);
 
     if ((result >= 0) && (result < mem_length)) {
-      // It fit.
-      dst->append(&mem_buf[0], result);
+      // It fit.  Drop the terminating NUL and any room left over.
+      formatted.resize(old_size + result);
+      dst->swap(formatted);
       return;
     }
   }
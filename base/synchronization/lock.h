@@ -58,6 +58,12 @@ class BASE_EXPORT Lock {
   void AssertAcquired() const;
 #endif                          // NDEBUG
 
+  // The number of times, process wide, that acquiring a Lock had to wait for
+  // another thread to release it.
+  static int GetContentionCount() {
+    return internal::LockImpl::GetContentionCount();
+  }
+
 #if defined(OS_POSIX)
   // The posix implementation of ConditionVariable needs to be able
   // to see our lock and tweak our debugging counters, as it releases
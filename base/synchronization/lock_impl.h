@@ -14,6 +14,7 @@
 #include <pthread.h>
 #endif
 
+#include "base/atomicops.h"
 #include "base/base_export.h"
 #include "base/basictypes.h"
 
@@ -45,6 +46,12 @@ class BASE_EXPORT LockImpl {
   // a successful call to Try, or a call to Lock.
   void Unlock();
 
+  // The number of times, over all the locks of the process, that Lock() found
+  // the lock held and had to wait for it.
+  static int GetContentionCount() {
+    return subtle::NoBarrier_Load(&contention_count_);
+  }
+
   // Return the native underlying lock.
   // TODO(awalker): refactor lock and condition variables so that this is
   // unnecessary.
@@ -53,6 +60,8 @@ class BASE_EXPORT LockImpl {
  private:
   OSLockType os_lock_;
 
+  static subtle::Atomic32 contention_count_;
+
   DISALLOW_COPY_AND_ASSIGN(LockImpl);
 };
 
@@ -11,6 +11,8 @@
 namespace base {
 namespace internal {
 
+subtle::Atomic32 LockImpl::contention_count_ = 0;
+
 LockImpl::LockImpl() {
 #ifndef NDEBUG
   // In debug, setup attributes for lock error checking.
@@ -23,6 +25,14 @@ LockImpl::LockImpl() {
   DCHECK_EQ(rv, 0);
   rv = pthread_mutexattr_destroy(&mta);
   DCHECK_EQ(rv, 0);
+#elif defined(OS_LINUX)
+  // In release, spin for a short while before sleeping on the futex, as most
+  // of our locks are held for a few instructions only.
+  pthread_mutexattr_t mta;
+  pthread_mutexattr_init(&mta);
+  pthread_mutexattr_settype(&mta, PTHREAD_MUTEX_ADAPTIVE_NP);
+  pthread_mutex_init(&os_lock_, &mta);
+  pthread_mutexattr_destroy(&mta);
 #else
   // In release, go with the default lock attributes.
   pthread_mutex_init(&os_lock_, NULL);
@@ -41,6 +51,10 @@ bool LockImpl::Try() {
 }
 
 void LockImpl::Lock() {
+  // Only the contended case pays for the count.
+  if (pthread_mutex_trylock(&os_lock_) == 0)
+    return;
+  subtle::NoBarrier_AtomicIncrement(&contention_count_, 1);
   int rv = pthread_mutex_lock(&os_lock_);
   DCHECK_EQ(rv, 0);
 }
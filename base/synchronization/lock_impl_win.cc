@@ -7,6 +7,8 @@
 namespace base {
 namespace internal {
 
+subtle::Atomic32 LockImpl::contention_count_ = 0;
+
 LockImpl::LockImpl() {
   // The second parameter is the spin count, for short-held locks it avoid the
   // contending thread from going to sleep which helps performance greatly.
@@ -25,6 +27,10 @@ bool LockImpl::Try() {
 }
 
 void LockImpl::Lock() {
+  // Only the contended case pays for the count.
+  if (::TryEnterCriticalSection(&os_lock_) != FALSE)
+    return;
+  subtle::NoBarrier_AtomicIncrement(&contention_count_, 1);
   ::EnterCriticalSection(&os_lock_);
 }
 
@@ -213,4 +213,41 @@ TEST(LockTest, MutexFourThreads) {
   EXPECT_EQ(4 * 40, value);
 }
 
+// Test that a contended Acquire() is counted --------------------------------
+
+class ContendedLockTestThread : public PlatformThread::Delegate {
+ public:
+  explicit ContendedLockTestThread(Lock* lock) : lock_(lock) {}
+
+  virtual void ThreadMain() OVERRIDE {
+    lock_->Acquire();
+    lock_->Release();
+  }
+
+ private:
+  Lock* lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(ContendedLockTestThread);
+};
+
+TEST(LockTest, ContentionCount) {
+  Lock lock;
+  int contentions = Lock::GetContentionCount();
+
+  // Uncontended acquisitions are not counted.
+  lock.Acquire();
+  lock.Release();
+  EXPECT_EQ(contentions, Lock::GetContentionCount());
+
+  lock.Acquire();
+  ContendedLockTestThread thread(&lock);
+  PlatformThreadHandle handle = kNullThreadHandle;
+  ASSERT_TRUE(PlatformThread::Create(0, &thread, &handle));
+  // The thread counts the contention before it blocks on the lock.
+  while (Lock::GetContentionCount() == contentions)
+    PlatformThread::YieldCurrentThread();
+  lock.Release();
+  PlatformThread::Join(handle);
+}
+
 }  // namespace base
@@ -0,0 +1,107 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_SYNCHRONIZATION_RW_LOCK_H_
+#define BASE_SYNCHRONIZATION_RW_LOCK_H_
+#pragma once
+
+#include "build/build_config.h"
+
+#if defined(OS_POSIX)
+#include <pthread.h>
+#endif
+
+#include "base/atomicops.h"
+#include "base/base_export.h"
+#include "base/basictypes.h"
+
+#if defined(OS_WIN)
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#endif
+
+namespace base {
+
+// A reader-writer lock: any number of readers may hold it at once, or a
+// single writer.  Use it for data that is read much more often than it is
+// written, where a Lock would make the readers wait for each other.  For
+// data that is only ever held briefly, a Lock is cheaper.
+//
+// The lock is not recursive, and a reader may not become a writer without
+// releasing the lock first.  Waiting writers keep new readers out, so that
+// a steady stream of readers does not starve them.
+class BASE_EXPORT RWLock {
+ public:
+  RWLock();
+  ~RWLock();
+
+  void ReadAcquire();
+  void ReadRelease();
+
+  void WriteAcquire();
+  void WriteRelease();
+
+  // The number of times, process wide, that acquiring an RWLock had to wait
+  // for another thread.
+  static int GetContentionCount() {
+    return subtle::NoBarrier_Load(&contention_count_);
+  }
+
+ private:
+  static void RecordContention() {
+    subtle::NoBarrier_AtomicIncrement(&contention_count_, 1);
+  }
+
+#if defined(OS_POSIX)
+  pthread_rwlock_t native_handle_;
+#elif defined(OS_WIN)
+  // Slim reader-writer locks need Vista, so this builds one on a Lock.
+  Lock lock_;
+  ConditionVariable readers_cv_;
+  ConditionVariable writer_cv_;
+  int readers_;
+  int waiting_writers_;
+  bool writer_;
+#endif
+
+  static subtle::Atomic32 contention_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(RWLock);
+};
+
+// Holds an RWLock for reading while in scope.
+class AutoReadLock {
+ public:
+  explicit AutoReadLock(RWLock& lock) : lock_(lock) {
+    lock_.ReadAcquire();
+  }
+
+  ~AutoReadLock() {
+    lock_.ReadRelease();
+  }
+
+ private:
+  RWLock& lock_;
+  DISALLOW_COPY_AND_ASSIGN(AutoReadLock);
+};
+
+// Holds an RWLock for writing while in scope.
+class AutoWriteLock {
+ public:
+  explicit AutoWriteLock(RWLock& lock) : lock_(lock) {
+    lock_.WriteAcquire();
+  }
+
+  ~AutoWriteLock() {
+    lock_.WriteRelease();
+  }
+
+ private:
+  RWLock& lock_;
+  DISALLOW_COPY_AND_ASSIGN(AutoWriteLock);
+};
+
+}  // namespace base
+
+#endif  // BASE_SYNCHRONIZATION_RW_LOCK_H_
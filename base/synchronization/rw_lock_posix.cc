@@ -0,0 +1,62 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/rw_lock.h"
+
+#include <errno.h>
+
+#include "base/logging.h"
+
+namespace base {
+
+subtle::Atomic32 RWLock::contention_count_ = 0;
+
+RWLock::RWLock() {
+  pthread_rwlockattr_t attributes;
+  int rv = pthread_rwlockattr_init(&attributes);
+  DCHECK_EQ(rv, 0);
+#if defined(OS_LINUX)
+  // glibc prefers readers by default, which lets them starve the writers.
+  rv = pthread_rwlockattr_setkind_np(
+      &attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+  DCHECK_EQ(rv, 0);
+#endif
+  rv = pthread_rwlock_init(&native_handle_, &attributes);
+  DCHECK_EQ(rv, 0);
+  rv = pthread_rwlockattr_destroy(&attributes);
+  DCHECK_EQ(rv, 0);
+}
+
+RWLock::~RWLock() {
+  int rv = pthread_rwlock_destroy(&native_handle_);
+  DCHECK_EQ(rv, 0);
+}
+
+void RWLock::ReadAcquire() {
+  if (pthread_rwlock_tryrdlock(&native_handle_) == 0)
+    return;
+  RecordContention();
+  int rv = pthread_rwlock_rdlock(&native_handle_);
+  DCHECK_EQ(rv, 0);
+}
+
+void RWLock::ReadRelease() {
+  int rv = pthread_rwlock_unlock(&native_handle_);
+  DCHECK_EQ(rv, 0);
+}
+
+void RWLock::WriteAcquire() {
+  if (pthread_rwlock_trywrlock(&native_handle_) == 0)
+    return;
+  RecordContention();
+  int rv = pthread_rwlock_wrlock(&native_handle_);
+  DCHECK_EQ(rv, 0);
+}
+
+void RWLock::WriteRelease() {
+  int rv = pthread_rwlock_unlock(&native_handle_);
+  DCHECK_EQ(rv, 0);
+}
+
+}  // namespace base
@@ -0,0 +1,146 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/rw_lock.h"
+
+#include "base/compiler_specific.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+// Readers share the lock ------------------------------------------------------
+
+class ReaderThread : public PlatformThread::Delegate {
+ public:
+  ReaderThread(RWLock* lock, WaitableEvent* acquired, WaitableEvent* release)
+      : lock_(lock),
+        acquired_(acquired),
+        release_(release) {
+  }
+
+  virtual void ThreadMain() OVERRIDE {
+    AutoReadLock auto_lock(*lock_);
+    acquired_->Signal();
+    release_->Wait();
+  }
+
+ private:
+  RWLock* lock_;
+  WaitableEvent* acquired_;
+  WaitableEvent* release_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReaderThread);
+};
+
+TEST(RWLockTest, ReadersShare) {
+  RWLock lock;
+  WaitableEvent acquired(false, false);
+  WaitableEvent release(false, false);
+  ReaderThread thread(&lock, &acquired, &release);
+  PlatformThreadHandle handle = kNullThreadHandle;
+  ASSERT_TRUE(PlatformThread::Create(0, &thread, &handle));
+  acquired.Wait();
+
+  // The thread holds the lock for reading; so can we.
+  int contentions = RWLock::GetContentionCount();
+  {
+    AutoReadLock auto_lock(lock);
+  }
+  EXPECT_EQ(contentions, RWLock::GetContentionCount());
+
+  release.Signal();
+  PlatformThread::Join(handle);
+}
+
+// Writers exclude each other and the readers ----------------------------------
+
+class WriterThread : public PlatformThread::Delegate {
+ public:
+  WriterThread(RWLock* lock, int* value) : lock_(lock), value_(value) {}
+
+  // Static helper which can also be called from the main thread.
+  static void DoStuff(RWLock* lock, int* value) {
+    for (int i = 0; i < 40; i++) {
+      {
+        AutoReadLock auto_lock(*lock);
+        int current = *value;
+        PlatformThread::YieldCurrentThread();
+        EXPECT_EQ(current, *value);
+      }
+      AutoWriteLock auto_lock(*lock);
+      int current = *value;
+      PlatformThread::YieldCurrentThread();
+      *value = current + 1;
+    }
+  }
+
+  virtual void ThreadMain() OVERRIDE {
+    DoStuff(lock_, value_);
+  }
+
+ private:
+  RWLock* lock_;
+  int* value_;
+
+  DISALLOW_COPY_AND_ASSIGN(WriterThread);
+};
+
+TEST(RWLockTest, WritersExclude) {
+  RWLock lock;
+  int value = 0;
+
+  WriterThread thread1(&lock, &value);
+  WriterThread thread2(&lock, &value);
+  WriterThread thread3(&lock, &value);
+  PlatformThreadHandle handle1 = kNullThreadHandle;
+  PlatformThreadHandle handle2 = kNullThreadHandle;
+  PlatformThreadHandle handle3 = kNullThreadHandle;
+
+  ASSERT_TRUE(PlatformThread::Create(0, &thread1, &handle1));
+  ASSERT_TRUE(PlatformThread::Create(0, &thread2, &handle2));
+  ASSERT_TRUE(PlatformThread::Create(0, &thread3, &handle3));
+
+  WriterThread::DoStuff(&lock, &value);
+
+  PlatformThread::Join(handle1);
+  PlatformThread::Join(handle2);
+  PlatformThread::Join(handle3);
+
+  EXPECT_EQ(4 * 40, value);
+}
+
+// A reader that waits for a writer is counted ---------------------------------
+
+class BlockedReaderThread : public PlatformThread::Delegate {
+ public:
+  explicit BlockedReaderThread(RWLock* lock) : lock_(lock) {}
+
+  virtual void ThreadMain() OVERRIDE {
+    AutoReadLock auto_lock(*lock_);
+  }
+
+ private:
+  RWLock* lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(BlockedReaderThread);
+};
+
+TEST(RWLockTest, ContentionCount) {
+  RWLock lock;
+  int contentions = RWLock::GetContentionCount();
+
+  lock.WriteAcquire();
+  BlockedReaderThread thread(&lock);
+  PlatformThreadHandle handle = kNullThreadHandle;
+  ASSERT_TRUE(PlatformThread::Create(0, &thread, &handle));
+  // The thread counts the contention before it blocks on the lock.
+  while (RWLock::GetContentionCount() == contentions)
+    PlatformThread::YieldCurrentThread();
+  lock.WriteRelease();
+  PlatformThread::Join(handle);
+}
+
+}  // namespace base
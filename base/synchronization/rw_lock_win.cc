@@ -0,0 +1,67 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/rw_lock.h"
+
+#include "base/logging.h"
+
+namespace base {
+
+subtle::Atomic32 RWLock::contention_count_ = 0;
+
+RWLock::RWLock()
+    : readers_cv_(&lock_),
+      writer_cv_(&lock_),
+      readers_(0),
+      waiting_writers_(0),
+      writer_(false) {
+}
+
+RWLock::~RWLock() {
+  DCHECK_EQ(0, readers_);
+  DCHECK(!writer_);
+}
+
+void RWLock::ReadAcquire() {
+  AutoLock auto_lock(lock_);
+  if (writer_ || waiting_writers_) {
+    RecordContention();
+    do {
+      readers_cv_.Wait();
+    } while (writer_ || waiting_writers_);
+  }
+  ++readers_;
+}
+
+void RWLock::ReadRelease() {
+  AutoLock auto_lock(lock_);
+  DCHECK_GT(readers_, 0);
+  if (--readers_ == 0 && waiting_writers_)
+    writer_cv_.Signal();
+}
+
+void RWLock::WriteAcquire() {
+  AutoLock auto_lock(lock_);
+  if (writer_ || readers_) {
+    RecordContention();
+    ++waiting_writers_;
+    do {
+      writer_cv_.Wait();
+    } while (writer_ || readers_);
+    --waiting_writers_;
+  }
+  writer_ = true;
+}
+
+void RWLock::WriteRelease() {
+  AutoLock auto_lock(lock_);
+  DCHECK(writer_);
+  writer_ = false;
+  if (waiting_writers_)
+    writer_cv_.Signal();
+  else
+    readers_cv_.Broadcast();
+}
+
+}  // namespace base
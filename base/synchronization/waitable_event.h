@@ -15,7 +15,6 @@
 
 #if defined(OS_POSIX)
 #include <list>
-#include <utility>
 #include "base/memory/ref_counted.h"
 #include "base/synchronization/lock.h"
 #endif
@@ -86,7 +85,7 @@ class BASE_EXPORT WaitableEvent {
 #endif
 
   // Wait, synchronously, on multiple events.
-  //   waitables: an array of WaitableEvent pointers
+  //   waitables: an array of distinct WaitableEvent pointers
   //   count: the number of elements in @waitables
   //
   // returns: the index of a WaitableEvent which has been signaled.
@@ -158,16 +157,6 @@ class BASE_EXPORT WaitableEvent {
     ~WaitableEventKernel();
   };
 
-  typedef std::pair<WaitableEvent*, size_t> WaiterAndIndex;
-
-  // When dealing with arrays of WaitableEvent*, we want to sort by the address
-  // of the WaitableEvent in order to have a globally consistent locking order.
-  // In that case we keep them, in sorted order, in an array of pairs where the
-  // second element is the index of the WaitableEvent in the original,
-  // unsorted, array.
-  static size_t EnqueueMany(WaiterAndIndex* waitables,
-                            size_t count, Waiter* waiter);
-
   bool SignalAll();
   bool SignalOne();
   void Enqueue(Waiter* waiter);
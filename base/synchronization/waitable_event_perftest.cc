@@ -0,0 +1,97 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/compiler_specific.h"
+#include "base/memory/scoped_vector.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kWaits = 20000;
+const size_t kEventCounts[] = { 1, 4, 16, 64, 256, 1024 };
+
+// Waits on all the events |waits| times, telling |ack| after each wait.
+class Waiter : public base::PlatformThread::Delegate {
+ public:
+  Waiter(base::WaitableEvent** events, size_t count, int waits,
+         base::WaitableEvent* ack)
+      : events_(events),
+        count_(count),
+        waits_(waits),
+        ack_(ack) {
+  }
+
+  virtual void ThreadMain() OVERRIDE {
+    for (int i = 0; i < waits_; ++i) {
+      base::WaitableEvent::WaitMany(events_, count_);
+      ack_->Signal();
+    }
+  }
+
+ private:
+  base::WaitableEvent** events_;
+  size_t count_;
+  int waits_;
+  base::WaitableEvent* ack_;
+
+  DISALLOW_COPY_AND_ASSIGN(Waiter);
+};
+
+}  // namespace
+
+// Measures WaitMany() when the last of the events is already signaled.
+TEST(WaitableEventPerfTest, WaitManySignaled) {
+  for (size_t i = 0; i < arraysize(kEventCounts); ++i) {
+    size_t count = kEventCounts[i];
+    ScopedVector<base::WaitableEvent> events;
+    for (size_t j = 0; j < count; ++j)
+      events.push_back(new base::WaitableEvent(false, false));
+
+    PerfTimer timer;
+    for (int j = 0; j < kWaits; ++j) {
+      events[count - 1]->Signal();
+      EXPECT_EQ(count - 1,
+                base::WaitableEvent::WaitMany(&events[0], count));
+    }
+    LogPerfResult(
+        base::StringPrintf("WaitableEvent_WaitMany_signaled_%d",
+                           static_cast<int>(count)).c_str(),
+        timer.Elapsed().InMicroseconds() / static_cast<double>(kWaits), "us");
+  }
+}
+
+// Measures a round trip through a thread blocked in WaitMany(), woken by the
+// last of the events.
+TEST(WaitableEventPerfTest, WaitManyWoken) {
+  for (size_t i = 0; i < arraysize(kEventCounts); ++i) {
+    size_t count = kEventCounts[i];
+    ScopedVector<base::WaitableEvent> events;
+    for (size_t j = 0; j < count; ++j)
+      events.push_back(new base::WaitableEvent(false, false));
+    base::WaitableEvent ack(false, false);
+
+    // Fewer round trips, as each one switches threads twice.
+    const int waits = kWaits / 10;
+    Waiter waiter(&events[0], count, waits, &ack);
+    base::PlatformThreadHandle handle;
+    ASSERT_TRUE(base::PlatformThread::Create(0, &waiter, &handle));
+
+    PerfTimer timer;
+    for (int j = 0; j < waits; ++j) {
+      events[count - 1]->Signal();
+      ack.Wait();
+    }
+    LogPerfResult(
+        base::StringPrintf("WaitableEvent_WaitMany_woken_%d",
+                           static_cast<int>(count)).c_str(),
+        timer.Elapsed().InMicroseconds() / static_cast<double>(waits), "us");
+    base::PlatformThread::Join(handle);
+  }
+}
@@ -2,13 +2,11 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include <algorithm>
-#include <vector>
-
 #include "base/logging.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/synchronization/condition_variable.h"
 #include "base/synchronization/lock.h"
+#include "base/threading/scoped_may_block.h"
 #include "base/threading/thread_restrictions.h"
 
 // -----------------------------------------------------------------------------
@@ -174,6 +172,17 @@ bool WaitableEvent::TimedWait(const TimeDelta& max_time) {
     return true;
   }
 
+  // A poll of an event that isn't signaled doesn't wait.
+  if (max_time.ToInternalValue() == 0) {
+    kernel_->lock_.Release();
+    return false;
+  }
+
+  // Let a thread pool that owns this thread bring in another one meanwhile.
+  // The pool may start a thread, so this is done before taking the
+  // SyncWaiter lock, which a thread signaling the event waits for.
+  ScopedMayBlock may_block;
+
   SyncWaiter sw;
   sw.lock()->Acquire();
 
@@ -215,123 +224,81 @@ bool WaitableEvent::TimedWait(const TimeDelta& max_time) {
 
 // -----------------------------------------------------------------------------
 // Synchronous waiting on multiple objects.
-
-static bool  // StrictWeakOrdering
-cmp_fst_addr(const std::pair<WaitableEvent*, unsigned> &a,
-             const std::pair<WaitableEvent*, unsigned> &b) {
-  return a.first < b.first;
-}
+//
+// The SyncWaiter is enqueued on each event in turn, holding only that event's
+// lock, so there is no need for a global locking order. An event found
+// signaled on the way is claimed by disabling the waiter under its lock: if
+// one of the events already visited has fired the waiter first, that one wins
+// and the signal of the later event is left alone. Either way, a signal that
+// the waiter rejected stays on its event, as in TimedWait.
+// -----------------------------------------------------------------------------
 
 // static
-size_t WaitableEvent::WaitMany(WaitableEvent** raw_waitables,
+size_t WaitableEvent::WaitMany(WaitableEvent** waitables,
                                size_t count) {
   base::ThreadRestrictions::AssertWaitAllowed();
   DCHECK(count) << "Cannot wait on no events";
 
-  // We need to acquire the locks in a globally consistent order. Thus we sort
-  // the array of waitables by address. We actually sort a pairs so that we can
-  // map back to the original index values later.
-  std::vector<std::pair<WaitableEvent*, size_t> > waitables;
-  waitables.reserve(count);
-  for (size_t i = 0; i < count; ++i)
-    waitables.push_back(std::make_pair(raw_waitables[i], i));
-
-  DCHECK_EQ(count, waitables.size());
-
-  sort(waitables.begin(), waitables.end(), cmp_fst_addr);
-
-  // The set of waitables must be distinct. Since we have just sorted by
-  // address, we can check this cheaply by comparing pairs of consecutive
-  // elements.
-  for (size_t i = 0; i < waitables.size() - 1; ++i) {
-    DCHECK(waitables[i].first != waitables[i+1].first);
+  // Most waits find an event already signaled, and need no waiter.
+  for (size_t i = 0; i < count; ++i) {
+    WaitableEventKernel* kernel = waitables[i]->kernel_;
+    base::AutoLock locked(kernel->lock_);
+    if (kernel->signaled_) {
+      if (!kernel->manual_reset_)
+        kernel->signaled_ = false;
+      return i;
+    }
   }
 
   SyncWaiter sw;
-
-  const size_t r = EnqueueMany(&waitables[0], count, &sw);
-  if (r) {
-    // One of the events is already signaled. The SyncWaiter has not been
-    // enqueued anywhere. EnqueueMany returns the count of remaining waitables
-    // when the signaled one was seen, so the index of the signaled event is
-    // @count - @r.
-    return waitables[count - r].second;
-  }
-
-  // At this point, we hold the locks on all the WaitableEvents and we have
-  // enqueued our waiter in them all.
-  sw.lock()->Acquire();
-    // Release the WaitableEvent locks in the reverse order
-    for (size_t i = 0; i < count; ++i) {
-      waitables[count - (1 + i)].first->kernel_->lock_.Release();
+  // The index of the event claimed while enqueuing, or |count|.
+  size_t claimed_index = count;
+  // The number of events the SyncWaiter was enqueued on.
+  size_t enqueued = 0;
+  bool fired = false;
+
+  for (; enqueued < count; ++enqueued) {
+    WaitableEventKernel* kernel = waitables[enqueued]->kernel_;
+    base::AutoLock locked(kernel->lock_);
+    if (kernel->signaled_) {
+      base::AutoLock waiter_locked(*sw.lock());
+      if (!sw.fired()) {
+        sw.Disable();
+        claimed_index = enqueued;
+        if (!kernel->manual_reset_)
+          kernel->signaled_ = false;
+      }
+      fired = true;
+      break;
     }
+    waitables[enqueued]->Enqueue(&sw);
+  }
 
-    for (;;) {
-      if (sw.fired())
-        break;
-
+  if (!fired) {
+    base::AutoLock waiter_locked(*sw.lock());
+    while (!sw.fired())
       sw.cv()->Wait();
-    }
-  sw.lock()->Release();
-
-  // The address of the WaitableEvent which fired is stored in the SyncWaiter.
-  WaitableEvent *const signaled_event = sw.signaling_event();
-  // This will store the index of the raw_waitables which fired.
-  size_t signaled_index = 0;
+  }
 
-  // Take the locks of each WaitableEvent in turn (except the signaled one) and
-  // remove our SyncWaiter from the wait-list
-  for (size_t i = 0; i < count; ++i) {
-    if (raw_waitables[i] != signaled_event) {
-      raw_waitables[i]->kernel_->lock_.Acquire();
-        // There's no possible ABA issue with the address of the SyncWaiter here
-        // because it lives on the stack. Thus the tag value is just the pointer
-        // value again.
-        raw_waitables[i]->kernel_->Dequeue(&sw, &sw);
-      raw_waitables[i]->kernel_->lock_.Release();
-    } else {
+  // Take the locks of each WaitableEvent in turn (except the signaled one,
+  // which has already dropped the SyncWaiter) and remove our SyncWaiter from
+  // the wait-list. There's no possible ABA issue with the address of the
+  // SyncWaiter here because it lives on the stack. Thus the tag value is just
+  // the pointer value again.
+  size_t signaled_index = claimed_index;
+  for (size_t i = 0; i < enqueued; ++i) {
+    if (claimed_index == count && waitables[i] == sw.signaling_event()) {
       signaled_index = i;
+      continue;
     }
+    base::AutoLock locked(waitables[i]->kernel_->lock_);
+    waitables[i]->kernel_->Dequeue(&sw, &sw);
   }
 
+  DCHECK_LT(signaled_index, count);
   return signaled_index;
 }
 
-// -----------------------------------------------------------------------------
-// If return value == 0:
-//   The locks of the WaitableEvents have been taken in order and the Waiter has
-//   been enqueued in the wait-list of each. None of the WaitableEvents are
-//   currently signaled
-// else:
-//   None of the WaitableEvent locks are held. The Waiter has not been enqueued
-//   in any of them and the return value is the index of the first WaitableEvent
-//   which was signaled, from the end of the array.
-// -----------------------------------------------------------------------------
-// static
-size_t WaitableEvent::EnqueueMany
-    (std::pair<WaitableEvent*, size_t>* waitables,
-     size_t count, Waiter* waiter) {
-  if (!count)
-    return 0;
-
-  waitables[0].first->kernel_->lock_.Acquire();
-    if (waitables[0].first->kernel_->signaled_) {
-      if (!waitables[0].first->kernel_->manual_reset_)
-        waitables[0].first->kernel_->signaled_ = false;
-      waitables[0].first->kernel_->lock_.Release();
-      return count;
-    }
-
-    const size_t r = EnqueueMany(waitables + 1, count - 1, waiter);
-    if (r) {
-      waitables[0].first->kernel_->lock_.Release();
-    } else {
-      waitables[0].first->Enqueue(waiter);
-    }
-
-    return r;
-}
-
 // -----------------------------------------------------------------------------
 
 
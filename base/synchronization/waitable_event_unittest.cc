@@ -105,4 +105,21 @@ TEST(WaitableEventTest, WaitMany) {
     delete ev[i];
 }
 
+// WaitMany() resets only the auto-reset event it returns.
+TEST(WaitableEventTest, WaitManyKeepsOtherSignals) {
+  WaitableEvent manual(true, false);
+  WaitableEvent first(false, false);
+  WaitableEvent second(false, false);
+  WaitableEvent* ev[] = { &manual, &first, &second };
+
+  first.Signal();
+  second.Signal();
+  EXPECT_EQ(1u, WaitableEvent::WaitMany(ev, 3));
+  EXPECT_EQ(2u, WaitableEvent::WaitMany(ev, 3));
+
+  manual.Signal();
+  EXPECT_EQ(0u, WaitableEvent::WaitMany(ev, 3));
+  EXPECT_TRUE(manual.IsSignaled());
+}
+
 }  // namespace base
@@ -0,0 +1,194 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_CHAIN_H_
+#define BASE_TASK_CHAIN_H_
+#pragma once
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/task_runner.h"
+
+namespace base {
+
+namespace internal {
+
+// Keeps the validity of a WeakPtr<T> of any T without remembering the pointer.
+class WeakGuard : public WeakPtrBase {
+ public:
+  WeakGuard() {}
+  template <typename T>
+  explicit WeakGuard(const WeakPtr<T>& ptr) : WeakPtrBase(ptr) {}
+
+  bool is_valid() const { return ref_.is_valid(); }
+};
+
+}  // namespace internal
+
+// TaskChain runs a sequence of steps, each on a TaskRunner of its own, that
+// all work on one |State| object.  It replaces pipelines of nested
+// PostTaskAndReply() calls, which allocate a relay and two closures for every
+// hop, with a stackless coroutine: |State| plays the part of the coroutine
+// frame and each step is a resumption point.
+//
+// A chain makes a fixed number of allocations when it is built, no matter how
+// many steps it has beyond the Callbacks the caller binds for them, and none
+// at all as it moves from one step to the next.
+//
+// EXAMPLE:
+//
+//   struct UploadState {
+//     FilePath path;
+//     std::string contents;
+//     scoped_refptr<Image> image;
+//   };
+//
+//   TaskChain<UploadState> chain;
+//   chain.state()->path = path;
+//   chain.Then(file_runner, Bind(&ReadFileStep))
+//        .Then(decode_runner, Bind(&DecodeStep))
+//        .Then(MessageLoopProxy::current(), &Uploader::OnDecoded,
+//              weak_factory_.GetWeakPtr());
+//   chain.Start(FROM_HERE);
+//
+// Steps run strictly one after the other, so a step never races with another
+// step over |State|.  The chain stops early if a step's TaskRunner refuses the
+// task, or when a step bound to a WeakPtr comes up after its object has gone
+// away, which is how a chain is canceled.  |State| is destroyed on the thread
+// that ran the last step, or the one that found the chain canceled.  Like
+// PostTaskAndReply(), a chain whose task is deleted unrun by a shutting down
+// TaskRunner is leaked.
+template <typename State>
+class TaskChain {
+ public:
+  typedef Callback<void(State*)> Step;
+
+  TaskChain() : core_(new Core) {}
+
+  // A chain that was never started is simply dropped.
+  ~TaskChain() {}
+
+  // The state the steps will work on, for setting up before Start().
+  State* state() {
+    DCHECK(core_);
+    return &core_->state_;
+  }
+
+  // Appends |step|, to be run on |task_runner| once the previous steps have
+  // finished.
+  TaskChain& Then(TaskRunner* task_runner, const Step& step) {
+    DCHECK(core_) << "The chain was already started";
+    DCHECK(task_runner);
+    DCHECK(!step.is_null());
+    core_->steps_.push_back(StepInfo(task_runner, step));
+    return *this;
+  }
+
+  // Appends a step that calls |method| on |object|, or cancels the rest of the
+  // chain if |object| is gone by then.  |object| is tested when the step
+  // comes up, so |task_runner| must run on the thread |object| lives on.
+  template <typename T>
+  TaskChain& Then(TaskRunner* task_runner,
+                  void (T::*method)(State*),
+                  const WeakPtr<T>& object) {
+    Then(task_runner, Bind(method, object));
+    core_->steps_.back().guard = internal::WeakGuard(object);
+    core_->steps_.back().guarded = true;
+    return *this;
+  }
+
+  // Posts the first step.  Returns false if that could not be done, in which
+  // case no step runs.  The TaskChain object may be destroyed right away.
+  bool Start(const tracked_objects::Location& from_here) {
+    DCHECK(core_) << "The chain was already started";
+    scoped_refptr<Core> core;
+    core.swap(core_);
+    if (core->steps_.empty())
+      return true;
+    return core->Start(from_here);
+  }
+
+ private:
+  struct StepInfo {
+    StepInfo(TaskRunner* task_runner, const Step& step)
+        : task_runner(task_runner),
+          step(step),
+          guarded(false) {
+    }
+
+    scoped_refptr<TaskRunner> task_runner;
+    Step step;
+    internal::WeakGuard guard;
+    bool guarded;
+  };
+
+  class Core : public RefCountedThreadSafe<Core> {
+   public:
+    Core() : next_step_(0) {}
+
+    bool Start(const tracked_objects::Location& from_here) {
+      from_here_ = from_here;
+      // Every hop posts this same closure, so moving along the chain only
+      // touches its reference count.  It keeps |this| alive until Finish().
+      run_next_step_ = Bind(&Core::RunNextStep, this);
+      if (steps_[0].task_runner->PostTask(from_here_, run_next_step_))
+        return true;
+      Finish();
+      return false;
+    }
+
+    void RunNextStep() {
+      const StepInfo& info = steps_[next_step_];
+      DCHECK(info.task_runner->RunsTasksOnCurrentThread());
+      if (info.guarded && !info.guard.is_valid()) {
+        Finish();
+        return;
+      }
+      info.step.Run(&state_);
+
+      if (++next_step_ == steps_.size() ||
+          !steps_[next_step_].task_runner->PostTask(from_here_,
+                                                    run_next_step_)) {
+        Finish();
+      }
+    }
+
+   private:
+    friend class TaskChain;
+    friend class RefCountedThreadSafe<Core>;
+
+    ~Core() {}
+
+    // Drops the reference cycle through |run_next_step_|.  The task that is
+    // running, if any, still holds a reference until it returns.
+    void Finish() {
+      steps_.clear();
+      run_next_step_.Reset();
+    }
+
+    std::vector<StepInfo> steps_;
+    size_t next_step_;
+    State state_;
+    tracked_objects::Location from_here_;
+    Closure run_next_step_;
+
+    DISALLOW_COPY_AND_ASSIGN(Core);
+  };
+
+  // NULL once the chain has been started.
+  scoped_refptr<Core> core_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskChain);
+};
+
+}  // namespace base
+
+#endif  // BASE_TASK_CHAIN_H_
@@ -0,0 +1,167 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task_chain.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/memory/weak_ptr.h"
+#include "base/message_loop.h"
+#include "base/message_loop_proxy.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+struct RecordingState {
+  RecordingState() : destroyed(NULL) {}
+  ~RecordingState() {
+    if (destroyed)
+      *destroyed = true;
+  }
+
+  std::vector<int> steps;
+  std::vector<PlatformThreadId> threads;
+  bool* destroyed;
+};
+
+void RecordStep(int id, RecordingState* state) {
+  state->steps.push_back(id);
+  state->threads.push_back(PlatformThread::CurrentId());
+}
+
+void QuitCurrentLoop(RecordingState* state) {
+  MessageLoop::current()->Quit();
+}
+
+void CopyAndQuit(RecordingState* result, RecordingState* state) {
+  result->steps = state->steps;
+  result->threads = state->threads;
+  MessageLoop::current()->Quit();
+}
+
+class Receiver : public SupportsWeakPtr<Receiver> {
+ public:
+  Receiver() : calls_(0) {}
+
+  void OnStep(RecordingState* state) {
+    ++calls_;
+    MessageLoop::current()->Quit();
+  }
+
+  int calls() const { return calls_; }
+
+ private:
+  int calls_;
+};
+
+class TaskChainTest : public testing::Test {
+ protected:
+  TaskChainTest()
+      : first_thread_("TaskChainTestFirst"),
+        second_thread_("TaskChainTestSecond") {
+  }
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(first_thread_.Start());
+    ASSERT_TRUE(second_thread_.Start());
+  }
+
+  TaskRunner* first_runner() {
+    return first_thread_.message_loop_proxy();
+  }
+  TaskRunner* second_runner() {
+    return second_thread_.message_loop_proxy();
+  }
+  TaskRunner* main_runner() {
+    return loop_.message_loop_proxy();
+  }
+
+  MessageLoop loop_;
+  Thread first_thread_;
+  Thread second_thread_;
+};
+
+}  // namespace
+
+TEST_F(TaskChainTest, RunsStepsInOrderOnTheirRunners) {
+  bool destroyed = false;
+  RecordingState result;
+  {
+    TaskChain<RecordingState> chain;
+    chain.state()->destroyed = &destroyed;
+    chain.Then(first_runner(), Bind(&RecordStep, 1))
+         .Then(second_runner(), Bind(&RecordStep, 2))
+         .Then(first_runner(), Bind(&RecordStep, 3))
+         .Then(main_runner(), Bind(&RecordStep, 4))
+         .Then(main_runner(), Bind(&CopyAndQuit, &result));
+    EXPECT_TRUE(chain.Start(FROM_HERE));
+  }
+  loop_.Run();
+  EXPECT_TRUE(destroyed);
+
+  ASSERT_EQ(4u, result.steps.size());
+  for (int i = 0; i < 4; ++i)
+    EXPECT_EQ(i + 1, result.steps[i]);
+  EXPECT_EQ(first_thread_.thread_id(), result.threads[0]);
+  EXPECT_EQ(second_thread_.thread_id(), result.threads[1]);
+  EXPECT_EQ(first_thread_.thread_id(), result.threads[2]);
+  EXPECT_EQ(PlatformThread::CurrentId(), result.threads[3]);
+}
+
+TEST_F(TaskChainTest, WeakPtrStep) {
+  Receiver receiver;
+  TaskChain<RecordingState> chain;
+  chain.Then(first_runner(), Bind(&RecordStep, 1))
+       .Then(main_runner(), &Receiver::OnStep, receiver.AsWeakPtr());
+  EXPECT_TRUE(chain.Start(FROM_HERE));
+  loop_.Run();
+  EXPECT_EQ(1, receiver.calls());
+}
+
+TEST_F(TaskChainTest, InvalidatedWeakPtrCancelsRest) {
+  bool destroyed = false;
+  scoped_ptr<Receiver> receiver(new Receiver);
+  {
+    TaskChain<RecordingState> chain;
+    chain.state()->destroyed = &destroyed;
+    chain.Then(main_runner(), &Receiver::OnStep, receiver->AsWeakPtr())
+         .Then(main_runner(), Bind(&QuitCurrentLoop));
+    EXPECT_TRUE(chain.Start(FROM_HERE));
+  }
+  receiver.reset();
+  loop_.RunAllPending();
+  EXPECT_TRUE(destroyed);
+}
+
+TEST_F(TaskChainTest, UnstartedChainRunsNothing) {
+  bool destroyed = false;
+  {
+    TaskChain<RecordingState> chain;
+    chain.state()->destroyed = &destroyed;
+    chain.Then(main_runner(), Bind(&QuitCurrentLoop));
+  }
+  EXPECT_TRUE(destroyed);
+  loop_.RunAllPending();
+}
+
+TEST_F(TaskChainTest, RefusedPostStopsChain) {
+  bool destroyed = false;
+  scoped_refptr<MessageLoopProxy> stopped_runner =
+      second_thread_.message_loop_proxy();
+  second_thread_.Stop();
+  {
+    TaskChain<RecordingState> chain;
+    chain.state()->destroyed = &destroyed;
+    chain.Then(stopped_runner, Bind(&RecordStep, 1));
+    EXPECT_FALSE(chain.Start(FROM_HERE));
+  }
+  EXPECT_TRUE(destroyed);
+}
+
+}  // namespace base
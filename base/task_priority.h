@@ -0,0 +1,27 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_PRIORITY_H_
+#define BASE_TASK_PRIORITY_H_
+#pragma once
+
+namespace base {
+
+// The lanes of a MessageLoop, from the most to the least urgent.  See
+// MessageLoop::PostTaskWithPriority().
+enum TaskPriority {
+  // Handling of user input, such as held or synthesized mouse moves.
+  TASK_PRIORITY_INPUT,
+  // Producing the next frame.
+  TASK_PRIORITY_DISPLAY,
+  // Everything posted with PostTask() and friends.
+  TASK_PRIORITY_NORMAL,
+  // Bookkeeping that runs only when the loop has nothing else to do.
+  TASK_PRIORITY_IDLE,
+  TASK_PRIORITY_COUNT
+};
+
+}  // namespace base
+
+#endif  // BASE_TASK_PRIORITY_H_
@@ -6,6 +6,8 @@
 #define BASE_TASK_RUNNER_H_
 #pragma once
 
+#include <vector>
+
 #include "base/base_export.h"
 #include "base/basictypes.h"
 #include "base/callback_forward.h"
@@ -81,6 +83,17 @@ class BASE_EXPORT TaskRunner
                                const Closure& task,
                                base::TimeDelta delay) = 0;
 
+  // Posts each of |tasks| as if by PostTask(), in order.  Returns true
+  // if all of the tasks may be run at some point in the future, and
+  // false if at least one of them definitely will not be run.
+  //
+  // The default implementation calls PostTask() for each task.
+  // Implementations should override it if they can do better for a
+  // burst of tasks, e.g. by taking a lock once and waking up the
+  // target thread at most once.
+  virtual bool PostTasks(const tracked_objects::Location& from_here,
+                         const std::vector<Closure>& tasks);
+
   // Returns true if the current thread is a thread on which a task
   // may be run, and false if no task will be run on the current
   // thread.
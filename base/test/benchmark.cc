@@ -0,0 +1,262 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/test/benchmark.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "base/allocator/allocator_extension.h"
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/stringprintf.h"
+#include "base/values.h"
+
+#if defined(OS_POSIX) && !defined(OS_MACOSX)
+#include <time.h>
+#endif
+
+namespace base {
+
+namespace {
+
+// Keeps the iterations of a sample countable when the body does nothing.
+const int kMaxIterationsPerSample = 1 << 30;
+
+// The two-sided 95% quantiles of Student's t distribution for 1 to 30
+// degrees of freedom; the normal quantile is used beyond.
+const double kStudentT95[] = {
+  12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+  2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+  2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+};
+const double kNormal95 = 1.960;
+
+LazyInstance<BenchmarkReporter>::Leaky g_reporter = LAZY_INSTANCE_INITIALIZER;
+
+// Allocations seen by the hooks while a benchmark samples.
+subtle::Atomic32 g_allocation_count = 0;
+
+void CountAllocation(void* ptr, size_t size) {
+  subtle::NoBarrier_AtomicIncrement(&g_allocation_count, 1);
+}
+
+void IgnoreFree(void* ptr) {
+}
+
+// Starts counting allocations, unless someone else hooks the allocator.
+bool StartCountingAllocations() {
+  if (allocator::thunks::GetAllocationHook())
+    return false;
+  subtle::NoBarrier_Store(&g_allocation_count, 0);
+  allocator::SetAllocationHooks(&CountAllocation, &IgnoreFree);
+  return true;
+}
+
+int StopCountingAllocations() {
+  allocator::SetAllocationHooks(NULL, NULL);
+  return subtle::NoBarrier_Load(&g_allocation_count);
+}
+
+// Sets |cpu_time| to the CPU time the calling thread used.  Returns false
+// where that can't be measured.
+bool GetThreadCpuTime(TimeDelta* cpu_time) {
+#if defined(OS_POSIX) && !defined(OS_MACOSX)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    return false;
+  *cpu_time = TimeDelta::FromMicroseconds(
+      static_cast<int64>(ts.tv_sec) * Time::kMicrosecondsPerSecond +
+      ts.tv_nsec / Time::kNanosecondsPerMicrosecond);
+  return true;
+#else
+  return false;
+#endif
+}
+
+double NanosecondsPerIteration(TimeDelta elapsed, int64 iterations) {
+  return elapsed.InMicroseconds() * 1000.0 / iterations;
+}
+
+void RunIterations(const Closure& iteration, int iterations) {
+  for (int i = 0; i < iterations; ++i)
+    iteration.Run();
+}
+
+}  // namespace
+
+BenchmarkOptions::BenchmarkOptions()
+    : warmup_time(TimeDelta::FromMilliseconds(100)),
+      min_sample_time(TimeDelta::FromMilliseconds(1)),
+      min_samples(10),
+      max_samples(1000),
+      max_time(TimeDelta::FromSeconds(5)),
+      target_relative_error(0.01) {
+}
+
+BenchmarkResult::BenchmarkResult()
+    : iterations_per_sample(0),
+      samples(0),
+      min_ns(0),
+      median_ns(0),
+      mean_ns(0),
+      p99_ns(0),
+      max_ns(0),
+      ci95_ns(0),
+      cpu_ns(-1),
+      allocations(-1),
+      converged(false) {
+}
+
+BenchmarkResult::~BenchmarkResult() {
+}
+
+DictionaryValue* BenchmarkResult::ToValue() const {
+  DictionaryValue* value = new DictionaryValue;
+  value->SetString("name", name);
+  value->SetInteger("iterations_per_sample", iterations_per_sample);
+  value->SetInteger("samples", samples);
+  value->SetDouble("min_ns", min_ns);
+  value->SetDouble("median_ns", median_ns);
+  value->SetDouble("mean_ns", mean_ns);
+  value->SetDouble("p99_ns", p99_ns);
+  value->SetDouble("max_ns", max_ns);
+  value->SetDouble("ci95_ns", ci95_ns);
+  value->SetDouble("cpu_ns", cpu_ns);
+  value->SetDouble("allocations", allocations);
+  value->SetBoolean("converged", converged);
+  return value;
+}
+
+std::string BenchmarkResult::ToString() const {
+  std::string text = StringPrintf(
+      "%s: median %.1f ns, min %.1f ns, p99 %.1f ns, mean %.1f +- %.1f ns "
+      "(%d samples of %d)",
+      name.c_str(), median_ns, min_ns, p99_ns, mean_ns, ci95_ns, samples,
+      iterations_per_sample);
+  if (cpu_ns >= 0)
+    StringAppendF(&text, ", cpu %.1f ns", cpu_ns);
+  if (allocations >= 0)
+    StringAppendF(&text, ", %.2f allocations", allocations);
+  if (!converged)
+    text.append(", not converged");
+  return text;
+}
+
+BenchmarkResult RunBenchmarkBatches(const std::string& name,
+                                    const BenchmarkBatchCallback& batch,
+                                    const BenchmarkOptions& options) {
+  DCHECK_GT(options.min_samples, 0);
+  DCHECK_GE(options.max_samples, options.min_samples);
+
+  // Warm up, doubling the iterations until a sample lasts long enough.
+  int iterations = 1;
+  TimeTicks warmup_end = TimeTicks::HighResNow() + options.warmup_time;
+  for (;;) {
+    TimeTicks start = TimeTicks::HighResNow();
+    batch.Run(iterations);
+    TimeTicks end = TimeTicks::HighResNow();
+    if (end - start < options.min_sample_time &&
+        iterations < kMaxIterationsPerSample) {
+      iterations *= 2;
+    } else if (end >= warmup_end) {
+      break;
+    }
+  }
+
+  BenchmarkResult result;
+  result.name = name;
+  result.iterations_per_sample = iterations;
+
+  std::vector<double> sample_ns;
+  bool counting_allocations = StartCountingAllocations();
+  TimeDelta cpu_start;
+  bool has_cpu_time = GetThreadCpuTime(&cpu_start);
+  TimeTicks sampling_start = TimeTicks::HighResNow();
+  while (static_cast<int>(sample_ns.size()) < options.max_samples) {
+    TimeTicks start = TimeTicks::HighResNow();
+    batch.Run(iterations);
+    TimeTicks end = TimeTicks::HighResNow();
+    sample_ns.push_back(NanosecondsPerIteration(end - start, iterations));
+
+    if (static_cast<int>(sample_ns.size()) >= options.min_samples) {
+      ComputeBenchmarkStatistics(sample_ns, &result);
+      if (result.ci95_ns <= options.target_relative_error * result.mean_ns) {
+        result.converged = true;
+        break;
+      }
+    }
+    if (end - sampling_start >= options.max_time)
+      break;
+  }
+  TimeDelta cpu_end;
+  has_cpu_time = has_cpu_time && GetThreadCpuTime(&cpu_end);
+  int allocation_count =
+      counting_allocations ? StopCountingAllocations() : -1;
+
+  ComputeBenchmarkStatistics(sample_ns, &result);
+  int64 total_iterations = static_cast<int64>(iterations) * sample_ns.size();
+  if (has_cpu_time) {
+    result.cpu_ns =
+        NanosecondsPerIteration(cpu_end - cpu_start, total_iterations);
+  }
+  if (allocation_count >= 0)
+    result.allocations = static_cast<double>(allocation_count) /
+                         total_iterations;
+
+  if (!g_reporter.Get().is_null())
+    g_reporter.Get().Run(result);
+  return result;
+}
+
+BenchmarkResult RunBenchmark(const std::string& name,
+                             const Closure& iteration,
+                             const BenchmarkOptions& options) {
+  return RunBenchmarkBatches(name, Bind(&RunIterations, iteration), options);
+}
+
+void ComputeBenchmarkStatistics(const std::vector<double>& sample_ns,
+                                BenchmarkResult* result) {
+  size_t count = sample_ns.size();
+  result->samples = static_cast<int>(count);
+  if (!count)
+    return;
+
+  std::vector<double> sorted(sample_ns);
+  std::sort(sorted.begin(), sorted.end());
+  result->min_ns = sorted.front();
+  result->max_ns = sorted.back();
+  result->median_ns = count % 2 ? sorted[count / 2] :
+      (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+  // The nearest rank: the smallest sample that at least 99% of the samples
+  // are at most.
+  size_t p99_rank = static_cast<size_t>(ceil(count * 0.99));
+  result->p99_ns = sorted[std::max<size_t>(p99_rank, 1) - 1];
+
+  double sum = 0;
+  for (size_t i = 0; i < count; ++i)
+    sum += sorted[i];
+  result->mean_ns = sum / count;
+
+  result->ci95_ns = 0;
+  if (count > 1) {
+    double squares = 0;
+    for (size_t i = 0; i < count; ++i)
+      squares += (sorted[i] - result->mean_ns) * (sorted[i] - result->mean_ns);
+    double standard_error = sqrt(squares / (count - 1) / count);
+    size_t degrees = count - 1;
+    double t = degrees <= arraysize(kStudentT95) ?
+        kStudentT95[degrees - 1] : kNormal95;
+    result->ci95_ns = t * standard_error;
+  }
+}
+
+void SetBenchmarkReporter(const BenchmarkReporter& reporter) {
+  g_reporter.Get() = reporter;
+}
+
+}  // namespace base
@@ -0,0 +1,115 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A harness for microbenchmarks, so that perftests share one way of getting
+// numbers that can be trusted instead of each timing its own loop once.
+//
+// RunBenchmark() first runs the body for a warmup period, growing the number
+// of iterations timed together (a sample) until a sample lasts long enough
+// for the clock.  It then takes samples until the 95% confidence interval of
+// the mean time per iteration is within a fraction of the mean, or until it
+// runs out of samples or time.  It reports the minimum, median, 99th
+// percentile and maximum time per iteration over the samples, the CPU time
+// of the thread and the allocations per iteration.
+//
+// The results go to the reporter set with SetBenchmarkReporter(), if any.
+// PerfTestSuite sets one that logs them to the perf log and, given
+// --benchmark-json=<file>, writes them all to <file> as JSON, which
+// tools/perf/compare_benchmarks.py compares between two runs.
+//
+// EXAMPLE:
+//
+//   TEST(StringPerfTest, Append) {
+//     RunBenchmark("string_append", base::Bind(&AppendOnce),
+//                  base::BenchmarkOptions());
+//   }
+
+#ifndef BASE_TEST_BENCHMARK_H_
+#define BASE_TEST_BENCHMARK_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/time.h"
+
+namespace base {
+
+class DictionaryValue;
+
+struct BenchmarkOptions {
+  BenchmarkOptions();
+
+  // How long to run the body before taking samples.
+  TimeDelta warmup_time;
+  // Each sample runs as many iterations as take at least this long.
+  TimeDelta min_sample_time;
+  int min_samples;
+  int max_samples;
+  // How long to take samples for at most.
+  TimeDelta max_time;
+  // Sampling stops once the half-width of the 95% confidence interval of
+  // the mean is at most this fraction of the mean.
+  double target_relative_error;
+};
+
+struct BenchmarkResult {
+  BenchmarkResult();
+  ~BenchmarkResult();
+
+  // Returns the result as a dictionary, with the members below as keys.
+  DictionaryValue* ToValue() const;
+
+  // Returns the result as one line of text.
+  std::string ToString() const;
+
+  std::string name;
+  int iterations_per_sample;
+  int samples;
+  // Wall time per iteration, in nanoseconds, over the samples.
+  double min_ns;
+  double median_ns;
+  double mean_ns;
+  double p99_ns;
+  double max_ns;
+  // The half-width of the 95% confidence interval of |mean_ns|.
+  double ci95_ns;
+  // CPU time of the thread per iteration, or -1 where it isn't measured.
+  double cpu_ns;
+  // Allocations per iteration, or -1 where they aren't counted.  Only
+  // allocations through the allocator shim (base/allocator) are counted.
+  double allocations;
+  // Whether |ci95_ns| reached the target before the limits.
+  bool converged;
+};
+
+// Runs the body of the benchmark |iterations| times.
+typedef Callback<void(int iterations)> BenchmarkBatchCallback;
+
+// Measures |batch|, reports the result and returns it.  Use this form when
+// the loop overhead of calling a closure per iteration would matter.
+BenchmarkResult RunBenchmarkBatches(const std::string& name,
+                                    const BenchmarkBatchCallback& batch,
+                                    const BenchmarkOptions& options);
+
+// Measures |iteration|, which runs the body once.
+BenchmarkResult RunBenchmark(const std::string& name,
+                             const Closure& iteration,
+                             const BenchmarkOptions& options);
+
+// Fills in the statistics of |result| from the time per iteration of each
+// sample, in nanoseconds.
+void ComputeBenchmarkStatistics(const std::vector<double>& sample_ns,
+                                BenchmarkResult* result);
+
+// Sets the callback that receives every result, replacing any earlier one.
+// A null callback removes it.
+typedef Callback<void(const BenchmarkResult&)> BenchmarkReporter;
+void SetBenchmarkReporter(const BenchmarkReporter& reporter);
+
+}  // namespace base
+
+#endif  // BASE_TEST_BENCHMARK_H_
@@ -0,0 +1,119 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/test/benchmark.h"
+
+#include <math.h>
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Options that keep the tests quick.
+BenchmarkOptions QuickOptions() {
+  BenchmarkOptions options;
+  options.warmup_time = TimeDelta::FromMilliseconds(5);
+  options.min_sample_time = TimeDelta::FromMicroseconds(200);
+  options.min_samples = 5;
+  options.max_samples = 50;
+  options.max_time = TimeDelta::FromMilliseconds(100);
+  return options;
+}
+
+void Count(int* count) {
+  ++*count;
+}
+
+void SaveResult(std::vector<BenchmarkResult>* results,
+                const BenchmarkResult& result) {
+  results->push_back(result);
+}
+
+}  // namespace
+
+TEST(BenchmarkTest, Statistics) {
+  std::vector<double> samples;
+  for (int i = 100; i >= 1; --i)
+    samples.push_back(i);
+
+  BenchmarkResult result;
+  ComputeBenchmarkStatistics(samples, &result);
+  EXPECT_EQ(100, result.samples);
+  EXPECT_DOUBLE_EQ(1, result.min_ns);
+  EXPECT_DOUBLE_EQ(100, result.max_ns);
+  EXPECT_DOUBLE_EQ(50.5, result.median_ns);
+  EXPECT_DOUBLE_EQ(50.5, result.mean_ns);
+  EXPECT_DOUBLE_EQ(99, result.p99_ns);
+  // The standard deviation of 1..100 is 29.01, so the standard error is
+  // 2.901, and the normal quantile applies with 99 degrees of freedom.
+  EXPECT_NEAR(1.96 * 2.901, result.ci95_ns, 0.01);
+
+  samples.resize(3);  // 100, 99, 98.
+  ComputeBenchmarkStatistics(samples, &result);
+  EXPECT_EQ(3, result.samples);
+  EXPECT_DOUBLE_EQ(99, result.median_ns);
+  EXPECT_DOUBLE_EQ(100, result.p99_ns);
+  // Student's t for 2 degrees of freedom, with a standard error of 1/sqrt(3).
+  EXPECT_NEAR(4.303 / sqrt(3.0), result.ci95_ns, 0.001);
+
+  samples.resize(1);
+  ComputeBenchmarkStatistics(samples, &result);
+  EXPECT_DOUBLE_EQ(100, result.median_ns);
+  EXPECT_DOUBLE_EQ(0, result.ci95_ns);
+}
+
+TEST(BenchmarkTest, Run) {
+  int count = 0;
+  BenchmarkOptions options = QuickOptions();
+  BenchmarkResult result =
+      RunBenchmark("count", Bind(&Count, &count), options);
+
+  EXPECT_EQ("count", result.name);
+  EXPECT_GE(result.samples, options.min_samples);
+  EXPECT_LE(result.samples, options.max_samples);
+  EXPECT_GT(result.iterations_per_sample, 1);
+  EXPECT_GE(count, result.samples * result.iterations_per_sample);
+  EXPECT_LE(result.min_ns, result.median_ns);
+  EXPECT_LE(result.median_ns, result.p99_ns);
+  EXPECT_LE(result.p99_ns, result.max_ns);
+  EXPECT_LE(result.min_ns, result.mean_ns);
+  EXPECT_LE(result.mean_ns, result.max_ns);
+  if (result.converged) {
+    EXPECT_LE(result.ci95_ns, options.target_relative_error * result.mean_ns);
+  }
+}
+
+TEST(BenchmarkTest, Reporter) {
+  std::vector<BenchmarkResult> results;
+  SetBenchmarkReporter(Bind(&SaveResult, &results));
+  int count = 0;
+  RunBenchmark("first", Bind(&Count, &count), QuickOptions());
+  RunBenchmark("second", Bind(&Count, &count), QuickOptions());
+  SetBenchmarkReporter(BenchmarkReporter());
+  RunBenchmark("unreported", Bind(&Count, &count), QuickOptions());
+
+  ASSERT_EQ(2u, results.size());
+  EXPECT_EQ("first", results[0].name);
+  EXPECT_EQ("second", results[1].name);
+
+  scoped_ptr<DictionaryValue> value(results[0].ToValue());
+  std::string name;
+  EXPECT_TRUE(value->GetString("name", &name));
+  EXPECT_EQ("first", name);
+  double median_ns = 0;
+  EXPECT_TRUE(value->GetDouble("median_ns", &median_ns));
+  EXPECT_DOUBLE_EQ(results[0].median_ns, median_ns);
+  int samples = 0;
+  EXPECT_TRUE(value->GetInteger("samples", &samples));
+  EXPECT_EQ(results[0].samples, samples);
+}
+
+}  // namespace base
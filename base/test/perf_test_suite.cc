@@ -4,13 +4,18 @@
 
 #include "base/test/perf_test_suite.h"
 
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/debug/debugger.h"
 #include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/json/json_writer.h"
 #include "base/path_service.h"
 #include "base/perftimer.h"
 #include "base/process_util.h"
 #include "base/string_util.h"
+#include "base/test/benchmark.h"
+#include "base/values.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -18,6 +23,9 @@ namespace base {
 PerfTestSuite::PerfTestSuite(int argc, char** argv) : TestSuite(argc, argv) {
 }
 
+PerfTestSuite::~PerfTestSuite() {
+}
+
 void PerfTestSuite::Initialize() {
   TestSuite::Initialize();
 
@@ -32,6 +40,12 @@ void PerfTestSuite::Initialize() {
   }
   ASSERT_TRUE(InitPerfLog(log_path));
 
+  benchmark_json_path_ =
+      CommandLine::ForCurrentProcess()->GetSwitchValuePath("benchmark-json");
+  benchmark_results_.reset(new ListValue);
+  SetBenchmarkReporter(Bind(&PerfTestSuite::OnBenchmarkResult,
+                            Unretained(this)));
+
   // Raise to high priority to have more precise measurements. Since we don't
   // aim at 1% precision, it is not necessary to run at realtime level.
   if (!base::debug::BeingDebugged())
@@ -39,8 +53,33 @@ void PerfTestSuite::Initialize() {
 }
 
 void PerfTestSuite::Shutdown() {
+  SetBenchmarkReporter(BenchmarkReporter());
+  if (!benchmark_json_path_.empty()) {
+    std::string json;
+    JSONWriter::WriteWithOptions(benchmark_results_.get(),
+                                 JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+    if (file_util::WriteFile(benchmark_json_path_, json.data(),
+                             json.size()) != static_cast<int>(json.size())) {
+      LOG(ERROR) << "Failed to write " << benchmark_json_path_.value();
+    }
+  }
+
   TestSuite::Shutdown();
   FinalizePerfLog();
 }
 
+void PerfTestSuite::OnBenchmarkResult(const BenchmarkResult& result) {
+  LogPerfResult(result.name.c_str(), result.median_ns, "ns");
+  LogPerfResult((result.name + "_p99").c_str(), result.p99_ns, "ns");
+  if (result.cpu_ns >= 0)
+    LogPerfResult((result.name + "_cpu").c_str(), result.cpu_ns, "ns");
+  if (result.allocations >= 0) {
+    LogPerfResult((result.name + "_allocations").c_str(), result.allocations,
+                  "allocations");
+  }
+  if (!result.converged)
+    LOG(WARNING) << result.name << " did not converge: " << result.ToString();
+  benchmark_results_->Append(result.ToValue());
+}
+
 }  // namespace base
@@ -6,16 +6,31 @@
 #define BASE_TEST_PERF_TEST_SUITE_H_
 #pragma once
 
+#include "base/file_path.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/test/test_suite.h"
 
 namespace base {
 
+class ListValue;
+struct BenchmarkResult;
+
 class PerfTestSuite : public TestSuite {
  public:
   PerfTestSuite(int argc, char** argv);
+  virtual ~PerfTestSuite();
 
   virtual void Initialize() OVERRIDE;
   virtual void Shutdown() OVERRIDE;
+
+ private:
+  // Logs the result of a benchmark run by the tests, and keeps it for
+  // |benchmark_json_path_|.
+  void OnBenchmarkResult(const BenchmarkResult& result);
+
+  // Where to write the results of the benchmarks as JSON, if anywhere.
+  FilePath benchmark_json_path_;
+  scoped_ptr<ListValue> benchmark_results_;
 };
 
 }  // namespace base
@@ -30,6 +30,10 @@ class SequencedWorkerPoolOwner : public SequencedWorkerPool::TestingObserver {
   SequencedWorkerPoolOwner(size_t max_threads,
                            const std::string& thread_name_prefix);
 
+  SequencedWorkerPoolOwner(size_t max_threads,
+                           const std::string& thread_name_prefix,
+                           SequencedWorkerPool::DispatchMode dispatch_mode);
+
   virtual ~SequencedWorkerPoolOwner();
 
   // Don't change the returned pool's testing observer.
@@ -0,0 +1,253 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/test/trace_budget.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/json/json_reader.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/stringprintf.h"
+#include "base/test/trace_event_analyzer.h"
+#include "base/values.h"
+
+namespace trace_analyzer {
+
+namespace {
+
+struct MetricName {
+  const char* name;
+  TraceMetric metric;
+};
+
+const MetricName kMetricNames[] = {
+  { "count", TRACE_METRIC_COUNT },
+  { "total_duration_us", TRACE_METRIC_TOTAL_DURATION },
+  { "max_duration_us", TRACE_METRIC_MAX_DURATION },
+  { "mean_interval_us", TRACE_METRIC_MEAN_INTERVAL },
+  { "max_interval_us", TRACE_METRIC_MAX_INTERVAL },
+  { "thread_hops", TRACE_METRIC_THREAD_HOPS },
+};
+
+bool Fail(std::string* error, const std::string& message) {
+  if (error)
+    *error = message;
+  return false;
+}
+
+bool ParseTraceBudget(const base::DictionaryValue& value,
+                      TraceBudget* budget,
+                      std::string* error) {
+  std::string metric;
+  if (!value.GetString("name", &budget->name) ||
+      !value.GetString("metric", &metric) ||
+      !value.GetString("event", &budget->event_pattern)) {
+    return Fail(error, "A budget needs a name, a metric and an event");
+  }
+  size_t i = 0;
+  while (i < arraysize(kMetricNames) && metric != kMetricNames[i].name)
+    ++i;
+  if (i == arraysize(kMetricNames))
+    return Fail(error, budget->name + ": unknown metric " + metric);
+  budget->metric = kMetricNames[i].metric;
+
+  if (!value.GetString("category", &budget->category_pattern))
+    budget->category_pattern = "*";
+  budget->has_min = value.GetDouble("min", &budget->min);
+  budget->has_max = value.GetDouble("max", &budget->max);
+  if (!budget->has_min && !budget->has_max)
+    return Fail(error, budget->name + ": needs a min or a max");
+  return true;
+}
+
+const char* GetMetricName(TraceMetric metric) {
+  for (size_t i = 0; i < arraysize(kMetricNames); ++i) {
+    if (kMetricNames[i].metric == metric)
+      return kMetricNames[i].name;
+  }
+  NOTREACHED();
+  return "";
+}
+
+}  // namespace
+
+TraceRecorder::TraceRecorder() : recording_(false) {
+}
+
+TraceRecorder::~TraceRecorder() {
+  if (recording_)
+    delete Stop();
+}
+
+void TraceRecorder::Start(const std::string& categories) {
+  DCHECK(!recording_);
+  base::debug::TraceLog* trace_log = base::debug::TraceLog::GetInstance();
+  trace_log->SetOutputCallback(
+      base::Bind(&TraceRecorder::OnTraceDataCollected,
+                 base::Unretained(this)));
+  buffer_.SetOutputCallback(output_.GetCallback());
+  output_.json_output.clear();
+  buffer_.Start();
+  recording_ = true;
+  trace_log->SetEnabled(categories);
+}
+
+TraceAnalyzer* TraceRecorder::Stop() {
+  DCHECK(recording_);
+  base::debug::TraceLog* trace_log = base::debug::TraceLog::GetInstance();
+  // Disabling flushes the events to OnTraceDataCollected().
+  trace_log->SetEnabled(false);
+  trace_log->SetOutputCallback(base::debug::TraceLog::OutputCallback());
+  buffer_.Finish();
+  recording_ = false;
+
+  TraceAnalyzer* analyzer = TraceAnalyzer::Create(output_.json_output);
+  if (analyzer)
+    analyzer->AssociateBeginEndEvents();
+  return analyzer;
+}
+
+void TraceRecorder::OnTraceDataCollected(
+    const scoped_refptr<base::RefCountedString>& json_events) {
+  buffer_.AddFragment(json_events->data());
+}
+
+TraceBudget::TraceBudget()
+    : metric(TRACE_METRIC_COUNT),
+      has_min(false),
+      min(0),
+      has_max(false),
+      max(0) {
+}
+
+TraceBudget::~TraceBudget() {
+}
+
+bool ParseTraceBudgets(const std::string& json,
+                       const std::string& scenario,
+                       std::vector<TraceBudget>* budgets,
+                       std::string* error) {
+  budgets->clear();
+  std::string parse_error;
+  scoped_ptr<base::Value> root(base::JSONReader::ReadAndReturnError(
+      json, base::JSON_ALLOW_TRAILING_COMMAS, NULL, &parse_error));
+  if (!root.get())
+    return Fail(error, parse_error);
+  base::DictionaryValue* scenarios = NULL;
+  if (!root->GetAsDictionary(&scenarios))
+    return Fail(error, "The budgets must be a dictionary of scenarios");
+  base::ListValue* list = NULL;
+  if (!scenarios->GetListWithoutPathExpansion(scenario, &list))
+    return Fail(error, "No budgets for " + scenario);
+
+  for (size_t i = 0; i < list->GetSize(); ++i) {
+    base::DictionaryValue* value = NULL;
+    if (!list->GetDictionary(i, &value))
+      return Fail(error, "The budgets of a scenario must be dictionaries");
+    TraceBudget budget;
+    if (!ParseTraceBudget(*value, &budget, error))
+      return false;
+    budgets->push_back(budget);
+  }
+  return true;
+}
+
+bool LoadTraceBudgets(const FilePath& path,
+                      const std::string& scenario,
+                      std::vector<TraceBudget>* budgets,
+                      std::string* error) {
+  std::string json;
+  if (!file_util::ReadFileToString(path, &json))
+    return Fail(error, "Can't read " + path.AsUTF8Unsafe());
+  return ParseTraceBudgets(json, scenario, budgets, error);
+}
+
+double ComputeTraceMetric(TraceAnalyzer* analyzer, const TraceBudget& budget) {
+  // A begin/end pair is measured at its begin event.
+  Query query =
+      Query::EventName() == Query::Pattern(budget.event_pattern) &&
+      Query::EventCategory() == Query::Pattern(budget.category_pattern) &&
+      Query::EventPhase() != Query::Phase(TRACE_EVENT_PHASE_END) &&
+      Query::EventPhase() != Query::Phase(TRACE_EVENT_PHASE_METADATA);
+  TraceEventVector events;
+  analyzer->FindEvents(query, &events);
+
+  switch (budget.metric) {
+    case TRACE_METRIC_COUNT:
+      return events.size();
+
+    case TRACE_METRIC_TOTAL_DURATION:
+    case TRACE_METRIC_MAX_DURATION: {
+      double total = 0;
+      double longest = 0;
+      for (size_t i = 0; i < events.size(); ++i) {
+        if (events[i]->phase != TRACE_EVENT_PHASE_BEGIN ||
+            !events[i]->has_other_event()) {
+          continue;
+        }
+        double duration = events[i]->GetAbsTimeToOtherEvent();
+        total += duration;
+        longest = std::max(longest, duration);
+      }
+      return budget.metric == TRACE_METRIC_TOTAL_DURATION ? total : longest;
+    }
+
+    case TRACE_METRIC_MEAN_INTERVAL:
+    case TRACE_METRIC_MAX_INTERVAL: {
+      if (events.size() < 2)
+        return 0;
+      double longest = 0;
+      for (size_t i = 1; i < events.size(); ++i) {
+        longest = std::max(longest,
+                           events[i]->timestamp - events[i - 1]->timestamp);
+      }
+      if (budget.metric == TRACE_METRIC_MAX_INTERVAL)
+        return longest;
+      return (events.back()->timestamp - events.front()->timestamp) /
+             (events.size() - 1);
+    }
+
+    case TRACE_METRIC_THREAD_HOPS: {
+      int hops = 0;
+      for (size_t i = 1; i < events.size(); ++i) {
+        if (events[i]->thread < events[i - 1]->thread ||
+            events[i - 1]->thread < events[i]->thread) {
+          ++hops;
+        }
+      }
+      return hops;
+    }
+  }
+  NOTREACHED();
+  return 0;
+}
+
+testing::AssertionResult CheckTraceBudgets(
+    TraceAnalyzer* analyzer,
+    const std::vector<TraceBudget>& budgets) {
+  std::string failures;
+  for (size_t i = 0; i < budgets.size(); ++i) {
+    const TraceBudget& budget = budgets[i];
+    double value = ComputeTraceMetric(analyzer, budget);
+    if (budget.has_min && value < budget.min) {
+      base::StringAppendF(&failures, "%s: %s of %s is %g, under the min %g\n",
+                          budget.name.c_str(), GetMetricName(budget.metric),
+                          budget.event_pattern.c_str(), value, budget.min);
+    }
+    if (budget.has_max && value > budget.max) {
+      base::StringAppendF(&failures, "%s: %s of %s is %g, over the max %g\n",
+                          budget.name.c_str(), GetMetricName(budget.metric),
+                          budget.event_pattern.c_str(), value, budget.max);
+    }
+  }
+  if (!failures.empty())
+    return testing::AssertionFailure() << failures;
+  return testing::AssertionSuccess();
+}
+
+}  // namespace trace_analyzer
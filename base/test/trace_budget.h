@@ -0,0 +1,134 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Trace budgets turn the trace of a test scenario into performance
+// assertions: how many times an event may happen, how long its begin/end
+// pairs may last, how far apart successive events may be, and how many times
+// a chain of events may hop between threads.
+//
+// Budgets are kept in checked-in JSON files, a dictionary of scenarios, each
+// a list of budgets:
+//
+//   {
+//     "open_menu": [
+//       { "name": "paints", "metric": "count",
+//         "category": "views", "event": "View::Paint", "max": 12 },
+//       { "name": "longest_layout", "metric": "max_duration_us",
+//         "event": "View::Layout", "max": 2000 }
+//     ]
+//   }
+//
+// "event" and "category" are patterns that may use * and ?; a missing
+// "category" matches all.  A budget has a "max", a "min" or both.  The
+// metrics are:
+//   count              events, counting a begin/end pair once.
+//   total_duration_us  the summed durations of the begin/end pairs.
+//   max_duration_us    the longest begin/end pair.
+//   mean_interval_us   the mean time between successive events.
+//   max_interval_us    the longest time between successive events.
+//   thread_hops        successive events that are on different threads.
+//
+// EXAMPLE:
+//
+//   trace_analyzer::TraceRecorder recorder;
+//   recorder.Start("views,ui");
+//   OpenMenu();
+//   scoped_ptr<trace_analyzer::TraceAnalyzer> analyzer(recorder.Stop());
+//   std::vector<trace_analyzer::TraceBudget> budgets;
+//   ASSERT_TRUE(trace_analyzer::LoadTraceBudgets(path, "open_menu",
+//                                                &budgets, NULL));
+//   EXPECT_TRUE(trace_analyzer::CheckTraceBudgets(analyzer.get(), budgets));
+
+#ifndef BASE_TEST_TRACE_BUDGET_H_
+#define BASE_TEST_TRACE_BUDGET_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/debug/trace_event.h"
+#include "base/memory/ref_counted_memory.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+class FilePath;
+
+namespace trace_analyzer {
+
+class TraceAnalyzer;
+
+// Records the trace of a scenario for a TraceAnalyzer.
+class TraceRecorder {
+ public:
+  TraceRecorder();
+  ~TraceRecorder();
+
+  // Starts tracing |categories|, in the syntax of TraceLog::SetEnabled().
+  void Start(const std::string& categories);
+
+  // Stops tracing and returns an analyzer of the events recorded since
+  // Start(), with the begin and end events associated.  The caller owns it.
+  TraceAnalyzer* Stop();
+
+ private:
+  void OnTraceDataCollected(
+      const scoped_refptr<base::RefCountedString>& json_events);
+
+  base::debug::TraceResultBuffer buffer_;
+  base::debug::TraceResultBuffer::SimpleOutput output_;
+  bool recording_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceRecorder);
+};
+
+enum TraceMetric {
+  TRACE_METRIC_COUNT,
+  TRACE_METRIC_TOTAL_DURATION,
+  TRACE_METRIC_MAX_DURATION,
+  TRACE_METRIC_MEAN_INTERVAL,
+  TRACE_METRIC_MAX_INTERVAL,
+  TRACE_METRIC_THREAD_HOPS,
+};
+
+struct TraceBudget {
+  TraceBudget();
+  ~TraceBudget();
+
+  // Names the budget in failures.
+  std::string name;
+  TraceMetric metric;
+  // Patterns of the events measured.
+  std::string event_pattern;
+  std::string category_pattern;
+  bool has_min;
+  double min;
+  bool has_max;
+  double max;
+};
+
+// Replaces |budgets| with those of |scenario| in |json|, in the format
+// above.  On failure, returns false and sets |error| if it isn't NULL.
+bool ParseTraceBudgets(const std::string& json,
+                       const std::string& scenario,
+                       std::vector<TraceBudget>* budgets,
+                       std::string* error);
+
+// Same as ParseTraceBudgets(), for the budget file at |path|.
+bool LoadTraceBudgets(const FilePath& path,
+                      const std::string& scenario,
+                      std::vector<TraceBudget>* budgets,
+                      std::string* error);
+
+// Returns the value of the metric of |budget| over the events of |analyzer|.
+double ComputeTraceMetric(TraceAnalyzer* analyzer, const TraceBudget& budget);
+
+// Succeeds if every budget holds, and otherwise fails with the budgets that
+// don't and their values.
+testing::AssertionResult CheckTraceBudgets(
+    TraceAnalyzer* analyzer,
+    const std::vector<TraceBudget>& budgets);
+
+}  // namespace trace_analyzer
+
+#endif  // BASE_TEST_TRACE_BUDGET_H_
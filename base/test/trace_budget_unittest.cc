@@ -0,0 +1,141 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/test/trace_budget.h"
+
+#include "base/memory/scoped_ptr.h"
+#include "base/test/trace_event_analyzer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace trace_analyzer {
+
+namespace {
+
+// Two paints on thread 1, 100 and 300 us long, then a task that hops from
+// thread 1 to thread 2 and back.
+const char kEvents[] =
+    "[{\"cat\":\"views\",\"pid\":1,\"tid\":1,\"ts\":1000,\"ph\":\"B\","
+    "\"name\":\"Paint\",\"args\":{}},"
+    "{\"cat\":\"views\",\"pid\":1,\"tid\":1,\"ts\":1100,\"ph\":\"E\","
+    "\"name\":\"Paint\",\"args\":{}},"
+    "{\"cat\":\"views\",\"pid\":1,\"tid\":1,\"ts\":2000,\"ph\":\"B\","
+    "\"name\":\"Paint\",\"args\":{}},"
+    "{\"cat\":\"views\",\"pid\":1,\"tid\":1,\"ts\":2300,\"ph\":\"E\","
+    "\"name\":\"Paint\",\"args\":{}},"
+    "{\"cat\":\"task\",\"pid\":1,\"tid\":1,\"ts\":3000,\"ph\":\"I\","
+    "\"name\":\"Step\",\"args\":{}},"
+    "{\"cat\":\"task\",\"pid\":1,\"tid\":2,\"ts\":3500,\"ph\":\"I\","
+    "\"name\":\"Step\",\"args\":{}},"
+    "{\"cat\":\"task\",\"pid\":1,\"tid\":1,\"ts\":5000,\"ph\":\"I\","
+    "\"name\":\"Step\",\"args\":{}}]";
+
+TraceBudget MakeBudget(TraceMetric metric, const char* event_pattern) {
+  TraceBudget budget;
+  budget.name = "test";
+  budget.metric = metric;
+  budget.event_pattern = event_pattern;
+  budget.category_pattern = "*";
+  return budget;
+}
+
+}  // namespace
+
+TEST(TraceBudgetTest, Parse) {
+  std::vector<TraceBudget> budgets;
+  std::string error;
+  EXPECT_TRUE(ParseTraceBudgets(
+      "{\"menu\": ["
+      "  {\"name\": \"paints\", \"metric\": \"count\", \"event\": \"Paint\","
+      "   \"category\": \"views\", \"max\": 3},"
+      "  {\"name\": \"hops\", \"metric\": \"thread_hops\", \"event\": \"S*\","
+      "   \"min\": 1, \"max\": 2},"
+      "]}",
+      "menu", &budgets, &error)) << error;
+  ASSERT_EQ(2u, budgets.size());
+  EXPECT_EQ("paints", budgets[0].name);
+  EXPECT_EQ(TRACE_METRIC_COUNT, budgets[0].metric);
+  EXPECT_EQ("Paint", budgets[0].event_pattern);
+  EXPECT_EQ("views", budgets[0].category_pattern);
+  EXPECT_FALSE(budgets[0].has_min);
+  EXPECT_TRUE(budgets[0].has_max);
+  EXPECT_EQ(3, budgets[0].max);
+  EXPECT_EQ(TRACE_METRIC_THREAD_HOPS, budgets[1].metric);
+  EXPECT_EQ("*", budgets[1].category_pattern);
+  EXPECT_TRUE(budgets[1].has_min);
+  EXPECT_EQ(1, budgets[1].min);
+
+  EXPECT_FALSE(ParseTraceBudgets("{\"menu\": []}", "window", &budgets,
+                                 &error));
+  EXPECT_FALSE(ParseTraceBudgets(
+      "{\"menu\": [{\"name\": \"a\", \"metric\": \"speed\", "
+      "\"event\": \"Paint\", \"max\": 1}]}", "menu", &budgets, &error));
+  EXPECT_FALSE(ParseTraceBudgets(
+      "{\"menu\": [{\"name\": \"a\", \"metric\": \"count\", "
+      "\"event\": \"Paint\"}]}", "menu", &budgets, &error));
+  EXPECT_FALSE(ParseTraceBudgets("{", "menu", &budgets, &error));
+}
+
+TEST(TraceBudgetTest, Metrics) {
+  scoped_ptr<TraceAnalyzer> analyzer(TraceAnalyzer::Create(kEvents));
+  ASSERT_TRUE(analyzer.get());
+  analyzer->AssociateBeginEndEvents();
+
+  EXPECT_EQ(2, ComputeTraceMetric(analyzer.get(),
+                                  MakeBudget(TRACE_METRIC_COUNT, "Paint")));
+  EXPECT_EQ(5, ComputeTraceMetric(analyzer.get(),
+                                  MakeBudget(TRACE_METRIC_COUNT, "*")));
+  EXPECT_EQ(400, ComputeTraceMetric(
+      analyzer.get(), MakeBudget(TRACE_METRIC_TOTAL_DURATION, "Paint")));
+  EXPECT_EQ(300, ComputeTraceMetric(
+      analyzer.get(), MakeBudget(TRACE_METRIC_MAX_DURATION, "Paint")));
+  EXPECT_EQ(1000, ComputeTraceMetric(
+      analyzer.get(), MakeBudget(TRACE_METRIC_MEAN_INTERVAL, "Step")));
+  EXPECT_EQ(1500, ComputeTraceMetric(
+      analyzer.get(), MakeBudget(TRACE_METRIC_MAX_INTERVAL, "Step")));
+  EXPECT_EQ(2, ComputeTraceMetric(
+      analyzer.get(), MakeBudget(TRACE_METRIC_THREAD_HOPS, "Step")));
+
+  TraceBudget budget = MakeBudget(TRACE_METRIC_COUNT, "Paint");
+  budget.category_pattern = "task";
+  EXPECT_EQ(0, ComputeTraceMetric(analyzer.get(), budget));
+}
+
+TEST(TraceBudgetTest, Check) {
+  scoped_ptr<TraceAnalyzer> analyzer(TraceAnalyzer::Create(kEvents));
+  ASSERT_TRUE(analyzer.get());
+  analyzer->AssociateBeginEndEvents();
+
+  std::vector<TraceBudget> budgets;
+  budgets.push_back(MakeBudget(TRACE_METRIC_COUNT, "Paint"));
+  budgets.back().has_max = true;
+  budgets.back().max = 2;
+  budgets.push_back(MakeBudget(TRACE_METRIC_THREAD_HOPS, "Step"));
+  budgets.back().has_min = true;
+  budgets.back().min = 1;
+  EXPECT_TRUE(CheckTraceBudgets(analyzer.get(), budgets));
+
+  budgets[0].max = 1;
+  testing::AssertionResult result = CheckTraceBudgets(analyzer.get(), budgets);
+  EXPECT_FALSE(result);
+  EXPECT_NE(std::string::npos,
+            std::string(result.message()).find("over the max"));
+}
+
+TEST(TraceBudgetTest, Record) {
+  TraceRecorder recorder;
+  recorder.Start("trace_budget_test");
+  for (int i = 0; i < 3; ++i) {
+    TRACE_EVENT0("trace_budget_test", "Scope");
+  }
+  TRACE_EVENT_INSTANT0("other_category", "Ignored");
+  scoped_ptr<TraceAnalyzer> analyzer(recorder.Stop());
+  ASSERT_TRUE(analyzer.get());
+
+  TraceBudget budget = MakeBudget(TRACE_METRIC_COUNT, "Scope");
+  EXPECT_EQ(3, ComputeTraceMetric(analyzer.get(), budget));
+  budget.event_pattern = "Ignored";
+  EXPECT_EQ(0, ComputeTraceMetric(analyzer.get(), budget));
+}
+
+}  // namespace trace_analyzer
@@ -0,0 +1,255 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/threading/hang_detector.h"
+
+#include <algorithm>
+
+#include "base/debug/stack_trace.h"
+#include "base/logging.h"
+#include "base/stringprintf.h"
+
+#if defined(OS_LINUX)
+#include <errno.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+
+#include "base/lazy_instance.h"
+#endif
+
+namespace base {
+
+namespace {
+
+#if defined(OS_LINUX)
+
+// The signal that makes the busy thread capture its stack.
+const int kCaptureSignal = SIGUSR2;
+
+// How long the watchdog thread waits for the busy thread to capture its
+// stack.
+const int kCaptureTimeoutMs = 100;
+
+const size_t kMaxFrames = 62;
+
+// The frames at the top of the stacks captured in the signal handler that
+// belong to the capture: StackTrace(), the handler and the signal trampoline.
+const size_t kCaptureFrames = 3;
+
+// Serializes the captures of all the detectors, which share the buffer below.
+LazyInstance<Lock>::Leaky g_capture_lock = LAZY_INSTANCE_INITIALIZER;
+bool g_capture_handler_installed = false;
+
+// Written by the signal handler on the busy thread, which then posts
+// |g_captured|, and read by the watchdog thread.
+const void* g_captured_frames[kMaxFrames];
+size_t g_captured_frame_count = 0;
+sem_t g_captured;
+
+void CaptureStackHandler(int signal) {
+  int saved_errno = errno;
+  debug::StackTrace trace;
+  size_t count = 0;
+  const void* const* frames = trace.Addresses(&count);
+  size_t skipped = std::min(count, kCaptureFrames);
+  count = std::min(count - skipped, kMaxFrames);
+  memcpy(g_captured_frames, frames + skipped, count * sizeof(frames[0]));
+  g_captured_frame_count = count;
+  sem_post(&g_captured);  // Async-signal-safe, unlike our locks.
+  errno = saved_errno;
+}
+
+// Replaces |frames| with the stack of |thread|, innermost first.  Returns
+// false if the thread did not capture it in time.
+bool CaptureStack(pthread_t thread, std::vector<const void*>* frames) {
+  AutoLock lock(g_capture_lock.Get());
+  if (!g_capture_handler_installed) {
+    sem_init(&g_captured, 0, 0);
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = CaptureStackHandler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(kCaptureSignal, &action, NULL) != 0)
+      return false;
+    g_capture_handler_installed = true;
+  }
+
+  // Forget a capture that came in after an earlier one timed out.
+  while (sem_trywait(&g_captured) == 0) {
+  }
+
+  if (pthread_kill(thread, kCaptureSignal) != 0)
+    return false;
+
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_nsec += kCaptureTimeoutMs * 1000 * 1000;
+  deadline.tv_sec += deadline.tv_nsec / (1000 * 1000 * 1000);
+  deadline.tv_nsec %= 1000 * 1000 * 1000;
+  while (sem_timedwait(&g_captured, &deadline) != 0) {
+    if (errno != EINTR)
+      return false;
+  }
+  frames->assign(g_captured_frames,
+                 g_captured_frames + g_captured_frame_count);
+  return true;
+}
+
+#endif  // defined(OS_LINUX)
+
+bool HasMoreHangs(const HangDetector::Hang& a, const HangDetector::Hang& b) {
+  return a.count > b.count;
+}
+
+}  // namespace
+
+HangDetector::Hang::Hang() : count(0) {
+}
+
+HangDetector::Hang::~Hang() {
+}
+
+HangDetector::HangWatchdog::HangWatchdog(HangDetector* detector,
+                                         const TimeDelta& threshold,
+                                         const std::string& thread_name)
+    : Watchdog(threshold, thread_name, true),
+      detector_(detector) {
+}
+
+HangDetector::HangWatchdog::~HangWatchdog() {
+}
+
+void HangDetector::HangWatchdog::Alarm() {
+  detector_->OnHang();
+}
+
+HangDetector::HangData::HangData() : count(0) {
+}
+
+HangDetector::HangDetector(const TimeDelta& threshold,
+                           const std::string& thread_name)
+    : threshold_(threshold),
+      thread_name_(thread_name),
+      message_loop_(MessageLoop::current()),
+#if defined(OS_LINUX)
+      thread_(pthread_self()),
+#endif
+      current_hang_(NULL),
+      ALLOW_THIS_IN_INITIALIZER_LIST(
+          watchdog_(this, threshold, thread_name)) {
+  DCHECK(message_loop_);
+#if defined(OS_LINUX)
+  // The first backtrace() loads libgcc, which can't be done from the signal
+  // handler.
+  debug::StackTrace();
+#endif
+  message_loop_->AddTaskObserver(this);
+}
+
+HangDetector::~HangDetector() {
+  DCHECK_EQ(message_loop_, MessageLoop::current());
+  message_loop_->RemoveTaskObserver(this);
+  watchdog_.Disarm();
+}
+
+void HangDetector::GetHangs(std::vector<Hang>* hangs) {
+  hangs->clear();
+  std::vector<std::vector<const void*> > stacks;
+  {
+    AutoLock lock(lock_);
+    for (HangMap::const_iterator it = hangs_.begin(); it != hangs_.end();
+         ++it) {
+      Hang hang;
+      hang.posted_from = it->first.first;
+      hang.count = it->second.count;
+      hang.longest = it->second.longest;
+      hangs->push_back(hang);
+      stacks.push_back(std::vector<const void*>());
+      stacks_.GetStack(it->first.second, &stacks.back());
+    }
+  }
+
+  // Symbolizing can take a while, so it is done without blocking the
+  // watchdog or the watched thread.
+  for (size_t i = 0; i < hangs->size(); ++i) {
+    if (!stacks[i].empty()) {
+      debug::StackTrace::SymbolizeAddresses(&stacks[i][0], stacks[i].size(),
+                                            &(*hangs)[i].stack);
+    }
+  }
+  std::stable_sort(hangs->begin(), hangs->end(), HasMoreHangs);
+}
+
+std::string HangDetector::GetReport() {
+  std::vector<Hang> hangs;
+  GetHangs(&hangs);
+
+  std::string report = StringPrintf(
+      "Tasks of the %s thread that ran over %d ms\n",
+      thread_name_.c_str(), static_cast<int>(threshold_.InMilliseconds()));
+  for (size_t i = 0; i < hangs.size(); ++i) {
+    const Hang& hang = hangs[i];
+    StringAppendF(&report, "\n%d times, at most %d ms, posted from %s\n",
+                  hang.count, static_cast<int>(hang.longest.InMilliseconds()),
+                  hang.posted_from.ToString().c_str());
+    for (size_t j = 0; j < hang.stack.size(); ++j)
+      StringAppendF(&report, "    %s\n", hang.stack[j].c_str());
+  }
+  return report;
+}
+
+void HangDetector::WillProcessTask(TimeTicks time_posted) {
+  // A task run by a nested loop takes over the watch until it is done.
+  const tracked_objects::Location* location =
+      message_loop_->current_task_location();
+  TimeTicks now = TimeTicks::Now();
+  {
+    AutoLock lock(lock_);
+    task_location_ = location ? *location : tracked_objects::Location();
+    task_start_ = now;
+    current_hang_ = NULL;
+  }
+  watchdog_.ArmAtStartTime(now);
+}
+
+void HangDetector::DidProcessTask(TimeTicks time_posted) {
+  watchdog_.Disarm();
+  AutoLock lock(lock_);
+  if (current_hang_) {
+    current_hang_->longest =
+        std::max(current_hang_->longest, TimeTicks::Now() - task_start_);
+  }
+  current_hang_ = NULL;
+  task_start_ = TimeTicks();
+}
+
+void HangDetector::OnHang() {
+  TimeTicks task_start;
+  {
+    AutoLock lock(lock_);
+    task_start = task_start_;
+  }
+  if (task_start.is_null())
+    return;
+
+  std::vector<const void*> frames;
+#if defined(OS_LINUX)
+  CaptureStack(thread_, &frames);
+#endif
+
+  AutoLock lock(lock_);
+  // Drop the stack if the task finished while it was captured.
+  if (task_start_ != task_start)
+    return;
+  size_t stack_id =
+      stacks_.Intern(frames.empty() ? NULL : &frames[0], frames.size());
+  HangData* hang = &hangs_[HangKey(task_location_, stack_id)];
+  ++hang->count;
+  current_hang_ = hang;
+}
+
+}  // namespace base
@@ -0,0 +1,141 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// HangDetector watches the tasks of the MessageLoop of the thread it is made
+// on with a Watchdog.  When a task runs longer than the threshold, the
+// watchdog thread captures the stack of the busy thread, and the detector
+// counts the hang under the location the task was posted from and that stack.
+// GetReport() symbolizes the hangs seen so far into text that can be
+// uploaded.
+//
+// Stacks are captured on Linux only, by signalling the busy thread with
+// SIGUSR2 and taking a StackTrace in the handler.  Elsewhere hangs are
+// counted by the location of their task alone.
+//
+// EXAMPLE:
+//
+//   // On the UI thread.
+//   HangDetector detector(TimeDelta::FromMilliseconds(500), "UI");
+//   ...
+//   std::string report = detector.GetReport();
+
+#ifndef BASE_THREADING_HANG_DETECTOR_H_
+#define BASE_THREADING_HANG_DETECTOR_H_
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/debug/stack_table.h"
+#include "base/location.h"
+#include "base/message_loop.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/watchdog.h"
+#include "base/time.h"
+
+namespace base {
+
+class BASE_EXPORT HangDetector : public MessageLoop::TaskObserver {
+ public:
+  // The hangs of the tasks posted from one location with one stack.
+  struct BASE_EXPORT Hang {
+    Hang();
+    ~Hang();
+
+    tracked_objects::Location posted_from;
+    // The symbols of the stack of the busy thread, innermost first.  Empty
+    // if the stack could not be captured.
+    std::vector<std::string> stack;
+    int count;
+    // The longest that one of the tasks ran.
+    TimeDelta longest;
+  };
+
+  // Starts watching the tasks of the current thread's MessageLoop, alarming
+  // for those that run longer than |threshold|.  |thread_name| names the
+  // thread in the report.
+  HangDetector(const TimeDelta& threshold, const std::string& thread_name);
+  virtual ~HangDetector();
+
+  // Replaces |hangs| with the hangs seen so far, the most frequent first.
+  void GetHangs(std::vector<Hang>* hangs);
+
+  // Returns the hangs seen so far as text, one hang per paragraph.
+  std::string GetReport();
+
+  // MessageLoop::TaskObserver:
+  virtual void WillProcessTask(TimeTicks time_posted) OVERRIDE;
+  virtual void DidProcessTask(TimeTicks time_posted) OVERRIDE;
+
+ private:
+  class HangWatchdog : public Watchdog {
+   public:
+    HangWatchdog(HangDetector* detector,
+                 const TimeDelta& threshold,
+                 const std::string& thread_name);
+    virtual ~HangWatchdog();
+
+    // Watchdog:
+    virtual void Alarm() OVERRIDE;
+
+   private:
+    HangDetector* detector_;
+
+    DISALLOW_COPY_AND_ASSIGN(HangWatchdog);
+  };
+
+  struct HangData {
+    HangData();
+
+    int count;
+    TimeDelta longest;
+  };
+
+  // Hangs are keyed by the location of their task and the id of their stack
+  // in |stacks_|.
+  typedef std::pair<tracked_objects::Location, size_t> HangKey;
+  typedef std::map<HangKey, HangData> HangMap;
+
+  // Called on the watchdog thread when the current task has run for longer
+  // than the threshold.
+  void OnHang();
+
+  const TimeDelta threshold_;
+  const std::string thread_name_;
+  MessageLoop* const message_loop_;
+
+#if defined(OS_LINUX)
+  // The thread whose tasks are watched, to signal.
+  const pthread_t thread_;
+#endif
+
+  // Guards the members below, which the watchdog thread writes to.
+  Lock lock_;
+
+  // Where the task being run was posted from, and when it started.
+  tracked_objects::Location task_location_;
+  TimeTicks task_start_;
+
+  // The hang of the task being run, if it has hung.
+  HangData* current_hang_;
+
+  debug::StackTable stacks_;
+  HangMap hangs_;
+
+  // Last so that its thread, which calls OnHang(), stops before the members
+  // above go away.
+  HangWatchdog watchdog_;
+
+  DISALLOW_COPY_AND_ASSIGN(HangDetector);
+};
+
+}  // namespace base
+
+#endif  // BASE_THREADING_HANG_DETECTOR_H_
@@ -0,0 +1,72 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/threading/hang_detector.h"
+
+#include "base/bind.h"
+#include "base/message_loop.h"
+#include "base/threading/platform_thread.h"
+#include "base/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Runs until |detector| has seen a hang, or a minute has passed.
+void WaitForHang(HangDetector* detector) {
+  TimeTicks start = TimeTicks::Now();
+  std::vector<HangDetector::Hang> hangs;
+  while (TimeTicks::Now() - start < TimeDelta::FromMinutes(1)) {
+    PlatformThread::Sleep(TimeDelta::FromMilliseconds(10));
+    detector->GetHangs(&hangs);
+    if (!hangs.empty())
+      return;
+  }
+}
+
+void QuickTask() {
+}
+
+}  // namespace
+
+TEST(HangDetectorTest, ReportsHangs) {
+  MessageLoop loop;
+  HangDetector detector(TimeDelta::FromMilliseconds(50), "Test");
+
+  const int hang_line = __LINE__ + 1;
+  loop.PostTask(FROM_HERE, Bind(&WaitForHang, &detector));
+  loop.PostTask(FROM_HERE, Bind(&QuickTask));
+  loop.PostTask(FROM_HERE, MessageLoop::QuitClosure());
+  loop.Run();
+
+  std::vector<HangDetector::Hang> hangs;
+  detector.GetHangs(&hangs);
+  ASSERT_EQ(1u, hangs.size());
+  EXPECT_EQ(1, hangs[0].count);
+  EXPECT_EQ(hang_line, hangs[0].posted_from.line_number());
+  EXPECT_GE(hangs[0].longest.InMilliseconds(), 50);
+#if defined(OS_LINUX)
+  EXPECT_FALSE(hangs[0].stack.empty());
+#endif
+
+  std::string report = detector.GetReport();
+  EXPECT_NE(std::string::npos, report.find("Test"));
+  EXPECT_NE(std::string::npos, report.find("1 times"));
+}
+
+TEST(HangDetectorTest, IgnoresQuickTasks) {
+  MessageLoop loop;
+  HangDetector detector(TimeDelta::FromSeconds(10), "Test");
+
+  loop.PostTask(FROM_HERE, Bind(&QuickTask));
+  loop.PostTask(FROM_HERE, MessageLoop::QuitClosure());
+  loop.Run();
+
+  std::vector<HangDetector::Hang> hangs;
+  detector.GetHangs(&hangs);
+  EXPECT_TRUE(hangs.empty());
+}
+
+}  // namespace base
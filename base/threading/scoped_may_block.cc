@@ -0,0 +1,39 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/threading/scoped_may_block.h"
+
+#include "base/lazy_instance.h"
+#include "base/threading/thread_local.h"
+
+namespace base {
+
+namespace {
+
+LazyInstance<ThreadLocalPointer<ScopedMayBlock::Observer> >::Leaky
+    g_may_block_observer = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+ScopedMayBlock::ScopedMayBlock()
+    : observer_(g_may_block_observer.Get().Get()) {
+  if (observer_) {
+    g_may_block_observer.Get().Set(NULL);
+    observer_->OnBlockingStarted();
+  }
+}
+
+ScopedMayBlock::~ScopedMayBlock() {
+  if (observer_) {
+    observer_->OnBlockingEnded();
+    g_may_block_observer.Get().Set(observer_);
+  }
+}
+
+// static
+void ScopedMayBlock::SetObserverForCurrentThread(Observer* observer) {
+  g_may_block_observer.Get().Set(observer);
+}
+
+}  // namespace base
@@ -0,0 +1,56 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_THREADING_SCOPED_MAY_BLOCK_H_
+#define BASE_THREADING_SCOPED_MAY_BLOCK_H_
+#pragma once
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+
+namespace base {
+
+// Marks a region of code in which the current thread may block, for example
+// on disk IO or while waiting for another thread.  Thread pools that limit how
+// many of their threads are runnable at once watch these regions so that they
+// can bring in another thread while one of theirs is stuck.
+//
+// On POSIX, WaitableEvent already marks the waits that do block, so most code
+// never uses this class directly.  Nested regions count as one.  On a thread
+// nobody watches, a region costs one thread local storage lookup.
+//
+//   {
+//     ScopedMayBlock may_block;
+//     file_util::ReadFileToString(path, &contents);
+//   }
+class BASE_EXPORT ScopedMayBlock {
+ public:
+  // Told about the outermost region on the thread it was set on.
+  class BASE_EXPORT Observer {
+   public:
+    virtual void OnBlockingStarted() = 0;
+    virtual void OnBlockingEnded() = 0;
+
+   protected:
+    virtual ~Observer() {}
+  };
+
+  ScopedMayBlock();
+  ~ScopedMayBlock();
+
+  // Sets the observer for regions on the current thread, or clears it if
+  // |observer| is NULL.  Must not be called inside a region.
+  static void SetObserverForCurrentThread(Observer* observer);
+
+ private:
+  // The observer that was told about this region, if any.  It is taken off
+  // the thread for the duration, which is what keeps nested regions quiet.
+  Observer* observer_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedMayBlock);
+};
+
+}  // namespace base
+
+#endif  // BASE_THREADING_SCOPED_MAY_BLOCK_H_
@@ -0,0 +1,81 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/threading/scoped_may_block.h"
+
+#include "base/compiler_specific.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/time.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class CountingObserver : public ScopedMayBlock::Observer {
+ public:
+  CountingObserver() : started_(0), ended_(0) {}
+  virtual ~CountingObserver() {}
+
+  virtual void OnBlockingStarted() OVERRIDE { ++started_; }
+  virtual void OnBlockingEnded() OVERRIDE { ++ended_; }
+
+  int started() const { return started_; }
+  int ended() const { return ended_; }
+
+ private:
+  int started_;
+  int ended_;
+};
+
+}  // namespace
+
+TEST(ScopedMayBlockTest, NestedRegionsCountOnce) {
+  CountingObserver observer;
+  ScopedMayBlock::SetObserverForCurrentThread(&observer);
+  {
+    ScopedMayBlock outer;
+    EXPECT_EQ(1, observer.started());
+    {
+      ScopedMayBlock inner;
+      EXPECT_EQ(1, observer.started());
+    }
+    EXPECT_EQ(0, observer.ended());
+  }
+  EXPECT_EQ(1, observer.ended());
+
+  {
+    ScopedMayBlock again;
+  }
+  EXPECT_EQ(2, observer.started());
+  EXPECT_EQ(2, observer.ended());
+
+  ScopedMayBlock::SetObserverForCurrentThread(NULL);
+  {
+    ScopedMayBlock unobserved;
+  }
+  EXPECT_EQ(2, observer.started());
+}
+
+#if defined(OS_POSIX)
+TEST(ScopedMayBlockTest, WaitableEventWaitIsARegion) {
+  CountingObserver observer;
+  ScopedMayBlock::SetObserverForCurrentThread(&observer);
+
+  WaitableEvent event(false, false);
+  EXPECT_FALSE(event.TimedWait(TimeDelta::FromMilliseconds(1)));
+  EXPECT_EQ(1, observer.started());
+  EXPECT_EQ(1, observer.ended());
+
+  // A signaled event does not block.
+  event.Signal();
+  EXPECT_TRUE(event.TimedWait(TimeDelta::FromMilliseconds(1)));
+  EXPECT_EQ(1, observer.started());
+
+  ScopedMayBlock::SetObserverForCurrentThread(NULL);
+}
+#endif  // defined(OS_POSIX)
+
+}  // namespace base
@@ -4,6 +4,7 @@
 
 #include "base/threading/sequenced_worker_pool.h"
 
+#include <deque>
 #include <list>
 #include <map>
 #include <set>
@@ -15,6 +16,7 @@
 #include "base/compiler_specific.h"
 #include "base/logging.h"
 #include "base/memory/linked_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/message_loop_proxy.h"
 #include "base/metrics/histogram.h"
 #include "base/stl_util.h"
@@ -23,6 +25,7 @@
 #include "base/synchronization/lock.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/simple_thread.h"
+#include "base/threading/thread_local.h"
 #include "base/threading/thread_restrictions.h"
 #include "base/time.h"
 #include "base/tracked_objects.h"
@@ -283,8 +286,13 @@ class SequencedWorkerPool::Worker : public SimpleThread {
     return running_sequence_;
   }
 
+  int thread_number() const {
+    return thread_number_;
+  }
+
  private:
   scoped_refptr<SequencedWorkerPool> worker_pool_;
+  const int thread_number_;
   SequenceToken running_sequence_;
 
   DISALLOW_COPY_AND_ASSIGN(Worker);
@@ -298,6 +306,7 @@ class SequencedWorkerPool::Inner {
   // by it).
   Inner(SequencedWorkerPool* worker_pool, size_t max_threads,
         const std::string& thread_name_prefix,
+        DispatchMode dispatch_mode,
         TestingObserver* observer);
 
   ~Inner();
@@ -331,6 +340,41 @@ class SequencedWorkerPool::Inner {
   void ThreadLoop(Worker* this_worker);
 
  private:
+  // The queue of unsequenced tasks owned by one worker thread in
+  // WORK_STEALING mode. Each queue has its own lock so that posting and
+  // taking unsequenced tasks never contends on |lock_|.
+  struct WorkerQueue {
+    Lock lock;
+    std::deque<SequencedTask> tasks;
+  };
+
+  // WORK_STEALING implementation of PostTask for tasks without a sequence
+  // token. Does not take |lock_| unless a thread needs to be woken up or
+  // started.
+  bool PostUnsequencedTask(const SequencedTask& sequenced);
+
+  // Queues a sequenced task in WORK_STEALING mode, marking its sequence
+  // runnable if nothing else in it is pending or running. Must be called
+  // under lock.
+  void LockedQueueSequencedTask(const SequencedTask& sequenced);
+
+  // Removes the next unsequenced task from the calling worker's queue at
+  // |own_index|, or steals one from another worker's queue if that is empty.
+  // Returns false if every queue is empty.
+  bool TakeUnsequencedTask(size_t own_index, SequencedTask* task);
+
+  // Runs unsequenced tasks outside the lock until there are none left or a
+  // sequence becomes runnable, so sequenced work is not starved.
+  void RunUnsequencedTasks(size_t own_index);
+
+  // Records that a BLOCK_SHUTDOWN unsequenced task has finished or was
+  // rejected, unblocking Shutdown() if it was the last one.
+  void DidFinishBlockingUnsequencedTask();
+
+  // Returns true if any unsequenced task is queued. May be called without
+  // holding the lock, in which case the answer may already be stale.
+  bool HasUnsequencedTasks() const;
+
   // Returns whether there are no more pending tasks and all threads
   // are idle.  Must be called under lock.
   bool IsIdle() const;
@@ -356,6 +400,10 @@ class SequencedWorkerPool::Inner {
   // sequence token.
   bool IsSequenceTokenRunnable(int sequence_token_id) const;
 
+  // Returns true if a thread could pick up a task right now. Must be called
+  // from within the lock.
+  bool HasRunnableTask() const;
+
   // Checks if all threads are busy and the addition of one more could run an
   // additional task waiting in the queue. This must be called from within
   // the lock.
@@ -428,8 +476,8 @@ class SequencedWorkerPool::Inner {
   // Number of threads currently waiting for work.
   size_t waiting_thread_count_;
 
-  // Number of threads currently running tasks that have the BLOCK_SHUTDOWN
-  // flag set.
+  // Number of threads currently running tasks that Shutdown() waits for:
+  // BLOCK_SHUTDOWN ones, and SKIP_ON_SHUTDOWN ones that started before it.
   size_t blocking_shutdown_thread_count_;
 
   // In-order list of all pending tasks. These are tasks waiting for a thread
@@ -451,6 +499,57 @@ class SequencedWorkerPool::Inner {
   // allowed, though we may still be running existing tasks.
   bool shutdown_called_;
 
+  const DispatchMode dispatch_mode_;
+
+  // The rest of the members are only used in WORK_STEALING mode. There,
+  // |pending_tasks_| stays empty and |pending_task_count_| and
+  // |blocking_shutdown_pending_task_count_| only count sequenced tasks.
+
+  // Per-worker queues of unsequenced tasks, indexed by thread number - 1.
+  // All max_threads_ queues are created up front so posting never has to
+  // wait for a thread to start.
+  ScopedVector<WorkerQueue> worker_queues_;
+
+  // The queue owned by the worker running on the current thread, if any.
+  // Mutable because ThreadLocalPointer::Get() is not const.
+  mutable ThreadLocalPointer<WorkerQueue> current_worker_queue_;
+
+  // Round-robin cursor used to pick a queue for tasks posted from threads
+  // that are not workers.
+  volatile subtle::Atomic32 next_worker_queue_;
+
+  // Number of tasks in |worker_queues_|. It may transiently go below zero
+  // because a task can be taken before its poster increments the count.
+  volatile subtle::Atomic32 unsequenced_task_count_;
+
+  // Number of BLOCK_SHUTDOWN unsequenced tasks that were posted and have not
+  // finished running yet.
+  volatile subtle::Atomic32 blocking_unsequenced_task_count_;
+
+  // Mirrors of |waiting_thread_count_| and |shutdown_called_| that can be
+  // read without the lock. Posters and workers pair these with the counts
+  // above so that whichever side acts second sees the other's update: a
+  // worker publishes that it is waiting before checking for tasks, and a
+  // poster publishes its task before checking for waiting workers.
+  volatile subtle::Atomic32 waiting_thread_hint_;
+  volatile subtle::Atomic32 shutdown_hint_;
+
+  // Set once max_threads_ workers have registered, after which posting an
+  // unsequenced task no longer considers starting a thread.
+  volatile subtle::Atomic32 all_threads_started_;
+
+  // Pending tasks for each sequence that has any, in posting order.
+  typedef std::map<int, std::deque<SequencedTask> > SequenceQueueMap;
+  SequenceQueueMap sequence_queues_;
+
+  // Sequences that have pending tasks and are not running on any thread, in
+  // the order they became runnable. A sequence is in here at most once.
+  std::deque<int> runnable_sequences_;
+
+  // Size of |runnable_sequences_|, readable without the lock so that workers
+  // running unsequenced tasks know when to come back for sequenced ones.
+  volatile subtle::Atomic32 runnable_sequence_hint_;
+
   TestingObserver* const testing_observer_;
 
   DISALLOW_COPY_AND_ASSIGN(Inner);
@@ -464,7 +563,8 @@ SequencedWorkerPool::Worker::Worker(
     const std::string& prefix)
     : SimpleThread(
           prefix + StringPrintf("Worker%d", thread_number).c_str()),
-      worker_pool_(worker_pool) {
+      worker_pool_(worker_pool),
+      thread_number_(thread_number) {
   Start();
 }
 
@@ -488,6 +588,7 @@ SequencedWorkerPool::Inner::Inner(
     SequencedWorkerPool* worker_pool,
     size_t max_threads,
     const std::string& thread_name_prefix,
+    DispatchMode dispatch_mode,
     TestingObserver* observer)
     : worker_pool_(worker_pool),
       last_sequence_number_(0),
@@ -503,7 +604,20 @@ SequencedWorkerPool::Inner::Inner(
       pending_task_count_(0),
       blocking_shutdown_pending_task_count_(0),
       shutdown_called_(false),
-      testing_observer_(observer) {}
+      dispatch_mode_(dispatch_mode),
+      next_worker_queue_(0),
+      unsequenced_task_count_(0),
+      blocking_unsequenced_task_count_(0),
+      waiting_thread_hint_(0),
+      shutdown_hint_(0),
+      all_threads_started_(0),
+      runnable_sequence_hint_(0),
+      testing_observer_(observer) {
+  if (dispatch_mode_ == WORK_STEALING) {
+    for (size_t i = 0; i < max_threads_; ++i)
+      worker_queues_.push_back(new WorkerQueue);
+  }
+}
 
 SequencedWorkerPool::Inner::~Inner() {
   // You must call Shutdown() before destroying the pool.
@@ -544,6 +658,10 @@ bool SequencedWorkerPool::Inner::PostTask(
   sequenced.location = from_here;
   sequenced.task = task;
 
+  if (dispatch_mode_ == WORK_STEALING && !optional_token_name &&
+      !sequenced.sequence_token_id)
+    return PostUnsequencedTask(sequenced);
+
   int create_thread_id = 0;
   {
     AutoLock lock(lock_);
@@ -554,7 +672,11 @@ bool SequencedWorkerPool::Inner::PostTask(
     if (optional_token_name)
       sequenced.sequence_token_id = LockedGetNamedTokenID(*optional_token_name);
 
-    pending_tasks_.push_back(sequenced);
+    if (dispatch_mode_ == WORK_STEALING) {
+      LockedQueueSequencedTask(sequenced);
+    } else {
+      pending_tasks_.push_back(sequenced);
+    }
     pending_task_count_++;
     if (shutdown_behavior == BLOCK_SHUTDOWN)
       blocking_shutdown_pending_task_count_++;
@@ -573,6 +695,9 @@ bool SequencedWorkerPool::Inner::PostTask(
 }
 
 bool SequencedWorkerPool::Inner::RunsTasksOnCurrentThread() const {
+  if (dispatch_mode_ == WORK_STEALING)
+    return current_worker_queue_.Get() != NULL;
+
   AutoLock lock(lock_);
   return ContainsKey(threads_, PlatformThread::CurrentId());
 }
@@ -607,6 +732,10 @@ void SequencedWorkerPool::Inner::Shutdown() {
     if (shutdown_called_)
       return;
     shutdown_called_ = true;
+    // Pairs with the barrier in PostUnsequencedTask: either the poster sees
+    // the flag and gives up, or CanShutdown() below sees its task.
+    subtle::NoBarrier_Store(&shutdown_hint_, 1);
+    subtle::MemoryBarrier();
 
     // Tickle the threads. This will wake up a waiting one so it will know that
     // it can exit, which in turn will wake up any other waiting ones.
@@ -645,11 +774,24 @@ void SequencedWorkerPool::Inner::ThreadLoop(Worker* this_worker) {
             std::make_pair(this_worker->tid(), make_linked_ptr(this_worker)));
     DCHECK(result.second);
 
+    const bool work_stealing = dispatch_mode_ == WORK_STEALING;
+    const size_t own_index = this_worker->thread_number() - 1;
+    if (work_stealing) {
+      current_worker_queue_.Set(worker_queues_[own_index]);
+      if (threads_.size() == max_threads_)
+        subtle::Release_Store(&all_threads_started_, 1);
+    }
+
     while (true) {
 #if defined(OS_MACOSX)
       base::mac::ScopedNSAutoreleasePool autorelease_pool;
 #endif
 
+      if (work_stealing) {
+        AutoUnlock unlock(lock_);
+        RunUnsequencedTasks(own_index);
+      }
+
       // See GetWork for what delete_these_outside_lock is doing.
       SequencedTask task;
       std::vector<Closure> delete_these_outside_lock;
@@ -686,14 +828,34 @@ void SequencedWorkerPool::Inner::ThreadLoop(Worker* this_worker) {
         // shutdown_called_ is set. There may be some tasks stuck
         // behind running ones with the same sequence token, but
         // additional threads won't help this case.
-        if (shutdown_called_)
+        //
+        // In WORK_STEALING mode a poster may still be committing an
+        // unsequenced BLOCK_SHUTDOWN task it was allowed to post, so stay
+        // around until those are done too.
+        if (shutdown_called_ &&
+            (!work_stealing ||
+             (!HasUnsequencedTasks() &&
+              subtle::Acquire_Load(&blocking_unsequenced_task_count_) == 0)))
           break;
         waiting_thread_count_++;
-        // This is the only time that IsIdle() can go to true.
-        if (IsIdle())
-          is_idle_cv_.Signal();
-        has_work_cv_.Wait();
+        if (work_stealing) {
+          // Pairs with the barrier in PostUnsequencedTask. See
+          // |waiting_thread_hint_|.
+          subtle::NoBarrier_Store(&waiting_thread_hint_,
+                                  static_cast<int>(waiting_thread_count_));
+          subtle::MemoryBarrier();
+        }
+        if (!work_stealing || !HasUnsequencedTasks()) {
+          // This is the only time that IsIdle() can go to true.
+          if (IsIdle())
+            is_idle_cv_.Signal();
+          has_work_cv_.Wait();
+        }
         waiting_thread_count_--;
+        if (work_stealing) {
+          subtle::NoBarrier_Store(&waiting_thread_hint_,
+                                  static_cast<int>(waiting_thread_count_));
+        }
       }
     }
   }  // Release lock_.
@@ -706,9 +868,155 @@ void SequencedWorkerPool::Inner::ThreadLoop(Worker* this_worker) {
   can_shutdown_cv_.Signal();
 }
 
+bool SequencedWorkerPool::Inner::PostUnsequencedTask(
+    const SequencedTask& sequenced) {
+  DCHECK_EQ(WORK_STEALING, dispatch_mode_);
+
+  // Register a blocking task before checking for shutdown. Pairs with the
+  // barrier in Shutdown(). See |shutdown_hint_|.
+  if (sequenced.shutdown_behavior == BLOCK_SHUTDOWN)
+    subtle::Barrier_AtomicIncrement(&blocking_unsequenced_task_count_, 1);
+  if (subtle::Acquire_Load(&shutdown_hint_)) {
+    if (sequenced.shutdown_behavior == BLOCK_SHUTDOWN)
+      DidFinishBlockingUnsequencedTask();
+    return false;
+  }
+
+  // Workers keep their own follow-up work local; other threads spread tasks
+  // round-robin and rely on idle workers to steal.
+  WorkerQueue* queue = current_worker_queue_.Get();
+  if (!queue) {
+    uint32 index = static_cast<uint32>(
+        subtle::NoBarrier_AtomicIncrement(&next_worker_queue_, 1));
+    queue = worker_queues_[index % max_threads_];
+  }
+  {
+    AutoLock lock(queue->lock);
+    queue->tasks.push_back(sequenced);
+  }
+  subtle::Barrier_AtomicIncrement(&unsequenced_task_count_, 1);
+
+  if (subtle::NoBarrier_Load(&waiting_thread_hint_) == 0 &&
+      subtle::Acquire_Load(&all_threads_started_))
+    return true;  // Every worker is busy and will find the task on its own.
+
+  int create_thread_id = 0;
+  {
+    AutoLock lock(lock_);
+    create_thread_id = PrepareToStartAdditionalThreadIfHelpful();
+  }
+  if (create_thread_id)
+    FinishStartingAdditionalThread(create_thread_id);
+  else
+    SignalHasWork();
+  return true;
+}
+
+void SequencedWorkerPool::Inner::LockedQueueSequencedTask(
+    const SequencedTask& sequenced) {
+  lock_.AssertAcquired();
+  DCHECK(sequenced.sequence_token_id);
+
+  std::deque<SequencedTask>& queue =
+      sequence_queues_[sequenced.sequence_token_id];
+  // A sequence that already has pending tasks is either runnable already or
+  // will be made runnable by DidRunWorkerTask.
+  if (queue.empty() && IsSequenceTokenRunnable(sequenced.sequence_token_id)) {
+    runnable_sequences_.push_back(sequenced.sequence_token_id);
+    subtle::NoBarrier_Store(&runnable_sequence_hint_,
+                            static_cast<int>(runnable_sequences_.size()));
+  }
+  queue.push_back(sequenced);
+}
+
+bool SequencedWorkerPool::Inner::TakeUnsequencedTask(size_t own_index,
+                                                     SequencedTask* task) {
+  if (!HasUnsequencedTasks())
+    return false;
+
+  for (size_t i = 0; i < max_threads_; ++i) {
+    WorkerQueue* queue = worker_queues_[(own_index + i) % max_threads_];
+    AutoLock lock(queue->lock);
+    if (!queue->tasks.empty()) {
+      *task = queue->tasks.front();
+      queue->tasks.pop_front();
+      subtle::NoBarrier_AtomicIncrement(&unsequenced_task_count_, -1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void SequencedWorkerPool::Inner::RunUnsequencedTasks(size_t own_index) {
+  SequencedTask task;
+  while (TakeUnsequencedTask(own_index, &task)) {
+    // Same as WillRunWorkerTask: there may be enough work queued up behind
+    // this task for another thread to be helpful.
+    if (!subtle::Acquire_Load(&all_threads_started_)) {
+      int new_thread_id = 0;
+      {
+        AutoLock lock(lock_);
+        new_thread_id = PrepareToStartAdditionalThreadIfHelpful();
+      }
+      if (new_thread_id)
+        FinishStartingAdditionalThread(new_thread_id);
+    }
+
+    // Tasks that don't block shutdown are deleted rather than run once
+    // shutdown has started, like GetWork does. A SKIP_ON_SHUTDOWN task is
+    // marked as started under the lock, so that Shutdown() either waits for
+    // it or it sees that shutdown has started.
+    bool run;
+    if (task.shutdown_behavior == SKIP_ON_SHUTDOWN) {
+      AutoLock lock(lock_);
+      run = !shutdown_called_;
+      if (run)
+        blocking_shutdown_thread_count_++;
+    } else {
+      run = task.shutdown_behavior == BLOCK_SHUTDOWN ||
+          !subtle::Acquire_Load(&shutdown_hint_);
+    }
+    if (run)
+      task.task.Run();
+    task.task = Closure();
+    if (task.shutdown_behavior == BLOCK_SHUTDOWN) {
+      DidFinishBlockingUnsequencedTask();
+    } else if (run && task.shutdown_behavior == SKIP_ON_SHUTDOWN) {
+      AutoLock lock(lock_);
+      DCHECK_GT(blocking_shutdown_thread_count_, 0u);
+      blocking_shutdown_thread_count_--;
+      if (shutdown_called_)
+        can_shutdown_cv_.Signal();
+    }
+
+    if (subtle::NoBarrier_Load(&runnable_sequence_hint_) > 0)
+      break;
+  }
+}
+
+void SequencedWorkerPool::Inner::DidFinishBlockingUnsequencedTask() {
+  // Pairs with the barrier in Shutdown(). See |shutdown_hint_|.
+  if (subtle::Barrier_AtomicIncrement(&blocking_unsequenced_task_count_,
+                                      -1) != 0 ||
+      !subtle::Acquire_Load(&shutdown_hint_))
+    return;
+
+  {
+    AutoLock lock(lock_);
+    can_shutdown_cv_.Signal();
+  }
+  // Workers that waited for this task instead of exiting can go now.
+  SignalHasWork();
+}
+
+bool SequencedWorkerPool::Inner::HasUnsequencedTasks() const {
+  return subtle::Acquire_Load(&unsequenced_task_count_) > 0;
+}
+
 bool SequencedWorkerPool::Inner::IsIdle() const {
   lock_.AssertAcquired();
-  return pending_task_count_ == 0 && waiting_thread_count_ == threads_.size();
+  return pending_task_count_ == 0 && waiting_thread_count_ == threads_.size() &&
+      !HasUnsequencedTasks();
 }
 
 int SequencedWorkerPool::Inner::LockedGetNamedTokenID(
@@ -732,6 +1040,42 @@ bool SequencedWorkerPool::Inner::GetWork(
     std::vector<Closure>* delete_these_outside_lock) {
   lock_.AssertAcquired();
 
+  if (dispatch_mode_ == WORK_STEALING) {
+    // Every sequence in |runnable_sequences_| can run its first task, so
+    // there is nothing to scan. Tasks that don't block shutdown are deleted
+    // once shutdown has started, as below.
+    bool found_task = false;
+    while (!found_task && !runnable_sequences_.empty()) {
+      int sequence_token_id = runnable_sequences_.front();
+      runnable_sequences_.pop_front();
+      SequenceQueueMap::iterator found =
+          sequence_queues_.find(sequence_token_id);
+      DCHECK(found != sequence_queues_.end());
+      std::deque<SequencedTask>& queue = found->second;
+      while (!queue.empty()) {
+        const SequencedTask& front = queue.front();
+        pending_task_count_--;
+        if (front.shutdown_behavior == BLOCK_SHUTDOWN)
+          blocking_shutdown_pending_task_count_--;
+        if (shutdown_called_ && front.shutdown_behavior != BLOCK_SHUTDOWN) {
+          delete_these_outside_lock->push_back(front.task);
+          queue.pop_front();
+          continue;
+        }
+        *task = front;
+        queue.pop_front();
+        found_task = true;
+        break;
+      }
+      // DidRunWorkerTask puts the sequence back if it still has tasks.
+      if (queue.empty())
+        sequence_queues_.erase(found);
+    }
+    subtle::NoBarrier_Store(&runnable_sequence_hint_,
+                            static_cast<int>(runnable_sequences_.size()));
+    return found_task;
+  }
+
   DCHECK_EQ(pending_tasks_.size(), pending_task_count_);
   UMA_HISTOGRAM_COUNTS_100("SequencedWorkerPool.TaskCount",
                            static_cast<int>(pending_task_count_));
@@ -816,7 +1160,9 @@ int SequencedWorkerPool::Inner::WillRunWorkerTask(const SequencedTask& task) {
   if (task.sequence_token_id)
     current_sequences_.insert(task.sequence_token_id);
 
-  if (task.shutdown_behavior == BLOCK_SHUTDOWN)
+  // Tasks that are already running when shutdown starts are completed, even
+  // the ones that would have been skipped if they hadn't started yet.
+  if (task.shutdown_behavior != CONTINUE_ON_SHUTDOWN)
     blocking_shutdown_thread_count_++;
 
   // We just picked up a task. Since StartAdditionalThreadIfHelpful only
@@ -840,13 +1186,20 @@ int SequencedWorkerPool::Inner::WillRunWorkerTask(const SequencedTask& task) {
 void SequencedWorkerPool::Inner::DidRunWorkerTask(const SequencedTask& task) {
   lock_.AssertAcquired();
 
-  if (task.shutdown_behavior == BLOCK_SHUTDOWN) {
+  if (task.shutdown_behavior != CONTINUE_ON_SHUTDOWN) {
     DCHECK_GT(blocking_shutdown_thread_count_, 0u);
     blocking_shutdown_thread_count_--;
   }
 
-  if (task.sequence_token_id)
+  if (task.sequence_token_id) {
     current_sequences_.erase(task.sequence_token_id);
+    if (dispatch_mode_ == WORK_STEALING &&
+        ContainsKey(sequence_queues_, task.sequence_token_id)) {
+      runnable_sequences_.push_back(task.sequence_token_id);
+      subtle::NoBarrier_Store(&runnable_sequence_hint_,
+                              static_cast<int>(runnable_sequences_.size()));
+    }
+  }
 }
 
 bool SequencedWorkerPool::Inner::IsSequenceTokenRunnable(
@@ -891,20 +1244,29 @@ int SequencedWorkerPool::Inner::PrepareToStartAdditionalThreadIfHelpful() {
   if (!shutdown_called_ &&
       !thread_being_created_ &&
       threads_.size() < max_threads_ &&
-      waiting_thread_count_ == 0) {
-    // We could use an additional thread if there's work to be done.
-    for (std::list<SequencedTask>::iterator i = pending_tasks_.begin();
-         i != pending_tasks_.end(); ++i) {
-      if (IsSequenceTokenRunnable(i->sequence_token_id)) {
-        // Found a runnable task, mark the thread as being started.
-        thread_being_created_ = true;
-        return static_cast<int>(threads_.size() + 1);
-      }
-    }
+      waiting_thread_count_ == 0 &&
+      HasRunnableTask()) {
+    // We could use an additional thread since there's work to be done, so
+    // mark the thread as being started.
+    thread_being_created_ = true;
+    return static_cast<int>(threads_.size() + 1);
   }
   return 0;
 }
 
+bool SequencedWorkerPool::Inner::HasRunnableTask() const {
+  lock_.AssertAcquired();
+  if (dispatch_mode_ == WORK_STEALING)
+    return HasUnsequencedTasks() || !runnable_sequences_.empty();
+
+  for (std::list<SequencedTask>::const_iterator i = pending_tasks_.begin();
+       i != pending_tasks_.end(); ++i) {
+    if (IsSequenceTokenRunnable(i->sequence_token_id))
+      return true;
+  }
+  return false;
+}
+
 void SequencedWorkerPool::Inner::FinishStartingAdditionalThread(
     int thread_number) {
   // Called outside of the lock.
@@ -927,7 +1289,8 @@ bool SequencedWorkerPool::Inner::CanShutdown() const {
   // See PrepareToStartAdditionalThreadIfHelpful for how thread creation works.
   return !thread_being_created_ &&
          blocking_shutdown_thread_count_ == 0 &&
-         blocking_shutdown_pending_task_count_ == 0;
+         blocking_shutdown_pending_task_count_ == 0 &&
+         subtle::Acquire_Load(&blocking_unsequenced_task_count_) == 0;
 }
 
 // SequencedWorkerPool --------------------------------------------------------
@@ -937,16 +1300,29 @@ SequencedWorkerPool::SequencedWorkerPool(
     const std::string& thread_name_prefix)
     : constructor_message_loop_(MessageLoopProxy::current()),
       inner_(new Inner(ALLOW_THIS_IN_INITIALIZER_LIST(this),
-                       max_threads, thread_name_prefix, NULL)) {
+                       max_threads, thread_name_prefix, SHARED_QUEUE,
+                       NULL)) {
+}
+
+SequencedWorkerPool::SequencedWorkerPool(
+    size_t max_threads,
+    const std::string& thread_name_prefix,
+    TestingObserver* observer)
+    : constructor_message_loop_(MessageLoopProxy::current()),
+      inner_(new Inner(ALLOW_THIS_IN_INITIALIZER_LIST(this),
+                       max_threads, thread_name_prefix, SHARED_QUEUE,
+                       observer)) {
 }
 
 SequencedWorkerPool::SequencedWorkerPool(
     size_t max_threads,
     const std::string& thread_name_prefix,
+    DispatchMode dispatch_mode,
     TestingObserver* observer)
     : constructor_message_loop_(MessageLoopProxy::current()),
       inner_(new Inner(ALLOW_THIS_IN_INITIALIZER_LIST(this),
-                       max_threads, thread_name_prefix, observer)) {
+                       max_threads, thread_name_prefix, dispatch_mode,
+                       observer)) {
 }
 
 SequencedWorkerPool::~SequencedWorkerPool() {}
@@ -101,6 +101,20 @@ class BASE_EXPORT SequencedWorkerPool : public TaskRunner {
     BLOCK_SHUTDOWN,
   };
 
+  // Defines how worker threads find the next task to run.
+  enum DispatchMode {
+    // All pending tasks wait in one list guarded by the pool's lock, which
+    // workers scan for a task whose sequence is not already running.
+    SHARED_QUEUE,
+
+    // Unsequenced tasks wait in per-worker queues without touching the pool's
+    // lock, and idle workers steal from busy ones. Each sequence keeps its own
+    // queue and is handed to one worker at a time, so finding a runnable task
+    // never requires a scan. Use this for pools with many threads and high
+    // posting rates.
+    WORK_STEALING,
+  };
+
   // Opaque identifier that defines sequencing of tasks posted to the worker
   // pool.
   class SequenceToken {
@@ -144,6 +158,12 @@ class BASE_EXPORT SequencedWorkerPool : public TaskRunner {
                       const std::string& thread_name_prefix,
                       TestingObserver* observer);
 
+  // Like above, but with the given |dispatch_mode|. |observer| may be NULL.
+  SequencedWorkerPool(size_t max_threads,
+                      const std::string& thread_name_prefix,
+                      DispatchMode dispatch_mode,
+                      TestingObserver* observer);
+
   // Returns a unique token that can be used to sequence tasks posted to
   // PostSequencedWorkerTask(). Valid tokens are alwys nonzero.
   SequenceToken GetSequenceToken();
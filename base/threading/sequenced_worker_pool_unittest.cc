@@ -151,10 +151,12 @@ class TestTracker : public base::RefCountedThreadSafe<TestTracker> {
   size_t started_events_;
 };
 
-class SequencedWorkerPoolTest : public testing::Test {
+// Runs each test against both dispatch modes.
+class SequencedWorkerPoolTest
+    : public testing::TestWithParam<SequencedWorkerPool::DispatchMode> {
  public:
   SequencedWorkerPoolTest()
-      : pool_owner_(kNumWorkerThreads, "test"),
+      : pool_owner_(kNumWorkerThreads, "test", GetParam()),
         tracker_(new TestTracker) {
   }
 
@@ -234,7 +236,7 @@ void EnsureTasksToCompleteCountAndUnblock(scoped_refptr<TestTracker> tracker,
 }
 
 // Tests that same-named tokens have the same ID.
-TEST_F(SequencedWorkerPoolTest, NamedTokens) {
+TEST_P(SequencedWorkerPoolTest, NamedTokens) {
   const std::string name1("hello");
   SequencedWorkerPool::SequenceToken token1 =
       pool()->GetNamedSequenceToken(name1);
@@ -262,7 +264,7 @@ TEST_F(SequencedWorkerPoolTest, NamedTokens) {
 
 // Tests that posting a bunch of tasks (many more than the number of worker
 // threads) runs them all.
-TEST_F(SequencedWorkerPoolTest, LotsOfTasks) {
+TEST_P(SequencedWorkerPoolTest, LotsOfTasks) {
   pool()->PostWorkerTask(FROM_HERE,
                          base::Bind(&TestTracker::SlowTask, tracker(), 0));
 
@@ -280,9 +282,9 @@ TEST_F(SequencedWorkerPoolTest, LotsOfTasks) {
 // worker threads) to two pools simultaneously runs them all twice.
 // This test is meant to shake out any concurrency issues between
 // pools (like histograms).
-TEST_F(SequencedWorkerPoolTest, LotsOfTasksTwoPools) {
-  SequencedWorkerPoolOwner pool1(kNumWorkerThreads, "test1");
-  SequencedWorkerPoolOwner pool2(kNumWorkerThreads, "test2");
+TEST_P(SequencedWorkerPoolTest, LotsOfTasksTwoPools) {
+  SequencedWorkerPoolOwner pool1(kNumWorkerThreads, "test1", GetParam());
+  SequencedWorkerPoolOwner pool2(kNumWorkerThreads, "test2", GetParam());
 
   base::Closure slow_task = base::Bind(&TestTracker::SlowTask, tracker(), 0);
   pool1.pool()->PostWorkerTask(FROM_HERE, slow_task);
@@ -306,7 +308,7 @@ TEST_F(SequencedWorkerPoolTest, LotsOfTasksTwoPools) {
 
 // Test that tasks with the same sequence token are executed in order but don't
 // affect other tasks.
-TEST_F(SequencedWorkerPoolTest, Sequence) {
+TEST_P(SequencedWorkerPoolTest, Sequence) {
   // Fill all the worker threads except one.
   const size_t kNumBackgroundTasks = kNumWorkerThreads - 1;
   ThreadBlocker background_blocker;
@@ -367,7 +369,7 @@ TEST_F(SequencedWorkerPoolTest, Sequence) {
 
 // Tests that unrun tasks are discarded properly according to their shutdown
 // mode.
-TEST_F(SequencedWorkerPoolTest, DiscardOnShutdown) {
+TEST_P(SequencedWorkerPoolTest, DiscardOnShutdown) {
   // Start tasks to take all the threads and block them.
   EnsureAllWorkersCreated();
   ThreadBlocker blocker;
@@ -412,7 +414,7 @@ TEST_F(SequencedWorkerPoolTest, DiscardOnShutdown) {
 }
 
 // Tests that CONTINUE_ON_SHUTDOWN tasks don't block shutdown.
-TEST_F(SequencedWorkerPoolTest, ContinueOnShutdown) {
+TEST_P(SequencedWorkerPoolTest, ContinueOnShutdown) {
   scoped_refptr<TaskRunner> runner(pool()->GetTaskRunnerWithShutdownBehavior(
       SequencedWorkerPool::CONTINUE_ON_SHUTDOWN));
   scoped_refptr<SequencedTaskRunner> sequenced_runner(
@@ -458,10 +460,30 @@ TEST_F(SequencedWorkerPoolTest, ContinueOnShutdown) {
   EXPECT_EQ(3u, result.size());
 }
 
+// Tests that SKIP_ON_SHUTDOWN tasks that are already running when shutdown
+// starts finish before Shutdown() returns.
+TEST_P(SequencedWorkerPoolTest, SkipOnShutdownInProgress) {
+  EnsureAllWorkersCreated();
+  ThreadBlocker blocker;
+  pool()->PostWorkerTaskWithShutdownBehavior(
+      FROM_HERE,
+      base::Bind(&TestTracker::BlockTask, tracker(), 0, &blocker),
+      SequencedWorkerPool::SKIP_ON_SHUTDOWN);
+  tracker()->WaitUntilTasksBlocked(1);
+
+  // Shutdown() has to wait for the running task, which is let go only then.
+  SetWillWaitForShutdownCallback(
+      base::Bind(&EnsureTasksToCompleteCountAndUnblock,
+                 scoped_refptr<TestTracker>(tracker()), 0, &blocker, 1));
+  pool()->Shutdown();
+
+  EXPECT_EQ(1u, tracker()->WaitUntilTasksComplete(0).size());
+}
+
 // Ensure all worker threads are created, and then trigger a spurious
 // work signal. This shouldn't cause any other work signals to be
 // triggered. This is a regression test for http://crbug.com/117469.
-TEST_F(SequencedWorkerPoolTest, SpuriousWorkSignal) {
+TEST_P(SequencedWorkerPoolTest, SpuriousWorkSignal) {
   EnsureAllWorkersCreated();
   int old_has_work_call_count = has_work_call_count();
   pool()->SignalHasWorkForTesting();
@@ -486,7 +508,7 @@ void IsRunningOnCurrentThreadTask(
 }
 
 // Verify correctness of the IsRunningSequenceOnCurrentThread method.
-TEST_F(SequencedWorkerPoolTest, IsRunningOnCurrentThread) {
+TEST_P(SequencedWorkerPoolTest, IsRunningOnCurrentThread) {
   SequencedWorkerPool::SequenceToken token1 = pool()->GetSequenceToken();
   SequencedWorkerPool::SequenceToken token2 = pool()->GetSequenceToken();
   SequencedWorkerPool::SequenceToken unsequenced_token;
@@ -522,6 +544,70 @@ TEST_F(SequencedWorkerPoolTest, IsRunningOnCurrentThread) {
   unused_pool->Shutdown();
 }
 
+// Runs a task and then posts the next unsequenced task of the chain from
+// inside the worker thread until |remaining| reaches zero.
+void PostChainedTask(SequencedWorkerPool* pool,
+                     scoped_refptr<TestTracker> tracker,
+                     int id,
+                     int remaining) {
+  tracker->FastTask(id);
+  if (remaining > 0) {
+    pool->PostWorkerTask(FROM_HERE,
+                         base::Bind(&PostChainedTask, base::Unretained(pool),
+                                    tracker, id + 1, remaining - 1));
+  }
+}
+
+// Mixes sequenced tasks posted from the main thread with unsequenced tasks
+// posted from workers, and checks that everything runs and that each
+// sequence runs in order.
+TEST_P(SequencedWorkerPoolTest, TasksPostedFromWorkers) {
+  const int kNumSequences = 4;
+  const int kNumChains = 4;
+  const int kTasksPerChain = 50;
+  const int kIdsPerChain = 1000;
+
+  for (int i = 0; i < kNumChains; ++i) {
+    pool()->PostWorkerTask(
+        FROM_HERE,
+        base::Bind(&PostChainedTask, base::Unretained(pool().get()),
+                   scoped_refptr<TestTracker>(tracker()),
+                   (kNumSequences + i) * kIdsPerChain, kTasksPerChain - 1));
+  }
+  std::vector<SequencedWorkerPool::SequenceToken> tokens;
+  for (int i = 0; i < kNumSequences; ++i)
+    tokens.push_back(pool()->GetSequenceToken());
+  for (int j = 0; j < kTasksPerChain; ++j) {
+    for (int i = 0; i < kNumSequences; ++i) {
+      pool()->PostSequencedWorkerTask(
+          tokens[i], FROM_HERE,
+          base::Bind(&TestTracker::FastTask, tracker(), i * kIdsPerChain + j));
+    }
+  }
+
+  const size_t kNumTasks = (kNumSequences + kNumChains) * kTasksPerChain;
+  std::vector<int> result = tracker()->WaitUntilTasksComplete(kNumTasks);
+  ASSERT_EQ(kNumTasks, result.size());
+
+  std::vector<int> next_expected(kNumSequences + kNumChains);
+  for (size_t i = 0; i < result.size(); ++i) {
+    int chain = result[i] / kIdsPerChain;
+    if (chain < kNumSequences) {
+      EXPECT_EQ(chain * kIdsPerChain + next_expected[chain], result[i]);
+    }
+    ++next_expected[chain];
+  }
+  for (int i = 0; i < kNumSequences + kNumChains; ++i)
+    EXPECT_EQ(kTasksPerChain, next_expected[i]);
+
+  pool()->FlushForTesting();
+}
+
+INSTANTIATE_TEST_CASE_P(SharedQueue, SequencedWorkerPoolTest,
+                        testing::Values(SequencedWorkerPool::SHARED_QUEUE));
+INSTANTIATE_TEST_CASE_P(WorkStealing, SequencedWorkerPoolTest,
+                        testing::Values(SequencedWorkerPool::WORK_STEALING));
+
 class SequencedWorkerPoolTaskRunnerTestDelegate {
  public:
   SequencedWorkerPoolTaskRunnerTestDelegate() {}
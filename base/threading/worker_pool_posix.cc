@@ -4,13 +4,17 @@
 
 #include "base/threading/worker_pool_posix.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/callback.h"
 #include "base/debug/trace_event.h"
 #include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
+#include "base/metrics/histogram.h"
 #include "base/stringprintf.h"
+#include "base/sys_info.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/thread_local.h"
 #include "base/threading/worker_pool.h"
@@ -26,6 +30,9 @@ base::LazyInstance<ThreadLocalBoolean>::Leaky
     g_worker_pool_running_on_this_thread = LAZY_INSTANCE_INITIALIZER;
 
 const int kIdleSecondsBeforeExit = 10 * 60;
+// The shared pool aims for one runnable thread per core, but no fewer than
+// this many, since much of its work is IO that is not marked as blocking.
+const int kMinRunnableThreads = 4;
 // A stack size of 64 KB is too small for the CERT_PKIXVerifyCert
 // function of NSS because of NSS bug 439169.
 const int kWorkerThreadStackSize = 128 * 1024;
@@ -43,17 +50,28 @@ class WorkerPoolImpl {
 };
 
 WorkerPoolImpl::WorkerPoolImpl()
-    : pool_(new base::PosixDynamicThreadPool("WorkerPool",
-                                             kIdleSecondsBeforeExit)) {
+    : pool_(new base::PosixDynamicThreadPool(
+          "WorkerPool", kIdleSecondsBeforeExit,
+          std::max(kMinRunnableThreads, SysInfo::NumberOfProcessors()))) {
 }
 
 WorkerPoolImpl::~WorkerPoolImpl() {
   pool_->Terminate();
 }
 
+// Slow tasks are expected to block, so they hold on to their thread without
+// counting against the target.
+void RunSlowTask(const base::Closure& task) {
+  ScopedMayBlock may_block;
+  task.Run();
+}
+
 void WorkerPoolImpl::PostTask(const tracked_objects::Location& from_here,
                               const base::Closure& task, bool task_is_slow) {
-  pool_->PostTask(from_here, task);
+  if (task_is_slow)
+    pool_->PostTask(from_here, base::Bind(&RunSlowTask, task));
+  else
+    pool_->PostTask(from_here, task);
 }
 
 base::LazyInstance<WorkerPoolImpl> g_lazy_worker_pool =
@@ -81,6 +99,7 @@ void WorkerThread::ThreadMain() {
       "%s/%d", name_prefix_.c_str(), PlatformThread::CurrentId());
   // Note |name.c_str()| must remain valid for for the whole life of the thread.
   PlatformThread::SetName(name.c_str());
+  ScopedMayBlock::SetObserverForCurrentThread(pool_.get());
 
   for (;;) {
     PendingTask pending_task = pool_->WaitForTask();
@@ -100,6 +119,8 @@ void WorkerThread::ThreadMain() {
         start_time, tracked_objects::ThreadData::NowForEndOfRun());
   }
 
+  ScopedMayBlock::SetObserverForCurrentThread(NULL);
+
   // The WorkerThread is non-joinable, so it deletes itself.
   delete this;
 }
@@ -123,11 +144,30 @@ PosixDynamicThreadPool::PosixDynamicThreadPool(
     int idle_seconds_before_exit)
     : name_prefix_(name_prefix),
       idle_seconds_before_exit_(idle_seconds_before_exit),
+      max_runnable_threads_(0),
       pending_tasks_available_cv_(&lock_),
       num_idle_threads_(0),
+      num_threads_(0),
+      num_blocked_threads_(0),
       terminated_(false),
       num_idle_threads_cv_(NULL) {}
 
+PosixDynamicThreadPool::PosixDynamicThreadPool(
+    const std::string& name_prefix,
+    int idle_seconds_before_exit,
+    int max_runnable_threads)
+    : name_prefix_(name_prefix),
+      idle_seconds_before_exit_(idle_seconds_before_exit),
+      max_runnable_threads_(max_runnable_threads),
+      pending_tasks_available_cv_(&lock_),
+      num_idle_threads_(0),
+      num_threads_(0),
+      num_blocked_threads_(0),
+      terminated_(false),
+      num_idle_threads_cv_(NULL) {
+  DCHECK_GT(max_runnable_threads, 0);
+}
+
 PosixDynamicThreadPool::~PosixDynamicThreadPool() {
   while (!pending_tasks_.empty())
     pending_tasks_.pop();
@@ -156,24 +196,65 @@ void PosixDynamicThreadPool::AddTask(PendingTask* pending_task) {
 
   pending_tasks_.push(*pending_task);
   pending_task->task.Reset();
+  UMA_HISTOGRAM_COUNTS_100("WorkerPool.QueueDepth", pending_tasks_.size());
 
-  // We have enough worker threads.
-  if (static_cast<size_t>(num_idle_threads_) >= pending_tasks_.size()) {
+  // We have enough worker threads, or as many as we may have.
+  if (static_cast<size_t>(num_idle_threads_) >= pending_tasks_.size() ||
+      !CanAddThread()) {
     pending_tasks_available_cv_.Signal();
   } else {
-    // The new PlatformThread will take ownership of the WorkerThread object,
-    // which will delete itself on exit.
-    WorkerThread* worker =
-        new WorkerThread(name_prefix_, this);
-    PlatformThread::CreateNonJoinable(kWorkerThreadStackSize, worker);
+    AddThread();
   }
 }
 
+bool PosixDynamicThreadPool::CanAddThread() const {
+  lock_.AssertAcquired();
+  return max_runnable_threads_ == 0 ||
+      num_threads_ - num_blocked_threads_ < max_runnable_threads_;
+}
+
+void PosixDynamicThreadPool::AddThread() {
+  lock_.AssertAcquired();
+  // The new PlatformThread will take ownership of the WorkerThread object,
+  // which will delete itself on exit.
+  WorkerThread* worker =
+      new WorkerThread(name_prefix_, this);
+  if (PlatformThread::CreateNonJoinable(kWorkerThreadStackSize, worker))
+    num_threads_++;
+  else
+    delete worker;
+}
+
+void PosixDynamicThreadPool::OnBlockingStarted() {
+  AutoLock locked(lock_);
+  num_blocked_threads_++;
+  // One runnable thread fewer; bring in one for the work it leaves waiting.
+  // Without a target, AddTask() has already found a thread for every task.
+  if (max_runnable_threads_ > 0 && !terminated_ &&
+      static_cast<size_t>(num_idle_threads_) < pending_tasks_.size() &&
+      CanAddThread()) {
+    AddThread();
+  }
+}
+
+void PosixDynamicThreadPool::OnBlockingEnded() {
+  AutoLock locked(lock_);
+  num_blocked_threads_--;
+  DCHECK_GE(num_blocked_threads_, 0);
+}
+
 PendingTask PosixDynamicThreadPool::WaitForTask() {
   AutoLock locked(lock_);
 
-  if (terminated_)
+  // Threads over the target are let go as they come back for more work.
+  if (terminated_ ||
+      (max_runnable_threads_ > 0 &&
+       num_threads_ - num_blocked_threads_ > max_runnable_threads_)) {
+    num_threads_--;
+    if (num_idle_threads_cv_.get())
+      num_idle_threads_cv_->Signal();
     return PendingTask(FROM_HERE, base::Closure());
+  }
 
   if (pending_tasks_.empty()) {  // No work available, wait for work.
     num_idle_threads_++;
@@ -187,12 +268,15 @@ PendingTask PosixDynamicThreadPool::WaitForTask() {
     if (pending_tasks_.empty()) {
       // We waited for work, but there's still no work.  Return NULL to signal
       // the thread to terminate.
+      num_threads_--;
       return PendingTask(FROM_HERE, base::Closure());
     }
   }
 
   PendingTask pending_task = pending_tasks_.front();
   pending_tasks_.pop();
+  UMA_HISTOGRAM_TIMES("WorkerPool.TaskWaitTime",
+                      TimeTicks::NowFast() - pending_task.time_posted);
   return pending_task;
 }
 
@@ -17,6 +17,13 @@
 // worker threads exit.  The owner of PosixDynamicThreadPool should likewise
 // maintain a scoped_refptr to the PosixDynamicThreadPool instance.
 //
+// A pool may be given a target number of runnable threads.  It then only adds
+// a thread beyond that target while some of its threads are blocked inside a
+// ScopedMayBlock region, such as a WaitableEvent::Wait(), and lets threads
+// exit as soon as they find the pool over its target once they are done with
+// their task.  Threads that block without saying so count as runnable, so
+// under a target the pool does not grow for them.
+//
 // NOTE: The classes defined in this file are only meant for use by the POSIX
 // implementation of WorkerPool.  No one else should be using these classes.
 // These symbols are exported in a header purely for testing purposes.
@@ -30,6 +37,7 @@
 
 #include "base/basictypes.h"
 #include "base/callback_forward.h"
+#include "base/compiler_specific.h"
 #include "base/location.h"
 #include "base/time.h"
 #include "base/memory/ref_counted.h"
@@ -38,6 +46,7 @@
 #include "base/synchronization/condition_variable.h"
 #include "base/synchronization/lock.h"
 #include "base/threading/platform_thread.h"
+#include "base/threading/scoped_may_block.h"
 #include "base/tracked_objects.h"
 
 class Task;
@@ -45,15 +54,23 @@ class Task;
 namespace base {
 
 class BASE_EXPORT PosixDynamicThreadPool
-    : public RefCountedThreadSafe<PosixDynamicThreadPool> {
+    : public RefCountedThreadSafe<PosixDynamicThreadPool>,
+      public ScopedMayBlock::Observer {
  public:
   class PosixDynamicThreadPoolPeer;
 
   // All worker threads will share the same |name_prefix|.  They will exit after
-  // |idle_seconds_before_exit|.
+  // |idle_seconds_before_exit|.  The pool adds a thread whenever no idle one
+  // can take a new task.
   PosixDynamicThreadPool(const std::string& name_prefix,
                          int idle_seconds_before_exit);
 
+  // Same as above, but aims for |max_runnable_threads| threads that are not
+  // blocked.  See the top of this file.
+  PosixDynamicThreadPool(const std::string& name_prefix,
+                         int idle_seconds_before_exit,
+                         int max_runnable_threads);
+
   // Indicates that the thread pool is going away.  Stops handing out tasks to
   // worker threads.  Wakes up all the idle threads to let them exit.
   void Terminate();
@@ -66,18 +83,31 @@ class BASE_EXPORT PosixDynamicThreadPool
   // work from the thread pool.  Returns NULL if no work is available.
   PendingTask WaitForTask();
 
+  // ScopedMayBlock::Observer methods, called on the worker threads:
+  virtual void OnBlockingStarted() OVERRIDE;
+  virtual void OnBlockingEnded() OVERRIDE;
+
  private:
   friend class RefCountedThreadSafe<PosixDynamicThreadPool>;
   friend class PosixDynamicThreadPoolPeer;
 
-  ~PosixDynamicThreadPool();
+  virtual ~PosixDynamicThreadPool();
 
   // Adds pending_task to the thread pool.  This function will clear
   // |pending_task->task|.
   void AddTask(PendingTask* pending_task);
 
+  // Whether the target number of runnable threads leaves room for one more.
+  // Must be called with |lock_| held.
+  bool CanAddThread() const;
+
+  // Starts a worker thread.  Must be called with |lock_| held.
+  void AddThread();
+
   const std::string name_prefix_;
   const int idle_seconds_before_exit_;
+  // 0 if the number of threads is not limited.
+  const int max_runnable_threads_;
 
   Lock lock_;  // Protects all the variables below.
 
@@ -86,10 +116,15 @@ class BASE_EXPORT PosixDynamicThreadPool
   // is being deleted and they can exit.
   ConditionVariable pending_tasks_available_cv_;
   int num_idle_threads_;
+  // All worker threads, including the idle and the blocked ones.
+  int num_threads_;
+  // Worker threads inside a ScopedMayBlock region.
+  int num_blocked_threads_;
   TaskQueue pending_tasks_;
   bool terminated_;
-  // Only used for tests to ensure correct thread ordering.  It will always be
-  // NULL in non-test code.
+  // Only used for tests to ensure correct thread ordering.  Signaled when a
+  // thread goes idle, wakes up or leaves for being over the target.  It will
+  // always be NULL in non-test code.
   scoped_ptr<ConditionVariable> num_idle_threads_cv_;
 
   DISALLOW_COPY_AND_ASSIGN(PosixDynamicThreadPool);
@@ -30,6 +30,8 @@ class PosixDynamicThreadPool::PosixDynamicThreadPoolPeer {
     return pool_->pending_tasks_;
   }
   int num_idle_threads() const { return pool_->num_idle_threads_; }
+  int num_threads() const { return pool_->num_threads_; }
+  int num_blocked_threads() const { return pool_->num_blocked_threads_; }
   ConditionVariable* num_idle_threads_cv() {
     return pool_->num_idle_threads_cv_.get();
   }
@@ -97,6 +99,15 @@ class PosixDynamicThreadPoolTest : public testing::Test {
         num_waiting_to_start_cv_(&num_waiting_to_start_lock_),
         start_(true, false) {}
 
+  explicit PosixDynamicThreadPoolTest(int max_runnable_threads)
+      : pool_(new base::PosixDynamicThreadPool("dynamic_pool", 60*60,
+                                               max_runnable_threads)),
+        peer_(pool_.get()),
+        counter_(0),
+        num_waiting_to_start_(0),
+        num_waiting_to_start_cv_(&num_waiting_to_start_lock_),
+        start_(true, false) {}
+
   virtual void SetUp() OVERRIDE {
     peer_.set_num_idle_threads_cv(new ConditionVariable(peer_.lock()));
   }
@@ -120,6 +131,16 @@ class PosixDynamicThreadPoolTest : public testing::Test {
     }
   }
 
+  // Waits until the queue is empty with |num_threads| threads left, all idle.
+  void WaitForAllTasksDone(int num_threads) {
+    base::AutoLock pool_locked(*peer_.lock());
+    while (!peer_.pending_tasks().empty() ||
+           peer_.num_threads() != num_threads ||
+           peer_.num_idle_threads() != num_threads) {
+      peer_.num_idle_threads_cv()->Wait();
+    }
+  }
+
   base::Closure CreateNewIncrementingTaskCallback() {
     return base::Bind(&IncrementingTask, &counter_lock_, &counter_,
                       &unique_threads_lock_, &unique_threads_);
@@ -146,6 +167,14 @@ class PosixDynamicThreadPoolTest : public testing::Test {
   base::WaitableEvent start_;
 };
 
+// Runs the tests on a pool that aims for a single runnable thread.
+class PosixDynamicThreadPoolSingleRunnableTest
+    : public PosixDynamicThreadPoolTest {
+ protected:
+  PosixDynamicThreadPoolSingleRunnableTest()
+      : PosixDynamicThreadPoolTest(1) {}
+};
+
 }  // namespace
 
 TEST_F(PosixDynamicThreadPoolTest, Basic) {
@@ -251,4 +280,38 @@ TEST_F(PosixDynamicThreadPoolTest, Complex) {
   EXPECT_EQ(4, counter_);
 }
 
+TEST_F(PosixDynamicThreadPoolSingleRunnableTest, QueuesBehindRunnableThread) {
+  // Without the target, three tasks posted at once would usually get three
+  // threads.
+  pool_->PostTask(FROM_HERE, CreateNewIncrementingTaskCallback());
+  pool_->PostTask(FROM_HERE, CreateNewIncrementingTaskCallback());
+  pool_->PostTask(FROM_HERE, CreateNewIncrementingTaskCallback());
+
+  WaitForAllTasksDone(1);
+
+  EXPECT_EQ(1U, unique_threads_.size());
+  EXPECT_EQ(3, counter_);
+}
+
+TEST_F(PosixDynamicThreadPoolSingleRunnableTest, GrowsWhileBlocked) {
+  // Both tasks wait on |start_|, which only works out if the pool brings in
+  // a second thread while the first one is blocked.
+  pool_->PostTask(FROM_HERE, CreateNewBlockingIncrementingTaskCallback());
+  pool_->PostTask(FROM_HERE, CreateNewBlockingIncrementingTaskCallback());
+
+  WaitForTasksToStart(2);
+  {
+    base::AutoLock pool_locked(*peer_.lock());
+    EXPECT_EQ(2, peer_.num_threads());
+  }
+  start_.Signal();
+
+  // Once nothing blocks, the pool shrinks back to its target.
+  WaitForAllTasksDone(1);
+
+  EXPECT_EQ(2U, unique_threads_.size());
+  EXPECT_EQ(0, peer_.num_blocked_threads());
+  EXPECT_EQ(2, counter_);
+}
+
 }  // namespace base
@@ -489,6 +489,13 @@ class BASE_EXPORT TimeTicks {
   // SHOULD ONLY BE USED WHEN IT IS REALLY NEEDED.
   static TimeTicks HighResNow();
 
+  // Like Now(), but meant for instrumentation that reads the clock several
+  // times per task, such as tracing and task timing. Where the processor has
+  // a time stamp counter that ticks at a constant rate, it is read instead of
+  // calling into the kernel, and scaled to follow Now() within a millisecond.
+  // Elsewhere, this is Now().
+  static TimeTicks NowFast();
+
   // Returns the current system trace time or, if none is defined, the current
   // high-res time (i.e. HighResNow()). On systems where a global trace clock
   // is defined, timestamping TraceEvents's with this value guarantees
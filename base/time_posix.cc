@@ -8,11 +8,21 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <limits>
 
 #include "base/basictypes.h"
 #include "base/logging.h"
 
+#if defined(OS_LINUX) && defined(ARCH_CPU_X86_64)
+#include <math.h>
+
+#include "base/atomicops.h"
+#include "base/cpu.h"
+#include "base/lazy_instance.h"
+#include "base/synchronization/lock.h"
+#endif
+
 #if defined(OS_ANDROID)
 #include "base/os_compat_android.h"
 #elif defined(OS_NACL)
@@ -255,11 +265,251 @@ TimeTicks TimeTicks::NowFromSystemTraceTime() {
 
 // static
 TimeTicks TimeTicks::NowFromSystemTraceTime() {
-  return HighResNow();
+  return NowFast();
 }
 
 #endif // defined(OS_CHROMEOS)
 
+#if defined(OS_LINUX) && defined(ARCH_CPU_X86_64)
+
+namespace {
+
+// Time is read from the counter for this long between two rescales.
+const int64 kRescaleIntervalMicroseconds =
+    250 * Time::kMicrosecondsPerMillisecond;
+
+// Two rescales are at least this far apart, so that a processor whose counter
+// is behind the others doesn't rescale on every read.
+const int64 kMinRescaleSpacingMicroseconds = kRescaleIntervalMicroseconds / 4;
+
+// Now() is used until the counter has been measured for this long.
+const int64 kCalibrationMicroseconds = 10 * Time::kMicrosecondsPerMillisecond;
+
+// The scales are fixed point numbers with this many fractional bits.
+const int kScaleShift = 32;
+
+inline int64 ReadTimeStampCounter() {
+  uint32 low;
+  uint32 high;
+  __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+  return (static_cast<int64>(high) << 32) | low;
+}
+
+// Keeps the compiler from moving memory accesses across it. The processor
+// doesn't reorder loads with other loads, nor stores with other stores.
+inline void CompilerBarrier() {
+  __asm__ __volatile__("" : : : "memory");
+}
+
+// Turns the time stamp counter into TimeTicks. The counter is measured against
+// TimeTicks::Now() since the first read; every kRescaleIntervalMicroseconds,
+// one of the readers takes a new scale from that measure and starts it from
+// Now(), so that errors don't accumulate. A clock that ran ahead of Now() is
+// slowed down over the next interval instead of going backwards, and a new
+// scale starts past every time the previous one gave.
+//
+// Readers don't lock or write: the scales are kept in a ring, each stamped
+// with the generation it was published as, and a reader that finds the stamp
+// changed under it reads again. The times read from Now() when the counter
+// can't be used are kept as a floor that the counter's times never go under.
+class TscClock {
+ public:
+  TscClock()
+      : enabled_(CPU().has_non_stop_time_stamp_counter()),
+        generation_(0),
+        floor_ticks_(0),
+        start_tsc_(0),
+        start_ticks_(0),
+        last_rescale_ticks_(0) {
+    if (enabled_) {
+      start_tsc_ = ReadTimeStampCounter();
+      start_ticks_ = TimeTicks::Now().ToInternalValue();
+    }
+  }
+
+  TimeTicks Now() {
+    if (!enabled_)
+      return TimeTicks::Now();
+
+    for (;;) {
+      subtle::Atomic32 generation = subtle::Acquire_Load(&generation_);
+      int64 tsc = ReadTimeStampCounter();
+      if (!generation) {
+        int64 now = TimeTicks::Now().ToInternalValue();
+        if (now - start_ticks_ >= kCalibrationMicroseconds)
+          Rescale(tsc, now);
+        return RaiseFloor(now);
+      }
+
+      Scale scale;
+      if (!ReadScale(generation, &scale))
+        continue;
+
+      int64 elapsed = tsc - scale.tsc;
+      if (elapsed < 0 || elapsed > scale.max_elapsed) {
+        // The counter of this processor is behind the one the scale started
+        // on, or the clock wasn't read for long enough to overflow the scale.
+        int64 now = TimeTicks::Now().ToInternalValue();
+        Rescale(tsc, now);
+        return RaiseFloor(std::max(now, scale.ticks));
+      }
+
+      int64 ticks =
+          scale.ticks + ((elapsed * scale.multiplier) >> kScaleShift);
+      if (elapsed >= scale.rescale_elapsed)
+        Rescale(tsc, TimeTicks::Now().ToInternalValue());
+      return TimeTicks::FromInternalValue(
+          std::max(ticks, subtle::NoBarrier_Load(&floor_ticks_)));
+    }
+  }
+
+ private:
+  struct Scale {
+    // The generation the scale was published as, or 0 while it is written.
+    subtle::Atomic32 generation;
+    // The counter and the time the scale starts at.
+    int64 tsc;
+    int64 ticks;
+    // Microseconds per counter tick, shifted left by kScaleShift.
+    int64 multiplier;
+    // The counter ticks after which the next scale is taken.
+    int64 rescale_elapsed;
+    // The counter ticks past which the scale overflows.
+    int64 max_elapsed;
+  };
+
+  static const int kScaleCount = 4;
+
+  // Copies the scale of |generation| to |scale|. Returns false if a rescale
+  // wrote over it meanwhile, which takes a reader held up for an interval.
+  bool ReadScale(subtle::Atomic32 generation, Scale* scale) const {
+    const Scale& slot = scales_[generation % kScaleCount];
+    if (subtle::Acquire_Load(&slot.generation) != generation)
+      return false;
+    *scale = slot;
+    CompilerBarrier();
+    return subtle::NoBarrier_Load(&slot.generation) == generation;
+  }
+
+  // Makes |ticks| the floor if it is above it, and returns the floor.
+  TimeTicks RaiseFloor(int64 ticks) {
+    subtle::Atomic64 floor = subtle::NoBarrier_Load(&floor_ticks_);
+    while (ticks > floor) {
+      subtle::Atomic64 previous =
+          subtle::NoBarrier_CompareAndSwap(&floor_ticks_, floor, ticks);
+      if (previous == floor)
+        return TimeTicks::FromInternalValue(ticks);
+      floor = previous;
+    }
+    return TimeTicks::FromInternalValue(floor);
+  }
+
+  // Starts a new scale at |tsc|, when Now() is |now|. Only one thread
+  // rescales at a time, and not more often than every
+  // kMinRescaleSpacingMicroseconds; the others keep the current scale
+  // meanwhile.
+  void Rescale(int64 tsc, int64 now) {
+    if (!lock_.Try())
+      return;
+    subtle::Atomic32 generation = subtle::NoBarrier_Load(&generation_);
+    if (generation &&
+        now - last_rescale_ticks_ < kMinRescaleSpacingMicroseconds) {
+      lock_.Release();
+      return;
+    }
+
+    int64 elapsed_tsc = tsc - start_tsc_;
+    int64 elapsed_ticks = now - start_ticks_;
+    if (elapsed_tsc > 0 && elapsed_ticks > 0) {
+      double microseconds_per_tick =
+          static_cast<double>(elapsed_ticks) / elapsed_tsc;
+      int64 interval_tsc = static_cast<int64>(
+          kRescaleIntervalMicroseconds / microseconds_per_tick);
+
+      // The new scale starts past the time the current one gives for |tsc|.
+      // The extra microsecond covers the readers that use the current scale
+      // until the new one is published.
+      int64 fast_ticks = subtle::NoBarrier_Load(&floor_ticks_);
+      if (generation) {
+        // Only this thread writes the scales, so it reads them as is.
+        const Scale& current = scales_[generation % kScaleCount];
+        int64 elapsed = tsc - current.tsc;
+        if (elapsed >= 0 && elapsed <= current.max_elapsed) {
+          fast_ticks = std::max(fast_ticks, current.ticks + 1 +
+              ((elapsed * current.multiplier) >> kScaleShift));
+        }
+      }
+
+      // A clock ahead of Now() continues from where it is, and catches up
+      // with Now() by the end of the interval.
+      int64 ahead = std::min(fast_ticks - now,
+                             kRescaleIntervalMicroseconds / 2);
+      if (ahead > 0) {
+        microseconds_per_tick *=
+            static_cast<double>(kRescaleIntervalMicroseconds - ahead) /
+            kRescaleIntervalMicroseconds;
+      }
+
+      subtle::Atomic32 next = generation + 1;
+      Scale& scale = scales_[next % kScaleCount];
+      subtle::NoBarrier_Store(&scale.generation, 0);
+      CompilerBarrier();
+      scale.tsc = tsc;
+      scale.ticks = std::max(fast_ticks, now);
+      scale.multiplier = static_cast<int64>(
+          ldexp(microseconds_per_tick, kScaleShift));
+      scale.rescale_elapsed = interval_tsc;
+      scale.max_elapsed = 16 * interval_tsc;
+      subtle::Release_Store(&scale.generation, next);
+      subtle::Release_Store(&generation_, next);
+      last_rescale_ticks_ = now;
+    }
+
+    lock_.Release();
+  }
+
+  // Whether the counter ticks at a constant rate.
+  const bool enabled_;
+
+  // The generation of the current scale, which is in |scales_| at the
+  // generation modulo kScaleCount, or 0 while calibrating.
+  subtle::Atomic32 generation_;
+  Scale scales_[kScaleCount];
+
+  // The latest time returned from Now() rather than from the counter.
+  subtle::Atomic64 floor_ticks_;
+
+  // The counter and Now() when the clock was first read.
+  int64 start_tsc_;
+  int64 start_ticks_;
+
+  // Now() when the current scale was taken. Guarded by |lock_|.
+  int64 last_rescale_ticks_;
+
+  // Held while rescaling.
+  Lock lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(TscClock);
+};
+
+LazyInstance<TscClock>::Leaky g_tsc_clock = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+// static
+TimeTicks TimeTicks::NowFast() {
+  return g_tsc_clock.Get().Now();
+}
+
+#else
+
+// static
+TimeTicks TimeTicks::NowFast() {
+  return Now();
+}
+
+#endif  // defined(OS_LINUX) && defined(ARCH_CPU_X86_64)
+
 #endif  // !OS_MACOSX
 
 // static
@@ -7,6 +7,7 @@
 #include <time.h>
 
 #include "base/compiler_specific.h"
+#include "base/synchronization/lock.h"
 #include "base/threading/platform_thread.h"
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -554,6 +555,80 @@ TEST(TimeTicks, NowFromSystemTraceTime) {
   HighResClockTest(&TimeTicks::NowFromSystemTraceTime);
 }
 
+TEST(TimeTicks, NowFast) {
+  HighResClockTest(&TimeTicks::NowFast);
+
+  // NowFast() follows Now() across a few rescales of the counter.
+  const TimeDelta kMaxDrift = TimeDelta::FromMilliseconds(2);
+  for (int index = 0; index < 300; index++) {
+    TimeTicks before = TimeTicks::Now();
+    TimeTicks fast = TimeTicks::NowFast();
+    TimeTicks after = TimeTicks::Now();
+    EXPECT_LE(before - kMaxDrift, fast);
+    EXPECT_GE(after + kMaxDrift, fast);
+    base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(1));
+  }
+}
+
+namespace {
+
+// Reads NowFast() on its own thread, checking each time against the latest
+// time read on any of the threads.
+class NowFastReader : public base::PlatformThread::Delegate {
+ public:
+  NowFastReader(base::Lock* lock, TimeTicks* latest, TimeTicks end)
+      : lock_(lock),
+        latest_(latest),
+        end_(end),
+        backwards_(0) {
+  }
+
+  virtual void ThreadMain() OVERRIDE {
+    for (;;) {
+      base::AutoLock auto_lock(*lock_);
+      TimeTicks now = TimeTicks::NowFast();
+      if (now < *latest_)
+        backwards_++;
+      else
+        *latest_ = now;
+      if (now >= end_)
+        return;
+    }
+  }
+
+  int backwards() const { return backwards_; }
+
+ private:
+  base::Lock* lock_;
+  TimeTicks* latest_;
+  const TimeTicks end_;
+  int backwards_;
+
+  DISALLOW_COPY_AND_ASSIGN(NowFastReader);
+};
+
+}  // namespace
+
+// NowFast() doesn't go backwards across threads, through a few rescales.
+TEST(TimeTicks, NowFastIsMonotonicAcrossThreads) {
+  const int kThreadCount = 4;
+  base::Lock lock;
+  TimeTicks latest;
+  TimeTicks end = TimeTicks::NowFast() + TimeDelta::FromMilliseconds(600);
+
+  NowFastReader* readers[kThreadCount];
+  base::PlatformThreadHandle handles[kThreadCount];
+  for (int i = 0; i < kThreadCount; i++) {
+    readers[i] = new NowFastReader(&lock, &latest, end);
+    ASSERT_TRUE(base::PlatformThread::Create(0, readers[i], &handles[i]));
+  }
+  for (int i = 0; i < kThreadCount; i++) {
+    base::PlatformThread::Join(handles[i]);
+    EXPECT_EQ(0, readers[i]->backwards());
+    delete readers[i];
+  }
+}
+
 TEST(TimeDelta, FromAndIn) {
   EXPECT_TRUE(TimeDelta::FromDays(2) == TimeDelta::FromHours(48));
   EXPECT_TRUE(TimeDelta::FromHours(3) == TimeDelta::FromMinutes(180));
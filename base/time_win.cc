@@ -435,6 +435,12 @@ TimeTicks TimeTicks::HighResNow() {
   return TimeTicks() + HighResNowSingleton::GetInstance()->Now();
 }
 
+// static
+TimeTicks TimeTicks::NowFast() {
+  // timeGetTime() doesn't enter the kernel.
+  return Now();
+}
+
 // static
 TimeTicks TimeTicks::NowFromSystemTraceTime() {
   return HighResNow();
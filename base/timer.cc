@@ -5,6 +5,7 @@
 #include "base/timer.h"
 
 #include "base/logging.h"
+#include "base/message_loop.h"
 #include "base/single_thread_task_runner.h"
 #include "base/thread_task_runner_handle.h"
 #include "base/threading/platform_thread.h"
@@ -58,6 +59,8 @@ class BaseTimerTaskInternal {
 
 Timer::Timer(bool retain_user_task, bool is_repeating)
     : scheduled_task_(NULL),
+      scheduled_task_loop_(NULL),
+      scheduled_task_id_(0),
       thread_id_(0),
       is_repeating_(is_repeating),
       retain_user_task_(retain_user_task),
@@ -69,6 +72,8 @@ Timer::Timer(const tracked_objects::Location& posted_from,
              const base::Closure& user_task,
              bool is_repeating)
     : scheduled_task_(NULL),
+      scheduled_task_loop_(NULL),
+      scheduled_task_id_(0),
       posted_from_(posted_from),
       delay_(delay),
       user_task_(user_task),
@@ -91,6 +96,7 @@ void Timer::Start(const tracked_objects::Location& posted_from,
 
 void Timer::Stop() {
   is_running_ = false;
+  AbandonScheduledTask();
   if (!retain_user_task_)
     user_task_.Reset();
 }
@@ -131,9 +137,17 @@ void Timer::PostNewScheduledTask(TimeDelta delay) {
   DCHECK(scheduled_task_ == NULL);
   is_running_ = true;
   scheduled_task_ = new BaseTimerTaskInternal(this);
-  ThreadTaskRunnerHandle::Get()->PostDelayedTask(posted_from_,
-      base::Bind(&BaseTimerTaskInternal::Run, base::Owned(scheduled_task_)),
-      delay);
+  base::Closure task =
+      base::Bind(&BaseTimerTaskInternal::Run, base::Owned(scheduled_task_));
+  // Prefer the current MessageLoop, since it can drop the task as soon as the
+  // timer is stopped or reset.
+  scheduled_task_loop_ = MessageLoop::current();
+  if (scheduled_task_loop_) {
+    scheduled_task_id_ = scheduled_task_loop_->PostCancelableDelayedTask(
+        posted_from_, task, delay);
+  } else {
+    ThreadTaskRunnerHandle::Get()->PostDelayedTask(posted_from_, task, delay);
+  }
   scheduled_run_time_ = desired_run_time_ = TimeTicks::Now() + delay;
   // Remember the thread ID that posts the first task -- this will be verified
   // later when the task is abandoned to detect misuse from multiple threads.
@@ -147,6 +161,10 @@ void Timer::AbandonScheduledTask() {
   if (scheduled_task_) {
     scheduled_task_->Abandon();
     scheduled_task_ = NULL;
+    // Deletes the abandoned task, unless this is running from its destructor.
+    if (scheduled_task_loop_)
+      scheduled_task_loop_->CancelDelayedTask(scheduled_task_id_);
+    scheduled_task_loop_ = NULL;
   }
 }
 
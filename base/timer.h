@@ -100,7 +100,8 @@ class BASE_EXPORT Timer {
              const base::Closure& user_task);
 
   // Call this method to stop and cancel the timer.  It is a no-op if the timer
-  // is not running.
+  // is not running.  When the timer runs on a MessageLoop, the scheduled task
+  // is removed from the loop's queue right away.
   void Stop();
 
   // Call this method to reset the timer delay. The user_task_ must be set. If
@@ -126,7 +127,8 @@ class BASE_EXPORT Timer {
   void PostNewScheduledTask(TimeDelta delay);
 
   // Disable scheduled_task_ and abandon it so that it no longer refers back to
-  // this object.
+  // this object.  If it was posted to a MessageLoop, it is also removed from
+  // the loop's delayed work queue.
   void AbandonScheduledTask();
 
   // Called by BaseTimerTaskInternal when the MessageLoop runs it.
@@ -142,6 +144,13 @@ class BASE_EXPORT Timer {
   // RunScheduledTask() at scheduled_run_time_.
   BaseTimerTaskInternal* scheduled_task_;
 
+  // The MessageLoop scheduled_task_ was posted to with
+  // PostCancelableDelayedTask(), and the id it returned.  NULL if the task was
+  // posted to a task runner that is not a MessageLoop, in which case it can
+  // only be abandoned.
+  MessageLoop* scheduled_task_loop_;
+  int scheduled_task_id_;
+
   // Location in user code.
   tracked_objects::Location posted_from_;
   // Delay requested by user.
@@ -156,9 +165,8 @@ class BASE_EXPORT Timer {
   // The desired run time of user_task_. The user may update this at any time,
   // even if their previous request has not run yet. If desired_run_time_ is
   // greater than scheduled_run_time_, a continuation task will be posted to
-  // wait for the remaining time. This allows us to reuse the pending task so as
-  // not to flood the MessageLoop with orphaned tasks when the user code
-  // excessively Stops and Starts the timer.
+  // wait for the remaining time. This allows Reset() to reuse the pending task
+  // instead of replacing it every time the user code pushes the timer back.
   TimeTicks desired_run_time_;
 
   // Thread ID of current MessageLoop for verifying single-threaded usage.
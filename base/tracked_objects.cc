@@ -74,10 +74,12 @@ DeathData::DeathData(int count) {
 
 void DeathData::RecordDeath(const int32 queue_duration,
                             const int32 run_duration,
-                            int32 random_number) {
-  ++count_;
-  queue_duration_sum_ += queue_duration;
-  run_duration_sum_ += run_duration;
+                            int32 random_number,
+                            int count) {
+  DCHECK_GT(count, 0);
+  count_ += count;
+  queue_duration_sum_ += count * queue_duration;
+  run_duration_sum_ += count * run_duration;
 
   if (queue_duration_max_ < queue_duration)
     queue_duration_max_ = queue_duration;
@@ -85,11 +87,12 @@ void DeathData::RecordDeath(const int32 queue_duration,
     run_duration_max_ = run_duration;
 
   // Take a uniformly distributed sample over all durations ever supplied.
-  // The probability that we (instead) use this new sample is 1/count_.  This
-  // results in a completely uniform selection of the sample.
+  // The probability that we (instead) use this new sample is count/count_.
+  // This results in a completely uniform selection of the sample.
   // We ignore the fact that we correlated our selection of a sample of run
   // and queue times.
-  if (0 == (random_number % count_)) {
+  if (static_cast<uint32>(random_number) % count_ <
+      static_cast<uint32>(count)) {
     queue_duration_sample_ = queue_duration;
     run_duration_sample_ = run_duration;
   }
@@ -180,11 +183,11 @@ BirthOnThreadSnapshot::~BirthOnThreadSnapshot() {
 //------------------------------------------------------------------------------
 Births::Births(const Location& location, const ThreadData& current)
     : BirthOnThread(location, current),
-      birth_count_(1) { }
+      birth_count_(0) { }
 
 int Births::birth_count() const { return birth_count_; }
 
-void Births::RecordBirth() { ++birth_count_; }
+void Births::RecordBirth(int count) { birth_count_ += count; }
 
 void Births::ForgetBirth() { --birth_count_; }
 
@@ -229,10 +232,17 @@ base::LazyInstance<base::Lock>::Leaky
 // static
 ThreadData::Status ThreadData::status_ = ThreadData::UNINITIALIZED;
 
+// static
+int ThreadData::sampling_interval_ = 1;
+
+// static
+bool ThreadData::coarse_clock_enabled_ = false;
+
 ThreadData::ThreadData(const std::string& suggested_name)
     : next_(NULL),
       next_retired_worker_(NULL),
       worker_thread_number_(0),
+      births_until_sample_(0),
       incarnation_count_for_pool_(-1) {
   DCHECK_GE(suggested_name.size(), 0u);
   thread_name_ = suggested_name;
@@ -243,6 +253,7 @@ ThreadData::ThreadData(int thread_number)
     : next_(NULL),
       next_retired_worker_(NULL),
       worker_thread_number_(thread_number),
+      births_until_sample_(0),
       incarnation_count_for_pool_(-1)  {
   CHECK_GT(thread_number, 0);
   base::StringAppendF(&thread_name_, "WorkerThread-%d", thread_number);
@@ -371,7 +382,6 @@ Births* ThreadData::TallyABirth(const Location& location) {
   Births* child;
   if (it != birth_map_.end()) {
     child =  it->second;
-    child->RecordBirth();
   } else {
     child = new Births(location, *this);  // Leak this.
     // Lock since the map may get relocated now, and other threads sometimes
@@ -379,6 +389,7 @@ Births* ThreadData::TallyABirth(const Location& location) {
     base::AutoLock lock(map_lock_);
     birth_map_[location] = child;
   }
+  child->RecordBirth(sampling_interval_);
 
   if (kTrackParentChildLinks && status_ > PROFILING_ACTIVE &&
       !parent_stack_.empty()) {
@@ -395,6 +406,20 @@ Births* ThreadData::TallyABirth(const Location& location) {
   return child;
 }
 
+bool ThreadData::ShouldSampleBirth() {
+  if (--births_until_sample_ > 0)
+    return false;
+  // Draw the gap to the next sampled birth uniformly from
+  // [1, 2 * sampling_interval_ - 1], whose mean is sampling_interval_.  The
+  // generator is the common 32-bit linear congruential one; we only need the
+  // gaps to look unrelated to what the thread is posting.
+  uint32 random = static_cast<uint32>(random_number_) * 1103515245u + 12345u;
+  random_number_ = static_cast<int32>(random);
+  births_until_sample_ =
+      1 + static_cast<int>((random >> 8) % (2 * sampling_interval_ - 1));
+  return true;
+}
+
 void ThreadData::TallyADeath(const Births& birth,
                              int32 queue_duration,
                              int32 run_duration) {
@@ -409,6 +434,9 @@ void ThreadData::TallyADeath(const Births& birth,
   // queue times are invalid.
   if (kAllowAlternateTimeSourceHandling && now_function_)
     queue_duration = 0;
+  // The coarse clock may lag behind the TimeTicks of the post by a tick.
+  if (queue_duration < 0)
+    queue_duration = 0;
 
   DeathMap::iterator it = death_map_.find(&birth);
   DeathData* death_data;
@@ -418,7 +446,8 @@ void ThreadData::TallyADeath(const Births& birth,
     base::AutoLock lock(map_lock_);  // Lock as the map may get relocated now.
     death_data = &death_map_[&birth];
   }  // Release lock ASAP.
-  death_data->RecordDeath(queue_duration, run_duration, random_number_);
+  death_data->RecordDeath(queue_duration, run_duration, random_number_,
+                          sampling_interval_);
 
   if (!kTrackParentChildLinks)
     return;
@@ -438,6 +467,9 @@ Births* ThreadData::TallyABirthIfActive(const Location& location) {
   ThreadData* current_thread_data = Get();
   if (!current_thread_data)
     return NULL;
+  // An unsampled birth gets no Births, so its death is not tallied either.
+  if (sampling_interval_ > 1 && !current_thread_data->ShouldSampleBirth())
+    return NULL;
   return current_thread_data->TallyABirth(location);
 }
 
@@ -733,7 +765,10 @@ bool ThreadData::TrackingParentChildStatus() {
 
 // static
 TrackedTime ThreadData::NowForStartOfRun(const Births* parent) {
-  if (kTrackParentChildLinks && parent && status_ > PROFILING_ACTIVE) {
+  // A run without Births is not tallied, so it needs no time.
+  if (!parent)
+    return TrackedTime();
+  if (kTrackParentChildLinks && status_ > PROFILING_ACTIVE) {
     ThreadData* current_thread_data = Get();
     if (current_thread_data)
       current_thread_data->parent_stack_.push(parent);
@@ -746,6 +781,22 @@ TrackedTime ThreadData::NowForEndOfRun() {
   return Now();
 }
 
+// static
+void ThreadData::SetSamplingInterval(int interval) {
+  DCHECK_GE(interval, 1);
+  sampling_interval_ = interval;
+}
+
+// static
+int ThreadData::sampling_interval() {
+  return sampling_interval_;
+}
+
+// static
+void ThreadData::SetCoarseClockEnabled(bool enabled) {
+  coarse_clock_enabled_ = enabled;
+}
+
 // static
 void ThreadData::SetAlternateTimeSource(NowFunction* now_function) {
   DCHECK(now_function);
@@ -757,8 +808,11 @@ void ThreadData::SetAlternateTimeSource(NowFunction* now_function) {
 TrackedTime ThreadData::Now() {
   if (kAllowAlternateTimeSourceHandling && now_function_)
     return TrackedTime::FromMilliseconds((*now_function_)());
-  if (kTrackAllTaskObjects && TrackingStatus())
+  if (kTrackAllTaskObjects && TrackingStatus()) {
+    if (coarse_clock_enabled_)
+      return TrackedTime::CoarseNow();
     return TrackedTime::Now();
+  }
   return TrackedTime();  // Super fast when disabled, or not compiled.
 }
 
@@ -799,6 +853,8 @@ void ThreadData::ShutdownSingleThreadedCleanup(bool leak) {
   // Put most global static back in pristine shape.
   worker_thread_data_creation_count_ = 0;
   cleanup_count_ = 0;
+  sampling_interval_ = 1;
+  coarse_clock_enabled_ = false;
   tls_index_.Set(NULL);
   status_ = DORMANT_DURING_TESTS;  // Almost UNINITIALIZED.
 
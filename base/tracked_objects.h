@@ -235,8 +235,9 @@ class BASE_EXPORT Births: public BirthOnThread {
 
   int birth_count() const;
 
-  // When we have a birth we update the count for this birthplace.
-  void RecordBirth();
+  // When we have a birth we update the count for this birthplace.  A sampled
+  // birth stands for |count| births.
+  void RecordBirth(int count);
 
   // When a birthplace is changed (updated), we need to decrement the counter
   // for the old instance.
@@ -268,10 +269,12 @@ class BASE_EXPORT DeathData {
   explicit DeathData(int count);
 
   // Update stats for a task destruction (death) that had a Run() time of
-  // |duration|, and has had a queueing delay of |queue_duration|.
+  // |duration|, and has had a queueing delay of |queue_duration|.  A sampled
+  // death stands for |count| deaths with the same durations.
   void RecordDeath(const int32 queue_duration,
                    const int32 run_duration,
-                   int random_number);
+                   int random_number,
+                   int count);
 
   // Metrics accessors, used only for serialization and in tests.
   int count() const;
@@ -478,6 +481,19 @@ class BASE_EXPORT ThreadData {
   // ignored.
   static void SetAlternateTimeSource(NowFunction* now);
 
+  // Records only one in |interval| tasks on average, with counts and duration
+  // sums scaled by |interval| so that they still estimate all the tasks.  The
+  // other tasks get no Births, so they skip the maps and the clock entirely.
+  // An |interval| of 1 (the default) records every task.  Tasks born under a
+  // different interval are tallied with the new one when they die, so change
+  // it while no tracked tasks are pending if the counts must balance.
+  static void SetSamplingInterval(int interval);
+  static int sampling_interval();
+
+  // Read run times from TrackedTime::CoarseNow(), which is much cheaper but
+  // only advances once per scheduler tick.
+  static void SetCoarseClockEnabled(bool enabled);
+
   // This function can be called at process termination to validate that thread
   // cleanup routines have been called for at least some number of named
   // threads.
@@ -519,6 +535,10 @@ class BASE_EXPORT ThreadData {
   // In this thread's data, record a new birth.
   Births* TallyABirth(const Location& location);
 
+  // Counts down to the next sampled birth on this thread, and returns true if
+  // the current birth is the one.  Only used when sampling_interval_ > 1.
+  bool ShouldSampleBirth();
+
   // Find a place to record a death on this thread.
   void TallyADeath(const Births& birth, int32 queue_duration, int32 duration);
 
@@ -616,6 +636,11 @@ class BASE_EXPORT ThreadData {
   // We set status_ to SHUTDOWN when we shut down the tracking service.
   static Status status_;
 
+  // See SetSamplingInterval() and SetCoarseClockEnabled().  Like status_, these
+  // are read without a lock.
+  static int sampling_interval_;
+  static bool coarse_clock_enabled_;
+
   // Link to next instance (null terminated list). Used to globally track all
   // registered instances (corresponds to all registered threads where we keep
   // data).
@@ -677,6 +702,11 @@ class BASE_EXPORT ThreadData {
   // we stir in more and more as we go.
   int32 random_number_;
 
+  // The number of births on this thread until the next sampled one.  The gaps
+  // are random, so that tasks posted in a fixed rotation are not always
+  // skipped.
+  int births_until_sample_;
+
   // Record of what the incarnation_counter_ was when this instance was created.
   // If the incarnation_counter_ has changed, then we avoid pushing into the
   // pool (this is only critical in tests which go through multiple
@@ -242,20 +242,31 @@ TEST_F(TrackedObjectsTest, DeathDataTest) {
   int32 queue_ms = 8;
 
   const int kUnrandomInt = 0;  // Fake random int that ensure we sample data.
-  data->RecordDeath(queue_ms, run_ms, kUnrandomInt);
+  data->RecordDeath(queue_ms, run_ms, kUnrandomInt, 1);
   EXPECT_EQ(data->run_duration_sum(), run_ms);
   EXPECT_EQ(data->run_duration_sample(), run_ms);
   EXPECT_EQ(data->queue_duration_sum(), queue_ms);
   EXPECT_EQ(data->queue_duration_sample(), queue_ms);
   EXPECT_EQ(data->count(), 1);
 
-  data->RecordDeath(queue_ms, run_ms, kUnrandomInt);
+  data->RecordDeath(queue_ms, run_ms, kUnrandomInt, 1);
   EXPECT_EQ(data->run_duration_sum(), run_ms + run_ms);
   EXPECT_EQ(data->run_duration_sample(), run_ms);
   EXPECT_EQ(data->queue_duration_sum(), queue_ms + queue_ms);
   EXPECT_EQ(data->queue_duration_sample(), queue_ms);
   EXPECT_EQ(data->count(), 2);
 
+  // A sampled death stands for several.
+  data->RecordDeath(queue_ms, run_ms + 1, kUnrandomInt, 3);
+  EXPECT_EQ(data->run_duration_sum(), 5 * run_ms + 3);
+  EXPECT_EQ(data->run_duration_max(), run_ms + 1);
+  EXPECT_EQ(data->run_duration_sample(), run_ms + 1);
+  EXPECT_EQ(data->queue_duration_sum(), 5 * queue_ms);
+  EXPECT_EQ(data->count(), 5);
+  data->Clear();
+  data->RecordDeath(queue_ms, run_ms, kUnrandomInt, 1);
+  data->RecordDeath(queue_ms, run_ms, kUnrandomInt, 1);
+
   DeathDataSnapshot snapshot(*data);
   EXPECT_EQ(2, snapshot.count);
   EXPECT_EQ(2 * run_ms, snapshot.run_duration_sum);
@@ -578,4 +589,50 @@ TEST_F(TrackedObjectsTest, DifferentLives) {
   EXPECT_EQ(base::GetCurrentProcId(), process_data.process_id);
 }
 
+TEST_F(TrackedObjectsTest, SampledLifeCycles) {
+  if (!ThreadData::InitializeAndSetTrackingStatus(
+          ThreadData::PROFILING_CHILDREN_ACTIVE))
+    return;
+  const int kSamplingInterval = 4;
+  ThreadData::SetSamplingInterval(kSamplingInterval);
+
+  ThreadData::InitializeThreadContext(kMainThreadName);
+  const char kFunction[] = "SampledLifeCycles";
+  Location location(kFunction, kFile, kLineNumber, NULL);
+
+  const base::TimeTicks kTimePosted = base::TimeTicks() +
+      base::TimeDelta::FromMilliseconds(1);
+  const TrackedTime kStartOfRun = TrackedTime() +
+      Duration::FromMilliseconds(5);
+  const TrackedTime kEndOfRun = TrackedTime() + Duration::FromMilliseconds(7);
+  const int kTasks = 2000;
+  int sampled = 0;
+  for (int i = 0; i < kTasks; ++i) {
+    base::TrackingInfo pending_task(location, base::TimeTicks());
+    pending_task.time_posted = kTimePosted;  // Overwrite implied Now().
+    if (!pending_task.birth_tally)
+      continue;
+    ++sampled;
+    ThreadData::TallyRunOnNamedThreadIfTracking(pending_task,
+        kStartOfRun, kEndOfRun);
+  }
+  EXPECT_GT(sampled, 0);
+  EXPECT_LT(sampled, kTasks);
+
+  // Every sampled task stands for |kSamplingInterval| tasks, and the births
+  // balance the deaths.
+  ProcessDataSnapshot process_data;
+  ThreadData::Snapshot(false, &process_data);
+  ASSERT_EQ(1u, process_data.tasks.size());
+  const DeathDataSnapshot& death_data = process_data.tasks[0].death_data;
+  EXPECT_EQ(kMainThreadName, process_data.tasks[0].death_thread_name);
+  EXPECT_EQ(sampled * kSamplingInterval, death_data.count);
+  EXPECT_EQ(death_data.count * 2, death_data.run_duration_sum);
+  EXPECT_EQ(2, death_data.run_duration_max);
+  EXPECT_EQ(death_data.count * 4, death_data.queue_duration_sum);
+  // The estimate is close to the real number of tasks.
+  EXPECT_LT(kTasks / 2, death_data.count);
+  EXPECT_GT(kTasks * 2, death_data.count);
+}
+
 }  // namespace tracked_objects
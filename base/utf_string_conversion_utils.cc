@@ -4,10 +4,59 @@
 
 #include "base/utf_string_conversion_utils.h"
 
+#include <algorithm>
+
+#include "base/bits.h"
 #include "base/third_party/icu/icu_utf.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY) && (defined(__SSE2__) || \
+    defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define UTF_USE_SSE2 1
+#include <emmintrin.h>
+#endif
 
 namespace base {
 
+namespace {
+
+inline bool IsASCIIChar(char c) {
+  return static_cast<unsigned char>(c) < 0x80;
+}
+
+inline bool IsASCIIChar(char16 c) {
+  return c < 0x80;
+}
+
+// The UTF-16 units a UTF-8 byte accounts for: one for each byte which starts
+// a character, and another for those which start a supplementary character.
+inline size_t UTF16UnitsForByte(char c) {
+  unsigned char byte = static_cast<unsigned char>(c);
+  return ((byte & 0xC0) != 0x80) + (byte >= 0xF0);
+}
+
+#if defined(UTF_USE_SSE2)
+
+// Returns the number of bits set in the 16 bit |mask|.
+inline int CountBits(int mask) {
+  mask = mask - ((mask >> 1) & 0x5555);
+  mask = (mask & 0x3333) + ((mask >> 2) & 0x3333);
+  mask = (mask + (mask >> 4)) & 0x0F0F;
+  return (mask + (mask >> 8)) & 0x1F;
+}
+
+inline __m128i LoadChars(const void* src) {
+  return _mm_loadu_si128(static_cast<const __m128i*>(src));
+}
+
+inline void StoreChars(void* dest, __m128i chars) {
+  _mm_storeu_si128(static_cast<__m128i*>(dest), chars);
+}
+
+#endif  // defined(UTF_USE_SSE2)
+
+}  // namespace
+
 // ReadUnicodeCharacter --------------------------------------------------------
 
 bool ReadUnicodeCharacter(const char* src,
@@ -102,6 +151,151 @@ size_t WriteUnicodeCharacter(uint32 code_point, string16* output) {
   return CBU16_MAX_LENGTH;
 }
 
+// ASCII runs ------------------------------------------------------------------
+
+size_t CountLeadingASCII(const char* src, size_t src_len) {
+  size_t i = 0;
+#if defined(UTF_USE_SSE2)
+  for (; i + 16 <= src_len; i += 16) {
+    // _mm_movemask_epi8() takes the top bit of each byte, which is set for
+    // every byte that is not ASCII.
+    int mask = _mm_movemask_epi8(LoadChars(src + i));
+    if (mask)
+      return i + bits::LowestSetBit(mask);
+  }
+#endif
+  while (i < src_len && IsASCIIChar(src[i]))
+    ++i;
+  return i;
+}
+
+size_t CountLeadingASCII(const char16* src, size_t src_len) {
+  size_t i = 0;
+#if defined(UTF_USE_SSE2)
+  const __m128i non_ascii_bits = _mm_set1_epi16(static_cast<int16>(0xFF80));
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 8 <= src_len; i += 8) {
+    __m128i ascii = _mm_cmpeq_epi16(
+        _mm_and_si128(LoadChars(src + i), non_ascii_bits), zero);
+    // Each character sets two bits of the mask.
+    int mask = _mm_movemask_epi8(ascii) ^ 0xFFFF;
+    if (mask)
+      return i + bits::LowestSetBit(mask) / 2;
+  }
+#endif
+  while (i < src_len && IsASCIIChar(src[i]))
+    ++i;
+  return i;
+}
+
+void CopyASCII(const char* src, size_t src_len, char16* dest) {
+  size_t i = 0;
+#if defined(UTF_USE_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= src_len; i += 16) {
+    __m128i chars = LoadChars(src + i);
+    StoreChars(dest + i, _mm_unpacklo_epi8(chars, zero));
+    StoreChars(dest + i + 8, _mm_unpackhi_epi8(chars, zero));
+  }
+#endif
+  for (; i < src_len; ++i)
+    dest[i] = static_cast<unsigned char>(src[i]);
+}
+
+void CopyASCII(const char16* src, size_t src_len, char* dest) {
+  size_t i = 0;
+#if defined(UTF_USE_SSE2)
+  for (; i + 16 <= src_len; i += 16) {
+    // The characters are below 0x80, so packing does not saturate them.
+    StoreChars(dest + i, _mm_packus_epi16(LoadChars(src + i),
+                                          LoadChars(src + i + 8)));
+  }
+#endif
+  for (; i < src_len; ++i)
+    dest[i] = static_cast<char>(src[i]);
+}
+
+size_t UTF16LengthOfUTF8(const char* src, size_t src_len) {
+  size_t i = 0;
+  size_t length = 0;
+#if defined(UTF_USE_SSE2)
+  // As signed bytes, trail bytes are below -64 and the leads of four byte
+  // sequences are -16 and up.
+  const __m128i last_trail = _mm_set1_epi8(-65);
+  const __m128i before_four_byte_lead = _mm_set1_epi8(-17);
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= src_len; i += 16) {
+    __m128i chars = LoadChars(src + i);
+    int mask = _mm_movemask_epi8(chars);
+    if (!mask) {
+      length += 16;
+      continue;
+    }
+    __m128i starts = _mm_cmpgt_epi8(chars, last_trail);
+    __m128i four_byte_leads = _mm_and_si128(
+        _mm_cmpgt_epi8(chars, before_four_byte_lead),
+        _mm_cmplt_epi8(chars, zero));
+    length += CountBits(_mm_movemask_epi8(starts)) +
+        CountBits(_mm_movemask_epi8(four_byte_leads));
+  }
+#endif
+  for (; i < src_len; ++i)
+    length += UTF16UnitsForByte(src[i]);
+  return length;
+}
+
+size_t UTF8LengthOfUTF16(const char16* src, size_t src_len) {
+  size_t i = 0;
+  size_t length = 0;
+#if defined(UTF_USE_SSE2)
+  // Blocks without surrogates take 1, 2 or 3 bytes a character.  Adding
+  // 0x8000 lets the signed comparisons compare them unsigned.
+  const __m128i bias = _mm_set1_epi16(static_cast<int16>(0x8000));
+  const __m128i last_one_byte = _mm_set1_epi16(static_cast<int16>(0x807F));
+  const __m128i last_two_byte = _mm_set1_epi16(static_cast<int16>(0x87FF));
+  const __m128i surrogate_bits = _mm_set1_epi16(static_cast<int16>(0xF800));
+  const __m128i surrogate = _mm_set1_epi16(static_cast<int16>(0xD800));
+#endif
+  while (i < src_len) {
+#if defined(UTF_USE_SSE2)
+    for (; i + 8 <= src_len; i += 8) {
+      __m128i chars = LoadChars(src + i);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(
+              _mm_and_si128(chars, surrogate_bits), surrogate))) {
+        break;
+      }
+      __m128i biased = _mm_xor_si128(chars, bias);
+      // Each character sets two bits of each mask.
+      length += 8 +
+          (CountBits(_mm_movemask_epi8(_mm_cmpgt_epi16(biased,
+                                                       last_one_byte))) +
+           CountBits(_mm_movemask_epi8(_mm_cmpgt_epi16(biased,
+                                                        last_two_byte)))) / 2;
+    }
+    // Count a block with surrogates, or the tail, a character at a time.
+    // A pair may run one past the end of the block.
+    size_t end = std::min(i + 8, src_len);
+#else
+    size_t end = src_len;
+#endif
+    for (; i < end; ++i) {
+      char16 c = src[i];
+      if (c < 0x80) {
+        length += 1;
+      } else if (c < 0x800) {
+        length += 2;
+      } else if (CBU16_IS_LEAD(c) && i + 1 < src_len &&
+                 CBU16_IS_TRAIL(src[i + 1])) {
+        length += 4;
+        ++i;
+      } else {
+        length += 3;
+      }
+    }
+  }
+  return length;
+}
+
 // Generalized Unicode converter -----------------------------------------------
 
 template<typename CHAR>
@@ -79,6 +79,25 @@ inline size_t WriteUnicodeCharacter(uint32 code_point, std::wstring* output) {
 }
 #endif  // defined(WCHAR_T_IS_UTF32)
 
+// ASCII runs ------------------------------------------------------------------
+
+// Returns the number of ASCII characters at the start of |src|.  On x86 with
+// SSE2 this and the functions below handle 16 bytes at a time.
+BASE_EXPORT size_t CountLeadingASCII(const char* src, size_t src_len);
+BASE_EXPORT size_t CountLeadingASCII(const char16* src, size_t src_len);
+
+// Copies |src_len| ASCII characters to |dest|, widening or narrowing each.
+BASE_EXPORT void CopyASCII(const char* src, size_t src_len, char16* dest);
+BASE_EXPORT void CopyASCII(const char16* src, size_t src_len, char* dest);
+
+// Returns the number of UTF-16 units the UTF-8 in |src| converts to.  This is
+// exact for valid UTF-8; invalid sequences may come out longer.
+BASE_EXPORT size_t UTF16LengthOfUTF8(const char* src, size_t src_len);
+
+// Returns the number of bytes the UTF-16 in |src| converts to in UTF-8,
+// counting each unpaired surrogate as the U+FFFD that replaces it.
+BASE_EXPORT size_t UTF8LengthOfUTF16(const char16* src, size_t src_len);
+
 // Generalized Unicode converter -----------------------------------------------
 
 // Guesses the length of the output in UTF-8 in bytes, clears that output
@@ -4,13 +4,19 @@
 
 #include "base/utf_string_conversions.h"
 
+#include <algorithm>
+
 #include "base/string_piece.h"
 #include "base/string_util.h"
 #include "base/utf_string_conversion_utils.h"
 
+using base::CopyASCII;
+using base::CountLeadingASCII;
 using base::PrepareForUTF8Output;
 using base::PrepareForUTF16Or32Output;
 using base::ReadUnicodeCharacter;
+using base::UTF16LengthOfUTF8;
+using base::UTF8LengthOfUTF16;
 using base::WriteUnicodeCharacter;
 
 namespace {
@@ -41,10 +47,83 @@ bool ConvertUnicode(const SRC_CHAR* src,
   return success;
 }
 
+inline bool IsASCIIChar(char c) {
+  return static_cast<unsigned char>(c) < 0x80;
+}
+
+inline bool IsASCIIChar(char16 c) {
+  return c < 0x80;
+}
+
+// Like ConvertUnicode(), but copies runs of ASCII in bulk and reads only the
+// characters in between one at a time.  Appends to |output|.
+template<typename SRC_CHAR, typename DEST_STRING>
+bool ConvertUnicodeWithASCIIRuns(const SRC_CHAR* src,
+                                 size_t src_len,
+                                 DEST_STRING* output) {
+  // Runs shorter than this, like the spaces between words, are cheaper to
+  // copy a character at a time.
+  const int32 kShortRun = 16;
+
+  bool success = true;
+  int32 src_len32 = static_cast<int32>(src_len);
+  int32 i = 0;
+  while (i < src_len32) {
+    int32 run_end = i;
+    int32 short_run_end = std::min(i + kShortRun, src_len32);
+    while (run_end < short_run_end && IsASCIIChar(src[run_end]))
+      run_end++;
+    if (run_end - i == kShortRun) {
+      run_end += static_cast<int32>(
+          CountLeadingASCII(src + run_end, src_len32 - run_end));
+      size_t output_len = output->size();
+      output->resize(output_len + (run_end - i));
+      CopyASCII(src + i, run_end - i, &(*output)[output_len]);
+    } else {
+      for (int32 j = i; j < run_end; j++)
+        output->push_back(src[j]);
+    }
+    i = run_end;
+
+    for (; i < src_len32 && !IsASCIIChar(src[i]); i++) {
+      uint32 code_point;
+      if (ReadUnicodeCharacter(src, src_len32, &i, &code_point)) {
+        WriteUnicodeCharacter(code_point, output);
+      } else {
+        WriteUnicodeCharacter(0xFFFD, output);
+        success = false;
+      }
+    }
+  }
+
+  return success;
+}
+
 }  // namespace
 
 // UTF-8 <-> Wide --------------------------------------------------------------
 
+#if defined(WCHAR_T_IS_UTF16)
+
+// When wide == UTF-16, these are the UTF-16 conversions below.
+bool WideToUTF8(const wchar_t* src, size_t src_len, std::string* output) {
+  return UTF16ToUTF8(src, src_len, output);
+}
+
+std::string WideToUTF8(const std::wstring& wide) {
+  return UTF16ToUTF8(wide);
+}
+
+bool UTF8ToWide(const char* src, size_t src_len, std::wstring* output) {
+  return UTF8ToUTF16(src, src_len, output);
+}
+
+std::wstring UTF8ToWide(const base::StringPiece& utf8) {
+  return UTF8ToUTF16(utf8);
+}
+
+#elif defined(WCHAR_T_IS_UTF32)
+
 bool WideToUTF8(const wchar_t* src, size_t src_len, std::string* output) {
   PrepareForUTF8Output(src, src_len, output);
   return ConvertUnicode(src, src_len, output);
@@ -69,6 +148,8 @@ std::wstring UTF8ToWide(const base::StringPiece& utf8) {
   return ret;
 }
 
+#endif  // defined(WCHAR_T_IS_UTF32)
+
 // UTF-16 <-> Wide -------------------------------------------------------------
 
 #if defined(WCHAR_T_IS_UTF16)
@@ -126,11 +207,13 @@ std::wstring UTF16ToWide(const string16& utf16) {
 
 // UTF16 <-> UTF8 --------------------------------------------------------------
 
-#if defined(WCHAR_T_IS_UTF32)
+// These measure the output first so that it is allocated once, then convert
+// ASCII a block at a time.
 
 bool UTF8ToUTF16(const char* src, size_t src_len, string16* output) {
-  PrepareForUTF16Or32Output(src, src_len, output);
-  return ConvertUnicode(src, src_len, output);
+  output->clear();
+  output->reserve(UTF16LengthOfUTF8(src, src_len));
+  return ConvertUnicodeWithASCIIRuns(src, src_len, output);
 }
 
 string16 UTF8ToUTF16(const base::StringPiece& utf8) {
@@ -142,8 +225,9 @@ string16 UTF8ToUTF16(const base::StringPiece& utf8) {
 }
 
 bool UTF16ToUTF8(const char16* src, size_t src_len, std::string* output) {
-  PrepareForUTF8Output(src, src_len, output);
-  return ConvertUnicode(src, src_len, output);
+  output->clear();
+  output->reserve(UTF8LengthOfUTF16(src, src_len));
+  return ConvertUnicodeWithASCIIRuns(src, src_len, output);
 }
 
 std::string UTF16ToUTF8(const string16& utf16) {
@@ -154,27 +238,6 @@ std::string UTF16ToUTF8(const string16& utf16) {
   return ret;
 }
 
-#elif defined(WCHAR_T_IS_UTF16)
-// Easy case since we can use the "wide" versions we already wrote above.
-
-bool UTF8ToUTF16(const char* src, size_t src_len, string16* output) {
-  return UTF8ToWide(src, src_len, output);
-}
-
-string16 UTF8ToUTF16(const base::StringPiece& utf8) {
-  return UTF8ToWide(utf8);
-}
-
-bool UTF16ToUTF8(const char16* src, size_t src_len, std::string* output) {
-  return WideToUTF8(src, src_len, output);
-}
-
-std::string UTF16ToUTF8(const string16& utf16) {
-  return WideToUTF8(utf16);
-}
-
-#endif
-
 std::wstring ASCIIToWide(const base::StringPiece& ascii) {
   DCHECK(IsStringASCII(ascii)) << ascii;
   return std::wstring(ascii.begin(), ascii.end());
@@ -0,0 +1,70 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/perftimer.h"
+#include "base/string16.h"
+#include "base/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kIterations = 200;
+
+// About 64K of text made of |word| and spaces.
+std::string MakeText(const char* word) {
+  std::string text;
+  while (text.size() < 64 * 1024) {
+    text += word;
+    text += ' ';
+  }
+  return text;
+}
+
+double MegabytesPerSecond(size_t bytes, base::TimeDelta elapsed) {
+  return static_cast<double>(bytes) * kIterations / (1024 * 1024) /
+      elapsed.InSecondsF();
+}
+
+// Times conversion of |utf8| to UTF-16 and back, reporting the rate in
+// UTF-8 bytes.
+void TimeConversions(const std::string& name, const std::string& utf8) {
+  string16 utf16;
+  PerfTimer to_utf16_timer;
+  for (int i = 0; i < kIterations; ++i)
+    ASSERT_TRUE(UTF8ToUTF16(utf8.data(), utf8.size(), &utf16));
+  LogPerfResult(("UTF8ToUTF16_" + name).c_str(),
+                MegabytesPerSecond(utf8.size(), to_utf16_timer.Elapsed()),
+                "MB/s");
+
+  std::string output;
+  PerfTimer to_utf8_timer;
+  for (int i = 0; i < kIterations; ++i)
+    ASSERT_TRUE(UTF16ToUTF8(utf16.data(), utf16.size(), &output));
+  LogPerfResult(("UTF16ToUTF8_" + name).c_str(),
+                MegabytesPerSecond(utf8.size(), to_utf8_timer.Elapsed()),
+                "MB/s");
+  EXPECT_EQ(utf8, output);
+}
+
+}  // namespace
+
+TEST(UTFStringConversionsPerfTest, ASCII) {
+  TimeConversions("ASCII", MakeText("http://www.example.com/path/to/page"));
+}
+
+// Mostly ASCII with the odd accented letter, like most European text.
+TEST(UTFStringConversionsPerfTest, Latin1) {
+  TimeConversions("Latin1",
+                  MakeText("Caf\xc3\xa9 cr\xc3\xa8me br\xc3\xbbl\xc3\xa9" "e, "
+                           "and a longer run of plain words"));
+}
+
+// Chinese with ASCII spaces and punctuation between the words.
+TEST(UTFStringConversionsPerfTest, CJK) {
+  TimeConversions("CJK", MakeText("\xe7\xbd\x91\xe9\xa1\xb5 "
+                                  "\xe5\x9b\xbe\xe7\x89\x87, "
+                                  "\xe8\xb5\x84\xe8\xae\xaf"));
+}
@@ -6,6 +6,7 @@
 #include "base/logging.h"
 #include "base/string_piece.h"
 #include "base/string_util.h"
+#include "base/utf_string_conversion_utils.h"
 #include "base/utf_string_conversions.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -208,4 +209,47 @@ TEST(UTFStringConversionsTest, ConvertMultiString) {
   EXPECT_EQ(expected, converted);
 }
 
+// A character of each UTF-8 length at each position in runs of ASCII long
+// enough to take the block at a time paths.
+TEST(UTFStringConversionsTest, ASCIIRuns) {
+  const char* const kUTF8Chars[] = {
+    "\x7f", "\xc3\xa9", "\xe7\xbd\x91", "\xf0\x90\x8c\x80",
+  };
+  const char16 kUTF16Chars[][2] = {
+    { 0x7F, 0 }, { 0xE9, 0 }, { 0x7F51, 0 }, { 0xD800, 0xDF00 },
+  };
+  for (size_t length = 0; length < 40; ++length) {
+    for (size_t position = 0; position <= length; ++position) {
+      for (size_t i = 0; i < arraysize(kUTF8Chars); ++i) {
+        std::string utf8(length, 'x');
+        utf8.insert(position, kUTF8Chars[i]);
+        string16 utf16(length, 'x');
+        utf16.insert(position, kUTF16Chars[i],
+                     kUTF16Chars[i][1] ? 2 : 1);
+
+        EXPECT_EQ(utf16, UTF8ToUTF16(utf8));
+        EXPECT_EQ(utf8, UTF16ToUTF8(utf16));
+        EXPECT_EQ(utf16.size(), UTF16LengthOfUTF8(utf8.data(), utf8.size()));
+        EXPECT_EQ(utf8.size(), UTF8LengthOfUTF16(utf16.data(), utf16.size()));
+        size_t ascii = i == 0 ? utf8.size() : position;
+        EXPECT_EQ(ascii, CountLeadingASCII(utf8.data(), utf8.size()));
+        EXPECT_EQ(i == 0 ? utf16.size() : position,
+                  CountLeadingASCII(utf16.data(), utf16.size()));
+      }
+    }
+  }
+}
+
+TEST(UTFStringConversionsTest, UnpairedSurrogateLength) {
+  // Each unpaired surrogate becomes a three byte U+FFFD.
+  string16 utf16(20, 'x');
+  utf16[3] = 0xD800;
+  utf16[12] = 0xDC00;
+  utf16[19] = 0xD800;
+  std::string utf8;
+  EXPECT_FALSE(UTF16ToUTF8(utf16.data(), utf16.size(), &utf8));
+  EXPECT_EQ(17u + 9u, utf8.size());
+  EXPECT_EQ(utf8.size(), UTF8LengthOfUTF16(utf16.data(), utf16.size()));
+}
+
 }  // base
@@ -8,6 +8,7 @@
 
 #include "base/float_util.h"
 #include "base/logging.h"
+#include "base/stl_util.h"
 #include "base/string_util.h"
 #include "base/utf_string_conversions.h"
 
@@ -16,11 +17,11 @@ namespace {
 // Make a deep copy of |node|, but don't include empty lists or dictionaries
 // in the copy. It's possible for this function to return NULL and it
 // expects |node| to always be non-NULL.
-Value* CopyWithoutEmptyChildren(Value* node) {
+Value* CopyWithoutEmptyChildren(const Value* node) {
   DCHECK(node);
   switch (node->GetType()) {
     case Value::TYPE_LIST: {
-      ListValue* list = static_cast<ListValue*>(node);
+      const ListValue* list = static_cast<const ListValue*>(node);
       ListValue* copy = new ListValue;
       for (ListValue::const_iterator it = list->begin(); it != list->end();
            ++it) {
@@ -36,7 +37,7 @@ Value* CopyWithoutEmptyChildren(Value* node) {
     }
 
     case Value::TYPE_DICTIONARY: {
-      DictionaryValue* dict = static_cast<DictionaryValue*>(node);
+      const DictionaryValue* dict = static_cast<const DictionaryValue*>(node);
       DictionaryValue* copy = new DictionaryValue;
       for (DictionaryValue::key_iterator it = dict->begin_keys();
            it != dict->end_keys(); ++it) {
@@ -80,6 +81,24 @@ class ValueEquals {
 
 namespace base {
 
+namespace internal {
+
+DictionaryChildren::DictionaryChildren() {
+}
+
+DictionaryChildren::~DictionaryChildren() {
+  STLDeleteValues(&values);
+}
+
+ListChildren::ListChildren() {
+}
+
+ListChildren::~ListChildren() {
+  STLDeleteElements(&values);
+}
+
+}  // namespace internal
+
 ///////////////////// Value ////////////////////
 
 Value::~Value() {
@@ -346,11 +365,11 @@ BinaryValue::BinaryValue(char* buffer, size_t size)
 ///////////////////// DictionaryValue ////////////////////
 
 DictionaryValue::DictionaryValue()
-    : Value(TYPE_DICTIONARY) {
+    : Value(TYPE_DICTIONARY),
+      children_(new internal::DictionaryChildren) {
 }
 
 DictionaryValue::~DictionaryValue() {
-  Clear();
 }
 
 bool DictionaryValue::GetAsDictionary(DictionaryValue** out_value) {
@@ -367,19 +386,16 @@ bool DictionaryValue::GetAsDictionary(const DictionaryValue** out_value) const {
 
 bool DictionaryValue::HasKey(const std::string& key) const {
   DCHECK(IsStringUTF8(key));
-  ValueMap::const_iterator current_entry = dictionary_.find(key);
-  DCHECK((current_entry == dictionary_.end()) || current_entry->second);
-  return current_entry != dictionary_.end();
+  ValueMap::const_iterator current_entry = dictionary().find(key);
+  DCHECK((current_entry == dictionary().end()) || current_entry->second);
+  return current_entry != dictionary().end();
 }
 
 void DictionaryValue::Clear() {
-  ValueMap::iterator dict_iterator = dictionary_.begin();
-  while (dict_iterator != dictionary_.end()) {
-    delete dict_iterator->second;
-    ++dict_iterator;
-  }
-
-  dictionary_.clear();
+  if (children_->HasOneRef())
+    STLDeleteValues(&children_->values);
+  else
+    children_ = new internal::DictionaryChildren;
 }
 
 void DictionaryValue::Set(const std::string& path, Value* in_value) {
@@ -433,7 +449,7 @@ void DictionaryValue::SetWithoutPathExpansion(const std::string& key,
   // If there's an existing value here, we need to delete it, because
   // we own all our children.
   std::pair<ValueMap::iterator, bool> ins_res =
-      dictionary_.insert(std::make_pair(key, in_value));
+      GetMutableDictionary().insert(std::make_pair(key, in_value));
   if (!ins_res.second) {
     DCHECK_NE(ins_res.first->second, in_value);  // This would be bogus
     delete ins_res.first->second;
@@ -441,6 +457,25 @@ void DictionaryValue::SetWithoutPathExpansion(const std::string& key,
   }
 }
 
+bool DictionaryValue::Get(const std::string& path, Value** out_value) {
+  DCHECK(IsStringUTF8(path));
+  std::string current_path(path);
+  DictionaryValue* current_dictionary = this;
+  for (size_t delimiter_position = current_path.find('.');
+       delimiter_position != std::string::npos;
+       delimiter_position = current_path.find('.')) {
+    DictionaryValue* child_dictionary = NULL;
+    if (!current_dictionary->GetDictionaryWithoutPathExpansion(
+            current_path.substr(0, delimiter_position), &child_dictionary))
+      return false;
+
+    current_dictionary = child_dictionary;
+    current_path.erase(0, delimiter_position + 1);
+  }
+
+  return current_dictionary->GetWithoutPathExpansion(current_path, out_value);
+}
+
 bool DictionaryValue::Get(const std::string& path, Value** out_value) const {
   DCHECK(IsStringUTF8(path));
   std::string current_path(path);
@@ -520,6 +555,19 @@ bool DictionaryValue::GetStringASCII(const std::string& path,
   return true;
 }
 
+bool DictionaryValue::GetBinary(const std::string& path,
+                                BinaryValue** out_value) {
+  Value* value;
+  bool result = Get(path, &value);
+  if (!result || !value->IsType(TYPE_BINARY))
+    return false;
+
+  if (out_value)
+    *out_value = static_cast<BinaryValue*>(value);
+
+  return true;
+}
+
 bool DictionaryValue::GetBinary(const std::string& path,
                                 BinaryValue** out_value) const {
   Value* value;
@@ -533,6 +581,19 @@ bool DictionaryValue::GetBinary(const std::string& path,
   return true;
 }
 
+bool DictionaryValue::GetDictionary(const std::string& path,
+                                    DictionaryValue** out_value) {
+  Value* value;
+  bool result = Get(path, &value);
+  if (!result || !value->IsType(TYPE_DICTIONARY))
+    return false;
+
+  if (out_value)
+    *out_value = static_cast<DictionaryValue*>(value);
+
+  return true;
+}
+
 bool DictionaryValue::GetDictionary(const std::string& path,
                                     DictionaryValue** out_value) const {
   Value* value;
@@ -546,6 +607,19 @@ bool DictionaryValue::GetDictionary(const std::string& path,
   return true;
 }
 
+bool DictionaryValue::GetList(const std::string& path,
+                              ListValue** out_value) {
+  Value* value;
+  bool result = Get(path, &value);
+  if (!result || !value->IsType(TYPE_LIST))
+    return false;
+
+  if (out_value)
+    *out_value = static_cast<ListValue*>(value);
+
+  return true;
+}
+
 bool DictionaryValue::GetList(const std::string& path,
                               ListValue** out_value) const {
   Value* value;
@@ -559,11 +633,18 @@ bool DictionaryValue::GetList(const std::string& path,
   return true;
 }
 
+bool DictionaryValue::GetWithoutPathExpansion(const std::string& key,
+                                              Value** out_value) {
+  GetMutableDictionary();
+  return static_cast<const DictionaryValue*>(this)->GetWithoutPathExpansion(
+      key, out_value);
+}
+
 bool DictionaryValue::GetWithoutPathExpansion(const std::string& key,
                                               Value** out_value) const {
   DCHECK(IsStringUTF8(key));
-  ValueMap::const_iterator entry_iterator = dictionary_.find(key);
-  if (entry_iterator == dictionary_.end())
+  ValueMap::const_iterator entry_iterator = dictionary().find(key);
+  if (entry_iterator == dictionary().end())
     return false;
 
   Value* entry = entry_iterator->second;
@@ -610,6 +691,20 @@ bool DictionaryValue::GetStringWithoutPathExpansion(
   return value->GetAsString(out_value);
 }
 
+bool DictionaryValue::GetDictionaryWithoutPathExpansion(
+    const std::string& key,
+    DictionaryValue** out_value) {
+  Value* value;
+  bool result = GetWithoutPathExpansion(key, &value);
+  if (!result || !value->IsType(TYPE_DICTIONARY))
+    return false;
+
+  if (out_value)
+    *out_value = static_cast<DictionaryValue*>(value);
+
+  return true;
+}
+
 bool DictionaryValue::GetDictionaryWithoutPathExpansion(
     const std::string& key,
     DictionaryValue** out_value) const {
@@ -624,6 +719,19 @@ bool DictionaryValue::GetDictionaryWithoutPathExpansion(
   return true;
 }
 
+bool DictionaryValue::GetListWithoutPathExpansion(const std::string& key,
+                                                  ListValue** out_value) {
+  Value* value;
+  bool result = GetWithoutPathExpansion(key, &value);
+  if (!result || !value->IsType(TYPE_LIST))
+    return false;
+
+  if (out_value)
+    *out_value = static_cast<ListValue*>(value);
+
+  return true;
+}
+
 bool DictionaryValue::GetListWithoutPathExpansion(const std::string& key,
                                                   ListValue** out_value) const {
   Value* value;
@@ -656,16 +764,17 @@ bool DictionaryValue::Remove(const std::string& path, Value** out_value) {
 bool DictionaryValue::RemoveWithoutPathExpansion(const std::string& key,
                                                  Value** out_value) {
   DCHECK(IsStringUTF8(key));
-  ValueMap::iterator entry_iterator = dictionary_.find(key);
-  if (entry_iterator == dictionary_.end())
+  if (!HasKey(key))
     return false;
 
+  ValueMap& dictionary = GetMutableDictionary();
+  ValueMap::iterator entry_iterator = dictionary.find(key);
   Value* entry = entry_iterator->second;
   if (out_value)
     *out_value = entry;
   else
     delete entry;
-  dictionary_.erase(entry_iterator);
+  dictionary.erase(entry_iterator);
   return true;
 }
 
@@ -695,19 +804,11 @@ void DictionaryValue::MergeDictionary(const DictionaryValue* dictionary) {
 }
 
 void DictionaryValue::Swap(DictionaryValue* other) {
-  dictionary_.swap(other->dictionary_);
+  children_.swap(other->children_);
 }
 
 DictionaryValue* DictionaryValue::DeepCopy() const {
-  DictionaryValue* result = new DictionaryValue;
-
-  for (ValueMap::const_iterator current_entry(dictionary_.begin());
-       current_entry != dictionary_.end(); ++current_entry) {
-    result->SetWithoutPathExpansion(current_entry->first,
-                                    current_entry->second->DeepCopy());
-  }
-
-  return result;
+  return new DictionaryValue(children_.get());
 }
 
 bool DictionaryValue::Equals(const Value* other) const {
@@ -736,44 +837,72 @@ bool DictionaryValue::Equals(const Value* other) const {
   return true;
 }
 
+DictionaryValue::DictionaryValue(internal::DictionaryChildren* children)
+    : Value(TYPE_DICTIONARY),
+      children_(children) {
+}
+
+ValueMap& DictionaryValue::GetMutableDictionary() {
+  if (!children_->HasOneRef()) {
+    // Copy the children, which shares their own children in turn.
+    scoped_refptr<internal::DictionaryChildren> copy(
+        new internal::DictionaryChildren);
+    for (ValueMap::const_iterator it = dictionary().begin();
+         it != dictionary().end(); ++it) {
+      copy->values.insert(copy->values.end(),
+                          std::make_pair(it->first, it->second->DeepCopy()));
+    }
+    children_.swap(copy);
+  }
+  return children_->values;
+}
+
 ///////////////////// ListValue ////////////////////
 
-ListValue::ListValue() : Value(TYPE_LIST) {
+ListValue::ListValue()
+    : Value(TYPE_LIST),
+      children_(new internal::ListChildren) {
 }
 
 ListValue::~ListValue() {
-  Clear();
 }
 
 void ListValue::Clear() {
-  for (ValueVector::iterator i(list_.begin()); i != list_.end(); ++i)
-    delete *i;
-  list_.clear();
+  if (children_->HasOneRef())
+    STLDeleteElements(&children_->values);
+  else
+    children_ = new internal::ListChildren;
 }
 
 bool ListValue::Set(size_t index, Value* in_value) {
   if (!in_value)
     return false;
 
-  if (index >= list_.size()) {
+  ValueVector& list = GetMutableList();
+  if (index >= list.size()) {
     // Pad out any intermediate indexes with null settings
-    while (index > list_.size())
+    while (index > list.size())
       Append(CreateNullValue());
     Append(in_value);
   } else {
-    DCHECK(list_[index] != in_value);
-    delete list_[index];
-    list_[index] = in_value;
+    DCHECK(list[index] != in_value);
+    delete list[index];
+    list[index] = in_value;
   }
   return true;
 }
 
+bool ListValue::Get(size_t index, Value** out_value) {
+  GetMutableList();
+  return static_cast<const ListValue*>(this)->Get(index, out_value);
+}
+
 bool ListValue::Get(size_t index, Value** out_value) const {
-  if (index >= list_.size())
+  if (index >= list().size())
     return false;
 
   if (out_value)
-    *out_value = list_[index];
+    *out_value = list()[index];
 
   return true;
 }
@@ -818,6 +947,18 @@ bool ListValue::GetString(size_t index, string16* out_value) const {
   return value->GetAsString(out_value);
 }
 
+bool ListValue::GetBinary(size_t index, BinaryValue** out_value) {
+  Value* value;
+  bool result = Get(index, &value);
+  if (!result || !value->IsType(TYPE_BINARY))
+    return false;
+
+  if (out_value)
+    *out_value = static_cast<BinaryValue*>(value);
+
+  return true;
+}
+
 bool ListValue::GetBinary(size_t index, BinaryValue** out_value) const {
   Value* value;
   bool result = Get(index, &value);
@@ -830,6 +971,18 @@ bool ListValue::GetBinary(size_t index, BinaryValue** out_value) const {
   return true;
 }
 
+bool ListValue::GetDictionary(size_t index, DictionaryValue** out_value) {
+  Value* value;
+  bool result = Get(index, &value);
+  if (!result || !value->IsType(TYPE_DICTIONARY))
+    return false;
+
+  if (out_value)
+    *out_value = static_cast<DictionaryValue*>(value);
+
+  return true;
+}
+
 bool ListValue::GetDictionary(size_t index, DictionaryValue** out_value) const {
   Value* value;
   bool result = Get(index, &value);
@@ -842,6 +995,18 @@ bool ListValue::GetDictionary(size_t index, DictionaryValue** out_value) const {
   return true;
 }
 
+bool ListValue::GetList(size_t index, ListValue** out_value) {
+  Value* value;
+  bool result = Get(index, &value);
+  if (!result || !value->IsType(TYPE_LIST))
+    return false;
+
+  if (out_value)
+    *out_value = static_cast<ListValue*>(value);
+
+  return true;
+}
+
 bool ListValue::GetList(size_t index, ListValue** out_value) const {
   Value* value;
   bool result = Get(index, &value);
@@ -855,65 +1020,65 @@ bool ListValue::GetList(size_t index, ListValue** out_value) const {
 }
 
 bool ListValue::Remove(size_t index, Value** out_value) {
-  if (index >= list_.size())
+  if (index >= list().size())
     return false;
 
+  ValueVector& list = GetMutableList();
   if (out_value)
-    *out_value = list_[index];
+    *out_value = list[index];
   else
-    delete list_[index];
+    delete list[index];
 
-  list_.erase(list_.begin() + index);
+  list.erase(list.begin() + index);
   return true;
 }
 
 bool ListValue::Remove(const Value& value, size_t* index) {
-  for (ValueVector::iterator i(list_.begin()); i != list_.end(); ++i) {
-    if ((*i)->Equals(&value)) {
-      size_t previous_index = i - list_.begin();
-      delete *i;
-      list_.erase(i);
-
-      if (index)
-        *index = previous_index;
-      return true;
-    }
-  }
-  return false;
+  const_iterator found = Find(value);
+  if (found == list().end())
+    return false;
+
+  size_t previous_index = found - list().begin();
+  ValueVector& list = GetMutableList();
+  delete list[previous_index];
+  list.erase(list.begin() + previous_index);
+
+  if (index)
+    *index = previous_index;
+  return true;
 }
 
 void ListValue::Append(Value* in_value) {
   DCHECK(in_value);
-  list_.push_back(in_value);
+  GetMutableList().push_back(in_value);
 }
 
 bool ListValue::AppendIfNotPresent(Value* in_value) {
   DCHECK(in_value);
-  for (ValueVector::const_iterator i(list_.begin()); i != list_.end(); ++i) {
-    if ((*i)->Equals(in_value)) {
-      delete in_value;
-      return false;
-    }
+  if (Find(*in_value) != list().end()) {
+    delete in_value;
+    return false;
   }
-  list_.push_back(in_value);
+  GetMutableList().push_back(in_value);
   return true;
 }
 
 bool ListValue::Insert(size_t index, Value* in_value) {
   DCHECK(in_value);
-  if (index > list_.size())
+  if (index > list().size())
     return false;
 
-  list_.insert(list_.begin() + index, in_value);
+  ValueVector& list = GetMutableList();
+  list.insert(list.begin() + index, in_value);
   return true;
 }
 
 ListValue::const_iterator ListValue::Find(const Value& value) const {
-  return std::find_if(list_.begin(), list_.end(), ValueEquals(&value));
+  return std::find_if(list().begin(), list().end(), ValueEquals(&value));
 }
 
 void ListValue::Swap(ListValue* other) {
-  list_.swap(other->list_);
+  children_.swap(other->children_);
 }
 
 bool ListValue::GetAsList(ListValue** out_value) {
@@ -929,12 +1094,7 @@ bool ListValue::GetAsList(const ListValue** out_value) const {
 }
 
 ListValue* ListValue::DeepCopy() const {
-  ListValue* result = new ListValue;
-
-  for (ValueVector::const_iterator i(list_.begin()); i != list_.end(); ++i)
-    result->Append((*i)->DeepCopy());
-
-  return result;
+  return new ListValue(children_.get());
 }
 
 bool ListValue::Equals(const Value* other) const {
@@ -956,6 +1116,23 @@ bool ListValue::Equals(const Value* other) const {
   return true;
 }
 
+ListValue::ListValue(internal::ListChildren* children)
+    : Value(TYPE_LIST),
+      children_(children) {
+}
+
+ValueVector& ListValue::GetMutableList() {
+  if (!children_->HasOneRef()) {
+    // Copy the children, which shares their own children in turn.
+    scoped_refptr<internal::ListChildren> copy(new internal::ListChildren);
+    copy->values.reserve(list().size());
+    for (const_iterator it = list().begin(); it != list().end(); ++it)
+      copy->values.push_back((*it)->DeepCopy());
+    children_.swap(copy);
+  }
+  return children_->values;
+}
+
 ValueSerializer::~ValueSerializer() {
 }
 
@@ -30,6 +30,7 @@
 #include "base/base_export.h"
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/memory/ref_counted.h"
 #include "base/string16.h"
 
 // This file declares "using base::Value", etc. at the bottom, so that
@@ -49,6 +50,40 @@ class Value;
 typedef std::vector<Value*> ValueVector;
 typedef std::map<std::string, Value*> ValueMap;
 
+namespace internal {
+
+// The children of a DictionaryValue and of a ListValue.  DeepCopy() shares
+// them between the original and the copy, and they are only changed while a
+// single container holds them, so they can be shared across threads.
+class BASE_EXPORT DictionaryChildren
+    : public RefCountedThreadSafe<DictionaryChildren> {
+ public:
+  DictionaryChildren();
+
+  ValueMap values;
+
+ private:
+  friend class RefCountedThreadSafe<DictionaryChildren>;
+  ~DictionaryChildren();
+
+  DISALLOW_COPY_AND_ASSIGN(DictionaryChildren);
+};
+
+class BASE_EXPORT ListChildren : public RefCountedThreadSafe<ListChildren> {
+ public:
+  ListChildren();
+
+  ValueVector values;
+
+ private:
+  friend class RefCountedThreadSafe<ListChildren>;
+  ~ListChildren();
+
+  DISALLOW_COPY_AND_ASSIGN(ListChildren);
+};
+
+}  // namespace internal
+
 // The Value class is the base class for Values. A Value can be instantiated
 // via the Create*Value() factory methods, or by directly creating instances of
 // the subclasses.
@@ -104,6 +139,15 @@ class BASE_EXPORT Value {
   // This creates a deep copy of the entire Value tree, and returns a pointer
   // to the copy.  The caller gets ownership of the copy, of course.
   //
+  // Copying a dictionary or a list takes constant time: the copy shares the
+  // children with the original, and the first change to either one copies
+  // the children of the containers on the path to the change, sharing theirs
+  // in turn.  The children are changed through non-const methods only, so a
+  // copy can be handed to another thread while the original is still used.
+  // Pointers to children that were obtained before the copy must not be used
+  // to change the original afterwards, since the copy shares them; get them
+  // again instead.
+  //
   // Subclasses return their own type directly in their overrides;
   // this works because C++ supports covariant return types.
   virtual Value* DeepCopy() const;
@@ -226,10 +270,10 @@ class BASE_EXPORT DictionaryValue : public Value {
   bool HasKey(const std::string& key) const;
 
   // Returns the number of Values in this dictionary.
-  size_t size() const { return dictionary_.size(); }
+  size_t size() const { return dictionary().size(); }
 
   // Returns whether the dictionary is empty.
-  bool empty() const { return dictionary_.empty(); }
+  bool empty() const { return dictionary().empty(); }
 
   // Clears any current contents of this dictionary.
   void Clear();
@@ -264,6 +308,12 @@ class BASE_EXPORT DictionaryValue : public Value {
   // through the |out_value| parameter, and the function will return true.
   // Otherwise, it will return false and |out_value| will be untouched.
   // Note that the dictionary always owns the value that's returned.
+  //
+  // The getters that return Values have a non-const form, which first copies
+  // the children shared with copies of this dictionary along |path| so the
+  // Value can be changed, and a const form that doesn't.  The Values returned
+  // by the const form must not be changed.
+  bool Get(const std::string& path, Value** out_value);
   bool Get(const std::string& path, Value** out_value) const;
 
   // These are convenience forms of Get().  The value will be retrieved
@@ -275,13 +325,17 @@ class BASE_EXPORT DictionaryValue : public Value {
   bool GetString(const std::string& path, std::string* out_value) const;
   bool GetString(const std::string& path, string16* out_value) const;
   bool GetStringASCII(const std::string& path, std::string* out_value) const;
+  bool GetBinary(const std::string& path, BinaryValue** out_value);
   bool GetBinary(const std::string& path, BinaryValue** out_value) const;
+  bool GetDictionary(const std::string& path, DictionaryValue** out_value);
   bool GetDictionary(const std::string& path,
                      DictionaryValue** out_value) const;
+  bool GetList(const std::string& path, ListValue** out_value);
   bool GetList(const std::string& path, ListValue** out_value) const;
 
   // Like Get(), but without special treatment of '.'.  This allows e.g. URLs to
   // be used as paths.
+  bool GetWithoutPathExpansion(const std::string& key, Value** out_value);
   bool GetWithoutPathExpansion(const std::string& key,
                                Value** out_value) const;
   bool GetIntegerWithoutPathExpansion(const std::string& key,
@@ -292,8 +346,12 @@ class BASE_EXPORT DictionaryValue : public Value {
                                      std::string* out_value) const;
   bool GetStringWithoutPathExpansion(const std::string& key,
                                      string16* out_value) const;
+  bool GetDictionaryWithoutPathExpansion(const std::string& key,
+                                         DictionaryValue** out_value);
   bool GetDictionaryWithoutPathExpansion(const std::string& key,
                                          DictionaryValue** out_value) const;
+  bool GetListWithoutPathExpansion(const std::string& key,
+                                   ListValue** out_value);
   bool GetListWithoutPathExpansion(const std::string& key,
                                    ListValue** out_value) const;
 
@@ -346,17 +404,19 @@ class BASE_EXPORT DictionaryValue : public Value {
     ValueMap::const_iterator itr_;
   };
 
-  key_iterator begin_keys() const { return key_iterator(dictionary_.begin()); }
-  key_iterator end_keys() const { return key_iterator(dictionary_.end()); }
+  key_iterator begin_keys() const {
+    return key_iterator(dictionary().begin());
+  }
+  key_iterator end_keys() const { return key_iterator(dictionary().end()); }
 
   // This class provides an iterator over both keys and values in the
   // dictionary.  It can't be used to modify the dictionary.
   class Iterator {
    public:
     explicit Iterator(const DictionaryValue& target)
-        : target_(target), it_(target.dictionary_.begin()) {}
+        : target_(target), it_(target.dictionary().begin()) {}
 
-    bool HasNext() const { return it_ != target_.dictionary_.end(); }
+    bool HasNext() const { return it_ != target_.dictionary().end(); }
     void Advance() { ++it_; }
 
     const std::string& key() const { return it_->first; }
@@ -372,7 +432,16 @@ class BASE_EXPORT DictionaryValue : public Value {
   virtual bool Equals(const Value* other) const OVERRIDE;
 
  private:
-  ValueMap dictionary_;
+  // Makes a copy that shares |children|.
+  explicit DictionaryValue(internal::DictionaryChildren* children);
+
+  const ValueMap& dictionary() const { return children_->values; }
+
+  // Returns the children to change or to hand out for changing, first copying
+  // them if they are shared with copies of this dictionary.
+  ValueMap& GetMutableDictionary();
+
+  scoped_refptr<internal::DictionaryChildren> children_;
 
   DISALLOW_COPY_AND_ASSIGN(DictionaryValue);
 };
@@ -390,10 +459,10 @@ class BASE_EXPORT ListValue : public Value {
   void Clear();
 
   // Returns the number of Values in this list.
-  size_t GetSize() const { return list_.size(); }
+  size_t GetSize() const { return list().size(); }
 
   // Returns whether the list is empty.
-  bool empty() const { return list_.empty(); }
+  bool empty() const { return list().empty(); }
 
   // Sets the list item at the given index to be the Value specified by
   // the value given.  If the index beyond the current end of the list, null
@@ -405,6 +474,10 @@ class BASE_EXPORT ListValue : public Value {
   // Gets the Value at the given index.  Modifies |out_value| (and returns true)
   // only if the index falls within the current list range.
   // Note that the list always owns the Value passed out via |out_value|.
+  // As with DictionaryValue, the const forms of the getters that return
+  // Values don't copy the children shared with copies of this list, and the
+  // Values they return must not be changed.
+  bool Get(size_t index, Value** out_value);
   bool Get(size_t index, Value** out_value) const;
 
   // Convenience forms of Get().  Modifies |out_value| (and returns true)
@@ -415,8 +488,11 @@ class BASE_EXPORT ListValue : public Value {
   bool GetDouble(size_t index, double* out_value) const;
   bool GetString(size_t index, std::string* out_value) const;
   bool GetString(size_t index, string16* out_value) const;
+  bool GetBinary(size_t index, BinaryValue** out_value);
   bool GetBinary(size_t index, BinaryValue** out_value) const;
+  bool GetDictionary(size_t index, DictionaryValue** out_value);
   bool GetDictionary(size_t index, DictionaryValue** out_value) const;
+  bool GetList(size_t index, ListValue** out_value);
   bool GetList(size_t index, ListValue** out_value) const;
 
   // Removes the Value with the specified index from this list.
@@ -451,12 +527,13 @@ class BASE_EXPORT ListValue : public Value {
   // Swaps contents with the |other| list.
   virtual void Swap(ListValue* other);
 
-  // Iteration.
-  iterator begin() { return list_.begin(); }
-  iterator end() { return list_.end(); }
+  // Iteration.  The Values reached through const_iterators must not be
+  // changed.
+  iterator begin() { return GetMutableList().begin(); }
+  iterator end() { return GetMutableList().end(); }
 
-  const_iterator begin() const { return list_.begin(); }
-  const_iterator end() const { return list_.end(); }
+  const_iterator begin() const { return list().begin(); }
+  const_iterator end() const { return list().end(); }
 
   // Overridden from Value:
   virtual bool GetAsList(ListValue** out_value) OVERRIDE;
@@ -465,7 +542,16 @@ class BASE_EXPORT ListValue : public Value {
   virtual bool Equals(const Value* other) const OVERRIDE;
 
  private:
-  ValueVector list_;
+  // Makes a copy that shares |children|.
+  explicit ListValue(internal::ListChildren* children);
+
+  const ValueVector& list() const { return children_->values; }
+
+  // Returns the children to change or to hand out for changing, first copying
+  // them if they are shared with copies of this list.
+  ValueVector& GetMutableList();
+
+  scoped_refptr<internal::ListChildren> children_;
 
   DISALLOW_COPY_AND_ASSIGN(ListValue);
 };
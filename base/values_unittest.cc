@@ -786,4 +786,59 @@ TEST(ValuesTest, DictionaryIterator) {
   EXPECT_TRUE(seen2);
 }
 
+// Makes sure a copy shares the children of the original until either one
+// changes, and that changes only copy the containers on their path.
+TEST(ValuesTest, DeepCopySharesUntilChanged) {
+  DictionaryValue original;
+  original.SetInteger("a.x", 1);
+  original.SetInteger("b.y", 2);
+  ListValue* list = new ListValue;
+  list->Append(Value::CreateStringValue("item"));
+  original.Set("list", list);
+
+  scoped_ptr<DictionaryValue> copy(original.DeepCopy());
+  const DictionaryValue& const_original = original;
+  const DictionaryValue& const_copy = *copy;
+  DictionaryValue* original_a = NULL;
+  DictionaryValue* copy_a = NULL;
+  ASSERT_TRUE(const_original.GetDictionary("a", &original_a));
+  ASSERT_TRUE(const_copy.GetDictionary("a", &copy_a));
+  EXPECT_EQ(original_a, copy_a);
+
+  copy->SetInteger("a.x", 3);
+  int value = 0;
+  EXPECT_TRUE(original.GetInteger("a.x", &value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(copy->GetInteger("a.x", &value));
+  EXPECT_EQ(3, value);
+
+  // Only the path to "a.x" was copied: the children of "b" are still shared.
+  Value* original_y = NULL;
+  Value* copy_y = NULL;
+  ASSERT_TRUE(const_original.Get("b.y", &original_y));
+  ASSERT_TRUE(const_copy.Get("b.y", &copy_y));
+  EXPECT_EQ(original_y, copy_y);
+
+  // Changing the original through a child it hands out leaves the copy alone.
+  ListValue* original_list = NULL;
+  ASSERT_TRUE(original.GetList("list", &original_list));
+  original_list->Append(Value::CreateIntegerValue(4));
+  ListValue* copy_list = NULL;
+  ASSERT_TRUE(copy->GetList("list", &copy_list));
+  EXPECT_EQ(2u, original_list->GetSize());
+  EXPECT_EQ(1u, copy_list->GetSize());
+
+  std::string item;
+  scoped_ptr<ListValue> list_copy(copy_list->DeepCopy());
+  list_copy->Remove(0, NULL);
+  EXPECT_TRUE(list_copy->empty());
+  EXPECT_TRUE(copy_list->GetString(0, &item));
+  EXPECT_EQ("item", item);
+
+  copy->Clear();
+  EXPECT_TRUE(copy->empty());
+  EXPECT_TRUE(original.GetInteger("b.y", &value));
+  EXPECT_EQ(2, value);
+}
+
 }  // namespace base
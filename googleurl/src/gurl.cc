@@ -90,6 +90,7 @@ const std::string& EmptyStringForGURL() {
 
 static pthread_once_t empty_string_once = PTHREAD_ONCE_INIT;
 static pthread_once_t empty_gurl_once = PTHREAD_ONCE_INIT;
+static pthread_once_t empty_shared_spec_once = PTHREAD_ONCE_INIT;
 
 void EmptyStringForGURLOnce(void) {
   empty_string = new std::string;
@@ -103,47 +104,137 @@ const std::string& EmptyStringForGURL() {
 
 #endif  // WIN32
 
+// Returns true if the text of |a_comp| in |a| is the text of |b_comp| in |b|.
+// Missing and empty components are equal.
+bool ComponentsEqual(const std::string& a, const url_parse::Component& a_comp,
+                     const std::string& b, const url_parse::Component& b_comp) {
+  int len = a_comp.len > 0 ? a_comp.len : 0;
+  if (len != (b_comp.len > 0 ? b_comp.len : 0))
+    return false;
+  return len == 0 ||
+      a.compare(a_comp.begin, len, b, b_comp.begin, len) == 0;
+}
+
 } // namespace
 
-GURL::GURL() : is_valid_(false), inner_url_(NULL) {
+GURL::SharedSpec* GURL::SharedSpec::empty_ = NULL;
+
+GURL::SharedSpec::SharedSpec(std::string* spec) : ref_count_(1) {
+  spec_.swap(*spec);
+}
+
+GURL::SharedSpec::~SharedSpec() {
+}
+
+#ifdef WIN32
+
+// static
+GURL::SharedSpec* GURL::SharedSpec::GetEmpty() {
+  if (!empty_) {
+    // Be careful that we don't break in the case that this is being called
+    // from multiple threads.
+    std::string empty;
+    SharedSpec* new_empty = new SharedSpec(&empty);
+    if (InterlockedCompareExchangePointer(
+        reinterpret_cast<PVOID*>(&empty_), new_empty, NULL)) {
+      // Another thread did the initialization out from under us.
+      delete new_empty;
+    }
+  }
+  empty_->AddRef();
+  return empty_;
+}
+
+void GURL::SharedSpec::AddRef() {
+  InterlockedIncrement(&ref_count_);
+}
+
+void GURL::SharedSpec::Release() {
+  if (InterlockedDecrement(&ref_count_) == 0)
+    delete this;
+}
+
+#else
+
+// static
+void GURL::SharedSpec::CreateEmpty() {
+  // The reference taken here is never released, so the empty spec lives as
+  // long as the process.
+  std::string empty;
+  empty_ = new SharedSpec(&empty);
+}
+
+// static
+GURL::SharedSpec* GURL::SharedSpec::GetEmpty() {
+  pthread_once(&empty_shared_spec_once, CreateEmpty);
+  empty_->AddRef();
+  return empty_;
+}
+
+void GURL::SharedSpec::AddRef() {
+  __sync_add_and_fetch(&ref_count_, 1);
+}
+
+void GURL::SharedSpec::Release() {
+  if (__sync_sub_and_fetch(&ref_count_, 1) == 0)
+    delete this;
+}
+
+#endif  // WIN32
+
+GURL::GURL()
+    : shared_spec_(SharedSpec::GetEmpty()),
+      is_valid_(false),
+      inner_url_(NULL) {
 }
 
 GURL::GURL(const GURL& other)
-    : spec_(other.spec_),
+    : shared_spec_(other.shared_spec_),
       is_valid_(other.is_valid_),
       parsed_(other.parsed_),
       inner_url_(NULL) {
+  shared_spec_->AddRef();
   if (other.inner_url_)
     inner_url_ = new GURL(*other.inner_url_);
   // Valid filesystem urls should always have an inner_url_.
   DCHECK(!is_valid_ || !SchemeIsFileSystem() || inner_url_);
 }
 
-GURL::GURL(const std::string& url_string) : inner_url_(NULL) {
-  is_valid_ = InitCanonical(url_string, &spec_, &parsed_);
+GURL::GURL(const std::string& url_string)
+    : shared_spec_(NULL),
+      inner_url_(NULL) {
+  std::string spec;
+  is_valid_ = InitCanonical(url_string, &spec, &parsed_);
+  SetSpec(&spec);
   if (is_valid_ && SchemeIsFileSystem()) {
-    inner_url_ =
-        new GURL(spec_.data(), parsed_.Length(), *parsed_.inner_parsed(), true);
+    inner_url_ = new GURL(raw_spec().data(), parsed_.Length(),
+                          *parsed_.inner_parsed(), true);
   }
 }
 
-GURL::GURL(const string16& url_string) : inner_url_(NULL) {
-  is_valid_ = InitCanonical(url_string, &spec_, &parsed_);
+GURL::GURL(const string16& url_string)
+    : shared_spec_(NULL),
+      inner_url_(NULL) {
+  std::string spec;
+  is_valid_ = InitCanonical(url_string, &spec, &parsed_);
+  SetSpec(&spec);
   if (is_valid_ && SchemeIsFileSystem()) {
-    inner_url_ =
-        new GURL(spec_.data(), parsed_.Length(), *parsed_.inner_parsed(), true);
+    inner_url_ = new GURL(raw_spec().data(), parsed_.Length(),
+                          *parsed_.inner_parsed(), true);
   }
 }
 
 GURL::GURL(const char* canonical_spec, size_t canonical_spec_len,
            const url_parse::Parsed& parsed, bool is_valid)
-    : spec_(canonical_spec, canonical_spec_len),
+    : shared_spec_(NULL),
       is_valid_(is_valid),
       parsed_(parsed),
       inner_url_(NULL) {
+  std::string spec(canonical_spec, canonical_spec_len);
+  SetSpec(&spec);
   if (is_valid_ && SchemeIsFileSystem()) {
-    inner_url_ =
-        new GURL(spec_.data(), parsed_.Length(), *parsed_.inner_parsed(), true);
+    inner_url_ = new GURL(raw_spec().data(), parsed_.Length(),
+                          *parsed_.inner_parsed(), true);
   }
 
 #ifndef NDEBUG
@@ -158,10 +249,10 @@ GURL::GURL(const char* canonical_spec, size_t canonical_spec_len,
       // We can't do this check on the inner_url of a filesystem URL, as
       // canonical_spec actually points to the start of the outer URL, so we'd
       // end up with infinite recursion in this constructor.
-      GURL test_url(spec_);
+      GURL test_url(raw_spec());
 
       DCHECK(test_url.is_valid_ == is_valid_);
-      DCHECK(test_url.spec_ == spec_);
+      DCHECK(test_url.raw_spec() == raw_spec());
 
       DCHECK(test_url.parsed_.scheme == parsed_.scheme);
       DCHECK(test_url.parsed_.username == parsed_.username);
@@ -176,12 +267,37 @@ GURL::GURL(const char* canonical_spec, size_t canonical_spec_len,
 #endif
 }
 
+// static
+GURL GURL::FromCanonicalSpec(const std::string& canonical_spec) {
+  const char* spec = canonical_spec.data();
+  int spec_len = static_cast<int>(canonical_spec.length());
+
+  // File and filesystem URLs have parsers of their own, leave them to the
+  // canonicalizer along with the nonstandard ones.
+  url_parse::Component scheme;
+  if (!url_parse::ExtractScheme(spec, spec_len, &scheme) ||
+      !url_util::IsStandard(spec, scheme) ||
+      url_util::LowerCaseEqualsASCII(spec + scheme.begin, spec + scheme.end(),
+                                     "file") ||
+      url_util::LowerCaseEqualsASCII(spec + scheme.begin, spec + scheme.end(),
+                                     "filesystem"))
+    return GURL(canonical_spec);
+
+  // Parsing a canonical spec gives what canonicalizing it would.
+  url_parse::Parsed parsed;
+  url_parse::ParseStandardURL(spec, spec_len, &parsed);
+  return GURL(spec, canonical_spec.length(), parsed, true);
+}
+
 GURL::~GURL() {
+  shared_spec_->Release();
   delete inner_url_;
 }
 
 GURL& GURL::operator=(const GURL& other) {
-  spec_ = other.spec_;
+  other.shared_spec_->AddRef();
+  shared_spec_->Release();
+  shared_spec_ = other.shared_spec_;
   is_valid_ = other.is_valid_;
   parsed_ = other.parsed_;
   delete inner_url_;
@@ -194,8 +310,8 @@ GURL& GURL::operator=(const GURL& other) {
 }
 
 const std::string& GURL::spec() const {
-  if (is_valid_ || spec_.empty())
-    return spec_;
+  if (is_valid_ || raw_spec().empty())
+    return raw_spec();
 
   DCHECK(false) << "Trying to get the spec of an invalid URL!";
   return EmptyStringForGURL();
@@ -220,11 +336,12 @@ GURL GURL::ResolveWithCharsetConverter(
 
   // Reserve enough room in the output for the input, plus some extra so that
   // we have room if we have to escape a few things without reallocating.
-  result.spec_.reserve(spec_.size() + 32);
-  url_canon::StdStringCanonOutput output(&result.spec_);
+  std::string result_spec;
+  result_spec.reserve(raw_spec().size() + 32);
+  url_canon::StdStringCanonOutput output(&result_spec);
 
   if (!url_util::ResolveRelative(
-          spec_.data(), static_cast<int>(spec_.length()), parsed_,
+          raw_spec().data(), static_cast<int>(raw_spec().length()), parsed_,
           relative.data(), static_cast<int>(relative.length()),
           charset_converter, &output, &result.parsed_)) {
     // Error resolving, return an empty URL.
@@ -232,9 +349,11 @@ GURL GURL::ResolveWithCharsetConverter(
   }
 
   output.Complete();
+  result.SetSpec(&result_spec);
   result.is_valid_ = true;
   if (result.SchemeIsFileSystem()) {
-    result.inner_url_ = new GURL(spec_.data(), result.parsed_.Length(),
+    result.inner_url_ = new GURL(result.raw_spec().data(),
+                                 result.parsed_.Length(),
                                  *result.parsed_.inner_parsed(), true);
   }
   return result;
@@ -252,11 +371,12 @@ GURL GURL::ResolveWithCharsetConverter(
 
   // Reserve enough room in the output for the input, plus some extra so that
   // we have room if we have to escape a few things without reallocating.
-  result.spec_.reserve(spec_.size() + 32);
-  url_canon::StdStringCanonOutput output(&result.spec_);
+  std::string result_spec;
+  result_spec.reserve(raw_spec().size() + 32);
+  url_canon::StdStringCanonOutput output(&result_spec);
 
   if (!url_util::ResolveRelative(
-          spec_.data(), static_cast<int>(spec_.length()), parsed_,
+          raw_spec().data(), static_cast<int>(raw_spec().length()), parsed_,
           relative.data(), static_cast<int>(relative.length()),
           charset_converter, &output, &result.parsed_)) {
     // Error resolving, return an empty URL.
@@ -264,9 +384,11 @@ GURL GURL::ResolveWithCharsetConverter(
   }
 
   output.Complete();
+  result.SetSpec(&result_spec);
   result.is_valid_ = true;
   if (result.SchemeIsFileSystem()) {
-    result.inner_url_ = new GURL(spec_.data(), result.parsed_.Length(),
+    result.inner_url_ = new GURL(result.raw_spec().data(),
+                                 result.parsed_.Length(),
                                  *result.parsed_.inner_parsed(), true);
   }
   return result;
@@ -283,16 +405,19 @@ GURL GURL::ReplaceComponents(
 
   // Reserve enough room in the output for the input, plus some extra so that
   // we have room if we have to escape a few things without reallocating.
-  result.spec_.reserve(spec_.size() + 32);
-  url_canon::StdStringCanonOutput output(&result.spec_);
+  std::string result_spec;
+  result_spec.reserve(raw_spec().size() + 32);
+  url_canon::StdStringCanonOutput output(&result_spec);
 
   result.is_valid_ = url_util::ReplaceComponents(
-      spec_.data(), static_cast<int>(spec_.length()), parsed_, replacements,
-      NULL, &output, &result.parsed_);
+      raw_spec().data(), static_cast<int>(raw_spec().length()), parsed_,
+      replacements, NULL, &output, &result.parsed_);
 
   output.Complete();
+  result.SetSpec(&result_spec);
   if (result.is_valid_ && result.SchemeIsFileSystem()) {
-    result.inner_url_ = new GURL(spec_.data(), result.parsed_.Length(),
+    result.inner_url_ = new GURL(result.raw_spec().data(),
+                                 result.parsed_.Length(),
                                  *result.parsed_.inner_parsed(), true);
   }
   return result;
@@ -309,16 +434,19 @@ GURL GURL::ReplaceComponents(
 
   // Reserve enough room in the output for the input, plus some extra so that
   // we have room if we have to escape a few things without reallocating.
-  result.spec_.reserve(spec_.size() + 32);
-  url_canon::StdStringCanonOutput output(&result.spec_);
+  std::string result_spec;
+  result_spec.reserve(raw_spec().size() + 32);
+  url_canon::StdStringCanonOutput output(&result_spec);
 
   result.is_valid_ = url_util::ReplaceComponents(
-      spec_.data(), static_cast<int>(spec_.length()), parsed_, replacements,
-      NULL, &output, &result.parsed_);
+      raw_spec().data(), static_cast<int>(raw_spec().length()), parsed_,
+      replacements, NULL, &output, &result.parsed_);
 
   output.Complete();
+  result.SetSpec(&result_spec);
   if (result.is_valid_ && result.SchemeIsFileSystem()) {
-    result.inner_url_ = new GURL(spec_.data(), result.parsed_.Length(),
+    result.inner_url_ = new GURL(result.raw_spec().data(),
+                                 result.parsed_.Length(),
                                  *result.parsed_.inner_parsed(), true);
   }
   return result;
@@ -333,14 +461,72 @@ GURL GURL::GetOrigin() const {
   if (SchemeIsFileSystem())
     return inner_url_->GetOrigin();
 
-  url_canon::Replacements<char> replacements;
-  replacements.ClearUsername();
-  replacements.ClearPassword();
-  replacements.ClearPath();
-  replacements.ClearQuery();
-  replacements.ClearRef();
+  // A URL that is its own origin can share its spec with the result. The
+  // inner URL of a filesystem: URL has the text of its outer URL around it,
+  // so isn't one.
+  if (parsed_.scheme.begin == 0 &&
+      parsed_.path.end() == static_cast<int>(raw_spec().length()) &&
+      !parsed_.username.is_valid() && !parsed_.password.is_valid() &&
+      parsed_.path.len == 1 && !parsed_.query.is_valid() &&
+      !parsed_.ref.is_valid())
+    return *this;
+
+  if (!parsed_.host.is_nonempty() || SchemeIsFile()) {
+    url_canon::Replacements<char> replacements;
+    replacements.ClearUsername();
+    replacements.ClearPassword();
+    replacements.ClearPath();
+    replacements.ClearQuery();
+    replacements.ClearRef();
+
+    return ReplaceComponents(replacements);
+  }
+
+  // The scheme, host and port are canonical already, so the origin can be
+  // put together from them without canonicalizing it again.
+  GURL origin;
+  std::string origin_spec;
+  origin_spec.reserve(parsed_.scheme.len + 3 + parsed_.host.len +
+                      (parsed_.port.is_valid() ? parsed_.port.len + 1 : 0) +
+                      1);
+  origin.parsed_.scheme = url_parse::Component(0, parsed_.scheme.len);
+  origin_spec.append(raw_spec(), parsed_.scheme.begin, parsed_.scheme.len);
+  origin_spec.append("://");
+  origin.parsed_.host = url_parse::Component(
+      static_cast<int>(origin_spec.length()), parsed_.host.len);
+  origin_spec.append(raw_spec(), parsed_.host.begin, parsed_.host.len);
+  if (parsed_.port.is_valid()) {
+    origin_spec.push_back(':');
+    origin.parsed_.port = url_parse::Component(
+        static_cast<int>(origin_spec.length()), parsed_.port.len);
+    origin_spec.append(raw_spec(), parsed_.port.begin, parsed_.port.len);
+  }
+  origin.parsed_.path = url_parse::Component(
+      static_cast<int>(origin_spec.length()), 1);
+  origin_spec.push_back('/');
+
+  origin.SetSpec(&origin_spec);
+  origin.is_valid_ = true;
+  return origin;
+}
+
+bool GURL::IsSameOriginWith(const GURL& other) const {
+  if (!is_valid_ || !other.is_valid_)
+    return false;
+
+  // The origin of a filesystem URL is the one of its inner URL.
+  const GURL* a = SchemeIsFileSystem() ? inner_url_ : this;
+  const GURL* b = other.SchemeIsFileSystem() ? other.inner_url_ : &other;
+  if (!a || !b || !a->is_valid_ || !b->is_valid_ || !a->IsStandard() ||
+      !b->IsStandard())
+    return false;
 
-  return ReplaceComponents(replacements);
+  return ComponentsEqual(a->raw_spec(), a->parsed_.scheme,
+                         b->raw_spec(), b->parsed_.scheme) &&
+         ComponentsEqual(a->raw_spec(), a->parsed_.host,
+                         b->raw_spec(), b->parsed_.host) &&
+         ComponentsEqual(a->raw_spec(), a->parsed_.port,
+                         b->raw_spec(), b->parsed_.port);
 }
 
 GURL GURL::GetWithEmptyPath() const {
@@ -359,43 +545,46 @@ GURL GURL::GetWithEmptyPath() const {
   other.parsed_.query.reset();
   other.parsed_.ref.reset();
 
-  // Set the path, since the path is longer than one, we can just set the
-  // first character and resize.
-  other.spec_[other.parsed_.path.begin] = '/';
+  // Set the path, since the path is longer than one, we can just keep the
+  // text up to its first character and make that a slash. The spec is
+  // shared, so this is done in a new one.
+  std::string spec(raw_spec(), 0, other.parsed_.path.begin);
+  spec.push_back('/');
   other.parsed_.path.len = 1;
-  other.spec_.resize(other.parsed_.path.begin + 1);
+  other.SetSpec(&spec);
   return other;
 }
 
 bool GURL::IsStandard() const {
-  return url_util::IsStandard(spec_.data(), parsed_.scheme);
+  return url_util::IsStandard(raw_spec().data(), parsed_.scheme);
 }
 
 bool GURL::SchemeIs(const char* lower_ascii_scheme) const {
   if (parsed_.scheme.len <= 0)
     return lower_ascii_scheme == NULL;
-  return url_util::LowerCaseEqualsASCII(spec_.data() + parsed_.scheme.begin,
-                                        spec_.data() + parsed_.scheme.end(),
+  const char* spec = raw_spec().data();
+  return url_util::LowerCaseEqualsASCII(spec + parsed_.scheme.begin,
+                                        spec + parsed_.scheme.end(),
                                         lower_ascii_scheme);
 }
 
 int GURL::IntPort() const {
   if (parsed_.port.is_nonempty())
-    return url_parse::ParsePort(spec_.data(), parsed_.port);
+    return url_parse::ParsePort(raw_spec().data(), parsed_.port);
   return url_parse::PORT_UNSPECIFIED;
 }
 
 int GURL::EffectiveIntPort() const {
   int int_port = IntPort();
   if (int_port == url_parse::PORT_UNSPECIFIED && IsStandard())
-    return url_canon::DefaultPortForScheme(spec_.data() + parsed_.scheme.begin,
-                                           parsed_.scheme.len);
+    return url_canon::DefaultPortForScheme(
+        raw_spec().data() + parsed_.scheme.begin, parsed_.scheme.len);
   return int_port;
 }
 
 std::string GURL::ExtractFileName() const {
   url_parse::Component file_component;
-  url_parse::ExtractFileName(spec_.data(), parsed_.path, &file_component);
+  url_parse::ExtractFileName(raw_spec().data(), parsed_.path, &file_component);
   return ComponentString(file_component);
 }
 
@@ -404,7 +593,7 @@ std::string GURL::PathForRequest() const {
   if (parsed_.ref.len >= 0) {
     // Clip off the reference when it exists. The reference starts after the #
     // sign, so we have to subtract one to also remove it.
-    return std::string(spec_, parsed_.path.begin,
+    return std::string(raw_spec(), parsed_.path.begin,
                        parsed_.ref.begin - parsed_.path.begin - 1);
   }
   // Compute the actual path length, rather than depending on the spec's
@@ -414,13 +603,14 @@ std::string GURL::PathForRequest() const {
   if (parsed_.query.is_valid())
     path_len = parsed_.query.end() - parsed_.path.begin;
 
-  return std::string(spec_, parsed_.path.begin, path_len);
+  return std::string(raw_spec(), parsed_.path.begin, path_len);
 }
 
 std::string GURL::HostNoBrackets() const {
   // If host looks like an IPv6 literal, strip the square brackets.
   url_parse::Component h(parsed_.host);
-  if (h.len >= 2 && spec_[h.begin] == '[' && spec_[h.end() - 1] == ']') {
+  const std::string& spec = raw_spec();
+  if (h.len >= 2 && spec[h.begin] == '[' && spec[h.end() - 1] == ']') {
     h.begin++;
     h.len -= 2;
   }
@@ -428,12 +618,12 @@ std::string GURL::HostNoBrackets() const {
 }
 
 bool GURL::HostIsIPAddress() const {
-  if (!is_valid_ || spec_.empty())
+  if (!is_valid_ || raw_spec().empty())
      return false;
 
   url_canon::RawCanonOutputT<char, 128> ignored_output;
   url_canon::CanonHostInfo host_info;
-  url_canon::CanonicalizeIPAddress(spec_.c_str(), parsed_.host,
+  url_canon::CanonicalizeIPAddress(raw_spec().c_str(), parsed_.host,
                                    &ignored_output, &host_info);
   return host_info.IsIPAddress();
 }
@@ -486,7 +676,7 @@ bool GURL::DomainIs(const char* lower_ascii_domain,
   // Check whether the host name is end with a dot. If yes, treat it
   // the same as no-dot unless the input comparison domain is end
   // with dot.
-  const char* last_pos = spec_.data() + parsed_.host.end() - 1;
+  const char* last_pos = raw_spec().data() + parsed_.host.end() - 1;
   int host_len = parsed_.host.len;
   if ('.' == *last_pos && '.' != lower_ascii_domain[domain_len - 1]) {
     last_pos--;
@@ -498,7 +688,7 @@ bool GURL::DomainIs(const char* lower_ascii_domain,
     return false;
 
   // Compare this url whether belong specific domain.
-  const char* start_pos = spec_.data() + parsed_.host.begin +
+  const char* start_pos = raw_spec().data() + parsed_.host.begin +
                           host_len - domain_len;
 
   if (!url_util::LowerCaseEqualsASCII(start_pos,
@@ -517,8 +707,16 @@ bool GURL::DomainIs(const char* lower_ascii_domain,
   return true;
 }
 
+void GURL::SetSpec(std::string* spec) {
+  SharedSpec* new_spec =
+      spec->empty() ? SharedSpec::GetEmpty() : new SharedSpec(spec);
+  if (shared_spec_)
+    shared_spec_->Release();
+  shared_spec_ = new_spec;
+}
+
 void GURL::Swap(GURL* other) {
-  spec_.swap(other->spec_);
+  std::swap(shared_spec_, other->shared_spec_);
   std::swap(is_valid_, other->is_valid_);
   std::swap(parsed_, other->parsed_);
   std::swap(inner_url_, other->inner_url_);
@@ -47,8 +47,8 @@ class GURL {
   // Creates an empty, invalid URL.
   GURL_API GURL();
 
-  // Copy construction is relatively inexpensive, with most of the time going
-  // to reallocating the string. It does not re-parse.
+  // Copy construction is inexpensive: the copy shares the spec of |other|
+  // and doesn't re-parse. Only the inner URL of filesystem: URLs is copied.
   GURL_API GURL(const GURL& other);
 
   // The narrow version requires the input be UTF-8. Invalid UTF-8 input will
@@ -69,6 +69,13 @@ class GURL {
   GURL_API GURL(const char* canonical_spec, size_t canonical_spec_len,
                 const url_parse::Parsed& parsed, bool is_valid);
 
+  // Creates a valid GURL from a spec that is known to be canonical, for
+  // example because it was read back from storage that only holds the specs
+  // of valid GURLs. Standard URLs are only parsed, which is much cheaper than
+  // canonicalizing them; other URLs are canonicalized as usual. Debug builds
+  // check that the spec is indeed canonical.
+  GURL_API static GURL FromCanonicalSpec(const std::string& canonical_spec);
+
   GURL_API ~GURL();
 
   GURL_API GURL& operator=(const GURL& other);
@@ -86,7 +93,7 @@ class GURL {
   // invalid, and is_valid() will return false for them. This is provided
   // because some users may want to treat the empty case differently.
   bool is_empty() const {
-    return spec_.empty();
+    return raw_spec().empty();
   }
 
   // Returns the raw spec, i.e., the full text of the URL, in canonical UTF-8,
@@ -112,7 +119,7 @@ class GURL {
   //
   // The returned string is guaranteed to be valid UTF-8.
   const std::string& possibly_invalid_spec() const {
-    return spec_;
+    return raw_spec();
   }
 
   // Getter for the raw parsed structure. This allows callers to locate parts
@@ -129,15 +136,16 @@ class GURL {
 
   // Defiant equality operator!
   bool operator==(const GURL& other) const {
-    return spec_ == other.spec_;
+    return shared_spec_ == other.shared_spec_ ||
+        raw_spec() == other.raw_spec();
   }
   bool operator!=(const GURL& other) const {
-    return spec_ != other.spec_;
+    return !(*this == other);
   }
 
   // Allows GURL to used as a key in STL (for example, a std::set or std::map).
   bool operator<(const GURL& other) const {
-    return spec_ < other.spec_;
+    return raw_spec() < other.raw_spec();
   }
 
   // Resolves a URL that's possibly relative to this object's URL, and returns
@@ -210,6 +218,12 @@ class GURL {
   // will be the empty URL.
   GURL_API GURL GetOrigin() const;
 
+  // Returns true if this URL and |other| are both valid standard URLs and
+  // have the same origin. This is the same as comparing the results of
+  // GetOrigin(), but it compares the scheme, host and port in place rather
+  // than creating the two origin GURLs.
+  GURL_API bool IsSameOriginWith(const GURL& other) const;
+
   // Returns true if the scheme for the current URL is a known "standard"
   // scheme. Standard schemes have an authority and a path section. This
   // includes file: and filesystem:, which some callers may want to filter out
@@ -362,15 +376,54 @@ class GURL {
   }
 
  private:
+  // The spec of a GURL, which the copies of the GURL share rather than each
+  // having a std::string of their own. It is never modified once created.
+  class SharedSpec {
+   public:
+    // Takes the contents of |spec|, leaving it empty. The reference count
+    // starts at one.
+    explicit SharedSpec(std::string* spec);
+
+    // Returns the spec of empty GURLs, with a reference added.
+    static SharedSpec* GetEmpty();
+
+    const std::string& spec() const {
+      return spec_;
+    }
+
+    void AddRef();
+    // Deletes the spec when the last reference is released.
+    void Release();
+
+   private:
+    ~SharedSpec();
+
+    static void CreateEmpty();
+
+    static SharedSpec* empty_;
+
+    volatile long ref_count_;
+    std::string spec_;
+  };
+
+  // Returns the text of the URL.
+  const std::string& raw_spec() const {
+    return shared_spec_->spec();
+  }
+
+  // Replaces the spec with the contents of |spec|, leaving it empty.
+  void SetSpec(std::string* spec);
+
   // Returns the substring of the input identified by the given component.
   std::string ComponentString(const url_parse::Component& comp) const {
     if (comp.len <= 0)
       return std::string();
-    return std::string(spec_, comp.begin, comp.len);
+    return std::string(raw_spec(), comp.begin, comp.len);
   }
 
-  // The actual text of the URL, in canonical ASCII form.
-  std::string spec_;
+  // The actual text of the URL, in canonical ASCII form. Never NULL; empty
+  // GURLs share a single empty spec.
+  SharedSpec* shared_spec_;
 
   // Set when the given URL is valid. Otherwise, we may still have a spec and
   // components, but they may not identify valid resources (for example, an
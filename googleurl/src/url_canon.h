@@ -130,14 +130,26 @@ class CanonOutputT {
     cur_len_++;
   }
 
+  // Makes sure the buffer can hold at least |estimated_size| characters in
+  // total, resizing it at most once. Callers that know how much they are about
+  // to write can then write to data() directly and call set_length(), rather
+  // than growing the buffer a character at a time. Returns false on OOM.
+  bool ReserveSizeIfNeeded(int estimated_size) {
+    if (estimated_size <= buffer_len_)
+      return true;
+    if (estimated_size >= (1 << 30))
+      return false;
+    Resize(estimated_size);
+    return true;
+  }
+
   // Appends the given string to the output.
   void Append(const T* str, int str_len) {
     if (cur_len_ + str_len > buffer_len_) {
       if (!Grow(cur_len_ + str_len - buffer_len_))
         return;
     }
-    for (int i = 0; i < str_len; i++)
-      buffer_[cur_len_ + i] = str[i];
+    memcpy(&buffer_[cur_len_], str, sizeof(T) * str_len);
     cur_len_ += str_len;
   }
 
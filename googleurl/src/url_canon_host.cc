@@ -27,6 +27,17 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
 #include "base/logging.h"
 #include "googleurl/src/url_canon.h"
 #include "googleurl/src/url_canon_internal.h"
@@ -310,6 +321,159 @@ bool DoComplexHost(const char16* host, int host_len,
   return DoIDNHost(host, host_len, output);
 }
 
+// The most hosts HostCache remembers.
+const size_t kMaxHostCacheEntries = 1024;
+
+// A mutex for HostCache, which may be used from any thread.
+class HostCacheLock {
+ public:
+#ifdef WIN32
+  HostCacheLock() { InitializeCriticalSection(&section_); }
+  void Acquire() { EnterCriticalSection(&section_); }
+  void Release() { LeaveCriticalSection(&section_); }
+#else
+  HostCacheLock() { pthread_mutex_init(&mutex_, NULL); }
+  void Acquire() { pthread_mutex_lock(&mutex_); }
+  void Release() { pthread_mutex_unlock(&mutex_); }
+#endif
+
+ private:
+#ifdef WIN32
+  CRITICAL_SECTION section_;
+#else
+  pthread_mutex_t mutex_;
+#endif
+};
+
+class AutoHostCacheLock {
+ public:
+  explicit AutoHostCacheLock(HostCacheLock* lock) : lock_(lock) {
+    lock_->Acquire();
+  }
+  ~AutoHostCacheLock() {
+    lock_->Release();
+  }
+
+ private:
+  HostCacheLock* lock_;
+};
+
+// What canonicalizing a host gave: the canonical host, and how it was
+// classified.
+struct HostCacheEntry {
+  std::string canonical_host;
+  CanonHostInfo::Family family;
+  int num_ipv4_components;
+  unsigned char address[16];
+};
+
+// Remembers what the hosts that needed unescaping or IDN conversion were
+// canonicalized to, so that a host that is seen again skips the conversion
+// and the IP address parsing. Those are much slower than a lookup, while
+// ASCII hosts are quick enough to canonicalize that they aren't cached. The
+// least recently used host is dropped when the cache is full.
+class HostCache {
+ public:
+  // Returns the process-wide cache. It is never deleted.
+  static HostCache* GetInstance();
+
+  // Copies the entry for |key| to |*entry| and returns true if there is one.
+  bool Lookup(const std::string& key, HostCacheEntry* entry);
+
+  void Insert(const std::string& key, const HostCacheEntry& entry);
+
+ private:
+  typedef std::list<std::pair<std::string, HostCacheEntry> > EntryList;
+  typedef std::map<std::string, EntryList::iterator> EntryMap;
+
+  HostCache() {}
+
+  static void CreateInstance();
+
+  static HostCache* instance_;
+
+  HostCacheLock lock_;
+  // Most recently used first.
+  EntryList entries_;
+  EntryMap index_;
+};
+
+HostCache* HostCache::instance_ = NULL;
+
+#ifdef WIN32
+
+// static
+HostCache* HostCache::GetInstance() {
+  if (!instance_) {
+    // Be careful that we don't break in the case that this is being called
+    // from multiple threads. Statics are not threadsafe.
+    HostCache* new_instance = new HostCache;
+    if (InterlockedCompareExchangePointer(
+        reinterpret_cast<PVOID*>(&instance_), new_instance, NULL)) {
+      // Another thread did the initialization out from under us.
+      delete new_instance;
+    }
+  }
+  return instance_;
+}
+
+#else
+
+pthread_once_t host_cache_once = PTHREAD_ONCE_INIT;
+
+// static
+void HostCache::CreateInstance() {
+  instance_ = new HostCache;
+}
+
+// static
+HostCache* HostCache::GetInstance() {
+  pthread_once(&host_cache_once, CreateInstance);
+  return instance_;
+}
+
+#endif  // WIN32
+
+bool HostCache::Lookup(const std::string& key, HostCacheEntry* entry) {
+  AutoHostCacheLock lock(&lock_);
+  EntryMap::iterator found = index_.find(key);
+  if (found == index_.end())
+    return false;
+
+  // Move the entry to the front.
+  entries_.splice(entries_.begin(), entries_, found->second);
+  *entry = found->second->second;
+  return true;
+}
+
+void HostCache::Insert(const std::string& key, const HostCacheEntry& entry) {
+  AutoHostCacheLock lock(&lock_);
+  EntryMap::iterator found = index_.find(key);
+  if (found != index_.end()) {
+    // Another thread canonicalized the same host meanwhile.
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return;
+  }
+
+  if (index_.size() >= kMaxHostCacheEntries) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.push_front(std::make_pair(key, entry));
+  index_[key] = entries_.begin();
+}
+
+// Returns the HostCache key of the given host. The width of the characters
+// is part of it, as 8-bit hosts are UTF-8 and 16-bit hosts are UTF-16.
+template<typename CHAR>
+std::string MakeHostCacheKey(const CHAR* spec,
+                             const url_parse::Component& host) {
+  std::string key(1, static_cast<char>(sizeof(CHAR)));
+  key.append(reinterpret_cast<const char*>(&spec[host.begin]),
+             host.len * sizeof(CHAR));
+  return key;
+}
+
 template<typename CHAR, typename UCHAR>
 void DoHost(const CHAR* spec,
             const url_parse::Component& host,
@@ -329,11 +493,25 @@ void DoHost(const CHAR* spec,
   const int output_begin = output->length();
 
   bool success;
+  std::string cache_key;
   if (!has_non_ascii && !has_escaped) {
     success = DoSimpleHost(&spec[host.begin], host.len,
                            output, &has_non_ascii);
     DCHECK(!has_non_ascii);
   } else {
+    cache_key = MakeHostCacheKey(spec, host);
+    HostCacheEntry entry;
+    if (HostCache::GetInstance()->Lookup(cache_key, &entry)) {
+      output->Append(entry.canonical_host.data(),
+                     static_cast<int>(entry.canonical_host.length()));
+      host_info->family = entry.family;
+      host_info->num_ipv4_components = entry.num_ipv4_components;
+      memcpy(host_info->address, entry.address, sizeof(entry.address));
+      host_info->out_host =
+          url_parse::MakeRange(output_begin, output->length());
+      return;
+    }
+
     success = DoComplexHost(&spec[host.begin], host.len,
                             has_non_ascii, has_escaped, output);
   }
@@ -360,6 +538,16 @@ void DoHost(const CHAR* spec,
   }
 
   host_info->out_host = url_parse::MakeRange(output_begin, output->length());
+
+  if (!cache_key.empty()) {
+    HostCacheEntry entry;
+    entry.canonical_host.assign(&output->data()[output_begin],
+                                output->length() - output_begin);
+    entry.family = host_info->family;
+    entry.num_ipv4_components = host_info->num_ipv4_components;
+    memcpy(entry.address, host_info->address, sizeof(entry.address));
+    HostCache::GetInstance()->Insert(cache_key, entry);
+  }
 }
 
 }  // namespace
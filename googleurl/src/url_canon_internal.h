@@ -361,6 +361,19 @@ void AppendInvalidNarrowString(const char* spec, int begin, int end,
 void AppendInvalidNarrowString(const char16* spec, int begin, int end,
                                CanonOutput* output);
 
+// Appends a run of characters that the caller found to be all 7-bit and
+// already canonical. The 8-bit version is a block copy, the 16-bit version
+// narrows each character.
+inline void AppendASCIIRun(const char* source, int length,
+                           CanonOutput* output) {
+  output->Append(source, length);
+}
+inline void AppendASCIIRun(const char16* source, int length,
+                           CanonOutput* output) {
+  for (int i = 0; i < length; i++)
+    output->push_back(static_cast<char>(source[i]));
+}
+
 // Misc canonicalization helpers ----------------------------------------------
 
 // Converts between UTF-8 and UTF-16, returning true on successful conversion.
@@ -430,6 +443,12 @@ bool CanonicalizePartialPath(const char16* spec,
                              int path_begin_in_output,
                              CanonOutput* output);
 
+// Also implemented in url_canon_path.cc. Returns true if the given path of
+// an 8-bit spec is nonempty and already canonical, so that CanonicalizePath
+// would copy it unchanged. This is conservative: it may return false for
+// some paths that canonicalize to themselves, such as ones with escapes.
+bool IsCanonicalPath(const char* spec, const url_parse::Component& path);
+
 #ifndef WIN32
 
 // Implementations of Windows' int-to-string conversions
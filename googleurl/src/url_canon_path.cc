@@ -101,6 +101,13 @@ const unsigned char kPathCharLookup[0x100] = {
      ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,
      ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE};
 
+// Returns true if the given character is copied to the output unchanged by
+// DoPartialPath no matter where it appears.
+template<typename UCHAR>
+inline bool IsPlainPathChar(UCHAR ch) {
+  return ch < 0x80 && !(kPathCharLookup[ch] & SPECIAL);
+}
+
 enum DotDisposition {
   // The given dot is just part of a filename and is not special.
   NOT_A_DIRECTORY,
@@ -311,8 +318,14 @@ bool DoPartialPath(const CHAR* spec,
           AppendEscapedChar(out_ch, output);
         }
       } else {
-        // Nothing special about this character, just append it.
-        output->push_back(out_ch);
+        // Nothing special about this character. Most paths are long runs of
+        // such characters, so find where the run ends and append it at once.
+        int run_end = i + 1;
+        while (run_end < end &&
+               IsPlainPathChar(static_cast<UCHAR>(spec[run_end])))
+          run_end++;
+        AppendASCIIRun(&spec[i], run_end - i, output);
+        i = run_end - 1;
       }
     }
   }
@@ -359,6 +372,30 @@ bool CanonicalizePath(const char16* spec,
   return DoPath<char16, char16>(spec, path, output, out_path);
 }
 
+bool IsCanonicalPath(const char* spec, const url_parse::Component& path) {
+  if (path.len <= 0 || spec[path.begin] != '/')
+    return false;
+
+  int end = path.end();
+  for (int i = path.begin + 1; i < end; i++) {
+    unsigned char ch = static_cast<unsigned char>(spec[i]);
+    if (IsPlainPathChar(ch))
+      continue;
+    if (ch != '.')
+      return false;  // Escapes, backslashes and escaped characters.
+
+    // Dots are only rewritten when they start a "." or ".." segment. The
+    // output matches the input up to here, so the slash can be looked for in
+    // the input.
+    int consumed_len;
+    if (spec[i - 1] == '/' &&
+        ClassifyAfterDot<char>(spec, i + 1, end, &consumed_len) !=
+            NOT_A_DIRECTORY)
+      return false;
+  }
+  return true;
+}
+
 bool CanonicalizePartialPath(const char* spec,
                              const url_parse::Component& path,
                              int path_begin_in_output,
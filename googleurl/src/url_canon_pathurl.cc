@@ -38,6 +38,46 @@ namespace url_canon {
 
 namespace {
 
+// Returns the number of bytes |code_point| takes in UTF-8.
+inline int UTF8Length(unsigned code_point) {
+  if (code_point <= 0x7f)
+    return 1;
+  if (code_point <= 0x7ff)
+    return 2;
+  if (code_point <= 0xffff)
+    return 3;
+  return 4;
+}
+
+// Writes |ch| escaped to |*dest| and advances it. Used with DoAppendUTF8 to
+// write into a buffer that is known to be big enough.
+inline void WriteEscapedChar(unsigned char ch, char** dest) {
+  (*dest)[0] = '%';
+  (*dest)[1] = kHexCharLookup[(ch >> 4) & 0xf];
+  (*dest)[2] = kHexCharLookup[ch & 0xf];
+  *dest += 3;
+}
+
+// Returns the exact length |path| of |spec| canonicalizes to in a path URL:
+// ASCII characters are copied and the others are escaped as UTF-8. Invalid
+// characters become the escaped replacement character.
+template<typename CHAR, typename UCHAR>
+int PathURLPathLength(const CHAR* spec, const url_parse::Component& path) {
+  int length = 0;
+  int end = path.end();
+  for (int i = path.begin; i < end; i++) {
+    UCHAR uch = static_cast<UCHAR>(spec[i]);
+    if (uch < 0x20 || uch >= 0x80) {
+      unsigned code_point;
+      ReadUTFChar(spec, &i, end, &code_point);
+      length += 3 * UTF8Length(code_point);
+    } else {
+      length++;
+    }
+  }
+  return length;
+}
+
 template<typename CHAR, typename UCHAR>
 bool DoCanonicalizePathURL(const URLComponentSource<CHAR>& source,
                            const url_parse::Parsed& parsed,
@@ -58,14 +98,28 @@ bool DoCanonicalizePathURL(const URLComponentSource<CHAR>& source,
     // Copy the path using path URL's more lax escaping rules (think for
     // javascript:). We convert to UTF-8 and escape non-ASCII, but leave all
     // ASCII characters alone. This helps readability of JavaStript.
+    //
+    // These paths can be very long (think of data: URLs), so the output is
+    // sized for the whole path up front and written without bounds checks.
     new_parsed->path.begin = output->length();
-    int end = parsed.path.end();
-    for (int i = parsed.path.begin; i < end; i++) {
-      UCHAR uch = static_cast<UCHAR>(source.path[i]);
-      if (uch < 0x20 || uch >= 0x80)
-        success &= AppendUTF8EscapedChar(source.path, &i, end, output);
-      else
-        output->push_back(static_cast<char>(uch));
+    int path_len = PathURLPathLength<CHAR, UCHAR>(source.path, parsed.path);
+    if (output->ReserveSizeIfNeeded(output->length() + path_len)) {
+      char* dest = output->data() + output->length();
+      int end = parsed.path.end();
+      for (int i = parsed.path.begin; i < end; i++) {
+        UCHAR uch = static_cast<UCHAR>(source.path[i]);
+        if (uch < 0x20 || uch >= 0x80) {
+          unsigned code_point;
+          success &= ReadUTFChar(source.path, &i, end, &code_point);
+          DoAppendUTF8<char*, WriteEscapedChar>(code_point, &dest);
+        } else {
+          *dest++ = static_cast<char>(uch);
+        }
+      }
+      DCHECK(dest - output->data() == output->length() + path_len);
+      output->set_length(output->length() + path_len);
+    } else {
+      success = false;
     }
     new_parsed->path.len = output->length() - new_parsed->path.begin;
   } else {
@@ -83,11 +83,20 @@ bool IsAllASCII(const CHAR* spec, const url_parse::Component& query) {
 template<typename CHAR>
 void AppendRaw8BitQueryString(const CHAR* source, int length,
                               CanonOutput* output) {
-  for (int i = 0; i < length; i++) {
-    if (!IsQueryChar(static_cast<unsigned char>(source[i])))
-      AppendEscapedChar(static_cast<unsigned char>(source[i]), output);
-    else  // Doesn't need escaping.
-      output->push_back(static_cast<char>(source[i]));
+  int i = 0;
+  while (i < length) {
+    // Queries rarely need escaping, so append each run of characters that
+    // don't in one block.
+    int run_end = i;
+    while (run_end < length &&
+           IsQueryChar(static_cast<unsigned char>(source[run_end])))
+      run_end++;
+    AppendASCIIRun(&source[i], run_end - i, output);
+    if (run_end == length)
+      break;
+
+    AppendEscapedChar(static_cast<unsigned char>(source[run_end]), output);
+    i = run_end + 1;
   }
 }
 
@@ -114,6 +114,122 @@ bool DoCanonicalizeStandardURL(const URLComponentSource<CHAR>& source,
   return success;
 }
 
+// Returns true if |ch| is in the canonical form of a host name that needs no
+// escaping or IDN conversion.
+inline bool IsCanonicalHostChar(char ch) {
+  return (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') ||
+         ch == '-' || ch == '.';
+}
+
+// Returns true if canonicalizing the given 8-bit standard URL would append it
+// unchanged, in which case the Parsed of the output is the given one. Most
+// URLs seen are canonical already, so checking for that and copying is much
+// cheaper than canonicalizing component by component.
+//
+// This only accepts the common layout "scheme://host[:port]/path[?query]
+// [#ref]" with no user info, a lower case host name that can't be an IP
+// address, and a port that isn't the scheme's default. Anything else is left
+// to the full canonicalizer, so false doesn't mean the URL isn't canonical.
+bool IsCanonicalStandardURL(const char* spec,
+                            int spec_len,
+                            const url_parse::Parsed& parsed) {
+  // Scheme.
+  const url_parse::Component& scheme = parsed.scheme;
+  if (scheme.begin != 0 || scheme.len <= 0 ||
+      !(spec[0] >= 'a' && spec[0] <= 'z'))
+    return false;
+  for (int i = 1; i < scheme.len; i++) {
+    char ch = spec[i];
+    if (!(ch >= 'a' && ch <= 'z') && !(ch >= '0' && ch <= '9') &&
+        ch != '+' && ch != '-' && ch != '.')
+      return false;
+  }
+  int cur = scheme.end();
+  if (spec_len - cur < 3 || spec[cur] != ':' || spec[cur + 1] != '/' ||
+      spec[cur + 2] != '/')
+    return false;
+  cur += 3;
+
+  // Host. IPv4 addresses are rewritten, and each of their components starts
+  // with a digit, so require a label that starts with something else.
+  if (parsed.username.is_valid() || parsed.password.is_valid())
+    return false;
+  const url_parse::Component& host = parsed.host;
+  if (host.begin != cur || host.len <= 0)
+    return false;
+  bool may_be_ip_address = true;
+  for (int i = host.begin; i < host.end(); i++) {
+    char ch = spec[i];
+    if (!IsCanonicalHostChar(ch))
+      return false;
+    if ((i == host.begin || spec[i - 1] == '.') && ch != '.' &&
+        !(ch >= '0' && ch <= '9'))
+      may_be_ip_address = false;
+  }
+  if (may_be_ip_address)
+    return false;
+  cur = host.end();
+
+  // Port: the canonical form has no leading zeros and omits the default.
+  const url_parse::Component& port = parsed.port;
+  if (port.is_valid()) {
+    if (port.begin != cur + 1 || spec[cur] != ':' || port.len <= 0 ||
+        port.len > 5 || spec[port.begin] == '0')
+      return false;
+    int port_num = 0;
+    for (int i = port.begin; i < port.end(); i++) {
+      if (spec[i] < '0' || spec[i] > '9')
+        return false;
+      port_num = port_num * 10 + (spec[i] - '0');
+    }
+    if (port_num > 65535 ||
+        port_num == DefaultPortForScheme(spec, scheme.len))
+      return false;
+    cur = port.end();
+  }
+
+  // Path.
+  if (parsed.path.begin != cur || !IsCanonicalPath(spec, parsed.path))
+    return false;
+  cur = parsed.path.end();
+
+  // Query: everything in it must be left unescaped.
+  const url_parse::Component& query = parsed.query;
+  if (query.is_valid()) {
+    if (query.begin != cur + 1 || spec[cur] != '?')
+      return false;
+    for (int i = query.begin; i < query.end(); i++) {
+      if (!IsQueryChar(static_cast<unsigned char>(spec[i])))
+        return false;
+    }
+    cur = query.end();
+  }
+
+  // Ref: printable ASCII is copied.
+  const url_parse::Component& ref = parsed.ref;
+  if (ref.is_valid()) {
+    if (ref.begin != cur + 1 || spec[cur] != '#')
+      return false;
+    for (int i = ref.begin; i < ref.end(); i++) {
+      unsigned char ch = static_cast<unsigned char>(spec[i]);
+      if (ch < 0x20 || ch >= 0x80)
+        return false;
+    }
+    cur = ref.end();
+  }
+
+  return cur == spec_len;
+}
+
+// Returns |component| moved |offset| characters to the right, for copying the
+// Parsed of a URL appended unchanged.
+url_parse::Component ShiftComponent(const url_parse::Component& component,
+                                    int offset) {
+  if (!component.is_valid())
+    return url_parse::Component();
+  return url_parse::Component(component.begin + offset, component.len);
+}
+
 }  // namespace
 
 
@@ -154,6 +270,22 @@ bool CanonicalizeStandardURL(const char* spec,
                              CharsetConverter* query_converter,
                              CanonOutput* output,
                              url_parse::Parsed* new_parsed) {
+  if (IsCanonicalStandardURL(spec, spec_len, parsed)) {
+    // Validate-only: the output is the input, so only the offsets need to be
+    // recorded.
+    int offset = output->length();
+    output->Append(spec, spec_len);
+    new_parsed->scheme = ShiftComponent(parsed.scheme, offset);
+    new_parsed->username.reset();
+    new_parsed->password.reset();
+    new_parsed->host = ShiftComponent(parsed.host, offset);
+    new_parsed->port = ShiftComponent(parsed.port, offset);
+    new_parsed->path = ShiftComponent(parsed.path, offset);
+    new_parsed->query = ShiftComponent(parsed.query, offset);
+    new_parsed->ref = ShiftComponent(parsed.ref, offset);
+    return true;
+  }
+
   return DoCanonicalizeStandardURL<char, unsigned char>(
       URLComponentSource<char>(spec), parsed, query_converter,
       output, new_parsed);
@@ -81,6 +81,41 @@ std::vector<const char*>* standard_schemes = NULL;
 // See the LockStandardSchemes declaration in the header.
 bool standard_schemes_locked = false;
 
+// How a URL is parsed and canonicalized, depending on its scheme.
+enum SchemeType {
+  SCHEME_PATH,  // Anything that isn't below, like "data" and "javascript".
+  SCHEME_STANDARD,
+  SCHEME_FILE,
+  SCHEME_FILESYSTEM,
+  SCHEME_MAILTO,
+};
+
+struct SchemeTableEntry {
+  const char* scheme;  // NULL for empty slots.
+  int scheme_len;
+  SchemeType type;
+};
+
+// A perfect hash table of the schemes that aren't SCHEME_PATH, built by
+// LockStandardSchemes once the list of standard schemes can't change anymore.
+// Each scheme hashes to a slot of its own, so classifying a scheme takes one
+// hash and at most one comparison instead of a comparison per scheme. NULL
+// before the schemes are locked.
+std::vector<SchemeTableEntry>* scheme_table = NULL;
+unsigned scheme_table_seed = 0;
+
+// Hashes the lower case form of the scheme in [begin, end). The seed is
+// varied until no two known schemes collide.
+template<typename CHAR>
+unsigned HashScheme(const CHAR* begin, const CHAR* end, unsigned seed) {
+  unsigned hash = 2166136261u ^ seed;
+  for (const CHAR* it = begin; it != end; ++it) {
+    hash ^= static_cast<unsigned>(ToLowerASCII(*it));
+    hash *= 16777619u;
+  }
+  return hash ^ (hash >> 15);
+}
+
 // Ensures that the standard_schemes list is initialized, does nothing if it
 // already has values.
 void InitStandardSchemes() {
@@ -104,6 +139,99 @@ inline bool DoCompareSchemeComponent(const CHAR* spec,
                               compare_to);
 }
 
+// Fills |scheme_table| with the standard schemes and mailto, choosing a seed
+// and a size for which the hash is perfect. Leaves it NULL in the unlikely
+// case that none is found, the schemes are then compared one by one.
+void BuildSchemeTable() {
+  InitStandardSchemes();
+  std::vector<SchemeTableEntry> entries;
+  for (size_t i = 0; i < standard_schemes->size(); i++) {
+    SchemeTableEntry entry;
+    entry.scheme = standard_schemes->at(i);
+    entry.scheme_len = static_cast<int>(strlen(entry.scheme));
+    if (!strcmp(entry.scheme, kFileScheme))
+      entry.type = SCHEME_FILE;
+    else if (!strcmp(entry.scheme, kFileSystemScheme))
+      entry.type = SCHEME_FILESYSTEM;
+    else
+      entry.type = SCHEME_STANDARD;
+    entries.push_back(entry);
+  }
+  // A standard scheme takes precedence over mailto, as in DoCanonicalize.
+  bool mailto_is_standard = false;
+  for (size_t i = 0; i < entries.size(); i++)
+    mailto_is_standard |= !strcmp(entries[i].scheme, kMailtoScheme);
+  if (!mailto_is_standard) {
+    SchemeTableEntry entry;
+    entry.scheme = kMailtoScheme;
+    entry.scheme_len = static_cast<int>(strlen(kMailtoScheme));
+    entry.type = SCHEME_MAILTO;
+    entries.push_back(entry);
+  }
+
+  const size_t kMaxTableSize = 1 << 16;
+  const unsigned kSeedsPerSize = 256;
+  size_t size = 1;
+  while (size < entries.size() * 2)
+    size *= 2;
+  for (; size <= kMaxTableSize; size *= 2) {
+    for (unsigned seed = 0; seed < kSeedsPerSize; seed++) {
+      SchemeTableEntry empty = { NULL, 0, SCHEME_PATH };
+      std::vector<SchemeTableEntry> table(size, empty);
+      bool collided = false;
+      for (size_t i = 0; i < entries.size() && !collided; i++) {
+        const char* scheme = entries[i].scheme;
+        size_t slot = HashScheme(scheme, scheme + entries[i].scheme_len,
+                                 seed) & (size - 1);
+        // Schemes added twice share their slot.
+        collided = table[slot].scheme &&
+            strcmp(table[slot].scheme, scheme) != 0;
+        if (!table[slot].scheme)
+          table[slot] = entries[i];
+      }
+      if (!collided) {
+        scheme_table = new std::vector<SchemeTableEntry>;
+        scheme_table->swap(table);
+        scheme_table_seed = seed;
+        return;
+      }
+    }
+  }
+}
+
+// Returns the type of the scheme identified by |scheme| within |spec|.
+template<typename CHAR>
+SchemeType DoClassifyScheme(const CHAR* spec,
+                            const url_parse::Component& scheme) {
+  if (!scheme.is_nonempty())
+    return SCHEME_PATH;  // Empty or invalid schemes are non-standard.
+
+  const CHAR* begin = &spec[scheme.begin];
+  const CHAR* end = &spec[scheme.end()];
+  if (scheme_table) {
+    size_t slot = HashScheme(begin, end, scheme_table_seed) &
+        (scheme_table->size() - 1);
+    const SchemeTableEntry& entry = (*scheme_table)[slot];
+    if (entry.scheme && entry.scheme_len == scheme.len &&
+        LowerCaseEqualsASCII(begin, end, entry.scheme))
+      return entry.type;
+    return SCHEME_PATH;
+  }
+
+  if (DoCompareSchemeComponent(spec, scheme, kFileScheme))
+    return SCHEME_FILE;
+  if (DoCompareSchemeComponent(spec, scheme, kFileSystemScheme))
+    return SCHEME_FILESYSTEM;
+  InitStandardSchemes();
+  for (size_t i = 0; i < standard_schemes->size(); i++) {
+    if (LowerCaseEqualsASCII(begin, end, standard_schemes->at(i)))
+      return SCHEME_STANDARD;
+  }
+  if (DoCompareSchemeComponent(spec, scheme, kMailtoScheme))
+    return SCHEME_MAILTO;
+  return SCHEME_PATH;
+}
+
 // Returns true if the given scheme identified by |scheme| within |spec| is one
 // of the registered "standard" schemes.
 template<typename CHAR>
@@ -111,6 +239,12 @@ bool DoIsStandard(const CHAR* spec, const url_parse::Component& scheme) {
   if (!scheme.is_nonempty())
     return false;  // Empty or invalid schemes are non-standard.
 
+  if (scheme_table) {
+    SchemeType type = DoClassifyScheme(spec, scheme);
+    return type == SCHEME_STANDARD || type == SCHEME_FILE ||
+        type == SCHEME_FILESYSTEM;
+  }
+
   InitStandardSchemes();
   for (size_t i = 0; i < standard_schemes->size(); i++) {
     if (LowerCaseEqualsASCII(&spec[scheme.begin], &spec[scheme.end()],
@@ -184,38 +318,47 @@ bool DoCanonicalize(const CHAR* in_spec, int in_spec_len,
   // This is the parsed version of the input URL, we have to canonicalize it
   // before storing it in our object.
   bool success;
-  if (DoCompareSchemeComponent(spec, scheme, kFileScheme)) {
-    // File URLs are special.
-    url_parse::ParseFileURL(spec, spec_len, &parsed_input);
-    success = url_canon::CanonicalizeFileURL(spec, spec_len, parsed_input,
-                                             charset_converter, output,
-                                             output_parsed);
-  } else if (DoCompareSchemeComponent(spec, scheme, kFileSystemScheme)) {
-    // Filesystem URLs are special.
-    url_parse::ParseFileSystemURL(spec, spec_len, &parsed_input);
-    success = url_canon::CanonicalizeFileSystemURL(spec, spec_len,
+  switch (DoClassifyScheme(spec, scheme)) {
+    case SCHEME_FILE:
+      // File URLs are special.
+      url_parse::ParseFileURL(spec, spec_len, &parsed_input);
+      success = url_canon::CanonicalizeFileURL(spec, spec_len, parsed_input,
+                                               charset_converter, output,
+                                               output_parsed);
+      break;
+
+    case SCHEME_FILESYSTEM:
+      // Filesystem URLs are special.
+      url_parse::ParseFileSystemURL(spec, spec_len, &parsed_input);
+      success = url_canon::CanonicalizeFileSystemURL(spec, spec_len,
+                                                     parsed_input,
+                                                     charset_converter,
+                                                     output, output_parsed);
+      break;
+
+    case SCHEME_STANDARD:
+      // All "normal" URLs.
+      url_parse::ParseStandardURL(spec, spec_len, &parsed_input);
+      success = url_canon::CanonicalizeStandardURL(spec, spec_len,
                                                    parsed_input,
                                                    charset_converter,
                                                    output, output_parsed);
+      break;
 
-  } else if (DoIsStandard(spec, scheme)) {
-    // All "normal" URLs.
-    url_parse::ParseStandardURL(spec, spec_len, &parsed_input);
-    success = url_canon::CanonicalizeStandardURL(spec, spec_len, parsed_input,
-                                                 charset_converter,
+    case SCHEME_MAILTO:
+      // Mailto are treated like a standard url with only a scheme, path,
+      // query
+      url_parse::ParseMailtoURL(spec, spec_len, &parsed_input);
+      success = url_canon::CanonicalizeMailtoURL(spec, spec_len, parsed_input,
                                                  output, output_parsed);
+      break;
 
-  } else if (DoCompareSchemeComponent(spec, scheme, kMailtoScheme)) {
-    // Mailto are treated like a standard url with only a scheme, path, query
-    url_parse::ParseMailtoURL(spec, spec_len, &parsed_input);
-    success = url_canon::CanonicalizeMailtoURL(spec, spec_len, parsed_input,
+    default:
+      // "Weird" URLs like data: and javascript:
+      url_parse::ParsePathURL(spec, spec_len, &parsed_input);
+      success = url_canon::CanonicalizePathURL(spec, spec_len, parsed_input,
                                                output, output_parsed);
-
-  } else {
-    // "Weird" URLs like data: and javascript:
-    url_parse::ParsePathURL(spec, spec_len, &parsed_input);
-    success = url_canon::CanonicalizePathURL(spec, spec_len, parsed_input,
-                                             output, output_parsed);
+      break;
   }
   return success;
 }
@@ -338,27 +481,26 @@ bool DoReplaceComponents(const char* spec,
 
   // If we get here, then we know the scheme doesn't need to be replaced, so can
   // just key off the scheme in the spec to know how to do the replacements.
-  if (DoCompareSchemeComponent(spec, parsed.scheme, kFileScheme)) {
-    return url_canon::ReplaceFileURL(spec, parsed, replacements,
-                                     charset_converter, output, out_parsed);
-  }
-  if (DoCompareSchemeComponent(spec, parsed.scheme, kFileSystemScheme)) {
-    return url_canon::ReplaceFileSystemURL(spec, parsed, replacements,
+  switch (DoClassifyScheme(spec, parsed.scheme)) {
+    case SCHEME_FILE:
+      return url_canon::ReplaceFileURL(spec, parsed, replacements,
+                                       charset_converter, output, out_parsed);
+    case SCHEME_FILESYSTEM:
+      return url_canon::ReplaceFileSystemURL(spec, parsed, replacements,
+                                             charset_converter, output,
+                                             out_parsed);
+    case SCHEME_STANDARD:
+      return url_canon::ReplaceStandardURL(spec, parsed, replacements,
                                            charset_converter, output,
                                            out_parsed);
+    case SCHEME_MAILTO:
+      return url_canon::ReplaceMailtoURL(spec, parsed, replacements,
+                                         output, out_parsed);
+    default:
+      // Default is a path URL.
+      return url_canon::ReplacePathURL(spec, parsed, replacements,
+                                       output, out_parsed);
   }
-  if (DoIsStandard(spec, parsed.scheme)) {
-    return url_canon::ReplaceStandardURL(spec, parsed, replacements,
-                                         charset_converter, output, out_parsed);
-  }
-  if (DoCompareSchemeComponent(spec, parsed.scheme, kMailtoScheme)) {
-     return url_canon::ReplaceMailtoURL(spec, parsed, replacements,
-                                        output, out_parsed);
-  }
-
-  // Default is a path URL.
-  return url_canon::ReplacePathURL(spec, parsed, replacements,
-                                   output, out_parsed);
 }
 
 }  // namespace
@@ -372,6 +514,10 @@ void Shutdown() {
     delete standard_schemes;
     standard_schemes = NULL;
   }
+  if (scheme_table) {
+    delete scheme_table;
+    scheme_table = NULL;
+  }
 }
 
 void AddStandardScheme(const char* new_scheme) {
@@ -400,7 +546,10 @@ void AddStandardScheme(const char* new_scheme) {
 }
 
 void LockStandardSchemes() {
+  if (standard_schemes_locked)
+    return;
   standard_schemes_locked = true;
+  BuildSchemeTable();
 }
 
 bool IsStandard(const char* spec, const url_parse::Component& scheme) {
@@ -443,6 +592,34 @@ bool Canonicalize(const char16* spec,
                         output, output_parsed);
 }
 
+void CanonicalizeBatch(const char* const* specs,
+                       const int* spec_lens,
+                       int count,
+                       url_canon::CharsetConverter* charset_converter,
+                       url_canon::CanonOutput* output,
+                       CanonicalizedURL* results) {
+  // Canonical specs are rarely longer than their input, so make room for all
+  // of them up front.
+  int total_len = output->length();
+  for (int i = 0; i < count; i++)
+    total_len += spec_lens[i];
+  if (output->capacity() < total_len)
+    output->Resize(total_len + total_len / 8);
+
+  // Each URL is canonicalized on its own so that its Parsed is relative to
+  // its spec, then appended.
+  url_canon::RawCanonOutput<1024> canonical;
+  for (int i = 0; i < count; i++) {
+    canonical.set_length(0);
+    results[i].is_valid = DoCanonicalize(specs[i], spec_lens[i],
+                                         charset_converter, &canonical,
+                                         &results[i].parsed);
+    results[i].begin = output->length();
+    results[i].len = canonical.length();
+    output->Append(canonical.data(), canonical.length());
+  }
+}
+
 bool ResolveRelative(const char* base_spec,
                      int base_spec_len,
                      const url_parse::Parsed& base_parsed,
@@ -77,6 +77,11 @@ GURL_API void AddStandardScheme(const char* new_scheme);
 // program is running with multiple threads, where such usage would be
 // dangerous.
 //
+// Since the list can't change anymore, this also builds a hash table of the
+// schemes, so that finding how to canonicalize a URL no longer compares its
+// scheme with each standard scheme in turn. Like AddStandardScheme, it isn't
+// threadsafe.
+//
 // We could have had AddStandardScheme use a lock instead, but that would add
 // some platform-specific dependencies we don't otherwise have now, and is
 // overkill considering the normal usage is so simple.
@@ -146,6 +151,37 @@ GURL_API bool Canonicalize(const char16* spec,
                            url_canon::CanonOutput* output,
                            url_parse::Parsed* output_parsed);
 
+// The result of canonicalizing one of the URLs given to CanonicalizeBatch.
+struct CanonicalizedURL {
+  // Where the canonical spec is in the output.
+  int begin;
+  int len;
+
+  // The parsed canonical spec. The components are relative to |begin|, so
+  // the spec can be used without copying, for example with the GURL
+  // constructor for parsed and canonicalized URLs.
+  url_parse::Parsed parsed;
+
+  // What Canonicalize() would return for the URL.
+  bool is_valid;
+};
+
+// Canonicalizes |count| URLs, the i-th of which is |specs[i]| and
+// |spec_lens[i]| characters long, appending their canonical specs one after
+// the other to |output| and describing the i-th in |results[i]|. This is
+// meant for bulk imports: the output is one buffer for all of the URLs, and
+// it is sized once up front.
+//
+// Canonicalization is threadsafe once the standard schemes are locked (see
+// LockStandardSchemes), so a large batch can be split up and its parts given
+// to several threads, each with an output of its own.
+GURL_API void CanonicalizeBatch(const char* const* specs,
+                                const int* spec_lens,
+                                int count,
+                                url_canon::CharsetConverter* charset_converter,
+                                url_canon::CanonOutput* output,
+                                CanonicalizedURL* results);
+
 // Resolves a potentially relative URL relative to the given parsed base URL.
 // The base MUST be valid. The resulting canonical URL and parsed information
 // will be placed in to the given out variables.
@@ -57,6 +57,19 @@ static FontConfigInterface* GetFcImpl() {
   return global_fc_impl;
 }
 
+void SkiaFontConfigPreloadFamilies(const char* const families[],
+                                   size_t count) {
+    FontConfigInterface* fc_impl = GetFcImpl();
+    for (size_t i = 0; i < count; ++i) {
+        for (int style = 0; style < 2; ++style) {
+            bool is_bold = style != 0;
+            bool is_italic = false;
+            fc_impl->Match(NULL, NULL, false, 0, families[i], NULL, 0,
+                           &is_bold, &is_italic);
+        }
+    }
+}
+
 SK_DECLARE_STATIC_MUTEX(global_remote_font_map_lock);
 static std::map<uint32_t, std::pair<uint8_t*, size_t> >* global_remote_fonts;
 
@@ -227,9 +240,84 @@ uint32_t SkFontHost::NextLogicalFont(SkFontID curr, SkFontID orig) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// The mappings of the system font files that streams are open on, by file id.
+// Each face of a file, at each style, opens its own stream on the file, so
+// the streams share one mapping, which is unmapped when the last of them is
+// closed.
+struct FontFileMapping {
+    uint8_t* memory;
+    size_t length;
+    int ref_count;
+};
+
+SK_DECLARE_STATIC_MUTEX(global_font_file_mappings_lock);
+static std::map<unsigned, FontFileMapping>* global_font_file_mappings;
+
+// For system fonts, filefaceid = (fileid << 4) | face_index.
+static unsigned FileFaceIdToFileId(unsigned filefaceid)
+{
+    return filefaceid >> 4;
+}
+
+// Returns a reference to the mapping of the file of |filefaceid|, mapping it
+// if no stream has it mapped. Returns false if the file can't be mapped.
+static bool AcquireFontFileMapping(unsigned filefaceid,
+                                   const uint8_t** memory, size_t* length)
+{
+    SkAutoMutexAcquire ac(global_font_file_mappings_lock);
+    if (!global_font_file_mappings)
+        global_font_file_mappings = new std::map<unsigned, FontFileMapping>();
+
+    const unsigned fileid = FileFaceIdToFileId(filefaceid);
+    std::map<unsigned, FontFileMapping>::iterator iter =
+        global_font_file_mappings->find(fileid);
+    if (iter == global_font_file_mappings->end()) {
+        const int fd = GetFcImpl()->Open(filefaceid);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st)) {
+            close(fd);
+            return false;
+        }
+
+        void* mapped = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED)
+            return false;
+
+        FontFileMapping mapping;
+        mapping.memory = reinterpret_cast<uint8_t*>(mapped);
+        mapping.length = st.st_size;
+        mapping.ref_count = 0;
+        iter = global_font_file_mappings->insert(
+            std::make_pair(fileid, mapping)).first;
+    }
+
+    iter->second.ref_count++;
+    *memory = iter->second.memory;
+    *length = iter->second.length;
+    return true;
+}
+
+// Releases a reference returned by AcquireFontFileMapping().
+static void ReleaseFontFileMapping(unsigned filefaceid)
+{
+    SkAutoMutexAcquire ac(global_font_file_mappings_lock);
+    std::map<unsigned, FontFileMapping>::iterator iter =
+        global_font_file_mappings->find(FileFaceIdToFileId(filefaceid));
+    SkASSERT(iter != global_font_file_mappings->end());
+    if (--iter->second.ref_count == 0) {
+        munmap(iter->second.memory, iter->second.length);
+        global_font_file_mappings->erase(iter);
+    }
+}
+
 class SkFileDescriptorStream : public SkStream {
   public:
-    SkFileDescriptorStream(int fd) {
+    SkFileDescriptorStream(unsigned filefaceid) {
+        filefaceid_ = filefaceid;
         memory_ = NULL;
         offset_ = 0;
 
@@ -238,21 +326,20 @@ class SkFileDescriptorStream : public SkStream {
         // the requested size down to 0
         length_ = 0;
 
-        struct stat st;
-        if (fstat(fd, &st))
-            return;
-
-        void* memory = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
-        close(fd);
-        if (memory == MAP_FAILED)
-            return;
-
-        memory_ = reinterpret_cast<uint8_t*>(memory);
-        length_ = st.st_size;
+        if (!AcquireFontFileMapping(filefaceid, &memory_, &length_)) {
+            memory_ = NULL;
+            length_ = 0;
+        }
     }
 
     ~SkFileDescriptorStream() {
-        munmap(const_cast<uint8_t*>(memory_), length_);
+        if (memory_)
+            ReleaseFontFileMapping(filefaceid_);
+    }
+
+    // Returns false if the font file couldn't be mapped.
+    bool isValid() const {
+        return memory_ != NULL;
     }
 
     virtual bool rewind() {
@@ -282,6 +369,7 @@ class SkFileDescriptorStream : public SkStream {
     }
 
   private:
+    unsigned filefaceid_;
     const uint8_t* memory_;
     size_t offset_, length_;
 };
@@ -306,11 +394,13 @@ SkStream* SkFontHost::OpenStream(uint32_t id)
     }
 
     // system font
-    const int fd = GetFcImpl()->Open(filefaceid);
-    if (fd < 0)
+    SkFileDescriptorStream* stream =
+        SkNEW_ARGS(SkFileDescriptorStream, (filefaceid));
+    if (!stream->isValid()) {
+        SkDELETE(stream);
         return NULL;
-
-    return SkNEW_ARGS(SkFileDescriptorStream, (fd));
+    }
+    return stream;
 }
 
 // static
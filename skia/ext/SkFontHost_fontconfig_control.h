@@ -19,6 +19,8 @@
 #define FontConfigControl_DEFINED
 #pragma once
 
+#include <stddef.h>
+
 #include "SkPreConfig.h"
 
 class FontConfigInterface;
@@ -36,4 +38,11 @@ SK_API void SkiaFontConfigUseDirectImplementation();
 // FontConfigInterface will be freed.
 SK_API void SkiaFontConfigSetImplementation(FontConfigInterface* font_config);
 
+// Matches each of the |count| families in |families|, in their regular and
+// bold styles, so that the current FontConfigInterface has the results cached
+// before the first typefaces are created. Call on a background thread at
+// startup with the families the UI and common pages use.
+SK_API void SkiaFontConfigPreloadFamilies(const char* const families[],
+                                          size_t count);
+
 #endif  // FontConfigControl_DEFINED
@@ -27,6 +27,9 @@
 
 namespace {
 
+// The most |family,style| matches FontConfigDirect remembers.
+const size_t kMaxCachedFontMatches = 256;
+
 // Equivalence classes, used to match the Liberation and other fonts
 // with their metric-compatible replacements.  See the discussion in
 // GetFontEquivClass().
@@ -291,15 +294,20 @@ bool FontConfigDirect::Match(std::string* result_family,
         int style = (*is_bold ? SkTypeface::kBold : 0 ) |
                     (*is_italic ? SkTypeface::kItalic : 0);
         FontMatchKey key = FontMatchKey(family, style);
-        const std::map<FontMatchKey, FontMatch>::const_iterator i =
+        const std::map<FontMatchKey, CachedFontMatch>::iterator i =
             font_match_cache_.find(key);
         if (i != font_match_cache_.end()) {
-            *is_bold = i->second.is_bold;
-            *is_italic = i->second.is_italic;
+            font_match_lru_.splice(font_match_lru_.begin(), font_match_lru_,
+                                   i->second.lru_position);
+            const FontMatch& font_match = i->second.match;
+            if (!font_match.found)
+                return false;
+            *is_bold = font_match.is_bold;
+            *is_italic = font_match.is_italic;
             if (result_family)
-                *result_family = i->second.family;
+                *result_family = font_match.family;
             if (result_filefaceid)
-                *result_filefaceid = i->second.filefaceid;
+                *result_filefaceid = font_match.filefaceid;
             return true;
         }
     }
@@ -391,6 +399,18 @@ bool FontConfigDirect::Match(std::string* result_family,
     if (!match) {
         FcPatternDestroy(pattern);
         FcFontSetDestroy(font_set);
+        // The family isn't installed. Remember it, so that the next request
+        // for it doesn't sort all the fonts again.
+        if (eligible_for_cache) {
+            int style = (*is_bold ? SkTypeface::kBold : 0 ) |
+                        (*is_italic ? SkTypeface::kItalic : 0);
+            FontMatch no_match;
+            no_match.found = false;
+            no_match.is_bold = false;
+            no_match.is_italic = false;
+            no_match.filefaceid = 0;
+            CacheFontMatch(FontMatchKey(family, style), no_match);
+        }
         return false;
     }
 
@@ -408,6 +428,7 @@ bool FontConfigDirect::Match(std::string* result_family,
     }
 
     FontMatch font_match;
+    font_match.found = true;
     if (filefaceid_valid) {
         font_match.filefaceid = filefaceid;
     } else {
@@ -440,7 +461,7 @@ bool FontConfigDirect::Match(std::string* result_family,
         if (eligible_for_cache) {
             int style = (*is_bold ? SkTypeface::kBold : 0 ) |
                         (*is_italic ? SkTypeface::kItalic : 0);
-            font_match_cache_[FontMatchKey(family, style)] = font_match;
+            CacheFontMatch(FontMatchKey(family, style), font_match);
         }
 
         if (result_family)
@@ -465,3 +486,25 @@ int FontConfigDirect::Open(unsigned filefaceid) {
 
     return open(i->second.c_str(), O_RDONLY);
 }
+
+void FontConfigDirect::CacheFontMatch(const FontMatchKey& key,
+                                      const FontMatch& match) {
+    // |mutex_| is held by the caller.
+    std::map<FontMatchKey, CachedFontMatch>::iterator i =
+        font_match_cache_.find(key);
+    if (i != font_match_cache_.end()) {
+        i->second.match = match;
+        font_match_lru_.splice(font_match_lru_.begin(), font_match_lru_,
+                               i->second.lru_position);
+        return;
+    }
+
+    if (font_match_cache_.size() >= kMaxCachedFontMatches) {
+        font_match_cache_.erase(font_match_lru_.back());
+        font_match_lru_.pop_back();
+    }
+    font_match_lru_.push_front(key);
+    CachedFontMatch& cached = font_match_cache_[key];
+    cached.match = match;
+    cached.lru_position = font_match_lru_.begin();
+}
@@ -19,6 +19,7 @@
 #define FontConfigDirect_DEFINED
 #pragma once
 
+#include <list>
 #include <map>
 #include <string>
 
@@ -45,14 +46,30 @@ class SK_API FontConfigDirect : public FontConfigInterface {
   std::map<std::string, unsigned> filename_to_fileid_;
 
   // Cache of |family,style| to |FontMatch| to minimize querying FontConfig.
+  // Families with no good match are cached too, since CSS font stacks ask for
+  // the same missing families over and over. The least recently used matches
+  // are dropped once there are kMaxCachedFontMatches of them.
   typedef std::pair<std::string, int> FontMatchKey;
   struct FontMatch {
+    bool found;
     std::string family;
     bool is_bold;
     bool is_italic;
     unsigned filefaceid;
   };
-  std::map<FontMatchKey, FontMatch> font_match_cache_;
+  struct CachedFontMatch {
+    FontMatch match;
+    // The position of the key in |font_match_lru_|.
+    std::list<FontMatchKey>::iterator lru_position;
+  };
+
+  // Adds |match| for |key| to the cache, dropping the least recently used
+  // match if it is full.
+  void CacheFontMatch(const FontMatchKey& key, const FontMatch& match);
+
+  std::map<FontMatchKey, CachedFontMatch> font_match_cache_;
+  // The keys of |font_match_cache_|, most recently used first.
+  std::list<FontMatchKey> font_match_lru_;
 
   unsigned next_file_id_;
 };
@@ -4,6 +4,15 @@
 
 #include "skia/ext/bitmap_platform_device_linux.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+#include "base/debug/trace_event.h"
+#include "base/lazy_instance.h"
+#include "base/synchronization/lock.h"
 #include "skia/ext/bitmap_platform_device_data.h"
 
 #if defined(OS_OPENBSD)
@@ -39,6 +48,116 @@ void LoadClipToContext(cairo_t* context, const SkRegion& clip) {
   cairo_clip(context);
 }
 
+// Pixel buffer pool -----------------------------------------------------------
+
+// Buffers bigger than this aren't pooled.
+const size_t kMaxPooledBufferBytes = 4 * 1024 * 1024;
+
+// The most bytes of buffers the pool keeps. Buffers released once the pool is
+// full are freed.
+const size_t kMaxPoolBytes = 16 * 1024 * 1024;
+
+// Returns the size of the buffers that serve requests for |bytes| bytes: a
+// power of two, or 1.25, 1.5 or 1.75 times one, so that a buffer is never
+// more than a quarter bigger than needed.
+size_t GetBucketBytes(size_t bytes) {
+  size_t power = 4096;
+  while (power * 2 <= bytes)
+    power *= 2;
+  size_t step = power / 4;
+  return (bytes + step - 1) / step * step;
+}
+
+struct PooledBuffer {
+  void* pixels;
+  size_t bytes;
+};
+
+void FreeBuffer(PooledBuffer* buffer) {
+  free(buffer->pixels);
+  delete buffer;
+}
+
+// The pixel buffers of the devices that were destroyed, bucketed by size, so
+// that the temporary canvases the UI creates over and over again don't each
+// allocate and clear a new buffer. Devices are created on several threads.
+class PixelBufferPool {
+ public:
+  PixelBufferPool() {}
+
+  // Returns a buffer of |bucket_bytes| bytes from the pool, or NULL if there
+  // is none, counting the hit or the miss.
+  PooledBuffer* Take(size_t bucket_bytes) {
+    PooledBuffer* buffer = NULL;
+    base::AutoLock lock(lock_);
+    BufferMap::iterator it = buffers_.find(bucket_bytes);
+    if (it != buffers_.end()) {
+      buffer = it->second.back();
+      it->second.pop_back();
+      if (it->second.empty())
+        buffers_.erase(it);
+      stats_.pooled_bytes -= buffer->bytes;
+      stats_.hits++;
+    } else {
+      stats_.misses++;
+    }
+    TRACE_COUNTER2("skia", "BitmapDevicePool",
+                   "hits", stats_.hits, "misses", stats_.misses);
+    return buffer;
+  }
+
+  // Keeps |buffer| for a later device, or frees it if the pool is full.
+  void Release(PooledBuffer* buffer) {
+    {
+      base::AutoLock lock(lock_);
+      if (stats_.pooled_bytes + buffer->bytes <= kMaxPoolBytes) {
+        buffers_[buffer->bytes].push_back(buffer);
+        stats_.pooled_bytes += buffer->bytes;
+        return;
+      }
+    }
+    FreeBuffer(buffer);
+  }
+
+  void Purge() {
+    BufferMap buffers;
+    {
+      base::AutoLock lock(lock_);
+      buffers.swap(buffers_);
+      stats_.pooled_bytes = 0;
+    }
+    for (BufferMap::iterator it = buffers.begin(); it != buffers.end(); ++it) {
+      for (size_t i = 0; i < it->second.size(); ++i)
+        FreeBuffer(it->second[i]);
+    }
+  }
+
+  BitmapPlatformDevice::PoolStats GetStats() {
+    base::AutoLock lock(lock_);
+    return stats_;
+  }
+
+ private:
+  typedef std::map<size_t, std::vector<PooledBuffer*> > BufferMap;
+
+  base::Lock lock_;
+  BufferMap buffers_;
+  BitmapPlatformDevice::PoolStats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(PixelBufferPool);
+};
+
+base::LazyInstance<PixelBufferPool>::Leaky g_pixel_buffer_pool =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Identifies the pooled buffer attached to a cairo surface.
+cairo_user_data_key_t g_pooled_buffer_key;
+
+// Called by cairo when the surface of a pooled buffer is destroyed.
+void ReleasePooledBuffer(void* data) {
+  g_pixel_buffer_pool.Get().Release(static_cast<PooledBuffer*>(data));
+}
+
 }  // namespace
 
 BitmapPlatformDevice::BitmapPlatformDeviceData::BitmapPlatformDeviceData(
@@ -96,11 +215,10 @@ BitmapPlatformDevice* BitmapPlatformDevice::Create(int width, int height,
 
 BitmapPlatformDevice* BitmapPlatformDevice::Create(int width, int height,
                                                    bool is_opaque) {
-  // This initializes the bitmap to all zeros.
-  cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
-                                                        width, height);
-
-  BitmapPlatformDevice* device = Create(width, height, is_opaque, surface);
+  // Opaque devices are painted over entirely, so a pooled buffer needn't be
+  // cleared for them.
+  BitmapPlatformDevice* device =
+      CreateFromPool(width, height, is_opaque, !is_opaque);
 
 #ifndef NDEBUG
   if (is_opaque)  // Fill with bright bluish green
@@ -113,14 +231,15 @@ BitmapPlatformDevice* BitmapPlatformDevice::Create(int width, int height,
 BitmapPlatformDevice* BitmapPlatformDevice::CreateAndClear(int width,
                                                            int height,
                                                            bool is_opaque) {
-  // The Linux port always constructs initialized bitmaps, so there is no extra
-  // work to perform here.
-  return Create(width, height, is_opaque);
+  return CreateFromPool(width, height, is_opaque, true);
 }
 
 BitmapPlatformDevice* BitmapPlatformDevice::Create(int width, int height,
                                                    bool is_opaque,
                                                    uint8_t* data) {
+  if (!data)
+    return CreateFromPool(width, height, is_opaque, !is_opaque);
+
   cairo_surface_t* surface = cairo_image_surface_create_for_data(
       data, CAIRO_FORMAT_ARGB32, width, height,
       cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width));
@@ -128,6 +247,67 @@ BitmapPlatformDevice* BitmapPlatformDevice::Create(int width, int height,
   return Create(width, height, is_opaque, surface);
 }
 
+// static
+BitmapPlatformDevice* BitmapPlatformDevice::CreateFromPool(int width,
+                                                           int height,
+                                                           bool is_opaque,
+                                                           bool clear) {
+  int stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
+  size_t bytes = static_cast<size_t>(stride) * height;
+  if (width <= 0 || height <= 0 || stride <= 0 ||
+      bytes > kMaxPooledBufferBytes) {
+    // This initializes the bitmap to all zeros.
+    return Create(width, height, is_opaque,
+                  cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                             width, height));
+  }
+
+  size_t bucket_bytes = GetBucketBytes(bytes);
+  PooledBuffer* buffer = g_pixel_buffer_pool.Get().Take(bucket_bytes);
+  if (buffer) {
+    if (clear)
+      memset(buffer->pixels, 0, bytes);
+  } else {
+    // Fresh buffers are zeroed, and cheaply so for big ones, whose pages
+    // come zeroed from the system.
+    void* pixels = calloc(bucket_bytes, 1);
+    if (!pixels) {
+      return Create(width, height, is_opaque,
+                    cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                               width, height));
+    }
+    buffer = new PooledBuffer;
+    buffer->pixels = pixels;
+    buffer->bytes = bucket_bytes;
+  }
+
+  // The buffer goes back to the pool when the surface is destroyed.
+  cairo_surface_t* surface = cairo_image_surface_create_for_data(
+      static_cast<unsigned char*>(buffer->pixels), CAIRO_FORMAT_ARGB32,
+      width, height, stride);
+  if (cairo_surface_set_user_data(surface, &g_pooled_buffer_key, buffer,
+                                  ReleasePooledBuffer) !=
+      CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy(surface);
+    FreeBuffer(buffer);
+    return Create(width, height, is_opaque,
+                  cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                             width, height));
+  }
+
+  return Create(width, height, is_opaque, surface);
+}
+
+// static
+BitmapPlatformDevice::PoolStats BitmapPlatformDevice::GetPoolStats() {
+  return g_pixel_buffer_pool.Get().GetStats();
+}
+
+// static
+void BitmapPlatformDevice::PurgePool() {
+  g_pixel_buffer_pool.Get().Purge();
+}
+
 // The device will own the bitmap, which corresponds to also owning the pixel
 // data. Therefore, we do not transfer ownership to the SkDevice's bitmap.
 BitmapPlatformDevice::BitmapPlatformDevice(
@@ -71,22 +71,40 @@ class BitmapPlatformDevice : public SkDevice, public PlatformDevice {
   BitmapPlatformDevice(const SkBitmap& other, BitmapPlatformDeviceData* data);
   virtual ~BitmapPlatformDevice();
 
+  // Counts of the pixel buffers that Create() took from the pool of buffers
+  // released by destroyed devices (hits), and that it had to allocate
+  // (misses), since the process started.
+  struct PoolStats {
+    PoolStats() : hits(0), misses(0), pooled_bytes(0) {}
+
+    int hits;
+    int misses;
+    // The bytes of the buffers waiting in the pool.
+    size_t pooled_bytes;
+  };
+
   // Constructs a device with size |width| * |height| with contents initialized
   // to zero. |is_opaque| should be set if the caller knows the bitmap will be
-  // completely opaque and allows some optimizations.
+  // completely opaque and allows some optimizations: the pixel buffer may then
+  // be a pooled one that isn't cleared, so the caller must paint every pixel.
   static BitmapPlatformDevice* Create(int width, int height, bool is_opaque);
 
-  // Performs the same construction as Create.
-  // Other ports require a separate construction routine because Create does not
-  // initialize the bitmap to 0.
+  // Performs the same construction as Create, but always initializes the
+  // bitmap to 0.
   static BitmapPlatformDevice* CreateAndClear(int width, int height,
                                               bool is_opaque);
 
-  // This doesn't take ownership of |data|. If |data| is NULL, the contents
-  // of the device are initialized to 0.
+  // This doesn't take ownership of |data|. If |data| is NULL, the device is
+  // created as by Create() above.
   static BitmapPlatformDevice* Create(int width, int height, bool is_opaque,
                                       uint8_t* data);
 
+  // Returns the counts of the pool of pixel buffers.
+  static PoolStats GetPoolStats();
+
+  // Frees the pixel buffers waiting in the pool, e.g. under memory pressure.
+  static void PurgePool();
+
   // Overridden from SkDevice:
   virtual void setMatrixClip(const SkMatrix& transform, const SkRegion& region,
                              const SkClipStack&) OVERRIDE;
@@ -105,6 +123,11 @@ class BitmapPlatformDevice : public SkDevice, public PlatformDevice {
   static BitmapPlatformDevice* Create(int width, int height, bool is_opaque,
                                       cairo_surface_t* surface);
 
+  // Creates a device whose pixel buffer comes from the pool if one fits.
+  // The buffer is cleared if |clear| is true or it is newly allocated.
+  static BitmapPlatformDevice* CreateFromPool(int width, int height,
+                                              bool is_opaque, bool clear);
+
   scoped_refptr<BitmapPlatformDeviceData> data_;
 
   DISALLOW_COPY_AND_ASSIGN(BitmapPlatformDevice);
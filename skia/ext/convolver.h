@@ -168,6 +168,23 @@ SK_API void BGRAConvolve2D(const unsigned char* source_data,
                            int output_byte_row_stride,
                            unsigned char* output,
                            bool use_sse2);
+
+// Same as BGRAConvolve2D(), but only computes the output rows from
+// |first_output_row| up to, but not including, |end_output_row|. |output|
+// still points to the first row of the whole output image. Each call
+// convolves the input rows its output rows need on its own, so calls for
+// different rows can run on different threads at once, and together give
+// the same result as BGRAConvolve2D().
+SK_API void BGRAConvolve2DRows(const unsigned char* source_data,
+                               int source_byte_row_stride,
+                               bool source_has_alpha,
+                               const ConvolutionFilter1D& xfilter,
+                               const ConvolutionFilter1D& yfilter,
+                               int first_output_row,
+                               int end_output_row,
+                               int output_byte_row_stride,
+                               unsigned char* output,
+                               bool use_sse2);
 }  // namespace skia
 
 #endif  // SKIA_EXT_CONVOLVER_H_
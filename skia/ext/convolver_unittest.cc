@@ -4,6 +4,7 @@
 
 #include <string.h>
 #include <time.h>
+#include <algorithm>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -318,4 +319,58 @@ TEST(Convolver, SIMDVerification) {
 #endif
 }
 
+// Verifies that convolving the output rows in bands gives the same result as
+// convolving them all at once, whatever the bands and the instruction set.
+TEST(Convolver, BandsMatchWholeImage) {
+  const int kSourceWidth = 413;
+  const int kSourceHeight = 307;
+  const int kDestWidth = 157;
+  const int kDestHeight = 131;
+  float filter[] = { 0.05f, -0.15f, 0.6f, 0.6f, -0.15f, 0.05f };
+
+  ConvolutionFilter1D x_filter, y_filter;
+  for (int p = 0; p < kDestWidth; ++p) {
+    int offset = std::min(kSourceWidth * p / kDestWidth,
+                          kSourceWidth - static_cast<int>(arraysize(filter)));
+    x_filter.AddFilter(offset, filter, arraysize(filter));
+  }
+  for (int p = 0; p < kDestHeight; ++p) {
+    int offset = std::min(kSourceHeight * p / kDestHeight,
+                          kSourceHeight - static_cast<int>(arraysize(filter)));
+    y_filter.AddFilter(offset, filter, arraysize(filter));
+  }
+
+  int source_row_bytes = kSourceWidth * 4;
+  std::vector<unsigned char> source(source_row_bytes * kSourceHeight);
+  unsigned int seed = 1;
+  for (size_t i = 0; i < source.size(); ++i) {
+    seed = seed * 1103515245 + 12345;
+    source[i] = static_cast<unsigned char>(seed >> 16);
+  }
+
+  int dest_row_bytes = kDestWidth * 4;
+  std::vector<unsigned char> whole(dest_row_bytes * kDestHeight);
+  std::vector<unsigned char> bands(dest_row_bytes * kDestHeight);
+  int band_counts[] = { 1, 2, 3, 7, kDestHeight };
+  for (int sse2 = 0; sse2 < 2; ++sse2) {
+    BGRAConvolve2D(&source[0], source_row_bytes, true, x_filter, y_filter,
+                   dest_row_bytes, &whole[0], sse2 != 0);
+    for (size_t i = 0; i < arraysize(band_counts); ++i) {
+      int band_count = band_counts[i];
+      memset(&bands[0], 0, bands.size());
+      // Convolve the bands last to first, so that no band can depend on rows
+      // convolved for the band before it.
+      for (int band = band_count - 1; band >= 0; --band) {
+        BGRAConvolve2DRows(&source[0], source_row_bytes, true,
+                           x_filter, y_filter,
+                           kDestHeight * band / band_count,
+                           kDestHeight * (band + 1) / band_count,
+                           dest_row_bytes, &bands[0], sse2 != 0);
+      }
+      EXPECT_TRUE(whole == bands) << "sse2: " << sse2
+                                  << " bands: " << band_count;
+    }
+  }
+}
+
 }  // namespace skia
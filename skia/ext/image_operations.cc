@@ -6,14 +6,25 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <string>
+#include <vector>
 
 #include "skia/ext/image_operations.h"
 
 // TODO(pkasting): skia/ext should not depend on base/!
+#include "base/bind.h"
 #include "base/debug/trace_event.h"
+#include "base/lazy_instance.h"
+#include "base/location.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/sharded_mru_cache.h"
 #include "base/metrics/histogram.h"
 #include "base/stack_container.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/sys_info.h"
+#include "base/threading/worker_pool.h"
 #include "base/time.h"
 #include "build/build_config.h"
 #include "skia/ext/convolver.h"
@@ -90,6 +101,57 @@ float EvalHamming(int filter_size, float x) {
 
 // ResizeFilter ----------------------------------------------------------------
 
+// A filter for one direction of a resize, which the resizes between the same
+// sizes share once it is computed. It doesn't change after that, so any
+// thread can use it.
+class SharedFilter : public base::RefCountedThreadSafe<SharedFilter> {
+ public:
+  SharedFilter() {}
+
+  ConvolutionFilter1D& filter() { return filter_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<SharedFilter>;
+
+  ~SharedFilter() {}
+
+  ConvolutionFilter1D filter_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedFilter);
+};
+
+struct SharedFilterCost {
+  size_t operator()(const scoped_refptr<SharedFilter>& filter) const {
+    // Roughly the bytes the filter takes.
+    const ConvolutionFilter1D& f = filter->filter();
+    return sizeof(SharedFilter) + f.num_values() *
+        (3 * sizeof(int) + f.max_filter() * sizeof(ConvolutionFilter1D::Fixed));
+  }
+};
+
+// The most bytes the cached filters may take. Icons and favicons are resized
+// between a few small sizes over and over, and their filters take a few
+// kilobytes each.
+const size_t kMaxFilterCacheBytes = 512 * 1024;
+
+// Resizes run on several threads at once.
+const size_t kFilterCacheShardCount = 4;
+
+class FilterCache
+    : public base::ShardedMRUCache<std::string, scoped_refptr<SharedFilter>,
+                                   SharedFilterCost> {
+ public:
+  FilterCache()
+      : base::ShardedMRUCache<std::string, scoped_refptr<SharedFilter>,
+                              SharedFilterCost>(
+            kMaxFilterCacheBytes, kFilterCacheShardCount,
+            "ResizeFilterCache") {
+  }
+};
+
+base::LazyInstance<FilterCache>::Leaky g_filter_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
 // Encapsulates computation and storage of the filters required for one complete
 // resize operation.
 class ResizeFilter {
@@ -100,8 +162,8 @@ class ResizeFilter {
                const SkIRect& dest_subset);
 
   // Returns the filled filter values.
-  const ConvolutionFilter1D& x_filter() { return x_filter_; }
-  const ConvolutionFilter1D& y_filter() { return y_filter_; }
+  const ConvolutionFilter1D& x_filter() { return x_filter_->filter(); }
+  const ConvolutionFilter1D& y_filter() { return y_filter_->filter(); }
 
  private:
   // Returns the number of pixels that the filer spans, in filter space (the
@@ -129,6 +191,14 @@ class ResizeFilter {
     }
   }
 
+  // Returns the filter resizing |src_size| pixels to |dest_size| pixels in one
+  // direction, of which only the |dest_subset_size| pixels starting at
+  // |dest_subset_lo| are computed. Filters are computed once and then found
+  // in the cache, as long as they stay in it.
+  scoped_refptr<SharedFilter> GetFilter(int src_size, int dest_size,
+                                        int dest_subset_lo,
+                                        int dest_subset_size);
+
   // Computes one set of filters either horizontally or vertically. The caller
   // will specify the "min" and "max" rather than the bottom/top and
   // right/bottom so that the same code can be re-used in each dimension.
@@ -163,16 +233,11 @@ class ResizeFilter {
 
   ImageOperations::ResizeMethod method_;
 
-  // Size of the filter support on one side only in the destination space.
-  // See GetFilterSupport.
-  float x_filter_support_;
-  float y_filter_support_;
-
   // Subset of scaled destination bitmap to compute.
   SkIRect out_bounds_;
 
-  ConvolutionFilter1D x_filter_;
-  ConvolutionFilter1D y_filter_;
+  scoped_refptr<SharedFilter> x_filter_;
+  scoped_refptr<SharedFilter> y_filter_;
 
   DISALLOW_COPY_AND_ASSIGN(ResizeFilter);
 };
@@ -187,25 +252,40 @@ ResizeFilter::ResizeFilter(ImageOperations::ResizeMethod method,
   SkASSERT((ImageOperations::RESIZE_FIRST_ALGORITHM_METHOD <= method) &&
            (method <= ImageOperations::RESIZE_LAST_ALGORITHM_METHOD));
 
-  float scale_x = static_cast<float>(dest_width) /
-                  static_cast<float>(src_full_width);
-  float scale_y = static_cast<float>(dest_height) /
-                  static_cast<float>(src_full_height);
-
-  x_filter_support_ = GetFilterSupport(scale_x);
-  y_filter_support_ = GetFilterSupport(scale_y);
-
-  // Support of the filter in source space.
-  float src_x_support = x_filter_support_ / scale_x;
-  float src_y_support = y_filter_support_ / scale_y;
+  x_filter_ = GetFilter(src_full_width, dest_width,
+                        dest_subset.fLeft, dest_subset.width());
+  y_filter_ = GetFilter(src_full_height, dest_height,
+                        dest_subset.fTop, dest_subset.height());
+}
 
-  ComputeFilters(src_full_width, dest_subset.fLeft, dest_subset.width(),
-                 scale_x, src_x_support, &x_filter_);
-  ComputeFilters(src_full_height, dest_subset.fTop, dest_subset.height(),
-                 scale_y, src_y_support, &y_filter_);
+scoped_refptr<SharedFilter> ResizeFilter::GetFilter(int src_size,
+                                                    int dest_size,
+                                                    int dest_subset_lo,
+                                                    int dest_subset_size) {
+  const int key_values[] = {
+    method_, src_size, dest_size, dest_subset_lo, dest_subset_size
+  };
+  std::string key(reinterpret_cast<const char*>(key_values),
+                  sizeof(key_values));
+  scoped_refptr<SharedFilter> filter;
+  if (g_filter_cache.Get().Get(key, &filter))
+    return filter;
+
+  float scale = static_cast<float>(dest_size) / static_cast<float>(src_size);
+
+  // Support of the filter in source space. GetFilterSupport() gives it on one
+  // side only, in the destination space.
+  float src_support = GetFilterSupport(scale) / scale;
+
+  filter = new SharedFilter;
+  ComputeFilters(src_size, dest_subset_lo, dest_subset_size, scale,
+                 src_support, &filter->filter());
+  g_filter_cache.Get().Put(key, filter);
+  return filter;
 }
 
-// TODO(egouriou): Take advantage of periods in the convolution.
+// TODO(egouriou): Take advantage of periods in the convolution, beyond
+// computing the filters of integral downscales only once (see below).
 // Practical resizing filters are periodic outside of the border area.
 // For Lanczos, a scaling by a (reduced) factor of p/q (q pixels in the
 // source become p pixels in the destination) will have a period of p.
@@ -235,6 +315,17 @@ void ResizeFilter::ComputeFilters(int src_size,
   StackVector<float, 64> filter_values;
   StackVector<int16, 64> fixed_filter_values;
 
+  // When downscaling by a power of two, the scale, the source positions and
+  // the distances to them are exact, so the filters that aren't clipped by
+  // the edges of the source are all the same, each |inv_scale| pixels after
+  // the one before. Only the first of them is computed, and copied for the
+  // others. Any other scale rounds the source positions differently for each
+  // pixel.
+  int factor = static_cast<int>(inv_scale + 0.5f);
+  bool periodic = factor >= 2 && (factor & (factor - 1)) == 0 &&
+      scale * factor == 1.0f;
+  std::vector<int16> period_values;
+
   // Loop over all pixels in the output range. We will generate one set of
   // filter values for each one. Those values will tell us how to blend the
   // source pixels to compute the destination pixel.
@@ -258,8 +349,17 @@ void ResizeFilter::ComputeFilters(int src_size,
     float src_pixel = dest_subset_i * inv_scale;
 
     // Compute the (inclusive) range of source pixels the filter covers.
-    int src_begin = std::max(0, FloorInt(src_pixel - src_support));
-    int src_end = std::min(src_size - 1, CeilInt(src_pixel + src_support));
+    int unclipped_begin = FloorInt(src_pixel - src_support);
+    int unclipped_end = CeilInt(src_pixel + src_support);
+    bool in_period = periodic && unclipped_begin >= 0 &&
+        unclipped_end <= src_size - 1;
+    if (in_period && !period_values.empty()) {
+      output->AddFilter(unclipped_begin, &period_values[0],
+                        static_cast<int>(period_values.size()));
+      continue;
+    }
+    int src_begin = std::max(0, unclipped_begin);
+    int src_end = std::min(src_size - 1, unclipped_end);
 
     // Compute the unnormalized filter value at each location of the source
     // it covers.
@@ -309,11 +409,135 @@ void ResizeFilter::ComputeFilters(int src_size,
     // Now it's ready to go.
     output->AddFilter(src_begin, &fixed_filter_values[0],
                       static_cast<int>(fixed_filter_values->size()));
+    if (in_period) {
+      period_values.assign(fixed_filter_values->begin(),
+                           fixed_filter_values->end());
+    }
   }
 
   output->PaddingForSIMD(8);
 }
 
+// Threaded convolution -------------------------------------------------------
+
+// Resizes that read and write fewer pixels than this run on the calling
+// thread only, since posting the bands would cost more than it saves.
+const int64 kMinParallelResizePixels = 256 * 256;
+
+// The fewest output rows a band has. Each band convolves horizontally the
+// input rows its first output row needs again, so thin bands waste work.
+const int kMinBandRows = 16;
+
+// The most threads a resize runs on, or 0 for one per processor.
+int g_max_resize_threads = 0;
+
+// Returns the number of bands of output rows to split a resize into, each of
+// which runs on its own thread.
+int GetResizeBandCount(const SkBitmap& source, const SkIRect& dest_subset) {
+  int64 pixels =
+      static_cast<int64>(source.width()) * source.height() +
+      static_cast<int64>(dest_subset.width()) * dest_subset.height();
+  if (pixels < kMinParallelResizePixels)
+    return 1;
+  int thread_count = g_max_resize_threads > 0 ?
+      g_max_resize_threads : base::SysInfo::NumberOfProcessors();
+  return std::max(1, std::min(thread_count,
+                              dest_subset.height() / kMinBandRows));
+}
+
+// Runs BGRAConvolve2D() as bands of output rows on the worker pool and on the
+// calling thread. Each thread taking part convolves the bands no thread has
+// taken yet until there are none left. The bands write to different rows of
+// the output, so they don't need to lock anything.
+class ConvolveJob : public base::RefCountedThreadSafe<ConvolveJob> {
+ public:
+  ConvolveJob(const unsigned char* source_data,
+              int source_byte_row_stride,
+              bool source_has_alpha,
+              const ConvolutionFilter1D& filter_x,
+              const ConvolutionFilter1D& filter_y,
+              int output_byte_row_stride,
+              unsigned char* output,
+              bool use_sse2,
+              int band_count)
+      : source_data_(source_data),
+        source_byte_row_stride_(source_byte_row_stride),
+        source_has_alpha_(source_has_alpha),
+        filter_x_(filter_x),
+        filter_y_(filter_y),
+        output_byte_row_stride_(output_byte_row_stride),
+        output_(output),
+        use_sse2_(use_sse2),
+        band_count_(band_count),
+        next_band_(0),
+        done_count_(0),
+        all_done_(&lock_) {
+  }
+
+  // Convolves all the bands and returns once they are done. The worker tasks
+  // that start after that find nothing left to do, and don't touch the
+  // source, the filters or the output. If a task can't be posted, the
+  // calling thread runs its share.
+  void RunAndWait() {
+    for (int i = 1; i < band_count_; ++i) {
+      if (!base::WorkerPool::PostTask(
+              FROM_HERE, base::Bind(&ConvolveJob::RunBands, this), false))
+        break;
+    }
+    RunBands();
+
+    base::AutoLock lock(lock_);
+    while (done_count_ < band_count_)
+      all_done_.Wait();
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<ConvolveJob>;
+
+  ~ConvolveJob() {}
+
+  void RunBands() {
+    for (;;) {
+      int band;
+      {
+        base::AutoLock lock(lock_);
+        if (next_band_ == band_count_)
+          return;
+        band = next_band_++;
+      }
+
+      int row_count = filter_y_.num_values();
+      BGRAConvolve2DRows(source_data_, source_byte_row_stride_,
+                         source_has_alpha_, filter_x_, filter_y_,
+                         row_count * band / band_count_,
+                         row_count * (band + 1) / band_count_,
+                         output_byte_row_stride_, output_, use_sse2_);
+
+      base::AutoLock lock(lock_);
+      if (++done_count_ == band_count_)
+        all_done_.Broadcast();
+    }
+  }
+
+  const unsigned char* source_data_;
+  int source_byte_row_stride_;
+  bool source_has_alpha_;
+  const ConvolutionFilter1D& filter_x_;
+  const ConvolutionFilter1D& filter_y_;
+  int output_byte_row_stride_;
+  unsigned char* output_;
+  bool use_sse2_;
+  const int band_count_;
+
+  // Guards the members below.
+  base::Lock lock_;
+  int next_band_;
+  int done_count_;
+  base::ConditionVariable all_done_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConvolveJob);
+};
+
 ImageOperations::ResizeMethod ResizeMethodToAlgorithmMethod(
     ImageOperations::ResizeMethod method) {
   // Convert any "Quality Method" into an "Algorithm Method"
@@ -522,11 +746,24 @@ SkBitmap ImageOperations::ResizeBasic(const SkBitmap& source,
   if (!result.readyToDraw())
     return SkBitmap();
 
-  BGRAConvolve2D(source_subset, static_cast<int>(source.rowBytes()),
-                 !source.isOpaque(), filter.x_filter(), filter.y_filter(),
-                 static_cast<int>(result.rowBytes()),
-                 static_cast<unsigned char*>(result.getPixels()),
-                 cpu.has_sse2());
+  // Large resizes are split into bands of output rows that run on several
+  // threads.
+  int band_count = GetResizeBandCount(source, dest_subset);
+  if (band_count > 1) {
+    scoped_refptr<ConvolveJob> job(new ConvolveJob(
+        source_subset, static_cast<int>(source.rowBytes()),
+        !source.isOpaque(), filter.x_filter(), filter.y_filter(),
+        static_cast<int>(result.rowBytes()),
+        static_cast<unsigned char*>(result.getPixels()),
+        cpu.has_sse2(), band_count));
+    job->RunAndWait();
+  } else {
+    BGRAConvolve2D(source_subset, static_cast<int>(source.rowBytes()),
+                   !source.isOpaque(), filter.x_filter(), filter.y_filter(),
+                   static_cast<int>(result.rowBytes()),
+                   static_cast<unsigned char*>(result.getPixels()),
+                   cpu.has_sse2());
+  }
 
   // Preserve the "opaque" flag for use as an optimization later.
   result.setIsOpaque(source.isOpaque());
@@ -537,6 +774,12 @@ SkBitmap ImageOperations::ResizeBasic(const SkBitmap& source,
   return result;
 }
 
+// static
+void ImageOperations::SetMaxResizeThreads(int count) {
+  DCHECK_GE(count, 0);
+  g_max_resize_threads = count;
+}
+
 // static
 SkBitmap ImageOperations::Resize(const SkBitmap& source,
                                  ResizeMethod method,
@@ -110,6 +110,12 @@ class SK_API ImageOperations {
                          ResizeMethod method,
                          int dest_width, int dest_height);
 
+  // Sets the most threads a resize may run on, counting the calling thread.
+  // Large resizes are split into bands of output rows, one per thread. 0, the
+  // default, uses one thread per processor. Meant for benchmarks and tests;
+  // it must not be called while a resize runs.
+  static void SetMaxResizeThreads(int count);
+
  private:
   ImageOperations();  // Class for scoping only.
 
@@ -13,9 +13,12 @@
 // source surface + destination surface and dividing by the elapsed time.
 // This number is somewhat reasonable way to measure this, given our current
 // implementation which somewhat scales this way.
+// With -threads n, it repeats the measure for each number of threads from 1
+// to n a resize may run on, and prints the speedup over a single thread.
 
 #include <stdio.h>
 
+#include "base/at_exit.h"
 #include "base/basictypes.h"
 #include "base/command_line.h"
 #include "base/format_macros.h"
@@ -141,6 +144,7 @@ class Benchmark {
 
   Benchmark()
       : num_iterations_(kDefaultNumberIterations),
+        num_threads_(0),
         method_(kDefaultResizeMethod) {}
 
   // Returns true if command line parsing was successful, false otherwise.
@@ -151,7 +155,12 @@ class Benchmark {
 
   static void Usage();
  private:
+  // Resizes num_iterations_ times, prints the throughput, along with
+  // |num_threads| if not 0, and returns the elapsed time in microseconds.
+  int64 TimeResizes(int num_threads) const;
+
   int num_iterations_;
+  int num_threads_;
   skia::ImageOperations::ResizeMethod method_;
   Dimensions source_;
   Dimensions dest_;
@@ -165,7 +174,7 @@ const skia::ImageOperations::ResizeMethod Benchmark::kDefaultResizeMethod =
 // argument management
 void Benchmark::Usage() {
   printf("image_operations_bench -source wxh -destination wxh "
-         "[-iterations i] [-method m] [-help]\n"
+         "[-iterations i] [-method m] [-threads n] [-help]\n"
          "  -source wxh: specify source width and height\n"
          "  -destination wxh: specify destination width and height\n"
          "  -iter i: perform i iterations (default:%d)\n"
@@ -173,7 +182,8 @@ void Benchmark::Usage() {
          Benchmark::kDefaultNumberIterations,
          MethodToString(Benchmark::kDefaultResizeMethod));
   PrintMethods();
-  printf("\n  -help: prints this help and exits\n");
+  printf("\n  -threads n: time with 1 to n threads and print the speedups\n"
+         "  -help: prints this help and exits\n");
 }
 
 bool Benchmark::ParseArgs(const CommandLine* command_line) {
@@ -198,6 +208,11 @@ bool Benchmark::ParseArgs(const CommandLine* command_line) {
       if (base::StringToInt(value, &num_iterations_) == false) {
         fNeedHelp = true;
       }
+    } else if (s == "threads") {
+      if (!base::StringToInt(value, &num_threads_) || num_threads_ <= 0) {
+        printf("Invalid number of threads '%s' specified\n", value.c_str());
+        fNeedHelp = true;
+      }
     } else if (s == "method") {
       if (!StringToMethod(value, &method_)) {
         printf("Invalid method '%s' specified\n", value.c_str());
@@ -227,7 +242,7 @@ bool Benchmark::ParseArgs(const CommandLine* command_line) {
 }
 
 // actual benchmark.
-bool Benchmark::Run() const {
+int64 Benchmark::TimeResizes(int num_threads) const {
   SkBitmap source;
   source.setConfig(SkBitmap::kARGB_8888_Config,
                    source_.width(), source_.height());
@@ -249,10 +264,33 @@ bool Benchmark::Run() const {
   const uint64 num_bytes = static_cast<uint64>(num_iterations_) *
       (GetBitmapSize(&source) + GetBitmapSize(&dest));
 
-  printf("%"PRIu64" MB/s,\telapsed = %"PRIu64" source=%d dest=%d\n",
+  printf("%"PRIu64" MB/s,\telapsed = %"PRIu64" source=%d dest=%d",
          static_cast<uint64>(elapsed_us == 0 ? 0 : num_bytes / elapsed_us),
          static_cast<uint64>(elapsed_us),
          GetBitmapSize(&source), GetBitmapSize(&dest));
+  if (num_threads > 0)
+    printf(" threads=%d", num_threads);
+
+  return elapsed_us;
+}
+
+bool Benchmark::Run() const {
+  if (num_threads_ == 0) {
+    TimeResizes(0);
+    printf("\n");
+    return true;
+  }
+
+  int64 single_thread_us = 0;
+  for (int threads = 1; threads <= num_threads_; ++threads) {
+    skia::ImageOperations::SetMaxResizeThreads(threads);
+    int64 elapsed_us = TimeResizes(threads);
+    if (threads == 1)
+      single_thread_us = elapsed_us;
+    printf(" speedup=%.2f\n", elapsed_us == 0 ? 0.0 :
+           static_cast<double>(single_thread_us) / elapsed_us);
+  }
+  skia::ImageOperations::SetMaxResizeThreads(0);
 
   return true;
 }
@@ -276,6 +314,8 @@ class CommandLineAutoReset {
 }  // namespace
 
 int main(int argc, char** argv) {
+  // The worker pool the resizes run on needs an AtExitManager.
+  base::AtExitManager exit_manager;
   Benchmark bench;
   CommandLineAutoReset command_line(argc, argv);
 
@@ -471,6 +471,79 @@ TEST(ImageOperations, HalveSubset) {
   }
 }
 
+// Downscales by a power of two copy the filters of the pixels away from the
+// edges instead of computing each of them. A subset, which starts copying at
+// another pixel, and a resize done again with the cached filters should give
+// the same pixels as the whole image.
+TEST(ImageOperations, QuarterSubsetLanczos3) {
+  int src_w = 64, src_h = 48;
+  SkBitmap src;
+  FillDataToBitmap(src_w, src_h, &src);
+
+  SkBitmap full_results = skia::ImageOperations::Resize(
+      src, skia::ImageOperations::RESIZE_LANCZOS3, src_w / 4, src_h / 4);
+  ASSERT_EQ(src_w / 4, full_results.width());
+  ASSERT_EQ(src_h / 4, full_results.height());
+
+  SkIRect subset_rect = { 5, 4, 12, 9 };
+  SkBitmap subset_results = skia::ImageOperations::Resize(
+      src, skia::ImageOperations::RESIZE_LANCZOS3,
+      src_w / 4, src_h / 4, subset_rect);
+  ASSERT_EQ(subset_rect.width(), subset_results.width());
+  ASSERT_EQ(subset_rect.height(), subset_results.height());
+
+  SkBitmap cached_results = skia::ImageOperations::Resize(
+      src, skia::ImageOperations::RESIZE_LANCZOS3, src_w / 4, src_h / 4);
+
+  SkAutoLockPixels full_lock(full_results);
+  SkAutoLockPixels subset_lock(subset_results);
+  SkAutoLockPixels cached_lock(cached_results);
+  for (int y = 0; y < subset_rect.height(); y++) {
+    for (int x = 0; x < subset_rect.width(); x++) {
+      ASSERT_EQ(
+          *full_results.getAddr32(x + subset_rect.fLeft, y + subset_rect.fTop),
+          *subset_results.getAddr32(x, y));
+    }
+  }
+  ASSERT_EQ(full_results.getSize(), cached_results.getSize());
+  EXPECT_EQ(0, memcmp(full_results.getPixels(), cached_results.getPixels(),
+                      full_results.getSize()));
+}
+
+// Resizes large enough to be split into bands on several threads should give
+// the same result as on a single thread.
+TEST(ImageOperations, ThreadedResizeMatchesSingleThread) {
+  int src_w = 640, src_h = 480;
+  SkBitmap src;
+  FillDataToBitmap(src_w, src_h, &src);
+  SkIRect subset_rect = { 10, 20, 300, 220 };
+
+  skia::ImageOperations::SetMaxResizeThreads(1);
+  SkBitmap single = skia::ImageOperations::Resize(
+      src, skia::ImageOperations::RESIZE_LANCZOS3, 311, 233);
+  SkBitmap single_subset = skia::ImageOperations::Resize(
+      src, skia::ImageOperations::RESIZE_LANCZOS3, 400, 300, subset_rect);
+
+  skia::ImageOperations::SetMaxResizeThreads(4);
+  SkBitmap threaded = skia::ImageOperations::Resize(
+      src, skia::ImageOperations::RESIZE_LANCZOS3, 311, 233);
+  SkBitmap threaded_subset = skia::ImageOperations::Resize(
+      src, skia::ImageOperations::RESIZE_LANCZOS3, 400, 300, subset_rect);
+  skia::ImageOperations::SetMaxResizeThreads(0);
+
+  SkAutoLockPixels single_lock(single);
+  SkAutoLockPixels threaded_lock(threaded);
+  ASSERT_EQ(single.getSize(), threaded.getSize());
+  EXPECT_EQ(0, memcmp(single.getPixels(), threaded.getPixels(),
+                      single.getSize()));
+
+  SkAutoLockPixels single_subset_lock(single_subset);
+  SkAutoLockPixels threaded_subset_lock(threaded_subset);
+  ASSERT_EQ(single_subset.getSize(), threaded_subset.getSize());
+  EXPECT_EQ(0, memcmp(single_subset.getPixels(), threaded_subset.getPixels(),
+                      single_subset.getSize()));
+}
+
 // Resamples an image to the same image, it should give the same result.
 TEST(ImageOperations, ResampleToSameHamming1) {
   CheckResampleToSame(skia::ImageOperations::RESIZE_HAMMING1);
@@ -14,6 +14,7 @@
 #include <unistd.h>
 #endif
 
+#include "skia/ext/bitmap_platform_device.h"
 #include "skia/ext/platform_canvas.h"
 #include "skia/ext/platform_device.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -387,4 +388,39 @@ TEST(PlatformCanvas, TranslateLayer) {
 #endif
 }
 
+#if defined(OS_POSIX) && !defined(OS_MACOSX) && !defined(OS_ANDROID)
+
+// The pixel buffer of a destroyed canvas is reused by the next one of about
+// the same size, cleared unless the new canvas is opaque.
+TEST(PlatformCanvas, PooledPixelBuffers) {
+  BitmapPlatformDevice::PurgePool();
+  BitmapPlatformDevice::PoolStats before = BitmapPlatformDevice::GetPoolStats();
+  EXPECT_EQ(0u, before.pooled_bytes);
+
+  {
+    PlatformCanvas canvas(64, 32, false);
+    canvas.drawColor(SK_ColorRED);
+  }
+  BitmapPlatformDevice::PoolStats released =
+      BitmapPlatformDevice::GetPoolStats();
+  EXPECT_EQ(before.misses + 1, released.misses);
+  EXPECT_EQ(before.hits, released.hits);
+  EXPECT_LT(0u, released.pooled_bytes);
+
+  {
+    // A slightly narrower canvas falls in the same bucket.
+    PlatformCanvas canvas(63, 32, false);
+    BitmapPlatformDevice::PoolStats reused =
+        BitmapPlatformDevice::GetPoolStats();
+    EXPECT_EQ(released.hits + 1, reused.hits);
+    EXPECT_EQ(0u, reused.pooled_bytes);
+    EXPECT_TRUE(VerifyRect(canvas, 0, 0, 0, 0, 0, 0));
+  }
+
+  BitmapPlatformDevice::PurgePool();
+  EXPECT_EQ(0u, BitmapPlatformDevice::GetPoolStats().pooled_bytes);
+}
+
+#endif
+
 }  // namespace skia
@@ -246,6 +246,29 @@ SkPDFArray* makeIndexedColorSpace(SkColorTable* table) {
     return result;
 }
 
+// Returns whether the two streams, which may be NULL, hold the same bytes.
+bool sameData(SkStream* a, SkStream* b) {
+    if (!a || !b) {
+        return a == b;
+    }
+    return a->getLength() == b->getLength() &&
+           memcmp(a->getMemoryBase(), b->getMemoryBase(), a->getLength()) == 0;
+}
+
+// FNV-1a over the bytes of the stream, which may be NULL.
+uint32_t hashData(SkStream* stream, uint32_t hash) {
+    if (!stream) {
+        return hash;
+    }
+    const uint8_t* data =
+        static_cast<const uint8_t*>(stream->getMemoryBase());
+    size_t length = stream->getLength();
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619;
+    }
+    return hash;
+}
+
 };  // namespace
 
 // static
@@ -266,6 +289,21 @@ SkPDFImage* SkPDFImage::CreateImage(const SkBitmap& bitmap,
         return NULL;
     }
 
+    // Indexed images also depend on the color table, don't bother with them.
+    SkBitmap::Config config = bitmap.getConfig();
+    bool canonicalize = config != SkBitmap::kIndex8_Config &&
+                        config != SkBitmap::kRLE_Index8_Config;
+    uint32_t hash = 0;
+    if (canonicalize) {
+        hash = hashData(alphaData, hashData(imageData, 2166136261U));
+        SkAutoMutexAcquire lock(CanonicalImagesMutex());
+        int index = Find(hash, config, srcRect, imageData, alphaData);
+        if (index >= 0) {
+            CanonicalImages()[index]->ref();
+            return CanonicalImages()[index];
+        }
+    }
+
     SkPDFImage* image =
         new SkPDFImage(imageData, bitmap, srcRect, false, paint);
 
@@ -273,13 +311,70 @@ SkPDFImage* SkPDFImage::CreateImage(const SkBitmap& bitmap,
         image->addSMask(new SkPDFImage(alphaData, bitmap, srcRect, true,
                                        paint))->unref();
     }
+
+    if (canonicalize) {
+        // The image is looked up again in case another thread made the same
+        // one in the meantime.
+        SkAutoMutexAcquire lock(CanonicalImagesMutex());
+        int index = Find(hash, config, srcRect, imageData, alphaData);
+        if (index >= 0) {
+            image->unref();
+            CanonicalImages()[index]->ref();
+            return CanonicalImages()[index];
+        }
+        image->fImageData = imageData;
+        image->fAlphaData = alphaData;
+        image->fHash = hash;
+        image->fConfig = config;
+        image->fWidth = srcRect.width();
+        image->fHeight = srcRect.height();
+        CanonicalImages().push(image);
+    }
     return image;
 }
 
 SkPDFImage::~SkPDFImage() {
+    if (fImageData.get()) {
+        SkAutoMutexAcquire lock(CanonicalImagesMutex());
+        int index = CanonicalImages().find(this);
+        SkASSERT(index >= 0);
+        CanonicalImages().removeShuffle(index);
+    }
     fResources.unrefAll();
 }
 
+// static
+SkTDArray<SkPDFImage*>& SkPDFImage::CanonicalImages() {
+    // This initialization is only thread safe with gcc.
+    static SkTDArray<SkPDFImage*> gCanonicalImages;
+    return gCanonicalImages;
+}
+
+// static
+SkBaseMutex& SkPDFImage::CanonicalImagesMutex() {
+    // This initialization is only thread safe with gcc or when
+    // POD-style mutex initialization is used.
+    SK_DECLARE_STATIC_MUTEX(gCanonicalImagesMutex);
+    return gCanonicalImagesMutex;
+}
+
+// static
+int SkPDFImage::Find(uint32_t hash, SkBitmap::Config config,
+                     const SkIRect& srcRect, SkStream* imageData,
+                     SkStream* alphaData) {
+    for (int i = 0; i < CanonicalImages().count(); i++) {
+        SkPDFImage* image = CanonicalImages()[i];
+        if (image->fHash == hash && image->fConfig == config &&
+                image->fWidth == srcRect.width() &&
+                image->fHeight == srcRect.height() &&
+                sameData(image->fImageData.get(), imageData) &&
+                sameData(image->fAlphaData.get(), alphaData)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 SkPDFImage* SkPDFImage::addSMask(SkPDFImage* mask) {
     fResources.push(mask);
     mask->ref();
@@ -293,7 +388,11 @@ void SkPDFImage::getResources(SkTDArray<SkPDFObject*>* resourceList) {
 
 SkPDFImage::SkPDFImage(SkStream* imageData, const SkBitmap& bitmap,
                        const SkIRect& srcRect, bool doingAlpha,
-                       const SkPaint& paint) {
+                       const SkPaint& paint)
+        : fHash(0),
+          fConfig(SkBitmap::kNo_Config),
+          fWidth(0),
+          fHeight(0) {
     this->setData(imageData);
     SkBitmap::Config config = bitmap.getConfig();
     bool alphaOnly = (config == SkBitmap::kA1_Config ||
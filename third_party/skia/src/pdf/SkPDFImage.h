@@ -10,9 +10,11 @@
 #ifndef SkPDFImage_DEFINED
 #define SkPDFImage_DEFINED
 
+#include "SkBitmap.h"
 #include "SkPDFStream.h"
 #include "SkPDFTypes.h"
 #include "SkRefCnt.h"
+#include "SkThread.h"
 
 class SkBitmap;
 class SkPaint;
@@ -24,12 +26,14 @@ struct SkIRect;
     An image XObject.
 */
 
-// We could play the same trick here as is done in SkPDFGraphicState, storing
-// a copy of the Bitmap object (not the pixels), the pixel generation number,
-// and settings used from the paint to canonicalize image objects.
+// Image objects are canonicalized by content, as SkPDFGraphicState does with
+// paints: drawing pixels that are identical to those of an image that is
+// still alive returns that image, so that an image drawn on many pages, or
+// drawn many times, is only kept and emitted once.
 class SkPDFImage : public SkPDFStream {
 public:
-    /** Create a new Image XObject to represent the passed bitmap.
+    /** Create a new Image XObject to represent the passed bitmap, or return
+     *  an existing one with the same pixels.
      *  @param bitmap   The image to encode.
      *  @param srcRect  The rectangle to cut out of bitmap.
      *  @param paint    Used to calculate alpha, masks, etc.
@@ -54,6 +58,28 @@ public:
 private:
     SkTDArray<SkPDFObject*> fResources;
 
+    // The key of canonical images: the uncompressed image and alpha data
+    // (the latter may be NULL) and their hash, and the bitmap parameters
+    // that the image dictionary is made from. fImageData is NULL for images
+    // that aren't canonical.
+    SkRefPtr<SkStream> fImageData;
+    SkRefPtr<SkStream> fAlphaData;
+    uint32_t fHash;
+    SkBitmap::Config fConfig;
+    int fWidth;
+    int fHeight;
+
+    // This should be made a hash table if performance is a problem.
+    static SkTDArray<SkPDFImage*>& CanonicalImages();
+    static SkBaseMutex& CanonicalImagesMutex();
+
+    /** Returns the index in CanonicalImages() of the image with the passed
+     *  key, or -1.  CanonicalImagesMutex() must be held.
+     */
+    static int Find(uint32_t hash, SkBitmap::Config config,
+                    const SkIRect& srcRect, SkStream* imageData,
+                    SkStream* alphaData);
+
     /** Create a PDF image XObject. Entries for the image properties are
      *  automatically added to the stream dictionary.
      *  @param imageData  The final raw bits representing the image.
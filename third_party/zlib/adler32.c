@@ -7,6 +7,11 @@
 
 #include "zutil.h"
 
+#if defined(ADLER32_SIMD_SSSE3)
+#  include "adler32_simd.h"
+#  include "x86.h"
+#endif
+
 #define local static
 
 local uLong adler32_combine_(uLong adler1, uLong adler2, z_off64_t len2);
@@ -65,6 +70,11 @@ uLong ZEXPORT adler32(adler, buf, len)
     unsigned long sum2;
     unsigned n;
 
+#if defined(ADLER32_SIMD_SSSE3)
+    if (buf != Z_NULL && len >= Z_ADLER32_SIMD_MIN_LEN && x86_cpu_simd())
+        return adler32_simd_(adler, buf, len);
+#endif
+
     /* split Adler-32 into component sums */
     sum2 = (adler >> 16) & 0xffff;
     adler &= 0xffff;
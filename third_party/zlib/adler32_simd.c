@@ -0,0 +1,98 @@
+/* adler32_simd.c -- SSSE3 version of adler32()
+ * Copyright 2012 The Chromium Authors. All rights reserved.
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * Per block of 32 bytes b[0..31], s1 grows by the sum of the bytes and s2 by
+ * 32 * s1 plus the bytes weighted 32 down to 1.  The byte sums come from
+ * psadbw, the weighted sums from pmaddubsw, and the 32 * s1 terms are
+ * accumulated and added once per run of NMAX bytes, so that only one modulo
+ * is needed per run, as in adler32().
+ */
+
+#include "adler32_simd.h"
+
+#include <tmmintrin.h>
+
+#define BASE 65521U     /* largest prime smaller than 65536 */
+#define NMAX 5552
+/* NMAX is the largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1 */
+
+#define BLOCK_SIZE 32
+
+uLong ZLIB_INTERNAL adler32_simd_(adler, buf, len)
+    uLong adler;
+    const unsigned char FAR *buf;
+    unsigned len;
+{
+    unsigned s1 = (unsigned)(adler & 0xffff);
+    unsigned s2 = (unsigned)((adler >> 16) & 0xffff);
+    unsigned blocks = len / BLOCK_SIZE;
+
+    const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                                       24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9,
+                                       8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+
+    len -= blocks * BLOCK_SIZE;
+
+    while (blocks) {
+        unsigned n = NMAX / BLOCK_SIZE;
+        __m128i v_ps;
+        __m128i v_s1;
+        __m128i v_s2;
+
+        if (n > blocks)
+            n = blocks;
+        blocks -= n;
+
+        /* v_ps accumulates s1 once per block; it starts with the s1 carried
+           in, which every block of the run adds to s2. */
+        v_ps = _mm_setr_epi32((int)(s1 * n), 0, 0, 0);
+        v_s2 = _mm_setr_epi32((int)s2, 0, 0, 0);
+        v_s1 = _mm_setzero_si128();
+
+        do {
+            const __m128i bytes1 = _mm_loadu_si128((const __m128i *)buf);
+            const __m128i bytes2 =
+                _mm_loadu_si128((const __m128i *)(buf + 16));
+
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+            v_s2 = _mm_add_epi32(
+                v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+            v_s2 = _mm_add_epi32(
+                v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+
+            buf += BLOCK_SIZE;
+        } while (--n);
+
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+        /* Sum the lanes.  psadbw leaves its sums in lanes 0 and 2. */
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, 0x4e));
+        s1 += (unsigned)_mm_cvtsi128_si32(v_s1);
+
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, 0xb1));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, 0x4e));
+        s2 = (unsigned)_mm_cvtsi128_si32(v_s2);
+
+        s1 %= BASE;
+        s2 %= BASE;
+    }
+
+    /* The remaining bytes, fewer than one block. */
+    while (len--) {
+        s1 += *buf++;
+        s2 += s1;
+    }
+    if (s1 >= BASE)
+        s1 -= BASE;
+    s2 %= BASE;
+
+    return s1 | ((uLong)s2 << 16);
+}
@@ -0,0 +1,26 @@
+/* adler32_simd.h -- SSSE3 version of adler32()
+ * Copyright 2012 The Chromium Authors. All rights reserved.
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+#ifndef ADLER32_SIMD_H
+#define ADLER32_SIMD_H
+
+#include "zutil.h"
+
+/* adler32() hands buffers of at least this many bytes to adler32_simd_(). */
+#define Z_ADLER32_SIMD_MIN_LEN 64
+
+/* Returns the Adler-32 checksum of |len| bytes of |buf| continuing from
+   |adler|, like adler32().  Only call it when x86_cpu_simd() is non-zero.
+ */
+uLong ZLIB_INTERNAL adler32_simd_ OF((uLong adler,
+                                      const unsigned char FAR *buf,
+                                      unsigned len));
+
+#endif /* ADLER32_SIMD_H */
@@ -28,6 +28,11 @@
 
 #include "zutil.h"      /* for STDC and FAR definitions */
 
+#if defined(CRC32_SIMD_SSE42_PCLMUL)
+#  include "crc32_simd.h"
+#  include "x86.h"
+#endif
+
 #define local static
 
 /* Find a four-byte integer type for crc32_little() and crc32_big(). */
@@ -230,6 +235,19 @@ unsigned long ZEXPORT crc32(crc, buf, len)
         make_crc_table();
 #endif /* DYNAMIC_CRC_TABLE */
 
+#if defined(CRC32_SIMD_SSE42_PCLMUL)
+    /* Fold the bulk of long buffers with PCLMULQDQ, and finish the tail of
+       fewer than Z_CRC32_SIMD_GRANULARITY bytes with the tables below. */
+    if (len >= Z_CRC32_SIMD_MIN_LEN && x86_cpu_simd()) {
+        unsigned chunk = len & ~(Z_CRC32_SIMD_GRANULARITY - 1);
+        crc = ~crc32_simd_(~(unsigned)crc, buf, chunk) & 0xffffffffUL;
+        buf += chunk;
+        len -= chunk;
+        if (len == 0)
+            return crc;
+    }
+#endif
+
 #ifdef BYFOUR
     if (sizeof(void *) == sizeof(ptrdiff_t)) {
         u4 endian;
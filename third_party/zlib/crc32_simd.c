@@ -0,0 +1,137 @@
+/* crc32_simd.c -- SSE4.2 and PCLMULQDQ version of crc32()
+ * Copyright 2012 The Chromium Authors. All rights reserved.
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * Folds 64 bytes at a time with carry-less multiplies, following "Fast CRC
+ * Computation for Generic Polynomials Using PCLMULQDQ Instruction" (Gopal et
+ * al., Intel, 2009), then Barrett-reduces the remainder to 32 bits.  The
+ * constants are those of the paper for the bit-reflected CRC-32 polynomial.
+ */
+
+#include "crc32_simd.h"
+
+#include <emmintrin.h>
+#include <smmintrin.h>
+#include <wmmintrin.h>
+
+#if defined(_MSC_VER)
+#  define zalign(x) __declspec(align(x))
+#else
+#  define zalign(x) __attribute__((aligned((x))))
+#endif
+
+unsigned ZLIB_INTERNAL crc32_simd_(crc, buf, len)
+    unsigned crc;
+    const unsigned char FAR *buf;
+    unsigned len;
+{
+    static const zalign(16) unsigned long long k1k2[] =
+        { 0x0154442bd4ULL, 0x01c6e41596ULL };
+    static const zalign(16) unsigned long long k3k4[] =
+        { 0x01751997d0ULL, 0x00ccaa009eULL };
+    static const zalign(16) unsigned long long k5k0[] =
+        { 0x0163cd6124ULL, 0x0000000000ULL };
+    static const zalign(16) unsigned long long poly[] =
+        { 0x01db710641ULL, 0x01f7011641ULL };
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    /* There is at least one block of 64 bytes. */
+    x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+
+    x0 = _mm_load_si128((const __m128i *)k1k2);
+
+    buf += 64;
+    len -= 64;
+
+    /* Fold four blocks of 16 bytes in parallel. */
+    while (len >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        y5 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+        y6 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+        y7 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+        y8 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+
+        x1 = _mm_xor_si128(x1, x5);
+        x2 = _mm_xor_si128(x2, x6);
+        x3 = _mm_xor_si128(x3, x7);
+        x4 = _mm_xor_si128(x4, x8);
+
+        x1 = _mm_xor_si128(x1, y5);
+        x2 = _mm_xor_si128(x2, y6);
+        x3 = _mm_xor_si128(x3, y7);
+        x4 = _mm_xor_si128(x4, y8);
+
+        buf += 64;
+        len -= 64;
+    }
+
+    /* Fold the four accumulators into one. */
+    x0 = _mm_load_si128((const __m128i *)k3k4);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(x1, x2);
+    x1 = _mm_xor_si128(x1, x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(x1, x3);
+    x1 = _mm_xor_si128(x1, x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(x1, x4);
+    x1 = _mm_xor_si128(x1, x5);
+
+    /* Fold the remaining blocks of 16 bytes one at a time. */
+    while (len >= 16) {
+        x2 = _mm_loadu_si128((const __m128i *)buf);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(x1, x2);
+        x1 = _mm_xor_si128(x1, x5);
+
+        buf += 16;
+        len -= 16;
+    }
+
+    /* Fold 128 bits down to 64. */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett-reduce to 32 bits. */
+    x0 = _mm_load_si128((const __m128i *)poly);
+
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (unsigned)_mm_extract_epi32(x1, 1);
+}
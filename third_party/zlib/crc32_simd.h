@@ -0,0 +1,30 @@
+/* crc32_simd.h -- SSE4.2 and PCLMULQDQ version of crc32()
+ * Copyright 2012 The Chromium Authors. All rights reserved.
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+#ifndef CRC32_SIMD_H
+#define CRC32_SIMD_H
+
+#include "zutil.h"
+
+/* crc32_simd_() takes at least Z_CRC32_SIMD_MIN_LEN bytes, in a multiple of
+   Z_CRC32_SIMD_GRANULARITY.
+ */
+#define Z_CRC32_SIMD_MIN_LEN 64
+#define Z_CRC32_SIMD_GRANULARITY 16
+
+/* Returns the CRC-32 register after folding |len| bytes of |buf| into
+   |crc|.  Unlike crc32(), neither |crc| nor the result is inverted.  Only
+   call it when x86_cpu_simd() is non-zero.
+ */
+unsigned ZLIB_INTERNAL crc32_simd_ OF((unsigned crc,
+                                       const unsigned char FAR *buf,
+                                       unsigned len));
+
+#endif /* CRC32_SIMD_H */
@@ -97,6 +97,52 @@ local  void check_match OF((deflate_state *s, IPos start, IPos match,
                             int length));
 #endif
 
+/* On little-endian x86, longest_match() compares a machine word at a time
+ * and finds the first differing byte from the lowest set bit of the xor of
+ * the words.
+ */
+#if !defined(UNALIGNED_OK) && !defined(ASMV)
+#  if defined(__GNUC__) && defined(__x86_64__)
+#    define MATCH_WORDS
+     typedef unsigned long long match_word;
+#    define match_word_first_diff(w) ((unsigned)__builtin_ctzll(w) >> 3)
+#  elif defined(__GNUC__) && defined(__i386__)
+#    define MATCH_WORDS
+     typedef unsigned int match_word;
+#    define match_word_first_diff(w) ((unsigned)__builtin_ctz(w) >> 3)
+#  elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#    include <intrin.h>
+#    define MATCH_WORDS
+#    if defined(_M_X64)
+       typedef unsigned __int64 match_word;
+#      pragma intrinsic(_BitScanForward64)
+#    else
+       typedef unsigned long match_word;
+#      pragma intrinsic(_BitScanForward)
+#    endif
+     local unsigned match_word_first_diff(match_word w)
+     {
+         unsigned long index;
+#    if defined(_M_X64)
+         _BitScanForward64(&index, w);
+#    else
+         _BitScanForward(&index, w);
+#    endif
+         return (unsigned)index >> 3;
+     }
+#  endif
+#endif
+
+#ifdef MATCH_WORDS
+/* Reads a possibly unaligned word. */
+local match_word load_match_word(const Bytef *p)
+{
+    match_word w;
+    zmemcpy((Bytef *)&w, p, sizeof(w));
+    return w;
+}
+#endif
+
 /* ===========================================================================
  * Local data
  */
@@ -1168,6 +1214,19 @@ local uInt longest_match(s, cur_match)
         scan += 2, match++;
         Assert(*scan == *match, "match[2]?");
 
+#ifdef MATCH_WORDS
+        /* Compare a word at a time from strstart+2.  MAX_MATCH-2 is a
+         * multiple of the word size, so the last word ends at strend.
+         */
+        do {
+            match_word diff = load_match_word(scan) ^ load_match_word(match);
+            if (diff) {
+                scan += match_word_first_diff(diff);
+                break;
+            }
+            scan += sizeof(match_word), match += sizeof(match_word);
+        } while (scan < strend);
+#else
         /* We check for insufficient lookahead only every 8th comparison;
          * the 256th check will be made at strstart+258.
          */
@@ -1177,6 +1236,7 @@ local uInt longest_match(s, cur_match)
                  *++scan == *++match && *++scan == *++match &&
                  *++scan == *++match && *++scan == *++match &&
                  scan < strend);
+#endif
 
         Assert(scan <= s->window+(unsigned)(s->window_size-1), "wild scan");
 
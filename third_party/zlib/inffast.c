@@ -29,6 +29,34 @@
 #  define PUP(a) *++(a)
 #endif
 
+/*
+   Copies len bytes of a match from from to out, a whole run at a time rather
+   than a byte at a time.  from and out overlap only when the match distance
+   dist is less than len; then from == out - dist, and the bytes repeat with a
+   period of dist, so each copy can take twice as many bytes as the one before.
+   Short matches, the most common, are copied by bytes to skip the zmemcpy()
+   calls.
+ */
+local void copy_match(out, from, len, dist)
+unsigned char FAR *out;
+const unsigned char FAR *from;
+unsigned len;
+unsigned dist;
+{
+    if (len < 8) {
+        while (len--)
+            *out++ = *from++;
+        return;
+    }
+    while (dist < len) {
+        zmemcpy(out, from, dist);
+        out += dist;
+        len -= dist;
+        dist += dist;
+    }
+    zmemcpy(out, from, len);
+}
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -218,9 +246,8 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
                         from += wsize - op;
                         if (op < len) {         /* some from window */
                             len -= op;
-                            do {
-                                PUP(out) = PUP(from);
-                            } while (--op);
+                            zmemcpy(out + OFF, from + OFF, op);
+                            out += op;
                             from = out - dist;  /* rest from output */
                         }
                     }
@@ -229,16 +256,14 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
                         op -= wnext;
                         if (op < len) {         /* some from end of window */
                             len -= op;
-                            do {
-                                PUP(out) = PUP(from);
-                            } while (--op);
+                            zmemcpy(out + OFF, from + OFF, op);
+                            out += op;
                             from = window - OFF;
                             if (wnext < len) {  /* some from start of window */
                                 op = wnext;
                                 len -= op;
-                                do {
-                                    PUP(out) = PUP(from);
-                                } while (--op);
+                                zmemcpy(out + OFF, from + OFF, op);
+                                out += op;
                                 from = out - dist;      /* rest from output */
                             }
                         }
@@ -247,37 +272,18 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
                         from += wnext - op;
                         if (op < len) {         /* some from window */
                             len -= op;
-                            do {
-                                PUP(out) = PUP(from);
-                            } while (--op);
+                            zmemcpy(out + OFF, from + OFF, op);
+                            out += op;
                             from = out - dist;  /* rest from output */
                         }
                     }
-                    while (len > 2) {
-                        PUP(out) = PUP(from);
-                        PUP(out) = PUP(from);
-                        PUP(out) = PUP(from);
-                        len -= 3;
-                    }
-                    if (len) {
-                        PUP(out) = PUP(from);
-                        if (len > 1)
-                            PUP(out) = PUP(from);
-                    }
+                    copy_match(out + OFF, from + OFF, len, dist);
+                    out += len;
                 }
                 else {
                     from = out - dist;          /* copy direct from output */
-                    do {                        /* minimum length is three */
-                        PUP(out) = PUP(from);
-                        PUP(out) = PUP(from);
-                        PUP(out) = PUP(from);
-                        len -= 3;
-                    } while (len > 2);
-                    if (len) {
-                        PUP(out) = PUP(from);
-                        if (len > 1)
-                            PUP(out) = PUP(from);
-                    }
+                    copy_match(out + OFF, from + OFF, len, dist);
+                    out += len;
                 }
             }
             else if ((op & 64) == 0) {          /* 2nd level distance code */
@@ -0,0 +1,136 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Checks the SIMD versions of crc32() and adler32() against the portable
+// code they replace, by running each buffer through both.
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+extern "C" {
+#include "third_party/zlib/zutil.h"
+#include "third_party/zlib/x86.h"
+}
+
+namespace {
+
+// Long enough to cover the SIMD minimums, several 16 and 32 byte blocks past
+// them and every tail length.
+const size_t kMaxShortLength = 300;
+
+// The buffer start is moved through every offset within a 16 byte vector.
+const size_t kMaxMisalignment = 16;
+
+// Lengths around adler32()'s NMAX (5552) modulo runs and a long buffer.
+const size_t kLongLengths[] = {
+  5551, 5552, 5553, 3 * 5552 + 17, 65536 + 15, 1 << 20,
+};
+
+// Forces crc32() and adler32() onto the portable code for its lifetime.
+class ScopedPortableChecksums {
+ public:
+  ScopedPortableChecksums() : saved_enable_simd_(x86_cpu_enable_simd) {
+    x86_cpu_checked = 1;
+    x86_cpu_enable_simd = 0;
+  }
+  ~ScopedPortableChecksums() {
+    x86_cpu_enable_simd = saved_enable_simd_;
+  }
+
+ private:
+  int saved_enable_simd_;
+};
+
+bool CpuHasSimd() {
+  x86_check_features();
+  return x86_cpu_enable_simd != 0;
+}
+
+// Fills |data| with bytes from a fixed linear congruential sequence, so that
+// failures are reproducible.
+void FillPseudoRandom(std::vector<unsigned char>* data) {
+  unsigned int state = 12345;
+  for (size_t i = 0; i < data->size(); ++i) {
+    state = state * 1103515245 + 12345;
+    (*data)[i] = static_cast<unsigned char>(state >> 16);
+  }
+}
+
+uLong PortableCrc32(uLong crc, const Bytef* buf, uInt len) {
+  ScopedPortableChecksums portable;
+  return crc32(crc, buf, len);
+}
+
+uLong PortableAdler32(uLong adler, const Bytef* buf, uInt len) {
+  ScopedPortableChecksums portable;
+  return adler32(adler, buf, len);
+}
+
+// Checks |buf| both from the initial value and continuing from a checksum
+// that is not the initial one, as happens when a stream is checksummed in
+// pieces.
+void ExpectMatchesPortable(const Bytef* buf, uInt len) {
+  const Bytef kPrefix[] = "zlib";
+  const uLong crc_start = crc32(0L, Z_NULL, 0);
+  const uLong crc_mid = PortableCrc32(crc_start, kPrefix, sizeof(kPrefix));
+  EXPECT_EQ(PortableCrc32(crc_start, buf, len), crc32(crc_start, buf, len))
+      << "crc32 of " << len << " bytes";
+  EXPECT_EQ(PortableCrc32(crc_mid, buf, len), crc32(crc_mid, buf, len))
+      << "continued crc32 of " << len << " bytes";
+
+  const uLong adler_start = adler32(0L, Z_NULL, 0);
+  const uLong adler_mid =
+      PortableAdler32(adler_start, kPrefix, sizeof(kPrefix));
+  EXPECT_EQ(PortableAdler32(adler_start, buf, len),
+            adler32(adler_start, buf, len))
+      << "adler32 of " << len << " bytes";
+  EXPECT_EQ(PortableAdler32(adler_mid, buf, len),
+            adler32(adler_mid, buf, len))
+      << "continued adler32 of " << len << " bytes";
+}
+
+}  // namespace
+
+TEST(ZlibSimdTest, ShortBuffers) {
+  if (!CpuHasSimd())
+    return;
+
+  std::vector<unsigned char> data(kMaxShortLength + kMaxMisalignment);
+  FillPseudoRandom(&data);
+  for (size_t offset = 0; offset < kMaxMisalignment; ++offset) {
+    for (size_t len = 0; len <= kMaxShortLength; ++len) {
+      SCOPED_TRACE(testing::Message() << "offset " << offset);
+      ExpectMatchesPortable(&data[offset], static_cast<uInt>(len));
+    }
+  }
+}
+
+TEST(ZlibSimdTest, LongBuffers) {
+  if (!CpuHasSimd())
+    return;
+
+  const size_t kMaxLength = 1 << 20;
+  std::vector<unsigned char> data(kMaxLength + kMaxMisalignment);
+  FillPseudoRandom(&data);
+  for (size_t i = 0; i < arraysize(kLongLengths); ++i) {
+    for (size_t offset = 0; offset < kMaxMisalignment; offset += 5) {
+      SCOPED_TRACE(testing::Message() << "offset " << offset);
+      ExpectMatchesPortable(&data[offset], static_cast<uInt>(kLongLengths[i]));
+    }
+  }
+}
+
+// All 0xff bytes make adler32()'s sums grow fastest, so a missed modulo
+// shows up as overflow.
+TEST(ZlibSimdTest, AllOnes) {
+  if (!CpuHasSimd())
+    return;
+
+  std::vector<unsigned char> data(3 * 5552 + 31, 0xff);
+  for (size_t len = 0; len <= data.size(); len += 97)
+    ExpectMatchesPortable(&data[0], static_cast<uInt>(len));
+  ExpectMatchesPortable(&data[0], static_cast<uInt>(data.size()));
+}
@@ -0,0 +1,46 @@
+/* x86.c -- runtime detection of the x86 SIMD instruction sets used by zlib
+ * Copyright 2012 The Chromium Authors. All rights reserved.
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "zutil.h"
+#include "x86.h"
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#else
+#  include <cpuid.h>
+#endif
+
+int ZLIB_INTERNAL x86_cpu_enable_simd = 0;
+int ZLIB_INTERNAL x86_cpu_checked = 0;
+
+void ZLIB_INTERNAL x86_check_features()
+{
+    unsigned ecx;
+    unsigned edx;
+    int has_sse2;
+    int has_ssse3;
+    int has_sse42;
+    int has_pclmulqdq;
+
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 1);
+    ecx = (unsigned)regs[2];
+    edx = (unsigned)regs[3];
+#else
+    unsigned eax;
+    unsigned ebx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        ecx = edx = 0;
+#endif
+
+    has_sse2 = edx & (1 << 26);
+    has_ssse3 = ecx & (1 << 9);
+    has_sse42 = ecx & (1 << 20);
+    has_pclmulqdq = ecx & (1 << 1);
+
+    x86_cpu_enable_simd = has_sse2 && has_ssse3 && has_sse42 && has_pclmulqdq;
+    x86_cpu_checked = 1;
+}
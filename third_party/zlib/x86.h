@@ -0,0 +1,33 @@
+/* x86.h -- runtime detection of the x86 SIMD instruction sets used by zlib
+ * Copyright 2012 The Chromium Authors. All rights reserved.
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+#ifndef X86_H
+#define X86_H
+
+#include "zlib.h"
+
+/* Non-zero when the CPU has SSE2, SSSE3, SSE4.2 and PCLMULQDQ, which the
+   SIMD versions of crc32() and adler32() need.  Valid only after
+   x86_check_features() has run, which x86_cpu_simd() takes care of.
+ */
+extern int ZLIB_INTERNAL x86_cpu_enable_simd;
+extern int ZLIB_INTERNAL x86_cpu_checked;
+
+void ZLIB_INTERNAL x86_check_features OF((void));
+
+/* Threads may race to run x86_check_features() the first time; they all
+   store the same values, so the race is benign and saves taking a lock on
+   every checksum.
+ */
+#define x86_cpu_simd() \
+    (x86_cpu_checked ? x86_cpu_enable_simd : (x86_check_features(), \
+                                              x86_cpu_enable_simd))
+
+#endif /* X86_H */
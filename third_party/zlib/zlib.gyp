@@ -71,6 +71,21 @@
                 'contrib/minizip/iowin32.c'
               ],
             }],
+            ['target_arch=="ia32" or target_arch=="x64"', {
+              # crc32() and adler32() dispatch at runtime to the SIMD code in
+              # zlib_x86_simd when the CPU supports it.
+              'sources': [
+                'x86.c',
+                'x86.h',
+              ],
+              'defines': [
+                'ADLER32_SIMD_SSSE3',
+                'CRC32_SIMD_SSE42_PCLMUL',
+              ],
+              'dependencies': [
+                'zlib_x86_simd',
+              ],
+            }],
           ],
         }, {
           'direct_dependent_settings': {
@@ -122,4 +137,64 @@
       ],
     }
   ],
+  'conditions': [
+    ['target_arch=="ia32" or target_arch=="x64"', {
+      'targets': [
+        # The SIMD code is built in its own target, as gyp has no per-file
+        # cflags and the rest of zlib, including the CPUID check in x86.c,
+        # must not be compiled with these instruction sets enabled.
+        {
+          'target_name': 'zlib_x86_simd',
+          'type': 'static_library',
+          'sources': [
+            'adler32_simd.c',
+            'adler32_simd.h',
+            'crc32_simd.c',
+            'crc32_simd.h',
+          ],
+          'include_dirs': [
+            '.',
+          ],
+          'conditions': [
+            ['os_posix==1 and OS!="mac"', {
+              'cflags': [
+                '-mssse3',
+                '-msse4.2',
+                '-mpclmul',
+              ],
+            }],
+            ['OS=="mac"', {
+              'xcode_settings': {
+                'OTHER_CFLAGS': [
+                  '-mssse3',
+                  '-msse4.2',
+                  '-mpclmul',
+                ],
+              },
+            }],
+          ],
+        },
+      ],
+    }],
+    ['use_system_zlib==0 and (target_arch=="ia32" or target_arch=="x64")', {
+      'targets': [
+        {
+          # Checks the SIMD crc32() and adler32() against the portable code.
+          'target_name': 'zlib_unittests',
+          'type': 'executable',
+          'dependencies': [
+            'zlib',
+            '../../base/base.gyp:run_all_unittests',
+            '../../testing/gtest.gyp:gtest',
+          ],
+          'include_dirs': [
+            '../..',
+          ],
+          'sources': [
+            'simd_unittest.cc',
+          ],
+        },
+      ],
+    }],
+  ],
 }
@@ -0,0 +1,82 @@
+#!/usr/bin/env python
+# Copyright (c) 2012 The Chromium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Compares two runs of benchmarks written by base/test/benchmark.h.
+
+Usage: compare_benchmarks.py [--regression-threshold=PERCENT] BEFORE AFTER
+
+BEFORE and AFTER are the files that perftests wrote with
+--benchmark-json=<file>.  For each benchmark in both, prints the median time
+per iteration of both runs and the change of the mean.  A change is only
+called faster or slower when the difference of the means is larger than
+their 95% confidence intervals combined; otherwise it is noise.
+
+With --regression-threshold, exits with 1 if any benchmark got slower by
+more than PERCENT percent.
+"""
+
+import json
+import math
+import optparse
+import sys
+
+
+def LoadResults(path):
+  """Returns the results in the file at |path|, keyed by benchmark name."""
+  with open(path) as results_file:
+    return dict((result['name'], result) for result in json.load(results_file))
+
+
+def Compare(before, after):
+  """Returns (change in percent of the mean, verdict) for two results."""
+  difference = after['mean_ns'] - before['mean_ns']
+  noise = math.sqrt(before['ci95_ns'] ** 2 + after['ci95_ns'] ** 2)
+  change = 100.0 * difference / before['mean_ns'] if before['mean_ns'] else 0
+  if abs(difference) <= noise:
+    return change, 'noise'
+  return change, 'slower' if difference > 0 else 'faster'
+
+
+def main(argv):
+  parser = optparse.OptionParser(usage='%prog [options] BEFORE AFTER')
+  parser.add_option('--regression-threshold', type='float', default=None,
+                    help='exit with 1 if a benchmark got slower by more '
+                         'than this many percent')
+  options, args = parser.parse_args(argv)
+  if len(args) != 2:
+    parser.error('expected the BEFORE and AFTER files')
+
+  before_results = LoadResults(args[0])
+  after_results = LoadResults(args[1])
+
+  regressed = False
+  width = max([len(name) for name in before_results] +
+              [len(name) for name in after_results] + [len('benchmark')])
+  sys.stdout.write('%-*s %14s %14s %9s\n' %
+                   (width, 'benchmark', 'before (ns)', 'after (ns)', 'change'))
+  for name in sorted(before_results):
+    if name not in after_results:
+      sys.stdout.write('%-*s only in BEFORE\n' % (width, name))
+      continue
+    before = before_results[name]
+    after = after_results[name]
+    change, verdict = Compare(before, after)
+    notes = [verdict]
+    if not before.get('converged', True) or not after.get('converged', True):
+      notes.append('not converged')
+    sys.stdout.write('%-*s %14.1f %14.1f %+8.1f%% %s\n' %
+                     (width, name, before['median_ns'], after['median_ns'],
+                      change, ', '.join(notes)))
+    if (options.regression_threshold is not None and verdict == 'slower' and
+        change > options.regression_threshold):
+      regressed = True
+  for name in sorted(set(after_results) - set(before_results)):
+    sys.stdout.write('%-*s only in AFTER\n' % (width, name))
+
+  return 1 if regressed else 0
+
+
+if __name__ == '__main__':
+  sys.exit(main(sys.argv[1:]))
@@ -12,6 +12,7 @@
       'type': '<(component)',
       'dependencies': [
         '../../base/base.gyp:base',
+        '../../base/base.gyp:base_i18n',
         '../../base/third_party/dynamic_annotations/dynamic_annotations.gyp:dynamic_annotations',
         '../../skia/skia.gyp:skia',
         '../compositor/compositor.gyp:compositor',
@@ -54,6 +55,8 @@
         'search_box_view.cc',
         'search_box_view.h',
         'search_box_view_delegate.h',
+        'search_index.cc',
+        'search_index.h',
         'search_result.cc',
         'search_result.h',
         'search_result_view.cc',
@@ -78,7 +81,9 @@
       ],
       'sources': [
         'apps_grid_view_unittest.cc',
+        'icon_cache_unittest.cc',
         'pagination_model_unittest.cc',
+        'search_index_unittest.cc',
         'test/app_list_test_suite.cc',
         'test/app_list_test_suite.h',
         'test/run_all_unittests.cc',
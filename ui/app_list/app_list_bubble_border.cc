@@ -4,11 +4,16 @@
 
 #include "ui/app_list/app_list_bubble_border.h"
 
+#include <string>
+
+#include "base/bind.h"
+#include "base/stringprintf.h"
 #include "third_party/skia/include/core/SkPath.h"
 #include "third_party/skia/include/core/SkPaint.h"
 #include "third_party/skia/include/effects/SkGradientShader.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/path.h"
+#include "ui/gfx/shadow_cache.h"
 #include "ui/gfx/skia_util.h"
 
 namespace {
@@ -31,6 +36,16 @@ const SkColor kContentsBackground = SkColorSetRGB(0xFC, 0xFC, 0xFC);
 const SkColor kTopSeparatorColor = SkColorSetRGB(0xF0, 0xF0, 0xF0);
 const int kTopSeparatorSize = 1;
 
+// Paints |path| with |paint| on |canvas|, moving |origin| to the origin of
+// |canvas|. Used to paint the masks of the shadows.
+void PaintShapeMask(const SkPath& path,
+                    const SkPaint& paint,
+                    const gfx::Point& origin,
+                    gfx::Canvas* canvas) {
+  canvas->Translate(gfx::Point(-origin.x(), -origin.y()));
+  canvas->DrawPath(path, paint);
+}
+
 // Builds a bubble shape for given |bounds|.
 void BuildShape(const gfx::Rect& bounds,
                 views::BubbleBorder::ArrowLocation arrow_location,
@@ -329,7 +344,22 @@ void AppListBubbleBorder::Paint(const views::View& view,
   paint.setStyle(SkPaint::kStrokeAndFill_Style);
   paint.setStrokeWidth(SkIntToScalar(kBorderSize));
   paint.setColor(kBorderColor);
-  SkSafeUnref(paint.setLooper(gfx::CreateShadowDrawLooper(shadows_)));
+
+  // The shadow masks are cached, since the shape only changes with the size of
+  // the contents and the arrow.
+  SkRect path_bounds = path.getBounds();
+  path_bounds.outset(SkIntToScalar(kBorderSize), SkIntToScalar(kBorderSize));
+  SkIRect shape_bounds;
+  path_bounds.roundOut(&shape_bounds);
+  const gfx::Rect shadow_bounds(shape_bounds.x(), shape_bounds.y(),
+                                shape_bounds.width(), shape_bounds.height());
+  const std::string shape_key = base::StringPrintf(
+      "AppListBubbleBorder %dx%d arrow %d offset %d",
+      content_bounds.width(), content_bounds.height(),
+      static_cast<int>(arrow_location()), GetArrowOffset());
+  gfx::ShadowCache::GetInstance()->PaintShadows(
+      canvas, shape_key, shadow_bounds, shadows_,
+      base::Bind(&PaintShapeMask, path, paint, shadow_bounds.origin()));
   canvas->DrawPath(path, paint);
 
   // Pads with kBoprderSize pixels to leave space for border lines.
@@ -133,10 +133,9 @@ class AppListItemView::IconOperation
 };
 
 AppListItemView::AppListItemView(AppsGridView* apps_grid_view,
-                                 AppListItemModel* model,
                                  views::ButtonListener* listener)
     : CustomButton(listener),
-      model_(model),
+      model_(NULL),
       apps_grid_view_(apps_grid_view),
       icon_(new StaticImageView),
       title_(new DropShadowLabel),
@@ -153,17 +152,39 @@ AppListItemView::AppListItemView(AppsGridView* apps_grid_view,
   AddChildView(icon_);
   AddChildView(title_);
 
-  ItemIconChanged();
-  ItemTitleChanged();
-  model_->AddObserver(this);
-
   set_context_menu_controller(this);
   set_request_focus_on_press(false);
 }
 
 AppListItemView::~AppListItemView() {
-  model_->RemoveObserver(this);
+  if (model_)
+    model_->RemoveObserver(this);
+  CancelPendingIconOperation();
+}
+
+void AppListItemView::SetModel(AppListItemModel* model) {
+  if (model == model_)
+    return;
+
+  if (model_) {
+    // Drop the hover state of the old item before letting go of it.
+    SetState(BS_NORMAL);
+    model_->RemoveObserver(this);
+  }
   CancelPendingIconOperation();
+  icon_op_ = NULL;
+
+  model_ = model;
+  if (!model_) {
+    icon_->SetImage(NULL);
+    title_->SetText(string16());
+    return;
+  }
+
+  ItemIconChanged();
+  ItemTitleChanged();
+  model_->AddObserver(this);
+  SchedulePaint();
 }
 
 void AppListItemView::SetIconSize(const gfx::Size& size) {
@@ -230,7 +251,7 @@ void AppListItemView::ItemTitleChanged() {
 }
 
 void AppListItemView::ItemHighlightedChanged() {
-  apps_grid_view_->EnsureItemVisible(this);
+  // AppsGridView makes the item visible, since it may not have a view.
   SchedulePaint();
 }
 
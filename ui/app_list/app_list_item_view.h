@@ -38,10 +38,13 @@ class APP_LIST_EXPORT AppListItemView : public views::CustomButton,
   static const char kViewClassName[];
 
   AppListItemView(AppsGridView* apps_grid_view,
-                  AppListItemModel* model,
                   views::ButtonListener* listener);
   virtual ~AppListItemView();
 
+  // Makes this view show |model|, which may be NULL while the view is not
+  // shown. AppsGridView rebinds its views to other items as pages change.
+  void SetModel(AppListItemModel* model);
+
   void SetIconSize(const gfx::Size& size);
 
   AppListItemModel* model() const { return model_; }
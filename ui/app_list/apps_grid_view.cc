@@ -5,7 +5,10 @@
 #include "ui/app_list/apps_grid_view.h"
 
 #include <algorithm>
+#include <cstdlib>
 
+#include "ui/app_list/app_list_item_model.h"
+#include "ui/app_list/app_list_item_model_observer.h"
 #include "ui/app_list/app_list_item_view.h"
 #include "ui/app_list/pagination_model.h"
 #include "ui/views/border.h"
@@ -27,6 +30,33 @@ const int kPreferredTileHeight = 98;
 
 namespace app_list {
 
+// Tells the grid when an item is highlighted, whether it has a view or not.
+class AppsGridView::ItemWatcher : public AppListItemModelObserver {
+ public:
+  ItemWatcher(AppsGridView* grid, AppListItemModel* item)
+      : grid_(grid),
+        item_(item) {
+    item_->AddObserver(this);
+  }
+  virtual ~ItemWatcher() {
+    item_->RemoveObserver(this);
+  }
+
+  // AppListItemModelObserver overrides:
+  virtual void ItemIconChanged() OVERRIDE {}
+  virtual void ItemTitleChanged() OVERRIDE {}
+  virtual void ItemHighlightedChanged() OVERRIDE {
+    if (item_->highlighted())
+      grid_->OnItemHighlighted(this);
+  }
+
+ private:
+  AppsGridView* grid_;
+  AppListItemModel* item_;
+
+  DISALLOW_COPY_AND_ASSIGN(ItemWatcher);
+};
+
 AppsGridView::AppsGridView(views::ButtonListener* listener,
                                    PaginationModel* pagination_model)
     : model_(NULL),
@@ -34,7 +64,8 @@ AppsGridView::AppsGridView(views::ButtonListener* listener,
       pagination_model_(pagination_model),
       cols_(0),
       rows_per_page_(0),
-      selected_item_index_(-1) {
+      selected_item_index_(-1),
+      ALLOW_THIS_IN_INITIALIZER_LIST(item_views_(this, this)) {
   pagination_model_->AddObserver(this);
 }
 
@@ -66,28 +97,20 @@ void AppsGridView::SetModel(AppListModel::Apps* model) {
 }
 
 void AppsGridView::SetSelectedItem(AppListItemView* item) {
-  int index = GetIndexOf(item);
+  int index = item_views_.GetIndexOfView(item);
   if (index >= 0)
     SetSelectedItemByIndex(index);
 }
 
 void AppsGridView::ClearSelectedItem(AppListItemView* item) {
-  int index = GetIndexOf(item);
+  int index = item_views_.GetIndexOfView(item);
   if (index == selected_item_index_)
     SetSelectedItemByIndex(-1);
 }
 
 bool AppsGridView::IsSelectedItem(const AppListItemView* item) const {
   return selected_item_index_ != -1 &&
-      selected_item_index_ == GetIndexOf(item);
-}
-
-void AppsGridView::EnsureItemVisible(const AppListItemView* item) {
-  int index = GetIndexOf(item);
-  if (index >= 0 && tiles_per_page()) {
-    pagination_model_->SelectPage(index / tiles_per_page(),
-                                  false /* animate */);
-  }
+      selected_item_index_ == item_views_.GetIndexOfView(item);
 }
 
 gfx::Size AppsGridView::GetPreferredSize() {
@@ -99,7 +122,8 @@ gfx::Size AppsGridView::GetPreferredSize() {
 
 void AppsGridView::Layout() {
   gfx::Rect rect(GetContentsBounds());
-  if (rect.IsEmpty() || child_count() == 0 || !tiles_per_page())
+  if (rect.IsEmpty() || item_views_.start() == item_views_.end() ||
+      !tiles_per_page())
     return;
 
   gfx::Size tile_size(kPreferredTileWidth, kPreferredTileHeight);
@@ -127,9 +151,8 @@ void AppsGridView::Layout() {
 
   const int first_visible_index = current_page * tiles_per_page();
   const int last_visible_index = (current_page + 1) * tiles_per_page() - 1;
-  gfx::Rect tile_slot(grid_rect.origin(), tile_size);
-  for (int i = 0; i < child_count(); ++i) {
-    views::View* view = child_at(i);
+  for (int i = item_views_.start(); i < item_views_.end(); ++i) {
+    views::View* view = item_views_.GetViewForIndex(i);
 
     // Decides an x_offset for current item.
     int x_offset = 0;
@@ -142,24 +165,23 @@ void AppsGridView::Layout() {
     if (page == current_page || page == transition.target_page)
       x_offset += transition_offset;
 
-    gfx::Rect adjusted_slot(tile_slot);
-    adjusted_slot.Offset(x_offset, 0);
-    view->SetBoundsRect(adjusted_slot);
-
-    tile_slot.Offset(tile_size.width(), 0);
-    if ((i + 1) % tiles_per_page() == 0) {
-      tile_slot.set_origin(grid_rect.origin());
-    } else if ((i + 1) % cols_ == 0) {
-      tile_slot.set_x(grid_rect.x());
-      tile_slot.set_y(tile_slot.y() + tile_size.height());
-    }
+    // Only the views of some pages exist, so the slot is computed from the
+    // index rather than by stepping through all the items.
+    const int slot = i % tiles_per_page();
+    gfx::Rect tile_slot(
+        gfx::Point(grid_rect.x() + slot % cols_ * tile_size.width(),
+                   grid_rect.y() + slot / cols_ * tile_size.height()),
+        tile_size);
+    tile_slot.Offset(x_offset, 0);
+    view->SetBoundsRect(tile_slot);
   }
 }
 
 bool AppsGridView::OnKeyPressed(const views::KeyEvent& event) {
   bool handled = false;
-  if (selected_item_index_ >= 0)
-    handled = GetItemViewAtIndex(selected_item_index_)->OnKeyPressed(event);
+  AppListItemView* selected_view = GetItemViewAtIndex(selected_item_index_);
+  if (selected_view)
+    handled = selected_view->OnKeyPressed(event);
 
   if (!handled) {
     switch (event.key_code()) {
@@ -168,7 +190,7 @@ bool AppsGridView::OnKeyPressed(const views::KeyEvent& event) {
         return true;
       case ui::VKEY_RIGHT:
         SetSelectedItemByIndex(std::min(selected_item_index_ + 1,
-                                        child_count() - 1));
+                                        item_count() - 1));
         return true;
       case ui::VKEY_UP:
         SetSelectedItemByIndex(std::max(selected_item_index_ - cols_,
@@ -179,7 +201,7 @@ bool AppsGridView::OnKeyPressed(const views::KeyEvent& event) {
           SetSelectedItemByIndex(0);
         } else {
           SetSelectedItemByIndex(std::min(selected_item_index_ + cols_,
-                                          child_count() - 1));
+                                          item_count() - 1));
         }
         return true;
       case ui::VKEY_PRIOR: {
@@ -194,7 +216,7 @@ bool AppsGridView::OnKeyPressed(const views::KeyEvent& event) {
         } else {
           SetSelectedItemByIndex(
               std::min(selected_item_index_ + tiles_per_page(),
-                       child_count() - 1));
+                       item_count() - 1));
         }
       }
       default:
@@ -207,8 +229,9 @@ bool AppsGridView::OnKeyPressed(const views::KeyEvent& event) {
 
 bool AppsGridView::OnKeyReleased(const views::KeyEvent& event) {
   bool handled = false;
-  if (selected_item_index_ >= 0)
-    handled = GetItemViewAtIndex(selected_item_index_)->OnKeyReleased(event);
+  AppListItemView* selected_view = GetItemViewAtIndex(selected_item_index_);
+  if (selected_view)
+    handled = selected_view->OnKeyReleased(event);
 
   return handled;
 }
@@ -219,14 +242,16 @@ void AppsGridView::OnPaintFocusBorder(gfx::Canvas* canvas) {
 
 void AppsGridView::Update() {
   selected_item_index_ = -1;
-  RemoveAllChildViews(true);
+  item_views_.Clear();
+  item_watchers_.reset();
   if (!model_ || model_->item_count() == 0)
     return;
 
   for (size_t i = 0; i < model_->item_count(); ++i)
-    AddChildView(CreateViewForItemAtIndex(i));
+    item_watchers_.push_back(new ItemWatcher(this, model_->GetItemAt(i)));
 
   UpdatePaginationModel();
+  UpdateItemViews();
 
   Layout();
   SchedulePaint();
@@ -234,36 +259,61 @@ void AppsGridView::Update() {
 
 void AppsGridView::UpdatePaginationModel() {
   pagination_model_->SetTotalPages(
-      (child_count() - 1) / tiles_per_page() + 1);
+      (item_count() - 1) / tiles_per_page() + 1);
   if (pagination_model_->selected_page() < 0)
     pagination_model_->SelectPage(0, false /* animate */);
 }
 
-AppListItemView* AppsGridView::CreateViewForItemAtIndex(size_t index) {
-  DCHECK_LT(index, model_->item_count());
-  AppListItemView* item = new AppListItemView(this,
-                                              model_->GetItemAt(index),
-                                              listener_);
-  item->SetIconSize(icon_size_);
-  return item;
+void AppsGridView::UpdateItemViews() {
+  const int current_page = pagination_model_->selected_page();
+  if (!model_ || !tiles_per_page() || current_page < 0) {
+    item_views_.Clear();
+    return;
+  }
+
+  // The pages between the selected page and the target of the transition
+  // are not shown, so when jumping further than the next page only the
+  // target page gets views.
+  int first_page = current_page;
+  int last_page = current_page;
+  const int target_page = pagination_model_->transition().target_page;
+  if (target_page >= 0) {
+    if (std::abs(target_page - current_page) == 1) {
+      first_page = std::min(current_page, target_page);
+      last_page = std::max(current_page, target_page);
+    } else {
+      first_page = last_page = target_page;
+    }
+  }
+  item_views_.SetRange(
+      std::min(first_page * tiles_per_page(), item_count()),
+      std::min((last_page + 1) * tiles_per_page(), item_count()));
+}
+
+int AppsGridView::item_count() const {
+  return model_ ? static_cast<int>(model_->item_count()) : 0;
 }
 
 AppListItemView* AppsGridView::GetItemViewAtIndex(int index) {
-  return static_cast<AppListItemView*>(child_at(index));
+  return static_cast<AppListItemView*>(item_views_.GetViewForIndex(index));
 }
 
 void AppsGridView::SetSelectedItemByIndex(int index) {
   if (selected_item_index_ == index)
     return;
 
-  if (selected_item_index_ >= 0)
-    GetItemViewAtIndex(selected_item_index_)->SchedulePaint();
+  AppListItemView* old_selected_view =
+      GetItemViewAtIndex(selected_item_index_);
+  if (old_selected_view)
+    old_selected_view->SchedulePaint();
 
-  if (index < 0 || index >= child_count()) {
+  if (index < 0 || index >= item_count()) {
     selected_item_index_ = -1;
   } else {
     selected_item_index_ = index;
-    GetItemViewAtIndex(selected_item_index_)->SchedulePaint();
+    AppListItemView* selected_view = GetItemViewAtIndex(selected_item_index_);
+    if (selected_view)
+      selected_view->SchedulePaint();
 
     if (tiles_per_page()) {
       pagination_model_->SelectPage(selected_item_index_ / tiles_per_page(),
@@ -272,21 +322,60 @@ void AppsGridView::SetSelectedItemByIndex(int index) {
   }
 }
 
+void AppsGridView::EnsureIndexVisible(int index) {
+  if (index >= 0 && tiles_per_page()) {
+    pagination_model_->SelectPage(index / tiles_per_page(),
+                                  false /* animate */);
+  }
+}
+
+void AppsGridView::OnItemHighlighted(ItemWatcher* watcher) {
+  ScopedVector<ItemWatcher>::iterator i =
+      std::find(item_watchers_.begin(), item_watchers_.end(), watcher);
+  DCHECK(i != item_watchers_.end());
+  EnsureIndexVisible(static_cast<int>(i - item_watchers_.begin()));
+}
+
 void AppsGridView::ListItemsAdded(size_t start, size_t count) {
+  std::vector<ItemWatcher*> watchers;
+  watchers.reserve(count);
   for (size_t i = start; i < start + count; ++i)
-    AddChildViewAt(CreateViewForItemAtIndex(i), i);
+    watchers.push_back(new ItemWatcher(this, model_->GetItemAt(i)));
+  item_watchers_.insert(item_watchers_.begin() + start,
+                        watchers.begin(), watchers.end());
+  item_views_.ItemsAdded(start, count);
 
   UpdatePaginationModel();
+  UpdateItemViews();
 
   Layout();
   SchedulePaint();
 }
 
 void AppsGridView::ListItemsRemoved(size_t start, size_t count) {
-  for (size_t i = 0; i < count; ++i)
-    delete child_at(start);
+  item_watchers_.erase(item_watchers_.begin() + start,
+                       item_watchers_.begin() + start + count);
+  item_views_.ItemsRemoved(start, count);
 
   UpdatePaginationModel();
+  UpdateItemViews();
+
+  Layout();
+  SchedulePaint();
+}
+
+void AppsGridView::ListItemsMoved(size_t start,
+                                  size_t count,
+                                  size_t target) {
+  std::vector<ItemWatcher*>::iterator begin = item_watchers_.begin();
+  if (target < start)
+    std::rotate(begin + target, begin + start, begin + start + count);
+  else
+    std::rotate(begin + start, begin + start + count, begin + target + count);
+
+  // Rebinds the views of all the items that changed index.
+  size_t first = std::min(start, target);
+  item_views_.ItemsChanged(first, std::max(start, target) + count - first);
 
   Layout();
   SchedulePaint();
@@ -300,11 +389,27 @@ void AppsGridView::TotalPagesChanged() {
 }
 
 void AppsGridView::SelectedPageChanged(int old_selected, int new_selected) {
+  UpdateItemViews();
   Layout();
 }
 
 void AppsGridView::TransitionChanged() {
+  UpdateItemViews();
   Layout();
 }
 
+views::View* AppsGridView::CreateRecyclableView() {
+  AppListItemView* view = new AppListItemView(this, listener_);
+  view->SetIconSize(icon_size_);
+  return view;
+}
+
+void AppsGridView::BindView(views::View* view, int index) {
+  static_cast<AppListItemView*>(view)->SetModel(model_->GetItemAt(index));
+}
+
+void AppsGridView::UnbindView(views::View* view) {
+  static_cast<AppListItemView*>(view)->SetModel(NULL);
+}
+
 }  // namespace app_list
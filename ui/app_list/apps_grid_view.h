@@ -8,11 +8,13 @@
 
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/memory/scoped_vector.h"
 #include "ui/app_list/app_list_export.h"
 #include "ui/app_list/app_list_model.h"
 #include "ui/app_list/pagination_model_observer.h"
 #include "ui/base/models/list_model_observer.h"
 #include "ui/views/view.h"
+#include "ui/views/view_recycler.h"
 
 namespace views {
 class ButtonListener;
@@ -23,10 +25,13 @@ namespace app_list {
 class AppListItemView;
 class PaginationModel;
 
-// AppsGridView displays a grid for AppListModel::Apps sub model.
+// AppsGridView displays a grid for AppListModel::Apps sub model. Only the
+// items of the selected page, and of the page being transitioned to, have
+// views. The views are recycled as pages change.
 class APP_LIST_EXPORT AppsGridView : public views::View,
                                      public ui::ListModelObserver,
-                                     public PaginationModelObserver {
+                                     public PaginationModelObserver,
+                                     public views::ViewRecycler::Delegate {
  public:
   AppsGridView(views::ButtonListener* listener,
                PaginationModel* pagination_model);
@@ -43,8 +48,6 @@ class APP_LIST_EXPORT AppsGridView : public views::View,
   void ClearSelectedItem(AppListItemView* item);
   bool IsSelectedItem(const AppListItemView* item) const;
 
-  void EnsureItemVisible(const AppListItemView* item);
-
   int tiles_per_page() const { return cols_ * rows_per_page_; }
 
   // Overridden from views::View:
@@ -55,20 +58,35 @@ class APP_LIST_EXPORT AppsGridView : public views::View,
   virtual void OnPaintFocusBorder(gfx::Canvas* canvas) OVERRIDE;
 
  private:
+  class ItemWatcher;
+
   // Updates from model.
   void Update();
 
   // Updates total pages and auto select first page is no page is selected.
   void UpdatePaginationModel();
 
-  AppListItemView* CreateViewForItemAtIndex(size_t index);
+  // Updates the range of items that have views from the pagination model.
+  void UpdateItemViews();
 
+  int item_count() const;
+
+  // Returns the view of the item at |index|, or NULL if it's not on a page
+  // that has views.
   AppListItemView* GetItemViewAtIndex(int index);
   void SetSelectedItemByIndex(int index);
 
+  // Selects the page of the item at |index|.
+  void EnsureIndexVisible(int index);
+
+  // Invoked by |watcher| when its item is highlighted.
+  void OnItemHighlighted(ItemWatcher* watcher);
+
   // Overridden from ListModelObserver:
   virtual void ListItemsAdded(size_t start, size_t count) OVERRIDE;
   virtual void ListItemsRemoved(size_t start, size_t count) OVERRIDE;
+  virtual void ListItemsMoved(size_t start, size_t count,
+                              size_t target) OVERRIDE;
   virtual void ListItemsChanged(size_t start, size_t count) OVERRIDE;
 
   // Overridden from PaginationModelObserver:
@@ -76,6 +94,11 @@ class APP_LIST_EXPORT AppsGridView : public views::View,
   virtual void SelectedPageChanged(int old_selected, int new_selected) OVERRIDE;
   virtual void TransitionChanged() OVERRIDE;
 
+  // Overridden from views::ViewRecycler::Delegate:
+  virtual views::View* CreateRecyclableView() OVERRIDE;
+  virtual void BindView(views::View* view, int index) OVERRIDE;
+  virtual void UnbindView(views::View* view) OVERRIDE;
+
   AppListModel::Apps* model_;  // Owned by AppListModel.
   views::ButtonListener* listener_;
   PaginationModel* pagination_model_;  // Owned by AppListView.
@@ -86,6 +109,12 @@ class APP_LIST_EXPORT AppsGridView : public views::View,
 
   int selected_item_index_;
 
+  // Watches the highlight of each item of |model_|, in order, since items
+  // without views need to be shown when highlighted.
+  ScopedVector<ItemWatcher> item_watchers_;
+
+  views::ViewRecycler item_views_;
+
   DISALLOW_COPY_AND_ASSIGN(AppsGridView);
 };
 
@@ -109,5 +109,20 @@ TEST_F(AppsGridViewTest, EnsureHighlightedVisible) {
   EXPECT_EQ(kPages - 1, pagination_model_->selected_page());
 }
 
+TEST_F(AppsGridViewTest, OnlySelectedPageHasViews) {
+  const int kPages = 3;
+  const int tiles_per_page = apps_grid_view_->tiles_per_page();
+  PopulateApps(kPages * tiles_per_page - 1);
+  EXPECT_EQ(tiles_per_page, apps_grid_view_->child_count());
+
+  // The last page is one item short.
+  pagination_model_->SelectPage(kPages - 1, false /* animate */);
+  EXPECT_EQ(tiles_per_page - 1, apps_grid_view_->child_count());
+
+  // Removing an item of the first page moves one out of the last page.
+  apps_model_->DeleteAt(0);
+  EXPECT_EQ(tiles_per_page - 2, apps_grid_view_->child_count());
+}
+
 }  // namespace test
 }  // namespace app_list
@@ -4,28 +4,40 @@
 
 #include "ui/app_list/icon_cache.h"
 
+#include "base/bind.h"
 #include "base/logging.h"
-#include "base/md5.h"
 #include "ui/gfx/size.h"
 
 namespace {
 
-// Gets cache key based on |image| contents and desired |size|.
-std::string GetKey(const SkBitmap& image, const gfx::Size& size) {
-  SkAutoLockPixels image_lock(image);
-  base::MD5Digest digest;
-  MD5Sum(image.getPixels(), image.getSize(), &digest);
-
-  return MD5DigestToBase16(digest) + "." + size.ToString();
+size_t GetImageByteCount(const SkBitmap& image) {
+  return image.getSize();
 }
 
 }  // namespace
 
 namespace app_list {
 
+// static
+const size_t IconCache::kDefaultByteBudget = 16 * 1024 * 1024;
+
 // static
 IconCache* IconCache::instance_ = NULL;
 
+IconCache::Key::Key(uint32 generation_id, const gfx::Size& size)
+    : generation_id(generation_id),
+      width(size.width()),
+      height(size.height()) {
+}
+
+bool IconCache::Key::operator<(const Key& other) const {
+  if (generation_id != other.generation_id)
+    return generation_id < other.generation_id;
+  if (width != other.width)
+    return width < other.width;
+  return height < other.height;
+}
+
 // static
 void IconCache::CreateInstance() {
   DCHECK(!instance_);
@@ -46,23 +58,28 @@ IconCache* IconCache::GetInstance() {
 }
 
 void IconCache::MarkAllEntryUnused() {
+  base::AutoLock lock(lock_);
   for (Cache::iterator i = cache_.begin(); i != cache_.end(); ++i)
     i->second.used = false;
 }
 
 void IconCache::PurgeAllUnused() {
+  base::AutoLock lock(lock_);
   for (Cache::iterator i = cache_.begin(); i != cache_.end();) {
-    Cache::iterator current(i);
-    ++i;
-    if (!current->second.used)
-      cache_.erase(current);
+    if (!i->second.used) {
+      byte_count_ -= GetImageByteCount(i->second.image);
+      i = cache_.Erase(i);
+    } else {
+      ++i;
+    }
   }
 }
 
 bool IconCache::Get(const SkBitmap& src,
                     const gfx::Size& size,
                     SkBitmap* processed) {
-  Cache::iterator it = cache_.find(GetKey(src, size));
+  base::AutoLock lock(lock_);
+  Cache::iterator it = cache_.Get(Key(src.getGenerationID(), size));
   if (it == cache_.end())
     return false;
 
@@ -76,15 +93,65 @@ bool IconCache::Get(const SkBitmap& src,
 void IconCache::Put(const SkBitmap& src,
                     const gfx::Size& size,
                     const SkBitmap& processed) {
-  const std::string key = GetKey(src, size);
-  cache_[key].image = processed;
-  cache_[key].used = true;
+  // Images without pixels have no generation ID to find them by.
+  uint32 generation_id = src.getGenerationID();
+  if (!generation_id)
+    return;
+
+  base::AutoLock lock(lock_);
+  Key key(generation_id, size);
+  Cache::iterator it = cache_.Peek(key);
+  if (it != cache_.end())
+    byte_count_ -= GetImageByteCount(it->second.image);
+
+  Item item;
+  item.image = processed;
+  item.used = true;
+  cache_.Put(key, item);
+  byte_count_ += GetImageByteCount(processed);
+  EvictToBudget();
+}
+
+void IconCache::SetByteBudget(size_t byte_budget) {
+  base::AutoLock lock(lock_);
+  byte_budget_ = byte_budget;
+  EvictToBudget();
 }
 
-IconCache::IconCache() {
+size_t IconCache::GetByteCount() {
+  base::AutoLock lock(lock_);
+  return byte_count_;
+}
+
+IconCache::IconCache()
+    : cache_(Cache::NO_AUTO_EVICT),
+      byte_count_(0),
+      byte_budget_(kDefaultByteBudget) {
+  memory_pressure_listener_.reset(new base::MemoryPressureListener(
+      base::Bind(&IconCache::OnMemoryPressure, base::Unretained(this))));
 }
 
 IconCache::~IconCache() {
 }
 
+void IconCache::EvictToBudget() {
+  EvictToByteCount(byte_budget_);
+}
+
+void IconCache::EvictToByteCount(size_t byte_count) {
+  lock_.AssertAcquired();
+  while (byte_count_ > byte_count && !cache_.empty()) {
+    Cache::reverse_iterator oldest = cache_.rbegin();
+    byte_count_ -= GetImageByteCount(oldest->second.image);
+    cache_.Erase(oldest);
+  }
+}
+
+void IconCache::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  base::AutoLock lock(lock_);
+  EvictToByteCount(base::MemoryPressureListener::GetTrimmedBudget(
+      byte_budget_, level));
+}
+
 }  // namespace app_list
@@ -6,10 +6,11 @@
 #define UI_APP_LIST_ICON_CACHE_H_
 #pragma once
 
-#include <map>
-#include <string>
-
 #include "base/basictypes.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/memory/mru_cache.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/lock.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "ui/app_list/app_list_export.h"
 
@@ -20,8 +21,16 @@ class Size;
 namespace app_list {
 
 // IconCache stores processed image, keyed by the source image and desired size.
+// The source image is identified by its generation ID, which changes whenever
+// its pixels do, so looking an image up doesn't need its pixels. The least
+// recently used images are evicted when the processed images take more than
+// the byte budget, and down to a share of it when memory is short. The cache
+// may be used from any thread.
 class APP_LIST_EXPORT IconCache {
  public:
+  // The default byte budget: 16MB.
+  static const size_t kDefaultByteBudget;
+
   static void CreateInstance();
   static void DeleteInstance();
 
@@ -37,19 +46,52 @@ class APP_LIST_EXPORT IconCache {
            const gfx::Size& size,
            const SkBitmap& processed);
 
+  // Sets how many bytes the processed images may take, evicting as needed.
+  void SetByteBudget(size_t byte_budget);
+
+  // Returns how many bytes the processed images take.
+  size_t GetByteCount();
+
  private:
+  struct Key {
+    Key(uint32 generation_id, const gfx::Size& size);
+
+    bool operator<(const Key& other) const;
+
+    uint32 generation_id;
+    int width;
+    int height;
+  };
   struct Item {
     SkBitmap image;
     bool used;
   };
-  typedef std::map<std::string, Item> Cache;
+  typedef base::MRUCache<Key, Item> Cache;
 
   IconCache();
   ~IconCache();
 
+  // Evicts the least recently used images until the cache is within budget.
+  // |lock_| must be held.
+  void EvictToBudget();
+
+  // Evicts the least recently used images until they take at most
+  // |byte_count| bytes. |lock_| must be held.
+  void EvictToByteCount(size_t byte_count);
+
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+
   static IconCache* instance_;
 
+  // Guards the members below.
+  base::Lock lock_;
+
   Cache cache_;
+  size_t byte_count_;
+  size_t byte_budget_;
+
+  scoped_ptr<base::MemoryPressureListener> memory_pressure_listener_;
 
   DISALLOW_COPY_AND_ASSIGN(IconCache);
 };
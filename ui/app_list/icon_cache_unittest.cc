@@ -0,0 +1,155 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/app_list/icon_cache.h"
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/message_loop.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/size.h"
+
+namespace app_list {
+namespace test {
+
+namespace {
+
+SkBitmap CreateBitmap(int width, int height) {
+  SkBitmap bitmap;
+  bitmap.setConfig(SkBitmap::kARGB_8888_Config, width, height);
+  bitmap.allocPixels();
+  bitmap.eraseARGB(255, 0, 0, 255);
+  return bitmap;
+}
+
+}  // namespace
+
+class IconCacheTest : public testing::Test {
+ public:
+  IconCacheTest() {}
+  virtual ~IconCacheTest() {}
+
+  // testing::Test overrides:
+  virtual void SetUp() OVERRIDE {
+    IconCache::CreateInstance();
+  }
+  virtual void TearDown() OVERRIDE {
+    IconCache::DeleteInstance();
+  }
+
+ private:
+  // For the memory pressure listener of the cache.
+  MessageLoop message_loop_;
+
+  DISALLOW_COPY_AND_ASSIGN(IconCacheTest);
+};
+
+// Images are found by their generation ID, not their pixels.
+TEST_F(IconCacheTest, KeyedByGeneration) {
+  IconCache* cache = IconCache::GetInstance();
+  SkBitmap src = CreateBitmap(64, 64);
+  SkBitmap processed = CreateBitmap(32, 32);
+  gfx::Size size(32, 32);
+
+  cache->Put(src, size, processed);
+  SkBitmap found;
+  EXPECT_TRUE(cache->Get(src, size, &found));
+  EXPECT_EQ(processed.getPixels(), found.getPixels());
+  EXPECT_FALSE(cache->Get(src, gfx::Size(48, 48), NULL));
+
+  // The same pixels in another image aren't found.
+  EXPECT_FALSE(cache->Get(CreateBitmap(64, 64), size, NULL));
+
+  // Changing the pixels of the source image changes its generation.
+  src.eraseARGB(255, 255, 0, 0);
+  EXPECT_FALSE(cache->Get(src, size, NULL));
+}
+
+// The least recently used images are evicted to stay within the budget.
+TEST_F(IconCacheTest, ByteBudget) {
+  IconCache* cache = IconCache::GetInstance();
+  gfx::Size size(32, 32);
+  SkBitmap processed = CreateBitmap(32, 32);
+  size_t image_bytes = processed.getSize();
+  cache->SetByteBudget(2 * image_bytes);
+
+  SkBitmap src1 = CreateBitmap(64, 64);
+  SkBitmap src2 = CreateBitmap(64, 64);
+  SkBitmap src3 = CreateBitmap(64, 64);
+  cache->Put(src1, size, processed);
+  cache->Put(src2, size, processed);
+  EXPECT_EQ(2 * image_bytes, cache->GetByteCount());
+
+  // Using src1 makes src2 the least recently used.
+  EXPECT_TRUE(cache->Get(src1, size, NULL));
+  cache->Put(src3, size, processed);
+  EXPECT_EQ(2 * image_bytes, cache->GetByteCount());
+  EXPECT_TRUE(cache->Get(src1, size, NULL));
+  EXPECT_FALSE(cache->Get(src2, size, NULL));
+  EXPECT_TRUE(cache->Get(src3, size, NULL));
+
+  // Replacing an image doesn't count it twice.
+  cache->Put(src3, size, processed);
+  EXPECT_EQ(2 * image_bytes, cache->GetByteCount());
+
+  cache->SetByteBudget(0);
+  EXPECT_EQ(0u, cache->GetByteCount());
+  EXPECT_FALSE(cache->Get(src1, size, NULL));
+}
+
+TEST_F(IconCacheTest, PurgeAllUnused) {
+  IconCache* cache = IconCache::GetInstance();
+  gfx::Size size(32, 32);
+  SkBitmap processed = CreateBitmap(32, 32);
+  SkBitmap used = CreateBitmap(64, 64);
+  SkBitmap unused = CreateBitmap(64, 64);
+  cache->Put(used, size, processed);
+  cache->Put(unused, size, processed);
+
+  cache->MarkAllEntryUnused();
+  EXPECT_TRUE(cache->Get(used, size, NULL));
+  cache->PurgeAllUnused();
+  EXPECT_TRUE(cache->Get(used, size, NULL));
+  EXPECT_FALSE(cache->Get(unused, size, NULL));
+  EXPECT_EQ(processed.getSize(), cache->GetByteCount());
+}
+
+// Memory pressure trims the images to a share of the budget, once.
+TEST_F(IconCacheTest, MemoryPressure) {
+  IconCache* cache = IconCache::GetInstance();
+  gfx::Size size(32, 32);
+  SkBitmap processed = CreateBitmap(32, 32);
+  size_t image_bytes = processed.getSize();
+  cache->SetByteBudget(4 * image_bytes);
+
+  SkBitmap src1 = CreateBitmap(64, 64);
+  SkBitmap src2 = CreateBitmap(64, 64);
+  SkBitmap src3 = CreateBitmap(64, 64);
+  cache->Put(src1, size, processed);
+  cache->Put(src2, size, processed);
+  cache->Put(src3, size, processed);
+  EXPECT_TRUE(cache->Get(src1, size, NULL));
+
+  base::MemoryPressureListener::NotifyMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_MODERATE);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(image_bytes, cache->GetByteCount());
+  EXPECT_TRUE(cache->Get(src1, size, NULL));
+  EXPECT_FALSE(cache->Get(src3, size, NULL));
+
+  // The budget is back for new images.
+  cache->Put(src2, size, processed);
+  cache->Put(src3, size, processed);
+  EXPECT_EQ(3 * image_bytes, cache->GetByteCount());
+
+  base::MemoryPressureListener::NotifyMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_CRITICAL);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(0u, cache->GetByteCount());
+}
+
+}  // namespace test
+}  // namespace app_list
@@ -0,0 +1,226 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/app_list/search_index.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "base/bind.h"
+#include "base/i18n/case_conversion.h"
+#include "base/message_loop.h"
+#include "base/string_split.h"
+#include "base/string_util.h"
+#include "base/utf_string_conversions.h"
+#include "ui/app_list/app_list_item_model.h"
+#include "ui/app_list/app_list_item_model_observer.h"
+
+namespace {
+
+// Splits |text| into lowercase words.
+void GetWords(const string16& text, std::vector<string16>* words) {
+  base::SplitStringAlongWhitespace(base::i18n::ToLower(text), words);
+}
+
+}  // namespace
+
+namespace app_list {
+
+// An item of the model and the words of its title. Tells the index when the
+// title changes.
+class SearchIndex::Entry : public AppListItemModelObserver {
+ public:
+  Entry(SearchIndex* index, AppListItemModel* item)
+      : index_(index),
+        item_(item) {
+    GetWords(UTF8ToUTF16(item_->title()), &words_);
+    // A word that appears twice in a title only needs to be posted once.
+    std::sort(words_.begin(), words_.end());
+    words_.erase(std::unique(words_.begin(), words_.end()), words_.end());
+    item_->AddObserver(this);
+  }
+
+  virtual ~Entry() {
+    item_->RemoveObserver(this);
+  }
+
+  AppListItemModel* item() const { return item_; }
+  const std::vector<string16>& words() const { return words_; }
+
+  // Whether one of the words starts with |prefix|.
+  bool HasWordStartingWith(const string16& prefix) const {
+    std::vector<string16>::const_iterator it =
+        std::lower_bound(words_.begin(), words_.end(), prefix);
+    return it != words_.end() && StartsWith(*it, prefix, true);
+  }
+
+  // Overridden from AppListItemModelObserver:
+  virtual void ItemIconChanged() OVERRIDE {}
+  virtual void ItemTitleChanged() OVERRIDE {
+    index_->OnTitleChanged();
+  }
+  virtual void ItemHighlightedChanged() OVERRIDE {}
+
+ private:
+  SearchIndex* index_;
+  AppListItemModel* item_;
+  // Sorted, without duplicates.
+  std::vector<string16> words_;
+
+  DISALLOW_COPY_AND_ASSIGN(Entry);
+};
+
+SearchIndex::SearchIndex(AppListModel::Apps* apps)
+    : apps_(apps),
+      indexed_(false),
+      has_last_matches_(false),
+      last_search_cost_(0),
+      ALLOW_THIS_IN_INITIALIZER_LIST(search_factory_(this)) {
+  apps_->AddObserver(this);
+}
+
+SearchIndex::~SearchIndex() {
+  apps_->RemoveObserver(this);
+}
+
+void SearchIndex::Search(const string16& query, Items* matches) {
+  EnsureIndex();
+
+  string16 lower_query = base::i18n::ToLower(query);
+  std::vector<string16> query_words;
+  GetWords(lower_query, &query_words);
+
+  Positions positions;
+  if (query_words.empty()) {
+    // An empty query matches nothing.
+    last_search_cost_ = 0;
+  } else if (has_last_matches_ && StartsWith(lower_query, last_query_, true)) {
+    // Each word of the last query is a prefix of a word of this one, so this
+    // query can only match items the last one matched.
+    last_search_cost_ = last_matches_.size();
+    for (size_t i = 0; i < last_matches_.size(); ++i) {
+      if (EntryMatches(last_matches_[i], query_words))
+        positions.push_back(last_matches_[i]);
+    }
+  } else {
+    last_search_cost_ = 0;
+    LookUp(query_words[0], &positions);
+    for (size_t i = 1; i < query_words.size() && !positions.empty(); ++i) {
+      Positions word_positions;
+      LookUp(query_words[i], &word_positions);
+      Positions intersection;
+      std::set_intersection(positions.begin(), positions.end(),
+                            word_positions.begin(), word_positions.end(),
+                            std::back_inserter(intersection));
+      positions.swap(intersection);
+    }
+  }
+
+  last_query_ = lower_query;
+  last_matches_ = positions;
+  has_last_matches_ = !query_words.empty();
+
+  matches->clear();
+  for (size_t i = 0; i < positions.size(); ++i)
+    matches->push_back(entries_[positions[i]]->item());
+}
+
+void SearchIndex::StartSearch(const string16& query,
+                              const SearchCallback& callback) {
+  CancelSearch();
+  MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&SearchIndex::RunSearch, search_factory_.GetWeakPtr(),
+                 query, callback));
+}
+
+void SearchIndex::CancelSearch() {
+  search_factory_.InvalidateWeakPtrs();
+}
+
+void SearchIndex::OnTitleChanged() {
+  Invalidate();
+}
+
+void SearchIndex::Invalidate() {
+  // The entries observe the items, which may be about to be deleted.
+  entries_.reset();
+  words_.clear();
+  indexed_ = false;
+  last_matches_.clear();
+  has_last_matches_ = false;
+}
+
+void SearchIndex::EnsureIndex() {
+  if (indexed_)
+    return;
+
+  for (size_t i = 0; i < apps_->item_count(); ++i) {
+    Entry* entry = new Entry(this, apps_->GetItemAt(i));
+    entries_.push_back(entry);
+    // Positions are added in ascending order, keeping the lists sorted.
+    for (size_t j = 0; j < entry->words().size(); ++j)
+      words_[entry->words()[j]].push_back(i);
+  }
+  indexed_ = true;
+}
+
+void SearchIndex::LookUp(const string16& prefix, Positions* positions) {
+  positions->clear();
+  Words::const_iterator it = words_.lower_bound(prefix);
+  Words::const_iterator end = it;
+  while (end != words_.end() && StartsWith(end->first, prefix, true))
+    ++end;
+
+  // A single word is the common case and its list is already sorted.
+  if (it != end && std::distance(it, end) == 1) {
+    *positions = it->second;
+    last_search_cost_ += positions->size();
+    return;
+  }
+
+  for (; it != end; ++it) {
+    positions->insert(positions->end(), it->second.begin(), it->second.end());
+    last_search_cost_ += it->second.size();
+  }
+  std::sort(positions->begin(), positions->end());
+  positions->erase(std::unique(positions->begin(), positions->end()),
+                   positions->end());
+}
+
+bool SearchIndex::EntryMatches(
+    size_t position,
+    const std::vector<string16>& query_words) const {
+  const Entry* entry = entries_[position];
+  for (size_t i = 0; i < query_words.size(); ++i) {
+    if (!entry->HasWordStartingWith(query_words[i]))
+      return false;
+  }
+  return true;
+}
+
+void SearchIndex::RunSearch(const string16& query,
+                            const SearchCallback& callback) {
+  Items matches;
+  Search(query, &matches);
+  callback.Run(matches);
+}
+
+void SearchIndex::ListItemsAdded(size_t start, size_t count) {
+  Invalidate();
+}
+
+void SearchIndex::ListItemsRemoved(size_t start, size_t count) {
+  Invalidate();
+}
+
+void SearchIndex::ListItemsMoved(size_t start, size_t count, size_t target) {
+  Invalidate();
+}
+
+void SearchIndex::ListItemsChanged(size_t start, size_t count) {
+  Invalidate();
+}
+
+}  // namespace app_list
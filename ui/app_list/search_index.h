@@ -0,0 +1,111 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_APP_LIST_SEARCH_INDEX_H_
+#define UI_APP_LIST_SEARCH_INDEX_H_
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/memory/scoped_vector.h"
+#include "base/memory/weak_ptr.h"
+#include "base/string16.h"
+#include "ui/app_list/app_list_export.h"
+#include "ui/app_list/app_list_model.h"
+#include "ui/base/models/list_model_observer.h"
+
+namespace app_list {
+
+class AppListItemModel;
+
+// SearchIndex finds the items of an Apps model whose titles match a query:
+// each word of the query must be the prefix of a word of the title, ignoring
+// case. The words of all the titles are kept sorted, each with the positions
+// of the items it appears in, so that the items a query word matches are a
+// range of the words rather than a scan of the titles. A query that extends
+// the previous one only looks at the items the previous one matched.
+//
+// The index follows the changes of the model and of the titles of its items,
+// and is rebuilt at the first query after one.
+class APP_LIST_EXPORT SearchIndex : public ui::ListModelObserver {
+ public:
+  typedef std::vector<AppListItemModel*> Items;
+  typedef base::Callback<void(const Items&)> SearchCallback;
+
+  explicit SearchIndex(AppListModel::Apps* apps);
+  virtual ~SearchIndex();
+
+  // Sets |matches| to the items matching |query|, in the order of the model.
+  void Search(const string16& query, Items* matches);
+
+  // Runs |callback| with the items matching |query| from a task posted to the
+  // current message loop. A search started before and still pending is
+  // canceled, so that typing faster than searching only searches the last
+  // query.
+  void StartSearch(const string16& query, const SearchCallback& callback);
+
+  // Cancels the pending search, if any.
+  void CancelSearch();
+
+  // Returns how many items the last Search() looked at: the items of the
+  // posting lists, or the previous matches when narrowing.
+  size_t last_search_cost() const { return last_search_cost_; }
+
+ private:
+  class Entry;
+
+  // The positions in |entries_| of the items a word appears in, ascending.
+  typedef std::vector<size_t> Positions;
+  typedef std::map<string16, Positions> Words;
+
+  // Invoked by the entries when the title of their item changes.
+  void OnTitleChanged();
+
+  // Drops the index and the last matches.
+  void Invalidate();
+
+  // Builds the index from the model, if it isn't up to date.
+  void EnsureIndex();
+
+  // Sets |positions| to the entries that have a word starting with |prefix|.
+  void LookUp(const string16& prefix, Positions* positions);
+
+  // Whether the entry at |position| matches all the |query_words|.
+  bool EntryMatches(size_t position,
+                    const std::vector<string16>& query_words) const;
+
+  void RunSearch(const string16& query, const SearchCallback& callback);
+
+  // Overridden from ui::ListModelObserver:
+  virtual void ListItemsAdded(size_t start, size_t count) OVERRIDE;
+  virtual void ListItemsRemoved(size_t start, size_t count) OVERRIDE;
+  virtual void ListItemsMoved(size_t start, size_t count,
+                              size_t target) OVERRIDE;
+  virtual void ListItemsChanged(size_t start, size_t count) OVERRIDE;
+
+  AppListModel::Apps* apps_;  // Not owned.
+
+  // One entry per item of |apps_|, in the same order, while |indexed_|.
+  ScopedVector<Entry> entries_;
+  Words words_;
+  bool indexed_;
+
+  // The lowercased text and matches of the last query, for narrowing.
+  string16 last_query_;
+  Positions last_matches_;
+  bool has_last_matches_;
+
+  size_t last_search_cost_;
+
+  base::WeakPtrFactory<SearchIndex> search_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(SearchIndex);
+};
+
+}  // namespace app_list
+
+#endif  // UI_APP_LIST_SEARCH_INDEX_H_
@@ -0,0 +1,146 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/app_list/search_index.h"
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/message_loop.h"
+#include "base/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/app_list/app_list_item_model.h"
+
+namespace app_list {
+namespace test {
+
+class SearchIndexTest : public testing::Test {
+ public:
+  SearchIndexTest() : index_(&apps_) {}
+  virtual ~SearchIndexTest() {}
+
+  AppListItemModel* AddApp(const std::string& title) {
+    AppListItemModel* item = new AppListItemModel;
+    item->SetTitle(title);
+    apps_.Add(item);
+    return item;
+  }
+
+  // Returns the titles of the items matching |query|, separated by commas.
+  std::string Search(const std::string& query) {
+    SearchIndex::Items matches;
+    index_.Search(UTF8ToUTF16(query), &matches);
+    return GetTitles(matches);
+  }
+
+  static std::string GetTitles(const SearchIndex::Items& items) {
+    std::string titles;
+    for (size_t i = 0; i < items.size(); ++i) {
+      if (i)
+        titles += ",";
+      titles += items[i]->title();
+    }
+    return titles;
+  }
+
+  void OnSearchDone(const SearchIndex::Items& matches) {
+    search_results_.push_back(GetTitles(matches));
+  }
+
+ protected:
+  MessageLoopForUI message_loop_;
+  AppListModel::Apps apps_;
+  SearchIndex index_;
+  std::vector<std::string> search_results_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SearchIndexTest);
+};
+
+TEST_F(SearchIndexTest, MatchesWordPrefixes) {
+  AddApp("Google Chrome");
+  AddApp("Calculator");
+  AddApp("Chrome Web Store");
+  AddApp("Calendar");
+
+  EXPECT_EQ("", Search(""));
+  EXPECT_EQ("", Search("  "));
+  EXPECT_EQ("Google Chrome,Chrome Web Store", Search("chr"));
+  EXPECT_EQ("Calculator,Calendar", Search("CAL"));
+  EXPECT_EQ("Calendar", Search("calen"));
+  EXPECT_EQ("Google Chrome,Chrome Web Store", Search("chrome"));
+  EXPECT_EQ("Chrome Web Store", Search("chrome we"));
+  EXPECT_EQ("Chrome Web Store", Search("store chr"));
+  EXPECT_EQ("", Search("hrome"));
+  EXPECT_EQ("", Search("chrome calendar"));
+}
+
+// Queries that extend the last one only look at what it matched.
+TEST_F(SearchIndexTest, Narrowing) {
+  for (int i = 0; i < 10; ++i)
+    AddApp("Other App");
+  AddApp("Google Chrome");
+  AddApp("Chrome Web Store");
+
+  EXPECT_EQ("Google Chrome,Chrome Web Store", Search("c"));
+  EXPECT_EQ(2u, index_.last_search_cost());
+  EXPECT_EQ("Google Chrome,Chrome Web Store", Search("ch"));
+  EXPECT_EQ(2u, index_.last_search_cost());
+  EXPECT_EQ("Chrome Web Store", Search("ch w"));
+  EXPECT_EQ(2u, index_.last_search_cost());
+  EXPECT_EQ("Chrome Web Store", Search("ch web"));
+  EXPECT_EQ(1u, index_.last_search_cost());
+
+  // Removing characters looks the words up again.
+  EXPECT_EQ("Google Chrome,Chrome Web Store", Search("ch"));
+  EXPECT_EQ(2u, index_.last_search_cost());
+  EXPECT_EQ("Other App,Other App,Other App,Other App,Other App,"
+            "Other App,Other App,Other App,Other App,Other App",
+            Search("o"));
+  EXPECT_EQ(10u, index_.last_search_cost());
+}
+
+// The index follows the changes of the model and of the titles.
+TEST_F(SearchIndexTest, FollowsModel) {
+  AddApp("Calculator");
+  AppListItemModel* files = AddApp("Files");
+
+  EXPECT_EQ("Calculator", Search("ca"));
+  AddApp("Camera");
+  EXPECT_EQ("Calculator,Camera", Search("ca"));
+  EXPECT_EQ("Camera", Search("cam"));
+
+  files->SetTitle("Camera Roll");
+  EXPECT_EQ("Camera Roll,Camera", Search("cam"));
+
+  apps_.DeleteAt(0);
+  EXPECT_EQ("Camera Roll,Camera", Search("ca"));
+  apps_.DeleteAll();
+  EXPECT_EQ("", Search("ca"));
+}
+
+// Only the last of the searches started in a row runs.
+TEST_F(SearchIndexTest, StartSearchCancelsStaleSearches) {
+  AddApp("Calculator");
+  AddApp("Calendar");
+
+  SearchIndex::SearchCallback callback =
+      base::Bind(&SearchIndexTest::OnSearchDone, base::Unretained(this));
+  index_.StartSearch(UTF8ToUTF16("c"), callback);
+  index_.StartSearch(UTF8ToUTF16("ca"), callback);
+  index_.StartSearch(UTF8ToUTF16("calc"), callback);
+  message_loop_.RunAllPending();
+  ASSERT_EQ(1u, search_results_.size());
+  EXPECT_EQ("Calculator", search_results_[0]);
+
+  index_.StartSearch(UTF8ToUTF16("cal"), callback);
+  index_.CancelSearch();
+  message_loop_.RunAllPending();
+  EXPECT_EQ(1u, search_results_.size());
+}
+
+}  // namespace test
+}  // namespace app_list
@@ -96,6 +96,8 @@ SearchResultView* SearchResultListView::GetResultViewAt(int index) {
 }
 
 void SearchResultListView::Update() {
+  // Views keep the results that are still at their position, so that only the
+  // rows that changed are rebuilt.
   last_visible_index_ = 0;
   for (size_t i = 0; i < static_cast<size_t>(child_count()); ++i) {
     SearchResultView* result_view = GetResultViewAt(i);
@@ -144,15 +146,29 @@ void SearchResultListView::ListItemsAdded(size_t start, size_t count) {
   ScheduleUpdate();
 }
 
-void SearchResultListView::ListItemsRemoved(size_t start, size_t count) {
+void SearchResultListView::ClearResultViews(size_t start, size_t count) {
   size_t last = std::min(start + count, static_cast<size_t>(child_count()));
   for (size_t i = start; i < last; ++i)
     GetResultViewAt(i)->ClearResultNoRepaint();
+}
+
+void SearchResultListView::ListItemsRemoved(size_t start, size_t count) {
+  ClearResultViews(start, count);
+  ScheduleUpdate();
+}
 
+void SearchResultListView::ListItemsMoved(size_t start,
+                                          size_t count,
+                                          size_t target) {
+  // Every result between the old and the new position changed index.
+  size_t first = std::min(start, target);
+  ClearResultViews(first, std::max(start, target) + count - first);
   ScheduleUpdate();
 }
 
 void SearchResultListView::ListItemsChanged(size_t start, size_t count) {
+  // The views only refresh results they weren't showing.
+  ClearResultViews(start, count);
   ScheduleUpdate();
 }
 
@@ -47,6 +47,10 @@ class SearchResultListView : public views::View,
   // pending call.
   void ScheduleUpdate();
 
+  // Clears the results of the views of the |count| results from |start|, so
+  // that the next Update refreshes them.
+  void ClearResultViews(size_t start, size_t count);
+
   // Overridden from views::ButtonListener:
   virtual void ButtonPressed(views::Button* sender,
                              const views::Event& event) OVERRIDE;
@@ -54,6 +58,8 @@ class SearchResultListView : public views::View,
   // Overridden from ListModelObserver:
   virtual void ListItemsAdded(size_t start, size_t count) OVERRIDE;
   virtual void ListItemsRemoved(size_t start, size_t count) OVERRIDE;
+  virtual void ListItemsMoved(size_t start, size_t count,
+                              size_t target) OVERRIDE;
   virtual void ListItemsChanged(size_t start, size_t count) OVERRIDE;
 
   SearchResultListViewDelegate* delegate_;  // Not owned.
@@ -103,6 +103,10 @@ SearchResultView::~SearchResultView() {
 }
 
 void SearchResultView::SetResult(SearchResult* result) {
+  // Results that stay in place as the list is updated are left as they are.
+  if (result == result_)
+    return;
+
   ClearResultNoRepaint();
 
   result_ = result;
@@ -37,7 +37,8 @@ class SearchResultView : public views::CustomButton,
                    views::ButtonListener* listener);
   virtual ~SearchResultView();
 
-  // Sets/gets SearchResult displayed by this view.
+  // Sets/gets SearchResult displayed by this view. Setting the result that is
+  // already displayed does nothing.
   void SetResult(SearchResult* result);
   const SearchResult* result() const { return result_; }
 
@@ -85,6 +85,8 @@
         'focus_change_observer.h',
         'focus_manager.cc',
         'focus_manager.h',
+        'input_latency_tracker.cc',
+        'input_latency_tracker.h',
         'layout_manager.cc',
         'layout_manager.h',
         'monitor_change_observer_x11.cc',
@@ -92,6 +94,8 @@
         'monitor_manager.cc',
         'monitor_manager.h',
         'root_window_host.h',
+        'root_window_host_headless.cc',
+        'root_window_host_headless.h',
         'root_window_host_linux.cc',
         'root_window_host_linux.h',
         'root_window_host_mac.h',
@@ -118,8 +122,11 @@
         'window.h',
         'window_delegate.h',
         'window_observer.h',
+        'window_cost_recorder.h',
         'window_tracker.cc',
         'window_tracker.h',
+        'window_tree_batch_update.cc',
+        'window_tree_batch_update.h',
         'x11_atom_cache.cc',
         'x11_atom_cache.h',
       ],
@@ -161,6 +168,10 @@
         'test/aura_test_helper.h',
         'test/event_generator.cc',
         'test/event_generator.h',
+        'test/event_recorder.cc',
+        'test/event_recorder.h',
+        'test/event_replayer.cc',
+        'test/event_replayer.h',
         'test/test_activation_client.cc',
         'test/test_activation_client.h',
         'test/test_aura_initializer.cc',
@@ -247,6 +258,7 @@
         '../ui.gyp:ui_resources',
         '../ui.gyp:ui_resources_standard',
         'aura',
+        'aura_test_support',
       ],
       'include_dirs': [
         '..',
@@ -288,6 +300,7 @@
         'shared/input_method_event_filter_unittest.cc',
         'event_filter_unittest.cc',
         'event_unittest.cc',
+        'input_latency_tracker_unittest.cc',
         'window_unittest.cc',
         '<(SHARED_INTERMEDIATE_DIR)/ui/ui_resources/ui_resources.rc',
         '<(SHARED_INTERMEDIATE_DIR)/ui/ui_resources_standard/ui_resources_standard.rc',
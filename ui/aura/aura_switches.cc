@@ -12,6 +12,10 @@ namespace switches {
 const char kAuraDisableMouseEventsFromTouch[] =
     "aura-disable-mouse-events-from-touch";
 
+// Hosts the root window without a native window or display, for running
+// compositing benchmarks on machines without X.
+const char kAuraHeadless[] = "aura-headless";
+
 // Initial dimensions for the host window in the form "1024x768".
 const char kAuraHostWindowSize[] = "aura-host-window-size";
 
@@ -12,6 +12,7 @@ namespace switches {
 
 // Please keep alphabetized.
 AURA_EXPORT extern const char kAuraDisableMouseEventsFromTouch[];
+AURA_EXPORT extern const char kAuraHeadless[];
 AURA_EXPORT extern const char kAuraHostWindowSize[];
 AURA_EXPORT extern const char kAuraHostWindowUseFullscreen[];
 
@@ -2,20 +2,36 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
 #include "base/at_exit.h"
 #include "base/bind.h"
 #include "base/command_line.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
 #include "base/i18n/icu_util.h"
+#include "base/json/json_writer.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/message_loop.h"
+#include "base/process_util.h"
 #include "base/string_split.h"
+#include "base/stringprintf.h"
 #include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "base/values.h"
 #include "third_party/skia/include/core/SkXfermode.h"
+#include "ui/aura/aura_switches.h"
 #include "ui/aura/env.h"
 #include "ui/aura/event.h"
 #include "ui/aura/root_window.h"
 #include "ui/aura/single_monitor_manager.h"
+#include "ui/aura/test/event_recorder.h"
+#include "ui/aura/test/event_replayer.h"
 #include "ui/aura/window.h"
+#include "ui/aura/window_delegate.h"
 #include "ui/base/hit_test.h"
 #include "ui/base/resource/resource_bundle.h"
 #include "ui/base/ui_base_paths.h"
@@ -25,8 +41,10 @@
 #include "ui/compositor/layer.h"
 #include "ui/compositor/test/compositor_test_support.h"
 #include "ui/gfx/canvas.h"
+#include "ui/gfx/font.h"
 #include "ui/gfx/rect.h"
 #include "ui/gfx/skia_util.h"
+#include "ui/gfx/transform.h"
 #include "third_party/khronos/GLES2/gl2.h"
 #ifndef GL_GLEXT_PROTOTYPES
 #define GL_GLEXT_PROTOTYPES 1
@@ -35,6 +53,8 @@
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebGraphicsContext3D.h"
 
 #if defined(USE_X11)
+#include <X11/Xlib.h>
+
 #include "base/message_pump_aurax11.h"
 #endif
 
@@ -83,33 +103,57 @@ class ColoredLayer : public Layer, public LayerDelegate {
 
 const int kFrames = 100;
 
-// Benchmark base class, hooks up drawing callback and displaying FPS.
+// Returns the |percentile|th percentile of |sorted_values|.
+double Percentile(const std::vector<double>& sorted_values,
+                  double percentile) {
+  if (sorted_values.empty())
+    return 0;
+  size_t index = static_cast<size_t>(
+      percentile / 100 * (sorted_values.size() - 1) + 0.5);
+  return sorted_values[std::min(index, sorted_values.size() - 1)];
+}
+
+// Benchmark base class, hooks up drawing callback and displaying FPS. When
+// the benchmark has run for the number of frames asked for, it reports the
+// frame times, the CPU time per frame, how it splits between the UI work and
+// the GPU work, and the memory used as JSON, on stdout or in the file given
+// with --json-output.
 class BenchCompositorObserver : public ui::CompositorObserver {
  public:
-  explicit BenchCompositorObserver(int max_frames)
-      : start_time_(),
+  BenchCompositorObserver(const std::string& name, int max_frames)
+      : name_(name),
+        start_time_(),
         frames_(0),
-        max_frames_(max_frames) {
+        max_frames_(max_frames),
+        process_metrics_(base::ProcessMetrics::CreateProcessMetrics(
+            base::GetCurrentProcessHandle())) {
   }
   virtual void OnCompositingStarted(Compositor* compositor) OVERRIDE {}
 
   virtual void OnCompositingEnded(Compositor* compositor) OVERRIDE {
+    TimeTicks now = TimeTicks::Now();
     if (start_time_.is_null()) {
-      start_time_ = TimeTicks::Now();
+      start_time_ = now;
+      first_frame_time_ = now;
+      // Starts measuring the CPU usage.
+      process_metrics_->GetCPUUsage();
     } else {
       ++frames_;
+      frame_times_ms_.push_back((now - last_frame_time_).InMillisecondsF());
+      const ui::FrameBreakdown& breakdown = compositor->last_frame_breakdown();
+      ui_time_ += breakdown.layout_time + breakdown.paint_time;
+      gpu_time_ += breakdown.composite_time + breakdown.swap_time;
       if (frames_ % kFrames == 0) {
-        TimeTicks now = TimeTicks::Now();
         double ms = (now - start_time_).InMillisecondsF() / kFrames;
         LOG(INFO) << "FPS: " << 1000.f / ms << " (" << ms << " ms)";
         start_time_ = now;
       }
     }
-    if (max_frames_ && frames_ == max_frames_) {
-      MessageLoop::current()->Quit();
-    } else {
+    last_frame_time_ = now;
+    if (max_frames_ && frames_ == max_frames_)
+      Finish();
+    else
       Draw();
-    }
   }
 
   virtual void OnCompositingAborted(Compositor* compositor) OVERRIDE {}
@@ -118,10 +162,78 @@ class BenchCompositorObserver : public ui::CompositorObserver {
 
   int frames() const { return frames_; }
 
+ protected:
+  // Adds the results particular to the benchmark to |report|.
+  virtual void AddToReport(DictionaryValue* report) {}
+
+  // Reports the results and quits.
+  void Finish() {
+    Report(TimeTicks::Now());
+    MessageLoop::current()->Quit();
+  }
+
  private:
+  void Report(TimeTicks now) {
+    double cpu_usage = process_metrics_->GetCPUUsage();
+    double total_ms = (now - first_frame_time_).InMillisecondsF();
+
+    std::vector<double> sorted_times(frame_times_ms_);
+    std::sort(sorted_times.begin(), sorted_times.end());
+    double sum = 0;
+    for (size_t i = 0; i < sorted_times.size(); ++i)
+      sum += sorted_times[i];
+
+    DictionaryValue* frame_time = new DictionaryValue;
+    frame_time->SetDouble("mean",
+                          frames_ ? sum / frames_ : 0);
+    frame_time->SetDouble("p50", Percentile(sorted_times, 50));
+    frame_time->SetDouble("p90", Percentile(sorted_times, 90));
+    frame_time->SetDouble("p99", Percentile(sorted_times, 99));
+    frame_time->SetDouble("max",
+                          sorted_times.empty() ? 0 : sorted_times.back());
+
+    DictionaryValue report;
+    report.SetString("benchmark", name_);
+    report.SetInteger("frames", frames_);
+    report.Set("frame_time_ms", frame_time);
+    report.SetDouble("cpu_ms_per_frame",
+                     frames_ ? cpu_usage / 100 * total_ms / frames_ : 0);
+    // Laying out and painting the layers is the UI's own CPU work; drawing
+    // them and swapping is the GPU's, or OSMesa's when headless.
+    report.SetDouble("ui_cpu_ms_per_frame",
+                     frames_ ? ui_time_.InMillisecondsF() / frames_ : 0);
+    report.SetDouble("gpu_ms_per_frame",
+                     frames_ ? gpu_time_.InMillisecondsF() / frames_ : 0);
+    report.SetDouble("working_set_bytes",
+                     process_metrics_->GetWorkingSetSize());
+    report.SetDouble("peak_working_set_bytes",
+                     process_metrics_->GetPeakWorkingSetSize());
+    AddToReport(&report);
+
+    std::string json;
+    base::JSONWriter::WriteWithOptions(
+        &report, base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+    FilePath output_path =
+        CommandLine::ForCurrentProcess()->GetSwitchValuePath("json-output");
+    if (output_path.empty()) {
+      printf("%s", json.c_str());
+      fflush(stdout);
+    } else if (file_util::WriteFile(output_path, json.data(), json.size()) !=
+               static_cast<int>(json.size())) {
+      LOG(ERROR) << "Could not write " << output_path.value();
+    }
+  }
+
+  std::string name_;
   TimeTicks start_time_;
+  TimeTicks first_frame_time_;
+  TimeTicks last_frame_time_;
   int frames_;
   int max_frames_;
+  std::vector<double> frame_times_ms_;
+  base::TimeDelta ui_time_;
+  base::TimeDelta gpu_time_;
+  scoped_ptr<base::ProcessMetrics> process_metrics_;
 
   DISALLOW_COPY_AND_ASSIGN(BenchCompositorObserver);
 };
@@ -156,7 +268,7 @@ class WebGLTexture : public ui::Texture {
 class WebGLBench : public BenchCompositorObserver {
  public:
   WebGLBench(Layer* parent, Compositor* compositor, int max_frames)
-      : BenchCompositorObserver(max_frames),
+      : BenchCompositorObserver("webgl", max_frames),
         parent_(parent),
         webgl_(ui::LAYER_TEXTURED),
         compositor_(compositor),
@@ -244,7 +356,7 @@ class SoftwareScrollBench : public BenchCompositorObserver {
   SoftwareScrollBench(ColoredLayer* layer,
                       Compositor* compositor,
                       int max_frames)
-      : BenchCompositorObserver(max_frames),
+      : BenchCompositorObserver("software_scroll", max_frames),
         layer_(layer),
         compositor_(compositor) {
     compositor->AddObserver(this);
@@ -269,6 +381,319 @@ class SoftwareScrollBench : public BenchCompositorObserver {
   DISALLOW_COPY_AND_ASSIGN(SoftwareScrollBench);
 };
 
+// A WindowDelegate that paints a color and, optionally, lines of text.
+class BenchWindowDelegate : public aura::WindowDelegate {
+ public:
+  BenchWindowDelegate(SkColor color, int text_lines)
+      : color_(color),
+        text_lines_(text_lines),
+        window_(NULL),
+        paint_on_input_(false) {
+  }
+
+  void set_window(aura::Window* window) { window_ = window; }
+
+  // Whether the window repaints itself for every input event it gets.
+  void set_paint_on_input(bool paint_on_input) {
+    paint_on_input_ = paint_on_input;
+  }
+
+  // Overridden from WindowDelegate:
+  virtual gfx::Size GetMinimumSize() const OVERRIDE {
+    return gfx::Size();
+  }
+  virtual void OnBoundsChanged(const gfx::Rect& old_bounds,
+                               const gfx::Rect& new_bounds) OVERRIDE {}
+  virtual void OnFocus(aura::Window* old_focused_window) OVERRIDE {}
+  virtual void OnBlur() OVERRIDE {}
+  virtual bool OnKeyEvent(aura::KeyEvent* event) OVERRIDE {
+    OnInput();
+    return false;
+  }
+  virtual gfx::NativeCursor GetCursor(const gfx::Point& point) OVERRIDE {
+    return gfx::kNullCursor;
+  }
+  virtual int GetNonClientComponent(const gfx::Point& point) const OVERRIDE {
+    return HTCLIENT;
+  }
+  virtual bool ShouldDescendIntoChildForEventHandling(
+      aura::Window* child,
+      const gfx::Point& location) OVERRIDE {
+    return true;
+  }
+  virtual bool OnMouseEvent(aura::MouseEvent* event) OVERRIDE {
+    OnInput();
+    return true;
+  }
+  virtual ui::TouchStatus OnTouchEvent(aura::TouchEvent* event) OVERRIDE {
+    OnInput();
+    return ui::TOUCH_STATUS_END;
+  }
+  virtual ui::GestureStatus OnGestureEvent(aura::GestureEvent* event) OVERRIDE {
+    return ui::GESTURE_STATUS_UNKNOWN;
+  }
+  virtual bool CanFocus() OVERRIDE { return false; }
+  virtual void OnCaptureLost() OVERRIDE {}
+  virtual void OnPaint(gfx::Canvas* canvas) OVERRIDE {
+    canvas->DrawColor(color_, SkXfermode::kSrc_Mode);
+    if (!text_lines_)
+      return;
+    const gfx::Font& font =
+        ResourceBundle::GetSharedInstance().GetFont(ResourceBundle::BaseFont);
+    int width = canvas->sk_canvas()->getDevice()->width();
+    for (int i = 0; i < text_lines_; ++i) {
+      canvas->DrawStringInt(
+          ASCIIToUTF16(base::StringPrintf(
+              "%d The quick brown fox jumps over the lazy dog.", i)),
+          font, SK_ColorBLACK, 0, i * font.GetHeight(), width,
+          font.GetHeight());
+    }
+  }
+  virtual void OnDeviceScaleFactorChanged(float device_scale_factor) OVERRIDE {}
+  virtual void OnWindowDestroying() OVERRIDE {}
+  virtual void OnWindowDestroyed() OVERRIDE {}
+  virtual void OnWindowVisibilityChanged(bool visible) OVERRIDE {}
+  virtual bool HasHitTestMask() const OVERRIDE { return false; }
+  virtual void GetHitTestMask(gfx::Path* mask) const OVERRIDE {}
+
+ private:
+  void OnInput() {
+    if (paint_on_input_ && window_)
+      window_->SchedulePaintInRect(gfx::Rect(window_->bounds().size()));
+  }
+
+  SkColor color_;
+  int text_lines_;
+  aura::Window* window_;
+  bool paint_on_input_;
+
+  DISALLOW_COPY_AND_ASSIGN(BenchWindowDelegate);
+};
+
+// Base class of the benchmarks that work on windows of the root window.
+class WindowBench : public BenchCompositorObserver {
+ public:
+  WindowBench(const std::string& name,
+              aura::RootWindow* root_window,
+              int max_frames)
+      : BenchCompositorObserver(name, max_frames),
+        root_window_(root_window),
+        paint_on_input_(false) {
+    root_window_->compositor()->AddObserver(this);
+  }
+
+  virtual ~WindowBench() {
+    root_window_->compositor()->RemoveObserver(this);
+  }
+
+ protected:
+  // Creates a shown window with |bounds| in the root window. Windows are
+  // colored after |index|, so that runs are reproducible.
+  aura::Window* CreateWindow(int index,
+                             const gfx::Rect& bounds,
+                             int text_lines) {
+    static const SkColor kColors[] = {
+      SK_ColorBLUE, SK_ColorGREEN, SK_ColorYELLOW, SK_ColorCYAN,
+      SK_ColorMAGENTA,
+    };
+    BenchWindowDelegate* delegate = new BenchWindowDelegate(
+        kColors[index % arraysize(kColors)], text_lines);
+    delegate->set_paint_on_input(paint_on_input_);
+    delegates_.push_back(delegate);
+    aura::Window* window = new aura::Window(delegate);
+    delegate->set_window(window);
+    window->Init(ui::LAYER_TEXTURED);
+    window->SetBounds(bounds);
+    window->Show();
+    root_window_->AddChild(window);
+    return window;
+  }
+
+  aura::RootWindow* root_window() { return root_window_; }
+
+  // Whether the windows created next repaint for every input event they get.
+  void set_paint_on_input(bool paint_on_input) {
+    paint_on_input_ = paint_on_input;
+  }
+
+ private:
+  aura::RootWindow* root_window_;
+  ScopedVector<BenchWindowDelegate> delegates_;
+  bool paint_on_input_;
+
+  DISALLOW_COPY_AND_ASSIGN(WindowBench);
+};
+
+// A benchmark that moves overlapping windows every frame.
+class AnimatingWindowsBench : public WindowBench {
+ public:
+  AnimatingWindowsBench(aura::RootWindow* root_window,
+                        int max_frames,
+                        int window_count)
+      : WindowBench("animating_windows", root_window, max_frames) {
+    for (int i = 0; i < window_count; ++i) {
+      windows_.push_back(CreateWindow(
+          i, gfx::Rect(20 * i, 15 * i, 400, 300), 0));
+    }
+  }
+
+  virtual void Draw() OVERRIDE {
+    for (size_t i = 0; i < windows_.size(); ++i) {
+      double phase = (frames() + 10 * i) * 2 * M_PI / kFrames;
+      ui::Transform transform;
+      transform.SetTranslate(100 * std::sin(phase), 100 * std::cos(phase));
+      windows_[i]->SetTransform(transform);
+    }
+  }
+
+ private:
+  ScopedVector<aura::Window> windows_;
+
+  DISALLOW_COPY_AND_ASSIGN(AnimatingWindowsBench);
+};
+
+// A benchmark that repaints windows full of text every frame.
+class TextPaintBench : public WindowBench {
+ public:
+  TextPaintBench(aura::RootWindow* root_window,
+                 int max_frames,
+                 int window_count)
+      : WindowBench("text_paint", root_window, max_frames) {
+    for (int i = 0; i < window_count; ++i) {
+      windows_.push_back(CreateWindow(
+          i, gfx::Rect(30 * i, 30 * i, 600, 500), 40));
+    }
+  }
+
+  virtual void Draw() OVERRIDE {
+    for (size_t i = 0; i < windows_.size(); ++i)
+      windows_[i]->SchedulePaintInRect(gfx::Rect(windows_[i]->bounds().size()));
+  }
+
+ private:
+  ScopedVector<aura::Window> windows_;
+
+  DISALLOW_COPY_AND_ASSIGN(TextPaintBench);
+};
+
+// A benchmark that replays mouse moves over windows through the native event
+// queue, a number of them every frame. Headless, there is no native event
+// queue and they are dispatched to the root window directly.
+class InputReplayBench : public WindowBench {
+ public:
+  InputReplayBench(aura::RootWindow* root_window,
+                   int max_frames,
+                   int window_count,
+                   int events_per_frame)
+      : WindowBench("input_replay", root_window, max_frames),
+        events_per_frame_(events_per_frame),
+        headless_(CommandLine::ForCurrentProcess()->HasSwitch(
+            switches::kAuraHeadless)) {
+    for (int i = 0; i < window_count; ++i) {
+      windows_.push_back(CreateWindow(
+          i, gfx::Rect(20 * i, 15 * i, 400, 300), 0));
+    }
+  }
+
+  virtual void Draw() OVERRIDE {
+    gfx::Size size = root_window()->bounds().size();
+    for (int i = 0; i < events_per_frame_; ++i) {
+      int step = frames() * events_per_frame_ + i;
+      gfx::Point location(step * 7 % std::max(1, size.width()),
+                          step * 5 % std::max(1, size.height()));
+#if defined(USE_X11)
+      if (!headless_) {
+        XEvent xevent = {0};
+        xevent.xmotion.type = MotionNotify;
+        xevent.xmotion.x = location.x();
+        xevent.xmotion.y = location.y();
+        root_window()->PostNativeEvent(&xevent);
+        continue;
+      }
+#endif
+      aura::MouseEvent event(ui::ET_MOUSE_MOVED, location, location, 0);
+      root_window()->DispatchMouseEvent(&event);
+    }
+    root_window()->compositor()->ScheduleDraw();
+  }
+
+ private:
+  ScopedVector<aura::Window> windows_;
+  int events_per_frame_;
+  bool headless_;
+
+  DISALLOW_COPY_AND_ASSIGN(InputReplayBench);
+};
+
+// A benchmark that creates windows every frame and destroys those of the
+// previous frame.
+class WindowChurnBench : public WindowBench {
+ public:
+  WindowChurnBench(aura::RootWindow* root_window,
+                   int max_frames,
+                   int windows_per_frame)
+      : WindowBench("window_churn", root_window, max_frames),
+        windows_per_frame_(windows_per_frame) {
+  }
+
+  virtual void Draw() OVERRIDE {
+    windows_.reset();
+    for (int i = 0; i < windows_per_frame_; ++i) {
+      windows_.push_back(CreateWindow(
+          i, gfx::Rect(10 * i, 10 * i, 200, 150), 0));
+    }
+  }
+
+ private:
+  ScopedVector<aura::Window> windows_;
+  int windows_per_frame_;
+
+  DISALLOW_COPY_AND_ASSIGN(WindowChurnBench);
+};
+
+// A benchmark that replays the events recorded with --record-events over
+// windows that repaint for every input event, and reports the time from the
+// dispatch of the inputs to the end of the frames showing them. It ends when
+// all the events have been replayed.
+class EventReplayBench : public WindowBench {
+ public:
+  EventReplayBench(aura::RootWindow* root_window,
+                   int window_count,
+                   const aura::test::RecordedEvents& events)
+      : WindowBench("event_replay", root_window, 0),
+        replayer_(root_window, events) {
+    set_paint_on_input(true);
+    for (int i = 0; i < window_count; ++i) {
+      windows_.push_back(CreateWindow(
+          i, gfx::Rect(20 * i, 15 * i, 400, 300), 0));
+    }
+    replayer_.Start(base::Bind(&EventReplayBench::Finish,
+                               base::Unretained(this)));
+  }
+
+ protected:
+  virtual void AddToReport(DictionaryValue* report) OVERRIDE {
+    DictionaryValue* latency = new DictionaryValue;
+    latency->SetInteger("inputs",
+                        static_cast<int>(replayer_.latencies().size()));
+    latency->SetDouble("p50",
+                       replayer_.GetLatencyPercentile(50).InMillisecondsF());
+    latency->SetDouble("p90",
+                       replayer_.GetLatencyPercentile(90).InMillisecondsF());
+    latency->SetDouble("p99",
+                       replayer_.GetLatencyPercentile(99).InMillisecondsF());
+    latency->SetDouble("max",
+                       replayer_.GetLatencyPercentile(100).InMillisecondsF());
+    report->Set("input_latency_ms", latency);
+  }
+
+ private:
+  ScopedVector<aura::Window> windows_;
+  aura::test::EventReplayer replayer_;
+
+  DISALLOW_COPY_AND_ASSIGN(EventReplayBench);
+};
+
 }  // anonymous namespace
 
 int main(int argc, char** argv) {
@@ -280,7 +705,23 @@ int main(int argc, char** argv) {
   icu_util::Initialize();
   ResourceBundle::InitSharedInstanceWithLocale("en-US", NULL);
 
-  MessageLoop message_loop(MessageLoop::TYPE_UI);
+  // With --headless, the benchmarks run without a display: the root window has
+  // no native window and the compositor draws offscreen with OSMesa, or with
+  // EGL pbuffers given --use-gl=egl.
+  CommandLine* command_line = CommandLine::ForCurrentProcess();
+  bool headless = command_line->HasSwitch("headless");
+  scoped_ptr<ui::HeadlessContextFactory> headless_context_factory;
+  if (headless) {
+    command_line->AppendSwitch(switches::kAuraHeadless);
+    headless_context_factory.reset(new ui::HeadlessContextFactory);
+    if (!headless_context_factory->Initialize())
+      return 1;
+    ui::ContextFactory::SetInstance(headless_context_factory.get());
+  }
+
+  // The UI message loop needs the X display.
+  MessageLoop message_loop(
+      headless ? MessageLoop::TYPE_DEFAULT : MessageLoop::TYPE_UI);
   ui::CompositorTestSupport::Initialize();
   aura::SingleMonitorManager* manager = new aura::SingleMonitorManager;
   manager->set_use_fullscreen_host_window(true);
@@ -299,7 +740,6 @@ int main(int argc, char** argv) {
 
   Layer content_layer(ui::LAYER_NOT_DRAWN);
 
-  CommandLine* command_line = CommandLine::ForCurrentProcess();
   bool force = command_line->HasSwitch("force-render-surface");
   content_layer.SetForceRenderSurface(force);
   gfx::Rect bounds(window.bounds().size());
@@ -312,12 +752,36 @@ int main(int argc, char** argv) {
   content_layer.Add(&page_background);
 
   int frames = atoi(command_line->GetSwitchValueASCII("frames").c_str());
+  int windows = 20;
+  if (command_line->HasSwitch("windows"))
+    windows = atoi(command_line->GetSwitchValueASCII("windows").c_str());
   scoped_ptr<BenchCompositorObserver> bench;
 
-  if (command_line->HasSwitch("bench-software-scroll")) {
+  std::string bench_name = command_line->GetSwitchValueASCII("bench");
+  if (command_line->HasSwitch("bench-software-scroll"))
+    bench_name = "software_scroll";
+  if (command_line->HasSwitch("replay-events"))
+    bench_name = "event_replay";
+  if (bench_name == "software_scroll") {
     bench.reset(new SoftwareScrollBench(&page_background,
                                         root_window->compositor(),
                                         frames));
+  } else if (bench_name == "animating_windows") {
+    bench.reset(new AnimatingWindowsBench(root_window.get(), frames, windows));
+  } else if (bench_name == "text_paint") {
+    bench.reset(new TextPaintBench(root_window.get(), frames, windows));
+  } else if (bench_name == "input_replay") {
+    bench.reset(new InputReplayBench(root_window.get(), frames, windows, 10));
+  } else if (bench_name == "window_churn") {
+    bench.reset(new WindowChurnBench(root_window.get(), frames, windows));
+  } else if (bench_name == "event_replay") {
+    aura::test::RecordedEvents events;
+    FilePath path = command_line->GetSwitchValuePath("replay-events");
+    if (!aura::test::ReadRecordedEvents(path, &events)) {
+      LOG(ERROR) << "Could not read events from " << path.value();
+      return 1;
+    }
+    bench.reset(new EventReplayBench(root_window.get(), windows, events));
   } else {
     bench.reset(new WebGLBench(&page_background,
                                root_window->compositor(),
@@ -328,8 +792,20 @@ int main(int argc, char** argv) {
   ui::PrintLayerHierarchy(root_window->layer(), gfx::Point(100, 100));
 #endif
 
+  // Records the events of the run, to replay them with --replay-events.
+  scoped_ptr<aura::test::EventRecorder> recorder;
+  FilePath record_path = command_line->GetSwitchValuePath("record-events");
+  if (!record_path.empty())
+    recorder.reset(new aura::test::EventRecorder(root_window.get()));
+
   root_window->ShowRootWindow();
-  MessageLoopForUI::current()->Run();
+  MessageLoop::current()->Run();
+  if (recorder.get() &&
+      !aura::test::WriteRecordedEvents(record_path, recorder->events())) {
+    LOG(ERROR) << "Could not write events to " << record_path.value();
+  }
+  recorder.reset();
+  bench.reset();
   root_window.reset();
 
   ui::CompositorTestSupport::Terminate();
@@ -14,9 +14,11 @@ DECLARE_EXPORTED_WINDOW_PROPERTY_TYPE(AURA_EXPORT, bool);
 namespace aura {
 namespace client {
 
-DEFINE_WINDOW_PROPERTY_KEY(
-    ActivationClient*, kRootWindowActivationClientKey, NULL);
-DEFINE_WINDOW_PROPERTY_KEY(bool, kHideOnDeactivate, false);
+DEFINE_WINDOW_PROPERTY_KEY_IN_SLOT(
+    ActivationClient*, kRootWindowActivationClientKey, NULL,
+    WINDOW_PROPERTY_SLOT_ACTIVATION_CLIENT);
+DEFINE_WINDOW_PROPERTY_KEY_IN_SLOT(bool, kHideOnDeactivate, false,
+                                   WINDOW_PROPERTY_SLOT_HIDE_ON_DEACTIVATE);
 
 void SetActivationClient(RootWindow* root_window, ActivationClient* client) {
   root_window->SetProperty(kRootWindowActivationClientKey, client);
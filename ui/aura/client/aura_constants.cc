@@ -18,16 +18,21 @@ namespace client {
 
 // Alphabetical sort.
 
-DEFINE_WINDOW_PROPERTY_KEY(bool, kAlwaysOnTopKey, false);
+DEFINE_WINDOW_PROPERTY_KEY_IN_SLOT(bool, kAlwaysOnTopKey, false,
+                                   WINDOW_PROPERTY_SLOT_ALWAYS_ON_TOP);
 DEFINE_WINDOW_PROPERTY_KEY(bool, kAnimationsDisabledKey, false);
 DEFINE_WINDOW_PROPERTY_KEY(bool, kDrawAttentionKey, false);
-DEFINE_WINDOW_PROPERTY_KEY(ui::ModalType, kModalKey, ui::MODAL_TYPE_NONE);
+DEFINE_WINDOW_PROPERTY_KEY_IN_SLOT(ui::ModalType, kModalKey,
+                                   ui::MODAL_TYPE_NONE,
+                                   WINDOW_PROPERTY_SLOT_MODAL);
 // gfx::Rect object for RestoreBoundsKey property is owned by the window
 // and will be freed automatically.
 DEFINE_OWNED_WINDOW_PROPERTY_KEY(gfx::Rect, kRestoreBoundsKey, NULL);
-DEFINE_WINDOW_PROPERTY_KEY(ui::InputMethod*, kRootWindowInputMethodKey, NULL);
-DEFINE_WINDOW_PROPERTY_KEY(
-    ui::WindowShowState, kShowStateKey, ui::SHOW_STATE_DEFAULT);
+DEFINE_WINDOW_PROPERTY_KEY_IN_SLOT(ui::InputMethod*, kRootWindowInputMethodKey,
+                                   NULL, WINDOW_PROPERTY_SLOT_INPUT_METHOD);
+DEFINE_WINDOW_PROPERTY_KEY_IN_SLOT(
+    ui::WindowShowState, kShowStateKey, ui::SHOW_STATE_DEFAULT,
+    WINDOW_PROPERTY_SLOT_SHOW_STATE);
 
 }  // namespace client
 }  // namespace aura
@@ -12,8 +12,9 @@ DECLARE_WINDOW_PROPERTY_TYPE(aura::client::CaptureClient*)
 namespace aura {
 namespace client {
 
-DEFINE_WINDOW_PROPERTY_KEY(
-    CaptureClient*, kRootWindowCaptureClientKey, NULL);
+DEFINE_WINDOW_PROPERTY_KEY_IN_SLOT(
+    CaptureClient*, kRootWindowCaptureClientKey, NULL,
+    WINDOW_PROPERTY_SLOT_CAPTURE_CLIENT);
 
 void SetCaptureClient(RootWindow* root_window, CaptureClient* client) {
   root_window->SetProperty(kRootWindowCaptureClientKey, client);
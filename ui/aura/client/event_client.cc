@@ -12,7 +12,9 @@ DECLARE_WINDOW_PROPERTY_TYPE(aura::client::EventClient*)
 namespace aura {
 namespace client {
 
-DEFINE_WINDOW_PROPERTY_KEY(EventClient*, kRootWindowEventClientKey, NULL);
+DEFINE_WINDOW_PROPERTY_KEY_IN_SLOT(
+    EventClient*, kRootWindowEventClientKey, NULL,
+    WINDOW_PROPERTY_SLOT_EVENT_CLIENT);
 
 void SetEventClient(RootWindow* root_window, EventClient* client) {
   root_window->SetProperty(kRootWindowEventClientKey, client);
@@ -4,6 +4,8 @@
 
 #include "ui/aura/env.h"
 
+#include "base/command_line.h"
+#include "ui/aura/aura_switches.h"
 #include "ui/aura/cursor_manager.h"
 #include "ui/aura/env_observer.h"
 #include "ui/aura/event_filter.h"
@@ -27,7 +29,9 @@ Env* Env::instance_ = NULL;
 Env::Env()
     : mouse_button_flags_(0),
       is_touch_down_(false),
-      stacking_client_(NULL) {
+      stacking_client_(NULL),
+      window_cost_recorder_(NULL),
+      event_filter_generation_(0) {
 }
 
 Env::~Env() {
@@ -61,12 +65,14 @@ void Env::SetMonitorManager(MonitorManager* monitor_manager) {
   monitor_manager_.reset(monitor_manager);
 #if defined(USE_X11)
   // Update the monitor manager with latest info.
-  monitor_change_observer_->NotifyDisplayChange();
+  if (monitor_change_observer_.get())
+    monitor_change_observer_->NotifyDisplayChange();
 #endif
 }
 
 void Env::SetEventFilter(EventFilter* event_filter) {
   event_filter_.reset(event_filter);
+  ++event_filter_generation_;
 }
 
 #if !defined(OS_MACOSX)
@@ -79,11 +85,15 @@ MessageLoop::Dispatcher* Env::GetDispatcher() {
 // Env, private:
 
 void Env::Init() {
-#if !defined(OS_MACOSX)
-  dispatcher_.reset(CreateDispatcher());
-#endif
 #if defined(USE_X11)
-  monitor_change_observer_.reset(new internal::MonitorChangeObserverX11);
+  // Both the dispatcher and the monitor observer talk to the X server, which a
+  // headless process doesn't have.
+  if (!CommandLine::ForCurrentProcess()->HasSwitch(switches::kAuraHeadless)) {
+    dispatcher_.reset(CreateDispatcher());
+    monitor_change_observer_.reset(new internal::MonitorChangeObserverX11);
+  }
+#elif !defined(OS_MACOSX)
+  dispatcher_.reset(CreateDispatcher());
 #endif
   ui::Compositor::Initialize(false);
 }
@@ -19,6 +19,7 @@ class EnvObserver;
 class EventFilter;
 class MonitorManager;
 class Window;
+class WindowCostRecorder;
 
 namespace internal {
 class MonitorChangeObserverX11;
@@ -56,6 +57,13 @@ class AURA_EXPORT Env {
     stacking_client_ = stacking_client;
   }
 
+  // The recorder of the time windows spend painting and handling events, or
+  // NULL, in which case they aren't timed. Not owned.
+  WindowCostRecorder* window_cost_recorder() { return window_cost_recorder_; }
+  void set_window_cost_recorder(WindowCostRecorder* recorder) {
+    window_cost_recorder_ = recorder;
+  }
+
   // Gets/sets MonitorManager. The MonitorManager's ownership is
   // transfered.
   MonitorManager* monitor_manager() { return monitor_manager_.get(); }
@@ -65,6 +73,10 @@ class AURA_EXPORT Env {
   EventFilter* event_filter() { return event_filter_.get(); }
   void SetEventFilter(EventFilter* event_filter);
 
+  // Changes whenever an event filter is set or a window changes parents, so
+  // that the filters found above a window can be kept until it does.
+  int event_filter_generation() const { return event_filter_generation_; }
+
   CursorManager* cursor_manager() { return &cursor_manager_; }
 
   // Returns the native event dispatcher. The result should only be passed to
@@ -83,6 +95,13 @@ class AURA_EXPORT Env {
   // Called by the Window when it is initialized. Notifies observers.
   void NotifyWindowInitialized(Window* window);
 
+  // Called by the Window when its event filter or its parent changes. Windows
+  // may outlive the Env, so this doesn't create one.
+  static void EventFiltersChanged() {
+    if (instance_)
+      ++instance_->event_filter_generation_;
+  }
+
   ObserverList<EnvObserver> observers_;
 #if !defined(OS_MACOSX)
   scoped_ptr<MessageLoop::Dispatcher> dispatcher_;
@@ -92,8 +111,10 @@ class AURA_EXPORT Env {
   int mouse_button_flags_;
   bool is_touch_down_;
   client::StackingClient* stacking_client_;
+  WindowCostRecorder* window_cost_recorder_;
   scoped_ptr<MonitorManager> monitor_manager_;
   scoped_ptr<EventFilter> event_filter_;
+  int event_filter_generation_;
   CursorManager cursor_manager_;
 
 #if defined(USE_X11)
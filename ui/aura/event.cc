@@ -262,7 +262,14 @@ TouchEvent::TouchEvent(const TouchEvent& model,
       radius_x_(model.radius_x_),
       radius_y_(model.radius_y_),
       rotation_angle_(model.rotation_angle_),
-      force_(model.force_) {
+      force_(model.force_),
+      coalesced_moves_(model.coalesced_moves_) {
+  // The earlier moves are converted to the coordinates of |target| the way
+  // the location is.
+  int dx = location().x() - model.location().x();
+  int dy = location().y() - model.location().y();
+  for (size_t i = 0; i < coalesced_moves_.size(); ++i)
+    coalesced_moves_[i].location.Offset(dx, dy);
 }
 
 TouchEvent::TouchEvent(ui::EventType type,
@@ -281,8 +288,26 @@ TouchEvent::TouchEvent(ui::EventType type,
 TouchEvent::~TouchEvent() {
 }
 
+void TouchEvent::MergeEarlierMove(const TouchEvent& earlier) {
+  DCHECK_EQ(ui::ET_TOUCH_MOVED, type());
+  DCHECK_EQ(ui::ET_TOUCH_MOVED, earlier.type());
+  DCHECK_EQ(touch_id_, earlier.touch_id_);
+  std::vector<CoalescedMove> moves(earlier.coalesced_moves_);
+  CoalescedMove move;
+  move.location = earlier.location();
+  move.time_stamp = earlier.time_stamp();
+  moves.push_back(move);
+  moves.insert(moves.end(), coalesced_moves_.begin(), coalesced_moves_.end());
+  coalesced_moves_.swap(moves);
+}
+
 void TouchEvent::UpdateForRootTransform(const ui::Transform& root_transform) {
   LocatedEvent::UpdateForRootTransform(root_transform);
+  for (size_t i = 0; i < coalesced_moves_.size(); ++i) {
+    gfx::Point3f p(coalesced_moves_[i].location);
+    root_transform.TransformPointReverse(p);
+    coalesced_moves_[i].location = p.AsPoint();
+  }
   gfx::Point3f scale;
   ui::InterpolatedTransform::FactorTRS(root_transform, NULL, NULL, &scale);
   if (scale.x())
@@ -327,6 +352,18 @@ float TouchEvent::Force() const {
   return force_;
 }
 
+int TouchEvent::GetCoalescedMoveCount() const {
+  return static_cast<int>(coalesced_moves_.size());
+}
+
+gfx::Point TouchEvent::GetCoalescedMoveLocation(int index) const {
+  return coalesced_moves_[index].location;
+}
+
+base::TimeDelta TouchEvent::GetCoalescedMoveTimestamp(int index) const {
+  return coalesced_moves_[index].time_stamp;
+}
+
 KeyEvent::KeyEvent(const base::NativeEvent& native_event, bool is_char)
     : Event(native_event,
             ui::EventTypeFromNative(native_event),
@@ -6,6 +6,8 @@
 #define UI_AURA_EVENT_H_
 #pragma once
 
+#include <vector>
+
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
 #include "base/event_types.h"
@@ -210,6 +212,10 @@ class AURA_EXPORT TouchEvent : public LocatedEvent,
   void set_radius_x(const float r) { radius_x_ = r; }
   void set_radius_y(const float r) { radius_y_ = r; }
 
+  // Merges |earlier|, a move of the same touch that was not dispatched, into
+  // this move, keeping its points for GetCoalescedMove*().
+  void MergeEarlierMove(const TouchEvent& earlier);
+
   // Overridden from LocatedEvent.
   virtual void UpdateForRootTransform(
       const ui::Transform& root_transform) OVERRIDE;
@@ -224,8 +230,16 @@ class AURA_EXPORT TouchEvent : public LocatedEvent,
   virtual float RadiusY() const OVERRIDE;
   virtual float RotationAngle() const OVERRIDE;
   virtual float Force() const OVERRIDE;
+  virtual int GetCoalescedMoveCount() const OVERRIDE;
+  virtual gfx::Point GetCoalescedMoveLocation(int index) const OVERRIDE;
+  virtual base::TimeDelta GetCoalescedMoveTimestamp(int index) const OVERRIDE;
 
  private:
+  struct CoalescedMove {
+    gfx::Point location;
+    base::TimeDelta time_stamp;
+  };
+
   // The identity (typically finger) of the touch starting at 0 and incrementing
   // for each separable additional touch that the hardware can detect.
   const int touch_id_;
@@ -242,6 +256,9 @@ class AURA_EXPORT TouchEvent : public LocatedEvent,
   // Force (pressure) of the touch. Normalized to be [0, 1]. Default to be 0.0.
   const float force_;
 
+  // The earlier moves merged into this one, oldest first.
+  std::vector<CoalescedMove> coalesced_moves_;
+
   DISALLOW_COPY_AND_ASSIGN(TouchEvent);
 };
 
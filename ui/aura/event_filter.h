@@ -32,8 +32,22 @@ class Window;
 // chance to prevent further processing of the event and/or take other actions.
 class AURA_EXPORT EventFilter {
  public:
+  // The kinds of events a filter pre-handles, as bits of handled_events().
+  enum EventKind {
+    KEY_EVENTS = 1 << 0,
+    MOUSE_EVENTS = 1 << 1,
+    TOUCH_EVENTS = 1 << 2,
+    GESTURE_EVENTS = 1 << 3,
+    ALL_EVENTS = KEY_EVENTS | MOUSE_EVENTS | TOUCH_EVENTS | GESTURE_EVENTS,
+  };
+
+  EventFilter() : handled_events_(ALL_EVENTS) {}
   virtual ~EventFilter() {}
 
+  // The EventKinds the filter pre-handles. Events of the other kinds are not
+  // sent to the filter, as if it had not consumed them.
+  int handled_events() const { return handled_events_; }
+
   // Parameters: a |target| Window and the |event|. The target window is the
   // window the event was targeted at. If |event| is a LocatedEvent, its
   // coordinates are relative to |target|.
@@ -57,6 +71,16 @@ class AURA_EXPORT EventFilter {
   // consumed.
   virtual ui::GestureStatus PreHandleGestureEvent(Window* target,
                                                   GestureEvent* event) = 0;
+
+ protected:
+  // Filters that only pre-handle some kinds of events set them here, usually
+  // from their constructor.
+  void set_handled_events(int handled_events) {
+    handled_events_ = handled_events;
+  }
+
+ private:
+  int handled_events_;
 };
 
 }  // namespace aura
@@ -112,5 +112,27 @@ TEST(EventTest, Repeated) {
   EXPECT_FALSE(MouseEvent::IsRepeatedClickEvent(mouse_ev1, mouse_ev2));
 }
 
+TEST(EventTest, MergeEarlierMove) {
+  base::TimeDelta start = base::TimeDelta::FromMilliseconds(0);
+  TouchEvent move1(ui::ET_TOUCH_MOVED, gfx::Point(10, 10), 0, start);
+  TouchEvent move2(ui::ET_TOUCH_MOVED, gfx::Point(20, 10), 0,
+                   start + base::TimeDelta::FromMilliseconds(1));
+  TouchEvent move3(ui::ET_TOUCH_MOVED, gfx::Point(30, 10), 0,
+                   start + base::TimeDelta::FromMilliseconds(2));
+  move2.MergeEarlierMove(move1);
+  move3.MergeEarlierMove(move2);
+
+  ASSERT_EQ(2, move3.GetCoalescedMoveCount());
+  EXPECT_EQ(gfx::Point(10, 10), move3.GetCoalescedMoveLocation(0));
+  EXPECT_EQ(start, move3.GetCoalescedMoveTimestamp(0));
+  EXPECT_EQ(gfx::Point(20, 10), move3.GetCoalescedMoveLocation(1));
+  EXPECT_EQ(gfx::Point(30, 10), move3.location());
+
+  // The merged moves follow the event into other coordinates.
+  TouchEvent copy(move3, NULL, NULL);
+  ASSERT_EQ(2, copy.GetCoalescedMoveCount());
+  EXPECT_EQ(gfx::Point(20, 10), copy.GetCoalescedMoveLocation(1));
+}
+
 }  // namespace test
 }  // namespace aura
@@ -211,11 +211,14 @@ class QueueTouchEventDelegate : public GestureEventConsumeDelegate {
  public:
   explicit QueueTouchEventDelegate(RootWindow* root_window)
       : window_(NULL),
-        root_window_(root_window) {
+        root_window_(root_window),
+        queue_events_(true) {
   }
   virtual ~QueueTouchEventDelegate() {}
 
   virtual ui::TouchStatus OnTouchEvent(TouchEvent* event) OVERRIDE {
+    if (!queue_events_)
+      return ui::TOUCH_STATUS_UNKNOWN;
     return event->type() == ui::ET_TOUCH_RELEASED ?
         ui::TOUCH_STATUS_QUEUED_END : ui::TOUCH_STATUS_QUEUED;
   }
@@ -229,10 +232,12 @@ class QueueTouchEventDelegate : public GestureEventConsumeDelegate {
   }
 
   void set_window(Window* w) { window_ = w; }
+  void set_queue_events(bool queue) { queue_events_ = queue; }
 
  private:
   Window* window_;
   RootWindow* root_window_;
+  bool queue_events_;
 
   DISALLOW_COPY_AND_ASSIGN(QueueTouchEventDelegate);
 };
@@ -1419,6 +1424,53 @@ TEST_F(GestureRecognizerTest, AsynchronousGestureRecognition) {
   EXPECT_FALSE(queued_delegate->pinch_end());
 }
 
+// Tests that touches handled right away, while earlier touches of the same
+// window wait to be acknowledged, are recognized in order once those are.
+TEST_F(GestureRecognizerTest, AsynchronousGestureRecognitionKeepsOrder) {
+  scoped_ptr<QueueTouchEventDelegate> queued_delegate(
+      new QueueTouchEventDelegate(root_window()));
+  const int kTouchId = 6;
+  gfx::Rect bounds(100, 200, 123, 45);
+  scoped_ptr<aura::Window> queue(CreateTestWindowWithDelegate(
+      queued_delegate.get(), -1234, bounds, NULL));
+  queued_delegate->set_window(queue.get());
+
+  // Only the press waits for an acknowledgement.
+  queued_delegate->Reset();
+  TouchEvent press(ui::ET_TOUCH_PRESSED, gfx::Point(101, 201),
+                   kTouchId, GetTime());
+  root_window()->DispatchTouchEvent(&press);
+  EXPECT_FALSE(queued_delegate->tap_down());
+  EXPECT_FALSE(queued_delegate->begin());
+
+  // The release is handled right away, but isn't recognized before the press.
+  queued_delegate->set_queue_events(false);
+  TouchEvent release(ui::ET_TOUCH_RELEASED, gfx::Point(101, 201),
+                     kTouchId, press.time_stamp() +
+                     base::TimeDelta::FromMilliseconds(50));
+  root_window()->DispatchTouchEvent(&release);
+  EXPECT_FALSE(queued_delegate->tap());
+  EXPECT_FALSE(queued_delegate->tap_down());
+  EXPECT_FALSE(queued_delegate->begin());
+  EXPECT_FALSE(queued_delegate->end());
+
+  // Acknowledging the press recognizes both touches.
+  queued_delegate->ReceivedAck();
+  EXPECT_TRUE(queued_delegate->tap_down());
+  EXPECT_TRUE(queued_delegate->begin());
+  EXPECT_TRUE(queued_delegate->tap());
+  EXPECT_TRUE(queued_delegate->end());
+  EXPECT_FALSE(queued_delegate->scroll_begin());
+
+  // With the queue empty, touches handled right away are recognized at once.
+  queued_delegate->Reset();
+  TouchEvent press2(ui::ET_TOUCH_PRESSED, gfx::Point(101, 201),
+                    kTouchId, GetTime());
+  root_window()->DispatchTouchEvent(&press2);
+  EXPECT_TRUE(queued_delegate->tap_down());
+  EXPECT_TRUE(queued_delegate->begin());
+}
+
 // Check that appropriate touch events generate pinch gesture events.
 TEST_F(GestureRecognizerTest, GestureEventPinchFromScroll) {
   scoped_ptr<GestureEventConsumeDelegate> delegate(
@@ -0,0 +1,98 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/aura/input_latency_tracker.h"
+
+#include "base/debug/trace_event.h"
+#include "base/logging.h"
+#include "ui/aura/event.h"
+
+namespace aura {
+
+InputLatencyTracker::Input::Input()
+    : id(0),
+      type(ui::ET_UNKNOWN),
+      frame(-1) {
+}
+
+InputLatencyTracker::InputLatencyTracker()
+    : dispatch_depth_(0),
+      draw_scheduled_(false),
+      next_input_id_(0) {
+}
+
+InputLatencyTracker::~InputLatencyTracker() {
+  for (size_t i = 0; i < inputs_.size(); ++i)
+    TRACE_EVENT_ASYNC_END0("ui", "InputLatency", inputs_[i].id);
+}
+
+void InputLatencyTracker::AddObserver(Observer* observer) {
+  observers_.AddObserver(observer);
+}
+
+void InputLatencyTracker::RemoveObserver(Observer* observer) {
+  observers_.RemoveObserver(observer);
+}
+
+void InputLatencyTracker::OnDispatchStarted(const Event& event) {
+  if (dispatch_depth_++)
+    return;
+  dispatched_input_.id = next_input_id_++;
+  dispatched_input_.type = event.type();
+  dispatched_input_.start_time = base::TimeTicks::Now();
+  dispatched_input_.frame = -1;
+  draw_scheduled_ = false;
+  FOR_EACH_OBSERVER(Observer, observers_, OnInputStarted(event));
+}
+
+void InputLatencyTracker::OnDispatchEnded() {
+  DCHECK_GT(dispatch_depth_, 0);
+  if (--dispatch_depth_ || !draw_scheduled_)
+    return;
+  TRACE_EVENT_ASYNC_BEGIN1("ui", "InputLatency", dispatched_input_.id,
+                           "type", static_cast<int>(dispatched_input_.type));
+  AddPendingInput(dispatched_input_);
+}
+
+void InputLatencyTracker::OnDrawScheduled() {
+  if (dispatch_depth_)
+    draw_scheduled_ = true;
+}
+
+void InputLatencyTracker::OnFrameStarted(int frame) {
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    if (inputs_[i].frame == -1)
+      inputs_[i].frame = frame;
+  }
+}
+
+void InputLatencyTracker::OnFrameEnded(int frame) {
+  base::TimeTicks now = base::TimeTicks::Now();
+  // Frames end in the order they started, so the inputs they show are the
+  // oldest ones.
+  while (!inputs_.empty() &&
+         inputs_.front().frame != -1 && inputs_.front().frame <= frame) {
+    Input input = inputs_.front();
+    inputs_.pop_front();
+    TRACE_EVENT_ASYNC_END0("ui", "InputLatency", input.id);
+    FOR_EACH_OBSERVER(Observer, observers_,
+                      OnInputLatency(input.type, now - input.start_time));
+  }
+}
+
+void InputLatencyTracker::OnFrameAborted() {
+  // The inputs of the aborted frame wait for the next one.
+  for (size_t i = 0; i < inputs_.size(); ++i)
+    inputs_[i].frame = -1;
+}
+
+void InputLatencyTracker::AddPendingInput(const Input& input) {
+  if (inputs_.size() == kMaxPendingInputs) {
+    TRACE_EVENT_ASYNC_END0("ui", "InputLatency", inputs_.front().id);
+    inputs_.pop_front();
+  }
+  inputs_.push_back(input);
+}
+
+}  // namespace aura
@@ -0,0 +1,105 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_AURA_INPUT_LATENCY_TRACKER_H_
+#define UI_AURA_INPUT_LATENCY_TRACKER_H_
+#pragma once
+
+#include <deque>
+
+#include "base/basictypes.h"
+#include "base/observer_list.h"
+#include "base/time.h"
+#include "ui/aura/aura_export.h"
+#include "ui/base/events.h"
+
+namespace aura {
+
+class Event;
+
+// InputLatencyTracker measures how long the input events of a RootWindow take
+// to reach the screen. Each input is stamped when the RootWindow starts
+// dispatching it. If a draw is scheduled while it is dispatched, the input
+// waits for the next frame the compositor starts, and its latency is known
+// when that frame ends. Inputs that don't schedule a draw have no visible
+// effect and aren't measured.
+//
+// Events dispatched while another one is (gestures made of touches, events
+// synthesized by handlers) are part of the outer input.
+class AURA_EXPORT InputLatencyTracker {
+ public:
+  class AURA_EXPORT Observer {
+   public:
+    // Invoked when the RootWindow starts dispatching an input.
+    virtual void OnInputStarted(const Event& event) {}
+
+    // Invoked when the frame showing the effects of an input of |type| has
+    // ended, |latency| after the input was stamped.
+    virtual void OnInputLatency(ui::EventType type,
+                                base::TimeDelta latency) {}
+
+   protected:
+    virtual ~Observer() {}
+  };
+
+  InputLatencyTracker();
+  ~InputLatencyTracker();
+
+  void AddObserver(Observer* observer);
+  void RemoveObserver(Observer* observer);
+
+  // Invoked by the RootWindow when dispatching |event| starts and ends.
+  void OnDispatchStarted(const Event& event);
+  void OnDispatchEnded();
+
+  // Invoked by the RootWindow when a draw is scheduled.
+  void OnDrawScheduled();
+
+  // Invoked by the RootWindow when the compositor starts and ends drawing
+  // |frame|, or aborts the frame it was drawing.
+  void OnFrameStarted(int frame);
+  void OnFrameEnded(int frame);
+  void OnFrameAborted();
+
+  // Returns the number of inputs whose frame hasn't ended yet.
+  size_t pending_input_count() const { return inputs_.size(); }
+
+ private:
+  struct Input {
+    Input();
+
+    // Identifies the input in traces.
+    int id;
+    ui::EventType type;
+    base::TimeTicks start_time;
+    // The frame showing the input, or -1 while it waits for a frame to start.
+    int frame;
+  };
+
+  // Inputs kept waiting at most: beyond, frames are not ending and the oldest
+  // inputs are dropped.
+  static const size_t kMaxPendingInputs = 64;
+
+  // Adds |input| to the inputs waiting for a frame.
+  void AddPendingInput(const Input& input);
+
+  // The inputs waiting for a frame or for their frame to end, oldest first.
+  std::deque<Input> inputs_;
+
+  // The outermost input being dispatched, if |dispatch_depth_| > 0.
+  Input dispatched_input_;
+  int dispatch_depth_;
+  // Whether a draw was scheduled while dispatching |dispatched_input_|.
+  bool draw_scheduled_;
+
+  int next_input_id_;
+
+  ObserverList<Observer> observers_;
+
+  DISALLOW_COPY_AND_ASSIGN(InputLatencyTracker);
+};
+
+}  // namespace aura
+
+#endif  // UI_AURA_INPUT_LATENCY_TRACKER_H_
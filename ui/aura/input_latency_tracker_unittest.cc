@@ -0,0 +1,116 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/aura/input_latency_tracker.h"
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/aura/event.h"
+
+namespace aura {
+namespace test {
+
+namespace {
+
+// Remembers the types of the inputs it is told the latency of.
+class TestObserver : public InputLatencyTracker::Observer {
+ public:
+  TestObserver() : started_count_(0) {}
+  virtual ~TestObserver() {}
+
+  int started_count() const { return started_count_; }
+  const std::vector<ui::EventType>& types() const { return types_; }
+
+  // Overridden from InputLatencyTracker::Observer:
+  virtual void OnInputStarted(const Event& event) OVERRIDE {
+    ++started_count_;
+  }
+  virtual void OnInputLatency(ui::EventType type,
+                              base::TimeDelta latency) OVERRIDE {
+    EXPECT_GE(latency.InMicroseconds(), 0);
+    types_.push_back(type);
+  }
+
+ private:
+  int started_count_;
+  std::vector<ui::EventType> types_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestObserver);
+};
+
+}  // namespace
+
+// Inputs that schedule a draw are measured when the next frame ends.
+TEST(InputLatencyTrackerTest, MeasuresInputsThatDraw) {
+  InputLatencyTracker tracker;
+  TestObserver observer;
+  tracker.AddObserver(&observer);
+
+  KeyEvent key(ui::ET_KEY_PRESSED, ui::VKEY_A, 0);
+  tracker.OnDispatchStarted(key);
+  tracker.OnDrawScheduled();
+  tracker.OnDispatchEnded();
+
+  // Inputs that don't draw aren't measured, nor are draws outside inputs.
+  KeyEvent release(ui::ET_KEY_RELEASED, ui::VKEY_A, 0);
+  tracker.OnDispatchStarted(release);
+  tracker.OnDispatchEnded();
+  tracker.OnDrawScheduled();
+  EXPECT_EQ(2, observer.started_count());
+  EXPECT_EQ(1u, tracker.pending_input_count());
+
+  // The frame already being drawn doesn't show the input.
+  tracker.OnFrameEnded(0);
+  EXPECT_TRUE(observer.types().empty());
+
+  tracker.OnFrameStarted(1);
+  MouseEvent move(ui::ET_MOUSE_MOVED, gfx::Point(), gfx::Point(), 0);
+  tracker.OnDispatchStarted(move);
+  tracker.OnDrawScheduled();
+  tracker.OnDispatchEnded();
+  tracker.OnFrameEnded(1);
+  ASSERT_EQ(1u, observer.types().size());
+  EXPECT_EQ(ui::ET_KEY_PRESSED, observer.types()[0]);
+
+  // The move waits for the next frame, and for another one if it aborts.
+  tracker.OnFrameStarted(2);
+  tracker.OnFrameAborted();
+  tracker.OnFrameStarted(3);
+  tracker.OnFrameEnded(3);
+  ASSERT_EQ(2u, observer.types().size());
+  EXPECT_EQ(ui::ET_MOUSE_MOVED, observer.types()[1]);
+  EXPECT_EQ(0u, tracker.pending_input_count());
+
+  tracker.RemoveObserver(&observer);
+}
+
+// Events dispatched while dispatching another are part of it.
+TEST(InputLatencyTrackerTest, NestedDispatches) {
+  InputLatencyTracker tracker;
+  TestObserver observer;
+  tracker.AddObserver(&observer);
+
+  TouchEvent touch(ui::ET_TOUCH_PRESSED, gfx::Point(), 0, base::TimeDelta());
+  MouseEvent press(ui::ET_MOUSE_PRESSED, gfx::Point(), gfx::Point(), 0);
+  tracker.OnDispatchStarted(touch);
+  tracker.OnDispatchStarted(press);
+  tracker.OnDrawScheduled();
+  tracker.OnDispatchEnded();
+  EXPECT_EQ(0u, tracker.pending_input_count());
+  tracker.OnDispatchEnded();
+  EXPECT_EQ(1, observer.started_count());
+
+  tracker.OnFrameStarted(1);
+  tracker.OnFrameEnded(1);
+  ASSERT_EQ(1u, observer.types().size());
+  EXPECT_EQ(ui::ET_TOUCH_PRESSED, observer.types()[0]);
+
+  tracker.RemoveObserver(&observer);
+}
+
+}  // namespace test
+}  // namespace aura
@@ -4,6 +4,7 @@
 
 #include "ui/aura/root_window.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "base/bind.h"
@@ -19,10 +20,12 @@
 #include "ui/aura/event.h"
 #include "ui/aura/event_filter.h"
 #include "ui/aura/focus_manager.h"
+#include "ui/aura/input_latency_tracker.h"
 #include "ui/aura/monitor_manager.h"
 #include "ui/aura/root_window_host.h"
 #include "ui/aura/root_window_observer.h"
 #include "ui/aura/window.h"
+#include "ui/aura/window_cost_recorder.h"
 #include "ui/aura/window_delegate.h"
 #include "ui/base/gestures/gesture_recognizer.h"
 #include "ui/base/gestures/gesture_types.h"
@@ -67,6 +70,9 @@ bool IsNonClientLocation(Window* target, const gfx::Point& location) {
 
 typedef std::vector<EventFilter*> EventFilters;
 
+// How many windows the event filter chains are kept for.
+const size_t kEventFilterChainCacheSize = 8;
+
 void GetEventFiltersToNotify(Window* target, EventFilters* filters) {
   while (target) {
     if (target->event_filter())
@@ -87,6 +93,51 @@ Window* ConsumerToWindow(ui::GestureConsumer* consumer) {
       static_cast<Window*>(consumer) : NULL;
 }
 
+// Tells an InputLatencyTracker that an event is being dispatched while in
+// scope.
+class ScopedInputDispatch {
+ public:
+  ScopedInputDispatch(InputLatencyTracker* tracker, const Event& event)
+      : tracker_(tracker) {
+    tracker_->OnDispatchStarted(event);
+  }
+
+  ~ScopedInputDispatch() {
+    tracker_->OnDispatchEnded();
+  }
+
+ private:
+  InputLatencyTracker* tracker_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedInputDispatch);
+};
+
+// Reports the time the delegate of a window takes to handle an event while in
+// scope, if the Env has a WindowCostRecorder.
+class ScopedEventCost {
+ public:
+  explicit ScopedEventCost(Window* window)
+      : window_(window),
+        recorder_(Env::GetInstance()->window_cost_recorder()) {
+    if (recorder_)
+      start_ = base::TimeTicks::HighResNow();
+  }
+
+  ~ScopedEventCost() {
+    if (recorder_) {
+      recorder_->OnWindowHandledEvent(
+          window_, base::TimeTicks::HighResNow() - start_);
+    }
+  }
+
+ private:
+  Window* window_;
+  WindowCostRecorder* recorder_;
+  base::TimeTicks start_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedEventCost);
+};
+
 }  // namespace
 
 CompositorLock::CompositorLock(RootWindow* root_window)
@@ -131,8 +182,12 @@ RootWindow::RootWindow(const gfx::Rect& initial_bounds)
       defer_draw_scheduling_(false),
       mouse_move_hold_count_(0),
       ALLOW_THIS_IN_INITIALIZER_LIST(held_mouse_event_factory_(this)),
+      ALLOW_THIS_IN_INITIALIZER_LIST(queued_moves_factory_(this)),
       compositor_lock_(NULL),
-      draw_on_compositor_unlock_(false) {
+      draw_on_compositor_unlock_(false),
+      input_latency_tracker_(new InputLatencyTracker),
+      event_filter_chains_(kEventFilterChainCacheSize),
+      event_filter_chains_generation_(-1) {
   SetName("RootWindow");
 
   compositor_.reset(new ui::Compositor(this, host_->GetAcceleratedWidget()));
@@ -184,6 +239,7 @@ void RootWindow::ShowRootWindow() {
 }
 
 void RootWindow::SetHostSize(const gfx::Size& size_in_pixel) {
+  DispatchQueuedMoves();
   DispatchHeldMouseMove();
   gfx::Rect bounds = host_->GetBounds();
   bounds.set_size(size_in_pixel);
@@ -199,6 +255,7 @@ gfx::Size RootWindow::GetHostSize() const {
 }
 
 void RootWindow::SetHostBounds(const gfx::Rect& bounds_in_pixel) {
+  DispatchQueuedMoves();
   DispatchHeldMouseMove();
   host_->SetBounds(bounds_in_pixel);
   // Requery the location to constrain it within the new root window size.
@@ -239,6 +296,7 @@ bool RootWindow::ConfineCursorToWindow() {
 }
 
 void RootWindow::Draw() {
+  DispatchQueuedMoves();
   defer_draw_scheduling_ = false;
   if (waiting_on_compositing_end_) {
     draw_on_compositing_end_ = true;
@@ -252,6 +310,8 @@ void RootWindow::Draw() {
 
   TRACE_EVENT_ASYNC_BEGIN0("ui", "RootWindow::Draw",
                            compositor_->last_started_frame() + 1);
+  input_latency_tracker_->OnFrameStarted(
+      compositor_->last_started_frame() + 1);
 
   compositor_->Draw(false);
 }
@@ -261,6 +321,7 @@ void RootWindow::ScheduleFullDraw() {
 }
 
 bool RootWindow::DispatchMouseEvent(MouseEvent* event) {
+  DispatchQueuedMoves();
   if (event->type() == ui::ET_MOUSE_DRAGGED ||
       (event->flags() & ui::EF_IS_SYNTHESIZED)) {
     if (mouse_move_hold_count_) {
@@ -275,11 +336,14 @@ bool RootWindow::DispatchMouseEvent(MouseEvent* event) {
     }
   }
   DispatchHeldMouseMove();
+  ScopedInputDispatch dispatch(input_latency_tracker_.get(), *event);
   return DispatchMouseEventImpl(event);
 }
 
 bool RootWindow::DispatchKeyEvent(KeyEvent* event) {
+  DispatchQueuedMoves();
   DispatchHeldMouseMove();
+  ScopedInputDispatch dispatch(input_latency_tracker_.get(), *event);
   if (event->key_code() == ui::VKEY_UNKNOWN)
     return false;
   client::EventClient* client = client::GetEventClient(GetRootWindow());
@@ -292,7 +356,9 @@ bool RootWindow::DispatchKeyEvent(KeyEvent* event) {
 }
 
 bool RootWindow::DispatchScrollEvent(ScrollEvent* event) {
+  DispatchQueuedMoves();
   DispatchHeldMouseMove();
+  ScopedInputDispatch dispatch(input_latency_tracker_.get(), *event);
   float scale = ui::GetDeviceScaleFactor(layer());
   ui::Transform transform = layer()->transform();
   transform.ConcatScale(scale, scale);
@@ -319,7 +385,9 @@ bool RootWindow::DispatchScrollEvent(ScrollEvent* event) {
 }
 
 bool RootWindow::DispatchTouchEvent(TouchEvent* event) {
+  DispatchQueuedMoves();
   DispatchHeldMouseMove();
+  ScopedInputDispatch dispatch(input_latency_tracker_.get(), *event);
   switch (event->type()) {
     case ui::ET_TOUCH_PRESSED:
       touch_ids_down_ |= (1 << event->touch_id());
@@ -381,7 +449,9 @@ bool RootWindow::DispatchTouchEvent(TouchEvent* event) {
 }
 
 bool RootWindow::DispatchGestureEvent(GestureEvent* event) {
+  DispatchQueuedMoves();
   DispatchHeldMouseMove();
+  ScopedInputDispatch dispatch(input_latency_tracker_.get(), *event);
 
   Window* target = client::GetCaptureWindow(this);
   if (!target) {
@@ -401,6 +471,7 @@ bool RootWindow::DispatchGestureEvent(GestureEvent* event) {
 }
 
 void RootWindow::OnHostResized(const gfx::Size& size_in_pixel) {
+  DispatchQueuedMoves();
   DispatchHeldMouseMove();
   // The compositor should have the same size as the native root window host.
   // Get the latest scale from monitor because it might have been changed.
@@ -514,13 +585,42 @@ void RootWindow::ReleaseMouseMoves() {
     // dispatching another one may not be safe/expected.
     // Instead we post a task, that we may cancel if HoldMouseMoves is called
     // again before it executes.
-    MessageLoop::current()->PostTask(
+    MessageLoop::current()->PostTaskWithPriority(
         FROM_HERE,
         base::Bind(&RootWindow::DispatchHeldMouseMove,
-                   held_mouse_event_factory_.GetWeakPtr()));
+                   held_mouse_event_factory_.GetWeakPtr()),
+        base::TASK_PRIORITY_INPUT);
   }
 }
 
+void RootWindow::QueueMouseMove(const MouseEvent& event) {
+  DCHECK(event.type() == ui::ET_MOUSE_MOVED ||
+         event.type() == ui::ET_MOUSE_DRAGGED);
+  // A move doesn't replace one with other buttons down.
+  if (queued_mouse_move_.get() &&
+      (queued_mouse_move_->type() != event.type() ||
+       queued_mouse_move_->flags() != event.flags())) {
+    DispatchQueuedMoves();
+  }
+  queued_mouse_move_.reset(new MouseEvent(event, NULL, NULL));
+  PostDispatchQueuedMoves();
+}
+
+void RootWindow::QueueTouchMove(const TouchEvent& event) {
+  DCHECK_EQ(ui::ET_TOUCH_MOVED, event.type());
+  TouchEvent* move = new TouchEvent(event, NULL, NULL);
+  for (size_t i = 0; i < queued_touch_moves_.size(); ++i) {
+    if (queued_touch_moves_[i]->touch_id() == move->touch_id()) {
+      move->MergeEarlierMove(*queued_touch_moves_[i]);
+      delete queued_touch_moves_[i];
+      queued_touch_moves_[i] = move;
+      return;
+    }
+  }
+  queued_touch_moves_.push_back(move);
+  PostDispatchQueuedMoves();
+}
+
 scoped_refptr<CompositorLock> RootWindow::GetCompositorLock() {
   if (!compositor_lock_)
     compositor_lock_ = new CompositorLock(this);
@@ -562,13 +662,15 @@ void RootWindow::SetTransform(const ui::Transform& transform) {
 // RootWindow, ui::CompositorDelegate implementation:
 
 void RootWindow::ScheduleDraw() {
+  input_latency_tracker_->OnDrawScheduled();
   if (compositor_lock_) {
     draw_on_compositor_unlock_ = true;
   } else if (!defer_draw_scheduling_) {
     defer_draw_scheduling_ = true;
-    MessageLoop::current()->PostTask(
+    MessageLoop::current()->PostTaskWithPriority(
         FROM_HERE,
-        base::Bind(&RootWindow::Draw, schedule_paint_factory_.GetWeakPtr()));
+        base::Bind(&RootWindow::Draw, schedule_paint_factory_.GetWeakPtr()),
+        base::TASK_PRIORITY_DISPLAY);
   }
 }
 
@@ -581,6 +683,7 @@ void RootWindow::OnCompositingStarted(ui::Compositor*) {
 void RootWindow::OnCompositingEnded(ui::Compositor*) {
   TRACE_EVENT_ASYNC_END0("ui", "RootWindow::Draw",
                          compositor_->last_ended_frame());
+  input_latency_tracker_->OnFrameEnded(compositor_->last_ended_frame());
   waiting_on_compositing_end_ = false;
   if (draw_on_compositing_end_) {
     draw_on_compositing_end_ = false;
@@ -593,6 +696,7 @@ void RootWindow::OnCompositingEnded(ui::Compositor*) {
 }
 
 void RootWindow::OnCompositingAborted(ui::Compositor*) {
+  input_latency_tracker_->OnFrameAborted();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -687,47 +791,74 @@ void RootWindow::HandleMouseMoved(const MouseEvent& event, Window* target) {
   }
 }
 
+scoped_refptr<RootWindow::EventFilterChain> RootWindow::GetEventFilterChain(
+    Window* window) {
+  int generation = Env::GetInstance()->event_filter_generation();
+  if (generation != event_filter_chains_generation_) {
+    event_filter_chains_.Clear();
+    event_filter_chains_generation_ = generation;
+  }
+
+  EventFilterChains::iterator it = event_filter_chains_.Get(window);
+  if (it != event_filter_chains_.end())
+    return it->second;
+
+  scoped_refptr<EventFilterChain> chain(new EventFilterChain);
+  GetEventFiltersToNotify(window, &chain->data);
+  std::reverse(chain->data.begin(), chain->data.end());
+  event_filter_chains_.Put(window, chain);
+  return chain;
+}
+
 bool RootWindow::ProcessMouseEvent(Window* target, MouseEvent* event) {
   if (!target->IsVisible())
     return false;
 
-  EventFilters filters;
-  GetEventFiltersToNotify(target->parent(), &filters);
-  for (EventFilters::const_reverse_iterator it = filters.rbegin(),
-           rend = filters.rend();
-       it != rend; ++it) {
-    if ((*it)->PreHandleMouseEvent(target, event))
+  scoped_refptr<EventFilterChain> chain =
+      GetEventFilterChain(target->parent());
+  const EventFilters& filters = chain->data;
+  for (size_t i = 0; i < filters.size(); ++i) {
+    if (!(filters[i]->handled_events() & EventFilter::MOUSE_EVENTS))
+      continue;
+    TRACE_EVENT1("ui", "EventFilter::PreHandleMouseEvent", "filter",
+                 static_cast<const void*>(filters[i]));
+    if (filters[i]->PreHandleMouseEvent(target, event))
       return true;
   }
 
   if (!target->delegate())
     return false;
+  ScopedEventCost cost(target);
   return target->delegate()->OnMouseEvent(event);
 }
 
 bool RootWindow::ProcessKeyEvent(Window* target, KeyEvent* event) {
-  EventFilters filters;
+  scoped_refptr<EventFilterChain> chain;
 
   if (!target) {
     // When no window is focused, send the key event to |this| so event filters
     // for the window could check if the key is a global shortcut like Alt+Tab.
     target = this;
-    GetEventFiltersToNotify(this, &filters);
+    chain = GetEventFilterChain(this);
   } else {
     if (!target->IsVisible())
       return false;
-    GetEventFiltersToNotify(target->parent(), &filters);
+    chain = GetEventFilterChain(target->parent());
   }
 
-  for (EventFilters::const_reverse_iterator it = filters.rbegin(),
-           rend = filters.rend();
-       it != rend; ++it) {
-    if ((*it)->PreHandleKeyEvent(target, event))
+  const EventFilters& filters = chain->data;
+  for (size_t i = 0; i < filters.size(); ++i) {
+    if (!(filters[i]->handled_events() & EventFilter::KEY_EVENTS))
+      continue;
+    TRACE_EVENT1("ui", "EventFilter::PreHandleKeyEvent", "filter",
+                 static_cast<const void*>(filters[i]));
+    if (filters[i]->PreHandleKeyEvent(target, event))
       return true;
   }
 
   if (!target->delegate())
     return false;
+  ScopedEventCost cost(target);
   return target->delegate()->OnKeyEvent(event);
 }
 
@@ -736,21 +867,23 @@ ui::TouchStatus RootWindow::ProcessTouchEvent(Window* target,
   if (!target->IsVisible())
     return ui::TOUCH_STATUS_UNKNOWN;
 
-  EventFilters filters;
-  if (target == this)
-    GetEventFiltersToNotify(target, &filters);
-  else
-    GetEventFiltersToNotify(target->parent(), &filters);
-  for (EventFilters::const_reverse_iterator it = filters.rbegin(),
-           rend = filters.rend();
-       it != rend; ++it) {
-    ui::TouchStatus status = (*it)->PreHandleTouchEvent(target, event);
+  scoped_refptr<EventFilterChain> chain =
+      GetEventFilterChain(target == this ? target : target->parent());
+  const EventFilters& filters = chain->data;
+  for (size_t i = 0; i < filters.size(); ++i) {
+    if (!(filters[i]->handled_events() & EventFilter::TOUCH_EVENTS))
+      continue;
+    TRACE_EVENT1("ui", "EventFilter::PreHandleTouchEvent", "filter",
+                 static_cast<const void*>(filters[i]));
+    ui::TouchStatus status = filters[i]->PreHandleTouchEvent(target, event);
     if (status != ui::TOUCH_STATUS_UNKNOWN)
       return status;
   }
 
-  if (target->delegate())
+  if (target->delegate()) {
+    ScopedEventCost cost(target);
     return target->delegate()->OnTouchEvent(event);
+  }
 
   return ui::TOUCH_STATUS_UNKNOWN;
 }
@@ -760,22 +893,24 @@ ui::GestureStatus RootWindow::ProcessGestureEvent(Window* target,
   if (!target->IsVisible())
     return ui::GESTURE_STATUS_UNKNOWN;
 
-  EventFilters filters;
-  if (target == this)
-    GetEventFiltersToNotify(target, &filters);
-  else
-    GetEventFiltersToNotify(target->parent(), &filters);
+  scoped_refptr<EventFilterChain> chain =
+      GetEventFilterChain(target == this ? target : target->parent());
+  const EventFilters& filters = chain->data;
   ui::GestureStatus status = ui::GESTURE_STATUS_UNKNOWN;
-  for (EventFilters::const_reverse_iterator it = filters.rbegin(),
-           rend = filters.rend();
-       it != rend; ++it) {
-    status = (*it)->PreHandleGestureEvent(target, event);
+  for (size_t i = 0; i < filters.size(); ++i) {
+    if (!(filters[i]->handled_events() & EventFilter::GESTURE_EVENTS))
+      continue;
+    TRACE_EVENT1("ui", "EventFilter::PreHandleGestureEvent", "filter",
+                 static_cast<const void*>(filters[i]));
+    status = filters[i]->PreHandleGestureEvent(target, event);
     if (status != ui::GESTURE_STATUS_UNKNOWN)
       return status;
   }
 
-  if (target->delegate())
+  if (target->delegate()) {
+    ScopedEventCost cost(target);
     status = target->delegate()->OnGestureEvent(event);
+  }
   if (status == ui::GESTURE_STATUS_UNKNOWN &&
       !CommandLine::ForCurrentProcess()->HasSwitch(
           switches::kAuraDisableMouseEventsFromTouch)) {
@@ -1010,14 +1145,40 @@ void RootWindow::DispatchHeldMouseMove() {
   }
 }
 
+void RootWindow::DispatchQueuedMoves() {
+  if (!queued_mouse_move_.get() && queued_touch_moves_.empty())
+    return;
+  queued_moves_factory_.InvalidateWeakPtrs();
+  // Dispatching the moves dispatches the queue first, so it must be emptied
+  // beforehand.
+  scoped_ptr<MouseEvent> mouse_move(queued_mouse_move_.release());
+  ScopedVector<TouchEvent> touch_moves;
+  touch_moves.swap(queued_touch_moves_);
+  if (mouse_move.get())
+    DispatchMouseEvent(mouse_move.get());
+  for (size_t i = 0; i < touch_moves.size(); ++i)
+    DispatchTouchEvent(touch_moves[i]);
+}
+
+void RootWindow::PostDispatchQueuedMoves() {
+  if (queued_moves_factory_.HasWeakPtrs())
+    return;
+  MessageLoop::current()->PostTaskWithPriority(
+      FROM_HERE,
+      base::Bind(&RootWindow::DispatchQueuedMoves,
+                 queued_moves_factory_.GetWeakPtr()),
+      base::TASK_PRIORITY_INPUT);
+}
+
 void RootWindow::PostMouseMoveEventAfterWindowChange() {
   if (synthesize_mouse_move_)
     return;
   synthesize_mouse_move_ = true;
-  MessageLoop::current()->PostTask(
+  MessageLoop::current()->PostTaskWithPriority(
       FROM_HERE,
       base::Bind(&RootWindow::SynthesizeMouseMoveEvent,
-                 event_factory_.GetWeakPtr()));
+                 event_factory_.GetWeakPtr()),
+      base::TASK_PRIORITY_INPUT);
 }
 
 void RootWindow::SynthesizeMouseMoveEvent() {
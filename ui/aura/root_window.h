@@ -9,8 +9,10 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/memory/mru_cache.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/memory/weak_ptr.h"
 #include "base/message_loop.h"
 #include "ui/aura/aura_export.h"
@@ -38,8 +40,10 @@ class Transform;
 
 namespace aura {
 
+class EventFilter;
 class FocusManager;
 class GestureEvent;
+class InputLatencyTracker;
 class KeyEvent;
 class MouseEvent;
 class RootWindow;
@@ -231,12 +235,28 @@ class AURA_EXPORT RootWindow : public ui::CompositorDelegate,
   void HoldMouseMoves();
   void ReleaseMouseMoves();
 
+  // Used by the host to queue a mouse move or drag, or a touch move, instead
+  // of dispatching it. A queued move is replaced by the next move of the same
+  // pointer, and the queue is dispatched before the next frame, so that
+  // devices that report faster than the display refreshes don't flood the UI
+  // thread. Touch moves keep the points they replace for gesture velocity.
+  // Every other event dispatches the queue first, so moves are never merged
+  // across presses, releases or key events.
+  void QueueMouseMove(const MouseEvent& event);
+  void QueueTouchMove(const TouchEvent& event);
+
   // Creates a compositor lock.
   scoped_refptr<CompositorLock> GetCompositorLock();
 
   // Sets if the window should be focused when shown.
   void SetFocusWhenShown(bool focus_when_shown);
 
+  // Measures the time from dispatching input events to the end of the frames
+  // showing them.
+  InputLatencyTracker* input_latency_tracker() {
+    return input_latency_tracker_.get();
+  }
+
   // Grabs the snapshot of the root window by using the platform-dependent APIs.
   bool GrabSnapshot(const gfx::Rect& snapshot_bounds,
                     std::vector<unsigned char>* png_representation);
@@ -274,10 +294,21 @@ class AURA_EXPORT RootWindow : public ui::CompositorDelegate,
   friend class Window;
   friend class CompositorLock;
 
+  // The event filters of a window and of its ancestors, outermost first.
+  typedef base::RefCountedData<std::vector<EventFilter*> > EventFilterChain;
+  typedef base::MRUCache<Window*, scoped_refptr<EventFilterChain> >
+      EventFilterChains;
+
   // Called whenever the mouse moves, tracks the current |mouse_moved_handler_|,
   // sending exited and entered events as its value changes.
   void HandleMouseMoved(const MouseEvent& event, Window* target);
 
+  // Returns the event filters of |window| and of its ancestors, including the
+  // one of Env. The chains of the windows events were last sent through are
+  // kept until a filter is set or a window changes parents. The chain is
+  // referenced so that it outlives the filters changing while it is walked.
+  scoped_refptr<EventFilterChain> GetEventFilterChain(Window* window);
+
   bool ProcessMouseEvent(Window* target, MouseEvent* event);
   bool ProcessKeyEvent(Window* target, KeyEvent* event);
   ui::TouchStatus ProcessTouchEvent(Window* target, TouchEvent* event);
@@ -330,6 +361,13 @@ class AURA_EXPORT RootWindow : public ui::CompositorDelegate,
   bool DispatchMouseEventToTarget(MouseEvent* event, Window* target);
   void DispatchHeldMouseMove();
 
+  // Dispatches the moves queued by QueueMouseMove() and QueueTouchMove().
+  void DispatchQueuedMoves();
+
+  // Posts DispatchQueuedMoves(), so that the queue is dispatched even if no
+  // frame is drawn.
+  void PostDispatchQueuedMoves();
+
   // Parses the switch describing the initial size for the host window and
   // returns bounds for the window.
   gfx::Rect GetInitialHostWindowBounds() const;
@@ -398,9 +436,23 @@ class AURA_EXPORT RootWindow : public ui::CompositorDelegate,
   // to 0.
   base::WeakPtrFactory<RootWindow> held_mouse_event_factory_;
 
+  // The moves queued by QueueMouseMove() and QueueTouchMove(), at most one per
+  // pointer.
+  scoped_ptr<MouseEvent> queued_mouse_move_;
+  ScopedVector<TouchEvent> queued_touch_moves_;
+  // Used to post DispatchQueuedMoves().
+  base::WeakPtrFactory<RootWindow> queued_moves_factory_;
+
   CompositorLock* compositor_lock_;
   bool draw_on_compositor_unlock_;
 
+  scoped_ptr<InputLatencyTracker> input_latency_tracker_;
+
+  // Valid while Env's event filter generation is
+  // |event_filter_chains_generation_|.
+  EventFilterChains event_filter_chains_;
+  int event_filter_chains_generation_;
+
   DISALLOW_COPY_AND_ASSIGN(RootWindow);
 };
 
@@ -0,0 +1,116 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/aura/root_window_host_headless.h"
+
+#include "base/logging.h"
+#include "ui/aura/root_window.h"
+
+namespace aura {
+
+namespace {
+
+// There is no screen to measure, so report a common laptop size.
+const int kScreenWidth = 1280;
+const int kScreenHeight = 800;
+
+}  // namespace
+
+RootWindowHostHeadless::RootWindowHostHeadless(const gfx::Rect& bounds)
+    : root_window_(NULL),
+      bounds_(bounds) {
+}
+
+RootWindowHostHeadless::~RootWindowHostHeadless() {
+}
+
+// static
+gfx::Size RootWindowHostHeadless::GetScreenSize() {
+  return gfx::Size(kScreenWidth, kScreenHeight);
+}
+
+void RootWindowHostHeadless::SetRootWindow(RootWindow* root_window) {
+  root_window_ = root_window;
+}
+
+RootWindow* RootWindowHostHeadless::GetRootWindow() {
+  return root_window_;
+}
+
+gfx::AcceleratedWidget RootWindowHostHeadless::GetAcceleratedWidget() {
+  return gfx::kNullAcceleratedWidget;
+}
+
+void RootWindowHostHeadless::Show() {
+}
+
+void RootWindowHostHeadless::ToggleFullScreen() {
+  SetBounds(gfx::Rect(GetScreenSize()));
+}
+
+gfx::Rect RootWindowHostHeadless::GetBounds() const {
+  return bounds_;
+}
+
+void RootWindowHostHeadless::SetBounds(const gfx::Rect& bounds) {
+  bool size_changed = bounds_.size() != bounds.size();
+  bounds_ = bounds;
+  if (size_changed)
+    root_window_->OnHostResized(bounds.size());
+  else
+    root_window_->SchedulePaintInRect(root_window_->bounds());
+}
+
+gfx::Point RootWindowHostHeadless::GetLocationOnNativeScreen() const {
+  return bounds_.origin();
+}
+
+void RootWindowHostHeadless::SetCapture() {
+}
+
+void RootWindowHostHeadless::ReleaseCapture() {
+}
+
+void RootWindowHostHeadless::SetCursor(gfx::NativeCursor cursor) {
+}
+
+void RootWindowHostHeadless::ShowCursor(bool show) {
+}
+
+gfx::Point RootWindowHostHeadless::QueryMouseLocation() {
+  return cursor_location_;
+}
+
+bool RootWindowHostHeadless::ConfineCursorToRootWindow() {
+  return false;
+}
+
+void RootWindowHostHeadless::UnConfineCursor() {
+}
+
+void RootWindowHostHeadless::MoveCursorTo(const gfx::Point& location) {
+  cursor_location_ = location;
+}
+
+void RootWindowHostHeadless::SetFocusWhenShown(bool focus_when_shown) {
+}
+
+bool RootWindowHostHeadless::GrabSnapshot(
+    const gfx::Rect& snapshot_bounds,
+    std::vector<unsigned char>* png_representation) {
+  return false;
+}
+
+#if !defined(OS_MACOSX)
+void RootWindowHostHeadless::PostNativeEvent(
+    const base::NativeEvent& native_event) {
+  NOTIMPLEMENTED();
+}
+#endif
+
+void RootWindowHostHeadless::OnDeviceScaleFactorChanged(
+    float device_scale_factor) {
+}
+
+}  // namespace aura
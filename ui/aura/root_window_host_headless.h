@@ -0,0 +1,65 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_AURA_ROOT_WINDOW_HOST_HEADLESS_H_
+#define UI_AURA_ROOT_WINDOW_HOST_HEADLESS_H_
+#pragma once
+
+#include "base/compiler_specific.h"
+#include "ui/aura/root_window_host.h"
+#include "ui/gfx/rect.h"
+
+namespace aura {
+
+// A RootWindowHost without a native window, used with --aura-headless so the
+// compositor can draw offscreen on machines without a display. It receives no
+// native events; callers dispatch aura events to the RootWindow directly.
+class RootWindowHostHeadless : public RootWindowHost {
+ public:
+  explicit RootWindowHostHeadless(const gfx::Rect& bounds);
+  virtual ~RootWindowHostHeadless();
+
+  // The size reported as the native screen size when headless.
+  static gfx::Size GetScreenSize();
+
+  // RootWindowHost Overrides.
+  virtual void SetRootWindow(RootWindow* root_window) OVERRIDE;
+  virtual RootWindow* GetRootWindow() OVERRIDE;
+  virtual gfx::AcceleratedWidget GetAcceleratedWidget() OVERRIDE;
+  virtual void Show() OVERRIDE;
+  virtual void ToggleFullScreen() OVERRIDE;
+  virtual gfx::Rect GetBounds() const OVERRIDE;
+  virtual void SetBounds(const gfx::Rect& bounds) OVERRIDE;
+  virtual gfx::Point GetLocationOnNativeScreen() const OVERRIDE;
+  virtual void SetCapture() OVERRIDE;
+  virtual void ReleaseCapture() OVERRIDE;
+  virtual void SetCursor(gfx::NativeCursor cursor_type) OVERRIDE;
+  virtual void ShowCursor(bool show) OVERRIDE;
+  virtual gfx::Point QueryMouseLocation() OVERRIDE;
+  virtual bool ConfineCursorToRootWindow() OVERRIDE;
+  virtual void UnConfineCursor() OVERRIDE;
+  virtual void MoveCursorTo(const gfx::Point& location) OVERRIDE;
+  virtual void SetFocusWhenShown(bool focus_when_shown) OVERRIDE;
+  virtual bool GrabSnapshot(
+      const gfx::Rect& snapshot_bounds,
+      std::vector<unsigned char>* png_representation) OVERRIDE;
+#if !defined(OS_MACOSX)
+  virtual void PostNativeEvent(const base::NativeEvent& event) OVERRIDE;
+#endif
+  virtual void OnDeviceScaleFactorChanged(float device_scale_factor) OVERRIDE;
+
+ private:
+  RootWindow* root_window_;
+
+  gfx::Rect bounds_;
+
+  // The last location passed to MoveCursorTo().
+  gfx::Point cursor_location_;
+
+  DISALLOW_COPY_AND_ASSIGN(RootWindowHostHeadless);
+};
+
+}  // namespace aura
+
+#endif  // UI_AURA_ROOT_WINDOW_HOST_HEADLESS_H_
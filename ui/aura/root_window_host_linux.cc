@@ -12,18 +12,22 @@
 #include <X11/extensions/Xfixes.h>
 #include <X11/extensions/Xrandr.h>
 #include <algorithm>
+#include <list>
 
+#include "base/command_line.h"
 #include "base/message_pump_aurax11.h"
 #include "base/stl_util.h"
 #include "base/stringprintf.h"
 #include "grit/ui_resources_standard.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "ui/aura/client/capture_client.h"
+#include "ui/aura/aura_switches.h"
 #include "ui/aura/client/user_action_client.h"
 #include "ui/aura/dispatcher_linux.h"
 #include "ui/aura/env.h"
 #include "ui/aura/event.h"
 #include "ui/aura/root_window.h"
+#include "ui/aura/root_window_host_headless.h"
 #include "ui/base/cursor/cursor.h"
 #include "ui/base/keycodes/keyboard_codes.h"
 #include "ui/base/resource/resource_bundle.h"
@@ -49,6 +53,9 @@ const int kForwardMouseButton = 9;
 
 const int kAnimatedCursorFrameDelayMs = 25;
 
+// The number of scale factors whose image cursors are kept.
+const size_t kMaxImageCursorSets = 2;
+
 const char kRootWindowHostLinuxKey[] = "__AURA_ROOT_WINDOW_HOST_LINUX__";
 
 const char* kAtomsToCache[] = {
@@ -301,20 +308,12 @@ bool ShouldSendCharEventForKeyboardCode(ui::KeyboardCode keycode) {
   }
 }
 
-}  // namespace
-
-// A utility class that provides X Cursor for NativeCursors for which we have
-// image resources.
-class RootWindowHostLinux::ImageCursors {
+// The X Cursors made from the image resources of the NativeCursors, for one
+// scale factor. They are all made when the set is created, so that changing
+// the cursor never has to load an image.
+class ImageCursorSet {
  public:
-  ImageCursors() : scale_factor_(0.0) {
-  }
-
-  void Reload(float scale_factor) {
-    if (scale_factor_ == scale_factor)
-      return;
-    scale_factor_ = scale_factor;
-    UnloadAll();
+  explicit ImageCursorSet(float scale_factor) : scale_factor_(scale_factor) {
     // The cursor's hot points are defined in chromeos's
     // src/platforms/assets/cursors/*.cfg files.
     LoadImageCursor(ui::kCursorNull, IDR_AURA_CURSOR_PTR, 9, 5);
@@ -362,11 +361,7 @@ class RootWindowHostLinux::ImageCursors {
     LoadAnimatedCursor(ui::kCursorProgress, IDR_THROBBER, 7, 7);
   }
 
-  ~ImageCursors() {
-    UnloadAll();
-  }
-
-  void UnloadAll() {
+  ~ImageCursorSet() {
     for (std::map<int, Cursor>::const_iterator it = cursors_.begin();
         it != cursors_.end(); ++it)
       ui::UnrefCustomXCursor(it->second);
@@ -379,6 +374,8 @@ class RootWindowHostLinux::ImageCursors {
     }
   }
 
+  float scale_factor() const { return scale_factor_; }
+
   // Returns true if we have an image resource loaded for the |native_cursor|.
   bool IsImageCursor(gfx::NativeCursor native_cursor) {
     int type = native_cursor.native_type();
@@ -469,6 +466,62 @@ class RootWindowHostLinux::ImageCursors {
 
   float scale_factor_;
 
+  DISALLOW_COPY_AND_ASSIGN(ImageCursorSet);
+};
+
+}  // namespace
+
+// A utility class that provides X Cursor for NativeCursors for which we have
+// image resources. The cursors of the last scale factors used are kept, so
+// that moving between monitors of different scale factors doesn't make them
+// again.
+class RootWindowHostLinux::ImageCursors {
+ public:
+  ImageCursors() : current_(NULL) {
+  }
+
+  ~ImageCursors() {
+    STLDeleteElements(&cursor_sets_);
+  }
+
+  void Reload(float scale_factor) {
+    if (current_ && current_->scale_factor() == scale_factor)
+      return;
+
+    for (std::list<ImageCursorSet*>::iterator it = cursor_sets_.begin();
+         it != cursor_sets_.end(); ++it) {
+      if ((*it)->scale_factor() == scale_factor) {
+        current_ = *it;
+        cursor_sets_.erase(it);
+        cursor_sets_.push_front(current_);
+        return;
+      }
+    }
+
+    if (cursor_sets_.size() == kMaxImageCursorSets) {
+      delete cursor_sets_.back();
+      cursor_sets_.pop_back();
+    }
+    current_ = new ImageCursorSet(scale_factor);
+    cursor_sets_.push_front(current_);
+  }
+
+  // Returns true if we have an image resource loaded for the |native_cursor|.
+  bool IsImageCursor(gfx::NativeCursor native_cursor) {
+    return current_ && current_->IsImageCursor(native_cursor);
+  }
+
+  // Gets the X Cursor corresponding to the |native_cursor|.
+  ::Cursor ImageCursorFromNative(gfx::NativeCursor native_cursor) {
+    DCHECK(current_);
+    return current_->ImageCursorFromNative(native_cursor);
+  }
+
+ private:
+  // The cursor sets, most recently used first.
+  std::list<ImageCursorSet*> cursor_sets_;
+  ImageCursorSet* current_;
+
   DISALLOW_COPY_AND_ASSIGN(ImageCursors);
 };
 
@@ -481,6 +534,7 @@ RootWindowHostLinux::RootWindowHostLinux(const gfx::Rect& bounds)
       cursor_shown_(true),
       bounds_(bounds),
       focus_when_shown_(false),
+      pointer_location_known_(false),
       pointer_barriers_(NULL),
       image_cursors_(new ImageCursors),
       atom_cache_(xdisplay_, kAtomsToCache) {
@@ -608,6 +662,8 @@ bool RootWindowHostLinux::Dispatch(const base::NativeEvent& event) {
     }  // fallthrough
     case ButtonRelease: {
       MouseEvent mouseev(xev);
+      if (!xev->xany.send_event)
+        SetPointerLocation(gfx::Point(xev->xbutton.x, xev->xbutton.y));
       root_window_->DispatchMouseEvent(&mouseev);
       break;
     }
@@ -627,6 +683,10 @@ bool RootWindowHostLinux::Dispatch(const base::NativeEvent& event) {
       gfx::Rect bounds(xev->xconfigure.x, xev->xconfigure.y,
                        xev->xconfigure.width, xev->xconfigure.height);
       bool size_changed = bounds_.size() != bounds.size();
+      // The pointer is elsewhere in a moved window, and is warped below when
+      // confined.
+      if (bounds_.origin() != bounds.origin() || pointer_barriers_.get())
+        pointer_location_known_ = false;
       bounds_ = bounds;
       // Update barrier and mouse location when the root window has
       // moved/resized.
@@ -654,7 +714,10 @@ bool RootWindowHostLinux::Dispatch(const base::NativeEvent& event) {
         case ui::ET_TOUCH_RELEASED:
         case ui::ET_TOUCH_MOVED: {
           TouchEvent touchev(xev);
-          root_window_->DispatchTouchEvent(&touchev);
+          if (type == ui::ET_TOUCH_MOVED && !xev->xany.send_event)
+            root_window_->QueueTouchMove(touchev);
+          else
+            root_window_->DispatchTouchEvent(&touchev);
           break;
         }
         case ui::ET_MOUSE_MOVED:
@@ -690,7 +753,18 @@ bool RootWindowHostLinux::Dispatch(const base::NativeEvent& event) {
             }
           }
           MouseEvent mouseev(xev);
-          root_window_->DispatchMouseEvent(&mouseev);
+          if (!xev->xany.send_event) {
+            XIDeviceEvent* xievent =
+                static_cast<XIDeviceEvent*>(xev->xcookie.data);
+            SetPointerLocation(gfx::Point(static_cast<int>(xievent->event_x),
+                                          static_cast<int>(xievent->event_y)));
+          }
+          if ((type == ui::ET_MOUSE_MOVED || type == ui::ET_MOUSE_DRAGGED) &&
+              !xev->xany.send_event) {
+            root_window_->QueueMouseMove(mouseev);
+          } else {
+            root_window_->DispatchMouseEvent(&mouseev);
+          }
           break;
         }
         case ui::ET_SCROLL_FLING_START:
@@ -711,6 +785,14 @@ bool RootWindowHostLinux::Dispatch(const base::NativeEvent& event) {
         XFreeEventData(xev->xgeneric.display, &last_event.xcookie);
       break;
     }
+    case EnterNotify:
+      if (!xev->xany.send_event)
+        SetPointerLocation(gfx::Point(xev->xcrossing.x, xev->xcrossing.y));
+      break;
+    case LeaveNotify:
+      // The window isn't told where the pointer goes next.
+      pointer_location_known_ = false;
+      break;
     case MapNotify: {
       // If there's no window manager running, we need to assign the X input
       // focus to our host window.
@@ -769,8 +851,16 @@ bool RootWindowHostLinux::Dispatch(const base::NativeEvent& event) {
         }
       }
 
+      // Moves sent by other clients, e.g. by ui_controls in tests, are
+      // dispatched right away, so that the events that follow them see their
+      // effects.
       MouseEvent mouseev(xev);
-      root_window_->DispatchMouseEvent(&mouseev);
+      if (xev->xany.send_event) {
+        root_window_->DispatchMouseEvent(&mouseev);
+      } else {
+        SetPointerLocation(gfx::Point(xev->xmotion.x, xev->xmotion.y));
+        root_window_->QueueMouseMove(mouseev);
+      }
       break;
     }
   }
@@ -823,8 +913,10 @@ void RootWindowHostLinux::SetBounds(const gfx::Rect& bounds) {
   if (bounds.size() != bounds_.size())
     XResizeWindow(xdisplay_, xwindow_, bounds.width(), bounds.height());
 
-  if (bounds.origin() != bounds_.origin())
+  if (bounds.origin() != bounds_.origin()) {
     XMoveWindow(xdisplay_, xwindow_, bounds.x(), bounds.y());
+    pointer_location_known_ = false;
+  }
 
   // Assume that the resize will go through as requested, which should be the
   // case if we're running without a window manager.  If there's a window
@@ -867,6 +959,11 @@ void RootWindowHostLinux::ShowCursor(bool show) {
 }
 
 gfx::Point RootWindowHostLinux::QueryMouseLocation() {
+  if (pointer_location_known_) {
+    return gfx::Point(max(0, min(bounds_.width(), pointer_location_.x())),
+                      max(0, min(bounds_.height(), pointer_location_.y())));
+  }
+
   ::Window root_return, child_return;
   int root_x_return, root_y_return, win_x_return, win_y_return;
   unsigned int mask_return;
@@ -877,6 +974,7 @@ gfx::Point RootWindowHostLinux::QueryMouseLocation() {
                 &root_x_return, &root_y_return,
                 &win_x_return, &win_y_return,
                 &mask_return);
+  SetPointerLocation(gfx::Point(win_x_return, win_y_return));
   return gfx::Point(max(0, min(bounds_.width(), win_x_return)),
                     max(0, min(bounds_.height(), win_y_return)));
 }
@@ -931,6 +1029,7 @@ void RootWindowHostLinux::UnConfineCursor() {
 void RootWindowHostLinux::MoveCursorTo(const gfx::Point& location) {
   XWarpPointer(xdisplay_, None, xwindow_, 0, 0, 0, 0, location.x(),
       location.y());
+  SetPointerLocation(location);
 }
 
 void RootWindowHostLinux::SetFocusWhenShown(bool focus_when_shown) {
@@ -1036,6 +1135,11 @@ bool RootWindowHostLinux::IsWindowManagerPresent() {
       xdisplay_, atom_cache_.GetAtom("WM_S0")) != None;
 }
 
+void RootWindowHostLinux::SetPointerLocation(const gfx::Point& location) {
+  pointer_location_ = location;
+  pointer_location_known_ = true;
+}
+
 void RootWindowHostLinux::SetCursorInternal(gfx::NativeCursor cursor) {
   ::Cursor xcursor =
       image_cursors_->IsImageCursor(cursor) ?
@@ -1048,6 +1152,8 @@ void RootWindowHostLinux::SetCursorInternal(gfx::NativeCursor cursor) {
 
 // static
 RootWindowHost* RootWindowHost::Create(const gfx::Rect& bounds) {
+  if (CommandLine::ForCurrentProcess()->HasSwitch(switches::kAuraHeadless))
+    return new RootWindowHostHeadless(bounds);
   return new RootWindowHostLinux(bounds);
 }
 
@@ -1060,6 +1166,8 @@ RootWindowHost* RootWindowHost::GetForAcceleratedWidget(
 
 // static
 gfx::Size RootWindowHost::GetNativeScreenSize() {
+  if (CommandLine::ForCurrentProcess()->HasSwitch(switches::kAuraHeadless))
+    return RootWindowHostHeadless::GetScreenSize();
   ::Display* xdisplay = base::MessagePumpAuraX11::GetDefaultXDisplay();
   return gfx::Size(DisplayWidth(xdisplay, 0), DisplayHeight(xdisplay, 0));
 }
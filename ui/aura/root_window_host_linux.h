@@ -62,6 +62,10 @@ class RootWindowHostLinux : public RootWindowHost,
   // detect that they're there.
   bool IsWindowManagerPresent();
 
+  // Records where the pointer is in |xwindow_|, as told by an event or a
+  // query.
+  void SetPointerLocation(const gfx::Point& location);
+
   // Sets the cursor on |xwindow_| to |cursor|.  Does not check or update
   // |current_cursor_|.
   void SetCursorInternal(gfx::NativeCursor cursor);
@@ -90,6 +94,13 @@ class RootWindowHostLinux : public RootWindowHost,
   // True if the window should be focused when the window is shown.
   bool focus_when_shown_;
 
+  // The last location of the pointer in |xwindow_|, known from the events
+  // the window gets, so that QueryMouseLocation() doesn't have to ask the X
+  // server each time. Forgotten when the pointer leaves the window or the
+  // window moves.
+  gfx::Point pointer_location_;
+  bool pointer_location_known_;
+
   scoped_array<XID> pointer_barriers_;
 
   scoped_ptr<ui::ViewProp> prop_;
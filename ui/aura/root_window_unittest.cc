@@ -4,6 +4,8 @@
 
 #include "ui/aura/root_window.h"
 
+#include <algorithm>
+#include <map>
 #include <vector>
 
 #include "testing/gtest/include/gtest/gtest.h"
@@ -16,6 +18,7 @@
 #include "ui/aura/test/event_generator.h"
 #include "ui/aura/test/test_window_delegate.h"
 #include "ui/aura/test/test_windows.h"
+#include "ui/aura/window_cost_recorder.h"
 #include "ui/base/gestures/gesture_configuration.h"
 #include "ui/base/hit_test.h"
 #include "ui/base/keycodes/keyboard_codes.h"
@@ -75,6 +78,8 @@ class EventCountFilter : public EventFilter {
   int num_key_events() const { return num_key_events_; }
   int num_mouse_events() const { return num_mouse_events_; }
 
+  void HandleOnly(int handled_events) { set_handled_events(handled_events); }
+
   void Reset() {
     num_key_events_ = 0;
     num_mouse_events_ = 0;
@@ -146,6 +151,59 @@ TEST_F(RootWindowTest, DispatchMouseEvent) {
   EXPECT_TRUE(delegate1->mouse_event_flags() & ui::EF_IS_NON_CLIENT);
 }
 
+namespace {
+
+// WindowCostRecorder that counts the events each window handled.
+class EventCostRecorder : public WindowCostRecorder {
+ public:
+  EventCostRecorder() {}
+
+  int GetEventCount(Window* window) { return event_counts_[window]; }
+
+  // Overridden from WindowCostRecorder:
+  virtual void OnWindowPainted(Window* window,
+                               base::TimeDelta duration) OVERRIDE {}
+  virtual void OnWindowHandledEvent(Window* window,
+                                    base::TimeDelta duration) OVERRIDE {
+    EXPECT_GE(duration.InMicroseconds(), 0);
+    event_counts_[window]++;
+  }
+
+ private:
+  std::map<Window*, int> event_counts_;
+
+  DISALLOW_COPY_AND_ASSIGN(EventCostRecorder);
+};
+
+}  // namespace
+
+// Verifies that the WindowCostRecorder of the Env hears about the events the
+// target window handled.
+TEST_F(RootWindowTest, WindowCostRecorder) {
+  scoped_ptr<NonClientDelegate> delegate1(new NonClientDelegate());
+  scoped_ptr<NonClientDelegate> delegate2(new NonClientDelegate());
+  scoped_ptr<Window> window1(CreateTestWindowWithDelegate(
+      delegate1.get(), 1, gfx::Rect(100, 200, 50, 50), NULL));
+  scoped_ptr<Window> window2(CreateTestWindowWithDelegate(
+      delegate2.get(), 2, gfx::Rect(300, 400, 50, 50), NULL));
+
+  EventCostRecorder recorder;
+  Env::GetInstance()->set_window_cost_recorder(&recorder);
+  gfx::Point point(101, 201);
+  MouseEvent event(ui::ET_MOUSE_PRESSED, point, point, ui::EF_LEFT_MOUSE_BUTTON);
+  root_window()->DispatchMouseEvent(&event);
+  Env::GetInstance()->set_window_cost_recorder(NULL);
+
+  EXPECT_EQ(1, recorder.GetEventCount(window1.get()));
+  EXPECT_EQ(0, recorder.GetEventCount(window2.get()));
+
+  // Nothing is recorded once the recorder is gone.
+  MouseEvent release(ui::ET_MOUSE_RELEASED, point, point,
+                     ui::EF_LEFT_MOUSE_BUTTON);
+  root_window()->DispatchMouseEvent(&release);
+  EXPECT_EQ(1, recorder.GetEventCount(window1.get()));
+}
+
 // Check that we correctly track the state of the mouse buttons in response to
 // button press and release events.
 TEST_F(RootWindowTest, MouseButtonState) {
@@ -329,6 +387,45 @@ TEST_F(RootWindowTest, CanProcessEventsWithinSubtree) {
   w3->parent()->RemoveChild(w3.get());
 }
 
+// Event filters only get the kinds of events they handle.
+TEST_F(RootWindowTest, EventFilterHandledEvents) {
+  EventCountFilter* filter = new EventCountFilter;
+  filter->HandleOnly(EventFilter::KEY_EVENTS);
+  root_window()->SetEventFilter(filter);  // passes ownership
+
+  test::TestWindowDelegate d;
+  scoped_ptr<Window> w1(test::CreateTestWindowWithDelegate(
+      &d, 1, gfx::Rect(10, 10, 20, 20), root_window()));
+  test::EventGenerator generator(root_window(), w1.get());
+  generator.ClickLeftButton();
+  EXPECT_EQ(0, filter->num_mouse_events());
+
+  generator.PressKey(ui::VKEY_A, 0);
+  EXPECT_EQ(1, filter->num_key_events());
+}
+
+// The filters events go through follow the filters being set and the windows
+// changing parents.
+TEST_F(RootWindowTest, EventFilterChainUpdates) {
+  test::TestWindowDelegate d;
+  scoped_ptr<Window> container(test::CreateTestWindowWithBounds(
+      gfx::Rect(0, 0, 100, 100), root_window()));
+  scoped_ptr<Window> w1(test::CreateTestWindowWithDelegate(
+      &d, 1, gfx::Rect(10, 10, 20, 20), container.get()));
+  test::EventGenerator generator(root_window(), w1.get());
+  generator.ClickLeftButton();
+
+  EventCountFilter* filter = new EventCountFilter;
+  container->SetEventFilter(filter);  // passes ownership
+  generator.ClickLeftButton();
+  EXPECT_LT(0, filter->num_mouse_events());
+
+  filter->Reset();
+  root_window()->AddChild(w1.get());
+  generator.ClickLeftButton();
+  EXPECT_EQ(0, filter->num_mouse_events());
+}
+
 TEST_F(RootWindowTest, IgnoreUnknownKeys) {
   EventCountFilter* filter = new EventCountFilter;
   root_window()->SetEventFilter(filter);  // passes ownership
@@ -643,4 +740,74 @@ TEST_F(RootWindowTest, HoldMouseMove) {
   EXPECT_TRUE(filter->events().empty());
 }
 
+TEST_F(RootWindowTest, QueueMoves) {
+  EventFilterRecorder* filter = new EventFilterRecorder;
+  root_window()->SetEventFilter(filter);  // passes ownership
+
+  test::TestWindowDelegate delegate;
+  scoped_ptr<aura::Window> window(CreateTestWindowWithDelegate(
+      &delegate, 1, gfx::Rect(0, 0, 100, 100), NULL));
+
+  MouseEvent mouse_move_event(ui::ET_MOUSE_MOVED, gfx::Point(0, 0),
+                              gfx::Point(0, 0), 0);
+  root_window()->DispatchMouseEvent(&mouse_move_event);
+  // Discard MOUSE_ENTER.
+  filter->events().clear();
+
+  // Consecutive moves are merged, and dispatched from a task.
+  MouseEvent mouse_move_event2(ui::ET_MOUSE_MOVED, gfx::Point(1, 1),
+                               gfx::Point(1, 1), 0);
+  MouseEvent mouse_move_event3(ui::ET_MOUSE_MOVED, gfx::Point(2, 2),
+                               gfx::Point(2, 2), 0);
+  root_window()->QueueMouseMove(mouse_move_event2);
+  root_window()->QueueMouseMove(mouse_move_event3);
+  EXPECT_TRUE(filter->events().empty());
+  RunAllPendingInMessageLoop();
+  EXPECT_EQ("MOUSE_MOVED", EventTypesToString(filter->events()));
+  EXPECT_EQ(gfx::Point(2, 2), root_window()->last_mouse_location());
+  filter->events().clear();
+
+  // A move is dispatched before the press that follows it.
+  MouseEvent mouse_pressed_event(ui::ET_MOUSE_PRESSED, gfx::Point(2, 2),
+                                 gfx::Point(2, 2), ui::EF_LEFT_MOUSE_BUTTON);
+  root_window()->QueueMouseMove(mouse_move_event2);
+  root_window()->DispatchMouseEvent(&mouse_pressed_event);
+  EXPECT_EQ("MOUSE_MOVED MOUSE_PRESSED",
+            EventTypesToString(filter->events()));
+  filter->events().clear();
+
+  // Drags don't replace moves.
+  MouseEvent mouse_dragged_event(ui::ET_MOUSE_DRAGGED, gfx::Point(3, 3),
+                                 gfx::Point(3, 3), ui::EF_LEFT_MOUSE_BUTTON);
+  root_window()->QueueMouseMove(mouse_move_event3);
+  root_window()->QueueMouseMove(mouse_dragged_event);
+  EXPECT_EQ("MOUSE_MOVED", EventTypesToString(filter->events()));
+  RunAllPendingInMessageLoop();
+  EXPECT_EQ("MOUSE_MOVED MOUSE_DRAGGED", EventTypesToString(filter->events()));
+  filter->events().clear();
+
+  // Touch moves are merged per touch.
+  base::TimeDelta time = base::TimeDelta::FromMilliseconds(0);
+  TouchEvent press0(ui::ET_TOUCH_PRESSED, gfx::Point(10, 10), 0, time);
+  TouchEvent press1(ui::ET_TOUCH_PRESSED, gfx::Point(50, 50), 1, time);
+  root_window()->DispatchTouchEvent(&press0);
+  root_window()->DispatchTouchEvent(&press1);
+  filter->events().clear();
+  for (int i = 1; i <= 3; ++i) {
+    time += base::TimeDelta::FromMilliseconds(1);
+    root_window()->QueueTouchMove(
+        TouchEvent(ui::ET_TOUCH_MOVED, gfx::Point(10 + i, 10), 0, time));
+    root_window()->QueueTouchMove(
+        TouchEvent(ui::ET_TOUCH_MOVED, gfx::Point(50 + i, 50), 1, time));
+  }
+  EXPECT_TRUE(filter->events().empty());
+  TouchEvent release0(ui::ET_TOUCH_RELEASED, gfx::Point(13, 10), 0, time);
+  root_window()->DispatchTouchEvent(&release0);
+  const EventFilterRecorder::Events& events = filter->events();
+  EventFilterRecorder::Events::const_iterator release =
+      std::find(events.begin(), events.end(), ui::ET_TOUCH_RELEASED);
+  ASSERT_TRUE(release != events.end());
+  EXPECT_EQ(2, std::count(events.begin(), release, ui::ET_TOUCH_MOVED));
+}
+
 }  // namespace aura
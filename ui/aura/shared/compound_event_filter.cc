@@ -147,7 +147,8 @@ ui::GestureStatus CompoundEventFilter::PreHandleGestureEvent(
     aura::EventFilter* filter;
     while (status == ui::GESTURE_STATUS_UNKNOWN &&
         (filter = it.GetNext()) != NULL) {
-      status = filter->PreHandleGestureEvent(target, event);
+      if (filter->handled_events() & GESTURE_EVENTS)
+        status = filter->PreHandleGestureEvent(target, event);
     }
   }
   return status;
@@ -173,8 +174,10 @@ bool CompoundEventFilter::FilterKeyEvent(aura::Window* target,
   if (filters_.might_have_observers()) {
     ObserverListBase<aura::EventFilter>::Iterator it(filters_);
     aura::EventFilter* filter;
-    while (!handled && (filter = it.GetNext()) != NULL)
-      handled = filter->PreHandleKeyEvent(target, event);
+    while (!handled && (filter = it.GetNext()) != NULL) {
+      if (filter->handled_events() & KEY_EVENTS)
+        handled = filter->PreHandleKeyEvent(target, event);
+    }
   }
   return handled;
 }
@@ -185,8 +188,10 @@ bool CompoundEventFilter::FilterMouseEvent(aura::Window* target,
   if (filters_.might_have_observers()) {
     ObserverListBase<aura::EventFilter>::Iterator it(filters_);
     aura::EventFilter* filter;
-    while (!handled && (filter = it.GetNext()) != NULL)
-      handled = filter->PreHandleMouseEvent(target, event);
+    while (!handled && (filter = it.GetNext()) != NULL) {
+      if (filter->handled_events() & MOUSE_EVENTS)
+        handled = filter->PreHandleMouseEvent(target, event);
+    }
   }
   return handled;
 }
@@ -200,7 +205,8 @@ ui::TouchStatus CompoundEventFilter::FilterTouchEvent(
     aura::EventFilter* filter;
     while (status == ui::TOUCH_STATUS_UNKNOWN &&
         (filter = it.GetNext()) != NULL) {
-      status = filter->PreHandleTouchEvent(target, event);
+      if (filter->handled_events() & TOUCH_EVENTS)
+        status = filter->PreHandleTouchEvent(target, event);
     }
   }
   return status;
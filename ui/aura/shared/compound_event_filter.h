@@ -25,7 +25,8 @@ namespace shared {
 // pass through those additional filters in their addition order and could be
 // consumed by any of those filters. If an event is consumed by a filter, the
 // rest of the filter(s) and CompoundEventFilter will not see the consumed
-// event.
+// event. Additional filters are skipped for the kinds of events they don't
+// handle.
 class AURA_EXPORT CompoundEventFilter : public aura::EventFilter {
  public:
   CompoundEventFilter();
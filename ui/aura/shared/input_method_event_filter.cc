@@ -20,6 +20,7 @@ InputMethodEventFilter::InputMethodEventFilter()
     : ALLOW_THIS_IN_INITIALIZER_LIST(
           input_method_(ui::CreateInputMethod(this))),
       target_root_window_(NULL) {
+  set_handled_events(KEY_EVENTS);
   // TODO(yusukes): Check if the root window is currently focused and pass the
   // result to Init().
   input_method_->Init(true);
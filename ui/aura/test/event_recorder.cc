@@ -0,0 +1,162 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/aura/test/event_recorder.h"
+
+#include <string>
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/string_number_conversions.h"
+#include "base/string_split.h"
+#include "base/stringprintf.h"
+#include "ui/aura/event.h"
+#include "ui/aura/root_window.h"
+
+namespace aura {
+namespace test {
+
+namespace {
+
+// The first line of the recordings.
+const char kHeader[] = "# aura input events 1";
+
+// The events that are recorded, with their names in the recordings.
+struct RecordedType {
+  ui::EventType type;
+  const char* name;
+};
+
+const RecordedType kRecordedTypes[] = {
+  { ui::ET_MOUSE_PRESSED, "mouse_pressed" },
+  { ui::ET_MOUSE_DRAGGED, "mouse_dragged" },
+  { ui::ET_MOUSE_RELEASED, "mouse_released" },
+  { ui::ET_MOUSE_MOVED, "mouse_moved" },
+  { ui::ET_KEY_PRESSED, "key_pressed" },
+  { ui::ET_KEY_RELEASED, "key_released" },
+  { ui::ET_TOUCH_RELEASED, "touch_released" },
+  { ui::ET_TOUCH_PRESSED, "touch_pressed" },
+  { ui::ET_TOUCH_MOVED, "touch_moved" },
+  { ui::ET_TOUCH_CANCELLED, "touch_cancelled" },
+};
+
+// Returns the name of |type| in the recordings, or NULL if it isn't recorded.
+const char* GetTypeName(ui::EventType type) {
+  for (size_t i = 0; i < arraysize(kRecordedTypes); ++i) {
+    if (kRecordedTypes[i].type == type)
+      return kRecordedTypes[i].name;
+  }
+  return NULL;
+}
+
+bool GetTypeForName(const std::string& name, ui::EventType* type) {
+  for (size_t i = 0; i < arraysize(kRecordedTypes); ++i) {
+    if (name == kRecordedTypes[i].name) {
+      *type = kRecordedTypes[i].type;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsKeyType(ui::EventType type) {
+  return type == ui::ET_KEY_PRESSED || type == ui::ET_KEY_RELEASED;
+}
+
+bool IsTouchType(ui::EventType type) {
+  return type == ui::ET_TOUCH_RELEASED || type == ui::ET_TOUCH_PRESSED ||
+      type == ui::ET_TOUCH_MOVED || type == ui::ET_TOUCH_CANCELLED;
+}
+
+}  // namespace
+
+RecordedEvent::RecordedEvent()
+    : type(ui::ET_UNKNOWN),
+      flags(0),
+      code(0) {
+}
+
+bool WriteRecordedEvents(const FilePath& path, const RecordedEvents& events) {
+  std::string data(kHeader);
+  data += "\n";
+  for (size_t i = 0; i < events.size(); ++i) {
+    const RecordedEvent& event = events[i];
+    std::string time = base::Int64ToString(event.time.InMicroseconds());
+    base::StringAppendF(&data, "%s %s %d %d %d %d\n",
+                        time.c_str(), GetTypeName(event.type),
+                        event.location.x(), event.location.y(),
+                        event.flags, event.code);
+  }
+  return file_util::WriteFile(path, data.data(), data.size()) ==
+      static_cast<int>(data.size());
+}
+
+bool ReadRecordedEvents(const FilePath& path, RecordedEvents* events) {
+  std::string data;
+  if (!file_util::ReadFileToString(path, &data))
+    return false;
+  std::vector<std::string> lines;
+  base::SplitString(data, '\n', &lines);
+  if (lines.empty() || lines[0] != kHeader)
+    return false;
+
+  events->clear();
+  for (size_t i = 1; i < lines.size(); ++i) {
+    if (lines[i].empty())
+      continue;
+    std::vector<std::string> fields;
+    base::SplitString(lines[i], ' ', &fields);
+    RecordedEvent event;
+    int64 time = 0;
+    int x = 0;
+    int y = 0;
+    if (fields.size() != 6 ||
+        !base::StringToInt64(fields[0], &time) ||
+        !GetTypeForName(fields[1], &event.type) ||
+        !base::StringToInt(fields[2], &x) ||
+        !base::StringToInt(fields[3], &y) ||
+        !base::StringToInt(fields[4], &event.flags) ||
+        !base::StringToInt(fields[5], &event.code)) {
+      return false;
+    }
+    event.time = base::TimeDelta::FromMicroseconds(time);
+    event.location.SetPoint(x, y);
+    events->push_back(event);
+  }
+  return true;
+}
+
+EventRecorder::EventRecorder(RootWindow* root_window)
+    : root_window_(root_window),
+      start_time_(base::TimeTicks::Now()) {
+  root_window_->input_latency_tracker()->AddObserver(this);
+}
+
+EventRecorder::~EventRecorder() {
+  root_window_->input_latency_tracker()->RemoveObserver(this);
+}
+
+void EventRecorder::OnInputStarted(const Event& event) {
+  if (!GetTypeName(event.type()) || (event.flags() & ui::EF_IS_SYNTHESIZED))
+    return;
+
+  RecordedEvent recorded;
+  recorded.time = base::TimeTicks::Now() - start_time_;
+  recorded.type = event.type();
+  recorded.flags = event.flags();
+  if (IsKeyType(event.type())) {
+    const KeyEvent& key_event = static_cast<const KeyEvent&>(event);
+    if (key_event.is_char())
+      return;
+    recorded.code = key_event.key_code();
+  } else {
+    recorded.location = static_cast<const LocatedEvent&>(event).location();
+    if (IsTouchType(event.type()))
+      recorded.code = static_cast<const TouchEvent&>(event).touch_id();
+  }
+  events_.push_back(recorded);
+}
+
+}  // namespace test
+}  // namespace aura
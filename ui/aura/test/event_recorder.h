@@ -0,0 +1,73 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_AURA_TEST_EVENT_RECORDER_H_
+#define UI_AURA_TEST_EVENT_RECORDER_H_
+#pragma once
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/time.h"
+#include "ui/aura/input_latency_tracker.h"
+#include "ui/base/events.h"
+#include "ui/gfx/point.h"
+
+class FilePath;
+
+namespace aura {
+class RootWindow;
+
+namespace test {
+
+// An input event as the RootWindow dispatched it, in host coordinates.
+struct RecordedEvent {
+  RecordedEvent();
+
+  // The time since the recording started.
+  base::TimeDelta time;
+  ui::EventType type;
+  gfx::Point location;
+  int flags;
+  // The key code of key events, the touch id of touch events.
+  int code;
+};
+
+typedef std::vector<RecordedEvent> RecordedEvents;
+
+// Writes |events| to the file at |path|, one per line, as text. Returns false
+// if the file could not be written.
+bool WriteRecordedEvents(const FilePath& path, const RecordedEvents& events);
+
+// Sets |events| to the events of the file at |path|. Returns false if the
+// file could not be read or is not a recording.
+bool ReadRecordedEvents(const FilePath& path, RecordedEvents* events);
+
+// EventRecorder records the mouse, key and touch events a RootWindow
+// dispatches, so that EventReplayer can dispatch them again. Events the
+// RootWindow makes itself (gestures, synthesized moves) and events the input
+// method translates are left out: replaying the others makes them again.
+class EventRecorder : public InputLatencyTracker::Observer {
+ public:
+  explicit EventRecorder(RootWindow* root_window);
+  virtual ~EventRecorder();
+
+  const RecordedEvents& events() const { return events_; }
+
+  // Overridden from InputLatencyTracker::Observer:
+  virtual void OnInputStarted(const Event& event) OVERRIDE;
+
+ private:
+  RootWindow* root_window_;
+  base::TimeTicks start_time_;
+  RecordedEvents events_;
+
+  DISALLOW_COPY_AND_ASSIGN(EventRecorder);
+};
+
+}  // namespace test
+}  // namespace aura
+
+#endif  // UI_AURA_TEST_EVENT_RECORDER_H_
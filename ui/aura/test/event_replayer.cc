@@ -0,0 +1,109 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/aura/test/event_replayer.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/message_loop.h"
+#include "ui/aura/event.h"
+#include "ui/aura/root_window.h"
+
+namespace aura {
+namespace test {
+
+EventReplayer::EventReplayer(RootWindow* root_window,
+                             const RecordedEvents& events)
+    : root_window_(root_window),
+      events_(events),
+      next_event_(0),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
+  root_window_->input_latency_tracker()->AddObserver(this);
+}
+
+EventReplayer::~EventReplayer() {
+  root_window_->input_latency_tracker()->RemoveObserver(this);
+}
+
+void EventReplayer::Start(const base::Closure& done) {
+  weak_factory_.InvalidateWeakPtrs();
+  next_event_ = 0;
+  latencies_.clear();
+  done_ = done;
+  start_time_ = base::TimeTicks::Now();
+  PostNextEvent();
+}
+
+base::TimeDelta EventReplayer::GetLatencyPercentile(double percentile) const {
+  if (latencies_.empty())
+    return base::TimeDelta();
+  std::vector<base::TimeDelta> sorted(latencies_);
+  std::sort(sorted.begin(), sorted.end());
+  size_t index = static_cast<size_t>(
+      percentile / 100 * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void EventReplayer::OnInputLatency(ui::EventType type,
+                                   base::TimeDelta latency) {
+  latencies_.push_back(latency);
+  MaybeFinish();
+}
+
+void EventReplayer::DispatchNextEvent() {
+  const RecordedEvent& recorded = events_[next_event_++];
+  switch (recorded.type) {
+    case ui::ET_KEY_PRESSED:
+    case ui::ET_KEY_RELEASED: {
+      KeyEvent event(recorded.type,
+                     static_cast<ui::KeyboardCode>(recorded.code),
+                     recorded.flags);
+      root_window_->DispatchKeyEvent(&event);
+      break;
+    }
+    case ui::ET_TOUCH_RELEASED:
+    case ui::ET_TOUCH_PRESSED:
+    case ui::ET_TOUCH_MOVED:
+    case ui::ET_TOUCH_CANCELLED: {
+      TouchEvent event(recorded.type, recorded.location, recorded.code,
+                       recorded.time);
+      root_window_->DispatchTouchEvent(&event);
+      break;
+    }
+    default: {
+      MouseEvent event(recorded.type, recorded.location, recorded.location,
+                       recorded.flags);
+      root_window_->DispatchMouseEvent(&event);
+      break;
+    }
+  }
+  PostNextEvent();
+}
+
+void EventReplayer::PostNextEvent() {
+  if (next_event_ == events_.size()) {
+    MaybeFinish();
+    return;
+  }
+  base::TimeDelta delay =
+      start_time_ + events_[next_event_].time - base::TimeTicks::Now();
+  MessageLoop::current()->PostDelayedTask(
+      FROM_HERE,
+      base::Bind(&EventReplayer::DispatchNextEvent, weak_factory_.GetWeakPtr()),
+      std::max(delay, base::TimeDelta()));
+}
+
+void EventReplayer::MaybeFinish() {
+  if (done_.is_null() || next_event_ < events_.size() ||
+      root_window_->input_latency_tracker()->pending_input_count()) {
+    return;
+  }
+  base::Closure done = done_;
+  done_.Reset();
+  done.Run();
+}
+
+}  // namespace test
+}  // namespace aura
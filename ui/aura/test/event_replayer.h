@@ -0,0 +1,74 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_AURA_TEST_EVENT_REPLAYER_H_
+#define UI_AURA_TEST_EVENT_REPLAYER_H_
+#pragma once
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/compiler_specific.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time.h"
+#include "ui/aura/input_latency_tracker.h"
+#include "ui/aura/test/event_recorder.h"
+
+namespace aura {
+class RootWindow;
+
+namespace test {
+
+// EventReplayer dispatches recorded events to a RootWindow again, each from a
+// task posted to the current message loop at the time it was recorded, and
+// collects the latencies of the inputs. Replaying a recording dispatches the
+// same events in the same order every time.
+class EventReplayer : public InputLatencyTracker::Observer {
+ public:
+  EventReplayer(RootWindow* root_window, const RecordedEvents& events);
+  virtual ~EventReplayer();
+
+  // Starts replaying the events. |done| is run once all of them have been
+  // dispatched and the frames showing them have ended.
+  void Start(const base::Closure& done);
+
+  // The latencies of the inputs that were shown, in the order their frames
+  // ended.
+  const std::vector<base::TimeDelta>& latencies() const { return latencies_; }
+
+  // Returns the |percentile|th percentile of latencies(), or zero if there
+  // are none.
+  base::TimeDelta GetLatencyPercentile(double percentile) const;
+
+  // Overridden from InputLatencyTracker::Observer:
+  virtual void OnInputLatency(ui::EventType type,
+                              base::TimeDelta latency) OVERRIDE;
+
+ private:
+  // Dispatches the next event, and posts the one after it.
+  void DispatchNextEvent();
+
+  // Posts DispatchNextEvent() at the time of the next event.
+  void PostNextEvent();
+
+  // Runs |done_| if the replay is over.
+  void MaybeFinish();
+
+  RootWindow* root_window_;
+  RecordedEvents events_;
+  size_t next_event_;
+  base::TimeTicks start_time_;
+  base::Closure done_;
+  std::vector<base::TimeDelta> latencies_;
+
+  base::WeakPtrFactory<EventReplayer> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(EventReplayer);
+};
+
+}  // namespace test
+}  // namespace aura
+
+#endif  // UI_AURA_TEST_EVENT_REPLAYER_H_
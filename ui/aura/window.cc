@@ -5,6 +5,7 @@
 #include "ui/aura/window.h"
 
 #include <algorithm>
+#include <functional>
 
 #include "base/bind.h"
 #include "base/bind_helpers.h"
@@ -23,8 +24,10 @@
 #include "ui/aura/focus_manager.h"
 #include "ui/aura/layout_manager.h"
 #include "ui/aura/root_window.h"
+#include "ui/aura/window_cost_recorder.h"
 #include "ui/aura/window_delegate.h"
 #include "ui/aura/window_observer.h"
+#include "ui/aura/window_tree_batch_update.h"
 #include "ui/base/animation/multi_animation.h"
 #include "ui/compositor/compositor.h"
 #include "ui/compositor/layer.h"
@@ -44,6 +47,14 @@ Window* GetParentForWindow(Window* window, Window* suggested_parent) {
   return NULL;
 }
 
+// Orders the properties of a window by key.
+struct PropertyKeyLess {
+  template<typename Property>
+  bool operator()(const Property& property, const void* key) const {
+    return std::less<const void*>()(property.first, key);
+  }
+};
+
 }  // namespace
 
 Window::TestApi::TestApi(Window* window) : window_(window) {}
@@ -62,7 +73,8 @@ Window::Window(WindowDelegate* delegate)
       id_(-1),
       transparent_(false),
       user_data_(NULL),
-      ignore_events_(false) {
+      ignore_events_(false),
+      set_slots_(0) {
 }
 
 Window::~Window() {
@@ -76,6 +88,8 @@ Window::~Window() {
     delegate_->OnWindowDestroying();
   FOR_EACH_OBSERVER(WindowObserver, observers_, OnWindowDestroying(this));
 
+  WindowTreeBatchUpdate::ForgetWindow(this);
+
   // Let the root know so that it can remove any references to us.
   RootWindow* root_window = GetRootWindow();
   if (root_window)
@@ -123,14 +137,15 @@ Window::~Window() {
 
   FOR_EACH_OBSERVER(WindowObserver, observers_, OnWindowDestroyed(this));
 
-  // Clear properties.
-  for (std::map<const void*, Value>::const_iterator iter = prop_map_.begin();
-       iter != prop_map_.end();
+  // Clear properties. Those with a slot are never owned.
+  for (Properties::const_iterator iter = properties_.begin();
+       iter != properties_.end();
        ++iter) {
     if (iter->second.deallocator)
       (*iter->second.deallocator)(iter->second.value);
   }
-  prop_map_.clear();
+  properties_.clear();
+  set_slots_ = 0;
 
   // If we have layer it will either be destroyed by layer_owner_'s dtor, or by
   // whoever acquired it. We don't have a layer if Init() wasn't invoked, which
@@ -422,6 +437,7 @@ gfx::NativeCursor Window::GetCursor(const gfx::Point& point) const {
 
 void Window::SetEventFilter(EventFilter* event_filter) {
   event_filter_.reset(event_filter);
+  Env::EventFiltersChanged();
 }
 
 void Window::AddObserver(WindowObserver* observer) {
@@ -565,12 +581,13 @@ void Window::SuppressPaint() {
 // {Set,Get,Clear}Property are implemented in window_property.h.
 
 void Window::SetNativeWindowProperty(const char* key, void* value) {
-  SetPropertyInternal(
-      key, key, NULL, reinterpret_cast<intptr_t>(value), 0);
+  SetPropertyInternal(key, WINDOW_PROPERTY_SLOT_NONE, key, NULL,
+                      reinterpret_cast<intptr_t>(value), 0);
 }
 
 void* Window::GetNativeWindowProperty(const char* key) const {
-  return reinterpret_cast<void*>(GetPropertyInternal(key, 0));
+  return reinterpret_cast<void*>(
+      GetPropertyInternal(key, WINDOW_PROPERTY_SLOT_NONE, 0));
 }
 
 void Window::OnDeviceScaleFactorChanged(float device_scale_factor) {
@@ -582,19 +599,39 @@ void Window::OnDeviceScaleFactorChanged(float device_scale_factor) {
 // Window, private:
 
 intptr_t Window::SetPropertyInternal(const void* key,
+                                     WindowPropertySlot slot,
                                      const char* name,
                                      PropertyDeallocator deallocator,
                                      intptr_t value,
                                      intptr_t default_value) {
-  intptr_t old = GetPropertyInternal(key, default_value);
-  if (value == default_value) {
-    prop_map_.erase(key);
+  intptr_t old = GetPropertyInternal(key, slot, default_value);
+  if (slot != WINDOW_PROPERTY_SLOT_NONE) {
+    DCHECK_LT(slot, WINDOW_PROPERTY_SLOT_COUNT);
+    DCHECK(!deallocator);
+    const uint32 bit = 1u << (slot - 1);
+    if (value == default_value) {
+      set_slots_ &= ~bit;
+    } else {
+      slot_values_[slot - 1] = value;
+      set_slots_ |= bit;
+    }
   } else {
-    Value prop_value;
-    prop_value.name = name;
-    prop_value.value = value;
-    prop_value.deallocator = deallocator;
-    prop_map_[key] = prop_value;
+    Properties::iterator iter = std::lower_bound(
+        properties_.begin(), properties_.end(), key, PropertyKeyLess());
+    bool found = iter != properties_.end() && iter->first == key;
+    if (value == default_value) {
+      if (found)
+        properties_.erase(iter);
+    } else {
+      Value prop_value;
+      prop_value.name = name;
+      prop_value.value = value;
+      prop_value.deallocator = deallocator;
+      if (found)
+        iter->second = prop_value;
+      else
+        properties_.insert(iter, std::make_pair(key, prop_value));
+    }
   }
   FOR_EACH_OBSERVER(WindowObserver, observers_,
                     OnWindowPropertyChanged(this, key, old));
@@ -602,9 +639,15 @@ intptr_t Window::SetPropertyInternal(const void* key,
 }
 
 intptr_t Window::GetPropertyInternal(const void* key,
+                                     WindowPropertySlot slot,
                                      intptr_t default_value) const {
-  std::map<const void*, Value>::const_iterator iter = prop_map_.find(key);
-  if (iter == prop_map_.end())
+  if (slot != WINDOW_PROPERTY_SLOT_NONE) {
+    return set_slots_ & (1u << (slot - 1)) ?
+        slot_values_[slot - 1] : default_value;
+  }
+  Properties::const_iterator iter = std::lower_bound(
+      properties_.begin(), properties_.end(), key, PropertyKeyLess());
+  if (iter == properties_.end() || iter->first != key)
     return default_value;
   return iter->second.value;
 }
@@ -689,17 +732,17 @@ Window* Window::GetWindowForPoint(const gfx::Point& local_point,
   if (!return_tightest && delegate_)
     return this;
 
+  // The client may not allow events to be processed by certain subtrees.
+  client::EventClient* client =
+      for_event_handling ? client::GetEventClient(GetRootWindow()) : NULL;
+
   for (Windows::const_reverse_iterator it = children_.rbegin(),
            rend = children_.rend();
        it != rend; ++it) {
     Window* child = *it;
 
-    if (for_event_handling) {
-      // The client may not allow events to be processed by certain subtrees.
-      client::EventClient* client = client::GetEventClient(GetRootWindow());
-      if (client && !client->CanProcessEventsWithinSubtree(child))
-        continue;
-    }
+    if (client && !client->CanProcessEventsWithinSubtree(child))
+      continue;
 
     // We don't process events for invisible windows or those that have asked
     // to ignore events.
@@ -707,7 +750,19 @@ Window* Window::GetWindowForPoint(const gfx::Point& local_point,
       continue;
 
     gfx::Point point_in_child_coords(local_point);
-    Window::ConvertPointToWindow(this, child, &point_in_child_coords);
+    if (child->layer()->transform().HasChange()) {
+      Window::ConvertPointToWindow(this, child, &point_in_child_coords);
+    } else {
+      // Most children aren't transformed. Those the point misses are skipped
+      // without the cost of converting it through the layer tree.
+      gfx::Rect child_bounds(child->bounds());
+      if (for_event_handling)
+        child_bounds.Inset(child->hit_test_bounds_override_outer_);
+      if (!child_bounds.Contains(local_point))
+        continue;
+      point_in_child_coords.Offset(-child->bounds().x(),
+                                   -child->bounds().y());
+    }
     if (for_event_handling && delegate_ &&
         !delegate_->ShouldDescendIntoChildForEventHandling(
             child, local_point)) {
@@ -725,6 +780,7 @@ Window* Window::GetWindowForPoint(const gfx::Point& local_point,
 }
 
 void Window::OnParentChanged() {
+  Env::EventFiltersChanged();
   FOR_EACH_OBSERVER(
       WindowObserver, observers_, OnWindowParentChanged(this, parent_));
 }
@@ -810,6 +866,8 @@ void Window::StackChildRelativeToImpl(Window* child,
 }
 
 void Window::OnStackingChanged() {
+  if (WindowTreeBatchUpdate::DeferStackingChange(this))
+    return;
   FOR_EACH_OBSERVER(WindowObserver, observers_, OnWindowStackingChanged(this));
 }
 
@@ -833,6 +891,10 @@ void Window::NotifyAddedToRootWindow() {
 
 void Window::OnLayerBoundsChanged(const gfx::Rect& old_bounds,
                                   bool contained_mouse) {
+  if (WindowTreeBatchUpdate::DeferBoundsChange(this, old_bounds,
+                                               contained_mouse)) {
+    return;
+  }
   if (layout_manager_.get())
     layout_manager_->OnWindowResized();
   if (delegate_)
@@ -846,8 +908,16 @@ void Window::OnLayerBoundsChanged(const gfx::Rect& old_bounds,
 }
 
 void Window::OnPaintLayer(gfx::Canvas* canvas) {
-  if (delegate_)
+  if (!delegate_)
+    return;
+  WindowCostRecorder* recorder = Env::GetInstance()->window_cost_recorder();
+  if (!recorder) {
     delegate_->OnPaint(canvas);
+    return;
+  }
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  delegate_->OnPaint(canvas);
+  recorder->OnWindowPainted(this, base::TimeTicks::HighResNow() - start);
 }
 
 base::Closure Window::PrepareForLayerBoundsChange() {
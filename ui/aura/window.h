@@ -6,7 +6,6 @@
 #define UI_AURA_WINDOW_H_
 #pragma once
 
-#include <map>
 #include <string>
 #include <vector>
 
@@ -48,6 +47,23 @@ class WindowObserver;
 template<typename T>
 struct WindowProperty;
 
+// The framework's properties that are read on every event, activation or focus
+// change, each of which every Window keeps in a slot of its own instead of
+// looking it up among its other properties. See
+// DEFINE_WINDOW_PROPERTY_KEY_IN_SLOT in window_property.h.
+enum WindowPropertySlot {
+  WINDOW_PROPERTY_SLOT_NONE = 0,
+  WINDOW_PROPERTY_SLOT_ACTIVATION_CLIENT,
+  WINDOW_PROPERTY_SLOT_ALWAYS_ON_TOP,
+  WINDOW_PROPERTY_SLOT_CAPTURE_CLIENT,
+  WINDOW_PROPERTY_SLOT_EVENT_CLIENT,
+  WINDOW_PROPERTY_SLOT_HIDE_ON_DEACTIVATE,
+  WINDOW_PROPERTY_SLOT_INPUT_METHOD,
+  WINDOW_PROPERTY_SLOT_MODAL,
+  WINDOW_PROPERTY_SLOT_SHOW_STATE,
+  WINDOW_PROPERTY_SLOT_COUNT
+};
+
 // Aura window implementation. Interesting events are sent to the
 // WindowDelegate.
 // TODO(beng): resolve ownership.
@@ -339,6 +355,7 @@ class AURA_EXPORT Window : public ui::LayerDelegate,
 
  private:
   friend class LayoutManager;
+  friend class WindowTreeBatchUpdate;
 
   // Used when stacking windows.
   enum StackDirection {
@@ -348,11 +365,14 @@ class AURA_EXPORT Window : public ui::LayerDelegate,
 
   // Called by the public {Set,Get,Clear}Property functions.
   intptr_t SetPropertyInternal(const void* key,
+                               WindowPropertySlot slot,
                                const char* name,
                                PropertyDeallocator deallocator,
                                intptr_t value,
                                intptr_t default_value);
-  intptr_t GetPropertyInternal(const void* key, intptr_t default_value) const;
+  intptr_t GetPropertyInternal(const void* key,
+                               WindowPropertySlot slot,
+                               intptr_t default_value) const;
 
   // Changes the bounds of the window without condition.
   void SetBoundsInternal(const gfx::Rect& new_bounds);
@@ -471,8 +491,17 @@ class AURA_EXPORT Window : public ui::LayerDelegate,
     intptr_t value;
     PropertyDeallocator deallocator;
   };
+  typedef std::vector<std::pair<const void*, Value> > Properties;
+
+  // The properties without a slot that aren't at their default, sorted by
+  // key. A window has a handful, which a vector finds faster than a map
+  // and keeps without an allocation each.
+  Properties properties_;
 
-  std::map<const void*, Value> prop_map_;
+  // The values of the properties with a slot, at slot - 1, and a bit per slot,
+  // 1 << (slot - 1), that is set if the property isn't at its default.
+  intptr_t slot_values_[WINDOW_PROPERTY_SLOT_COUNT - 1];
+  uint32 set_slots_;
 
   DISALLOW_COPY_AND_ASSIGN(Window);
 };
@@ -0,0 +1,35 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_AURA_WINDOW_COST_RECORDER_H_
+#define UI_AURA_WINDOW_COST_RECORDER_H_
+#pragma once
+
+#include "base/time.h"
+#include "ui/aura/aura_export.h"
+
+namespace aura {
+
+class Window;
+
+// Receives the time windows spend painting and handling events, for debugging
+// tools such as Oak. Windows only time their work while a recorder is set on
+// the Env, see Env::set_window_cost_recorder().
+class AURA_EXPORT WindowCostRecorder {
+ public:
+  // Invoked after the delegate of |window| painted its layer.
+  virtual void OnWindowPainted(Window* window, base::TimeDelta duration) = 0;
+
+  // Invoked after the delegate of |window| handled an event. The delegate may
+  // have deleted |window|, so it must not be dereferenced.
+  virtual void OnWindowHandledEvent(Window* window,
+                                    base::TimeDelta duration) = 0;
+
+ protected:
+  virtual ~WindowCostRecorder() {}
+};
+
+}  // namespace aura
+
+#endif  // UI_AURA_WINDOW_COST_RECORDER_H_
@@ -33,6 +33,12 @@
 //    // namespace which cannot be accessed from another file.
 //    DEFINE_LOCAL_WINDOW_PROPERTY_KEY(MyType, kMyKey, MyDefault);
 //
+//    // Use this instead of DEFINE_WINDOW_PROPERTY_KEY for a property of the
+//    // framework that is read on every event, to keep it in a slot of every
+//    // window. Add the slot to WindowPropertySlot in window.h.
+//    DEFINE_WINDOW_PROPERTY_KEY_IN_SLOT(MyType, kMyKey, MyDefault,
+//                                       WINDOW_PROPERTY_SLOT_MY);
+//
 //  }  // foo namespace
 //
 // To define a new type used for WindowProperty.
@@ -76,12 +82,16 @@ struct WindowProperty {
   T default_value;
   const char* name;
   Window::PropertyDeallocator deallocator;
+  // WINDOW_PROPERTY_SLOT_NONE unless the key is defined in a slot. Owned
+  // properties never are.
+  WindowPropertySlot slot;
 };
 
 template<typename T>
 void Window::SetProperty(const WindowProperty<T>* property, T value) {
   intptr_t old = SetPropertyInternal(
       property,
+      property->slot,
       property->name,
       value == property->default_value ? NULL : property->deallocator,
       WindowPropertyCaster<T>::ToIntptrT(value),
@@ -95,7 +105,8 @@ void Window::SetProperty(const WindowProperty<T>* property, T value) {
 template<typename T>
 T Window::GetProperty(const WindowProperty<T>* property) const {
   return WindowPropertyCaster<T>::FromIntptrT(GetPropertyInternal(
-      property, WindowPropertyCaster<T>::ToIntptrT(property->default_value)));
+      property, property->slot,
+      WindowPropertyCaster<T>::ToIntptrT(property->default_value)));
 }
 
 template<typename T>
@@ -122,6 +133,13 @@ void Window::ClearProperty(const WindowProperty<T>* property) {
   }                                                                           \
   const aura::WindowProperty<TYPE>* const NAME = & NAME ## _Value;
 
+#define DEFINE_WINDOW_PROPERTY_KEY_IN_SLOT(TYPE, NAME, DEFAULT, SLOT) \
+  namespace {                                                       \
+    const aura::WindowProperty<TYPE> NAME ## _Value =               \
+        {DEFAULT, #NAME, NULL, aura::SLOT};                         \
+  }                                                                 \
+  const aura::WindowProperty<TYPE>* const NAME = & NAME ## _Value;
+
 #define DEFINE_LOCAL_WINDOW_PROPERTY_KEY(TYPE, NAME, DEFAULT) \
   namespace {                                                                 \
     const aura::WindowProperty<TYPE> NAME ## _Value = {DEFAULT, #NAME, NULL}; \
@@ -0,0 +1,114 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/aura/window_tree_batch_update.h"
+
+#include <algorithm>
+
+#include "ui/aura/window.h"
+
+namespace aura {
+
+namespace {
+
+// The outermost batch in scope. Windows live on the UI thread only.
+WindowTreeBatchUpdate* g_current_batch = NULL;
+
+}  // namespace
+
+WindowTreeBatchUpdate::WindowTreeBatchUpdate() : flushing_(false) {
+  if (!g_current_batch)
+    g_current_batch = this;
+}
+
+WindowTreeBatchUpdate::~WindowTreeBatchUpdate() {
+  if (g_current_batch != this)
+    return;
+  Flush();
+  g_current_batch = NULL;
+}
+
+// static
+bool WindowTreeBatchUpdate::DeferBoundsChange(Window* window,
+                                              const gfx::Rect& old_bounds,
+                                              bool contained_mouse) {
+  WindowTreeBatchUpdate* batch = g_current_batch;
+  if (!batch || batch->flushing_)
+    return false;
+
+  std::map<Window*, BoundsChange>::iterator it =
+      batch->bounds_changes_.find(window);
+  if (it != batch->bounds_changes_.end()) {
+    // The first old bounds stay; the mouse may have been in any of them.
+    it->second.contained_mouse |= contained_mouse;
+    return true;
+  }
+
+  if (!batch->stacking_changes_.count(window))
+    batch->changed_windows_.push_back(window);
+  BoundsChange& change = batch->bounds_changes_[window];
+  change.old_bounds = old_bounds;
+  change.contained_mouse = contained_mouse;
+  return true;
+}
+
+// static
+bool WindowTreeBatchUpdate::DeferStackingChange(Window* window) {
+  WindowTreeBatchUpdate* batch = g_current_batch;
+  if (!batch || batch->flushing_)
+    return false;
+
+  if (!batch->stacking_changes_.count(window) &&
+      !batch->bounds_changes_.count(window)) {
+    batch->changed_windows_.push_back(window);
+  }
+  batch->stacking_changes_.insert(window);
+  return true;
+}
+
+// static
+void WindowTreeBatchUpdate::ForgetWindow(Window* window) {
+  WindowTreeBatchUpdate* batch = g_current_batch;
+  if (!batch)
+    return;
+
+  std::vector<Window*>::iterator it = std::find(
+      batch->changed_windows_.begin(), batch->changed_windows_.end(), window);
+  if (it == batch->changed_windows_.end())
+    return;
+  batch->changed_windows_.erase(it);
+  batch->bounds_changes_.erase(window);
+  batch->stacking_changes_.erase(window);
+}
+
+void WindowTreeBatchUpdate::Flush() {
+  flushing_ = true;
+  // The notifications may destroy windows that haven't notified yet, which
+  // then forget themselves, so each window is taken off the lists before it
+  // notifies.
+  while (!changed_windows_.empty()) {
+    Window* window = changed_windows_.front();
+    changed_windows_.erase(changed_windows_.begin());
+
+    std::map<Window*, BoundsChange>::iterator bounds_it =
+        bounds_changes_.find(window);
+    bool bounds_changed = bounds_it != bounds_changes_.end();
+    BoundsChange bounds_change;
+    if (bounds_changed) {
+      bounds_change = bounds_it->second;
+      bounds_changes_.erase(bounds_it);
+    }
+    bool stacking_changed = stacking_changes_.erase(window) > 0;
+
+    if (bounds_changed) {
+      window->OnLayerBoundsChanged(bounds_change.old_bounds,
+                                   bounds_change.contained_mouse);
+    }
+    if (stacking_changed)
+      window->OnStackingChanged();
+  }
+  flushing_ = false;
+}
+
+}  // namespace aura
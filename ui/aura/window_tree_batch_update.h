@@ -0,0 +1,72 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_AURA_WINDOW_TREE_BATCH_UPDATE_H_
+#define UI_AURA_WINDOW_TREE_BATCH_UPDATE_H_
+#pragma once
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "ui/aura/aura_export.h"
+#include "ui/gfx/rect.h"
+
+namespace aura {
+
+class Window;
+
+// While a WindowTreeBatchUpdate is in scope, windows whose bounds or stacking
+// change don't notify their layout manager, delegate, observers and root
+// window right away. When the outermost batch goes out of scope, each window
+// notifies once: with the bounds it had before its first change, and the
+// bounds it ends up with. This turns the layout of many windows, e.g. when
+// switching workspaces, from one relayout per change into one per window.
+//
+// Windows are still added, removed and restacked right away, and the
+// notifications of those that are added or removed are not deferred, as
+// layout managers track their children with them.
+class AURA_EXPORT WindowTreeBatchUpdate {
+ public:
+  WindowTreeBatchUpdate();
+  ~WindowTreeBatchUpdate();
+
+ private:
+  friend class Window;
+
+  struct BoundsChange {
+    gfx::Rect old_bounds;
+    bool contained_mouse;
+  };
+
+  // Called by |window| when its bounds or stacking change. Return true if
+  // the notifications are deferred until the end of the outermost batch.
+  static bool DeferBoundsChange(Window* window,
+                                const gfx::Rect& old_bounds,
+                                bool contained_mouse);
+  static bool DeferStackingChange(Window* window);
+
+  // Called by |window| when it is destroyed, so that it doesn't notify.
+  static void ForgetWindow(Window* window);
+
+  // Sends the deferred notifications, in the order the windows first
+  // changed.
+  void Flush();
+
+  // Whether Flush() is running. Changes made while flushing aren't deferred.
+  bool flushing_;
+
+  // The windows with deferred notifications, in the order they first
+  // changed, and what changed.
+  std::vector<Window*> changed_windows_;
+  std::map<Window*, BoundsChange> bounds_changes_;
+  std::set<Window*> stacking_changes_;
+
+  DISALLOW_COPY_AND_ASSIGN(WindowTreeBatchUpdate);
+};
+
+}  // namespace aura
+
+#endif  // UI_AURA_WINDOW_TREE_BATCH_UPDATE_H_
@@ -10,6 +10,7 @@
 #include "base/compiler_specific.h"
 #include "base/stringprintf.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "ui/aura/client/aura_constants.h"
 #include "ui/aura/client/capture_client.h"
 #include "ui/aura/client/stacking_client.h"
 #include "ui/aura/client/visibility_client.h"
@@ -25,6 +26,7 @@
 #include "ui/aura/window_delegate.h"
 #include "ui/aura/window_observer.h"
 #include "ui/aura/window_property.h"
+#include "ui/aura/window_tree_batch_update.h"
 #include "ui/base/gestures/gesture_configuration.h"
 #include "ui/base/hit_test.h"
 #include "ui/base/keycodes/keyboard_codes.h"
@@ -515,6 +517,31 @@ TEST_F(WindowTest, GetEventHandlerForPointWithOverride) {
   EXPECT_EQ(child.get(),  parent->GetEventHandlerForPoint(gfx::Point(1, 1)));
 }
 
+// Checks that transformed children, and children with an outer hit test
+// override, are hit where they are drawn.
+TEST_F(WindowTest, GetEventHandlerForPointWithTransformedChildren) {
+  scoped_ptr<Window> parent(
+      CreateTestWindow(SK_ColorWHITE, 1, gfx::Rect(0, 0, 400, 400), NULL));
+  scoped_ptr<Window> moved(
+      CreateTestWindow(SK_ColorRED, 2, gfx::Rect(0, 0, 50, 50), parent.get()));
+  scoped_ptr<Window> outer(
+      CreateTestWindow(SK_ColorBLUE, 3, gfx::Rect(300, 300, 50, 50),
+                       parent.get()));
+  outer->set_hit_test_bounds_override_outer(gfx::Insets(-5, -5, -5, -5));
+
+  ui::Transform transform;
+  transform.SetTranslate(100, 100);
+  moved->SetTransform(transform);
+
+  EXPECT_EQ(parent.get(), parent->GetEventHandlerForPoint(gfx::Point(10, 10)));
+  EXPECT_EQ(moved.get(), parent->GetEventHandlerForPoint(gfx::Point(110, 110)));
+  EXPECT_EQ(outer.get(), parent->GetEventHandlerForPoint(gfx::Point(297, 297)));
+  EXPECT_EQ(parent.get(),
+            parent->GetEventHandlerForPoint(gfx::Point(290, 290)));
+  EXPECT_EQ(parent.get(),
+            parent->GetTopWindowContainingPoint(gfx::Point(297, 297)));
+}
+
 TEST_F(WindowTest, GetTopWindowContainingPoint) {
   Window* root = root_window();
   root->SetBounds(gfx::Rect(0, 0, 300, 300));
@@ -1445,6 +1472,32 @@ TEST_F(WindowTest, Property) {
   EXPECT_EQ(std::string("squeamish"), w->GetProperty(kStringKey));
 }
 
+TEST_F(WindowTest, SlotProperty) {
+  scoped_ptr<Window> w(CreateTestWindowWithId(0, NULL));
+
+  // Properties in slots read their defaults until set, like any other.
+  EXPECT_EQ(ui::SHOW_STATE_DEFAULT, w->GetProperty(client::kShowStateKey));
+  EXPECT_FALSE(w->GetProperty(client::kAlwaysOnTopKey));
+
+  w->SetProperty(client::kShowStateKey, ui::SHOW_STATE_MAXIMIZED);
+  w->SetProperty(client::kAlwaysOnTopKey, true);
+  w->SetProperty(kIntKey, 5);
+  EXPECT_EQ(ui::SHOW_STATE_MAXIMIZED, w->GetProperty(client::kShowStateKey));
+  EXPECT_TRUE(w->GetProperty(client::kAlwaysOnTopKey));
+  EXPECT_EQ(ui::MODAL_TYPE_NONE, w->GetProperty(client::kModalKey));
+  EXPECT_EQ(5, w->GetProperty(kIntKey));
+
+  // Clearing one slot leaves the others.
+  w->ClearProperty(client::kShowStateKey);
+  EXPECT_EQ(ui::SHOW_STATE_DEFAULT, w->GetProperty(client::kShowStateKey));
+  EXPECT_TRUE(w->GetProperty(client::kAlwaysOnTopKey));
+  EXPECT_EQ(5, w->GetProperty(kIntKey));
+
+  // Slots are per window.
+  scoped_ptr<Window> w2(CreateTestWindowWithId(1, NULL));
+  EXPECT_FALSE(w2->GetProperty(client::kAlwaysOnTopKey));
+}
+
 namespace {
 
 class TestProperty {
@@ -1723,6 +1776,14 @@ TEST_F(WindowObserverTest, PropertyChanged) {
   w1->ClearProperty(&prop);
   EXPECT_EQ(PropertyChangeInfo(&prop, 3), PropertyChangeInfoAndClear());
 
+  // So should setting a property in a slot.
+  w1->SetProperty(client::kAlwaysOnTopKey, true);
+  EXPECT_EQ(PropertyChangeInfo(client::kAlwaysOnTopKey, 0),
+            PropertyChangeInfoAndClear());
+  w1->ClearProperty(client::kAlwaysOnTopKey);
+  EXPECT_EQ(PropertyChangeInfo(client::kAlwaysOnTopKey, 1),
+            PropertyChangeInfoAndClear());
+
   w1->SetNativeWindowProperty(native_prop_key, &*w1);
   EXPECT_EQ(PropertyChangeInfo(native_prop_key, 0),
             PropertyChangeInfoAndClear());
@@ -2462,5 +2523,105 @@ TEST_F(WindowTest, DelegateNotifiedAsBoundsChangeInHiddenLayer) {
   EXPECT_NE("0,0 100x100", window->bounds().ToString());
 }
 
+
+// Counts the bounds and stacking notifications of windows, and the resizes
+// of the window it lays out.
+class BatchUpdateObserver : public WindowObserver, public LayoutManager {
+ public:
+  BatchUpdateObserver()
+      : bounds_changed_count_(0),
+        stacking_changed_count_(0),
+        resized_count_(0) {
+  }
+  virtual ~BatchUpdateObserver() {}
+
+  int bounds_changed_count() const { return bounds_changed_count_; }
+  int stacking_changed_count() const { return stacking_changed_count_; }
+  int resized_count() const { return resized_count_; }
+  const gfx::Rect& old_bounds() const { return old_bounds_; }
+  const gfx::Rect& new_bounds() const { return new_bounds_; }
+
+  // Overridden from WindowObserver:
+  virtual void OnWindowBoundsChanged(Window* window,
+                                     const gfx::Rect& old_bounds,
+                                     const gfx::Rect& new_bounds) OVERRIDE {
+    bounds_changed_count_++;
+    old_bounds_ = old_bounds;
+    new_bounds_ = new_bounds;
+  }
+  virtual void OnWindowStackingChanged(Window* window) OVERRIDE {
+    stacking_changed_count_++;
+  }
+
+  // Overridden from LayoutManager:
+  virtual void OnWindowResized() OVERRIDE {
+    resized_count_++;
+  }
+  virtual void OnWindowAddedToLayout(Window* child) OVERRIDE {}
+  virtual void OnWillRemoveWindowFromLayout(Window* child) OVERRIDE {}
+  virtual void OnWindowRemovedFromLayout(Window* child) OVERRIDE {}
+  virtual void OnChildWindowVisibilityChanged(Window* child,
+                                              bool visible) OVERRIDE {}
+  virtual void SetChildBounds(Window* child,
+                              const gfx::Rect& requested_bounds) OVERRIDE {
+    SetChildBoundsDirect(child, requested_bounds);
+  }
+
+ private:
+  int bounds_changed_count_;
+  int stacking_changed_count_;
+  int resized_count_;
+  gfx::Rect old_bounds_;
+  gfx::Rect new_bounds_;
+
+  DISALLOW_COPY_AND_ASSIGN(BatchUpdateObserver);
+};
+
+// Checks that the windows changed in a batch notify once, when the outermost
+// batch ends.
+TEST_F(WindowTest, WindowTreeBatchUpdate) {
+  scoped_ptr<Window> parent(CreateTestWindowWithId(1, NULL));
+  scoped_ptr<Window> w11(CreateTestWindowWithBounds(gfx::Rect(0, 0, 10, 10),
+                                                    parent.get()));
+  scoped_ptr<Window> w12(CreateTestWindowWithBounds(gfx::Rect(0, 0, 10, 10),
+                                                    parent.get()));
+  BatchUpdateObserver* layout_manager = new BatchUpdateObserver;
+  w11->SetLayoutManager(layout_manager);
+  BatchUpdateObserver observer;
+  w11->AddObserver(&observer);
+
+  {
+    WindowTreeBatchUpdate batch;
+    w11->SetBounds(gfx::Rect(10, 10, 20, 20));
+    {
+      WindowTreeBatchUpdate nested_batch;
+      w11->SetBounds(gfx::Rect(20, 20, 30, 30));
+      parent->StackChildAtTop(w11.get());
+    }
+    parent->StackChildAtTop(w12.get());
+    parent->StackChildAtTop(w11.get());
+    EXPECT_EQ("20,20 30x30", w11->bounds().ToString());
+    EXPECT_EQ(w11.get(), parent->children().back());
+    EXPECT_EQ(0, observer.bounds_changed_count());
+    EXPECT_EQ(0, observer.stacking_changed_count());
+    EXPECT_EQ(0, layout_manager->resized_count());
+
+    // A window destroyed in the batch doesn't notify.
+    w12.reset();
+  }
+  EXPECT_EQ(1, observer.bounds_changed_count());
+  EXPECT_EQ("0,0 10x10", observer.old_bounds().ToString());
+  EXPECT_EQ("20,20 30x30", observer.new_bounds().ToString());
+  EXPECT_EQ(1, observer.stacking_changed_count());
+  EXPECT_EQ(1, layout_manager->resized_count());
+
+  // Out of a batch, windows notify right away again.
+  w11->SetBounds(gfx::Rect(0, 0, 10, 10));
+  EXPECT_EQ(2, observer.bounds_changed_count());
+  EXPECT_EQ(2, layout_manager->resized_count());
+
+  w11->RemoveObserver(&observer);
+}
+
 }  // namespace test
 }  // namespace aura
@@ -6,7 +6,7 @@
 
 #include <X11/Xatom.h>
 
-#include "base/message_pump_aurax11.h"
+#include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 
 namespace aura {
@@ -20,8 +20,7 @@ X11AtomCache::X11AtomCache(Display* xdisplay, const char** to_cache)
   scoped_array< ::Atom> cached_atoms(new ::Atom[cache_count]);
 
   // Grab all the atoms we need now to minimize roundtrips to the X11 server.
-  XInternAtoms(base::MessagePumpAuraX11::GetDefaultXDisplay(),
-               const_cast<char**>(to_cache), cache_count, False,
+  XInternAtoms(xdisplay_, const_cast<char**>(to_cache), cache_count, False,
                cached_atoms.get());
 
   for (int i = 0; i < cache_count; ++i)
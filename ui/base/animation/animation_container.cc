@@ -4,8 +4,10 @@
 
 #include "ui/base/animation/animation_container.h"
 
+#include "ui/base/animation/animation_container_clock.h"
 #include "ui/base/animation/animation_container_element.h"
 #include "ui/base/animation/animation_container_observer.h"
+#include "ui/base/animation/animation_ticker.h"
 
 using base::TimeDelta;
 using base::TimeTicks;
@@ -14,7 +16,9 @@ namespace ui {
 
 AnimationContainer::AnimationContainer()
     : last_tick_time_(TimeTicks::Now()),
-      observer_(NULL) {
+      observer_(NULL),
+      ticker_(AnimationTicker::GetForCurrentThread()),
+      clock_(ticker_.get()) {
 }
 
 AnimationContainer::~AnimationContainer() {
@@ -36,6 +40,8 @@ void AnimationContainer::Start(AnimationContainerElement* element) {
 
   element->SetStartTime(last_tick_time_);
   elements_.insert(element);
+  if (elements_.size() == 1)
+    clock_->StartTicking(this);
 }
 
 void AnimationContainer::Stop(AnimationContainerElement* element) {
@@ -44,7 +50,7 @@ void AnimationContainer::Stop(AnimationContainerElement* element) {
   elements_.erase(element);
 
   if (elements_.empty()) {
-    timer_.Stop();
+    clock_->StopTicking(this);
     if (observer_)
       observer_->AnimationContainerEmpty(this);
   } else {
@@ -54,16 +60,35 @@ void AnimationContainer::Stop(AnimationContainerElement* element) {
   }
 }
 
-void AnimationContainer::Run() {
+void AnimationContainer::SetClock(AnimationContainerClock* clock) {
+  if (!clock)
+    clock = ticker_.get();
+  if (clock == clock_)
+    return;
+
+  if (is_running())
+    clock_->StopTicking(this);
+  clock_ = clock;
+  if (is_running())
+    clock_->StartTicking(this);
+}
+
+void AnimationContainer::Tick(TimeTicks now) {
+  if (now > last_tick_time_)
+    RunAt(now);
+}
+
+void AnimationContainer::RunAt(TimeTicks now) {
   // We notify the observer after updating all the elements. If all the elements
   // are deleted as a result of updating then our ref count would go to zero and
   // we would be deleted before we notify our observer. We add a reference to
   // ourself here to make sure we're still valid after running all the elements.
   scoped_refptr<AnimationContainer> this_ref(this);
 
-  TimeTicks current_time = TimeTicks::Now();
+  last_tick_time_ = now;
 
-  last_tick_time_ = current_time;
+  if (observer_)
+    observer_->AnimationContainerWillProgress(this);
 
   // Make a copy of the elements to iterate over so that if any elements are
   // removed as part of invoking Step there aren't any problems.
@@ -73,7 +98,7 @@ void AnimationContainer::Run() {
        i != elements.end(); ++i) {
     // Make sure the element is still valid.
     if (elements_.find(*i) != elements_.end())
-      (*i)->Step(current_time);
+      (*i)->Step(now);
   }
 
   if (observer_)
@@ -83,9 +108,9 @@ void AnimationContainer::Run() {
 void AnimationContainer::SetMinTimerInterval(base::TimeDelta delta) {
   // This doesn't take into account how far along the current element is, but
   // that shouldn't be a problem for uses of Animation/AnimationContainer.
-  timer_.Stop();
   min_timer_interval_ = delta;
-  timer_.Start(FROM_HERE, min_timer_interval_, this, &AnimationContainer::Run);
+  if (is_running())
+    clock_->IntervalChanged(this);
 }
 
 TimeDelta AnimationContainer::GetMinInterval() {
@@ -10,13 +10,14 @@
 
 #include "base/memory/ref_counted.h"
 #include "base/time.h"
-#include "base/timer.h"
 #include "ui/base/ui_export.h"
 
 namespace ui {
 
+class AnimationContainerClock;
 class AnimationContainerElement;
 class AnimationContainerObserver;
+class AnimationTicker;
 
 // AnimationContainer is used by Animation to manage the underlying timer.
 // Internally each Animation creates a single AnimationContainer. You can
@@ -24,6 +25,9 @@ class AnimationContainerObserver;
 // Animation::SetContainer. Grouping a set of Animations into the same
 // AnimationContainer ensures they all update and start at the same time.
 //
+// The containers of a thread don't have timers of their own: they are all
+// stepped by the AnimationTicker of the thread, unless given another clock.
+//
 // AnimationContainer is ref counted. Each Animation contained within the
 // AnimationContainer own it.
 class UI_EXPORT AnimationContainer
@@ -46,6 +50,18 @@ class UI_EXPORT AnimationContainer
     observer_ = observer;
   }
 
+  // Makes |clock| step the animations instead of the AnimationTicker of the
+  // thread. NULL goes back to the ticker. The clock is not owned and must
+  // outlive its use by the container.
+  void SetClock(AnimationContainerClock* clock);
+
+  // Invoked by the clock: steps the animations to |now|. Does nothing if the
+  // animations have already been stepped to |now| or later.
+  void Tick(base::TimeTicks now);
+
+  // The smallest interval the running animations ask to be stepped at.
+  base::TimeDelta min_timer_interval() const { return min_timer_interval_; }
+
   // The time the last animation ran at.
   base::TimeTicks last_tick_time() const { return last_tick_time_; }
 
@@ -59,10 +75,10 @@ class UI_EXPORT AnimationContainer
 
   ~AnimationContainer();
 
-  // Timer callback method.
-  void Run();
+  // Steps the animations to |now|.
+  void RunAt(base::TimeTicks now);
 
-  // Sets min_timer_interval_ and restarts the timer.
+  // Sets min_timer_interval_ and tells the clock if the container is ticking.
   void SetMinTimerInterval(base::TimeDelta delta);
 
   // Returns the min timer interval of all the timers.
@@ -71,7 +87,7 @@ class UI_EXPORT AnimationContainer
   // Represents one of two possible values:
   // . If only a single animation has been started and the timer hasn't yet
   //   fired this is the time the animation was added.
-  // . The time the last animation ran at (::Run was invoked).
+  // . The time the last animation ran at (::RunAt was invoked).
   base::TimeTicks last_tick_time_;
 
   // Set of elements (animations) being managed.
@@ -80,10 +96,13 @@ class UI_EXPORT AnimationContainer
   // Minimum interval the timers run at.
   base::TimeDelta min_timer_interval_;
 
-  base::RepeatingTimer<AnimationContainer> timer_;
-
   AnimationContainerObserver* observer_;
 
+  // The ticker of the thread the container was created on, and the clock that
+  // steps the animations: the ticker unless SetClock() was given another.
+  scoped_refptr<AnimationTicker> ticker_;
+  AnimationContainerClock* clock_;
+
   DISALLOW_COPY_AND_ASSIGN(AnimationContainer);
 };
 
@@ -0,0 +1,37 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_BASE_ANIMATION_ANIMATION_CONTAINER_CLOCK_H_
+#define UI_BASE_ANIMATION_ANIMATION_CONTAINER_CLOCK_H_
+#pragma once
+
+#include "ui/base/ui_export.h"
+
+namespace ui {
+
+class AnimationContainer;
+
+// A clock steps the animations of a container in place of the container's
+// own timer, for example at the beginning of each frame of a compositor.
+// See AnimationContainer::SetClock().
+class UI_EXPORT AnimationContainerClock {
+ public:
+  // Invoked when the container has animations to step. The clock should call
+  // AnimationContainer::Tick() regularly until StopTicking() is invoked.
+  virtual void StartTicking(AnimationContainer* container) = 0;
+
+  // Invoked when no more animations are being managed by the container.
+  virtual void StopTicking(AnimationContainer* container) = 0;
+
+  // Invoked when the smallest interval the animations of a ticking container
+  // ask to be stepped at changes.
+  virtual void IntervalChanged(AnimationContainer* container) {}
+
+ protected:
+  virtual ~AnimationContainerClock() {}
+};
+
+}  // namespace ui
+
+#endif  // UI_BASE_ANIMATION_ANIMATION_CONTAINER_CLOCK_H_
@@ -16,6 +16,10 @@ class AnimationContainer;
 // the container.
 class UI_EXPORT AnimationContainerObserver {
  public:
+  // Invoked on every tick of the timer managed by the container, before any
+  // animation updates.
+  virtual void AnimationContainerWillProgress(AnimationContainer* container) {}
+
   // Invoked on every tick of the timer managed by the container and after
   // all the animations have updated.
   virtual void AnimationContainerProgressed(
@@ -2,11 +2,16 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+
+#include "base/bind.h"
 #include "base/memory/scoped_ptr.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "ui/base/animation/animation_container.h"
+#include "ui/base/animation/animation_container_clock.h"
 #include "ui/base/animation/animation_container_observer.h"
+#include "ui/base/animation/animation_ticker.h"
 #include "ui/base/animation/linear_animation.h"
 #include "ui/base/animation/test_animation_delegate.h"
 
@@ -20,6 +25,7 @@ class MockObserver : public AnimationContainerObserver {
  public:
   MockObserver() {}
 
+  MOCK_METHOD1(AnimationContainerWillProgress, void(AnimationContainer*));
   MOCK_METHOD1(AnimationContainerProgressed, void(AnimationContainer*));
   MOCK_METHOD1(AnimationContainerEmpty, void(AnimationContainer*));
 
@@ -27,6 +33,27 @@ class MockObserver : public AnimationContainerObserver {
   DISALLOW_COPY_AND_ASSIGN(MockObserver);
 };
 
+class TestClock : public AnimationContainerClock {
+ public:
+  TestClock() : container_(NULL) {}
+
+  AnimationContainer* container() const { return container_; }
+
+  // AnimationContainerClock overrides:
+  virtual void StartTicking(AnimationContainer* container) OVERRIDE {
+    container_ = container;
+  }
+  virtual void StopTicking(AnimationContainer* container) OVERRIDE {
+    EXPECT_EQ(container_, container);
+    container_ = NULL;
+  }
+
+ private:
+  AnimationContainer* container_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestClock);
+};
+
 class TestAnimation : public LinearAnimation {
  public:
   explicit TestAnimation(AnimationDelegate* delegate)
@@ -101,8 +128,11 @@ TEST_F(AnimationContainerTest, Observer) {
   TestAnimation animation1(&delegate1);
   animation1.SetContainer(container.get());
 
-  // We expect to get these two calls: the animation progressed, and then when
-  // the animation completed the container went empty.
+  // We expect to get these calls: the animation is about to progress and
+  // progressed, and then when the animation completed the container went
+  // empty.
+  EXPECT_CALL(observer, AnimationContainerWillProgress(container.get())).Times(
+      AtLeast(1));
   EXPECT_CALL(observer, AnimationContainerProgressed(container.get())).Times(
       AtLeast(1));
   EXPECT_CALL(observer, AnimationContainerEmpty(container.get())).Times(1);
@@ -123,4 +153,71 @@ TEST_F(AnimationContainerTest, Observer) {
   container->set_observer(NULL);
 }
 
+// Makes sure a clock steps the animations in place of the timer.
+TEST_F(AnimationContainerTest, Clock) {
+  TestClock clock;
+  TestAnimationDelegate delegate;
+
+  scoped_refptr<AnimationContainer> container(new AnimationContainer());
+  container->SetClock(&clock);
+  TestAnimation animation(&delegate);
+  animation.SetContainer(container.get());
+
+  animation.Start();
+  EXPECT_EQ(container.get(), clock.container());
+
+  // Ticks that don't move time forward do nothing.
+  base::TimeTicks start_time = container->last_tick_time();
+  container->Tick(start_time);
+  EXPECT_FALSE(delegate.finished());
+
+  // The delegate quits the message loop when the animation ends.
+  MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&AnimationContainer::Tick, container.get(),
+                 start_time + base::TimeDelta::FromMilliseconds(20)));
+  MessageLoop::current()->Run();
+  EXPECT_TRUE(delegate.finished());
+  EXPECT_FALSE(container->is_running());
+  EXPECT_FALSE(clock.container());
+
+  container->SetClock(NULL);
+}
+
+// Makes sure the containers of a thread are stepped together by its ticker,
+// which stops once nothing is running.
+TEST_F(AnimationContainerTest, SharedTicker) {
+  scoped_refptr<AnimationTicker> ticker(AnimationTicker::GetForCurrentThread());
+  TestAnimationDelegate delegate1;
+  TestAnimationDelegate delegate2;
+
+  scoped_refptr<AnimationContainer> container1(new AnimationContainer());
+  scoped_refptr<AnimationContainer> container2(new AnimationContainer());
+  TestAnimation animation1(&delegate1);
+  TestAnimation animation2(&delegate2);
+  animation1.SetContainer(container1.get());
+  animation2.SetContainer(container2.get());
+
+  EXPECT_FALSE(ticker->is_ticking());
+  animation1.Start();
+  animation2.Start();
+  EXPECT_TRUE(ticker->is_ticking());
+
+  // A single tick of the ticker steps both containers to their end.
+  base::TimeTicks end_time =
+      std::max(container1->last_tick_time(), container2->last_tick_time()) +
+      base::TimeDelta::FromMilliseconds(20);
+  MessageLoop::current()->PostTask(
+      FROM_HERE, base::Bind(&AnimationTicker::Tick, ticker.get(), end_time));
+  MessageLoop::current()->Run();
+  EXPECT_TRUE(delegate1.finished());
+  EXPECT_TRUE(delegate2.finished());
+  EXPECT_EQ(end_time, container1->last_tick_time());
+  EXPECT_EQ(end_time, container2->last_tick_time());
+
+  EXPECT_FALSE(container1->is_running());
+  EXPECT_FALSE(container2->is_running());
+  EXPECT_FALSE(ticker->is_ticking());
+}
+
 }  // namespace ui
@@ -0,0 +1,130 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/base/animation/animation_ticker.h"
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/threading/thread_local.h"
+#include "ui/base/animation/animation_container.h"
+
+using base::TimeDelta;
+using base::TimeTicks;
+
+namespace ui {
+
+namespace {
+
+base::LazyInstance<base::ThreadLocalPointer<AnimationTicker> >::Leaky
+    current_ticker = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+// static
+AnimationTicker* AnimationTicker::GetForCurrentThread() {
+  AnimationTicker* ticker = current_ticker.Pointer()->Get();
+  if (!ticker) {
+    ticker = new AnimationTicker();
+    current_ticker.Pointer()->Set(ticker);
+  }
+  return ticker;
+}
+
+AnimationTicker::AnimationTicker() : beat_(NULL) {
+}
+
+AnimationTicker::~AnimationTicker() {
+  // Running containers hold a reference to their ticker.
+  DCHECK(containers_.empty());
+  DCHECK(current_ticker.Pointer()->Get() == this);
+  current_ticker.Pointer()->Set(NULL);
+}
+
+void AnimationTicker::SetBeat(Beat* beat) {
+  if (beat == beat_)
+    return;
+
+  if (beat_ && is_ticking())
+    beat_->StopBeating();
+  beat_ = beat;
+  if (!is_ticking())
+    return;
+
+  if (beat_) {
+    timer_.Stop();
+    beat_->StartBeating();
+  } else {
+    UpdateTimer();
+  }
+}
+
+void AnimationTicker::Tick(TimeTicks now) {
+  // Stepping may release the last references to the ticker.
+  scoped_refptr<AnimationTicker> this_ref(this);
+
+  // Containers may stop, start or go away as others are stepped. Only the
+  // ones that were running before and still are get stepped.
+  Containers containers = containers_;
+  for (Containers::const_iterator i = containers.begin();
+       i != containers.end(); ++i) {
+    if (containers_.find(*i) != containers_.end())
+      (*i)->Tick(now);
+  }
+}
+
+void AnimationTicker::StartTicking(AnimationContainer* container) {
+  DCHECK(containers_.count(container) == 0);
+
+  containers_.insert(container);
+  if (beat_) {
+    if (containers_.size() == 1)
+      beat_->StartBeating();
+  } else {
+    UpdateTimer();
+  }
+}
+
+void AnimationTicker::StopTicking(AnimationContainer* container) {
+  DCHECK(containers_.count(container) > 0);
+
+  containers_.erase(container);
+  if (beat_) {
+    if (containers_.empty())
+      beat_->StopBeating();
+  } else {
+    UpdateTimer();
+  }
+}
+
+void AnimationTicker::IntervalChanged(AnimationContainer* container) {
+  if (!beat_)
+    UpdateTimer();
+}
+
+void AnimationTicker::Run() {
+  Tick(TimeTicks::Now());
+}
+
+void AnimationTicker::UpdateTimer() {
+  if (beat_ || containers_.empty()) {
+    timer_.Stop();
+    return;
+  }
+
+  Containers::const_iterator i = containers_.begin();
+  TimeDelta interval = (*i)->min_timer_interval();
+  for (++i; i != containers_.end(); ++i) {
+    if ((*i)->min_timer_interval() < interval)
+      interval = (*i)->min_timer_interval();
+  }
+
+  // Restarting the timer at the same interval would push the next step back.
+  if (timer_.IsRunning() && interval == timer_interval_)
+    return;
+  timer_.Stop();
+  timer_interval_ = interval;
+  timer_.Start(FROM_HERE, timer_interval_, this, &AnimationTicker::Run);
+}
+
+}  // namespace ui
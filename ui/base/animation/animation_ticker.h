@@ -0,0 +1,86 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_BASE_ANIMATION_ANIMATION_TICKER_H_
+#define UI_BASE_ANIMATION_ANIMATION_TICKER_H_
+#pragma once
+
+#include <set>
+
+#include "base/memory/ref_counted.h"
+#include "base/time.h"
+#include "base/timer.h"
+#include "ui/base/animation/animation_container_clock.h"
+#include "ui/base/ui_export.h"
+
+namespace ui {
+
+// AnimationTicker is the clock all the AnimationContainers of a thread share
+// by default, so that a thread running any number of animations wakes up
+// once per step rather than once per container. It steps the running
+// containers together with a single timer, at the smallest interval any of
+// them asks for, or at the beat of a Beat, e.g. the frames of a compositor.
+// Nothing is scheduled while no container is running.
+class UI_EXPORT AnimationTicker
+    : public AnimationContainerClock,
+      public base::RefCounted<AnimationTicker> {
+ public:
+  // A Beat calls Tick() regularly between StartBeating() and StopBeating(),
+  // in place of the ticker's timer.
+  class Beat {
+   public:
+    virtual void StartBeating() = 0;
+    virtual void StopBeating() = 0;
+
+   protected:
+    virtual ~Beat() {}
+  };
+
+  // Returns the ticker of the current thread, creating it if needed. The
+  // ticker lives as long as something holds a reference to it.
+  static AnimationTicker* GetForCurrentThread();
+
+  // Makes |beat| step the containers instead of the timer. NULL goes back to
+  // the timer. The beat is not owned and must outlive its use by the ticker.
+  void SetBeat(Beat* beat);
+
+  // Steps the running containers to |now|.
+  void Tick(base::TimeTicks now);
+
+  // Is any container running?
+  bool is_ticking() const { return !containers_.empty(); }
+
+  // Overridden from AnimationContainerClock:
+  virtual void StartTicking(AnimationContainer* container) OVERRIDE;
+  virtual void StopTicking(AnimationContainer* container) OVERRIDE;
+  virtual void IntervalChanged(AnimationContainer* container) OVERRIDE;
+
+ private:
+  friend class base::RefCounted<AnimationTicker>;
+
+  typedef std::set<AnimationContainer*> Containers;
+
+  AnimationTicker();
+  virtual ~AnimationTicker();
+
+  // Timer callback method.
+  void Run();
+
+  // Restarts the timer at the smallest interval of the running containers,
+  // unless there is a beat or no container is running.
+  void UpdateTimer();
+
+  Containers containers_;
+
+  Beat* beat_;
+
+  base::TimeDelta timer_interval_;
+  base::RepeatingTimer<AnimationTicker> timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(AnimationTicker);
+};
+
+}  // namespace ui
+
+#endif  // UI_BASE_ANIMATION_ANIMATION_TICKER_H_
@@ -161,6 +161,16 @@ void Clipboard::DispatchObject(ObjectType type, const ObjectMapParams& params) {
   }
 }
 
+#if !defined(TOOLKIT_GTK)
+void Clipboard::ReadDataAsync(const FormatType& format,
+                              const ReadDataCallback& callback) const {
+  // The platform clipboard hands the data over in one go.
+  std::string result;
+  ReadData(format, &result);
+  callback.Run(result);
+}
+#endif
+
 // static
 void Clipboard::ReplaceSharedMemHandle(ObjectMap* objects,
                                        base::SharedMemoryHandle bitmap_handle,
@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 
+#include "base/callback.h"
 #include "base/compiler_specific.h"
 #include "base/gtest_prod_util.h"
 #include "base/process.h"
@@ -246,6 +247,16 @@ class UI_EXPORT Clipboard : NON_EXPORTED_BASE(public base::ThreadChecker) {
   // as a byte vector.
   void ReadData(const FormatType& format, std::string* result) const;
 
+  // Like ReadData(), but doesn't block on the application that owns the
+  // clipboard: |callback| is run with the data, or an empty string if there
+  // is none, once it has all arrived. Large data comes in chunks, which is
+  // slow, and ReadData() runs a nested message loop until it all arrives. On
+  // some platforms the data is always read right away, and |callback| runs
+  // before this returns.
+  typedef base::Callback<void(const std::string&)> ReadDataCallback;
+  void ReadDataAsync(const FormatType& format,
+                     const ReadDataCallback& callback) const;
+
   // Gets the FormatType corresponding to an arbitrary format string,
   // registering it with the system if needed. Due to Windows/Linux
   // limitiations, |format_string| must never be controlled by the user.
@@ -280,6 +291,15 @@ class UI_EXPORT Clipboard : NON_EXPORTED_BASE(public base::ThreadChecker) {
   static const FormatType& GetCFHDropFormatType();
   static const FormatType& GetFileDescriptorFormatType();
   static const FormatType& GetFileContentFormatZeroType();
+
+  // Puts the data of |format| on the clipboard, if it was written without
+  // data to be rendered on demand. Called on WM_RENDERFORMAT, with the
+  // clipboard open.
+  void RenderFormat(UINT format);
+
+  // Drops the data of the formats that weren't rendered. Called on
+  // WM_DESTROYCLIPBOARD.
+  void ClearPendingFormats();
 #endif
 
  private:
@@ -310,6 +330,9 @@ class UI_EXPORT Clipboard : NON_EXPORTED_BASE(public base::ThreadChecker) {
                  const char* data_data,
                  size_t data_len);
 #if defined(OS_WIN)
+  // Makes the CF_BITMAP of the bitmap written by WriteBitmap().
+  void RenderBitmap(const char* pixel_data, const char* size_data);
+
   void WriteBitmapFromHandle(HBITMAP source_hbitmap,
                              const gfx::Size& size);
 
@@ -332,6 +355,10 @@ class UI_EXPORT Clipboard : NON_EXPORTED_BASE(public base::ThreadChecker) {
 
   // True if we can create a window.
   bool create_window_;
+
+  // The CBF_BITMAP params of the bitmap that CF_BITMAP is rendered from, if
+  // it hasn't been yet.
+  ObjectMapParams pending_bitmap_;
 #elif defined(TOOLKIT_GTK)
   // The public API is via WriteObjects() which dispatches to multiple
   // Write*() calls, but on GTK we must write all the clipboard types
@@ -11,10 +11,12 @@
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/file_path.h"
 #include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/memory/singleton.h"
 #include "base/utf_string_conversions.h"
 #include "third_party/skia/include/core/SkBitmap.h"
@@ -120,6 +122,90 @@ GdkAtom StringToGdkAtom(const std::string& str) {
   return gdk_atom_intern(str.c_str(), FALSE);
 }
 
+// GtkClipboardReceivedFunc callback for Clipboard::ReadDataAsync().
+void OnDataReceived(GtkClipboard* clipboard,
+                    GtkSelectionData* selection_data,
+                    gpointer user_data) {
+  scoped_ptr<Clipboard::ReadDataCallback> callback(
+      reinterpret_cast<Clipboard::ReadDataCallback*>(user_data));
+  std::string result;
+  // The length is negative if the data couldn't be retrieved.
+  if (gtk_selection_data_get_length(selection_data) > 0) {
+    result.assign(reinterpret_cast<const char*>(
+                      gtk_selection_data_get_data(selection_data)),
+                  gtk_selection_data_get_length(selection_data));
+  }
+  callback->Run(result);
+}
+
+// Called on GdkPixbuf destruction; see ClipboardBitmap::GetPixbuf().
+void GdkPixbufFree(guchar* pixels, gpointer data) {
+  free(pixels);
+}
+
+// Makes a copy of |pixels| with the ordering changed from BGRA to RGBA.
+// The caller is responsible for free()ing the data. If |stride| is 0, it's
+// assumed to be 4 * |width|.
+uint8_t* BGRAToRGBA(const uint8_t* pixels, int width, int height, int stride) {
+  if (stride == 0)
+    stride = width * 4;
+
+  uint8_t* new_pixels = static_cast<uint8_t*>(malloc(height * stride));
+
+  // We have to copy the pixels and swap from BGRA to RGBA.
+  for (int i = 0; i < height; ++i) {
+    for (int j = 0; j < width; ++j) {
+      int idx = i * stride + j * 4;
+      new_pixels[idx] = pixels[idx + 2];
+      new_pixels[idx + 1] = pixels[idx + 1];
+      new_pixels[idx + 2] = pixels[idx];
+      new_pixels[idx + 3] = pixels[idx + 3];
+    }
+  }
+
+  return new_pixels;
+}
+
+// A bitmap we copied to the clipboard. Converting it to a GdkPixbuf, which GTK
+// then encodes to the image format asked for, is left until an application
+// first asks for the image, as most copied images are never pasted. The
+// GdkPixbuf is kept for later requests.
+class ClipboardBitmap {
+ public:
+  ClipboardBitmap(const char* pixel_data, const gfx::Size& size)
+      : pixels_(pixel_data, pixel_data + 4 * size.width() * size.height()),
+        size_(size),
+        pixbuf_(NULL) {
+  }
+
+  ~ClipboardBitmap() {
+    if (pixbuf_)
+      g_object_unref(pixbuf_);
+  }
+
+  GdkPixbuf* GetPixbuf() {
+    if (!pixbuf_) {
+      guchar* data = BGRAToRGBA(reinterpret_cast<const uint8_t*>(&pixels_[0]),
+                                size_.width(), size_.height(), 0);
+      pixbuf_ = gdk_pixbuf_new_from_data(data, GDK_COLORSPACE_RGB, TRUE,
+                                         8, size_.width(), size_.height(),
+                                         size_.width() * 4, GdkPixbufFree,
+                                         NULL);
+      // The pixbuf has its own copy of the pixels.
+      std::vector<char>().swap(pixels_);
+    }
+    return pixbuf_;
+  }
+
+ private:
+  // BGRA pixels, until |pixbuf_| is made.
+  std::vector<char> pixels_;
+  gfx::Size size_;
+  GdkPixbuf* pixbuf_;
+
+  DISALLOW_COPY_AND_ASSIGN(ClipboardBitmap);
+};
+
 // GtkClipboardGetFunc callback.
 // GTK will call this when an application wants data we copied to the clipboard.
 void GetData(GtkClipboard* clipboard,
@@ -138,7 +224,7 @@ void GetData(GtkClipboard* clipboard,
 
   if (target_string == kMimeTypeBitmap) {
     gtk_selection_data_set_pixbuf(selection_data,
-        reinterpret_cast<GdkPixbuf*>(iter->second.first));
+        reinterpret_cast<ClipboardBitmap*>(iter->second.first)->GetPixbuf());
   } else {
     gtk_selection_data_set(selection_data,
                            gtk_selection_data_get_target(selection_data), 8,
@@ -161,7 +247,7 @@ void ClearData(GtkClipboard* clipboard,
   for (Clipboard::TargetMap::iterator iter = map->begin();
        iter != map->end(); ++iter) {
     if (iter->first == kMimeTypeBitmap)
-      g_object_unref(reinterpret_cast<GdkPixbuf*>(iter->second.first));
+      delete reinterpret_cast<ClipboardBitmap*>(iter->second.first);
     else
       ptrs.insert(iter->second.first);
   }
@@ -174,34 +260,6 @@ void ClearData(GtkClipboard* clipboard,
   delete map;
 }
 
-// Called on GdkPixbuf destruction; see WriteBitmap().
-void GdkPixbufFree(guchar* pixels, gpointer data) {
-  free(pixels);
-}
-
-// Makes a copy of |pixels| with the ordering changed from BGRA to RGBA.
-// The caller is responsible for free()ing the data. If |stride| is 0, it's
-// assumed to be 4 * |width|.
-uint8_t* BGRAToRGBA(const uint8_t* pixels, int width, int height, int stride) {
-  if (stride == 0)
-    stride = width * 4;
-
-  uint8_t* new_pixels = static_cast<uint8_t*>(malloc(height * stride));
-
-  // We have to copy the pixels and swap from BGRA to RGBA.
-  for (int i = 0; i < height; ++i) {
-    for (int j = 0; j < width; ++j) {
-      int idx = i * stride + j * 4;
-      new_pixels[idx] = pixels[idx + 2];
-      new_pixels[idx + 1] = pixels[idx + 1];
-      new_pixels[idx + 2] = pixels[idx];
-      new_pixels[idx + 3] = pixels[idx + 3];
-    }
-  }
-
-  return new_pixels;
-}
-
 }  // namespace
 
 Clipboard::FormatType::FormatType() {
@@ -335,17 +393,11 @@ void Clipboard::WriteWebSmartPaste() {
 void Clipboard::WriteBitmap(const char* pixel_data, const char* size_data) {
   const gfx::Size* size = reinterpret_cast<const gfx::Size*>(size_data);
 
-  guchar* data = BGRAToRGBA(reinterpret_cast<const uint8_t*>(pixel_data),
-                            size->width(), size->height(), 0);
-
-  GdkPixbuf* pixbuf =
-      gdk_pixbuf_new_from_data(data, GDK_COLORSPACE_RGB, TRUE,
-                               8, size->width(), size->height(),
-                               size->width() * 4, GdkPixbufFree, NULL);
-  // We store the GdkPixbuf*, and the size_t half of the pair is meaningless.
-  // Note that this contrasts with the vast majority of entries in our target
-  // map, which directly store the data and its length.
-  InsertMapping(kMimeTypeBitmap, reinterpret_cast<char*>(pixbuf), 0);
+  // We store a ClipboardBitmap*, and the size_t half of the pair is
+  // meaningless. Note that this contrasts with the vast majority of entries in
+  // our target map, which directly store the data and its length.
+  ClipboardBitmap* bitmap = new ClipboardBitmap(pixel_data, *size);
+  InsertMapping(kMimeTypeBitmap, reinterpret_cast<char*>(bitmap), 0);
 }
 
 void Clipboard::WriteBookmark(const char* title_data, size_t title_len,
@@ -609,6 +661,16 @@ void Clipboard::ReadData(const FormatType& format, std::string* result) const {
   gtk_selection_data_free(data);
 }
 
+void Clipboard::ReadDataAsync(const FormatType& format,
+                              const ReadDataCallback& callback) const {
+  DCHECK(CalledOnValidThread());
+  // GTK receives the data from the main loop, in increments if it is large
+  // (the INCR protocol), and calls OnDataReceived() when it's all there.
+  gtk_clipboard_request_contents(clipboard_, format.ToGdkAtom(),
+                                 OnDataReceived,
+                                 new ReadDataCallback(callback));
+}
+
 uint64 Clipboard::GetSequenceNumber(Buffer buffer) {
   DCHECK(CalledOnValidThread());
   if (buffer == BUFFER_STANDARD)
@@ -7,6 +7,7 @@
 #include <string>
 
 #include "base/basictypes.h"
+#include "base/bind.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/pickle.h"
 #include "base/string_util.h"
@@ -23,6 +24,10 @@
 #include "ui/base/clipboard/clipboard_util_win.h"
 #endif
 
+#if defined(TOOLKIT_GTK)
+#include <gtk/gtk.h>
+#endif
+
 namespace ui {
 
 #if defined(OS_WIN)
@@ -48,6 +53,11 @@ bool MarkupMatches(const string16& expected_markup,
   return actual_markup.find(expected_markup) != string16::npos;
 }
 
+void StoreData(std::string* output, bool* done, const std::string& data) {
+  *output = data;
+  *done = true;
+}
+
 }  // namespace
 
 TEST_F(ClipboardTest, ClearTest) {
@@ -472,6 +482,37 @@ TEST_F(ClipboardTest, DataTest) {
   EXPECT_EQ(payload, unpickled_string);
 }
 
+TEST_F(ClipboardTest, ReadDataAsyncTest) {
+  Clipboard clipboard;
+  const ui::Clipboard::FormatType kFormat =
+      ui::Clipboard::GetFormatType("chromium/x-test-format");
+  // Big enough to be transferred in increments.
+  std::string payload(4 * 1024 * 1024, 'a');
+  Pickle write_pickle;
+  write_pickle.WriteString(payload);
+
+  {
+    ScopedClipboardWriter clipboard_writer(&clipboard,
+                                           Clipboard::BUFFER_STANDARD);
+    clipboard_writer.WritePickledData(write_pickle, kFormat);
+  }
+
+  std::string output;
+  bool done = false;
+  clipboard.ReadDataAsync(kFormat, base::Bind(&StoreData, &output, &done));
+#if defined(TOOLKIT_GTK)
+  while (!done)
+    gtk_main_iteration();
+#endif
+  ASSERT_TRUE(done);
+
+  Pickle read_pickle(output.data(), output.size());
+  PickleIterator iter(read_pickle);
+  std::string unpickled_string;
+  ASSERT_TRUE(read_pickle.ReadString(&iter, &unpickled_string));
+  EXPECT_EQ(payload, unpickled_string);
+}
+
 TEST_F(ClipboardTest, MultipleDataTest) {
   Clipboard clipboard;
   const ui::Clipboard::FormatType kFormat1 =
@@ -588,6 +629,45 @@ TEST_F(ClipboardTest, BitmapTest) {
                                           Clipboard::BUFFER_STANDARD));
 }
 
+// Bitmaps are only converted to the platform's format when they are first
+// read, and reading them again must give the same image.
+TEST_F(ClipboardTest, BitmapRenderedOnDemandTest) {
+  unsigned int fake_bitmap[] = {
+    0xFF155189, 0xFFA55C8D, 0xFF845674, 0xFF57BD89,
+    0xFFFD46AE, 0xFFC64F5A, 0xFFEDC5AF, 0xFF78F568,
+    0xFFE9F63A, 0xFF1EA14F, 0xFFAB32DF, 0xFF3A3FD1,
+  };
+
+  Clipboard clipboard;
+
+  {
+    ScopedClipboardWriter clipboard_writer(&clipboard,
+                                           Clipboard::BUFFER_STANDARD);
+    clipboard_writer.WriteBitmapFromPixels(fake_bitmap, gfx::Size(3, 4));
+  }
+
+  SkBitmap first = clipboard.ReadImage(Clipboard::BUFFER_STANDARD);
+  SkBitmap second = clipboard.ReadImage(Clipboard::BUFFER_STANDARD);
+  EXPECT_EQ(3, first.width());
+  EXPECT_EQ(4, first.height());
+  EXPECT_EQ(first.width(), second.width());
+  EXPECT_EQ(first.height(), second.height());
+
+  // Replacing the clipboard drops the bitmap that may not have been rendered.
+  {
+    ScopedClipboardWriter clipboard_writer(&clipboard,
+                                           Clipboard::BUFFER_STANDARD);
+    clipboard_writer.WriteBitmapFromPixels(fake_bitmap, gfx::Size(3, 4));
+  }
+  {
+    ScopedClipboardWriter clipboard_writer(&clipboard,
+                                           Clipboard::BUFFER_STANDARD);
+    clipboard_writer.WriteText(ASCIIToUTF16("text"));
+  }
+  EXPECT_FALSE(clipboard.IsFormatAvailable(Clipboard::GetBitmapFormatType(),
+                                           Clipboard::BUFFER_STANDARD));
+}
+
 void HtmlTestHelper(const std::string& cf_html,
                     const std::string& expected_html) {
   std::string html;
@@ -99,17 +99,30 @@ LRESULT CALLBACK ClipboardOwnerWndProc(HWND hwnd,
                                        LPARAM lparam) {
   LRESULT lresult = 0;
 
+  Clipboard* clipboard =
+      reinterpret_cast<Clipboard*>(::GetWindowLongPtr(hwnd, GWLP_USERDATA));
   switch (message) {
   case WM_RENDERFORMAT:
     // This message comes when SetClipboardData was sent a null data handle
     // and now it's come time to put the data on the clipboard.
-    // We always set data, so there isn't a need to actually do anything here.
+    if (clipboard)
+      clipboard->RenderFormat(static_cast<UINT>(wparam));
     break;
   case WM_RENDERALLFORMATS:
     // This message comes when SetClipboardData was sent a null data handle
     // and now this application is about to quit, so it must put data on
     // the clipboard before it exits.
-    // We always set data, so there isn't a need to actually do anything here.
+    if (clipboard && ::OpenClipboard(hwnd)) {
+      // Another application may have taken the clipboard in the meantime.
+      if (::GetClipboardOwner() == hwnd)
+        clipboard->RenderFormat(CF_BITMAP);
+      ::CloseClipboard();
+    }
+    break;
+  case WM_DESTROYCLIPBOARD:
+    // The clipboard was emptied, so the formats we haven't rendered are gone.
+    if (clipboard)
+      clipboard->ClearPendingFormats();
     break;
   case WM_DRAWCLIPBOARD:
     break;
@@ -202,6 +215,7 @@ Clipboard::Clipboard() : create_window_(false) {
 }
 
 Clipboard::~Clipboard() {
+  // Destroying the window renders the formats that are still pending.
   if (clipboard_owner_)
     ::DestroyWindow(clipboard_owner_);
   clipboard_owner_ = NULL;
@@ -271,6 +285,32 @@ void Clipboard::WriteWebSmartPaste() {
 }
 
 void Clipboard::WriteBitmap(const char* pixel_data, const char* size_data) {
+  // Making the CF_BITMAP takes a DIB section, a device-dependent bitmap and an
+  // alpha blend, which is wasted on the many copied images that are never
+  // pasted. Keep the pixels and advertise the format, and make the bitmap on
+  // the WM_RENDERFORMAT that asks for it. Windows keeps it after that.
+  DCHECK(clipboard_owner_);
+  const gfx::Size* size = reinterpret_cast<const gfx::Size*>(size_data);
+  pending_bitmap_.resize(2);
+  pending_bitmap_[0].assign(pixel_data,
+                            pixel_data + 4 * size->width() * size->height());
+  pending_bitmap_[1].assign(size_data, size_data + sizeof(gfx::Size));
+  ::SetClipboardData(CF_BITMAP, NULL);
+}
+
+void Clipboard::RenderFormat(UINT format) {
+  if (format != CF_BITMAP || pending_bitmap_.empty())
+    return;
+  ObjectMapParams bitmap;
+  bitmap.swap(pending_bitmap_);
+  RenderBitmap(&bitmap[0].front(), &bitmap[1].front());
+}
+
+void Clipboard::ClearPendingFormats() {
+  pending_bitmap_.clear();
+}
+
+void Clipboard::RenderBitmap(const char* pixel_data, const char* size_data) {
   const gfx::Size* size = reinterpret_cast<const gfx::Size*>(size_data);
   HDC dc = ::GetDC(NULL);
 
@@ -839,6 +879,11 @@ HWND Clipboard::GetClipboardWindow() const {
                                       0, 0, 0, 0, 0,
                                       HWND_MESSAGE,
                                       0, 0, 0);
+    // Lets ClipboardOwnerWndProc() render the formats written without data.
+    if (clipboard_owner_) {
+      ::SetWindowLongPtr(clipboard_owner_, GWLP_USERDATA,
+                         reinterpret_cast<LONG_PTR>(this));
+    }
   }
   return clipboard_owner_;
 }
@@ -40,6 +40,13 @@ void GesturePoint::UpdateValues(const TouchEvent& event) {
   const int64 event_timestamp_microseconds =
       event.GetTimestamp().InMicroseconds();
   if (event.GetEventType() == ui::ET_TOUCH_MOVED) {
+    for (int i = 0; i < event.GetCoalescedMoveCount(); ++i) {
+      gfx::Point location = event.GetCoalescedMoveLocation(i);
+      velocity_calculator_.PointSeen(
+          location.x(),
+          location.y(),
+          event.GetCoalescedMoveTimestamp(i).InMicroseconds());
+    }
     velocity_calculator_.PointSeen(event.GetLocation().x(),
                                    event.GetLocation().y(),
                                    event_timestamp_microseconds);
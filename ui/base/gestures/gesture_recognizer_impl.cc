@@ -4,6 +4,8 @@
 
 #include "ui/base/gestures/gesture_recognizer_impl.h"
 
+#include <vector>
+
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/time.h"
@@ -11,27 +13,12 @@
 #include "ui/base/gestures/gesture_configuration.h"
 #include "ui/base/gestures/gesture_sequence.h"
 #include "ui/base/gestures/gesture_types.h"
+#include "ui/gfx/point.h"
 
 namespace ui {
 
 namespace {
 
-// This is used to pop a std::queue when returning from a function.
-class ScopedPop {
- public:
-  explicit ScopedPop(std::queue<TouchEvent*>* queue) : queue_(queue) {
-  }
-
-  ~ScopedPop() {
-    delete queue_->front();
-    queue_->pop();
-  }
-
- private:
-  std::queue<TouchEvent*>* queue_;
-  DISALLOW_COPY_AND_ASSIGN(ScopedPop);
-};
-
 // CancelledTouchEvent mirrors a TouchEvent object.
 class MirroredTouchEvent : public TouchEvent {
  public:
@@ -45,6 +32,10 @@ class MirroredTouchEvent : public TouchEvent {
         radius_y_(real->RadiusY()),
         rotation_angle_(real->RotationAngle()),
         force_(real->Force()) {
+    for (int i = 0; i < real->GetCoalescedMoveCount(); ++i) {
+      coalesced_locations_.push_back(real->GetCoalescedMoveLocation(i));
+      coalesced_timestamps_.push_back(real->GetCoalescedMoveTimestamp(i));
+    }
   }
 
   virtual ~MirroredTouchEvent() {
@@ -87,6 +78,18 @@ class MirroredTouchEvent : public TouchEvent {
     return force_;
   }
 
+  virtual int GetCoalescedMoveCount() const OVERRIDE {
+    return static_cast<int>(coalesced_locations_.size());
+  }
+
+  virtual gfx::Point GetCoalescedMoveLocation(int index) const OVERRIDE {
+    return coalesced_locations_[index];
+  }
+
+  virtual base::TimeDelta GetCoalescedMoveTimestamp(int index) const OVERRIDE {
+    return coalesced_timestamps_[index];
+  }
+
  protected:
   void set_type(const EventType type) { type_ = type; }
 
@@ -100,6 +103,8 @@ class MirroredTouchEvent : public TouchEvent {
   float radius_y_;
   float rotation_angle_;
   float force_;
+  std::vector<gfx::Point> coalesced_locations_;
+  std::vector<base::TimeDelta> coalesced_timestamps_;
 
   DISALLOW_COPY_AND_ASSIGN(MirroredTouchEvent);
 };
@@ -159,8 +164,46 @@ void TransferTouchIdToConsumerMap(
   }
 }
 
+void AppendGestures(GestureRecognizer::Gestures* more,
+                    GestureRecognizer::Gestures* gestures) {
+  if (!more)
+    return;
+  gestures->insert(gestures->end(), more->begin(), more->end());
+  more->weak_erase(more->begin(), more->end());
+  delete more;
+}
+
 }  // namespace
 
+// A touch waiting in the queue of its consumer. Touches that the consumer
+// handles asynchronously wait for it to acknowledge them. Those it handles
+// right away, while earlier touches still wait, are queued already
+// acknowledged, so that the touches of a consumer are always recognized in
+// order.
+class GestureRecognizerImpl::QueuedTouchEvent : public MirroredTouchEvent {
+ public:
+  explicit QueuedTouchEvent(const TouchEvent* real)
+      : MirroredTouchEvent(real),
+        acked_(false),
+        status_(ui::TOUCH_STATUS_UNKNOWN) {
+  }
+
+  // Records that the consumer handled the touch with |status|.
+  void Ack(ui::TouchStatus status) {
+    acked_ = true;
+    status_ = status;
+  }
+
+  bool acked() const { return acked_; }
+  ui::TouchStatus status() const { return status_; }
+
+ private:
+  bool acked_;
+  ui::TouchStatus status_;
+
+  DISALLOW_COPY_AND_ASSIGN(QueuedTouchEvent);
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // GestureRecognizerImpl, public:
 
@@ -289,6 +332,17 @@ GestureSequence::Gestures* GestureRecognizerImpl::ProcessTouchEventForGesture(
       touch_id_target_for_gestures_[event.GetTouchId()] = target;
   }
 
+  // A touch handled right away waits for the earlier touches of its target
+  // that are still queued, and is recognized as soon as they are.
+  if (status != ui::TOUCH_STATUS_QUEUED &&
+      status != ui::TOUCH_STATUS_QUEUED_END &&
+      event_queue_.count(target) && !event_queue_[target]->empty()) {
+    QueuedTouchEvent* queued = new QueuedTouchEvent(&event);
+    queued->Ack(status);
+    event_queue_[target]->push(queued);
+    return NULL;
+  }
+
   GestureSequence* gesture_sequence = GetGestureSequenceForConsumer(target);
   return gesture_sequence->ProcessTouchEventForGesture(event, status);
 }
@@ -296,8 +350,8 @@ GestureSequence::Gestures* GestureRecognizerImpl::ProcessTouchEventForGesture(
 void GestureRecognizerImpl::QueueTouchEventForGesture(GestureConsumer* consumer,
                                                       const TouchEvent& event) {
   if (!event_queue_[consumer])
-    event_queue_[consumer] = new std::queue<TouchEvent*>();
-  event_queue_[consumer]->push(new MirroredTouchEvent(&event));
+    event_queue_[consumer] = new TouchEventQueue();
+  event_queue_[consumer]->push(new QueuedTouchEvent(&event));
 }
 
 GestureSequence::Gestures* GestureRecognizerImpl::AdvanceTouchQueue(
@@ -308,22 +362,21 @@ GestureSequence::Gestures* GestureRecognizerImpl::AdvanceTouchQueue(
     return NULL;
   }
 
-  ScopedPop pop(event_queue_[consumer]);
-  TouchEvent* event = event_queue_[consumer]->front();
+  TouchEventQueue* queue = event_queue_[consumer];
+  DCHECK(!queue->front()->acked());
+  queue->front()->Ack(
+      processed ? ui::TOUCH_STATUS_CONTINUE : ui::TOUCH_STATUS_UNKNOWN);
 
+  // Recognizes the acknowledged touch, and those handled after it that were
+  // only waiting for it.
   GestureSequence* sequence = GetGestureSequenceForConsumer(consumer);
-
-  if (processed && event->GetEventType() == ui::ET_TOUCH_RELEASED) {
-    // A touch release was was processed (e.g. preventDefault()ed by a
-    // web-page), but we still need to process a touch cancel.
-    CancelledTouchEvent cancelled(event);
-    return sequence->ProcessTouchEventForGesture(cancelled,
-                                                 ui::TOUCH_STATUS_UNKNOWN);
+  scoped_ptr<Gestures> gestures(new Gestures());
+  while (!queue->empty() && queue->front()->acked()) {
+    scoped_ptr<QueuedTouchEvent> event(queue->front());
+    queue->pop();
+    RecognizeQueuedTouch(sequence, *event, event->status(), gestures.get());
   }
-
-  return sequence->ProcessTouchEventForGesture(
-      *event,
-      processed ? ui::TOUCH_STATUS_CONTINUE : ui::TOUCH_STATUS_UNKNOWN);
+  return gestures.release();
 }
 
 void GestureRecognizerImpl::FlushTouchQueue(GestureConsumer* consumer) {
@@ -333,7 +386,12 @@ void GestureRecognizerImpl::FlushTouchQueue(GestureConsumer* consumer) {
   }
 
   if (event_queue_.count(consumer)) {
-    delete event_queue_[consumer];
+    TouchEventQueue* queue = event_queue_[consumer];
+    while (!queue->empty()) {
+      delete queue->front();
+      queue->pop();
+    }
+    delete queue;
     event_queue_.erase(consumer);
   }
 
@@ -341,6 +399,25 @@ void GestureRecognizerImpl::FlushTouchQueue(GestureConsumer* consumer) {
   RemoveConsumerFromMap(consumer, &touch_id_target_for_gestures_);
 }
 
+void GestureRecognizerImpl::RecognizeQueuedTouch(
+    GestureSequence* sequence,
+    const QueuedTouchEvent& event,
+    ui::TouchStatus status,
+    Gestures* gestures) {
+  if (status != ui::TOUCH_STATUS_UNKNOWN &&
+      event.GetEventType() == ui::ET_TOUCH_RELEASED) {
+    // A touch release was was processed (e.g. preventDefault()ed by a
+    // web-page), but we still need to process a touch cancel.
+    CancelledTouchEvent cancelled(&event);
+    AppendGestures(sequence->ProcessTouchEventForGesture(
+                       cancelled, ui::TOUCH_STATUS_UNKNOWN),
+                   gestures);
+    return;
+  }
+  AppendGestures(sequence->ProcessTouchEventForGesture(event, status),
+                 gestures);
+}
+
 // GestureRecognizer, static
 GestureRecognizer* GestureRecognizer::Create(GestureEventHelper* helper) {
   return new GestureRecognizerImpl(helper);
@@ -58,7 +58,17 @@ class UI_EXPORT GestureRecognizerImpl : public GestureRecognizer {
                                       bool processed) OVERRIDE;
   virtual void FlushTouchQueue(GestureConsumer* consumer) OVERRIDE;
 
-  typedef std::queue<TouchEvent*> TouchEventQueue;
+  // A touch waiting in the queue of its consumer to be recognized.
+  class QueuedTouchEvent;
+  typedef std::queue<QueuedTouchEvent*> TouchEventQueue;
+
+  // Recognizes |event|, whose handler returned |status|, and appends the
+  // gestures found to |gestures|.
+  void RecognizeQueuedTouch(GestureSequence* sequence,
+                            const QueuedTouchEvent& event,
+                            ui::TouchStatus status,
+                            Gestures* gestures);
+
   std::map<GestureConsumer*, TouchEventQueue*> event_queue_;
   std::map<GestureConsumer*, GestureSequence*> consumer_sequence_;
 
@@ -4,8 +4,24 @@
 
 #include "ui/base/gestures/gesture_types.h"
 
+#include "ui/gfx/point.h"
+
 namespace ui {
 
+int TouchEvent::GetCoalescedMoveCount() const {
+  return 0;
+}
+
+gfx::Point TouchEvent::GetCoalescedMoveLocation(int index) const {
+  NOTREACHED();
+  return gfx::Point();
+}
+
+base::TimeDelta TouchEvent::GetCoalescedMoveTimestamp(int index) const {
+  NOTREACHED();
+  return base::TimeDelta();
+}
+
 GestureEventDetails::GestureEventDetails(ui::EventType type,
                                          float delta_x,
                                          float delta_y)
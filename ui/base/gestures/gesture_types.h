@@ -136,6 +136,13 @@ class UI_EXPORT TouchEvent {
   virtual float RadiusY() const = 0;
   virtual float RotationAngle() const = 0;
   virtual float Force() const = 0;
+
+  // The earlier moves of the same touch that were merged into this one when
+  // moves came faster than they could be dispatched, oldest first. Their
+  // locations are in the coordinates of GetLocation().
+  virtual int GetCoalescedMoveCount() const;
+  virtual gfx::Point GetCoalescedMoveLocation(int index) const;
+  virtual base::TimeDelta GetCoalescedMoveTimestamp(int index) const;
 };
 
 // An abstract type to represent gesture-events.
@@ -19,8 +19,11 @@
 
 #include "base/basictypes.h"
 #include "base/logging.h"
+#include "base/metrics/histogram.h"
+#include "base/stl_util.h"
 #include "base/string_util.h"
 #include "base/third_party/icu/icu_utf.h"
+#include "base/time.h"
 #include "base/utf_string_conversions.h"
 #include "ui/base/events.h"
 #include "ui/base/ime/ibus_client_impl.h"
@@ -83,7 +86,8 @@ class InputMethodIBus::PendingKeyEventImpl
  public:
   PendingKeyEventImpl(InputMethodIBus* input_method,
                       const base::NativeEvent& native_event,
-                      guint32 ibus_keyval);
+                      guint32 ibus_keyval,
+                      uint32 sequence_number);
   virtual ~PendingKeyEventImpl();
 
   // internal::IBusClient::PendingKeyEvent overrides:
@@ -108,15 +112,24 @@ class InputMethodIBus::PendingKeyEventImpl
 
   const guint32 ibus_keyval_;
 
+  // The order in which the key event was sent to ibus.
+  const uint32 sequence_number_;
+
+  // When the key event was sent to ibus.
+  const base::TimeTicks send_time_;
+
   DISALLOW_COPY_AND_ASSIGN(PendingKeyEventImpl);
 };
 
 InputMethodIBus::PendingKeyEventImpl::PendingKeyEventImpl(
     InputMethodIBus* input_method,
     const base::NativeEvent& native_event,
-    guint32 ibus_keyval)
+    guint32 ibus_keyval,
+    uint32 sequence_number)
     : input_method_(input_method),
-      ibus_keyval_(ibus_keyval) {
+      ibus_keyval_(ibus_keyval),
+      sequence_number_(sequence_number),
+      send_time_(base::TimeTicks::Now()) {
   DCHECK(input_method_);
 
   // TODO(yusukes): Support non-native event (from e.g. a virtual keyboard).
@@ -133,10 +146,14 @@ void InputMethodIBus::PendingKeyEventImpl::ProcessPostIME(bool handled) {
   if (!input_method_)
     return;
 
+  UMA_HISTOGRAM_TIMES("IME.IBus.KeyEventLatency",
+                      base::TimeTicks::Now() - send_time_);
+
   if (x_event_.type == KeyPress || x_event_.type == KeyRelease) {
-    input_method_->ProcessKeyEventPostIME(reinterpret_cast<XEvent*>(&x_event_),
-                                          ibus_keyval_,
-                                          handled);
+    input_method_->OnKeyEventResult(sequence_number_,
+                                    reinterpret_cast<XEvent*>(&x_event_),
+                                    ibus_keyval_,
+                                    handled);
     return;
   }
 
@@ -145,6 +162,21 @@ void InputMethodIBus::PendingKeyEventImpl::ProcessPostIME(bool handled) {
   // and 'unmodified_character_' to support i18n VKs like a French VK!
 }
 
+// InputMethodIBus::KeyEventResult implementation -----------------------------
+struct InputMethodIBus::KeyEventResult {
+  KeyEventResult(const base::NativeEvent& native_event,
+                 guint32 ibus_keyval,
+                 bool handled)
+      : x_event(*GetKeyEvent(native_event)),
+        ibus_keyval(ibus_keyval),
+        handled(handled) {
+  }
+
+  XKeyEvent x_event;
+  guint32 ibus_keyval;
+  bool handled;
+};
+
 // InputMethodIBus::PendingCreateICRequestImpl implementation -----------------
 class InputMethodIBus::PendingCreateICRequestImpl
     : public internal::IBusClient::PendingCreateICRequest {
@@ -217,6 +249,8 @@ InputMethodIBus::InputMethodIBus(
       ibus_client_(new internal::MockIBusClient),
 #endif
       context_(NULL),
+      next_key_event_sequence_number_(0),
+      next_key_event_to_process_(0),
       pending_create_ic_request_(NULL),
       context_focused_(false),
       composing_text_(false),
@@ -292,10 +326,14 @@ void InputMethodIBus::DispatchKeyEvent(const base::NativeEvent& native_event) {
   // TEXT_INPUT_TYPE_PASSWORD, to bypass the input method.
   // Note: We need to send the key event to ibus even if the |context_| is not
   // enabled, so that ibus can have a chance to enable the |context_|.
+  // Keys without a keysym, which the input method can't tell apart, don't
+  // need a round trip to ibus either, as long as no earlier key event is
+  // still waiting for one and could be overtaken.
   if (!context_focused_ ||
       GetTextInputType() == TEXT_INPUT_TYPE_PASSWORD ||
       ibus_client_->GetInputMethodType() ==
-      internal::IBusClient::INPUT_METHOD_XKB_LAYOUT) {
+      internal::IBusClient::INPUT_METHOD_XKB_LAYOUT ||
+      (ibus_keyval == NoSymbol && pending_key_events_.empty())) {
     if (native_event->type == KeyPress)
       ProcessUnfilteredKeyPressEvent(native_event, ibus_keyval);
     else
@@ -303,8 +341,11 @@ void InputMethodIBus::DispatchKeyEvent(const base::NativeEvent& native_event) {
     return;
   }
 
+  // Key events are sent to ibus without waiting for the results of earlier
+  // ones, and numbered so that results are processed in order.
   PendingKeyEventImpl* pending_key =
-      new PendingKeyEventImpl(this, native_event, ibus_keyval);
+      new PendingKeyEventImpl(this, native_event, ibus_keyval,
+                              next_key_event_sequence_number_++);
   pending_key_events_.insert(pending_key);
 
   ibus_client_->SendKeyEvent(context_,
@@ -709,6 +750,34 @@ void InputMethodIBus::FinishPendingKeyEvent(PendingKeyEventImpl* pending_key) {
   pending_key_events_.erase(pending_key);
 }
 
+void InputMethodIBus::OnKeyEventResult(uint32 sequence_number,
+                                       const base::NativeEvent& native_event,
+                                       guint32 ibus_keyval,
+                                       bool handled) {
+  if (sequence_number != next_key_event_to_process_) {
+    DCHECK(!early_key_event_results_.count(sequence_number));
+    early_key_event_results_[sequence_number] =
+        new KeyEventResult(native_event, ibus_keyval, handled);
+    return;
+  }
+
+  // Processing a result may abandon all pending key events, which resets
+  // |next_key_event_to_process_| and drops the early results.
+  ++next_key_event_to_process_;
+  ProcessKeyEventPostIME(native_event, ibus_keyval, handled);
+
+  std::map<uint32, KeyEventResult*>::iterator it;
+  while ((it = early_key_event_results_.find(next_key_event_to_process_)) !=
+         early_key_event_results_.end()) {
+    scoped_ptr<KeyEventResult> result(it->second);
+    early_key_event_results_.erase(it);
+    ++next_key_event_to_process_;
+    ProcessKeyEventPostIME(reinterpret_cast<XEvent*>(&result->x_event),
+                           result->ibus_keyval,
+                           result->handled);
+  }
+}
+
 void InputMethodIBus::AbandonAllPendingKeyEvents() {
   std::set<PendingKeyEventImpl*>::iterator i;
   for (i = pending_key_events_.begin(); i != pending_key_events_.end(); ++i) {
@@ -716,6 +785,8 @@ void InputMethodIBus::AbandonAllPendingKeyEvents() {
     (*i)->Abandon();
   }
   pending_key_events_.clear();
+  STLDeleteValues(&early_key_event_results_);
+  next_key_event_to_process_ = next_key_event_sequence_number_;
 }
 
 void InputMethodIBus::OnCommitText(
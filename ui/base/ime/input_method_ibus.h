@@ -6,6 +6,7 @@
 #define UI_BASE_IME_INPUT_METHOD_IBUS_H_
 #pragma once
 
+#include <map>
 #include <set>
 #include <string>
 
@@ -60,6 +61,7 @@ class UI_EXPORT InputMethodIBus : public InputMethodBase {
  private:
   class PendingKeyEventImpl;
   class PendingCreateICRequestImpl;
+  struct KeyEventResult;
 
   // Overridden from InputMethodBase:
   virtual void OnWillChangeFocusedClient(TextInputClient* focused_before,
@@ -123,6 +125,15 @@ class UI_EXPORT InputMethodIBus : public InputMethodBase {
   // from |pending_key_events_|.
   void FinishPendingKeyEvent(PendingKeyEventImpl* pending_key);
 
+  // Called with the result of the key event numbered |sequence_number| from
+  // ibus. Several key events may be sent to ibus before it replies, so the
+  // result is only processed once those of all earlier key events have been;
+  // until then it is kept in |early_key_event_results_|.
+  void OnKeyEventResult(uint32 sequence_number,
+                        const base::NativeEvent& native_event,
+                        guint32 ibus_keyval,
+                        bool handled);
+
   // Abandons all pending key events. It usually happends when we lose keyboard
   // focus, the text input type is changed or we are destroyed.
   void AbandonAllPendingKeyEvents();
@@ -156,6 +167,15 @@ class UI_EXPORT InputMethodIBus : public InputMethodBase {
   // They will be deleted in ProcessKeyEventDone().
   std::set<PendingKeyEventImpl*> pending_key_events_;
 
+  // The sequence number of the next key event sent to ibus, and that of the
+  // key event whose result is to be processed next.
+  uint32 next_key_event_sequence_number_;
+  uint32 next_key_event_to_process_;
+
+  // Results of key events that came in before those of earlier key events,
+  // by sequence number. Owned.
+  std::map<uint32, KeyEventResult*> early_key_event_results_;
+
   // The pending request for creating the |context_| instance. We need to keep
   // this pointer so that we can receive or abandon the result.
   PendingCreateICRequestImpl* pending_create_ic_request_;
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <iterator>
+#include <map>
 #include <string>
 
 #include "base/command_line.h"
@@ -14,12 +15,15 @@
 #include "base/file_util.h"
 #include "base/i18n/file_util_icu.h"
 #include "base/i18n/rtl.h"
+#include "base/lazy_instance.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/path_service.h"
 #include "base/stringprintf.h"
 #include "base/string_number_conversions.h"
 #include "base/string_split.h"
 #include "base/string_util.h"
+#include "base/synchronization/lock.h"
 #include "base/sys_string_conversions.h"
 #include "base/utf_string_conversions.h"
 #include "build/build_config.h"
@@ -352,6 +356,178 @@ std::string GetCanonicalLocale(const std::string& locale) {
 }
 #endif
 
+// A format string split at its placeholders, so that formatting is a single
+// pass over the pieces rather than a parse of the string. Follows the syntax
+// of ReplaceStringPlaceholders(): "$1" to "$9" are replaced, and in a run of
+// '$' followed by anything else, the first one is dropped.
+class FormatTemplate : public base::RefCountedThreadSafe<FormatTemplate> {
+ public:
+  explicit FormatTemplate(const string16& format_string);
+
+  const string16& format_string() const { return format_string_; }
+
+  // Same as ReplaceStringPlaceholders() with the |count| |replacements|.
+  string16 Format(const string16* const* replacements,
+                  size_t count,
+                  std::vector<size_t>* offsets) const;
+
+ private:
+  friend class base::RefCountedThreadSafe<FormatTemplate>;
+
+  ~FormatTemplate() {}
+
+  string16 format_string_;
+
+  // The text before each placeholder, and after the last one.
+  std::vector<string16> literals_;
+  size_t literals_length_;
+
+  // The zero-based index of the replacement of each placeholder.
+  std::vector<size_t> placeholders_;
+
+  DISALLOW_COPY_AND_ASSIGN(FormatTemplate);
+};
+
+FormatTemplate::FormatTemplate(const string16& format_string)
+    : format_string_(format_string),
+      literals_length_(0) {
+  string16 literal;
+  for (string16::const_iterator i = format_string.begin();
+       i != format_string.end(); ++i) {
+    if ('$' != *i) {
+      literal.push_back(*i);
+      continue;
+    }
+    // A '$' that ends the string is dropped.
+    if (i + 1 == format_string.end())
+      break;
+
+    ++i;
+    DCHECK('$' == *i || '1' <= *i) << "Invalid placeholder: " << *i;
+    if ('$' == *i) {
+      while (i != format_string.end() && '$' == *i) {
+        literal.push_back('$');
+        ++i;
+      }
+      --i;
+      continue;
+    }
+
+    size_t index = 0;
+    while (i != format_string.end() && '0' <= *i && *i <= '9') {
+      index *= 10;
+      index += *i - '0';
+      ++i;
+    }
+    --i;
+    literals_length_ += literal.length();
+    literals_.push_back(literal);
+    literal.clear();
+    // A '$' without digits wraps around to an index nothing replaces.
+    placeholders_.push_back(index - 1);
+  }
+  literals_length_ += literal.length();
+  literals_.push_back(literal);
+}
+
+string16 FormatTemplate::Format(const string16* const* replacements,
+                                size_t count,
+                                std::vector<size_t>* offsets) const {
+  size_t length = literals_length_;
+  for (size_t i = 0; i < placeholders_.size(); ++i) {
+    if (placeholders_[i] < count)
+      length += replacements[placeholders_[i]]->length();
+  }
+
+  string16 formatted;
+  formatted.reserve(length);
+
+  // The offsets of the placeholders, ordered by index. Like
+  // ReplaceStringPlaceholders(), a placeholder goes before the earlier ones of
+  // the same index.
+  std::vector<std::pair<size_t, size_t> > placeholder_offsets;
+  for (size_t i = 0; i < placeholders_.size(); ++i) {
+    formatted.append(literals_[i]);
+    size_t index = placeholders_[i];
+    if (offsets) {
+      std::pair<size_t, size_t> placeholder_offset(index, formatted.size());
+      std::vector<std::pair<size_t, size_t> >::iterator it =
+          placeholder_offsets.begin();
+      while (it != placeholder_offsets.end() && it->first < index)
+        ++it;
+      placeholder_offsets.insert(it, placeholder_offset);
+    }
+    if (index < count)
+      formatted.append(*replacements[index]);
+  }
+  formatted.append(literals_.back());
+
+  if (offsets) {
+    for (size_t i = 0; i < placeholder_offsets.size(); ++i)
+      offsets->push_back(placeholder_offsets[i].second);
+  }
+  return formatted;
+}
+
+// The templates of the format strings used so far, by message id.
+class FormatTemplateCache {
+ public:
+  FormatTemplateCache() {}
+
+  scoped_refptr<FormatTemplate> Get(int message_id,
+                                    const string16& format_string) {
+    base::AutoLock lock_scope(lock_);
+    scoped_refptr<FormatTemplate>& format_template = templates_[message_id];
+    // The format string changes with the locale.
+    if (!format_template || format_template->format_string() != format_string)
+      format_template = new FormatTemplate(format_string);
+    return format_template;
+  }
+
+ private:
+  base::Lock lock_;
+  std::map<int, scoped_refptr<FormatTemplate> > templates_;
+
+  DISALLOW_COPY_AND_ASSIGN(FormatTemplateCache);
+};
+
+base::LazyInstance<FormatTemplateCache>::Leaky g_format_templates =
+    LAZY_INSTANCE_INITIALIZER;
+
+// A collator for each locale asked for, to clone new ones from. Creating a
+// collator from a locale loads and compiles its rules.
+class CollatorCache {
+ public:
+  CollatorCache() {}
+
+  icu::Collator* CreateCollator(const std::string& locale) {
+    base::AutoLock lock_scope(lock_);
+    std::map<std::string, icu::Collator*>::const_iterator it =
+        collators_.find(locale);
+    if (it == collators_.end()) {
+      UErrorCode error = U_ZERO_ERROR;
+      icu::Locale loc(locale.c_str());
+      scoped_ptr<icu::Collator> collator(
+          icu::Collator::createInstance(loc, error));
+      // Locales without a collator are remembered too.
+      if (U_FAILURE(error))
+        collator.reset();
+      it = collators_.insert(std::make_pair(locale, collator.release())).first;
+    }
+    return it->second ? it->second->clone() : NULL;
+  }
+
+ private:
+  base::Lock lock_;
+  // Owns the collators, which are never deleted.
+  std::map<std::string, icu::Collator*> collators_;
+
+  DISALLOW_COPY_AND_ASSIGN(CollatorCache);
+};
+
+base::LazyInstance<CollatorCache>::Leaky g_collators =
+    LAZY_INSTANCE_INITIALIZER;
+
 }  // namespace
 
 namespace l10n_util {
@@ -614,21 +790,18 @@ std::string GetStringUTF8(int message_id) {
 
 string16 GetStringUTF16(int message_id) {
   ResourceBundle& rb = ResourceBundle::GetSharedInstance();
-  string16 str = rb.GetLocalizedString(message_id);
+  string16 str = rb.GetLocalizedStringRef(message_id);
   AdjustParagraphDirectionality(&str);
 
   return str;
 }
 
 static string16 GetStringF(int message_id,
-                           const std::vector<string16>& replacements,
+                           const string16* const* replacements,
+                           size_t replacement_count,
                            std::vector<size_t>* offsets) {
-  // TODO(tc): We could save a string copy if we got the raw string as
-  // a StringPiece and were able to call ReplaceStringPlaceholders with
-  // a StringPiece format string and string16 substitution strings.  In
-  // practice, the strings should be relatively short.
   ResourceBundle& rb = ResourceBundle::GetSharedInstance();
-  const string16& format_string = rb.GetLocalizedString(message_id);
+  const string16& format_string = rb.GetLocalizedStringRef(message_id);
 
 #ifndef NDEBUG
   // Make sure every replacement string is being used, so we don't just
@@ -640,7 +813,7 @@ static string16 GetStringF(int message_id,
 
     // $9 is the highest allowed placeholder.
     for (size_t i = 0; i < 9; ++i) {
-      bool placeholder_should_exist = replacements.size() > i;
+      bool placeholder_should_exist = replacement_count > i;
 
       std::string placeholder =
           base::StringPrintf("$%d", static_cast<int>(i + 1));
@@ -658,8 +831,10 @@ static string16 GetStringF(int message_id,
   }
 #endif
 
-  string16 formatted = ReplaceStringPlaceholders(format_string, replacements,
-                                                 offsets);
+  scoped_refptr<FormatTemplate> format_template =
+      g_format_templates.Get().Get(message_id, format_string);
+  string16 formatted =
+      format_template->Format(replacements, replacement_count, offsets);
   AdjustParagraphDirectionality(&formatted);
 
   return formatted;
@@ -693,9 +868,8 @@ std::string GetStringFUTF8(int message_id,
 
 string16 GetStringFUTF16(int message_id,
                          const string16& a) {
-  std::vector<string16> replacements;
-  replacements.push_back(a);
-  return GetStringF(message_id, replacements, NULL);
+  const string16* replacements[] = { &a };
+  return GetStringF(message_id, replacements, arraysize(replacements), NULL);
 }
 
 string16 GetStringFUTF16(int message_id,
@@ -708,11 +882,8 @@ string16 GetStringFUTF16(int message_id,
                          const string16& a,
                          const string16& b,
                          const string16& c) {
-  std::vector<string16> replacements;
-  replacements.push_back(a);
-  replacements.push_back(b);
-  replacements.push_back(c);
-  return GetStringF(message_id, replacements, NULL);
+  const string16* replacements[] = { &a, &b, &c };
+  return GetStringF(message_id, replacements, arraysize(replacements), NULL);
 }
 
 string16 GetStringFUTF16(int message_id,
@@ -720,12 +891,8 @@ string16 GetStringFUTF16(int message_id,
                          const string16& b,
                          const string16& c,
                          const string16& d) {
-  std::vector<string16> replacements;
-  replacements.push_back(a);
-  replacements.push_back(b);
-  replacements.push_back(c);
-  replacements.push_back(d);
-  return GetStringF(message_id, replacements, NULL);
+  const string16* replacements[] = { &a, &b, &c, &d };
+  return GetStringF(message_id, replacements, arraysize(replacements), NULL);
 }
 
 string16 GetStringFUTF16(int message_id,
@@ -734,21 +901,16 @@ string16 GetStringFUTF16(int message_id,
                          const string16& c,
                          const string16& d,
                          const string16& e) {
-  std::vector<string16> replacements;
-  replacements.push_back(a);
-  replacements.push_back(b);
-  replacements.push_back(c);
-  replacements.push_back(d);
-  replacements.push_back(e);
-  return GetStringF(message_id, replacements, NULL);
+  const string16* replacements[] = { &a, &b, &c, &d, &e };
+  return GetStringF(message_id, replacements, arraysize(replacements), NULL);
 }
 
 string16 GetStringFUTF16(int message_id, const string16& a, size_t* offset) {
   DCHECK(offset);
   std::vector<size_t> offsets;
-  std::vector<string16> replacements;
-  replacements.push_back(a);
-  string16 result = GetStringF(message_id, replacements, &offsets);
+  const string16* replacements[] = { &a };
+  string16 result = GetStringF(message_id, replacements,
+                               arraysize(replacements), &offsets);
   DCHECK(offsets.size() == 1);
   *offset = offsets[0];
   return result;
@@ -758,10 +920,9 @@ string16 GetStringFUTF16(int message_id,
                          const string16& a,
                          const string16& b,
                          std::vector<size_t>* offsets) {
-  std::vector<string16> replacements;
-  replacements.push_back(a);
-  replacements.push_back(b);
-  return GetStringF(message_id, replacements, offsets);
+  const string16* replacements[] = { &a, &b };
+  return GetStringF(message_id, replacements, arraysize(replacements),
+                    offsets);
 }
 
 string16 GetStringFUTF16Int(int message_id, int a) {
@@ -772,6 +933,10 @@ string16 GetStringFUTF16Int(int message_id, int64 a) {
   return GetStringFUTF16(message_id, UTF8ToUTF16(base::Int64ToString(a)));
 }
 
+icu::Collator* CreateCollator(const std::string& locale) {
+  return g_collators.Get().CreateCollator(locale);
+}
+
 // Compares the character data stored in two different string16 strings by
 // specified Collator instance.
 UCollationResult CompareString16WithCollator(const icu::Collator* collator,
@@ -787,6 +952,25 @@ UCollationResult CompareString16WithCollator(const icu::Collator* collator,
   return result;
 }
 
+void GetSortKeyWithCollator(const icu::Collator* collator,
+                            const string16& string,
+                            std::vector<uint8>* key) {
+  DCHECK(collator);
+  const UChar* chars = static_cast<const UChar*>(string.c_str());
+  int32_t length = static_cast<int32_t>(string.length());
+  // Most keys fit a buffer of a few bytes per character; getSortKey() returns
+  // the size needed when they don't.
+  key->resize(string.length() * 4 + 16);
+  int32_t key_length = collator->getSortKey(chars, length, &(*key)[0],
+                                            static_cast<int32_t>(key->size()));
+  if (key_length > static_cast<int32_t>(key->size())) {
+    key->resize(key_length);
+    key_length = collator->getSortKey(chars, length, &(*key)[0], key_length);
+  }
+  // The key ends with a NUL byte, which doesn't change how keys compare.
+  key->resize(key_length);
+}
+
 // Specialization of operator() method for string16 version.
 template <>
 bool StringComparator<string16>::operator()(const string16& lhs,
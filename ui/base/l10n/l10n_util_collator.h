@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 
+#include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/utf_string_conversions.h"
 #include "ui/base/ui_export.h"
@@ -18,12 +19,66 @@
 
 namespace l10n_util {
 
+// Returns a new collator for |locale|, owned by the caller, or NULL if there
+// is none. The collator is cloned from one kept for each locale, which is much
+// faster than creating it from the locale's rules.
+UI_EXPORT icu::Collator* CreateCollator(const std::string& locale);
+
 // Compares the two strings using the specified collator.
 UI_EXPORT UCollationResult CompareString16WithCollator(
     const icu::Collator* collator,
     const string16& lhs,
     const string16& rhs);
 
+// Sets |key| to the sort key of |string| for |collator|. Sort keys compare
+// bytewise the way their strings compare with the collator.
+UI_EXPORT void GetSortKeyWithCollator(const icu::Collator* collator,
+                                      const string16& string,
+                                      std::vector<uint8>* key);
+
+namespace internal {
+
+// Below this many elements, sorts compare the strings with the collator
+// rather than computing their sort keys.
+const size_t kMinElementsForSortKeys = 16;
+
+// Sorts [|first|, |last|) by the sort keys of the strings |get_string|
+// returns for the elements, computing each key once. Elements that collate
+// equal keep their order.
+template <class Iterator, class StringGetter>
+void SortWithSortKeys(const icu::Collator* collator,
+                      Iterator first,
+                      Iterator last,
+                      StringGetter get_string) {
+  size_t count = last - first;
+  // Ties between equal keys are broken by the position, keeping the sort
+  // stable.
+  std::vector<std::pair<std::vector<uint8>, size_t> > keys(count);
+  for (size_t i = 0; i < count; ++i) {
+    GetSortKeyWithCollator(collator, get_string(first[i]), &keys[i].first);
+    keys[i].second = i;
+  }
+  std::sort(keys.begin(), keys.end());
+
+  // Moves the elements in place, following the cycles of the permutation:
+  // position i gets the element at |order[i]|.
+  std::vector<size_t> order(count);
+  for (size_t i = 0; i < count; ++i)
+    order[i] = keys[i].second;
+  for (size_t i = 0; i < count; ++i) {
+    size_t current = i;
+    while (order[current] != i) {
+      size_t next = order[current];
+      std::iter_swap(first + current, first + next);
+      order[current] = current;
+      current = next;
+    }
+    order[current] = current;
+  }
+}
+
+}  // namespace internal
+
 // Used by SortStringsUsingMethod. Invokes a method on the objects passed to
 // operator (), comparing the string results using a collator.
 template <class T, class Method>
@@ -47,6 +102,21 @@ class StringMethodComparatorWithCollator
   Method method_;
 };
 
+// Used by SortStringsUsingMethod. Invokes a method on the objects passed to
+// operator (), returning the string result.
+template <class T, class Method>
+class StringMethodGetter {
+ public:
+  explicit StringMethodGetter(Method method) : method_(method) { }
+
+  string16 operator() (T* t) const {
+    return (t->*method_)();
+  }
+
+ private:
+  Method method_;
+};
+
 // Used by SortStringsUsingMethod. Invokes a method on the objects passed to
 // operator (), comparing the string results using <.
 template <class T, class Method>
@@ -72,15 +142,20 @@ template <class T, class Method>
 void SortStringsUsingMethod(const std::string& locale,
                             std::vector<T*>* elements,
                             Method method) {
-  UErrorCode error = U_ZERO_ERROR;
-  icu::Locale loc(locale.c_str());
-  scoped_ptr<icu::Collator> collator(icu::Collator::createInstance(loc, error));
-  if (U_FAILURE(error)) {
+  scoped_ptr<icu::Collator> collator(CreateCollator(locale));
+  if (!collator.get()) {
     sort(elements->begin(), elements->end(),
          StringMethodComparator<T, Method>(method));
     return;
   }
 
+  if (elements->size() >= internal::kMinElementsForSortKeys) {
+    internal::SortWithSortKeys(collator.get(), elements->begin(),
+                               elements->end(),
+                               StringMethodGetter<T, Method>(method));
+    return;
+  }
+
   std::sort(elements->begin(), elements->end(),
       StringMethodComparatorWithCollator<T, Method>(collator.get(), method));
 }
@@ -116,6 +191,23 @@ template <> UI_EXPORT
 bool StringComparator<string16>::operator()(const string16& lhs,
                                             const string16& rhs);
 
+// Returns the string key of the elements StringComparator compares.
+template <class Element>
+class StringKeyGetter {
+ public:
+  const string16& operator()(const Element& element) const {
+    return element.GetStringKey();
+  }
+};
+
+template <>
+class StringKeyGetter<string16> {
+ public:
+  const string16& operator()(const string16& element) const {
+    return element;
+  }
+};
+
 // In place sorting of |elements| of a vector according to the string key of
 // each element in the vector by using collation rules for |locale|.
 // |begin_index| points to the start position of elements in the vector which
@@ -129,11 +221,17 @@ void SortVectorWithStringKey(const std::string& locale,
                              bool needs_stable_sort) {
   DCHECK(begin_index < end_index &&
          end_index <= static_cast<unsigned int>(elements->size()));
-  UErrorCode error = U_ZERO_ERROR;
-  icu::Locale loc(locale.c_str());
-  scoped_ptr<icu::Collator> collator(icu::Collator::createInstance(loc, error));
-  if (U_FAILURE(error))
-    collator.reset();
+  scoped_ptr<icu::Collator> collator(CreateCollator(locale));
+  // Sorting by sort keys is stable.
+  if (collator.get() &&
+      end_index - begin_index >= internal::kMinElementsForSortKeys) {
+    internal::SortWithSortKeys(collator.get(),
+                               elements->begin() + begin_index,
+                               elements->begin() + end_index,
+                               StringKeyGetter<Element>());
+    return;
+  }
+
   StringComparator<Element> c(collator.get());
   if (needs_stable_sort) {
     stable_sort(elements->begin() + begin_index,
@@ -5,6 +5,7 @@
 #include "build/build_config.h"
 
 #if defined(OS_POSIX) && !defined(OS_MACOSX)
+#include <algorithm>
 #include <cstdlib>
 #endif
 
@@ -303,6 +304,32 @@ TEST_F(L10nUtilTest, SortStringsUsingFunction) {
   STLDeleteElements(&strings);
 }
 
+// Sorts long enough to use sort keys order the strings like the collator,
+// keeping strings that collate equal in order.
+TEST_F(L10nUtilTest, SortStrings16WithSortKeys) {
+  const char* kStrings[] = {
+    "delta", "Alpha", "charlie", "bravo", "Echo", "alpha", "golf", "foxtrot",
+    "hotel", "India", "juliet", "kilo", "Lima", "mike", "November", "oscar",
+    "papa", "Quebec", "romeo", "sierra", "\xC3\xA9" "cho", "alpha",
+  };
+  std::vector<string16> strings;
+  for (size_t i = 0; i < arraysize(kStrings); ++i)
+    strings.push_back(UTF8ToUTF16(kStrings[i]));
+  ASSERT_GE(strings.size(), l10n_util::internal::kMinElementsForSortKeys);
+
+  scoped_ptr<icu::Collator> collator(l10n_util::CreateCollator("en-US"));
+  ASSERT_TRUE(collator.get());
+  std::vector<string16> expected(strings);
+  std::stable_sort(expected.begin(), expected.end(),
+                   l10n_util::StringComparator<string16>(collator.get()));
+
+  l10n_util::SortStrings16("en-US", &strings);
+  EXPECT_TRUE(expected == strings);
+  EXPECT_EQ(ASCIIToUTF16("alpha"), strings[0]);
+  EXPECT_EQ(ASCIIToUTF16("alpha"), strings[1]);
+  EXPECT_EQ(ASCIIToUTF16("Alpha"), strings[2]);
+}
+
 TEST_F(L10nUtilTest, GetDisplayNameForLocale) {
   // TODO(jungshik): Make this test more extensive.
   // Test zh-CN and zh-TW are treated as zh-Hans and zh-Hant.
@@ -19,6 +19,11 @@ class ComboboxModel {
   // Returns the string at the specified index.
   virtual string16 GetItemAt(int index) = 0;
 
+  // Returns the index of an item at least as wide as every other one, which
+  // the combo box is then sized by, or -1 if the model doesn't know. Combo
+  // boxes with many items that don't know are sized by a sample of them.
+  virtual int GetWidestItemIndex() const { return -1; }
+
  protected:
   virtual ~ComboboxModel() {}
 };
@@ -6,6 +6,9 @@
 #define UI_BASE_MODELS_LIST_MODEL_H_
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
 #include "base/basictypes.h"
 #include "base/logging.h"
 #include "base/memory/scoped_vector.h"
@@ -35,6 +38,20 @@ class ListModel {
     AddAt(item_count(), item);
   }
 
+  // Adds |items| to the model starting at |index|, in order. Observers are
+  // notified once for the whole range.
+  void AddItemsAt(size_t index, ScopedVector<ItemType> items) {
+    DCHECK_LE(index, item_count());
+    size_t count = items.size();
+    if (!count)
+      return;
+    std::vector<ItemType*> to_be_added;
+    items.release(&to_be_added);
+    items_->insert(items_.begin() + index,
+                   to_be_added.begin(), to_be_added.end());
+    NotifyItemsAdded(index, count);
+  }
+
   // Removes an item at given |index| from the model. Note the removed item
   // is NOT deleted and it's up to the caller to delete it.
   ItemType* RemoveAt(size_t index) {
@@ -45,6 +62,18 @@ class ListModel {
     return item;
   }
 
+  // Removes the |count| items starting at |start| from the model and returns
+  // them. Observers are notified once for the whole range.
+  ScopedVector<ItemType> RemoveItemsAt(size_t start, size_t count) {
+    DCHECK_LE(start + count, item_count());
+    ScopedVector<ItemType> removed;
+    removed->assign(items_.begin() + start, items_.begin() + start + count);
+    items_->erase(items_.begin() + start, items_.begin() + start + count);
+    if (count)
+      NotifyItemsRemoved(start, count);
+    return removed.Pass();
+  }
+
   // Removes all items from the model. This does NOT delete the items.
   void RemoveAll() {
     size_t count = item_count();
@@ -57,6 +86,32 @@ class ListModel {
     delete RemoveAt(index);
   }
 
+  // Removes and deletes the |count| items starting at |start|.
+  void DeleteItemsAt(size_t start, size_t count) {
+    RemoveItemsAt(start, count);
+  }
+
+  // Moves the |count| items starting at |start| so that they start at
+  // |target|, where |target| is an index in the list once the items are
+  // taken out of it. Observers are notified once with ListItemsMoved.
+  void MoveItems(size_t start, size_t count, size_t target) {
+    DCHECK_LE(start + count, item_count());
+    DCHECK_LE(target + count, item_count());
+    if (!count || start == target)
+      return;
+    typename std::vector<ItemType*>::iterator begin = items_.begin();
+    if (target < start)
+      std::rotate(begin + target, begin + start, begin + start + count);
+    else
+      std::rotate(begin + start, begin + start + count, begin + target + count);
+    NotifyItemsMoved(start, count, target);
+  }
+
+  // Moves the item at |index| to |target|.
+  void Move(size_t index, size_t target) {
+    MoveItems(index, 1, target);
+  }
+
   // Removes and deletes all items from the model.
   void DeleteAll() {
     ScopedVector<ItemType> to_be_deleted(items_.Pass());
@@ -83,6 +138,12 @@ class ListModel {
                       ListItemsRemoved(start, count));
   }
 
+  void NotifyItemsMoved(size_t start, size_t count, size_t target) {
+    FOR_EACH_OBSERVER(ListModelObserver,
+                      observers_,
+                      ListItemsMoved(start, count, target));
+  }
+
   void NotifyItemsChanged(size_t start, size_t count) {
     FOR_EACH_OBSERVER(ListModelObserver,
                       observers_,
@@ -21,6 +21,11 @@ class UI_EXPORT ListModelObserver {
   // removal.
   virtual void ListItemsRemoved(size_t start, size_t count) = 0;
 
+  // Invoked after the |count| items at |start| have been moved so that they
+  // now start at |target|. The items between the two positions shift to make
+  // room for them.
+  virtual void ListItemsMoved(size_t start, size_t count, size_t target) = 0;
+
   // Invoked after items has been changed.
   virtual void ListItemsChanged(size_t start, size_t count) = 0;
 
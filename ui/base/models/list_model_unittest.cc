@@ -28,6 +28,7 @@ class ListModelTest : public testing::Test,
   ListModelTest()
       : added_count_(0),
         removed_count_(0),
+        moved_count_(0),
         changed_count_(0) {
   }
 
@@ -40,9 +41,11 @@ class ListModelTest : public testing::Test,
   }
 
   void ClearCounts() {
-    added_count_ = removed_count_ = changed_count_ = 0;
+    added_count_ = removed_count_ = moved_count_ = changed_count_ = 0;
   }
 
+  size_t moved_count() const { return moved_count_; }
+
   // ListModelObserver implementation:
   virtual void ListItemsAdded(size_t start, size_t count) OVERRIDE {
     added_count_ += count;
@@ -50,6 +53,11 @@ class ListModelTest : public testing::Test,
   virtual void ListItemsRemoved(size_t start, size_t count) OVERRIDE {
     removed_count_ += count;
   }
+  virtual void ListItemsMoved(size_t start,
+                              size_t count,
+                              size_t target) OVERRIDE {
+    ++moved_count_;
+  }
   virtual void ListItemsChanged(size_t start, size_t count) OVERRIDE {
     changed_count_ += count;
   }
@@ -57,6 +65,7 @@ class ListModelTest : public testing::Test,
  private:
   size_t added_count_;
   size_t removed_count_;
+  size_t moved_count_;
   size_t changed_count_;
 
   DISALLOW_COPY_AND_ASSIGN(ListModelTest);
@@ -129,6 +138,72 @@ TEST_F(ListModelTest, RemoveAll) {
   ExpectCountsEqual(0, 3, 0);
 }
 
+TEST_F(ListModelTest, AddAndRemoveRange) {
+  ListModel<FooItem> model;
+  model.AddObserver(this);
+
+  model.Add(new FooItem(0));
+  model.Add(new FooItem(1));
+  ClearCounts();
+
+  ScopedVector<FooItem> items;
+  for (int i = 2; i < 5; ++i)
+    items.push_back(new FooItem(i));
+  model.AddItemsAt(1, items.Pass());
+  ExpectCountsEqual(3, 0, 0);
+
+  // 0 2 3 4 1
+  ASSERT_EQ(5U, model.item_count());
+  EXPECT_EQ(0, model.GetItemAt(0)->id());
+  EXPECT_EQ(2, model.GetItemAt(1)->id());
+  EXPECT_EQ(4, model.GetItemAt(3)->id());
+  EXPECT_EQ(1, model.GetItemAt(4)->id());
+
+  ScopedVector<FooItem> removed(model.RemoveItemsAt(2, 2));
+  ExpectCountsEqual(3, 2, 0);
+  ASSERT_EQ(2U, removed.size());
+  EXPECT_EQ(3, removed[0]->id());
+  EXPECT_EQ(4, removed[1]->id());
+
+  model.DeleteItemsAt(0, 2);
+  ExpectCountsEqual(3, 4, 0);
+  ASSERT_EQ(1U, model.item_count());
+  EXPECT_EQ(1, model.GetItemAt(0)->id());
+}
+
+TEST_F(ListModelTest, Move) {
+  ListModel<FooItem> model;
+  model.AddObserver(this);
+
+  for (int i = 0; i < 6; ++i)
+    model.Add(new FooItem(i));
+  ClearCounts();
+
+  // Move forward: 0 1 2 3 4 5 -> 0 3 4 1 2 5
+  model.MoveItems(1, 2, 3);
+  EXPECT_EQ(1U, moved_count());
+  const int kForward[] = { 0, 3, 4, 1, 2, 5 };
+  for (size_t i = 0; i < arraysize(kForward); ++i)
+    EXPECT_EQ(kForward[i], model.GetItemAt(i)->id());
+
+  // Move backward: 0 3 4 1 2 5 -> 0 1 2 5 3 4
+  model.MoveItems(3, 3, 1);
+  EXPECT_EQ(2U, moved_count());
+  const int kBackward[] = { 0, 1, 2, 5, 3, 4 };
+  for (size_t i = 0; i < arraysize(kBackward); ++i)
+    EXPECT_EQ(kBackward[i], model.GetItemAt(i)->id());
+
+  model.Move(3, 5);
+  EXPECT_EQ(3U, moved_count());
+  EXPECT_EQ(3, model.GetItemAt(3)->id());
+  EXPECT_EQ(5, model.GetItemAt(5)->id());
+
+  // Moving to where the items already are is not a change.
+  model.Move(2, 2);
+  EXPECT_EQ(3U, moved_count());
+  ExpectCountsEqual(0, 0, 0);
+}
+
 TEST_F(ListModelTest, FakeUpdate) {
   ListModel<FooItem> model;
   model.AddObserver(this);
@@ -0,0 +1,259 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/base/models/table_model_sorter.h"
+
+#include <algorithm>
+#include <string>
+
+#include "base/bind.h"
+#include "base/i18n/string_search.h"
+#include "base/lazy_instance.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/cancellation_flag.h"
+#include "base/sys_info.h"
+#include "base/threading/sequenced_worker_pool.h"
+#include "ui/base/models/table_model.h"
+#include "unicode/coll.h"
+
+namespace ui {
+
+namespace {
+
+// Tables with fewer rows than this per core are sorted in fewer parts, since
+// a part costs a task.
+const size_t kMinRowsPerPart = 4096;
+
+// The workers that sort the parts of the tables, one per core.
+class SortWorkerPool {
+ public:
+  SortWorkerPool()
+      : pool_(new base::SequencedWorkerPool(
+            base::SysInfo::NumberOfProcessors(), "TableSortWorker")),
+        task_runner_(pool_->GetTaskRunnerWithShutdownBehavior(
+            base::SequencedWorkerPool::CONTINUE_ON_SHUTDOWN)) {
+  }
+
+  base::TaskRunner* task_runner() { return task_runner_.get(); }
+
+ private:
+  scoped_refptr<base::SequencedWorkerPool> pool_;
+  scoped_refptr<base::TaskRunner> task_runner_;
+
+  DISALLOW_COPY_AND_ASSIGN(SortWorkerPool);
+};
+
+base::LazyInstance<SortWorkerPool>::Leaky g_sort_worker_pool =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+// The state of one sort, shared by its tasks. The parts are sorted on
+// workers in parallel, each into its own slot, then merged by one worker
+// once the UI thread has seen them all done.
+class TableModelSorter::SortJob : public base::RefCountedThreadSafe<SortJob> {
+ public:
+  SortJob(std::vector<string16>* texts,
+          bool ascending,
+          const string16& filter,
+          const SortedCallback& callback)
+      : locale_(icu::Locale::getDefault()),
+        ascending_(ascending),
+        filter_(filter),
+        callback_(callback) {
+    texts_.swap(*texts);
+    size_t part_count = std::min<size_t>(
+        base::SysInfo::NumberOfProcessors(),
+        texts_.size() / kMinRowsPerPart);
+    parts_.resize(std::max<size_t>(part_count, 1));
+  }
+
+  size_t part_count() const { return parts_.size(); }
+  const std::vector<int>& rows() const { return rows_; }
+  const SortedCallback& callback() const { return callback_; }
+
+  void Cancel() { cancelled_.Set(); }
+
+  // Filters and sorts the rows of |part|. Run on a worker.
+  void SortPart(size_t part) {
+    if (cancelled_.IsSet())
+      return;
+
+    UErrorCode status = U_ZERO_ERROR;
+    scoped_ptr<icu::Collator> collator(
+        icu::Collator::createInstance(locale_, status));
+    if (!U_SUCCESS(status))
+      collator.reset();
+    DCHECK(collator.get());
+
+    scoped_ptr<base::i18n::FixedPatternStringSearchIgnoringCaseAndAccents>
+        search;
+    if (!filter_.empty()) {
+      search.reset(
+          new base::i18n::FixedPatternStringSearchIgnoringCaseAndAccents(
+              filter_));
+    }
+
+    size_t begin = texts_.size() * part / parts_.size();
+    size_t end = texts_.size() * (part + 1) / parts_.size();
+    std::vector<Entry>& entries = parts_[part];
+    entries.reserve(end - begin);
+    std::vector<uint8_t> buffer(256);
+    for (size_t row = begin; row < end; ++row) {
+      const string16& text = texts_[row];
+      if (search.get() && !search->Search(text))
+        continue;
+      entries.push_back(Entry());
+      Entry& entry = entries.back();
+      entry.row = static_cast<int>(row);
+      if (collator.get()) {
+        entry.key = GetSortKey(collator.get(), text, &buffer);
+      } else {
+        entry.key.assign(reinterpret_cast<const char*>(text.data()),
+                         text.size() * sizeof(char16));
+      }
+    }
+    std::sort(entries.begin(), entries.end(), EntryLess(ascending_));
+  }
+
+  // Merges the sorted parts into |rows_|. Run on a worker.
+  void Merge() {
+    if (cancelled_.IsSet())
+      return;
+
+    EntryLess less(ascending_);
+    while (parts_.size() > 1) {
+      std::vector<std::vector<Entry> > merged((parts_.size() + 1) / 2);
+      for (size_t i = 0; i + 1 < parts_.size(); i += 2) {
+        std::vector<Entry>& out = merged[i / 2];
+        out.resize(parts_[i].size() + parts_[i + 1].size());
+        std::merge(parts_[i].begin(), parts_[i].end(),
+                   parts_[i + 1].begin(), parts_[i + 1].end(),
+                   out.begin(), less);
+      }
+      if (parts_.size() % 2)
+        merged.back().swap(parts_.back());
+      parts_.swap(merged);
+    }
+
+    const std::vector<Entry>& entries = parts_[0];
+    rows_.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+      rows_[i] = entries[i].row;
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<SortJob>;
+
+  // A row and the collation key of its text.
+  struct Entry {
+    std::string key;
+    int row;
+  };
+
+  // Orders the entries by key, in the requested direction. Rows with equal
+  // keys stay in model order.
+  class EntryLess {
+   public:
+    explicit EntryLess(bool ascending) : ascending_(ascending) {}
+
+    bool operator()(const Entry& a, const Entry& b) const {
+      int result = a.key.compare(b.key);
+      if (result == 0)
+        return a.row < b.row;
+      return ascending_ ? result < 0 : result > 0;
+    }
+
+   private:
+    bool ascending_;
+  };
+
+  ~SortJob() {}
+
+  static std::string GetSortKey(icu::Collator* collator,
+                                const string16& text,
+                                std::vector<uint8_t>* buffer) {
+    const UChar* chars = static_cast<const UChar*>(text.c_str());
+    int32_t length = static_cast<int32_t>(text.length());
+    int32_t key_length = collator->getSortKey(
+        chars, length, &(*buffer)[0], static_cast<int32_t>(buffer->size()));
+    if (key_length > static_cast<int32_t>(buffer->size())) {
+      buffer->resize(key_length);
+      key_length = collator->getSortKey(chars, length, &(*buffer)[0],
+                                        key_length);
+    }
+    return std::string(reinterpret_cast<const char*>(&(*buffer)[0]),
+                       key_length);
+  }
+
+  std::vector<string16> texts_;
+  icu::Locale locale_;
+  const bool ascending_;
+  const string16 filter_;
+  SortedCallback callback_;
+  base::CancellationFlag cancelled_;
+
+  std::vector<std::vector<Entry> > parts_;
+  std::vector<int> rows_;
+
+  DISALLOW_COPY_AND_ASSIGN(SortJob);
+};
+
+TableModelSorter::TableModelSorter(TableModel* model)
+    : model_(model),
+      pending_parts_(0) {
+}
+
+TableModelSorter::~TableModelSorter() {
+  Cancel();
+}
+
+void TableModelSorter::Sort(int column_id,
+                            bool ascending,
+                            const string16& filter,
+                            const SortedCallback& callback) {
+  Cancel();
+
+  // The text is copied here, since the model is only used on the UI thread.
+  std::vector<string16> texts(model_->RowCount());
+  for (size_t row = 0; row < texts.size(); ++row)
+    texts[row] = model_->GetText(static_cast<int>(row), column_id);
+
+  job_ = new SortJob(&texts, ascending, filter, callback);
+  pending_parts_ = static_cast<int>(job_->part_count());
+  for (size_t part = 0; part < job_->part_count(); ++part) {
+    g_sort_worker_pool.Get().task_runner()->PostTaskAndReply(
+        FROM_HERE,
+        base::Bind(&SortJob::SortPart, job_, part),
+        base::Bind(&TableModelSorter::OnPartSorted, AsWeakPtr(), job_));
+  }
+}
+
+void TableModelSorter::Cancel() {
+  if (!job_.get())
+    return;
+  job_->Cancel();
+  job_ = NULL;
+  pending_parts_ = 0;
+}
+
+void TableModelSorter::OnPartSorted(scoped_refptr<SortJob> job) {
+  if (job.get() != job_.get() || --pending_parts_ > 0)
+    return;
+  g_sort_worker_pool.Get().task_runner()->PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&SortJob::Merge, job),
+      base::Bind(&TableModelSorter::OnMerged, AsWeakPtr(), job));
+}
+
+void TableModelSorter::OnMerged(scoped_refptr<SortJob> job) {
+  if (job.get() != job_.get())
+    return;
+  job_ = NULL;
+  job->callback().Run(job->rows());
+}
+
+}  // namespace ui
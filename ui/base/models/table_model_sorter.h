@@ -0,0 +1,79 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_BASE_MODELS_TABLE_MODEL_SORTER_H_
+#define UI_BASE_MODELS_TABLE_MODEL_SORTER_H_
+#pragma once
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/string16.h"
+#include "ui/base/ui_export.h"
+
+namespace ui {
+
+class TableModel;
+
+// TableModelSorter sorts and filters the rows of a TableModel by the text of
+// a column without blocking the UI thread. The text of the column is copied
+// from the model on the UI thread. Then workers compute the ICU collation key
+// of each row once, and sort parts of the rows in parallel. The parts are
+// merged, and the result is handed back to the UI thread in one go. Starting
+// a sort cancels the one in progress, whose result is never delivered.
+//
+// Rows are ordered as TableModel::CompareValues() orders them by default,
+// with a locale specific string comparison. Models that override it to compare
+// other values need to sort themselves.
+class UI_EXPORT TableModelSorter
+    : public base::SupportsWeakPtr<TableModelSorter> {
+ public:
+  // Run on the UI thread with the rows of the model that matched the filter,
+  // in sorted order.
+  typedef base::Callback<void(const std::vector<int>&)> SortedCallback;
+
+  explicit TableModelSorter(TableModel* model);
+  ~TableModelSorter();
+
+  // Sorts the rows by the text of the column |column_id|. Only the rows whose
+  // text contains |filter|, ignoring case and accents, are kept; an empty
+  // |filter| keeps all of them. |callback| is run once the sort is done,
+  // unless it is cancelled first.
+  void Sort(int column_id,
+            bool ascending,
+            const string16& filter,
+            const SortedCallback& callback);
+
+  // Cancels the sort in progress, if any.
+  void Cancel();
+
+  // Whether a sort is in progress.
+  bool is_sorting() const { return job_.get() != NULL; }
+
+ private:
+  class SortJob;
+
+  // Called on the UI thread when a part of |job| is sorted.
+  void OnPartSorted(scoped_refptr<SortJob> job);
+
+  // Called on the UI thread when the parts of |job| are merged.
+  void OnMerged(scoped_refptr<SortJob> job);
+
+  TableModel* model_;
+
+  // The sort in progress.
+  scoped_refptr<SortJob> job_;
+
+  // The number of parts of |job_| still being sorted.
+  int pending_parts_;
+
+  DISALLOW_COPY_AND_ASSIGN(TableModelSorter);
+};
+
+}  // namespace ui
+
+#endif  // UI_BASE_MODELS_TABLE_MODEL_SORTER_H_
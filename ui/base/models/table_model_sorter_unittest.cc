@@ -0,0 +1,113 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/base/models/table_model_sorter.h"
+
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/compiler_specific.h"
+#include "base/message_loop.h"
+#include "base/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/base/models/table_model.h"
+
+namespace ui {
+
+namespace {
+
+// A table model with one column, backed by a vector of strings.
+class StringTableModel : public TableModel {
+ public:
+  StringTableModel(const char* const* texts, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+      texts_.push_back(ASCIIToUTF16(texts[i]));
+  }
+
+  // TableModel:
+  virtual int RowCount() OVERRIDE { return static_cast<int>(texts_.size()); }
+  virtual string16 GetText(int row, int column_id) OVERRIDE {
+    return texts_[row];
+  }
+  virtual void SetObserver(TableModelObserver* observer) OVERRIDE {}
+
+ private:
+  std::vector<string16> texts_;
+
+  DISALLOW_COPY_AND_ASSIGN(StringTableModel);
+};
+
+const char* const kTexts[] = { "pear", "Apple", "banana", "apple pie", "fig" };
+
+}  // namespace
+
+class TableModelSorterTest : public testing::Test {
+ public:
+  TableModelSorterTest()
+      : model_(kTexts, arraysize(kTexts)),
+        sorter_(&model_),
+        sorted_count_(0) {
+  }
+
+  // Sorts and waits for the result.
+  void SortAndWait(bool ascending, const std::string& filter) {
+    sorter_.Sort(0, ascending, ASCIIToUTF16(filter),
+                 base::Bind(&TableModelSorterTest::OnSorted,
+                            base::Unretained(this), true));
+    message_loop_.Run();
+  }
+
+  void OnSorted(bool quit, const std::vector<int>& rows) {
+    sorted_count_++;
+    rows_ = rows;
+    if (quit)
+      MessageLoop::current()->Quit();
+  }
+
+ protected:
+  MessageLoopForUI message_loop_;
+  StringTableModel model_;
+  TableModelSorter sorter_;
+  int sorted_count_;
+  std::vector<int> rows_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TableModelSorterTest);
+};
+
+TEST_F(TableModelSorterTest, SortsByCollation) {
+  SortAndWait(true, std::string());
+  ASSERT_EQ(5u, rows_.size());
+  EXPECT_EQ(1, rows_[0]);  // Apple
+  EXPECT_EQ(3, rows_[1]);  // apple pie
+  EXPECT_EQ(2, rows_[2]);  // banana
+  EXPECT_EQ(4, rows_[3]);  // fig
+  EXPECT_EQ(0, rows_[4]);  // pear
+  EXPECT_FALSE(sorter_.is_sorting());
+
+  SortAndWait(false, std::string());
+  ASSERT_EQ(5u, rows_.size());
+  EXPECT_EQ(0, rows_[0]);
+  EXPECT_EQ(1, rows_[4]);
+}
+
+TEST_F(TableModelSorterTest, Filters) {
+  SortAndWait(true, "APPLE");
+  ASSERT_EQ(2u, rows_.size());
+  EXPECT_EQ(1, rows_[0]);
+  EXPECT_EQ(3, rows_[1]);
+}
+
+// Starting a sort cancels the one in progress, whose result is dropped.
+TEST_F(TableModelSorterTest, NewSortCancelsOld) {
+  sorter_.Sort(0, true, string16(),
+               base::Bind(&TableModelSorterTest::OnSorted,
+                          base::Unretained(this), false));
+  SortAndWait(true, "fig");
+  message_loop_.RunAllPending();
+  EXPECT_EQ(1, sorted_count_);
+  ASSERT_EQ(1u, rows_.size());
+  EXPECT_EQ(4, rows_[0]);
+}
+
+}  // namespace ui
@@ -64,10 +64,10 @@ namespace ui {
 template <class NodeType>
 class TreeNode : public TreeModelNode {
  public:
-  TreeNode() : parent_(NULL) {}
+  TreeNode() : parent_(NULL), index_in_parent_(-1) {}
 
   explicit TreeNode(const string16& title)
-      : title_(title), parent_(NULL) {}
+      : title_(title), parent_(NULL), index_in_parent_(-1) {}
 
   virtual ~TreeNode() {}
 
@@ -82,23 +82,62 @@ class TreeNode : public TreeModelNode {
       parent->Remove(node);
     node->parent_ = static_cast<NodeType*>(this);
     children_->insert(children_->begin() + index, node);
+    UpdateChildIndices(index);
   }
 
   // Removes |node| from this node and returns it. It's up to the caller to
   // delete it.
   virtual NodeType* Remove(NodeType* node) {
-    typename std::vector<NodeType*>::iterator i =
-        std::find(children_->begin(), children_->end(), node);
-    DCHECK(i != children_->end());
+    DCHECK(node);
+    DCHECK_EQ(this, node->parent_);
+    int index = node->index_in_parent_;
     node->parent_ = NULL;
-    children_->erase(i);
+    node->index_in_parent_ = -1;
+    children_->erase(children_->begin() + index);
+    UpdateChildIndices(index);
     return node;
   }
 
+  // Adds |nodes| as children of this node, in order, starting at |index|.
+  // None of |nodes| may have a parent. Cheaper than adding the nodes one by
+  // one, as the children after |index| are shifted once.
+  virtual void AddChildren(ScopedVector<NodeType> nodes, int index) {
+    DCHECK_GE(index, 0);
+    DCHECK_LE(index, child_count());
+    std::vector<NodeType*> added;
+    nodes.release(&added);
+    for (size_t i = 0; i < added.size(); ++i) {
+      DCHECK(added[i] && !added[i]->parent_);
+      added[i]->parent_ = static_cast<NodeType*>(this);
+    }
+    children_->insert(children_->begin() + index, added.begin(), added.end());
+    UpdateChildIndices(index);
+  }
+
+  // Removes the |count| children starting at |start| and returns them.
+  virtual ScopedVector<NodeType> RemoveChildren(int start, int count) {
+    DCHECK_GE(start, 0);
+    DCHECK_GE(count, 0);
+    DCHECK_LE(start + count, child_count());
+    ScopedVector<NodeType> removed;
+    removed->assign(children_->begin() + start,
+                    children_->begin() + start + count);
+    for (size_t i = 0; i < removed.size(); ++i) {
+      removed[i]->parent_ = NULL;
+      removed[i]->index_in_parent_ = -1;
+    }
+    children_->erase(children_->begin() + start,
+                     children_->begin() + start + count);
+    UpdateChildIndices(start);
+    return removed.Pass();
+  }
+
   // Removes all the children from this node. This does NOT delete the nodes.
   void RemoveAll() {
-    for (size_t i = 0; i < children_->size(); ++i)
+    for (size_t i = 0; i < children_->size(); ++i) {
       children_[i]->parent_ = NULL;
+      children_[i]->index_in_parent_ = -1;
+    }
     children_->clear();
   }
 
@@ -138,10 +177,7 @@ class TreeNode : public TreeModelNode {
   // Returns the index of |node|, or -1 if |node| is not a child of this.
   int GetIndexOf(const NodeType* node) const {
     DCHECK(node);
-    typename std::vector<NodeType*>::const_iterator i =
-        std::find(children_->begin(), children_->end(), node);
-    return
-        i != children_->end() ? static_cast<int>(i - children_->begin()) : -1;
+    return node->parent_ == this ? node->index_in_parent_ : -1;
   }
 
   // Sets the title of the node.
@@ -161,15 +197,25 @@ class TreeNode : public TreeModelNode {
   }
 
  protected:
-  std::vector<NodeType*>& children() { return children_.get(); }
+  const std::vector<NodeType*>& children() const { return children_.get(); }
 
  private:
+  // Refreshes the index of the children from |start| on.
+  void UpdateChildIndices(int start) {
+    for (size_t i = start; i < children_->size(); ++i)
+      children_[i]->index_in_parent_ = static_cast<int>(i);
+  }
+
   // Title displayed in the tree.
   string16 title_;
 
   // This node's parent.
   NodeType* parent_;
 
+  // Index of this node in the children of |parent_|, or -1 if it has no
+  // parent. Kept up to date by the parent, so that GetIndexOf() is O(1).
+  int index_in_parent_;
+
   // This node's children.
   ScopedVector<NodeType> children_;
 
@@ -226,6 +272,37 @@ class TreeNodeModel : public TreeModel {
     return delete_node;
   }
 
+  // Adds |nodes| to |parent| starting at |index|, with one notification.
+  void AddChildren(NodeType* parent, ScopedVector<NodeType> nodes, int index) {
+    DCHECK(parent);
+    int count = static_cast<int>(nodes.size());
+    if (!count)
+      return;
+    parent->AddChildren(nodes.Pass(), index);
+    NotifyObserverTreeNodesAdded(parent, index, count);
+  }
+
+  // Removes the |count| children of |parent| starting at |start|, with one
+  // notification, and returns them.
+  ScopedVector<NodeType> RemoveChildren(NodeType* parent, int start,
+                                        int count) {
+    DCHECK(parent);
+    ScopedVector<NodeType> removed(parent->RemoveChildren(start, count));
+    if (count)
+      NotifyObserverTreeNodesRemoved(parent, start, count);
+    return removed.Pass();
+  }
+
+  // Moves the |count| children of |parent| starting at |start| so that they
+  // start at |target|, an index among the children once the moved ones are
+  // taken out. Observers see the move as one removal and one addition.
+  void MoveChildren(NodeType* parent, int start, int count, int target) {
+    DCHECK(parent);
+    if (!count || start == target)
+      return;
+    AddChildren(parent, RemoveChildren(parent, start, count), target);
+  }
+
   void NotifyObserverTreeNodesAdded(NodeType* parent, int start, int count) {
     FOR_EACH_OBSERVER(TreeModelObserver,
                       observer_list_,
@@ -309,6 +309,53 @@ TEST_F(TreeNodeModelTest, BasicOperations) {
   EXPECT_EQ(0, root.child_count());
 }
 
+// Verifies that ranges of children are added, removed and moved with one
+// notification each, and that the indices of the children stay right.
+TEST_F(TreeNodeModelTest, RangeOperations) {
+  TestNode* root = new TestNode;
+  TreeNodeModel<TestNode> model(root);
+  model.AddObserver(this);
+
+  ScopedVector<TestNode> nodes;
+  for (int i = 0; i < 5; ++i)
+    nodes.push_back(new TestNode(i));
+  model.AddChildren(root, nodes.Pass(), 0);
+  EXPECT_EQ("added=1 removed=0 changed=0", GetObserverCountStateAndClear());
+  ASSERT_EQ(5, root->child_count());
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(i, root->GetChild(i)->value);
+    EXPECT_EQ(i, root->GetIndexOf(root->GetChild(i)));
+  }
+
+  // Inserting in the middle shifts the indices of the later children.
+  TestNode* middle = new TestNode(5);
+  model.Add(root, middle, 2);
+  EXPECT_EQ(2, root->GetIndexOf(middle));
+  EXPECT_EQ(2, root->GetChild(3)->value);
+  EXPECT_EQ(3, root->GetIndexOf(root->GetChild(3)));
+  GetObserverCountStateAndClear();
+
+  // 0 1 5 2 3 4 -> 0 3 4 1 5 2
+  model.MoveChildren(root, 1, 3, 3);
+  EXPECT_EQ("added=1 removed=1 changed=0", GetObserverCountStateAndClear());
+  const int kMoved[] = { 0, 3, 4, 1, 5, 2 };
+  ASSERT_EQ(static_cast<int>(arraysize(kMoved)), root->child_count());
+  for (size_t i = 0; i < arraysize(kMoved); ++i) {
+    EXPECT_EQ(kMoved[i], root->GetChild(i)->value);
+    EXPECT_EQ(static_cast<int>(i), root->GetIndexOf(root->GetChild(i)));
+  }
+
+  ScopedVector<TestNode> removed(model.RemoveChildren(root, 1, 4));
+  EXPECT_EQ("added=0 removed=1 changed=0", GetObserverCountStateAndClear());
+  ASSERT_EQ(4u, removed.size());
+  EXPECT_EQ(3, removed[0]->value);
+  EXPECT_EQ(NULL, removed[0]->parent());
+  EXPECT_EQ(-1, root->GetIndexOf(removed[0]));
+  ASSERT_EQ(2, root->child_count());
+  EXPECT_EQ(2, root->GetChild(1)->value);
+  EXPECT_EQ(1, root->GetIndexOf(root->GetChild(1)));
+}
+
 TEST_F(TreeNodeModelTest, IsRoot) {
   TestNode root;
   EXPECT_TRUE(root.is_root());
@@ -13,9 +13,14 @@ unsigned int NativeTheme::track_color_ = 0xd3d3d3;
 void NativeTheme::SetScrollbarColors(unsigned inactive_color,
                                      unsigned active_color,
                                      unsigned track_color) const {
+  if (thumb_inactive_color_ == inactive_color &&
+      thumb_active_color_ == active_color &&
+      track_color_ == track_color)
+    return;
   thumb_inactive_color_ = inactive_color;
   thumb_active_color_ = active_color;
   track_color_ = track_color;
+  ColorsChanged();
 }
 
 // NativeTheme::instance() is implemented in the platform specific source files,
@@ -262,6 +262,10 @@ class UI_EXPORT NativeTheme {
   NativeTheme() {}
   virtual ~NativeTheme() {}
 
+  // Invoked when the colors the parts are painted with change, so that themes
+  // that keep painted parts around can drop them.
+  virtual void ColorsChanged() const {}
+
   static unsigned int thumb_inactive_color_;
   static unsigned int thumb_active_color_;
   static unsigned int track_color_;
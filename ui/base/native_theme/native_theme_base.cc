@@ -6,6 +6,7 @@
 
 #include <limits>
 
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/logging.h"
 #include "grit/ui_resources_standard.h"
@@ -41,6 +42,11 @@ const SkColor kMenuPopupBackgroundColor = SkColorSetRGB(210, 225, 246);
 const unsigned int kDefaultScrollbarWidth = 15;
 const unsigned int kDefaultScrollbarButtonLength = 14;
 
+// How many painted parts are kept, and the size in device pixels above which
+// parts are painted every time instead.
+const size_t kPartCacheSize = 32;
+const int kMaxCachedPartPixels = 256 * 256;
+
 const SkColor kCheckboxTinyColor = SK_ColorGRAY;
 const SkColor kCheckboxShadowColor = SkColorSetARGB(0x15, 0, 0, 0);
 const SkColor kCheckboxShadowHoveredColor = SkColorSetARGB(0x1F, 0, 0, 0);
@@ -156,6 +162,76 @@ void NativeThemeBase::Paint(SkCanvas* canvas,
                             State state,
                             const gfx::Rect& rect,
                             const ExtraParams& extra) const {
+  if (!PaintCachedPart(canvas, part, state, rect, extra))
+    PaintPart(canvas, part, state, rect, extra);
+}
+
+NativeThemeBase::NativeThemeBase()
+    : scrollbar_width_(kDefaultScrollbarWidth),
+      scrollbar_button_length_(kDefaultScrollbarButtonLength),
+      part_cache_(kPartCacheSize),
+      part_cache_generation_(0),
+      ALLOW_THIS_IN_INITIALIZER_LIST(color_change_listener_(this)) {
+  memory_pressure_listener_.reset(new base::MemoryPressureListener(
+      base::Bind(&NativeThemeBase::OnMemoryPressure, base::Unretained(this))));
+}
+
+NativeThemeBase::~NativeThemeBase() {
+}
+
+void NativeThemeBase::ColorsChanged() const {
+  ClearPartCache();
+}
+
+void NativeThemeBase::OnSysColorChange() {
+  ClearPartCache();
+}
+
+void NativeThemeBase::ClearPartCache() const {
+  base::AutoLock lock(part_cache_lock_);
+  part_cache_.Clear();
+  ++part_cache_generation_;
+}
+
+void NativeThemeBase::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  base::AutoLock lock(part_cache_lock_);
+  part_cache_.ShrinkToSize(
+      base::MemoryPressureListener::GetTrimmedBudget(kPartCacheSize, level));
+}
+
+NativeThemeBase::PartKey::PartKey()
+    : part(kCheckbox),
+      state(kDisabled),
+      width(0),
+      height(0),
+      scale(0) {
+  memset(extra, 0, sizeof(extra));
+}
+
+bool NativeThemeBase::PartKey::operator<(const PartKey& other) const {
+  if (part != other.part)
+    return part < other.part;
+  if (state != other.state)
+    return state < other.state;
+  if (width != other.width)
+    return width < other.width;
+  if (height != other.height)
+    return height < other.height;
+  if (scale != other.scale)
+    return scale < other.scale;
+  for (size_t i = 0; i < arraysize(extra); ++i) {
+    if (extra[i] != other.extra[i])
+      return extra[i] < other.extra[i];
+  }
+  return false;
+}
+
+void NativeThemeBase::PaintPart(SkCanvas* canvas,
+                                Part part,
+                                State state,
+                                const gfx::Rect& rect,
+                                const ExtraParams& extra) const {
   switch (part) {
     // Please keep these in the order of NativeTheme::Part.
     case kCheckbox:
@@ -232,12 +308,104 @@ void NativeThemeBase::Paint(SkCanvas* canvas,
   }
 }
 
-NativeThemeBase::NativeThemeBase()
-    : scrollbar_width_(kDefaultScrollbarWidth),
-      scrollbar_button_length_(kDefaultScrollbarButtonLength) {
-}
+bool NativeThemeBase::PaintCachedPart(SkCanvas* canvas,
+                                      Part part,
+                                      State state,
+                                      const gfx::Rect& rect,
+                                      const ExtraParams& extra) const {
+  PartKey key;
+  key.part = part;
+  key.state = state;
+  key.width = rect.width();
+  key.height = rect.height();
+  switch (part) {
+    case kCheckbox:
+    case kPushButton:
+    case kRadio:
+      key.extra[0] = extra.button.checked;
+      key.extra[1] = extra.button.indeterminate;
+      key.extra[2] = extra.button.is_focused;
+      key.extra[3] = extra.button.has_border;
+      key.extra[4] = static_cast<int>(extra.button.background_color);
+      break;
+    case kScrollbarDownArrow:
+    case kScrollbarUpArrow:
+    case kScrollbarLeftArrow:
+    case kScrollbarRightArrow:
+    case kScrollbarHorizontalThumb:
+    case kScrollbarVerticalThumb:
+      break;
+    case kScrollbarHorizontalTrack:
+    case kScrollbarVerticalTrack:
+      // The ends of the track are painted differently from its middle.
+      key.extra[0] = extra.scrollbar_track.is_upper;
+      key.extra[1] = extra.scrollbar_track.track_x - rect.x();
+      key.extra[2] = extra.scrollbar_track.track_y - rect.y();
+      key.extra[3] = extra.scrollbar_track.track_width;
+      key.extra[4] = extra.scrollbar_track.track_height;
+      break;
+    case kSliderTrack:
+    case kSliderThumb:
+      key.extra[0] = extra.slider.vertical;
+      key.extra[1] = extra.slider.in_drag;
+      break;
+    default:
+      return false;
+  }
 
-NativeThemeBase::~NativeThemeBase() {
+  // A bitmap only looks like the painted part when it is drawn unscaled, at
+  // whole pixels, so the transform may only scale uniformly and the part must
+  // land on the pixel grid.
+  const SkMatrix& matrix = canvas->getTotalMatrix();
+  if (matrix.getType() & ~(SkMatrix::kScale_Mask | SkMatrix::kTranslate_Mask))
+    return false;
+  key.scale = matrix.getScaleX();
+  if (key.scale <= 0 || matrix.getScaleY() != key.scale)
+    return false;
+  SkRect device_rect;
+  matrix.mapRect(&device_rect, gfx::RectToSkRect(rect));
+  SkIRect device_irect;
+  device_rect.round(&device_irect);
+  SkRect aligned_rect;
+  aligned_rect.set(device_irect);
+  if (device_irect.isEmpty() || aligned_rect != device_rect ||
+      device_irect.width() * device_irect.height() > kMaxCachedPartPixels)
+    return false;
+
+  SkBitmap bitmap;
+  int generation;
+  {
+    base::AutoLock lock(part_cache_lock_);
+    PartCache::iterator it = part_cache_.Get(key);
+    if (it != part_cache_.end())
+      bitmap = it->second;
+    generation = part_cache_generation_;
+  }
+
+  if (bitmap.isNull()) {
+    bitmap.setConfig(SkBitmap::kARGB_8888_Config,
+                     device_irect.width(), device_irect.height());
+    if (!bitmap.allocPixels())
+      return false;
+    bitmap.eraseARGB(0, 0, 0, 0);
+    SkCanvas bitmap_canvas(bitmap);
+    bitmap_canvas.scale(key.scale, key.scale);
+    bitmap_canvas.translate(SkIntToScalar(-rect.x()),
+                            SkIntToScalar(-rect.y()));
+    PaintPart(&bitmap_canvas, part, state, rect, extra);
+    bitmap.setImmutable();
+
+    base::AutoLock lock(part_cache_lock_);
+    if (generation == part_cache_generation_)
+      part_cache_.Put(key, bitmap);
+  }
+
+  canvas->save(SkCanvas::kMatrix_SaveFlag);
+  canvas->resetMatrix();
+  canvas->drawBitmap(bitmap, SkIntToScalar(device_irect.x()),
+                     SkIntToScalar(device_irect.y()));
+  canvas->restore();
+  return true;
 }
 
 void NativeThemeBase::PaintArrowButton(
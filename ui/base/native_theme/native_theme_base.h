@@ -8,8 +8,14 @@
 
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/memory/mru_cache.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/lock.h"
 #include "skia/ext/platform_canvas.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 #include "ui/base/native_theme/native_theme.h"
+#include "ui/gfx/sys_color_change_listener.h"
 
 namespace gfx {
 class ImageSkia;
@@ -20,7 +26,13 @@ class Size;
 namespace ui {
 
 // Theme support for non-Windows toolkits.
-class NativeThemeBase : public NativeTheme {
+//
+// The scrollbar parts, checkboxes, radio buttons, push buttons and sliders are
+// painted once into a bitmap per part, state, size, scale factor and extra
+// params, and the bitmap is drawn from then on. The bitmaps are dropped when
+// the scrollbar or the system colors change.
+class NativeThemeBase : public NativeTheme,
+                        public gfx::SysColorChangeListener {
  public:
   // NativeTheme implementation:
   virtual gfx::Size GetPartSize(Part part,
@@ -36,6 +48,16 @@ class NativeThemeBase : public NativeTheme {
   NativeThemeBase();
   virtual ~NativeThemeBase();
 
+  // NativeTheme implementation:
+  virtual void ColorsChanged() const OVERRIDE;
+
+  // gfx::SysColorChangeListener implementation:
+  virtual void OnSysColorChange() OVERRIDE;
+
+  // Drops the cached parts. Themes whose parts change for other reasons than
+  // the colors call this when they do.
+  void ClearPartCache() const;
+
   // Draw the arrow. Used by scrollbar and inner spin button.
   virtual void PaintArrowButton(
       SkCanvas* gc,
@@ -142,6 +164,38 @@ class NativeThemeBase : public NativeTheme {
                               SkScalar saturate_amount,
                               SkScalar brighten_amount) const;
  private:
+  // What a cached part was painted for. The extra params that matter to the
+  // part are copied to |extra|, with positions relative to the part.
+  struct PartKey {
+    PartKey();
+
+    bool operator<(const PartKey& other) const;
+
+    Part part;
+    State state;
+    int width;
+    int height;
+    SkScalar scale;
+    int extra[5];
+  };
+  typedef base::MRUCache<PartKey, SkBitmap> PartCache;
+
+  // Paints |part| with the Paint*() method for it.
+  void PaintPart(SkCanvas* canvas,
+                 Part part,
+                 State state,
+                 const gfx::Rect& rect,
+                 const ExtraParams& extra) const;
+
+  // Draws |part| from the cache, painting it into the cache first if it isn't
+  // there. Returns false if the part can't be cached at the transform of
+  // |canvas|, in which case nothing is drawn.
+  bool PaintCachedPart(SkCanvas* canvas,
+                       Part part,
+                       State state,
+                       const gfx::Rect& rect,
+                       const ExtraParams& extra) const;
+
   void DrawVertLine(SkCanvas* canvas,
                     int x,
                     int y1,
@@ -160,6 +214,10 @@ class NativeThemeBase : public NativeTheme {
                  SkScalar max) const;
   SkColor OutlineColor(SkScalar* hsv1, SkScalar* hsv2) const;
 
+  // Keeps fewer parts when memory is short.
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+
   // Returns whether the new experimental vector-graphics based checkbox and
   // radiobutton style is enabled.
   bool IsNewCheckboxStyleEnabled(SkCanvas* canvas) const;
@@ -192,6 +250,17 @@ class NativeThemeBase : public NativeTheme {
   unsigned int scrollbar_width_;
   unsigned int scrollbar_button_length_;
 
+  // Paint() is const, the cache is not part of the state of the theme.
+  mutable base::Lock part_cache_lock_;
+  mutable PartCache part_cache_;
+  // Bumped when the cache is cleared, so that parts painted with the old
+  // colors on another thread don't make it in.
+  mutable int part_cache_generation_;
+
+  gfx::ScopedSysColorChangeListener color_change_listener_;
+
+  scoped_ptr<base::MemoryPressureListener> memory_pressure_listener_;
+
   DISALLOW_COPY_AND_ASSIGN(NativeThemeBase);
 };
 
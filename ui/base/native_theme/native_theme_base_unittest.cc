@@ -0,0 +1,164 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/base/native_theme/native_theme_base.h"
+
+#include <string.h>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "ui/gfx/rect.h"
+
+namespace ui {
+
+namespace {
+
+// Paints scrollbar tracks like NativeThemeBase, counting how many times.
+class TestNativeTheme : public NativeThemeBase {
+ public:
+  TestNativeTheme() : track_paint_count_(0) {}
+  virtual ~TestNativeTheme() {}
+
+  int track_paint_count() const { return track_paint_count_; }
+
+  void SimulateSysColorChange() { OnSysColorChange(); }
+
+  void PaintTrackUncached(SkCanvas* canvas,
+                          const gfx::Rect& rect,
+                          const ExtraParams& extra) const {
+    NativeThemeBase::PaintScrollbarTrack(canvas, kScrollbarVerticalTrack,
+                                         kNormal, extra.scrollbar_track, rect);
+  }
+
+  // NativeThemeBase overrides:
+  virtual SkColor GetSystemColor(ColorId color_id) const OVERRIDE {
+    return SK_ColorBLACK;
+  }
+  virtual void PaintScrollbarTrack(
+      SkCanvas* canvas,
+      Part part,
+      State state,
+      const ScrollbarTrackExtraParams& extra_params,
+      const gfx::Rect& rect) const OVERRIDE {
+    ++track_paint_count_;
+    NativeThemeBase::PaintScrollbarTrack(canvas, part, state, extra_params,
+                                         rect);
+  }
+
+ private:
+  mutable int track_paint_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestNativeTheme);
+};
+
+SkBitmap CreateBitmap() {
+  SkBitmap bitmap;
+  bitmap.setConfig(SkBitmap::kARGB_8888_Config, 40, 200);
+  bitmap.allocPixels();
+  bitmap.eraseARGB(255, 255, 255, 255);
+  return bitmap;
+}
+
+bool BitmapsEqual(const SkBitmap& a, const SkBitmap& b) {
+  SkAutoLockPixels lock_a(a);
+  SkAutoLockPixels lock_b(b);
+  return a.getSize() == b.getSize() &&
+      memcmp(a.getPixels(), b.getPixels(), a.getSize()) == 0;
+}
+
+NativeTheme::ExtraParams TrackParams(const gfx::Rect& track) {
+  NativeTheme::ExtraParams extra;
+  memset(&extra, 0, sizeof(extra));
+  extra.scrollbar_track.track_x = track.x();
+  extra.scrollbar_track.track_y = track.y();
+  extra.scrollbar_track.track_width = track.width();
+  extra.scrollbar_track.track_height = track.height();
+  return extra;
+}
+
+}  // namespace
+
+// Parts are painted once and drawn from the cache after, looking the same.
+TEST(NativeThemeBaseTest, CachesParts) {
+  TestNativeTheme theme;
+  gfx::Rect rect(10, 20, 15, 100);
+  NativeTheme::ExtraParams extra = TrackParams(rect);
+
+  SkBitmap expected = CreateBitmap();
+  SkCanvas expected_canvas(expected);
+  theme.PaintTrackUncached(&expected_canvas, rect, extra);
+
+  for (int i = 0; i < 2; ++i) {
+    SkBitmap bitmap = CreateBitmap();
+    SkCanvas canvas(bitmap);
+    theme.Paint(&canvas, NativeTheme::kScrollbarVerticalTrack,
+                NativeTheme::kNormal, rect, extra);
+    EXPECT_TRUE(BitmapsEqual(expected, bitmap));
+  }
+  EXPECT_EQ(1, theme.track_paint_count());
+
+  // The same part elsewhere on the canvas is drawn from the cache.
+  SkBitmap bitmap = CreateBitmap();
+  SkCanvas canvas(bitmap);
+  canvas.translate(SkIntToScalar(5), SkIntToScalar(30));
+  theme.Paint(&canvas, NativeTheme::kScrollbarVerticalTrack,
+              NativeTheme::kNormal, rect, extra);
+  EXPECT_EQ(1, theme.track_paint_count());
+
+  // Another size or state is painted.
+  theme.Paint(&canvas, NativeTheme::kScrollbarVerticalTrack,
+              NativeTheme::kNormal, gfx::Rect(10, 20, 15, 50),
+              TrackParams(gfx::Rect(10, 20, 15, 50)));
+  EXPECT_EQ(2, theme.track_paint_count());
+  theme.Paint(&canvas, NativeTheme::kScrollbarVerticalTrack,
+              NativeTheme::kHovered, rect, extra);
+  EXPECT_EQ(3, theme.track_paint_count());
+}
+
+// Parts that don't land on the pixel grid are painted every time.
+TEST(NativeThemeBaseTest, UnalignedPartsArePainted) {
+  TestNativeTheme theme;
+  gfx::Rect rect(10, 20, 15, 100);
+  NativeTheme::ExtraParams extra = TrackParams(rect);
+
+  SkBitmap bitmap = CreateBitmap();
+  SkCanvas canvas(bitmap);
+  canvas.translate(SkFloatToScalar(0.5f), 0);
+  theme.Paint(&canvas, NativeTheme::kScrollbarVerticalTrack,
+              NativeTheme::kNormal, rect, extra);
+  theme.Paint(&canvas, NativeTheme::kScrollbarVerticalTrack,
+              NativeTheme::kNormal, rect, extra);
+  EXPECT_EQ(2, theme.track_paint_count());
+}
+
+// Changing the scrollbar colors drops the cached parts.
+TEST(NativeThemeBaseTest, ColorsChangeClearsCache) {
+  TestNativeTheme theme;
+  gfx::Rect rect(10, 20, 15, 100);
+  NativeTheme::ExtraParams extra = TrackParams(rect);
+
+  SkBitmap bitmap = CreateBitmap();
+  SkCanvas canvas(bitmap);
+  theme.Paint(&canvas, NativeTheme::kScrollbarVerticalTrack,
+              NativeTheme::kNormal, rect, extra);
+  EXPECT_EQ(1, theme.track_paint_count());
+
+  theme.SetScrollbarColors(0x101010, 0x202020, 0x303030);
+  theme.Paint(&canvas, NativeTheme::kScrollbarVerticalTrack,
+              NativeTheme::kNormal, rect, extra);
+  EXPECT_EQ(2, theme.track_paint_count());
+
+  theme.SimulateSysColorChange();
+  theme.Paint(&canvas, NativeTheme::kScrollbarVerticalTrack,
+              NativeTheme::kNormal, rect, extra);
+  EXPECT_EQ(3, theme.track_paint_count());
+
+  // The colors are shared by all the themes.
+  theme.SetScrollbarColors(0xeaeaea, 0xf4f4f4, 0xd3d3d3);
+}
+
+}  // namespace ui
@@ -5,12 +5,21 @@
 #include "ui/base/resource/data_pack.h"
 
 #include <errno.h>
+#include <string.h>
+
+#include <set>
 
 #include "base/file_util.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted_memory.h"
 #include "base/metrics/histogram.h"
 #include "base/string_piece.h"
+#include "build/build_config.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+#if defined(OS_POSIX)
+#include <sys/mman.h>
+#endif
 
 // For details of the file layout, see
 // http://dev.chromium.org/developers/design-documents/linuxresourcesandlocalizedstrings
@@ -21,6 +30,13 @@ static const uint32 kFileFormatVersion = 4;
 // Length of file header: version, entry count and text encoding type.
 static const size_t kHeaderLength = 2 * sizeof(uint32) + sizeof(uint8);
 
+// The version of packs whose data isn't in the order of the ids, written by
+// WritePackOrdered(). Their header ends with the length of the data used
+// first, which follows the index, and each entry of the index gives the
+// length of its resource.
+static const uint32 kOrderedFileFormatVersion = 5;
+static const size_t kOrderedHeaderLength = kHeaderLength + sizeof(uint32);
+
 #pragma pack(push,2)
 struct DataPackEntry {
   uint16 resource_id;
@@ -43,6 +59,113 @@ struct DataPackEntry {
 
 COMPILE_ASSERT(sizeof(DataPackEntry) == 6, size_of_entry_must_be_six);
 
+// The entries of the index of ordered packs. They start like DataPackEntry,
+// so DataPackEntry::CompareById() also searches them.
+#pragma pack(push,2)
+struct OrderedDataPackEntry {
+  uint16 resource_id;
+  uint32 file_offset;
+  uint32 length;
+};
+#pragma pack(pop)
+
+COMPILE_ASSERT(sizeof(OrderedDataPackEntry) == 10, size_of_entry_must_be_ten);
+
+// Raw image resources start with this value, which can't start a PNG or a
+// JPEG. "RAWI" in little endian.
+const uint32 kRawImageMagic = 0x49574152;
+
+// The header of raw image resources. The pixels follow at |pixel_offset| from
+// the start of the resource, |height| rows of |row_bytes| bytes of
+// premultiplied 32-bit pixels in the order SkBitmap keeps them. WritePack()
+// adjusts |pixel_offset| to align the pixels in the file.
+struct RawImageHeader {
+  uint32 magic;
+  uint32 width;
+  uint32 height;
+  uint32 row_bytes;
+  uint32 pixel_offset;
+};
+
+COMPILE_ASSERT(sizeof(RawImageHeader) == 20, size_of_header_must_be_twenty);
+
+// The alignment of the pixels of raw images, which are read as 32-bit words.
+const size_t kRawImageAlignment = 4;
+
+// Returns true if |data| starts with the header of a raw image.
+bool IsRawImage(const base::StringPiece& data) {
+  if (data.size() < sizeof(RawImageHeader))
+    return false;
+  uint32 magic;
+  memcpy(&magic, data.data(), sizeof(magic));
+  return magic == kRawImageMagic;
+}
+
+// Returns the number of bytes to insert between the header and the pixels of
+// the resource |data| written at |offset| in a pack file, so that the pixels
+// are aligned. Returns 0 for resources that aren't raw images.
+uint32 GetRawImagePadding(const base::StringPiece& data, uint32 offset) {
+  if (!IsRawImage(data))
+    return 0;
+  uint32 pixels = offset + sizeof(RawImageHeader);
+  return (kRawImageAlignment - pixels % kRawImageAlignment) %
+      kRawImageAlignment;
+}
+
+// Writes the resource |data| at |offset| in |file|, inserting the padding
+// GetRawImagePadding() returns.
+bool WriteResource(FILE* file, const base::StringPiece& data, uint32 offset) {
+  uint32 padding = GetRawImagePadding(data, offset);
+  if (!padding)
+    return fwrite(data.data(), data.length(), 1, file) == 1;
+
+  RawImageHeader header;
+  memcpy(&header, data.data(), sizeof(header));
+  if (header.pixel_offset > data.length())
+    return false;
+  const size_t pixels_size = data.length() - header.pixel_offset;
+  header.pixel_offset += padding;
+  const char zeros[kRawImageAlignment] = { 0 };
+  return fwrite(&header, sizeof(header), 1, file) == 1 &&
+      fwrite(zeros, padding, 1, file) == 1 &&
+      (!pixels_size ||
+       fwrite(data.data() + data.length() - pixels_size, pixels_size, 1,
+              file) == 1);
+}
+
+// Writes the part of the header common to all versions. Returns false on
+// error.
+bool WriteHeader(FILE* file,
+                 uint32 version,
+                 uint32 entry_count,
+                 ui::ResourceHandle::TextEncodingType text_encoding_type) {
+  if (fwrite(&version, sizeof(version), 1, file) != 1) {
+    LOG(ERROR) << "Failed to write file version";
+    return false;
+  }
+
+  if (fwrite(&entry_count, sizeof(entry_count), 1, file) != 1) {
+    LOG(ERROR) << "Failed to write entry count";
+    return false;
+  }
+
+  if (text_encoding_type != ui::ResourceHandle::UTF8 &&
+      text_encoding_type != ui::ResourceHandle::UTF16 &&
+      text_encoding_type != ui::ResourceHandle::BINARY) {
+    LOG(ERROR) << "Invalid text encoding type, got " << text_encoding_type
+               << ", expected between " << ui::ResourceHandle::BINARY
+               << " and " << ui::ResourceHandle::UTF16;
+    return false;
+  }
+
+  uint8 write_buffer = text_encoding_type;
+  if (fwrite(&write_buffer, sizeof(uint8), 1, file) != 1) {
+    LOG(ERROR) << "Failed to write file text resources encoding";
+    return false;
+  }
+  return true;
+}
+
 // We're crashing when trying to load a pak file on Windows.  Add some error
 // codes for logging.
 // http://crbug.com/58056
@@ -63,6 +186,8 @@ namespace ui {
 
 DataPack::DataPack(ui::ScaleFactor scale_factor)
     : resource_count_(0),
+      index_offset_(kHeaderLength),
+      entry_size_(sizeof(DataPackEntry)),
       text_encoding_type_(BINARY),
       scale_factor_(scale_factor) {
 }
@@ -93,14 +218,24 @@ bool DataPack::Load(const FilePath& path) {
   // First uint32: version; second: resource count;
   const uint32* ptr = reinterpret_cast<const uint32*>(mmap_->data());
   uint32 version = ptr[0];
-  if (version != kFileFormatVersion) {
+  if (version != kFileFormatVersion && version != kOrderedFileFormatVersion) {
     LOG(ERROR) << "Bad data pack version: got " << version << ", expected "
-               << kFileFormatVersion;
+               << kFileFormatVersion << " or " << kOrderedFileFormatVersion;
     UMA_HISTOGRAM_ENUMERATION("DataPack.Load", BAD_VERSION,
                               LOAD_ERRORS_COUNT);
     mmap_.reset();
     return false;
   }
+  const bool ordered = version == kOrderedFileFormatVersion;
+  index_offset_ = ordered ? kOrderedHeaderLength : kHeaderLength;
+  entry_size_ = ordered ? sizeof(OrderedDataPackEntry) : sizeof(DataPackEntry);
+  if (index_offset_ > mmap_->length()) {
+    DLOG(ERROR) << "Data pack file corruption: incomplete file header.";
+    UMA_HISTOGRAM_ENUMERATION("DataPack.Load", HEADER_TRUNCATED,
+                              LOAD_ERRORS_COUNT);
+    mmap_.reset();
+    return false;
+  }
   resource_count_ = ptr[1];
 
   // third: text encoding.
@@ -118,8 +253,7 @@ bool DataPack::Load(const FilePath& path) {
 
   // Sanity check the file.
   // 1) Check we have enough entries.
-  if (kHeaderLength + resource_count_ * sizeof(DataPackEntry) >
-      mmap_->length()) {
+  if (index_offset_ + resource_count_ * entry_size_ > mmap_->length()) {
     LOG(ERROR) << "Data pack file corruption: too short for number of "
                   "entries specified.";
     UMA_HISTOGRAM_ENUMERATION("DataPack.Load", INDEX_TRUNCATED,
@@ -127,6 +261,9 @@ bool DataPack::Load(const FilePath& path) {
     mmap_.reset();
     return false;
   }
+  if (ordered)
+    return LoadOrderedIndex();
+
   // 2) Verify the entries are within the appropriate bounds. There's an extra
   // entry after the last item which gives us the length of the last item.
   for (size_t i = 0; i < resource_count_ + 1; ++i) {
@@ -145,9 +282,41 @@ bool DataPack::Load(const FilePath& path) {
   return true;
 }
 
+bool DataPack::LoadOrderedIndex() {
+  // 2) Verify the entries are within the appropriate bounds.
+  const size_t data_start = index_offset_ + resource_count_ * entry_size_;
+  for (size_t i = 0; i < resource_count_; ++i) {
+    const OrderedDataPackEntry* entry =
+        reinterpret_cast<const OrderedDataPackEntry*>(
+            mmap_->data() + index_offset_ + (i * entry_size_));
+    if (entry->file_offset > mmap_->length() ||
+        entry->length > mmap_->length() - entry->file_offset) {
+      LOG(ERROR) << "Entry #" << i << " in data pack points off end of file. "
+                 << "Was the file corrupted?";
+      UMA_HISTOGRAM_ENUMERATION("DataPack.Load", ENTRY_NOT_FOUND,
+                                LOAD_ERRORS_COUNT);
+      mmap_.reset();
+      return false;
+    }
+  }
+
+  // The header ends with the length of the data used first, which follows
+  // the index. Have the system read it, and the header and index before it,
+  // ahead of the lookups.
+  uint32 hot_length;
+  memcpy(&hot_length, mmap_->data() + kHeaderLength, sizeof(hot_length));
+  if (hot_length > mmap_->length() - data_start)
+    hot_length = mmap_->length() - data_start;
+#if defined(OS_POSIX)
+  madvise(const_cast<uint8*>(mmap_->data()), data_start + hot_length,
+          MADV_WILLNEED);
+#endif
+  return true;
+}
+
 bool DataPack::HasResource(uint16 resource_id) const {
-  return !!bsearch(&resource_id, mmap_->data() + kHeaderLength, resource_count_,
-                   sizeof(DataPackEntry), DataPackEntry::CompareById);
+  return !!bsearch(&resource_id, mmap_->data() + index_offset_,
+                   resource_count_, entry_size_, DataPackEntry::CompareById);
 }
 
 bool DataPack::GetStringPiece(uint16 resource_id,
@@ -163,13 +332,22 @@ bool DataPack::GetStringPiece(uint16 resource_id,
   #error DataPack assumes little endian
 #endif
 
-  const DataPackEntry* target = reinterpret_cast<const DataPackEntry*>(
-      bsearch(&resource_id, mmap_->data() + kHeaderLength, resource_count_,
-              sizeof(DataPackEntry), DataPackEntry::CompareById));
-  if (!target) {
+  const void* found = bsearch(&resource_id, mmap_->data() + index_offset_,
+                              resource_count_, entry_size_,
+                              DataPackEntry::CompareById);
+  if (!found) {
     return false;
   }
 
+  if (entry_size_ == sizeof(OrderedDataPackEntry)) {
+    const OrderedDataPackEntry* entry =
+        reinterpret_cast<const OrderedDataPackEntry*>(found);
+    data->set(mmap_->data() + entry->file_offset, entry->length);
+    return true;
+  }
+
+  const DataPackEntry* target = reinterpret_cast<const DataPackEntry*>(found);
+
   const DataPackEntry* next_entry = target + 1;
   size_t length = next_entry->file_offset - target->file_offset;
 
@@ -195,6 +373,60 @@ ui::ScaleFactor DataPack::GetScaleFactor() const {
   return scale_factor_;
 }
 
+// static
+bool DataPack::EncodeRawImage(const SkBitmap& bitmap, std::string* data) {
+  if (bitmap.config() != SkBitmap::kARGB_8888_Config || bitmap.empty())
+    return false;
+
+  SkAutoLockPixels lock(bitmap);
+  if (!bitmap.getPixels())
+    return false;
+  RawImageHeader header;
+  header.magic = kRawImageMagic;
+  header.width = bitmap.width();
+  header.height = bitmap.height();
+  header.row_bytes = bitmap.rowBytes();
+  header.pixel_offset = sizeof(header);
+  data->assign(reinterpret_cast<const char*>(&header), sizeof(header));
+  data->append(static_cast<const char*>(bitmap.getPixels()),
+               bitmap.getSize());
+  return true;
+}
+
+// static
+bool DataPack::DecodeRawImage(const base::StringPiece& data,
+                              SkBitmap* bitmap) {
+  if (!IsRawImage(data))
+    return false;
+
+  RawImageHeader header;
+  memcpy(&header, data.data(), sizeof(header));
+  if (header.pixel_offset < sizeof(header) ||
+      header.pixel_offset > data.size() ||
+      header.width == 0 || header.height == 0 ||
+      header.row_bytes < header.width * 4 ||
+      (data.size() - header.pixel_offset) / header.row_bytes <
+          header.height) {
+    LOG(ERROR) << "Raw image resource is truncated or corrupted.";
+    return false;
+  }
+
+  const char* pixels = data.data() + header.pixel_offset;
+  bitmap->setConfig(SkBitmap::kARGB_8888_Config, header.width, header.height,
+                    header.row_bytes);
+  if (reinterpret_cast<uintptr_t>(pixels) % kRawImageAlignment == 0) {
+    // The pixels are read-only, like the rest of the mapped file.
+    bitmap->setPixels(const_cast<char*>(pixels));
+  } else {
+    if (!bitmap->allocPixels())
+      return false;
+    SkAutoLockPixels lock(*bitmap);
+    memcpy(bitmap->getPixels(), pixels, bitmap->getSize());
+  }
+  bitmap->setImmutable();
+  return true;
+}
+
 // static
 bool DataPack::WritePack(const FilePath& path,
                          const std::map<uint16, base::StringPiece>& resources,
@@ -203,32 +435,10 @@ bool DataPack::WritePack(const FilePath& path,
   if (!file)
     return false;
 
-  if (fwrite(&kFileFormatVersion, sizeof(kFileFormatVersion), 1, file) != 1) {
-    LOG(ERROR) << "Failed to write file version";
-    file_util::CloseFile(file);
-    return false;
-  }
-
   // Note: the python version of this function explicitly sorted keys, but
   // std::map is a sorted associative container, we shouldn't have to do that.
   uint32 entry_count = resources.size();
-  if (fwrite(&entry_count, sizeof(entry_count), 1, file) != 1) {
-    LOG(ERROR) << "Failed to write entry count";
-    file_util::CloseFile(file);
-    return false;
-  }
-
-  if (textEncodingType != UTF8 && textEncodingType != UTF16 &&
-      textEncodingType != BINARY) {
-    LOG(ERROR) << "Invalid text encoding type, got " << textEncodingType
-               << ", expected between " << BINARY << " and " << UTF16;
-    file_util::CloseFile(file);
-    return false;
-  }
-
-  uint8 write_buffer = textEncodingType;
-  if (fwrite(&write_buffer, sizeof(uint8), 1, file) != 1) {
-    LOG(ERROR) << "Failed to write file text resources encoding";
+  if (!WriteHeader(file, kFileFormatVersion, entry_count, textEncodingType)) {
     file_util::CloseFile(file);
     return false;
   }
@@ -253,7 +463,8 @@ bool DataPack::WritePack(const FilePath& path,
       return false;
     }
 
-    data_offset += it->second.length();
+    data_offset += it->second.length() +
+        GetRawImagePadding(it->second, data_offset);
   }
 
   // We place an extra entry after the last item that allows us to read the
@@ -271,14 +482,91 @@ bool DataPack::WritePack(const FilePath& path,
     return false;
   }
 
+  data_offset = kHeaderLength + index_length;
   for (std::map<uint16, base::StringPiece>::const_iterator it =
            resources.begin();
        it != resources.end(); ++it) {
-    if (fwrite(it->second.data(), it->second.length(), 1, file) != 1) {
+    if (!WriteResource(file, it->second, data_offset)) {
       LOG(ERROR) << "Failed to write data for " << it->first;
       file_util::CloseFile(file);
       return false;
     }
+    data_offset += it->second.length() +
+        GetRawImagePadding(it->second, data_offset);
+  }
+
+  file_util::CloseFile(file);
+
+  return true;
+}
+
+// static
+bool DataPack::WritePackOrdered(
+    const FilePath& path,
+    const std::map<uint16, base::StringPiece>& resources,
+    TextEncodingType textEncodingType,
+    const std::vector<uint16>& hot_ids) {
+  // The order of the data: the hot resources, then the others by id.
+  std::vector<uint16> order;
+  std::set<uint16> ordered_ids;
+  for (size_t i = 0; i < hot_ids.size(); ++i) {
+    if (resources.count(hot_ids[i]) && ordered_ids.insert(hot_ids[i]).second)
+      order.push_back(hot_ids[i]);
+  }
+  const size_t hot_count = order.size();
+  for (std::map<uint16, base::StringPiece>::const_iterator it =
+           resources.begin();
+       it != resources.end(); ++it) {
+    if (!ordered_ids.count(it->first))
+      order.push_back(it->first);
+  }
+
+  // Lay the data out, and note where the hot part ends.
+  uint32 entry_count = resources.size();
+  const uint32 data_start =
+      kOrderedHeaderLength + entry_count * sizeof(OrderedDataPackEntry);
+  std::map<uint16, OrderedDataPackEntry> entries;
+  uint32 data_offset = data_start;
+  uint32 hot_length = 0;
+  for (size_t i = 0; i < order.size(); ++i) {
+    const base::StringPiece& data = resources.find(order[i])->second;
+    OrderedDataPackEntry& entry = entries[order[i]];
+    entry.resource_id = order[i];
+    entry.file_offset = data_offset;
+    entry.length = data.length() + GetRawImagePadding(data, data_offset);
+    data_offset += entry.length;
+    if (i + 1 == hot_count)
+      hot_length = data_offset - data_start;
+  }
+
+  FILE* file = file_util::OpenFile(path, "wb");
+  if (!file)
+    return false;
+
+  if (!WriteHeader(file, kOrderedFileFormatVersion, entry_count,
+                   textEncodingType) ||
+      fwrite(&hot_length, sizeof(hot_length), 1, file) != 1) {
+    file_util::CloseFile(file);
+    return false;
+  }
+
+  for (std::map<uint16, OrderedDataPackEntry>::const_iterator it =
+           entries.begin();
+       it != entries.end(); ++it) {
+    if (fwrite(&it->second, sizeof(it->second), 1, file) != 1) {
+      LOG(ERROR) << "Failed to write entry for " << it->first;
+      file_util::CloseFile(file);
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (!WriteResource(file, resources.find(order[i])->second,
+                       entries[order[i]].file_offset)) {
+      LOG(ERROR) << "Failed to write data for " << order[i];
+      file_util::CloseFile(file);
+      return false;
+    }
   }
 
   file_util::CloseFile(file);
@@ -8,6 +8,7 @@
 #include "base/scoped_temp_dir.h"
 #include "base/string_piece.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 #include "ui/base/resource/data_pack.h"
 
 namespace ui {
@@ -107,4 +108,93 @@ TEST_P(DataPackTest, Write) {
   EXPECT_EQ(fifteen, data);
 }
 
+// Verifies that raw images survive a pack file, with their pixels aligned
+// whatever resources precede them.
+TEST(DataPackTest, RawImage) {
+  ScopedTempDir dir;
+  ASSERT_TRUE(dir.CreateUniqueTempDir());
+  FilePath file = dir.path().Append(FILE_PATH_LITERAL("images.pak"));
+
+  SkBitmap bitmap;
+  bitmap.setConfig(SkBitmap::kARGB_8888_Config, 3, 2);
+  ASSERT_TRUE(bitmap.allocPixels());
+  bitmap.eraseARGB(128, 64, 32, 16);
+  std::string raw;
+  ASSERT_TRUE(DataPack::EncodeRawImage(bitmap, &raw));
+
+  // An odd-sized resource puts the next one at an odd offset.
+  std::string odd("odd");
+  std::map<uint16, base::StringPiece> resources;
+  resources.insert(std::make_pair(1, base::StringPiece(odd)));
+  resources.insert(std::make_pair(2, base::StringPiece(raw)));
+  ASSERT_TRUE(DataPack::WritePack(file, resources, DataPack::BINARY));
+
+  DataPack pack(SCALE_FACTOR_100P);
+  ASSERT_TRUE(pack.Load(file));
+  base::StringPiece data;
+  ASSERT_TRUE(pack.GetStringPiece(1, &data));
+  EXPECT_EQ(odd, data);
+  ASSERT_TRUE(pack.GetStringPiece(2, &data));
+  EXPECT_FALSE(DataPack::DecodeRawImage(base::StringPiece(odd), &bitmap));
+
+  SkBitmap decoded;
+  ASSERT_TRUE(DataPack::DecodeRawImage(data, &decoded));
+  EXPECT_EQ(3, decoded.width());
+  EXPECT_EQ(2, decoded.height());
+  EXPECT_TRUE(decoded.isImmutable());
+  // The pixels weren't copied.
+  EXPECT_GE(static_cast<const char*>(decoded.getPixels()), data.data());
+  EXPECT_LT(static_cast<const char*>(decoded.getPixels()),
+            data.data() + data.size());
+  SkAutoLockPixels lock(bitmap);
+  EXPECT_EQ(*bitmap.getAddr32(2, 1), *decoded.getAddr32(2, 1));
+}
+
+// Verifies that packs with their data in another order than the ids read back
+// the same resources.
+TEST(DataPackTest, WriteOrdered) {
+  ScopedTempDir dir;
+  ASSERT_TRUE(dir.CreateUniqueTempDir());
+  FilePath file = dir.path().Append(FILE_PATH_LITERAL("ordered.pak"));
+
+  std::string one("one");
+  std::string two("two");
+  std::string three("three");
+  std::string four("four");
+  std::map<uint16, base::StringPiece> resources;
+  resources.insert(std::make_pair(1, base::StringPiece(one)));
+  resources.insert(std::make_pair(2, base::StringPiece(two)));
+  resources.insert(std::make_pair(15, base::StringPiece(three)));
+  resources.insert(std::make_pair(17, base::StringPiece(four)));
+
+  std::vector<uint16> hot_ids;
+  hot_ids.push_back(17);
+  hot_ids.push_back(99);
+  hot_ids.push_back(2);
+  hot_ids.push_back(17);
+  ASSERT_TRUE(DataPack::WritePackOrdered(file, resources, DataPack::BINARY,
+                                         hot_ids));
+
+  DataPack pack(SCALE_FACTOR_100P);
+  ASSERT_TRUE(pack.Load(file));
+  EXPECT_EQ(DataPack::BINARY, pack.GetTextEncodingType());
+
+  base::StringPiece data;
+  ASSERT_TRUE(pack.GetStringPiece(1, &data));
+  EXPECT_EQ(one, data);
+  ASSERT_TRUE(pack.GetStringPiece(2, &data));
+  EXPECT_EQ(two, data);
+  ASSERT_TRUE(pack.GetStringPiece(15, &data));
+  EXPECT_EQ(three, data);
+  ASSERT_TRUE(pack.GetStringPiece(17, &data));
+  EXPECT_EQ(four, data);
+  EXPECT_FALSE(pack.HasResource(99));
+
+  // The hot resources come first.
+  base::StringPiece first, second;
+  ASSERT_TRUE(pack.GetStringPiece(17, &first));
+  ASSERT_TRUE(pack.GetStringPiece(2, &second));
+  EXPECT_EQ(first.data() + first.size(), second.data());
+}
+
 }  // namespace ui
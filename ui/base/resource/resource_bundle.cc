@@ -7,16 +7,22 @@
 #include <vector>
 
 #include "base/auto_reset.h"
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/file_util.h"
+#include "base/location.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted_memory.h"
 #include "base/metrics/histogram.h"
 #include "base/path_service.h"
 #include "base/stl_util.h"
 #include "base/string_piece.h"
+#include "base/string_util.h"
+#include "base/synchronization/condition_variable.h"
 #include "base/synchronization/lock.h"
+#include "base/synchronization/rw_lock.h"
 #include "base/threading/platform_thread.h"
+#include "base/threading/worker_pool.h"
 #include "base/utf_string_conversions.h"
 #include "build/build_config.h"
 #include "skia/ext/image_operations.h"
@@ -83,6 +89,16 @@ void Create2xResourceIfMissing(gfx::ImageSkia image, int idr) {
 
 }  // namespace
 
+struct ResourceBundle::PrefetchedImage {
+  PrefetchedImage() : decoded(false) {}
+
+  // Whether the decoding has finished.
+  bool decoded;
+
+  // One bitmap per data pack, null where the pack doesn't have the image.
+  std::vector<SkBitmap> bitmaps;
+};
+
 ResourceBundle* ResourceBundle::g_shared_instance_ = NULL;
 static bool g_locale_initialized_ = false;
 static bool g_locale_reloading_ = false;
@@ -232,6 +248,7 @@ void ResourceBundle::LoadTestResources(const FilePath& path,
   if (!path.empty() && data_pack->Load(path))
     data_packs_.push_back(data_pack.release());
 
+  RetireLocalizedStrings();
   data_pack.reset(new DataPack(ui::SCALE_FACTOR_NONE));
   if (!locale_path.empty() && data_pack->Load(locale_path)) {
     locale_resources_data_.reset(data_pack.release());
@@ -243,6 +260,15 @@ void ResourceBundle::LoadTestResources(const FilePath& path,
 
 void ResourceBundle::UnloadLocaleResources() {
   locale_resources_data_.reset();
+  RetireLocalizedStrings();
+}
+
+void ResourceBundle::RetireLocalizedStrings() {
+  base::AutoLock strings_lock_scope(*localized_strings_lock_);
+  if (!localized_strings_->empty()) {
+    retired_localized_strings_.push_back(localized_strings_.release());
+    localized_strings_.reset(new LocalizedStringMap);
+  }
 }
 
 void ResourceBundle::OverrideLocalePakForTest(const FilePath& pak_path) {
@@ -255,7 +281,7 @@ const FilePath& ResourceBundle::GetOverriddenPakPath() {
 
 std::string ResourceBundle::ReloadLocaleResources(
     const std::string& pref_locale) {
-  base::AutoLock lock_scope(*locale_resources_data_lock_);
+  base::AutoWriteLock lock_scope(*locale_resources_data_lock_);
   AutoReset<bool> reset_reloading(&g_locale_reloading_, true);
   AutoReset<base::PlatformThreadId> reset_reloading_thread(
       &g_locale_reload_thread_id_, base::PlatformThread::CurrentId());
@@ -285,21 +311,32 @@ gfx::Image& ResourceBundle::GetImageNamed(int resource_id) {
   if (delegate_)
     image = delegate_->GetImageNamed(resource_id);
 
+  bool loaded_from_data_packs = false;
   if (image.IsEmpty()) {
     DCHECK(!delegate_ && !data_packs_.empty()) <<
         "Missing call to SetResourcesDataDLL?";
-    gfx::ImageSkia image_skia;
-    for (size_t i = 0; i < data_packs_.size(); ++i) {
-      scoped_ptr<SkBitmap> bitmap(LoadBitmap(*data_packs_[i], resource_id));
-      if (bitmap.get()) {
-        if (gfx::Screen::IsDIPEnabled())
-          image_skia.AddBitmapForScale(*bitmap,
-              ui::GetScaleFactorScale(data_packs_[i]->GetScaleFactor()));
-        else
-          image_skia.AddBitmapForScale(*bitmap, 1.0f);
+    // One bitmap per data pack, null where the pack doesn't have the image.
+    std::vector<SkBitmap> bitmaps;
+    if (!TakePrefetchedBitmaps(resource_id, &bitmaps)) {
+      bitmaps.resize(data_packs_.size());
+      for (size_t i = 0; i < data_packs_.size(); ++i) {
+        scoped_ptr<SkBitmap> bitmap(LoadBitmap(*data_packs_[i], resource_id));
+        if (bitmap.get())
+          bitmaps[i] = *bitmap;
       }
     }
 
+    gfx::ImageSkia image_skia;
+    for (size_t i = 0; i < bitmaps.size(); ++i) {
+      if (bitmaps[i].isNull())
+        continue;
+      if (gfx::Screen::IsDIPEnabled())
+        image_skia.AddBitmapForScale(bitmaps[i],
+            ui::GetScaleFactorScale(data_packs_[i]->GetScaleFactor()));
+      else
+        image_skia.AddBitmapForScale(bitmaps[i], 1.0f);
+    }
+
     if (image_skia.empty()) {
       LOG(WARNING) << "Unable to load image with id " << resource_id;
       NOTREACHED();  // Want to assert in debug mode.
@@ -310,6 +347,7 @@ gfx::Image& ResourceBundle::GetImageNamed(int resource_id) {
     Create2xResourceIfMissing(image_skia, resource_id);
 
     image = gfx::Image(image_skia);
+    loaded_from_data_packs = true;
   }
 
   // The load was successful, so cache the image.
@@ -320,6 +358,8 @@ gfx::Image& ResourceBundle::GetImageNamed(int resource_id) {
     return images_[resource_id];
 
   images_[resource_id] = image;
+  if (loaded_from_data_packs)
+    loaded_image_ids_.push_back(resource_id);
   return images_[resource_id];
 }
 
@@ -327,6 +367,54 @@ gfx::Image& ResourceBundle::GetNativeImageNamed(int resource_id) {
   return GetNativeImageNamed(resource_id, RTL_DISABLED);
 }
 
+void ResourceBundle::PrefetchImages(const std::vector<int>& resource_ids) {
+  DCHECK(!data_packs_.empty());
+  for (size_t i = 0; i < resource_ids.size(); ++i) {
+    const int resource_id = resource_ids[i];
+    {
+      base::AutoLock lock_scope(*images_and_fonts_lock_);
+      if (images_.count(resource_id))
+        continue;
+    }
+    {
+      base::AutoLock lock_scope(*prefetch_lock_);
+      if (prefetched_images_.count(resource_id))
+        continue;
+      prefetched_images_[resource_id] = new PrefetchedImage;
+      ++pending_prefetch_count_;
+    }
+    if (!base::WorkerPool::PostTask(
+            FROM_HERE,
+            base::Bind(&ResourceBundle::DecodePrefetchedImage,
+                       base::Unretained(this), resource_id),
+            false)) {
+      // Decode it here rather than leave GetImageNamed() waiting for it.
+      DecodePrefetchedImage(resource_id);
+    }
+  }
+}
+
+std::vector<int> ResourceBundle::GetLoadedImageIDs() const {
+  base::AutoLock lock_scope(*images_and_fonts_lock_);
+  return loaded_image_ids_;
+}
+
+void ResourceBundle::StartRecordingResourceIDs() {
+  base::AutoLock lock_scope(*recording_lock_);
+  recording_resource_ids_ = true;
+  recorded_resource_ids_.clear();
+  recorded_resource_id_set_.clear();
+}
+
+std::vector<uint16> ResourceBundle::StopRecordingResourceIDs() {
+  base::AutoLock lock_scope(*recording_lock_);
+  recording_resource_ids_ = false;
+  std::vector<uint16> ids;
+  ids.swap(recorded_resource_ids_);
+  recorded_resource_id_set_.clear();
+  return ids;
+}
+
 base::RefCountedStaticMemory* ResourceBundle::LoadDataResourceBytes(
     int resource_id,
     ScaleFactor scale_factor) const {
@@ -367,6 +455,7 @@ base::StringPiece ResourceBundle::GetRawDataResource(
   if (locale_resources_data_->GetStringPiece(resource_id, &data))
     return data;
 
+  RecordResourceID(resource_id);
   if (scale_factor != ui::SCALE_FACTOR_100P) {
     for (size_t i = 0; i < data_packs_.size(); i++) {
       if (data_packs_[i]->GetScaleFactor() == scale_factor &&
@@ -384,19 +473,40 @@ base::StringPiece ResourceBundle::GetRawDataResource(
 }
 
 string16 ResourceBundle::GetLocalizedString(int message_id) {
-  string16 string;
-  if (delegate_ && delegate_->GetLocalizedString(message_id, &string))
-    return string;
+  return GetLocalizedStringRef(message_id);
+}
 
+const string16& ResourceBundle::GetLocalizedStringRef(int message_id) {
   // Ensure that ReloadLocaleResources() doesn't drop the resources while
   // we're using them.
-  base::AutoLock lock_scope(*locale_resources_data_lock_);
+  base::AutoReadLock lock_scope(*locale_resources_data_lock_);
+
+  {
+    base::AutoLock strings_lock_scope(*localized_strings_lock_);
+    LocalizedStringMap::const_iterator it =
+        localized_strings_->find(message_id);
+    if (it != localized_strings_->end())
+      return it->second;
+  }
 
+  string16 string;
+  if (!delegate_ || !delegate_->GetLocalizedString(message_id, &string)) {
+    if (!LoadLocalizedString(message_id, &string))
+      return EmptyString16();
+  }
+
+  // Another thread may have added the string meanwhile; keep the first copy.
+  base::AutoLock strings_lock_scope(*localized_strings_lock_);
+  return localized_strings_->insert(
+      std::make_pair(message_id, string)).first->second;
+}
+
+bool ResourceBundle::LoadLocalizedString(int message_id, string16* string) {
   // If for some reason we were unable to load the resources , return an empty
   // string (better than crashing).
   if (!locale_resources_data_.get()) {
     LOG(WARNING) << "locale resources are not loaded";
-    return string16();
+    return false;
   }
 
   base::StringPiece data;
@@ -406,7 +516,7 @@ string16 ResourceBundle::GetLocalizedString(int message_id) {
     data = GetRawDataResource(message_id, ui::SCALE_FACTOR_NONE);
     if (data.empty()) {
       NOTREACHED() << "unable to find resource: " << message_id;
-      return string16();
+      return false;
     }
   }
 
@@ -417,14 +527,13 @@ string16 ResourceBundle::GetLocalizedString(int message_id) {
       << "requested localized string from binary pack file";
 
   // Data pack encodes strings as either UTF8 or UTF16.
-  string16 msg;
   if (encoding == ResourceHandle::UTF16) {
-    msg = string16(reinterpret_cast<const char16*>(data.data()),
+    string->assign(reinterpret_cast<const char16*>(data.data()),
                    data.length() / 2);
   } else if (encoding == ResourceHandle::UTF8) {
-    msg = UTF8ToUTF16(data);
+    *string = UTF8ToUTF16(data);
   }
-  return msg;
+  return true;
 }
 
 const gfx::Font& ResourceBundle::GetFont(FontStyle style) {
@@ -459,10 +568,25 @@ void ResourceBundle::ReloadFonts() {
 ResourceBundle::ResourceBundle(Delegate* delegate)
     : delegate_(delegate),
       images_and_fonts_lock_(new base::Lock),
-      locale_resources_data_lock_(new base::Lock) {
+      locale_resources_data_lock_(new base::RWLock),
+      localized_strings_lock_(new base::Lock),
+      prefetch_lock_(new base::Lock),
+      prefetch_decoded_(new base::ConditionVariable(prefetch_lock_.get())),
+      pending_prefetch_count_(0),
+      localized_strings_(new LocalizedStringMap),
+      recording_lock_(new base::Lock),
+      recording_resource_ids_(false) {
+  memory_pressure_listener_.reset(new base::MemoryPressureListener(
+      base::Bind(&ResourceBundle::OnMemoryPressure, base::Unretained(this))));
 }
 
 ResourceBundle::~ResourceBundle() {
+  {
+    base::AutoLock lock_scope(*prefetch_lock_);
+    while (pending_prefetch_count_ > 0)
+      prefetch_decoded_->Wait();
+    STLDeleteValues(&prefetched_images_);
+  }
   FreeImages();
   UnloadLocaleResources();
 }
@@ -526,6 +650,16 @@ void ResourceBundle::LoadFontsIfNecessary() {
 
 SkBitmap* ResourceBundle::LoadBitmap(const ResourceHandle& data_handle,
                                      int resource_id) {
+  RecordResourceID(resource_id);
+
+  // Raw images refer to the pack, which lives as long as the bundle.
+  base::StringPiece data;
+  SkBitmap raw_bitmap;
+  if (data_handle.GetStringPiece(resource_id, &data) &&
+      DataPack::DecodeRawImage(data, &raw_bitmap)) {
+    return new SkBitmap(raw_bitmap);
+  }
+
   scoped_refptr<base::RefCountedMemory> memory(
       data_handle.GetStaticMemory(resource_id));
   if (!memory)
@@ -545,6 +679,68 @@ SkBitmap* ResourceBundle::LoadBitmap(const ResourceHandle& data_handle,
   return NULL;
 }
 
+void ResourceBundle::RecordResourceID(int resource_id) const {
+  base::AutoLock lock_scope(*recording_lock_);
+  if (recording_resource_ids_ &&
+      recorded_resource_id_set_.insert(resource_id).second) {
+    recorded_resource_ids_.push_back(resource_id);
+  }
+}
+
+void ResourceBundle::DecodePrefetchedImage(int resource_id) {
+  std::vector<SkBitmap> bitmaps(data_packs_.size());
+  for (size_t i = 0; i < data_packs_.size(); ++i) {
+    scoped_ptr<SkBitmap> bitmap(LoadBitmap(*data_packs_[i], resource_id));
+    if (bitmap.get())
+      bitmaps[i] = *bitmap;
+  }
+
+  base::AutoLock lock_scope(*prefetch_lock_);
+  PrefetchedImage* image = prefetched_images_[resource_id];
+  DCHECK(image);
+  image->bitmaps.swap(bitmaps);
+  image->decoded = true;
+  --pending_prefetch_count_;
+  prefetch_decoded_->Broadcast();
+}
+
+bool ResourceBundle::TakePrefetchedBitmaps(int resource_id,
+                                           std::vector<SkBitmap>* bitmaps) {
+  base::AutoLock lock_scope(*prefetch_lock_);
+  // The image is looked up again after each wait, since another thread may
+  // have taken it meanwhile.
+  PrefetchedImageMap::iterator it;
+  while ((it = prefetched_images_.find(resource_id)) !=
+             prefetched_images_.end() &&
+         !it->second->decoded) {
+    prefetch_decoded_->Wait();
+  }
+  if (it == prefetched_images_.end())
+    return false;
+  bitmaps->swap(it->second->bitmaps);
+  delete it->second;
+  prefetched_images_.erase(it);
+  return true;
+}
+
+void ResourceBundle::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  if (level != base::MemoryPressureListener::MEMORY_PRESSURE_CRITICAL)
+    return;
+  base::AutoLock lock_scope(*prefetch_lock_);
+  // Images still being decoded are left to finish. GetImageNamed() loads the
+  // dropped ones from the data packs, as if they were never prefetched.
+  for (PrefetchedImageMap::iterator it = prefetched_images_.begin();
+       it != prefetched_images_.end();) {
+    if (it->second->decoded) {
+      delete it->second;
+      prefetched_images_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
 gfx::Image& ResourceBundle::GetEmptyImage() {
   base::AutoLock lock(*images_and_fonts_lock_);
 
@@ -9,11 +9,14 @@
 #include "build/build_config.h"
 
 #include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/file_path.h"
 #include "base/gtest_prod_util.h"
+#include "base/memory/memory_pressure_listener.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
 #include "base/string16.h"
@@ -27,8 +30,10 @@
 class SkBitmap;
 
 namespace base {
+class ConditionVariable;
 class Lock;
 class RefCountedStaticMemory;
+class RWLock;
 }
 
 namespace ui {
@@ -100,7 +105,8 @@ class UI_EXPORT ResourceBundle {
                                     base::StringPiece* value) = 0;
 
     // Retrieve a localized string. Return true if a string was provided or
-    // false to attempt retrieval of the default string.
+    // false to attempt retrieval of the default string. Each string is asked
+    // for once per locale; the ResourceBundle keeps the value.
     virtual bool GetLocalizedString(int message_id, string16* value) = 0;
 
     // Return a font resource or NULL to attempt retrieval of the default
@@ -184,6 +190,27 @@ class UI_EXPORT ResourceBundle {
   // Same as GetNativeImageNamed() except that RTL is not enabled.
   gfx::Image& GetNativeImageNamed(int resource_id);
 
+  // Starts decoding the images |resource_ids| from the data packs on worker
+  // threads, for each scale factor. GetImageNamed() then only waits for the
+  // images whose decoding hasn't finished. Images already loaded or being
+  // decoded are skipped. Call this after the data packs have been added.
+  // Decoded images that aren't asked for yet are dropped when memory is
+  // critically short, and loaded again when they are.
+  void PrefetchImages(const std::vector<int>& resource_ids);
+
+  // Returns the ids of the images loaded from the data packs so far, in the
+  // order they were first asked for. The list can be saved and passed to
+  // PrefetchImages() on the next startup.
+  std::vector<int> GetLoadedImageIDs() const;
+
+  // Starts recording the ids of the resources read from the data packs, in
+  // the order they are first read, for example for the length of startup.
+  // The list is meant for DataPack::WritePackOrdered().
+  void StartRecordingResourceIDs();
+
+  // Stops recording and returns the ids recorded.
+  std::vector<uint16> StopRecordingResourceIDs();
+
   // Loads the raw bytes of a data resource nearest the scale factor
   // |scale_factor| into |bytes|, without doing any processing or interpretation
   // of the resource. Use ResourceHandle::SCALE_FACTOR_NONE for non-image
@@ -202,6 +229,12 @@ class UI_EXPORT ResourceBundle {
   // string if the message_id is not found.
   string16 GetLocalizedString(int message_id);
 
+  // Like GetLocalizedString(), but returns the copy of the string the bundle
+  // keeps. Strings are converted from the locale pack the first time they are
+  // asked for, and the reference stays valid as long as the bundle, even
+  // across ReloadLocaleResources().
+  const string16& GetLocalizedStringRef(int message_id);
+
   // Returns the font for the specified style.
   const gfx::Font& GetFont(FontStyle style);
 
@@ -221,10 +254,16 @@ class UI_EXPORT ResourceBundle {
   FRIEND_TEST_ALL_PREFIXES(ResourceBundle, DelegateLoadDataResourceBytes);
   FRIEND_TEST_ALL_PREFIXES(ResourceBundle, DelegateGetRawDataResource);
   FRIEND_TEST_ALL_PREFIXES(ResourceBundle, DelegateGetLocalizedString);
+  FRIEND_TEST_ALL_PREFIXES(ResourceBundle, InternLocalizedStrings);
   FRIEND_TEST_ALL_PREFIXES(ResourceBundle, DelegateGetFont);
   FRIEND_TEST_ALL_PREFIXES(ResourceBundle, GetRawDataResource);
   FRIEND_TEST_ALL_PREFIXES(ResourceBundle, LoadDataResourceBytes);
   FRIEND_TEST_ALL_PREFIXES(ResourceBundle, LocaleDataPakExists);
+  FRIEND_TEST_ALL_PREFIXES(ResourceBundle, PrefetchImages);
+
+  // The bitmaps of an image being decoded by PrefetchImages().
+  struct PrefetchedImage;
+  typedef std::map<int, PrefetchedImage*> PrefetchedImageMap;
 
   // Ctor/dtor are private, since we're a singleton.
   explicit ResourceBundle(Delegate* delegate);
@@ -248,6 +287,14 @@ class UI_EXPORT ResourceBundle {
   // comments for ReloadLocaleResources().
   void UnloadLocaleResources();
 
+  // Sets the localized strings converted so far aside, for a new locale.
+  void RetireLocalizedStrings();
+
+  // Converts the localized string |message_id| from the locale pack into
+  // |string|. Returns false if it isn't found. |locale_resources_data_lock_|
+  // must be held.
+  bool LoadLocalizedString(int message_id, string16* string);
+
   // Initialize all the gfx::Font members if they haven't yet been initialized.
   void LoadFontsIfNecessary();
 
@@ -260,6 +307,23 @@ class UI_EXPORT ResourceBundle {
   // done.
   SkBitmap* LoadBitmap(const ResourceHandle& dll_inst, int resource_id);
 
+  // Records |resource_id| if StartRecordingResourceIDs() was called.
+  void RecordResourceID(int resource_id) const;
+
+  // Decodes the bitmaps of the prefetched image |resource_id|. Runs on a
+  // worker thread.
+  void DecodePrefetchedImage(int resource_id);
+
+  // If |resource_id| was prefetched, waits for its decoding to finish and
+  // moves the bitmaps, one per data pack, into |bitmaps|. Returns false if the
+  // image wasn't prefetched.
+  bool TakePrefetchedBitmaps(int resource_id, std::vector<SkBitmap>* bitmaps);
+
+  // Drops the decoded prefetched images under critical pressure. The loaded
+  // images stay, since callers keep references to them.
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+
   // Returns an empty image for when a resource cannot be loaded. This is a
   // bright red bitmap.
   gfx::Image& GetEmptyImage();
@@ -273,18 +337,59 @@ class UI_EXPORT ResourceBundle {
   // Protects |images_| and font-related members.
   scoped_ptr<base::Lock> images_and_fonts_lock_;
 
-  // Protects |locale_resources_data_|.
-  scoped_ptr<base::Lock> locale_resources_data_lock_;
+  // Protects |locale_resources_data_|.  Every localized string lookup reads
+  // it, from any thread, and only ReloadLocaleResources() writes it.
+  scoped_ptr<base::RWLock> locale_resources_data_lock_;
+
+  // Protects |localized_strings_| and |retired_localized_strings_|. Taken
+  // after |locale_resources_data_lock_| when both are.
+  scoped_ptr<base::Lock> localized_strings_lock_;
+
+  // Protects |prefetched_images_| and |pending_prefetch_count_|.
+  scoped_ptr<base::Lock> prefetch_lock_;
+
+  // Signaled each time a prefetched image has been decoded.
+  scoped_ptr<base::ConditionVariable> prefetch_decoded_;
+
+  // The images prefetched and not yet taken by GetImageNamed(). Owns the
+  // values.
+  PrefetchedImageMap prefetched_images_;
+
+  // The number of prefetched images still being decoded. The destructor waits
+  // for it to drop to 0, since the decoding reads the data packs.
+  int pending_prefetch_count_;
+
+  scoped_ptr<base::MemoryPressureListener> memory_pressure_listener_;
 
   // Handles for data sources.
   scoped_ptr<ResourceHandle> locale_resources_data_;
   ScopedVector<ResourceHandle> data_packs_;
 
+  // The localized strings of the loaded locale asked for so far. The strings
+  // of the locales unloaded before are kept, since references to them may
+  // still be in use.
+  typedef std::map<int, string16> LocalizedStringMap;
+  scoped_ptr<LocalizedStringMap> localized_strings_;
+  ScopedVector<LocalizedStringMap> retired_localized_strings_;
+
   // Cached images. The ResourceBundle caches all retrieved images and keeps
   // ownership of the pointers.
   typedef std::map<int, gfx::Image> ImageMap;
   ImageMap images_;
 
+  // The ids of the images loaded from the data packs, in load order. Protected
+  // by |images_and_fonts_lock_|.
+  std::vector<int> loaded_image_ids_;
+
+  // Protects the members below, which resources read on any thread update.
+  scoped_ptr<base::Lock> recording_lock_;
+
+  // Whether the ids of the resources read are recorded, the ids in the order
+  // they were first read, and the same ids for lookups.
+  bool recording_resource_ids_;
+  mutable std::vector<uint16> recorded_resource_ids_;
+  mutable std::set<uint16> recorded_resource_id_set_;
+
   gfx::Image empty_image_;
 
   // The various fonts used. Cached to avoid repeated GDI creation/destruction.
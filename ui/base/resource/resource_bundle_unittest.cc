@@ -15,6 +15,9 @@
 #include "testing/gtest/include/gtest/gtest.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "ui/base/layout.h"
+#include "ui/base/resource/data_pack.h"
+#include "ui/gfx/codec/png_codec.h"
+#include "ui/gfx/image/image_skia.h"
 
 using ::testing::_;
 using ::testing::Between;
@@ -207,6 +210,33 @@ TEST(ResourceBundle, DelegateGetLocalizedString) {
   EXPECT_EQ(data, result);
 }
 
+// Localized strings are kept for the locale, and references to them stay
+// valid when the locale changes.
+TEST(ResourceBundle, InternLocalizedStrings) {
+  MockResourceBundleDelegate delegate;
+  ResourceBundle resource_bundle(&delegate);
+
+  string16 data = ASCIIToUTF16("My test data");
+  int resource_id = 5;
+
+  EXPECT_CALL(delegate, GetLocalizedStringMock(resource_id))
+      .Times(2)
+      .WillRepeatedly(Return(data));
+
+  const string16& result = resource_bundle.GetLocalizedStringRef(resource_id);
+  EXPECT_EQ(data, result);
+  EXPECT_EQ(&result, &resource_bundle.GetLocalizedStringRef(resource_id));
+  EXPECT_EQ(data, resource_bundle.GetLocalizedString(resource_id));
+
+  // Loading other locale resources asks for the string again.
+  resource_bundle.LoadTestResources(FilePath(), FilePath());
+  const string16& reloaded_result =
+      resource_bundle.GetLocalizedStringRef(resource_id);
+  EXPECT_EQ(data, reloaded_result);
+  EXPECT_NE(&result, &reloaded_result);
+  EXPECT_EQ(data, result);
+}
+
 TEST(ResourceBundle, DelegateGetFont) {
   MockResourceBundleDelegate delegate;
   ResourceBundle resource_bundle(&delegate);
@@ -299,6 +329,64 @@ TEST(ResourceBundle, GetRawDataResource) {
   }
 }
 
+// Verifies that prefetched images are decoded from every pack and recorded.
+TEST(ResourceBundle, PrefetchImages) {
+  ScopedTempDir dir;
+  ASSERT_TRUE(dir.CreateUniqueTempDir());
+  FilePath locale_path = dir.path().Append(FILE_PATH_LITERAL("empty.pak"));
+  FilePath data_path = dir.path().Append(FILE_PATH_LITERAL("images.pak"));
+  FilePath data_2x_path = dir.path().Append(FILE_PATH_LITERAL("images_2x.pak"));
+
+  // Image 1 is in both packs, image 2 only in the 1x one.
+  std::vector<unsigned char> png_1x, png_2x;
+  SkBitmap bitmap;
+  bitmap.setConfig(SkBitmap::kARGB_8888_Config, 10, 10);
+  bitmap.allocPixels();
+  bitmap.eraseARGB(255, 0, 0, 255);
+  ASSERT_TRUE(gfx::PNGCodec::EncodeBGRASkBitmap(bitmap, false, &png_1x));
+  bitmap.setConfig(SkBitmap::kARGB_8888_Config, 20, 20);
+  bitmap.allocPixels();
+  bitmap.eraseARGB(255, 0, 0, 255);
+  ASSERT_TRUE(gfx::PNGCodec::EncodeBGRASkBitmap(bitmap, false, &png_2x));
+  base::StringPiece png_1x_piece(
+      reinterpret_cast<const char*>(&png_1x[0]), png_1x.size());
+  base::StringPiece png_2x_piece(
+      reinterpret_cast<const char*>(&png_2x[0]), png_2x.size());
+
+  std::map<uint16, base::StringPiece> resources;
+  resources[1] = png_1x_piece;
+  resources[2] = png_1x_piece;
+  ASSERT_TRUE(DataPack::WritePack(data_path, resources, DataPack::BINARY));
+  resources.clear();
+  resources[1] = png_2x_piece;
+  ASSERT_TRUE(DataPack::WritePack(data_2x_path, resources, DataPack::BINARY));
+  ASSERT_EQ(file_util::WriteFile(locale_path, kEmptyPakContents,
+      kEmptyPakSize), static_cast<int>(kEmptyPakSize));
+
+  {
+    ResourceBundle resource_bundle(NULL);
+    resource_bundle.LoadTestResources(data_path, locale_path);
+    resource_bundle.AddDataPack(data_2x_path, SCALE_FACTOR_200P);
+
+    std::vector<int> ids;
+    ids.push_back(2);
+    ids.push_back(1);
+    resource_bundle.PrefetchImages(ids);
+    // Asking again for images being decoded does nothing.
+    resource_bundle.PrefetchImages(ids);
+
+    const gfx::ImageSkia* image = resource_bundle.GetImageSkiaNamed(1);
+    EXPECT_EQ(10, image->width());
+    EXPECT_EQ(10, resource_bundle.GetImageSkiaNamed(2)->width());
+    EXPECT_TRUE(resource_bundle.prefetched_images_.empty());
+
+    std::vector<int> loaded_ids = resource_bundle.GetLoadedImageIDs();
+    ASSERT_EQ(2u, loaded_ids.size());
+    EXPECT_EQ(1, loaded_ids[0]);
+    EXPECT_EQ(2, loaded_ids[1]);
+  }
+}
+
 TEST(ResourceBundle, LocaleDataPakExists) {
   ResourceBundle resource_bundle(NULL);
 
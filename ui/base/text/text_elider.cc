@@ -9,9 +9,11 @@
 
 #include "ui/base/text/text_elider.h"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
+#include "base/basictypes.h"
 #include "base/file_path.h"
 #include "base/i18n/break_iterator.h"
 #include "base/i18n/char_iterator.h"
@@ -138,15 +140,36 @@ string16 ElideComponentizedPath(const string16& url_path_prefix,
   const string16 kEllipsisAndSlash = UTF8ToUTF16(kEllipsis) + kForwardSlash;
 
   CHECK(url_path_number_of_elements);
-  for (size_t i = url_path_number_of_elements - 1; i > 0; --i) {
-    string16 elided_path = BuildPathFromComponents(url_path_prefix,
-        url_path_elements, url_filename, i);
-    if (available_pixel_width >= font.GetStringWidth(elided_path))
-      return ElideText(elided_path + url_query,
-                       font, available_pixel_width, ELIDE_AT_END);
+  if (url_path_number_of_elements < 2)
+    return string16();
+
+  // The whole path has no ellipsis, so it is tried on its own.
+  string16 elided_path = BuildPathFromComponents(url_path_prefix,
+      url_path_elements, url_filename, url_path_number_of_elements - 1);
+  if (available_pixel_width < font.GetStringWidth(elided_path)) {
+    // Each component fewer makes the elided path shorter, so bisect for the
+    // most components that fit rather than measuring each count in turn.
+    size_t num_components = 0;
+    size_t lo = 1;
+    size_t hi = url_path_number_of_elements - 1;
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      string16 path = BuildPathFromComponents(url_path_prefix,
+          url_path_elements, url_filename, mid);
+      if (available_pixel_width >= font.GetStringWidth(path)) {
+        num_components = mid;
+        elided_path = path;
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    if (!num_components)
+      return string16();
   }
 
-  return string16();
+  return ElideText(elided_path + url_query,
+                   font, available_pixel_width, ELIDE_AT_END);
 }
 
 }  // namespace
@@ -488,16 +511,28 @@ string16 ElideText(const string16& text,
   if (current_text_pixel_width <= available_pixel_width)
     return text;
 
-  if (font.GetStringWidth(kEllipsisUTF16) > available_pixel_width)
+  const int ellipsis_pixel_width = font.GetStringWidth(kEllipsisUTF16);
+  if (ellipsis_pixel_width > available_pixel_width)
     return string16();
 
-  // Use binary search to compute the elided text.
+  // Find the longest cut that fits. We check the width of the whole desired
+  // string at once to ensure we handle kerning/ligatures/etc. correctly, so
+  // each probe costs a measurement. Rather than bisecting the whole text,
+  // start from the length the average character width predicts, which is
+  // usually off by a few characters, and widen the search from there in
+  // doubling steps. |lo| is the longest length known to fit and |hi| the
+  // shortest known not to; the cut of length 0 is at most the ellipsis.
   size_t lo = 0;
-  size_t hi = text.length() - 1;
-  size_t guess;
-  for (guess = (lo + hi) / 2; lo <= hi; guess = (lo + hi) / 2) {
-    // We check the length of the whole desired string at once to ensure we
-    // handle kerning/ligatures/etc. correctly.
+  size_t hi = text.length();
+  const int64 width_for_text = std::max(0,
+      available_pixel_width - (insert_ellipsis ? ellipsis_pixel_width : 0));
+  size_t guess = static_cast<size_t>(
+      width_for_text * static_cast<int64>(text.length()) /
+      current_text_pixel_width);
+  size_t step = 1;
+  while (hi - lo > 1) {
+    if (guess <= lo || guess >= hi)
+      guess = lo + (hi - lo) / 2;
     const string16 cut = slicer.CutString(guess, insert_ellipsis);
     const int guess_length = font.GetStringWidth(cut);
     // Check again that we didn't hit a Pango width overflow. If so, cut the
@@ -506,13 +541,17 @@ string16 ElideText(const string16& text,
       return ElideText(slicer.CutString(guess / 2, false),
                        font, available_pixel_width, elide_behavior);
     }
-    if (guess_length > available_pixel_width)
-      hi = guess - 1;
-    else
-      lo = guess + 1;
+    if (guess_length > available_pixel_width) {
+      hi = guess;
+      guess = guess > step ? guess - step : 0;
+    } else {
+      lo = guess;
+      guess += step;
+    }
+    step *= 2;
   }
 
-  return slicer.CutString(guess, insert_ellipsis);
+  return slicer.CutString(lo, insert_ellipsis);
 }
 
 SortedDisplayURL::SortedDisplayURL(const GURL& url,
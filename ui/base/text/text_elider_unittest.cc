@@ -320,6 +320,27 @@ TEST(TextEliderTest, ElideTextTruncate) {
   }
 }
 
+// Verifies ElideText() keeps as many characters as fit, whatever its first
+// guess at the length was.
+TEST(TextEliderTest, ElideTextLongestFit) {
+  const gfx::Font font;
+  const string16 kEllipsisStr = UTF8ToUTF16(kEllipsis);
+  const string16 text = ASCIIToUTF16(
+      "Wide WWWW and narrow iiii characters make the average width a poor "
+      "guess at how many of them fit");
+  const int full_width = font.GetStringWidth(text);
+
+  for (int width = full_width / 8; width < full_width; width += 7) {
+    const string16 result = ElideText(text, font, width, ELIDE_AT_END);
+    ASSERT_GE(result.length(), kEllipsisStr.length());
+    const size_t kept = result.length() - kEllipsisStr.length();
+    EXPECT_EQ(text.substr(0, kept) + kEllipsisStr, result);
+    EXPECT_LE(font.GetStringWidth(result), width);
+    EXPECT_GT(font.GetStringWidth(text.substr(0, kept + 1) + kEllipsisStr),
+              width);
+  }
+}
+
 // Checks that all occurrences of |first_char| are followed by |second_char| and
 // all occurrences of |second_char| are preceded by |first_char| in |text|.
 static void CheckSurrogatePairs(const string16& text,
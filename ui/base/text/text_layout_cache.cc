@@ -0,0 +1,168 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/base/text/text_layout_cache.h"
+
+#include "base/bind.h"
+#include "base/format_macros.h"
+#include "base/memory/singleton.h"
+#include "base/string_number_conversions.h"
+#include "base/stringprintf.h"
+#include "googleurl/src/gurl.h"
+#include "ui/gfx/canvas.h"
+#include "ui/gfx/font.h"
+
+namespace ui {
+
+namespace {
+
+// The most the entries may take, in bytes.
+const size_t kMaxCacheBytes = 1024 * 1024;
+
+// The cache is only used on the UI thread, so one shard is enough.
+const size_t kShardCount = 1;
+
+// The operations the cache remembers the results of.
+const char kSizeStringOp = 'S';
+const char kElideTextOp = 'T';
+const char kElideEmailOp = 'E';
+const char kElideUrlOp = 'U';
+
+}  // namespace
+
+size_t TextLayoutCache::LayoutCost::operator()(const Layout& layout) const {
+  return sizeof(Layout) + layout.key_size +
+      layout.text.size() * sizeof(char16);
+}
+
+// static
+TextLayoutCache* TextLayoutCache::GetInstance() {
+  return Singleton<TextLayoutCache>::get();
+}
+
+void TextLayoutCache::SizeStringInt(const string16& text,
+                                    const gfx::Font& font,
+                                    int* width,
+                                    int* height,
+                                    int flags) {
+  // The width and height passed in limit the size of multi-line text, so they
+  // are part of the key.
+  std::string key(MakeKey(kSizeStringOp, font, *width, *height,
+                          base::IntToString(flags), text));
+  Layout layout;
+  if (!cache_.Get(key, &layout)) {
+    layout.width = *width;
+    layout.height = *height;
+    gfx::Canvas::SizeStringInt(text, font, &layout.width, &layout.height,
+                               flags);
+    layout.key_size = key.size();
+    cache_.Put(key, layout);
+  }
+  *width = layout.width;
+  *height = layout.height;
+}
+
+string16 TextLayoutCache::ElideText(const string16& text,
+                                    const gfx::Font& font,
+                                    int available_pixel_width,
+                                    ElideBehavior elide_behavior) {
+  std::string key(MakeKey(kElideTextOp, font, available_pixel_width,
+                          elide_behavior, std::string(), text));
+  string16 elided;
+  if (!GetText(key, &elided)) {
+    elided = ui::ElideText(text, font, available_pixel_width, elide_behavior);
+    PutText(key, elided);
+  }
+  return elided;
+}
+
+string16 TextLayoutCache::ElideEmail(const string16& email,
+                                     const gfx::Font& font,
+                                     int available_pixel_width) {
+  std::string key(MakeKey(kElideEmailOp, font, available_pixel_width, 0,
+                          std::string(), email));
+  string16 elided;
+  if (!GetText(key, &elided)) {
+    elided = ui::ElideEmail(email, font, available_pixel_width);
+    PutText(key, elided);
+  }
+  return elided;
+}
+
+string16 TextLayoutCache::ElideUrl(const GURL& url,
+                                   const gfx::Font& font,
+                                   int available_pixel_width,
+                                   const std::string& languages) {
+  std::string key(MakeKey(kElideUrlOp, font, available_pixel_width, 0,
+                          languages + '|' + url.possibly_invalid_spec(),
+                          string16()));
+  string16 elided;
+  if (!GetText(key, &elided)) {
+    elided = ui::ElideUrl(url, font, available_pixel_width, languages);
+    PutText(key, elided);
+  }
+  return elided;
+}
+
+void TextLayoutCache::Clear() {
+  cache_.Clear();
+}
+
+base::ShardedMRUCacheStats TextLayoutCache::GetStats() const {
+  return cache_.GetStats();
+}
+
+TextLayoutCache::TextLayoutCache()
+    : cache_(kMaxCacheBytes, kShardCount, "TextLayoutCache") {
+  memory_pressure_listener_.reset(new base::MemoryPressureListener(
+      base::Bind(&TextLayoutCache::OnMemoryPressure, base::Unretained(this))));
+}
+
+TextLayoutCache::~TextLayoutCache() {
+}
+
+// static
+std::string TextLayoutCache::MakeKey(char op,
+                                     const gfx::Font& font,
+                                     int a,
+                                     int b,
+                                     const std::string& extra,
+                                     const string16& text) {
+  // The lengths of the strings of variable length are part of the key, so
+  // that no two keys run into each other.
+  std::string font_name(font.GetFontName());
+  std::string key(base::StringPrintf(
+      "%c|%d|%d|%d|%d|%" PRIuS "|%" PRIuS "|", op, font.GetFontSize(),
+      font.GetStyle(), a, b, font_name.size(), extra.size()));
+  key.reserve(key.size() + font_name.size() + extra.size() +
+              text.size() * sizeof(char16));
+  key.append(font_name);
+  key.append(extra);
+  key.append(reinterpret_cast<const char*>(text.data()),
+             text.size() * sizeof(char16));
+  return key;
+}
+
+bool TextLayoutCache::GetText(const std::string& key, string16* text) {
+  Layout layout;
+  if (!cache_.Get(key, &layout))
+    return false;
+  text->swap(layout.text);
+  return true;
+}
+
+void TextLayoutCache::PutText(const std::string& key, const string16& text) {
+  Layout layout;
+  layout.text = text;
+  layout.key_size = key.size();
+  cache_.Put(key, layout);
+}
+
+void TextLayoutCache::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  cache_.EvictToCost(base::MemoryPressureListener::GetTrimmedBudget(
+      kMaxCacheBytes, level));
+}
+
+}  // namespace ui
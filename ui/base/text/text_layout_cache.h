@@ -0,0 +1,120 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_BASE_TEXT_TEXT_LAYOUT_CACHE_H_
+#define UI_BASE_TEXT_TEXT_LAYOUT_CACHE_H_
+#pragma once
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/sharded_mru_cache.h"
+#include "base/string16.h"
+#include "ui/base/text/text_elider.h"
+#include "ui/base/ui_export.h"
+
+template <typename T> struct DefaultSingletonTraits;
+
+class GURL;
+
+namespace gfx {
+class Font;
+}
+
+namespace ui {
+
+// TextLayoutCache remembers the sizes gfx::Canvas::SizeStringInt() measures
+// and the strings the elide functions return, keyed by the text, the font,
+// the flags and the width. Labels, tabs and menus measure and elide the same
+// strings each time they are laid out and painted, and each of those runs the
+// platform's text shaping again.
+//
+// The cache is shared by the whole process and is limited by the bytes its
+// entries take, and trimmed to a share of those when memory is short. Its
+// hits, misses and evictions are exported as the StatsCounters
+// "TextLayoutCache.Hits", "TextLayoutCache.Misses" and
+// "TextLayoutCache.Evictions".
+class UI_EXPORT TextLayoutCache {
+ public:
+  static TextLayoutCache* GetInstance();
+
+  // Same as gfx::Canvas::SizeStringInt().
+  void SizeStringInt(const string16& text,
+                     const gfx::Font& font,
+                     int* width,
+                     int* height,
+                     int flags);
+
+  // Same as ui::ElideText().
+  string16 ElideText(const string16& text,
+                     const gfx::Font& font,
+                     int available_pixel_width,
+                     ElideBehavior elide_behavior);
+
+  // Same as ui::ElideEmail().
+  string16 ElideEmail(const string16& email,
+                      const gfx::Font& font,
+                      int available_pixel_width);
+
+  // Same as ui::ElideUrl().
+  string16 ElideUrl(const GURL& url,
+                    const gfx::Font& font,
+                    int available_pixel_width,
+                    const std::string& languages);
+
+  // Forgets all the entries, for example when the rendering settings of fonts
+  // change.
+  void Clear();
+
+  base::ShardedMRUCacheStats GetStats() const;
+
+ private:
+  friend struct DefaultSingletonTraits<TextLayoutCache>;
+
+  // The result of measuring or eliding a string.
+  struct Layout {
+    Layout() : width(0), height(0), key_size(0) {}
+
+    string16 text;
+    int width;
+    int height;
+    // The size of the key, which is charged to the entry.
+    size_t key_size;
+  };
+
+  struct LayoutCost {
+    size_t operator()(const Layout& layout) const;
+  };
+
+  TextLayoutCache();
+  ~TextLayoutCache();
+
+  // Returns the key for the operation |op| on |text| with |font|. |a|, |b|
+  // and |extra| are the other parameters of the operation.
+  static std::string MakeKey(char op,
+                             const gfx::Font& font,
+                             int a,
+                             int b,
+                             const std::string& extra,
+                             const string16& text);
+
+  // Looks up or stores elided text under |key|.
+  bool GetText(const std::string& key, string16* text);
+  void PutText(const std::string& key, const string16& text);
+
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+
+  base::ShardedMRUCache<std::string, Layout, LayoutCost> cache_;
+
+  scoped_ptr<base::MemoryPressureListener> memory_pressure_listener_;
+
+  DISALLOW_COPY_AND_ASSIGN(TextLayoutCache);
+};
+
+}  // namespace ui
+
+#endif  // UI_BASE_TEXT_TEXT_LAYOUT_CACHE_H_
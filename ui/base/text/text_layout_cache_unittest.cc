@@ -0,0 +1,68 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/base/text/text_layout_cache.h"
+
+#include "base/utf_string_conversions.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/gfx/canvas.h"
+#include "ui/gfx/font.h"
+
+namespace ui {
+
+// Verifies the cache returns what the functions it wraps return, and only
+// computes each result once.
+TEST(TextLayoutCacheTest, MatchesUncachedResults) {
+  TextLayoutCache* cache = TextLayoutCache::GetInstance();
+  cache->Clear();
+  const gfx::Font font;
+  const string16 text(ASCIIToUTF16("The quick brown fox"));
+  const int kWidth = font.GetStringWidth(text) / 2;
+
+  base::ShardedMRUCacheStats before = cache->GetStats();
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(ElideText(text, font, kWidth, ELIDE_IN_MIDDLE),
+              cache->ElideText(text, font, kWidth, ELIDE_IN_MIDDLE));
+    EXPECT_EQ(ElideText(text, font, kWidth, ELIDE_AT_END),
+              cache->ElideText(text, font, kWidth, ELIDE_AT_END));
+
+    const string16 email(ASCIIToUTF16("someone@example.com"));
+    EXPECT_EQ(ElideEmail(email, font, kWidth),
+              cache->ElideEmail(email, font, kWidth));
+
+    const GURL url("http://www.example.com/a/long/path");
+    EXPECT_EQ(ElideUrl(url, font, kWidth, std::string()),
+              cache->ElideUrl(url, font, kWidth, std::string()));
+
+    int expected_width = 0, expected_height = 0;
+    gfx::Canvas::SizeStringInt(text, font, &expected_width, &expected_height,
+                               gfx::Canvas::NO_ELLIPSIS);
+    int width = 0, height = 0;
+    cache->SizeStringInt(text, font, &width, &height,
+                         gfx::Canvas::NO_ELLIPSIS);
+    EXPECT_EQ(expected_width, width);
+    EXPECT_EQ(expected_height, height);
+  }
+  base::ShardedMRUCacheStats after = cache->GetStats();
+  EXPECT_EQ(5, after.misses - before.misses);
+  EXPECT_EQ(5, after.hits - before.hits);
+}
+
+// Verifies the font is part of the key.
+TEST(TextLayoutCacheTest, KeysOnFont) {
+  TextLayoutCache* cache = TextLayoutCache::GetInstance();
+  cache->Clear();
+  const gfx::Font font;
+  const gfx::Font bold_font(font.DeriveFont(4, gfx::Font::BOLD));
+  const string16 text(ASCIIToUTF16("Some text"));
+
+  int width = 0, height = 0;
+  cache->SizeStringInt(text, font, &width, &height, 0);
+  int bold_width = 0, bold_height = 0;
+  cache->SizeStringInt(text, bold_font, &bold_width, &bold_height, 0);
+  EXPECT_GT(bold_width, width);
+}
+
+}  // namespace ui
@@ -4,17 +4,44 @@
 
 #include "ui/base/text/utf16_indexing.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/third_party/icu/icu_utf.h"
 
 namespace ui {
 
-bool IsValidCodePointIndex(const string16& s, size_t index) {
+namespace {
+
+// The number of code units between two checkpoints of a UTF16IndexMap.
+const size_t kCheckpointInterval = 64;
+
+// Returns the number of UTF-8 bytes that s[index] accounts for.  As with code
+// point offsets, a surrogate pair is counted at its first half.
+size_t UTF8LengthAt(const base::StringPiece16& s, size_t index) {
+  char16 c = s[index];
+  if (c < 0x80)
+    return 1;
+  if (c < 0x800)
+    return 2;
+  if (!IsValidCodePointIndex(s, index))
+    return 0;
+  if (CBU16_IS_LEAD(c) && index + 1 < s.length() &&
+      CBU16_IS_TRAIL(s[index + 1]))
+    return 4;
+  return 3;
+}
+
+}  // namespace
+
+bool IsValidCodePointIndex(const base::StringPiece16& s, size_t index) {
   return index == 0 || index == s.length() ||
     !(CBU16_IS_TRAIL(s[index]) && CBU16_IS_LEAD(s[index - 1]));
 }
 
-ptrdiff_t UTF16IndexToOffset(const string16& s, size_t base, size_t pos) {
+ptrdiff_t UTF16IndexToOffset(const base::StringPiece16& s,
+                             size_t base,
+                             size_t pos) {
   // The indices point between UTF-16 words (range 0 to s.length() inclusive).
   // In order to consistently handle indices that point to the middle of a
   // surrogate pair, we count the first word in that surrogate pair and not
@@ -30,7 +57,9 @@ ptrdiff_t UTF16IndexToOffset(const string16& s, size_t base, size_t pos) {
   return delta;
 }
 
-size_t UTF16OffsetToIndex(const string16& s, size_t base, ptrdiff_t offset) {
+size_t UTF16OffsetToIndex(const base::StringPiece16& s,
+                          size_t base,
+                          ptrdiff_t offset) {
   DCHECK_LE(base, s.length());
   // As in UTF16IndexToOffset, we count the first half of a surrogate pair, not
   // the second. When stepping from pos to pos+1 we check s[pos:pos+1] == s[pos]
@@ -52,4 +81,116 @@ size_t UTF16OffsetToIndex(const string16& s, size_t base, ptrdiff_t offset) {
   return pos;
 }
 
+UTF16IndexMap::UTF16IndexMap() {
+  Invalidate(0);
+}
+
+UTF16IndexMap::~UTF16IndexMap() {
+}
+
+void UTF16IndexMap::Invalidate(size_t index) {
+  // The checkpoint at |index| counts s[index - 1], whose UTF-8 length depends
+  // on s[index], so it goes too.
+  size_t count = std::max<size_t>(
+      1, (index + kCheckpointInterval - 1) / kCheckpointInterval);
+  if (checkpoints_.size() > count) {
+    checkpoints_.resize(count);
+  } else if (checkpoints_.empty()) {
+    Checkpoint start = { 0, 0, 0 };
+    checkpoints_.push_back(start);
+  }
+}
+
+size_t UTF16IndexMap::IndexToOffset(const base::StringPiece16& s,
+                                    size_t index) {
+  DCHECK_LE(index, s.length());
+  const Checkpoint& checkpoint = CheckpointAtIndex(s, index);
+  size_t offset = checkpoint.offset;
+  for (size_t i = checkpoint.index; i < index; ++i)
+    offset += IsValidCodePointIndex(s, i) ? 1 : 0;
+  return offset;
+}
+
+size_t UTF16IndexMap::OffsetToIndex(const base::StringPiece16& s,
+                                    size_t offset) {
+  const Checkpoint& checkpoint =
+      CheckpointAtOrBefore(s, &Checkpoint::offset, offset);
+  size_t pos = checkpoint.index;
+  size_t remaining = offset - checkpoint.offset;
+  while (remaining > 0 && pos < s.length())
+    remaining -= IsValidCodePointIndex(s, pos++) ? 1 : 0;
+  // As in UTF16OffsetToIndex, an offset past the end is clamped in release.
+  DCHECK_EQ(0u, remaining);
+  if (!IsValidCodePointIndex(s, pos))
+    ++pos;
+  return pos;
+}
+
+size_t UTF16IndexMap::IndexToUTF8Offset(const base::StringPiece16& s,
+                                        size_t index) {
+  DCHECK_LE(index, s.length());
+  const Checkpoint& checkpoint = CheckpointAtIndex(s, index);
+  size_t utf8_offset = checkpoint.utf8_offset;
+  for (size_t i = checkpoint.index; i < index; ++i)
+    utf8_offset += UTF8LengthAt(s, i);
+  return utf8_offset;
+}
+
+size_t UTF16IndexMap::UTF8OffsetToIndex(const base::StringPiece16& s,
+                                        size_t utf8_offset) {
+  const Checkpoint& checkpoint =
+      CheckpointAtOrBefore(s, &Checkpoint::utf8_offset, utf8_offset);
+  size_t pos = checkpoint.index;
+  size_t walked = checkpoint.utf8_offset;
+  // A byte offset inside a character is taken to be the end of it, as
+  // g_utf8_pointer_to_offset() does.
+  while (walked < utf8_offset && pos < s.length())
+    walked += UTF8LengthAt(s, pos++);
+  DCHECK_GE(walked, utf8_offset);
+  if (!IsValidCodePointIndex(s, pos))
+    ++pos;
+  return pos;
+}
+
+const UTF16IndexMap::Checkpoint& UTF16IndexMap::CheckpointAtIndex(
+    const base::StringPiece16& s,
+    size_t index) {
+  size_t i = index / kCheckpointInterval;
+  while (checkpoints_.size() <= i)
+    AddCheckpoint(s);
+  return checkpoints_[i];
+}
+
+const UTF16IndexMap::Checkpoint& UTF16IndexMap::CheckpointAtOrBefore(
+    const base::StringPiece16& s,
+    size_t Checkpoint::* field,
+    size_t value) {
+  while (checkpoints_.back().*field < value &&
+         checkpoints_.back().index + kCheckpointInterval <= s.length())
+    AddCheckpoint(s);
+  // The fields grow with the index, so the checkpoints are sorted by each.
+  size_t low = 0;
+  size_t high = checkpoints_.size();
+  while (high - low > 1) {
+    size_t middle = low + (high - low) / 2;
+    if (checkpoints_[middle].*field <= value)
+      low = middle;
+    else
+      high = middle;
+  }
+  return checkpoints_[low];
+}
+
+void UTF16IndexMap::AddCheckpoint(const base::StringPiece16& s) {
+  Checkpoint checkpoint = checkpoints_.back();
+  size_t end = checkpoint.index + kCheckpointInterval;
+  DCHECK_LE(end, s.length());
+  for (size_t i = checkpoint.index; i < end; ++i) {
+    checkpoint.offset += IsValidCodePointIndex(s, i) ? 1 : 0;
+    checkpoint.utf8_offset += UTF8LengthAt(s, i);
+  }
+  checkpoint.index = end;
+  checkpoints_.push_back(checkpoint);
+}
+
 }  // namespace ui
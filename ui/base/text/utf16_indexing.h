@@ -6,14 +6,18 @@
 #define UI_BASE_TEXT_UTF16_INDEXING_H_
 #pragma once
 
-#include "base/string16.h"
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/string_piece.h"
 #include "ui/base/ui_export.h"
 
 namespace ui {
 
 // Returns false if s[index-1] is a high surrogate and s[index] is a low
 // surrogate, true otherwise.
-UI_EXPORT bool IsValidCodePointIndex(const string16& s, size_t index);
+UI_EXPORT bool IsValidCodePointIndex(const base::StringPiece16& s,
+                                     size_t index);
 
 // |UTF16IndexToOffset| returns the number of code points between |base| and
 // |pos| in the given string. |UTF16OffsetToIndex| returns the index that is
@@ -38,13 +42,63 @@ UI_EXPORT bool IsValidCodePointIndex(const string16& s, size_t index);
 //   Always,
 //     UTF16IndexToOffset(s, base, UTF16OffsetToIndex(s, base, ofs)) == ofs
 //     UTF16IndexToOffset(s, i, j) == -UTF16IndexToOffset(s, j, i)
-UI_EXPORT ptrdiff_t UTF16IndexToOffset(const string16& s,
+UI_EXPORT ptrdiff_t UTF16IndexToOffset(const base::StringPiece16& s,
                                        size_t base,
                                        size_t pos);
-UI_EXPORT size_t UTF16OffsetToIndex(const string16& s,
+UI_EXPORT size_t UTF16OffsetToIndex(const base::StringPiece16& s,
                                     size_t base,
                                     ptrdiff_t offset);
 
+// UTF16IndexMap converts between UTF-16 indices into a string, code point
+// offsets from its start, and byte offsets into its UTF-8 form, without
+// scanning from the start of the string every time.  It remembers the offsets
+// at a checkpoint every few dozen code units, built as far into the string as
+// the conversions need, and walks from the nearest one.  The conversions
+// agree with UTF16IndexToOffset(s, 0, index) and UTF16OffsetToIndex(s, 0,
+// offset), and the UTF-8 form is that of UTF16ToUTF8(), where an unpaired
+// surrogate becomes a three byte replacement character.
+//
+// The map does not keep the string; every call must pass the same string,
+// and Invalidate() must be told where each edit of it starts.
+class UI_EXPORT UTF16IndexMap {
+ public:
+  UTF16IndexMap();
+  ~UTF16IndexMap();
+
+  // Forgets the checkpoints that depend on the code units from |index| on.
+  void Invalidate(size_t index);
+
+  size_t IndexToOffset(const base::StringPiece16& s, size_t index);
+  size_t OffsetToIndex(const base::StringPiece16& s, size_t offset);
+  size_t IndexToUTF8Offset(const base::StringPiece16& s, size_t index);
+  size_t UTF8OffsetToIndex(const base::StringPiece16& s, size_t utf8_offset);
+
+ private:
+  struct Checkpoint {
+    size_t index;
+    size_t offset;
+    size_t utf8_offset;
+  };
+
+  // Returns the last checkpoint at or before |index|.
+  const Checkpoint& CheckpointAtIndex(const base::StringPiece16& s,
+                                      size_t index);
+
+  // Returns the last checkpoint whose |field| is at most |value|.
+  const Checkpoint& CheckpointAtOrBefore(const base::StringPiece16& s,
+                                         size_t Checkpoint::* field,
+                                         size_t value);
+
+  // Appends the checkpoint that follows the last one.
+  void AddCheckpoint(const base::StringPiece16& s);
+
+  // Checkpoint i is at index i * kCheckpointInterval.  The first one, at the
+  // start of the string, is always there.
+  std::vector<Checkpoint> checkpoints_;
+
+  DISALLOW_COPY_AND_ASSIGN(UTF16IndexMap);
+};
+
 }  // namespace ui
 
 #endif  // UI_BASE_TEXT_UTF16_INDEXING_H_
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/utf_string_conversions.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "ui/base/text/utf16_indexing.h"
 
@@ -29,4 +30,41 @@ TEST(UTF16IndexingTest, IndexOffsetConversions) {
   }
 }
 
+TEST(UTF16IndexingTest, IndexMap) {
+  // Long enough for several checkpoints, with surrogate pairs straddling
+  // their boundaries, unpaired surrogates and one, two and three byte
+  // characters.
+  const char16 pieces[][3] = {
+    {'a', 0}, {0xD83D, 0xDE00, 0}, {0x00E9, 0}, {0xDC00, 0}, {0x4E2D, 0},
+    {0xD800, 0}, {'b', 0},
+  };
+  string16 s;
+  for (size_t i = 0; s.length() < 500; ++i)
+    s += pieces[(i * 5 + i / 7) % arraysize(pieces)];
+
+  UTF16IndexMap map;
+  for (int pass = 0; pass < 2; ++pass) {
+    // The second pass edits the string, so the map must drop what follows.
+    if (pass == 1) {
+      s.replace(150, 3, pieces[1]);
+      map.Invalidate(150);
+    }
+    // Visit the indices out of order, so that later checkpoints are built
+    // before the conversions near the start are checked.
+    for (size_t n = 0; n <= s.length(); ++n) {
+      size_t i = (n * 193) % (s.length() + 1);
+      size_t offset = static_cast<size_t>(UTF16IndexToOffset(s, 0, i));
+      EXPECT_EQ(offset, map.IndexToOffset(s, i));
+      EXPECT_EQ(UTF16OffsetToIndex(s, 0, offset), map.OffsetToIndex(s, offset));
+
+      size_t utf8_offset = UTF16ToUTF8(s.substr(0, i)).length();
+      if (!IsValidCodePointIndex(s, i))
+        utf8_offset = UTF16ToUTF8(s.substr(0, i + 1)).length();
+      EXPECT_EQ(utf8_offset, map.IndexToUTF8Offset(s, i));
+      size_t valid_i = IsValidCodePointIndex(s, i) ? i : i + 1;
+      EXPECT_EQ(valid_i, map.UTF8OffsetToIndex(s, utf8_offset));
+    }
+  }
+}
+
 }  // namespace ui
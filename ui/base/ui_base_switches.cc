@@ -6,6 +6,9 @@
 
 namespace switches {
 
+// Lay text out in views with HarfBuzz instead of Pango or Uniscribe.
+const char kEnableHarfBuzzRenderText[] = "enable-harfbuzz-rendertext";
+
 // Let text glyphs have X-positions that aren't snapped to the pixel grid.
 const char kEnableTextSubpixelPositioning[] =
     "enable-text-subpixel-positioning";
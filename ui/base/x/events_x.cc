@@ -10,6 +10,7 @@
 #include <X11/Xlib.h>
 
 #include "base/command_line.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/message_pump_aurax11.h"
 #include "ui/base/keycodes/keyboard_code_conversion_x.h"
@@ -561,6 +562,117 @@ float GetTouchParamFromXEvent(XEvent* xev,
   return default_value;
 }
 
+// The classification of an XI2 event. Translating one event into a ui event
+// asks for its type several times, e.g. for its flags and its touch id, and
+// finding it out queries the touch device maps and the CMT valuators. So the
+// last event classified is remembered, and recognized by the fields X sets
+// anew for each event.
+class XI2EventClassifier {
+ public:
+  XI2EventClassifier() { Reset(); }
+
+  void Reset() {
+    memset(&key_, 0, sizeof(key_));
+    should_process_ = false;
+    touch_ = false;
+    type_ = ui::ET_UNKNOWN;
+  }
+
+  // Whether the event comes from a touch device.
+  bool IsTouch(const base::NativeEvent& native_event) {
+    Classify(native_event);
+    return touch_;
+  }
+
+  // The type of the event, ET_UNKNOWN if it shouldn't be processed.
+  ui::EventType GetType(const base::NativeEvent& native_event) {
+    Classify(native_event);
+    return should_process_ ? type_ : ui::ET_UNKNOWN;
+  }
+
+ private:
+  struct Key {
+    void* data;
+    unsigned long serial;
+    unsigned int cookie;
+    int evtype;
+    int sourceid;
+    int detail;
+    Time time;
+  };
+
+  void Classify(const base::NativeEvent& native_event) {
+    DCHECK_EQ(GenericEvent, native_event->type);
+    XIDeviceEvent* xievent =
+        static_cast<XIDeviceEvent*>(native_event->xcookie.data);
+    Key key;
+    memset(&key, 0, sizeof(key));
+    key.data = native_event->xcookie.data;
+    key.serial = native_event->xcookie.serial;
+    key.cookie = native_event->xcookie.cookie;
+    key.evtype = xievent->evtype;
+    key.sourceid = xievent->sourceid;
+    key.detail = xievent->detail;
+    key.time = xievent->time;
+    if (key_.data && !memcmp(&key, &key_, sizeof(key)))
+      return;
+
+    key_ = key;
+    ui::TouchFactory* factory = ui::TouchFactory::GetInstance();
+    should_process_ = factory->ShouldProcessXI2Event(native_event);
+    touch_ = factory->IsTouchDevice(xievent->sourceid);
+    type_ = should_process_ ? ComputeType(native_event, xievent) :
+                              ui::ET_UNKNOWN;
+  }
+
+  ui::EventType ComputeType(const base::NativeEvent& native_event,
+                            XIDeviceEvent* xievent) const {
+    if (touch_)
+      return GetTouchEventType(native_event);
+
+    switch (xievent->evtype) {
+      case XI_ButtonPress: {
+        int button = ui::EventButtonFromNative(native_event);
+        if (button >= kMinWheelButton && button <= kMaxWheelButton)
+          return ui::ET_MOUSEWHEEL;
+        return ui::ET_MOUSE_PRESSED;
+      }
+      case XI_ButtonRelease: {
+        int button = ui::EventButtonFromNative(native_event);
+        // Drop wheel events; we should've already scrolled on the press.
+        if (button >= kMinWheelButton && button <= kMaxWheelButton)
+          return ui::ET_UNKNOWN;
+        return ui::ET_MOUSE_RELEASED;
+      }
+      case XI_Motion: {
+        float vx, vy;
+        bool is_cancel;
+        if (ui::GetFlingData(native_event, &vx, &vy, &is_cancel)) {
+          return is_cancel ? ui::ET_SCROLL_FLING_CANCEL :
+                             ui::ET_SCROLL_FLING_START;
+        } else if (ui::GetScrollOffsets(native_event, NULL, NULL)) {
+          return ui::ET_SCROLL;
+        } else if (GetButtonMaskForX2Event(xievent)) {
+          return ui::ET_MOUSE_DRAGGED;
+        } else {
+          return ui::ET_MOUSE_MOVED;
+        }
+      }
+    }
+    return ui::ET_UNKNOWN;
+  }
+
+  Key key_;
+  bool should_process_;
+  bool touch_;
+  ui::EventType type_;
+
+  DISALLOW_COPY_AND_ASSIGN(XI2EventClassifier);
+};
+
+base::LazyInstance<XI2EventClassifier>::Leaky g_xi2_event_classifier =
+    LAZY_INSTANCE_INITIALIZER;
+
 Atom GetNoopEventAtom() {
   return XInternAtom(
       base::MessagePumpAuraX11::GetDefaultXDisplay(),
@@ -631,6 +743,7 @@ void UpdateDeviceList() {
   CMTEventData::GetInstance()->UpdateDeviceList(display);
   TouchFactory::GetInstance()->UpdateDeviceList(display);
   ValuatorTracker::GetInstance()->SetupValuator();
+  g_xi2_event_classifier.Get().Reset();
 }
 
 EventType EventTypeFromNative(const base::NativeEvent& native_event) {
@@ -659,45 +772,8 @@ EventType EventTypeFromNative(const base::NativeEvent& native_event) {
       return ET_MOUSE_ENTERED;
     case LeaveNotify:
       return ET_MOUSE_EXITED;
-    case GenericEvent: {
-      TouchFactory* factory = TouchFactory::GetInstance();
-      if (!factory->ShouldProcessXI2Event(native_event))
-        return ET_UNKNOWN;
-
-      XIDeviceEvent* xievent =
-          static_cast<XIDeviceEvent*>(native_event->xcookie.data);
-
-      if (factory->IsTouchDevice(xievent->sourceid))
-        return GetTouchEventType(native_event);
-
-      switch (xievent->evtype) {
-        case XI_ButtonPress: {
-          int button = EventButtonFromNative(native_event);
-          if (button >= kMinWheelButton && button <= kMaxWheelButton)
-            return ET_MOUSEWHEEL;
-          return ET_MOUSE_PRESSED;
-        }
-        case XI_ButtonRelease: {
-          int button = EventButtonFromNative(native_event);
-          // Drop wheel events; we should've already scrolled on the press.
-          if (button >= kMinWheelButton && button <= kMaxWheelButton)
-            return ET_UNKNOWN;
-          return ET_MOUSE_RELEASED;
-        }
-        case XI_Motion: {
-          float vx, vy;
-          bool is_cancel;
-          if (GetFlingData(native_event, &vx, &vy, &is_cancel)) {
-            return is_cancel ? ET_SCROLL_FLING_CANCEL : ET_SCROLL_FLING_START;
-          } else if (GetScrollOffsets(native_event, NULL, NULL))
-            return ET_SCROLL;
-          else if (GetButtonMaskForX2Event(xievent)) {
-            return ET_MOUSE_DRAGGED;
-          } else
-            return ET_MOUSE_MOVED;
-        }
-      }
-    }
+    case GenericEvent:
+      return g_xi2_event_classifier.Get().GetType(native_event);
     default:
       break;
   }
@@ -725,8 +801,7 @@ int EventFlagsFromNative(const base::NativeEvent& native_event) {
       XIDeviceEvent* xievent =
           static_cast<XIDeviceEvent*>(native_event->xcookie.data);
 
-      const bool touch =
-          TouchFactory::GetInstance()->IsTouchDevice(xievent->sourceid);
+      const bool touch = g_xi2_event_classifier.Get().IsTouch(native_event);
       switch (xievent->evtype) {
         case XI_ButtonPress:
         case XI_ButtonRelease: {
@@ -6,6 +6,8 @@
 
 #include <X11/extensions/XInput2.h>
 
+#include <algorithm>
+
 #include "ui/base/x/x11_util.h"
 #include "ui/base/touch/touch_factory.h"
 
@@ -95,16 +97,10 @@ bool ValuatorTracker::ExtractValuator(const XEvent& xev,
   XIDeviceEvent* xiev = static_cast<XIDeviceEvent*>(xev.xcookie.data);
   if (xiev->sourceid >= kMaxDeviceNum || xiev->deviceid >= kMaxDeviceNum)
     return false;
-  int val_index = valuator_lookup_[xiev->sourceid][val];
-  if (val_index >= 0) {
-    if (XIMaskIsSet(xiev->valuators.mask, val_index)) {
-      double* valuators = xiev->valuators.values;
-      while (val_index--) {
-        if (XIMaskIsSet(xiev->valuators.mask, val_index))
-          ++valuators;
-      }
-      *value = *valuators;
-      last_seen_valuator_[xiev->deviceid][val] = *value;
+  if (valuator_lookup_[xiev->sourceid][val] >= 0) {
+    DecodeValuators(xev);
+    if (decoded_.found & (1 << val)) {
+      *value = decoded_.values[val];
       return true;
     } else {
       *value = last_seen_valuator_[xiev->deviceid][val];
@@ -147,8 +143,46 @@ bool ValuatorTracker::GetValuatorRange(unsigned int deviceid,
   return false;
 }
 
+void ValuatorTracker::DecodeValuators(const XEvent& xev) {
+  XIDeviceEvent* xiev = static_cast<XIDeviceEvent*>(xev.xcookie.data);
+  if (decoded_.data == xev.xcookie.data &&
+      decoded_.serial == xev.xcookie.serial &&
+      decoded_.cookie == xev.xcookie.cookie &&
+      decoded_.sourceid == xiev->sourceid &&
+      decoded_.time == xiev->time)
+    return;
+
+  decoded_.data = xev.xcookie.data;
+  decoded_.serial = xev.xcookie.serial;
+  decoded_.cookie = xev.xcookie.cookie;
+  decoded_.sourceid = xiev->sourceid;
+  decoded_.time = xiev->time;
+  decoded_.found = 0;
+
+  // The values are packed: the n-th value is the one of the n-th valuator
+  // set in the mask.
+  const signed char* types = valuator_type_[xiev->sourceid];
+  int limit = std::min(valuator_limit_[xiev->sourceid],
+                       xiev->valuators.mask_len * 8);
+  double* values = xiev->valuators.values;
+  for (int i = 0; i < limit; ++i) {
+    if (!XIMaskIsSet(xiev->valuators.mask, i))
+      continue;
+    int type = types[i];
+    if (type >= 0) {
+      decoded_.values[type] = *values;
+      decoded_.found |= 1 << type;
+      last_seen_valuator_[xiev->deviceid][type] = *values;
+    }
+    ++values;
+  }
+}
+
 void ValuatorTracker::SetupValuator() {
   memset(valuator_lookup_, -1, sizeof(valuator_lookup_));
+  memset(valuator_type_, -1, sizeof(valuator_type_));
+  memset(valuator_limit_, 0, sizeof(valuator_limit_));
+  memset(&decoded_, 0, sizeof(decoded_));
   memset(valuator_min_, 0, sizeof(valuator_min_));
   memset(valuator_max_, 0, sizeof(valuator_max_));
   memset(last_seen_valuator_, 0, sizeof(last_seen_valuator_));
@@ -167,8 +201,11 @@ void ValuatorTracker::SetupValuator() {
     for (int j = 0; j < VAL_LAST_ENTRY; j++) {
       Valuator val = static_cast<Valuator>(j);
       XIValuatorClassInfo* valuator = FindValuator(display, info, val);
-      if (valuator) {
+      if (valuator && valuator->number < kMaxValuatorNum) {
         valuator_lookup_[info->deviceid][j] = valuator->number;
+        valuator_type_[info->deviceid][valuator->number] = j;
+        valuator_limit_[info->deviceid] =
+            std::max(valuator_limit_[info->deviceid], valuator->number + 1);
         valuator_min_[info->deviceid][j] = valuator->min;
         valuator_max_[info->deviceid][j] = valuator->max;
       }
@@ -63,6 +63,8 @@ class ValuatorTracker {
   // Extract the Valuator from the XEvent. Return true and the value is set
   // if the Valuator is found, false and value unchanged if the Valuator
   // is not found.
+  // All the valuators of an event are decoded by the first call for it, the
+  // following calls for the same event only look them up.
   bool ExtractValuator(const XEvent& xev, Valuator val, float* value);
 
   // Normalize the Valuator with value on deviceid to fall into [0, 1].
@@ -87,6 +89,25 @@ class ValuatorTracker {
   friend struct DefaultSingletonTraits<ValuatorTracker>;
 
   static const int kMaxDeviceNum = 128;
+  // Valuator numbers are stored in signed chars.
+  static const int kMaxValuatorNum = 128;
+
+  // The valuators of the last event decoded, and the fields X sets anew for
+  // each event to recognize it by.
+  struct DecodedEvent {
+    void* data;
+    unsigned long serial;
+    unsigned int cookie;
+    int sourceid;
+    unsigned long time;
+    // Bit (1 << Valuator) is set for each Valuator found in the event.
+    unsigned int found;
+    float values[VAL_LAST_ENTRY];
+  };
+
+  // Decodes the valuators of |xev| into |decoded_| in one pass over its
+  // valuator mask, unless it is the event decoded last.
+  void DecodeValuators(const XEvent& xev);
 
   // Index table to find the valuator for the Valuator on the specific device
   // by valuator_lookup_[device_id][valuator]. Use 2-D array to get fast
@@ -95,6 +116,14 @@ class ValuatorTracker {
   // hash map.
   signed char valuator_lookup_[kMaxDeviceNum][VAL_LAST_ENTRY];
 
+  // The reverse of |valuator_lookup_|: the Valuator for a valuator number on
+  // a device, -1 for the valuators that aren't tracked.
+  signed char valuator_type_[kMaxDeviceNum][kMaxValuatorNum];
+
+  // One past the highest valuator number tracked on a device. Decoding stops
+  // there.
+  int valuator_limit_[kMaxDeviceNum];
+
   // Index table to find the min & max value of the Valuator on a specific
   // device.
   int valuator_min_[kMaxDeviceNum][VAL_LAST_ENTRY];
@@ -105,6 +134,8 @@ class ValuatorTracker {
   // event.
   float last_seen_valuator_[kMaxDeviceNum][VAL_LAST_ENTRY];
 
+  DecodedEvent decoded_;
+
   DISALLOW_COPY_AND_ASSIGN(ValuatorTracker);
 };
 
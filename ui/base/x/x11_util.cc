@@ -302,6 +302,191 @@ class XButtonMap {
   DISALLOW_COPY_AND_ASSIGN(XButtonMap);
 };
 
+// Images with fewer pixels than this are cheaper to send through the X
+// socket than through shared memory.
+const int kMinSharedMemoryImagePixels = 64 * 64;
+
+// Writes the |width| x |height| pixels at |src_x|, |src_y| of the ARGB |data|,
+// whose rows are |data_width| pixels long, to the data of |image|, converting
+// them to its format.  As in PutARGBImage(), a 32-bit format that isn't ARGB
+// is taken to be ABGR.
+void CopyARGBPixelsToImage(const uint8* data, int data_width,
+                           int src_x, int src_y, int width, int height,
+                           XImage* image) {
+  for (int y = 0; y < height; ++y) {
+    const uint32_t* in = reinterpret_cast<const uint32_t*>(data) +
+        (src_y + y) * data_width + src_x;
+    char* out = image->data + y * image->bytes_per_line;
+    if (image->bits_per_pixel == 16) {
+      uint16_t* out16 = reinterpret_cast<uint16_t*>(out);
+      for (int x = 0; x < width; ++x) {
+        out16[x] = ((in[x] >> 8) & 0xf800) |
+                   ((in[x] >> 5) & 0x07e0) |
+                   ((in[x] >> 3) & 0x001f);
+      }
+    } else if (image->red_mask == 0xff0000 && image->blue_mask == 0xff) {
+      memcpy(out, in, width * 4);
+    } else {
+      uint8_t* out8 = reinterpret_cast<uint8_t*>(out);
+      for (int x = 0; x < width; ++x) {
+        out8[0] = (in[x] >> 16) & 0xff;  // Red
+        out8[1] = (in[x] >> 8) & 0xff;   // Green
+        out8[2] = in[x] & 0xff;          // Blue
+        out8[3] = (in[x] >> 24) & 0xff;  // Alpha
+        out8 += 4;
+      }
+    }
+  }
+}
+
+// Shared memory segments that PutARGBImage() draws large images through with
+// XShmPutImage, so that their pixels are not copied through the X socket.
+// Like TransportDIB, a segment is SysV shared memory that is marked for
+// removal once the X server has attached it.  A few segments are kept per
+// display and used in turn; a segment is only written again once the server
+// has processed the request that read it.  Displays that can't attach our
+// shared memory, such as remote ones, are never given a segment, and
+// PutARGBImage() uses XPutImage for them.
+class XSharedMemoryImagePool {
+ public:
+  static XSharedMemoryImagePool* GetInstance() {
+    return Singleton<XSharedMemoryImagePool,
+                     LeakySingletonTraits<XSharedMemoryImagePool> >::get();
+  }
+
+  // Puts the |width| x |height| pixels at |src_x|, |src_y| of |data| at
+  // |dst_x|, |dst_y| in |pixmap|.  Returns false, having drawn nothing, if
+  // shared memory can't be used.
+  bool PutImage(Display* display,
+                Visual* visual, int depth, int pixmap_bpp,
+                XID pixmap, GC gc,
+                const uint8* data, int data_width,
+                int src_x, int src_y,
+                int dst_x, int dst_y,
+                int width, int height) {
+    if (QuerySharedMemorySupport(display) == SHARED_MEMORY_NONE)
+      return false;
+    DisplaySegments& segments = displays_[display];
+    if (segments.disabled)
+      return false;
+
+    Segment& segment = segments.segments[segments.next];
+    XImage* image = XShmCreateImage(display, visual, depth, ZPixmap, NULL,
+                                    &segment.info, width, height);
+    if (!image)
+      return false;
+    if (image->bits_per_pixel != pixmap_bpp ||
+        (pixmap_bpp != 16 && pixmap_bpp != 32)) {
+      XDestroyImage(image);
+      return false;
+    }
+
+    WaitForSegment(display, &segment);
+    size_t size = static_cast<size_t>(image->bytes_per_line) * height;
+    if (segment.size < size) {
+      FreeSegment(display, &segment);
+      if (!AllocateSegment(display, size, &segment)) {
+        // Don't pay for failing system calls on every image.
+        segments.disabled = true;
+        XDestroyImage(image);
+        return false;
+      }
+    }
+
+    image->data = segment.info.shmaddr;
+    CopyARGBPixelsToImage(data, data_width, src_x, src_y, width, height,
+                          image);
+    segment.serial = NextRequest(display);
+    XShmPutImage(display, pixmap, gc, image, 0, 0, dst_x, dst_y,
+                 width, height, False);
+    segments.next = (segments.next + 1) % kSegmentsPerDisplay;
+
+    // The data belongs to the segment.
+    image->data = NULL;
+    XDestroyImage(image);
+    return true;
+  }
+
+ private:
+  friend struct DefaultSingletonTraits<XSharedMemoryImagePool>;
+
+  static const int kSegmentsPerDisplay = 2;
+
+  struct Segment {
+    Segment() : size(0), serial(0) {
+      memset(&info, 0, sizeof(info));
+    }
+
+    XShmSegmentInfo info;
+    size_t size;
+    // The request that last read the segment.
+    unsigned long serial;
+  };
+
+  struct DisplaySegments {
+    DisplaySegments() : next(0), disabled(false) {}
+
+    Segment segments[kSegmentsPerDisplay];
+    int next;
+    bool disabled;
+  };
+
+  XSharedMemoryImagePool() {}
+  ~XSharedMemoryImagePool() {}
+
+  // Blocks until the X server is done with |segment|.
+  static void WaitForSegment(Display* display, Segment* segment) {
+    if (segment->size &&
+        LastKnownRequestProcessed(display) < segment->serial) {
+      XSync(display, False);
+    }
+  }
+
+  static bool AllocateSegment(Display* display, size_t size,
+                              Segment* segment) {
+    int shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (shmid == -1)
+      return false;
+    void* address = shmat(shmid, NULL, 0);
+    if (address == reinterpret_cast<void*>(-1)) {
+      shmctl(shmid, IPC_RMID, NULL);
+      return false;
+    }
+
+    segment->info.shmid = shmid;
+    segment->info.shmaddr = static_cast<char*>(address);
+    segment->info.readOnly = True;
+    gdk_error_trap_push();
+    bool attached = XShmAttach(display, &segment->info);
+    XSync(display, False);
+    if (gdk_error_trap_pop())
+      attached = false;
+    // The server has attached the segment, or failed to; either way it can
+    // go away with the last of its users.
+    shmctl(shmid, IPC_RMID, NULL);
+    if (!attached) {
+      shmdt(address);
+      *segment = Segment();
+      return false;
+    }
+    segment->size = size;
+    segment->serial = 0;
+    return true;
+  }
+
+  static void FreeSegment(Display* display, Segment* segment) {
+    if (!segment->size)
+      return;
+    XShmDetach(display, &segment->info);
+    shmdt(segment->info.shmaddr);
+    *segment = Segment();
+  }
+
+  std::map<Display*, DisplaySegments> displays_;
+
+  DISALLOW_COPY_AND_ASSIGN(XSharedMemoryImagePool);
+};
+
 }  // namespace
 
 bool XDisplayExists() {
@@ -886,6 +1071,15 @@ void PutARGBImage(Display* display,
   // parameter.
   int pixmap_bpp = BitsPerPixelForPixmapDepth(display, depth);
 
+  if (copy_width * copy_height >= kMinSharedMemoryImagePixels &&
+      XSharedMemoryImagePool::GetInstance()->PutImage(
+          display, static_cast<Visual*>(visual), depth, pixmap_bpp,
+          pixmap, static_cast<GC>(pixmap_gc),
+          data, data_width, src_x, src_y, dst_x, dst_y,
+          copy_width, copy_height)) {
+    return;
+  }
+
   XImage image;
   memset(&image, 0, sizeof(image));
 
@@ -4,22 +4,39 @@
 
 #include "ui/compositor/compositor.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "base/bind.h"
 #include "base/command_line.h"
+#include "base/debug/trace_event.h"
+#include "base/lazy_instance.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/message_loop.h"
+#include "base/path_service.h"
+#include "base/sys_info.h"
 #include "base/threading/thread_restrictions.h"
+#include "base/threading/worker_pool.h"
+#include "skia/ext/image_operations.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/WebCompositor.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebFloatPoint.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebRect.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebSize.h"
 #include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkGraphics.h"
 #include "third_party/skia/include/images/SkImageEncoder.h"
 #include "ui/compositor/compositor_observer.h"
 #include "ui/compositor/compositor_switches.h"
 #include "ui/compositor/dip_util.h"
+#include "ui/compositor/frame_breakdown_hud.h"
 #include "ui/compositor/layer.h"
 #include "ui/compositor/test_web_graphics_context_3d.h"
 #include "ui/gl/gl_context.h"
 #include "ui/gl/gl_implementation.h"
+#include "ui/gl/gl_program_cache.h"
+#include "ui/gl/gl_state_cache.h"
 #include "ui/gl/gl_surface.h"
+#include "ui/gl/gl_switches.h"
 #include "webkit/glue/webthread_impl.h"
 #include "webkit/gpu/webgraphicscontext3d_in_process_impl.h"
 
@@ -27,17 +44,125 @@
 #include "base/chromeos/chromeos_version.h"
 #endif
 
+#if defined(OS_WIN)
+#include "base/base_paths_win.h"
+#endif
+
 namespace {
 
 const double kDefaultRefreshRate = 60.0;
 const double kTestRefreshRate = 100.0;
 
+// The textures of the layers of a compositor may use up to this share of the
+// physical memory, and never more than kMaxTextureMemoryBudgetMB.
+const int kTextureMemoryBudgetDivisor = 16;
+const int kMaxTextureMemoryBudgetMB = 256;
+
+// The layers that paint in tiles repaint at most this many tiles per frame,
+// together.
+const int kMaxTilesPaintedPerFrame = 16;
+
+// The tiles rasterized on workers are handed to the compositor for upload at
+// most this many bytes per frame, together, so that a burst of them doesn't
+// stall a frame. It is as many bytes as kMaxTilesPaintedPerFrame full tiles.
+const size_t kMaxUploadBytesPerFrame = 4 * 1024 * 1024;
+
+// Skia keeps the glyph masks it rasterizes in a cache of up to this size for
+// text drawn at a device scale factor of 1. Glyphs that don't fit are
+// rasterized again each time text-heavy layers repaint, for example on every
+// step of a scroll.
+const size_t kGlyphCacheBytes = 4 * 1024 * 1024;
+
+// Grows Skia's glyph cache for text drawn at |scale|. Masks grow with the
+// square of the scale factor. The cache is shared by all compositors, so it
+// is never shrunk.
+void EnsureGlyphCacheFitsScale(float scale) {
+  size_t limit = static_cast<size_t>(kGlyphCacheBytes * scale * scale);
+  if (SkGraphics::GetFontCacheLimit() < limit)
+    SkGraphics::SetFontCacheLimit(limit);
+}
+
 webkit_glue::WebThreadImpl* g_compositor_thread = NULL;
 
 bool test_compositor_enabled = false;
 
 ui::ContextFactory* g_context_factory = NULL;
 
+// The nesting depth of ScopedDrawBatch, and the compositors that were asked
+// to draw during the outermost batch.
+int g_draw_batch_depth = 0;
+base::LazyInstance<std::vector<ui::Compositor*> >::Leaky g_batched_compositors =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Redraws are aligned to the default refresh rate until the compositor is told
+// otherwise. The test compositor draws as soon as asked.
+base::TimeDelta GetDefaultVSyncInterval() {
+  if (test_compositor_enabled)
+    return base::TimeDelta();
+  return base::TimeDelta::FromMicroseconds(static_cast<int64>(
+      base::Time::kMicrosecondsPerSecond / kDefaultRefreshRate));
+}
+
+// The compositor only swaps the damaged part of a frame when the GL surface
+// supports GL_CHROMIUM_post_sub_buffer (glXCopySubBufferMESA,
+// eglPostSubBufferNV), and falls back to full swaps otherwise.
+bool IsPartialSwapEnabled() {
+  return !CommandLine::ForCurrentProcess()->HasSwitch(
+      switches::kUIDisablePartialSwap);
+}
+
+// Tells |callback| that its pixels could not be read.
+void FailReadPixels(const ui::Compositor::ReadPixelsCallback& callback) {
+  MessageLoop::current()->PostTask(FROM_HERE,
+                                   base::Bind(callback, false, SkBitmap()));
+}
+
+// Copies |src_rect| of the |frame_size| pixels read back, which are RGBA and
+// bottom up as GL returns them, into |bitmap| as BGRA and top down, then
+// scales it to |dest_size|. Runs on a worker thread.
+void ConvertReadbackPixels(scoped_refptr<base::RefCountedBytes> pixels,
+                           const gfx::Size& frame_size,
+                           const gfx::Rect& src_rect,
+                           const gfx::Size& dest_size,
+                           SkBitmap* bitmap) {
+  TRACE_EVENT0("ui", "ConvertReadbackPixels");
+  SkBitmap copy;
+  copy.setConfig(SkBitmap::kARGB_8888_Config,
+                 src_rect.width(), src_rect.height());
+  copy.allocPixels();
+  {
+    SkAutoLockPixels lock(copy);
+    size_t src_row_bytes = 4 * frame_size.width();
+    for (int y = 0; y < src_rect.height(); ++y) {
+      int src_row = frame_size.height() - 1 - (src_rect.y() + y);
+      const unsigned char* src =
+          pixels->front() + src_row * src_row_bytes + 4 * src_rect.x();
+      unsigned char* dest =
+          reinterpret_cast<unsigned char*>(copy.getAddr32(0, y));
+      for (int x = 0; x < src_rect.width(); ++x, src += 4, dest += 4) {
+        dest[0] = src[2];
+        dest[1] = src[1];
+        dest[2] = src[0];
+        dest[3] = src[3];
+      }
+    }
+  }
+
+  if (dest_size == src_rect.size()) {
+    *bitmap = copy;
+    return;
+  }
+  *bitmap = skia::ImageOperations::Resize(copy,
+                                          skia::ImageOperations::RESIZE_GOOD,
+                                          dest_size.width(),
+                                          dest_size.height());
+}
+
+void RunReadPixelsCallback(const ui::Compositor::ReadPixelsCallback& callback,
+                           SkBitmap* bitmap) {
+  callback.Run(true, *bitmap);
+}
+
 }  // anonymous namespace
 
 namespace ui {
@@ -61,6 +186,13 @@ void ContextFactory::SetInstance(ContextFactory* instance) {
   g_context_factory = instance;
 }
 
+size_t ContextFactory::GetTextureMemoryBudget(Compositor* compositor) {
+  int budget_mb = std::min(
+      base::SysInfo::AmountOfPhysicalMemoryMB() / kTextureMemoryBudgetDivisor,
+      kMaxTextureMemoryBudgetMB);
+  return static_cast<size_t>(budget_mb) * 1024 * 1024;
+}
+
 DefaultContextFactory::DefaultContextFactory() {
 }
 
@@ -77,6 +209,33 @@ bool DefaultContextFactory::Initialize() {
     LOG(ERROR) << "Could not load the GL bindings";
     return false;
   }
+
+  // The compositors of all the root windows then draw with one real context,
+  // which they switch to without a context switch in the driver, and share
+  // their textures.
+  if (CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kUIEnableVirtualGLContexts)) {
+    if (!share_group_.get())
+      share_group_ = new gfx::GLShareGroup;
+    share_group_->SetVirtualized(true);
+  }
+
+  // The binaries of the compositor's programs are kept across runs, so that
+  // the first frame doesn't wait for its shaders to compile.
+  if (!CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kUIDisableProgramCache)) {
+    FilePath cache_path;
+#if defined(OS_WIN)
+    bool has_cache_path = PathService::Get(base::DIR_LOCAL_APP_DATA,
+                                           &cache_path);
+#else
+    bool has_cache_path = PathService::Get(base::DIR_CACHE, &cache_path);
+#endif
+    if (has_cache_path) {
+      gfx::GLProgramCache::Initialize(
+          cache_path.Append(FILE_PATH_LITERAL("ui_gl_program_cache")));
+    }
+  }
   return true;
 }
 
@@ -118,6 +277,44 @@ WebKit::WebGraphicsContext3D* DefaultContextFactory::CreateContextCommon(
   return context;
 }
 
+HeadlessContextFactory::HeadlessContextFactory() {
+}
+
+HeadlessContextFactory::~HeadlessContextFactory() {
+}
+
+bool HeadlessContextFactory::Initialize() {
+  // OSMesa renders in software and needs no display.
+  CommandLine* command_line = CommandLine::ForCurrentProcess();
+  if (!command_line->HasSwitch(switches::kUseGL)) {
+    command_line->AppendSwitchASCII(switches::kUseGL,
+                                    gfx::kGLImplementationOSMesaName);
+  }
+  base::ThreadRestrictions::ScopedAllowIO allow_io;
+  if (!gfx::GLSurface::InitializeOneOff() ||
+      gfx::GetGLImplementation() == gfx::kGLImplementationNone) {
+    LOG(ERROR) << "Could not load the GL bindings";
+    return false;
+  }
+  return true;
+}
+
+WebKit::WebGraphicsContext3D* HeadlessContextFactory::CreateContext(
+    Compositor* compositor) {
+  return CreateOffscreenContext(compositor);
+}
+
+WebKit::WebGraphicsContext3D* HeadlessContextFactory::CreateOffscreenContext(
+    Compositor* compositor) {
+  WebKit::WebGraphicsContext3D::Attributes attrs;
+  attrs.shareResources = true;
+  return webkit::gpu::WebGraphicsContext3DInProcessImpl::CreateForWebView(
+      attrs, false);
+}
+
+void HeadlessContextFactory::RemoveCompositor(Compositor* compositor) {
+}
+
 Texture::Texture(bool flipped, const gfx::Size& size)
     : texture_id_(0),
       flipped_(flipped),
@@ -137,7 +334,10 @@ Compositor::Compositor(CompositorDelegate* delegate,
       device_scale_factor_(0.0f),
       last_started_frame_(0),
       last_ended_frame_(0),
-      disable_schedule_composite_(false) {
+      disable_schedule_composite_(false),
+      draw_batched_(false),
+      ALLOW_THIS_IN_INITIALIZER_LIST(
+          scheduler_(this, GetDefaultVSyncInterval())) {
   WebKit::WebLayerTreeView::Settings settings;
   CommandLine* command_line = CommandLine::ForCurrentProcess();
   settings.showFPSCounter =
@@ -148,14 +348,21 @@ Compositor::Compositor(CompositorDelegate* delegate,
       test_compositor_enabled ? kTestRefreshRate : kDefaultRefreshRate;
 
 #if !defined(WEBCOMPOSITOR_OWNS_SETTINGS)
-  settings.partialSwapEnabled =
-      command_line->HasSwitch(switches::kUIEnablePartialSwap);
+  settings.partialSwapEnabled = IsPartialSwapEnabled();
   settings.perTilePainting =
       command_line->HasSwitch(switches::kUIEnablePerTilePainting);
 #endif
 
   host_.initialize(this, root_web_layer_, settings);
   root_web_layer_.setAnchorPoint(WebKit::WebFloatPoint(0.f, 0.f));
+
+  if (command_line->HasSwitch(switches::kUIShowFrameBreakdown)) {
+    hud_.reset(new FrameBreakdownHUD);
+    root_web_layer_.addChild(hud_->layer()->web_layer());
+  }
+
+  memory_pressure_listener_.reset(new base::MemoryPressureListener(
+      base::Bind(&Compositor::OnMemoryPressure, base::Unretained(this))));
 }
 
 Compositor::~Compositor() {
@@ -169,14 +376,19 @@ Compositor::~Compositor() {
     root_layer_->SetCompositor(NULL);
   if (!test_compositor_enabled)
     ContextFactory::GetInstance()->RemoveCompositor(this);
+  if (draw_batched_) {
+    std::vector<Compositor*>& batched = g_batched_compositors.Get();
+    batched.erase(std::find(batched.begin(), batched.end(), this));
+  }
+  for (size_t i = 0; i < pending_readbacks_.size(); ++i)
+    FailReadPixels(pending_readbacks_[i].callback);
 }
 
 void Compositor::Initialize(bool use_thread) {
 #if defined(WEBCOMPOSITOR_OWNS_SETTINGS)
   CommandLine* command_line = CommandLine::ForCurrentProcess();
   // These settings must be applied before we initialize the compositor.
-  WebKit::WebCompositor::setPartialSwapEnabled(
-      command_line->HasSwitch(switches::kUIEnablePartialSwap));
+  WebKit::WebCompositor::setPartialSwapEnabled(IsPartialSwapEnabled());
   WebKit::WebCompositor::setPerTilePaintingEnabled(
       command_line->HasSwitch(switches::kUIEnablePerTilePainting));
 #endif
@@ -193,12 +405,47 @@ void Compositor::Terminate() {
   }
 }
 
+// static
+bool Compositor::WasInitializedWithThread() {
+  return g_compositor_thread != NULL;
+}
+
 void Compositor::ScheduleDraw() {
+  if (g_draw_batch_depth > 0) {
+    if (!draw_batched_) {
+      draw_batched_ = true;
+      g_batched_compositors.Get().push_back(this);
+    }
+    return;
+  }
+  scheduler_.SetNeedsFrame();
+}
+
+// static
+void Compositor::BeginDrawBatch() {
+  g_draw_batch_depth++;
+}
+
+// static
+void Compositor::EndDrawBatch() {
+  DCHECK_GT(g_draw_batch_depth, 0);
+  if (--g_draw_batch_depth > 0)
+    return;
+  std::vector<Compositor*> batched;
+  batched.swap(g_batched_compositors.Get());
+  for (size_t i = 0; i < batched.size(); ++i) {
+    batched[i]->draw_batched_ = false;
+    batched[i]->ScheduleDraw();
+  }
+}
+
+void Compositor::BeginFrame(base::TimeTicks frame_time) {
   if (g_compositor_thread) {
     // TODO(nduca): Temporary while compositor calls
     // compositeImmediately() directly.
     layout();
-    host_.composite();
+    Composite();
+    ReadBackPendingRequests();
   } else if (delegate_) {
     delegate_->ScheduleDraw();
   }
@@ -215,18 +462,23 @@ void Compositor::SetRootLayer(Layer* root_layer) {
   root_web_layer_.removeAllChildren();
   if (root_layer_)
     root_web_layer_.addChild(root_layer_->web_layer());
+  if (hud_.get())
+    root_web_layer_.addChild(hud_->layer()->web_layer());
 }
 
 void Compositor::Draw(bool force_clear) {
-  if (!root_layer_)
+  if (!root_layer_) {
+    scheduler_.DidAbortFrame();
     return;
+  }
 
   last_started_frame_++;
 
   // TODO(nduca): Temporary while compositor calls
   // compositeImmediately() directly.
   layout();
-  host_.composite();
+  Composite();
+  ReadBackPendingRequests();
   if (!g_compositor_thread && !swap_posted_)
     NotifyEnd();
 }
@@ -258,6 +510,22 @@ bool Compositor::ReadPixels(SkBitmap* bitmap,
   return false;
 }
 
+void Compositor::ReadPixelsAsync(const gfx::Rect& bounds_in_pixel,
+                                 const gfx::Size& dest_size_in_pixel,
+                                 const ReadPixelsCallback& callback) {
+  if (bounds_in_pixel.IsEmpty() || dest_size_in_pixel.IsEmpty() ||
+      !gfx::Rect(size()).Contains(bounds_in_pixel)) {
+    FailReadPixels(callback);
+    return;
+  }
+  PendingReadback request;
+  request.bounds_in_pixel = bounds_in_pixel;
+  request.dest_size_in_pixel = dest_size_in_pixel;
+  request.callback = callback;
+  pending_readbacks_.push_back(request);
+  ScheduleDraw();
+}
+
 void Compositor::SetScaleAndSize(float scale, const gfx::Size& size_in_pixel) {
   DCHECK(scale > 0);
   if (size_in_pixel.IsEmpty() || scale <= 0)
@@ -268,8 +536,11 @@ void Compositor::SetScaleAndSize(float scale, const gfx::Size& size_in_pixel) {
 
   if (device_scale_factor_ != scale) {
     device_scale_factor_ = scale;
+    EnsureGlyphCacheFitsScale(scale);
     if (root_layer_)
       root_layer_->OnDeviceScaleFactorChanged(scale);
+    if (hud_.get())
+      hud_->layer()->OnDeviceScaleFactorChanged(scale);
   }
 }
 
@@ -285,6 +556,11 @@ bool Compositor::HasObserver(CompositorObserver* observer) {
   return observer_list_.HasObserver(observer);
 }
 
+void Compositor::SetVSyncParameters(base::TimeTicks timebase,
+                                    base::TimeDelta interval) {
+  scheduler_.SetVSyncParameters(timebase, interval);
+}
+
 void Compositor::OnSwapBuffersPosted() {
   swap_posted_ = true;
 }
@@ -293,9 +569,11 @@ void Compositor::OnSwapBuffersComplete() {
   DCHECK(swap_posted_);
   swap_posted_ = false;
   NotifyEnd();
+  NotifySwapCompleted();
 }
 
 void Compositor::OnSwapBuffersAborted() {
+  scheduler_.DidAbortFrame();
   if (swap_posted_) {
     swap_posted_ = false;
     NotifyEnd();
@@ -309,12 +587,31 @@ void Compositor::updateAnimations(double frameBeginTime) {
 }
 
 void Compositor::layout() {
+  base::TimeTicks start_time = base::TimeTicks::Now();
   // We're sending damage that will be addressed during this composite
   // cycle, so we don't need to schedule another composite to address it.
   disable_schedule_composite_ = true;
-  if (root_layer_)
-    root_layer_->SendDamagedRects();
+  bool sent_all_damage = true;
+  if (root_layer_) {
+    root_layer_->ComputeOcclusion();
+    texture_budget_.set_limit_bytes(
+        ContextFactory::GetInstance()->GetTextureMemoryBudget(this));
+    texture_budget_.Update(root_layer_);
+    int tile_budget = kMaxTilesPaintedPerFrame;
+    sent_all_damage = root_layer_->SendDamagedRects(&tile_budget);
+    size_t upload_budget_bytes = kMaxUploadBytesPerFrame;
+    if (!root_layer_->SendRasterizedTiles(&upload_budget_bytes))
+      sent_all_damage = false;
+  }
+  if (hud_.get()) {
+    int tile_budget = kMaxTilesPaintedPerFrame;
+    hud_->layer()->SendDamagedRects(&tile_budget);
+  }
   disable_schedule_composite_ = false;
+  // The tiles left for later are painted in the next frames.
+  if (!sent_all_damage)
+    ScheduleDraw();
+  frame_breakdown_.layout_time += base::TimeTicks::Now() - start_time;
 }
 
 void Compositor::applyScrollAndScale(const WebKit::WebSize& scrollDelta,
@@ -343,6 +640,7 @@ void Compositor::didCommitAndDrawFrame() {
 
 void Compositor::didCompleteSwapBuffers() {
   NotifyEnd();
+  NotifySwapCompleted();
 }
 
 void Compositor::scheduleComposite() {
@@ -373,11 +671,160 @@ void Compositor::SwizzleRGBAToBGRAAndFlip(unsigned char* pixels,
   }
 }
 
+void Compositor::AddPaintTime(base::TimeDelta paint_time) {
+  frame_breakdown_.paint_time += paint_time;
+}
+
+void Compositor::Composite() {
+  base::TimeTicks start_time = base::TimeTicks::Now();
+  FrameBreakdown before = frame_breakdown_;
+  host_.composite();
+  base::TimeTicks end_time = base::TimeTicks::Now();
+  // Compositing lays out and paints the layers; those are counted apart.
+  frame_breakdown_.composite_time += (end_time - start_time) -
+      (frame_breakdown_.layout_time - before.layout_time) -
+      (frame_breakdown_.paint_time - before.paint_time);
+  composite_end_time_ = end_time;
+}
+
+void Compositor::RecordFrameBreakdown() {
+  base::TimeTicks now = base::TimeTicks::Now();
+  if (!composite_end_time_.is_null())
+    frame_breakdown_.swap_time = now - composite_end_time_;
+  composite_end_time_ = base::TimeTicks();
+
+  // The GL calls of the process since the last frame, which are those of this
+  // frame when the compositor draws in process.
+  gfx::GLStateCache::Counts gl_counts = gfx::GLStateCache::TakeCounts();
+
+  bool tracing = base::debug::TraceLog::GetInstance()->IsEnabled();
+  if (tracing || hud_.get()) {
+    gfx::Size viewport_size = size_;
+    if (device_scale_factor_ > 0.0f) {
+      viewport_size = gfx::Size(
+          static_cast<int>(size_.width() / device_scale_factor_),
+          static_cast<int>(size_.height() / device_scale_factor_));
+    }
+    ComputeLayerTreeStats(root_layer_, viewport_size, &frame_breakdown_);
+    frame_breakdown_.texture_bytes = texture_budget_.used_bytes();
+  }
+
+  if (tracing) {
+    TRACE_COUNTER2("ui", "UIFrameCpuUs",
+                   "layout", frame_breakdown_.layout_time.InMicroseconds(),
+                   "paint", frame_breakdown_.paint_time.InMicroseconds());
+    TRACE_COUNTER2("ui", "UIFrameGpuUs",
+                   "composite",
+                   frame_breakdown_.composite_time.InMicroseconds(),
+                   "swap", frame_breakdown_.swap_time.InMicroseconds());
+    TRACE_COUNTER2("ui", "UILayers",
+                   "total", frame_breakdown_.layer_count,
+                   "drawn", frame_breakdown_.drawn_layer_count);
+    TRACE_COUNTER2("ui", "UITextures",
+                   "tiles", frame_breakdown_.tile_count,
+                   "KB", frame_breakdown_.texture_bytes / 1024);
+    TRACE_COUNTER1("ui", "UIOverdrawPercent",
+                   static_cast<int>(frame_breakdown_.overdraw * 100));
+    TRACE_COUNTER2("ui", "UIGLCalls",
+                   "calls", gl_counts.calls,
+                   "state_changes", gl_counts.state_changes);
+    TRACE_COUNTER1("ui", "UIGLDroppedStateChanges",
+                   gl_counts.dropped_state_changes);
+  }
+
+  last_frame_breakdown_ = frame_breakdown_;
+  frame_breakdown_ = FrameBreakdown();
+  if (hud_.get() && hud_->Update(last_frame_breakdown_, now))
+    ScheduleDraw();
+}
+
+void Compositor::ReadBackPendingRequests() {
+  if (pending_readbacks_.empty())
+    return;
+  TRACE_EVENT1("ui", "Compositor::ReadBackPendingRequests",
+               "requests", static_cast<int>(pending_readbacks_.size()));
+  std::vector<PendingReadback> requests;
+  requests.swap(pending_readbacks_);
+
+  // The size may have changed since the requests were made.
+  gfx::Rect frame_rect;
+  for (size_t i = 0; i < requests.size(); ++i) {
+    if (gfx::Rect(size()).Contains(requests[i].bounds_in_pixel))
+      frame_rect = frame_rect.Union(requests[i].bounds_in_pixel);
+  }
+
+  scoped_refptr<base::RefCountedBytes> pixels(new base::RefCountedBytes);
+  bool success = false;
+  if (!frame_rect.IsEmpty()) {
+    pixels->data().resize(4 * frame_rect.width() * frame_rect.height());
+    // Convert to OpenGL coordinates.
+    gfx::Point gl_origin(frame_rect.x(),
+                         size().height() - frame_rect.bottom());
+    success = host_.compositeAndReadback(
+        &pixels->data()[0], gfx::Rect(gl_origin, frame_rect.size()));
+  }
+
+  for (size_t i = 0; i < requests.size(); ++i) {
+    const PendingReadback& request = requests[i];
+    if (!success || !frame_rect.Contains(request.bounds_in_pixel)) {
+      FailReadPixels(request.callback);
+      continue;
+    }
+    gfx::Rect src_rect(request.bounds_in_pixel.x() - frame_rect.x(),
+                       request.bounds_in_pixel.y() - frame_rect.y(),
+                       request.bounds_in_pixel.width(),
+                       request.bounds_in_pixel.height());
+    SkBitmap* bitmap = new SkBitmap;
+    bool posted = base::WorkerPool::PostTaskAndReply(
+        FROM_HERE,
+        base::Bind(&ConvertReadbackPixels, pixels, frame_rect.size(), src_rect,
+                   request.dest_size_in_pixel, bitmap),
+        base::Bind(&RunReadPixelsCallback, request.callback,
+                   base::Owned(bitmap)),
+        true);
+    if (!posted)
+      FailReadPixels(request.callback);
+  }
+}
+
 void Compositor::NotifyEnd() {
   last_ended_frame_++;
+  RecordFrameBreakdown();
+  bool frame_finished = scheduler_.DidFinishFrame(base::TimeTicks::Now());
   FOR_EACH_OBSERVER(CompositorObserver,
                     observer_list_,
                     OnCompositingEnded(this));
+  if (frame_finished && scheduler_.interval() > base::TimeDelta()) {
+    FOR_EACH_OBSERVER(CompositorObserver,
+                      observer_list_,
+                      OnCompositingFrameStatistics(this,
+                                                   scheduler_.statistics()));
+  }
+}
+
+void Compositor::NotifySwapCompleted() {
+  FOR_EACH_OBSERVER(CompositorObserver,
+                    observer_list_,
+                    OnCompositingSwapCompleted(
+                        this, last_frame_breakdown_.swap_time));
+}
+
+void Compositor::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  texture_budget_.TrimAtNextUpdate(level);
+  // The glyph cache is shared by all compositors; the first to hear empties
+  // it.
+  if (level == base::MemoryPressureListener::MEMORY_PRESSURE_CRITICAL)
+    SkGraphics::PurgeFontCache();
+  ScheduleDraw();
+}
+
+ScopedDrawBatch::ScopedDrawBatch() {
+  Compositor::BeginDrawBatch();
+}
+
+ScopedDrawBatch::~ScopedDrawBatch() {
+  Compositor::EndDrawBatch();
 }
 
 COMPOSITOR_EXPORT void SetupTestCompositor() {
@@ -36,6 +36,12 @@
         'debug_utils.h',
         'dip_util.cc',
         'dip_util.h',
+        'frame_breakdown.cc',
+        'frame_breakdown.h',
+        'frame_breakdown_hud.cc',
+        'frame_breakdown_hud.h',
+        'frame_scheduler.cc',
+        'frame_scheduler.h',
         'layer.cc',
         'layer.h',
         'layer_animation_delegate.h',
@@ -50,11 +56,17 @@
         'layer_delegate.h',
         'layer_owner.cc',
         'layer_owner.h',
+        'layer_rasterizer.cc',
+        'layer_rasterizer.h',
         'layer_type.h',
         'scoped_layer_animation_settings.cc',
         'scoped_layer_animation_settings.h',
         'screen_rotation.cc',
         'screen_rotation.h',
+        'texture_budget.cc',
+        'texture_budget.h',
+        'threaded_layer_animation.cc',
+        'threaded_layer_animation.h',
         # UI tests need TestWebGraphicsContext3D, so we always build it.
         'test_web_graphics_context_3d.cc',
         'test_web_graphics_context_3d.h',
@@ -111,9 +123,11 @@
         'compositor_test_support',
       ],
       'sources': [
+        'frame_scheduler_unittest.cc',
         'layer_animation_element_unittest.cc',
         'layer_animation_sequence_unittest.cc',
         'layer_animator_unittest.cc',
+        'layer_rasterizer_unittest.cc',
         'layer_unittest.cc',
         'run_all_unittests.cc',
         'test/test_compositor_host.h',
@@ -6,14 +6,23 @@
 #define UI_COMPOSITOR_COMPOSITOR_H_
 #pragma once
 
+#include <vector>
+
+#include "base/callback.h"
 #include "base/hash_tables.h"
+#include "base/memory/memory_pressure_listener.h"
 #include "base/memory/ref_counted.h"
 #include "base/observer_list.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebLayer.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebLayerTreeView.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebLayerTreeViewClient.h"
+#include "base/memory/scoped_ptr.h"
 #include "ui/compositor/compositor_export.h"
+#include "ui/compositor/frame_breakdown.h"
+#include "ui/compositor/frame_scheduler.h"
+#include "ui/compositor/texture_budget.h"
 #include "ui/gfx/native_widget_types.h"
+#include "ui/gfx/rect.h"
 #include "ui/gfx/size.h"
 #include "ui/gfx/transform.h"
 #include "ui/gl/gl_share_group.h"
@@ -25,13 +34,13 @@ class GLContext;
 class GLSurface;
 class GLShareGroup;
 class Point;
-class Rect;
 }
 
 namespace ui {
 
 class Compositor;
 class CompositorObserver;
+class FrameBreakdownHUD;
 class Layer;
 
 // This class abstracts the creation of the 3D context for the compositor. It is
@@ -61,6 +70,13 @@ class COMPOSITOR_EXPORT ContextFactory {
 
   // Destroys per-compositor data.
   virtual void RemoveCompositor(Compositor* compositor) = 0;
+
+  // Returns how many bytes the textures of the layers of |compositor| may use.
+  // The compositor asks before each frame, and evicts the textures of layers
+  // it doesn't draw to stay within it. Factories lower it when the GPU runs
+  // low on memory, then call Compositor::ScheduleDraw() to have it applied.
+  // By default, it is a share of the physical memory.
+  virtual size_t GetTextureMemoryBudget(Compositor* compositor);
 };
 
 // The default factory that creates in-process contexts.
@@ -92,6 +108,27 @@ class COMPOSITOR_EXPORT DefaultContextFactory : public ContextFactory {
   DISALLOW_COPY_AND_ASSIGN(DefaultContextFactory);
 };
 
+// A factory for processes without a display, e.g. perf runs on CI machines.
+// Every compositor draws into an offscreen context backed by OSMesa, or by an
+// EGL pbuffer when --use-gl=egl is passed.
+class COMPOSITOR_EXPORT HeadlessContextFactory : public ContextFactory {
+ public:
+  HeadlessContextFactory();
+  virtual ~HeadlessContextFactory();
+
+  // ContextFactory implementation
+  virtual WebKit::WebGraphicsContext3D* CreateContext(
+      Compositor* compositor) OVERRIDE;
+  virtual WebKit::WebGraphicsContext3D* CreateOffscreenContext(
+      Compositor* compositor) OVERRIDE;
+  virtual void RemoveCompositor(Compositor* compositor) OVERRIDE;
+
+  bool Initialize();
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(HeadlessContextFactory);
+};
+
 // Texture provide an abstraction over the external texture that can be passed
 // to a layer.
 class COMPOSITOR_EXPORT Texture : public base::RefCounted<Texture> {
@@ -132,7 +169,8 @@ class COMPOSITOR_EXPORT CompositorDelegate {
 // appropriately transformed texture for each transformed view in the widget's
 // view hierarchy.
 class COMPOSITOR_EXPORT Compositor
-    : NON_EXPORTED_BASE(public WebKit::WebLayerTreeViewClient) {
+    : NON_EXPORTED_BASE(public WebKit::WebLayerTreeViewClient),
+      public FrameSchedulerClient {
  public:
   Compositor(CompositorDelegate* delegate,
              gfx::AcceleratedWidget widget);
@@ -141,9 +179,19 @@ class COMPOSITOR_EXPORT Compositor
   static void Initialize(bool useThread);
   static void Terminate();
 
-  // Schedules a redraw of the layer tree associated with this compositor.
+  // Returns true if Initialize() gave the compositor a thread of its own.
+  static bool WasInitializedWithThread();
+
+  // Schedules a redraw of the layer tree associated with this compositor, at
+  // the next vsync.
   void ScheduleDraw();
 
+  // Between these calls, compositors postpone the draws they are asked for,
+  // and schedule each of them once at the end. Batches nest. See
+  // ScopedDrawBatch.
+  static void BeginDrawBatch();
+  static void EndDrawBatch();
+
   // Sets the root of the layer tree drawn by this Compositor. The root layer
   // must have no parent. The compositor's root layer is reset if the root layer
   // is destroyed. NULL can be passed to reset the root layer, in which case the
@@ -172,6 +220,18 @@ class COMPOSITOR_EXPORT Compositor
   // Returns false if the pixels could not be read.
   bool ReadPixels(SkBitmap* bitmap, const gfx::Rect& bounds_in_pixel);
 
+  // Run with false and an empty bitmap if the pixels could not be read.
+  typedef base::Callback<void(bool, const SkBitmap&)> ReadPixelsCallback;
+
+  // Reads the region |bounds_in_pixel| of the next frame, scaled to
+  // |dest_size_in_pixel|, and runs |callback| with it, always from a task.
+  // Unlike ReadPixels(), it doesn't wait for the GPU: the requests made before
+  // a frame share one readback when it is drawn, and the pixels are swizzled,
+  // flipped and scaled on a worker thread.
+  void ReadPixelsAsync(const gfx::Rect& bounds_in_pixel,
+                       const gfx::Size& dest_size_in_pixel,
+                       const ReadPixelsCallback& callback);
+
   // Sets the compositor's device scale factor and size.
   void SetScaleAndSize(float scale, const gfx::Size& size_in_pixel);
 
@@ -181,6 +241,28 @@ class COMPOSITOR_EXPORT Compositor
   // Returns the widget for this compositor.
   gfx::AcceleratedWidget widget() const { return widget_; }
 
+  // Sets when the display refreshes: at |timebase| plus multiples of
+  // |interval|. Redraws are aligned to those times.
+  void SetVSyncParameters(base::TimeTicks timebase, base::TimeDelta interval);
+
+  // Returns how long frames have taken to reach the screen.
+  const FrameStatistics& frame_statistics() const {
+    return scheduler_.statistics();
+  }
+
+  // Returns how much memory the textures of the layers use.
+  const TextureBudget& texture_budget() const { return texture_budget_; }
+
+  // Returns where the time of the last frame went. Its layer, tile and
+  // overdraw counts are only filled while tracing or showing the frame
+  // breakdown HUD.
+  const FrameBreakdown& last_frame_breakdown() const {
+    return last_frame_breakdown_;
+  }
+
+  // Called by the layers with the time their delegates took to paint.
+  void AddPaintTime(base::TimeDelta paint_time);
+
   // Compositor does not own observers. It is the responsibility of the
   // observer to remove itself when it is done observing.
   void AddObserver(CompositorObserver* observer);
@@ -214,6 +296,9 @@ class COMPOSITOR_EXPORT Compositor
   virtual void didCompleteSwapBuffers();
   virtual void scheduleComposite();
 
+  // FrameSchedulerClient implementation.
+  virtual void BeginFrame(base::TimeTicks frame_time) OVERRIDE;
+
   int last_started_frame() { return last_started_frame_; }
   int last_ended_frame() { return last_ended_frame_; }
 
@@ -228,6 +313,31 @@ class COMPOSITOR_EXPORT Compositor
   // Notifies the compositor that compositing is complete.
   void NotifyEnd();
 
+  // Notifies the observers that the swap of the last frame has completed.
+  void NotifySwapCompleted();
+
+  // Composites the frame, timing it.
+  void Composite();
+
+  // Completes the breakdown of the frame that ends, and shows it.
+  void RecordFrameBreakdown();
+
+  // Reads back the pixels of the frame just drawn for the ReadPixelsAsync()
+  // requests, and hands them to workers.
+  void ReadBackPendingRequests();
+
+  // Evicts textures at the next frame, and drops the glyphs Skia caches when
+  // the pressure is critical.
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+
+  // A ReadPixelsAsync() request waiting for the next frame.
+  struct PendingReadback {
+    gfx::Rect bounds_in_pixel;
+    gfx::Size dest_size_in_pixel;
+    ReadPixelsCallback callback;
+  };
+
   CompositorDelegate* delegate_;
   gfx::Size size_;
 
@@ -252,6 +362,38 @@ class COMPOSITOR_EXPORT Compositor
   int last_ended_frame_;
 
   bool disable_schedule_composite_;
+
+  // True if a draw was asked for during a draw batch.
+  bool draw_batched_;
+
+  FrameScheduler scheduler_;
+
+  TextureBudget texture_budget_;
+
+  scoped_ptr<base::MemoryPressureListener> memory_pressure_listener_;
+
+  // The breakdown of the frame in progress and of the last frame, and when
+  // compositing the frame in progress ended.
+  FrameBreakdown frame_breakdown_;
+  FrameBreakdown last_frame_breakdown_;
+  base::TimeTicks composite_end_time_;
+
+  // Shows |last_frame_breakdown_|, with --ui-show-frame-breakdown.
+  scoped_ptr<FrameBreakdownHUD> hud_;
+
+  std::vector<PendingReadback> pending_readbacks_;
+};
+
+// Batches the draws that compositors are asked for during its lifetime, so
+// that changing many layers at once, e.g. when animations step together,
+// schedules at most one draw per compositor.
+class COMPOSITOR_EXPORT ScopedDrawBatch {
+ public:
+  ScopedDrawBatch();
+  ~ScopedDrawBatch();
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ScopedDrawBatch);
 };
 
 }  // namespace ui
@@ -6,11 +6,13 @@
 #define UI_COMPOSITOR_COMPOSITOR_OBSERVER_H_
 #pragma once
 
+#include "base/time.h"
 #include "ui/compositor/compositor_export.h"
 
 namespace ui {
 
 class Compositor;
+struct FrameStatistics;
 
 // A compositor observer is notified when compositing completes.
 class COMPOSITOR_EXPORT CompositorObserver {
@@ -25,6 +27,18 @@ class COMPOSITOR_EXPORT CompositorObserver {
   // Called when compositing is aborted (e.g. lost graphics context).
   virtual void OnCompositingAborted(Compositor* compositor) = 0;
 
+  // Called after OnCompositingEnded() for a frame begun on vsync, with the
+  // timing of all the frames of the compositor so far.
+  virtual void OnCompositingFrameStatistics(
+      Compositor* compositor,
+      const FrameStatistics& statistics) {}
+
+  // Called after OnCompositingEnded() when the swap of a frame has completed,
+  // with how long it took from the end of compositing. Not called for frames
+  // drawn without a swap, or whose swap was aborted.
+  virtual void OnCompositingSwapCompleted(Compositor* compositor,
+                                          base::TimeDelta swap_latency) {}
+
  protected:
   virtual ~CompositorObserver() {}
 };
@@ -10,11 +10,19 @@ const char kDisableTestCompositor[] = "disable-test-compositor";
 
 const char kDisableUIVsync[] = "disable-ui-vsync";
 
-const char kUIEnablePartialSwap[] = "ui-enable-partial-swap";
+const char kUIDisablePartialSwap[] = "ui-disable-partial-swap";
+
+// Compiles the compositor's shaders on every run instead of keeping the
+// binaries of its programs on disk.
+const char kUIDisableProgramCache[] = "ui-disable-program-cache";
 
 // Show FPS counter.
 const char kUIShowFPSCounter[] = "ui-show-fps-counter";
 
+// Shows where the time of the frames goes, and what they draw, above the
+// layer tree.
+const char kUIShowFrameBreakdown[] = "ui-show-frame-breakdown";
+
 // Show colored borders around layers.
 const char kUIShowLayerBorders[] = "ui-show-layer-borders";
 
@@ -23,4 +31,12 @@ const char kUIShowLayerTree[] = "ui-show-layer-tree";
 
 const char kUIEnablePerTilePainting[] = "ui-enable-per-tile-painting";
 
+// Layers that paint in tiles record their contents on the UI thread and
+// rasterize the recordings on worker threads.
+const char kUIEnableThreadedRaster[] = "ui-enable-threaded-raster";
+
+// Makes the compositors draw with one real GL context, each keeping its own
+// state in software, instead of switching between contexts of their own.
+const char kUIEnableVirtualGLContexts[] = "ui-enable-virtual-gl-contexts";
+
 }  // namespace switches
@@ -12,11 +12,15 @@ namespace switches {
 
 COMPOSITOR_EXPORT extern const char kDisableTestCompositor[];
 COMPOSITOR_EXPORT extern const char kDisableUIVsync[];
-COMPOSITOR_EXPORT extern const char kUIEnablePartialSwap[];
+COMPOSITOR_EXPORT extern const char kUIDisablePartialSwap[];
+COMPOSITOR_EXPORT extern const char kUIDisableProgramCache[];
 COMPOSITOR_EXPORT extern const char kUIShowFPSCounter[];
+COMPOSITOR_EXPORT extern const char kUIShowFrameBreakdown[];
 COMPOSITOR_EXPORT extern const char kUIShowLayerBorders[];
 COMPOSITOR_EXPORT extern const char kUIShowLayerTree[];
 COMPOSITOR_EXPORT extern const char kUIEnablePerTilePainting[];
+COMPOSITOR_EXPORT extern const char kUIEnableThreadedRaster[];
+COMPOSITOR_EXPORT extern const char kUIEnableVirtualGLContexts[];
 
 }  // namespace switches
 
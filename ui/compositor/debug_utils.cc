@@ -8,11 +8,15 @@
 
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 
 #include "base/logging.h"
 #include "base/utf_string_conversions.h"
+#include "ui/compositor/compositor.h"
 #include "ui/compositor/layer.h"
+#include "ui/compositor/layer_rasterizer.h"
+#include "ui/compositor/texture_budget.h"
 #include "ui/gfx/interpolated_transform.h"
 #include "ui/gfx/point.h"
 #include "ui/gfx/transform.h"
@@ -21,6 +25,8 @@ namespace ui {
 
 namespace {
 
+const size_t kBytesPerKB = 1024;
+
 void PrintLayerHierarchyImp(const Layer* layer, int indent,
                             gfx::Point mouse_location) {
   if (!layer->visible())
@@ -50,6 +56,8 @@ void PrintLayerHierarchyImp(const Layer* layer, int indent,
       buf << L" textured";
       if (layer->fills_bounds_opaquely())
         buf << L" opaque";
+      if (layer->occluded())
+        buf << L" occluded";
       break;
     case ui::LAYER_SOLID_COLOR:
       buf << L" solid";
@@ -60,6 +68,23 @@ void PrintLayerHierarchyImp(const Layer* layer, int indent,
   buf << L"bounds: " << layer->bounds().x() << L',' << layer->bounds().y();
   buf << L' ' << layer->bounds().width() << L'x' << layer->bounds().height();
 
+  if (layer->type() == ui::LAYER_TEXTURED) {
+    buf << L'\n' << UTF8ToWide(content_indent_str);
+    if (layer->texture_evicted())
+      buf << L"texture: evicted";
+    else
+      buf << L"texture: " << layer->GetTextureMemoryBytes() / kBytesPerKB
+          << L" KB";
+  }
+
+  if (layer->rasterizer()) {
+    const LayerRasterizer* rasterizer = layer->rasterizer();
+    buf << L'\n' << UTF8ToWide(content_indent_str);
+    buf << L"raster: " << rasterizer->rasterized_tile_count() << L" tiles in "
+        << rasterizer->total_raster_time().InMilliseconds() << L" ms, last "
+        << rasterizer->last_raster_time().InMicroseconds() << L" us";
+  }
+
   if (layer->opacity() != 1.0f) {
     buf << L'\n' << UTF8ToWide(content_indent_str);
     buf << L"opacity: " << std::setprecision(2) << layer->opacity();
@@ -104,6 +129,17 @@ void PrintLayerHierarchy(const Layer* layer, gfx::Point mouse_location) {
   PrintLayerHierarchyImp(layer, 0, mouse_location);
 }
 
+void PrintTextureMemoryUsage(const Compositor* compositor) {
+  const TextureBudget& budget = compositor->texture_budget();
+  std::ostringstream buf;
+  buf << "Layer textures: " << budget.used_bytes() / kBytesPerKB << " KB, "
+      << budget.drawn_bytes() / kBytesPerKB << " KB drawn, budget "
+      << budget.limit_bytes() / kBytesPerKB << " KB, "
+      << budget.eviction_count() << " evictions";
+  VLOG(1) << buf.str();
+  std::cout << buf.str() << std::endl;
+}
+
 } // namespace ui
 
 #endif // NDEBUG
@@ -16,12 +16,17 @@ class Point;
 
 namespace ui {
 
+class Compositor;
 class Layer;
 
 // Log the layer hierarchy. Mark layers which contain |mouse_location| with '*'.
 COMPOSITOR_EXPORT void PrintLayerHierarchy(const Layer* layer,
                                            gfx::Point mouse_location);
 
+// Log how much memory the textures of the layers of |compositor| use, against
+// its texture budget.
+COMPOSITOR_EXPORT void PrintTextureMemoryUsage(const Compositor* compositor);
+
 } // namespace ui
 
 #endif // NDEBUG
@@ -0,0 +1,91 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/compositor/frame_breakdown.h"
+
+#include "ui/compositor/dip_util.h"
+#include "ui/compositor/layer.h"
+#include "ui/gfx/rect.h"
+#include "ui/gfx/size.h"
+#include "ui/gfx/transform.h"
+
+namespace ui {
+
+namespace {
+
+int TilesAcross(int pixels) {
+  return (pixels + Layer::kTileSize - 1) / Layer::kTileSize;
+}
+
+// Adds the counts of |layer| and its descendants to |breakdown|, and the area
+// of the viewport they draw to |drawn_area|. |to_root| maps the layer to the
+// root, and |drawn| is false if an ancestor is hidden.
+void AddLayerStats(const Layer* layer,
+                   const Transform& to_root,
+                   bool drawn,
+                   const gfx::Rect& viewport,
+                   FrameBreakdown* breakdown,
+                   int64* drawn_area) {
+  breakdown->layer_count++;
+  drawn = drawn && layer->visible();
+  if (drawn && !layer->occluded() && layer->type() != LAYER_NOT_DRAWN) {
+    breakdown->drawn_layer_count++;
+    gfx::Rect rect(layer->bounds().size());
+    to_root.TransformRect(&rect);
+    rect = rect.Intersect(viewport);
+    *drawn_area += static_cast<int64>(rect.width()) * rect.height();
+    if (layer->type() == LAYER_TEXTURED) {
+      gfx::Size size = ConvertSizeToPixel(layer, layer->bounds().size());
+      breakdown->tile_count +=
+          TilesAcross(size.width()) * TilesAcross(size.height());
+    }
+  }
+
+  for (size_t i = 0; i < layer->children().size(); ++i) {
+    const Layer* child = layer->children()[i];
+    Transform child_to_root = child->transform();
+    child_to_root.ConcatTranslate(static_cast<float>(child->bounds().x()),
+                                  static_cast<float>(child->bounds().y()));
+    child_to_root.ConcatTransform(to_root);
+    AddLayerStats(child, child_to_root, drawn, viewport, breakdown,
+                  drawn_area);
+  }
+}
+
+}  // namespace
+
+FrameBreakdown::FrameBreakdown()
+    : layer_count(0),
+      drawn_layer_count(0),
+      tile_count(0),
+      texture_bytes(0),
+      overdraw(0.0f) {
+}
+
+FrameBreakdown::~FrameBreakdown() {
+}
+
+void ComputeLayerTreeStats(const Layer* root,
+                           const gfx::Size& viewport_size,
+                           FrameBreakdown* breakdown) {
+  breakdown->layer_count = 0;
+  breakdown->drawn_layer_count = 0;
+  breakdown->tile_count = 0;
+  breakdown->overdraw = 0.0f;
+  if (!root)
+    return;
+
+  gfx::Rect viewport(viewport_size);
+  int64 drawn_area = 0;
+  Transform root_transform = root->transform();
+  root_transform.ConcatTranslate(static_cast<float>(root->bounds().x()),
+                                 static_cast<float>(root->bounds().y()));
+  AddLayerStats(root, root_transform, true, viewport, breakdown, &drawn_area);
+  if (!viewport.IsEmpty()) {
+    breakdown->overdraw = static_cast<float>(drawn_area) /
+        (static_cast<float>(viewport.width()) * viewport.height());
+  }
+}
+
+}  // namespace ui
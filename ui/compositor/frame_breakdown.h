@@ -0,0 +1,58 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_COMPOSITOR_FRAME_BREAKDOWN_H_
+#define UI_COMPOSITOR_FRAME_BREAKDOWN_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/time.h"
+#include "ui/compositor/compositor_export.h"
+
+namespace gfx {
+class Size;
+}
+
+namespace ui {
+
+class Layer;
+
+// Where the time of a compositor frame went, and what the frame drew.
+struct COMPOSITOR_EXPORT FrameBreakdown {
+  FrameBreakdown();
+  ~FrameBreakdown();
+
+  // Time on the UI thread: preparing the layer tree (occlusion, texture
+  // budget and damage), the delegates painting the layers, and the rest of
+  // compositing, which uploads the textures and draws.
+  base::TimeDelta layout_time;
+  base::TimeDelta paint_time;
+  base::TimeDelta composite_time;
+
+  // From the end of compositing until the swap completed.
+  base::TimeDelta swap_time;
+
+  // The layers of the tree, and those that were drawn.
+  int layer_count;
+  int drawn_layer_count;
+
+  // The tiles of the textures of the drawn layers, and the bytes of the
+  // textures of all the layers.
+  int tile_count;
+  size_t texture_bytes;
+
+  // How many times the drawn layers cover each pixel of the viewport, on
+  // average.
+  float overdraw;
+};
+
+// Fills the layer, tile and overdraw counts of |breakdown| for the tree under
+// |root|, drawn into a viewport of |viewport_size| DIPs.
+COMPOSITOR_EXPORT void ComputeLayerTreeStats(const Layer* root,
+                                             const gfx::Size& viewport_size,
+                                             FrameBreakdown* breakdown);
+
+}  // namespace ui
+
+#endif  // UI_COMPOSITOR_FRAME_BREAKDOWN_H_
@@ -0,0 +1,94 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/compositor/frame_breakdown_hud.h"
+
+#include "base/stringprintf.h"
+#include "base/utf_string_conversions.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "ui/compositor/layer.h"
+#include "ui/gfx/canvas.h"
+#include "ui/gfx/font.h"
+#include "ui/gfx/rect.h"
+
+namespace ui {
+
+namespace {
+
+const int kUpdateIntervalMs = 500;
+
+const int kWidth = 220;
+const int kLineHeight = 16;
+const int kPadding = 4;
+const int kLineCount = 7;
+
+const SkColor kBackgroundColor = SkColorSetARGB(0xC0, 0, 0, 0);
+const SkColor kTextColor = SK_ColorWHITE;
+
+string16 FormatTime(const char* name, base::TimeDelta time) {
+  return ASCIIToUTF16(base::StringPrintf("%s: %.2f ms", name,
+                                         time.InMillisecondsF()));
+}
+
+}  // namespace
+
+FrameBreakdownHUD::FrameBreakdownHUD()
+    : layer_(new Layer(LAYER_TEXTURED)) {
+  layer_->set_name("FrameBreakdownHUD");
+  layer_->set_delegate(this);
+  layer_->SetFillsBoundsOpaquely(false);
+  layer_->SetBounds(gfx::Rect(0, 0, kWidth,
+                              kLineCount * kLineHeight + 2 * kPadding));
+}
+
+FrameBreakdownHUD::~FrameBreakdownHUD() {
+}
+
+bool FrameBreakdownHUD::Update(const FrameBreakdown& breakdown,
+                               base::TimeTicks now) {
+  if (!last_update_time_.is_null() &&
+      now - last_update_time_ <
+          base::TimeDelta::FromMilliseconds(kUpdateIntervalMs)) {
+    return false;
+  }
+  last_update_time_ = now;
+
+  lines_.clear();
+  lines_.push_back(FormatTime("Layout", breakdown.layout_time));
+  lines_.push_back(FormatTime("Paint", breakdown.paint_time));
+  lines_.push_back(FormatTime("Upload and draw", breakdown.composite_time));
+  lines_.push_back(FormatTime("Swap", breakdown.swap_time));
+  lines_.push_back(ASCIIToUTF16(base::StringPrintf(
+      "Layers: %d, %d drawn", breakdown.layer_count,
+      breakdown.drawn_layer_count)));
+  lines_.push_back(ASCIIToUTF16(base::StringPrintf(
+      "Tiles: %d, textures: %d KB", breakdown.tile_count,
+      static_cast<int>(breakdown.texture_bytes / 1024))));
+  lines_.push_back(ASCIIToUTF16(base::StringPrintf(
+      "Overdraw: %.2fx", breakdown.overdraw)));
+  DCHECK_EQ(static_cast<size_t>(kLineCount), lines_.size());
+
+  layer_->SchedulePaint(gfx::Rect(layer_->bounds().size()));
+  return true;
+}
+
+void FrameBreakdownHUD::OnPaintLayer(gfx::Canvas* canvas) {
+  canvas->DrawColor(SkColorSetARGB(0, 0, 0, 0), SkXfermode::kSrc_Mode);
+  canvas->FillRect(gfx::Rect(layer_->bounds().size()), kBackgroundColor);
+  gfx::Font font;
+  for (size_t i = 0; i < lines_.size(); ++i) {
+    canvas->DrawStringInt(lines_[i], font, kTextColor, kPadding,
+                          kPadding + static_cast<int>(i) * kLineHeight,
+                          kWidth - 2 * kPadding, kLineHeight);
+  }
+}
+
+void FrameBreakdownHUD::OnDeviceScaleFactorChanged(float device_scale_factor) {
+}
+
+base::Closure FrameBreakdownHUD::PrepareForLayerBoundsChange() {
+  return base::Closure();
+}
+
+}  // namespace ui
@@ -0,0 +1,53 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_COMPOSITOR_FRAME_BREAKDOWN_HUD_H_
+#define UI_COMPOSITOR_FRAME_BREAKDOWN_HUD_H_
+#pragma once
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/string16.h"
+#include "base/time.h"
+#include "ui/compositor/frame_breakdown.h"
+#include "ui/compositor/layer_delegate.h"
+
+namespace ui {
+
+class Layer;
+
+// FrameBreakdownHUD shows the breakdown of the last frames of a compositor in
+// a layer that the compositor draws above its layer tree.
+class FrameBreakdownHUD : public LayerDelegate {
+ public:
+  FrameBreakdownHUD();
+  virtual ~FrameBreakdownHUD();
+
+  Layer* layer() { return layer_.get(); }
+
+  // Shows |breakdown|, at most a couple of times per second so that the HUD
+  // stays readable and doesn't redraw continuously. Returns true if the layer
+  // needs to be drawn again.
+  bool Update(const FrameBreakdown& breakdown, base::TimeTicks now);
+
+ private:
+  // LayerDelegate overrides:
+  virtual void OnPaintLayer(gfx::Canvas* canvas) OVERRIDE;
+  virtual void OnDeviceScaleFactorChanged(float device_scale_factor) OVERRIDE;
+  virtual base::Closure PrepareForLayerBoundsChange() OVERRIDE;
+
+  scoped_ptr<Layer> layer_;
+
+  std::vector<string16> lines_;
+  base::TimeTicks last_update_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameBreakdownHUD);
+};
+
+}  // namespace ui
+
+#endif  // UI_COMPOSITOR_FRAME_BREAKDOWN_HUD_H_
@@ -0,0 +1,226 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/compositor/frame_scheduler.h"
+
+#include <algorithm>
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "ui/base/animation/animation_ticker.h"
+
+namespace ui {
+
+namespace {
+
+// Frames that take this many vsync intervals or more share the last bucket.
+const size_t kFrameTimeHistogramSize = 4;
+
+// Steps the animations of the thread at the beginning of the frames of the
+// first scheduler that is aligned to vsync.
+class AnimationBeat : public AnimationTicker::Beat {
+ public:
+  AnimationBeat() : ticking_(false) {}
+
+  void AddScheduler(FrameScheduler* scheduler) {
+    schedulers_.push_back(scheduler);
+    if (schedulers_.size() == 1) {
+      ticker_ = AnimationTicker::GetForCurrentThread();
+      ticker_->SetBeat(this);
+    }
+  }
+
+  void RemoveScheduler(FrameScheduler* scheduler) {
+    std::vector<FrameScheduler*>::iterator it =
+        std::find(schedulers_.begin(), schedulers_.end(), scheduler);
+    DCHECK(it != schedulers_.end());
+    bool was_first = it == schedulers_.begin();
+    schedulers_.erase(it);
+    if (schedulers_.empty()) {
+      ticker_->SetBeat(NULL);
+      ticker_ = NULL;
+    } else if (was_first && ticking_) {
+      schedulers_.front()->SetNeedsAnimate();
+    }
+  }
+
+  // Steps the animations if |scheduler| is the one that drives them.
+  void Tick(FrameScheduler* scheduler, base::TimeTicks frame_time) {
+    if (!ticking_ || schedulers_.front() != scheduler)
+      return;
+    ticker_->Tick(frame_time);
+    if (ticking_)
+      scheduler->SetNeedsAnimate();
+  }
+
+  // AnimationTicker::Beat overrides:
+  virtual void StartBeating() OVERRIDE {
+    ticking_ = true;
+    if (!schedulers_.empty())
+      schedulers_.front()->SetNeedsAnimate();
+  }
+
+  virtual void StopBeating() OVERRIDE {
+    ticking_ = false;
+  }
+
+ private:
+  std::vector<FrameScheduler*> schedulers_;
+  // The ticker of the thread the schedulers live on, while there are any.
+  scoped_refptr<AnimationTicker> ticker_;
+  bool ticking_;
+
+  DISALLOW_COPY_AND_ASSIGN(AnimationBeat);
+};
+
+base::LazyInstance<AnimationBeat>::Leaky g_animation_beat =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+FrameStatistics::FrameStatistics()
+    : frame_count(0),
+      missed_deadline_count(0),
+      frame_time_histogram(kFrameTimeHistogramSize, 0) {
+}
+
+FrameStatistics::~FrameStatistics() {
+}
+
+FrameScheduler::FrameScheduler(FrameSchedulerClient* client,
+                               base::TimeDelta interval)
+    : client_(client),
+      timebase_(base::TimeTicks::Now()),
+      interval_(interval),
+      needs_frame_(false),
+      needs_animate_(false),
+      in_vsync_(false) {
+  if (interval_ > base::TimeDelta())
+    g_animation_beat.Get().AddScheduler(this);
+}
+
+FrameScheduler::~FrameScheduler() {
+  if (interval_ > base::TimeDelta())
+    g_animation_beat.Get().RemoveScheduler(this);
+}
+
+void FrameScheduler::SetVSyncParameters(base::TimeTicks timebase,
+                                        base::TimeDelta interval) {
+  bool was_aligned = interval_ > base::TimeDelta();
+  bool is_aligned = interval > base::TimeDelta();
+  timebase_ = timebase;
+  interval_ = interval;
+  if (was_aligned != is_aligned) {
+    if (is_aligned)
+      g_animation_beat.Get().AddScheduler(this);
+    else
+      g_animation_beat.Get().RemoveScheduler(this);
+  }
+
+  if (timer_.IsRunning()) {
+    timer_.Stop();
+    ScheduleVSync();
+  }
+}
+
+void FrameScheduler::SetNeedsFrame() {
+  needs_frame_ = true;
+  if (!in_vsync_)
+    ScheduleVSync();
+}
+
+void FrameScheduler::SetNeedsAnimate() {
+  needs_animate_ = true;
+  if (!in_vsync_)
+    ScheduleVSync();
+}
+
+bool FrameScheduler::DidFinishFrame(base::TimeTicks now) {
+  if (!frame_in_progress())
+    return false;
+
+  base::TimeDelta frame_time =
+      std::max(base::TimeDelta(), now - frame_begin_time_);
+  statistics_.frame_count++;
+  if (now > deadline_)
+    statistics_.missed_deadline_count++;
+  statistics_.last_frame_time = frame_time;
+  size_t bucket = 0;
+  if (interval_ > base::TimeDelta())
+    bucket = static_cast<size_t>(frame_time / interval_);
+  bucket = std::min(bucket, statistics_.frame_time_histogram.size() - 1);
+  statistics_.frame_time_histogram[bucket]++;
+
+  frame_begin_time_ = base::TimeTicks();
+  deadline_ = base::TimeTicks();
+  return true;
+}
+
+void FrameScheduler::DidAbortFrame() {
+  frame_begin_time_ = base::TimeTicks();
+  deadline_ = base::TimeTicks();
+}
+
+base::TimeTicks FrameScheduler::NextFrameTime(base::TimeTicks now) const {
+  if (interval_ <= base::TimeDelta())
+    return now;
+
+  // Rounds towards the timebase, so the vsync found is at most one interval
+  // before |now|.
+  int64 intervals = (now - timebase_) / interval_;
+  base::TimeTicks frame_time = timebase_ + interval_ * intervals;
+  if (frame_time < now)
+    frame_time += interval_;
+  return frame_time;
+}
+
+void FrameScheduler::OnVSync(base::TimeTicks frame_time) {
+  DCHECK(!in_vsync_);
+  in_vsync_ = true;
+
+  // Animations go first so that what they change is drawn in this frame.
+  if (needs_animate_) {
+    needs_animate_ = false;
+    g_animation_beat.Get().Tick(this, frame_time);
+  }
+
+  if (needs_frame_) {
+    if (!frame_in_progress()) {
+      frame_begin_time_ = frame_time;
+      deadline_ = frame_time + interval_;
+    }
+    // What the frame asks for goes to the next one.
+    needs_frame_ = false;
+    client_->BeginFrame(frame_time);
+  }
+
+  in_vsync_ = false;
+  if (needs_frame_ || needs_animate_)
+    ScheduleVSync();
+}
+
+void FrameScheduler::ScheduleVSync() {
+  if (timer_.IsRunning())
+    return;
+
+  if (interval_ <= base::TimeDelta()) {
+    OnVSync(base::TimeTicks::Now());
+    return;
+  }
+
+  base::TimeTicks now = base::TimeTicks::Now();
+  timer_.Start(FROM_HERE, NextFrameTime(now) - now, this,
+               &FrameScheduler::OnTimer);
+}
+
+void FrameScheduler::OnTimer() {
+  // The timer may fire late; the frame begins at the last vsync.
+  base::TimeTicks now = base::TimeTicks::Now();
+  base::TimeTicks frame_time = NextFrameTime(now);
+  if (frame_time > now)
+    frame_time -= interval_;
+  OnVSync(frame_time);
+}
+
+}  // namespace ui
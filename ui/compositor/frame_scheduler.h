@@ -0,0 +1,125 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_COMPOSITOR_FRAME_SCHEDULER_H_
+#define UI_COMPOSITOR_FRAME_SCHEDULER_H_
+#pragma once
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/time.h"
+#include "base/timer.h"
+#include "ui/compositor/compositor_export.h"
+
+namespace ui {
+
+// How long the frames of a FrameScheduler took to reach the screen.
+struct COMPOSITOR_EXPORT FrameStatistics {
+  FrameStatistics();
+  ~FrameStatistics();
+
+  // The number of frames that finished, and how many of those finished after
+  // their deadline.
+  int frame_count;
+  int missed_deadline_count;
+
+  // From the beginning of the last frame to its swap completing.
+  base::TimeDelta last_frame_time;
+
+  // Element i counts the frames that took between i and i + 1 vsync
+  // intervals. The last element also counts all the longer frames.
+  std::vector<int> frame_time_histogram;
+};
+
+// An interface to allow the FrameScheduler to begin frames.
+class COMPOSITOR_EXPORT FrameSchedulerClient {
+ public:
+  // Asks for a frame to be drawn, and FrameScheduler::DidFinishFrame() to be
+  // called when it is on screen.
+  virtual void BeginFrame(base::TimeTicks frame_time) = 0;
+
+ protected:
+  virtual ~FrameSchedulerClient() {}
+};
+
+// FrameScheduler coalesces the invalidations of a compositor into at most one
+// frame per vsync interval, begun on a vsync. The deadline of a frame is the
+// vsync that follows its beginning.
+//
+// While any animation is running, the first FrameScheduler that is aligned to
+// vsync also steps the animations of the thread, LayerAnimators included, at
+// the beginning of its frames, in place of the timer of the AnimationTicker,
+// so that animations and drawing share a beat.
+class COMPOSITOR_EXPORT FrameScheduler {
+ public:
+  // A zero |interval| begins frames as soon as they are needed, without
+  // waiting for a vsync or stepping the animations.
+  FrameScheduler(FrameSchedulerClient* client, base::TimeDelta interval);
+  ~FrameScheduler();
+
+  // Vsyncs happen at |timebase| plus multiples of |interval|.
+  void SetVSyncParameters(base::TimeTicks timebase, base::TimeDelta interval);
+  base::TimeDelta interval() const { return interval_; }
+
+  // Asks for a frame at the next vsync.
+  void SetNeedsFrame();
+
+  // Asks for the animations to be stepped at the next vsync.
+  void SetNeedsAnimate();
+
+  // Called when the swap of the frame in progress has completed. Returns false
+  // if no frame was in progress.
+  bool DidFinishFrame(base::TimeTicks now);
+
+  // Called when the frame in progress won't reach the screen.
+  void DidAbortFrame();
+
+  // Returns the first vsync at or after |now|.
+  base::TimeTicks NextFrameTime(base::TimeTicks now) const;
+
+  // Steps the animations and begins a frame, if needed. Invoked on vsync;
+  // public for testing.
+  void OnVSync(base::TimeTicks frame_time);
+
+  bool needs_frame() const { return needs_frame_; }
+
+  // Whether a frame has begun and not finished yet.
+  bool frame_in_progress() const { return !frame_begin_time_.is_null(); }
+  base::TimeTicks deadline() const { return deadline_; }
+
+  const FrameStatistics& statistics() const { return statistics_; }
+
+ private:
+  // Starts the timer for the next vsync.
+  void ScheduleVSync();
+
+  void OnTimer();
+
+  FrameSchedulerClient* client_;
+
+  base::TimeTicks timebase_;
+  base::TimeDelta interval_;
+
+  bool needs_frame_;
+  bool needs_animate_;
+
+  // True within OnVSync(), where new requests join the frame that begins.
+  bool in_vsync_;
+
+  // When the frame in progress began and when it should finish. Null if no
+  // frame is in progress.
+  base::TimeTicks frame_begin_time_;
+  base::TimeTicks deadline_;
+
+  FrameStatistics statistics_;
+
+  base::OneShotTimer<FrameScheduler> timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameScheduler);
+};
+
+}  // namespace ui
+
+#endif  // UI_COMPOSITOR_FRAME_SCHEDULER_H_
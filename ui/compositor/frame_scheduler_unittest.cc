@@ -0,0 +1,190 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/compositor/frame_scheduler.h"
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/compositor/layer_animation_element.h"
+#include "ui/compositor/layer_animation_sequence.h"
+#include "ui/compositor/layer_animator.h"
+#include "ui/compositor/test/test_layer_animation_delegate.h"
+
+namespace ui {
+
+namespace {
+
+class TestFrameSchedulerClient : public FrameSchedulerClient {
+ public:
+  TestFrameSchedulerClient() : frame_count_(0), redraw_scheduler_(NULL) {}
+
+  int frame_count() const { return frame_count_; }
+  base::TimeTicks last_frame_time() const { return last_frame_time_; }
+
+  // If set, each frame asks |scheduler| for another one.
+  void set_redraw_scheduler(FrameScheduler* scheduler) {
+    redraw_scheduler_ = scheduler;
+  }
+
+  // FrameSchedulerClient implementation.
+  virtual void BeginFrame(base::TimeTicks frame_time) OVERRIDE {
+    frame_count_++;
+    last_frame_time_ = frame_time;
+    if (redraw_scheduler_)
+      redraw_scheduler_->SetNeedsFrame();
+  }
+
+ private:
+  int frame_count_;
+  base::TimeTicks last_frame_time_;
+  FrameScheduler* redraw_scheduler_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestFrameSchedulerClient);
+};
+
+}  // namespace
+
+class FrameSchedulerTest : public testing::Test {
+ public:
+  FrameSchedulerTest()
+      : interval_(base::TimeDelta::FromMilliseconds(16)),
+        scheduler_(&client_, interval_) {
+  }
+
+ protected:
+  MessageLoopForUI message_loop_;
+  base::TimeDelta interval_;
+  TestFrameSchedulerClient client_;
+  FrameScheduler scheduler_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(FrameSchedulerTest);
+};
+
+// Checks that frames are aligned to vsync.
+TEST_F(FrameSchedulerTest, NextFrameTime) {
+  base::TimeTicks timebase = base::TimeTicks::Now();
+  scheduler_.SetVSyncParameters(timebase, interval_);
+  base::TimeDelta millisecond = base::TimeDelta::FromMilliseconds(1);
+
+  EXPECT_EQ(timebase, scheduler_.NextFrameTime(timebase));
+  EXPECT_EQ(timebase + interval_,
+            scheduler_.NextFrameTime(timebase + millisecond));
+  EXPECT_EQ(timebase + 2 * interval_,
+            scheduler_.NextFrameTime(timebase + 2 * interval_));
+  EXPECT_EQ(timebase,
+            scheduler_.NextFrameTime(timebase - interval_ + millisecond));
+  EXPECT_EQ(timebase - interval_,
+            scheduler_.NextFrameTime(timebase - interval_ - millisecond));
+}
+
+// Checks that invalidations between two vsyncs make a single frame.
+TEST_F(FrameSchedulerTest, CoalescesInvalidations) {
+  scheduler_.SetNeedsFrame();
+  scheduler_.SetNeedsFrame();
+  scheduler_.SetNeedsFrame();
+  EXPECT_TRUE(scheduler_.needs_frame());
+  EXPECT_EQ(0, client_.frame_count());
+
+  base::TimeTicks frame_time =
+      scheduler_.NextFrameTime(base::TimeTicks::Now());
+  scheduler_.OnVSync(frame_time);
+  EXPECT_EQ(1, client_.frame_count());
+  EXPECT_EQ(frame_time, client_.last_frame_time());
+  EXPECT_FALSE(scheduler_.needs_frame());
+  EXPECT_TRUE(scheduler_.frame_in_progress());
+  EXPECT_EQ(frame_time + interval_, scheduler_.deadline());
+
+  // Nothing was invalidated since.
+  scheduler_.OnVSync(frame_time + interval_);
+  EXPECT_EQ(1, client_.frame_count());
+}
+
+// Checks that a frame that asks for another one gets it at the next vsync.
+TEST_F(FrameSchedulerTest, FrameAsksForNext) {
+  client_.set_redraw_scheduler(&scheduler_);
+  scheduler_.SetNeedsFrame();
+  base::TimeTicks frame_time =
+      scheduler_.NextFrameTime(base::TimeTicks::Now());
+  scheduler_.OnVSync(frame_time);
+  EXPECT_EQ(1, client_.frame_count());
+  EXPECT_TRUE(scheduler_.needs_frame());
+
+  client_.set_redraw_scheduler(NULL);
+  scheduler_.OnVSync(frame_time + interval_);
+  EXPECT_EQ(2, client_.frame_count());
+  EXPECT_FALSE(scheduler_.needs_frame());
+}
+
+// Checks that frames that finish after their deadline are counted, and that
+// frame times go in the right buckets.
+TEST_F(FrameSchedulerTest, Deadlines) {
+  base::TimeTicks frame_time =
+      scheduler_.NextFrameTime(base::TimeTicks::Now());
+  EXPECT_FALSE(scheduler_.DidFinishFrame(frame_time));
+
+  scheduler_.SetNeedsFrame();
+  scheduler_.OnVSync(frame_time);
+  EXPECT_TRUE(scheduler_.DidFinishFrame(frame_time + interval_ / 2));
+  EXPECT_FALSE(scheduler_.frame_in_progress());
+
+  frame_time += interval_;
+  scheduler_.SetNeedsFrame();
+  scheduler_.OnVSync(frame_time);
+  EXPECT_TRUE(scheduler_.DidFinishFrame(frame_time + interval_ * 5 / 2));
+
+  frame_time += 3 * interval_;
+  scheduler_.SetNeedsFrame();
+  scheduler_.OnVSync(frame_time);
+  EXPECT_TRUE(scheduler_.DidFinishFrame(frame_time + 10 * interval_));
+
+  const FrameStatistics& statistics = scheduler_.statistics();
+  EXPECT_EQ(3, statistics.frame_count);
+  EXPECT_EQ(2, statistics.missed_deadline_count);
+  EXPECT_EQ(10 * interval_, statistics.last_frame_time);
+  ASSERT_EQ(4u, statistics.frame_time_histogram.size());
+  EXPECT_EQ(1, statistics.frame_time_histogram[0]);
+  EXPECT_EQ(0, statistics.frame_time_histogram[1]);
+  EXPECT_EQ(1, statistics.frame_time_histogram[2]);
+  EXPECT_EQ(1, statistics.frame_time_histogram[3]);
+}
+
+// Checks that without an interval frames begin as soon as they are needed.
+TEST_F(FrameSchedulerTest, NoInterval) {
+  TestFrameSchedulerClient client;
+  FrameScheduler scheduler(&client, base::TimeDelta());
+  scheduler.SetNeedsFrame();
+  EXPECT_EQ(1, client.frame_count());
+  EXPECT_FALSE(scheduler.needs_frame());
+  scheduler.SetNeedsFrame();
+  EXPECT_EQ(2, client.frame_count());
+}
+
+// Checks that the animators are stepped at the beginning of frames.
+TEST_F(FrameSchedulerTest, StepsAnimators) {
+  scoped_ptr<LayerAnimator> animator(LayerAnimator::CreateDefaultAnimator());
+  TestLayerAnimationDelegate delegate;
+  animator->SetDelegate(&delegate);
+  delegate.SetOpacityFromAnimation(0.0f);
+
+  base::TimeDelta duration = base::TimeDelta::FromMilliseconds(100);
+  animator->StartAnimation(new LayerAnimationSequence(
+      LayerAnimationElement::CreateOpacityElement(1.0f, duration)));
+  EXPECT_TRUE(animator->is_animating());
+  base::TimeTicks start_time = animator->last_step_time();
+
+  scheduler_.OnVSync(start_time + duration / 2);
+  EXPECT_FLOAT_EQ(0.5f, delegate.GetOpacityForAnimation());
+  EXPECT_EQ(0, client_.frame_count());
+
+  scheduler_.OnVSync(start_time + duration);
+  EXPECT_FLOAT_EQ(1.0f, delegate.GetOpacityForAnimation());
+  EXPECT_FALSE(animator->is_animating());
+}
+
+}  // namespace ui
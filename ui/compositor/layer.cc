@@ -6,22 +6,32 @@
 
 #include <algorithm>
 
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/debug/trace_event.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "third_party/WebKit/Source/Platform/chromium/public/WebAnimation.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebContentLayer.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebExternalTextureLayer.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebFilterOperation.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebFilterOperations.h"
+#include "third_party/WebKit/Source/Platform/chromium/public/WebFloatAnimationCurve.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebFloatPoint.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebFloatRect.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebSize.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebSolidColorLayer.h"
+#include "third_party/WebKit/Source/Platform/chromium/public/WebTransformAnimationCurve.h"
+#include "third_party/WebKit/Source/Platform/chromium/public/WebTransformOperations.h"
+#include "third_party/WebKit/Source/Platform/chromium/public/WebTransformationMatrix.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPicture.h"
 #include "ui/base/animation/animation.h"
 #include "ui/compositor/compositor_switches.h"
 #include "ui/compositor/dip_util.h"
 #include "ui/compositor/layer_animator.h"
+#include "ui/compositor/layer_rasterizer.h"
+#include "ui/compositor/threaded_layer_animation.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/display.h"
 #include "ui/gfx/interpolated_transform.h"
@@ -40,10 +50,58 @@ const ui::Layer* GetRoot(const ui::Layer* layer) {
   return layer->parent() ? GetRoot(layer->parent()) : layer;
 }
 
+// Ids of threaded animations; also used as their group ids, so that each
+// starts on its own.
+int g_next_threaded_animation_id = 1;
+
+WebKit::WebTransformationMatrix ToWebTransformationMatrix(
+    const ui::Transform& transform) {
+  // WebTransformationMatrix names its entries column first.
+  const SkMatrix44& m = transform.matrix();
+  return WebKit::WebTransformationMatrix(
+      m.get(0, 0), m.get(1, 0), m.get(2, 0), m.get(3, 0),
+      m.get(0, 1), m.get(1, 1), m.get(2, 1), m.get(3, 1),
+      m.get(0, 2), m.get(1, 2), m.get(2, 2), m.get(3, 2),
+      m.get(0, 3), m.get(1, 3), m.get(2, 3), m.get(3, 3));
+}
+
+// Returns true if |transform| keeps a layer in the plane of its parent, so
+// that composing it with 2D transforms is exact.
+bool IsFlat(const ui::Transform& transform) {
+  const SkMatrix44& m = transform.matrix();
+  return m.get(0, 2) == 0 && m.get(1, 2) == 0 &&
+      m.get(2, 0) == 0 && m.get(2, 1) == 0 &&
+      m.get(3, 0) == 0 && m.get(3, 1) == 0 && m.get(3, 2) == 0 &&
+      m.get(3, 3) == 1;
+}
+
+// Maps a layer of |size| with |matrix|. |outer| gets the smallest rect that
+// holds the result. |inner| gets the largest rect it holds, which is empty
+// unless the layer stays axis-aligned.
+void MapLayerRect(const SkMatrix& matrix,
+                  const gfx::Size& size,
+                  SkIRect* outer,
+                  SkIRect* inner) {
+  SkRect rect = SkRect::MakeWH(SkIntToScalar(size.width()),
+                               SkIntToScalar(size.height()));
+  bool stays_rect = matrix.mapRect(&rect);
+  rect.roundOut(outer);
+  if (stays_rect) {
+    inner->set(SkScalarCeilToInt(rect.fLeft),
+               SkScalarCeilToInt(rect.fTop),
+               SkScalarFloorToInt(rect.fRight),
+               SkScalarFloorToInt(rect.fBottom));
+  } else {
+    inner->setEmpty();
+  }
+}
+
 }  // namespace
 
 namespace ui {
 
+const int Layer::kTileSize = 256;
+
 Layer::Layer()
     : type_(LAYER_TEXTURED),
       compositor_(NULL),
@@ -51,7 +109,10 @@ Layer::Layer()
       visible_(true),
       force_render_surface_(false),
       fills_bounds_opaquely_(true),
+      occluded_(false),
+      texture_evicted_(false),
       layer_updated_externally_(false),
+      paint_in_tiles_(false),
       opacity_(1.0f),
       background_blur_radius_(0),
       layer_saturation_(0.0f),
@@ -70,7 +131,10 @@ Layer::Layer(LayerType type)
       visible_(true),
       force_render_surface_(false),
       fills_bounds_opaquely_(true),
+      occluded_(false),
+      texture_evicted_(false),
       layer_updated_externally_(false),
+      paint_in_tiles_(false),
       opacity_(1.0f),
       background_blur_radius_(0),
       layer_saturation_(0.0f),
@@ -170,6 +234,10 @@ LayerAnimator* Layer::GetAnimator() {
   return animator_.get();
 }
 
+bool Layer::IsAnimating() const {
+  return animator_.get() && animator_->is_animating();
+}
+
 void Layer::SetTransform(const ui::Transform& transform) {
   GetAnimator()->SetTransform(transform);
 }
@@ -275,6 +343,12 @@ bool Layer::ShouldDraw() const {
   return type_ != LAYER_NOT_DRAWN && GetCombinedOpacity() > 0.0f;
 }
 
+void Layer::ComputeOcclusion() {
+  DCHECK(!parent_);
+  SkRegion occlusion;
+  ComputeOcclusionForSubtree(Transform(), 1.0f, true, NULL, &occlusion);
+}
+
 // static
 void Layer::ConvertPointToLayer(const Layer* source,
                                 const Layer* target,
@@ -309,37 +383,60 @@ void Layer::SetExternalTexture(Texture* texture) {
   texture_ = texture;
   if (web_layer_is_accelerated_ != layer_updated_externally_) {
     // Switch to a different type of layer.
-    web_layer_.removeAllChildren();
-    WebKit::WebLayer new_layer;
     if (layer_updated_externally_) {
       WebKit::WebExternalTextureLayer texture_layer =
           WebKit::WebExternalTextureLayer::create();
       texture_layer.setFlipped(texture_->flipped());
-      new_layer = texture_layer;
+      ReplaceWebLayer(texture_layer);
     } else {
-      new_layer = WebKit::WebContentLayer::create(this);
-    }
-    if (parent_) {
-      DCHECK(!parent_->web_layer_.isNull());
-      parent_->web_layer_.replaceChild(web_layer_, new_layer);
+      ReplaceWebLayer(WebKit::WebContentLayer::create(this));
     }
-    web_layer_ = new_layer;
     web_layer_is_accelerated_ = layer_updated_externally_;
-    for (size_t i = 0; i < children_.size(); ++i) {
-      DCHECK(!children_[i]->web_layer_.isNull());
-      web_layer_.addChild(children_[i]->web_layer_);
-    }
-    web_layer_.setAnchorPoint(WebKit::WebFloatPoint(0.f, 0.f));
-    web_layer_.setOpaque(fills_bounds_opaquely_);
-    web_layer_.setOpacity(visible_ ? opacity_ : 0.f);
-    web_layer_.setDebugBorderWidth(show_debug_borders_ ? 2 : 0);
-    web_layer_.setForceRenderSurface(force_render_surface_);
-    RecomputeTransform();
+    texture_evicted_ = false;
     RecomputeDebugBorderColor();
   }
   RecomputeDrawsContentAndUVRect();
 }
 
+size_t Layer::GetTextureMemoryBytes() const {
+  if (type_ != LAYER_TEXTURED || texture_evicted_)
+    return 0;
+  gfx::Size size;
+  if (web_layer_is_accelerated_)
+    size = texture_->size();
+  else if (delegate_)
+    size = ConvertSizeToPixel(this, bounds_.size());
+  return static_cast<size_t>(size.width()) * size.height() * 4;
+}
+
+bool Layer::CanEvictTexture() const {
+  return type_ == LAYER_TEXTURED && !web_layer_is_accelerated_ && delegate_ &&
+      parent_ && !texture_evicted_;
+}
+
+void Layer::EvictTexture() {
+  DCHECK(CanEvictTexture());
+  // The tiles of the content layer go away with it; the new one has none.
+  ReplaceWebLayer(WebKit::WebContentLayer::create(this));
+  texture_evicted_ = true;
+  damaged_region_.setEmpty();
+  damaged_tiles_.setEmpty();
+  if (rasterizer_.get())
+    rasterizer_->Clear();
+  rasterized_tiles_.clear();
+  RecomputeDrawsContentAndUVRect();
+}
+
+void Layer::RestoreTexture() {
+  if (!texture_evicted_)
+    return;
+  texture_evicted_ = false;
+  RecomputeDrawsContentAndUVRect();
+  // Like when uncovered, the compositor sends the damage right away.
+  damaged_region_.op(0, 0, bounds_.width(), bounds_.height(),
+                     SkRegion::kUnion_Op);
+}
+
 void Layer::SetColor(SkColor color) {
   DCHECK_EQ(type_, LAYER_SOLID_COLOR);
   // WebColor is equivalent to SkColor, per WebColor.h.
@@ -367,7 +464,7 @@ void Layer::ScheduleDraw() {
     compositor->ScheduleDraw();
 }
 
-void Layer::SendDamagedRects() {
+bool Layer::SendDamagedRects(int* tile_budget) {
   if ((delegate_ || texture_) && !damaged_region_.isEmpty()) {
     for (SkRegion::Iterator iter(damaged_region_);
          !iter.done(); iter.next()) {
@@ -384,21 +481,67 @@ void Layer::SendDamagedRects() {
       }
 
       gfx::Rect damaged_in_pixel = ConvertRectToPixel(this, damaged);
-      WebKit::WebFloatRect web_rect(
-          damaged_in_pixel.x(),
-          damaged_in_pixel.y(),
-          damaged_in_pixel.width(),
-          damaged_in_pixel.height());
-      if (!web_layer_is_accelerated_)
-        web_layer_.to<WebKit::WebContentLayer>().invalidateRect(web_rect);
-      else
-        web_layer_.to<WebKit::WebExternalTextureLayer>().invalidateRect(
-            web_rect);
+      if (paint_in_tiles_ && !web_layer_is_accelerated_) {
+        AddDamagedTiles(damaged_in_pixel);
+        continue;
+      }
+      InvalidateWebLayerRect(damaged_in_pixel);
     }
     damaged_region_.setEmpty();
   }
-  for (size_t i = 0; i < children_.size(); ++i)
-    children_[i]->SendDamagedRects();
+
+  bool sent_all = SendDamagedTiles(tile_budget);
+  for (size_t i = 0; i < children_.size(); ++i) {
+    if (!children_[i]->SendDamagedRects(tile_budget))
+      sent_all = false;
+  }
+  return sent_all;
+}
+
+bool Layer::SendRasterizedTiles(size_t* upload_budget_bytes) {
+  while (!rasterized_tiles_.empty() && *upload_budget_bytes > 0) {
+    const gfx::Rect& tile = rasterized_tiles_.front();
+    size_t tile_bytes = static_cast<size_t>(tile.width()) * tile.height() * 4;
+    InvalidateWebLayerRect(tile);
+    *upload_budget_bytes -= std::min(tile_bytes, *upload_budget_bytes);
+    rasterized_tiles_.pop_front();
+  }
+
+  bool sent_all = rasterized_tiles_.empty();
+  for (size_t i = 0; i < children_.size(); ++i) {
+    if (!children_[i]->SendRasterizedTiles(upload_budget_bytes))
+      sent_all = false;
+  }
+  return sent_all;
+}
+
+void Layer::SetPaintInTiles(bool paint_in_tiles) {
+  if (paint_in_tiles_ == paint_in_tiles)
+    return;
+  paint_in_tiles_ = paint_in_tiles;
+  if (paint_in_tiles_ && CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kUIEnableThreadedRaster)) {
+    rasterizer_.reset(new LayerRasterizer(
+        base::Bind(&Layer::OnTileRasterized, base::Unretained(this))));
+  } else {
+    rasterizer_.reset();
+  }
+  rasterized_tiles_.clear();
+  if (!paint_in_tiles_ && !damaged_tiles_.isEmpty()) {
+    // Send the tiles left for later at the next frame.
+    gfx::Rect bounds_in_pixel(ConvertSizeToPixel(this, bounds_.size()));
+    for (SkRegion::Iterator iter(damaged_tiles_); !iter.done(); iter.next()) {
+      const SkIRect& rect = iter.rect();
+      InvalidateWebLayerRect(gfx::Rect(rect.x(), rect.y(), rect.width(),
+          rect.height()).Intersect(bounds_in_pixel));
+    }
+    damaged_tiles_.setEmpty();
+    ScheduleDraw();
+  }
+}
+
+void Layer::SetPaintPriorityRect(const gfx::Rect& rect) {
+  paint_priority_rect_ = rect;
 }
 
 void Layer::SuppressPaint() {
@@ -412,6 +555,7 @@ void Layer::SuppressPaint() {
 void Layer::OnDeviceScaleFactorChanged(float device_scale_factor) {
   if (device_scale_factor_ == device_scale_factor)
     return;
+  FinishThreadedAnimations(LayerAnimationElement::TRANSFORM);
   device_scale_factor_ = device_scale_factor;
   RecomputeTransform();
   RecomputeDrawsContentAndUVRect();
@@ -429,17 +573,42 @@ void Layer::paintContents(WebKit::WebCanvas* web_canvas,
 #endif
                           ) {
   TRACE_EVENT0("ui", "Layer::paintContents");
+  base::TimeTicks start_time = base::TimeTicks::Now();
+  // Tiles rasterized on workers are drawn as they are; the delegate paints
+  // the rest.
+  SkRegion drawn;
+  if (rasterizer_.get()) {
+    rasterizer_->DrawTiles(web_canvas,
+                           gfx::Rect(clip.x, clip.y, clip.width, clip.height),
+                           &drawn);
+    // The tiles drawn here need not be invalidated again.
+    std::deque<gfx::Rect>::iterator it = rasterized_tiles_.begin();
+    while (it != rasterized_tiles_.end()) {
+      if (drawn.contains(SkIRect::MakeXYWH(it->x(), it->y(), it->width(),
+                                           it->height())))
+        it = rasterized_tiles_.erase(it);
+      else
+        ++it;
+    }
+  }
+  SkIRect sk_clip = SkIRect::MakeXYWH(clip.x, clip.y, clip.width, clip.height);
+  if (drawn.contains(sk_clip))
+    return;
+
   gfx::Canvas canvas(web_canvas);
-  bool scale_content = scale_content_;
-  if (scale_content) {
+  if (!drawn.isEmpty()) {
+    SkRegion remaining(sk_clip);
+    remaining.op(drawn, SkRegion::kDifference_Op);
     canvas.Save();
-    canvas.sk_canvas()->scale(SkFloatToScalar(device_scale_factor_),
-                              SkFloatToScalar(device_scale_factor_));
+    web_canvas->clipRegion(remaining);
   }
-  if (delegate_)
-    delegate_->OnPaintLayer(&canvas);
-  if (scale_content)
+  PaintWithDelegate(&canvas);
+  if (!drawn.isEmpty())
     canvas.Restore();
+
+  Compositor* compositor = GetCompositor();
+  if (compositor)
+    compositor->AddPaintTime(base::TimeTicks::Now() - start_time);
 }
 
 void Layer::SetForceRenderSurface(bool force) {
@@ -515,10 +684,251 @@ bool Layer::GetTransformRelativeTo(const Layer* ancestor,
   return p == ancestor;
 }
 
+void Layer::ComputeOcclusionForSubtree(const Transform& to_root,
+                                       float parent_opacity,
+                                       bool position_known,
+                                       const SkIRect* clip,
+                                       SkRegion* occlusion) {
+  float opacity = parent_opacity * opacity_;
+  position_known = position_known && threaded_animations_.empty() &&
+      IsFlat(transform_);
+
+  SkIRect outer;
+  SkIRect inner;
+  MapLayerRect(to_root.matrix(), bounds_.size(), &outer, &inner);
+  if (!position_known)
+    inner.setEmpty();
+
+  SkIRect children_clip_rect;
+  const SkIRect* children_clip = clip;
+  if (GetMasksToBounds()) {
+    children_clip_rect = inner;
+    if (clip && !children_clip_rect.intersect(*clip))
+      children_clip_rect.setEmpty();
+    children_clip = &children_clip_rect;
+  }
+
+  // Children are drawn above their parent, topmost last.
+  for (size_t i = children_.size(); i > 0; --i) {
+    Layer* child = children_[i - 1];
+    if (!child->visible_)
+      continue;
+    Transform child_to_root = child->transform_;
+    child_to_root.ConcatTranslate(static_cast<float>(child->bounds_.x()),
+                                  static_cast<float>(child->bounds_.y()));
+    child_to_root.ConcatTransform(to_root);
+    child->ComputeOcclusionForSubtree(child_to_root, opacity, position_known,
+                                      children_clip, occlusion);
+  }
+
+  bool occluded = type_ == LAYER_TEXTURED && position_known &&
+      occlusion->contains(outer);
+  SetOccluded(occluded);
+  if (occluded)
+    return;
+
+  // A background blur reads what is below the layer, so nothing above it can
+  // hide the layers below.
+  if (background_blur_radius_ > 0) {
+    occlusion->setEmpty();
+    return;
+  }
+
+  if (opacity == 1.0f && DrawsOpaqueBounds()) {
+    SkIRect covered = inner;
+    if (clip && !covered.intersect(*clip))
+      covered.setEmpty();
+    if (!covered.isEmpty())
+      occlusion->op(covered, SkRegion::kUnion_Op);
+  }
+}
+
+bool Layer::DrawsOpaqueBounds() const {
+  if (!fills_bounds_opaquely_)
+    return false;
+  if (type_ == LAYER_SOLID_COLOR)
+    return true;
+  if (type_ != LAYER_TEXTURED)
+    return false;
+  if (!web_layer_is_accelerated_)
+    return delegate_ != NULL;
+
+  // An external texture smaller than the bounds leaves the rest uncovered.
+  gfx::Size texture_size = scale_content_ ?
+      texture_->size() : ConvertSizeToDIP(this, texture_->size());
+  return texture_size.width() >= bounds_.width() &&
+      texture_size.height() >= bounds_.height();
+}
+
+void Layer::SetOccluded(bool occluded) {
+  if (occluded_ == occluded)
+    return;
+
+  occluded_ = occluded;
+  RecomputeDrawsContentAndUVRect();
+  if (!occluded_ && (delegate_ || texture_)) {
+    // Nothing was painted while occluded. The compositor sends the damage
+    // right after computing occlusion, so no draw needs scheduling.
+    damaged_region_.op(0, 0, bounds_.width(), bounds_.height(),
+                       SkRegion::kUnion_Op);
+  }
+  if (delegate_)
+    delegate_->OnLayerOcclusionChanged(occluded_);
+}
+
+void Layer::InvalidateWebLayerRect(const gfx::Rect& rect_in_pixel) {
+  WebKit::WebFloatRect web_rect(
+      rect_in_pixel.x(),
+      rect_in_pixel.y(),
+      rect_in_pixel.width(),
+      rect_in_pixel.height());
+  if (!web_layer_is_accelerated_)
+    web_layer_.to<WebKit::WebContentLayer>().invalidateRect(web_rect);
+  else
+    web_layer_.to<WebKit::WebExternalTextureLayer>().invalidateRect(web_rect);
+}
+
+void Layer::AddDamagedTiles(const gfx::Rect& rect_in_pixel) {
+  if (rect_in_pixel.IsEmpty())
+    return;
+  int left = rect_in_pixel.x() / kTileSize * kTileSize;
+  int top = rect_in_pixel.y() / kTileSize * kTileSize;
+  int right = (rect_in_pixel.right() + kTileSize - 1) / kTileSize * kTileSize;
+  int bottom =
+      (rect_in_pixel.bottom() + kTileSize - 1) / kTileSize * kTileSize;
+  damaged_tiles_.op(left, top, right, bottom, SkRegion::kUnion_Op);
+}
+
+bool Layer::SendDamagedTiles(int* tile_budget) {
+  if (damaged_tiles_.isEmpty())
+    return true;
+
+  gfx::Rect bounds_in_pixel(ConvertSizeToPixel(this, bounds_.size()));
+  std::vector<gfx::Rect> tiles;
+  SkRegion sent;
+  // The damaged tiles in the priority rect go first.
+  if (!paint_priority_rect_.IsEmpty()) {
+    gfx::Rect priority = ConvertRectToPixel(
+        this, paint_priority_rect_).Intersect(bounds_in_pixel);
+    SkRegion urgent(damaged_tiles_);
+    urgent.op(priority.x() / kTileSize * kTileSize,
+              priority.y() / kTileSize * kTileSize,
+              (priority.right() + kTileSize - 1) / kTileSize * kTileSize,
+              (priority.bottom() + kTileSize - 1) / kTileSize * kTileSize,
+              SkRegion::kIntersect_Op);
+    CollectTiles(urgent, bounds_in_pixel, tile_budget, &tiles, &sent);
+  }
+  SkRegion rest(damaged_tiles_);
+  rest.op(sent, SkRegion::kDifference_Op);
+  CollectTiles(rest, bounds_in_pixel, tile_budget, &tiles, &sent);
+  damaged_tiles_.op(sent, SkRegion::kDifference_Op);
+
+  if (rasterizer_.get() && delegate_ && !tiles.empty()) {
+    RecordTiles(tiles);
+  } else {
+    for (size_t i = 0; i < tiles.size(); ++i)
+      InvalidateWebLayerRect(tiles[i]);
+  }
+  return damaged_tiles_.isEmpty();
+}
+
+// static
+void Layer::CollectTiles(const SkRegion& region,
+                         const gfx::Rect& bounds_in_pixel,
+                         int* tile_budget,
+                         std::vector<gfx::Rect>* tiles,
+                         SkRegion* sent) {
+  for (SkRegion::Iterator iter(region); !iter.done(); iter.next()) {
+    const SkIRect& rect = iter.rect();
+    for (int y = rect.top(); y < rect.bottom() && *tile_budget > 0;
+         y += kTileSize) {
+      for (int x = rect.left(); x < rect.right() && *tile_budget > 0;
+           x += kTileSize) {
+        gfx::Rect tile(x, y, kTileSize, kTileSize);
+        tile = tile.Intersect(bounds_in_pixel);
+        if (!tile.IsEmpty())
+          tiles->push_back(tile);
+        sent->op(x, y, x + kTileSize, y + kTileSize, SkRegion::kUnion_Op);
+        (*tile_budget)--;
+      }
+    }
+  }
+}
+
+void Layer::RecordTiles(const std::vector<gfx::Rect>& tiles) {
+  TRACE_EVENT0("ui", "Layer::RecordTiles");
+  SkRegion area;
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    area.op(tiles[i].x(), tiles[i].y(), tiles[i].right(), tiles[i].bottom(),
+            SkRegion::kUnion_Op);
+  }
+
+  gfx::Size size_in_pixel = ConvertSizeToPixel(this, bounds_.size());
+  SkPicture picture;
+  SkCanvas* recording_canvas =
+      picture.beginRecording(size_in_pixel.width(), size_in_pixel.height());
+  recording_canvas->clipRegion(area);
+  gfx::Canvas canvas(recording_canvas);
+  PaintWithDelegate(&canvas);
+  rasterizer_->Rasterize(&picture, tiles);
+}
+
+void Layer::OnTileRasterized(const gfx::Rect& tile) {
+  // The compositor uploads the tiles it is handed in the frame that draws
+  // them, so they are handed over at the pace of the upload budget rather
+  // than as soon as the workers are done.
+  rasterized_tiles_.push_back(tile);
+  ScheduleDraw();
+}
+
+void Layer::PaintWithDelegate(gfx::Canvas* canvas) {
+  bool scale_content = scale_content_;
+  if (scale_content) {
+    canvas->Save();
+    canvas->sk_canvas()->scale(SkFloatToScalar(device_scale_factor_),
+                               SkFloatToScalar(device_scale_factor_));
+  }
+  if (delegate_)
+    delegate_->OnPaintLayer(canvas);
+  if (scale_content)
+    canvas->Restore();
+}
+
+void Layer::ReplaceWebLayer(WebKit::WebLayer new_layer) {
+  // The threaded animations play on the old web layer.
+  FinishThreadedAnimations(LayerAnimationElement::TRANSFORM);
+  FinishThreadedAnimations(LayerAnimationElement::OPACITY);
+
+  bool masks_to_bounds = GetMasksToBounds();
+  web_layer_.removeAllChildren();
+  if (parent_) {
+    DCHECK(!parent_->web_layer_.isNull());
+    parent_->web_layer_.replaceChild(web_layer_, new_layer);
+  }
+  web_layer_ = new_layer;
+  for (size_t i = 0; i < children_.size(); ++i) {
+    DCHECK(!children_[i]->web_layer_.isNull());
+    web_layer_.addChild(children_[i]->web_layer_);
+  }
+  web_layer_.setAnchorPoint(WebKit::WebFloatPoint(0.f, 0.f));
+  web_layer_.setOpaque(fills_bounds_opaquely_);
+  web_layer_.setOpacity(visible_ ? opacity_ : 0.f);
+  web_layer_.setDebugBorderWidth(show_debug_borders_ ? 2 : 0);
+  web_layer_.setForceRenderSurface(force_render_surface_);
+  web_layer_.setMasksToBounds(masks_to_bounds);
+  SetBackgroundBlur(background_blur_radius_);
+  SetLayerFilters();
+  RecomputeTransform();
+  RecomputeDebugBorderColor();
+}
+
 void Layer::SetBoundsImmediately(const gfx::Rect& bounds) {
   if (bounds == bounds_)
     return;
 
+  if (bounds.origin() != bounds_.origin())
+    FinishThreadedAnimations(LayerAnimationElement::TRANSFORM);
+
   base::Closure closure;
   if (delegate_)
     closure = delegate_->PrepareForLayerBoundsChange();
@@ -562,6 +972,9 @@ void Layer::SetVisibilityImmediately(bool visible) {
   if (visible_ == visible)
     return;
 
+  // The web layer's opacity stands in for visibility.
+  if (!visible)
+    FinishThreadedAnimations(LayerAnimationElement::OPACITY);
   visible_ = visible;
   // TODO(piman): Expose a visibility flag on WebLayer.
   web_layer_.setOpacity(visible_ ? opacity_ : 0.f);
@@ -603,6 +1016,89 @@ bool Layer::GetVisibilityForAnimation() const {
   return visible();
 }
 
+bool Layer::CanRunThreadedAnimations() const {
+  // Without a thread of its own the compositor runs on this one, and
+  // stepping here costs no more.
+  return Compositor::WasInitializedWithThread();
+}
+
+int Layer::AddThreadedAnimation(const ThreadedLayerAnimation& animation) {
+  DCHECK(!animation.keyframes.empty());
+  int id = g_next_threaded_animation_id++;
+  scoped_ptr<WebKit::WebAnimation> web_animation;
+  if (animation.property == LayerAnimationElement::OPACITY) {
+    if (!visible_)
+      return 0;
+    scoped_ptr<WebKit::WebFloatAnimationCurve> curve(
+        WebKit::WebFloatAnimationCurve::create());
+    for (size_t i = 0; i < animation.keyframes.size(); ++i) {
+      const ThreadedLayerAnimation::Keyframe& keyframe = animation.keyframes[i];
+      curve->add(WebKit::WebFloatKeyframe(keyframe.time.InSecondsF(),
+                                          keyframe.opacity),
+                 WebKit::WebAnimationCurve::TimingFunctionTypeLinear);
+    }
+    web_animation.reset(WebKit::WebAnimation::create(
+        *curve, id, id, WebKit::WebAnimation::TargetPropertyOpacity));
+  } else {
+    DCHECK_EQ(LayerAnimationElement::TRANSFORM, animation.property);
+    scoped_ptr<WebKit::WebTransformAnimationCurve> curve(
+        WebKit::WebTransformAnimationCurve::create());
+    for (size_t i = 0; i < animation.keyframes.size(); ++i) {
+      const ThreadedLayerAnimation::Keyframe& keyframe = animation.keyframes[i];
+      WebKit::WebTransformOperations operations;
+      operations.appendMatrix(ToWebTransformationMatrix(
+          GetWebLayerTransform(keyframe.transform)));
+      curve->add(WebKit::WebTransformKeyframe(keyframe.time.InSecondsF(),
+                                              operations),
+                 WebKit::WebAnimationCurve::TimingFunctionTypeLinear);
+    }
+    web_animation.reset(WebKit::WebAnimation::create(
+        *curve, id, id, WebKit::WebAnimation::TargetPropertyTransform));
+  }
+  if (!web_layer_.addAnimation(web_animation.get()))
+    return 0;
+
+  // The web layer takes the final value now, so that it has it when the
+  // animation ends on the compositor thread, before the animator here has
+  // caught up.
+  const ThreadedLayerAnimation::Keyframe& last = animation.keyframes.back();
+  if (animation.property == LayerAnimationElement::OPACITY)
+    web_layer_.setOpacity(last.opacity);
+  else
+    web_layer_.setTransform(GetWebLayerTransform(last.transform).matrix());
+
+  threaded_animations_[id] = animation.property;
+  return id;
+}
+
+void Layer::RemoveThreadedAnimation(int id) {
+  std::map<int, LayerAnimationElement::AnimatableProperty>::iterator it =
+      threaded_animations_.find(id);
+  if (it == threaded_animations_.end())
+    return;
+
+  web_layer_.removeAnimation(id);
+  // Go back to this layer's own value, which the animator sets next.
+  if (it->second == LayerAnimationElement::OPACITY)
+    web_layer_.setOpacity(visible_ ? opacity_ : 0.f);
+  else
+    RecomputeTransform();
+  threaded_animations_.erase(it);
+}
+
+void Layer::FinishThreadedAnimations(
+    LayerAnimationElement::AnimatableProperty property) {
+  for (std::map<int, LayerAnimationElement::AnimatableProperty>::iterator it =
+           threaded_animations_.begin();
+       it != threaded_animations_.end(); ++it) {
+    if (it->second == property) {
+      // Removes the animations from |threaded_animations_|.
+      animator_->StopAnimatingProperty(property);
+      return;
+    }
+  }
+}
+
 void Layer::CreateWebLayer() {
   if (type_ == LAYER_SOLID_COLOR)
     web_layer_ = WebKit::WebSolidColorLayer::create();
@@ -616,7 +1112,7 @@ void Layer::CreateWebLayer() {
   web_layer_.setDebugBorderWidth(show_debug_borders_ ? 2 : 0);
 }
 
-void Layer::RecomputeTransform() {
+Transform Layer::GetWebLayerTransform(const Transform& layer_transform) const {
   ui::Transform scale_translate;
   scale_translate.matrix().set3x3(device_scale_factor_, 0, 0,
                                   0, device_scale_factor_, 0,
@@ -626,15 +1122,20 @@ void Layer::RecomputeTransform() {
   transform.matrix().set3x3(1.0f / device_scale_factor_, 0, 0,
                             0, 1.0f / device_scale_factor_, 0,
                             0, 0, 1);
-  transform.ConcatTransform(transform_);
+  transform.ConcatTransform(layer_transform);
   transform.ConcatTranslate(bounds_.x(), bounds_.y());
   transform.ConcatTransform(scale_translate);
-  web_layer_.setTransform(transform.matrix());
+  return transform;
+}
+
+void Layer::RecomputeTransform() {
+  web_layer_.setTransform(GetWebLayerTransform(transform_).matrix());
 }
 
 void Layer::RecomputeDrawsContentAndUVRect() {
   DCHECK(!web_layer_.isNull());
-  bool should_draw = type_ != LAYER_NOT_DRAWN;
+  bool should_draw = type_ != LAYER_NOT_DRAWN && !occluded_ &&
+      !texture_evicted_;
   if (!web_layer_is_accelerated_) {
     if (type_ != LAYER_SOLID_COLOR)
       web_layer_.to<WebKit::WebContentLayer>().setDrawsContent(should_draw);
@@ -6,6 +6,8 @@
 #define UI_COMPOSITOR_LAYER_H_
 #pragma once
 
+#include <deque>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -19,6 +21,7 @@
 #include "third_party/skia/include/core/SkRegion.h"
 #include "ui/compositor/compositor.h"
 #include "ui/compositor/layer_animation_delegate.h"
+#include "ui/compositor/layer_animation_element.h"
 #include "ui/compositor/layer_delegate.h"
 #include "ui/compositor/layer_type.h"
 #include "ui/gfx/rect.h"
@@ -26,10 +29,15 @@
 
 class SkCanvas;
 
+namespace gfx {
+class Canvas;
+}
+
 namespace ui {
 
 class Compositor;
 class LayerAnimator;
+class LayerRasterizer;
 class Texture;
 
 // Layer manages a texture, transform and a set of child Layers. Any View that
@@ -103,6 +111,10 @@ class COMPOSITOR_EXPORT Layer :
   // been set. Will not return NULL.
   LayerAnimator* GetAnimator();
 
+  // Returns true if the animator of the layer is animating. Unlike
+  // GetAnimator(), doesn't create an animator.
+  bool IsAnimating() const;
+
   // The transform, relative to the parent.
   void SetTransform(const Transform& transform);
   const Transform& transform() const { return transform_; }
@@ -180,6 +192,31 @@ class COMPOSITOR_EXPORT Layer :
   void SetFillsBoundsOpaquely(bool fills_bounds_opaquely);
   bool fills_bounds_opaquely() const { return fills_bounds_opaquely_; }
 
+  // Returns true if opaque layers above cover this layer completely, as of
+  // the last ComputeOcclusion(). An occluded layer is neither painted nor
+  // drawn.
+  bool occluded() const { return occluded_; }
+
+  // Finds the layers of the tree that are covered by opaque layers above them
+  // and stops painting and drawing them. Called on the root layer by the
+  // compositor before each frame.
+  void ComputeOcclusion();
+
+  // Returns the bytes that the layer's own texture takes, estimated from its
+  // size in pixels.
+  size_t GetTextureMemoryBytes() const;
+
+  // Returns true if the texture of the layer can be dropped and repainted
+  // later, which is the case for textured layers that aren't the root and that
+  // their delegate paints.
+  bool CanEvictTexture() const;
+
+  // Drops the texture of the layer, which stops painting until
+  // RestoreTexture(). Called by TextureBudget on layers that aren't drawn.
+  void EvictTexture();
+  void RestoreTexture();
+  bool texture_evicted() const { return texture_evicted_; }
+
   const std::string& name() const { return name_; }
   void set_name(const std::string& name) { name_ = name; }
 
@@ -202,8 +239,17 @@ class COMPOSITOR_EXPORT Layer :
   void ScheduleDraw();
 
   // Sends damaged rectangles recorded in |damaged_region_| to
-  // |compostior_| to repaint the content.
-  void SendDamagedRects();
+  // |compostior_| to repaint the content. Layers that paint in tiles send at
+  // most |*tile_budget| tiles, which they take from it, and keep the others
+  // for the next frames. Returns false if some damage was kept.
+  bool SendDamagedRects(int* tile_budget);
+
+  // Invalidates the tiles rasterized on workers since the last frame, for the
+  // compositor to upload them, until |*upload_budget_bytes| runs out. Each
+  // tile costs its size in bytes, taken from the budget; one tile is sent
+  // even if it costs more than is left. Returns false if some tiles are left
+  // for the next frames.
+  bool SendRasterizedTiles(size_t* upload_budget_bytes);
 
   // Suppresses painting the content by disgarding damaged region and ignoring
   // new paint requests.
@@ -222,6 +268,27 @@ class COMPOSITOR_EXPORT Layer :
   // Returns true if the layer scales its content.
   bool scale_content() const { return scale_content_; }
 
+  // Sets whether the layer repaints in tiles of kTileSize pixels: damage is
+  // rounded out to whole tiles, and the compositor repaints and uploads a
+  // limited number of tiles per frame, spreading large repaints over several
+  // frames. Meant for large layers, like full-screen windows. With
+  // --ui-enable-threaded-raster, the tiles are recorded on the UI thread and
+  // rasterized on worker threads.
+  void SetPaintInTiles(bool paint_in_tiles);
+  bool paint_in_tiles() const { return paint_in_tiles_; }
+
+  // Sets the part of the layer, in DIP, whose damaged tiles are sent before
+  // the others, for example the visible part of a scrolled layer and the
+  // part about to be scrolled into view. Empty by default.
+  void SetPaintPriorityRect(const gfx::Rect& rect);
+  const gfx::Rect& paint_priority_rect() const { return paint_priority_rect_; }
+
+  // The rasterizer of the tiles, if they are rasterized on worker threads.
+  const LayerRasterizer* rasterizer() const { return rasterizer_.get(); }
+
+  // The side of the tiles of layers that paint in tiles, in pixels.
+  static const int kTileSize;
+
   // Sometimes the Layer is being updated by something other than SetCanvas
   // (e.g. the GPU process on UI_COMPOSITOR_IMAGE_TRANSPORT).
   bool layer_updated_externally() const { return layer_updated_externally_; }
@@ -260,6 +327,58 @@ class COMPOSITOR_EXPORT Layer :
   bool GetTransformRelativeTo(const Layer* ancestor,
                               Transform* transform) const;
 
+  // Computes occlusion for this layer and its descendants, front to back.
+  // |to_root| maps the layer to the root. |parent_opacity| is the combined
+  // opacity of the ancestors. |position_known| is false if the layer might be
+  // drawn somewhere else than its properties say, e.g. while a threaded
+  // animation moves an ancestor. |clip|, if not NULL, bounds what the
+  // ancestors let the layer draw. |occlusion| is the region of the root that
+  // the layers visited so far cover opaquely.
+  void ComputeOcclusionForSubtree(const Transform& to_root,
+                                  float parent_opacity,
+                                  bool position_known,
+                                  const SkIRect* clip,
+                                  SkRegion* occlusion);
+
+  // Returns true if the layer draws opaque pixels over all its bounds.
+  bool DrawsOpaqueBounds() const;
+
+  void SetOccluded(bool occluded);
+
+  // Invalidates |rect_in_pixel| of |web_layer_|, for the compositor to
+  // repaint or update it.
+  void InvalidateWebLayerRect(const gfx::Rect& rect_in_pixel);
+
+  // Adds the tiles that |rect_in_pixel| touches to |damaged_tiles_|.
+  void AddDamagedTiles(const gfx::Rect& rect_in_pixel);
+
+  // Invalidates as many of |damaged_tiles_| as |*tile_budget| allows, and
+  // takes them from it. Returns false if some tiles are left.
+  bool SendDamagedTiles(int* tile_budget);
+
+  // Adds the tiles of |region|, a union of whole tiles in pixels, clipped to
+  // |bounds_in_pixel|, to |tiles| and |sent| while |*tile_budget| lasts.
+  static void CollectTiles(const SkRegion& region,
+                           const gfx::Rect& bounds_in_pixel,
+                           int* tile_budget,
+                           std::vector<gfx::Rect>* tiles,
+                           SkRegion* sent);
+
+  // Records the contents of |tiles|, in pixels, for |rasterizer_|.
+  void RecordTiles(const std::vector<gfx::Rect>& tiles);
+
+  // Queues a tile that |rasterizer_| has rasterized, for SendRasterizedTiles()
+  // to have it drawn.
+  void OnTileRasterized(const gfx::Rect& tile);
+
+  // Has the delegate paint into |canvas|, scaled if the layer scales its
+  // content.
+  void PaintWithDelegate(gfx::Canvas* canvas);
+
+  // Replaces |web_layer_| with |new_layer|, which takes over its children and
+  // properties.
+  void ReplaceWebLayer(WebKit::WebLayer new_layer);
+
   // The only externally updated layers are ones that get their pixels from
   // WebKit and WebKit does not produce valid alpha values. All other layers
   // should have valid alpha.
@@ -282,8 +401,21 @@ class COMPOSITOR_EXPORT Layer :
   virtual const Transform& GetTransformForAnimation() const OVERRIDE;
   virtual float GetOpacityForAnimation() const OVERRIDE;
   virtual bool GetVisibilityForAnimation() const OVERRIDE;
+  virtual bool CanRunThreadedAnimations() const OVERRIDE;
+  virtual int AddThreadedAnimation(
+      const ThreadedLayerAnimation& animation) OVERRIDE;
+  virtual void RemoveThreadedAnimation(int id) OVERRIDE;
+
+  // Finishes the threaded animations of |property|, whose keyframes were
+  // made for the position, device scale and visibility the layer had then.
+  void FinishThreadedAnimations(
+      LayerAnimationElement::AnimatableProperty property);
 
   void CreateWebLayer();
+
+  // Returns the transform of the web layer for |transform|, which adds the
+  // position of the layer and its device scale.
+  Transform GetWebLayerTransform(const Transform& transform) const;
   void RecomputeTransform();
   void RecomputeDrawsContentAndUVRect();
   void RecomputeDebugBorderColor();
@@ -313,6 +445,12 @@ class COMPOSITOR_EXPORT Layer :
 
   bool fills_bounds_opaquely_;
 
+  // Whether opaque layers above cover this one. See occluded().
+  bool occluded_;
+
+  // Whether the texture was dropped to save memory. See EvictTexture().
+  bool texture_evicted_;
+
   // If true the layer is always up to date.
   bool layer_updated_externally_;
 
@@ -320,6 +458,16 @@ class COMPOSITOR_EXPORT Layer :
   // compositor is ready to paint the content.
   SkRegion damaged_region_;
 
+  // See SetPaintInTiles(). |damaged_tiles_| holds the damaged tiles that are
+  // left for the next frames, in pixels.
+  bool paint_in_tiles_;
+  SkRegion damaged_tiles_;
+  gfx::Rect paint_priority_rect_;
+  scoped_ptr<LayerRasterizer> rasterizer_;
+  // The tiles |rasterizer_| has ready that are left to invalidate, in pixels,
+  // oldest first.
+  std::deque<gfx::Rect> rasterized_tiles_;
+
   float opacity_;
   int background_blur_radius_;
 
@@ -337,6 +485,11 @@ class COMPOSITOR_EXPORT Layer :
 
   WebKit::WebLayer web_layer_;
   bool web_layer_is_accelerated_;
+
+  // The property of each animation the compositor thread is playing on
+  // |web_layer_|, by id.
+  std::map<int, LayerAnimationElement::AnimatableProperty>
+      threaded_animations_;
   bool show_debug_borders_;
 
   // If true, the layer scales the canvas and the texture with the device scale
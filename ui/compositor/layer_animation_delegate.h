@@ -12,6 +12,8 @@
 
 namespace ui {
 
+struct ThreadedLayerAnimation;
+
 // Layer animations interact with the layers using this interface.
 class COMPOSITOR_EXPORT LayerAnimationDelegate {
  public:
@@ -25,6 +27,22 @@ class COMPOSITOR_EXPORT LayerAnimationDelegate {
   virtual float GetOpacityForAnimation() const = 0;
   virtual bool GetVisibilityForAnimation() const = 0;
 
+  // Returns true if the compositor can play transform and opacity
+  // animations on its own thread, so that the animator need not step them.
+  virtual bool CanRunThreadedAnimations() const { return false; }
+
+  // Hands |animation| to the compositor to play on its own thread, and
+  // returns an id for RemoveThreadedAnimation().  The property keeps its
+  // value here, as far as the Get*ForAnimation() methods are concerned, until
+  // the animator sets it.  Returns 0 if the delegate can't play this one, in
+  // which case the animator steps the animation itself.
+  virtual int AddThreadedAnimation(const ThreadedLayerAnimation& animation) {
+    return 0;
+  }
+
+  // Stops a threaded animation that has not ended, or forgets one that has.
+  virtual void RemoveThreadedAnimation(int id) {}
+
  protected:
   virtual ~LayerAnimationDelegate() {}
 };
@@ -4,16 +4,74 @@
 
 #include "ui/compositor/layer_animation_sequence.h"
 
+#include <math.h>
+
 #include <algorithm>
 #include <iterator>
 
+#include "base/compiler_specific.h"
 #include "base/debug/trace_event.h"
 #include "ui/compositor/layer_animation_delegate.h"
 #include "ui/compositor/layer_animation_element.h"
 #include "ui/compositor/layer_animation_observer.h"
+#include "ui/compositor/threaded_layer_animation.h"
 
 namespace ui {
 
+namespace {
+
+// The interval between the samples of an element played by the compositor.
+const double kThreadedKeyframeIntervalMs = 1000.0 / 60.0;
+
+// Takes in the values that elements set, starting from those of another
+// delegate, so that a sequence can be sampled without touching its layer.
+class SamplingDelegate : public LayerAnimationDelegate {
+ public:
+  explicit SamplingDelegate(const LayerAnimationDelegate* delegate)
+      : bounds_(delegate->GetBoundsForAnimation()),
+        transform_(delegate->GetTransformForAnimation()),
+        opacity_(delegate->GetOpacityForAnimation()),
+        visibility_(delegate->GetVisibilityForAnimation()) {
+  }
+  virtual ~SamplingDelegate() {}
+
+  virtual void SetBoundsFromAnimation(const gfx::Rect& bounds) OVERRIDE {
+    bounds_ = bounds;
+  }
+  virtual void SetTransformFromAnimation(const Transform& transform) OVERRIDE {
+    transform_ = transform;
+  }
+  virtual void SetOpacityFromAnimation(float opacity) OVERRIDE {
+    opacity_ = opacity;
+  }
+  virtual void SetVisibilityFromAnimation(bool visibility) OVERRIDE {
+    visibility_ = visibility;
+  }
+  virtual void ScheduleDrawForAnimation() OVERRIDE {}
+  virtual const gfx::Rect& GetBoundsForAnimation() const OVERRIDE {
+    return bounds_;
+  }
+  virtual const Transform& GetTransformForAnimation() const OVERRIDE {
+    return transform_;
+  }
+  virtual float GetOpacityForAnimation() const OVERRIDE {
+    return opacity_;
+  }
+  virtual bool GetVisibilityForAnimation() const OVERRIDE {
+    return visibility_;
+  }
+
+ private:
+  gfx::Rect bounds_;
+  Transform transform_;
+  float opacity_;
+  bool visibility_;
+
+  DISALLOW_COPY_AND_ASSIGN(SamplingDelegate);
+};
+
+}  // namespace
+
 LayerAnimationSequence::LayerAnimationSequence()
     : is_cyclic_(false),
       last_element_(0) {
@@ -98,6 +156,74 @@ void LayerAnimationSequence::Abort() {
   NotifyAborted();
 }
 
+bool LayerAnimationSequence::GetThreadedAnimations(
+    const LayerAnimationDelegate* delegate,
+    std::vector<ThreadedLayerAnimation>* animations) {
+  if (is_cyclic_ || elements_.empty())
+    return false;
+  bool has_transform = false;
+  bool has_opacity = false;
+  for (LayerAnimationElement::AnimatableProperties::const_iterator iter =
+           properties_.begin(); iter != properties_.end(); ++iter) {
+    if (*iter == LayerAnimationElement::TRANSFORM)
+      has_transform = true;
+    else if (*iter == LayerAnimationElement::OPACITY)
+      has_opacity = true;
+    else
+      return false;
+  }
+  for (size_t i = 0; i < elements_.size(); ++i) {
+    if (elements_[i]->duration() == base::TimeDelta())
+      return false;
+  }
+
+  ThreadedLayerAnimation transform_animation;
+  transform_animation.property = LayerAnimationElement::TRANSFORM;
+  ThreadedLayerAnimation opacity_animation;
+  opacity_animation.property = LayerAnimationElement::OPACITY;
+
+  // Each element finishes at t = 1, which leaves it ready to be run again
+  // for real.  An element starts where the one before it finished, so only
+  // the first sample of the first element is taken at t = 0.
+  SamplingDelegate sampler(delegate);
+  base::TimeDelta element_start;
+  ThreadedLayerAnimation::Keyframe keyframe;
+  keyframe.opacity = sampler.GetOpacityForAnimation();
+  keyframe.transform = sampler.GetTransformForAnimation();
+  transform_animation.keyframes.push_back(keyframe);
+  opacity_animation.keyframes.push_back(keyframe);
+  for (size_t i = 0; i < elements_.size(); ++i) {
+    LayerAnimationElement* element = elements_[i].get();
+    double duration_ms = element->duration().InMillisecondsF();
+    int samples = std::max(
+        1, static_cast<int>(ceil(duration_ms / kThreadedKeyframeIntervalMs)));
+    element->Progress(0.0, &sampler);
+    for (int j = 1; j <= samples; ++j) {
+      double t = static_cast<double>(j) / samples;
+      element->Progress(t, &sampler);
+      keyframe.time = element_start + base::TimeDelta::FromMicroseconds(
+          static_cast<int64>(t * element->duration().InMicroseconds()));
+      keyframe.opacity = sampler.GetOpacityForAnimation();
+      keyframe.transform = sampler.GetTransformForAnimation();
+      if (element->properties().count(LayerAnimationElement::TRANSFORM) ||
+          j == samples) {
+        transform_animation.keyframes.push_back(keyframe);
+      }
+      if (element->properties().count(LayerAnimationElement::OPACITY) ||
+          j == samples) {
+        opacity_animation.keyframes.push_back(keyframe);
+      }
+    }
+    element_start += element->duration();
+  }
+
+  if (has_transform)
+    animations->push_back(transform_animation);
+  if (has_opacity)
+    animations->push_back(opacity_animation);
+  return true;
+}
+
 void LayerAnimationSequence::AddElement(LayerAnimationElement* element) {
   // Update duration and properties.
   duration_ += element->duration();
@@ -19,6 +19,7 @@ namespace ui {
 
 class LayerAnimationDelegate;
 class LayerAnimationObserver;
+struct ThreadedLayerAnimation;
 
 // Contains a collection of layer animation elements to be played one after
 // another. Although it has a similar interface to LayerAnimationElement, it is
@@ -48,6 +49,17 @@ class COMPOSITOR_EXPORT LayerAnimationSequence {
   // Aborts the given animation.
   void Abort();
 
+  // Appends to |animations| keyframes for the compositor that play the
+  // sequence from the current values of |delegate|, one animation for each
+  // property.  The elements are sampled at about the display's frame rate,
+  // so any tween or interpolated transform comes out right.  Returns false,
+  // appending nothing, if the sequence can't be played that way: it is
+  // cyclic, an element takes no time, or it animates bounds or visibility.
+  // Sampling runs the elements, so call this just before the sequence
+  // starts.
+  bool GetThreadedAnimations(const LayerAnimationDelegate* delegate,
+                             std::vector<ThreadedLayerAnimation>* animations);
+
   // All properties modified by the sequence.
   const LayerAnimationElement::AnimatableProperties& properties() const {
     return properties_;
@@ -4,16 +4,20 @@
 
 #include "ui/compositor/layer_animation_sequence.h"
 
+#include <vector>
+
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/time.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "ui/base/animation/tween.h"
 #include "ui/compositor/layer_animation_delegate.h"
 #include "ui/compositor/layer_animation_element.h"
 #include "ui/compositor/test/test_layer_animation_delegate.h"
 #include "ui/compositor/test/test_layer_animation_observer.h"
 #include "ui/compositor/test/test_utils.h"
+#include "ui/compositor/threaded_layer_animation.h"
 #include "ui/gfx/rect.h"
 #include "ui/gfx/transform.h"
 
@@ -192,6 +196,69 @@ TEST(LayerAnimationSequenceTest, AddObserver) {
   }
 }
 
+// Check that the keyframes for the compositor follow the tween of each
+// element, and that the sequence still runs normally afterwards.
+TEST(LayerAnimationSequenceTest, ThreadedAnimations) {
+  LayerAnimationSequence sequence;
+  TestLayerAnimationDelegate delegate;
+  delegate.SetOpacityFromAnimation(0.0f);
+  base::TimeDelta delta = base::TimeDelta::FromSeconds(1);
+  LayerAnimationElement* fade_in =
+      LayerAnimationElement::CreateOpacityElement(1.0f, delta);
+  fade_in->set_tween_type(Tween::EASE_IN);
+  sequence.AddElement(fade_in);
+  sequence.AddElement(
+      LayerAnimationElement::CreateOpacityElement(0.5f, delta));
+
+  std::vector<ThreadedLayerAnimation> animations;
+  ASSERT_TRUE(sequence.GetThreadedAnimations(&delegate, &animations));
+  ASSERT_EQ(1u, animations.size());
+  EXPECT_EQ(LayerAnimationElement::OPACITY, animations[0].property);
+  const std::vector<ThreadedLayerAnimation::Keyframe>& keyframes =
+      animations[0].keyframes;
+  ASSERT_GT(keyframes.size(), 2u);
+  EXPECT_EQ(base::TimeDelta(), keyframes.front().time);
+  EXPECT_FLOAT_EQ(0.0f, keyframes.front().opacity);
+  EXPECT_EQ(2 * delta, keyframes.back().time);
+  EXPECT_FLOAT_EQ(0.5f, keyframes.back().opacity);
+  for (size_t i = 1; i < keyframes.size(); ++i) {
+    EXPECT_LT(keyframes[i - 1].time, keyframes[i].time);
+    if (keyframes[i].time <= delta) {
+      double t = keyframes[i].time.InMillisecondsF() / delta.InMillisecondsF();
+      EXPECT_NEAR(Tween::CalculateValue(Tween::EASE_IN, t),
+                  keyframes[i].opacity, 1e-4);
+    }
+  }
+
+  // The delegate is untouched, and the sequence starts from its value.
+  EXPECT_FLOAT_EQ(0.0f, delegate.GetOpacityForAnimation());
+  sequence.Progress(delta / 2, &delegate);
+  EXPECT_FLOAT_EQ(Tween::CalculateValue(Tween::EASE_IN, 0.5),
+                  delegate.GetOpacityForAnimation());
+}
+
+// Check that only transform and opacity sequences go to the compositor.
+TEST(LayerAnimationSequenceTest, ThreadedAnimationsUnsupported) {
+  TestLayerAnimationDelegate delegate;
+  base::TimeDelta delta = base::TimeDelta::FromSeconds(1);
+  std::vector<ThreadedLayerAnimation> animations;
+
+  LayerAnimationSequence bounds(
+      LayerAnimationElement::CreateBoundsElement(gfx::Rect(0, 0, 5, 5), delta));
+  EXPECT_FALSE(bounds.GetThreadedAnimations(&delegate, &animations));
+
+  LayerAnimationSequence cyclic(
+      LayerAnimationElement::CreateOpacityElement(1.0f, delta));
+  cyclic.set_is_cyclic(true);
+  EXPECT_FALSE(cyclic.GetThreadedAnimations(&delegate, &animations));
+
+  LayerAnimationSequence instant(LayerAnimationElement::CreateOpacityElement(
+      1.0f, base::TimeDelta()));
+  EXPECT_FALSE(instant.GetThreadedAnimations(&delegate, &animations));
+
+  EXPECT_TRUE(animations.empty());
+}
+
 } // namespace
 
 } // namespace ui
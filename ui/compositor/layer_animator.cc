@@ -4,15 +4,20 @@
 
 #include "ui/compositor/layer_animator.h"
 
+#include <algorithm>
+
 #include "base/debug/trace_event.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "ui/base/animation/animation_container.h"
+#include "ui/base/animation/animation_container_observer.h"
 #include "ui/compositor/compositor.h"
 #include "ui/compositor/layer.h"
 #include "ui/compositor/layer_animation_delegate.h"
 #include "ui/compositor/layer_animation_observer.h"
 #include "ui/compositor/layer_animation_sequence.h"
+#include "ui/compositor/threaded_layer_animation.h"
 
 namespace ui {
 
@@ -29,6 +34,33 @@ static const base::TimeDelta kTimerInterval =
 // For visual debugging, slow animations down by this factor.
 const int kSlowAnimationScaleFactor = 4;
 
+// Has the animators that step together in a tick ask each compositor for a
+// single draw, however many layers they change.
+class DrawBatcher : public AnimationContainerObserver {
+ public:
+  DrawBatcher() {}
+
+  // AnimationContainerObserver overrides:
+  virtual void AnimationContainerWillProgress(
+      AnimationContainer* container) OVERRIDE {
+    Compositor::BeginDrawBatch();
+  }
+
+  virtual void AnimationContainerProgressed(
+      AnimationContainer* container) OVERRIDE {
+    Compositor::EndDrawBatch();
+  }
+
+  virtual void AnimationContainerEmpty(AnimationContainer* container) OVERRIDE {
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(DrawBatcher);
+};
+
+base::LazyInstance<DrawBatcher>::Leaky g_draw_batcher =
+    LAZY_INSTANCE_INITIALIZER;
+
 }  // namespace
 
 // static
@@ -63,6 +95,17 @@ LayerAnimator* LayerAnimator::CreateImplicitAnimator() {
   return new LayerAnimator(kDefaultTransitionDuration);
 }
 
+// static
+AnimationContainer* LayerAnimator::GetAnimationContainer() {
+  static ui::AnimationContainer* container = NULL;
+  if (!container) {
+    container = new AnimationContainer();
+    container->AddRef();
+    container->set_observer(g_draw_batcher.Pointer());
+  }
+  return container;
+}
+
 void LayerAnimator::SetTransform(const Transform& transform) {
   base::TimeDelta duration = GetTransitionDuration();
   scoped_ptr<LayerAnimationElement> element(
@@ -271,6 +314,8 @@ void LayerAnimator::Step(base::TimeTicks now) {
     if (delta >= running_animations_copy[i].sequence->duration() &&
         !running_animations_copy[i].sequence->is_cyclic()) {
       FinishAnimation(running_animations_copy[i].sequence);
+    } else if (!running_animations_copy[i].threaded_animation_ids.empty()) {
+      // The compositor is playing it.
     } else if (ProgressAnimation(running_animations_copy[i].sequence, delta))
       needs_redraw = true;
   }
@@ -291,19 +336,63 @@ void LayerAnimator::UpdateAnimationState() {
   if (disable_timer_for_test_)
     return;
 
-  static ui::AnimationContainer* container = NULL;
-  if (!container) {
-    container = new AnimationContainer();
-    container->AddRef();
+  AnimationContainer* container = GetAnimationContainer();
+
+  // Threaded animations only need a call to Step() when they end.
+  bool should_start = is_animating() && running_animations_.empty();
+  base::TimeTicks threaded_end_time;
+  for (RunningAnimations::const_iterator iter = running_animations_.begin();
+       iter != running_animations_.end(); ++iter) {
+    if (iter->threaded_animation_ids.empty()) {
+      should_start = true;
+    } else {
+      base::TimeTicks end_time = iter->start_time + iter->sequence->duration();
+      if (threaded_end_time.is_null() || end_time < threaded_end_time)
+        threaded_end_time = end_time;
+    }
   }
 
-  const bool should_start = is_animating();
   if (should_start && !is_started_)
     container->Start(this);
   else if (!should_start && is_started_)
     container->Stop(this);
 
   is_started_ = should_start;
+
+  if (!should_start && !threaded_end_time.is_null()) {
+    base::TimeDelta delay = threaded_end_time - base::TimeTicks::Now();
+    delay = std::max(base::TimeDelta(), delay);
+    threaded_animation_timer_.Start(FROM_HERE, delay, this,
+                                    &LayerAnimator::OnThreadedAnimationTimer);
+  } else {
+    threaded_animation_timer_.Stop();
+  }
+}
+
+void LayerAnimator::StartThreadedAnimation(RunningAnimation* running) {
+  if (!delegate() || !delegate()->CanRunThreadedAnimations())
+    return;
+
+  std::vector<ThreadedLayerAnimation> animations;
+  if (!running->sequence->GetThreadedAnimations(delegate(), &animations))
+    return;
+
+  for (size_t i = 0; i < animations.size(); ++i) {
+    int id = delegate()->AddThreadedAnimation(animations[i]);
+    if (!id) {
+      for (size_t j = 0; j < running->threaded_animation_ids.size(); ++j)
+        delegate()->RemoveThreadedAnimation(running->threaded_animation_ids[j]);
+      running->threaded_animation_ids.clear();
+      return;
+    }
+    running->threaded_animation_ids.push_back(id);
+  }
+}
+
+void LayerAnimator::OnThreadedAnimationTimer() {
+  Step(base::TimeTicks::Now());
+  // Sets the timer again if it fired early.
+  UpdateAnimationState();
 }
 
 LayerAnimationSequence* LayerAnimator::RemoveAnimation(
@@ -314,6 +403,8 @@ LayerAnimationSequence* LayerAnimator::RemoveAnimation(
   for (RunningAnimations::iterator iter = running_animations_.begin();
        iter != running_animations_.end(); ++iter) {
     if ((*iter).sequence == sequence) {
+      for (size_t i = 0; i < iter->threaded_animation_ids.size(); ++i)
+        delegate()->RemoveThreadedAnimation(iter->threaded_animation_ids[i]);
       running_animations_.erase(iter);
       break;
     }
@@ -420,11 +511,19 @@ void LayerAnimator::RemoveAllAnimationsWithACommonProperty(
             sequence->properties())) {
       scoped_ptr<LayerAnimationSequence> removed(
           RemoveAnimation(running_animations_copy[i].sequence));
-      if (abort)
+      if (abort) {
+        // A sequence the compositor was playing stops where it had got to.
+        base::TimeDelta elapsed =
+            base::TimeTicks::Now() - running_animations_copy[i].start_time;
+        if (!running_animations_copy[i].threaded_animation_ids.empty() &&
+            elapsed < running_animations_copy[i].sequence->duration()) {
+          running_animations_copy[i].sequence->Progress(elapsed, delegate());
+        }
         running_animations_copy[i].sequence->Abort();
-      else
+      } else {
         running_animations_copy[i].sequence->Progress(
             running_animations_copy[i].sequence->duration(), delegate());
+      }
     }
   }
 
@@ -554,12 +653,15 @@ bool LayerAnimator::StartSequenceImmediately(LayerAnimationSequence* sequence) {
   // All clear, actually start the sequence. Note: base::TimeTicks::Now has
   // a resolution that can be as bad as 15ms. If this causes glitches in the
   // animations, this can be switched to HighResNow() (animation uses Now()
-  // internally).
-  base::TimeTicks start_time = is_animating()
+  // internally). The last step time is stale if only threaded animations
+  // are running, since nothing steps them.
+  base::TimeTicks start_time =
+      is_animating() && (is_started_ || disable_timer_for_test_)
       ? last_step_time_
       : base::TimeTicks::Now();
 
   running_animations_.push_back(RunningAnimation(sequence, start_time));
+  StartThreadedAnimation(&running_animations_.back());
 
   // Need to keep a reference to the animation.
   AddToQueueIfNotPresent(sequence);
@@ -13,6 +13,7 @@
 #include "base/memory/linked_ptr.h"
 #include "base/observer_list.h"
 #include "base/time.h"
+#include "base/timer.h"
 #include "ui/base/animation/animation_container_element.h"
 #include "ui/base/animation/tween.h"
 #include "ui/compositor/compositor_export.h"
@@ -24,6 +25,7 @@ class Rect;
 
 namespace ui {
 class Animation;
+class AnimationContainer;
 class Layer;
 class LayerAnimationSequence;
 class LayerAnimationDelegate;
@@ -54,6 +56,9 @@ class COMPOSITOR_EXPORT LayerAnimator : public AnimationContainerElement {
   // Implicitly animates when properties are set.
   static LayerAnimator* CreateImplicitAnimator();
 
+  // Returns the container that steps all the animators.
+  static AnimationContainer* GetAnimationContainer();
+
   // Sets the transform on the delegate. May cause an implicit animation.
   virtual void SetTransform(const Transform& transform);
   Transform GetTargetTransform() const;
@@ -176,6 +181,9 @@ class COMPOSITOR_EXPORT LayerAnimator : public AnimationContainerElement {
     }
     LayerAnimationSequence* sequence;
     base::TimeTicks start_time;
+    // The delegate's ids for the animations that play the sequence on the
+    // compositor thread.  Empty if the animator steps the sequence.
+    std::vector<int> threaded_animation_ids;
   };
 
   typedef std::vector<RunningAnimation> RunningAnimations;
@@ -187,8 +195,17 @@ class COMPOSITOR_EXPORT LayerAnimator : public AnimationContainerElement {
   virtual base::TimeDelta GetTimerInterval() const OVERRIDE;
 
   // Starts or stops stepping depending on whether thare are running animations.
+  // If the only running animations are threaded, waits for the first of them
+  // to end instead.
   void UpdateAnimationState();
 
+  // Hands |running| to the compositor thread if the delegate and the sequence
+  // allow it.
+  void StartThreadedAnimation(RunningAnimation* running);
+
+  // Called when a threaded animation should have ended.
+  void OnThreadedAnimationTimer();
+
   // Removes the sequences from both the running animations and the queue.
   // Returns a pointer to the removed animation, if any. NOTE: the caller is
   // responsible for deleting the returned pointer.
@@ -277,6 +294,10 @@ class COMPOSITOR_EXPORT LayerAnimator : public AnimationContainerElement {
   // True if we are being stepped by our container.
   bool is_started_;
 
+  // Fires when the first threaded animation ends, while no animation needs
+  // stepping.
+  base::OneShotTimer<LayerAnimator> threaded_animation_timer_;
+
   // This prevents the animator from automatically stepping through animations
   // and allows for manual stepping.
   bool disable_timer_for_test_;
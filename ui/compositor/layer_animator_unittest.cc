@@ -4,6 +4,8 @@
 
 #include "ui/compositor/layer_animator.h"
 
+#include <map>
+
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
 #include "base/memory/scoped_ptr.h"
@@ -16,6 +18,7 @@
 #include "ui/compositor/test/test_layer_animation_delegate.h"
 #include "ui/compositor/test/test_layer_animation_observer.h"
 #include "ui/compositor/test/test_utils.h"
+#include "ui/compositor/threaded_layer_animation.h"
 #include "ui/gfx/rect.h"
 #include "ui/gfx/transform.h"
 
@@ -112,6 +115,37 @@ class TestLayerAnimationSequence : public LayerAnimationSequence {
   DISALLOW_COPY_AND_ASSIGN(TestLayerAnimationSequence);
 };
 
+// Plays transform and opacity animations on a pretend compositor thread.
+class ThreadedTestLayerAnimationDelegate : public TestLayerAnimationDelegate {
+ public:
+  typedef std::map<int, ThreadedLayerAnimation> Animations;
+
+  ThreadedTestLayerAnimationDelegate() : next_id_(1) {}
+  virtual ~ThreadedTestLayerAnimationDelegate() {}
+
+  const Animations& animations() const { return animations_; }
+
+  virtual bool CanRunThreadedAnimations() const OVERRIDE {
+    return true;
+  }
+
+  virtual int AddThreadedAnimation(
+      const ThreadedLayerAnimation& animation) OVERRIDE {
+    animations_[next_id_] = animation;
+    return next_id_++;
+  }
+
+  virtual void RemoveThreadedAnimation(int id) OVERRIDE {
+    EXPECT_EQ(1u, animations_.erase(id));
+  }
+
+ private:
+  int next_id_;
+  Animations animations_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadedTestLayerAnimationDelegate);
+};
+
 } // namespace
 
 // Checks that setting a property on an implicit animator causes an animation to
@@ -1118,4 +1152,95 @@ TEST(LayerAnimatorTest, GetTargetOpacity) {
   }
 }
 
+// Checks that an opacity animation is handed to the delegate's compositor
+// thread, isn't stepped here, and ends when its time is up.
+TEST(LayerAnimatorTest, ThreadedAnimation) {
+  scoped_ptr<LayerAnimator> animator(LayerAnimator::CreateDefaultAnimator());
+  AnimationContainerElement* element = animator.get();
+  animator->set_disable_timer_for_test(true);
+  ThreadedTestLayerAnimationDelegate delegate;
+  animator->SetDelegate(&delegate);
+  TestLayerAnimationObserver observer;
+  animator->AddObserver(&observer);
+  delegate.SetOpacityFromAnimation(0.0f);
+
+  base::TimeDelta delta = base::TimeDelta::FromSeconds(1);
+  LayerAnimationSequence* sequence = new LayerAnimationSequence(
+      LayerAnimationElement::CreateOpacityElement(1.0f, delta));
+  animator->StartAnimation(sequence);
+  EXPECT_TRUE(animator->is_animating());
+  ASSERT_EQ(1u, delegate.animations().size());
+  const ThreadedLayerAnimation& animation =
+      delegate.animations().begin()->second;
+  EXPECT_EQ(LayerAnimationElement::OPACITY, animation.property);
+  EXPECT_FLOAT_EQ(0.0f, animation.keyframes.front().opacity);
+  EXPECT_FLOAT_EQ(1.0f, animation.keyframes.back().opacity);
+  EXPECT_EQ(delta, animation.keyframes.back().time);
+
+  base::TimeTicks start_time = animator->last_step_time();
+  element->Step(start_time + base::TimeDelta::FromMilliseconds(500));
+  EXPECT_FLOAT_EQ(0.0f, delegate.GetOpacityForAnimation());
+  EXPECT_FLOAT_EQ(1.0f, animator->GetTargetOpacity());
+  EXPECT_FALSE(observer.last_ended_sequence());
+
+  element->Step(start_time + delta);
+  EXPECT_FALSE(animator->is_animating());
+  EXPECT_TRUE(delegate.animations().empty());
+  EXPECT_FLOAT_EQ(1.0f, delegate.GetOpacityForAnimation());
+  EXPECT_EQ(observer.last_ended_sequence(), sequence);
+}
+
+// Checks that preempting a threaded animation takes it off the compositor
+// thread and notifies observers as usual.
+TEST(LayerAnimatorTest, PreemptThreadedAnimation) {
+  scoped_ptr<LayerAnimator> animator(LayerAnimator::CreateDefaultAnimator());
+  animator->set_disable_timer_for_test(true);
+  animator->set_preemption_strategy(
+      LayerAnimator::IMMEDIATELY_ANIMATE_TO_NEW_TARGET);
+  ThreadedTestLayerAnimationDelegate delegate;
+  animator->SetDelegate(&delegate);
+  TestLayerAnimationObserver observer;
+  animator->AddObserver(&observer);
+  delegate.SetOpacityFromAnimation(0.0f);
+
+  base::TimeDelta delta = base::TimeDelta::FromSeconds(1);
+  LayerAnimationSequence* first = new LayerAnimationSequence(
+      LayerAnimationElement::CreateOpacityElement(1.0f, delta));
+  animator->StartAnimation(first);
+  ASSERT_EQ(1u, delegate.animations().size());
+  int first_id = delegate.animations().begin()->first;
+
+  LayerAnimationSequence* second = new LayerAnimationSequence(
+      LayerAnimationElement::CreateOpacityElement(0.5f, delta));
+  animator->StartAnimation(second);
+  EXPECT_EQ(observer.last_aborted_sequence(), first);
+  ASSERT_EQ(1u, delegate.animations().size());
+  EXPECT_NE(first_id, delegate.animations().begin()->first);
+  const ThreadedLayerAnimation& animation =
+      delegate.animations().begin()->second;
+  EXPECT_FLOAT_EQ(0.5f, animation.keyframes.back().opacity);
+
+  animator->StopAnimating();
+  EXPECT_TRUE(delegate.animations().empty());
+  EXPECT_FLOAT_EQ(0.5f, delegate.GetOpacityForAnimation());
+  EXPECT_EQ(observer.last_ended_sequence(), second);
+}
+
+// Checks that bounds animations are still stepped by the animator.
+TEST(LayerAnimatorTest, BoundsAnimationIsNotThreaded) {
+  scoped_ptr<LayerAnimator> animator(LayerAnimator::CreateImplicitAnimator());
+  AnimationContainerElement* element = animator.get();
+  animator->set_disable_timer_for_test(true);
+  ThreadedTestLayerAnimationDelegate delegate;
+  animator->SetDelegate(&delegate);
+  delegate.SetBoundsFromAnimation(gfx::Rect(0, 0, 10, 10));
+
+  animator->SetBounds(gfx::Rect(0, 0, 30, 30));
+  EXPECT_TRUE(animator->is_animating());
+  EXPECT_TRUE(delegate.animations().empty());
+  element->Step(animator->last_step_time() + base::TimeDelta::FromSeconds(1));
+  CheckApproximatelyEqual(gfx::Rect(0, 0, 30, 30),
+                          delegate.GetBoundsForAnimation());
+}
+
 }  // namespace ui
@@ -29,6 +29,12 @@ class COMPOSITOR_EXPORT LayerDelegate {
   // the bounds change.
   virtual base::Closure PrepareForLayerBoundsChange() = 0;
 
+  // Called when opaque layers above start or stop covering the layer
+  // completely. While covered, the layer is neither painted nor drawn, so the
+  // delegate may free what it keeps for painting. The layer is painted again
+  // in full when it is uncovered.
+  virtual void OnLayerOcclusionChanged(bool occluded) {}
+
  protected:
   virtual ~LayerDelegate() {}
 };
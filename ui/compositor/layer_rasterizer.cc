@@ -0,0 +1,157 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/compositor/layer_rasterizer.h"
+
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/lazy_instance.h"
+#include "base/location.h"
+#include "base/sys_info.h"
+#include "base/threading/sequenced_worker_pool.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkRegion.h"
+
+namespace ui {
+
+namespace {
+
+// The workers that rasterize the tiles of all the layers, one per core.
+class RasterWorkerPool {
+ public:
+  RasterWorkerPool()
+      : pool_(new base::SequencedWorkerPool(
+            base::SysInfo::NumberOfProcessors(), "LayerRasterWorker")),
+        task_runner_(pool_->GetTaskRunnerWithShutdownBehavior(
+            base::SequencedWorkerPool::CONTINUE_ON_SHUTDOWN)) {
+  }
+
+  base::TaskRunner* task_runner() { return task_runner_.get(); }
+
+ private:
+  scoped_refptr<base::SequencedWorkerPool> pool_;
+  scoped_refptr<base::TaskRunner> task_runner_;
+
+  DISALLOW_COPY_AND_ASSIGN(RasterWorkerPool);
+};
+
+base::LazyInstance<RasterWorkerPool>::Leaky g_raster_worker_pool =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+// Rasterizes one tile. Created on the UI thread, run on a worker, and handed
+// back to the UI thread.
+class LayerRasterizer::RasterTask
+    : public base::RefCountedThreadSafe<RasterTask> {
+ public:
+  // Each task plays back its own copy of the picture, since playing back is
+  // not thread safe.
+  RasterTask(const SkPicture& picture, const gfx::Rect& rect, int version)
+      : picture_(picture),
+        rect_(rect),
+        version_(version) {
+  }
+
+  void Run() {
+    TRACE_EVENT0("ui", "LayerRasterizer::RasterTask::Run");
+    base::TimeTicks start = base::TimeTicks::Now();
+    bitmap_.setConfig(SkBitmap::kARGB_8888_Config,
+                      rect_.width(), rect_.height());
+    bitmap_.allocPixels();
+    bitmap_.eraseARGB(0, 0, 0, 0);
+    SkCanvas canvas(bitmap_);
+    canvas.translate(SkIntToScalar(-rect_.x()), SkIntToScalar(-rect_.y()));
+    picture_.draw(&canvas);
+    raster_time_ = base::TimeTicks::Now() - start;
+  }
+
+  const gfx::Rect& rect() const { return rect_; }
+  int version() const { return version_; }
+  const SkBitmap& bitmap() const { return bitmap_; }
+  base::TimeDelta raster_time() const { return raster_time_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<RasterTask>;
+
+  ~RasterTask() {}
+
+  SkPicture picture_;
+  gfx::Rect rect_;
+  int version_;
+  SkBitmap bitmap_;
+  base::TimeDelta raster_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(RasterTask);
+};
+
+LayerRasterizer::LayerRasterizer(const TileCallback& tile_ready)
+    : tile_ready_(tile_ready),
+      next_version_(0),
+      rasterized_tile_count_(0) {
+}
+
+LayerRasterizer::~LayerRasterizer() {
+}
+
+void LayerRasterizer::Rasterize(SkPicture* picture,
+                                const std::vector<gfx::Rect>& tiles) {
+  picture->endRecording();
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    TileKey key(tiles[i].x(), tiles[i].y());
+    ready_tiles_.erase(key);
+    int version = next_version_++;
+    pending_tiles_[key] = version;
+    scoped_refptr<RasterTask> task(new RasterTask(*picture, tiles[i],
+                                                  version));
+    g_raster_worker_pool.Get().task_runner()->PostTaskAndReply(
+        FROM_HERE,
+        base::Bind(&RasterTask::Run, task),
+        base::Bind(&LayerRasterizer::OnTileRasterized, AsWeakPtr(), task));
+  }
+}
+
+void LayerRasterizer::DrawTiles(SkCanvas* canvas,
+                                const gfx::Rect& clip,
+                                SkRegion* drawn) {
+  std::map<TileKey, Tile>::iterator it = ready_tiles_.begin();
+  while (it != ready_tiles_.end()) {
+    const Tile& tile = it->second;
+    if (!tile.rect.Intersects(clip)) {
+      ++it;
+      continue;
+    }
+    canvas->drawBitmap(tile.bitmap,
+                       SkIntToScalar(tile.rect.x()),
+                       SkIntToScalar(tile.rect.y()));
+    drawn->op(tile.rect.x(), tile.rect.y(), tile.rect.right(),
+              tile.rect.bottom(), SkRegion::kUnion_Op);
+    ready_tiles_.erase(it++);
+  }
+}
+
+void LayerRasterizer::Clear() {
+  pending_tiles_.clear();
+  ready_tiles_.clear();
+}
+
+void LayerRasterizer::OnTileRasterized(scoped_refptr<RasterTask> task) {
+  rasterized_tile_count_++;
+  total_raster_time_ += task->raster_time();
+  last_raster_time_ = task->raster_time();
+
+  TileKey key(task->rect().x(), task->rect().y());
+  std::map<TileKey, int>::iterator it = pending_tiles_.find(key);
+  if (it == pending_tiles_.end() || it->second != task->version())
+    return;
+  pending_tiles_.erase(it);
+
+  Tile& tile = ready_tiles_[key];
+  tile.rect = task->rect();
+  tile.bitmap = task->bitmap();
+  tile_ready_.Run(tile.rect);
+}
+
+}  // namespace ui
@@ -0,0 +1,89 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_COMPOSITOR_LAYER_RASTERIZER_H_
+#define UI_COMPOSITOR_LAYER_RASTERIZER_H_
+#pragma once
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/compositor/compositor_export.h"
+#include "ui/gfx/rect.h"
+
+class SkCanvas;
+class SkPicture;
+class SkRegion;
+
+namespace ui {
+
+// LayerRasterizer rasterizes recordings of the contents of a layer into tiles
+// on worker threads, and keeps each tile until the layer draws it. All its
+// methods are called on the UI thread.
+class COMPOSITOR_EXPORT LayerRasterizer
+    : public base::SupportsWeakPtr<LayerRasterizer> {
+ public:
+  typedef base::Callback<void(const gfx::Rect&)> TileCallback;
+
+  // |tile_ready| is run with the rect of each tile, in pixels, when it is
+  // rasterized.
+  explicit LayerRasterizer(const TileCallback& tile_ready);
+  ~LayerRasterizer();
+
+  // Rasterizes the |tiles| of |picture|, in pixels, on worker threads. They
+  // replace the tiles over the same rects, in progress or ready.
+  void Rasterize(SkPicture* picture, const std::vector<gfx::Rect>& tiles);
+
+  // Draws the rasterized tiles that intersect |clip|, in pixels, into
+  // |canvas| and forgets them. Adds the rects drawn to |drawn|.
+  void DrawTiles(SkCanvas* canvas, const gfx::Rect& clip, SkRegion* drawn);
+
+  // Forgets the tiles, in progress or ready.
+  void Clear();
+
+  // Debug counters: the number of tiles rasterized so far, the time it took
+  // the workers in total, and how long the last tile took.
+  int rasterized_tile_count() const { return rasterized_tile_count_; }
+  base::TimeDelta total_raster_time() const { return total_raster_time_; }
+  base::TimeDelta last_raster_time() const { return last_raster_time_; }
+
+ private:
+  class RasterTask;
+
+  // The origin of a tile.
+  typedef std::pair<int, int> TileKey;
+
+  struct Tile {
+    gfx::Rect rect;
+    SkBitmap bitmap;
+  };
+
+  void OnTileRasterized(scoped_refptr<RasterTask> task);
+
+  TileCallback tile_ready_;
+
+  // The version of the task in progress for each tile. The result of older
+  // tasks is dropped.
+  std::map<TileKey, int> pending_tiles_;
+  int next_version_;
+
+  std::map<TileKey, Tile> ready_tiles_;
+
+  int rasterized_tile_count_;
+  base::TimeDelta total_raster_time_;
+  base::TimeDelta last_raster_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(LayerRasterizer);
+};
+
+}  // namespace ui
+
+#endif  // UI_COMPOSITOR_LAYER_RASTERIZER_H_
@@ -0,0 +1,105 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/compositor/layer_rasterizer.h"
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/message_loop.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkRegion.h"
+
+namespace ui {
+
+namespace {
+
+// Remembers the tiles that are ready, and quits the message loop once
+// |expected_count| of them are.
+class TileCounter {
+ public:
+  explicit TileCounter(size_t expected_count)
+      : expected_count_(expected_count) {}
+
+  void OnTileReady(const gfx::Rect& tile) {
+    tiles_.push_back(tile);
+    if (tiles_.size() == expected_count_)
+      MessageLoop::current()->Quit();
+  }
+
+  const std::vector<gfx::Rect>& tiles() const { return tiles_; }
+
+ private:
+  size_t expected_count_;
+  std::vector<gfx::Rect> tiles_;
+
+  DISALLOW_COPY_AND_ASSIGN(TileCounter);
+};
+
+}  // namespace
+
+// Checks that recordings are rasterized into tiles on workers, and that the
+// tiles are drawn once.
+TEST(LayerRasterizerTest, Rasterize) {
+  MessageLoopForUI message_loop;
+  TileCounter counter(2);
+  LayerRasterizer rasterizer(
+      base::Bind(&TileCounter::OnTileReady, base::Unretained(&counter)));
+
+  SkPicture picture;
+  SkCanvas* recording_canvas = picture.beginRecording(512, 256);
+  recording_canvas->drawColor(SK_ColorRED);
+
+  std::vector<gfx::Rect> tiles;
+  tiles.push_back(gfx::Rect(0, 0, 256, 256));
+  tiles.push_back(gfx::Rect(256, 0, 256, 256));
+  rasterizer.Rasterize(&picture, tiles);
+  MessageLoop::current()->Run();
+
+  ASSERT_EQ(2u, counter.tiles().size());
+  EXPECT_EQ(2, rasterizer.rasterized_tile_count());
+
+  SkBitmap bitmap;
+  bitmap.setConfig(SkBitmap::kARGB_8888_Config, 512, 256);
+  bitmap.allocPixels();
+  bitmap.eraseARGB(0, 0, 0, 0);
+  SkCanvas canvas(bitmap);
+  SkRegion drawn;
+  rasterizer.DrawTiles(&canvas, gfx::Rect(0, 0, 300, 10), &drawn);
+  EXPECT_TRUE(drawn.contains(SkIRect::MakeWH(512, 256)));
+  {
+    SkAutoLockPixels lock(bitmap);
+    EXPECT_EQ(SK_ColorRED, bitmap.getColor(10, 10));
+    EXPECT_EQ(SK_ColorRED, bitmap.getColor(500, 200));
+  }
+
+  // The tiles were handed over.
+  SkRegion drawn_again;
+  rasterizer.DrawTiles(&canvas, gfx::Rect(0, 0, 512, 256), &drawn_again);
+  EXPECT_TRUE(drawn_again.isEmpty());
+}
+
+// Checks that tiles rasterized for a replaced recording are dropped.
+TEST(LayerRasterizerTest, Clear) {
+  MessageLoopForUI message_loop;
+  TileCounter counter(1);
+  LayerRasterizer rasterizer(
+      base::Bind(&TileCounter::OnTileReady, base::Unretained(&counter)));
+
+  SkPicture picture;
+  picture.beginRecording(256, 256)->drawColor(SK_ColorBLUE);
+  std::vector<gfx::Rect> tiles(1, gfx::Rect(0, 0, 256, 256));
+  rasterizer.Rasterize(&picture, tiles);
+  rasterizer.Clear();
+  rasterizer.Rasterize(&picture, tiles);
+  MessageLoop::current()->Run();
+
+  // The tile of the first task is dropped.
+  EXPECT_EQ(1u, counter.tiles().size());
+}
+
+}  // namespace ui
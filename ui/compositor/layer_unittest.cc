@@ -3,20 +3,29 @@
 // found in the LICENSE file.
 
 #include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/command_line.h"
 #include "base/compiler_specific.h"
 #include "base/file_path.h"
 #include "base/file_util.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
 #include "base/path_service.h"
 #include "base/string_util.h"
 #include "base/stringprintf.h"
+#include "base/threading/platform_thread.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebSize.h"
+#include "third_party/skia/include/core/SkGraphics.h"
 #include "ui/compositor/compositor_observer.h"
 #include "ui/compositor/compositor_setup.h"
+#include "ui/compositor/compositor_switches.h"
+#include "ui/compositor/frame_breakdown.h"
 #include "ui/compositor/layer.h"
 #include "ui/compositor/layer_animation_sequence.h"
+#include "ui/compositor/layer_rasterizer.h"
 #include "ui/compositor/test/test_compositor_host.h"
+#include "ui/compositor/texture_budget.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/codec/png_codec.h"
 #include "ui/gfx/gfx_paths.h"
@@ -320,6 +329,35 @@ class NullLayerDelegate : public LayerDelegate {
   DISALLOW_COPY_AND_ASSIGN(NullLayerDelegate);
 };
 
+// LayerDelegate that remembers what it was told about occlusion.
+class OcclusionLayerDelegate : public LayerDelegate {
+ public:
+  OcclusionLayerDelegate() : occluded_(false), change_count_(0) {}
+  virtual ~OcclusionLayerDelegate() {}
+
+  bool occluded() const { return occluded_; }
+  int change_count() const { return change_count_; }
+
+ private:
+  // Overridden from LayerDelegate:
+  virtual void OnPaintLayer(gfx::Canvas* canvas) OVERRIDE {
+  }
+  virtual void OnDeviceScaleFactorChanged(float device_scale_factor) OVERRIDE {
+  }
+  virtual base::Closure PrepareForLayerBoundsChange() OVERRIDE {
+    return base::Closure();
+  }
+  virtual void OnLayerOcclusionChanged(bool occluded) OVERRIDE {
+    occluded_ = occluded;
+    change_count_++;
+  }
+
+  bool occluded_;
+  int change_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(OcclusionLayerDelegate);
+};
+
 // Remembers if it has been notified.
 class TestCompositorObserver : public CompositorObserver {
  public:
@@ -354,6 +392,43 @@ class TestCompositorObserver : public CompositorObserver {
   DISALLOW_COPY_AND_ASSIGN(TestCompositorObserver);
 };
 
+// Waits for the result of Compositor::ReadPixelsAsync().
+class ReadPixelsWaiter {
+ public:
+  ReadPixelsWaiter() : called_(false), waiting_(false), success_(false) {}
+
+  Compositor::ReadPixelsCallback callback() {
+    return base::Bind(&ReadPixelsWaiter::OnReadPixels, base::Unretained(this));
+  }
+
+  void Wait() {
+    if (called_)
+      return;
+    waiting_ = true;
+    MessageLoop::current()->Run();
+    waiting_ = false;
+  }
+
+  bool success() const { return success_; }
+  const SkBitmap& bitmap() const { return bitmap_; }
+
+ private:
+  void OnReadPixels(bool success, const SkBitmap& bitmap) {
+    called_ = true;
+    success_ = success;
+    bitmap_ = bitmap;
+    if (waiting_)
+      MessageLoop::current()->Quit();
+  }
+
+  bool called_;
+  bool waiting_;
+  bool success_;
+  SkBitmap bitmap_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadPixelsWaiter);
+};
+
 }  // namespace
 
 #if defined(OS_WIN)
@@ -365,6 +440,7 @@ class TestCompositorObserver : public CompositorObserver {
 #define MAYBE_Hierarchy DISABLED_Hierarchy
 #define MAYBE_HierarchyNoTexture DISABLED_HierarchyNoTexture
 #define MAYBE_DrawPixels DISABLED_DrawPixels
+#define MAYBE_ReadPixelsAsync DISABLED_ReadPixelsAsync
 #define MAYBE_SetRootLayer DISABLED_SetRootLayer
 #define MAYBE_CompositorObservers DISABLED_CompositorObservers
 #define MAYBE_ModifyHierarchy DISABLED_ModifyHierarchy
@@ -379,6 +455,7 @@ class TestCompositorObserver : public CompositorObserver {
 #define MAYBE_Hierarchy Hierarchy
 #define MAYBE_HierarchyNoTexture HierarchyNoTexture
 #define MAYBE_DrawPixels DrawPixels
+#define MAYBE_ReadPixelsAsync ReadPixelsAsync
 #define MAYBE_SetRootLayer SetRootLayer
 #define MAYBE_CompositorObservers CompositorObservers
 #define MAYBE_ModifyHierarchy ModifyHierarchy
@@ -713,6 +790,256 @@ TEST_F(LayerWithNullDelegateTest, Visibility) {
   EXPECT_EQ(1.f, l1->web_layer().opacity());
 }
 
+// Checks that layers covered by opaque layers above them are occluded.
+TEST_F(LayerWithNullDelegateTest, Occlusion) {
+  scoped_ptr<Layer> root(CreateNoTextureLayer(gfx::Rect(0, 0, 400, 400)));
+  scoped_ptr<Layer> bottom(CreateTextureLayer(gfx::Rect(10, 10, 100, 100)));
+  scoped_ptr<Layer> left(CreateTextureLayer(gfx::Rect(0, 0, 60, 200)));
+  scoped_ptr<Layer> right(CreateTextureLayer(gfx::Rect(60, 0, 100, 200)));
+  OcclusionLayerDelegate delegate;
+  bottom->set_delegate(&delegate);
+  root->Add(bottom.get());
+  root->Add(left.get());
+  root->Add(right.get());
+  compositor()->SetRootLayer(root.get());
+
+  // Together, the two layers above cover the bottom one.
+  root->ComputeOcclusion();
+  EXPECT_TRUE(bottom->occluded());
+  EXPECT_TRUE(delegate.occluded());
+  EXPECT_EQ(1, delegate.change_count());
+  EXPECT_FALSE(left->occluded());
+  EXPECT_FALSE(right->occluded());
+
+  // Nothing changed.
+  root->ComputeOcclusion();
+  EXPECT_EQ(1, delegate.change_count());
+
+  // Translucent layers don't cover what is below.
+  right->SetOpacity(0.5f);
+  root->ComputeOcclusion();
+  EXPECT_FALSE(bottom->occluded());
+  EXPECT_FALSE(delegate.occluded());
+  EXPECT_EQ(2, delegate.change_count());
+
+  right->SetOpacity(1.0f);
+  right->SetFillsBoundsOpaquely(false);
+  root->ComputeOcclusion();
+  EXPECT_FALSE(bottom->occluded());
+
+  right->SetFillsBoundsOpaquely(true);
+  root->ComputeOcclusion();
+  EXPECT_TRUE(bottom->occluded());
+
+  // Nor do hidden layers.
+  left->SetVisible(false);
+  root->ComputeOcclusion();
+  EXPECT_FALSE(bottom->occluded());
+
+  // Nor rotated ones.
+  left->SetVisible(true);
+  Transform rotation;
+  rotation.SetRotate(45.0f);
+  left->SetTransform(rotation);
+  root->ComputeOcclusion();
+  EXPECT_FALSE(bottom->occluded());
+
+  // Moving the layers keeps them in the same plane.
+  Transform translation;
+  translation.SetTranslate(-10.0f, 0.0f);
+  left->SetTransform(translation);
+  right->SetTransform(translation);
+  root->ComputeOcclusion();
+  EXPECT_TRUE(bottom->occluded());
+}
+
+// Checks that the textures of layers that aren't drawn are evicted, least
+// recently drawn first, and come back when the layers are drawn again.
+// The glyph cache grows to fit text drawn at the device scale factor.
+TEST_F(LayerWithDelegateTest, GlyphCacheGrowsWithScale) {
+  // 4MB at a scale of 1, times 2 squared.
+  compositor()->SetScaleAndSize(2.0f, gfx::Size(2000, 2000));
+  size_t scaled_limit = SkGraphics::GetFontCacheLimit();
+  EXPECT_GE(scaled_limit, static_cast<size_t>(16 * 1024 * 1024));
+
+  // It isn't shrunk when the scale goes back down.
+  compositor()->SetScaleAndSize(1.0f, gfx::Size(1000, 1000));
+  EXPECT_EQ(scaled_limit, SkGraphics::GetFontCacheLimit());
+}
+
+TEST_F(LayerWithNullDelegateTest, TextureBudget) {
+  scoped_ptr<Layer> root(CreateNoTextureLayer(gfx::Rect(0, 0, 400, 400)));
+  scoped_ptr<Layer> l1(CreateTextureLayer(gfx::Rect(0, 0, 100, 100)));
+  scoped_ptr<Layer> l2(CreateTextureLayer(gfx::Rect(100, 0, 100, 100)));
+  scoped_ptr<Layer> l3(CreateTextureLayer(gfx::Rect(200, 0, 100, 100)));
+  root->Add(l1.get());
+  root->Add(l2.get());
+  root->Add(l3.get());
+  const size_t kLayerBytes = 100 * 100 * 4;
+  EXPECT_EQ(kLayerBytes, l1->GetTextureMemoryBytes());
+  EXPECT_FALSE(root->CanEvictTexture());
+  EXPECT_TRUE(l1->CanEvictTexture());
+
+  TextureBudget budget;
+  budget.set_limit_bytes(kLayerBytes);
+  budget.Update(root.get());
+  EXPECT_EQ(3 * kLayerBytes, budget.used_bytes());
+  EXPECT_EQ(3 * kLayerBytes, budget.drawn_bytes());
+
+  // l2 was drawn more recently than l1.
+  l1->SetVisible(false);
+  budget.Update(root.get());
+  EXPECT_TRUE(l1->texture_evicted());
+  l2->SetVisible(false);
+  budget.Update(root.get());
+  EXPECT_TRUE(l2->texture_evicted());
+  EXPECT_EQ(kLayerBytes, budget.used_bytes());
+  EXPECT_EQ(2, budget.eviction_count());
+  EXPECT_EQ(0u, l1->GetTextureMemoryBytes());
+
+  // A layer shown again gets its texture back.
+  l1->SetVisible(true);
+  budget.Update(root.get());
+  EXPECT_FALSE(l1->texture_evicted());
+  EXPECT_TRUE(l2->texture_evicted());
+  EXPECT_EQ(2 * kLayerBytes, budget.used_bytes());
+  EXPECT_EQ(2, budget.eviction_count());
+
+  // Within the budget, hidden layers keep their texture.
+  budget.set_limit_bytes(3 * kLayerBytes);
+  l3->SetVisible(false);
+  budget.Update(root.get());
+  EXPECT_FALSE(l3->texture_evicted());
+
+  // The least recently drawn layers go first.
+  budget.set_limit_bytes(kLayerBytes);
+  l1->SetVisible(false);
+  budget.Update(root.get());
+  EXPECT_TRUE(l3->texture_evicted());
+  EXPECT_FALSE(l1->texture_evicted());
+  EXPECT_EQ(kLayerBytes, budget.used_bytes());
+  EXPECT_EQ(0u, budget.drawn_bytes());
+}
+
+TEST_F(LayerWithNullDelegateTest, TextureBudgetTrim) {
+  scoped_ptr<Layer> root(CreateNoTextureLayer(gfx::Rect(0, 0, 400, 400)));
+  scoped_ptr<Layer> l1(CreateTextureLayer(gfx::Rect(0, 0, 100, 100)));
+  scoped_ptr<Layer> l2(CreateTextureLayer(gfx::Rect(100, 0, 100, 100)));
+  root->Add(l1.get());
+  root->Add(l2.get());
+  const size_t kLayerBytes = 100 * 100 * 4;
+
+  TextureBudget budget;
+  budget.set_limit_bytes(4 * kLayerBytes);
+  l1->SetVisible(false);
+  l2->SetVisible(false);
+  budget.Update(root.get());
+  EXPECT_EQ(2 * kLayerBytes, budget.used_bytes());
+
+  // Moderate pressure leaves a quarter of the limit, for one update.
+  budget.TrimAtNextUpdate(
+      base::MemoryPressureListener::MEMORY_PRESSURE_MODERATE);
+  budget.Update(root.get());
+  EXPECT_EQ(kLayerBytes, budget.used_bytes());
+  EXPECT_EQ(1, budget.eviction_count());
+  l1->SetVisible(true);
+  l2->SetVisible(true);
+  budget.Update(root.get());
+  EXPECT_EQ(2 * kLayerBytes, budget.used_bytes());
+
+  // Critical pressure evicts all that isn't drawn.
+  l1->SetVisible(false);
+  budget.TrimAtNextUpdate(
+      base::MemoryPressureListener::MEMORY_PRESSURE_CRITICAL);
+  budget.Update(root.get());
+  EXPECT_TRUE(l1->texture_evicted());
+  EXPECT_FALSE(l2->texture_evicted());
+  EXPECT_EQ(kLayerBytes, budget.used_bytes());
+}
+
+// Checks that layers that paint in tiles send at most the tile budget, and
+// keep the other tiles for later.
+TEST_F(LayerWithNullDelegateTest, PaintInTiles) {
+  scoped_ptr<Layer> root(CreateNoTextureLayer(gfx::Rect(0, 0, 1024, 1024)));
+  scoped_ptr<Layer> l1(CreateTextureLayer(gfx::Rect(0, 0, 1024, 512)));
+  root->Add(l1.get());
+  l1->SetPaintInTiles(true);
+
+  // The damage touches 4 tiles of the top row and 4 of the second.
+  l1->SchedulePaint(gfx::Rect(10, 250, 1000, 10));
+  int tile_budget = 3;
+  EXPECT_FALSE(root->SendDamagedRects(&tile_budget));
+  EXPECT_EQ(0, tile_budget);
+  tile_budget = 3;
+  EXPECT_FALSE(root->SendDamagedRects(&tile_budget));
+  tile_budget = 3;
+  EXPECT_TRUE(root->SendDamagedRects(&tile_budget));
+  EXPECT_EQ(1, tile_budget);
+
+  // Other layers don't count against the budget.
+  l1->SetPaintInTiles(false);
+  l1->SchedulePaint(gfx::Rect(0, 0, 1024, 512));
+  tile_budget = 1;
+  EXPECT_TRUE(root->SendDamagedRects(&tile_budget));
+  EXPECT_EQ(1, tile_budget);
+}
+
+// Checks that the tiles rasterized on workers are sent within the upload
+// budget, and that one is sent whatever the budget.
+TEST_F(LayerWithNullDelegateTest, RasterizedTilesUploadBudget) {
+  scoped_ptr<Layer> root(CreateNoTextureLayer(gfx::Rect(0, 0, 1024, 1024)));
+  scoped_ptr<Layer> l1(CreateTextureLayer(gfx::Rect(0, 0, 512, 256)));
+  root->Add(l1.get());
+  CommandLine old_command_line(*CommandLine::ForCurrentProcess());
+  CommandLine::ForCurrentProcess()->AppendSwitch(
+      switches::kUIEnableThreadedRaster);
+  l1->SetPaintInTiles(true);
+  *CommandLine::ForCurrentProcess() = old_command_line;
+  ASSERT_TRUE(l1->rasterizer());
+
+  l1->SchedulePaint(gfx::Rect(0, 0, 512, 256));
+  int tile_budget = 2;
+  EXPECT_TRUE(root->SendDamagedRects(&tile_budget));
+  while (l1->rasterizer()->rasterized_tile_count() < 2) {
+    RunPendingMessages();
+    base::PlatformThread::YieldCurrentThread();
+  }
+
+  const size_t kTileBytes = Layer::kTileSize * Layer::kTileSize * 4;
+  size_t upload_budget_bytes = 1;
+  EXPECT_FALSE(root->SendRasterizedTiles(&upload_budget_bytes));
+  EXPECT_EQ(0u, upload_budget_bytes);
+  upload_budget_bytes = 2 * kTileBytes;
+  EXPECT_TRUE(root->SendRasterizedTiles(&upload_budget_bytes));
+  EXPECT_EQ(kTileBytes, upload_budget_bytes);
+}
+
+// Checks the layer, tile and overdraw counts of frame breakdowns.
+TEST_F(LayerWithNullDelegateTest, LayerTreeStats) {
+  scoped_ptr<Layer> root(CreateNoTextureLayer(gfx::Rect(0, 0, 400, 400)));
+  scoped_ptr<Layer> l1(CreateTextureLayer(gfx::Rect(0, 0, 400, 200)));
+  scoped_ptr<Layer> l2(CreateTextureLayer(gfx::Rect(0, 0, 400, 400)));
+  scoped_ptr<Layer> l3(CreateTextureLayer(gfx::Rect(0, 0, 100, 100)));
+  root->Add(l1.get());
+  root->Add(l2.get());
+  root->Add(l3.get());
+  l3->SetVisible(false);
+
+  FrameBreakdown breakdown;
+  ComputeLayerTreeStats(root.get(), gfx::Size(400, 400), &breakdown);
+  EXPECT_EQ(4, breakdown.layer_count);
+  EXPECT_EQ(2, breakdown.drawn_layer_count);
+  EXPECT_EQ(2 * 1 + 2 * 2, breakdown.tile_count);
+  EXPECT_FLOAT_EQ(1.5f, breakdown.overdraw);
+
+  // Only what is within the viewport counts.
+  Transform translation;
+  translation.SetTranslate(0.0f, 300.0f);
+  l2->SetTransform(translation);
+  ComputeLayerTreeStats(root.get(), gfx::Size(400, 400), &breakdown);
+  EXPECT_FLOAT_EQ(0.75f, breakdown.overdraw);
+}
+
 // Checks that stacking-related methods behave as advertised.
 TEST_F(LayerWithNullDelegateTest, Stacking) {
   scoped_ptr<Layer> root(new Layer(LAYER_NOT_DRAWN));
@@ -819,6 +1146,49 @@ TEST_F(LayerWithRealCompositorTest, MAYBE_DrawPixels) {
   EXPECT_TRUE(is_all_red);
 }
 
+// Checks that ReadPixelsAsync() reads the next frame, and scales it.
+TEST_F(LayerWithRealCompositorTest, MAYBE_ReadPixelsAsync) {
+  scoped_ptr<Layer> layer(CreateColorLayer(SK_ColorRED,
+                                           gfx::Rect(0, 0, 500, 500)));
+  scoped_ptr<Layer> layer2(CreateColorLayer(SK_ColorBLUE,
+                                            gfx::Rect(0, 0, 500, 10)));
+  layer->Add(layer2.get());
+  DrawTree(layer.get());
+
+  ReadPixelsWaiter blue;
+  ReadPixelsWaiter red;
+  ReadPixelsWaiter outside;
+  Compositor* compositor = GetCompositor();
+  compositor->ReadPixelsAsync(gfx::Rect(0, 0, 500, 10), gfx::Size(500, 10),
+                              blue.callback());
+  compositor->ReadPixelsAsync(gfx::Rect(0, 100, 400, 400), gfx::Size(40, 40),
+                              red.callback());
+  compositor->ReadPixelsAsync(gfx::Rect(0, 0, 600, 10), gfx::Size(600, 10),
+                              outside.callback());
+  compositor->Draw(false);
+  blue.Wait();
+  red.Wait();
+  outside.Wait();
+
+  ASSERT_TRUE(blue.success());
+  ASSERT_EQ(500, blue.bitmap().width());
+  ASSERT_EQ(10, blue.bitmap().height());
+  SkAutoLockPixels blue_lock(blue.bitmap());
+  for (int x = 0; x < 500; x++) {
+    for (int y = 0; y < 10; y++)
+      ASSERT_EQ(SK_ColorBLUE, blue.bitmap().getColor(x, y));
+  }
+
+  ASSERT_TRUE(red.success());
+  ASSERT_EQ(40, red.bitmap().width());
+  ASSERT_EQ(40, red.bitmap().height());
+  SkAutoLockPixels red_lock(red.bitmap());
+  EXPECT_EQ(SK_ColorRED, red.bitmap().getColor(20, 20));
+
+  EXPECT_FALSE(outside.success());
+  EXPECT_TRUE(outside.bitmap().empty());
+}
+
 // Checks the logic around Compositor::SetRootLayer and Layer::SetCompositor.
 TEST_F(LayerWithRealCompositorTest, MAYBE_SetRootLayer) {
   Compositor* compositor = GetCompositor();
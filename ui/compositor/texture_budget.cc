@@ -0,0 +1,96 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/compositor/texture_budget.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "ui/compositor/layer.h"
+
+namespace ui {
+
+TextureBudget::TextureBudget()
+    : limit_bytes_(std::numeric_limits<size_t>::max()),
+      trim_pending_(false),
+      trim_level_(base::MemoryPressureListener::MEMORY_PRESSURE_MODERATE),
+      used_bytes_(0),
+      drawn_bytes_(0),
+      eviction_count_(0),
+      frame_number_(0) {
+}
+
+TextureBudget::~TextureBudget() {
+}
+
+void TextureBudget::Update(Layer* root) {
+  frame_number_++;
+  used_bytes_ = 0;
+  drawn_bytes_ = 0;
+
+  std::map<const Layer*, int64> last_drawn;
+  std::vector<std::pair<int64, Layer*> > idle_layers;
+  if (root)
+    AddLayerTextures(root, true, &last_drawn, &idle_layers);
+  last_drawn_.swap(last_drawn);
+
+  size_t limit_bytes = limit_bytes_;
+  if (trim_pending_) {
+    limit_bytes = base::MemoryPressureListener::GetTrimmedBudget(limit_bytes_,
+                                                                 trim_level_);
+    trim_pending_ = false;
+  }
+  if (used_bytes_ <= limit_bytes)
+    return;
+
+  std::sort(idle_layers.begin(), idle_layers.end());
+  for (size_t i = 0; i < idle_layers.size() && used_bytes_ > limit_bytes;
+       ++i) {
+    Layer* layer = idle_layers[i].second;
+    used_bytes_ -= layer->GetTextureMemoryBytes();
+    layer->EvictTexture();
+    eviction_count_++;
+  }
+}
+
+void TextureBudget::TrimAtNextUpdate(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  // The higher of two levels pending wins.
+  if (!trim_pending_ || level > trim_level_)
+    trim_level_ = level;
+  trim_pending_ = true;
+}
+
+void TextureBudget::AddLayerTextures(
+    Layer* layer,
+    bool drawn,
+    std::map<const Layer*, int64>* last_drawn,
+    std::vector<std::pair<int64, Layer*> >* idle_layers) {
+  drawn = drawn && layer->visible();
+  bool layer_drawn = drawn && !layer->occluded();
+  if (layer_drawn && layer->texture_evicted())
+    layer->RestoreTexture();
+
+  int64 last_drawn_frame = 0;
+  if (layer_drawn) {
+    last_drawn_frame = frame_number_;
+  } else {
+    std::map<const Layer*, int64>::const_iterator it = last_drawn_.find(layer);
+    if (it != last_drawn_.end())
+      last_drawn_frame = it->second;
+  }
+  (*last_drawn)[layer] = last_drawn_frame;
+
+  size_t bytes = layer->GetTextureMemoryBytes();
+  used_bytes_ += bytes;
+  if (layer_drawn)
+    drawn_bytes_ += bytes;
+  else if (bytes && layer->CanEvictTexture())
+    idle_layers->push_back(std::make_pair(last_drawn_frame, layer));
+
+  for (size_t i = 0; i < layer->children().size(); ++i)
+    AddLayerTextures(layer->children()[i], drawn, last_drawn, idle_layers);
+}
+
+}  // namespace ui
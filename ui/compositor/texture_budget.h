@@ -0,0 +1,83 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_COMPOSITOR_TEXTURE_BUDGET_H_
+#define UI_COMPOSITOR_TEXTURE_BUDGET_H_
+#pragma once
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "ui/compositor/compositor_export.h"
+
+namespace ui {
+
+class Layer;
+
+// TextureBudget keeps the textures of the layers of a compositor within a
+// number of bytes. When they use more, it evicts the textures of the layers
+// that aren't drawn, because they are hidden or occluded, least recently
+// drawn first. The layers repaint when they are drawn again. The textures of
+// drawn layers are never evicted, even over budget. When memory is short, the
+// next update evicts down to a share of the limit.
+class COMPOSITOR_EXPORT TextureBudget {
+ public:
+  TextureBudget();
+  ~TextureBudget();
+
+  void set_limit_bytes(size_t limit_bytes) { limit_bytes_ = limit_bytes; }
+  size_t limit_bytes() const { return limit_bytes_; }
+
+  // Called before each frame, after occlusion is computed, with the root of
+  // the tree to draw. Restores the textures of the evicted layers that are
+  // drawn again, then evicts as needed to get within the limit.
+  void Update(Layer* root);
+
+  // Makes the next Update() evict down to the share of the limit that
+  // |level| leaves, as if the limit were lower for that frame only.
+  void TrimAtNextUpdate(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+
+  // The bytes that the textures of the tree use, and how many of those belong
+  // to drawn layers, as of the last Update().
+  size_t used_bytes() const { return used_bytes_; }
+  size_t drawn_bytes() const { return drawn_bytes_; }
+
+  // The number of textures evicted since the budget was created.
+  int eviction_count() const { return eviction_count_; }
+
+ private:
+  // Records the textures of |layer| and its descendants. |drawn| is false if
+  // an ancestor is hidden. The layers that aren't drawn and whose texture
+  // could be evicted are added to |idle_layers|, with the frame in which they
+  // were last drawn.
+  void AddLayerTextures(
+      Layer* layer,
+      bool drawn,
+      std::map<const Layer*, int64>* last_drawn,
+      std::vector<std::pair<int64, Layer*> >* idle_layers);
+
+  size_t limit_bytes_;
+  bool trim_pending_;
+  base::MemoryPressureListener::MemoryPressureLevel trim_level_;
+  size_t used_bytes_;
+  size_t drawn_bytes_;
+  int eviction_count_;
+
+  // Counts the calls to Update().
+  int64 frame_number_;
+
+  // The frame in which each layer of the tree was last drawn. Rebuilt at each
+  // Update(), so that it only refers to layers of the tree.
+  std::map<const Layer*, int64> last_drawn_;
+
+  DISALLOW_COPY_AND_ASSIGN(TextureBudget);
+};
+
+}  // namespace ui
+
+#endif  // UI_COMPOSITOR_TEXTURE_BUDGET_H_
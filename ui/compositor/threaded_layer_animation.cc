@@ -0,0 +1,20 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/compositor/threaded_layer_animation.h"
+
+namespace ui {
+
+ThreadedLayerAnimation::Keyframe::Keyframe()
+    : opacity(0.0f) {
+}
+
+ThreadedLayerAnimation::ThreadedLayerAnimation()
+    : property(LayerAnimationElement::OPACITY) {
+}
+
+ThreadedLayerAnimation::~ThreadedLayerAnimation() {
+}
+
+}  // namespace ui
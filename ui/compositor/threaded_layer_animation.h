@@ -0,0 +1,42 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_COMPOSITOR_THREADED_LAYER_ANIMATION_H_
+#define UI_COMPOSITOR_THREADED_LAYER_ANIMATION_H_
+#pragma once
+
+#include <vector>
+
+#include "base/time.h"
+#include "ui/compositor/compositor_export.h"
+#include "ui/compositor/layer_animation_element.h"
+#include "ui/gfx/transform.h"
+
+namespace ui {
+
+// An animation of one property, as keyframes for the compositor to play on
+// its own thread.  The property goes linearly from each keyframe to the next.
+struct COMPOSITOR_EXPORT ThreadedLayerAnimation {
+  struct Keyframe {
+    Keyframe();
+
+    // Since the start of the animation.
+    base::TimeDelta time;
+    // Only the value of |property| is meaningful.
+    float opacity;
+    Transform transform;
+  };
+
+  ThreadedLayerAnimation();
+  ~ThreadedLayerAnimation();
+
+  // TRANSFORM or OPACITY.
+  LayerAnimationElement::AnimatableProperty property;
+  // In order of time; the first is at time zero.
+  std::vector<Keyframe> keyframes;
+};
+
+}  // namespace ui
+
+#endif  // UI_COMPOSITOR_THREADED_LAYER_ANIMATION_H_
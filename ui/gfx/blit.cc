@@ -4,7 +4,16 @@
 
 #include "ui/gfx/blit.h"
 
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/location.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/sys_info.h"
+#include "base/threading/worker_pool.h"
 #include "build/build_config.h"
 #include "skia/ext/platform_canvas.h"
 #include "ui/gfx/point.h"
@@ -146,6 +155,147 @@ void ScrollCanvas(SkCanvas* canvas,
 // use platform scroll code, but it's complex so we just use the same path
 // here. Either way it will be software-only, so it shouldn't matter much.
 
+namespace {
+
+// Scrolls that move fewer pixels than this run on the calling thread only,
+// since posting the strips would cost more than it saves.
+const int kMinParallelScrollPixels = 512 * 512;
+
+// The fewest columns or rows a strip has.
+const int kMinStripSize = 64;
+
+// Moves the pixels of |bitmap| that end up in |dest_rect| by |amount|, in
+// place.
+void ScrollPixels(const SkBitmap& bitmap,
+                  const gfx::Rect& dest_rect,
+                  const gfx::Point& amount) {
+  size_t row_bytes = dest_rect.width() * 4;
+  size_t stride = bitmap.rowBytes();
+  char* dest = reinterpret_cast<char*>(
+      bitmap.getAddr32(dest_rect.x(), dest_rect.y()));
+  const char* src = reinterpret_cast<const char*>(
+      bitmap.getAddr32(dest_rect.x() - amount.x(),
+                       dest_rect.y() - amount.y()));
+  if (amount.y() > 0) {
+    // Data is moving down, copy from the bottom up.
+    for (int y = dest_rect.height() - 1; y >= 0; y--)
+      memcpy(dest + y * stride, src + y * stride, row_bytes);
+  } else if (amount.y() < 0) {
+    // Data is moving up, copy from the top down.
+    for (int y = 0; y < dest_rect.height(); y++)
+      memcpy(dest + y * stride, src + y * stride, row_bytes);
+  } else if (amount.x() != 0) {
+    // Horizontal-only scroll. We can do it in either top-to-bottom or bottom-
+    // to-top, but have to be careful about the order for copying each row.
+    // Fortunately, memmove already handles this for us.
+    for (int y = 0; y < dest_rect.height(); y++)
+      memmove(dest + y * stride, src + y * stride, row_bytes);
+  }
+}
+
+// Returns the number of strips to split a scroll into, each of which runs on
+// its own thread. A vertical scroll only moves pixels within their column,
+// and a horizontal one within their row, so strips of columns or rows are
+// independent. A diagonal scroll reads each strip from its neighbour, and
+// isn't split.
+int GetScrollStripCount(const gfx::Rect& dest_rect, const gfx::Point& amount) {
+  if (amount.x() != 0 && amount.y() != 0)
+    return 1;
+  if (dest_rect.width() * dest_rect.height() < kMinParallelScrollPixels)
+    return 1;
+  int size = amount.x() == 0 ? dest_rect.width() : dest_rect.height();
+  return std::max(1, std::min(base::SysInfo::NumberOfProcessors(),
+                              size / kMinStripSize));
+}
+
+// Runs ScrollPixels() as strips of columns (vertical scrolls) or rows
+// (horizontal scrolls) on the worker pool and on the calling thread. Each
+// thread taking part scrolls the strips no thread has taken yet until there
+// are none left.
+class ScrollJob : public base::RefCountedThreadSafe<ScrollJob> {
+ public:
+  ScrollJob(const SkBitmap& bitmap,
+            const gfx::Rect& dest_rect,
+            const gfx::Point& amount,
+            int strip_count)
+      : bitmap_(bitmap),
+        dest_rect_(dest_rect),
+        amount_(amount),
+        strip_count_(strip_count),
+        next_strip_(0),
+        done_count_(0),
+        all_done_(&lock_) {
+  }
+
+  // Scrolls all the strips and returns once they are done. The worker tasks
+  // that start after that find nothing left to do, and don't touch the
+  // pixels. If a task can't be posted, the calling thread runs its share.
+  void RunAndWait() {
+    for (int i = 1; i < strip_count_; ++i) {
+      if (!base::WorkerPool::PostTask(
+              FROM_HERE, base::Bind(&ScrollJob::RunStrips, this), false))
+        break;
+    }
+    RunStrips();
+
+    base::AutoLock lock(lock_);
+    while (done_count_ < strip_count_)
+      all_done_.Wait();
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<ScrollJob>;
+
+  ~ScrollJob() {}
+
+  void RunStrips() {
+    for (;;) {
+      int strip;
+      {
+        base::AutoLock lock(lock_);
+        if (next_strip_ == strip_count_)
+          return;
+        strip = next_strip_++;
+      }
+
+      ScrollPixels(bitmap_, GetStrip(strip), amount_);
+
+      base::AutoLock lock(lock_);
+      if (++done_count_ == strip_count_)
+        all_done_.Broadcast();
+    }
+  }
+
+  gfx::Rect GetStrip(int strip) const {
+    if (amount_.x() == 0) {
+      int left = dest_rect_.x() + dest_rect_.width() * strip / strip_count_;
+      int right =
+          dest_rect_.x() + dest_rect_.width() * (strip + 1) / strip_count_;
+      return gfx::Rect(left, dest_rect_.y(), right - left,
+                       dest_rect_.height());
+    }
+    int top = dest_rect_.y() + dest_rect_.height() * strip / strip_count_;
+    int bottom =
+        dest_rect_.y() + dest_rect_.height() * (strip + 1) / strip_count_;
+    return gfx::Rect(dest_rect_.x(), top, dest_rect_.width(), bottom - top);
+  }
+
+  const SkBitmap bitmap_;
+  const gfx::Rect dest_rect_;
+  const gfx::Point amount_;
+  const int strip_count_;
+
+  // Guards the members below.
+  base::Lock lock_;
+  int next_strip_;
+  int done_count_;
+  base::ConditionVariable all_done_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScrollJob);
+};
+
+}  // namespace
+
 void ScrollCanvas(SkCanvas* canvas,
                   const gfx::Rect& in_clip,
                   const gfx::Point& amount) {
@@ -162,37 +312,17 @@ void ScrollCanvas(SkCanvas* canvas,
   gfx::Rect dest_rect = clip;
   dest_rect.Offset(amount);
   dest_rect = dest_rect.Intersect(clip);
-  if (dest_rect.size() == gfx::Size())
+  if (dest_rect.size() == gfx::Size() || amount == gfx::Point())
     return;  // Nothing to do.
 
-  // Compute the source pixels that will map to the dest_rect
-  gfx::Rect src_rect = dest_rect;
-  src_rect.Offset(-amount.x(), -amount.y());
-
-  size_t row_bytes = dest_rect.width() * 4;
-  if (amount.y() > 0) {
-    // Data is moving down, copy from the bottom up.
-    for (int y = dest_rect.height() - 1; y >= 0; y--) {
-      memcpy(bitmap.getAddr32(dest_rect.x(), dest_rect.y() + y),
-             bitmap.getAddr32(src_rect.x(), src_rect.y() + y),
-             row_bytes);
-    }
-  } else if (amount.y() < 0) {
-    // Data is moving up, copy from the top down.
-    for (int y = 0; y < dest_rect.height(); y++) {
-      memcpy(bitmap.getAddr32(dest_rect.x(), dest_rect.y() + y),
-             bitmap.getAddr32(src_rect.x(), src_rect.y() + y),
-             row_bytes);
-    }
-  } else if (amount.x() != 0) {
-    // Horizontal-only scroll. We can do it in either top-to-bottom or bottom-
-    // to-top, but have to be careful about the order for copying each row.
-    // Fortunately, memmove already handles this for us.
-    for (int y = 0; y < dest_rect.height(); y++) {
-      memmove(bitmap.getAddr32(dest_rect.x(), dest_rect.y() + y),
-              bitmap.getAddr32(src_rect.x(), src_rect.y() + y),
-              row_bytes);
-    }
+  // Large scrolls are split into strips that run on several threads.
+  int strip_count = GetScrollStripCount(dest_rect, amount);
+  if (strip_count > 1) {
+    scoped_refptr<ScrollJob> job(
+        new ScrollJob(bitmap, dest_rect, amount, strip_count));
+    job->RunAndWait();
+  } else {
+    ScrollPixels(bitmap, dest_rect, amount);
   }
 }
 
@@ -135,6 +135,51 @@ TEST(Blit, ScrollCanvas) {
   VerifyCanvasValues<5, 5>(&canvas, scroll_diagonal_expected);
 }
 
+#if !defined(OS_WIN) || defined(USE_AURA)
+
+// Scrolls large enough to be split into strips that run on several threads
+// must give the same result as scrolling row by row.
+TEST(Blit, ScrollCanvasLarge) {
+  static const int kCanvasWidth = 1024;
+  static const int kCanvasHeight = 768;
+  skia::PlatformCanvas canvas(kCanvasWidth, kCanvasHeight, true);
+  SkBitmap& bitmap = const_cast<SkBitmap&>(
+      skia::GetTopDevice(canvas)->accessBitmap(true));
+  SkAutoLockPixels lock(bitmap);
+
+  const gfx::Point amounts[] = {
+    gfx::Point(0, 37),
+    gfx::Point(0, -45),
+    gfx::Point(53, 0),
+    gfx::Point(-29, 0),
+    gfx::Point(11, -7),
+  };
+  gfx::Rect clip(3, 5, kCanvasWidth - 10, kCanvasHeight - 9);
+  for (size_t i = 0; i < arraysize(amounts); ++i) {
+    const gfx::Point& amount = amounts[i];
+    for (int y = 0; y < kCanvasHeight; y++) {
+      for (int x = 0; x < kCanvasWidth; x++)
+        *bitmap.getAddr32(x, y) = (y << 16) | x;
+    }
+
+    gfx::ScrollCanvas(&canvas, clip, amount);
+
+    gfx::Rect dest_rect = clip;
+    dest_rect.Offset(amount);
+    dest_rect = dest_rect.Intersect(clip);
+    for (int y = 0; y < kCanvasHeight; y++) {
+      for (int x = 0; x < kCanvasWidth; x++) {
+        uint32 expected = dest_rect.Contains(x, y) ?
+            ((y - amount.y()) << 16) | (x - amount.x()) : (y << 16) | x;
+        ASSERT_EQ(expected, *bitmap.getAddr32(x, y))
+            << "amount " << amount.ToString() << " at " << x << "," << y;
+      }
+    }
+  }
+}
+
+#endif
+
 #if defined(OS_WIN)
 
 TEST(Blit, WithSharedMemory) {
@@ -4,6 +4,7 @@
 
 #include "ui/gfx/canvas.h"
 
+#include <algorithm>
 #include <limits>
 
 #include "base/i18n/rtl.h"
@@ -12,6 +13,7 @@
 #include "third_party/skia/include/effects/SkGradientShader.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/font.h"
+#include "ui/gfx/insets.h"
 #include "ui/gfx/rect.h"
 #include "ui/gfx/skia_util.h"
 #include "ui/gfx/transform.h"
@@ -352,6 +354,57 @@ void Canvas::DrawImageInt(const gfx::ImageSkia& image,
   canvas_->drawRect(dest_rect, p);
 }
 
+void Canvas::DrawImageNine(const gfx::ImageSkia& image,
+                           const gfx::Insets& insets,
+                           int dest_x, int dest_y, int dest_w, int dest_h,
+                           bool paint_center) {
+  if (!IntersectsClipRectInt(dest_x, dest_y, dest_w, dest_h))
+    return;
+
+  // The bitmap is picked for the scale its center is stretched by.
+  int src_center_w = std::max(image.width() - insets.width(), 1);
+  int src_center_h = std::max(image.height() - insets.height(), 1);
+  float user_scale_x = std::max(
+      static_cast<float>(dest_w - insets.width()) / src_center_w, 1.0f);
+  float user_scale_y = std::max(
+      static_cast<float>(dest_h - insets.height()) / src_center_h, 1.0f);
+
+  float bitmap_scale;
+  const SkBitmap& bitmap = GetBitmapToPaint(image, user_scale_x, user_scale_y,
+                                            &bitmap_scale);
+  if (bitmap.isNull())
+    return;
+
+  // The nine-patch is drawn in the pixels of the bitmap.
+  SkIRect center = SkIRect::MakeLTRB(
+      static_cast<int>(insets.left() * bitmap_scale + 0.5f),
+      static_cast<int>(insets.top() * bitmap_scale + 0.5f),
+      bitmap.width() - static_cast<int>(insets.right() * bitmap_scale + 0.5f),
+      bitmap.height() -
+          static_cast<int>(insets.bottom() * bitmap_scale + 0.5f));
+  SkRect dest_rect = SkRect::MakeXYWH(
+      SkFloatToScalar(dest_x * bitmap_scale),
+      SkFloatToScalar(dest_y * bitmap_scale),
+      SkFloatToScalar(dest_w * bitmap_scale),
+      SkFloatToScalar(dest_h * bitmap_scale));
+
+  canvas_->save();
+  canvas_->scale(SkFloatToScalar(1.0f / bitmap_scale),
+                 SkFloatToScalar(1.0f / bitmap_scale));
+  if (!paint_center) {
+    SkRect dest_center = SkRect::MakeLTRB(
+        dest_rect.left() + SkIntToScalar(center.left()),
+        dest_rect.top() + SkIntToScalar(center.top()),
+        dest_rect.right() - SkIntToScalar(bitmap.width() - center.right()),
+        dest_rect.bottom() - SkIntToScalar(bitmap.height() - center.bottom()));
+    canvas_->clipRect(dest_center, SkRegion::kDifference_Op);
+  }
+  SkPaint paint;
+  paint.setFilterBitmap(true);
+  canvas_->drawBitmapNine(bitmap, center, dest_rect, &paint);
+  canvas_->restore();
+}
+
 void Canvas::DrawStringInt(const string16& text,
                            const gfx::Font& font,
                            SkColor color,
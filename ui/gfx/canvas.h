@@ -25,6 +25,7 @@ class Transform;
 namespace gfx {
 
 class Brush;
+class Insets;
 class Rect;
 class Font;
 class Point;
@@ -278,6 +279,18 @@ class UI_EXPORT Canvas {
                     bool filter,
                     const SkPaint& paint);
 
+  // Draws |image| as a nine-patch filling the destination rect. |insets| divide
+  // the image into nine regions: the four corners are drawn unscaled, the
+  // edges are stretched along one axis and the center along both. If
+  // |paint_center| is false, the center is left unpainted. The image is drawn
+  // in one call, without any intermediate bitmap.
+  // Parameters are specified relative to current canvas scale not in pixels.
+  // Thus, |x| is 2 pixels if canvas scale = 2 & |x| = 1.
+  void DrawImageNine(const gfx::ImageSkia& image,
+                     const gfx::Insets& insets,
+                     int dest_x, int dest_y, int dest_w, int dest_h,
+                     bool paint_center);
+
   // Draws text with the specified color, font and location. The text is
   // aligned to the left, vertically centered, clipped to the region. If the
   // text is too big, it is truncated and '...' is added to the end.
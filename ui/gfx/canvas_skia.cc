@@ -4,9 +4,12 @@
 
 #include "ui/gfx/canvas.h"
 
+#include "base/bind.h"
 #include "base/i18n/rtl.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/stringprintf.h"
+#include "base/utf_string_conversions.h"
 #include "ui/base/range/range.h"
 #include "ui/base/text/text_elider.h"
 #include "ui/gfx/font.h"
@@ -14,6 +17,7 @@
 #include "ui/gfx/insets.h"
 #include "ui/gfx/rect.h"
 #include "ui/gfx/render_text.h"
+#include "ui/gfx/shadow_cache.h"
 #include "ui/gfx/shadow_value.h"
 #include "ui/gfx/skia_util.h"
 
@@ -192,6 +196,18 @@ int AdjustPlatformSpecificFlags(const string16& text, int flags) {
   return flags;
 }
 
+// Paints |text| in black on |canvas|, in |size| at its origin. Used to paint
+// the masks of text shadows.
+void PaintTextMask(const string16& text,
+                   const gfx::Font& font,
+                   const gfx::Size& size,
+                   int flags,
+                   gfx::Canvas* canvas) {
+  canvas->DrawStringInt(text, font, SK_ColorBLACK, 0, 0,
+                        size.width(), size.height(),
+                        flags | gfx::Canvas::NO_SUBPIXEL_RENDERING);
+}
+
 }  // anonymous namespace
 
 namespace gfx {
@@ -278,6 +294,23 @@ void Canvas::DrawStringWithShadows(const string16& text,
   gfx::Rect clip_rect(text_bounds);
   clip_rect.Inset(ShadowValue::GetMargin(shadows));
 
+  if (!shadows.empty()) {
+    // Paint the shadows from the masks cached for the text, then the text
+    // itself, so repainting the same text doesn't blur it again.
+    const std::string shape_key = base::StringPrintf(
+        "Text %s %d %d %d ", font.GetFontName().c_str(), font.GetFontSize(),
+        font.GetStyle(), flags) + UTF16ToUTF8(text);
+    canvas_->save(SkCanvas::kClip_SaveFlag);
+    ClipRect(clip_rect);
+    ShadowCache::GetInstance()->PaintShadows(
+        this, shape_key, text_bounds, shadows,
+        base::Bind(&PaintTextMask, text, font, text_bounds.size(), flags));
+    canvas_->restore();
+    DrawStringWithShadows(text, font, color, text_bounds, flags,
+                          ShadowValues());
+    return;
+  }
+
   canvas_->save(SkCanvas::kClip_SaveFlag);
   ClipRect(clip_rect);
 
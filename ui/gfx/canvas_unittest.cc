@@ -6,6 +6,8 @@
 #include "testing/gtest/include/gtest/gtest.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/font.h"
+#include "ui/gfx/insets.h"
+#include "ui/gfx/size.h"
 
 namespace gfx {
 
@@ -34,4 +36,37 @@ TEST(CanvasTest, StringSizeEmptyString) {
   EXPECT_GT(height, 0);
 }
 
+// The corners of a nine-patch keep their size and the center is left alone
+// when it isn't painted.
+TEST(CanvasTest, DrawImageNine) {
+  // A 6x6 image with 2 pixel red borders around a 2x2 green center.
+  SkBitmap bitmap;
+  bitmap.setConfig(SkBitmap::kARGB_8888_Config, 6, 6);
+  bitmap.allocPixels();
+  bitmap.eraseColor(SK_ColorRED);
+  SkBitmap center;
+  bitmap.extractSubset(&center, SkIRect::MakeLTRB(2, 2, 4, 4));
+  center.eraseColor(SK_ColorGREEN);
+
+  Canvas canvas(Size(20, 20), false);
+  canvas.sk_canvas()->clear(SK_ColorBLUE);
+  canvas.DrawImageNine(ImageSkia(bitmap), Insets(2, 2, 2, 2), 0, 0, 20, 20,
+                       true);
+  SkBitmap result(canvas.ExtractBitmap());
+  SkAutoLockPixels lock(result);
+  EXPECT_EQ(SkPreMultiplyColor(SK_ColorRED), *result.getAddr32(0, 0));
+  EXPECT_EQ(SkPreMultiplyColor(SK_ColorRED), *result.getAddr32(19, 19));
+  EXPECT_EQ(SkPreMultiplyColor(SK_ColorRED), *result.getAddr32(10, 1));
+  EXPECT_EQ(SkPreMultiplyColor(SK_ColorGREEN), *result.getAddr32(10, 10));
+
+  Canvas hollow_canvas(Size(20, 20), false);
+  hollow_canvas.sk_canvas()->clear(SK_ColorBLUE);
+  hollow_canvas.DrawImageNine(ImageSkia(bitmap), Insets(2, 2, 2, 2),
+                              0, 0, 20, 20, false);
+  SkBitmap hollow_result(hollow_canvas.ExtractBitmap());
+  SkAutoLockPixels hollow_lock(hollow_result);
+  EXPECT_EQ(SkPreMultiplyColor(SK_ColorRED), *hollow_result.getAddr32(1, 10));
+  EXPECT_EQ(SkPreMultiplyColor(SK_ColorBLUE), *hollow_result.getAddr32(10, 10));
+}
+
 }  // namespace gfx
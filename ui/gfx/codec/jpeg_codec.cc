@@ -6,10 +6,14 @@
 
 #include <setjmp.h>
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkColorPriv.h"
+#include "ui/gfx/rect.h"
+#include "ui/gfx/size.h"
 
 extern "C" {
 #if defined(USE_SYSTEM_LIBJPEG)
@@ -184,15 +188,49 @@ class CompressDestroyer {
   jpeg_compress_struct* cinfo_;
 };
 
-}  // namespace
+// The destination of EncodeToBuffer(): a caller-supplied buffer that is
+// never grown.
+struct FixedBufferState {
+  FixedBufferState(unsigned char* b, size_t c)
+      : buffer(b),
+        capacity(c),
+        size(0) {
+  }
 
-bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
-                       int w, int h, int row_byte_width,
-                       int quality, std::vector<unsigned char>* output) {
+  unsigned char* buffer;
+  size_t capacity;
+
+  // The number of bytes written, set when encoding completes.
+  size_t size;
+};
+
+void InitFixedDestination(jpeg_compress_struct* cinfo) {
+  FixedBufferState* state = static_cast<FixedBufferState*>(cinfo->client_data);
+  cinfo->dest->next_output_byte = state->buffer;
+  cinfo->dest->free_in_buffer = state->capacity;
+}
+
+// The buffer is full and can't grow, so fail the encode.
+boolean EmptyFixedBuffer(jpeg_compress_struct* cinfo) {
+  cinfo->err->error_exit(reinterpret_cast<jpeg_common_struct*>(cinfo));
+  return 0;
+}
+
+void TermFixedDestination(jpeg_compress_struct* cinfo) {
+  FixedBufferState* state = static_cast<FixedBufferState*>(cinfo->client_data);
+  state->size = state->capacity - cinfo->dest->free_in_buffer;
+}
+
+// Encodes |input| into |destmgr|, whose callbacks get |client_data|.
+bool EncodeToDestination(const unsigned char* input,
+                         JPEGCodec::ColorFormat format,
+                         int w, int h, int row_byte_width,
+                         const JPEGCodec::EncodeOptions& options,
+                         jpeg_destination_mgr* destmgr,
+                         void* client_data) {
   jpeg_compress_struct cinfo;
   CompressDestroyer destroyer;
   destroyer.SetManagedObject(&cinfo);
-  output->clear();
 
   // We set up the normal JPEG error routines, then override error_exit.
   // This must be done before the call to create_compress.
@@ -221,15 +259,15 @@ bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
   // libjpeg-turbo supports all input formats used by Chromium (i.e. RGB, RGBA,
   // and BGRA), we just map the input parameters to a colorspace used by
   // libjpeg-turbo.
-  if (format == FORMAT_RGB) {
+  if (format == JPEGCodec::FORMAT_RGB) {
     cinfo.input_components = 3;
     cinfo.in_color_space = JCS_RGB;
-  } else if (format == FORMAT_RGBA ||
-             (format == FORMAT_SkBitmap && SK_R32_SHIFT == 0)) {
+  } else if (format == JPEGCodec::FORMAT_RGBA ||
+             (format == JPEGCodec::FORMAT_SkBitmap && SK_R32_SHIFT == 0)) {
     cinfo.input_components = 4;
     cinfo.in_color_space = JCS_EXT_RGBX;
-  } else if (format == FORMAT_BGRA ||
-             (format == FORMAT_SkBitmap && SK_B32_SHIFT == 0)) {
+  } else if (format == JPEGCodec::FORMAT_BGRA ||
+             (format == JPEGCodec::FORMAT_SkBitmap && SK_B32_SHIFT == 0)) {
     cinfo.input_components = 4;
     cinfo.in_color_space = JCS_EXT_BGRX;
   } else {
@@ -244,17 +282,12 @@ bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
   cinfo.data_precision = 8;
 
   jpeg_set_defaults(&cinfo);
-  jpeg_set_quality(&cinfo, quality, 1);  // quality here is 0-100
+  jpeg_set_quality(&cinfo, options.quality, 1);  // quality here is 0-100
+  cinfo.dct_method = options.fast_dct ? JDCT_IFAST : JDCT_ISLOW;
+  cinfo.optimize_coding = options.optimize_coding ? 1 : 0;
 
-  // set up the destination manager
-  jpeg_destination_mgr destmgr;
-  destmgr.init_destination = InitDestination;
-  destmgr.empty_output_buffer = EmptyOutputBuffer;
-  destmgr.term_destination = TermDestination;
-  cinfo.dest = &destmgr;
-
-  JpegEncoderState state(output);
-  cinfo.client_data = &state;
+  cinfo.dest = destmgr;
+  cinfo.client_data = client_data;
 
   jpeg_start_compress(&cinfo, 1);
 
@@ -268,7 +301,7 @@ bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
     jpeg_write_scanlines(&cinfo, const_cast<unsigned char**>(&row), 1);
   }
 #else
-  if (format == FORMAT_RGB) {
+  if (format == JPEGCodec::FORMAT_RGB) {
     // no conversion necessary
     while (cinfo.next_scanline < cinfo.image_height) {
       const unsigned char* row = &input[cinfo.next_scanline * row_byte_width];
@@ -277,11 +310,11 @@ bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
   } else {
     // get the correct format converter
     void (*converter)(const unsigned char* in, int w, unsigned char* rgb);
-    if (format == FORMAT_RGBA ||
-        (format == FORMAT_SkBitmap && SK_R32_SHIFT == 0)) {
+    if (format == JPEGCodec::FORMAT_RGBA ||
+        (format == JPEGCodec::FORMAT_SkBitmap && SK_R32_SHIFT == 0)) {
       converter = StripAlpha;
-    } else if (format == FORMAT_BGRA ||
-               (format == FORMAT_SkBitmap && SK_B32_SHIFT == 0)) {
+    } else if (format == JPEGCodec::FORMAT_BGRA ||
+               (format == JPEGCodec::FORMAT_SkBitmap && SK_B32_SHIFT == 0)) {
       converter = BGRAtoRGB;
     } else {
       NOTREACHED() << "Invalid pixel format";
@@ -303,6 +336,86 @@ bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
   return true;
 }
 
+}  // namespace
+
+JPEGCodec::EncodeOptions::EncodeOptions()
+    : quality(90),
+      fast_dct(false),
+      optimize_coding(false) {
+}
+
+// static
+JPEGCodec::EncodeOptions JPEGCodec::EncodeOptions::ForPreset(
+    EncodePreset preset) {
+  EncodeOptions options;
+  switch (preset) {
+    case PRESET_FAST:
+      options.quality = 80;
+      options.fast_dct = true;
+      break;
+    case PRESET_DEFAULT:
+      break;
+    case PRESET_SMALL:
+      options.optimize_coding = true;
+      break;
+  }
+  return options;
+}
+
+bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
+                       int w, int h, int row_byte_width,
+                       int quality, std::vector<unsigned char>* output) {
+  EncodeOptions options;
+  options.quality = quality;
+  return Encode(input, format, w, h, row_byte_width, options, output);
+}
+
+bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
+                       int w, int h, int row_byte_width,
+                       const EncodeOptions& options,
+                       std::vector<unsigned char>* output) {
+  output->clear();
+
+  // set up the destination manager
+  jpeg_destination_mgr destmgr;
+  destmgr.init_destination = InitDestination;
+  destmgr.empty_output_buffer = EmptyOutputBuffer;
+  destmgr.term_destination = TermDestination;
+
+  JpegEncoderState state(output);
+  return EncodeToDestination(input, format, w, h, row_byte_width, options,
+                             &destmgr, &state);
+}
+
+bool JPEGCodec::EncodeToBuffer(const unsigned char* input, ColorFormat format,
+                               int w, int h, int row_byte_width,
+                               const EncodeOptions& options,
+                               unsigned char* output, size_t output_capacity,
+                               size_t* output_size) {
+  jpeg_destination_mgr destmgr;
+  destmgr.init_destination = InitFixedDestination;
+  destmgr.empty_output_buffer = EmptyFixedBuffer;
+  destmgr.term_destination = TermFixedDestination;
+
+  FixedBufferState state(output, output_capacity);
+  if (!EncodeToDestination(input, format, w, h, row_byte_width, options,
+                           &destmgr, &state)) {
+    return false;
+  }
+  *output_size = state.size;
+  return true;
+}
+
+// static
+size_t JPEGCodec::EncodedSizeBound(int w, int h) {
+  // Whole 16x16 MCUs of 6 bytes per pixel, the worst case without chroma
+  // subsampling, plus room for the headers and tables. This is at least
+  // libjpeg-turbo's tjBufSize() for any subsampling.
+  size_t padded_w = (static_cast<size_t>(w) + 15) & ~static_cast<size_t>(15);
+  size_t padded_h = (static_cast<size_t>(h) + 15) & ~static_cast<size_t>(15);
+  return padded_w * padded_h * 6 + 2048;
+}
+
 // Decoder --------------------------------------------------------------------
 
 namespace {
@@ -431,6 +544,25 @@ class DecompressDestroyer {
   jpeg_decompress_struct* cinfo_;
 };
 
+// The largest factor libjpeg scales images down by while decoding.
+const int kMaxScaleDenominator = 8;
+
+// Returns the largest factor, out of 1, 2, 4 and 8, that |size| can be
+// scaled down by and still be at least as large as |target_size|.
+int GetScaleDenominator(const Size& size, const Size& target_size) {
+  if (target_size.IsEmpty())
+    return 1;
+  int denominator = kMaxScaleDenominator;
+  while (denominator > 1 &&
+         ((size.width() + denominator - 1) / denominator <
+              target_size.width() ||
+          (size.height() + denominator - 1) / denominator <
+              target_size.height())) {
+    denominator /= 2;
+  }
+  return denominator;
+}
+
 }  // namespace
 
 bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
@@ -605,4 +737,132 @@ SkBitmap* JPEGCodec::Decode(const unsigned char* input, size_t input_size) {
   return bitmap;
 }
 
+// static
+SkBitmap* JPEGCodec::DecodeScaled(const unsigned char* input,
+                                  size_t input_size,
+                                  const Size& target_size,
+                                  const Rect& region) {
+  // These are set up before the setjmp() below, so that they are still valid
+  // when the library jumps back to it.
+  scoped_ptr<SkBitmap> bitmap(new SkBitmap);
+  std::vector<unsigned char> row_data;
+
+  jpeg_decompress_struct cinfo;
+  DecompressDestroyer destroyer;
+  destroyer.SetManagedObject(&cinfo);
+
+  CoderErrorMgr errmgr;
+  cinfo.err = jpeg_std_error(&errmgr.pub);
+  errmgr.pub.error_exit = ErrorExit;
+  if (setjmp(errmgr.setjmp_buffer)) {
+    destroyer.DestroyManagedObject();
+    return NULL;
+  }
+
+  jpeg_create_decompress(&cinfo);
+
+  jpeg_source_mgr srcmgr;
+  srcmgr.init_source = InitSource;
+  srcmgr.fill_input_buffer = FillInputBuffer;
+  srcmgr.skip_input_data = SkipInputData;
+  srcmgr.resync_to_restart = jpeg_resync_to_restart;  // use default routine
+  srcmgr.term_source = TermSource;
+  cinfo.src = &srcmgr;
+
+  JpegDecoderState state(input, input_size);
+  cinfo.client_data = &state;
+
+  if (jpeg_read_header(&cinfo, true) != JPEG_HEADER_OK)
+    return NULL;
+
+  switch (cinfo.jpeg_color_space) {
+    case JCS_GRAYSCALE:
+    case JCS_RGB:
+    case JCS_YCbCr:
+      break;
+    default:
+      // See Decode() above.
+      return NULL;
+  }
+
+  // JPEGs are opaque, so the pixels need no premultiplying; when the library
+  // can fill in the alpha bytes, rows decode straight into Skia's order.
+  bool direct = false;
+#ifdef JCS_EXTENSIONS
+  if (SK_B32_SHIFT == 0) {
+    cinfo.out_color_space = JCS_EXT_BGRX;
+    direct = true;
+  } else if (SK_R32_SHIFT == 0) {
+    cinfo.out_color_space = JCS_EXT_RGBX;
+    direct = true;
+  } else {
+    cinfo.out_color_space = JCS_RGB;
+  }
+#else
+  cinfo.out_color_space = JCS_RGB;
+#endif
+
+  Rect image_rect(cinfo.image_width, cinfo.image_height);
+  Rect source_rect = region.IsEmpty() ? image_rect :
+      region.Intersect(image_rect);
+  if (source_rect.IsEmpty())
+    return NULL;
+
+  cinfo.scale_num = 1;
+  cinfo.scale_denom = GetScaleDenominator(source_rect.size(), target_size);
+  jpeg_calc_output_dimensions(&cinfo);
+
+  // The region in the coordinates of the scaled image, rounded outwards.
+  const int denominator = cinfo.scale_denom;
+  const int output_width = static_cast<int>(cinfo.output_width);
+  const int output_height = static_cast<int>(cinfo.output_height);
+  const int left = source_rect.x() / denominator;
+  const int top = source_rect.y() / denominator;
+  const int right = std::min(output_width,
+      (source_rect.right() + denominator - 1) / denominator);
+  const int bottom = std::min(output_height,
+      (source_rect.bottom() + denominator - 1) / denominator);
+
+  bitmap->setConfig(SkBitmap::kARGB_8888_Config, right - left, bottom - top);
+  if (!bitmap->allocPixels())
+    return NULL;
+  bitmap->setIsOpaque(true);
+
+  jpeg_start_decompress(&cinfo);
+
+  // Rows are decoded straight into the bitmap when they need neither
+  // converting nor cropping; otherwise they go through |row_data|, as do the
+  // rows above the region.
+  const bool read_into_bitmap = direct && left == 0 &&
+      right == output_width;
+  if (!read_into_bitmap || top > 0)
+    row_data.resize(output_width * cinfo.output_components);
+
+  // libjpeg can't skip rows, so the ones above the region are decoded and
+  // dropped.
+  for (int y = 0; y < bottom; ++y) {
+    unsigned char* rowptr = y >= top && read_into_bitmap ?
+        reinterpret_cast<unsigned char*>(bitmap->getAddr32(0, y - top)) :
+        &row_data[0];
+    if (!jpeg_read_scanlines(&cinfo, &rowptr, 1))
+      return NULL;
+    if (y < top || read_into_bitmap)
+      continue;
+
+    unsigned char* dest =
+        reinterpret_cast<unsigned char*>(bitmap->getAddr32(0, y - top));
+    if (direct) {
+      memcpy(dest, &row_data[left * 4], (right - left) * 4);
+    } else if (SK_B32_SHIFT == 0) {
+      RGBtoBGRA(&row_data[left * 3], right - left, dest);
+    } else {
+      AddAlpha(&row_data[left * 3], right - left, dest);
+    }
+  }
+
+  // The rows below the region are never decoded; the destroyer aborts the
+  // decompression.
+  return bitmap.release();
+}
+
 }  // namespace gfx
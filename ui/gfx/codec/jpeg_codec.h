@@ -15,6 +15,9 @@ class SkBitmap;
 
 namespace gfx {
 
+class Rect;
+class Size;
+
 // Interface for encoding/decoding JPEG data. This is a wrapper around libjpeg,
 // which has an inconvenient interface for callers. This is only used for UI
 // elements, WebKit has its own more complicated JPEG decoder which handles,
@@ -38,6 +41,38 @@ class UI_EXPORT JPEGCodec {
     FORMAT_SkBitmap
   };
 
+  // Speed and size trade-offs for encoding.
+  enum EncodePreset {
+    // The fast integer DCT at quality 80, where its loss of accuracy is hard
+    // to see. For thumbnails and other images encoded in bulk.
+    PRESET_FAST,
+
+    // The accurate integer DCT at quality 90.
+    PRESET_DEFAULT,
+
+    // As PRESET_DEFAULT, with Huffman tables optimized for the image, which
+    // makes smaller files but takes an extra pass. For images that are kept.
+    PRESET_SMALL
+  };
+
+  struct UI_EXPORT EncodeOptions {
+    // The options of PRESET_DEFAULT.
+    EncodeOptions();
+
+    static EncodeOptions ForPreset(EncodePreset preset);
+
+    // An integer in the range 0-100, where 100 is the highest quality.
+    int quality;
+
+    // Whether to use the fast integer DCT, which loses accuracy at high
+    // qualities, instead of the accurate one.
+    bool fast_dct;
+
+    // Whether to compute Huffman tables for the image in an extra pass
+    // rather than use the standard ones.
+    bool optimize_coding;
+  };
+
   // Encodes the given raw 'input' data, with each pixel being represented as
   // given in 'format'. The encoded JPEG data will be written into the supplied
   // vector and true will be returned on success. On failure (false), the
@@ -48,10 +83,31 @@ class UI_EXPORT JPEGCodec {
   //   w * bytes_per_pixel if there is extra padding at the end of each row
   //   (often, each row is padded to the next machine word).
   // quality: an integer in the range 0-100, where 100 is the highest quality.
+  //
+  // With libjpeg-turbo, RGBA and BGRA pixels are read as they are, without
+  // being converted to RGB first.
   static bool Encode(const unsigned char* input, ColorFormat format,
                      int w, int h, int row_byte_width,
                      int quality, std::vector<unsigned char>* output);
 
+  // As above, with the given options.
+  static bool Encode(const unsigned char* input, ColorFormat format,
+                     int w, int h, int row_byte_width,
+                     const EncodeOptions& options,
+                     std::vector<unsigned char>* output);
+
+  // As above, writing the JPEG data into the |output_capacity| bytes at
+  // |output| and its size into |*output_size|. Fails if the data does not
+  // fit; a buffer of EncodedSizeBound() bytes always fits.
+  static bool EncodeToBuffer(const unsigned char* input, ColorFormat format,
+                             int w, int h, int row_byte_width,
+                             const EncodeOptions& options,
+                             unsigned char* output, size_t output_capacity,
+                             size_t* output_size);
+
+  // The largest size of the JPEG data of a |w| x |h| image.
+  static size_t EncodedSizeBound(int w, int h);
+
   // Decodes the JPEG data contained in input of length input_size. The
   // decoded data will be placed in *output with the dimensions in *w and *h
   // on success (returns true). This data will be written in the'format'
@@ -64,6 +120,24 @@ class UI_EXPORT JPEGCodec {
   // successful, a SkBitmap is created and returned. It is up to the caller
   // to delete the returned bitmap.
   static SkBitmap* Decode(const unsigned char* input, size_t input_size);
+
+  // Decodes the part |region| of the JPEG data into an SkBitmap, letting
+  // libjpeg scale the image down by 2, 4 or 8 while it decodes, for as long
+  // as the result stays at least as large as |target_size|. This costs a
+  // fraction of decoding the whole image and resizing it, so it suits
+  // thumbnails and wallpapers; callers resize the result to the exact size
+  // they need. The pixels are written straight into the bitmap when the
+  // library supports Skia's pixel order, and the rows below |region| are
+  // not decoded at all.
+  //
+  // |region| is in the coordinates of the full size image and is clipped to
+  // it; an empty |region| means the whole image. An empty |target_size|
+  // means no scaling. Returns NULL on failure. It is up to the caller to
+  // delete the returned bitmap.
+  static SkBitmap* DecodeScaled(const unsigned char* input,
+                                size_t input_size,
+                                const Size& target_size,
+                                const Rect& region);
 };
 
 }  // namespace gfx
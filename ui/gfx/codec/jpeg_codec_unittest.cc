@@ -4,9 +4,15 @@
 
 #include <math.h>
 
+#include <algorithm>
+
 #include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 #include "ui/gfx/codec/jpeg_codec.h"
+#include "ui/gfx/rect.h"
+#include "ui/gfx/size.h"
 
 namespace {
 
@@ -164,6 +170,131 @@ TEST(JPEGCodec, EncodeDecodeRGBA) {
   ASSERT_GE(jpeg_equality_threshold, AveragePixelDelta(original, decoded));
 }
 
+// Every preset encodes an image that decodes close to the original.
+TEST(JPEGCodec, EncodePresets) {
+  int w = 64, h = 48;
+
+  std::vector<unsigned char> original;
+  MakeRGBImage(w, h, &original);
+
+  const JPEGCodec::EncodePreset kPresets[] = {
+    JPEGCodec::PRESET_FAST,
+    JPEGCodec::PRESET_DEFAULT,
+    JPEGCodec::PRESET_SMALL,
+  };
+  for (size_t i = 0; i < arraysize(kPresets); ++i) {
+    std::vector<unsigned char> encoded;
+    ASSERT_TRUE(JPEGCodec::Encode(
+        &original[0], JPEGCodec::FORMAT_RGB, w, h, w * 3,
+        JPEGCodec::EncodeOptions::ForPreset(kPresets[i]), &encoded));
+
+    std::vector<unsigned char> decoded;
+    int outw, outh;
+    ASSERT_TRUE(JPEGCodec::Decode(&encoded[0], encoded.size(),
+                                  JPEGCodec::FORMAT_RGB, &decoded,
+                                  &outw, &outh));
+    ASSERT_EQ(original.size(), decoded.size());
+    EXPECT_GE(4.0, AveragePixelDelta(original, decoded)) << i;
+  }
+}
+
+// EncodeToBuffer() writes the same data as Encode(), and fails when the
+// buffer is too small.
+TEST(JPEGCodec, EncodeToBuffer) {
+  int w = 20, h = 20;
+
+  std::vector<unsigned char> original;
+  MakeRGBImage(w, h, &original);
+  JPEGCodec::EncodeOptions options;
+
+  std::vector<unsigned char> encoded;
+  ASSERT_TRUE(JPEGCodec::Encode(&original[0], JPEGCodec::FORMAT_RGB, w, h,
+                                w * 3, options, &encoded));
+
+  std::vector<unsigned char> buffer(JPEGCodec::EncodedSizeBound(w, h));
+  size_t size = 0;
+  ASSERT_TRUE(JPEGCodec::EncodeToBuffer(&original[0], JPEGCodec::FORMAT_RGB,
+                                        w, h, w * 3, options, &buffer[0],
+                                        buffer.size(), &size));
+  ASSERT_EQ(encoded.size(), size);
+  EXPECT_TRUE(std::equal(encoded.begin(), encoded.end(), buffer.begin()));
+
+  EXPECT_FALSE(JPEGCodec::EncodeToBuffer(&original[0], JPEGCodec::FORMAT_RGB,
+                                         w, h, w * 3, options, &buffer[0],
+                                         encoded.size() / 2, &size));
+}
+
+// Scaled decoding picks the smallest scale that is at least the target size.
+TEST(JPEGCodec, DecodeScaled) {
+  int w = 64, h = 48;
+
+  std::vector<unsigned char> original;
+  MakeRGBImage(w, h, &original);
+  std::vector<unsigned char> encoded;
+  ASSERT_TRUE(JPEGCodec::Encode(&original[0], JPEGCodec::FORMAT_RGB, w, h,
+                                w * 3, jpeg_quality, &encoded));
+
+  scoped_ptr<SkBitmap> bitmap(JPEGCodec::DecodeScaled(
+      &encoded[0], encoded.size(), Size(8, 6), Rect()));
+  ASSERT_TRUE(bitmap.get());
+  EXPECT_EQ(8, bitmap->width());
+  EXPECT_EQ(6, bitmap->height());
+  EXPECT_TRUE(bitmap->isOpaque());
+
+  bitmap.reset(JPEGCodec::DecodeScaled(
+      &encoded[0], encoded.size(), Size(20, 20), Rect()));
+  ASSERT_TRUE(bitmap.get());
+  EXPECT_EQ(32, bitmap->width());
+  EXPECT_EQ(24, bitmap->height());
+
+  // An empty target size means no scaling.
+  bitmap.reset(JPEGCodec::DecodeScaled(
+      &encoded[0], encoded.size(), Size(), Rect()));
+  ASSERT_TRUE(bitmap.get());
+  EXPECT_EQ(w, bitmap->width());
+  EXPECT_EQ(h, bitmap->height());
+
+  // Corrupted data fails.
+  EXPECT_TRUE(JPEGCodec::DecodeScaled(
+      &original[0], original.size(), Size(), Rect()) == NULL);
+}
+
+// Decoding a region at full scale gives the pixels of that region of the
+// whole image.
+TEST(JPEGCodec, DecodeScaledRegion) {
+  int w = 64, h = 48;
+
+  std::vector<unsigned char> original;
+  MakeRGBImage(w, h, &original);
+  std::vector<unsigned char> encoded;
+  ASSERT_TRUE(JPEGCodec::Encode(&original[0], JPEGCodec::FORMAT_RGB, w, h,
+                                w * 3, jpeg_quality, &encoded));
+
+  scoped_ptr<SkBitmap> full(JPEGCodec::Decode(&encoded[0], encoded.size()));
+  ASSERT_TRUE(full.get());
+
+  const Rect regions[] = {
+    Rect(0, 0, w, 10), Rect(10, 5, 20, 30), Rect(50, 40, 100, 100)
+  };
+  for (size_t i = 0; i < arraysize(regions); ++i) {
+    Rect region = regions[i].Intersect(Rect(w, h));
+    scoped_ptr<SkBitmap> bitmap(JPEGCodec::DecodeScaled(
+        &encoded[0], encoded.size(), Size(), regions[i]));
+    ASSERT_TRUE(bitmap.get());
+    ASSERT_EQ(region.width(), bitmap->width());
+    ASSERT_EQ(region.height(), bitmap->height());
+
+    SkAutoLockPixels full_lock(*full);
+    SkAutoLockPixels bitmap_lock(*bitmap);
+    for (int y = 0; y < region.height(); ++y) {
+      for (int x = 0; x < region.width(); ++x) {
+        EXPECT_EQ(*full->getAddr32(region.x() + x, region.y() + y),
+                  *bitmap->getAddr32(x, y));
+      }
+    }
+  }
+}
+
 // Test that corrupted data decompression causes failures.
 TEST(JPEGCodec, DecodeCorrupted) {
   int w = 20, h = 20;
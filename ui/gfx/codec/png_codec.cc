@@ -4,9 +4,20 @@
 
 #include "ui/gfx/codec/png_codec.h"
 
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/cpu.h"
+#include "base/location.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/string_util.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/sys_info.h"
+#include "base/threading/worker_pool.h"
+#include "build/build_config.h"
 #include "ui/gfx/size.h"
 #include "ui/gfx/skia_util.h"
 #include "third_party/skia/include/core/SkBitmap.h"
@@ -27,10 +38,30 @@ extern "C" {
 #endif
 }
 
+// The SSE2 row conversion writes Skia's BGRA order.
+#if defined(ARCH_CPU_X86_FAMILY) && SK_R32_SHIFT == 16 && SK_B32_SHIFT == 0
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || _M_IX86_FP==2
+#define SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+#endif
+
 namespace gfx {
 
 namespace {
 
+#if defined(SIMD_SSE2)
+// Swaps the first and third bytes of each of the four pixels of |pixels|.
+inline __m128i SwapRedAndBlue_SSE2(__m128i pixels) {
+  const __m128i alpha_green_mask = _mm_set1_epi32(0xFF00FF00);
+  const __m128i byte_mask = _mm_set1_epi32(0x000000FF);
+  return _mm_or_si128(
+      _mm_and_si128(pixels, alpha_green_mask),
+      _mm_or_si128(_mm_and_si128(_mm_srli_epi32(pixels, 16), byte_mask),
+                   _mm_slli_epi32(_mm_and_si128(pixels, byte_mask), 16)));
+}
+#endif
+
 // Converts BGRA->RGBA and RGBA->BGRA.
 void ConvertBetweenBGRAandRGBA(const unsigned char* input, int pixel_width,
                                unsigned char* output, bool* is_opaque) {
@@ -80,6 +111,143 @@ void ConvertSkiatoRGBA(const unsigned char* skia, int pixel_width,
   gfx::ConvertSkiaToRGBA(skia, pixel_width, rgba);
 }
 
+#if defined(SIMD_SSE2)
+// SSE2 versions of the converters above, which convert four pixels at a time
+// and give the same results.
+void ConvertBetweenBGRAandRGBA_SSE2(const unsigned char* input,
+                                    int pixel_width,
+                                    unsigned char* output,
+                                    bool* is_opaque) {
+  int x = 0;
+  for (; x + 4 <= pixel_width; x += 4) {
+    __m128i pixels = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(&input[x * 4]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[x * 4]),
+                     SwapRedAndBlue_SSE2(pixels));
+  }
+  ConvertBetweenBGRAandRGBA(&input[x * 4], pixel_width - x, &output[x * 4],
+                            is_opaque);
+}
+
+// Only runs of four opaque pixels are converted with SSE2; the others need
+// unpremultiplying.
+void ConvertSkiatoRGBA_SSE2(const unsigned char* skia, int pixel_width,
+                            unsigned char* rgba, bool* is_opaque) {
+  const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+  int x = 0;
+  for (; x + 4 <= pixel_width; x += 4) {
+    __m128i pixels = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(&skia[x * 4]));
+    __m128i alpha = _mm_and_si128(pixels, alpha_mask);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alpha_mask)) == 0xFFFF) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&rgba[x * 4]),
+                       SwapRedAndBlue_SSE2(pixels));
+    } else {
+      gfx::ConvertSkiaToRGBA(&skia[x * 4], 4, &rgba[x * 4]);
+    }
+  }
+  gfx::ConvertSkiaToRGBA(&skia[x * 4], pixel_width - x, &rgba[x * 4]);
+}
+#endif  // defined(SIMD_SSE2)
+
+// The type of functions usable for converting between pixel formats.
+typedef void (*FormatConverter)(const unsigned char* in, int w,
+                                unsigned char* out, bool* is_opaque);
+
+// Returns the SSE2 version of |converter| if there is one and the CPU
+// supports it, or |converter|.
+FormatConverter GetFastestConverter(FormatConverter converter) {
+#if defined(SIMD_SSE2)
+  base::CPU cpu;
+  if (cpu.has_sse2()) {
+    if (converter == ConvertBetweenBGRAandRGBA)
+      return ConvertBetweenBGRAandRGBA_SSE2;
+    if (converter == ConvertSkiatoRGBA)
+      return ConvertSkiatoRGBA_SSE2;
+  }
+#endif
+  return converter;
+}
+
+// Returns how many worker threads to run |task_count| tasks on besides the
+// calling thread.
+int GetParallelWorkerCount(size_t task_count) {
+  if (task_count < 2)
+    return 0;
+  return static_cast<int>(std::min(
+      task_count - 1,
+      static_cast<size_t>(std::max(base::SysInfo::NumberOfProcessors() - 1,
+                                   0))));
+}
+
+// Runs the tasks of a job on the worker pool and on the calling thread. Each
+// thread taking part runs the tasks no thread has taken yet until there are
+// none left. Subclasses keep the results of each task apart, so that the
+// tasks don't need to lock anything.
+class PngParallelJob : public base::RefCountedThreadSafe<PngParallelJob> {
+ public:
+  explicit PngParallelJob(size_t task_count)
+      : task_count_(task_count),
+        next_task_(0),
+        done_count_(0),
+        all_done_(&lock_) {
+  }
+
+  // Runs the tasks on the calling thread and on up to |worker_count| worker
+  // threads, and returns once they have all run. The worker tasks that
+  // start after that find nothing left to do. If a task can't be posted,
+  // the calling thread runs its share.
+  void RunAndWait(int worker_count) {
+    for (int i = 0; i < worker_count; ++i) {
+      if (!base::WorkerPool::PostTask(
+              FROM_HERE, base::Bind(&PngParallelJob::RunTasks, this), false))
+        break;
+    }
+    RunTasks();
+
+    base::AutoLock lock(lock_);
+    while (done_count_ < task_count_)
+      all_done_.Wait();
+  }
+
+ protected:
+  friend class base::RefCountedThreadSafe<PngParallelJob>;
+
+  virtual ~PngParallelJob() {}
+
+  // Runs the task |index|. Called on any of the threads taking part.
+  virtual void RunTask(size_t index) = 0;
+
+ private:
+  void RunTasks() {
+    for (;;) {
+      size_t index;
+      {
+        base::AutoLock lock(lock_);
+        if (next_task_ == task_count_)
+          return;
+        index = next_task_++;
+      }
+
+      RunTask(index);
+
+      base::AutoLock lock(lock_);
+      if (++done_count_ == task_count_)
+        all_done_.Broadcast();
+    }
+  }
+
+  const size_t task_count_;
+
+  // Guards the members below.
+  base::Lock lock_;
+  size_t next_task_;
+  size_t done_count_;
+  base::ConditionVariable all_done_;
+
+  DISALLOW_COPY_AND_ASSIGN(PngParallelJob);
+};
+
 }  // namespace
 
 // Decoder --------------------------------------------------------------------
@@ -105,7 +273,9 @@ class PngDecoderState {
         output(o),
         width(0),
         height(0),
-        done(false) {
+        done(false),
+        clear_bitmap(false),
+        use_sse2(base::CPU().has_sse2()) {
   }
 
   // Output is an SkBitmap.
@@ -117,7 +287,9 @@ class PngDecoderState {
         output(NULL),
         width(0),
         height(0),
-        done(false) {
+        done(false),
+        clear_bitmap(false),
+        use_sse2(base::CPU().has_sse2()) {
   }
 
   PNGCodec::ColorFormat output_format;
@@ -141,10 +313,66 @@ class PngDecoderState {
   // Set to true when we've found the end of the data.
   bool done;
 
+  // Whether to make the bitmap transparent when allocating it, so that the
+  // rows not decoded yet are defined.
+  bool clear_bitmap;
+
+  // Whether to convert rows to Skia format with SSE2.
+  bool use_sse2;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(PngDecoderState);
 };
 
+#if defined(SIMD_SSE2)
+// Returns |c| * |a| / 255 for each 16-bit lane, rounded like
+// SkMulDiv255Round().
+inline __m128i MulDiv255Round_SSE2(__m128i c, __m128i a) {
+  __m128i prod = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(prod, _mm_srli_epi16(prod, 8)), 8);
+}
+
+// Converts the RGBA pixels of |data| to premultiplied Skia pixels in place,
+// four at a time, giving the same results as SkPreMultiplyARGB(). Returns the
+// number of pixels converted; the last |pixel_width| % 4 are left to the
+// caller. Sets |*is_opaque| to false if any converted pixel isn't opaque.
+int ConvertRGBARowToSkia_SSE2(unsigned char* data,
+                              int pixel_width,
+                              bool* is_opaque) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+
+  int x = 0;
+  for (; x + 4 <= pixel_width; x += 4) {
+    __m128i* p = reinterpret_cast<__m128i*>(data + x * 4);
+    __m128i pixels = _mm_loadu_si128(p);
+    __m128i alpha = _mm_and_si128(pixels, alpha_mask);
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alpha_mask)) != 0xFFFF) {
+      *is_opaque = false;
+
+      // Multiply the color channels of each pixel by its alpha, with 16 bits
+      // per channel, then put the alpha back.
+      __m128i low = _mm_unpacklo_epi8(pixels, zero);
+      __m128i high = _mm_unpackhi_epi8(pixels, zero);
+      __m128i low_alpha = _mm_shufflehi_epi16(
+          _mm_shufflelo_epi16(low, _MM_SHUFFLE(3, 3, 3, 3)),
+          _MM_SHUFFLE(3, 3, 3, 3));
+      __m128i high_alpha = _mm_shufflehi_epi16(
+          _mm_shufflelo_epi16(high, _MM_SHUFFLE(3, 3, 3, 3)),
+          _MM_SHUFFLE(3, 3, 3, 3));
+      low = MulDiv255Round_SSE2(low, low_alpha);
+      high = MulDiv255Round_SSE2(high, high_alpha);
+      pixels = _mm_or_si128(
+          _mm_andnot_si128(alpha_mask, _mm_packus_epi16(low, high)), alpha);
+    }
+
+    _mm_storeu_si128(p, SwapRedAndBlue_SSE2(pixels));
+  }
+  return x;
+}
+#endif  // defined(SIMD_SSE2)
+
 // User transform (passed to libpng) which converts a row decoded by libpng to
 // Skia format. Expects the row to have 4 channels, otherwise there won't be
 // enough room in |data|.
@@ -158,8 +386,16 @@ void ConvertRGBARowToSkia(png_structp png_ptr,
       static_cast<PngDecoderState*>(png_get_user_transform_ptr(png_ptr));
   DCHECK(state) << "LibPNG user transform pointer is NULL";
 
+  unsigned char* p = data;
+#if defined(SIMD_SSE2)
+  if (state->use_sse2) {
+    p += channels * ConvertRGBARowToSkia_SSE2(
+        data, static_cast<int>(row_info->width), &state->is_opaque);
+  }
+#endif
+
   unsigned char* const end = data + row_info->rowbytes;
-  for (unsigned char* p = data; p < end; p += channels) {
+  for (; p < end; p += channels) {
     uint32_t* sk_pixel = reinterpret_cast<uint32_t*>(p);
     const unsigned char alpha = p[channels - 1];
     if (alpha != 255) {
@@ -292,6 +528,8 @@ void DecodeInfoCallback(png_struct* png_ptr, png_info* info_ptr) {
     state->bitmap->setConfig(SkBitmap::kARGB_8888_Config,
                              state->width, state->height);
     state->bitmap->allocPixels();
+    if (state->clear_bitmap)
+      state->bitmap->eraseARGB(0, 0, 0, 0);
   } else if (state->output) {
     state->output->resize(
         state->width * state->output_channels * state->height);
@@ -406,8 +644,113 @@ void LogLibPNGEncodeWarning(png_structp png_ptr, png_const_charp warning_msg) {
   DLOG(ERROR) << "libpng encode warning: " << warning_msg;
 }
 
+// Decodes the inputs of a PNGCodec::DecodeBatch() call, one per task.
+class PngBatchJob : public PngParallelJob {
+ public:
+  explicit PngBatchJob(const std::vector<base::StringPiece>& inputs)
+      : PngParallelJob(inputs.size()),
+        inputs_(inputs),
+        bitmaps_(inputs.size()) {
+  }
+
+  std::vector<SkBitmap>* bitmaps() { return &bitmaps_; }
+
+ protected:
+  virtual ~PngBatchJob() {}
+
+  virtual void RunTask(size_t index) OVERRIDE {
+    const unsigned char* data =
+        reinterpret_cast<const unsigned char*>(inputs_[index].data());
+    if (!PNGCodec::Decode(data, inputs_[index].size(), &bitmaps_[index]))
+      bitmaps_[index].reset();
+  }
+
+ private:
+  const std::vector<base::StringPiece> inputs_;
+  std::vector<SkBitmap> bitmaps_;
+
+  DISALLOW_COPY_AND_ASSIGN(PngBatchJob);
+};
+
 }  // namespace
 
+// IncrementalDecoder ---------------------------------------------------------
+
+class PNGCodec::IncrementalDecoder::State {
+ public:
+  State()
+      : png_ptr(NULL),
+        info_ptr(NULL),
+        decoder_state(&bitmap),
+        failed(false) {
+  }
+  ~State() {
+    if (png_ptr)
+      png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+  }
+
+  png_struct* png_ptr;
+  png_info* info_ptr;
+  SkBitmap bitmap;
+  PngDecoderState decoder_state;
+
+  // Set once libpng reports an error; the structs can't be used after that.
+  bool failed;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(State);
+};
+
+PNGCodec::IncrementalDecoder::IncrementalDecoder() : state_(new State) {
+  state_->png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL,
+                                           NULL);
+  if (state_->png_ptr)
+    state_->info_ptr = png_create_info_struct(state_->png_ptr);
+  if (!state_->info_ptr) {
+    state_->failed = true;
+    return;
+  }
+
+  state_->decoder_state.clear_bitmap = true;
+  png_set_error_fn(state_->png_ptr, NULL, LogLibPNGDecodeError,
+                   LogLibPNGDecodeWarning);
+  png_set_progressive_read_fn(state_->png_ptr, &state_->decoder_state,
+                              &DecodeInfoCallback, &DecodeRowCallback,
+                              &DecodeEndCallback);
+}
+
+PNGCodec::IncrementalDecoder::~IncrementalDecoder() {
+}
+
+bool PNGCodec::IncrementalDecoder::AppendData(const unsigned char* input,
+                                              size_t input_size) {
+  if (state_->failed)
+    return false;
+
+  if (setjmp(png_jmpbuf(state_->png_ptr))) {
+    // libpng jumps here from the error function when the data is invalid.
+    state_->failed = true;
+    return false;
+  }
+
+  png_process_data(state_->png_ptr,
+                   state_->info_ptr,
+                   const_cast<unsigned char*>(input),
+                   input_size);
+
+  if (state_->decoder_state.done)
+    state_->bitmap.setIsOpaque(state_->decoder_state.is_opaque);
+  return true;
+}
+
+bool PNGCodec::IncrementalDecoder::IsComplete() const {
+  return !state_->failed && state_->decoder_state.done;
+}
+
+const SkBitmap& PNGCodec::IncrementalDecoder::bitmap() const {
+  return state_->bitmap;
+}
+
 // static
 bool PNGCodec::Decode(const unsigned char* input, size_t input_size,
                       ColorFormat format, std::vector<unsigned char>* output,
@@ -483,6 +826,15 @@ bool PNGCodec::Decode(const unsigned char* input, size_t input_size,
   return true;
 }
 
+// static
+void PNGCodec::DecodeBatch(const std::vector<base::StringPiece>& inputs,
+                           std::vector<SkBitmap>* bitmaps) {
+  DCHECK(bitmaps);
+  scoped_refptr<PngBatchJob> job(new PngBatchJob(inputs));
+  job->RunAndWait(GetParallelWorkerCount(inputs.size()));
+  bitmaps->swap(*job->bitmaps());
+}
+
 // static
 SkBitmap* PNGCodec::CreateSkBitmapFromBGRAFormat(
     std::vector<unsigned char>& bgra, int width, int height) {
@@ -600,10 +952,6 @@ class CommentWriter {
 };
 #endif  // PNG_TEXT_SUPPORTED
 
-// The type of functions usable for converting between pixel formats.
-typedef void (*FormatConverter)(const unsigned char* in, int w,
-                                unsigned char* out, bool* is_opaque);
-
 // libpng uses a wacky setjmp-based API, which makes the compiler nervous.
 // We constrain all of the calls we make to libpng where the setjmp() is in
 // place to this function.
@@ -661,6 +1009,194 @@ bool DoLibpngWrite(png_struct* png_ptr, png_info* info_ptr,
   return true;
 }
 
+// Images with fewer pixels than this are compressed in one strip by
+// FastEncodeBGRASkBitmap(), since splitting them costs more than it saves.
+const int kMinParallelEncodePixels = 512 * 512;
+
+// The fewest rows FastEncodeBGRASkBitmap() compresses in one strip.
+const int kMinStripRows = 64;
+
+// The size of the buffer deflate() writes to.
+const size_t kDeflateBufferSize = 16 * 1024;
+
+// The chunk names libpng would export if it weren't built without global
+// arrays.
+const png_byte kPngIDAT[5] = { 'I', 'D', 'A', 'T', '\0' };
+const png_byte kPngIEND[5] = { 'I', 'E', 'N', 'D', '\0' };
+
+// Filters and compresses the rows of an image in strips, one per task. Each
+// strip is a raw deflate stream of its own that ends on a byte boundary, so
+// the strips can be concatenated into the zlib stream of a single IDAT chunk.
+class PngStripEncodeJob : public PngParallelJob {
+ public:
+  struct Strip {
+    Strip() : adler(0), raw_size(0), ok(false) {}
+
+    std::vector<unsigned char> data;
+    // The Adler-32 checksum and size of the filtered rows, before
+    // compression.
+    uLong adler;
+    uLong raw_size;
+    bool ok;
+  };
+
+  PngStripEncodeJob(const unsigned char* input,
+                    int width,
+                    int height,
+                    int row_byte_width,
+                    int output_color_components,
+                    FormatConverter converter,
+                    size_t strip_count)
+      : PngParallelJob(strip_count),
+        input_(input),
+        width_(width),
+        height_(height),
+        row_byte_width_(row_byte_width),
+        output_color_components_(output_color_components),
+        converter_(converter),
+        strips_(strip_count) {
+  }
+
+  const std::vector<Strip>& strips() const { return strips_; }
+
+ protected:
+  virtual ~PngStripEncodeJob() {}
+
+  virtual void RunTask(size_t index) OVERRIDE {
+    Strip* strip = &strips_[index];
+    const int first_row = static_cast<int>(height_ * index / strips_.size());
+    const int end_row =
+        static_cast<int>(height_ * (index + 1) / strips_.size());
+    const bool last_strip = index + 1 == strips_.size();
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8,
+                     Z_RLE) != Z_OK) {
+      return;
+    }
+
+    const int bpp = output_color_components_;
+    const int row_size = width_ * bpp;
+    std::vector<unsigned char> converted_row(row_size);
+    std::vector<unsigned char> filtered_row(row_size + 1);
+    unsigned char buffer[kDeflateBufferSize];
+    uLong adler = adler32(0L, Z_NULL, 0);
+    bool ok = true;
+    for (int y = first_row; ok && y < end_row; ++y) {
+      const unsigned char* row = &input_[y * row_byte_width_];
+      if (converter_) {
+        converter_(row, width_, &converted_row[0], NULL);
+        row = &converted_row[0];
+      }
+
+      // The Sub filter stores each byte as its difference from the same
+      // byte of the pixel to the left, which is zero over flat colors.
+      filtered_row[0] = PNG_FILTER_VALUE_SUB;
+      for (int i = 0; i < bpp; ++i)
+        filtered_row[i + 1] = row[i];
+      for (int i = bpp; i < row_size; ++i)
+        filtered_row[i + 1] = row[i] - row[i - bpp];
+      adler = adler32(adler, &filtered_row[0], filtered_row.size());
+
+      int flush = Z_NO_FLUSH;
+      if (y == end_row - 1)
+        flush = last_strip ? Z_FINISH : Z_SYNC_FLUSH;
+      stream.next_in = &filtered_row[0];
+      stream.avail_in = static_cast<uInt>(filtered_row.size());
+      do {
+        stream.next_out = buffer;
+        stream.avail_out = sizeof(buffer);
+        if (deflate(&stream, flush) == Z_STREAM_ERROR) {
+          ok = false;
+          break;
+        }
+        strip->data.insert(strip->data.end(), buffer,
+                           buffer + sizeof(buffer) - stream.avail_out);
+      } while (stream.avail_out == 0);
+    }
+    deflateEnd(&stream);
+
+    strip->adler = adler;
+    strip->raw_size = static_cast<uLong>(end_row - first_row) * (row_size + 1);
+    strip->ok = ok;
+  }
+
+ private:
+  const unsigned char* input_;
+  const int width_;
+  const int height_;
+  const int row_byte_width_;
+  const int output_color_components_;
+  const FormatConverter converter_;
+
+  std::vector<Strip> strips_;
+
+  DISALLOW_COPY_AND_ASSIGN(PngStripEncodeJob);
+};
+
+// Writes a PNG whose image data is the compressed |strips|, the way
+// DoLibpngWrite() does for rows. |adler| is the checksum of all the
+// filtered rows.
+bool DoLibpngStripWrite(png_struct* png_ptr, png_info* info_ptr,
+                        PngEncoderState* state,
+                        int width, int height, int png_output_color_type,
+                        const std::vector<PngStripEncodeJob::Strip>& strips,
+                        uLong adler,
+                        const std::vector<PNGCodec::Comment>& comments) {
+  if (setjmp(png_jmpbuf(png_ptr)))
+    return false;
+
+  png_set_write_fn(png_ptr, state, EncoderWriteCallback, FakeFlushCallback);
+  png_set_error_fn(png_ptr, NULL, LogLibPNGEncodeError, LogLibPNGEncodeWarning);
+
+  png_set_IHDR(png_ptr, info_ptr, width, height, 8, png_output_color_type,
+               PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
+               PNG_FILTER_TYPE_DEFAULT);
+
+#ifdef PNG_TEXT_SUPPORTED
+  CommentWriter comment_writer(comments);
+  if (comment_writer.HasComments()) {
+    png_set_text(png_ptr, info_ptr, comment_writer.get_png_text(),
+                 comment_writer.size());
+  }
+#endif
+
+  png_write_info(png_ptr, info_ptr);
+
+  // The zlib stream is a header for a deflate stream with a 32K window at
+  // the fastest level, the strips, and the checksum, most significant byte
+  // first.
+  static const unsigned char kZlibHeader[] = { 0x78, 0x01 };
+  unsigned char checksum[4] = {
+    static_cast<unsigned char>(adler >> 24),
+    static_cast<unsigned char>(adler >> 16),
+    static_cast<unsigned char>(adler >> 8),
+    static_cast<unsigned char>(adler)
+  };
+  png_uint_32 idat_size = sizeof(kZlibHeader) + sizeof(checksum);
+  for (size_t i = 0; i < strips.size(); ++i)
+    idat_size += static_cast<png_uint_32>(strips[i].data.size());
+
+  png_write_chunk_start(png_ptr, const_cast<png_bytep>(kPngIDAT), idat_size);
+  png_write_chunk_data(png_ptr, const_cast<png_bytep>(kZlibHeader),
+                       sizeof(kZlibHeader));
+  for (size_t i = 0; i < strips.size(); ++i) {
+    if (!strips[i].data.empty()) {
+      png_write_chunk_data(png_ptr,
+                           const_cast<png_bytep>(&strips[i].data[0]),
+                           strips[i].data.size());
+    }
+  }
+  png_write_chunk_data(png_ptr, checksum, sizeof(checksum));
+  png_write_chunk_end(png_ptr);
+
+  // png_write_end() refuses to run when libpng hasn't written the IDAT
+  // chunks itself, so the IEND chunk is written directly too.
+  png_write_chunk(png_ptr, const_cast<png_bytep>(kPngIEND), NULL, 0);
+  return true;
+}
+
 }  // namespace
 
 // static
@@ -743,6 +1279,7 @@ bool PNGCodec::EncodeWithCompressionLevel(const unsigned char* input,
 
   // Row stride should be at least as long as the length of the data.
   DCHECK(input_color_components * size.width() <= row_byte_width);
+  converter = GetFastestConverter(converter);
 
   png_struct* png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING,
                                                 NULL, NULL, NULL);
@@ -778,6 +1315,68 @@ bool PNGCodec::EncodeBGRASkBitmap(const SkBitmap& input,
                 std::vector<Comment>(), output);
 }
 
+// static
+bool PNGCodec::FastEncodeBGRASkBitmap(const SkBitmap& input,
+                                      bool discard_transparency,
+                                      std::vector<unsigned char>* output) {
+  static const int bbp = 4;
+
+  SkAutoLockPixels lock_input(input);
+  DCHECK(input.empty() || input.bytesPerPixel() == bbp);
+  if (input.empty())
+    return EncodeBGRASkBitmap(input, discard_transparency, output);
+
+  int output_color_components;
+  int png_output_color_type;
+  FormatConverter converter;
+  if (discard_transparency) {
+    output_color_components = 3;
+    png_output_color_type = PNG_COLOR_TYPE_RGB;
+    converter = ConvertSkiatoRGB;
+  } else {
+    output_color_components = 4;
+    png_output_color_type = PNG_COLOR_TYPE_RGB_ALPHA;
+    converter = GetFastestConverter(ConvertSkiatoRGBA);
+  }
+
+  const int width = input.width();
+  const int height = input.height();
+  size_t strip_count = 1;
+  if (width * height >= kMinParallelEncodePixels) {
+    strip_count = std::max(1, std::min(base::SysInfo::NumberOfProcessors(),
+                                       height / kMinStripRows));
+  }
+
+  scoped_refptr<PngStripEncodeJob> job(new PngStripEncodeJob(
+      reinterpret_cast<const unsigned char*>(input.getAddr32(0, 0)),
+      width, height, static_cast<int>(input.rowBytes()),
+      output_color_components, converter, strip_count));
+  job->RunAndWait(GetParallelWorkerCount(strip_count));
+
+  const std::vector<PngStripEncodeJob::Strip>& strips = job->strips();
+  uLong adler = adler32(0L, Z_NULL, 0);
+  for (size_t i = 0; i < strips.size(); ++i) {
+    if (!strips[i].ok)
+      return false;
+    adler = adler32_combine(adler, strips[i].adler, strips[i].raw_size);
+  }
+
+  png_struct* png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING,
+                                                NULL, NULL, NULL);
+  if (!png_ptr)
+    return false;
+  PngWriteStructDestroyer destroyer(&png_ptr);
+  png_info* info_ptr = png_create_info_struct(png_ptr);
+  if (!info_ptr)
+    return false;
+  destroyer.SetInfoStruct(&info_ptr);
+
+  PngEncoderState state(output);
+  return DoLibpngStripWrite(png_ptr, info_ptr, &state, width, height,
+                            png_output_color_type, strips, adler,
+                            std::vector<Comment>());
+}
+
 PNGCodec::Comment::Comment(const std::string& k, const std::string& t)
     : key(k), text(t) {
 }
@@ -10,6 +10,8 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/string_piece.h"
 #include "ui/base/ui_export.h"
 
 class SkBitmap;
@@ -52,6 +54,34 @@ class UI_EXPORT PNGCodec {
     std::string text;
   };
 
+  // Decodes PNG data that arrives in pieces, for example from a stream,
+  // straight into an SkBitmap. Rows are premultiplied and written to the
+  // bitmap as libpng decodes them, so a partly received image can be drawn.
+  class UI_EXPORT IncrementalDecoder {
+   public:
+    IncrementalDecoder();
+    ~IncrementalDecoder();
+
+    // Decodes the next |input_size| bytes of the PNG. Returns false if the
+    // data isn't a valid PNG, after which the decoder must not be used
+    // again.
+    bool AppendData(const unsigned char* input, size_t input_size);
+
+    // Returns true once the whole image has been decoded.
+    bool IsComplete() const;
+
+    // The bitmap the image is decoded into. It is empty until the header
+    // has been decoded, and the parts of it not decoded yet are transparent.
+    const SkBitmap& bitmap() const;
+
+   private:
+    class State;
+
+    scoped_ptr<State> state_;
+
+    DISALLOW_COPY_AND_ASSIGN(IncrementalDecoder);
+  };
+
   // Calls PNGCodec::EncodeWithCompressionLevel with the default compression
   // level.
   static bool Encode(const unsigned char* input,
@@ -98,6 +128,16 @@ class UI_EXPORT PNGCodec {
                                  bool discard_transparency,
                                  std::vector<unsigned char>* output);
 
+  // Same as EncodeBGRASkBitmap(), but tuned for speed rather than size, for
+  // screenshots and thumbnails. Rows use the Sub filter and zlib's Z_RLE
+  // strategy, which suit UI content with its runs of flat color, and large
+  // images are compressed in strips on the worker pool, blocking the calling
+  // thread until they are done. The output is a standard PNG, usually
+  // somewhat larger than the one EncodeBGRASkBitmap() writes.
+  static bool FastEncodeBGRASkBitmap(const SkBitmap& input,
+                                     bool discard_transparency,
+                                     std::vector<unsigned char>* output);
+
   // Decodes the PNG data contained in input of length input_size. The
   // decoded data will be placed in *output with the dimensions in *w and *h
   // on success (returns true). This data will be written in the 'format'
@@ -121,6 +161,13 @@ class UI_EXPORT PNGCodec {
   static bool Decode(const unsigned char* input, size_t input_size,
                      SkBitmap* bitmap);
 
+  // Decodes each of |inputs| into the SkBitmap with the same index in
+  // |bitmaps|, spreading the work over the worker pool and the calling
+  // thread. Returns once all of them are decoded. The bitmaps of the inputs
+  // that can't be decoded are empty.
+  static void DecodeBatch(const std::vector<base::StringPiece>& inputs,
+                          std::vector<SkBitmap>* bitmaps);
+
   // Create a SkBitmap from a decoded BGRA DIB. The caller owns the returned
   // SkBitmap.
   static SkBitmap* CreateSkBitmapFromBGRAFormat(
@@ -12,6 +12,7 @@
 #include <cmath>
 
 #include "base/logging.h"
+#include "base/string_piece.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkColorPriv.h"
@@ -901,6 +902,113 @@ TEST(PNGCodec, DecodeInterlacedRGBAtoSkBitmap) {
   }
 }
 
+// Decoding into an SkBitmap premultiplies the pixels and notices that the
+// image isn't opaque. The width isn't a multiple of four, so that the pixels
+// at the end of the rows are converted one at a time.
+TEST(PNGCodec, DecodeRGBAtoSkBitmapPremultiplies) {
+  const int w = 21, h = 5;
+
+  std::vector<unsigned char> original;
+  MakeRGBAImage(w, h, true, &original);
+
+  std::vector<unsigned char> encoded;
+  ASSERT_TRUE(EncodeImage(original, w, h, COLOR_TYPE_RGBA, &encoded));
+
+  SkBitmap decoded_bitmap;
+  ASSERT_TRUE(PNGCodec::Decode(&encoded.front(), encoded.size(),
+                               &decoded_bitmap));
+  EXPECT_FALSE(decoded_bitmap.isOpaque());
+
+  SkAutoLockPixels lock(decoded_bitmap);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      const unsigned char* original_pixel = &original[(y * w + x) * 4];
+      EXPECT_EQ(SkPreMultiplyARGB(original_pixel[3], original_pixel[0],
+                                  original_pixel[1], original_pixel[2]),
+                decoded_bitmap.getAddr32(0, y)[x]);
+    }
+  }
+}
+
+// Decoding the data in pieces gives the same bitmap as decoding it at once.
+TEST(PNGCodec, IncrementalDecode) {
+  const int w = 20, h = 20;
+
+  std::vector<unsigned char> original;
+  MakeRGBAImage(w, h, true, &original);
+
+  std::vector<unsigned char> encoded;
+  ASSERT_TRUE(EncodeImage(original, w, h, COLOR_TYPE_RGBA, &encoded,
+                          PNG_INTERLACE_ADAM7));
+
+  SkBitmap expected;
+  ASSERT_TRUE(PNGCodec::Decode(&encoded.front(), encoded.size(), &expected));
+
+  PNGCodec::IncrementalDecoder decoder;
+  const size_t kChunkSize = 7;
+  for (size_t i = 0; i < encoded.size(); i += kChunkSize) {
+    EXPECT_FALSE(decoder.IsComplete());
+    ASSERT_TRUE(decoder.AppendData(&encoded[i],
+                                   std::min(kChunkSize, encoded.size() - i)));
+  }
+  ASSERT_TRUE(decoder.IsComplete());
+
+  const SkBitmap& decoded = decoder.bitmap();
+  ASSERT_EQ(w, decoded.width());
+  ASSERT_EQ(h, decoded.height());
+  EXPECT_EQ(expected.isOpaque(), decoded.isOpaque());
+  SkAutoLockPixels expected_lock(expected);
+  SkAutoLockPixels decoded_lock(decoded);
+  EXPECT_EQ(0, memcmp(expected.getPixels(), decoded.getPixels(),
+                      expected.getSize()));
+}
+
+TEST(PNGCodec, IncrementalDecodeCorrupted) {
+  const int w = 20, h = 20;
+
+  std::vector<unsigned char> original;
+  MakeRGBImage(w, h, &original);
+
+  // Raw pixels aren't a PNG.
+  PNGCodec::IncrementalDecoder decoder;
+  EXPECT_FALSE(decoder.AppendData(&original[0], original.size()));
+  EXPECT_FALSE(decoder.IsComplete());
+  EXPECT_FALSE(decoder.AppendData(&original[0], original.size()));
+}
+
+TEST(PNGCodec, DecodeBatch) {
+  const int kCount = 10;
+
+  std::vector<std::vector<unsigned char> > encoded(kCount);
+  std::vector<base::StringPiece> inputs;
+  for (int i = 0; i < kCount; i++) {
+    std::vector<unsigned char> original;
+    MakeRGBAImage(i + 1, i + 2, true, &original);
+    ASSERT_TRUE(EncodeImage(original, i + 1, i + 2, COLOR_TYPE_RGBA,
+                            &encoded[i]));
+    inputs.push_back(base::StringPiece(
+        reinterpret_cast<const char*>(&encoded[i][0]), encoded[i].size()));
+  }
+  // An input that isn't a PNG.
+  inputs.push_back(base::StringPiece("not a png"));
+
+  std::vector<SkBitmap> bitmaps;
+  PNGCodec::DecodeBatch(inputs, &bitmaps);
+  ASSERT_EQ(inputs.size(), bitmaps.size());
+  for (int i = 0; i < kCount; i++) {
+    SkBitmap expected;
+    ASSERT_TRUE(PNGCodec::Decode(&encoded[i][0], encoded[i].size(),
+                                 &expected));
+    ASSERT_EQ(expected.width(), bitmaps[i].width());
+    ASSERT_EQ(expected.height(), bitmaps[i].height());
+    SkAutoLockPixels expected_lock(expected);
+    SkAutoLockPixels bitmap_lock(bitmaps[i]);
+    EXPECT_EQ(0, memcmp(expected.getPixels(), bitmaps[i].getPixels(),
+                        expected.getSize()));
+  }
+  EXPECT_TRUE(bitmaps[kCount].isNull());
+}
+
 // Test that corrupted data decompression causes failures.
 TEST(PNGCodec, DecodeCorrupted) {
   int w = 20, h = 20;
@@ -1047,6 +1155,38 @@ TEST(PNGCodec, EncodeBGRASkBitmapDiscardTransparency) {
   }
 }
 
+// The fast encoder writes a PNG that decodes to the same pixels as the one
+// the default encoder writes, whether or not the image is split in strips.
+TEST(PNGCodec, FastEncodeBGRASkBitmap) {
+  const int sizes[][2] = { { 20, 17 }, { 601, 600 } };
+  for (size_t i = 0; i < arraysize(sizes); ++i) {
+    SkBitmap original_bitmap;
+    MakeTestSkBitmap(sizes[i][0], sizes[i][1], &original_bitmap);
+
+    for (int discard_transparency = 0; discard_transparency < 2;
+         ++discard_transparency) {
+      std::vector<unsigned char> encoded;
+      ASSERT_TRUE(PNGCodec::EncodeBGRASkBitmap(
+          original_bitmap, discard_transparency != 0, &encoded));
+      std::vector<unsigned char> fast_encoded;
+      ASSERT_TRUE(PNGCodec::FastEncodeBGRASkBitmap(
+          original_bitmap, discard_transparency != 0, &fast_encoded));
+
+      SkBitmap expected;
+      ASSERT_TRUE(PNGCodec::Decode(&encoded[0], encoded.size(), &expected));
+      SkBitmap decoded;
+      ASSERT_TRUE(PNGCodec::Decode(&fast_encoded[0], fast_encoded.size(),
+                                   &decoded));
+      ASSERT_EQ(expected.width(), decoded.width());
+      ASSERT_EQ(expected.height(), decoded.height());
+      SkAutoLockPixels expected_lock(expected);
+      SkAutoLockPixels decoded_lock(decoded);
+      EXPECT_EQ(0, memcmp(expected.getPixels(), decoded.getPixels(),
+                          expected.getSize()));
+    }
+  }
+}
+
 TEST(PNGCodec, EncodeWithComment) {
   const int w = 10, h = 10;
 
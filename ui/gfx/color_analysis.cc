@@ -5,10 +5,30 @@
 #include "ui/gfx/color_analysis.h"
 
 #include <algorithm>
+#include <limits>
+#include <string>
 #include <vector>
 
+#include "base/bind.h"
+#include "base/cpu.h"
+#include "base/lazy_instance.h"
+#include "base/location.h"
+#include "base/md5.h"
+#include "base/memory/sharded_mru_cache.h"
+#include "base/sys_info.h"
+#include "base/threading/sequenced_worker_pool.h"
+#include "build/build_config.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkUnPreMultiply.h"
 #include "ui/gfx/codec/png_codec.h"
 
+#if defined(ARCH_CPU_X86_FAMILY)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || _M_IX86_FP==2
+#define SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+#endif
+
 namespace {
 
 // RGBA KMean Constants
@@ -17,6 +37,15 @@ const int kNumberOfIterations = 50;
 const uint32_t kMaxBrightness = 600;
 const uint32_t kMinDarkness = 100;
 
+// Bitmaps with more pixels than this are sampled on a grid.
+const int kMaxSampledPixels = 64 * 64;
+
+// The most colors of bitmaps remembered.
+const size_t kMaxCachedColors = 4096;
+
+// The colors are computed and remembered on several workers at once.
+const size_t kColorCacheShardCount = 4;
+
 // Background Color Modification Constants
 const SkColor kDefaultBgColor = SK_ColorWHITE;
 
@@ -121,6 +150,331 @@ class KMeanCluster {
   uint32_t weight;
 };
 
+// Adds each of the |pixel_count| BGRA pixels of |pixels| to the cluster it is
+// closest to in RGB space, or to the first of them if several are as close.
+void AddPixelsToClusters(const uint8_t* pixels,
+                         int pixel_count,
+                         std::vector<KMeanCluster>* clusters) {
+  for (int i = 0; i < pixel_count; ++i) {
+    uint8_t b = pixels[i * 4];
+    uint8_t g = pixels[i * 4 + 1];
+    uint8_t r = pixels[i * 4 + 2];
+
+    uint32_t distance_sqr_to_closest_cluster = UINT_MAX;
+    std::vector<KMeanCluster>::iterator closest_cluster = clusters->begin();
+
+    // Figure out which cluster this color is closest to in RGB space.
+    for (std::vector<KMeanCluster>::iterator cluster = clusters->begin();
+        cluster != clusters->end(); ++cluster) {
+      uint32_t distance_sqr = cluster->GetDistanceSqr(r, g, b);
+
+      if (distance_sqr < distance_sqr_to_closest_cluster) {
+        distance_sqr_to_closest_cluster = distance_sqr;
+        closest_cluster = cluster;
+      }
+    }
+
+    closest_cluster->AddPoint(r, g, b);
+  }
+}
+
+#if defined(SIMD_SSE2)
+// Same as AddPixelsToClusters(), finding the closest clusters of four pixels
+// at a time.
+void AddPixelsToClusters_SSE2(const uint8_t* pixels,
+                              int pixel_count,
+                              std::vector<KMeanCluster>* clusters) {
+  // The centroids, as the 16 bit B, G, R and 0 of two pixels.
+  int cluster_count = static_cast<int>(clusters->size());
+  __m128i centroids[kNumberOfClusters];
+  for (int k = 0; k < cluster_count; ++k) {
+    uint8_t r, g, b;
+    (*clusters)[k].GetCentroid(&r, &g, &b);
+    centroids[k] = _mm_setr_epi16(b, g, r, 0, b, g, r, 0);
+  }
+
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+  int i = 0;
+  for (; i + 4 <= pixel_count; i += 4) {
+    __m128i bgra = _mm_and_si128(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i * 4)),
+        rgb_mask);
+    __m128i pixels01 = _mm_unpacklo_epi8(bgra, zero);
+    __m128i pixels23 = _mm_unpackhi_epi8(bgra, zero);
+
+    // The distances can't be larger than 3 * 255^2, so this is larger than
+    // any, and the first cluster is always picked over it.
+    __m128i best_distance = _mm_set1_epi32(std::numeric_limits<int>::max());
+    __m128i best_cluster = zero;
+    for (int k = 0; k < cluster_count; ++k) {
+      __m128i diff01 = _mm_sub_epi16(pixels01, centroids[k]);
+      __m128i diff23 = _mm_sub_epi16(pixels23, centroids[k]);
+      // b^2 + g^2 and r^2 + 0 for each pixel.
+      __m128 squares01 = _mm_castsi128_ps(_mm_madd_epi16(diff01, diff01));
+      __m128 squares23 = _mm_castsi128_ps(_mm_madd_epi16(diff23, diff23));
+      __m128i distance = _mm_add_epi32(
+          _mm_castps_si128(_mm_shuffle_ps(squares01, squares23,
+                                          _MM_SHUFFLE(2, 0, 2, 0))),
+          _mm_castps_si128(_mm_shuffle_ps(squares01, squares23,
+                                          _MM_SHUFFLE(3, 1, 3, 1))));
+
+      // Only strictly closer clusters replace the best, as above.
+      __m128i closer = _mm_cmplt_epi32(distance, best_distance);
+      best_distance = _mm_or_si128(_mm_and_si128(closer, distance),
+                                   _mm_andnot_si128(closer, best_distance));
+      best_cluster = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(k)),
+                                  _mm_andnot_si128(closer, best_cluster));
+    }
+
+    int closest[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(closest), best_cluster);
+    for (int j = 0; j < 4; ++j) {
+      const uint8_t* pixel = pixels + (i + j) * 4;
+      (*clusters)[closest[j]].AddPoint(pixel[2], pixel[1], pixel[0]);
+    }
+  }
+
+  AddPixelsToClusters(pixels + i * 4, pixel_count - i, clusters);
+}
+#endif
+
+// Implements CalculateKMeanColorOfPNG() for |img_width| * |img_height|
+// unpremultiplied BGRA pixels.
+SkColor CalculateKMeanColorOfPixels(const uint8_t* decoded_data,
+                                    int img_width,
+                                    int img_height,
+                                    uint32_t darkness_limit,
+                                    uint32_t brightness_limit,
+                                    color_utils::KMeanImageSampler& sampler) {
+  SkColor color = kDefaultBgColor;
+  int pixel_count = img_width * img_height;
+  if (pixel_count <= 0)
+    return color;
+
+  std::vector<KMeanCluster> clusters;
+  clusters.resize(kNumberOfClusters, KMeanCluster());
+
+  // Pick a starting point for each cluster
+  std::vector<KMeanCluster>::iterator cluster = clusters.begin();
+  while (cluster != clusters.end()) {
+    // Try up to 10 times to find a unique color. If no unique color can be
+    // found, destroy this cluster.
+    bool color_unique = false;
+    for (int i = 0; i < 10; ++i) {
+      int pixel_pos = sampler.GetSample(img_width, img_height) % pixel_count;
+
+      uint8_t b = decoded_data[pixel_pos * 4];
+      uint8_t g = decoded_data[pixel_pos * 4 + 1];
+      uint8_t r = decoded_data[pixel_pos * 4 + 2];
+
+      // Loop through the previous clusters and check to see if we have seen
+      // this color before.
+      color_unique = true;
+      for (std::vector<KMeanCluster>::iterator
+          cluster_check = clusters.begin();
+          cluster_check != cluster; ++cluster_check) {
+        if (cluster_check->IsAtCentroid(r, g, b)) {
+          color_unique = false;
+          break;
+        }
+      }
+
+      // If we have a unique color set the center of the cluster to
+      // that color.
+      if (color_unique) {
+        cluster->SetCentroid(r, g, b);
+        break;
+      }
+    }
+
+    // If we don't have a unique color erase this cluster.
+    if (!color_unique) {
+      cluster = clusters.erase(cluster);
+    } else {
+      // Have to increment the iterator here, otherwise the increment in the
+      // for loop will skip a cluster due to the erase if the color wasn't
+      // unique.
+      ++cluster;
+    }
+  }
+
+  bool use_sse2 = base::CPU().has_sse2();
+#if !defined(SIMD_SSE2)
+  use_sse2 = false;
+#endif
+
+  bool convergence = false;
+  for (int iteration = 0;
+      iteration < kNumberOfIterations && !convergence && !clusters.empty();
+      ++iteration) {
+
+    // Loop through each pixel so we can place it in the appropriate cluster.
+#if defined(SIMD_SSE2)
+    if (use_sse2)
+      AddPixelsToClusters_SSE2(decoded_data, pixel_count, &clusters);
+    else
+#endif
+      AddPixelsToClusters(decoded_data, pixel_count, &clusters);
+
+    // Calculate the new cluster centers and see if we've converged or not.
+    convergence = true;
+    for (std::vector<KMeanCluster>::iterator cluster = clusters.begin();
+        cluster != clusters.end(); ++cluster) {
+      convergence &= cluster->CompareCentroidWithAggregate();
+
+      cluster->RecomputeCentroid();
+    }
+  }
+
+  // Sort the clusters by population so we can tell what the most popular
+  // color is.
+  std::sort(clusters.begin(), clusters.end(),
+            KMeanCluster::SortKMeanClusterByWeight);
+
+  // Loop through the clusters to figure out which cluster has an appropriate
+  // color. Skip any that are too bright/dark and go in order of weight.
+  for (std::vector<KMeanCluster>::iterator cluster = clusters.begin();
+      cluster != clusters.end(); ++cluster) {
+    uint8_t r, g, b;
+    cluster->GetCentroid(&r, &g, &b);
+    // Sum the RGB components to determine if the color is too bright or too
+    // dark.
+    // TODO (dtrainor): Look into using HSV here instead. This approximation
+    // might be fine though.
+    uint32_t summed_color = r + g + b;
+
+    if (summed_color < brightness_limit && summed_color > darkness_limit) {
+      // If we found a valid color just set it and break. We don't want to
+      // check the other ones.
+      color = SkColorSetARGB(0xFF, r, g, b);
+      break;
+    } else if (cluster == clusters.begin()) {
+      // We haven't found a valid color, but we are at the first color so
+      // set the color anyway to make sure we at least have a value here.
+      color = SkColorSetARGB(0xFF, r, g, b);
+    }
+  }
+
+  return color;
+}
+
+// Returns the key the color of |bitmap| is remembered by: a digest of its
+// pixels, its size and the limits.
+std::string GetColorCacheKey(const SkBitmap& bitmap,
+                             uint32_t darkness_limit,
+                             uint32_t brightness_limit) {
+  SkAutoLockPixels lock(bitmap);
+  base::MD5Context context;
+  base::MD5Init(&context);
+  for (int y = 0; y < bitmap.height(); ++y) {
+    base::MD5Update(&context, base::StringPiece(
+        reinterpret_cast<const char*>(bitmap.getAddr32(0, y)),
+        bitmap.width() * 4));
+  }
+  base::MD5Digest digest;
+  base::MD5Final(&digest, &context);
+
+  const uint32_t values[] = {
+    static_cast<uint32_t>(bitmap.width()),
+    static_cast<uint32_t>(bitmap.height()),
+    darkness_limit,
+    brightness_limit
+  };
+  std::string key(reinterpret_cast<const char*>(digest.a), sizeof(digest.a));
+  key.append(reinterpret_cast<const char*>(values), sizeof(values));
+  return key;
+}
+
+// The colors of the bitmaps seen by CalculateKMeanColorsOfBitmaps(), and the
+// workers it computes them on.
+class BitmapColorAnalyzer {
+ public:
+  BitmapColorAnalyzer()
+      : colors_(kMaxCachedColors, kColorCacheShardCount, "BitmapColorCache"),
+        pool_(new base::SequencedWorkerPool(
+            base::SysInfo::NumberOfProcessors(), "ColorAnalysisWorker")),
+        task_runner_(pool_->GetTaskRunnerWithShutdownBehavior(
+            base::SequencedWorkerPool::CONTINUE_ON_SHUTDOWN)) {
+  }
+
+  base::ShardedMRUCache<std::string, SkColor>& colors() { return colors_; }
+  base::TaskRunner* task_runner() { return task_runner_.get(); }
+
+ private:
+  base::ShardedMRUCache<std::string, SkColor> colors_;
+  scoped_refptr<base::SequencedWorkerPool> pool_;
+  scoped_refptr<base::TaskRunner> task_runner_;
+
+  DISALLOW_COPY_AND_ASSIGN(BitmapColorAnalyzer);
+};
+
+base::LazyInstance<BitmapColorAnalyzer>::Leaky g_color_analyzer =
+    LAZY_INSTANCE_INITIALIZER;
+
+// The state of one CalculateKMeanColorsOfBitmaps() call, shared by its tasks.
+// The bitmaps are split in parts, one per task, and each task writes the
+// colors of its part.
+class BitmapColorsJob : public base::RefCountedThreadSafe<BitmapColorsJob> {
+ public:
+  BitmapColorsJob(const std::vector<SkBitmap>& bitmaps,
+                  uint32_t darkness_limit,
+                  uint32_t brightness_limit,
+                  size_t part_count,
+                  const color_utils::KMeanColorsCallback& callback)
+      : bitmaps_(bitmaps),
+        colors_(bitmaps.size(), kDefaultBgColor),
+        darkness_limit_(darkness_limit),
+        brightness_limit_(brightness_limit),
+        part_count_(part_count),
+        pending_parts_(part_count),
+        callback_(callback) {
+  }
+
+  size_t part_count() const { return part_count_; }
+
+  // Computes the colors of the bitmaps of |part|. Runs on a worker.
+  void AnalyzePart(size_t part) {
+    color_utils::RandomSampler sampler;
+    base::ShardedMRUCache<std::string, SkColor>& cache =
+        g_color_analyzer.Get().colors();
+    size_t end = bitmaps_.size() * (part + 1) / part_count_;
+    for (size_t i = bitmaps_.size() * part / part_count_; i < end; ++i) {
+      std::string key(GetColorCacheKey(bitmaps_[i], darkness_limit_,
+                                       brightness_limit_));
+      if (cache.Get(key, &colors_[i]))
+        continue;
+      colors_[i] = color_utils::CalculateKMeanColorOfBitmap(
+          bitmaps_[i], darkness_limit_, brightness_limit_, sampler);
+      cache.Put(key, colors_[i]);
+    }
+  }
+
+  // Runs the callback once all the parts are done. Runs on the thread that
+  // started the job.
+  void OnPartAnalyzed() {
+    if (--pending_parts_ == 0)
+      callback_.Run(colors_);
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<BitmapColorsJob>;
+
+  ~BitmapColorsJob() {}
+
+  const std::vector<SkBitmap> bitmaps_;
+  std::vector<SkColor> colors_;
+  const uint32_t darkness_limit_;
+  const uint32_t brightness_limit_;
+  const size_t part_count_;
+
+  // Only used on the thread that started the job.
+  size_t pending_parts_;
+  color_utils::KMeanColorsCallback callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(BitmapColorsJob);
+};
+
 } // namespace
 
 namespace color_utils {
@@ -185,7 +539,6 @@ SkColor CalculateKMeanColorOfPNG(scoped_refptr<base::RefCountedMemory> png,
                                  KMeanImageSampler& sampler) {
   int img_width, img_height;
   std::vector<uint8_t> decoded_data;
-  SkColor color = kDefaultBgColor;
 
   if (png.get() &&
       png->size() &&
@@ -195,131 +548,71 @@ SkColor CalculateKMeanColorOfPNG(scoped_refptr<base::RefCountedMemory> png,
                             &decoded_data,
                             &img_width,
                             &img_height)) {
-    std::vector<KMeanCluster> clusters;
-    clusters.resize(kNumberOfClusters, KMeanCluster());
-
-    // Pick a starting point for each cluster
-    std::vector<KMeanCluster>::iterator cluster = clusters.begin();
-    while (cluster != clusters.end()) {
-      // Try up to 10 times to find a unique color. If no unique color can be
-      // found, destroy this cluster.
-      bool color_unique = false;
-      for (int i = 0; i < 10; ++i) {
-        int pixel_pos = sampler.GetSample(img_width, img_height) %
-            (img_width * img_height);
-
-        uint8_t b = decoded_data[pixel_pos * 4];
-        uint8_t g = decoded_data[pixel_pos * 4 + 1];
-        uint8_t r = decoded_data[pixel_pos * 4 + 2];
-
-        // Loop through the previous clusters and check to see if we have seen
-        // this color before.
-        color_unique = true;
-        for (std::vector<KMeanCluster>::iterator
-            cluster_check = clusters.begin();
-            cluster_check != cluster; ++cluster_check) {
-          if (cluster_check->IsAtCentroid(r, g, b)) {
-            color_unique = false;
-            break;
-          }
-        }
-
-        // If we have a unique color set the center of the cluster to
-        // that color.
-        if (color_unique) {
-          cluster->SetCentroid(r, g, b);
-          break;
-        }
-      }
-
-      // If we don't have a unique color erase this cluster.
-      if (!color_unique) {
-        cluster = clusters.erase(cluster);
-      } else {
-        // Have to increment the iterator here, otherwise the increment in the
-        // for loop will skip a cluster due to the erase if the color wasn't
-        // unique.
-        ++cluster;
-      }
-    }
-
-    bool convergence = false;
-    for (int iteration = 0;
-        iteration < kNumberOfIterations && !convergence && !clusters.empty();
-        ++iteration) {
-
-      // Loop through each pixel so we can place it in the appropriate cluster.
-      std::vector<uint8_t>::iterator pixel = decoded_data.begin();
-      while (pixel != decoded_data.end()) {
-        uint8_t b = *(pixel++);
-        if (pixel == decoded_data.end())
-          continue;
-        uint8_t g = *(pixel++);
-        if (pixel == decoded_data.end())
-          continue;
-        uint8_t r = *(pixel++);
-        if (pixel == decoded_data.end())
-          continue;
-        ++pixel; // Ignore the alpha channel.
-
-        uint32_t distance_sqr_to_closest_cluster = UINT_MAX;
-        std::vector<KMeanCluster>::iterator closest_cluster = clusters.begin();
-
-        // Figure out which cluster this color is closest to in RGB space.
-        for (std::vector<KMeanCluster>::iterator cluster = clusters.begin();
-            cluster != clusters.end(); ++cluster) {
-          uint32_t distance_sqr = cluster->GetDistanceSqr(r, g, b);
-
-          if (distance_sqr < distance_sqr_to_closest_cluster) {
-            distance_sqr_to_closest_cluster = distance_sqr;
-            closest_cluster = cluster;
-          }
-        }
-
-        closest_cluster->AddPoint(r, g, b);
-      }
-
-      // Calculate the new cluster centers and see if we've converged or not.
-      convergence = true;
-      for (std::vector<KMeanCluster>::iterator cluster = clusters.begin();
-          cluster != clusters.end(); ++cluster) {
-        convergence &= cluster->CompareCentroidWithAggregate();
+    return CalculateKMeanColorOfPixels(&decoded_data[0], img_width,
+                                       img_height, darkness_limit,
+                                       brightness_limit, sampler);
+  }
+  return kDefaultBgColor;
+}
 
-        cluster->RecomputeCentroid();
-      }
+SkColor CalculateKMeanColorOfBitmap(const SkBitmap& bitmap,
+                                    uint32_t darkness_limit,
+                                    uint32_t brightness_limit,
+                                    KMeanImageSampler& sampler) {
+  SkAutoLockPixels lock(bitmap);
+  if (bitmap.config() != SkBitmap::kARGB_8888_Config ||
+      !bitmap.getPixels() || bitmap.empty())
+    return kDefaultBgColor;
+
+  // Sample every |step|th pixel of every |step|th row, so that there are at
+  // most kMaxSampledPixels.
+  int step = 1;
+  while (((bitmap.width() + step - 1) / step) *
+         ((bitmap.height() + step - 1) / step) > kMaxSampledPixels)
+    ++step;
+  int sampled_width = (bitmap.width() + step - 1) / step;
+  int sampled_height = (bitmap.height() + step - 1) / step;
+
+  // The pixels are unpremultiplied to BGRA, as PNGCodec decodes them.
+  std::vector<uint8_t> samples(sampled_width * sampled_height * 4);
+  uint8_t* sample = &samples[0];
+  for (int y = 0; y < bitmap.height(); y += step) {
+    const SkPMColor* row = bitmap.getAddr32(0, y);
+    for (int x = 0; x < bitmap.width(); x += step) {
+      SkColor color = SkUnPreMultiply::PMColorToColor(row[x]);
+      sample[0] = SkColorGetB(color);
+      sample[1] = SkColorGetG(color);
+      sample[2] = SkColorGetR(color);
+      sample[3] = SkColorGetA(color);
+      sample += 4;
     }
+  }
 
-    // Sort the clusters by population so we can tell what the most popular
-    // color is.
-    std::sort(clusters.begin(), clusters.end(),
-              KMeanCluster::SortKMeanClusterByWeight);
+  return CalculateKMeanColorOfPixels(&samples[0], sampled_width,
+                                     sampled_height, darkness_limit,
+                                     brightness_limit, sampler);
+}
 
-    // Loop through the clusters to figure out which cluster has an appropriate
-    // color. Skip any that are too bright/dark and go in order of weight.
-    for (std::vector<KMeanCluster>::iterator cluster = clusters.begin();
-        cluster != clusters.end(); ++cluster) {
-      uint8_t r, g, b;
-      cluster->GetCentroid(&r, &g, &b);
-      // Sum the RGB components to determine if the color is too bright or too
-      // dark.
-      // TODO (dtrainor): Look into using HSV here instead. This approximation
-      // might be fine though.
-      uint32_t summed_color = r + g + b;
-
-      if (summed_color < brightness_limit && summed_color > darkness_limit) {
-        // If we found a valid color just set it and break. We don't want to
-        // check the other ones.
-        color = SkColorSetARGB(0xFF, r, g, b);
-        break;
-      } else if (cluster == clusters.begin()) {
-        // We haven't found a valid color, but we are at the first color so
-        // set the color anyway to make sure we at least have a value here.
-        color = SkColorSetARGB(0xFF, r, g, b);
-      }
-    }
+void CalculateKMeanColorsOfBitmaps(const std::vector<SkBitmap>& bitmaps,
+                                   uint32_t darkness_limit,
+                                   uint32_t brightness_limit,
+                                   const KMeanColorsCallback& callback) {
+  size_t part_count = std::min(
+      bitmaps.size(),
+      static_cast<size_t>(base::SysInfo::NumberOfProcessors()));
+  if (part_count == 0) {
+    callback.Run(std::vector<SkColor>());
+    return;
   }
 
-  return color;
+  scoped_refptr<BitmapColorsJob> job(new BitmapColorsJob(
+      bitmaps, darkness_limit, brightness_limit, part_count, callback));
+  for (size_t part = 0; part < part_count; ++part) {
+    g_color_analyzer.Get().task_runner()->PostTaskAndReply(
+        FROM_HERE,
+        base::Bind(&BitmapColorsJob::AnalyzePart, job, part),
+        base::Bind(&BitmapColorsJob::OnPartAnalyzed, job));
+  }
 }
 
 }  // color_utils
@@ -6,13 +6,18 @@
 #define UI_GFX_COLOR_ANALYSIS_H_
 #pragma once
 
+#include <vector>
+
 #include "base/basictypes.h"
+#include "base/callback.h"
 #include "base/compiler_specific.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/ref_counted_memory.h"
 #include "third_party/skia/include/core/SkColor.h"
 #include "ui/base/ui_export.h"
 
+class SkBitmap;
+
 namespace color_utils {
 
 // This class exposes the sampling method to the caller, which allows
@@ -111,6 +116,29 @@ UI_EXPORT SkColor CalculateKMeanColorOfPNG(
     uint32_t brightness_limit,
     KMeanImageSampler& sampler);
 
+// Same as CalculateKMeanColorOfPNG(), for an image that is already decoded
+// into an ARGB |bitmap|. Bitmaps with more than 4096 pixels are sampled on an
+// evenly spaced grid of about that many pixels, and the sampler picks the
+// starting colors among those. Returns white for other configs.
+UI_EXPORT SkColor CalculateKMeanColorOfBitmap(const SkBitmap& bitmap,
+                                              uint32_t darkness_limit,
+                                              uint32_t brightness_limit,
+                                              KMeanImageSampler& sampler);
+
+typedef base::Callback<void(const std::vector<SkColor>&)> KMeanColorsCallback;
+
+// Computes CalculateKMeanColorOfBitmap() with a RandomSampler for each of
+// |bitmaps| on worker threads, and runs |callback| on the calling thread with
+// the colors, in the order of the bitmaps. The colors are remembered by the
+// pixels and limits they were computed for, so icons seen before aren't
+// analyzed again. The pixels of the bitmaps are read on the workers, so they
+// must not change until |callback| runs.
+UI_EXPORT void CalculateKMeanColorsOfBitmaps(
+    const std::vector<SkBitmap>& bitmaps,
+    uint32_t darkness_limit,
+    uint32_t brightness_limit,
+    const KMeanColorsCallback& callback);
+
 }  // namespace color_utils
 
 #endif  // UI_GFX_COLOR_ANALYSIS_H_
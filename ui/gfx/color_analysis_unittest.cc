@@ -4,10 +4,16 @@
 
 #include "ui/gfx/color_analysis.h"
 
+#include <stdlib.h>
+
 #include <vector>
 
+#include "base/bind.h"
+#include "base/message_loop.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkColor.h"
+#include "ui/gfx/codec/png_codec.h"
 
 namespace {
 
@@ -125,9 +131,34 @@ class MockKMeanImageSampler : public color_utils::KMeanImageSampler {
   size_t current_result_index_;
 };
 
+// Returns an opaque bitmap of random colors.
+SkBitmap MakeRandomBitmap(int width, int height) {
+  SkBitmap bitmap;
+  bitmap.setConfig(SkBitmap::kARGB_8888_Config, width, height);
+  bitmap.allocPixels();
+  SkAutoLockPixels lock(bitmap);
+  srand(width * height);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      *bitmap.getAddr32(x, y) = SkPreMultiplyColor(
+          SkColorSetARGB(0xFF, rand() % 256, rand() % 256, rand() % 256));
+    }
+  }
+  return bitmap;
+}
+
 } // namespace
 
 class ColorAnalysisTest : public testing::Test {
+ public:
+  void OnColorsCalculated(const std::vector<SkColor>& colors) {
+    colors_ = colors;
+    MessageLoop::current()->Quit();
+  }
+
+ protected:
+  MessageLoopForUI message_loop_;
+  std::vector<SkColor> colors_;
 };
 
 TEST_F(ColorAnalysisTest, CalculatePNGKMeanAllWhite) {
@@ -178,3 +209,42 @@ TEST_F(ColorAnalysisTest, CalculatePNGKMeanPickMostCommon) {
 
   EXPECT_EQ(color, SkColorSetARGB(0xFF, 0xFF, 0x00, 0x00));
 }
+
+// Bitmaps small enough not to be sampled give the color of their PNG.
+TEST_F(ColorAnalysisTest, CalculateBitmapKMeanMatchesPNG) {
+  SkBitmap bitmap(MakeRandomBitmap(37, 23));
+  scoped_refptr<base::RefCountedBytes> png(new base::RefCountedBytes);
+  ASSERT_TRUE(gfx::PNGCodec::EncodeBGRASkBitmap(bitmap, false, &png->data()));
+
+  color_utils::GridSampler png_sampler;
+  color_utils::GridSampler bitmap_sampler;
+  EXPECT_EQ(color_utils::CalculateKMeanColorOfPNG(png, 100, 600, png_sampler),
+            color_utils::CalculateKMeanColorOfBitmap(bitmap, 100, 600,
+                                                     bitmap_sampler));
+}
+
+// Each bitmap of a batch gets its own color, the same the second time when it
+// is remembered.
+TEST_F(ColorAnalysisTest, CalculateBitmapsKMean) {
+  std::vector<SkBitmap> bitmaps;
+  for (int i = 0; i < 8; ++i) {
+    SkBitmap bitmap;
+    bitmap.setConfig(SkBitmap::kARGB_8888_Config, 100, 50 + i);
+    bitmap.allocPixels();
+    bitmap.eraseARGB(0xFF, i * 30, 0x80, 0x40);
+    bitmaps.push_back(bitmap);
+  }
+  bitmaps.push_back(MakeRandomBitmap(300, 200));
+
+  for (int pass = 0; pass < 2; ++pass) {
+    color_utils::CalculateKMeanColorsOfBitmaps(
+        bitmaps, 100, 600,
+        base::Bind(&ColorAnalysisTest::OnColorsCalculated,
+                   base::Unretained(this)));
+    message_loop_.Run();
+
+    ASSERT_EQ(bitmaps.size(), colors_.size());
+    for (int i = 0; i < 8; ++i)
+      EXPECT_EQ(SkColorSetARGB(0xFF, i * 30, 0x80, 0x40), colors_[i]);
+  }
+}
@@ -0,0 +1,131 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/font_fallback_warmer_linux.h"
+
+#include <fontconfig/fontconfig.h>
+
+#include "base/bind.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/i18n/char_iterator.h"
+#include "base/lazy_instance.h"
+#include "base/location.h"
+#include "base/memory/singleton.h"
+#include "base/threading/sequenced_worker_pool.h"
+#include "unicode/uscript.h"
+
+namespace gfx {
+
+namespace {
+
+// The size of the reads that bring a font file into the page cache.
+const size_t kReadChunkSize = 64 * 1024;
+
+// One worker is enough: the fonts are warmed one at a time, in the
+// background.
+class WarmerWorkerPool {
+ public:
+  WarmerWorkerPool()
+      : pool_(new base::SequencedWorkerPool(1, "FontFallbackWarmer")),
+        task_runner_(pool_->GetTaskRunnerWithShutdownBehavior(
+            base::SequencedWorkerPool::CONTINUE_ON_SHUTDOWN)) {
+  }
+
+  base::TaskRunner* task_runner() { return task_runner_.get(); }
+
+ private:
+  scoped_refptr<base::SequencedWorkerPool> pool_;
+  scoped_refptr<base::TaskRunner> task_runner_;
+
+  DISALLOW_COPY_AND_ASSIGN(WarmerWorkerPool);
+};
+
+base::LazyInstance<WarmerWorkerPool>::Leaky g_warmer_worker_pool =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Reads the file at |path| and throws the contents away.
+void ReadFontFile(const FilePath& path) {
+  FILE* file = file_util::OpenFile(path, "rb");
+  if (!file)
+    return;
+  char buffer[kReadChunkSize];
+  while (fread(buffer, 1, sizeof(buffer), file) == sizeof(buffer)) {
+  }
+  file_util::CloseFile(file);
+}
+
+// Asks fontconfig for the fonts to draw |character| with in |family|, the
+// same way Pango does, and reads the first one that has it. Run on a worker.
+// fontconfig is already used off the UI thread by Skia's font host.
+void WarmFallbackFont(const std::string& family, int32 character) {
+  FcPattern* pattern = FcPatternCreate();
+  FcPatternAddString(pattern, FC_FAMILY,
+                     reinterpret_cast<const FcChar8*>(family.c_str()));
+  FcCharSet* charset = FcCharSetCreate();
+  FcCharSetAddChar(charset, character);
+  FcPatternAddCharSet(pattern, FC_CHARSET, charset);
+  FcCharSetDestroy(charset);
+  FcConfigSubstitute(NULL, pattern, FcMatchPattern);
+  FcDefaultSubstitute(pattern);
+
+  FcResult result;
+  FcFontSet* fonts = FcFontSort(NULL, pattern, FcTrue, NULL, &result);
+  if (fonts) {
+    for (int i = 0; i < fonts->nfont; ++i) {
+      FcCharSet* font_charset = NULL;
+      if (FcPatternGetCharSet(fonts->fonts[i], FC_CHARSET, 0,
+                              &font_charset) != FcResultMatch ||
+          !FcCharSetHasChar(font_charset, character)) {
+        continue;
+      }
+      FcChar8* file = NULL;
+      if (FcPatternGetString(fonts->fonts[i], FC_FILE, 0, &file) ==
+          FcResultMatch) {
+        ReadFontFile(FilePath(reinterpret_cast<const char*>(file)));
+      }
+      break;
+    }
+    FcFontSetDestroy(fonts);
+  }
+  FcPatternDestroy(pattern);
+}
+
+}  // namespace
+
+// static
+FontFallbackWarmer* FontFallbackWarmer::GetInstance() {
+  return Singleton<FontFallbackWarmer>::get();
+}
+
+size_t FontFallbackWarmer::WarmForText(const std::string& family,
+                                       const string16& text) {
+  size_t queued = 0;
+  base::AutoLock lock(lock_);
+  for (base::i18n::UTF16CharIterator iter(&text); !iter.end();
+       iter.Advance()) {
+    UErrorCode error = U_ZERO_ERROR;
+    UScriptCode script = uscript_getScript(iter.get(), &error);
+    // Common and inherited characters, like spaces, digits and combining
+    // marks, are drawn with the font of the text around them.
+    if (U_FAILURE(error) || script == USCRIPT_COMMON ||
+        script == USCRIPT_INHERITED) {
+      continue;
+    }
+    if (!warmed_.insert(std::make_pair(family, script)).second)
+      continue;
+    g_warmer_worker_pool.Get().task_runner()->PostTask(
+        FROM_HERE, base::Bind(&WarmFallbackFont, family, iter.get()));
+    queued++;
+  }
+  return queued;
+}
+
+FontFallbackWarmer::FontFallbackWarmer() {
+}
+
+FontFallbackWarmer::~FontFallbackWarmer() {
+}
+
+}  // namespace gfx
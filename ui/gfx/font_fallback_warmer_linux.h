@@ -0,0 +1,56 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GFX_FONT_FALLBACK_WARMER_LINUX_H_
+#define UI_GFX_FONT_FALLBACK_WARMER_LINUX_H_
+#pragma once
+
+#include <set>
+#include <string>
+#include <utility>
+
+#include "base/basictypes.h"
+#include "base/string16.h"
+#include "base/synchronization/lock.h"
+#include "ui/base/ui_export.h"
+
+template <typename T> struct DefaultSingletonTraits;
+
+namespace gfx {
+
+// FontFallbackWarmer finds the fallback fonts for the scripts of text on a
+// worker thread. The first time Pango lays out text in a script the font does
+// not cover, it asks fontconfig for the fallback font, which walks the
+// charsets of all the fonts, and then opens the fallback font file. Both can
+// take milliseconds on the UI thread. The warmer runs the same fontconfig
+// query and reads the font file first, so the UI thread finds the fontconfig
+// caches loaded and the file in the page cache.
+//
+// Each script is warmed once per font family, in the order it is first seen.
+class UI_EXPORT FontFallbackWarmer {
+ public:
+  static FontFallbackWarmer* GetInstance();
+
+  // Queues the warming of the fallback fonts for the scripts in |text| that
+  // have not been warmed for |family| yet. Returns the number of scripts
+  // queued.
+  size_t WarmForText(const std::string& family, const string16& text);
+
+ private:
+  friend struct DefaultSingletonTraits<FontFallbackWarmer>;
+
+  FontFallbackWarmer();
+  ~FontFallbackWarmer();
+
+  // The pairs of font family and script already queued. Guarded by |lock_|,
+  // since text may be laid out on more than one thread.
+  std::set<std::pair<std::string, int> > warmed_;
+  base::Lock lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(FontFallbackWarmer);
+};
+
+}  // namespace gfx
+
+#endif  // UI_GFX_FONT_FALLBACK_WARMER_LINUX_H_
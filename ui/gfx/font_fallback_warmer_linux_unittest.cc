@@ -0,0 +1,31 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/font_fallback_warmer_linux.h"
+
+#include "base/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace gfx {
+
+// Verifies each script is warmed once per family, and that common characters
+// are skipped.
+TEST(FontFallbackWarmerTest, WarmsEachScriptOnce) {
+  FontFallbackWarmer* warmer = FontFallbackWarmer::GetInstance();
+  const std::string kFamily("FontFallbackWarmerTestFamily");
+
+  EXPECT_EQ(0U, warmer->WarmForText(kFamily, ASCIIToUTF16("123 ,.")));
+  EXPECT_EQ(1U, warmer->WarmForText(kFamily, ASCIIToUTF16("abc def")));
+  EXPECT_EQ(0U, warmer->WarmForText(kFamily, ASCIIToUTF16("ghi")));
+
+  // Latin is already warmed; Hebrew and Devanagari are new.
+  EXPECT_EQ(2U, warmer->WarmForText(
+      kFamily, WideToUTF16(L"a \x05d0\x05d1 \x0915\x094d\x0915")));
+  EXPECT_EQ(0U, warmer->WarmForText(kFamily, WideToUTF16(L"\x05d2")));
+
+  // Another family warms the same scripts again.
+  EXPECT_EQ(1U, warmer->WarmForText(kFamily + "2", WideToUTF16(L"\x05d2")));
+}
+
+}  // namespace gfx
@@ -5,10 +5,18 @@
 #include "ui/gfx/image/image.h"
 
 #include <algorithm>
+#include <vector>
 
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/location.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/threading/worker_pool.h"
 #include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/codec/png_codec.h"
 #include "ui/gfx/image/image_skia.h"
 #include "ui/gfx/size.h"
 
@@ -16,6 +24,8 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gdk/gdk.h>
 #include <glib-object.h>
+#include "base/lazy_instance.h"
+#include "base/memory/mru_cache.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/gtk_util.h"
 #include "ui/gfx/image/cairo_cached_surface.h"
@@ -39,8 +49,83 @@ const ImageSkia ImageSkiaFromGdkPixbuf(GdkPixbuf* pixbuf) {
   cairo_paint(cr);
   return ImageSkia(SkBitmap(canvas.ExtractBitmap()));
 }
+
+// The GdkPixbufs converted from SkBitmaps, keyed by the generation ID of the
+// bitmap, so that Images made from the same pixels share one conversion; GTK
+// menus and toolbars wrap the same theme images in new Images over and over.
+// The least recently used pixbufs are released when they take more than the
+// byte budget. Like Image, it is only used on the UI thread.
+class PixbufConversionCache {
+ public:
+  // The most bytes of pixels the cached pixbufs may take: 8MB.
+  static const size_t kByteBudget = 8 * 1024 * 1024;
+
+  PixbufConversionCache()
+      : cache_(Cache::NO_AUTO_EVICT),
+        byte_count_(0) {
+  }
+
+  // Returns a new reference to the pixbuf of |bitmap|, converting it if it
+  // isn't cached.
+  GdkPixbuf* GetPixbuf(const SkBitmap& bitmap) {
+    // Bitmaps without pixels have no generation ID to find them by.
+    uint32 generation_id = bitmap.getGenerationID();
+    if (!generation_id)
+      return GdkPixbufFromSkBitmap(bitmap);
+
+    Cache::iterator it = cache_.Get(generation_id);
+    if (it == cache_.end()) {
+      GdkPixbuf* pixbuf = GdkPixbufFromSkBitmap(bitmap);
+      if (!pixbuf)
+        return NULL;
+      it = cache_.Put(generation_id, pixbuf);
+      byte_count_ += GetPixbufByteCount(pixbuf);
+      EvictToBudget(it->second);
+    }
+    g_object_ref(it->second);
+    return it->second;
+  }
+
+ private:
+  typedef base::MRUCache<uint32, GdkPixbuf*> Cache;
+
+  static size_t GetPixbufByteCount(GdkPixbuf* pixbuf) {
+    return static_cast<size_t>(gdk_pixbuf_get_rowstride(pixbuf)) *
+        gdk_pixbuf_get_height(pixbuf);
+  }
+
+  // Releases the least recently used pixbufs, other than |keep|, until the
+  // cache is within budget.
+  void EvictToBudget(GdkPixbuf* keep) {
+    while (byte_count_ > kByteBudget) {
+      Cache::reverse_iterator oldest = cache_.rbegin();
+      if (oldest->second == keep)
+        break;
+      byte_count_ -= GetPixbufByteCount(oldest->second);
+      g_object_unref(oldest->second);
+      cache_.Erase(oldest);
+    }
+  }
+
+  Cache cache_;
+  size_t byte_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(PixbufConversionCache);
+};
+
+base::LazyInstance<PixbufConversionCache>::Leaky g_pixbuf_conversion_cache =
+    LAZY_INSTANCE_INITIALIZER;
 #endif
 
+// Encodes |bitmap| as PNG into |png|, which is left NULL if that fails. Runs
+// on the worker pool for Image::ToPNGBytesAsync().
+void EncodePNG(const SkBitmap& bitmap,
+               scoped_refptr<base::RefCountedMemory>* png) {
+  std::vector<unsigned char> data;
+  if (PNGCodec::EncodeBGRASkBitmap(bitmap, false, &data))
+    *png = base::RefCountedBytes::TakeVector(&data);
+}
+
 class ImageRepSkia;
 class ImageRepGdk;
 class ImageRepCairoCached;
@@ -192,6 +277,30 @@ class ImageStorage : public base::RefCounted<ImageStorage> {
   }
   gfx::Image::RepresentationMap& representations() { return representations_; }
 
+  // The image encoded as PNG, once it has been.
+  const scoped_refptr<base::RefCountedMemory>& png_bytes() const {
+    return png_bytes_;
+  }
+  void set_png_bytes(const scoped_refptr<base::RefCountedMemory>& png_bytes) {
+    png_bytes_ = png_bytes;
+  }
+
+  // The callbacks waiting for an encoding on the worker pool.
+  std::vector<gfx::Image::PNGCallback>& png_callbacks() {
+    return png_callbacks_;
+  }
+
+  // Stores the result of an encoding on the worker pool and runs the
+  // callbacks waiting for it.
+  void OnPNGEncoded(scoped_refptr<base::RefCountedMemory>* png) {
+    if (!png_bytes_.get())
+      png_bytes_ = *png;
+    std::vector<gfx::Image::PNGCallback> callbacks;
+    callbacks.swap(png_callbacks_);
+    for (size_t i = 0; i < callbacks.size(); ++i)
+      callbacks[i].Run(png_bytes_);
+  }
+
  private:
   ~ImageStorage() {
     for (gfx::Image::RepresentationMap::iterator it = representations_.begin();
@@ -210,6 +319,9 @@ class ImageStorage : public base::RefCounted<ImageStorage> {
   // more for any converted representations.
   gfx::Image::RepresentationMap representations_;
 
+  scoped_refptr<base::RefCountedMemory> png_bytes_;
+  std::vector<gfx::Image::PNGCallback> png_callbacks_;
+
   friend class base::RefCounted<ImageStorage>;
 };
 
@@ -313,6 +425,41 @@ NSImage* Image::CopyNSImage() const {
 }
 #endif
 
+scoped_refptr<base::RefCountedMemory> Image::ToPNGBytes() const {
+  CHECK(storage_.get());
+  if (!storage_->png_bytes().get()) {
+    scoped_refptr<base::RefCountedMemory> png;
+    internal::EncodePNG(*ToSkBitmap(), &png);
+    storage_->set_png_bytes(png);
+  }
+  return storage_->png_bytes();
+}
+
+void Image::ToPNGBytesAsync(const PNGCallback& callback) const {
+  CHECK(storage_.get());
+  if (storage_->png_bytes().get()) {
+    MessageLoop::current()->PostTask(
+        FROM_HERE, base::Bind(callback, storage_->png_bytes()));
+    return;
+  }
+
+  std::vector<PNGCallback>& callbacks = storage_->png_callbacks();
+  callbacks.push_back(callback);
+  if (callbacks.size() > 1)
+    return;  // An encoding is already on its way.
+
+  // The bitmap shares its pixels, which no one writes, with this image.
+  // The storage is only referenced from this thread, by the reply.
+  scoped_refptr<base::RefCountedMemory>* png =
+      new scoped_refptr<base::RefCountedMemory>;
+  base::WorkerPool::PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&internal::EncodePNG, *ToSkBitmap(), png),
+      base::Bind(&internal::ImageStorage::OnPNGEncoded, storage_,
+                 base::Owned(png)),
+      true /* task_is_slow */);
+}
+
 #if defined(OS_MACOSX)
 Image::operator NSImage*() const {
   return ToNSImage();
@@ -407,7 +554,7 @@ internal::ImageRep* Image::GetRepresentation(
     NOTIMPLEMENTED();
 #elif defined(TOOLKIT_GTK)
     if (rep_type == Image::kImageRepGdk) {
-      GdkPixbuf* pixbuf = gfx::GdkPixbufFromSkBitmap(
+      GdkPixbuf* pixbuf = internal::g_pixbuf_conversion_cache.Get().GetPixbuf(
           *default_rep->AsImageRepSkia()->image()->bitmap());
       native_rep = new internal::ImageRepGdk(pixbuf);
     }
@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/callback_forward.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
 #include "ui/base/ui_export.h"
@@ -31,6 +32,10 @@
 
 class SkBitmap;
 
+namespace base {
+class RefCountedMemory;
+}
+
 namespace {
 class ImageTest;
 class ImageMacTest;
@@ -59,6 +64,10 @@ class UI_EXPORT Image {
 
   typedef std::map<RepresentationType, internal::ImageRep*> RepresentationMap;
 
+  // Receives the image encoded as PNG, or NULL if it couldn't be encoded.
+  typedef base::Callback<void(scoped_refptr<base::RefCountedMemory>)>
+      PNGCallback;
+
   // Creates an empty image with no representations.
   Image();
 
@@ -116,6 +125,15 @@ class UI_EXPORT Image {
   NSImage* CopyNSImage() const;
 #endif
 
+  // Returns the image encoded as PNG, or NULL if it couldn't be encoded. The
+  // encoding is kept with the representations, so it is only done once.
+  scoped_refptr<base::RefCountedMemory> ToPNGBytes() const;
+
+  // Like ToPNGBytes(), for callers that only need the encoded data: encodes
+  // the image on the worker pool, and runs |callback| with the data on the
+  // calling thread's message loop, even if the image was already encoded.
+  void ToPNGBytesAsync(const PNGCallback& callback) const;
+
   // DEPRECATED ----------------------------------------------------------------
   // Conversion handlers. These wrap the ToType() variants.
 #if defined(OS_MACOSX)
@@ -4,10 +4,16 @@
 
 #include "ui/gfx/image/image_skia.h"
 
+#include <algorithm>
 #include <limits>
 #include <cmath>
+#include <map>
+#include <set>
 
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "ui/gfx/image/image_skia_source.h"
 #include "ui/gfx/size.h"
 #include "ui/gfx/skia_util.h"
 
@@ -15,6 +21,21 @@ namespace gfx {
 
 namespace internal {
 
+class ImageSkiaStorage;
+
+}  // internal
+
+namespace {
+
+// The storages of the images that have a source, so that the bitmaps they
+// generated can be purged.
+base::LazyInstance<std::set<internal::ImageSkiaStorage*> >::Leaky
+    g_sourced_storages = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+namespace internal {
+
 // A helper class such that ImageSkia can be cheaply copied. ImageSkia holds a
 // refptr instance of ImageSkiaStorage, which in turn holds all of ImageSkia's
 // information.
@@ -23,6 +44,11 @@ class ImageSkiaStorage : public base::RefCounted<ImageSkiaStorage> {
   ImageSkiaStorage() {
   }
 
+  // Takes ownership of |source|.
+  explicit ImageSkiaStorage(ImageSkiaSource* source) : source_(source) {
+    g_sourced_storages.Get().insert(this);
+  }
+
   void AddBitmap(const SkBitmap& bitmap) {
     bitmaps_.push_back(bitmap);
   }
@@ -35,16 +61,60 @@ class ImageSkiaStorage : public base::RefCounted<ImageSkiaStorage> {
 
   const std::vector<SkBitmap>& bitmaps() const { return bitmaps_; }
 
+  ImageSkiaSource* source() const { return source_.get(); }
+
+  // Returns the bitmap the source generated for |scale_factor|, asking the
+  // source for it if it hasn't yet. Returns NULL if the source can't generate
+  // it.
+  const SkBitmap* GetGeneratedBitmap(float scale_factor) {
+    DCHECK(source_.get());
+    GeneratedBitmaps::iterator it = generated_bitmaps_.find(scale_factor);
+    if (it == generated_bitmaps_.end()) {
+      SkBitmap bitmap(source_->GetBitmapForScale(scale_factor));
+      if (bitmap.isNull())
+        return NULL;
+      it = generated_bitmaps_.insert(
+          std::make_pair(scale_factor, bitmap)).first;
+    }
+    return &it->second;
+  }
+
+  bool HasGeneratedBitmap(float scale_factor) const {
+    return generated_bitmaps_.count(scale_factor) != 0;
+  }
+
+  // Appends the bitmaps generated so far to |bitmaps|.
+  void AppendGeneratedBitmaps(std::vector<SkBitmap>* bitmaps) const {
+    for (GeneratedBitmaps::const_iterator it = generated_bitmaps_.begin();
+         it != generated_bitmaps_.end(); ++it) {
+      bitmaps->push_back(it->second);
+    }
+  }
+
+  void PurgeGeneratedBitmaps() {
+    generated_bitmaps_.clear();
+  }
+
   void set_size(const gfx::Size& size) { size_ = size; }
   const gfx::Size& size() const { return size_; }
 
  private:
+  typedef std::map<float, SkBitmap> GeneratedBitmaps;
+
   ~ImageSkiaStorage() {
+    if (source_.get())
+      g_sourced_storages.Get().erase(this);
   }
 
   // Bitmaps at different densities.
   std::vector<SkBitmap> bitmaps_;
 
+  // Generates bitmaps at the densities asked for, if not NULL.
+  scoped_ptr<ImageSkiaSource> source_;
+
+  // The bitmaps |source_| generated, by the scale factor they were asked for.
+  GeneratedBitmaps generated_bitmaps_;
+
   // Size of the image in DIP.
   gfx::Size size_;
 
@@ -67,6 +137,12 @@ ImageSkia::ImageSkia(const SkBitmap& bitmap, float dip_scale_factor) {
   Init(bitmap, dip_scale_factor);
 }
 
+ImageSkia::ImageSkia(ImageSkiaSource* source, const gfx::Size& size)
+    : storage_(new internal::ImageSkiaStorage(source)) {
+  DCHECK(source);
+  storage_->set_size(size);
+}
+
 ImageSkia::ImageSkia(const ImageSkia& other) : storage_(other.storage_) {
 }
 
@@ -85,7 +161,7 @@ ImageSkia::operator SkBitmap&() const {
     return *null_bitmap_;
   }
 
-  return const_cast<SkBitmap&>(storage_->bitmaps()[0]);
+  return const_cast<SkBitmap&>(*bitmap());
 }
 
 ImageSkia::~ImageSkia() {
@@ -122,7 +198,10 @@ bool ImageSkia::HasBitmapForScale(float dip_scale_factor) {
                                          &bitmap_scale_factor);
   // TODO(pkotwicz): Allow for small errors between scale factors due to
   // rounding errors in computing |bitmap_scale_factor|.
-  return (candidate >= 0 && bitmap_scale_factor == dip_scale_factor);
+  if (candidate >= 0 && bitmap_scale_factor == dip_scale_factor)
+    return true;
+  return !isNull() && storage_->source() &&
+      storage_->HasGeneratedBitmap(dip_scale_factor);
 }
 
 const SkBitmap& ImageSkia::GetBitmapForScale(float scale_factor,
@@ -135,6 +214,21 @@ const SkBitmap& ImageSkia::GetBitmapForScale(float scale_factor,
 const SkBitmap& ImageSkia::GetBitmapForScale(float x_scale_factor,
                                              float y_scale_factor,
                                              float* bitmap_scale_factor) const {
+  if (!isNull() && storage_->source()) {
+    // A bitmap added for the scale factor is used over generating one.
+    float scale_factor = std::max(x_scale_factor, y_scale_factor);
+    int index = GetBitmapIndexForScale(scale_factor, scale_factor,
+                                       bitmap_scale_factor);
+    if (index >= 0 && *bitmap_scale_factor == scale_factor)
+      return storage_->bitmaps()[index];
+
+    const SkBitmap* generated = storage_->GetGeneratedBitmap(scale_factor);
+    if (generated) {
+      *bitmap_scale_factor = scale_factor;
+      return *generated;
+    }
+  }
+
   int closest_index = GetBitmapIndexForScale(x_scale_factor, y_scale_factor,
       bitmap_scale_factor);
 
@@ -162,7 +256,12 @@ bool ImageSkia::extractSubset(ImageSkia* dst, const SkIRect& subset) const {
     return false;
   gfx::ImageSkia image;
   int dip_width = width();
-  const std::vector<SkBitmap>& bitmaps = storage_->bitmaps();
+  // Images with a source have at least their 1x bitmap.
+  if (storage_->source()) {
+    float scale_factor;
+    GetBitmapForScale(1.0f, &scale_factor);
+  }
+  const std::vector<SkBitmap> bitmaps = this->bitmaps();
   for (std::vector<SkBitmap>::const_iterator it = bitmaps.begin();
        it != bitmaps.end(); ++it) {
     const SkBitmap& bitmap = *it;
@@ -187,7 +286,19 @@ bool ImageSkia::extractSubset(ImageSkia* dst, const SkIRect& subset) const {
 }
 
 const std::vector<SkBitmap> ImageSkia::bitmaps() const {
-  return storage_->bitmaps();
+  std::vector<SkBitmap> bitmaps(storage_->bitmaps());
+  if (storage_->source())
+    storage_->AppendGeneratedBitmaps(&bitmaps);
+  return bitmaps;
+}
+
+// static
+void ImageSkia::PurgeGeneratedBitmaps() {
+  std::set<internal::ImageSkiaStorage*>& storages = g_sourced_storages.Get();
+  for (std::set<internal::ImageSkiaStorage*>::iterator it = storages.begin();
+       it != storages.end(); ++it) {
+    (*it)->PurgeGeneratedBitmaps();
+  }
 }
 
 const SkBitmap* ImageSkia::bitmap() const {
@@ -197,6 +308,12 @@ const SkBitmap* ImageSkia::bitmap() const {
     return null_bitmap_;
   }
 
+  // Images with a source that no bitmap was added to return their 1x bitmap.
+  if (storage_->bitmaps().empty() && storage_->source()) {
+    float scale_factor;
+    return &GetBitmapForScale(1.0f, &scale_factor);
+  }
+
   return &storage_->bitmaps()[0];
 }
 
@@ -15,6 +15,9 @@
 
 namespace gfx {
 
+class ImageSkiaSource;
+class Size;
+
 namespace internal {
 class ImageSkiaStorage;
 }  // namespace internal
@@ -43,6 +46,11 @@ class UI_EXPORT ImageSkia {
   // DIP width and height are set based on |dip_scale_factor|.
   ImageSkia(const SkBitmap& bitmap, float dip_scale_factor);
 
+  // Creates an image of DIP size |size| whose bitmaps are generated by
+  // |source| at each scale factor they are asked for, and kept with the image
+  // until PurgeGeneratedBitmaps() is called. Takes ownership of |source|.
+  ImageSkia(ImageSkiaSource* source, const gfx::Size& size);
+
   // Copies a reference to |other|'s storage.
   ImageSkia(const ImageSkia& other);
 
@@ -72,12 +80,14 @@ class UI_EXPORT ImageSkia {
   void RemoveBitmapForScale(float dip_scale_factor);
 
   // Returns true if the object owns a bitmap whose density matches
-  // |dip_scale_factor| exactly.
+  // |dip_scale_factor| exactly, including one generated by its source.
   bool HasBitmapForScale(float dip_scale_factor);
 
   // Returns the bitmap whose density best matches |scale_factor|.
   // Returns a null bitmap if the object contains no bitmaps.
   // |bitmap_scale_factor| is set to the scale factor of the returned bitmap.
+  // Images with a source return the bitmap the source generates for
+  // |scale_factor| unless a bitmap was added for exactly |scale_factor|.
   const SkBitmap& GetBitmapForScale(float scale_factor,
                                     float* bitmap_scale_factor) const;
 
@@ -85,6 +95,7 @@ class UI_EXPORT ImageSkia {
   // |y_scale_factor|.
   // Returns a null bitmap if the object contains no bitmaps.
   // |bitmap_scale_factor| is set to the scale factor of the returned bitmap.
+  // Images with a source use the larger of the two scale factors.
   const SkBitmap& GetBitmapForScale(float x_scale_factor,
                                     float y_scale_factor,
                                     float* bitmap_scale_factor) const;
@@ -109,9 +120,15 @@ class UI_EXPORT ImageSkia {
   // done.
   const SkBitmap* bitmap() const;
 
-  // Returns a vector with the SkBitmaps contained in this object.
+  // Returns a vector with the SkBitmaps contained in this object, followed by
+  // the ones generated by its source so far.
   const std::vector<SkBitmap> bitmaps() const;
 
+  // Frees the bitmaps generated by the sources of all the images, which
+  // generate them again when next asked. Call when memory is low. References
+  // to the freed bitmaps become invalid.
+  static void PurgeGeneratedBitmaps();
+
  private:
   // Initialize ImageSkiaStorage with passed in parameters.
   // If |bitmap.isNull()|, ImageStorage is set to NULL.
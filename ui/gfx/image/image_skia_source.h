@@ -0,0 +1,29 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GFX_IMAGE_IMAGE_SKIA_SOURCE_H_
+#define UI_GFX_IMAGE_IMAGE_SKIA_SOURCE_H_
+#pragma once
+
+#include "ui/base/ui_export.h"
+
+class SkBitmap;
+
+namespace gfx {
+
+// Generates the bitmaps of an ImageSkia at the scale factors it is drawn at,
+// when they are first needed. See ImageSkia(ImageSkiaSource*, const Size&).
+class UI_EXPORT ImageSkiaSource {
+ public:
+  virtual ~ImageSkiaSource() {}
+
+  // Returns the bitmap of the image at |scale_factor|. Its size should be the
+  // DIP size of the image times |scale_factor|. Returns a null bitmap if the
+  // image can't be drawn at |scale_factor|.
+  virtual SkBitmap GetBitmapForScale(float scale_factor) = 0;
+};
+
+}  // namespace gfx
+
+#endif  // UI_GFX_IMAGE_IMAGE_SKIA_SOURCE_H_
@@ -2,11 +2,18 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/bind.h"
+#include "base/compiler_specific.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/message_loop.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/codec/png_codec.h"
 #include "ui/gfx/image/image.h"
 #include "ui/gfx/image/image_skia.h"
+#include "ui/gfx/image/image_skia_source.h"
 #include "ui/gfx/image/image_unittest_util.h"
+#include "ui/gfx/size.h"
 
 #if defined(TOOLKIT_GTK)
 #include <gtk/gtk.h>
@@ -27,6 +34,31 @@ const bool kUsesSkiaNatively = false;
 class ImageTest : public testing::Test {
 };
 
+// Generates bitmaps of a 10x12 DIP image, counting how many it generated.
+class CountingImageSource : public gfx::ImageSkiaSource {
+ public:
+  explicit CountingImageSource(int* count) : count_(count) {
+  }
+
+  virtual SkBitmap GetBitmapForScale(float scale_factor) OVERRIDE {
+    (*count_)++;
+    return gfx::test::CreateBitmap(static_cast<int>(10 * scale_factor),
+                                   static_cast<int>(12 * scale_factor));
+  }
+
+ private:
+  int* count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingImageSource);
+};
+
+// Stores the PNG data it is given and quits the message loop.
+void StorePNGAndQuit(scoped_refptr<base::RefCountedMemory>* out,
+                     scoped_refptr<base::RefCountedMemory> png) {
+  *out = png;
+  MessageLoop::current()->Quit();
+}
+
 namespace gt = gfx::test;
 
 TEST_F(ImageTest, EmptyImage) {
@@ -173,6 +205,17 @@ TEST_F(ImageTest, SkiaToGdkCopy) {
   g_object_unref(pixbuf);
 }
 
+// Images made from the same pixels share the conversion to a pixbuf.
+TEST_F(ImageTest, SkiaToGdkSharesConversion) {
+  SkBitmap bitmap(gt::CreateBitmap(25, 25));
+  gfx::Image image1(bitmap);
+  gfx::Image image2(bitmap);
+  EXPECT_EQ(image1.ToGdkPixbuf(), image2.ToGdkPixbuf());
+
+  gfx::Image other(gt::CreateBitmap(25, 25));
+  EXPECT_NE(image1.ToGdkPixbuf(), other.ToGdkPixbuf());
+}
+
 TEST_F(ImageTest, SkiaToCairoCreatesGdk) {
   gfx::Image image(gt::CreateBitmap(25, 25));
   EXPECT_FALSE(image.HasRepresentation(gfx::Image::kImageRepGdk));
@@ -298,6 +341,44 @@ TEST_F(ImageTest, RemoveFromMultiResolutionImage) {
   EXPECT_EQ(0u, image_skia.bitmaps().size());
 }
 
+TEST_F(ImageTest, SourceGeneratesEachScaleOnce) {
+  int count = 0;
+  gfx::ImageSkia image_skia(new CountingImageSource(&count),
+                            gfx::Size(10, 12));
+  EXPECT_EQ(10, image_skia.width());
+  EXPECT_EQ(0, count);
+
+  float scale_factor;
+  const SkBitmap& bitmap1_5x = image_skia.GetBitmapForScale(1.5f,
+                                                            &scale_factor);
+  EXPECT_EQ(1.5f, scale_factor);
+  EXPECT_EQ(15, bitmap1_5x.width());
+  EXPECT_EQ(18, bitmap1_5x.height());
+  EXPECT_EQ(1, count);
+
+  // Copies share the generated bitmaps.
+  gfx::ImageSkia copy(image_skia);
+  EXPECT_TRUE(copy.HasBitmapForScale(1.5f));
+  copy.GetBitmapForScale(1.5f, &scale_factor);
+  EXPECT_EQ(1, count);
+
+  EXPECT_EQ(10, image_skia.bitmap()->width());
+  EXPECT_EQ(2, count);
+  EXPECT_EQ(2u, image_skia.bitmaps().size());
+
+  // Added bitmaps are used over generating them.
+  image_skia.AddBitmapForScale(gt::CreateBitmap(20, 24), 2.0f);
+  EXPECT_EQ(20, image_skia.GetBitmapForScale(2.0f, &scale_factor).width());
+  EXPECT_EQ(2, count);
+
+  // Purged bitmaps are generated again.
+  gfx::ImageSkia::PurgeGeneratedBitmaps();
+  EXPECT_FALSE(image_skia.HasBitmapForScale(1.5f));
+  EXPECT_EQ(1u, image_skia.bitmaps().size());
+  image_skia.GetBitmapForScale(1.5f, &scale_factor);
+  EXPECT_EQ(3, count);
+}
+
 // Tests that gfx::Image does indeed take ownership of the SkBitmap it is
 // passed.
 TEST_F(ImageTest, OwnershipTest) {
@@ -310,6 +391,38 @@ TEST_F(ImageTest, OwnershipTest) {
   EXPECT_TRUE(!image.ToSkBitmap()->isNull());
 }
 
+TEST_F(ImageTest, PNGBytes) {
+  gfx::Image image(gt::CreateBitmap(25, 30));
+  scoped_refptr<base::RefCountedMemory> png = image.ToPNGBytes();
+  ASSERT_TRUE(png.get());
+
+  // The encoding is kept with the image and its copies.
+  gfx::Image copy(image);
+  EXPECT_EQ(png.get(), copy.ToPNGBytes().get());
+
+  SkBitmap decoded;
+  ASSERT_TRUE(gfx::PNGCodec::Decode(png->front(), png->size(), &decoded));
+  EXPECT_EQ(25, decoded.width());
+  EXPECT_EQ(30, decoded.height());
+}
+
+TEST_F(ImageTest, PNGBytesAsync) {
+  MessageLoop message_loop;
+  gfx::Image image(gt::CreateBitmap(25, 30));
+
+  scoped_refptr<base::RefCountedMemory> png;
+  image.ToPNGBytesAsync(base::Bind(&StorePNGAndQuit, &png));
+  message_loop.Run();
+  ASSERT_TRUE(png.get());
+  EXPECT_EQ(png.get(), image.ToPNGBytes().get());
+
+  // Once encoded, the data is given out again.
+  scoped_refptr<base::RefCountedMemory> again;
+  image.ToPNGBytesAsync(base::Bind(&StorePNGAndQuit, &again));
+  message_loop.Run();
+  EXPECT_EQ(png.get(), again.get());
+}
+
 // Integration tests with UI toolkit frameworks require linking against the
 // Views library and cannot be here (gfx_unittests doesn't include it). They
 // instead live in /chrome/browser/ui/tests/ui_gfx_image_unittest.cc.
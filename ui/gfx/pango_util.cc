@@ -18,6 +18,7 @@
 #include "base/utf_string_conversions.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/font.h"
+#include "ui/gfx/font_fallback_warmer_linux.h"
 #include "ui/gfx/font_render_params_linux.h"
 #include "ui/gfx/platform_font_pango.h"
 #include "ui/gfx/rect.h"
@@ -283,6 +284,7 @@ void SetupPangoLayout(PangoLayout* layout,
 
   ScopedPangoFontDescription desc(font.GetNativeFont());
   pango_layout_set_font_description(layout, desc.get());
+  FontFallbackWarmer::GetInstance()->WarmForText(font.GetFontName(), text);
 }
 
 void SetupPangoLayoutWithFontDescription(
@@ -297,6 +299,9 @@ void SetupPangoLayoutWithFontDescription(
   ScopedPangoFontDescription desc(
       pango_font_description_from_string(font_description.c_str()));
   pango_layout_set_font_description(layout, desc.get());
+  const char* family = pango_font_description_get_family(desc.get());
+  if (family)
+    FontFallbackWarmer::GetInstance()->WarmForText(family, text);
 }
 
 void AdjustTextRectBasedOnLayout(PangoLayout* layout,
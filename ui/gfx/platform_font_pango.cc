@@ -8,11 +8,18 @@
 #include <pango/pango.h>
 
 #include <algorithm>
+#include <map>
 #include <string>
+#include <utility>
 
+#include "base/bind.h"
+#include "base/lazy_instance.h"
+#include "base/location.h"
 #include "base/logging.h"
 #include "base/string_piece.h"
 #include "base/string_split.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/sequenced_worker_pool.h"
 #include "base/utf_string_conversions.h"
 #include "grit/app_locale_settings.h"
 #include "third_party/skia/include/core/SkPaint.h"
@@ -34,6 +41,11 @@ namespace {
 // IsFallbackFontAllowed function in skia/ext/SkFontHost_fontconfig_direct.cpp.
 const char* kFallbackFontFamilyName = "sans";
 
+// The size deltas and styles the resource bundle derives from the default
+// font, which WarmCache() caches.
+const int kWarmedSizeDeltas[] = { -3, -2, -1, 1, 2, 3, 7, 8 };
+const int kWarmedStyles[] = { gfx::Font::NORMAL, gfx::Font::BOLD };
+
 // Returns the available font family that best (in FontConfig's eyes) matches
 // the supplied list of family names.
 std::string FindBestMatchFontFamilyName(
@@ -85,6 +97,167 @@ std::string GetDefaultFont() {
 #endif  // !defined(TOOLKIT_GTK)
 }
 
+// The metrics of a typeface at a size and style.
+struct FontMetrics {
+  FontMetrics()
+      : height_pixels(0),
+        ascent_pixels(0),
+        pango_metrics_inited(false),
+        average_width_pixels(0.0),
+        underline_position_pixels(0.0),
+        underline_thickness_pixels(0.0) {
+  }
+
+  int height_pixels;
+  int ascent_pixels;
+
+  // The Pango metrics are only computed on the UI thread, when first needed.
+  bool pango_metrics_inited;
+  double average_width_pixels;
+  double underline_position_pixels;
+  double underline_thickness_pixels;
+};
+
+// The family, typeface id, size and style of a font.
+typedef std::pair<std::pair<std::string, uint32_t>, std::pair<int, int> >
+    FontMetricsKey;
+
+FontMetricsKey MakeFontMetricsKey(const std::string& family,
+                                  SkTypeface* typeface,
+                                  int size,
+                                  int style) {
+  return std::make_pair(std::make_pair(family, SkTypeface::UniqueID(typeface)),
+                        std::make_pair(size, style));
+}
+
+// Remembers, for the whole process, the typefaces, metrics and best matching
+// family names of the fonts created, so that deriving a font whose size or
+// style was seen before doesn't ask fontconfig, Skia or Pango again. Fonts
+// are created on the UI thread and on the worker that warms the cache, so
+// the cache is guarded by a lock. It isn't bounded: a process only uses a
+// few families, sizes and styles.
+class FontCache {
+ public:
+  FontCache() {
+  }
+
+  // Returns a new reference to the typeface of |family| in |style|, or NULL
+  // if there is none.
+  SkTypeface* CreateTypeface(const std::string& family,
+                             SkTypeface::Style style) {
+    std::pair<std::string, int> key(family, style);
+    {
+      base::AutoLock lock(lock_);
+      std::map<std::pair<std::string, int>, SkTypeface*>::iterator it =
+          typefaces_.find(key);
+      if (it != typefaces_.end()) {
+        SkSafeRef(it->second);
+        return it->second;
+      }
+    }
+
+    SkTypeface* typeface = SkTypeface::CreateFromName(family.c_str(), style);
+    base::AutoLock lock(lock_);
+    // The cache keeps its own reference to the typeface for good.
+    std::pair<std::map<std::pair<std::string, int>, SkTypeface*>::iterator,
+              bool> inserted = typefaces_.insert(std::make_pair(key,
+                                                                typeface));
+    if (inserted.second) {
+      SkSafeRef(typeface);
+    } else {
+      SkSafeUnref(typeface);
+      typeface = inserted.first->second;
+      SkSafeRef(typeface);
+    }
+    return typeface;
+  }
+
+  // Returns FindBestMatchFontFamilyName(|family_names|), where
+  // |family_names_string| is the comma separated list of the names.
+  std::string GetBestMatchFontFamilyName(
+      const std::string& family_names_string) {
+    {
+      base::AutoLock lock(lock_);
+      std::map<std::string, std::string>::const_iterator it =
+          best_matches_.find(family_names_string);
+      if (it != best_matches_.end())
+        return it->second;
+    }
+
+    std::vector<std::string> family_names;
+    base::SplitString(family_names_string, ',', &family_names);
+    std::string font_family = FindBestMatchFontFamilyName(family_names);
+    base::AutoLock lock(lock_);
+    best_matches_[family_names_string] = font_family;
+    return font_family;
+  }
+
+  bool GetMetrics(const FontMetricsKey& key, FontMetrics* metrics) {
+    base::AutoLock lock(lock_);
+    std::map<FontMetricsKey, FontMetrics>::const_iterator it =
+        metrics_.find(key);
+    if (it == metrics_.end())
+      return false;
+    *metrics = it->second;
+    return true;
+  }
+
+  void PutMetrics(const FontMetricsKey& key, const FontMetrics& metrics) {
+    base::AutoLock lock(lock_);
+    metrics_[key] = metrics;
+  }
+
+ private:
+  // The typefaces by family and SkTypeface::Style.
+  std::map<std::pair<std::string, int>, SkTypeface*> typefaces_;
+
+  // The best matching family for comma separated lists of families.
+  std::map<std::string, std::string> best_matches_;
+
+  std::map<FontMetricsKey, FontMetrics> metrics_;
+
+  base::Lock lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(FontCache);
+};
+
+base::LazyInstance<FontCache>::Leaky g_font_cache = LAZY_INSTANCE_INITIALIZER;
+
+// One worker is enough: the cache is warmed once, in the background.
+class FontCacheWorkerPool {
+ public:
+  FontCacheWorkerPool()
+      : pool_(new base::SequencedWorkerPool(1, "FontCacheWarmer")),
+        task_runner_(pool_->GetTaskRunnerWithShutdownBehavior(
+            base::SequencedWorkerPool::CONTINUE_ON_SHUTDOWN)) {
+  }
+
+  base::TaskRunner* task_runner() { return task_runner_.get(); }
+
+ private:
+  scoped_refptr<base::SequencedWorkerPool> pool_;
+  scoped_refptr<base::TaskRunner> task_runner_;
+
+  DISALLOW_COPY_AND_ASSIGN(FontCacheWorkerPool);
+};
+
+base::LazyInstance<FontCacheWorkerPool>::Leaky g_font_cache_worker_pool =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Creates the fonts WarmCache() caches, throwing them away. Runs on a worker.
+void WarmFontCache(const std::string& family_names, int size) {
+  std::string family =
+      g_font_cache.Get().GetBestMatchFontFamilyName(family_names);
+  gfx::Font font(family, size);
+  for (size_t i = 0; i < arraysize(kWarmedStyles); ++i) {
+    font.DeriveFont(0, kWarmedStyles[i]);
+    for (size_t j = 0; j < arraysize(kWarmedSizeDeltas); ++j) {
+      if (size + kWarmedSizeDeltas[j] > 0)
+        font.DeriveFont(kWarmedSizeDeltas[j], kWarmedStyles[i]);
+    }
+  }
+}
+
 }  // namespace
 
 namespace gfx {
@@ -110,10 +283,8 @@ PlatformFontPango::PlatformFontPango() {
 }
 
 PlatformFontPango::PlatformFontPango(NativeFont native_font) {
-  std::vector<std::string> family_names;
-  base::SplitString(pango_font_description_get_family(native_font), ',',
-                    &family_names);
-  std::string font_family = FindBestMatchFontFamilyName(family_names);
+  std::string font_family = g_font_cache.Get().GetBestMatchFontFamilyName(
+      pango_font_description_get_family(native_font));
   InitWithNameAndSize(font_family, gfx::GetPangoFontSizeInPixels(native_font));
 
   int style = 0;
@@ -154,6 +325,18 @@ void PlatformFontPango::ReloadDefaultFont() {
   default_font_ = NULL;
 }
 
+// static
+void PlatformFontPango::WarmCache() {
+  // The default font and the resolution are read from GTK on this thread.
+  ScopedPangoFontDescription desc(
+      pango_font_description_from_string(GetDefaultFont().c_str()));
+  g_font_cache_worker_pool.Get().task_runner()->PostTask(
+      FROM_HERE,
+      base::Bind(&WarmFontCache,
+                 std::string(pango_font_description_get_family(desc.get())),
+                 static_cast<int>(gfx::GetPangoFontSizeInPixels(desc.get()))));
+}
+
 Font PlatformFontPango::DeriveFont(int size_delta, int style) const {
   // If the delta is negative, if must not push the size below 1
   if (size_delta < 0)
@@ -174,9 +357,8 @@ Font PlatformFontPango::DeriveFont(int size_delta, int style) const {
   if (gfx::Font::ITALIC & style)
     skstyle |= SkTypeface::kItalic;
 
-  SkTypeface* typeface = SkTypeface::CreateFromName(
-      font_family_.c_str(),
-      static_cast<SkTypeface::Style>(skstyle));
+  SkTypeface* typeface = g_font_cache.Get().CreateTypeface(
+      font_family_, static_cast<SkTypeface::Style>(skstyle));
   SkAutoUnref tf_helper(typeface);
 
   return Font(new PlatformFontPango(typeface,
@@ -266,12 +448,12 @@ void PlatformFontPango::InitWithNameAndSize(const std::string& font_name,
   DCHECK_GT(font_size, 0);
   std::string fallback;
 
-  SkTypeface* typeface = SkTypeface::CreateFromName(
-      font_name.c_str(), SkTypeface::kNormal);
+  SkTypeface* typeface = g_font_cache.Get().CreateTypeface(
+      font_name, SkTypeface::kNormal);
   if (!typeface) {
     // A non-scalable font such as .pcf is specified. Falls back to a default
     // scalable font.
-    typeface = SkTypeface::CreateFromName(
+    typeface = g_font_cache.Get().CreateTypeface(
         kFallbackFontFamilyName, SkTypeface::kNormal);
     CHECK(typeface) << "Could not find any font: "
                     << font_name
@@ -297,18 +479,28 @@ void PlatformFontPango::InitWithTypefaceNameSizeAndStyle(
   font_family_ = font_family;
   font_size_pixels_ = font_size;
   style_ = style;
-  pango_metrics_inited_ = false;
-  average_width_pixels_ = 0.0f;
-  underline_position_pixels_ = 0.0f;
-  underline_thickness_pixels_ = 0.0f;
-
-  SkPaint paint;
-  SkPaint::FontMetrics metrics;
-  PaintSetup(&paint);
-  paint.getFontMetrics(&metrics);
-
-  ascent_pixels_ = SkScalarCeil(-metrics.fAscent);
-  height_pixels_ = ascent_pixels_ + SkScalarCeil(metrics.fDescent);
+
+  FontMetricsKey key(MakeFontMetricsKey(font_family_, typeface_,
+                                        font_size_pixels_, style_));
+  FontMetrics cached;
+  if (!g_font_cache.Get().GetMetrics(key, &cached)) {
+    SkPaint paint;
+    SkPaint::FontMetrics metrics;
+    PaintSetup(&paint);
+    paint.getFontMetrics(&metrics);
+
+    cached.ascent_pixels = SkScalarCeil(-metrics.fAscent);
+    cached.height_pixels =
+        cached.ascent_pixels + SkScalarCeil(metrics.fDescent);
+    g_font_cache.Get().PutMetrics(key, cached);
+  }
+
+  ascent_pixels_ = cached.ascent_pixels;
+  height_pixels_ = cached.height_pixels;
+  pango_metrics_inited_ = cached.pango_metrics_inited;
+  average_width_pixels_ = cached.average_width_pixels;
+  underline_position_pixels_ = cached.underline_position_pixels;
+  underline_thickness_pixels_ = cached.underline_thickness_pixels;
 }
 
 void PlatformFontPango::InitFromPlatformFont(const PlatformFontPango* other) {
@@ -366,6 +558,17 @@ void PlatformFontPango::InitPangoMetrics() {
         ASCIIToUTF16("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"));
     const double dialog_units_pixels = (text_width_pixels / 26 + 1) / 2;
     average_width_pixels_ = std::min(pango_width_pixels, dialog_units_pixels);
+
+    FontMetrics metrics;
+    metrics.ascent_pixels = ascent_pixels_;
+    metrics.height_pixels = height_pixels_;
+    metrics.pango_metrics_inited = true;
+    metrics.average_width_pixels = average_width_pixels_;
+    metrics.underline_position_pixels = underline_position_pixels_;
+    metrics.underline_thickness_pixels = underline_thickness_pixels_;
+    g_font_cache.Get().PutMetrics(
+        MakeFontMetricsKey(font_family_, typeface_, font_size_pixels_, style_),
+        metrics);
   }
 }
 
@@ -31,6 +31,11 @@ class UI_EXPORT PlatformFontPango : public PlatformFont {
   // the locale has changed.
   static void ReloadDefaultFont();
 
+  // Fills the process-wide font cache with the typefaces and metrics of the
+  // default font at the sizes and styles the resource bundle derives from it,
+  // on a worker thread. Call once at startup, on the UI thread.
+  static void WarmCache();
+
   // Position as an offset from the height of the drawn text, used to draw
   // an underline. This is a negative number, so the underline would be
   // drawn at y + height + underline_position;
@@ -68,6 +73,8 @@ class UI_EXPORT PlatformFontPango : public PlatformFont {
   void InitFromPlatformFont(const PlatformFontPango* other);
 
   // Potentially slow call to get pango metrics (average width, underline info).
+  // The metrics are shared by all the fonts with the same typeface, family,
+  // size and style.
   void InitPangoMetrics();
 
   // Setup a Skia context to use the current typeface
@@ -8,6 +8,7 @@
 
 #include "base/memory/ref_counted.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "ui/gfx/font.h"
 #include "ui/gfx/pango_util.h"
 
 namespace gfx {
@@ -37,4 +38,20 @@ TEST(PlatformFontPangoTest, MAYBE_FamilyList) {
   EXPECT_EQ(15, font2->GetFontSize());
 }
 
+// Fonts derived again from the cache have the metrics of the first ones.
+TEST(PlatformFontPangoTest, DeriveFontFromCache) {
+  scoped_refptr<gfx::PlatformFontPango> font(
+      new gfx::PlatformFontPango("sans", 13));
+  Font bold = font->DeriveFont(2, Font::BOLD);
+  EXPECT_EQ(15, bold.GetFontSize());
+  EXPECT_EQ(Font::BOLD, bold.GetStyle());
+
+  Font bold_again = font->DeriveFont(2, Font::BOLD);
+  EXPECT_EQ(bold.GetFontName(), bold_again.GetFontName());
+  EXPECT_EQ(bold.GetHeight(), bold_again.GetHeight());
+  EXPECT_EQ(bold.GetBaseline(), bold_again.GetBaseline());
+  EXPECT_EQ(bold.GetAverageCharacterWidth(),
+            bold_again.GetAverageCharacterWidth());
+}
+
 }  // namespace gfx
@@ -5,9 +5,12 @@
 #include "ui/gfx/render_text.h"
 
 #include <algorithm>
+#include <map>
 
 #include "base/i18n/break_iterator.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/memory/arena.h"
 #include "base/stl_util.h"
 #include "third_party/skia/include/core/SkTypeface.h"
 #include "third_party/skia/include/effects/SkGradientShader.h"
@@ -21,6 +24,7 @@ namespace {
 // All chars are replaced by this char when the password style is set.
 // TODO(benrg): GTK uses the first of U+25CF, U+2022, U+2731, U+273A, '*'
 // that's available in the font (find_invisible_char() in gtkentry.c).
+// RenderTextLinux maps the obscured text as one UTF-8 byte per character.
 const char16 kPasswordReplacementChar = '*';
 
 // Default color used for the cursor.
@@ -105,6 +109,13 @@ SkTypeface::Style ConvertFontStyleToSkiaTypefaceStyle(int font_style) {
   return static_cast<SkTypeface::Style>(skia_style);
 }
 
+// The typefaces SkiaTextRenderer::SetFontFamilyWithStyle() has looked up, by
+// family and style. Each holds a reference, and may be NULL if the lookup
+// failed. Looking a typeface up by name asks the platform's font system, so
+// it is done once rather than for every run of every paint.
+typedef std::map<std::pair<std::string, int>, SkTypeface*> TypefaceMap;
+base::LazyInstance<TypefaceMap>::Leaky g_typefaces = LAZY_INSTANCE_INITIALIZER;
+
 // Given |font| and |display_width|, returns the width of the fade gradient.
 int CalculateFadeGradientWidth(const gfx::Font& font, int display_width) {
   // Fade in/out about 2.5 characters of the beginning/end of the string.
@@ -123,8 +134,8 @@ void AddFadeEffect(const gfx::Rect& text_rect,
                    const gfx::Rect& fade_rect,
                    SkColor c0,
                    SkColor c1,
-                   std::vector<SkScalar>* positions,
-                   std::vector<SkColor>* colors) {
+                   base::ArenaVector<SkScalar>::Type* positions,
+                   base::ArenaVector<SkColor>::Type* colors) {
   const SkScalar left = static_cast<SkScalar>(fade_rect.x() - text_rect.x());
   const SkScalar width = static_cast<SkScalar>(fade_rect.width());
   const SkScalar p0 = left / text_rect.width();
@@ -148,8 +159,13 @@ SkShader* CreateFadeShader(const gfx::Rect& text_rect,
                            SkColor color) {
   // Fade alpha of 51/255 corresponds to a fade of 0.2 of the original color.
   const SkColor fade_color = SkColorSetA(color, 51);
-  std::vector<SkScalar> positions;
-  std::vector<SkColor> colors;
+  base::ScopedArenaFrame frame(base::Arena::GetForCurrentThread());
+  base::ArenaVector<SkScalar>::Type positions(
+      base::ArenaAllocator<SkScalar>(frame.arena()));
+  base::ArenaVector<SkColor>::Type colors(
+      base::ArenaAllocator<SkColor>(frame.arena()));
+  positions.reserve(6);
+  colors.reserve(6);
 
   if (!left_part.IsEmpty())
     AddFadeEffect(text_rect, left_part, fade_color, color,
@@ -236,8 +252,14 @@ void SkiaTextRenderer::SetFontFamilyWithStyle(const std::string& family,
   DCHECK(!family.empty());
 
   SkTypeface::Style skia_style = ConvertFontStyleToSkiaTypefaceStyle(style);
-  SkTypeface* typeface = SkTypeface::CreateFromName(family.c_str(), skia_style);
-  SkAutoUnref auto_unref(typeface);
+  TypefaceMap& typefaces = g_typefaces.Get();
+  TypefaceMap::key_type key(family, skia_style);
+  TypefaceMap::iterator i = typefaces.find(key);
+  if (i == typefaces.end()) {
+    i = typefaces.insert(std::make_pair(
+        key, SkTypeface::CreateFromName(family.c_str(), skia_style))).first;
+  }
+  SkTypeface* typeface = i->second;
   if (typeface) {
     // |paint_| adds its own ref. So don't |release()| it from the ref ptr here.
     SetTypeface(typeface);
@@ -362,7 +384,31 @@ RenderText::~RenderText() {
 void RenderText::SetText(const string16& text) {
   DCHECK(!composition_range_.IsValid());
   size_t old_text_length = text_.length();
+
+  // Find what changed for the index map and the word breaker; ReplaceText()
+  // already knows.
+  size_t common_length = std::min(old_text_length, text.length());
+  size_t common_prefix = 0;
+  while (common_prefix < common_length &&
+         text_[common_prefix] == text[common_prefix])
+    ++common_prefix;
+  size_t common_suffix = 0;
+  if (word_breaker_.get()) {
+    while (common_suffix < common_length - common_prefix &&
+           text_[old_text_length - common_suffix - 1] ==
+               text[text.length() - common_suffix - 1])
+      ++common_suffix;
+  }
+
   text_ = text;
+  text_index_map_.Invalidate(common_prefix);
+
+  if (word_breaker_.get() &&
+      !word_breaker_->TextChanged(
+          common_prefix, old_text_length - common_prefix - common_suffix,
+          text_.length() - common_prefix - common_suffix)) {
+    word_breaker_.reset();
+  }
 
   // Update the style ranges as needed.
   if (text_.empty()) {
@@ -397,6 +443,65 @@ void RenderText::SetText(const string16& text) {
   ResetLayout();
 }
 
+void RenderText::ReplaceText(const ui::Range& range, const string16& text) {
+  DCHECK(!composition_range_.IsValid());
+  size_t start = range.GetMin();
+  size_t old_end = range.GetMax();
+  DCHECK_LE(old_end, text_.length());
+  size_t old_length = old_end - start;
+  size_t new_end = start + text.length();
+
+  text_.replace(start, old_length, text);
+  text_index_map_.Invalidate(start);
+
+  if (word_breaker_.get() &&
+      !word_breaker_->TextChanged(start, old_length, text.length())) {
+    word_breaker_.reset();
+  }
+
+  // Move the boundaries between style ranges with the text: those after the
+  // edit shift by the change in length, and those before it stay.  Those at
+  // the start of the edit or in the replaced text move to the end of the new
+  // text, so it belongs to the range the character before it is in.
+  if (text_.empty()) {
+    style_ranges_.clear();
+  } else if (style_ranges_.empty()) {
+    ApplyDefaultStyle();
+  } else {
+    StyleRanges::iterator i = style_ranges_.begin();
+    while (i != style_ranges_.end()) {
+      size_t range_start = i->range.start();
+      size_t range_end = i->range.end();
+      if (range_start >= old_end)
+        range_start = range_start - old_length + text.length();
+      else if (range_start >= start)
+        range_start = new_end;
+      if (range_end >= old_end)
+        range_end = range_end - old_length + text.length();
+      else if (range_end >= start)
+        range_end = new_end;
+      if (i == style_ranges_.begin())
+        range_start = 0;
+      if (i + 1 == style_ranges_.end())
+        range_end = text_.length();
+      if (range_start == range_end) {
+        i = style_ranges_.erase(i);
+      } else {
+        i->range = ui::Range(range_start, range_end);
+        ++i;
+      }
+    }
+  }
+#ifndef NDEBUG
+  CheckStyleRanges(style_ranges_, text_.length());
+#endif
+  cached_bounds_and_offset_valid_ = false;
+
+  SetSelectionModel(SelectionModel());
+
+  ResetLayout();
+}
+
 void RenderText::SetHorizontalAlignment(HorizontalAlignment alignment) {
   if (horizontal_alignment_ != alignment) {
     horizontal_alignment_ = alignment;
@@ -538,16 +643,15 @@ void RenderText::SelectWord() {
 
   size_t cursor_pos = cursor_position();
 
-  base::i18n::BreakIterator iter(text(), base::i18n::BreakIterator::BREAK_WORD);
-  bool success = iter.Init();
-  DCHECK(success);
-  if (!success)
+  base::i18n::BreakIterator* iter = GetWordBreaker();
+  DCHECK(iter);
+  if (!iter)
     return;
 
   size_t selection_start = cursor_pos;
   for (; selection_start != 0; --selection_start) {
-    if (iter.IsStartOfWord(selection_start) ||
-        iter.IsEndOfWord(selection_start))
+    if (iter->IsStartOfWord(selection_start) ||
+        iter->IsEndOfWord(selection_start))
       break;
   }
 
@@ -555,7 +659,7 @@ void RenderText::SelectWord() {
     ++cursor_pos;
 
   for (; cursor_pos < text().length(); ++cursor_pos)
-    if (iter.IsEndOfWord(cursor_pos) || iter.IsStartOfWord(cursor_pos))
+    if (iter->IsEndOfWord(cursor_pos) || iter->IsStartOfWord(cursor_pos))
       break;
 
   MoveCursorTo(selection_start, false);
@@ -604,6 +708,9 @@ VisualCursorDirection RenderText::GetVisualDirectionOfLogicalEnd() {
 }
 
 void RenderText::Draw(Canvas* canvas) {
+  // The scratch vectors of drawing come from the arena of the thread, which
+  // is reset once the outermost draw or paint returns.
+  base::ScopedArenaFrame frame(base::Arena::GetForCurrentThread());
   EnsureLayout();
 
   gfx::Rect clip_rect(display_rect());
@@ -715,6 +822,16 @@ RenderText::RenderText()
       cached_bounds_and_offset_valid_(false) {
 }
 
+base::i18n::BreakIterator* RenderText::GetWordBreaker() {
+  if (!word_breaker_.get()) {
+    word_breaker_.reset(new base::i18n::BreakIterator(
+        text_, base::i18n::BreakIterator::BREAK_WORD));
+    if (!word_breaker_->InitIncremental())
+      word_breaker_.reset();
+  }
+  return word_breaker_.get();
+}
+
 const Point& RenderText::GetUpdatedDisplayOffset() {
   UpdateCachedBoundsAndOffset();
   return display_offset_;
@@ -751,7 +868,7 @@ string16 RenderText::GetDisplayText() const {
   if (!obscured_)
     return text_;
   size_t obscured_text_length =
-      static_cast<size_t>(ui::UTF16IndexToOffset(text_, 0, text_.length()));
+      text_index_map_.IndexToOffset(text_, text_.length());
   return string16(obscured_text_length, kPasswordReplacementChar);
 }
 
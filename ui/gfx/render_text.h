@@ -14,10 +14,12 @@
 
 #include "base/gtest_prod_util.h"
 #include "base/i18n/rtl.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/string16.h"
 #include "third_party/skia/include/core/SkColor.h"
 #include "third_party/skia/include/core/SkPaint.h"
 #include "ui/base/range/range.h"
+#include "ui/base/text/utf16_indexing.h"
 #include "ui/gfx/font_list.h"
 #include "ui/gfx/point.h"
 #include "ui/gfx/rect.h"
@@ -30,6 +32,12 @@ struct SkPoint;
 class SkShader;
 class SkTypeface;
 
+namespace base {
+namespace i18n {
+class BreakIterator;
+}
+}
+
 namespace gfx {
 
 class Canvas;
@@ -122,6 +130,13 @@ class UI_EXPORT RenderText {
   const string16& text() const { return text_; }
   void SetText(const string16& text);
 
+  // Replaces the characters in |range| with |text|.  Unlike SetText(), this
+  // splices the text in place and knows what changed without comparing the
+  // old and new text, and the style ranges move with the text after the
+  // edit; inserted text takes the style of the character before it.  Like
+  // SetText(), the selection is reset.
+  void ReplaceText(const ui::Range& range, const string16& text);
+
   HorizontalAlignment horizontal_alignment() const {
     return horizontal_alignment_;
   }
@@ -303,6 +318,10 @@ class UI_EXPORT RenderText {
 
   const StyleRanges& style_ranges() const { return style_ranges_; }
 
+  // Returns a BREAK_WORD iterator over text() in incremental mode, or NULL if
+  // ICU fails.  SetText() re-breaks only the part of the text that changed.
+  base::i18n::BreakIterator* GetWordBreaker();
+
   // Get the selection model that visually neighbors |position| by |break_type|.
   // The returned value represents a cursor/caret position without a selection.
   SelectionModel GetAdjacentSelectionModel(const SelectionModel& current,
@@ -359,6 +378,10 @@ class UI_EXPORT RenderText {
   // obscured field.
   string16 GetDisplayText() const;
 
+  // Converts between indices into text(), code point offsets and UTF-8 byte
+  // offsets, from checkpoints kept until the text is edited.
+  ui::UTF16IndexMap* text_index_map() const { return &text_index_map_; }
+
   // Apply composition style (underline) to composition range and selection
   // style (foreground) to selection range.
   void ApplyCompositionAndSelectionStyles(StyleRanges* style_ranges);
@@ -401,6 +424,7 @@ class UI_EXPORT RenderText {
   FRIEND_TEST_ALL_PREFIXES(RenderTextTest, CustomDefaultStyle);
   FRIEND_TEST_ALL_PREFIXES(RenderTextTest, ApplyStyleRange);
   FRIEND_TEST_ALL_PREFIXES(RenderTextTest, StyleRangesAdjust);
+  FRIEND_TEST_ALL_PREFIXES(RenderTextTest, ReplaceText);
   FRIEND_TEST_ALL_PREFIXES(RenderTextTest, PasswordCensorship);
   FRIEND_TEST_ALL_PREFIXES(RenderTextTest, GraphemePositions);
   FRIEND_TEST_ALL_PREFIXES(RenderTextTest, EdgeSelectionModels);
@@ -470,6 +494,9 @@ class UI_EXPORT RenderText {
   // True if this is an obscured (password) field.
   bool obscured_;
 
+  // The index map of |text_|, invalidated wherever the text is edited.
+  mutable ui::UTF16IndexMap text_index_map_;
+
   // Fade text head and/or tail, if text doesn't fit into |display_rect_|.
   bool fade_head_;
   bool fade_tail_;
@@ -491,6 +518,9 @@ class UI_EXPORT RenderText {
   // Text shadows to be drawn.
   ShadowValues text_shadows_;
 
+  // Made by GetWordBreaker() on first use.
+  scoped_ptr<base::i18n::BreakIterator> word_breaker_;
+
   DISALLOW_COPY_AND_ASSIGN(RenderText);
 };
 
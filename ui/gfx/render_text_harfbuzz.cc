@@ -0,0 +1,804 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/render_text_harfbuzz.h"
+
+#include <algorithm>
+#include <map>
+
+#include "base/i18n/bidi_line_iterator.h"
+#include "base/i18n/break_iterator.h"
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/memory/mru_cache.h"
+#include "third_party/harfbuzz-ng/src/hb.h"
+#include "third_party/harfbuzz-ng/src/hb-icu.h"
+#include "third_party/skia/include/core/SkTypeface.h"
+#include "ui/gfx/canvas.h"
+#include "ui/gfx/font.h"
+#include "unicode/utf16.h"
+
+namespace gfx {
+
+namespace {
+
+// The character obscured text is laid out with, as in RenderText.
+const char16 kPasswordReplacementChar = '*';
+
+// The number of shaped words kept in the word cache. A word takes about a
+// hundred bytes, so this bounds the cache to a few hundred kilobytes.
+const size_t kMaxCachedWords = 4096;
+
+// HarfBuzz positions are 16.16 fixed point values when the scale of the font
+// is its size in pixels, shifted by 16 bits.
+hb_position_t SkiaScalarToHarfBuzzPosition(SkScalar value) {
+  return SkScalarToFixed(value);
+}
+
+SkScalar HarfBuzzPositionToSkiaScalar(hb_position_t value) {
+  return SkFixedToScalar(value);
+}
+
+SkTypeface::Style ConvertFontStyleToSkiaTypefaceStyle(int font_style) {
+  int skia_style = SkTypeface::kNormal;
+  if (font_style & Font::BOLD)
+    skia_style |= SkTypeface::kBold;
+  if (font_style & Font::ITALIC)
+    skia_style |= SkTypeface::kItalic;
+  return static_cast<SkTypeface::Style>(skia_style);
+}
+
+// The HarfBuzz font functions, which HarfBuzz calls back with the SkPaint
+// that a HarfBuzz font was created with as |font_data|.
+hb_bool_t GetGlyph(hb_font_t* font,
+                   void* font_data,
+                   hb_codepoint_t unicode,
+                   hb_codepoint_t variation_selector,
+                   hb_codepoint_t* glyph,
+                   void* user_data) {
+  SkPaint* paint = reinterpret_cast<SkPaint*>(font_data);
+  paint->setTextEncoding(SkPaint::kUTF32_TextEncoding);
+  uint16 glyph_id = 0;
+  paint->textToGlyphs(&unicode, sizeof(hb_codepoint_t), &glyph_id);
+  *glyph = glyph_id;
+  return glyph_id != 0;
+}
+
+hb_position_t GetGlyphHorizontalAdvance(hb_font_t* font,
+                                        void* font_data,
+                                        hb_codepoint_t glyph,
+                                        void* user_data) {
+  SkPaint* paint = reinterpret_cast<SkPaint*>(font_data);
+  paint->setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+  uint16 glyph_id = glyph;
+  SkScalar advance = 0;
+  paint->getTextWidths(&glyph_id, sizeof(glyph_id), &advance);
+  return SkiaScalarToHarfBuzzPosition(advance);
+}
+
+hb_bool_t GetGlyphExtents(hb_font_t* font,
+                          void* font_data,
+                          hb_codepoint_t glyph,
+                          hb_glyph_extents_t* extents,
+                          void* user_data) {
+  SkPaint* paint = reinterpret_cast<SkPaint*>(font_data);
+  paint->setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+  uint16 glyph_id = glyph;
+  SkScalar advance = 0;
+  SkRect bounds;
+  paint->getTextWidths(&glyph_id, sizeof(glyph_id), &advance, &bounds);
+  // HarfBuzz's Y axis points up, Skia's down.
+  extents->x_bearing = SkiaScalarToHarfBuzzPosition(bounds.fLeft);
+  extents->y_bearing = SkiaScalarToHarfBuzzPosition(-bounds.fTop);
+  extents->width = SkiaScalarToHarfBuzzPosition(bounds.width());
+  extents->height = SkiaScalarToHarfBuzzPosition(-bounds.height());
+  return true;
+}
+
+hb_font_funcs_t* GetFontFuncs() {
+  static hb_font_funcs_t* font_funcs = NULL;
+  if (!font_funcs) {
+    font_funcs = hb_font_funcs_create();
+    hb_font_funcs_set_glyph_func(font_funcs, GetGlyph, NULL, NULL);
+    hb_font_funcs_set_glyph_h_advance_func(
+        font_funcs, GetGlyphHorizontalAdvance, NULL, NULL);
+    hb_font_funcs_set_glyph_extents_func(
+        font_funcs, GetGlyphExtents, NULL, NULL);
+    hb_font_funcs_make_immutable(font_funcs);
+  }
+  return font_funcs;
+}
+
+void DeleteTableData(void* data) {
+  delete[] static_cast<char*>(data);
+}
+
+// Reads the font table |tag| of the SkTypeface |user_data| for HarfBuzz.
+hb_blob_t* GetFontTable(hb_face_t* face, hb_tag_t tag, void* user_data) {
+  SkTypeface* typeface = reinterpret_cast<SkTypeface*>(user_data);
+  const size_t table_size = typeface->getTableSize(tag);
+  if (!table_size)
+    return NULL;
+  char* data = new char[table_size];
+  typeface->getTableData(tag, 0, table_size, data);
+  return hb_blob_create(data, table_size, HB_MEMORY_MODE_WRITABLE, data,
+                        DeleteTableData);
+}
+
+// A HarfBuzz font and the SkPaint its font functions measure glyphs with.
+struct HarfBuzzFont {
+  SkPaint paint;
+  hb_face_t* face;
+  hb_font_t* font;
+};
+
+// The HarfBuzz fonts made so far, by family, Font::FontStyle and size. NULL
+// if the family couldn't be found. They are never released.
+typedef std::map<std::pair<std::string, std::pair<int, int> >, HarfBuzzFont*>
+    HarfBuzzFontMap;
+base::LazyInstance<HarfBuzzFontMap>::Leaky g_harfbuzz_fonts =
+    LAZY_INSTANCE_INITIALIZER;
+
+HarfBuzzFont* GetHarfBuzzFont(const Font& font, int font_style) {
+  HarfBuzzFontMap& fonts = g_harfbuzz_fonts.Get();
+  HarfBuzzFontMap::key_type key(font.GetFontName(),
+                                std::make_pair(font_style,
+                                               font.GetFontSize()));
+  HarfBuzzFontMap::iterator it = fonts.find(key);
+  if (it != fonts.end())
+    return it->second;
+
+  SkTypeface::Style skia_style = ConvertFontStyleToSkiaTypefaceStyle(
+      font_style);
+  SkTypeface* typeface = SkTypeface::CreateFromName(
+      font.GetFontName().c_str(), skia_style);
+  if (!typeface)
+    typeface = SkTypeface::CreateFromName(NULL, skia_style);
+  HarfBuzzFont* harfbuzz_font = NULL;
+  if (typeface) {
+    harfbuzz_font = new HarfBuzzFont;
+    // The paint keeps the typeface alive for the face.
+    harfbuzz_font->paint.setTypeface(typeface);
+    typeface->unref();
+    harfbuzz_font->paint.setTextSize(SkIntToScalar(font.GetFontSize()));
+    harfbuzz_font->face = hb_face_create_for_tables(GetFontTable, typeface,
+                                                    NULL);
+    harfbuzz_font->font = hb_font_create(harfbuzz_font->face);
+    hb_font_set_funcs(harfbuzz_font->font, GetFontFuncs(),
+                      &harfbuzz_font->paint, NULL);
+    const hb_position_t scale =
+        SkiaScalarToHarfBuzzPosition(SkIntToScalar(font.GetFontSize()));
+    hb_font_set_scale(harfbuzz_font->font, scale, scale);
+  }
+  fonts[key] = harfbuzz_font;
+  return harfbuzz_font;
+}
+
+// A word shaped on its own, with the spaces that follow it.
+struct ShapedWord {
+  // The glyphs in visual order, their pen positions and offsets, and the
+  // index of the first character of their cluster in the word.
+  std::vector<uint16> glyphs;
+  std::vector<SkScalar> glyph_x;
+  std::vector<SkPoint> offsets;
+  std::vector<uint32> clusters;
+  SkScalar width;
+};
+
+// Everything shaping a word depends on.
+struct ShapedWordKey {
+  bool operator<(const ShapedWordKey& other) const {
+    if (font != other.font)
+      return font < other.font;
+    if (script != other.script)
+      return script < other.script;
+    if (is_rtl != other.is_rtl)
+      return is_rtl < other.is_rtl;
+    return text < other.text;
+  }
+
+  const HarfBuzzFont* font;
+  UScriptCode script;
+  bool is_rtl;
+  string16 text;
+};
+
+// The words shaped recently, for all RenderTextHarfBuzz instances. Only used
+// on the UI thread.
+struct ShapedWordCache {
+  ShapedWordCache() : words(kMaxCachedWords), lookups(0), misses(0) {}
+
+  base::OwningMRUCache<ShapedWordKey, ShapedWord*> words;
+  int lookups;
+  int misses;
+};
+
+base::LazyInstance<ShapedWordCache>::Leaky g_shaped_words =
+    LAZY_INSTANCE_INITIALIZER;
+
+ShapedWord* ShapeWord(const ShapedWordKey& key) {
+  hb_buffer_t* buffer = hb_buffer_create();
+  hb_buffer_set_script(buffer, hb_icu_script_to_script(key.script));
+  hb_buffer_set_direction(buffer,
+                          key.is_rtl ? HB_DIRECTION_RTL : HB_DIRECTION_LTR);
+  hb_buffer_add_utf16(buffer,
+                      reinterpret_cast<const uint16_t*>(key.text.c_str()),
+                      key.text.length(), 0, key.text.length());
+  hb_shape(key.font->font, buffer, NULL, 0);
+
+  unsigned int glyph_count = 0;
+  hb_glyph_info_t* infos = hb_buffer_get_glyph_infos(buffer, &glyph_count);
+  hb_glyph_position_t* positions = hb_buffer_get_glyph_positions(buffer, NULL);
+
+  ShapedWord* word = new ShapedWord;
+  word->glyphs.resize(glyph_count);
+  word->glyph_x.resize(glyph_count);
+  word->offsets.resize(glyph_count);
+  word->clusters.resize(glyph_count);
+  SkScalar x = 0;
+  for (unsigned int i = 0; i < glyph_count; ++i) {
+    word->glyphs[i] = infos[i].codepoint;
+    word->clusters[i] = infos[i].cluster;
+    word->glyph_x[i] = x;
+    word->offsets[i].set(HarfBuzzPositionToSkiaScalar(positions[i].x_offset),
+                         -HarfBuzzPositionToSkiaScalar(positions[i].y_offset));
+    x += HarfBuzzPositionToSkiaScalar(positions[i].x_advance);
+  }
+  word->width = x;
+  hb_buffer_destroy(buffer);
+  return word;
+}
+
+// Returns the shaped word for |key|. The word is owned by the cache, and only
+// valid until the next call.
+const ShapedWord* GetShapedWord(const ShapedWordKey& key) {
+  ShapedWordCache& cache = g_shaped_words.Get();
+  ++cache.lookups;
+  base::OwningMRUCache<ShapedWordKey, ShapedWord*>::iterator it =
+      cache.words.Get(key);
+  if (it != cache.words.end())
+    return it->second;
+  ++cache.misses;
+  return cache.words.Put(key, ShapeWord(key))->second;
+}
+
+// Returns the end of the run of |text| that starts at |start| and is in one
+// script, at most |end|, and sets |script| to that script. Characters of the
+// common and inherited scripts, such as spaces, punctuation and combining
+// marks, take the script of the run they are in.
+size_t ScriptRunEnd(const string16& text,
+                    size_t start,
+                    size_t end,
+                    UScriptCode* script) {
+  *script = USCRIPT_COMMON;
+  size_t pos = start;
+  while (pos < end) {
+    size_t char_start = pos;
+    UChar32 c;
+    U16_NEXT(text.data(), pos, end, c);
+    UErrorCode error = U_ZERO_ERROR;
+    UScriptCode char_script = uscript_getScript(c, &error);
+    if (U_FAILURE(error) || char_script == USCRIPT_COMMON ||
+        char_script == USCRIPT_INHERITED) {
+      continue;
+    }
+    if (*script == USCRIPT_COMMON)
+      *script = char_script;
+    else if (char_script != *script)
+      return char_start;
+  }
+  return end;
+}
+
+// Returns true if the given visual cursor |direction| is logically forward
+// motion in |run|.
+bool IsForwardMotion(VisualCursorDirection direction,
+                     const internal::TextRunHarfBuzz* run) {
+  return run->is_rtl == (direction == CURSOR_LEFT);
+}
+
+}  // namespace
+
+namespace internal {
+
+TextRunHarfBuzz::TextRunHarfBuzz()
+    : foreground(SK_ColorBLACK),
+      font_style(0),
+      strike(false),
+      diagonal_strike(false),
+      underline(false),
+      level(0),
+      is_rtl(false),
+      script(USCRIPT_INVALID_CODE),
+      width(0),
+      preceding_run_widths(0),
+      advance(0) {
+}
+
+TextRunHarfBuzz::~TextRunHarfBuzz() {
+}
+
+size_t TextRunHarfBuzz::GetClusterAt(size_t pos, ui::Range* chars) const {
+  // The cluster starts at the largest cluster index not past |pos|, and ends
+  // at the next one. A cluster's glyphs are adjacent, so the first one found
+  // is the leftmost.
+  size_t cluster_start = 0;
+  size_t cluster_end = range.length();
+  size_t first_glyph = glyphs.size();
+  for (size_t i = 0; i < glyph_to_char.size(); ++i) {
+    size_t cluster = glyph_to_char[i];
+    if (cluster <= pos && (cluster > cluster_start ||
+                           first_glyph == glyphs.size())) {
+      cluster_start = cluster;
+      first_glyph = i;
+    } else if (cluster > pos && cluster < cluster_end) {
+      cluster_end = cluster;
+    }
+  }
+  *chars = ui::Range(cluster_start, cluster_end);
+  return first_glyph;
+}
+
+int TextRunHarfBuzz::GetGlyphXBoundary(size_t text_index,
+                                       bool trailing) const {
+  DCHECK_GE(text_index, range.start());
+  DCHECK_LT(text_index, range.end() + (trailing ? 0 : 1));
+  if (text_index == range.end())
+    return preceding_run_widths + (is_rtl ? 0 : width);
+
+  ui::Range chars;
+  size_t glyph = GetClusterAt(text_index - range.start(), &chars);
+  if (glyph == glyphs.size())
+    return preceding_run_widths;
+
+  // Find the horizontal extent of the cluster's glyphs.
+  size_t last_glyph = glyph;
+  while (last_glyph + 1 < glyphs.size() &&
+         glyph_to_char[last_glyph + 1] == glyph_to_char[glyph]) {
+    ++last_glyph;
+  }
+  SkScalar left = glyph_x[glyph];
+  SkScalar right = last_glyph + 1 < glyphs.size() ?
+      glyph_x[last_glyph + 1] : advance;
+
+  // Split a cluster of several characters, like a ligature, evenly between
+  // them, as Uniscribe's ScriptCPtoX() does.
+  const size_t char_count = std::max<size_t>(chars.length(), 1);
+  const SkScalar char_width = (right - left) / char_count;
+  size_t offset = text_index - range.start() - chars.start();
+  if (trailing)
+    ++offset;
+  SkScalar x = is_rtl ? right - char_width * offset :
+                        left + char_width * offset;
+  return preceding_run_widths + SkScalarRoundToInt(x);
+}
+
+}  // namespace internal
+
+RenderTextHarfBuzz::RenderTextHarfBuzz()
+    : RenderText(),
+      common_baseline_(0),
+      needs_layout_(false) {
+  MoveCursorTo(EdgeSelectionModel(CURSOR_LEFT));
+}
+
+RenderTextHarfBuzz::~RenderTextHarfBuzz() {
+}
+
+base::i18n::TextDirection RenderTextHarfBuzz::GetTextDirection() {
+  // Like Pango, take the direction of the first strong character.
+  return base::i18n::GetFirstStrongCharacterDirection(text());
+}
+
+Size RenderTextHarfBuzz::GetStringSize() {
+  EnsureLayout();
+  return string_size_;
+}
+
+SelectionModel RenderTextHarfBuzz::FindCursorPosition(const Point& point) {
+  if (text().empty())
+    return SelectionModel();
+
+  EnsureLayout();
+  // Find the run that contains the point and adjust the argument location.
+  Point p(ToTextPoint(point));
+  size_t run_index = GetRunContainingPoint(p);
+  if (run_index == runs_.size())
+    return EdgeSelectionModel((p.x() < 0) ? CURSOR_LEFT : CURSOR_RIGHT);
+  internal::TextRunHarfBuzz* run = runs_[run_index];
+
+  // Find the glyph under the point, and whether the point is on its trailing
+  // half.
+  if (run->glyphs.empty())
+    return SelectionModel(run->range.start(), CURSOR_FORWARD);
+  const SkScalar x = SkIntToScalar(p.x() - run->preceding_run_widths);
+  size_t glyph = 0;
+  while (glyph + 1 < run->glyphs.size() && run->glyph_x[glyph + 1] <= x)
+    ++glyph;
+  const SkScalar right = glyph + 1 < run->glyphs.size() ?
+      run->glyph_x[glyph + 1] : run->advance;
+  const bool right_half = x >= (run->glyph_x[glyph] + right) / 2;
+  const bool trailing = right_half != run->is_rtl;
+
+  ui::Range chars;
+  run->GetClusterAt(run->glyph_to_char[glyph], &chars);
+  size_t cursor = run->range.start() + (trailing ? chars.end() : chars.start());
+  DCHECK_LE(cursor, text().length());
+  return SelectionModel(cursor, trailing ? CURSOR_BACKWARD : CURSOR_FORWARD);
+}
+
+std::vector<RenderText::FontSpan> RenderTextHarfBuzz::GetFontSpansForTesting() {
+  EnsureLayout();
+
+  std::vector<RenderText::FontSpan> spans;
+  for (size_t i = 0; i < runs_.size(); ++i)
+    spans.push_back(RenderText::FontSpan(runs_[i]->font, runs_[i]->range));
+
+  return spans;
+}
+
+// static
+void RenderTextHarfBuzz::TakeWordCacheCounts(int* lookups, int* misses) {
+  ShapedWordCache& cache = g_shaped_words.Get();
+  *lookups = cache.lookups;
+  *misses = cache.misses;
+  cache.lookups = 0;
+  cache.misses = 0;
+}
+
+SelectionModel RenderTextHarfBuzz::AdjacentCharSelectionModel(
+    const SelectionModel& selection,
+    VisualCursorDirection direction) {
+  DCHECK(!needs_layout_);
+  internal::TextRunHarfBuzz* run;
+  size_t run_index = GetRunContainingCaret(selection);
+  if (run_index == runs_.size()) {
+    // The cursor is not in any run: we're at the visual and logical edge.
+    SelectionModel edge = EdgeSelectionModel(direction);
+    if (edge.caret_pos() == selection.caret_pos())
+      return edge;
+    run = direction == CURSOR_RIGHT ?
+        runs_[visual_to_logical_.front()] : runs_[visual_to_logical_.back()];
+  } else {
+    // If the cursor is moving within the current run, just move it by one
+    // grapheme in the appropriate direction.
+    run = runs_[run_index];
+    size_t caret = selection.caret_pos();
+    if (IsForwardMotion(direction, run)) {
+      if (caret < run->range.end()) {
+        caret = IndexOfAdjacentGrapheme(caret, CURSOR_FORWARD);
+        return SelectionModel(caret, CURSOR_BACKWARD);
+      }
+    } else {
+      if (caret > run->range.start()) {
+        caret = IndexOfAdjacentGrapheme(caret, CURSOR_BACKWARD);
+        return SelectionModel(caret, CURSOR_FORWARD);
+      }
+    }
+    // The cursor is at the edge of a run; move to the visually adjacent run.
+    int visual_index = logical_to_visual_[run_index];
+    visual_index += (direction == CURSOR_LEFT) ? -1 : 1;
+    if (visual_index < 0 || visual_index >= static_cast<int>(runs_.size()))
+      return EdgeSelectionModel(direction);
+    run = runs_[visual_to_logical_[visual_index]];
+  }
+  return IsForwardMotion(direction, run) ? FirstSelectionModelInsideRun(run) :
+                                           LastSelectionModelInsideRun(run);
+}
+
+SelectionModel RenderTextHarfBuzz::AdjacentWordSelectionModel(
+    const SelectionModel& selection,
+    VisualCursorDirection direction) {
+  if (is_obscured())
+    return EdgeSelectionModel(direction);
+
+  base::i18n::BreakIterator* iter = GetWordBreaker();
+  DCHECK(iter);
+  if (!iter)
+    return selection;
+
+  SelectionModel cur(selection);
+  for (;;) {
+    cur = AdjacentCharSelectionModel(cur, direction);
+    size_t run_index = GetRunContainingCaret(cur);
+    if (run_index == runs_.size())
+      break;
+    size_t cursor = cur.caret_pos();
+    if (IsForwardMotion(direction, runs_[run_index]) ?
+        iter->IsEndOfWord(cursor) : iter->IsStartOfWord(cursor))
+      break;
+  }
+
+  return cur;
+}
+
+void RenderTextHarfBuzz::SetSelectionModel(const SelectionModel& model) {
+  RenderText::SetSelectionModel(model);
+  // The selection foreground is applied to the runs when the text is
+  // itemized, as in RenderTextWin. Relaying out only shapes the words that
+  // the new run boundaries split.
+  ResetLayout();
+}
+
+void RenderTextHarfBuzz::GetGlyphBounds(size_t index,
+                                        ui::Range* xspan,
+                                        int* height) {
+  size_t run_index =
+      GetRunContainingCaret(SelectionModel(index, CURSOR_FORWARD));
+  DCHECK_LT(run_index, runs_.size());
+  internal::TextRunHarfBuzz* run = runs_[run_index];
+  xspan->set_start(run->GetGlyphXBoundary(index, false));
+  xspan->set_end(run->GetGlyphXBoundary(index, true));
+  *height = run->font.GetHeight();
+}
+
+std::vector<Rect> RenderTextHarfBuzz::GetSubstringBounds(ui::Range range) {
+  DCHECK(!needs_layout_);
+  DCHECK(ui::Range(0, text().length()).Contains(range));
+
+  std::vector<Rect> bounds;
+  if (range.is_empty())
+    return bounds;
+
+  // Add a Rect for each run/selection intersection.
+  for (size_t i = 0; i < runs_.size(); ++i) {
+    internal::TextRunHarfBuzz* run = runs_[visual_to_logical_[i]];
+    ui::Range intersection = run->range.Intersect(range);
+    if (intersection.IsValid()) {
+      DCHECK(!intersection.is_reversed());
+      ui::Range range(run->GetGlyphXBoundary(intersection.start(), false),
+                      run->GetGlyphXBoundary(intersection.end(), false));
+      Rect rect(range.GetMin(), 0, range.length(), run->font.GetHeight());
+      // Center the rect vertically in the display area.
+      rect.Offset(0, (display_rect().height() - rect.height()) / 2);
+      rect.set_origin(ToViewPoint(rect.origin()));
+      // Union this with the last rect if they're adjacent.
+      if (!bounds.empty() && rect.SharesEdgeWith(bounds.back())) {
+        rect = rect.Union(bounds.back());
+        bounds.pop_back();
+      }
+      bounds.push_back(rect);
+    }
+  }
+  return bounds;
+}
+
+bool RenderTextHarfBuzz::IsCursorablePosition(size_t position) {
+  if (position == 0 || position == text().length())
+    return true;
+  if (position > text().length() || U16_IS_TRAIL(text()[position]))
+    return false;
+
+  EnsureLayout();
+  size_t run_index =
+      GetRunContainingCaret(SelectionModel(position, CURSOR_FORWARD));
+  if (run_index >= runs_.size())
+    return false;
+
+  internal::TextRunHarfBuzz* run = runs_[run_index];
+  if (position == run->range.start())
+    return true;
+  ui::Range chars;
+  run->GetClusterAt(position - run->range.start(), &chars);
+  return chars.start() == position - run->range.start();
+}
+
+void RenderTextHarfBuzz::ResetLayout() {
+  // Layout is performed lazily as needed for drawing/metrics.
+  needs_layout_ = true;
+}
+
+void RenderTextHarfBuzz::EnsureLayout() {
+  if (!needs_layout_)
+    return;
+  ItemizeText();
+  if (!runs_.empty())
+    LayoutVisualText();
+  needs_layout_ = false;
+}
+
+void RenderTextHarfBuzz::DrawVisualText(Canvas* canvas) {
+  DCHECK(!needs_layout_);
+
+  Point offset(GetOriginForDrawing());
+  // Skia will draw glyphs with respect to the baseline.
+  offset.Offset(0, common_baseline_);
+
+  const SkScalar x = SkIntToScalar(offset.x());
+  const SkScalar y = SkIntToScalar(offset.y());
+
+  internal::SkiaTextRenderer renderer(canvas);
+  ApplyFadeEffects(&renderer);
+  ApplyTextShadows(&renderer);
+
+  std::vector<SkPoint> positions;
+  for (size_t i = 0; i < runs_.size(); ++i) {
+    // Get the run specified by the visual-to-logical map.
+    internal::TextRunHarfBuzz* run = runs_[visual_to_logical_[i]];
+    const SkScalar run_x = x + SkIntToScalar(run->preceding_run_widths);
+    if (run->glyphs.empty())
+      continue;
+
+    positions.resize(run->glyphs.size());
+    for (size_t glyph = 0; glyph < run->glyphs.size(); ++glyph) {
+      positions[glyph].set(run_x + run->glyph_x[glyph] +
+                               run->offsets[glyph].x(),
+                           y + run->offsets[glyph].y());
+    }
+
+    renderer.SetTextSize(run->font.GetFontSize());
+    renderer.SetFontFamilyWithStyle(run->font.GetFontName(), run->font_style);
+    renderer.SetForegroundColor(run->foreground);
+    renderer.DrawPosText(&positions[0], &run->glyphs[0], run->glyphs.size());
+    StyleRange style;
+    style.strike = run->strike;
+    style.diagonal_strike = run->diagonal_strike;
+    style.underline = run->underline;
+    renderer.DrawDecorations(run_x, y, run->width, style);
+  }
+}
+
+void RenderTextHarfBuzz::ItemizeText() {
+  runs_.reset();
+  string_size_ = Size(0, GetFont().GetHeight());
+  common_baseline_ = 0;
+  layout_text_ = is_obscured() ?
+      string16(text().length(), kPasswordReplacementChar) : text();
+  if (layout_text_.empty())
+    return;
+
+  base::i18n::BiDiLineIterator bidi_iterator;
+  if (!bidi_iterator.Open(layout_text_,
+                          GetTextDirection() == base::i18n::RIGHT_TO_LEFT,
+                          false)) {
+    NOTREACHED();
+    return;
+  }
+
+  // Build the list of runs: break them at bidi level, script and style
+  // changes.
+  // TODO(msw): Only break for font changes, not color etc. See TextRun comment.
+  StyleRanges styles(style_ranges());
+  ApplyCompositionAndSelectionStyles(&styles);
+  StyleRanges::const_iterator style = styles.begin();
+  const size_t text_length = layout_text_.length();
+  for (size_t run_break = 0; run_break < text_length;) {
+    internal::TextRunHarfBuzz* run = new internal::TextRunHarfBuzz;
+    run->range.set_start(run_break);
+    run->font_style = style->font_style;
+    run->foreground = style->foreground;
+    run->strike = style->strike;
+    run->diagonal_strike = style->diagonal_strike;
+    run->underline = style->underline;
+
+    int bidi_run_end = 0;
+    bidi_iterator.GetLogicalRun(run_break, &bidi_run_end, &run->level);
+    run->is_rtl = run->level % 2 == 1;
+
+    // Find the range end and advance the styles as needed.
+    const size_t style_range_end = style->range.end();
+    run_break = ScriptRunEnd(layout_text_, run_break,
+                             std::min<size_t>(bidi_run_end, style_range_end),
+                             &run->script);
+    if (run_break >= style_range_end)
+      style++;
+    run->range.set_end(run_break);
+    runs_.push_back(run);
+  }
+}
+
+void RenderTextHarfBuzz::ShapeRun(internal::TextRunHarfBuzz* run) {
+  run->font = GetFont();
+  if ((run->font.GetStyle() & (Font::BOLD | Font::ITALIC)) !=
+      (run->font_style & (Font::BOLD | Font::ITALIC))) {
+    run->font = run->font.DeriveFont(0, run->font_style);
+  }
+  run->glyphs.clear();
+  run->glyph_x.clear();
+  run->offsets.clear();
+  run->glyph_to_char.clear();
+  run->advance = 0;
+
+  ShapedWordKey key;
+  key.font = GetHarfBuzzFont(run->font, run->font_style);
+  key.script = run->script;
+  key.is_rtl = run->is_rtl;
+  if (!key.font)
+    return;
+
+  // Split the run into words, each with the spaces that follow it, which are
+  // shaped on their own and placed in visual order.
+  std::vector<ui::Range> words;
+  size_t word_start = run->range.start();
+  for (size_t i = run->range.start(); i < run->range.end(); ++i) {
+    if (i + 1 == run->range.end() ||
+        (layout_text_[i] == ' ' && layout_text_[i + 1] != ' ')) {
+      words.push_back(ui::Range(word_start, i + 1));
+      word_start = i + 1;
+    }
+  }
+  if (run->is_rtl)
+    std::reverse(words.begin(), words.end());
+
+  for (size_t i = 0; i < words.size(); ++i) {
+    key.text = layout_text_.substr(words[i].start(), words[i].length());
+    const ShapedWord* word = GetShapedWord(key);
+    const uint32 word_offset = words[i].start() - run->range.start();
+    for (size_t glyph = 0; glyph < word->glyphs.size(); ++glyph) {
+      run->glyphs.push_back(word->glyphs[glyph]);
+      run->glyph_x.push_back(run->advance + word->glyph_x[glyph]);
+      run->offsets.push_back(word->offsets[glyph]);
+      run->glyph_to_char.push_back(word_offset + word->clusters[glyph]);
+    }
+    run->advance += word->width;
+  }
+  run->width = SkScalarRoundToInt(run->advance);
+}
+
+void RenderTextHarfBuzz::LayoutVisualText() {
+  DCHECK(!runs_.empty());
+
+  string_size_.set_height(0);
+  std::vector<UBiDiLevel> levels(runs_.size());
+  for (size_t i = 0; i < runs_.size(); ++i) {
+    internal::TextRunHarfBuzz* run = runs_[i];
+    ShapeRun(run);
+    string_size_.set_height(std::max(string_size_.height(),
+                                     run->font.GetHeight()));
+    common_baseline_ = std::max(common_baseline_, run->font.GetBaseline());
+    levels[i] = run->level;
+  }
+
+  // Get the maps between visual and logical run indices.
+  visual_to_logical_.resize(runs_.size());
+  logical_to_visual_.resize(runs_.size());
+  ubidi_reorderVisual(&levels[0], runs_.size(), &visual_to_logical_[0]);
+  ubidi_reorderLogical(&levels[0], runs_.size(), &logical_to_visual_[0]);
+
+  // Precalculate run width information.
+  int preceding_run_widths = 0;
+  for (size_t i = 0; i < runs_.size(); ++i) {
+    internal::TextRunHarfBuzz* run = runs_[visual_to_logical_[i]];
+    run->preceding_run_widths = preceding_run_widths;
+    preceding_run_widths += run->width;
+  }
+  string_size_.set_width(preceding_run_widths);
+}
+
+size_t RenderTextHarfBuzz::GetRunContainingCaret(
+    const SelectionModel& caret) const {
+  DCHECK(!needs_layout_);
+  size_t position = caret.caret_pos();
+  LogicalCursorDirection affinity = caret.caret_affinity();
+  size_t run = 0;
+  for (; run < runs_.size(); ++run)
+    if (RangeContainsCaret(runs_[run]->range, position, affinity))
+      break;
+  return run;
+}
+
+size_t RenderTextHarfBuzz::GetRunContainingPoint(const Point& point) const {
+  DCHECK(!needs_layout_);
+  // Find the text run containing the argument point (assumed already offset).
+  size_t run = 0;
+  for (; run < runs_.size(); ++run)
+    if (runs_[run]->preceding_run_widths <= point.x() &&
+        runs_[run]->preceding_run_widths + runs_[run]->width > point.x())
+      break;
+  return run;
+}
+
+SelectionModel RenderTextHarfBuzz::FirstSelectionModelInsideRun(
+    const internal::TextRunHarfBuzz* run) {
+  size_t cursor = IndexOfAdjacentGrapheme(run->range.start(), CURSOR_FORWARD);
+  return SelectionModel(cursor, CURSOR_BACKWARD);
+}
+
+SelectionModel RenderTextHarfBuzz::LastSelectionModelInsideRun(
+    const internal::TextRunHarfBuzz* run) {
+  size_t caret = IndexOfAdjacentGrapheme(run->range.end(), CURSOR_BACKWARD);
+  return SelectionModel(caret, CURSOR_FORWARD);
+}
+
+}  // namespace gfx
@@ -0,0 +1,150 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GFX_RENDER_TEXT_HARFBUZZ_H_
+#define UI_GFX_RENDER_TEXT_HARFBUZZ_H_
+#pragma once
+
+#include <vector>
+
+#include "base/memory/scoped_vector.h"
+#include "third_party/skia/include/core/SkPoint.h"
+#include "ui/gfx/render_text.h"
+#include "unicode/ubidi.h"
+#include "unicode/uscript.h"
+
+namespace gfx {
+
+namespace internal {
+
+struct TextRunHarfBuzz {
+  TextRunHarfBuzz();
+  ~TextRunHarfBuzz();
+
+  // Returns the index of the first glyph of the cluster that |pos|, a text
+  // index relative to the start of the run, belongs to, and sets |chars| to
+  // the run-relative range of text of that cluster.
+  size_t GetClusterAt(size_t pos, ui::Range* chars) const;
+
+  // Returns the X coordinate of the leading or |trailing| edge of the glyph
+  // starting at |text_index|, relative to the left of the text (not the view).
+  int GetGlyphXBoundary(size_t text_index, bool trailing) const;
+
+  ui::Range range;
+  Font font;
+  // TODO(msw): Disambiguate color, strike, etc. from TextRuns, as in
+  //            RenderTextWin.
+  SkColor foreground;
+  // A gfx::Font::FontStyle flag to specify bold and italic styles.
+  int font_style;
+  bool strike;
+  bool diagonal_strike;
+  bool underline;
+
+  UBiDiLevel level;
+  bool is_rtl;
+  UScriptCode script;
+
+  int width;
+  // The cumulative widths of preceding runs.
+  int preceding_run_widths;
+
+  // The glyphs in visual order, their positions relative to the left of the
+  // run, and the run-relative index of the first character of the cluster
+  // each belongs to.
+  std::vector<uint16> glyphs;
+  std::vector<SkScalar> glyph_x;
+  std::vector<SkPoint> offsets;
+  std::vector<uint32> glyph_to_char;
+  // The unrounded width of the run.
+  SkScalar advance;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TextRunHarfBuzz);
+};
+
+}  // namespace internal
+
+// RenderTextHarfBuzz lays text out without the platform's text stack: ICU
+// splits the text into runs of one bidi level, script and style, HarfBuzz
+// shapes them and Skia draws the glyphs. Runs are shaped a word at a time,
+// and the shaped words are kept in a process-wide cache, so that laying out
+// text that changed a little, or that another RenderText showed before, only
+// shapes the words that are new.
+//
+// Font fallback isn't supported yet: glyphs missing from the font of a run
+// are drawn as the font's missing glyph.
+class UI_EXPORT RenderTextHarfBuzz : public RenderText {
+ public:
+  RenderTextHarfBuzz();
+  virtual ~RenderTextHarfBuzz();
+
+  // Overridden from RenderText:
+  virtual base::i18n::TextDirection GetTextDirection() OVERRIDE;
+  virtual Size GetStringSize() OVERRIDE;
+  virtual SelectionModel FindCursorPosition(const Point& point) OVERRIDE;
+  virtual std::vector<FontSpan> GetFontSpansForTesting() OVERRIDE;
+
+  // Returns how many words were looked up in the shaped word cache since the
+  // last call, and how many of those had to be shaped.
+  static void TakeWordCacheCounts(int* lookups, int* misses);
+
+ protected:
+  // Overridden from RenderText:
+  virtual SelectionModel AdjacentCharSelectionModel(
+      const SelectionModel& selection,
+      VisualCursorDirection direction) OVERRIDE;
+  virtual SelectionModel AdjacentWordSelectionModel(
+      const SelectionModel& selection,
+      VisualCursorDirection direction) OVERRIDE;
+  virtual void SetSelectionModel(const SelectionModel& model) OVERRIDE;
+  virtual void GetGlyphBounds(size_t index,
+                              ui::Range* xspan,
+                              int* height) OVERRIDE;
+  virtual std::vector<Rect> GetSubstringBounds(ui::Range range) OVERRIDE;
+  virtual bool IsCursorablePosition(size_t position) OVERRIDE;
+  virtual void ResetLayout() OVERRIDE;
+  virtual void EnsureLayout() OVERRIDE;
+  virtual void DrawVisualText(Canvas* canvas) OVERRIDE;
+
+ private:
+  void ItemizeText();
+  void ShapeRun(internal::TextRunHarfBuzz* run);
+  void LayoutVisualText();
+
+  // Return the run index that contains the argument; or the length of the
+  // |runs_| vector if argument exceeds the text length or width.
+  size_t GetRunContainingCaret(const SelectionModel& caret) const;
+  size_t GetRunContainingPoint(const Point& point) const;
+
+  // Given a |run|, returns the SelectionModel that contains the logical first
+  // or last caret position inside (not at a boundary of) the run.
+  // The returned value represents a cursor/caret position without a selection.
+  SelectionModel FirstSelectionModelInsideRun(
+      const internal::TextRunHarfBuzz* run);
+  SelectionModel LastSelectionModelInsideRun(
+      const internal::TextRunHarfBuzz* run);
+
+  // The text that is laid out: text(), or as many replacement characters if
+  // the text is obscured.
+  string16 layout_text_;
+
+  ScopedVector<internal::TextRunHarfBuzz> runs_;
+  Size string_size_;
+
+  // A common vertical baseline for all the text runs. This is computed as the
+  // largest baseline over all the runs' fonts.
+  int common_baseline_;
+
+  std::vector<int32> visual_to_logical_;
+  std::vector<int32> logical_to_visual_;
+
+  bool needs_layout_;
+
+  DISALLOW_COPY_AND_ASSIGN(RenderTextHarfBuzz);
+};
+
+}  // namespace gfx
+
+#endif  // UI_GFX_RENDER_TEXT_HARFBUZZ_H_
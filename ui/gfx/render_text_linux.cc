@@ -9,14 +9,18 @@
 #include <string>
 #include <vector>
 
+#include "base/command_line.h"
 #include "base/i18n/break_iterator.h"
 #include "base/logging.h"
+#include "base/memory/arena.h"
 #include "third_party/skia/include/core/SkTypeface.h"
 #include "ui/base/text/utf16_indexing.h"
+#include "ui/base/ui_base_switches.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/font.h"
 #include "ui/gfx/font_render_params_linux.h"
 #include "ui/gfx/pango_util.h"
+#include "ui/gfx/render_text_harfbuzz.h"
 
 namespace gfx {
 
@@ -46,21 +50,6 @@ bool IndexInRange(const ui::Range& range, size_t index) {
   return index >= range.start() && index < range.end();
 }
 
-// Sets underline metrics on |renderer| according to Pango font |desc|.
-void SetPangoUnderlineMetrics(PangoFontDescription *desc,
-                              internal::SkiaTextRenderer* renderer) {
-  PangoFontMetrics* metrics = GetPangoFontMetrics(desc);
-  int thickness = pango_font_metrics_get_underline_thickness(metrics);
-  // Pango returns the position "above the baseline". Change its sign to convert
-  // it to a vertical offset from the baseline.
-  int position = -pango_font_metrics_get_underline_position(metrics);
-  pango_quantize_line_geometry(&thickness, &position);
-  // Note: pango_quantize_line_geometry() guarantees pixel boundaries, so
-  //       PANGO_PIXELS() is safe to use.
-  renderer->SetUnderlineMetrics(PANGO_PIXELS(thickness),
-                                PANGO_PIXELS(position));
-}
-
 }  // namespace
 
 // TODO(xji): index saved in upper layer is utf16 index. Pango uses utf8 index.
@@ -73,7 +62,8 @@ RenderTextLinux::RenderTextLinux()
       log_attrs_(NULL),
       num_log_attrs_(0),
       layout_text_(NULL),
-      layout_text_len_(0) {
+      layout_text_len_(0),
+      baseline_(0) {
 }
 
 RenderTextLinux::~RenderTextLinux() {
@@ -81,6 +71,10 @@ RenderTextLinux::~RenderTextLinux() {
 }
 
 RenderText* RenderText::CreateRenderText() {
+  if (CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kEnableHarfBuzzRenderText)) {
+    return new RenderTextHarfBuzz;
+  }
   return new RenderTextLinux;
 }
 
@@ -192,10 +186,9 @@ SelectionModel RenderTextLinux::AdjacentWordSelectionModel(
   if (is_obscured())
     return EdgeSelectionModel(direction);
 
-  base::i18n::BreakIterator iter(text(), base::i18n::BreakIterator::BREAK_WORD);
-  bool success = iter.Init();
-  DCHECK(success);
-  if (!success)
+  base::i18n::BreakIterator* iter = GetWordBreaker();
+  DCHECK(iter);
+  if (!iter)
     return selection;
 
   SelectionModel cur(selection);
@@ -207,7 +200,7 @@ SelectionModel RenderTextLinux::AdjacentWordSelectionModel(
     PangoItem* item = reinterpret_cast<PangoLayoutRun*>(run->data)->item;
     size_t cursor = cur.caret_pos();
     if (IsForwardMotion(direction, item) ?
-        iter.IsEndOfWord(cursor) : iter.IsStartOfWord(cursor))
+        iter->IsEndOfWord(cursor) : iter->IsStartOfWord(cursor))
       break;
   }
 
@@ -252,8 +245,9 @@ bool RenderTextLinux::IsCursorablePosition(size_t position) {
     return false;
 
   EnsureLayout();
-  ptrdiff_t offset = ui::UTF16IndexToOffset(text(), 0, position);
-  return (offset < num_log_attrs_ && log_attrs_[offset].is_cursor_position);
+  size_t offset = text_index_map()->IndexToOffset(text(), position);
+  return (offset < static_cast<size_t>(num_log_attrs_) &&
+          log_attrs_[offset].is_cursor_position);
 }
 
 void RenderTextLinux::ResetLayout() {
@@ -276,6 +270,8 @@ void RenderTextLinux::ResetLayout() {
     selection_visual_bounds_.clear();
   layout_text_ = NULL;
   layout_text_len_ = 0;
+  glyph_runs_.clear();
+  baseline_ = 0;
 }
 
 void RenderTextLinux::EnsureLayout() {
@@ -346,23 +342,26 @@ void RenderTextLinux::SetupPangoAttributes(PangoLayout* layout) {
 
 void RenderTextLinux::DrawVisualText(Canvas* canvas) {
   DCHECK(layout_);
+  EnsureGlyphRuns();
 
   Point offset(GetOriginForDrawing());
   // Skia will draw glyphs with respect to the baseline.
-  offset.Offset(0, PANGO_PIXELS(pango_layout_get_baseline(layout_)));
+  offset.Offset(0, baseline_);
 
   SkScalar x = SkIntToScalar(offset.x());
   SkScalar y = SkIntToScalar(offset.y());
 
-  std::vector<SkPoint> pos;
-  std::vector<uint16> glyphs;
+  base::ScopedArenaFrame frame(base::Arena::GetForCurrentThread());
+  base::ArenaVector<SkPoint>::Type pos(
+      base::ArenaAllocator<SkPoint>(frame.arena()));
 
   StyleRanges styles(style_ranges());
   ApplyCompositionAndSelectionStyles(&styles);
 
   // Pre-calculate UTF8 indices from UTF16 indices.
   // TODO(asvitkine): Can we cache these?
-  std::vector<ui::Range> style_ranges_utf8;
+  base::ArenaVector<ui::Range>::Type style_ranges_utf8(
+      base::ArenaAllocator<ui::Range>(frame.arena()));
   style_ranges_utf8.reserve(styles.size());
   size_t start_index = 0;
   for (size_t i = 0; i < styles.size(); ++i) {
@@ -385,54 +384,36 @@ void RenderTextLinux::DrawVisualText(Canvas* canvas) {
       render_params.antialiasing,
       use_subpixel_rendering && !background_is_transparent());
 
-  for (GSList* it = current_line_->runs; it; it = it->next) {
-    PangoLayoutRun* run = reinterpret_cast<PangoLayoutRun*>(it->data);
-    int glyph_count = run->glyphs->num_glyphs;
-    if (glyph_count == 0)
-      continue;
-
-    size_t run_start = run->item->offset;
-    size_t first_glyph_byte_index = run_start + run->glyphs->log_clusters[0];
-    size_t style_increment = IsForwardMotion(CURSOR_RIGHT, run->item) ? 1 : -1;
+  for (size_t r = 0; r < glyph_runs_.size(); ++r) {
+    const GlyphRun& run = glyph_runs_[r];
+    int glyph_count = static_cast<int>(run.glyphs.size());
+    size_t style_increment = run.forward ? 1 : -1;
 
     // Find the initial style for this run.
     // TODO(asvitkine): Can we avoid looping here, e.g. by caching this per run?
     int style = -1;
     for (size_t i = 0; i < style_ranges_utf8.size(); ++i) {
-      if (IndexInRange(style_ranges_utf8[i], first_glyph_byte_index)) {
+      if (IndexInRange(style_ranges_utf8[i], run.byte_indices[0])) {
         style = i;
         break;
       }
     }
     DCHECK_GE(style, 0);
 
-    ScopedPangoFontDescription desc(
-        pango_font_describe(run->item->analysis.font));
+    renderer.SetTextSize(run.text_size);
+    renderer.SetUnderlineMetrics(run.underline_thickness,
+                                 run.underline_position);
 
-    const std::string family_name =
-        pango_font_description_get_family(desc.get());
-    renderer.SetTextSize(GetPangoFontSizeInPixels(desc.get()));
+    pos.resize(glyph_count);
+    for (int i = 0; i < glyph_count; ++i)
+      pos[i].set(x + run.positions[i].x(), y + run.positions[i].y());
 
-    SkScalar glyph_x = x;
     SkScalar start_x = x;
     int start = 0;
-
-    glyphs.resize(glyph_count);
-    pos.resize(glyph_count);
-
     for (int i = 0; i < glyph_count; ++i) {
-      const PangoGlyphInfo& glyph = run->glyphs->glyphs[i];
-      glyphs[i] = static_cast<uint16>(glyph.glyph);
-      // Use pango_units_to_double() rather than PANGO_PIXELS() here so that
-      // units won't get rounded to the pixel grid if we're using subpixel
-      // positioning.
-      pos[i].set(glyph_x + pango_units_to_double(glyph.geometry.x_offset),
-                 y + pango_units_to_double(glyph.geometry.y_offset));
-      glyph_x += pango_units_to_double(glyph.geometry.width);
-
       // If this glyph is beyond the current style, draw the glyphs so far and
       // advance to the next style.
-      size_t glyph_byte_index = run_start + run->glyphs->log_clusters[i];
+      size_t glyph_byte_index = run.byte_indices[i];
       DCHECK_GE(style, 0);
       DCHECK_LT(style, static_cast<int>(styles.size()));
       if (!IndexInRange(style_ranges_utf8[style], glyph_byte_index)) {
@@ -440,11 +421,10 @@ void RenderTextLinux::DrawVisualText(Canvas* canvas) {
         //                  but can span multiple styles, Pango splits the
         //                  styles evenly over the glyph. We can do this too by
         //                  clipping and drawing the glyph several times.
+        SkScalar glyph_x = x + run.pen_x[i];
         renderer.SetForegroundColor(styles[style].foreground);
-        renderer.SetFontFamilyWithStyle(family_name, styles[style].font_style);
-        renderer.DrawPosText(&pos[start], &glyphs[start], i - start);
-        if (styles[style].underline)
-          SetPangoUnderlineMetrics(desc.get(), &renderer);
+        renderer.SetFontFamilyWithStyle(run.family, styles[style].font_style);
+        renderer.DrawPosText(&pos[start], &run.glyphs[start], i - start);
         renderer.DrawDecorations(start_x, y, glyph_x - start_x, styles[style]);
 
         start = i;
@@ -458,13 +438,79 @@ void RenderTextLinux::DrawVisualText(Canvas* canvas) {
     }
 
     // Draw the remaining glyphs.
+    SkScalar end_x = x + run.width;
     renderer.SetForegroundColor(styles[style].foreground);
-    renderer.SetFontFamilyWithStyle(family_name, styles[style].font_style);
-    renderer.DrawPosText(&pos[start], &glyphs[start], glyph_count - start);
-    if (styles[style].underline)
-      SetPangoUnderlineMetrics(desc.get(), &renderer);
-    renderer.DrawDecorations(start_x, y, glyph_x - start_x, styles[style]);
-    x = glyph_x;
+    renderer.SetFontFamilyWithStyle(run.family, styles[style].font_style);
+    renderer.DrawPosText(&pos[start], &run.glyphs[start], glyph_count - start);
+    renderer.DrawDecorations(start_x, y, end_x - start_x, styles[style]);
+    x = end_x;
+  }
+}
+
+RenderTextLinux::GlyphRun::GlyphRun()
+    : text_size(0),
+      underline_thickness(0),
+      underline_position(0),
+      forward(true),
+      width(0) {
+}
+
+RenderTextLinux::GlyphRun::~GlyphRun() {
+}
+
+void RenderTextLinux::EnsureGlyphRuns() {
+  if (!glyph_runs_.empty())
+    return;
+
+  baseline_ = PANGO_PIXELS(pango_layout_get_baseline(layout_));
+  glyph_runs_.reserve(g_slist_length(current_line_->runs));
+  for (GSList* it = current_line_->runs; it; it = it->next) {
+    PangoLayoutRun* pango_run = reinterpret_cast<PangoLayoutRun*>(it->data);
+    int glyph_count = pango_run->glyphs->num_glyphs;
+    if (glyph_count == 0)
+      continue;
+
+    glyph_runs_.push_back(GlyphRun());
+    GlyphRun& run = glyph_runs_.back();
+
+    ScopedPangoFontDescription desc(
+        pango_font_describe(pango_run->item->analysis.font));
+    run.family = pango_font_description_get_family(desc.get());
+    run.text_size = GetPangoFontSizeInPixels(desc.get());
+
+    PangoFontMetrics* metrics = GetPangoFontMetrics(desc.get());
+    int thickness = pango_font_metrics_get_underline_thickness(metrics);
+    // Pango returns the position "above the baseline". Change its sign to
+    // convert it to a vertical offset from the baseline.
+    int position = -pango_font_metrics_get_underline_position(metrics);
+    pango_quantize_line_geometry(&thickness, &position);
+    // Note: pango_quantize_line_geometry() guarantees pixel boundaries, so
+    //       PANGO_PIXELS() is safe to use.
+    run.underline_thickness = PANGO_PIXELS(thickness);
+    run.underline_position = PANGO_PIXELS(position);
+
+    run.forward = IsForwardMotion(CURSOR_RIGHT, pango_run->item);
+    run.glyphs.resize(glyph_count);
+    run.positions.resize(glyph_count);
+    run.pen_x.resize(glyph_count);
+    run.byte_indices.resize(glyph_count);
+
+    size_t run_start = pango_run->item->offset;
+    SkScalar glyph_x = 0;
+    for (int i = 0; i < glyph_count; ++i) {
+      const PangoGlyphInfo& glyph = pango_run->glyphs->glyphs[i];
+      run.glyphs[i] = static_cast<uint16>(glyph.glyph);
+      // Use pango_units_to_double() rather than PANGO_PIXELS() here so that
+      // units won't get rounded to the pixel grid if we're using subpixel
+      // positioning.
+      run.positions[i].set(
+          glyph_x + pango_units_to_double(glyph.geometry.x_offset),
+          pango_units_to_double(glyph.geometry.y_offset));
+      run.pen_x[i] = glyph_x;
+      run.byte_indices[i] = run_start + pango_run->glyphs->log_clusters[i];
+      glyph_x += pango_units_to_double(glyph.geometry.width);
+    }
+    run.width = glyph_x;
   }
 }
 
@@ -500,19 +546,24 @@ SelectionModel RenderTextLinux::LastSelectionModelInsideRun(
 size_t RenderTextLinux::TextIndexToLayoutIndex(size_t text_index) const {
   // If the text is obscured then |layout_text_| is not the same as |text()|,
   // but whether or not the text is obscured, the character (code point) offset
-  // in |layout_text_| is the same as that in |text()|.
+  // in |layout_text_| is the same as that in |text()|. The obscured text is
+  // made of single byte replacement characters, so its byte offsets are its
+  // character offsets; otherwise |layout_text_| is the UTF-8 form of |text()|.
   DCHECK(layout_);
-  ptrdiff_t offset = ui::UTF16IndexToOffset(text(), 0, text_index);
-  const char* layout_pointer = g_utf8_offset_to_pointer(layout_text_, offset);
-  return (layout_pointer - layout_text_);
+  size_t layout_index = is_obscured() ?
+      text_index_map()->IndexToOffset(text(), text_index) :
+      text_index_map()->IndexToUTF8Offset(text(), text_index);
+  DCHECK_LE(layout_index, layout_text_len_);
+  return layout_index;
 }
 
 size_t RenderTextLinux::LayoutIndexToTextIndex(size_t layout_index) const {
   // See |TextIndexToLayoutIndex()|.
   DCHECK(layout_);
-  const char* layout_pointer = layout_text_ + layout_index;
-  long offset = g_utf8_pointer_to_offset(layout_text_, layout_pointer);
-  return ui::UTF16OffsetToIndex(text(), 0, offset);
+  DCHECK_LE(layout_index, layout_text_len_);
+  if (is_obscured())
+    return text_index_map()->OffsetToIndex(text(), layout_index);
+  return text_index_map()->UTF8OffsetToIndex(text(), layout_index);
 }
 
 std::vector<Rect> RenderTextLinux::CalculateSubstringBounds(ui::Range range) {
@@ -7,8 +7,10 @@
 #pragma once
 
 #include <pango/pango.h>
+#include <string>
 #include <vector>
 
+#include "third_party/skia/include/core/SkPoint.h"
 #include "ui/gfx/render_text.h"
 
 namespace gfx {
@@ -44,6 +46,32 @@ class RenderTextLinux : public RenderText {
   virtual void DrawVisualText(Canvas* canvas) OVERRIDE;
 
  private:
+  // A run of |current_line_| with what DrawVisualText() needs from Pango to
+  // draw it, so that repainting an unchanged layout makes no Pango calls.
+  struct GlyphRun {
+    GlyphRun();
+    ~GlyphRun();
+
+    std::string family;
+    SkScalar text_size;
+    SkScalar underline_thickness;
+    SkScalar underline_position;
+    // True if the glyphs are in logical order.
+    bool forward;
+    // The width of the run.
+    SkScalar width;
+    // For each glyph: its id, its position relative to the start of the run
+    // on the baseline, the x of the pen before it, and the byte index into
+    // |layout_text_| of its cluster.
+    std::vector<uint16> glyphs;
+    std::vector<SkPoint> positions;
+    std::vector<SkScalar> pen_x;
+    std::vector<size_t> byte_indices;
+  };
+
+  // Fills |glyph_runs_| from |current_line_| if it is empty.
+  void EnsureGlyphRuns();
+
   // Returns the run that contains the character attached to the caret in the
   // given selection model. Return NULL if not found.
   GSList* GetRunContainingCaret(const SelectionModel& caret) const;
@@ -92,6 +120,11 @@ class RenderTextLinux : public RenderText {
   // The text length.
   size_t layout_text_len_;
 
+  // The runs of |current_line_| ready to draw, and the baseline of |layout_|
+  // in pixels. Built on the first draw after the layout is reset.
+  std::vector<GlyphRun> glyph_runs_;
+  int baseline_;
+
   DISALLOW_COPY_AND_ASSIGN(RenderTextLinux);
 };
 
@@ -4,10 +4,13 @@
 
 #include "ui/gfx/render_text.h"
 
+#include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/time.h"
 #include "base/utf_string_conversions.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "ui/base/l10n/l10n_util.h"
+#include "ui/gfx/render_text_harfbuzz.h"
 
 #if defined(OS_WIN)
 #include "base/win/windows_version.h"
@@ -319,6 +322,44 @@ void TestVisualCursorMotionInObscuredField(RenderText* render_text,
   EXPECT_EQ(SelectionModel(0, CURSOR_BACKWARD), render_text->selection_model());
 }
 
+TEST_F(RenderTextTest, ReplaceText) {
+  scoped_ptr<RenderText> render_text(RenderText::CreateRenderText());
+  render_text->SetText(ASCIIToUTF16("01234"));
+  StyleRange underline;
+  underline.underline = true;
+  underline.range = ui::Range(2, 3);
+  render_text->ApplyStyleRange(underline);
+
+  // Ranges after the edit move with the text.
+  render_text->ReplaceText(ui::Range(1, 1), ASCIIToUTF16("ab"));
+  EXPECT_EQ(ASCIIToUTF16("0ab1234"), render_text->text());
+  ASSERT_EQ(3U, render_text->style_ranges().size());
+  EXPECT_EQ(ui::Range(0, 4), render_text->style_ranges()[0].range);
+  EXPECT_EQ(ui::Range(4, 5), render_text->style_ranges()[1].range);
+  EXPECT_TRUE(render_text->style_ranges()[1].underline);
+  EXPECT_EQ(ui::Range(5, 7), render_text->style_ranges()[2].range);
+
+  // Text inserted at the start of a range takes the style before it.
+  render_text->ReplaceText(ui::Range(4, 4), ASCIIToUTF16("x"));
+  EXPECT_EQ(ASCIIToUTF16("0ab1x234"), render_text->text());
+  ASSERT_EQ(3U, render_text->style_ranges().size());
+  EXPECT_EQ(ui::Range(0, 5), render_text->style_ranges()[0].range);
+  EXPECT_EQ(ui::Range(5, 6), render_text->style_ranges()[1].range);
+  EXPECT_TRUE(render_text->style_ranges()[1].underline);
+
+  // Ranges inside replaced text are removed.
+  render_text->ReplaceText(ui::Range(7, 3), ASCIIToUTF16("y"));
+  EXPECT_EQ(ASCIIToUTF16("0aby4"), render_text->text());
+  ASSERT_EQ(2U, render_text->style_ranges().size());
+  EXPECT_EQ(ui::Range(0, 4), render_text->style_ranges()[0].range);
+  EXPECT_EQ(ui::Range(4, 5), render_text->style_ranges()[1].range);
+  EXPECT_FALSE(render_text->style_ranges()[1].underline);
+
+  render_text->ReplaceText(ui::Range(0, 5), string16());
+  EXPECT_TRUE(render_text->text().empty());
+  EXPECT_TRUE(render_text->style_ranges().empty());
+}
+
 TEST_F(RenderTextTest, PasswordCensorship) {
   const string16 seuss = ASCIIToUTF16("hop on pop");
   const string16 no_seuss = ASCIIToUTF16("**********");
@@ -1239,4 +1280,114 @@ TEST_F(RenderTextTest, DisplayRectShowsCursorRTL) {
   base::i18n::SetICUDefaultLocale(locale);
 }
 
+TEST_F(RenderTextTest, HarfBuzz_MoveCursorLeftRightInLtrRtl) {
+  scoped_ptr<RenderText> render_text(new RenderTextHarfBuzz);
+  render_text->SetText(WideToUTF16(L"abc\x05d0\x05d1\x05d2"));
+  std::vector<SelectionModel> expected;
+  expected.push_back(SelectionModel(0, CURSOR_BACKWARD));
+  expected.push_back(SelectionModel(1, CURSOR_BACKWARD));
+  expected.push_back(SelectionModel(2, CURSOR_BACKWARD));
+  expected.push_back(SelectionModel(3, CURSOR_BACKWARD));
+  expected.push_back(SelectionModel(5, CURSOR_FORWARD));
+  expected.push_back(SelectionModel(4, CURSOR_FORWARD));
+  expected.push_back(SelectionModel(3, CURSOR_FORWARD));
+  expected.push_back(SelectionModel(6, CURSOR_FORWARD));
+  RunMoveCursorLeftRightTest(render_text.get(), expected, CURSOR_RIGHT);
+
+  expected.clear();
+  expected.push_back(SelectionModel(6, CURSOR_FORWARD));
+  expected.push_back(SelectionModel(4, CURSOR_BACKWARD));
+  expected.push_back(SelectionModel(5, CURSOR_BACKWARD));
+  expected.push_back(SelectionModel(6, CURSOR_BACKWARD));
+  expected.push_back(SelectionModel(2, CURSOR_FORWARD));
+  expected.push_back(SelectionModel(1, CURSOR_FORWARD));
+  expected.push_back(SelectionModel(0, CURSOR_FORWARD));
+  expected.push_back(SelectionModel(0, CURSOR_BACKWARD));
+  RunMoveCursorLeftRightTest(render_text.get(), expected, CURSOR_LEFT);
+}
+
+TEST_F(RenderTextTest, HarfBuzz_Runs) {
+  scoped_ptr<RenderText> render_text(new RenderTextHarfBuzz);
+
+  // Runs break at bidi level and script changes. Spaces and punctuation stay
+  // in the run they are in.
+  render_text->SetText(WideToUTF16(L"abc, \x05d0\x05d1 \x0915\x093f"));
+  std::vector<RenderText::FontSpan> spans =
+      render_text->GetFontSpansForTesting();
+  ASSERT_EQ(3U, spans.size());
+  EXPECT_EQ(ui::Range(0, 5), spans[0].second);
+  EXPECT_EQ(ui::Range(5, 7), spans[1].second);
+  EXPECT_EQ(ui::Range(7, 10), spans[2].second);
+
+  // And at font style changes.
+  render_text->SetText(ASCIIToUTF16("abcdef"));
+  StyleRange bold;
+  bold.font_style = Font::BOLD;
+  bold.range = ui::Range(2, 4);
+  render_text->ApplyStyleRange(bold);
+  spans = render_text->GetFontSpansForTesting();
+  ASSERT_EQ(3U, spans.size());
+  EXPECT_EQ(ui::Range(2, 4), spans[1].second);
+  EXPECT_EQ(Font::BOLD, spans[1].first.GetStyle() & Font::BOLD);
+}
+
+TEST_F(RenderTextTest, HarfBuzz_WordCache) {
+  const string16 text(ASCIIToUTF16("the quick brown fox the quick"));
+  int lookups = 0;
+  int misses = 0;
+  RenderTextHarfBuzz::TakeWordCacheCounts(&lookups, &misses);
+
+  // The text has five different words, counting the trailing spaces.
+  scoped_ptr<RenderText> render_text(new RenderTextHarfBuzz);
+  render_text->SetText(text);
+  const int width = render_text->GetStringSize().width();
+  EXPECT_GT(width, 0);
+  RenderTextHarfBuzz::TakeWordCacheCounts(&lookups, &misses);
+  EXPECT_GT(lookups, 0);
+  EXPECT_LE(misses, 5);
+
+  // Laying the same text out again shapes nothing, and gives the same size.
+  scoped_ptr<RenderText> other_render_text(new RenderTextHarfBuzz);
+  other_render_text->SetText(text);
+  EXPECT_EQ(width, other_render_text->GetStringSize().width());
+  RenderTextHarfBuzz::TakeWordCacheCounts(&lookups, &misses);
+  EXPECT_GT(lookups, 0);
+  EXPECT_EQ(0, misses);
+}
+
+// Compares the time the platform's RenderText and RenderTextHarfBuzz take to
+// lay out and measure the texts the tests above use. Run it by hand with
+// --gtest_also_run_disabled_tests.
+TEST_F(RenderTextTest, DISABLED_HarfBuzz_LayoutBenchmark) {
+  const wchar_t* kTexts[] = {
+    L"abc",
+    L"abc\x05d0\x05d1\x05d2",
+    L"a\x05d1" L"b",
+    L"\x05d0\x05d1\x05d2",
+    L"\x0915\x093f\x0915\x094d\x0915",
+    L"foo bar baz \x05d0\x05d1\x05d2 qux 123 \x05d3\x05d4",
+    L"\x6211\x4eec\x53bb\x516c\x56ed\x73a9",
+  };
+  const int kIterations = 1000;
+
+  scoped_ptr<RenderText> render_texts[2];
+  render_texts[0].reset(RenderText::CreateRenderText());
+  render_texts[1].reset(new RenderTextHarfBuzz);
+  const char* kNames[] = { "platform", "harfbuzz" };
+  for (size_t i = 0; i < arraysize(render_texts); ++i) {
+    const base::TimeTicks start = base::TimeTicks::HighResNow();
+    for (int iteration = 0; iteration < kIterations; ++iteration) {
+      for (size_t text = 0; text < arraysize(kTexts); ++text) {
+        render_texts[i]->SetText(WideToUTF16(kTexts[text]));
+        render_texts[i]->MoveCursor(LINE_BREAK, CURSOR_RIGHT, false);
+        EXPECT_GT(render_texts[i]->GetStringSize().width(), 0);
+      }
+    }
+    LOG(INFO) << kNames[i] << ": "
+              << (base::TimeTicks::HighResNow() - start).InMillisecondsF() /
+                 kIterations
+              << " ms per pass";
+  }
+}
+
 }  // namespace gfx
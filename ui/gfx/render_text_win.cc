@@ -6,17 +6,21 @@
 
 #include <algorithm>
 
+#include "base/command_line.h"
 #include "base/i18n/break_iterator.h"
 #include "base/logging.h"
+#include "base/memory/arena.h"
 #include "base/string_split.h"
 #include "base/string_util.h"
 #include "base/threading/thread_restrictions.h"
 #include "base/utf_string_conversions.h"
 #include "base/win/registry.h"
 #include "base/win/windows_version.h"
+#include "ui/base/ui_base_switches.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/font_smoothing_win.h"
 #include "ui/gfx/platform_font_win.h"
+#include "ui/gfx/render_text_harfbuzz.h"
 
 namespace gfx {
 
@@ -540,7 +544,9 @@ void RenderTextWin::DrawVisualText(Canvas* canvas) {
   SkScalar x = SkIntToScalar(offset.x());
   SkScalar y = SkIntToScalar(offset.y());
 
-  std::vector<SkPoint> pos;
+  base::ScopedArenaFrame frame(base::Arena::GetForCurrentThread());
+  base::ArenaVector<SkPoint>::Type pos(
+      base::ArenaAllocator<SkPoint>(frame.arena()));
 
   internal::SkiaTextRenderer renderer(canvas);
   ApplyFadeEffects(&renderer);
@@ -907,6 +913,10 @@ SelectionModel RenderTextWin::LastSelectionModelInsideRun(
 }
 
 RenderText* RenderText::CreateRenderText() {
+  if (CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kEnableHarfBuzzRenderText)) {
+    return new RenderTextHarfBuzz;
+  }
   return new RenderTextWin;
 }
 
@@ -7,7 +7,14 @@
 #include <gdk/gdkx.h>
 #include <gtk/gtk.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "base/logging.h"
+#include "base/memory/singleton.h"
+#include "ui/base/glib/glib_signal.h"
+#include "ui/base/work_area_watcher_observer.h"
+#include "ui/base/x/work_area_watcher_x.h"
 #include "ui/gfx/display.h"
 
 namespace {
@@ -47,28 +54,164 @@ bool GetScreenWorkArea(gfx::Rect* out_rect) {
   return true;
 }
 
-gfx::Rect NativePrimaryMonitorBounds() {
-  GdkScreen* screen = gdk_screen_get_default();
-  GdkRectangle rect;
-  gdk_screen_get_monitor_geometry(screen, 0, &rect);
-  return gfx::Rect(rect);
+// Keeps the monitor geometry of the default screen and the work area, so that
+// screen queries are answered without a round trip to the X server. GDK
+// turns the XRandR RRScreenChangeNotify events into the "monitors-changed"
+// and "size-changed" signals of the screen, and WorkAreaWatcherX reports
+// changes to _NET_WORKAREA; each drops the cached values, which are fetched
+// again on the next query.
+class DisplayConfigCache : public ui::WorkAreaWatcherObserver {
+ public:
+  static DisplayConfigCache* GetInstance();
+
+  int GetMonitorCount();
+
+  // Returns the bounds of monitor |monitor|, which is 0 for the primary one.
+  gfx::Rect GetMonitorBounds(int monitor);
+
+  // Returns the monitor that contains |point|, or else the closest one.
+  int GetMonitorNearestPoint(const gfx::Point& point);
+
+  // Returns false if the window manager doesn't publish a work area.
+  bool GetWorkArea(gfx::Rect* work_area);
+
+  // Overridden from ui::WorkAreaWatcherObserver:
+  virtual void WorkAreaChanged() OVERRIDE;
+
+ private:
+  friend struct DefaultSingletonTraits<DisplayConfigCache>;
+
+  DisplayConfigCache();
+  virtual ~DisplayConfigCache();
+
+  void UpdateMonitorBounds();
+
+  CHROMEG_CALLBACK_0(DisplayConfigCache, void, OnMonitorsChanged, GdkScreen*);
+
+  GdkScreen* screen_;
+  gulong monitors_changed_handler_;
+  gulong size_changed_handler_;
+
+  // Empty until the first query after a change.
+  std::vector<gfx::Rect> monitor_bounds_;
+
+  bool work_area_valid_;
+  bool has_work_area_;
+  gfx::Rect work_area_;
+
+  DISALLOW_COPY_AND_ASSIGN(DisplayConfigCache);
+};
+
+DisplayConfigCache::DisplayConfigCache()
+    : screen_(gdk_screen_get_default()),
+      work_area_valid_(false),
+      has_work_area_(false) {
+  monitors_changed_handler_ = g_signal_connect(
+      screen_, "monitors-changed", G_CALLBACK(OnMonitorsChangedThunk), this);
+  size_changed_handler_ = g_signal_connect(
+      screen_, "size-changed", G_CALLBACK(OnMonitorsChangedThunk), this);
+  ui::WorkAreaWatcherX::AddObserver(this);
+}
+
+DisplayConfigCache::~DisplayConfigCache() {
+  ui::WorkAreaWatcherX::RemoveObserver(this);
+  g_signal_handler_disconnect(screen_, size_changed_handler_);
+  g_signal_handler_disconnect(screen_, monitors_changed_handler_);
+}
+
+// static
+DisplayConfigCache* DisplayConfigCache::GetInstance() {
+  return Singleton<DisplayConfigCache>::get();
+}
+
+int DisplayConfigCache::GetMonitorCount() {
+  UpdateMonitorBounds();
+  return static_cast<int>(monitor_bounds_.size());
+}
+
+gfx::Rect DisplayConfigCache::GetMonitorBounds(int monitor) {
+  UpdateMonitorBounds();
+  DCHECK_GE(monitor, 0);
+  DCHECK_LT(monitor, static_cast<int>(monitor_bounds_.size()));
+  return monitor_bounds_[monitor];
+}
+
+int DisplayConfigCache::GetMonitorNearestPoint(const gfx::Point& point) {
+  UpdateMonitorBounds();
+  int nearest = 0;
+  int64 nearest_distance = -1;
+  for (size_t i = 0; i < monitor_bounds_.size(); ++i) {
+    const gfx::Rect& bounds = monitor_bounds_[i];
+    if (bounds.Contains(point))
+      return static_cast<int>(i);
+    int64 dx = std::max(0, std::max(bounds.x() - point.x(),
+                                    point.x() - bounds.right()));
+    int64 dy = std::max(0, std::max(bounds.y() - point.y(),
+                                    point.y() - bounds.bottom()));
+    int64 distance = dx * dx + dy * dy;
+    if (nearest_distance < 0 || distance < nearest_distance) {
+      nearest = static_cast<int>(i);
+      nearest_distance = distance;
+    }
+  }
+  return nearest;
+}
+
+bool DisplayConfigCache::GetWorkArea(gfx::Rect* work_area) {
+  if (!work_area_valid_) {
+    has_work_area_ = GetScreenWorkArea(&work_area_);
+    work_area_valid_ = true;
+  }
+  *work_area = work_area_;
+  return has_work_area_;
+}
+
+void DisplayConfigCache::WorkAreaChanged() {
+  work_area_valid_ = false;
+}
+
+void DisplayConfigCache::UpdateMonitorBounds() {
+  if (!monitor_bounds_.empty())
+    return;
+  // GDK reports at least one monitor, which covers the screen if there is no
+  // XRandR or Xinerama.
+  gint count = std::max(1, gdk_screen_get_n_monitors(screen_));
+  for (gint i = 0; i < count; ++i) {
+    GdkRectangle rect;
+    gdk_screen_get_monitor_geometry(screen_, i, &rect);
+    monitor_bounds_.push_back(gfx::Rect(rect));
+  }
+}
+
+void DisplayConfigCache::OnMonitorsChanged(GdkScreen* screen) {
+  monitor_bounds_.clear();
+  // The work area follows the monitors, and the window manager may not
+  // update _NET_WORKAREA before the next query.
+  work_area_valid_ = false;
 }
 
 gfx::Rect GetMonitorAreaNearestWindow(gfx::NativeView view) {
-  GdkScreen* screen = gdk_screen_get_default();
-  gint monitor_num = 0;
-  if (view && GTK_IS_WINDOW(view)) {
-    GtkWidget* top_level = gtk_widget_get_toplevel(view);
-    DCHECK(GTK_IS_WINDOW(top_level));
-    GtkWindow* window = GTK_WINDOW(top_level);
-    screen = gtk_window_get_screen(window);
-    monitor_num = gdk_screen_get_monitor_at_window(
-        screen,
-        gtk_widget_get_window(top_level));
+  DisplayConfigCache* cache = DisplayConfigCache::GetInstance();
+  if (!view || !GTK_IS_WINDOW(view))
+    return cache->GetMonitorBounds(0);
+
+  GtkWidget* top_level = gtk_widget_get_toplevel(view);
+  DCHECK(GTK_IS_WINDOW(top_level));
+  GdkScreen* screen = gtk_window_get_screen(GTK_WINDOW(top_level));
+  if (screen != gdk_screen_get_default()) {
+    // Only the default screen is cached.
+    gint monitor_num = gdk_screen_get_monitor_at_window(
+        screen, gtk_widget_get_window(top_level));
+    GdkRectangle bounds;
+    gdk_screen_get_monitor_geometry(screen, monitor_num, &bounds);
+    return gfx::Rect(bounds);
   }
-  GdkRectangle bounds;
-  gdk_screen_get_monitor_geometry(screen, monitor_num, &bounds);
-  return gfx::Rect(bounds);
+  // Finding the monitor of a window asks the X server where the window is,
+  // which is only needed if there is more than one monitor.
+  if (cache->GetMonitorCount() == 1)
+    return cache->GetMonitorBounds(0);
+  return cache->GetMonitorBounds(gdk_screen_get_monitor_at_window(
+      screen, gtk_widget_get_window(top_level)));
 }
 
 }  // namespace
@@ -120,21 +263,21 @@ gfx::Display Screen::GetDisplayNearestWindow(gfx::NativeView view) {
 
 // static
 gfx::Display Screen::GetDisplayNearestPoint(const gfx::Point& point) {
-  GdkScreen* screen = gdk_screen_get_default();
-  gint monitor = gdk_screen_get_monitor_at_point(screen, point.x(), point.y());
-  GdkRectangle bounds;
-  gdk_screen_get_monitor_geometry(screen, monitor, &bounds);
+  DisplayConfigCache* cache = DisplayConfigCache::GetInstance();
+  gfx::Rect bounds =
+      cache->GetMonitorBounds(cache->GetMonitorNearestPoint(point));
   // TODO(oshima): Implement ID and Observer.
-  return gfx::Display(0, gfx::Rect(bounds));
+  return gfx::Display(0, bounds);
 }
 
 // static
 gfx::Display Screen::GetPrimaryDisplay() {
-  gfx::Rect bounds = NativePrimaryMonitorBounds();
+  DisplayConfigCache* cache = DisplayConfigCache::GetInstance();
+  gfx::Rect bounds = cache->GetMonitorBounds(0);
   // TODO(oshima): Implement ID and Observer.
   gfx::Display display(0, bounds);
   gfx::Rect rect;
-  if (GetScreenWorkArea(&rect)) {
+  if (cache->GetWorkArea(&rect)) {
     display.set_work_area(rect.Intersect(bounds));
   } else {
     // Return the best we've got.
@@ -153,8 +296,7 @@ gfx::Display Screen::GetDisplayMatching(const gfx::Rect& match_rect) {
 int Screen::GetNumDisplays() {
   // This query is kinda bogus for Linux -- do we want number of X screens?
   // The number of monitors Xinerama has?  We'll just use whatever GDK uses.
-  GdkScreen* screen = gdk_screen_get_default();
-  return gdk_screen_get_n_monitors(screen);
+  return DisplayConfigCache::GetInstance()->GetMonitorCount();
 }
 
 }  // namespace gfx
@@ -0,0 +1,194 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/shadow_cache.h"
+
+#include <math.h>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/memory/singleton.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPaint.h"
+#include "ui/gfx/canvas.h"
+#include "ui/gfx/rect.h"
+#include "ui/gfx/size.h"
+#include "ui/gfx/skbitmap_operations.h"
+
+namespace {
+
+size_t GetMaskByteCount(const SkBitmap& mask) {
+  return mask.getSize();
+}
+
+// Returns the scale from the coordinates of |canvas| to its pixels.
+float GetCanvasScale(gfx::Canvas* canvas) {
+  float scale = fabs(SkScalarToFloat(
+      canvas->sk_canvas()->getTotalMatrix().getScaleX()));
+  return scale > 0 ? scale : 1.0f;
+}
+
+// Returns the standard deviation of the Gaussian blur, in pixels, that
+// approximates the blur SkBlurMaskFilter makes for |blur| at |scale|. Its high
+// quality blur is three box blurs of radius blur / 2 / sqrt(3), and three box
+// blurs of radius r have the variance r * (r + 1).
+double GetBlurSigma(double blur, float scale) {
+  double pass_radius = blur / 2 * 0.57735 * scale;
+  return sqrt(pass_radius * (pass_radius + 1));
+}
+
+}  // namespace
+
+namespace gfx {
+
+// static
+const size_t ShadowCache::kDefaultByteBudget = 4 * 1024 * 1024;
+
+ShadowCache::Key::Key(const std::string& shape_key,
+                      int width,
+                      int height,
+                      double blur,
+                      float scale)
+    : shape_key(shape_key),
+      width(width),
+      height(height),
+      blur(blur),
+      scale(scale) {
+}
+
+bool ShadowCache::Key::operator<(const Key& other) const {
+  if (width != other.width)
+    return width < other.width;
+  if (height != other.height)
+    return height < other.height;
+  if (blur != other.blur)
+    return blur < other.blur;
+  if (scale != other.scale)
+    return scale < other.scale;
+  return shape_key < other.shape_key;
+}
+
+// static
+ShadowCache* ShadowCache::GetInstance() {
+  return Singleton<ShadowCache>::get();
+}
+
+void ShadowCache::PaintShadows(Canvas* canvas,
+                               const std::string& shape_key,
+                               const Rect& bounds,
+                               const ShadowValues& shadows,
+                               const PaintMaskCallback& paint_mask) {
+  if (bounds.IsEmpty())
+    return;
+
+  const float scale = GetCanvasScale(canvas);
+  for (size_t i = 0; i < shadows.size(); ++i) {
+    const ShadowValue& shadow = shadows[i];
+    SkBitmap mask = GetMask(
+        Key(shape_key, bounds.width(), bounds.height(), shadow.blur(), scale),
+        paint_mask);
+    if (mask.isNull())
+      continue;
+
+    // The mask is padded for the blur on each side.
+    const int padding =
+        (mask.width() - static_cast<int>(ceil(bounds.width() * scale))) / 2;
+    SkRect dest;
+    dest.setXYWH(
+        SkFloatToScalar(bounds.x() + shadow.x() - padding / scale),
+        SkFloatToScalar(bounds.y() + shadow.y() - padding / scale),
+        SkFloatToScalar(mask.width() / scale),
+        SkFloatToScalar(mask.height() / scale));
+
+    // Bitmaps of kA8_Config are drawn in the color of the paint.
+    SkPaint paint;
+    paint.setColor(shadow.color());
+    paint.setFilterBitmap(scale != 1.0f);
+    canvas->sk_canvas()->drawBitmapRect(mask, NULL, dest, &paint);
+  }
+}
+
+void ShadowCache::SetByteBudget(size_t byte_budget) {
+  base::AutoLock lock(lock_);
+  byte_budget_ = byte_budget;
+  EvictToBudget();
+}
+
+size_t ShadowCache::GetByteCount() {
+  base::AutoLock lock(lock_);
+  return byte_count_;
+}
+
+void ShadowCache::Clear() {
+  base::AutoLock lock(lock_);
+  cache_.Clear();
+  byte_count_ = 0;
+}
+
+ShadowCache::ShadowCache()
+    : cache_(Cache::NO_AUTO_EVICT),
+      byte_count_(0),
+      byte_budget_(kDefaultByteBudget) {
+  memory_pressure_listener_.reset(new base::MemoryPressureListener(
+      base::Bind(&ShadowCache::OnMemoryPressure, base::Unretained(this))));
+}
+
+ShadowCache::~ShadowCache() {
+}
+
+SkBitmap ShadowCache::GetMask(const Key& key,
+                              const PaintMaskCallback& paint_mask) {
+  {
+    base::AutoLock lock(lock_);
+    Cache::iterator it = cache_.Get(key);
+    if (it != cache_.end())
+      return it->second;
+  }
+
+  // Paint and blur the shape without the lock; another thread painting the
+  // same shape at the same time at worst blurs it twice.
+  const Size size(static_cast<int>(ceil(key.width * key.scale)),
+                  static_cast<int>(ceil(key.height * key.scale)));
+  if (size.IsEmpty())
+    return SkBitmap();
+
+  Canvas shape_canvas(size, false);
+  shape_canvas.sk_canvas()->scale(SkFloatToScalar(key.scale),
+                                  SkFloatToScalar(key.scale));
+  paint_mask.Run(&shape_canvas);
+  SkBitmap mask = SkBitmapOperations::CreateBlurredAlphaMask(
+      shape_canvas.ExtractBitmap(),
+      SkBitmapOperations::GetBoxBlurRadius(GetBlurSigma(key.blur, key.scale)));
+
+  base::AutoLock lock(lock_);
+  Cache::iterator it = cache_.Peek(key);
+  if (it != cache_.end())
+    byte_count_ -= GetMaskByteCount(it->second);
+  cache_.Put(key, mask);
+  byte_count_ += GetMaskByteCount(mask);
+  EvictToBudget();
+  return mask;
+}
+
+void ShadowCache::EvictToBudget() {
+  EvictToByteCount(byte_budget_);
+}
+
+void ShadowCache::EvictToByteCount(size_t byte_count) {
+  lock_.AssertAcquired();
+  while (byte_count_ > byte_count && !cache_.empty()) {
+    Cache::reverse_iterator oldest = cache_.rbegin();
+    byte_count_ -= GetMaskByteCount(oldest->second);
+    cache_.Erase(oldest);
+  }
+}
+
+void ShadowCache::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  base::AutoLock lock(lock_);
+  EvictToByteCount(base::MemoryPressureListener::GetTrimmedBudget(
+      byte_budget_, level));
+}
+
+}  // namespace gfx
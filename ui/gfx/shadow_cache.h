@@ -0,0 +1,118 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GFX_SHADOW_CACHE_H_
+#define UI_GFX_SHADOW_CACHE_H_
+#pragma once
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/memory/mru_cache.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/lock.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/base/ui_export.h"
+#include "ui/gfx/shadow_value.h"
+
+template <typename T> struct DefaultSingletonTraits;
+
+namespace gfx {
+
+class Canvas;
+class Rect;
+
+// ShadowCache paints shadows from blurred alpha masks that it keeps between
+// paints, so text and borders drawn again with the same shadows don't blur
+// them again. A mask is keyed by a string naming the shape the caller paints,
+// the size of the shape, the blur of the shadow and the scale of the canvas;
+// the offset and color of the shadow are applied when the mask is drawn, so
+// shadows that differ only in those share a mask. Missing masks are blurred
+// with SkBitmapOperations::CreateBlurredAlphaMask(). The least recently used
+// masks are evicted when the masks take more than the byte budget, and down to
+// a share of it when memory is short.
+class UI_EXPORT ShadowCache {
+ public:
+  // Paints the shape to mask, in its own coordinates, on the canvas passed in.
+  // Only the alpha of what is painted is used.
+  typedef base::Callback<void(Canvas*)> PaintMaskCallback;
+
+  // The default byte budget: 4MB.
+  static const size_t kDefaultByteBudget;
+
+  static ShadowCache* GetInstance();
+
+  // Paints |shadows| of the shape |shape_key| that fills |bounds| of |canvas|.
+  // |paint_mask| is run to paint the shape when its mask isn't cached. The
+  // same |shape_key| must always paint the same shape for the same size.
+  void PaintShadows(Canvas* canvas,
+                    const std::string& shape_key,
+                    const Rect& bounds,
+                    const ShadowValues& shadows,
+                    const PaintMaskCallback& paint_mask);
+
+  // Sets how many bytes the masks may take, evicting as needed.
+  void SetByteBudget(size_t byte_budget);
+
+  // Returns how many bytes the masks take.
+  size_t GetByteCount();
+
+  // Evicts all the masks.
+  void Clear();
+
+ private:
+  friend struct DefaultSingletonTraits<ShadowCache>;
+
+  struct Key {
+    Key(const std::string& shape_key,
+        int width,
+        int height,
+        double blur,
+        float scale);
+
+    bool operator<(const Key& other) const;
+
+    std::string shape_key;
+    int width;
+    int height;
+    double blur;
+    float scale;
+  };
+  typedef base::MRUCache<Key, SkBitmap> Cache;
+
+  ShadowCache();
+  ~ShadowCache();
+
+  // Returns the mask of the shape painted by |paint_mask| for |key|, blurring
+  // it if it isn't cached.
+  SkBitmap GetMask(const Key& key, const PaintMaskCallback& paint_mask);
+
+  // Evicts the least recently used masks until the cache is within budget.
+  // |lock_| must be held.
+  void EvictToBudget();
+
+  // Evicts the least recently used masks until they take at most
+  // |byte_count| bytes. |lock_| must be held.
+  void EvictToByteCount(size_t byte_count);
+
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+
+  // Guards the members below.
+  base::Lock lock_;
+
+  Cache cache_;
+  size_t byte_count_;
+  size_t byte_budget_;
+
+  scoped_ptr<base::MemoryPressureListener> memory_pressure_listener_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShadowCache);
+};
+
+}  // namespace gfx
+
+#endif  // UI_GFX_SHADOW_CACHE_H_
@@ -0,0 +1,110 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/shadow_cache.h"
+
+#include "base/bind.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "ui/gfx/canvas.h"
+#include "ui/gfx/rect.h"
+#include "ui/gfx/size.h"
+
+namespace gfx {
+
+namespace {
+
+// Fills the 10x10 shape mask and counts the masks painted.
+void PaintSquare(int* paint_count, Canvas* canvas) {
+  ++*paint_count;
+  canvas->FillRect(Rect(0, 0, 10, 10), SK_ColorBLACK);
+}
+
+class ShadowCacheTest : public testing::Test {
+ public:
+  ShadowCacheTest() : cache_(ShadowCache::GetInstance()) {}
+
+  virtual void SetUp() OVERRIDE {
+    cache_->Clear();
+    cache_->SetByteBudget(ShadowCache::kDefaultByteBudget);
+  }
+
+  virtual void TearDown() OVERRIDE {
+    SetUp();
+  }
+
+ protected:
+  ShadowCache* cache_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ShadowCacheTest);
+};
+
+}  // namespace
+
+TEST_F(ShadowCacheTest, ReusesMasks) {
+  Canvas canvas(Size(40, 40), false);
+  int paint_count = 0;
+  ShadowValues shadows;
+  shadows.push_back(ShadowValue(Point(1, 1), 4, SK_ColorRED));
+  // Differs from the first shadow only in offset and color.
+  shadows.push_back(ShadowValue(Point(-1, 2), 4, SK_ColorBLUE));
+
+  cache_->PaintShadows(&canvas, "square", Rect(10, 10, 10, 10), shadows,
+                       base::Bind(&PaintSquare, &paint_count));
+  EXPECT_EQ(1, paint_count);
+  const size_t byte_count = cache_->GetByteCount();
+  EXPECT_GT(byte_count, 0u);
+
+  // Painting elsewhere uses the same mask.
+  cache_->PaintShadows(&canvas, "square", Rect(20, 5, 10, 10), shadows,
+                       base::Bind(&PaintSquare, &paint_count));
+  EXPECT_EQ(1, paint_count);
+  EXPECT_EQ(byte_count, cache_->GetByteCount());
+
+  // The shadows were painted under the shape.
+  SkBitmap bitmap = canvas.ExtractBitmap();
+  SkAutoLockPixels lock(bitmap);
+  EXPECT_NE(0u, SkColorGetA(bitmap.getColor(16, 16)));
+  EXPECT_EQ(0u, SkColorGetA(bitmap.getColor(39, 39)));
+
+  // Another blur, shape or scale needs another mask.
+  shadows[0] = ShadowValue(Point(1, 1), 8, SK_ColorRED);
+  cache_->PaintShadows(&canvas, "square", Rect(10, 10, 10, 10), shadows,
+                       base::Bind(&PaintSquare, &paint_count));
+  EXPECT_EQ(2, paint_count);
+  cache_->PaintShadows(&canvas, "other", Rect(10, 10, 10, 10), shadows,
+                       base::Bind(&PaintSquare, &paint_count));
+  EXPECT_EQ(4, paint_count);
+  canvas.sk_canvas()->scale(SkIntToScalar(2), SkIntToScalar(2));
+  cache_->PaintShadows(&canvas, "other", Rect(0, 0, 10, 10), shadows,
+                       base::Bind(&PaintSquare, &paint_count));
+  EXPECT_EQ(6, paint_count);
+}
+
+TEST_F(ShadowCacheTest, EvictsToBudget) {
+  Canvas canvas(Size(40, 40), false);
+  int paint_count = 0;
+  ShadowValues shadows;
+  shadows.push_back(ShadowValue(Point(), 4, SK_ColorBLACK));
+
+  cache_->PaintShadows(&canvas, "first", Rect(10, 10, 10, 10), shadows,
+                       base::Bind(&PaintSquare, &paint_count));
+  const size_t mask_byte_count = cache_->GetByteCount();
+  cache_->SetByteBudget(mask_byte_count);
+  cache_->PaintShadows(&canvas, "second", Rect(10, 10, 10, 10), shadows,
+                       base::Bind(&PaintSquare, &paint_count));
+  EXPECT_EQ(mask_byte_count, cache_->GetByteCount());
+  EXPECT_EQ(2, paint_count);
+
+  // The first mask was evicted for the second.
+  cache_->PaintShadows(&canvas, "first", Rect(10, 10, 10, 10), shadows,
+                       base::Bind(&PaintSquare, &paint_count));
+  EXPECT_EQ(3, paint_count);
+
+  cache_->SetByteBudget(0);
+  EXPECT_EQ(0u, cache_->GetByteCount());
+}
+
+}  // namespace gfx
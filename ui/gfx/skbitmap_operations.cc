@@ -5,9 +5,13 @@
 #include "ui/gfx/skbitmap_operations.h"
 
 #include <algorithm>
+#include <math.h>
 #include <string.h>
+#include <vector>
 
+#include "base/cpu.h"
 #include "base/logging.h"
+#include "build/build_config.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkColorFilter.h"
@@ -18,6 +22,211 @@
 #include "ui/gfx/point.h"
 #include "ui/gfx/size.h"
 
+#if defined(ARCH_CPU_X86_FAMILY)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || _M_IX86_FP==2
+#define SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+#endif
+
+namespace {
+
+#if defined(SIMD_SSE2)
+// Blends |width| pixels of |first_row| and |second_row| into |dst_row|, giving
+// |second_row| the weight |alpha|. The channels are weighted in double
+// precision and truncated like the scalar loop does, so the results are the
+// same to the bit.
+void BlendRow_SSE2(const uint32* first_row,
+                   const uint32* second_row,
+                   uint32* dst_row,
+                   int width,
+                   double alpha) {
+  const __m128d first_alpha = _mm_set1_pd(1 - alpha);
+  const __m128d second_alpha = _mm_set1_pd(alpha);
+  const __m128i zero = _mm_setzero_si128();
+
+  for (int x = 0; x < width; ++x) {
+    // Widen the four channels of each pixel to 32 bits.
+    __m128i first = _mm_cvtsi32_si128(first_row[x]);
+    first = _mm_unpacklo_epi16(_mm_unpacklo_epi8(first, zero), zero);
+    __m128i second = _mm_cvtsi32_si128(second_row[x]);
+    second = _mm_unpacklo_epi16(_mm_unpacklo_epi8(second, zero), zero);
+
+    // Weigh the two low channels, then the two high ones.
+    __m128d low = _mm_add_pd(
+        _mm_mul_pd(_mm_cvtepi32_pd(first), first_alpha),
+        _mm_mul_pd(_mm_cvtepi32_pd(second), second_alpha));
+    __m128d high = _mm_add_pd(
+        _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(first, 8)), first_alpha),
+        _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(second, 8)), second_alpha));
+
+    // Truncate and narrow the channels back to bytes.
+    __m128i result = _mm_unpacklo_epi64(_mm_cvttpd_epi32(low),
+                                        _mm_cvttpd_epi32(high));
+    result = _mm_packs_epi32(result, result);
+    result = _mm_packus_epi16(result, result);
+    dst_row[x] = _mm_cvtsi128_si32(result);
+  }
+}
+
+// Averages the 2x2 blocks of pixels of |src0| and |src1| into the |count|
+// pixels of |dst|. Each block must lie fully within the rows. Each channel is
+// the sum of the four pixels shifted right by two, as in the scalar loop.
+void DownsampleRow_SSE2(const SkPMColor* src0,
+                        const SkPMColor* src1,
+                        SkPMColor* dst,
+                        int count) {
+  const __m128i zero = _mm_setzero_si128();
+  int x = 0;
+  for (; x + 1 < count; x += 2) {
+    // Two blocks: four pixels from each row.
+    __m128i row0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src0));
+    __m128i row1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1));
+
+    // Sum the rows with 16 bits per channel.
+    __m128i left = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero),
+                                 _mm_unpacklo_epi8(row1, zero));
+    __m128i right = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero),
+                                  _mm_unpackhi_epi8(row1, zero));
+
+    // Sum the columns of each block into the low half.
+    left = _mm_add_epi16(left, _mm_srli_si128(left, 8));
+    right = _mm_add_epi16(right, _mm_srli_si128(right, 8));
+
+    __m128i sum = _mm_srli_epi16(_mm_unpacklo_epi64(left, right), 2);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst),
+                     _mm_packus_epi16(sum, sum));
+
+    src0 += 4;
+    src1 += 4;
+    dst += 2;
+  }
+  if (x < count) {
+    __m128i row0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src0));
+    __m128i row1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src1));
+    __m128i sum = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero),
+                                _mm_unpacklo_epi8(row1, zero));
+    sum = _mm_add_epi16(sum, _mm_srli_si128(sum, 8));
+    sum = _mm_srli_epi16(sum, 2);
+    *dst = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+  }
+}
+
+// Adds |row|, |width| alpha values, to the column sums |sums|, or subtracts it
+// if |subtract| is true. Eight columns are done at a time; the caller does the
+// remainder.
+void AddRowToSums_SSE2(const uint8* row, uint16* sums, int width,
+                       bool subtract) {
+  const __m128i zero = _mm_setzero_si128();
+  for (int x = 0; x + 8 <= width; x += 8) {
+    __m128i values = _mm_unpacklo_epi8(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + x)), zero);
+    __m128i* sum = reinterpret_cast<__m128i*>(sums + x);
+    __m128i result = subtract ?
+        _mm_sub_epi16(_mm_loadu_si128(sum), values) :
+        _mm_add_epi16(_mm_loadu_si128(sum), values);
+    _mm_storeu_si128(sum, result);
+  }
+}
+
+// Writes the averages of the column sums |sums| to |out|, as
+// ((sum + half) * multiplier) >> 16 like the scalar loop does. Eight columns
+// are done at a time; the caller does the remainder.
+void WriteColumnAverages_SSE2(const uint16* sums, uint8* out, int width,
+                              uint16 half, uint16 multiplier) {
+  const __m128i halves = _mm_set1_epi16(half);
+  const __m128i multipliers = _mm_set1_epi16(multiplier);
+  for (int x = 0; x + 8 <= width; x += 8) {
+    __m128i sum = _mm_add_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + x)), halves);
+    __m128i average = _mm_mulhi_epu16(sum, multipliers);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x),
+                     _mm_packus_epi16(average, average));
+  }
+}
+#endif  // defined(SIMD_SSE2)
+
+// The number of box blur passes CreateBlurredAlphaMask() makes in each
+// direction. Three passes are within a few percent of a Gaussian blur.
+const int kBoxBlurPasses = 3;
+
+// Box blurs are averages over 2 * radius + 1 values, computed in 16 bits as
+// ((sum + half) * multiplier) >> 16, which needs the sums to fit in 16 bits.
+const int kMaxBoxBlurRadius = 126;
+
+// Box blurs the |width| alpha values of |in| into |out|.
+void BoxBlurRow(const uint8* in, uint8* out, int width, int radius) {
+  const uint32 diameter = 2 * radius + 1;
+  const uint32 half = diameter / 2;
+  const uint32 multiplier = 65536 / diameter;
+  uint32 sum = 0;
+  for (int x = 0; x < radius && x < width; ++x)
+    sum += in[x];
+  for (int x = 0; x < width; ++x) {
+    if (x + radius < width)
+      sum += in[x + radius];
+    out[x] = static_cast<uint8>(((sum + half) * multiplier) >> 16);
+    if (x - radius >= 0)
+      sum -= in[x - radius];
+  }
+}
+
+// Box blurs the columns of the |width| x |height| alpha values of |in| into
+// |out|, keeping a running sum for every column so that whole rows are added
+// and written at a time. |radius| must be positive for the multiplier to fit
+// in 16 bits.
+void BoxBlurColumns(const uint8* in, uint8* out, int width, int height,
+                    int radius, bool use_sse2) {
+  DCHECK_GT(radius, 0);
+  const uint16 diameter = 2 * radius + 1;
+  const uint16 half = diameter / 2;
+  const uint16 multiplier = 65536 / diameter;
+  std::vector<uint16> sums(width, 0);
+
+  // The SSE2 loops leave the last width % 8 columns to the scalar ones.
+  int first_scalar_x = 0;
+#if defined(SIMD_SSE2)
+  if (use_sse2)
+    first_scalar_x = width & ~7;
+#endif
+
+  for (int y = -radius; y < height; ++y) {
+    if (y + radius < height) {
+      const uint8* row = in + (y + radius) * width;
+#if defined(SIMD_SSE2)
+      if (use_sse2)
+        AddRowToSums_SSE2(row, &sums[0], width, false);
+#endif
+      for (int x = first_scalar_x; x < width; ++x)
+        sums[x] += row[x];
+    }
+    if (y < 0)
+      continue;
+
+    uint8* out_row = out + y * width;
+#if defined(SIMD_SSE2)
+    if (use_sse2)
+      WriteColumnAverages_SSE2(&sums[0], out_row, width, half, multiplier);
+#endif
+    for (int x = first_scalar_x; x < width; ++x) {
+      out_row[x] = static_cast<uint8>(
+          ((static_cast<uint32>(sums[x]) + half) * multiplier) >> 16);
+    }
+
+    if (y - radius >= 0) {
+      const uint8* row = in + (y - radius) * width;
+#if defined(SIMD_SSE2)
+      if (use_sse2)
+        AddRowToSums_SSE2(row, &sums[0], width, true);
+#endif
+      for (int x = first_scalar_x; x < width; ++x)
+        sums[x] -= row[x];
+    }
+  }
+}
+
+}  // namespace
+
 // static
 SkBitmap SkBitmapOperations::CreateInvertedBitmap(const SkBitmap& image) {
   DCHECK(image.config() == SkBitmap::kARGB_8888_Config);
@@ -93,6 +302,19 @@ SkBitmap SkBitmapOperations::CreateBlendedBitmap(const SkBitmap& first,
   else if (alpha > alpha_max)
     return second;
 
+  base::CPU cpu;
+  return CreateBlendedBitmapImpl(first, second, alpha, cpu.has_sse2());
+}
+
+// static
+SkBitmap SkBitmapOperations::CreateBlendedBitmapImpl(const SkBitmap& first,
+                                                     const SkBitmap& second,
+                                                     double alpha,
+                                                     bool use_sse2) {
+#if !defined(SIMD_SSE2)
+  use_sse2 = false;
+#endif
+
   SkAutoLockPixels lock_first(first);
   SkAutoLockPixels lock_second(second);
 
@@ -109,6 +331,13 @@ SkBitmap SkBitmapOperations::CreateBlendedBitmap(const SkBitmap& first,
     uint32* second_row = second.getAddr32(0, y);
     uint32* dst_row = blended.getAddr32(0, y);
 
+#if defined(SIMD_SSE2)
+    if (use_sse2) {
+      BlendRow_SSE2(first_row, second_row, dst_row, first.width(), alpha);
+      continue;
+    }
+#endif
+
     for (int x = 0; x < first.width(); ++x) {
       uint32 first_pixel = first_row[x];
       uint32 second_pixel = second_row[x];
@@ -631,6 +860,17 @@ SkBitmap SkBitmapOperations::DownsampleByTwo(const SkBitmap& bitmap) {
   if ((bitmap.width() <= 1) || (bitmap.height() <= 1))
     return bitmap;
 
+  base::CPU cpu;
+  return DownsampleByTwoImpl(bitmap, cpu.has_sse2());
+}
+
+// static
+SkBitmap SkBitmapOperations::DownsampleByTwoImpl(const SkBitmap& bitmap,
+                                                 bool use_sse2) {
+#if !defined(SIMD_SSE2)
+  use_sse2 = false;
+#endif
+
   SkBitmap result;
   result.setConfig(SkBitmap::kARGB_8888_Config,
                    (bitmap.width() + 1) / 2, (bitmap.height() + 1) / 2);
@@ -650,7 +890,19 @@ SkBitmap SkBitmapOperations::DownsampleByTwo(const SkBitmap& bitmap) {
 
     SkPMColor* SK_RESTRICT cur_dst = result.getAddr32(0, dest_y);
 
-    for (int dest_x = 0; dest_x <= resultLastX; ++dest_x) {
+    int dest_x = 0;
+#if defined(SIMD_SSE2)
+    if (use_sse2) {
+      // Only the last column of an odd width has no full block.
+      dest_x = bitmap.width() / 2;
+      DownsampleRow_SSE2(cur_src0, cur_src1, cur_dst, dest_x);
+      cur_src0 += dest_x * 2;
+      cur_src1 += dest_x * 2;
+      cur_dst += dest_x;
+    }
+#endif
+
+    for (; dest_x <= resultLastX; ++dest_x) {
       // This code is based on downsampleby2_proc32 in SkBitmap.cpp. It is very
       // clever in that it does two channels at once: alpha and green ("ag")
       // and red and blue ("rb"). Each channel gets averaged across 4 pixels
@@ -806,3 +1058,77 @@ SkBitmap SkBitmapOperations::CreateDropShadow(
   canvas.drawBitmap(bitmap, SkIntToScalar(0), SkIntToScalar(0));
   return image_with_shadow;
 }
+
+// static
+int SkBitmapOperations::GetBoxBlurRadius(double sigma) {
+  // Each pass of a box blur of radius r has the variance r * (r + 1) / 3.
+  double radius = (sqrt(1 + 4 * sigma * sigma) - 1) / 2;
+  return std::min(kMaxBoxBlurRadius,
+                  std::max(0, static_cast<int>(radius + 0.5)));
+}
+
+// static
+int SkBitmapOperations::GetBlurredAlphaMaskPadding(int radius) {
+  return kBoxBlurPasses * radius;
+}
+
+// static
+SkBitmap SkBitmapOperations::CreateBlurredAlphaMask(const SkBitmap& bitmap,
+                                                    int radius) {
+  base::CPU cpu;
+  return CreateBlurredAlphaMaskImpl(bitmap, radius, cpu.has_sse2());
+}
+
+// static
+SkBitmap SkBitmapOperations::CreateBlurredAlphaMaskImpl(const SkBitmap& bitmap,
+                                                        int radius,
+                                                        bool use_sse2) {
+#if !defined(SIMD_SSE2)
+  use_sse2 = false;
+#endif
+  DCHECK(bitmap.config() == SkBitmap::kARGB_8888_Config ||
+         bitmap.config() == SkBitmap::kA8_Config);
+  DCHECK_GE(radius, 0);
+  DCHECK_LE(radius, kMaxBoxBlurRadius);
+
+  const int padding = GetBlurredAlphaMaskPadding(radius);
+  const int width = bitmap.width() + 2 * padding;
+  const int height = bitmap.height() + 2 * padding;
+  std::vector<uint8> alpha(width * height, 0);
+  {
+    SkAutoLockPixels lock(bitmap);
+    for (int y = 0; y < bitmap.height(); ++y) {
+      uint8* out = &alpha[(y + padding) * width + padding];
+      if (bitmap.config() == SkBitmap::kA8_Config) {
+        memcpy(out, bitmap.getAddr8(0, y), bitmap.width());
+      } else {
+        const SkPMColor* in = bitmap.getAddr32(0, y);
+        for (int x = 0; x < bitmap.width(); ++x)
+          out[x] = SkGetPackedA32(in[x]);
+      }
+    }
+  }
+
+  // Box blurs are separable, so all the row passes are done before the
+  // column passes.
+  if (radius > 0 && width > 0 && height > 0) {
+    std::vector<uint8> scratch(alpha.size());
+    for (int pass = 0; pass < kBoxBlurPasses; ++pass) {
+      for (int y = 0; y < height; ++y)
+        BoxBlurRow(&alpha[y * width], &scratch[y * width], width, radius);
+      alpha.swap(scratch);
+    }
+    for (int pass = 0; pass < kBoxBlurPasses; ++pass) {
+      BoxBlurColumns(&alpha[0], &scratch[0], width, height, radius, use_sse2);
+      alpha.swap(scratch);
+    }
+  }
+
+  SkBitmap result;
+  result.setConfig(SkBitmap::kA8_Config, width, height);
+  result.allocPixels();
+  SkAutoLockPixels lock(result);
+  for (int y = 0; y < height; ++y)
+    memcpy(result.getAddr8(0, y), &alpha[y * width], width);
+  return result;
+}
@@ -110,11 +110,42 @@ class UI_EXPORT SkBitmapOperations {
   static SkBitmap CreateDropShadow(const SkBitmap& bitmap,
                                    const gfx::ShadowValues& shadows);
 
+  // Returns the radius of the box blur that CreateBlurredAlphaMask() uses to
+  // approximate a Gaussian blur with the standard deviation |sigma|, in
+  // pixels.
+  static int GetBoxBlurRadius(double sigma);
+
+  // Returns how many pixels CreateBlurredAlphaMask() pads each side of a
+  // bitmap with for a blur of |radius|.
+  static int GetBlurredAlphaMaskPadding(int radius);
+
+  // Create a kA8_Config bitmap of the alpha channel of |bitmap| blurred with
+  // three passes of a box blur of |radius| in each direction, which
+  // approximates a Gaussian blur at a fraction of its cost. The result is
+  // padded with GetBlurredAlphaMaskPadding(radius) pixels on each side for the
+  // blur to spread into. The image must use the kARGB_8888_Config or
+  // kA8_Config config.
+  static SkBitmap CreateBlurredAlphaMask(const SkBitmap& bitmap, int radius);
+
  private:
   SkBitmapOperations();  // Class for scoping only.
 
+  // The implementations of CreateBlendedBitmap(), DownsampleByTwo() and
+  // CreateBlurredAlphaMask(). They
+  // use SSE2 when |use_sse2| is true and the binary was built with SSE2
+  // support, and give the same results to the bit either way.
+  static SkBitmap CreateBlendedBitmapImpl(const SkBitmap& first,
+                                          const SkBitmap& second,
+                                          double alpha,
+                                          bool use_sse2);
+  static SkBitmap DownsampleByTwoImpl(const SkBitmap& bitmap, bool use_sse2);
+  static SkBitmap CreateBlurredAlphaMaskImpl(const SkBitmap& bitmap,
+                                             int radius,
+                                             bool use_sse2);
+
   FRIEND_TEST_ALL_PREFIXES(SkBitmapOperationsTest, DownsampleByTwo);
   FRIEND_TEST_ALL_PREFIXES(SkBitmapOperationsTest, DownsampleByTwoSmall);
+  FRIEND_TEST_ALL_PREFIXES(SkBitmapOperationsTest, SSE2MatchesScalar);
 };
 
 #endif  // UI_GFX_SKBITMAP_OPERATIONS_H_
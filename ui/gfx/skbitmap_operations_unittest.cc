@@ -4,6 +4,10 @@
 
 #include "ui/gfx/skbitmap_operations.h"
 
+#include <math.h>
+#include <string.h>
+
+#include "base/cpu.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkColorPriv.h"
@@ -40,6 +44,53 @@ bool BitmapsClose(const SkBitmap& a, const SkBitmap& b) {
   return true;
 }
 
+bool BitmapsEqual(const SkBitmap& a, const SkBitmap& b) {
+  if (a.width() != b.width() || a.height() != b.height())
+    return false;
+
+  SkAutoLockPixels a_lock(a);
+  SkAutoLockPixels b_lock(b);
+
+  for (int y = 0; y < a.height(); y++) {
+    for (int x = 0; x < a.width(); x++) {
+      if (*a.getAddr32(x, y) != *b.getAddr32(x, y))
+        return false;
+    }
+  }
+  return true;
+}
+
+// Fills |bmp| with premultiplied pixels that vary from one to the next, using
+// |seed| to start a simple linear congruential generator.
+// Returns true if the kA8_Config bitmaps |a| and |b| are the same.
+bool AlphaMasksEqual(const SkBitmap& a, const SkBitmap& b) {
+  if (a.config() != SkBitmap::kA8_Config ||
+      b.config() != SkBitmap::kA8_Config ||
+      a.width() != b.width() || a.height() != b.height())
+    return false;
+
+  SkAutoLockPixels a_lock(a);
+  SkAutoLockPixels b_lock(b);
+  for (int y = 0; y < a.height(); ++y) {
+    if (memcmp(a.getAddr8(0, y), b.getAddr8(0, y), a.width()) != 0)
+      return false;
+  }
+  return true;
+}
+
+void FillRandomDataToBitmap(int w, int h, uint32 seed, SkBitmap* bmp) {
+  bmp->setConfig(SkBitmap::kARGB_8888_Config, w, h);
+  bmp->allocPixels();
+
+  SkAutoLockPixels lock(*bmp);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      seed = seed * 1103515245 + 12345;
+      *bmp->getAddr32(x, y) = SkPreMultiplyColor(seed);
+    }
+  }
+}
+
 void FillDataToBitmap(int w, int h, SkBitmap* bmp) {
   bmp->setConfig(SkBitmap::kARGB_8888_Config, w, h);
   bmp->allocPixels();
@@ -515,3 +566,93 @@ TEST(SkBitmapOperationsTest, CreateTransposedBitmap) {
     }
   }
 }
+
+// The SSE2 versions of the operations must give the same results to the bit
+// as the scalar ones, for odd sizes too.
+TEST(SkBitmapOperationsTest, SSE2MatchesScalar) {
+  base::CPU cpu;
+  if (!cpu.has_sse2())
+    return;
+
+  int sizes[][2] = { {1, 1}, {2, 2}, {3, 5}, {7, 4}, {16, 16}, {37, 19} };
+  for (size_t i = 0; i < arraysize(sizes); ++i) {
+    SkBitmap first, second;
+    FillRandomDataToBitmap(sizes[i][0], sizes[i][1], i, &first);
+    FillRandomDataToBitmap(sizes[i][0], sizes[i][1], i + 100, &second);
+
+    double alphas[] = { 0.1, 0.25, 0.5, 1.0 / 3, 0.9 };
+    for (size_t j = 0; j < arraysize(alphas); ++j) {
+      EXPECT_TRUE(BitmapsEqual(
+          SkBitmapOperations::CreateBlendedBitmapImpl(first, second,
+                                                      alphas[j], false),
+          SkBitmapOperations::CreateBlendedBitmapImpl(first, second,
+                                                      alphas[j], true)));
+    }
+
+    if (first.width() > 1 && first.height() > 1) {
+      EXPECT_TRUE(BitmapsEqual(
+          SkBitmapOperations::DownsampleByTwoImpl(first, false),
+          SkBitmapOperations::DownsampleByTwoImpl(first, true)));
+    }
+
+    int radii[] = { 1, 2, 5 };
+    for (size_t j = 0; j < arraysize(radii); ++j) {
+      EXPECT_TRUE(AlphaMasksEqual(
+          SkBitmapOperations::CreateBlurredAlphaMaskImpl(first, radii[j],
+                                                         false),
+          SkBitmapOperations::CreateBlurredAlphaMaskImpl(first, radii[j],
+                                                         true)));
+    }
+  }
+}
+
+// Tests that blurred alpha masks are padded for the blur, keep the total
+// alpha and spread a single pixel symmetrically.
+TEST(SkBitmapOperationsTest, CreateBlurredAlphaMask) {
+  SkBitmap src;
+  src.setConfig(SkBitmap::kA8_Config, 9, 5);
+  src.allocPixels();
+  src.eraseARGB(0, 0, 0, 0);
+  {
+    SkAutoLockPixels lock(src);
+    *src.getAddr8(4, 2) = 255;
+  }
+
+  // Without a radius the mask is the alpha channel as is.
+  SkBitmap unblurred = SkBitmapOperations::CreateBlurredAlphaMask(src, 0);
+  EXPECT_TRUE(AlphaMasksEqual(src, unblurred));
+
+  const int radius = 2;
+  const int padding = SkBitmapOperations::GetBlurredAlphaMaskPadding(radius);
+  EXPECT_EQ(3 * radius, padding);
+  SkBitmap blurred = SkBitmapOperations::CreateBlurredAlphaMask(src, radius);
+  ASSERT_EQ(SkBitmap::kA8_Config, blurred.config());
+  EXPECT_EQ(src.width() + 2 * padding, blurred.width());
+  EXPECT_EQ(src.height() + 2 * padding, blurred.height());
+
+  SkAutoLockPixels lock(blurred);
+  const int center_x = 4 + padding;
+  const int center_y = 2 + padding;
+  int total = 0;
+  for (int y = 0; y < blurred.height(); ++y) {
+    for (int x = 0; x < blurred.width(); ++x) {
+      int alpha = *blurred.getAddr8(x, y);
+      total += alpha;
+      EXPECT_EQ(alpha, *blurred.getAddr8(2 * center_x - x, y));
+      EXPECT_EQ(alpha, *blurred.getAddr8(x, 2 * center_y - y));
+      if (x != center_x) {
+        EXPECT_LE(alpha, *blurred.getAddr8(center_x, y));
+      }
+    }
+  }
+  EXPECT_LT(*blurred.getAddr8(center_x, center_y), 255);
+  EXPECT_GT(*blurred.getAddr8(center_x, center_y), 0);
+  EXPECT_EQ(0, *blurred.getAddr8(0, 0));
+  // Rounding each pass loses a little of the total.
+  EXPECT_NEAR(255, total, 255 / 10);
+
+  // Three passes of a box blur of radius r have a variance of r * (r + 1).
+  EXPECT_EQ(0, SkBitmapOperations::GetBoxBlurRadius(0));
+  double sigma = sqrt(radius * (radius + 1.0));
+  EXPECT_EQ(radius, SkBitmapOperations::GetBoxBlurRadius(sigma));
+}
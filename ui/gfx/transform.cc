@@ -3,12 +3,19 @@
 // found in the LICENSE file.
 
 #include "ui/gfx/transform.h"
+
+#include <cmath>
+
 #include "ui/gfx/point3.h"
 #include "ui/gfx/rect.h"
 #include "ui/gfx/skia_util.h"
 
 namespace {
 
+// Matrices whose determinant is smaller than this can't be inverted. This is
+// the threshold SkMatrix44::invert() uses.
+const double kMinInvertibleDeterminant = 1e-8;
+
 static int SymmetricRound(float x) {
   return static_cast<int>(
     x > 0
@@ -16,11 +23,56 @@ static int SymmetricRound(float x) {
       : std::ceil(x - 0.5f));
 }
 
+// The entries of a 2D affine matrix, which maps (x, y) to
+// (a * x + c * y + tx, b * x + d * y + ty).
+struct Affine2D {
+  explicit Affine2D(const SkMatrix44& matrix) {
+    float m[16];
+    matrix.asColMajorf(m);
+    a = m[0];
+    b = m[1];
+    c = m[4];
+    d = m[5];
+    tx = m[12];
+    ty = m[13];
+  }
+
+  float a, b, c, d, tx, ty;
+};
+
+void SetAffine2D(double a, double b, double c, double d,
+                 double tx, double ty,
+                 SkMatrix44* matrix) {
+  matrix->set3x3(SkDoubleToMScalar(a), SkDoubleToMScalar(b), 0,
+                 SkDoubleToMScalar(c), SkDoubleToMScalar(d), 0,
+                 0, 0, 1);
+  matrix->set(0, 3, SkDoubleToMScalar(tx));
+  matrix->set(1, 3, SkDoubleToMScalar(ty));
+}
+
+// Sets |result| to |lhs| * |rhs|. The products are summed in doubles in the
+// order SkMatrix44::setConcat() sums them, leaving out the terms that are 0,
+// so that the result is the same.
+void ConcatAffine2D(const Affine2D& lhs, const Affine2D& rhs,
+                    SkMatrix44* result) {
+  double a = static_cast<double>(lhs.a);
+  double b = static_cast<double>(lhs.b);
+  double c = static_cast<double>(lhs.c);
+  double d = static_cast<double>(lhs.d);
+  SetAffine2D(a * rhs.a + c * rhs.b,
+              b * rhs.a + d * rhs.b,
+              a * rhs.c + c * rhs.d,
+              b * rhs.c + d * rhs.d,
+              a * rhs.tx + c * rhs.ty + lhs.tx,
+              b * rhs.tx + d * rhs.ty + lhs.ty,
+              result);
+}
+
 } // namespace
 
 namespace ui {
 
-Transform::Transform() {
+Transform::Transform() : type_(TYPE_IDENTITY) {
   matrix_.reset();
 }
 
@@ -36,6 +88,7 @@ bool Transform::operator!=(const Transform& rhs) const {
 
 void Transform::SetRotate(float degree) {
   matrix_.setRotateDegreesAbout(0, 0, 1, SkFloatToScalar(degree));
+  type_ = TYPE_UNKNOWN;
 }
 
 void Transform::SetRotateAbout(const gfx::Point3f& axis, float degree) {
@@ -43,46 +96,55 @@ void Transform::SetRotateAbout(const gfx::Point3f& axis, float degree) {
                                 axis.y(),
                                 axis.z(),
                                 SkFloatToScalar(degree));
+  type_ = TYPE_UNKNOWN;
 }
 
 void Transform::SetScaleX(float x) {
   matrix_.set(0, 0, SkFloatToScalar(x));
+  type_ = TYPE_UNKNOWN;
 }
 
 void Transform::SetScaleY(float y) {
   matrix_.set(1, 1, SkFloatToScalar(y));
+  type_ = TYPE_UNKNOWN;
 }
 
 void Transform::SetScale(float x, float y) {
   matrix_.setScale(SkFloatToScalar(x),
                    SkFloatToScalar(y),
                    matrix_.get(2, 2));
+  type_ = TYPE_UNKNOWN;
 }
 
 void Transform::SetTranslateX(float x) {
   matrix_.set(0, 3, SkFloatToScalar(x));
+  type_ = TYPE_UNKNOWN;
 }
 
 void Transform::SetTranslateY(float y) {
   matrix_.set(1, 3, SkFloatToScalar(y));
+  type_ = TYPE_UNKNOWN;
 }
 
 void Transform::SetTranslate(float x, float y) {
   matrix_.setTranslate(SkFloatToScalar(x),
                        SkFloatToScalar(y),
                        matrix_.get(2, 3));
+  type_ = TYPE_UNKNOWN;
 }
 
 void Transform::SetPerspectiveDepth(float depth) {
   SkMatrix44 m;
   m.set(3, 2, -1 / depth);
   matrix_ = m;
+  type_ = TYPE_UNKNOWN;
 }
 
 void Transform::ConcatRotate(float degree) {
   SkMatrix44 rot;
   rot.setRotateDegreesAbout(0, 0, 1, SkFloatToScalar(degree));
   matrix_.postConcat(rot);
+  type_ = TYPE_UNKNOWN;
 }
 
 void Transform::ConcatRotateAbout(const gfx::Point3f& axis, float degree) {
@@ -92,69 +154,148 @@ void Transform::ConcatRotateAbout(const gfx::Point3f& axis, float degree) {
                             axis.z(),
                             SkFloatToScalar(degree));
   matrix_.postConcat(rot);
+  type_ = TYPE_UNKNOWN;
 }
 
 void Transform::ConcatScale(float x, float y) {
-  SkMatrix44 scale;
-  scale.setScale(SkFloatToScalar(x), SkFloatToScalar(y), 1);
-  matrix_.postConcat(scale);
+  Transform scale;
+  scale.matrix_.setScale(SkFloatToScalar(x), SkFloatToScalar(y), 1);
+  scale.type_ = TYPE_SCALE_TRANSLATE;
+  ConcatTransform(scale);
 }
 
 void Transform::ConcatTranslate(float x, float y) {
-  SkMatrix44 translate;
-  translate.setTranslate(SkFloatToScalar(x), SkFloatToScalar(y), 0);
-  matrix_.postConcat(translate);
+  Transform translate;
+  translate.matrix_.setTranslate(SkFloatToScalar(x), SkFloatToScalar(y), 0);
+  translate.type_ = TYPE_TRANSLATE;
+  ConcatTransform(translate);
 }
 
 void Transform::PreconcatTransform(const Transform& transform) {
-  if (!transform.matrix_.isIdentity()) {
+  MatrixType type = transform.GetType();
+  if (type == TYPE_IDENTITY)
+    return;
+  if (type == TYPE_GENERAL || GetType() == TYPE_GENERAL) {
     matrix_.preConcat(transform.matrix_);
+    type_ = TYPE_UNKNOWN;
+    return;
   }
+  ConcatAffine2D(Affine2D(matrix_), Affine2D(transform.matrix_), &matrix_);
+  type_ = TYPE_UNKNOWN;
 }
 
 void Transform::ConcatTransform(const Transform& transform) {
-  if (!transform.matrix_.isIdentity()) {
+  MatrixType type = transform.GetType();
+  if (type == TYPE_IDENTITY)
+    return;
+  if (type == TYPE_GENERAL || GetType() == TYPE_GENERAL) {
     matrix_.postConcat(transform.matrix_);
+    type_ = TYPE_UNKNOWN;
+    return;
   }
+  ConcatAffine2D(Affine2D(transform.matrix_), Affine2D(matrix_), &matrix_);
+  type_ = TYPE_UNKNOWN;
 }
 
 bool Transform::HasChange() const {
-  return !matrix_.isIdentity();
+  return GetType() != TYPE_IDENTITY;
 }
 
 bool Transform::GetInverse(Transform* transform) const {
-  return matrix_.invert(&transform->matrix_);
+  MatrixType type = GetType();
+  if (type == TYPE_GENERAL) {
+    if (!matrix_.invert(&transform->matrix_))
+      return false;
+    transform->type_ = TYPE_UNKNOWN;
+    return true;
+  }
+
+  Affine2D m(matrix_);
+  switch (type) {
+    case TYPE_IDENTITY:
+      transform->matrix_.reset();
+      break;
+    case TYPE_TRANSLATE:
+      transform->matrix_.setTranslate(-m.tx, -m.ty, 0);
+      break;
+    default: {
+      double det = static_cast<double>(m.a) * m.d -
+          static_cast<double>(m.b) * m.c;
+      if (std::abs(det) < kMinInvertibleDeterminant)
+        return false;
+      double inv_det = 1.0 / det;
+      SetAffine2D(m.d * inv_det,
+                  -m.b * inv_det,
+                  -m.c * inv_det,
+                  m.a * inv_det,
+                  (static_cast<double>(m.c) * m.ty -
+                   static_cast<double>(m.d) * m.tx) * inv_det,
+                  (static_cast<double>(m.b) * m.tx -
+                   static_cast<double>(m.a) * m.ty) * inv_det,
+                  &transform->matrix_);
+      break;
+    }
+  }
+  // The inverse of a scale may round to 1.
+  transform->type_ = type <= TYPE_TRANSLATE ? type : TYPE_UNKNOWN;
+  return true;
 }
 
 void Transform::TransformPoint(gfx::Point& point) const {
-  TransformPointInternal(matrix_, point);
+  MatrixType type = GetType();
+  if (type == TYPE_GENERAL) {
+    TransformPointInternal(matrix_, point);
+    return;
+  }
+  if (type == TYPE_IDENTITY)
+    return;
+
+  // Sums the same terms as SkMatrix44::map(), less the ones that are 0.
+  Affine2D m(matrix_);
+  float x = SkIntToScalar(point.x());
+  float y = SkIntToScalar(point.y());
+  point.SetPoint(SymmetricRound(m.a * x + m.c * y + m.tx),
+                 SymmetricRound(m.b * x + m.d * y + m.ty));
 }
 
 void Transform::TransformPoint(gfx::Point3f& point) const {
-  TransformPointInternal(matrix_, point);
+  MatrixType type = GetType();
+  if (type == TYPE_GENERAL) {
+    TransformPointInternal(matrix_, point);
+    return;
+  }
+  if (type == TYPE_IDENTITY)
+    return;
+
+  Affine2D m(matrix_);
+  float x = point.x();
+  float y = point.y();
+  point.SetPoint(m.a * x + m.c * y + m.tx,
+                 m.b * x + m.d * y + m.ty,
+                 point.z());
 }
 
 bool Transform::TransformPointReverse(gfx::Point& point) const {
-  // TODO(sad): Try to avoid trying to invert the matrix.
-  SkMatrix44 inverse;
-  if (!matrix_.invert(&inverse))
+  Transform inverse;
+  if (!GetInverse(&inverse))
     return false;
 
-  TransformPointInternal(inverse, point);
+  inverse.TransformPoint(point);
   return true;
 }
 
 bool Transform::TransformPointReverse(gfx::Point3f& point) const {
-  // TODO(sad): Try to avoid trying to invert the matrix.
-  SkMatrix44 inverse;
-  if (!matrix_.invert(&inverse))
+  Transform inverse;
+  if (!GetInverse(&inverse))
     return false;
 
-  TransformPointInternal(inverse, point);
+  inverse.TransformPoint(point);
   return true;
 }
 
 void Transform::TransformRect(gfx::Rect* rect) const {
+  if (GetType() == TYPE_IDENTITY)
+    return;
   SkRect src = gfx::RectToSkRect(*rect);
   const SkMatrix& matrix = matrix_;
   matrix.mapRect(&src);
@@ -162,16 +303,35 @@ void Transform::TransformRect(gfx::Rect* rect) const {
 }
 
 bool Transform::TransformRectReverse(gfx::Rect* rect) const {
-  SkMatrix44 inverse;
-  if (!matrix_.invert(&inverse))
+  Transform inverse;
+  if (!GetInverse(&inverse))
     return false;
-  const SkMatrix& matrix = inverse;
-  SkRect src = gfx::RectToSkRect(*rect);
-  matrix.mapRect(&src);
-  *rect = gfx::SkRectToRect(src);
+  inverse.TransformRect(rect);
   return true;
 }
 
+Transform::MatrixType Transform::GetType() const {
+  if (type_ != TYPE_UNKNOWN)
+    return type_;
+
+  float m[16];
+  matrix_.asColMajorf(m);
+  if (m[2] != 0 || m[3] != 0 || m[6] != 0 || m[7] != 0 ||
+      m[8] != 0 || m[9] != 0 || m[10] != 1 || m[11] != 0 ||
+      m[14] != 0 || m[15] != 1) {
+    type_ = TYPE_GENERAL;
+  } else if (m[1] != 0 || m[4] != 0) {
+    type_ = TYPE_AFFINE;
+  } else if (m[0] != 1 || m[5] != 1) {
+    type_ = TYPE_SCALE_TRANSLATE;
+  } else if (m[12] != 0 || m[13] != 0) {
+    type_ = TYPE_TRANSLATE;
+  } else {
+    type_ = TYPE_IDENTITY;
+  }
+  return type_;
+}
+
 void Transform::TransformPointInternal(const SkMatrix44& xform,
                                        gfx::Point3f& point) const {
   SkScalar p[4] = {
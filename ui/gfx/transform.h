@@ -19,6 +19,10 @@ namespace ui {
 
 // 4x4 transformation matrix. Transform is cheap and explicitly allows
 // copy/assign.
+//
+// Most transforms only translate, scale or rotate in 2D. Transform keeps
+// track of the kind of matrix it has, and maps points, inverts and
+// concatenates 2D matrices without the 4x4 math, with the same results.
 class UI_EXPORT Transform {
  public:
   Transform();
@@ -110,11 +114,32 @@ class UI_EXPORT Transform {
   // transformed rect.
   bool TransformRectReverse(gfx::Rect* rect) const;
 
-  // Returns the underlying matrix.
+  // Returns the underlying matrix. The kind of the matrix is found again the
+  // next time it is needed after the non-const version is called, so don't
+  // keep the reference to change the matrix after using the transform.
   const SkMatrix44& matrix() const { return matrix_; }
-  SkMatrix44& matrix() { return matrix_; }
+  SkMatrix44& matrix() {
+    type_ = TYPE_UNKNOWN;
+    return matrix_;
+  }
 
  private:
+  // The kinds of matrices, from the simplest. Each kind may also have the
+  // entries of the kinds before it. TYPE_AFFINE adds 2D rotations and skews,
+  // and TYPE_GENERAL is any other matrix, such as the ones with perspective
+  // or that use z.
+  enum MatrixType {
+    TYPE_UNKNOWN,  // Not found since the matrix last changed.
+    TYPE_IDENTITY,
+    TYPE_TRANSLATE,
+    TYPE_SCALE_TRANSLATE,
+    TYPE_AFFINE,
+    TYPE_GENERAL,
+  };
+
+  // Returns the kind of the matrix, finding it if it isn't known.
+  MatrixType GetType() const;
+
   void TransformPointInternal(const SkMatrix44& xform,
                               gfx::Point& point) const;
 
@@ -123,6 +148,9 @@ class UI_EXPORT Transform {
 
   SkMatrix44 matrix_;
 
+  // The kind of |matrix_|, or TYPE_UNKNOWN if it must be found again.
+  mutable MatrixType type_;
+
   // copy/assign are allowed.
 };
 
@@ -4,6 +4,7 @@
 
 #include "ui/gfx/transform.h"
 
+#include <cmath>
 #include <ostream>
 #include <limits>
 
@@ -13,6 +14,10 @@
 
 namespace {
 
+int SymmetricRound(float x) {
+  return static_cast<int>(x > 0 ? std::floor(x + 0.5f) : std::ceil(x - 0.5f));
+}
+
 bool PointsAreNearlyEqual(const gfx::Point3f& lhs,
                           const gfx::Point3f& rhs) {
   float epsilon = 0.0001f;
@@ -512,4 +517,73 @@ TEST(XFormTest, SetRotate2D) {
   }
 }
 
+// Transforms that are 2D skip the 4x4 math. They should give the same results
+// as the matrix does.
+TEST(XFormTest, AffineMatchesMatrix) {
+  ui::Transform translate;
+  translate.SetTranslate(3.25f, -7.5f);
+  ui::Transform scale;
+  scale.SetScale(1.5f, 0.75f);
+  scale.ConcatTranslate(-20.0f, 4.0f);
+  ui::Transform rotate;
+  rotate.SetRotate(30.0f);
+  rotate.ConcatTranslate(11.0f, 13.0f);
+  const ui::Transform transforms[] = { translate, scale, rotate };
+
+  for (size_t i = 0; i < arraysize(transforms); ++i) {
+    for (size_t j = 0; j < arraysize(transforms); ++j) {
+      ui::Transform xform = transforms[i];
+      xform.ConcatTransform(transforms[j]);
+      SkMatrix44 expected;
+      expected.setConcat(transforms[j].matrix(), transforms[i].matrix());
+      EXPECT_TRUE(expected == xform.matrix());
+
+      xform = transforms[i];
+      xform.PreconcatTransform(transforms[j]);
+      expected.setConcat(transforms[i].matrix(), transforms[j].matrix());
+      EXPECT_TRUE(expected == xform.matrix());
+
+      ui::Transform inverse;
+      ASSERT_TRUE(xform.GetInverse(&inverse));
+      ASSERT_TRUE(xform.matrix().invert(&expected));
+      for (int row = 0; row < 4; ++row) {
+        for (int col = 0; col < 4; ++col)
+          EXPECT_EQ(expected.get(row, col), inverse.matrix().get(row, col));
+      }
+
+      for (int x = -50; x <= 50; x += 25) {
+        gfx::Point point(x, 2 * x + 1);
+        SkScalar p[4] = { SkIntToScalar(point.x()), SkIntToScalar(point.y()),
+                          0, 1 };
+        xform.matrix().map(p);
+        xform.TransformPoint(point);
+        EXPECT_EQ(SymmetricRound(p[0]), point.x());
+        EXPECT_EQ(SymmetricRound(p[1]), point.y());
+
+        gfx::Point3f point3(x, 0.5f * x, 7);
+        SkScalar p3[4] = { point3.x(), point3.y(), point3.z(), 1 };
+        xform.matrix().map(p3);
+        xform.TransformPoint(point3);
+        EXPECT_EQ(p3[0], point3.x());
+        EXPECT_EQ(p3[1], point3.y());
+        EXPECT_EQ(p3[2], point3.z());
+      }
+    }
+  }
+
+  // Translations that cancel out leave no change.
+  ui::Transform xform;
+  xform.ConcatTranslate(5, 0);
+  EXPECT_TRUE(xform.HasChange());
+  xform.ConcatTranslate(-5, 0);
+  EXPECT_FALSE(xform.HasChange());
+
+  // Changing the matrix directly is noticed.
+  xform.matrix().set(0, 0, 2);
+  EXPECT_TRUE(xform.HasChange());
+  gfx::Point point(3, 4);
+  xform.TransformPoint(point);
+  EXPECT_EQ(gfx::Point(6, 4), point);
+}
+
 } // namespace
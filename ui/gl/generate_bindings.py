@@ -295,6 +295,10 @@ GL_FUNCTIONS = [
 { 'return_type': 'void',
   'names': ['glGetIntegerv'],
   'arguments': 'GLenum pname, GLint* params', },
+{ 'return_type': 'void',
+  'names': ['glGetProgramBinary', 'glGetProgramBinaryOES'],
+  'arguments': 'GLuint program, GLsizei bufSize, GLsizei* length, '
+               'GLenum* binaryFormat, GLvoid* binary', },
 { 'return_type': 'void',
   'names': ['glGetProgramiv'],
   'arguments': 'GLuint program, GLenum pname, GLint* params', },
@@ -420,6 +424,10 @@ GL_FUNCTIONS = [
 { 'return_type': 'void',
   'names': ['glPolygonOffset'],
   'arguments': 'GLfloat factor, GLfloat units', },
+{ 'return_type': 'void',
+  'names': ['glProgramBinary', 'glProgramBinaryOES'],
+  'arguments': 'GLuint program, GLenum binaryFormat, '
+               'const GLvoid* binary, GLsizei length', },
 { 'return_type': 'void',
   'names': ['glQueryCounter'],
   'arguments': 'GLuint id, GLenum target', },
@@ -1074,6 +1082,50 @@ FUNCTION_SETS = [
     '../../third_party/mesa/MesaLib/include/GL/glxext.h'], []],
 ]
 
+# The functions whose calls the state cache bindings drop when they don't change
+# the shadowed state of the current context. Each maps to the GLStateCache
+# call that decides whether the call reaches the driver.
+STATE_CACHE_FILTERS = {
+  'glActiveTexture': 'ActiveTexture(texture)',
+  'glBindTexture': 'BindTexture(target, texture)',
+  'glBlendFunc': 'BlendFunc(sfactor, dfactor)',
+  'glDisable': 'SetCapability(cap, false)',
+  'glEnable': 'SetCapability(cap, true)',
+  'glUseProgram': 'UseProgram(program)',
+}
+
+# The functions that change shadowed state without setting it. Each maps to the
+# GLStateCache call that records the change.
+STATE_CACHE_INVALIDATIONS = {
+  'glBlendFuncSeparate': 'InvalidateBlendFunc()',
+  'glDeleteProgram': 'DeleteProgram(program)',
+  'glDeleteTextures': 'DeleteTextures(n, textures)',
+}
+
+# The functions that the program cache intercepts while it is enabled. Each
+# maps to the GLProgramCache call that records the call and returns whether
+# the cache handled it, in which case it doesn't reach the driver.
+PROGRAM_CACHE_FILTERS = {
+  'glAttachShader': 'AttachShader(program, shader)',
+  'glBindAttribLocation': 'BindAttribLocation(program, index, name)',
+  'glCompileShader': 'CompileShader(shader)',
+  'glDeleteProgram': 'DeleteProgram(program)',
+  'glDeleteShader': 'DeleteShader(shader)',
+  'glDetachShader': 'DetachShader(program, shader)',
+  'glGetShaderInfoLog': 'GetShaderInfoLog(shader)',
+  'glGetShaderiv': 'GetShaderiv(shader, pname, params)',
+  'glLinkProgram': 'LinkProgram(program)',
+  'glShaderSource': 'ShaderSource(shader, count, str, length)',
+}
+
+# The functions whose results the program cache records. Each maps to the
+# GLProgramCache call that records the result.
+PROGRAM_CACHE_RESULTS = {
+  'glCreateProgram': 'CreateProgram(result)',
+  'glCreateShader': 'CreateShader(result)',
+}
+
+
 def GenerateHeader(file, functions, set_name, used_extension_functions):
   """Generates gl_binding_autogen_x.h"""
 
@@ -1097,6 +1149,7 @@ def GenerateHeader(file, functions, set_name, used_extension_functions):
   file.write('void InitializeGLExtensionBindings%s(GLContext* context);\n' %
       set_name.upper())
   file.write('void InitializeDebugGLBindings%s();\n' % set_name.upper())
+  file.write('void InitializeStateCacheGLBindings%s();\n' % set_name.upper())
   file.write('void ClearGLBindings%s();\n' % set_name.upper())
 
   # Write typedefs for function pointer types. Always use the GL name for the
@@ -1132,9 +1185,68 @@ def GenerateHeader(file, functions, set_name, used_extension_functions):
       set_name.upper())
 
 
+def GetArgumentNames(arguments):
+  """Returns the comma separated names of the arguments of a function."""
+  argument_names = re.sub(
+      r'(const )?[a-zA-Z0-9_]+\** ([a-zA-Z0-9_]+)', r'\2', arguments)
+  argument_names = re.sub(
+      r'(const )?[a-zA-Z0-9_]+\** ([a-zA-Z0-9_]+)', r'\2', argument_names)
+  if argument_names == 'void':
+    argument_names = ''
+  return argument_names
+
+
+def GroupExtensionFunctions(ext_functions):
+  """Groups the functions of an extension by their entry point.
+
+  Args:
+    ext_functions: List of (entry point name, function name) of an extension.
+  Returns:
+    List of (entry point name, function names), in the order of the entry
+    points' first function.
+  """
+  groups = collections.OrderedDict()
+  for entry_point_name, function_name in ext_functions:
+    groups.setdefault(entry_point_name, []).append(function_name)
+  return groups.items()
+
+
+def WriteLazyFunction(file, func, lazy_name, get_proc_address, names):
+  """Writes the trampoline Lazy_|lazy_name| for the entry point of |func|,
+  which looks up |names| in turn with |get_proc_address| the first time it is
+  called."""
+  first_name = func['names'][0]
+  return_type = func['return_type']
+  arguments = func['arguments']
+  argument_names = GetArgumentNames(arguments)
+  file.write('\n')
+  file.write('static %s GL_BINDING_CALL Lazy_%s(%s) {\n' %
+      (return_type, lazy_name, arguments))
+  for i, name in enumerate(names):
+    if i:
+      file.write('  if (!proc)\n')
+      file.write('    proc = ')
+    else:
+      file.write('  %sProc proc = ' % first_name)
+    file.write('reinterpret_cast<%sProc>(%s("%s"));\n' %
+        (first_name, get_proc_address, name))
+  file.write('  CHECK(proc) << "%s is not available.";\n' % names[0])
+  for pointer in ['g_%s', 'g_state_cache_%s', 'g_debug_%s']:
+    pointer = pointer % first_name
+    file.write('  if (%s == Lazy_%s)\n' % (pointer, lazy_name))
+    file.write('    %s = proc;\n' % pointer)
+  if return_type == 'void':
+    file.write('  proc(%s);\n' % argument_names)
+  else:
+    file.write('  return proc(%s);\n' % argument_names)
+  file.write('}\n')
+
+
 def GenerateSource(file, functions, set_name, used_extension_functions):
   """Generates gl_binding_autogen_x.cc"""
 
+  functions_by_name = dict((func['names'][0], func) for func in functions)
+
   # Write file header.
   file.write('// Copyright (c) 2011 The Chromium Authors. All rights reserved.\n')
   file.write('// Use of this source code is governed by a BSD-style license that can be\n')
@@ -1143,10 +1255,13 @@ def GenerateSource(file, functions, set_name, used_extension_functions):
   file.write('// This file is automatically generated.\n')
   file.write('\n')
   file.write('#include <string>\n')
+  file.write('#include "base/debug/trace_event.h"\n')
   file.write('#include "gpu/command_buffer/common/gles2_cmd_utils.h"\n')
   file.write('#include "ui/gl/gl_bindings.h"\n')
   file.write('#include "ui/gl/gl_context.h"\n')
   file.write('#include "ui/gl/gl_implementation.h"\n')
+  file.write('#include "ui/gl/gl_program_cache.h"\n')
+  file.write('#include "ui/gl/gl_state_cache.h"\n')
 
   # Write definitions for booleans indicating which extensions are available.
   file.write('\n')
@@ -1161,6 +1276,8 @@ def GenerateSource(file, functions, set_name, used_extension_functions):
   file.write('\n')
   file.write('static bool g_debugBindingsInitialized;\n')
   file.write('static void UpdateDebugGLExtensionBindings();\n')
+  file.write('static bool g_stateCacheBindingsInitialized;\n')
+  file.write('static void UpdateStateCacheGLExtensionBindings();\n')
   file.write('\n')
   for func in functions:
     file.write('%sProc g_%s;\n' % (func['names'][0], func['names'][0]))
@@ -1170,44 +1287,67 @@ def GenerateSource(file, functions, set_name, used_extension_functions):
     file.write('static %sProc g_debug_%s;\n' %
                (func['names'][0], func['names'][0]))
 
-  # Write function to initialize the core function pointers. The code assumes
-  # any non-NULL pointer returned by GetGLCoreProcAddress() is valid, although
-  # it may be overwritten by an extension function pointer later.
+  file.write('\n')
+  for func in functions:
+    file.write('static %sProc g_state_cache_%s;\n' %
+               (func['names'][0], func['names'][0]))
+
+  # Write the trampolines that the function pointers start out as. Looking up
+  # every entry point when GL is initialized takes hundreds of dlsym() and
+  # GetProcAddress calls, most of them for functions that are never called, so
+  # each entry point is only looked up the first time it is called. Its
+  # trampoline then replaces itself wherever it was installed, in the function
+  # pointer or in the pointer of the state cache or debug function wrapping
+  # it, and later calls go straight to the driver. Threads that race to the
+  # first call look up and store the same pointer.
+  file.write('\n')
+  file.write('extern "C" {\n')
+  for func in functions:
+    WriteLazyFunction(file, func, func['names'][0], 'GetGLCoreProcAddress',
+                      func['names'])
+  for extension, ext_functions in used_extension_functions:
+    for entry_point_name, function_names in GroupExtensionFunctions(
+        ext_functions):
+      WriteLazyFunction(file, functions_by_name[entry_point_name],
+                        '%s_%s' % (entry_point_name, extension),
+                        'GetGLProcAddress', function_names)
+  file.write('}  // extern "C"\n')
+
+  # Write function to initialize the core function pointers to their
+  # trampolines. The code assumes any non-NULL pointer returned by
+  # GetGLCoreProcAddress() is valid, although it may be overwritten by an
+  # extension function pointer later.
   file.write('\n')
   file.write('void InitializeGLBindings%s() {\n' % set_name.upper())
+  file.write('  TRACE_EVENT0("gpu", "InitializeGLBindings%s");\n' %
+      set_name.upper())
   for func in functions:
-    first_name = func['names'][0]
-    for i, name in enumerate(func['names']):
-      if i:
-        file.write('  if (!g_%s)\n  ' % first_name)
-      file.write(
-          '  g_%s = reinterpret_cast<%sProc>(GetGLCoreProcAddress("%s"));\n' %
-              (first_name, first_name, name))
+    file.write('  g_%s = Lazy_%s;\n' % (func['names'][0], func['names'][0]))
   file.write('}\n')
   file.write('\n')
 
   # Write function to initialize the extension function pointers. This function
   # uses a current context to query which extensions are actually supported.
+  # The pointers of the functions of unsupported extensions are left alone, so
+  # that callers can still test for them.
   file.write('void InitializeGLExtensionBindings%s(GLContext* context) {\n' %
       set_name.upper())
+  file.write('  TRACE_EVENT0("gpu", "InitializeGLExtensionBindings%s");\n' %
+      set_name.upper())
   file.write('  DCHECK(context && context->IsCurrent(NULL));\n')
   for extension, ext_functions in used_extension_functions:
     file.write('  g_%s = context->HasExtension("%s");\n' %
         (extension, extension))
     file.write('  if (g_%s) {\n' %
         (extension))
-    queried_entry_points = set()
-    for entry_point_name, function_name in ext_functions:
-      # Replace the pointer unconditionally unless this extension has several
-      # alternatives for the same entry point (e.g.,
-      # GL_ARB_blend_func_extended).
-      if entry_point_name in queried_entry_points:
-        file.write('    if (!g_%s)\n  ' % entry_point_name)
-      file.write(
-         '    g_%s = reinterpret_cast<%sProc>(GetGLProcAddress("%s"));\n' %
-             (entry_point_name, entry_point_name, function_name))
-      queried_entry_points.add(entry_point_name)
+    # An extension that has several alternatives for the same entry point
+    # (e.g., GL_ARB_blend_func_extended) gets one trampoline trying each.
+    for entry_point_name, _ in GroupExtensionFunctions(ext_functions):
+      file.write('    g_%s = Lazy_%s_%s;\n' %
+          (entry_point_name, entry_point_name, extension))
     file.write('  }\n')
+  file.write('  if (g_stateCacheBindingsInitialized)\n')
+  file.write('    UpdateStateCacheGLExtensionBindings();\n')
   file.write('  if (g_debugBindingsInitialized)\n')
   file.write('    UpdateDebugGLExtensionBindings();\n')
   file.write('}\n')
@@ -1292,18 +1432,103 @@ def GenerateSource(file, functions, set_name, used_extension_functions):
   file.write('}\n')
 
   # Write function to update the debug function pointers to extension functions
-  # after the extensions have been initialized.
+  # after the extensions have been initialized. The state cache function
+  # pointers are updated first, so an extension function is already wrapped by
+  # its state cache function, which the debug function must then wrap.
   file.write('\n')
   file.write('static void UpdateDebugGLExtensionBindings() {\n')
   for extension, ext_functions in used_extension_functions:
     for name, _ in ext_functions:
-      file.write('  if (g_debug_%s != g_%s &&\n' % (name, name))
-      file.write('      g_%s != Debug_%s) {\n' % (name, name))
+      file.write('  if (g_%s != Debug_%s) {\n' % (name, name))
       file.write('    g_debug_%s = g_%s;\n' % (name, name))
       file.write('    g_%s = Debug_%s;\n' % (name, name))
       file.write('  }\n')
   file.write('}\n')
 
+  # Write state cache wrappers for each function. They count every call, and
+  # consult the state cache of the current context before the calls that set
+  # or change the state it shadows. They also report the calls that build
+  # programs to the program cache.
+  file.write('\n')
+  file.write('extern "C" {\n')
+  for func in functions:
+    names = func['names']
+    return_type = func['return_type']
+    arguments = func['arguments']
+    function_name = names[0]
+    file.write('\n')
+    file.write('static %s GL_BINDING_CALL StateCache_%s(%s) {\n' %
+        (return_type, function_name, arguments))
+    argument_names = re.sub(
+        r'(const )?[a-zA-Z0-9_]+\** ([a-zA-Z0-9_]+)', r'\2', arguments)
+    argument_names = re.sub(
+        r'(const )?[a-zA-Z0-9_]+\** ([a-zA-Z0-9_]+)', r'\2', argument_names)
+    if argument_names == 'void' or argument_names == '':
+      argument_names = ''
+    file.write('  GLStateCache::CountCall();\n')
+    if function_name in PROGRAM_CACHE_FILTERS:
+      file.write('  GLProgramCache* program_cache = '
+                 'GLProgramCache::GetCurrent();\n')
+      file.write('  if (program_cache && program_cache->%s)\n' %
+          PROGRAM_CACHE_FILTERS[function_name])
+      file.write('    return;\n')
+    if function_name in PROGRAM_CACHE_RESULTS:
+      file.write('  %s result = g_state_cache_%s(%s);\n' %
+          (return_type, function_name, argument_names))
+      file.write('  GLProgramCache* program_cache = '
+                 'GLProgramCache::GetCurrent();\n')
+      file.write('  if (program_cache)\n')
+      file.write('    program_cache->%s;\n' %
+          PROGRAM_CACHE_RESULTS[function_name])
+      file.write('  return result;\n')
+      file.write('}\n')
+      continue
+    if function_name in STATE_CACHE_FILTERS:
+      file.write('  GLStateCache* cache = GLStateCache::GetCurrent();\n')
+      file.write('  if (cache && !cache->%s)\n' %
+          STATE_CACHE_FILTERS[function_name])
+      file.write('    return;\n')
+    elif function_name in STATE_CACHE_INVALIDATIONS:
+      file.write('  GLStateCache* cache = GLStateCache::GetCurrent();\n')
+      file.write('  if (cache)\n')
+      file.write('    cache->%s;\n' % STATE_CACHE_INVALIDATIONS[function_name])
+    if return_type == 'void':
+      file.write('  g_state_cache_%s(%s);\n' % (function_name, argument_names))
+    else:
+      file.write('  return g_state_cache_%s(%s);\n' %
+          (function_name, argument_names))
+    file.write('}\n')
+  file.write('}  // extern "C"\n')
+
+  # Write function to initialize the state cache function pointers. The
+  # functions of unsupported extensions stay NULL so that callers can still
+  # test for them.
+  file.write('\n')
+  file.write('void InitializeStateCacheGLBindings%s() {\n' % set_name.upper())
+  for func in functions:
+    first_name = func['names'][0]
+    file.write('  if (!g_state_cache_%s && g_%s) {\n' %
+        (first_name, first_name))
+    file.write('    g_state_cache_%s = g_%s;\n' % (first_name, first_name))
+    file.write('    g_%s = StateCache_%s;\n' % (first_name, first_name))
+    file.write('  }\n')
+  file.write('  g_stateCacheBindingsInitialized = true;\n')
+  file.write('}\n')
+
+  # Write function to update the state cache function pointers to extension
+  # functions after the extensions have been initialized.
+  file.write('\n')
+  file.write('static void UpdateStateCacheGLExtensionBindings() {\n')
+  for extension, ext_functions in used_extension_functions:
+    for name, _ in ext_functions:
+      file.write('  if (g_%s &&\n' % name)
+      file.write('      g_%s != StateCache_%s &&\n' % (name, name))
+      file.write('      g_%s != Debug_%s) {\n' % (name, name))
+      file.write('    g_state_cache_%s = g_%s;\n' % (name, name))
+      file.write('    g_%s = StateCache_%s;\n' % (name, name))
+      file.write('  }\n')
+  file.write('}\n')
+
   # Write function to clear all function pointers.
   file.write('\n')
   file.write('void ClearGLBindings%s() {\n' % set_name.upper())
@@ -1319,6 +1544,11 @@ def GenerateSource(file, functions, set_name, used_extension_functions):
   for func in functions:
     file.write('  g_debug_%s = NULL;\n' % func['names'][0])
   file.write('  g_debugBindingsInitialized = false;\n')
+  # Clear state cache GL bindings.
+  file.write('\n')
+  for func in functions:
+    file.write('  g_state_cache_%s = NULL;\n' % func['names'][0])
+  file.write('  g_stateCacheBindingsInitialized = false;\n')
   file.write('}\n')
 
   file.write('\n')
@@ -49,10 +49,14 @@
         'gl_context_osmesa.h',
         'gl_context_stub.cc',
         'gl_context_stub.h',
+        'gl_context_virtual.cc',
+        'gl_context_virtual.h',
         'gl_context_win.cc',
         'gl_export.h',
         'gl_fence.cc',
         'gl_fence.h',
+        'gl_image.cc',
+        'gl_image.h',
         'gl_implementation.cc',
         'gl_implementation.h',
         'gl_implementation_android.cc',
@@ -61,8 +65,12 @@
         'gl_implementation_win.cc',
         'gl_interface.cc',
         'gl_interface.h',
+        'gl_program_cache.cc',
+        'gl_program_cache.h',
         'gl_share_group.cc',
         'gl_share_group.h',
+        'gl_state_cache.cc',
+        'gl_state_cache.h',
         'gl_surface.cc',
         'gl_surface.h',
         'gl_surface_android.cc',
@@ -71,6 +79,8 @@
         'gl_surface_mac.cc',
         'gl_surface_stub.cc',
         'gl_surface_stub.h',
+        'gl_surface_triple_buffered.cc',
+        'gl_surface_triple_buffered.h',
         'gl_surface_win.cc',
         'gl_surface_osmesa.cc',
         'gl_surface_osmesa.h',
@@ -128,6 +138,8 @@
             'egl_util.h',
             'gl_context_egl.cc',
             'gl_context_egl.h',
+            'gl_image_egl.cc',
+            'gl_image_egl.h',
             'gl_surface_egl.cc',
             'gl_surface_egl.h',
             '<(gl_binding_output_dir)/gl_bindings_autogen_egl.cc',
@@ -141,6 +153,9 @@
           'sources': [
             'gl_context_glx.cc',
             'gl_context_glx.h',
+            'gl_image_glx.cc',
+            'gl_image_glx.h',
+            'gl_image_linux.cc',
             'gl_surface_glx.cc',
             'gl_surface_glx.h',
             '<(gl_binding_output_dir)/gl_bindings_autogen_glx.cc',
@@ -11,6 +11,7 @@
 #include "ui/gl/gl_bindings.h"
 #include "ui/gl/gl_context.h"
 #include "ui/gl/gl_implementation.h"
+#include "ui/gl/gl_state_cache.h"
 #include "ui/gl/gl_surface.h"
 #include "ui/gl/gl_switches.h"
 
@@ -21,7 +22,9 @@ base::LazyInstance<base::ThreadLocalPointer<GLContext> >::Leaky
     current_context_ = LAZY_INSTANCE_INITIALIZER;
 }  // namespace
 
-GLContext::GLContext(GLShareGroup* share_group) : share_group_(share_group) {
+GLContext::GLContext(GLShareGroup* share_group)
+    : share_group_(share_group),
+      state_cache_(new GLStateCache) {
   if (!share_group_.get())
     share_group_ = new GLShareGroup;
 
@@ -67,6 +70,10 @@ GLShareGroup* GLContext::share_group() {
   return share_group_.get();
 }
 
+GLStateCache* GLContext::GetStateCache() {
+  return state_cache_.get();
+}
+
 bool GLContext::LosesAllContextsOnContextLost() {
   switch (GetGLImplementation()) {
     case kGLImplementationDesktopGL:
@@ -10,11 +10,13 @@
 
 #include "base/basictypes.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
 #include "ui/gl/gl_share_group.h"
 #include "ui/gl/gpu_preference.h"
 
 namespace gfx {
 
+class GLStateCache;
 class GLSurface;
 
 // Encapsulates an OpenGL context, hiding platform specific management.
@@ -57,6 +59,10 @@ class GL_EXPORT GLContext : public base::RefCounted<GLContext> {
 
   GLShareGroup* share_group();
 
+  // Returns the shadow of this context's state that the GL bindings use to
+  // drop redundant state changes.
+  GLStateCache* GetStateCache();
+
   // Create a GL context that is compatible with the given surface.
   // |share_group|, if non-NULL, is a group of contexts which the
   // internally created OpenGL context shares textures and other resources.
@@ -86,6 +92,7 @@ class GL_EXPORT GLContext : public base::RefCounted<GLContext> {
   friend class base::RefCounted<GLContext>;
 
   scoped_refptr<GLShareGroup> share_group_;
+  scoped_ptr<GLStateCache> state_cache_;
 
   DISALLOW_COPY_AND_ASSIGN(GLContext);
 };
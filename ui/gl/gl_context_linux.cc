@@ -13,6 +13,7 @@
 #include "ui/gl/gl_context_glx.h"
 #include "ui/gl/gl_context_osmesa.h"
 #include "ui/gl/gl_context_stub.h"
+#include "ui/gl/gl_context_virtual.h"
 #include "ui/gl/gl_implementation.h"
 #include "ui/gl/gl_surface_egl.h"
 #include "ui/gl/gl_surface_glx.h"
@@ -28,6 +29,13 @@ scoped_refptr<GLContext> GLContext::CreateGLContext(
     GLSurface* compatible_surface,
     GpuPreference gpu_preference) {
   TRACE_EVENT0("gpu", "GLContext::CreateGLContext");
+  if (share_group && share_group->IsVirtualized()) {
+    scoped_refptr<GLContext> context(new GLContextVirtual(share_group));
+    if (!context->Initialize(compatible_surface, gpu_preference))
+      return NULL;
+
+    return context;
+  }
   switch (GetGLImplementation()) {
     case kGLImplementationOSMesaGL: {
       scoped_refptr<GLContext> context(new GLContextOSMesa(share_group));
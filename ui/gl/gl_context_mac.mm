@@ -14,6 +14,7 @@
 #include "ui/gl/gl_context_cgl.h"
 #include "ui/gl/gl_context_osmesa.h"
 #include "ui/gl/gl_context_stub.h"
+#include "ui/gl/gl_context_virtual.h"
 #include "ui/gl/gl_implementation.h"
 #include "ui/gl/gl_surface.h"
 #include "ui/gl/gl_switches.h"
@@ -43,6 +44,13 @@ scoped_refptr<GLContext> GLContext::CreateGLContext(
     GLSurface* compatible_surface,
     GpuPreference gpu_preference) {
   TRACE_EVENT0("gpu", "GLContext::CreateGLContext");
+  if (share_group && share_group->IsVirtualized()) {
+    scoped_refptr<GLContext> context(new GLContextVirtual(share_group));
+    if (!context->Initialize(compatible_surface, gpu_preference))
+      return NULL;
+
+    return context;
+  }
   switch (GetGLImplementation()) {
     case kGLImplementationDesktopGL:
     case kGLImplementationAppleGL: {
@@ -0,0 +1,261 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gl/gl_context_virtual.h"
+
+#include "base/debug/trace_event.h"
+#include "base/logging.h"
+#include "ui/gl/gl_bindings.h"
+#include "ui/gl/gl_state_cache.h"
+#include "ui/gl/gl_surface.h"
+
+namespace gfx {
+
+namespace {
+
+// The capabilities that are saved, in the order of State::capabilities.
+const GLenum kCapabilities[] = {
+  GL_BLEND,
+  GL_CULL_FACE,
+  GL_DEPTH_TEST,
+  GL_DITHER,
+  GL_POLYGON_OFFSET_FILL,
+  GL_SAMPLE_ALPHA_TO_COVERAGE,
+  GL_SAMPLE_COVERAGE,
+  GL_SCISSOR_TEST,
+  GL_STENCIL_TEST,
+};
+
+GLint GetInteger(GLenum pname) {
+  GLint value = 0;
+  glGetIntegerv(pname, &value);
+  return value;
+}
+
+GLint GetVertexAttrib(GLuint index, GLenum pname) {
+  GLint value = 0;
+  glGetVertexAttribiv(index, pname, &value);
+  return value;
+}
+
+}  // namespace
+
+GLContextVirtual::VertexAttrib::VertexAttrib()
+    : enabled(false),
+      buffer(0),
+      size(4),
+      type(GL_FLOAT),
+      normalized(false),
+      stride(0),
+      pointer(NULL) {
+}
+
+GLContextVirtual::State::State()
+    : framebuffer(0),
+      renderbuffer(0),
+      array_buffer(0),
+      element_array_buffer(0),
+      program(0),
+      active_texture(GL_TEXTURE0),
+      pack_alignment(4),
+      unpack_alignment(4) {
+  for (int i = 0; i < kSavedTextureUnits; ++i)
+    textures[i] = 0;
+  for (int i = 0; i < kCapabilityCount; ++i)
+    capabilities[i] = kCapabilities[i] == GL_DITHER;
+  blend_func[0] = blend_func[2] = GL_ONE;
+  blend_func[1] = blend_func[3] = GL_ZERO;
+  for (int i = 0; i < 4; ++i) {
+    clear_color[i] = 0;
+    color_mask[i] = GL_TRUE;
+    viewport[i] = 0;
+    scissor[i] = 0;
+  }
+}
+
+GLContextVirtual::GLContextVirtual(GLShareGroup* share_group)
+    : GLContext(share_group) {
+  COMPILE_ASSERT(arraysize(kCapabilities) == kCapabilityCount,
+                 capabilities_count_mismatch);
+}
+
+bool GLContextVirtual::Initialize(GLSurface* compatible_surface,
+                                  GpuPreference gpu_preference) {
+  DCHECK(share_group()->IsVirtualized());
+  real_context_ = share_group()->GetSharedContext();
+  if (!real_context_) {
+    // The real context is kept out of the group, or it would be virtual too.
+    real_context_ = GLContext::CreateGLContext(NULL, compatible_surface,
+                                               gpu_preference);
+    if (!real_context_) {
+      LOG(ERROR) << "Could not create the shared context.";
+      return false;
+    }
+    share_group()->SetSharedContext(real_context_);
+  }
+
+  // Like a new context, start with the viewport covering the surface.
+  gfx::Size size = compatible_surface->GetSize();
+  state_.viewport[2] = state_.scissor[2] = size.width();
+  state_.viewport[3] = state_.scissor[3] = size.height();
+  return true;
+}
+
+void GLContextVirtual::Destroy() {
+  if (!real_context_)
+    return;
+
+  if (GetCurrent() == this)
+    SetRealContextCurrent();
+  if (share_group()->GetSharedContextOwner() == this)
+    share_group()->SetSharedContextOwner(NULL);
+  real_context_ = NULL;
+}
+
+bool GLContextVirtual::MakeCurrent(GLSurface* surface) {
+  DCHECK(real_context_);
+  if (IsCurrent(surface))
+    return true;
+
+  GLContextVirtual* owner =
+      static_cast<GLContextVirtual*>(share_group()->GetSharedContextOwner());
+  if (owner && GetCurrent() == owner)
+    SetRealContextCurrent();
+  if (!real_context_->MakeCurrent(surface))
+    return false;
+  SetCurrent(this, surface);
+
+  if (owner != this) {
+    TRACE_EVENT0("gpu", "GLContextVirtual::SwitchState");
+    // The bindings drop the calls that this context's state cache thinks
+    // change nothing, so it must not remember anything while the real context
+    // holds another state.
+    GetStateCache()->Reset();
+    if (owner)
+      owner->SaveState();
+    GetStateCache()->Reset();
+    RestoreState();
+    share_group()->SetSharedContextOwner(this);
+  }
+  return true;
+}
+
+void GLContextVirtual::ReleaseCurrent(GLSurface* surface) {
+  if (!IsCurrent(surface))
+    return;
+
+  SetRealContextCurrent();
+}
+
+bool GLContextVirtual::IsCurrent(GLSurface* surface) {
+  if (GetCurrent() != this)
+    return false;
+
+  return !surface || GLSurface::GetCurrent() == surface;
+}
+
+void* GLContextVirtual::GetHandle() {
+  return real_context_ ? real_context_->GetHandle() : NULL;
+}
+
+void GLContextVirtual::SetSwapInterval(int interval) {
+  DCHECK(IsCurrent(NULL));
+  GLSurface* surface = GLSurface::GetCurrent();
+  SetRealContextCurrent();
+  real_context_->SetSwapInterval(interval);
+  SetCurrent(this, surface);
+}
+
+bool GLContextVirtual::WasAllocatedUsingARBRobustness() {
+  return real_context_ && real_context_->WasAllocatedUsingARBRobustness();
+}
+
+GLContextVirtual::~GLContextVirtual() {
+  Destroy();
+}
+
+void GLContextVirtual::SaveState() {
+  state_.framebuffer = GetInteger(GL_FRAMEBUFFER_BINDING_EXT);
+  state_.renderbuffer = GetInteger(GL_RENDERBUFFER_BINDING_EXT);
+  state_.array_buffer = GetInteger(GL_ARRAY_BUFFER_BINDING);
+  state_.element_array_buffer = GetInteger(GL_ELEMENT_ARRAY_BUFFER_BINDING);
+  state_.program = GetInteger(GL_CURRENT_PROGRAM);
+  state_.active_texture = GetInteger(GL_ACTIVE_TEXTURE);
+  for (int i = 0; i < kSavedTextureUnits; ++i) {
+    glActiveTexture(GL_TEXTURE0 + i);
+    state_.textures[i] = GetInteger(GL_TEXTURE_BINDING_2D);
+  }
+  for (int i = 0; i < kCapabilityCount; ++i)
+    state_.capabilities[i] = glIsEnabled(kCapabilities[i]) == GL_TRUE;
+  state_.blend_func[0] = GetInteger(GL_BLEND_SRC_RGB);
+  state_.blend_func[1] = GetInteger(GL_BLEND_DST_RGB);
+  state_.blend_func[2] = GetInteger(GL_BLEND_SRC_ALPHA);
+  state_.blend_func[3] = GetInteger(GL_BLEND_DST_ALPHA);
+  glGetFloatv(GL_COLOR_CLEAR_VALUE, state_.clear_color);
+  glGetBooleanv(GL_COLOR_WRITEMASK, state_.color_mask);
+  glGetIntegerv(GL_VIEWPORT, state_.viewport);
+  glGetIntegerv(GL_SCISSOR_BOX, state_.scissor);
+  state_.pack_alignment = GetInteger(GL_PACK_ALIGNMENT);
+  state_.unpack_alignment = GetInteger(GL_UNPACK_ALIGNMENT);
+  for (int i = 0; i < kSavedVertexAttribs; ++i) {
+    VertexAttrib& attrib = state_.attribs[i];
+    attrib.enabled =
+        GetVertexAttrib(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED) == GL_TRUE;
+    attrib.buffer = GetVertexAttrib(i, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING);
+    attrib.size = GetVertexAttrib(i, GL_VERTEX_ATTRIB_ARRAY_SIZE);
+    attrib.type = GetVertexAttrib(i, GL_VERTEX_ATTRIB_ARRAY_TYPE);
+    attrib.normalized =
+        GetVertexAttrib(i, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED) == GL_TRUE;
+    attrib.stride = GetVertexAttrib(i, GL_VERTEX_ATTRIB_ARRAY_STRIDE);
+    glGetVertexAttribPointerv(i, GL_VERTEX_ATTRIB_ARRAY_POINTER,
+                              &attrib.pointer);
+  }
+}
+
+void GLContextVirtual::RestoreState() {
+  glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, state_.framebuffer);
+  glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, state_.renderbuffer);
+  for (int i = 0; i < kSavedVertexAttribs; ++i) {
+    const VertexAttrib& attrib = state_.attribs[i];
+    glBindBuffer(GL_ARRAY_BUFFER, attrib.buffer);
+    glVertexAttribPointer(i, attrib.size, attrib.type, attrib.normalized,
+                          attrib.stride, attrib.pointer);
+    if (attrib.enabled)
+      glEnableVertexAttribArray(i);
+    else
+      glDisableVertexAttribArray(i);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, state_.array_buffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, state_.element_array_buffer);
+  glUseProgram(state_.program);
+  for (int i = 0; i < kSavedTextureUnits; ++i) {
+    glActiveTexture(GL_TEXTURE0 + i);
+    glBindTexture(GL_TEXTURE_2D, state_.textures[i]);
+  }
+  glActiveTexture(state_.active_texture);
+  for (int i = 0; i < kCapabilityCount; ++i) {
+    if (state_.capabilities[i])
+      glEnable(kCapabilities[i]);
+    else
+      glDisable(kCapabilities[i]);
+  }
+  glBlendFuncSeparate(state_.blend_func[0], state_.blend_func[1],
+                      state_.blend_func[2], state_.blend_func[3]);
+  glClearColor(state_.clear_color[0], state_.clear_color[1],
+               state_.clear_color[2], state_.clear_color[3]);
+  glColorMask(state_.color_mask[0], state_.color_mask[1],
+              state_.color_mask[2], state_.color_mask[3]);
+  glViewport(state_.viewport[0], state_.viewport[1],
+             state_.viewport[2], state_.viewport[3]);
+  glScissor(state_.scissor[0], state_.scissor[1],
+            state_.scissor[2], state_.scissor[3]);
+  glPixelStorei(GL_PACK_ALIGNMENT, state_.pack_alignment);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, state_.unpack_alignment);
+}
+
+void GLContextVirtual::SetRealContextCurrent() {
+  SetCurrent(real_context_.get(), GLSurface::GetCurrent());
+}
+
+}  // namespace gfx
@@ -0,0 +1,110 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GL_GL_CONTEXT_VIRTUAL_H_
+#define UI_GL_GL_CONTEXT_VIRTUAL_H_
+#pragma once
+
+#include "base/compiler_specific.h"
+#include "ui/gl/gl_context.h"
+
+namespace gfx {
+
+// A context of a virtualized share group (see GLShareGroup::SetVirtualized).
+// All the virtual contexts of a group draw with the group's one real context,
+// and making one current only makes the real context current with its
+// surface. Textures and other objects are shared since there is only one
+// context.
+//
+// The state that isn't shared, the bindings, the capabilities and the like,
+// is kept in software: the state of the virtual context that used the real
+// context last is read back when another one is made current, and the state
+// of the new one is set again.
+//
+// The real context stays current when a virtual context is released, so that
+// making one current again costs no context switch.
+class GL_EXPORT GLContextVirtual : public GLContext {
+ public:
+  explicit GLContextVirtual(GLShareGroup* share_group);
+
+  // Implement GLContext.
+  virtual bool Initialize(GLSurface* compatible_surface,
+                          GpuPreference gpu_preference) OVERRIDE;
+  virtual void Destroy() OVERRIDE;
+  virtual bool MakeCurrent(GLSurface* surface) OVERRIDE;
+  virtual void ReleaseCurrent(GLSurface* surface) OVERRIDE;
+  virtual bool IsCurrent(GLSurface* surface) OVERRIDE;
+  virtual void* GetHandle() OVERRIDE;
+  virtual void SetSwapInterval(int interval) OVERRIDE;
+  virtual bool WasAllocatedUsingARBRobustness() OVERRIDE;
+
+ protected:
+  virtual ~GLContextVirtual();
+
+ private:
+  // The texture units whose 2D bindings are saved, and the vertex attributes
+  // whose arrays are saved. The compositor's shaders use fewer.
+  enum {
+    kSavedTextureUnits = 4,
+    kSavedVertexAttribs = 4
+  };
+
+  // The capabilities that are saved.
+  enum {
+    kCapabilityCount = 9
+  };
+
+  struct VertexAttrib {
+    VertexAttrib();
+
+    bool enabled;
+    unsigned int buffer;
+    int size;
+    unsigned int type;
+    bool normalized;
+    int stride;
+    void* pointer;
+  };
+
+  // The state of a virtual context. It starts as the state of a new context.
+  struct State {
+    State();
+
+    unsigned int framebuffer;
+    unsigned int renderbuffer;
+    unsigned int array_buffer;
+    unsigned int element_array_buffer;
+    unsigned int program;
+    unsigned int active_texture;
+    unsigned int textures[kSavedTextureUnits];
+    bool capabilities[kCapabilityCount];
+    int blend_func[4];
+    float clear_color[4];
+    unsigned char color_mask[4];
+    int viewport[4];
+    int scissor[4];
+    int pack_alignment;
+    int unpack_alignment;
+    VertexAttrib attribs[kSavedVertexAttribs];
+  };
+
+  // Reads the state of this context from the real context, which must hold it.
+  void SaveState();
+
+  // Sets the saved state of this context on the real context.
+  void RestoreState();
+
+  // Tells GLContext the real context is current, with the current surface, as
+  // the real context checks that it is before doing anything.
+  void SetRealContextCurrent();
+
+  scoped_refptr<GLContext> real_context_;
+  State state_;
+
+  DISALLOW_COPY_AND_ASSIGN(GLContextVirtual);
+};
+
+}  // namespace gfx
+
+#endif  // UI_GL_GL_CONTEXT_VIRTUAL_H_
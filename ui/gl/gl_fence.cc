@@ -91,6 +91,14 @@ GLFence* GLFence::Create() {
   }
 }
 
+// static
+GLFence* GLFence::CreateForSharing() {
+  // NV fences belong to the context that sets them; sync objects are shared.
+  if (gfx::g_GL_ARB_sync)
+    return new GLFenceARBSync();
+  return NULL;
+}
+
 // static
 bool GLFence::IsContextLost() {
   if (!gfx::g_GL_ARB_robustness)
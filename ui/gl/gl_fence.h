@@ -17,6 +17,10 @@ class GL_EXPORT GLFence {
   virtual ~GLFence();
 
   static GLFence* Create();
+
+  // Creates a fence that the other contexts of the share group of the current
+  // context can also test. Returns NULL if that isn't supported.
+  static GLFence* CreateForSharing();
   virtual bool HasCompleted() = 0;
 
  protected:
@@ -0,0 +1,60 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GL_GL_IMAGE_H_
+#define UI_GL_GL_IMAGE_H_
+#pragma once
+
+#include "base/memory/ref_counted.h"
+#include "ui/gfx/size.h"
+#include "ui/gl/gl_export.h"
+
+#if defined(USE_X11)
+#include <X11/X.h>
+#endif
+
+namespace gfx {
+
+// Encapsulates an image that lives outside of GL, such as a pixmap, and that
+// can be bound to a texture so that it is sampled in place rather than
+// uploaded. The platform specific management is hidden.
+class GL_EXPORT GLImage : public base::RefCounted<GLImage> {
+ public:
+  GLImage();
+
+  // Destroys the image.
+  virtual void Destroy() = 0;
+
+  // Gets the size of the image.
+  virtual gfx::Size GetSize() = 0;
+
+  // Binds the image to the texture currently bound to GL_TEXTURE_2D with the
+  // current context. The texture samples what the image holds when this is
+  // called: bind it again after the image changes.
+  virtual bool BindTexImage() = 0;
+
+  // Releases the image from the texture currently bound to GL_TEXTURE_2D.
+  virtual void ReleaseTexImage() = 0;
+
+#if defined(USE_X11)
+  // Creates a GL image for |pixmap|, an X pixmap of |size| and |depth|, for
+  // the GL implementation in use. Returns NULL if the implementation can't
+  // bind pixmaps.
+  static scoped_refptr<GLImage> CreateGLImageForPixmap(XID pixmap,
+                                                       const gfx::Size& size,
+                                                       int depth);
+#endif
+
+ protected:
+  virtual ~GLImage();
+
+ private:
+  friend class base::RefCounted<GLImage>;
+
+  DISALLOW_COPY_AND_ASSIGN(GLImage);
+};
+
+}  // namespace gfx
+
+#endif  // UI_GL_GL_IMAGE_H_
@@ -0,0 +1,76 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gl/gl_image_egl.h"
+
+#include "base/logging.h"
+#include "third_party/angle/include/EGL/egl.h"
+#include "third_party/angle/include/EGL/eglext.h"
+#include "ui/gl/egl_util.h"
+#include "ui/gl/gl_surface_egl.h"
+
+// This header must come after the above third-party include, as
+// it brings in #defines that cause conflicts.
+#include "ui/gl/gl_bindings.h"
+
+namespace gfx {
+
+GLImageEGL::GLImageEGL(XID pixmap, const gfx::Size& size)
+    : pixmap_(pixmap),
+      egl_image_(EGL_NO_IMAGE_KHR),
+      size_(size) {
+}
+
+bool GLImageEGL::Initialize() {
+  DCHECK_EQ(egl_image_, EGL_NO_IMAGE_KHR);
+
+  // The image follows the pixmap rather than taking a copy of it, and keeps
+  // what the pixmap holds when it is created.
+  EGLint attributes[] = {
+    EGL_IMAGE_PRESERVED_KHR, EGL_TRUE,
+    EGL_NONE
+  };
+  egl_image_ = eglCreateImageKHR(GLSurfaceEGL::GetHardwareDisplay(),
+                                 EGL_NO_CONTEXT,
+                                 EGL_NATIVE_PIXMAP_KHR,
+                                 reinterpret_cast<EGLClientBuffer>(pixmap_),
+                                 attributes);
+  if (egl_image_ == EGL_NO_IMAGE_KHR) {
+    LOG(ERROR) << "eglCreateImageKHR failed with error "
+               << GetLastEGLErrorString();
+    return false;
+  }
+
+  return true;
+}
+
+void GLImageEGL::Destroy() {
+  if (egl_image_ != EGL_NO_IMAGE_KHR) {
+    eglDestroyImageKHR(GLSurfaceEGL::GetHardwareDisplay(), egl_image_);
+    egl_image_ = EGL_NO_IMAGE_KHR;
+  }
+}
+
+gfx::Size GLImageEGL::GetSize() {
+  return size_;
+}
+
+bool GLImageEGL::BindTexImage() {
+  if (egl_image_ == EGL_NO_IMAGE_KHR)
+    return false;
+
+  glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, egl_image_);
+  return glGetError() == GL_NO_ERROR;
+}
+
+void GLImageEGL::ReleaseTexImage() {
+  // The texture samples the image until it is given other storage or
+  // deleted; there is nothing to release.
+}
+
+GLImageEGL::~GLImageEGL() {
+  Destroy();
+}
+
+}  // namespace gfx
@@ -0,0 +1,43 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GL_GL_IMAGE_EGL_H_
+#define UI_GL_GL_IMAGE_EGL_H_
+#pragma once
+
+#include "base/compiler_specific.h"
+#include "ui/gl/gl_image.h"
+
+typedef void* EGLImageKHR;
+
+namespace gfx {
+
+// Binds an X pixmap to textures through an EGLImage, with EGL_KHR_image_pixmap
+// and GL_OES_EGL_image.
+class GL_EXPORT GLImageEGL : public GLImage {
+ public:
+  GLImageEGL(XID pixmap, const gfx::Size& size);
+
+  bool Initialize();
+
+  // Implement GLImage.
+  virtual void Destroy() OVERRIDE;
+  virtual gfx::Size GetSize() OVERRIDE;
+  virtual bool BindTexImage() OVERRIDE;
+  virtual void ReleaseTexImage() OVERRIDE;
+
+ protected:
+  virtual ~GLImageEGL();
+
+ private:
+  XID pixmap_;
+  EGLImageKHR egl_image_;
+  gfx::Size size_;
+
+  DISALLOW_COPY_AND_ASSIGN(GLImageEGL);
+};
+
+}  // namespace gfx
+
+#endif  // UI_GL_GL_IMAGE_EGL_H_
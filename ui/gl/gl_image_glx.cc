@@ -0,0 +1,142 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+extern "C" {
+#include <X11/Xlib.h>
+}
+
+#include "ui/gl/gl_image_glx.h"
+
+#include "base/basictypes.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "ui/gl/gl_bindings.h"
+#include "ui/gl/gl_surface_glx.h"
+
+namespace gfx {
+
+namespace {
+
+// scoped_ptr functor for XFree(). Use as follows:
+//   scoped_ptr_malloc<XVisualInfo, ScopedPtrXFree> foo(...);
+// where "XVisualInfo" is any X type that is freed with XFree.
+class ScopedPtrXFree {
+ public:
+  void operator()(void* x) const {
+    ::XFree(x);
+  }
+};
+
+int GetFBConfigAttrib(Display* display, GLXFBConfig config, int attribute) {
+  int value = 0;
+  glXGetFBConfigAttrib(display, config, attribute, &value);
+  return value;
+}
+
+}  // namespace anonymous
+
+GLImageGLX::GLImageGLX(XID pixmap, const gfx::Size& size, int depth)
+    : display_(NULL),
+      pixmap_(pixmap),
+      glx_pixmap_(0),
+      size_(size),
+      depth_(depth) {
+}
+
+bool GLImageGLX::Initialize() {
+  DCHECK(!glx_pixmap_);
+
+  if (!GLSurfaceGLX::HasGLXExtension("GLX_EXT_texture_from_pixmap")) {
+    LOG(ERROR) << "GLX_EXT_texture_from_pixmap not supported.";
+    return false;
+  }
+  if (depth_ != 24 && depth_ != 32) {
+    LOG(ERROR) << "Unsupported pixmap depth " << depth_ << ".";
+    return false;
+  }
+
+  display_ = ui::GetXDisplay();
+  bool has_alpha = depth_ == 32;
+
+  const int config_attributes[] = {
+    GLX_DRAWABLE_TYPE, GLX_PIXMAP_BIT,
+    GLX_BIND_TO_TEXTURE_TARGETS_EXT, GLX_TEXTURE_2D_BIT_EXT,
+    has_alpha ? GLX_BIND_TO_TEXTURE_RGBA_EXT : GLX_BIND_TO_TEXTURE_RGB_EXT,
+        True,
+    0
+  };
+
+  int num_elements = 0;
+  scoped_ptr_malloc<GLXFBConfig, ScopedPtrXFree> configs(
+      glXChooseFBConfig(display_,
+                        DefaultScreen(display_),
+                        config_attributes,
+                        &num_elements));
+  if (!configs.get()) {
+    LOG(ERROR) << "glXChooseFBConfig failed.";
+    return false;
+  }
+
+  // The config must lay out its pixels like the pixmap does.
+  GLXFBConfig config = NULL;
+  for (int i = 0; i < num_elements; ++i) {
+    GLXFBConfig candidate = configs.get()[i];
+    int bits = GetFBConfigAttrib(display_, candidate, GLX_RED_SIZE) +
+        GetFBConfigAttrib(display_, candidate, GLX_GREEN_SIZE) +
+        GetFBConfigAttrib(display_, candidate, GLX_BLUE_SIZE) +
+        GetFBConfigAttrib(display_, candidate, GLX_ALPHA_SIZE);
+    if (bits == depth_) {
+      config = candidate;
+      break;
+    }
+  }
+  if (!config) {
+    LOG(ERROR) << "No GLXFBConfig binds pixmaps of depth " << depth_ << ".";
+    return false;
+  }
+
+  const int pixmap_attributes[] = {
+    GLX_TEXTURE_TARGET_EXT, GLX_TEXTURE_2D_EXT,
+    GLX_TEXTURE_FORMAT_EXT,
+        has_alpha ? GLX_TEXTURE_FORMAT_RGBA_EXT : GLX_TEXTURE_FORMAT_RGB_EXT,
+    0
+  };
+  glx_pixmap_ = glXCreatePixmap(display_, config, pixmap_, pixmap_attributes);
+  if (!glx_pixmap_) {
+    LOG(ERROR) << "glXCreatePixmap failed.";
+    return false;
+  }
+
+  return true;
+}
+
+void GLImageGLX::Destroy() {
+  if (glx_pixmap_) {
+    glXDestroyPixmap(display_, glx_pixmap_);
+    glx_pixmap_ = 0;
+  }
+}
+
+gfx::Size GLImageGLX::GetSize() {
+  return size_;
+}
+
+bool GLImageGLX::BindTexImage() {
+  if (!glx_pixmap_)
+    return false;
+
+  glXBindTexImageEXT(display_, glx_pixmap_, GLX_FRONT_LEFT_EXT, 0);
+  return true;
+}
+
+void GLImageGLX::ReleaseTexImage() {
+  if (glx_pixmap_)
+    glXReleaseTexImageEXT(display_, glx_pixmap_, GLX_FRONT_LEFT_EXT);
+}
+
+GLImageGLX::~GLImageGLX() {
+  Destroy();
+}
+
+}  // namespace gfx
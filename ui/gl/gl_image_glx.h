@@ -0,0 +1,43 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GL_GL_IMAGE_GLX_H_
+#define UI_GL_GL_IMAGE_GLX_H_
+#pragma once
+
+#include "base/compiler_specific.h"
+#include "ui/base/x/x11_util.h"
+#include "ui/gl/gl_image.h"
+
+namespace gfx {
+
+// Binds an X pixmap to textures with GLX_EXT_texture_from_pixmap.
+class GL_EXPORT GLImageGLX : public GLImage {
+ public:
+  GLImageGLX(XID pixmap, const gfx::Size& size, int depth);
+
+  bool Initialize();
+
+  // Implement GLImage.
+  virtual void Destroy() OVERRIDE;
+  virtual gfx::Size GetSize() OVERRIDE;
+  virtual bool BindTexImage() OVERRIDE;
+  virtual void ReleaseTexImage() OVERRIDE;
+
+ protected:
+  virtual ~GLImageGLX();
+
+ private:
+  Display* display_;
+  XID pixmap_;
+  XID glx_pixmap_;
+  gfx::Size size_;
+  int depth_;
+
+  DISALLOW_COPY_AND_ASSIGN(GLImageGLX);
+};
+
+}  // namespace gfx
+
+#endif  // UI_GL_GL_IMAGE_GLX_H_
@@ -0,0 +1,38 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gl/gl_image.h"
+
+#include "ui/gl/gl_image_egl.h"
+#include "ui/gl/gl_image_glx.h"
+#include "ui/gl/gl_implementation.h"
+
+namespace gfx {
+
+// static
+scoped_refptr<GLImage> GLImage::CreateGLImageForPixmap(XID pixmap,
+                                                       const gfx::Size& size,
+                                                       int depth) {
+  switch (GetGLImplementation()) {
+    case kGLImplementationDesktopGL: {
+      scoped_refptr<GLImageGLX> image(new GLImageGLX(pixmap, size, depth));
+      if (!image->Initialize())
+        return NULL;
+
+      return image;
+    }
+    case kGLImplementationEGLGLES2: {
+      scoped_refptr<GLImageEGL> image(new GLImageEGL(pixmap, size));
+      if (!image->Initialize())
+        return NULL;
+
+      return image;
+    }
+    default:
+      // OSMesa and the mock bindings can't bind pixmaps; callers upload.
+      return NULL;
+  }
+}
+
+}  // namespace gfx
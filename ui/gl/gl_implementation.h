@@ -46,6 +46,10 @@ GL_EXPORT bool InitializeGLExtensionBindings(GLImplementation implementation,
 // Initialize Debug logging wrappers for GL bindings.
 void InitializeDebugGLBindings();
 
+// Initialize the wrappers for GL bindings that drop redundant state changes
+// and count GL calls. See GLStateCache.
+void InitializeStateCacheGLBindings();
+
 void ClearGLBindings();
 
 // Set the current GL implementation.
@@ -121,6 +121,10 @@ bool InitializeGLExtensionBindings(GLImplementation implementation,
 void InitializeDebugGLBindings() {
 }
 
+void InitializeStateCacheGLBindings() {
+  InitializeStateCacheGLBindingsGL();
+}
+
 void ClearGLBindings() {
   ClearGLBindingsEGL();
   ClearGLBindingsGL();
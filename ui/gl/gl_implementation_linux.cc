@@ -215,6 +215,10 @@ void InitializeDebugGLBindings() {
   InitializeDebugGLBindingsOSMESA();
 }
 
+void InitializeStateCacheGLBindings() {
+  InitializeStateCacheGLBindingsGL();
+}
+
 void ClearGLBindings() {
   ClearGLBindingsEGL();
   ClearGLBindingsGL();
@@ -129,6 +129,10 @@ void InitializeDebugGLBindings() {
   InitializeDebugGLBindingsOSMESA();
 }
 
+void InitializeStateCacheGLBindings() {
+  InitializeStateCacheGLBindingsGL();
+}
+
 void ClearGLBindings() {
   ClearGLBindingsGL();
   ClearGLBindingsOSMESA();
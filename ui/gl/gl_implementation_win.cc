@@ -276,6 +276,10 @@ void InitializeDebugGLBindings() {
   InitializeDebugGLBindingsWGL();
 }
 
+void InitializeStateCacheGLBindings() {
+  InitializeStateCacheGLBindingsGL();
+}
+
 void ClearGLBindings() {
   ClearGLBindingsEGL();
   ClearGLBindingsGL();
@@ -273,6 +273,12 @@ class GL_EXPORT GLInterface {
 
   virtual void GetIntegerv(GLenum pname, GLint* params) = 0;
 
+  virtual void GetProgramBinary(GLuint program,
+                                GLsizei bufSize,
+                                GLsizei* length,
+                                GLenum* binaryFormat,
+                                GLvoid* binary) = 0;
+
   virtual void GetProgramiv(GLuint program, GLenum pname, GLint* params) = 0;
 
   // TODO(gman): Implement this
@@ -397,6 +403,11 @@ class GL_EXPORT GLInterface {
 
   virtual void PolygonOffset(GLfloat factor, GLfloat units) = 0;
 
+  virtual void ProgramBinary(GLuint program,
+                             GLenum binaryFormat,
+                             const GLvoid* binary,
+                             GLsizei length) = 0;
+
   virtual void QueryCounter(GLuint id, GLenum target) = 0;
 
   virtual void ReadBuffer(GLenum src) = 0;
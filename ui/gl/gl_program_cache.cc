@@ -0,0 +1,401 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gl/gl_program_cache.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/file_util.h"
+#include "base/lazy_instance.h"
+#include "base/location.h"
+#include "base/sha1.h"
+#include "base/string_number_conversions.h"
+#include "base/threading/thread_local.h"
+#include "base/threading/worker_pool.h"
+#include "ui/gl/gl_bindings.h"
+#include "ui/gl/gl_context.h"
+
+namespace gfx {
+
+namespace {
+
+// Binaries are kept in files named by their key with this extension, behind
+// a header holding their format.
+const FilePath::CharType kBinaryExtension[] = FILE_PATH_LITERAL(".bin");
+const FilePath::CharType kBinaryPattern[] = FILE_PATH_LITERAL("*.bin");
+const FilePath::CharType kTemporaryExtension[] = FILE_PATH_LITERAL(".tmp");
+
+// Files bigger than this are left alone, as no program binary is.
+const int64 kMaxBinaryFileSize = 4 * 1024 * 1024;
+
+GLProgramCache* g_program_cache = NULL;
+
+// Set while the cache makes GL calls itself, so that the bindings pass them
+// on to the driver.
+base::LazyInstance<base::ThreadLocalBoolean>::Leaky g_making_calls =
+    LAZY_INSTANCE_INITIALIZER;
+
+class ScopedMakingCalls {
+ public:
+  ScopedMakingCalls() { g_making_calls.Pointer()->Set(true); }
+  ~ScopedMakingCalls() { g_making_calls.Pointer()->Set(false); }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ScopedMakingCalls);
+};
+
+std::string GetString(GLenum name) {
+  const char* value = reinterpret_cast<const char*>(glGetString(name));
+  return value ? value : "";
+}
+
+void WriteBinary(const FilePath& path,
+                 const std::string& key,
+                 unsigned int format,
+                 const std::string& data) {
+  std::string contents(reinterpret_cast<const char*>(&format), sizeof(format));
+  contents += data;
+  // Written aside and moved in place, so that a crash leaves no partial file.
+  FilePath file = path.AppendASCII(key).AddExtension(kBinaryExtension);
+  FilePath temporary_file = file.AddExtension(kTemporaryExtension);
+  if (file_util::WriteFile(temporary_file, contents.data(), contents.size()) !=
+          static_cast<int>(contents.size()) ||
+      !file_util::Move(temporary_file, file)) {
+    file_util::Delete(temporary_file, false);
+  }
+}
+
+void DeleteBinary(const FilePath& path, const std::string& key) {
+  file_util::Delete(path.AppendASCII(key).AddExtension(kBinaryExtension),
+                    false);
+}
+
+}  // namespace
+
+GLProgramCache::Shader::Shader()
+    : compile_pending(false),
+      deleted(false),
+      attach_count(0) {
+}
+
+GLProgramCache::Shader::~Shader() {
+}
+
+GLProgramCache::Program::Program() {
+}
+
+GLProgramCache::Program::~Program() {
+}
+
+// static
+void GLProgramCache::Initialize(const FilePath& path) {
+  if (g_program_cache)
+    return;
+
+  g_program_cache = new GLProgramCache(path);
+  base::WorkerPool::PostTask(
+      FROM_HERE,
+      base::Bind(&GLProgramCache::LoadBinaries,
+                 base::Unretained(g_program_cache)),
+      true);
+}
+
+// static
+GLProgramCache* GLProgramCache::GetCurrent() {
+  if (!g_program_cache || g_making_calls.Pointer()->Get() ||
+      !GLContext::GetCurrent()) {
+    return NULL;
+  }
+  return g_program_cache;
+}
+
+bool GLProgramCache::ShaderSource(unsigned int shader,
+                                  int count,
+                                  const char** str,
+                                  const int* length) {
+  // The pending compile is of the previous source.
+  CompilePendingShader(shader);
+
+  base::AutoLock lock(lock_);
+  std::string& source = shaders_[GetName(shader)].source;
+  source.clear();
+  for (int i = 0; i < count; ++i) {
+    if (length && length[i] >= 0)
+      source.append(str[i], length[i]);
+    else
+      source.append(str[i]);
+  }
+  return false;
+}
+
+bool GLProgramCache::CompileShader(unsigned int shader) {
+  if (!IsSupported())
+    return false;
+
+  base::AutoLock lock(lock_);
+  Shader& record = shaders_[GetName(shader)];
+  record.compile_pending = true;
+  return true;
+}
+
+bool GLProgramCache::GetShaderiv(unsigned int shader,
+                                 unsigned int pname,
+                                 int* params) {
+  if (pname == GL_COMPILE_STATUS) {
+    base::AutoLock lock(lock_);
+    ShaderMap::iterator it = shaders_.find(GetName(shader));
+    if (it != shaders_.end() && it->second.compile_pending) {
+      *params = GL_TRUE;
+      return true;
+    }
+    return false;
+  }
+  CompilePendingShader(shader);
+  return false;
+}
+
+bool GLProgramCache::GetShaderInfoLog(unsigned int shader) {
+  CompilePendingShader(shader);
+  return false;
+}
+
+bool GLProgramCache::AttachShader(unsigned int program, unsigned int shader) {
+  base::AutoLock lock(lock_);
+  programs_[GetName(program)].shaders.push_back(shader);
+  ++shaders_[GetName(shader)].attach_count;
+  return false;
+}
+
+bool GLProgramCache::DetachShader(unsigned int program, unsigned int shader) {
+  base::AutoLock lock(lock_);
+  std::vector<unsigned int>& shaders = programs_[GetName(program)].shaders;
+  std::vector<unsigned int>::iterator it =
+      std::find(shaders.begin(), shaders.end(), shader);
+  if (it != shaders.end()) {
+    shaders.erase(it);
+    ObjectName name = GetName(shader);
+    --shaders_[name].attach_count;
+    ReleaseShader(name);
+  }
+  return false;
+}
+
+bool GLProgramCache::BindAttribLocation(unsigned int program,
+                                        unsigned int index,
+                                        const char* name) {
+  base::AutoLock lock(lock_);
+  programs_[GetName(program)].attrib_locations[name] = index;
+  return false;
+}
+
+bool GLProgramCache::LinkProgram(unsigned int program) {
+  if (!IsSupported())
+    return false;
+
+  TRACE_EVENT0("gpu", "GLProgramCache::LinkProgram");
+  base::AutoLock lock(lock_);
+  ScopedMakingCalls making_calls;
+  const Program& record = programs_[GetName(program)];
+  // A program whose shaders the cache didn't see can't be looked up.
+  if (record.shaders.empty())
+    return false;
+  std::string key = GetKey(record);
+
+  BinaryMap::iterator it = binaries_.find(key);
+  if (it != binaries_.end()) {
+    glProgramBinary(program, it->second.format, it->second.data.data(),
+                    it->second.data.size());
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked)
+      return true;
+
+    // The driver changed without saying so. Link as usual, which replaces the
+    // binary.
+    binaries_.erase(it);
+    base::WorkerPool::PostTask(FROM_HERE,
+                               base::Bind(&DeleteBinary, path_, key),
+                               true);
+  }
+
+  for (size_t i = 0; i < record.shaders.size(); ++i) {
+    Shader& shader = shaders_[GetName(record.shaders[i])];
+    if (shader.compile_pending) {
+      glCompileShader(record.shaders[i]);
+      shader.compiled_source = shader.source;
+      shader.compile_pending = false;
+    }
+  }
+  glLinkProgram(program);
+
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  GLint length = 0;
+  if (linked)
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return true;
+
+  Binary& binary = binaries_[key];
+  binary.data.resize(length);
+  GLenum format = 0;
+  glGetProgramBinary(program, length, &length, &format, &binary.data[0]);
+  binary.data.resize(length);
+  binary.format = format;
+  base::WorkerPool::PostTask(
+      FROM_HERE,
+      base::Bind(&WriteBinary, path_, key, binary.format, binary.data),
+      true);
+  return true;
+}
+
+bool GLProgramCache::DeleteShader(unsigned int shader) {
+  base::AutoLock lock(lock_);
+  ObjectName name = GetName(shader);
+  ShaderMap::iterator it = shaders_.find(name);
+  if (it != shaders_.end()) {
+    it->second.deleted = true;
+    ReleaseShader(name);
+  }
+  return false;
+}
+
+bool GLProgramCache::DeleteProgram(unsigned int program) {
+  base::AutoLock lock(lock_);
+  ProgramMap::iterator it = programs_.find(GetName(program));
+  if (it == programs_.end())
+    return false;
+
+  std::vector<unsigned int> shaders;
+  shaders.swap(it->second.shaders);
+  programs_.erase(it);
+  for (size_t i = 0; i < shaders.size(); ++i) {
+    ObjectName name = GetName(shaders[i]);
+    --shaders_[name].attach_count;
+    ReleaseShader(name);
+  }
+  return false;
+}
+
+void GLProgramCache::CreateShader(unsigned int shader) {
+  base::AutoLock lock(lock_);
+  shaders_.erase(GetName(shader));
+}
+
+void GLProgramCache::CreateProgram(unsigned int program) {
+  base::AutoLock lock(lock_);
+  programs_.erase(GetName(program));
+}
+
+GLProgramCache::GLProgramCache(const FilePath& path)
+    : path_(path),
+      support_(SUPPORT_UNKNOWN) {
+}
+
+GLProgramCache::~GLProgramCache() {
+}
+
+// static
+GLProgramCache::ObjectName GLProgramCache::GetName(unsigned int object) {
+  return ObjectName(GLContext::GetCurrent()->share_group(), object);
+}
+
+bool GLProgramCache::IsSupported() {
+  base::AutoLock lock(lock_);
+  if (support_ == SUPPORT_UNKNOWN) {
+    ScopedMakingCalls making_calls;
+    GLContext* context = GLContext::GetCurrent();
+    GLint format_count = 0;
+    if ((context->HasExtension("GL_OES_get_program_binary") ||
+         context->HasExtension("GL_ARB_get_program_binary")) &&
+        g_glProgramBinary && g_glGetProgramBinary)
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    support_ = format_count > 0 ? SUPPORTED : UNSUPPORTED;
+    driver_ = GetString(GL_VENDOR) + '\n' + GetString(GL_RENDERER) + '\n' +
+        GetString(GL_VERSION);
+  }
+  return support_ == SUPPORTED;
+}
+
+void GLProgramCache::CompilePendingShader(unsigned int shader) {
+  base::AutoLock lock(lock_);
+  ShaderMap::iterator it = shaders_.find(GetName(shader));
+  if (it == shaders_.end() || !it->second.compile_pending)
+    return;
+
+  ScopedMakingCalls making_calls;
+  glCompileShader(shader);
+  it->second.compiled_source = it->second.source;
+  it->second.compile_pending = false;
+}
+
+std::string GLProgramCache::GetKey(const Program& program) {
+  // The order the shaders were attached in doesn't matter to the driver.
+  std::vector<std::string> sources;
+  for (size_t i = 0; i < program.shaders.size(); ++i) {
+    const Shader& shader = shaders_[GetName(program.shaders[i])];
+    sources.push_back(shader.compile_pending ? shader.source :
+                                               shader.compiled_source);
+  }
+  std::sort(sources.begin(), sources.end());
+
+  std::string description = driver_;
+  for (size_t i = 0; i < sources.size(); ++i) {
+    description += '\0';
+    description += sources[i];
+  }
+  for (std::map<std::string, unsigned int>::const_iterator it =
+           program.attrib_locations.begin();
+       it != program.attrib_locations.end(); ++it) {
+    description += '\0';
+    description += it->first;
+    description += '\0';
+    description += base::UintToString(it->second);
+  }
+  std::string hash = base::SHA1HashString(description);
+  return base::HexEncode(hash.data(), hash.size());
+}
+
+void GLProgramCache::ReleaseShader(const ObjectName& shader) {
+  ShaderMap::iterator it = shaders_.find(shader);
+  if (it != shaders_.end() && it->second.deleted &&
+      it->second.attach_count <= 0) {
+    shaders_.erase(it);
+  }
+}
+
+void GLProgramCache::LoadBinaries() {
+  file_util::CreateDirectory(path_);
+  BinaryMap binaries;
+  file_util::FileEnumerator enumerator(path_, false,
+                                       file_util::FileEnumerator::FILES,
+                                       kBinaryPattern);
+  for (FilePath file = enumerator.Next(); !file.empty();
+       file = enumerator.Next()) {
+    int64 size = 0;
+    if (!file_util::GetFileSize(file, &size) || size > kMaxBinaryFileSize)
+      continue;
+
+    std::string contents;
+    if (!file_util::ReadFileToString(file, &contents) ||
+        contents.size() <= sizeof(unsigned int)) {
+      continue;
+    }
+    std::string key = file.BaseName().RemoveExtension().MaybeAsASCII();
+    Binary& binary = binaries[key];
+    memcpy(&binary.format, contents.data(), sizeof(binary.format));
+    binary.data = contents.substr(sizeof(binary.format));
+  }
+
+  base::AutoLock lock(lock_);
+  // Binaries of programs linked meanwhile are newer.
+  for (BinaryMap::iterator it = binaries.begin(); it != binaries.end(); ++it)
+    binaries_.insert(*it);
+}
+
+}  // namespace gfx
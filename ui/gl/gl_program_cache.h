@@ -0,0 +1,154 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GL_GL_PROGRAM_CACHE_H_
+#define UI_GL_GL_PROGRAM_CACHE_H_
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/file_path.h"
+#include "base/synchronization/lock.h"
+#include "ui/gl/gl_export.h"
+
+namespace gfx {
+
+class GLShareGroup;
+
+// GLProgramCache keeps the binaries of the programs linked in the process on
+// disk, with GL_OES_get_program_binary or GL_ARB_get_program_binary, so that
+// the next run loads them instead of compiling and linking the shaders again.
+// Once enabled, the state cache bindings (see generate_bindings.py) report the
+// calls that build programs to it:
+//
+// - Compiling a shader is deferred until a program it is attached to is
+//   linked, or until its info log is asked for. Its compile status reads as
+//   successful until then, so a failed compile shows as a failed link.
+// - Linking a program looks its binary up by the driver, the sources of its
+//   shaders and its attribute bindings. When there is one, the shaders are
+//   never compiled. Otherwise they are, the program is linked, and its binary
+//   is kept and written to disk on a worker thread.
+//
+// The binaries on disk are read on a worker thread as soon as the cache is
+// enabled, which is well before the first program is linked. Programs linked
+// before they are read are built as usual.
+//
+// The GL types are spelled out so that this header doesn't pull in
+// gl_bindings.h, which must only be included in .cc files.
+class GL_EXPORT GLProgramCache {
+ public:
+  // Enables the cache for the process, keeping the binaries in |path|.
+  static void Initialize(const FilePath& path);
+
+  // Returns the cache if it is enabled and a context is current on this
+  // thread, or NULL. Also NULL while the cache makes GL calls itself.
+  static GLProgramCache* GetCurrent();
+
+  // These record the calls that build programs in the share group of the
+  // current context. Each returns true if the cache handled the call, which
+  // must then not be passed on to the driver.
+  bool ShaderSource(unsigned int shader,
+                    int count,
+                    const char** str,
+                    const int* length);
+  bool CompileShader(unsigned int shader);
+  bool GetShaderiv(unsigned int shader, unsigned int pname, int* params);
+  bool GetShaderInfoLog(unsigned int shader);
+  bool AttachShader(unsigned int program, unsigned int shader);
+  bool DetachShader(unsigned int program, unsigned int shader);
+  bool BindAttribLocation(unsigned int program,
+                          unsigned int index,
+                          const char* name);
+  bool LinkProgram(unsigned int program);
+  bool DeleteShader(unsigned int shader);
+  bool DeleteProgram(unsigned int program);
+
+  // These record the objects the driver created, forgetting anything known
+  // about objects of the same name that were deleted without the cache
+  // seeing it.
+  void CreateShader(unsigned int shader);
+  void CreateProgram(unsigned int program);
+
+ private:
+  // Objects are named by their share group and their GL name.
+  typedef std::pair<GLShareGroup*, unsigned int> ObjectName;
+
+  struct Shader {
+    Shader();
+    ~Shader();
+
+    // The source set last, and the source the shader was compiled with.
+    std::string source;
+    std::string compiled_source;
+    bool compile_pending;
+    bool deleted;
+    int attach_count;
+  };
+
+  struct Program {
+    Program();
+    ~Program();
+
+    std::vector<unsigned int> shaders;
+    std::map<std::string, unsigned int> attrib_locations;
+  };
+
+  struct Binary {
+    unsigned int format;
+    std::string data;
+  };
+
+  typedef std::map<ObjectName, Shader> ShaderMap;
+  typedef std::map<ObjectName, Program> ProgramMap;
+  typedef std::map<std::string, Binary> BinaryMap;
+
+  enum Support {
+    SUPPORT_UNKNOWN,
+    SUPPORTED,
+    UNSUPPORTED
+  };
+
+  explicit GLProgramCache(const FilePath& path);
+  ~GLProgramCache();
+
+  // Returns the name of |object| in the share group of the current context.
+  static ObjectName GetName(unsigned int object);
+
+  // Returns whether the driver can get and load program binaries, finding
+  // out with the current context the first time.
+  bool IsSupported();
+
+  // Compiles |shader| if its compile is pending.
+  void CompilePendingShader(unsigned int shader);
+
+  // Returns the key of |program|'s binary.
+  std::string GetKey(const Program& program);
+
+  // Forgets |shader| once it is deleted and attached to no program.
+  void ReleaseShader(const ObjectName& shader);
+
+  // Reads the binaries in |path_|, on a worker thread.
+  void LoadBinaries();
+
+  const FilePath path_;
+
+  base::Lock lock_;
+  Support support_;
+  // The vendor, renderer and version of the driver, which the binaries are
+  // only valid for.
+  std::string driver_;
+  ShaderMap shaders_;
+  ProgramMap programs_;
+  BinaryMap binaries_;
+
+  DISALLOW_COPY_AND_ASSIGN(GLProgramCache);
+};
+
+}  // namespace gfx
+
+#endif  // UI_GL_GL_PROGRAM_CACHE_H_
@@ -5,10 +5,13 @@
 #include "ui/gl/gl_share_group.h"
 
 #include "ui/gl/gl_context.h"
+#include "ui/gl/gl_state_cache.h"
 
 namespace gfx {
 
-GLShareGroup::GLShareGroup() {
+GLShareGroup::GLShareGroup()
+    : virtualized_(false),
+      shared_context_owner_(NULL) {
 }
 
 void GLShareGroup::AddContext(GLContext* context) {
@@ -38,6 +41,41 @@ GLContext* GLShareGroup::GetContext() {
   return NULL;
 }
 
+void GLShareGroup::DidDeleteTextures(GLContext* context,
+                                     int n,
+                                     const unsigned int* textures) {
+  for (ContextSet::iterator it = contexts_.begin();
+       it != contexts_.end();
+       ++it) {
+    if (*it != context)
+      (*it)->GetStateCache()->ForgetTextures(n, textures);
+  }
+}
+
+void GLShareGroup::SetVirtualized(bool virtualized) {
+  virtualized_ = virtualized;
+}
+
+bool GLShareGroup::IsVirtualized() const {
+  return virtualized_;
+}
+
+void GLShareGroup::SetSharedContext(GLContext* context) {
+  shared_context_ = context;
+}
+
+GLContext* GLShareGroup::GetSharedContext() {
+  return shared_context_.get();
+}
+
+void GLShareGroup::SetSharedContextOwner(GLContext* context) {
+  shared_context_owner_ = context;
+}
+
+GLContext* GLShareGroup::GetSharedContextOwner() {
+  return shared_context_owner_;
+}
+
 GLShareGroup::~GLShareGroup() {
 }
 
@@ -34,6 +34,26 @@ class GL_EXPORT GLShareGroup : public base::RefCounted<GLShareGroup> {
   // or NULL if there are no initialized contexts in the share group.
   GLContext* GetContext();
 
+  // Tells the state caches of the contexts in the group other than |context|
+  // that |context| deleted |textures|, whose names the group shares.
+  void DidDeleteTextures(GLContext* context,
+                         int n,
+                         const unsigned int* textures);
+
+  // Makes the contexts created in the group from now on virtual: they all
+  // draw with one real context, so that switching between them switches no
+  // context in the driver. See GLContextVirtual.
+  void SetVirtualized(bool virtualized);
+  bool IsVirtualized() const;
+
+  // The real context of the virtual contexts, created with the first of them.
+  void SetSharedContext(GLContext* context);
+  GLContext* GetSharedContext();
+
+  // The virtual context whose state the shared context holds, if any.
+  void SetSharedContextOwner(GLContext* context);
+  GLContext* GetSharedContextOwner();
+
  private:
   friend class base::RefCounted<GLShareGroup>;
 
@@ -44,6 +64,10 @@ class GL_EXPORT GLShareGroup : public base::RefCounted<GLShareGroup> {
   typedef std::set<GLContext*> ContextSet;
   ContextSet contexts_;
 
+  bool virtualized_;
+  scoped_refptr<GLContext> shared_context_;
+  GLContext* shared_context_owner_;
+
   DISALLOW_COPY_AND_ASSIGN(GLShareGroup);
 };
 
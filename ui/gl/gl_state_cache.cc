@@ -0,0 +1,202 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gl/gl_state_cache.h"
+
+#include "ui/gl/gl_bindings.h"
+#include "ui/gl/gl_context.h"
+
+namespace gfx {
+
+namespace {
+
+// The texture targets whose bindings are shadowed, in the order of
+// GLStateCache::textures_.
+const GLenum kTextureTargets[] = {
+  GL_TEXTURE_2D,
+  GL_TEXTURE_CUBE_MAP,
+  GL_TEXTURE_RECTANGLE_ARB,
+};
+
+// The capabilities that are shadowed, in the order of
+// GLStateCache::capabilities_.
+const GLenum kCapabilities[] = {
+  GL_BLEND,
+  GL_CULL_FACE,
+  GL_DEPTH_TEST,
+  GL_DITHER,
+  GL_POLYGON_OFFSET_FILL,
+  GL_SAMPLE_ALPHA_TO_COVERAGE,
+  GL_SAMPLE_COVERAGE,
+  GL_SCISSOR_TEST,
+  GL_STENCIL_TEST,
+};
+
+}  // namespace
+
+base::subtle::Atomic32 GLStateCache::calls_ = 0;
+base::subtle::Atomic32 GLStateCache::state_changes_ = 0;
+base::subtle::Atomic32 GLStateCache::dropped_state_changes_ = 0;
+
+GLStateCache::GLStateCache() {
+  COMPILE_ASSERT(arraysize(kTextureTargets) == kTextureTargetCount,
+                 texture_targets_count_mismatch);
+  COMPILE_ASSERT(arraysize(kCapabilities) == kCapabilityCount,
+                 capabilities_count_mismatch);
+}
+
+GLStateCache::~GLStateCache() {
+}
+
+// static
+GLStateCache* GLStateCache::GetCurrent() {
+  GLContext* context = GLContext::GetCurrent();
+  return context ? context->GetStateCache() : NULL;
+}
+
+// static
+GLStateCache::Counts GLStateCache::TakeCounts() {
+  Counts counts;
+  counts.calls = base::subtle::NoBarrier_AtomicExchange(&calls_, 0);
+  counts.state_changes =
+      base::subtle::NoBarrier_AtomicExchange(&state_changes_, 0);
+  counts.dropped_state_changes =
+      base::subtle::NoBarrier_AtomicExchange(&dropped_state_changes_, 0);
+  return counts;
+}
+
+void GLStateCache::Reset() {
+  active_texture_unit_ = Value();
+  for (int unit = 0; unit < kMaxTextureUnits; ++unit) {
+    for (int target = 0; target < kTextureTargetCount; ++target)
+      textures_[unit][target] = Value();
+  }
+  program_ = Value();
+  for (int cap = 0; cap < kCapabilityCount; ++cap)
+    capabilities_[cap] = Value();
+  InvalidateBlendFunc();
+}
+
+bool GLStateCache::ActiveTexture(GLenum texture) {
+  GLuint unit = texture - GL_TEXTURE0;
+  if (unit >= static_cast<GLuint>(kMaxTextureUnits)) {
+    // The texture bindings that follow can't be shadowed.
+    active_texture_unit_ = Value();
+    return true;
+  }
+  return Update(&active_texture_unit_, unit);
+}
+
+bool GLStateCache::BindTexture(GLenum target, GLuint texture) {
+  int target_index = GetTextureTargetIndex(target);
+  if (target_index < 0 || !active_texture_unit_.known)
+    return true;
+  return Update(&textures_[active_texture_unit_.value][target_index], texture);
+}
+
+bool GLStateCache::UseProgram(GLuint program) {
+  return Update(&program_, program);
+}
+
+bool GLStateCache::SetCapability(GLenum cap, bool enabled) {
+  int cap_index = GetCapabilityIndex(cap);
+  if (cap_index < 0)
+    return true;
+  return Update(&capabilities_[cap_index], enabled);
+}
+
+bool GLStateCache::BlendFunc(GLenum sfactor, GLenum dfactor) {
+  bool changed = !blend_sfactor_.known || blend_sfactor_.value != sfactor ||
+      !blend_dfactor_.known || blend_dfactor_.value != dfactor;
+  if (!changed) {
+    base::subtle::NoBarrier_AtomicIncrement(&dropped_state_changes_, 1);
+    return false;
+  }
+  blend_sfactor_.known = true;
+  blend_sfactor_.value = sfactor;
+  blend_dfactor_.known = true;
+  blend_dfactor_.value = dfactor;
+  base::subtle::NoBarrier_AtomicIncrement(&state_changes_, 1);
+  return true;
+}
+
+void GLStateCache::InvalidateBlendFunc() {
+  blend_sfactor_ = Value();
+  blend_dfactor_ = Value();
+}
+
+void GLStateCache::DeleteTextures(GLsizei n, const GLuint* textures) {
+  // Deleting a bound texture binds 0 in its place, but only on the units of
+  // the current context. Bindings that aren't known may be one of them.
+  ClearTextureBindings(n, textures, true);
+  GLContext* context = GLContext::GetCurrent();
+  if (context)
+    context->share_group()->DidDeleteTextures(context, n, textures);
+}
+
+void GLStateCache::ForgetTextures(GLsizei n, const GLuint* textures) {
+  // The other contexts keep the deleted texture bound, while its name may
+  // come back for a new texture. Binding that one must reach the driver.
+  ClearTextureBindings(n, textures, false);
+}
+
+void GLStateCache::DeleteProgram(GLuint program) {
+  // A program in use is only deleted once it is no longer used, after which
+  // its name may be reused. Don't assume a new program with the same name is
+  // in use.
+  if (program && program_.known && program_.value == program)
+    program_ = Value();
+}
+
+void GLStateCache::ClearTextureBindings(GLsizei n,
+                                        const GLuint* textures,
+                                        bool unbound) {
+  for (GLsizei i = 0; i < n; ++i) {
+    if (!textures[i])
+      continue;
+    for (int unit = 0; unit < kMaxTextureUnits; ++unit) {
+      for (int target = 0; target < kTextureTargetCount; ++target) {
+        Value* binding = &textures_[unit][target];
+        if (!binding->known || binding->value != textures[i])
+          continue;
+        if (unbound)
+          binding->value = 0;
+        else
+          *binding = Value();
+      }
+    }
+  }
+}
+
+// static
+int GLStateCache::GetTextureTargetIndex(GLenum target) {
+  for (int i = 0; i < kTextureTargetCount; ++i) {
+    if (kTextureTargets[i] == target)
+      return i;
+  }
+  return -1;
+}
+
+// static
+int GLStateCache::GetCapabilityIndex(GLenum cap) {
+  for (int i = 0; i < kCapabilityCount; ++i) {
+    if (kCapabilities[i] == cap)
+      return i;
+  }
+  return -1;
+}
+
+// static
+bool GLStateCache::Update(Value* state, GLuint value) {
+  if (state->known && state->value == value) {
+    base::subtle::NoBarrier_AtomicIncrement(&dropped_state_changes_, 1);
+    return false;
+  }
+  state->known = true;
+  state->value = value;
+  base::subtle::NoBarrier_AtomicIncrement(&state_changes_, 1);
+  return true;
+}
+
+}  // namespace gfx
@@ -0,0 +1,133 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GL_GL_STATE_CACHE_H_
+#define UI_GL_GL_STATE_CACHE_H_
+#pragma once
+
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "ui/gl/gl_export.h"
+
+namespace gfx {
+
+// GLStateCache shadows the state of a GL context that is cheap to track and
+// is set over and over again: the active texture unit, the textures bound to
+// each unit, the program in use, the common capabilities and the blend
+// function. The generated state cache bindings (see generate_bindings.py) ask
+// the cache of the current context whether a call changes anything before
+// passing it to the driver, and drop it if it does not.
+//
+// The bindings also count the GL calls made and the state changes issued and
+// dropped, so that they can be traced once a frame without turning on the
+// logging bindings.
+//
+// The GL types are spelled out so that this header doesn't pull in
+// gl_bindings.h, which must only be included in .cc files.
+//
+// State that isn't known, because the context was just created or because
+// something changed it behind the cache's back, is never assumed: the next
+// call that sets it reaches the driver.
+class GL_EXPORT GLStateCache {
+ public:
+  struct Counts {
+    Counts() : calls(0), state_changes(0), dropped_state_changes(0) {}
+
+    // GL calls made through the state cache bindings.
+    int calls;
+    // Calls setting shadowed state that reached the driver.
+    int state_changes;
+    // Calls setting shadowed state that changed nothing, and were dropped.
+    int dropped_state_changes;
+  };
+
+  GLStateCache();
+  ~GLStateCache();
+
+  // Returns the cache of the context current on this thread, or NULL if
+  // there is none.
+  static GLStateCache* GetCurrent();
+
+  // Counts a GL call. Called by every state cache binding.
+  static void CountCall() {
+    base::subtle::NoBarrier_AtomicIncrement(&calls_, 1);
+  }
+
+  // Returns the counts of all the contexts of the process since the last time
+  // this was called, and starts counting again.
+  static Counts TakeCounts();
+
+  // Forgets all the shadowed state. Must be called after the state of the
+  // context was changed other than through the GL bindings.
+  void Reset();
+
+  // Each of these records the state a GL call sets and returns true if the
+  // call must be passed on to the driver, or false if it changes nothing.
+  bool ActiveTexture(unsigned int texture);
+  bool BindTexture(unsigned int target, unsigned int texture);
+  bool UseProgram(unsigned int program);
+  bool SetCapability(unsigned int cap, bool enabled);
+  bool BlendFunc(unsigned int sfactor, unsigned int dfactor);
+
+  // These record calls that change shadowed state without setting it.
+  // DeleteTextures() also tells the other contexts of the share group.
+  void InvalidateBlendFunc();
+  void DeleteTextures(int n, const unsigned int* textures);
+  void DeleteProgram(unsigned int program);
+
+  // Records that another context of the share group deleted |textures|.
+  void ForgetTextures(int n, const unsigned int* textures);
+
+ private:
+  // The texture units and targets whose bindings are shadowed. Bindings of
+  // other units and targets always reach the driver.
+  enum {
+    kMaxTextureUnits = 32,
+    kTextureTargetCount = 3
+  };
+
+  // The capabilities that are shadowed.
+  enum {
+    kCapabilityCount = 9
+  };
+
+  // A piece of shadowed state, which may be unknown.
+  struct Value {
+    Value() : known(false), value(0) {}
+
+    bool known;
+    unsigned int value;
+  };
+
+  // Makes the bindings of |textures| 0 if |unbound|, or unknown otherwise.
+  void ClearTextureBindings(int n, const unsigned int* textures, bool unbound);
+
+  // Returns the index of |target| in |textures_|, or -1 if it isn't shadowed.
+  static int GetTextureTargetIndex(unsigned int target);
+
+  // Returns the index of |cap| in |capabilities_|, or -1 if it isn't shadowed.
+  static int GetCapabilityIndex(unsigned int cap);
+
+  // Sets |state| to |value| and returns true if that changes it, counting the
+  // change or the lack of it.
+  static bool Update(Value* state, unsigned int value);
+
+  static base::subtle::Atomic32 calls_;
+  static base::subtle::Atomic32 state_changes_;
+  static base::subtle::Atomic32 dropped_state_changes_;
+
+  // The active texture unit, as an offset from GL_TEXTURE0.
+  Value active_texture_unit_;
+  Value textures_[kMaxTextureUnits][kTextureTargetCount];
+  Value program_;
+  Value capabilities_[kCapabilityCount];
+  Value blend_sfactor_;
+  Value blend_dfactor_;
+
+  DISALLOW_COPY_AND_ASSIGN(GLStateCache);
+};
+
+}  // namespace gfx
+
+#endif  // UI_GL_GL_STATE_CACHE_H_
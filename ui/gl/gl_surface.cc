@@ -66,6 +66,11 @@ bool GLSurface::InitializeOneOff() {
     DVLOG(1) << "Using "
              << GetGLImplementationName(GetGLImplementation())
              << " GL implementation.";
+    // The mock bindings must see every call the tests expect.
+    if (GetGLImplementation() != kGLImplementationMockGL &&
+        !CommandLine::ForCurrentProcess()->HasSwitch(
+            switches::kDisableGLStateCache))
+      InitializeStateCacheGLBindings();
     if (CommandLine::ForCurrentProcess()->HasSwitch(
         switches::kEnableGPUServiceLogging))
       InitializeDebugGLBindings();
@@ -4,6 +4,7 @@
 
 #include "ui/gl/gl_surface.h"
 
+#include "base/command_line.h"
 #include "base/debug/trace_event.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
@@ -15,11 +16,26 @@
 #include "ui/gl/gl_surface_glx.h"
 #include "ui/gl/gl_surface_osmesa.h"
 #include "ui/gl/gl_surface_stub.h"
+#include "ui/gl/gl_surface_triple_buffered.h"
+#include "ui/gl/gl_switches.h"
 
 namespace gfx {
 
 namespace {
 Display* g_osmesa_display;
+
+// Wraps |surface| in a TripleBufferedGLSurface if asked to on the command
+// line. Returns |surface| if that fails.
+scoped_refptr<GLSurface> MaybeTripleBuffer(GLSurface* surface) {
+  if (!CommandLine::ForCurrentProcess()->HasSwitch(
+      switches::kEnableTripleBufferedSurfaces))
+    return surface;
+  scoped_refptr<GLSurface> triple_buffered(
+      new TripleBufferedGLSurface(surface));
+  if (!triple_buffered->Initialize())
+    return surface;
+  return triple_buffered;
+}
 }  // namespace anonymous
 
 // This OSMesa GL surface can use XLib to swap the contents of the buffer to a
@@ -60,10 +76,10 @@ bool GLSurface::InitializeOneOffInternal() {
       }
       break;
     case kGLImplementationOSMesaGL:
-      if (!NativeViewGLSurfaceOSMesa::InitializeOneOff()) {
-        LOG(ERROR) << "NativeViewGLSurfaceOSMesa::InitializeOneOff failed.";
-        return false;
-      }
+      // Without a display OSMesa still draws into offscreen surfaces, which
+      // is all a headless process needs.
+      if (!NativeViewGLSurfaceOSMesa::InitializeOneOff())
+        LOG(WARNING) << "No X display: only offscreen OSMesa surfaces.";
       break;
     case kGLImplementationEGLGLES2:
       if (!GLSurfaceEGL::InitializeOneOff()) {
@@ -272,6 +288,8 @@ scoped_refptr<GLSurface> GLSurface::CreateViewGLSurface(
 
   switch (GetGLImplementation()) {
     case kGLImplementationOSMesaGL: {
+      if (!g_osmesa_display)
+        return NULL;
       scoped_refptr<GLSurface> surface(
           new NativeViewGLSurfaceOSMesa(window));
       if (!surface->Initialize())
@@ -285,7 +303,7 @@ scoped_refptr<GLSurface> GLSurface::CreateViewGLSurface(
       if (!surface->Initialize())
         return NULL;
 
-      return surface;
+      return MaybeTripleBuffer(surface);
     }
     case kGLImplementationEGLGLES2: {
       scoped_refptr<GLSurface> surface(new NativeViewGLSurfaceEGL(
@@ -293,7 +311,7 @@ scoped_refptr<GLSurface> GLSurface::CreateViewGLSurface(
       if (!surface->Initialize())
         return NULL;
 
-      return surface;
+      return MaybeTripleBuffer(surface);
     }
     case kGLImplementationMockGL:
       return new GLSurfaceStub;
@@ -0,0 +1,436 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gl/gl_surface_triple_buffered.h"
+
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/logging.h"
+#include "base/message_loop.h"
+#include "base/synchronization/waitable_event.h"
+#include "ui/gl/gl_bindings.h"
+#include "ui/gl/gl_context.h"
+#include "ui/gl/gl_fence.h"
+#include "ui/gl/gl_share_group.h"
+#include "ui/gl/gpu_preference.h"
+
+namespace gfx {
+
+namespace {
+
+// How often the present thread checks whether the frame it is to present is
+// rendered.
+const int kFencePollIntervalMs = 1;
+
+}  // namespace
+
+TripleBufferedGLSurface::Buffer::Buffer()
+    : state(BUFFER_FREE),
+      texture(0),
+      framebuffer(0),
+      present_framebuffer(0) {
+}
+
+TripleBufferedGLSurface::Buffer::~Buffer() {
+}
+
+TripleBufferedGLSurface::TripleBufferedGLSurface(GLSurface* view_surface)
+    : GLSurfaceAdapter(view_surface),
+      present_thread_("GLPresentThread"),
+      use_angle_blit_(false),
+      buffers_created_(false),
+      back_buffer_(0),
+      present_posted_(false),
+      dropped_frame_count_(0) {
+}
+
+TripleBufferedGLSurface::~TripleBufferedGLSurface() {
+  Destroy();
+}
+
+bool TripleBufferedGLSurface::Initialize() {
+  offscreen_surface_ = GLSurface::CreateOffscreenGLSurface(false,
+                                                           gfx::Size(1, 1));
+  if (!offscreen_surface_.get()) {
+    LOG(ERROR) << "Could not create the offscreen surface to render on.";
+    return false;
+  }
+  size_ = surface()->GetSize();
+  if (!present_thread_.Start()) {
+    LOG(ERROR) << "Could not start the present thread.";
+    return false;
+  }
+  return true;
+}
+
+void TripleBufferedGLSurface::Destroy() {
+  if (present_thread_.IsRunning()) {
+    present_thread_.message_loop()->PostTask(
+        FROM_HERE,
+        base::Bind(&TripleBufferedGLSurface::DestroyOnPresentThread,
+                   base::Unretained(this)));
+    present_thread_.Stop();
+  }
+  // The textures and framebuffers go away with the context if it isn't
+  // current.
+  if (buffers_created_ && GLContext::GetCurrent())
+    DeleteBuffers();
+  buffers_created_ = false;
+  if (offscreen_surface_.get()) {
+    offscreen_surface_->Destroy();
+    offscreen_surface_ = NULL;
+  }
+  GLSurfaceAdapter::Destroy();
+}
+
+bool TripleBufferedGLSurface::Resize(const gfx::Size& size) {
+  {
+    base::AutoLock lock(lock_);
+    if (size == size_)
+      return true;
+  }
+
+  // The present thread drops the frames of the old size before the buffers
+  // are reallocated.
+  bool result = false;
+  base::WaitableEvent done(false, false);
+  present_thread_.message_loop()->PostTask(
+      FROM_HERE,
+      base::Bind(&TripleBufferedGLSurface::ResizeOnPresentThread,
+                 base::Unretained(this), size, &done, &result));
+  done.Wait();
+
+  if (buffers_created_ && GLContext::GetCurrent())
+    AllocateBuffers();
+  return result;
+}
+
+bool TripleBufferedGLSurface::SwapBuffers() {
+  if (!buffers_created_)
+    return false;
+  TRACE_EVENT0("gpu", "TripleBufferedGLSurface::SwapBuffers");
+
+  scoped_ptr<GLFence> fence(GLFence::CreateForSharing());
+  if (!fence.get())
+    glFinish();
+
+  int old_back_buffer = back_buffer_;
+  bool post_present = false;
+  {
+    base::AutoLock lock(lock_);
+    // The new frame replaces the one that is still queued, if any.
+    int queued = FindBuffer(BUFFER_QUEUED);
+    if (queued >= 0) {
+      buffers_[queued].state = BUFFER_FREE;
+      buffers_[queued].fence.reset();
+      ++dropped_frame_count_;
+    }
+    Buffer& buffer = buffers_[back_buffer_];
+    buffer.state = BUFFER_QUEUED;
+    buffer.fence.swap(fence);
+    buffer.queued_time = base::TimeTicks::Now();
+
+    // At most one buffer is queued and one presented, so one is free.
+    back_buffer_ = FindBuffer(BUFFER_FREE);
+    DCHECK_GE(back_buffer_, 0);
+    buffers_[back_buffer_].state = BUFFER_RENDERING;
+
+    post_present = !present_posted_;
+    present_posted_ = true;
+  }
+  if (post_present) {
+    present_thread_.message_loop()->PostTask(
+        FROM_HERE,
+        base::Bind(&TripleBufferedGLSurface::PresentOnPresentThread,
+                   base::Unretained(this)));
+  }
+
+  // Framebuffer 0 stands for the back buffer: keep it bound if it was.
+  GLint framebuffer_binding = 0;
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &framebuffer_binding);
+  if (static_cast<GLuint>(framebuffer_binding) ==
+      buffers_[old_back_buffer].framebuffer) {
+    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,
+                         buffers_[back_buffer_].framebuffer);
+  }
+  return true;
+}
+
+bool TripleBufferedGLSurface::PostSubBuffer(
+    int x, int y, int width, int height) {
+  return false;
+}
+
+std::string TripleBufferedGLSurface::GetExtensions() {
+  // The extensions of the view surface, such as partial swaps, don't apply.
+  return std::string();
+}
+
+gfx::Size TripleBufferedGLSurface::GetSize() {
+  base::AutoLock lock(lock_);
+  return size_;
+}
+
+void* TripleBufferedGLSurface::GetHandle() {
+  return offscreen_surface_->GetHandle();
+}
+
+unsigned int TripleBufferedGLSurface::GetBackingFrameBufferObject() {
+  return buffers_created_ ? buffers_[back_buffer_].framebuffer : 0;
+}
+
+bool TripleBufferedGLSurface::OnMakeCurrent(GLContext* context) {
+  if (!offscreen_surface_->OnMakeCurrent(context))
+    return false;
+  if (buffers_created_)
+    return true;
+
+  bool has_blit = context->HasExtension("GL_EXT_framebuffer_blit");
+  use_angle_blit_ = !has_blit &&
+      context->HasExtension("GL_ANGLE_framebuffer_blit");
+  if (!has_blit && !use_angle_blit_) {
+    LOG(ERROR) << "Triple buffering needs framebuffer blits.";
+    return false;
+  }
+
+  bool result = false;
+  base::WaitableEvent done(false, false);
+  present_thread_.message_loop()->PostTask(
+      FROM_HERE,
+      base::Bind(&TripleBufferedGLSurface::InitializeOnPresentThread,
+                 base::Unretained(this),
+                 base::Unretained(context->share_group()),
+                 &done, &result));
+  done.Wait();
+  if (!result)
+    return false;
+
+  CreateBuffers();
+  return true;
+}
+
+void* TripleBufferedGLSurface::GetDisplay() {
+  return offscreen_surface_->GetDisplay();
+}
+
+void* TripleBufferedGLSurface::GetConfig() {
+  return offscreen_surface_->GetConfig();
+}
+
+unsigned TripleBufferedGLSurface::GetFormat() {
+  return offscreen_surface_->GetFormat();
+}
+
+base::TimeDelta TripleBufferedGLSurface::GetLastPresentLatency() {
+  base::AutoLock lock(lock_);
+  return last_present_latency_;
+}
+
+int TripleBufferedGLSurface::GetDroppedFrameCount() {
+  base::AutoLock lock(lock_);
+  return dropped_frame_count_;
+}
+
+void TripleBufferedGLSurface::CreateBuffers() {
+  GLint framebuffer_binding = 0;
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &framebuffer_binding);
+  GLint texture_binding = 0;
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture_binding);
+
+  for (int i = 0; i < kBufferCount; ++i) {
+    Buffer& buffer = buffers_[i];
+    glGenTextures(1, &buffer.texture);
+    glBindTexture(GL_TEXTURE_2D, buffer.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  }
+  buffers_created_ = true;
+  AllocateBuffers();
+
+  for (int i = 0; i < kBufferCount; ++i) {
+    Buffer& buffer = buffers_[i];
+    glGenFramebuffersEXT(1, &buffer.framebuffer);
+    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, buffer.framebuffer);
+    glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT,
+                              GL_TEXTURE_2D, buffer.texture, 0);
+  }
+
+  back_buffer_ = 0;
+  {
+    base::AutoLock lock(lock_);
+    buffers_[back_buffer_].state = BUFFER_RENDERING;
+  }
+
+  glBindTexture(GL_TEXTURE_2D, texture_binding);
+  glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, framebuffer_binding);
+}
+
+void TripleBufferedGLSurface::AllocateBuffers() {
+  gfx::Size size = GetSize();
+  GLint texture_binding = 0;
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture_binding);
+  for (int i = 0; i < kBufferCount; ++i) {
+    glBindTexture(GL_TEXTURE_2D, buffers_[i].texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.width(), size.height(), 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+  }
+  glBindTexture(GL_TEXTURE_2D, texture_binding);
+}
+
+void TripleBufferedGLSurface::DeleteBuffers() {
+  for (int i = 0; i < kBufferCount; ++i) {
+    Buffer& buffer = buffers_[i];
+    glDeleteFramebuffersEXT(1, &buffer.framebuffer);
+    glDeleteTextures(1, &buffer.texture);
+    buffer.framebuffer = 0;
+    buffer.texture = 0;
+    buffer.fence.reset();
+    buffer.state = BUFFER_FREE;
+  }
+}
+
+int TripleBufferedGLSurface::FindBuffer(BufferState state) const {
+  for (int i = 0; i < kBufferCount; ++i) {
+    if (buffers_[i].state == state)
+      return i;
+  }
+  return -1;
+}
+
+void TripleBufferedGLSurface::InitializeOnPresentThread(
+    GLShareGroup* share_group,
+    base::WaitableEvent* done,
+    bool* result) {
+  present_context_ = GLContext::CreateGLContext(share_group, surface(),
+                                                PreferIntegratedGpu);
+  if (present_context_.get() && present_context_->MakeCurrent(surface())) {
+    // Blocking on vsync is what this thread is for.
+    present_context_->SetSwapInterval(1);
+    *result = true;
+  } else {
+    LOG(ERROR) << "Could not create the context to present with.";
+    present_context_ = NULL;
+  }
+  done->Signal();
+}
+
+void TripleBufferedGLSurface::ResizeOnPresentThread(
+    const gfx::Size& size,
+    base::WaitableEvent* done,
+    bool* result) {
+  *result = surface()->Resize(size);
+  {
+    base::AutoLock lock(lock_);
+    size_ = size;
+    for (int i = 0; i < kBufferCount; ++i) {
+      Buffer& buffer = buffers_[i];
+      if (buffer.state == BUFFER_QUEUED || buffer.state == BUFFER_PRESENTING) {
+        buffer.state = BUFFER_FREE;
+        buffer.fence.reset();
+        ++dropped_frame_count_;
+      }
+    }
+  }
+  done->Signal();
+}
+
+void TripleBufferedGLSurface::PresentOnPresentThread() {
+  if (!present_context_.get())
+    return;
+
+  int index = -1;
+  gfx::Size size;
+  {
+    base::AutoLock lock(lock_);
+    present_posted_ = false;
+    // A buffer may already be waiting for its frame to be rendered.
+    index = FindBuffer(BUFFER_PRESENTING);
+    if (index < 0) {
+      index = FindBuffer(BUFFER_QUEUED);
+      if (index < 0)
+        return;
+      buffers_[index].state = BUFFER_PRESENTING;
+    }
+    size = size_;
+  }
+
+  // The state of the buffer is only changed on this thread while it is
+  // presented, so its fence can be tested without the lock.
+  Buffer& buffer = buffers_[index];
+  if (buffer.fence.get() && !buffer.fence->HasCompleted()) {
+    base::AutoLock lock(lock_);
+    if (!present_posted_) {
+      present_posted_ = true;
+      MessageLoop::current()->PostDelayedTask(
+          FROM_HERE,
+          base::Bind(&TripleBufferedGLSurface::PresentOnPresentThread,
+                     base::Unretained(this)),
+          base::TimeDelta::FromMilliseconds(kFencePollIntervalMs));
+    }
+    return;
+  }
+
+  {
+    TRACE_EVENT0("gpu", "TripleBufferedGLSurface::Present");
+    if (!buffer.present_framebuffer)
+      glGenFramebuffersEXT(1, &buffer.present_framebuffer);
+    glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, buffer.present_framebuffer);
+    glFramebufferTexture2DEXT(GL_READ_FRAMEBUFFER_EXT,
+                              GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D,
+                              buffer.texture, 0);
+    glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, 0);
+    if (use_angle_blit_) {
+      glBlitFramebufferANGLE(0, 0, size.width(), size.height(),
+                             0, 0, size.width(), size.height(),
+                             GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    } else {
+      glBlitFramebufferEXT(0, 0, size.width(), size.height(),
+                           0, 0, size.width(), size.height(),
+                           GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    surface()->SwapBuffers();
+  }
+
+  base::TimeDelta latency;
+  {
+    base::AutoLock lock(lock_);
+    // A resize may have dropped the frame meanwhile.
+    if (buffer.state == BUFFER_PRESENTING) {
+      latency = base::TimeTicks::Now() - buffer.queued_time;
+      last_present_latency_ = latency;
+      buffer.state = BUFFER_FREE;
+      buffer.fence.reset();
+    }
+    if (FindBuffer(BUFFER_QUEUED) >= 0 && !present_posted_) {
+      present_posted_ = true;
+      MessageLoop::current()->PostTask(
+          FROM_HERE,
+          base::Bind(&TripleBufferedGLSurface::PresentOnPresentThread,
+                     base::Unretained(this)));
+    }
+  }
+  TRACE_COUNTER1("gpu", "PresentLatencyUs", latency.InMicroseconds());
+}
+
+void TripleBufferedGLSurface::DestroyOnPresentThread() {
+  if (!present_context_.get())
+    return;
+  base::AutoLock lock(lock_);
+  for (int i = 0; i < kBufferCount; ++i) {
+    Buffer& buffer = buffers_[i];
+    if (buffer.present_framebuffer)
+      glDeleteFramebuffersEXT(1, &buffer.present_framebuffer);
+    buffer.present_framebuffer = 0;
+    // The fences are deleted while a context of their share group is current.
+    buffer.fence.reset();
+    if (buffer.state == BUFFER_QUEUED || buffer.state == BUFFER_PRESENTING)
+      buffer.state = BUFFER_FREE;
+  }
+  present_context_->ReleaseCurrent(surface());
+  present_context_ = NULL;
+}
+
+}  // namespace gfx
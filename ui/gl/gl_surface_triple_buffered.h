@@ -0,0 +1,143 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GL_GL_SURFACE_TRIPLE_BUFFERED_H_
+#define UI_GL_GL_SURFACE_TRIPLE_BUFFERED_H_
+#pragma once
+
+#include <string>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread.h"
+#include "base/time.h"
+#include "ui/gfx/size.h"
+#include "ui/gl/gl_surface.h"
+
+namespace base {
+class WaitableEvent;
+}
+
+namespace gfx {
+
+class GLFence;
+class GLShareGroup;
+
+// TripleBufferedGLSurface keeps SwapBuffers() from blocking on vsync. The
+// contexts made current with it render into one of three offscreen buffers,
+// the framebuffer object of which GetBackingFrameBufferObject() returns, and
+// are bound to a 1x1 offscreen surface rather than to the view. SwapBuffers()
+// fences the frame and queues it for a thread of the surface's own, which
+// waits for the fence, blits the frame into the view surface and swaps it
+// there. A queued frame that a newer one catches up with is dropped.
+//
+// The present thread renders with a context of the share group of the first
+// context made current with the surface. Blitting needs
+// GL_EXT_framebuffer_blit or GL_ANGLE_framebuffer_blit; making a context
+// current fails without them. Partial swaps aren't supported.
+class GL_EXPORT TripleBufferedGLSurface : public GLSurfaceAdapter {
+ public:
+  // Presents into |view_surface|, which must be initialized.
+  explicit TripleBufferedGLSurface(GLSurface* view_surface);
+
+  // Implement GLSurface.
+  virtual bool Initialize() OVERRIDE;
+  virtual void Destroy() OVERRIDE;
+  virtual bool Resize(const gfx::Size& size) OVERRIDE;
+  virtual bool SwapBuffers() OVERRIDE;
+  virtual bool PostSubBuffer(int x, int y, int width, int height) OVERRIDE;
+  virtual std::string GetExtensions() OVERRIDE;
+  virtual gfx::Size GetSize() OVERRIDE;
+  virtual void* GetHandle() OVERRIDE;
+  virtual unsigned int GetBackingFrameBufferObject() OVERRIDE;
+  virtual bool OnMakeCurrent(GLContext* context) OVERRIDE;
+  virtual void* GetDisplay() OVERRIDE;
+  virtual void* GetConfig() OVERRIDE;
+  virtual unsigned GetFormat() OVERRIDE;
+
+  // Returns how long the last frame presented took from SwapBuffers() to the
+  // swap of the view surface returning, and how many frames were dropped so
+  // far. May be called on any thread.
+  base::TimeDelta GetLastPresentLatency();
+  int GetDroppedFrameCount();
+
+ protected:
+  virtual ~TripleBufferedGLSurface();
+
+ private:
+  enum BufferState {
+    BUFFER_FREE,
+    BUFFER_RENDERING,
+    BUFFER_QUEUED,
+    BUFFER_PRESENTING
+  };
+
+  enum {
+    kBufferCount = 3
+  };
+
+  struct Buffer {
+    Buffer();
+    ~Buffer();
+
+    BufferState state;
+    // The color texture, shared by the contexts.
+    unsigned int texture;
+    // Framebuffer objects aren't shared: one for the context that renders,
+    // one for the present context.
+    unsigned int framebuffer;
+    unsigned int present_framebuffer;
+    // Signaled when the frame in the buffer is rendered. NULL if the frame was
+    // finished before being queued.
+    scoped_ptr<GLFence> fence;
+    base::TimeTicks queued_time;
+  };
+
+  // Creates the buffers with the context that is current, and allocates
+  // them at |size_|.
+  void CreateBuffers();
+  void AllocateBuffers();
+  void DeleteBuffers();
+
+  // Returns the index of the first buffer in |state|, or -1. |lock_| must be
+  // held.
+  int FindBuffer(BufferState state) const;
+
+  // Run on |present_thread_|.
+  void InitializeOnPresentThread(GLShareGroup* share_group,
+                                 base::WaitableEvent* done,
+                                 bool* result);
+  void ResizeOnPresentThread(const gfx::Size& size,
+                             base::WaitableEvent* done,
+                             bool* result);
+  void PresentOnPresentThread();
+  void DestroyOnPresentThread();
+
+  // The surface the contexts are made current on.
+  scoped_refptr<GLSurface> offscreen_surface_;
+
+  base::Thread present_thread_;
+  // Only used on |present_thread_|.
+  scoped_refptr<GLContext> present_context_;
+
+  bool use_angle_blit_;
+  bool buffers_created_;
+  Buffer buffers_[kBufferCount];
+  // The buffer being rendered. Only used on the thread that renders.
+  int back_buffer_;
+
+  // Guards the members below and the states, fences and queue times of the
+  // buffers.
+  base::Lock lock_;
+  gfx::Size size_;
+  bool present_posted_;
+  base::TimeDelta last_present_latency_;
+  int dropped_frame_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(TripleBufferedGLSurface);
+};
+
+}  // namespace gfx
+
+#endif  // UI_GL_GL_SURFACE_TRIPLE_BUFFERED_H_
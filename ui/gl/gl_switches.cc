@@ -17,6 +17,10 @@ const char kGLImplementationMockName[]        = "mock";
 
 namespace switches {
 
+// Pass every GL call on to the driver, rather than dropping the ones that
+// don't change the state of the context.
+const char kDisableGLStateCache[]           = "disable-gl-state-cache";
+
 // Disable dynamic switching between integrated and discrete GPU on
 // systems that would otherwise support it (currently, only a limited
 // number of MacBook Pros).
@@ -29,6 +33,11 @@ const char kDisableGpuVsync[]               = "disable-gpu-vsync";
 const char kEnableGPUServiceLogging[]       = "enable-gpu-service-logging";
 const char kEnableGPUClientLogging[]        = "enable-gpu-client-logging";
 
+// Render views into offscreen buffers and present them on a thread of their
+// own, so that swapping buffers doesn't block on vsync. See
+// TripleBufferedGLSurface.
+const char kEnableTripleBufferedSurfaces[]  = "enable-triple-buffered-surfaces";
+
 // Select which implementation of GL the GPU process should use. Options are:
 //  desktop: whatever desktop OpenGL the user has installed (Linux and Mac
 //           default).
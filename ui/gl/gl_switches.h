@@ -24,10 +24,12 @@ extern const char kGLImplementationMockName[];
 
 namespace switches {
 
+GL_EXPORT extern const char kDisableGLStateCache[];
 GL_EXPORT extern const char kDisableGpuSwitching[];
 GL_EXPORT extern const char kDisableGpuVsync[];
 GL_EXPORT extern const char kEnableGPUServiceLogging[];
 GL_EXPORT extern const char kEnableGPUClientLogging[];
+GL_EXPORT extern const char kEnableTripleBufferedSurfaces[];
 GL_EXPORT extern const char kGpuNoContextLost[];
 GL_EXPORT extern const char kGpuSwapDelay[];
 GL_EXPORT extern const char kUseGL[];
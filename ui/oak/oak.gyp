@@ -31,6 +31,8 @@
         'oak.h',
         'oak_aura_window_display.cc',
         'oak_aura_window_display.h',
+        'oak_cost_recorder.cc',
+        'oak_cost_recorder.h',
         'oak_export.h',
         'oak_pretty_print.cc',
         'oak_pretty_print.h',
@@ -10,6 +10,7 @@
 #include "base/utf_string_conversions.h"
 #include "ui/aura/window.h"
 #include "ui/base/models/table_model_observer.h"
+#include "ui/oak/oak_cost_recorder.h"
 #include "ui/oak/oak_pretty_print.h"
 
 namespace oak {
@@ -36,6 +37,12 @@ ROW_IGNOREEVENTS,
 ROW_CANFOCUS,
 ROW_HITTESTBOUNDSOVERRIDEOUTER,
 ROW_HITTESTBOUNDSOVERRIDEINNER,
+ROW_RECENTPAINTS,
+ROW_TOTALPAINTS,
+ROW_RECENTEVENTS,
+ROW_TOTALEVENTS,
+ROW_TEXTUREBYTES,
+ROW_ANIMATING,
 ROW_COUNT
 };
 
@@ -76,7 +83,10 @@ string16 PropertyWithWindowType(int type) {
 ////////////////////////////////////////////////////////////////////////////////
 // OakAuraWindowDisplay, public:
 
-OakAuraWindowDisplay::OakAuraWindowDisplay() : observer_(NULL), window_(NULL) {
+OakAuraWindowDisplay::OakAuraWindowDisplay(const OakCostRecorder* costs)
+    : costs_(costs),
+      observer_(NULL),
+      window_(NULL) {
 }
 
 OakAuraWindowDisplay::~OakAuraWindowDisplay() {
@@ -149,6 +159,31 @@ string16 OakAuraWindowDisplay::GetText(int row, int column_id) {
     case ROW_HITTESTBOUNDSOVERRIDEINNER:
       return PropertyWithInsets("Hit test bounds override inner: ",
                                 window_->hit_test_bounds_override_inner());
+    case ROW_RECENTPAINTS: {
+      WindowCost cost = costs_->GetRecentCost(window_);
+      return PropertyWithCost("Paints (last second): ", cost.paint_count,
+                              cost.paint_time);
+    }
+    case ROW_TOTALPAINTS: {
+      WindowCost cost = costs_->GetTotalCost(window_);
+      return PropertyWithCost("Paints (total): ", cost.paint_count,
+                              cost.paint_time);
+    }
+    case ROW_RECENTEVENTS: {
+      WindowCost cost = costs_->GetRecentCost(window_);
+      return PropertyWithCost("Events (last second): ", cost.event_count,
+                              cost.event_time);
+    }
+    case ROW_TOTALEVENTS: {
+      WindowCost cost = costs_->GetTotalCost(window_);
+      return PropertyWithCost("Events (total): ", cost.event_count,
+                              cost.event_time);
+    }
+    case ROW_TEXTUREBYTES:
+      return PropertyWithBytes("Layer texture: ",
+                               GetWindowTextureBytes(window_));
+    case ROW_ANIMATING:
+      return PropertyWithBool("Animating: ", IsWindowAnimating(window_));
     default:
       NOTREACHED();
       break;
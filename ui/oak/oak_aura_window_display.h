@@ -12,9 +12,12 @@
 namespace oak {
 namespace internal {
 
+class OakCostRecorder;
+
 class OakAuraWindowDisplay : public OakDetailsModel {
  public:
-  OakAuraWindowDisplay();
+  // |costs| provides the costs of the windows and must outlive the display.
+  explicit OakAuraWindowDisplay(const OakCostRecorder* costs);
   virtual ~OakAuraWindowDisplay();
 
  private:
@@ -26,6 +29,7 @@ class OakAuraWindowDisplay : public OakDetailsModel {
   virtual string16 GetText(int row, int column_id) OVERRIDE;
   virtual void SetObserver(ui::TableModelObserver* observer) OVERRIDE;
 
+  const OakCostRecorder* costs_;
   ui::TableModelObserver* observer_;
   aura::Window* window_;
 
@@ -0,0 +1,102 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/oak/oak_cost_recorder.h"
+
+#include "base/logging.h"
+#include "ui/aura/env.h"
+#include "ui/aura/window.h"
+#include "ui/compositor/layer.h"
+
+namespace oak {
+namespace internal {
+
+////////////////////////////////////////////////////////////////////////////////
+// WindowCost, public:
+
+WindowCost::WindowCost() : paint_count(0), event_count(0) {
+}
+
+void WindowCost::Add(const WindowCost& other) {
+  paint_count += other.paint_count;
+  paint_time += other.paint_time;
+  event_count += other.event_count;
+  event_time += other.event_time;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// OakCostRecorder, public:
+
+OakCostRecorder::OakCostRecorder() {
+  DCHECK(!aura::Env::GetInstance()->window_cost_recorder());
+  aura::Env::GetInstance()->set_window_cost_recorder(this);
+}
+
+OakCostRecorder::~OakCostRecorder() {
+  DCHECK_EQ(this, aura::Env::GetInstance()->window_cost_recorder());
+  aura::Env::GetInstance()->set_window_cost_recorder(NULL);
+}
+
+void OakCostRecorder::StartTracking(aura::Window* window) {
+  costs_[window];
+}
+
+void OakCostRecorder::StopTracking(aura::Window* window) {
+  costs_.erase(window);
+}
+
+void OakCostRecorder::EndInterval() {
+  for (CostMap::iterator i = costs_.begin(); i != costs_.end(); ++i) {
+    i->second.total.Add(i->second.current);
+    i->second.recent = i->second.current;
+    i->second.current = WindowCost();
+  }
+}
+
+WindowCost OakCostRecorder::GetRecentCost(aura::Window* window) const {
+  CostMap::const_iterator i = costs_.find(window);
+  return i != costs_.end() ? i->second.recent : WindowCost();
+}
+
+WindowCost OakCostRecorder::GetTotalCost(aura::Window* window) const {
+  CostMap::const_iterator i = costs_.find(window);
+  if (i == costs_.end())
+    return WindowCost();
+  WindowCost total = i->second.total;
+  total.Add(i->second.current);
+  return total;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// OakCostRecorder, aura::WindowCostRecorder implementation:
+
+void OakCostRecorder::OnWindowPainted(aura::Window* window,
+                                      base::TimeDelta duration) {
+  CostMap::iterator i = costs_.find(window);
+  if (i == costs_.end())
+    return;
+  i->second.current.paint_count++;
+  i->second.current.paint_time += duration;
+}
+
+void OakCostRecorder::OnWindowHandledEvent(aura::Window* window,
+                                           base::TimeDelta duration) {
+  // |window| may be gone; it is only looked up.
+  CostMap::iterator i = costs_.find(window);
+  if (i == costs_.end())
+    return;
+  i->second.current.event_count++;
+  i->second.current.event_time += duration;
+}
+
+size_t GetWindowTextureBytes(aura::Window* window) {
+  return window->layer() ? window->layer()->GetTextureMemoryBytes() : 0;
+}
+
+bool IsWindowAnimating(aura::Window* window) {
+  return window->layer() && window->layer()->IsAnimating();
+}
+
+}  // namespace internal
+}  // namespace oak
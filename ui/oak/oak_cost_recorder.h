@@ -0,0 +1,81 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_OAK_OAK_COST_RECORDER_H_
+#define UI_OAK_OAK_COST_RECORDER_H_
+#pragma once
+
+#include <map>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/time.h"
+#include "ui/aura/window_cost_recorder.h"
+
+namespace oak {
+namespace internal {
+
+// The work a window did over some time.
+struct WindowCost {
+  WindowCost();
+
+  void Add(const WindowCost& other);
+
+  int paint_count;
+  base::TimeDelta paint_time;
+  int event_count;
+  base::TimeDelta event_time;
+};
+
+// Records the time the windows that Oak shows spend painting and handling
+// events. The time is split into intervals, so that Oak can show what the
+// windows cost lately as well as since they are tracked. Only one
+// OakCostRecorder can exist at a time, as it installs itself on the aura::Env.
+class OakCostRecorder : public aura::WindowCostRecorder {
+ public:
+  OakCostRecorder();
+  virtual ~OakCostRecorder();
+
+  // Starts and stops recording the costs of |window|. Costs of windows that
+  // aren't tracked are dropped.
+  void StartTracking(aura::Window* window);
+  void StopTracking(aura::Window* window);
+
+  // Ends the current interval, whose costs become the recent costs.
+  void EndInterval();
+
+  // Returns the costs of |window| over the last complete interval, and since
+  // it is tracked.
+  WindowCost GetRecentCost(aura::Window* window) const;
+  WindowCost GetTotalCost(aura::Window* window) const;
+
+ private:
+  struct Costs {
+    WindowCost current;
+    WindowCost recent;
+    WindowCost total;
+  };
+  typedef std::map<aura::Window*, Costs> CostMap;
+
+  // Overridden from aura::WindowCostRecorder:
+  virtual void OnWindowPainted(aura::Window* window,
+                               base::TimeDelta duration) OVERRIDE;
+  virtual void OnWindowHandledEvent(aura::Window* window,
+                                    base::TimeDelta duration) OVERRIDE;
+
+  CostMap costs_;
+
+  DISALLOW_COPY_AND_ASSIGN(OakCostRecorder);
+};
+
+// Returns the bytes that the texture of the layer of |window| takes.
+size_t GetWindowTextureBytes(aura::Window* window);
+
+// Returns true if the layer of |window| is animating.
+bool IsWindowAnimating(aura::Window* window);
+
+}  // namespace internal
+}  // namespace oak
+
+#endif  // UI_OAK_OAK_COST_RECORDER_H_
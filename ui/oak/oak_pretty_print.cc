@@ -8,6 +8,7 @@
 #include "base/utf_string_conversions.h"
 #include "base/string_number_conversions.h"
 #include "base/stringprintf.h"
+#include "base/time.h"
 #include "ui/gfx/insets.h"
 #include "ui/gfx/rect.h"
 
@@ -39,5 +40,20 @@ string16 PropertyWithInsets(const std::string& prefix,
   return ASCIIToUTF16(prefix + insets.ToString());
 }
 
+string16 PropertyWithBytes(const std::string& prefix, size_t bytes) {
+  if (bytes < 1024)
+    return ASCIIToUTF16(prefix + base::StringPrintf("%d B",
+                                                    static_cast<int>(bytes)));
+  return ASCIIToUTF16(prefix + base::StringPrintf("%.1f KB", bytes / 1024.0));
+}
+
+string16 PropertyWithCost(const std::string& prefix,
+                          int count,
+                          base::TimeDelta time) {
+  return ASCIIToUTF16(prefix + base::StringPrintf("%d, %.2f ms",
+                                                  count,
+                                                  time.InMillisecondsF()));
+}
+
 }  // namespace internal
 }  // namespace oak
@@ -8,6 +8,10 @@
 
 #include "base/string16.h"
 
+namespace base {
+class TimeDelta;
+}
+
 namespace gfx {
 class Insets;
 class Rect;
@@ -24,6 +28,11 @@ string16 PropertyWithBool(const std::string& prefix, bool value);
 string16 PropertyWithBounds(const std::string& prefix, const gfx::Rect& bounds);
 string16 PropertyWithInsets(const std::string& prefix,
                             const gfx::Insets& insets);
+string16 PropertyWithBytes(const std::string& prefix, size_t bytes);
+// Prints |count| occurrences that took |time| in total.
+string16 PropertyWithCost(const std::string& prefix,
+                          int count,
+                          base::TimeDelta time);
 
 }  // namespace internal
 }  // namespace oak
@@ -4,13 +4,21 @@
 
 #include "ui/oak/oak_tree_model.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/stringprintf.h"
 #include "base/utf_string_conversions.h"
 #include "ui/aura/root_window.h"
 #include "ui/aura/window.h"
 #include "ui/base/models/tree_node_model.h"
+#include "ui/oak/oak_cost_recorder.h"
 
 namespace oak {
 namespace internal {
+namespace {
 
 string16 GetNodeTitleForWindow(aura::Window* window) {
   std::string window_name = window->name();
@@ -19,20 +27,201 @@ string16 GetNodeTitleForWindow(aura::Window* window) {
   return ASCIIToUTF16(window_name);
 }
 
-void AddChildWindows(aura::Window* parent_window, WindowNode* parent_node) {
-  aura::Window::Windows::const_iterator it = parent_window->children().begin();
-  for (; it != parent_window->children().end(); ++it) {
-    WindowNode* child_node = new WindowNode(GetNodeTitleForWindow(*it), *it);
-    parent_node->Add(child_node, parent_node->child_count());
-    AddChildWindows(*it, child_node);
+// Returns the index of each child of |window| in the stacking order.
+void GetStackingIndices(aura::Window* window,
+                        std::map<aura::Window*, int>* indices) {
+  const aura::Window::Windows& children = window->children();
+  for (size_t i = 0; i < children.size(); ++i)
+    (*indices)[children[i]] = static_cast<int>(i);
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// OakTreeModel, public:
+
+OakTreeModel::OakTreeModel(aura::Window* root, OakCostRecorder* costs)
+    : TreeOfWindows(new WindowNode(GetNodeTitleForWindow(root), root)),
+      root_(root),
+      costs_(costs),
+      sort_order_(SORT_BY_STACKING) {
+  WindowNode* root_node = GetRoot();
+  nodes_[root] = root_node;
+  root->AddObserver(this);
+  costs_->StartTracking(root);
+  const aura::Window::Windows& children = root->children();
+  for (size_t i = 0; i < children.size(); ++i)
+    root_node->Add(CreateNodes(children[i]), root_node->child_count());
+}
+
+OakTreeModel::~OakTreeModel() {
+  if (root_)
+    ForgetNodes(GetRoot());
+}
+
+void OakTreeModel::SetSortOrder(SortOrder order) {
+  DCHECK_LT(order, SORT_ORDER_COUNT);
+  sort_order_ = order;
+  if (root_)
+    SortChildren(GetRoot(), true);
+}
+
+void OakTreeModel::Refresh() {
+  if (!root_)
+    return;
+  costs_->EndInterval();
+  RefreshNodes(GetRoot());
+  if (sort_order_ != SORT_BY_STACKING)
+    SortChildren(GetRoot(), true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// OakTreeModel, aura::WindowObserver implementation:
+
+void OakTreeModel::OnWindowAdded(aura::Window* new_window) {
+  std::map<aura::Window*, WindowNode*>::iterator parent =
+      nodes_.find(new_window->parent());
+  DCHECK(parent != nodes_.end());
+  WindowNode* parent_node = parent->second;
+  const aura::Window::Windows& siblings = new_window->parent()->children();
+  int index = static_cast<int>(
+      std::find(siblings.begin(), siblings.end(), new_window) -
+      siblings.begin());
+  // When sorted by cost the window settles at the next Refresh().
+  Add(parent_node, CreateNodes(new_window),
+      std::min(index, parent_node->child_count()));
+}
+
+void OakTreeModel::OnWillRemoveWindow(aura::Window* window) {
+  std::map<aura::Window*, WindowNode*>::iterator node = nodes_.find(window);
+  DCHECK(node != nodes_.end());
+  WindowNode* window_node = node->second;
+  ForgetNodes(window_node);
+  delete Remove(window_node->parent(), window_node);
+}
+
+void OakTreeModel::OnWindowStackingChanged(aura::Window* window) {
+  if (sort_order_ != SORT_BY_STACKING || !window->parent())
+    return;
+  std::map<aura::Window*, WindowNode*>::iterator parent =
+      nodes_.find(window->parent());
+  if (parent != nodes_.end())
+    SortChildren(parent->second, false);
+}
+
+void OakTreeModel::OnWindowDestroying(aura::Window* window) {
+  // The other windows are removed from their parent before they go away.
+  if (window != root_)
+    return;
+  ForgetNodes(GetRoot());
+  root_ = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// OakTreeModel, private:
+
+WindowNode* OakTreeModel::CreateNodes(aura::Window* window) {
+  WindowNode* node = new WindowNode(GetTitle(window), window);
+  nodes_[window] = node;
+  window->AddObserver(this);
+  costs_->StartTracking(window);
+  const aura::Window::Windows& children = window->children();
+  for (size_t i = 0; i < children.size(); ++i)
+    node->Add(CreateNodes(children[i]), node->child_count());
+  return node;
+}
+
+void OakTreeModel::ForgetNodes(WindowNode* node) {
+  aura::Window* window = node->value;
+  window->RemoveObserver(this);
+  costs_->StopTracking(window);
+  nodes_.erase(window);
+  subtree_costs_.erase(node);
+  for (int i = 0; i < node->child_count(); ++i)
+    ForgetNodes(node->GetChild(i));
+}
+
+string16 OakTreeModel::GetTitle(aura::Window* window) const {
+  std::string title = UTF16ToUTF8(GetNodeTitleForWindow(window));
+  WindowCost cost = costs_->GetRecentCost(window);
+  if (cost.paint_count) {
+    base::StringAppendF(&title, ", %d paints in %.1f ms", cost.paint_count,
+                        cost.paint_time.InMillisecondsF());
+  }
+  if (cost.event_count) {
+    base::StringAppendF(&title, ", %d events in %.1f ms", cost.event_count,
+                        cost.event_time.InMillisecondsF());
   }
+  size_t texture_bytes = GetWindowTextureBytes(window);
+  if (texture_bytes) {
+    base::StringAppendF(&title, ", %d KB",
+                        static_cast<int>(texture_bytes / 1024));
+  }
+  if (IsWindowAnimating(window))
+    title.append(", animating");
+  return UTF8ToUTF16(title);
 }
 
-TreeOfWindows* GenerateModel(aura::Window* root) {
-  WindowNode* root_node = new WindowNode(GetNodeTitleForWindow(root), root);
-  TreeOfWindows* tree = new TreeOfWindows(root_node);
-  AddChildWindows(root, root_node);
-  return tree;
+int64 OakTreeModel::RefreshNodes(WindowNode* node) {
+  aura::Window* window = node->value;
+  string16 title = GetTitle(window);
+  if (title != node->GetTitle())
+    SetTitle(node, title);
+
+  int64 cost = 0;
+  switch (sort_order_) {
+    case SORT_BY_PAINT_TIME:
+      cost = costs_->GetRecentCost(window).paint_time.InMicroseconds();
+      break;
+    case SORT_BY_EVENT_TIME:
+      cost = costs_->GetRecentCost(window).event_time.InMicroseconds();
+      break;
+    case SORT_BY_TEXTURE_BYTES:
+      cost = static_cast<int64>(GetWindowTextureBytes(window));
+      break;
+    default:
+      break;
+  }
+  for (int i = 0; i < node->child_count(); ++i)
+    cost += RefreshNodes(node->GetChild(i));
+  subtree_costs_[node] = cost;
+  return cost;
+}
+
+void OakTreeModel::SortChildren(WindowNode* node, bool recursive) {
+  std::map<aura::Window*, int> stacking;
+  GetStackingIndices(node->value, &stacking);
+
+  // Sorted by key, which is the negated cost so that the most costly windows
+  // come first, then the stacking order.
+  typedef std::pair<std::pair<int64, int>, WindowNode*> SortEntry;
+  std::vector<SortEntry> entries;
+  for (int i = 0; i < node->child_count(); ++i) {
+    WindowNode* child = node->GetChild(i);
+    int64 cost = 0;
+    if (sort_order_ != SORT_BY_STACKING) {
+      std::map<WindowNode*, int64>::const_iterator it =
+          subtree_costs_.find(child);
+      if (it != subtree_costs_.end())
+        cost = it->second;
+    }
+    entries.push_back(
+        SortEntry(std::make_pair(-cost, stacking[child->value]), child));
+  }
+  std::sort(entries.begin(), entries.end());
+
+  // Moves the children that are out of place, so that observers only hear
+  // about the ones that moved.
+  for (size_t i = 0; i < entries.size(); ++i) {
+    int index = node->GetIndexOf(entries[i].second);
+    if (index != static_cast<int>(i))
+      MoveChildren(node, index, 1, static_cast<int>(i));
+  }
+
+  if (recursive) {
+    for (int i = 0; i < node->child_count(); ++i)
+      SortChildren(node->GetChild(i), true);
+  }
 }
 
 }  // namespace internal
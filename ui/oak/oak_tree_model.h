@@ -6,7 +6,11 @@
 #define UI_OAK_OAK_TREE_MODEL_H_
 #pragma once
 
+#include <map>
+
+#include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "ui/aura/window_observer.h"
 #include "ui/base/models/tree_node_model.h"
 
 namespace aura {
@@ -16,10 +20,77 @@ class Window;
 namespace oak {
 namespace internal {
 
+class OakCostRecorder;
+
 typedef ui::TreeNodeWithValue<aura::Window*> WindowNode;
 typedef ui::TreeNodeModel<WindowNode> TreeOfWindows;
 
-TreeOfWindows* GenerateModel(aura::Window* root);
+// How the siblings of the tree are ordered. Costs are those of the last
+// interval of the OakCostRecorder, summed over the subtree of each window, and
+// the most costly windows come first.
+enum SortOrder {
+  SORT_BY_STACKING = 0,
+  SORT_BY_PAINT_TIME,
+  SORT_BY_EVENT_TIME,
+  SORT_BY_TEXTURE_BYTES,
+  SORT_ORDER_COUNT
+};
+
+// The tree of the windows below a root window. It follows the hierarchy as
+// windows are added and removed, one subtree at a time, rather than being
+// rebuilt. The titles of the nodes show the recent costs of the windows, and
+// are updated by Refresh().
+class OakTreeModel : public TreeOfWindows,
+                     public aura::WindowObserver {
+ public:
+  // |costs| must outlive the model; it is told which windows to track.
+  OakTreeModel(aura::Window* root, OakCostRecorder* costs);
+  virtual ~OakTreeModel();
+
+  SortOrder sort_order() const { return sort_order_; }
+  void SetSortOrder(SortOrder order);
+
+  // Ends the interval of the cost recorder, then updates the titles whose
+  // text changed and reorders the siblings whose order changed.
+  void Refresh();
+
+ private:
+  // Overridden from aura::WindowObserver:
+  virtual void OnWindowAdded(aura::Window* new_window) OVERRIDE;
+  virtual void OnWillRemoveWindow(aura::Window* window) OVERRIDE;
+  virtual void OnWindowStackingChanged(aura::Window* window) OVERRIDE;
+  virtual void OnWindowDestroying(aura::Window* window) OVERRIDE;
+
+  // Creates the nodes of |window| and its descendants, and starts observing
+  // and tracking them.
+  WindowNode* CreateNodes(aura::Window* window);
+
+  // Stops observing and tracking the windows of |node| and its descendants.
+  void ForgetNodes(WindowNode* node);
+
+  // Returns the title of the node of |window|.
+  string16 GetTitle(aura::Window* window) const;
+
+  // Updates the titles below |node|, and returns the cost of its subtree for
+  // the sort order.
+  int64 RefreshNodes(WindowNode* node);
+
+  // Reorders the children of |node| by the sort order, and the children of
+  // its descendants if |recursive|.
+  void SortChildren(WindowNode* node, bool recursive);
+
+  aura::Window* root_;
+  OakCostRecorder* costs_;
+  SortOrder sort_order_;
+
+  // The node of each window in the tree.
+  std::map<aura::Window*, WindowNode*> nodes_;
+
+  // The subtree costs computed by the last Refresh(), for sorting.
+  std::map<WindowNode*, int64> subtree_costs_;
+
+  DISALLOW_COPY_AND_ASSIGN(OakTreeModel);
+};
 
 }  // namespace internal
 }  // namespace oak
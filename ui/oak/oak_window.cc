@@ -12,6 +12,8 @@
 #include "ui/gfx/image/image.h"
 #include "ui/oak/oak.h"
 #include "ui/oak/oak_aura_window_display.h"
+#include "ui/oak/oak_cost_recorder.h"
+#include "ui/views/controls/combobox/combobox.h"
 #include "ui/views/controls/table/table_view.h"
 #include "ui/views/controls/tree/tree_view.h"
 #include "ui/views/layout/layout_constants.h"
@@ -21,6 +23,11 @@ namespace oak {
 namespace internal {
 namespace {
 const SkColor kBorderColor = SkColorSetRGB(0xCC, 0xCC, 0xCC);
+
+// How often the costs are refreshed. The details show the costs over the last
+// interval as those of the last second.
+const int kRefreshIntervalMs = 1000;
+
 }  // namespace
 
 // static
@@ -29,10 +36,15 @@ views::Widget* OakWindow::instance = NULL;
 ////////////////////////////////////////////////////////////////////////////////
 // OakWindow, public:
 
-OakWindow::OakWindow() : tree_(NULL), tree_container_(NULL), details_(NULL) {
+OakWindow::OakWindow()
+    : tree_(NULL),
+      tree_container_(NULL),
+      sort_combobox_(NULL),
+      details_(NULL) {
 }
 
 OakWindow::~OakWindow() {
+  refresh_timer_.Stop();
   // The tree/table need to be destroyed before the model.
   tree_.reset();
   details_.reset();
@@ -91,8 +103,14 @@ void OakWindow::Layout() {
 
   int tree_height =
       (content_bounds.height() / 2) - views::kUnrelatedControlVerticalSpacing;
+  gfx::Rect sort_bounds = content_bounds;
+  sort_bounds.set_height(sort_combobox_->GetPreferredSize().height());
+  sort_combobox_->SetBoundsRect(sort_bounds);
+
   gfx::Rect tree_bounds = content_bounds;
-  tree_bounds.set_height(tree_height);
+  tree_bounds.set_y(
+      sort_bounds.bottom() + views::kRelatedControlVerticalSpacing);
+  tree_bounds.set_height(tree_height - (tree_bounds.y() - content_bounds.y()));
   tree_container_->SetBoundsRect(tree_bounds);
 
   separator_rect_ = content_bounds;
@@ -111,15 +129,52 @@ void OakWindow::Layout() {
 // OakWindow, views::TreeViewController implementation:
 
 void OakWindow::OnTreeViewSelectionChanged(views::TreeView* tree) {
-  details_model_->SetValue(tree_model_->AsNode(tree->GetSelectedNode())->value);
+  ui::TreeModelNode* selected = tree->GetSelectedNode();
+  details_model_->SetValue(
+      selected ? tree_model_->AsNode(selected)->value : NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// OakWindow, ui::ComboboxModel implementation:
+
+int OakWindow::GetItemCount() const {
+  return SORT_ORDER_COUNT;
+}
+
+string16 OakWindow::GetItemAt(int index) {
+  switch (index) {
+    case SORT_BY_STACKING:
+      return ASCIIToUTF16("Sort by stacking order");
+    case SORT_BY_PAINT_TIME:
+      return ASCIIToUTF16("Sort by paint time");
+    case SORT_BY_EVENT_TIME:
+      return ASCIIToUTF16("Sort by event time");
+    case SORT_BY_TEXTURE_BYTES:
+      return ASCIIToUTF16("Sort by texture memory");
+    default:
+      NOTREACHED();
+      return string16();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// OakWindow, views::ComboboxListener implementation:
+
+void OakWindow::OnSelectedIndexChanged(views::Combobox* combobox) {
+  DCHECK_EQ(sort_combobox_, combobox);
+  ui::TreeModelNode* selected = tree_->GetSelectedNode();
+  tree_model_->SetSortOrder(static_cast<SortOrder>(combobox->selected_index()));
+  if (selected)
+    tree_->SetSelectedNode(selected);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // OakWindow, private:
 
 void OakWindow::Init() {
-  tree_model_.reset(
-      GenerateModel(GetWidget()->GetNativeView()->GetRootWindow()));
+  costs_.reset(new OakCostRecorder);
+  tree_model_.reset(new OakTreeModel(
+      GetWidget()->GetNativeView()->GetRootWindow(), costs_.get()));
   tree_.reset(new views::TreeView);
   tree_->set_owned_by_client();
   tree_->SetController(this);
@@ -127,7 +182,12 @@ void OakWindow::Init() {
   tree_container_ = tree_->CreateParentIfNecessary();
   AddChildView(tree_container_);
 
-  details_model_.reset(new OakAuraWindowDisplay);
+  sort_combobox_ = new views::Combobox(this);
+  sort_combobox_->SetSelectedIndex(tree_model_->sort_order());
+  sort_combobox_->set_listener(this);
+  AddChildView(sort_combobox_);
+
+  details_model_.reset(new OakAuraWindowDisplay(costs_.get()));
   std::vector<ui::TableColumn> columns;
   columns.push_back(ui::TableColumn());
   details_.reset(new views::TableView(details_model_.get(),
@@ -142,6 +202,24 @@ void OakWindow::Init() {
   AddChildView(details_container_);
 
   OnTreeViewSelectionChanged(tree_.get());
+
+  refresh_timer_.Start(FROM_HERE,
+                       base::TimeDelta::FromMilliseconds(kRefreshIntervalMs),
+                       this, &OakWindow::RefreshCosts);
+}
+
+void OakWindow::RefreshCosts() {
+  // Nodes are only deleted when their window goes away, so |selected| stays
+  // valid while the tree is refreshed.
+  ui::TreeModelNode* selected = tree_->GetSelectedNode();
+  tree_model_->Refresh();
+
+  // Moving the selected node among its siblings moves the selection to its
+  // parent.
+  if (selected && tree_->GetSelectedNode() != selected)
+    tree_->SetSelectedNode(selected);
+  else
+    OnTreeViewSelectionChanged(tree_.get());
 }
 
 }  // namespace internal
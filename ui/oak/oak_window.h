@@ -6,22 +6,28 @@
 #define UI_OAK_OAK_WINDOW_H_
 #pragma once
 
+#include "base/timer.h"
+#include "ui/base/models/combobox_model.h"
 #include "ui/oak/oak_tree_model.h"
+#include "ui/views/controls/combobox/combobox_listener.h"
 #include "ui/views/controls/tree/tree_view_controller.h"
 #include "ui/views/widget/widget_delegate.h"
 
 namespace views {
+class Combobox;
 class TableView;
 }
 
 namespace oak {
 namespace internal {
 
-class OakTreeModel;
+class OakCostRecorder;
 class OakDetailsModel;
 
 class OakWindow : public views::WidgetDelegateView,
-                  public views::TreeViewController {
+                  public views::TreeViewController,
+                  public ui::ComboboxModel,
+                  public views::ComboboxListener {
  public:
   OakWindow();
   virtual ~OakWindow();
@@ -48,18 +54,36 @@ class OakWindow : public views::WidgetDelegateView,
   // Overridden from views::TreeViewController:
   virtual void OnTreeViewSelectionChanged(views::TreeView* tree) OVERRIDE;
 
+  // Overridden from ui::ComboboxModel, listing the sort orders:
+  virtual int GetItemCount() const OVERRIDE;
+  virtual string16 GetItemAt(int index) OVERRIDE;
+
+  // Overridden from views::ComboboxListener:
+  virtual void OnSelectedIndexChanged(views::Combobox* combobox) OVERRIDE;
+
   void Init();
 
+  // Updates the costs shown in the tree and the details, keeping the selected
+  // window selected as the tree is resorted.
+  void RefreshCosts();
+
+  // Records the costs of the windows. Outlives the models that read it.
+  scoped_ptr<OakCostRecorder> costs_;
+
   scoped_ptr<views::TreeView> tree_;
-  scoped_ptr<TreeOfWindows> tree_model_;
+  scoped_ptr<OakTreeModel> tree_model_;
   views::View* tree_container_;
 
+  views::Combobox* sort_combobox_;
+
   gfx::Rect separator_rect_;
 
   scoped_ptr<views::TableView> details_;
   scoped_ptr<OakDetailsModel> details_model_;
   views::View* details_container_;
 
+  base::RepeatingTimer<OakWindow> refresh_timer_;
+
   DISALLOW_COPY_AND_ASSIGN(OakWindow);
 };
 
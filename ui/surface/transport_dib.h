@@ -19,6 +19,10 @@
 #include "ui/base/x/x11_util.h"
 #endif
 
+namespace gfx {
+class Size;
+}
+
 namespace skia {
 class PlatformCanvas;
 }
@@ -195,6 +199,13 @@ class SURFACE_EXPORT TransportDIB {
   // Map the shared memory into the X server and return an id for the shared
   // segment.
   XID MapToX(Display* connection);
+
+  // Create an X pixmap of |size| and |depth| whose pixels are the memory of
+  // this transport DIB, mapping it if needed. The X server, and GL through
+  // gfx::GLImage, then read the pixels in place rather than from a copy.
+  // Returns 0 if the X server has no shared memory pixmaps or the pixmap
+  // doesn't fit. The caller frees the pixmap before destroying the DIB.
+  XID CreateXPixmap(Display* connection, const gfx::Size& size, int depth);
 #endif
 
  private:
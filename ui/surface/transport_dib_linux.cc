@@ -6,9 +6,15 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/ipc.h>
 #include <sys/shm.h>
 
+extern "C" {
+#include <X11/Xlib.h>
+#include <X11/extensions/XShm.h>
+}
+
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "skia/ext/platform_canvas.h"
@@ -139,3 +145,29 @@ XID TransportDIB::MapToX(Display* display) {
 
   return x_shm_;
 }
+
+XID TransportDIB::CreateXPixmap(Display* display,
+                                const gfx::Size& size,
+                                int depth) {
+  if (ui::QuerySharedMemorySupport(display) != ui::SHARED_MEMORY_PIXMAP)
+    return 0;
+  if (address_ == kInvalidAddress && !Map())
+    return 0;
+
+  size_t bytes_per_row = static_cast<size_t>(size.width()) *
+      ui::BitsPerPixelForPixmapDepth(display, depth) / 8;
+  if (size.IsEmpty() || bytes_per_row * size.height() > size_) {
+    DLOG(ERROR) << "Transport DIB too small for a " << size.ToString()
+                << " pixmap";
+    return 0;
+  }
+
+  XShmSegmentInfo shminfo;
+  memset(&shminfo, 0, sizeof(shminfo));
+  shminfo.shmseg = MapToX(display);
+  shminfo.shmid = key_.shmkey;
+  shminfo.shmaddr = static_cast<char*>(address_);
+  return XShmCreatePixmap(display, DefaultRootWindow(display),
+                          shminfo.shmaddr, &shminfo,
+                          size.width(), size.height(), depth);
+}
@@ -60,9 +60,12 @@
         'base/animation/animation.h',
         'base/animation/animation_container.cc',
         'base/animation/animation_container.h',
+        'base/animation/animation_container_clock.h',
         'base/animation/animation_container_element.h',
         'base/animation/animation_container_observer.h',
         'base/animation/animation_delegate.h',
+        'base/animation/animation_ticker.cc',
+        'base/animation/animation_ticker.h',
         'base/animation/linear_animation.cc',
         'base/animation/linear_animation.h',
         'base/animation/multi_animation.cc',
@@ -210,6 +213,8 @@
         'base/models/table_model.cc',
         'base/models/table_model.h',
         'base/models/table_model_observer.h',
+        'base/models/table_model_sorter.cc',
+        'base/models/table_model_sorter.h',
         'base/models/tree_model.cc',
         'base/models/tree_model.h',
         'base/models/tree_node_iterator.h',
@@ -247,6 +252,8 @@
         'base/text/bytes_formatting.h',
         'base/text/text_elider.cc',
         'base/text/text_elider.h',
+        'base/text/text_layout_cache.cc',
+        'base/text/text_layout_cache.h',
         'base/text/utf16_indexing.cc',
         'base/text/utf16_indexing.h',
         'base/theme_provider.cc',
@@ -332,6 +339,8 @@
         'gfx/font.cc',
         'gfx/font_list.h',
         'gfx/font_list.cc',
+        'gfx/font_fallback_warmer_linux.cc',
+        'gfx/font_fallback_warmer_linux.h',
         'gfx/font_render_params_linux.cc',
         'gfx/font_render_params_linux.h',
         'gfx/font_smoothing_win.cc',
@@ -342,6 +351,7 @@
         'gfx/image/image.h',
         'gfx/image/image_skia.cc',
         'gfx/image/image_skia.h',
+        'gfx/image/image_skia_source.h',
         'gfx/image/image_skia_util_mac.h',
         'gfx/image/image_skia_util_mac.mm',
         'gfx/image/image_util.cc',
@@ -378,6 +388,8 @@
         'gfx/rect_base_impl.h',
         'gfx/render_text.cc',
         'gfx/render_text.h',
+        'gfx/render_text_harfbuzz.cc',
+        'gfx/render_text_harfbuzz.h',
         'gfx/render_text_linux.cc',
         'gfx/render_text_linux.h',
         'gfx/render_text_win.cc',
@@ -396,6 +408,8 @@
         'gfx/scrollbar_size.h',
         'gfx/selection_model.cc',
         'gfx/selection_model.h',
+        'gfx/shadow_cache.cc',
+        'gfx/shadow_cache.h',
         'gfx/shadow_value.cc',
         'gfx/shadow_value.h',
         'gfx/size.cc',
@@ -669,11 +683,17 @@
           'sources!': [
             'gfx/render_text.cc',
             'gfx/render_text.h',
+            'gfx/render_text_harfbuzz.cc',
+            'gfx/render_text_harfbuzz.h',
             'gfx/render_text_linux.cc',
             'gfx/render_text_linux.h',
             'gfx/render_text_win.cc',
             'gfx/render_text_win.h',
           ],
+        }, {  # toolkit_views==1 or use_canvas_skia==1
+          'dependencies': [
+            '../third_party/harfbuzz-ng/harfbuzz.gyp:harfbuzz-ng',
+          ],
         }],
         ['OS=="android"', {
           'sources!': [
@@ -0,0 +1,128 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/views/accessibility/accessibility_event_queue.h"
+
+#include "base/bind.h"
+#include "base/message_loop.h"
+#include "ui/base/accessibility/accessible_view_state.h"
+#include "ui/views/view.h"
+
+namespace views {
+namespace internal {
+
+AccessibilityEventQueue::AccessibilityEventQueue(
+    const DeliverCallback& deliver_callback)
+    : deliver_callback_(deliver_callback),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
+}
+
+AccessibilityEventQueue::~AccessibilityEventQueue() {
+}
+
+void AccessibilityEventQueue::AddEvent(
+    View* view,
+    ui::AccessibilityTypes::Event event_type,
+    bool send_native_event) {
+  if (IsStateChange(event_type)) {
+    for (size_t i = 0; i < pending_.size(); ++i) {
+      PendingEvent& pending = pending_[i];
+      if (pending.view == view && pending.event_type == event_type) {
+        pending.send_native_event |= send_native_event;
+        return;
+      }
+    }
+  }
+
+  PendingEvent pending = { view, event_type, send_native_event };
+  pending_.push_back(pending);
+
+  if (!weak_factory_.HasWeakPtrs()) {
+    MessageLoop::current()->PostTask(
+        FROM_HERE,
+        base::Bind(&AccessibilityEventQueue::Flush,
+                   weak_factory_.GetWeakPtr()));
+  }
+}
+
+void AccessibilityEventQueue::Flush() {
+  weak_factory_.InvalidateWeakPtrs();
+
+  // Delivering may queue more events, or remove views.
+  while (!pending_.empty()) {
+    PendingEvent pending = pending_.front();
+    pending_.erase(pending_.begin());
+    if (IsStateChange(pending.event_type) &&
+        !UpdateDeliveredState(pending.view, pending.event_type)) {
+      continue;
+    }
+    deliver_callback_.Run(pending.view, pending.event_type,
+                          pending.send_native_event);
+  }
+}
+
+void AccessibilityEventQueue::ViewRemoved(View* view) {
+  for (size_t i = 0; i < pending_.size();) {
+    if (pending_[i].view == view)
+      pending_.erase(pending_.begin() + i);
+    else
+      ++i;
+  }
+  delivered_states_.erase(view);
+}
+
+void AccessibilityEventQueue::Clear() {
+  weak_factory_.InvalidateWeakPtrs();
+  pending_.clear();
+  delivered_states_.clear();
+}
+
+// static
+bool AccessibilityEventQueue::IsStateChange(
+    ui::AccessibilityTypes::Event event_type) {
+  return event_type == ui::AccessibilityTypes::EVENT_NAME_CHANGED ||
+      event_type == ui::AccessibilityTypes::EVENT_TEXT_CHANGED ||
+      event_type == ui::AccessibilityTypes::EVENT_SELECTION_CHANGED ||
+      event_type == ui::AccessibilityTypes::EVENT_VALUE_CHANGED;
+}
+
+bool AccessibilityEventQueue::UpdateDeliveredState(
+    View* view,
+    ui::AccessibilityTypes::Event event_type) {
+  ui::AccessibleViewState state;
+  view->GetAccessibleState(&state);
+
+  // Only the part the event announces is remembered, as the others may have
+  // changed with events still to be delivered.
+  DeliveredState& delivered = delivered_states_[view];
+  bool changed = false;
+  switch (event_type) {
+    case ui::AccessibilityTypes::EVENT_NAME_CHANGED:
+      changed = !delivered.has_name || delivered.name != state.name;
+      delivered.has_name = true;
+      delivered.name = state.name;
+      break;
+    case ui::AccessibilityTypes::EVENT_TEXT_CHANGED:
+    case ui::AccessibilityTypes::EVENT_VALUE_CHANGED:
+      changed = !delivered.has_value || delivered.value != state.value;
+      delivered.has_value = true;
+      delivered.value = state.value;
+      break;
+    case ui::AccessibilityTypes::EVENT_SELECTION_CHANGED:
+      changed = !delivered.has_selection ||
+          delivered.selection_start != state.selection_start ||
+          delivered.selection_end != state.selection_end;
+      delivered.has_selection = true;
+      delivered.selection_start = state.selection_start;
+      delivered.selection_end = state.selection_end;
+      break;
+    default:
+      NOTREACHED();
+      break;
+  }
+  return changed;
+}
+
+}  // namespace internal
+}  // namespace views
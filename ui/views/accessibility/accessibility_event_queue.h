@@ -0,0 +1,112 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_VIEWS_ACCESSIBILITY_ACCESSIBILITY_EVENT_QUEUE_H_
+#define UI_VIEWS_ACCESSIBILITY_ACCESSIBILITY_EVENT_QUEUE_H_
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/memory/weak_ptr.h"
+#include "base/string16.h"
+#include "ui/base/accessibility/accessibility_types.h"
+#include "ui/views/views_export.h"
+
+namespace views {
+
+class View;
+
+namespace internal {
+
+// AccessibilityEventQueue holds the accessibility events of the views of a
+// Widget until the task that sent them is done, and then delivers them in
+// one batch. Assistive technology answers most events by asking the view for
+// its state, so a textfield that is typed in or a progress bar that is
+// updated would otherwise cost a round trip for each change.
+//
+// Repeated name, text, selection and value changes of a view are sent once
+// per batch. When the batch is delivered they are compared with the state of
+// the view the last time they were delivered, and dropped if that part of the
+// state hasn't changed. Other events, such as focus and menu events, are
+// delivered once each in the order they were sent.
+class VIEWS_EXPORT AccessibilityEventQueue {
+ public:
+  // Delivers an event to the ViewsDelegate and, if the bool is true, to the
+  // platform.
+  typedef base::Callback<void(View*, ui::AccessibilityTypes::Event, bool)>
+      DeliverCallback;
+
+  explicit AccessibilityEventQueue(const DeliverCallback& deliver_callback);
+  ~AccessibilityEventQueue();
+
+  // Queues |event_type| for |view|, and schedules the batch to be delivered
+  // if it isn't already.
+  void AddEvent(View* view,
+                ui::AccessibilityTypes::Event event_type,
+                bool send_native_event);
+
+  // Delivers the queued events now.
+  void Flush();
+
+  // Forgets the events and the state of |view|, which is leaving the Widget.
+  void ViewRemoved(View* view);
+
+  // Forgets all the events and states.
+  void Clear();
+
+  bool HasPendingEvents() const { return !pending_.empty(); }
+
+ private:
+  struct PendingEvent {
+    View* view;
+    ui::AccessibilityTypes::Event event_type;
+    bool send_native_event;
+  };
+
+  // The parts of the accessible state of a view that state change events
+  // announced, and whether an event announced each of them yet.
+  struct DeliveredState {
+    DeliveredState()
+        : has_name(false),
+          has_value(false),
+          has_selection(false),
+          selection_start(-1),
+          selection_end(-1) {}
+
+    bool has_name;
+    bool has_value;
+    bool has_selection;
+    string16 name;
+    string16 value;
+    int selection_start;
+    int selection_end;
+  };
+
+  // Returns true if |event_type| announces a change of the state of a view,
+  // in which case repeating it only matters once per batch.
+  static bool IsStateChange(ui::AccessibilityTypes::Event event_type);
+
+  // Returns true if the part of the state of |view| that |event_type|
+  // announces differs from when it was last delivered, and remembers it.
+  bool UpdateDeliveredState(View* view,
+                            ui::AccessibilityTypes::Event event_type);
+
+  DeliverCallback deliver_callback_;
+
+  std::vector<PendingEvent> pending_;
+
+  std::map<View*, DeliveredState> delivered_states_;
+
+  base::WeakPtrFactory<AccessibilityEventQueue> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(AccessibilityEventQueue);
+};
+
+}  // namespace internal
+}  // namespace views
+
+#endif  // UI_VIEWS_ACCESSIBILITY_ACCESSIBILITY_EVENT_QUEUE_H_
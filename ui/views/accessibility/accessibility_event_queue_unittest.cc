@@ -0,0 +1,130 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/views/accessibility/accessibility_event_queue.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/message_loop.h"
+#include "base/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/base/accessibility/accessible_view_state.h"
+#include "ui/views/view.h"
+
+namespace views {
+namespace internal {
+
+namespace {
+
+typedef ui::AccessibilityTypes Types;
+
+// A view whose accessible value is set by the test.
+class ValueView : public View {
+ public:
+  ValueView() {}
+
+  void set_value(const std::string& value) { value_ = ASCIIToUTF16(value); }
+
+  // View:
+  virtual void GetAccessibleState(ui::AccessibleViewState* state) OVERRIDE {
+    state->value = value_;
+  }
+
+ private:
+  string16 value_;
+
+  DISALLOW_COPY_AND_ASSIGN(ValueView);
+};
+
+struct DeliveredEvent {
+  View* view;
+  Types::Event event_type;
+};
+
+void RecordEvent(std::vector<DeliveredEvent>* events,
+                 View* view,
+                 Types::Event event_type,
+                 bool send_native_event) {
+  DeliveredEvent event = { view, event_type };
+  events->push_back(event);
+}
+
+class AccessibilityEventQueueTest : public testing::Test {
+ public:
+  AccessibilityEventQueueTest()
+      : queue_(base::Bind(&RecordEvent, &events_)) {
+  }
+
+ protected:
+  MessageLoopForUI message_loop_;
+  std::vector<DeliveredEvent> events_;
+  AccessibilityEventQueue queue_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(AccessibilityEventQueueTest);
+};
+
+}  // namespace
+
+// Verifies repeated state changes are delivered once, after the task that
+// sent them.
+TEST_F(AccessibilityEventQueueTest, CoalescesStateChanges) {
+  ValueView view;
+  View other;
+  for (int i = 0; i < 5; ++i) {
+    view.set_value(std::string(i, 'x'));
+    queue_.AddEvent(&view, Types::EVENT_VALUE_CHANGED, true);
+  }
+  queue_.AddEvent(&other, Types::EVENT_FOCUS, true);
+  queue_.AddEvent(&view, Types::EVENT_FOCUS, true);
+  queue_.AddEvent(&other, Types::EVENT_FOCUS, true);
+  EXPECT_TRUE(events_.empty());
+
+  MessageLoop::current()->RunAllPending();
+  ASSERT_EQ(4u, events_.size());
+  EXPECT_EQ(&view, events_[0].view);
+  EXPECT_EQ(Types::EVENT_VALUE_CHANGED, events_[0].event_type);
+  EXPECT_EQ(&other, events_[1].view);
+  EXPECT_EQ(&view, events_[2].view);
+  EXPECT_EQ(Types::EVENT_FOCUS, events_[2].event_type);
+  EXPECT_EQ(&other, events_[3].view);
+  EXPECT_FALSE(queue_.HasPendingEvents());
+}
+
+// Verifies a state change is dropped if the state is the one last delivered.
+TEST_F(AccessibilityEventQueueTest, DropsUnchangedState) {
+  ValueView view;
+  view.set_value("50%");
+  queue_.AddEvent(&view, Types::EVENT_VALUE_CHANGED, true);
+  queue_.Flush();
+  EXPECT_EQ(1u, events_.size());
+
+  queue_.AddEvent(&view, Types::EVENT_VALUE_CHANGED, true);
+  queue_.Flush();
+  EXPECT_EQ(1u, events_.size());
+
+  view.set_value("51%");
+  queue_.AddEvent(&view, Types::EVENT_VALUE_CHANGED, true);
+  queue_.Flush();
+  EXPECT_EQ(2u, events_.size());
+
+  // The first name change is delivered whatever the name.
+  queue_.AddEvent(&view, Types::EVENT_NAME_CHANGED, true);
+  queue_.Flush();
+  EXPECT_EQ(3u, events_.size());
+}
+
+// Verifies the events of a removed view are not delivered.
+TEST_F(AccessibilityEventQueueTest, ViewRemoved) {
+  ValueView view;
+  queue_.AddEvent(&view, Types::EVENT_FOCUS, true);
+  queue_.AddEvent(&view, Types::EVENT_VALUE_CHANGED, true);
+  queue_.ViewRemoved(&view);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_TRUE(events_.empty());
+}
+
+}  // namespace internal
+}  // namespace views
@@ -10,6 +10,11 @@
 #include "ui/views/animation/bounds_animator_observer.h"
 #include "ui/views/view.h"
 
+#if defined(USE_UI_LAYER)
+#include "ui/compositor/compositor.h"
+#include "ui/compositor/layer.h"
+#endif
+
 // Duration in milliseconds for animations.
 static const int kDefaultAnimationDuration = 200;
 
@@ -50,6 +55,11 @@ void BoundsAnimator::AnimateViewTo(View* view, const gfx::Rect& target) {
     // the animationcontainer.
     existing_data = data_[view];
 
+    // A view animated by its layer transform still has its start bounds. Move
+    // it to where it appears so the new animation starts from there.
+    if (existing_data.uses_layer_transform)
+      ApplyCurrentBounds(view, existing_data, existing_data.animation);
+
     RemoveFromMaps(view);
   }
 
@@ -62,6 +72,12 @@ void BoundsAnimator::AnimateViewTo(View* view, const gfx::Rect& target) {
   data.start_bounds = view->bounds();
   data.target_bounds = target;
   data.animation = CreateAnimation();
+#if defined(USE_UI_LAYER)
+  if (view->layer() && !data.start_bounds.IsEmpty()) {
+    data.uses_layer_transform = true;
+    data.start_transform = view->GetTransform();
+  }
+#endif
 
   animation_to_view_[data.animation] = view;
 
@@ -196,6 +212,44 @@ Animation* BoundsAnimator::ResetAnimationForView(View* view) {
   return old_animation;
 }
 
+void BoundsAnimator::ApplyCurrentBounds(View* view,
+                                        const Data& data,
+                                        const Animation* animation) {
+#if defined(USE_UI_LAYER)
+  if (view->layer())
+    view->SetTransform(data.start_transform);
+#endif
+  view->SetBoundsRect(
+      animation->CurrentValueBetween(data.start_bounds, data.target_bounds));
+}
+
+bool BoundsAnimator::SetLayerTransformForBounds(View* view,
+                                                const Data& data,
+                                                const gfx::Rect& bounds) {
+#if defined(USE_UI_LAYER)
+  if (!data.uses_layer_transform || !view->layer())
+    return false;
+
+  // The layer keeps the start bounds. Scale it to the size of |bounds| and
+  // move it to their origin, taking into account that the layer is placed at
+  // the mirrored bounds.
+  const gfx::Rect& start = data.start_bounds;
+  ui::Transform transform(data.start_transform);
+  if (bounds.size() != start.size()) {
+    transform.ConcatScale(
+        static_cast<float>(bounds.width()) / start.width(),
+        static_cast<float>(bounds.height()) / start.height());
+  }
+  int dx = parent_->GetMirroredXWithWidthInView(bounds.x(), bounds.width()) -
+      parent_->GetMirroredXWithWidthInView(start.x(), start.width());
+  transform.ConcatTranslate(dx, bounds.y() - start.y());
+  view->layer()->SetTransform(transform);
+  return true;
+#else
+  return false;
+#endif
+}
+
 void BoundsAnimator::AnimationEndedOrCanceled(const Animation* animation,
                                               AnimationEndType type) {
   DCHECK(animation_to_view_.find(animation) != animation_to_view_.end());
@@ -208,6 +262,9 @@ void BoundsAnimator::AnimationEndedOrCanceled(const Animation* animation,
 
   RemoveFromMaps(view);
 
+  if (data.uses_layer_transform)
+    ApplyCurrentBounds(view, data, animation);
+
   if (data.delegate) {
     if (type == ANIMATION_ENDED) {
       data.delegate->AnimationEnded(animation);
@@ -228,7 +285,9 @@ void BoundsAnimator::AnimationProgressed(const Animation* animation) {
   const Data& data = data_[view];
   gfx::Rect new_bounds =
       animation->CurrentValueBetween(data.start_bounds, data.target_bounds);
-  if (new_bounds != view->bounds()) {
+  if (SetLayerTransformForBounds(view, data, new_bounds)) {
+    // The compositor draws the layer at its new place; nothing to repaint.
+  } else if (new_bounds != view->bounds()) {
     gfx::Rect total_bounds = new_bounds.Union(view->bounds());
 
     // Build up the region to repaint in repaint_bounds_. We'll do the repaint
@@ -253,6 +312,13 @@ void BoundsAnimator::AnimationCanceled(const Animation* animation) {
   AnimationEndedOrCanceled(animation, ANIMATION_CANCELED);
 }
 
+void BoundsAnimator::AnimationContainerWillProgress(
+    AnimationContainer* container) {
+#if defined(USE_UI_LAYER)
+  draw_batch_.reset(new ui::ScopedDrawBatch);
+#endif
+}
+
 void BoundsAnimator::AnimationContainerProgressed(
     AnimationContainer* container) {
   if (!repaint_bounds_.IsEmpty()) {
@@ -263,6 +329,11 @@ void BoundsAnimator::AnimationContainerProgressed(
     repaint_bounds_.SetRect(0, 0, 0, 0);
   }
 
+#if defined(USE_UI_LAYER)
+  // Observers may delete us, so end the batch first.
+  draw_batch_.reset();
+#endif
+
   FOR_EACH_OBSERVER(BoundsAnimatorObserver,
                     observers_,
                     OnBoundsAnimatorProgressed(this));
@@ -10,14 +10,17 @@
 
 #include "base/compiler_specific.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/observer_list.h"
 #include "ui/base/animation/animation_container_observer.h"
 #include "ui/base/animation/animation_delegate.h"
 #include "ui/base/animation/tween.h"
 #include "ui/gfx/rect.h"
+#include "ui/gfx/transform.h"
 #include "ui/views/views_export.h"
 
 namespace ui {
+class ScopedDrawBatch;
 class SlideAnimation;
 }
 
@@ -36,6 +39,13 @@ class View;
 // You can attach an AnimationDelegate to the individual animation for a view
 // by way of SetAnimationDelegate. Additionally you can attach an observer to
 // the BoundsAnimator that is notified when all animations are complete.
+//
+// Views that paint to a layer are not moved at each step of the animation.
+// Instead the transform of their layer is set so the layer appears at the
+// animated bounds, which the compositor draws without painting or laying out
+// the view. The view is given its real bounds when its animation ends or is
+// canceled. All the animations step on the same timer, and the layers they
+// change in a step are drawn once.
 class VIEWS_EXPORT BoundsAnimator : public ui::AnimationDelegate,
                                     public ui::AnimationContainerObserver {
  public:
@@ -107,12 +117,20 @@ class VIEWS_EXPORT BoundsAnimator : public ui::AnimationDelegate,
   struct Data {
     Data()
         : delete_delegate_when_done(false),
+          uses_layer_transform(false),
           animation(NULL),
           delegate(NULL) {}
 
     // If true the delegate is deleted when done.
     bool delete_delegate_when_done;
 
+    // If true the view is animated by the transform of its layer, and keeps
+    // |start_bounds| until the animation ends.
+    bool uses_layer_transform;
+
+    // The transform the layer had before the animation, restored at the end.
+    ui::Transform start_transform;
+
     // The initial bounds.
     gfx::Rect start_bounds;
 
@@ -149,6 +167,18 @@ class VIEWS_EXPORT BoundsAnimator : public ui::AnimationDelegate,
   // of the returned animation passes to the caller.
   ui::Animation* ResetAnimationForView(View* view);
 
+  // Moves |view| to where |animation| currently puts it, removing the layer
+  // transform if |data| uses one.
+  void ApplyCurrentBounds(View* view,
+                          const Data& data,
+                          const ui::Animation* animation);
+
+  // Sets the transform of the layer of |view| so it appears at |bounds|.
+  // Returns false, doing nothing, if |view| is not animated by its layer.
+  bool SetLayerTransformForBounds(View* view,
+                                  const Data& data,
+                                  const gfx::Rect& bounds);
+
   // Invoked from AnimationEnded and AnimationCanceled.
   void AnimationEndedOrCanceled(const ui::Animation* animation,
                                 AnimationEndType type);
@@ -159,6 +189,8 @@ class VIEWS_EXPORT BoundsAnimator : public ui::AnimationDelegate,
   virtual void AnimationCanceled(const ui::Animation* animation) OVERRIDE;
 
   // ui::AnimationContainerObserver overrides.
+  virtual void AnimationContainerWillProgress(
+      ui::AnimationContainer* container) OVERRIDE;
   virtual void AnimationContainerProgressed(
       ui::AnimationContainer* container) OVERRIDE;
   virtual void AnimationContainerEmpty(
@@ -188,6 +220,12 @@ class VIEWS_EXPORT BoundsAnimator : public ui::AnimationDelegate,
 
   ui::Tween::Type tween_type_;
 
+#if defined(USE_UI_LAYER)
+  // Postpones the draws of the layers changed during a step of the animations
+  // until all of them have stepped.
+  scoped_ptr<ui::ScopedDrawBatch> draw_batch_;
+#endif
+
   DISALLOW_COPY_AND_ASSIGN(BoundsAnimator);
 };
 
@@ -4,6 +4,9 @@
 
 #include "ui/views/button_drag_utils.h"
 
+#include "base/lazy_instance.h"
+#include "base/memory/mru_cache.h"
+#include "base/stringprintf.h"
 #include "base/utf_string_conversions.h"
 #include "googleurl/src/gurl.h"
 #include "grit/ui_resources_standard.h"
@@ -12,21 +15,51 @@
 #include "ui/base/resource/resource_bundle.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/image/image.h"
+#include "ui/gfx/size.h"
 #include "ui/views/controls/button/text_button.h"
 
 namespace button_drag_utils {
 
+namespace {
+
 // Maximum width of the link drag image in pixels.
-static const int kLinkDragImageMaxWidth = 200;
+const int kLinkDragImageMaxWidth = 200;
 
-void SetURLAndDragImage(const GURL& url,
-                        const string16& title,
-                        const gfx::ImageSkia& icon,
-                        ui::OSExchangeData* data) {
-  DCHECK(url.is_valid() && data);
+// The number of link drag images kept around. Dragging a link again, which
+// is common for bookmarks, then doesn't need a button to be laid out and
+// painted before the drag can start.
+const size_t kDragImageCacheSize = 16;
 
-  data->SetURL(url, title);
+struct DragImage {
+  gfx::ImageSkia image;
+  gfx::Size size;
+};
+
+class DragImageCache : public base::MRUCache<std::string, DragImage> {
+ public:
+  DragImageCache()
+      : base::MRUCache<std::string, DragImage>(kDragImageCacheSize) {
+  }
+};
+
+base::LazyInstance<DragImageCache>::Leaky g_drag_image_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Returns the key of the drag image of a link. Icons are told apart by the
+// generation ID of their pixels, which a favicon keeps while it is unchanged.
+std::string GetDragImageKey(const GURL& url,
+                            const string16& title,
+                            const gfx::ImageSkia& icon) {
+  uint32 icon_id = icon.isNull() ? 0 : icon.bitmap()->getGenerationID();
+  return base::StringPrintf("%u\n%s\n", icon_id, url.spec().c_str()) +
+      UTF16ToUTF8(title);
+}
 
+// Paints the drag image of a link.
+void CreateDragImage(const GURL& url,
+                     const string16& title,
+                     const gfx::ImageSkia& icon,
+                     DragImage* drag_image) {
   // Create a button to render the drag image for us.
   views::TextButton button(NULL,
                            title.empty() ? UTF8ToUTF16(url.spec()) : title);
@@ -43,8 +76,32 @@ void SetURLAndDragImage(const GURL& url,
   // Render the image.
   gfx::Canvas canvas(prefsize, false);
   button.PaintButton(&canvas, views::TextButton::PB_FOR_DRAG);
-  drag_utils::SetDragImageOnDataObject(canvas, prefsize,
-      gfx::Point(prefsize.width() / 2, prefsize.height() / 2), data);
+  drag_image->image = canvas.ExtractBitmap();
+  drag_image->size = prefsize;
+}
+
+}  // namespace
+
+void SetURLAndDragImage(const GURL& url,
+                        const string16& title,
+                        const gfx::ImageSkia& icon,
+                        ui::OSExchangeData* data) {
+  DCHECK(url.is_valid() && data);
+
+  data->SetURL(url, title);
+
+  DragImageCache* cache = g_drag_image_cache.Pointer();
+  std::string key = GetDragImageKey(url, title, icon);
+  DragImageCache::iterator it = cache->Get(key);
+  if (it == cache->end()) {
+    DragImage drag_image;
+    CreateDragImage(url, title, icon, &drag_image);
+    it = cache->Put(key, drag_image);
+  }
+  const DragImage& drag_image = it->second;
+  drag_utils::SetDragImageOnDataObject(drag_image.image, drag_image.size,
+      gfx::Point(drag_image.size.width() / 2, drag_image.size.height() / 2),
+      data);
 }
 
 }  // namespace button_drag_utils
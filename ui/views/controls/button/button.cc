@@ -16,6 +16,8 @@ Button::~Button() {
 }
 
 void Button::SetTooltipText(const string16& tooltip_text) {
+  if (tooltip_text == tooltip_text_)
+    return;
   tooltip_text_ = tooltip_text;
   TooltipTextChanged();
 }
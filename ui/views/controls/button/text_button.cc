@@ -678,18 +678,21 @@ TextButton::~TextButton() {
 
 void TextButton::SetIcon(const gfx::ImageSkia& icon) {
   icon_ = icon;
+  PreferredSizeChanged();
   SchedulePaint();
 }
 
 void TextButton::SetHoverIcon(const gfx::ImageSkia& icon) {
   icon_hover_ = icon;
   has_hover_icon_ = true;
+  PreferredSizeChanged();
   SchedulePaint();
 }
 
 void TextButton::SetPushedIcon(const gfx::ImageSkia& icon) {
   icon_pushed_ = icon;
   has_pushed_icon_ = true;
+  PreferredSizeChanged();
   SchedulePaint();
 }
 
@@ -750,6 +753,7 @@ void TextButton::PaintButton(gfx::Canvas* canvas, PaintButtonMode mode) {
 
 void TextButton::set_ignore_minimum_size(bool ignore_minimum_size) {
   ignore_minimum_size_ = ignore_minimum_size;
+  PreferredSizeChanged();
 }
 
 std::string TextButton::GetClassName() const {
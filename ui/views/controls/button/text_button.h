@@ -171,7 +171,10 @@ class VIEWS_EXPORT TextButtonBase : public CustomButton,
   // current size.
   void ClearMaxTextSize();
 
-  void set_max_width(int max_width) { max_width_ = max_width; }
+  void set_max_width(int max_width) {
+    max_width_ = max_width;
+    PreferredSizeChanged();
+  }
   void SetFont(const gfx::Font& font);
   // Return the font used by this button.
   gfx::Font font() const { return font_; }
@@ -317,6 +320,7 @@ class VIEWS_EXPORT TextButton : public TextButtonBase {
 
   void set_icon_text_spacing(int icon_text_spacing) {
     icon_text_spacing_ = icon_text_spacing;
+    PreferredSizeChanged();
   }
 
   // Sets the icon.
@@ -4,16 +4,36 @@
 
 #include "ui/views/controls/combobox/combobox.h"
 
+#include <algorithm>
+
+#include "base/i18n/rtl.h"
 #include "base/logging.h"
 #include "base/utf_string_conversions.h"
 #include "ui/base/accessibility/accessible_view_state.h"
 #include "ui/base/keycodes/keyboard_codes.h"
 #include "ui/base/models/combobox_model.h"
 #include "ui/base/resource/resource_bundle.h"
+#include "ui/gfx/font.h"
 #include "ui/views/controls/combobox/combobox_listener.h"
 #include "ui/views/controls/native/native_view_host.h"
 #include "ui/views/widget/widget.h"
 
+namespace {
+
+// Models with more items than this, that don't name their widest item, are
+// measured by a sample of this many items.
+const int kMaxMeasuredItems = 100;
+
+int GetItemWidth(ui::ComboboxModel* model, int index) {
+  string16 text = model->GetItemAt(index);
+  // The items are shown with the Unicode formatting characters that
+  // right-to-left UIs need.
+  base::i18n::AdjustStringForLocaleDirection(&text);
+  return views::Combobox::GetFont().GetStringWidth(text);
+}
+
+}  // namespace
+
 namespace views {
 
 // static
@@ -40,6 +60,22 @@ const gfx::Font& Combobox::GetFont() {
   return rb.GetFont(ui::ResourceBundle::BaseFont);
 }
 
+// static
+int Combobox::GetMaxItemWidth(ui::ComboboxModel* model) {
+  int num_items = model->GetItemCount();
+  int widest_index = model->GetWidestItemIndex();
+  if (widest_index >= 0 && widest_index < num_items)
+    return GetItemWidth(model, widest_index);
+
+  // Items wider than the sample are elided when selected.
+  int step = std::max(1, (num_items + kMaxMeasuredItems - 1) /
+                         kMaxMeasuredItems);
+  int max_width = 0;
+  for (int i = 0; i < num_items; i += step)
+    max_width = std::max(max_width, GetItemWidth(model, i));
+  return max_width;
+}
+
 void Combobox::ModelChanged() {
   selected_index_ = std::min(0, model_->GetItemCount());
   if (native_wrapper_)
@@ -36,6 +36,11 @@ class VIEWS_EXPORT Combobox : public View {
 
   static const gfx::Font& GetFont();
 
+  // Returns the width of the widest item of |model| in GetFont(). Only the
+  // item the model names as its widest is measured, or, if it names none and
+  // has many items, a sample of them.
+  static int GetMaxItemWidth(ui::ComboboxModel* model);
+
   // Sets the listener which will be called when a selection has been made.
   void set_listener(ComboboxListener* listener) {
     listener_ = listener;
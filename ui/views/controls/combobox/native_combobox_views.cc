@@ -155,27 +155,11 @@ void NativeComboboxViews::OnBlur() {
 // NativeComboboxViews, NativeComboboxWrapper overrides:
 
 void NativeComboboxViews::UpdateFromModel() {
-  int max_width = 0;
-  const gfx::Font& font = Combobox::GetFont();
-
-  MenuItemView* menu = new MenuItemView(this);
-  // MenuRunner owns |menu|.
-  dropdown_list_menu_runner_.reset(new MenuRunner(menu));
-
-  int num_items = combobox_->model()->GetItemCount();
-  for (int i = 0; i < num_items; ++i) {
-    string16 text = combobox_->model()->GetItemAt(i);
-
-    // Inserting the Unicode formatting characters if necessary so that the
-    // text is displayed correctly in right-to-left UIs.
-    base::i18n::AdjustStringForLocaleDirection(&text);
-
-    menu->AppendMenuItem(i + kFirstMenuItemId, text, MenuItemView::NORMAL);
-    max_width = std::max(max_width, font.GetStringWidth(text));
-  }
-
-  content_width_ = max_width;
-  content_height_ = font.GetFontSize();
+  // The menu of a model with many items is slow to build, so it is only built
+  // when the dropdown is shown.
+  dropdown_list_menu_runner_.reset();
+  content_width_ = Combobox::GetMaxItemWidth(combobox_->model());
+  content_height_ = Combobox::GetFont().GetFontSize();
 }
 
 void NativeComboboxViews::UpdateSelectedIndex() {
@@ -306,10 +290,26 @@ void NativeComboboxViews::PaintText(gfx::Canvas* canvas) {
   canvas->Restore();
 }
 
-void NativeComboboxViews::ShowDropDownMenu() {
+void NativeComboboxViews::CreateDropDownMenu() {
+  MenuItemView* menu = new MenuItemView(this);
+  // MenuRunner owns |menu|.
+  dropdown_list_menu_runner_.reset(new MenuRunner(menu));
 
+  int num_items = combobox_->model()->GetItemCount();
+  for (int i = 0; i < num_items; ++i) {
+    string16 text = combobox_->model()->GetItemAt(i);
+
+    // Inserting the Unicode formatting characters if necessary so that the
+    // text is displayed correctly in right-to-left UIs.
+    base::i18n::AdjustStringForLocaleDirection(&text);
+
+    menu->AppendMenuItem(i + kFirstMenuItemId, text, MenuItemView::NORMAL);
+  }
+}
+
+void NativeComboboxViews::ShowDropDownMenu() {
   if (!dropdown_list_menu_runner_.get())
-    UpdateFromModel();
+    CreateDropDownMenu();
 
   // Extend the menu to the width of the combobox.
   MenuItemView* menu = dropdown_list_menu_runner_->GetMenu();
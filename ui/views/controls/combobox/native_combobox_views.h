@@ -69,6 +69,9 @@ class NativeComboboxViews : public views::View,
   // Draw the selected value of the drop down list
   void PaintText(gfx::Canvas* canvas);
 
+  // Builds the drop down list from the model.
+  void CreateDropDownMenu();
+
   // Show the drop down list
   void ShowDropDownMenu();
 
@@ -5,6 +5,7 @@
 #include "base/utf_string_conversions.h"
 #include "ui/base/keycodes/keyboard_codes.h"
 #include "ui/base/models/combobox_model.h"
+#include "ui/gfx/font.h"
 #include "ui/views/controls/combobox/combobox.h"
 #include "ui/views/controls/combobox/native_combobox_views.h"
 #include "ui/views/ime/mock_input_method.h"
@@ -68,6 +69,36 @@ class TestComboboxModel : public ui::ComboboxModel {
   DISALLOW_COPY_AND_ASSIGN(TestComboboxModel);
 };
 
+// A model with many items of growing width, which counts the items asked for.
+class LargeComboboxModel : public ui::ComboboxModel {
+ public:
+  explicit LargeComboboxModel(int widest_item_index)
+      : widest_item_index_(widest_item_index),
+        items_asked_(0) {
+  }
+  virtual ~LargeComboboxModel() {}
+
+  int items_asked() const { return items_asked_; }
+
+  // Overridden from ui::ComboboxModel:
+  virtual int GetItemCount() const OVERRIDE {
+    return 10000;
+  }
+  virtual string16 GetItemAt(int index) OVERRIDE {
+    ++items_asked_;
+    return ASCIIToUTF16(std::string(index / 100 + 1, 'x'));
+  }
+  virtual int GetWidestItemIndex() const OVERRIDE {
+    return widest_item_index_;
+  }
+
+ private:
+  int widest_item_index_;
+  int items_asked_;
+
+  DISALLOW_COPY_AND_ASSIGN(LargeComboboxModel);
+};
+
 }  // namespace
 
 namespace views {
@@ -192,4 +223,20 @@ TEST_F(NativeComboboxViewsTest, DisabilityTest) {
   ASSERT_FALSE(combobox_view_->enabled());
 }
 
+// Checks that only a sample of the items of a large model are measured, or
+// only the widest item when the model names it.
+TEST_F(NativeComboboxViewsTest, MaxItemWidthOfLargeModel) {
+  const gfx::Font& font = Combobox::GetFont();
+
+  LargeComboboxModel sampled_model(-1);
+  int width = Combobox::GetMaxItemWidth(&sampled_model);
+  EXPECT_LT(sampled_model.items_asked(), sampled_model.GetItemCount() / 10);
+  EXPECT_GE(width, font.GetStringWidth(ASCIIToUTF16(std::string(90, 'x'))));
+
+  LargeComboboxModel hinted_model(sampled_model.GetItemCount() - 1);
+  width = Combobox::GetMaxItemWidth(&hinted_model);
+  EXPECT_EQ(1, hinted_model.items_asked());
+  EXPECT_EQ(font.GetStringWidth(ASCIIToUTF16(std::string(100, 'x'))), width);
+}
+
 }  // namespace views
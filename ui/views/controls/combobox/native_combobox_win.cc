@@ -48,8 +48,6 @@ NativeComboboxWin::~NativeComboboxWin() {
 
 void NativeComboboxWin::UpdateFromModel() {
   SendMessage(native_view(), CB_RESETCONTENT, 0, 0);
-  const gfx::Font& font = Combobox::GetFont();
-  int max_width = 0;
   int num_items = combobox_->model()->GetItemCount();
   for (int i = 0; i < num_items; ++i) {
     string16 text = combobox_->model()->GetItemAt(i);
@@ -60,8 +58,8 @@ void NativeComboboxWin::UpdateFromModel() {
 
     SendMessage(native_view(), CB_ADDSTRING, 0,
                 reinterpret_cast<LPARAM>(UTF16ToWide(text).c_str()));
-    max_width = std::max(max_width, font.GetStringWidth(text));
   }
+  int max_width = Combobox::GetMaxItemWidth(combobox_->model());
   content_width_ = max_width;
 
   if (num_items > 0) {
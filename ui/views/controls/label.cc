@@ -18,6 +18,7 @@
 #include "ui/base/native_theme/native_theme.h"
 #include "ui/base/resource/resource_bundle.h"
 #include "ui/base/text/text_elider.h"
+#include "ui/base/text/text_layout_cache.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/color_utils.h"
 #include "ui/gfx/font.h"
@@ -54,6 +55,10 @@ void Label::SetFont(const gfx::Font& font) {
 }
 
 void Label::SetText(const string16& text) {
+  // Labels are often refreshed with the text they already show; skip the
+  // copy and the relayout.
+  if (text == text_ && url_.is_empty() && !is_email_)
+    return;
   text_ = text;
   url_ = GURL();
   text_size_valid_ = false;
@@ -229,7 +234,8 @@ int Label::GetHeightForWidth(int w) {
 
   w = std::max(0, w - GetInsets().width());
   int h = font_.GetHeight();
-  gfx::Canvas::SizeStringInt(text_, font_, &w, &h, ComputeDrawStringFlags());
+  ui::TextLayoutCache::GetInstance()->SizeStringInt(
+      text_, font_, &w, &h, ComputeDrawStringFlags());
   return h + GetInsets().height();
 }
 
@@ -316,7 +322,8 @@ gfx::Size Label::GetTextSize() const {
     int flags = ComputeDrawStringFlags();
     if (!is_multi_line_)
       flags |= gfx::Canvas::NO_ELLIPSIS;
-    gfx::Canvas::SizeStringInt(text_, font_, &w, &h, flags);
+    ui::TextLayoutCache::GetInstance()->SizeStringInt(
+        text_, font_, &w, &h, flags);
     text_size_.SetSize(w, h);
     text_size_valid_ = true;
   }
@@ -497,8 +504,8 @@ void Label::CalculateDrawStringParams(string16* paint_text,
   if (!url_.is_empty()) {
     // TODO(jungshik) : Figure out how to get 'intl.accept_languages'
     // preference and use it when calling ElideUrl.
-    *paint_text =
-        ui::ElideUrl(url_, font_, GetAvailableRect().width(), std::string());
+    *paint_text = ui::TextLayoutCache::GetInstance()->ElideUrl(
+        url_, font_, GetAvailableRect().width(), std::string());
 
     // An URLs is always treated as an LTR text and therefore we should
     // explicitly mark it as such if the locale is RTL so that URLs containing
@@ -512,10 +519,11 @@ void Label::CalculateDrawStringParams(string16* paint_text,
     *paint_text = base::i18n::GetDisplayStringInLTRDirectionality(
         *paint_text);
   } else if (is_email_) {
-    *paint_text = ui::ElideEmail(text_, font_, GetAvailableRect().width());
+    *paint_text = ui::TextLayoutCache::GetInstance()->ElideEmail(
+        text_, font_, GetAvailableRect().width());
   } else if (elide_in_middle_) {
-    *paint_text = ui::ElideText(text_, font_, GetAvailableRect().width(),
-                                ui::ELIDE_IN_MIDDLE);
+    *paint_text = ui::TextLayoutCache::GetInstance()->ElideText(
+        text_, font_, GetAvailableRect().width(), ui::ELIDE_IN_MIDDLE);
   } else {
     *paint_text = text_;
   }
@@ -11,6 +11,7 @@
 #include "ui/base/accessibility/accessible_view_state.h"
 #include "ui/base/l10n/l10n_util.h"
 #include "ui/base/models/menu_model.h"
+#include "ui/base/text/text_layout_cache.h"
 #include "ui/gfx/canvas.h"
 #include "ui/views/controls/button/menu_button.h"
 #include "ui/views/controls/menu/menu_config.h"
@@ -48,6 +49,15 @@ class EmptyMenuMenuItem : public MenuItemView {
   DISALLOW_COPY_AND_ASSIGN(EmptyMenuMenuItem);
 };
 
+// Returns the width of |text| in |font|. Menus measure the same labels each
+// time they are shown, so the sizes are looked up in the TextLayoutCache.
+int GetTextWidth(const string16& text, const gfx::Font& font) {
+  int width = 0, height = 0;
+  ui::TextLayoutCache::GetInstance()->SizeStringInt(
+      text, font, &width, &height, gfx::Canvas::NO_ELLIPSIS);
+  return width;
+}
+
 }  // namespace
 
 // Padding between child views.
@@ -280,39 +290,43 @@ MenuItemView* MenuItemView::AppendMenuItemWithIcon(int item_id,
 MenuItemView* MenuItemView::AppendMenuItemFromModel(ui::MenuModel* model,
                                                     int index,
                                                     int id) {
+  const int menu_index = submenu_ ? submenu_->child_count() : 0;
+  return AddMenuItemFromModelAt(menu_index, model, index, id);
+}
+
+MenuItemView* MenuItemView::AddMenuItemFromModelAt(int menu_index,
+                                                   ui::MenuModel* model,
+                                                   int index,
+                                                   int id) {
   gfx::ImageSkia icon;
   string16 label;
-  MenuItemView::Type type;
-  ui::MenuModel::ItemType menu_type = model->GetTypeAt(index);
-  switch (menu_type) {
+  MenuItemView::Type type = GetTypeForModelItem(model, index);
+  if (type == NORMAL || type == SUBMENU)
+    model->GetIconAt(index, &icon);
+  if (type != SEPARATOR)
+    label = model->GetLabelAt(index);
+
+  return AddMenuItemAt(menu_index, id, label, icon, type);
+}
+
+// static
+MenuItemView::Type MenuItemView::GetTypeForModelItem(ui::MenuModel* model,
+                                                     int index) {
+  switch (model->GetTypeAt(index)) {
     case ui::MenuModel::TYPE_COMMAND:
-      model->GetIconAt(index, &icon);
-      type = MenuItemView::NORMAL;
-      label = model->GetLabelAt(index);
-      break;
+      return MenuItemView::NORMAL;
     case ui::MenuModel::TYPE_CHECK:
-      type = MenuItemView::CHECKBOX;
-      label = model->GetLabelAt(index);
-      break;
+      return MenuItemView::CHECKBOX;
     case ui::MenuModel::TYPE_RADIO:
-      type = MenuItemView::RADIO;
-      label = model->GetLabelAt(index);
-      break;
+      return MenuItemView::RADIO;
     case ui::MenuModel::TYPE_SEPARATOR:
-      type = MenuItemView::SEPARATOR;
-      break;
+      return MenuItemView::SEPARATOR;
     case ui::MenuModel::TYPE_SUBMENU:
-      model->GetIconAt(index, &icon);
-      type = MenuItemView::SUBMENU;
-      label = model->GetLabelAt(index);
-      break;
+      return MenuItemView::SUBMENU;
     default:
       NOTREACHED();
-      type = MenuItemView::NORMAL;
-      break;
+      return MenuItemView::NORMAL;
   }
-
-  return AppendMenuItemImpl(id, label, icon, type);
 }
 
 MenuItemView* MenuItemView::AppendMenuItemImpl(int item_id,
@@ -338,6 +352,8 @@ SubmenuView* MenuItemView::GetSubmenu() const {
 }
 
 void MenuItemView::SetTitle(const string16& title) {
+  if (title == title_)
+    return;
   title_ = title;
   pref_size_.SetSize(0, 0);  // Triggers preferred size recalculation.
 }
@@ -490,7 +506,7 @@ void MenuItemView::Layout() {
 
 int MenuItemView::GetAcceleratorTextWidth() {
   string16 text = GetAcceleratorText();
-  return text.empty() ? 0 : GetFont().GetStringWidth(text);
+  return text.empty() ? 0 : GetTextWidth(text, GetFont());
 }
 
 void MenuItemView::SetMargins(int top_margin, int bottom_margin) {
@@ -704,6 +720,17 @@ void MenuItemView::DestroyAllMenuHosts() {
   }
 }
 
+void MenuItemView::HideAllMenuHosts() {
+  if (!HasSubmenu())
+    return;
+
+  submenu_->CloseKeepingHost();
+  for (int i = 0, item_count = submenu_->GetMenuItemCount(); i < item_count;
+       ++i) {
+    submenu_->GetMenuItemAt(i)->HideAllMenuHosts();
+  }
+}
+
 int MenuItemView::GetTopMargin() {
   if (top_margin_ >= 0)
     return top_margin_;
@@ -756,7 +783,7 @@ gfx::Size MenuItemView::CalculatePreferredSize() {
   int menu_item_height = std::max(font.GetHeight(), child_size.height()) +
                              GetBottomMargin() + GetTopMargin();
   return gfx::Size(
-      font.GetStringWidth(title_) + label_start_ +
+      GetTextWidth(title_, font) + label_start_ +
           item_right_margin_ + child_size.width(),
       std::max(menu_item_height, MenuConfig::instance().item_min_height));
 }
@@ -191,6 +191,16 @@ class VIEWS_EXPORT MenuItemView : public View {
                                         int index,
                                         int id);
 
+  // Same as AppendMenuItemFromModel(), but adds the item at |menu_index|.
+  MenuItemView* AddMenuItemFromModelAt(int menu_index,
+                                       ui::MenuModel* model,
+                                       int index,
+                                       int id);
+
+  // Returns the type of item AddMenuItemFromModelAt() creates for the entry
+  // at |index| of |model|.
+  static Type GetTypeForModelItem(ui::MenuModel* model, int index);
+
   // All the AppendXXX methods funnel into this.
   MenuItemView* AppendMenuItemImpl(int item_id,
                                    const string16& label,
@@ -379,6 +389,10 @@ class VIEWS_EXPORT MenuItemView : public View {
   // the windows used to display all descendants.
   void DestroyAllMenuHosts();
 
+  // Hides the window used to display this menu and the windows of all
+  // descendants, keeping them to show the menus again.
+  void HideAllMenuHosts();
+
   // Returns the accelerator text.
   string16 GetAcceleratorText();
 
@@ -4,6 +4,8 @@
 
 #include "ui/views/controls/menu/menu_model_adapter.h"
 
+#include <map>
+
 #include "base/logging.h"
 #include "ui/base/l10n/l10n_util.h"
 #include "ui/base/models/menu_model.h"
@@ -25,13 +27,6 @@ MenuModelAdapter::~MenuModelAdapter() {
 void MenuModelAdapter::BuildMenu(MenuItemView* menu) {
   DCHECK(menu);
 
-  // Clear the menu.
-  if (menu->HasSubmenu()) {
-    const int subitem_count = menu->GetSubmenu()->child_count();
-    for (int i = 0; i < subitem_count; ++i)
-      menu->RemoveMenuItemAt(0);
-  }
-
   // Leave entries in the map if the menu is being shown.  This
   // allows the map to find the menu model of submenus being closed
   // so ui::MenuModel::MenuClosed() can be called.
@@ -39,7 +34,8 @@ void MenuModelAdapter::BuildMenu(MenuItemView* menu) {
     menu_map_.clear();
   menu_map_[menu] = menu_model_;
 
-  // Repopulate the menu.
+  // Repopulate the menu. Items that are kept are deleted or reused by
+  // ChildrenChanged().
   BuildMenuImpl(menu, menu_model_);
   menu->ChildrenChanged();
 }
@@ -179,19 +175,63 @@ void MenuModelAdapter::WillHideMenu(MenuItemView* menu) {
 void MenuModelAdapter::BuildMenuImpl(MenuItemView* menu, ui::MenuModel* model) {
   DCHECK(menu);
   DCHECK(model);
+
+  // The items the menu has now, by command id. Each is taken out when it is
+  // reused.
+  std::map<int, MenuItemView*> existing_items;
+  SubmenuView* submenu = menu->GetSubmenu();
+  if (submenu) {
+    for (int i = 0; i < submenu->child_count(); ++i) {
+      View* child = submenu->child_at(i);
+      if (child->id() != MenuItemView::kMenuItemViewID)
+        continue;
+      MenuItemView* item = static_cast<MenuItemView*>(child);
+      existing_items.insert(std::make_pair(item->GetCommand(), item));
+    }
+  }
+
+  // The items before |menu_index| match the entries of the model already
+  // handled.
+  int menu_index = 0;
   const int item_count = model->GetItemCount();
-  for (int i = 0; i < item_count; ++i) {
+  for (int i = 0; i < item_count; ++i, ++menu_index) {
     const int index = i + model->GetFirstItemIndex(NULL);
+    const int command_id = model->GetCommandIdAt(index);
+    const MenuItemView::Type type =
+        MenuItemView::GetTypeForModelItem(model, index);
+
+    MenuItemView* item = NULL;
+    if (type == MenuItemView::SEPARATOR) {
+      // Separators have no identity; reuse the one in place, if any.
+      View* child = submenu && menu_index < submenu->child_count() ?
+          submenu->child_at(menu_index) : NULL;
+      if (child && child->id() != MenuItemView::kMenuItemViewID &&
+          child->id() != MenuItemView::kEmptyMenuItemViewID) {
+        continue;
+      }
+      menu->AddMenuItemFromModelAt(menu_index, model, index, command_id);
+      submenu = menu->GetSubmenu();
+      continue;
+    }
 
-    MenuItemView* item = menu->AppendMenuItemFromModel(
-        model, index, model->GetCommandIdAt(index));
-
-    if (item)
-      item->SetVisible(model->IsVisibleAt(index));
+    std::map<int, MenuItemView*>::iterator existing =
+        existing_items.find(command_id);
+    if (existing != existing_items.end() &&
+        existing->second->GetType() == type) {
+      item = existing->second;
+      existing_items.erase(existing);
+      if (submenu->GetIndexOf(item) != menu_index)
+        submenu->ReorderChildView(item, menu_index);
+      UpdateMenuItem(item, model, index);
+    } else {
+      item = menu->AddMenuItemFromModelAt(menu_index, model, index,
+                                          command_id);
+      submenu = menu->GetSubmenu();
+    }
+    DCHECK(item);
+    item->SetVisible(model->IsVisibleAt(index));
 
-    if (model->GetTypeAt(index) == ui::MenuModel::TYPE_SUBMENU) {
-      DCHECK(item);
-      DCHECK_EQ(MenuItemView::SUBMENU, item->GetType());
+    if (type == MenuItemView::SUBMENU) {
       ui::MenuModel* submodel = model->GetSubmenuModelAt(index);
       DCHECK(submodel);
       BuildMenuImpl(item, submodel);
@@ -200,7 +240,24 @@ void MenuModelAdapter::BuildMenuImpl(MenuItemView* menu, ui::MenuModel* model) {
     }
   }
 
+  // Whatever follows matches nothing in the model any more.
+  while (submenu && submenu->child_count() > menu_index)
+    menu->RemoveMenuItemAt(menu_index);
+
   menu->set_has_icons(model->HasIcons());
 }
 
+void MenuModelAdapter::UpdateMenuItem(MenuItemView* item,
+                                      ui::MenuModel* model,
+                                      int index) {
+  // SetTitle() keeps the measured size if the label hasn't changed.
+  item->SetTitle(model->GetLabelAt(index));
+  if (item->GetType() == MenuItemView::NORMAL ||
+      item->GetType() == MenuItemView::SUBMENU) {
+    gfx::ImageSkia icon;
+    model->GetIconAt(index, &icon);
+    item->SetIcon(icon);
+  }
+}
+
 }  // namespace views
@@ -27,7 +27,9 @@ class VIEWS_EXPORT MenuModelAdapter : public MenuDelegate {
   virtual ~MenuModelAdapter();
 
   // Populate a MenuItemView menu with the ui::MenuModel items
-  // (including submenus).
+  // (including submenus). If |menu| already has items, only the differences
+  // with the model are applied: items whose command id and type still match
+  // an entry of the model are kept, with their measured sizes, and updated.
   virtual void BuildMenu(MenuItemView* menu);
 
   // Convenience for creating and populating a menu. The caller owns the
@@ -56,11 +58,14 @@ class VIEWS_EXPORT MenuModelAdapter : public MenuDelegate {
   virtual void WillHideMenu(MenuItemView* menu) OVERRIDE;
 
  private:
-  // Implementation of BuildMenu().  index_offset is both input and output;
-  // on input it contains the offset from index to command id for the model,
-  // and on output it contains the offset for the next model.
+  // Implementation of BuildMenu(). Makes the items of |menu| match |model|,
+  // keeping the existing items that can be updated.
   void BuildMenuImpl(MenuItemView* menu, ui::MenuModel* model);
 
+  // Updates |item| for the entry at |index| of |model|. |item| already has
+  // the command id and the type of the entry.
+  void UpdateMenuItem(MenuItemView* item, ui::MenuModel* model, int index);
+
   // Container of ui::MenuModel pointers as encountered by preorder
   // traversal.  The first element is always the top-level model
   // passed to the constructor.
@@ -140,6 +140,15 @@ class MenuModelBase : public ui::MenuModel {
     return items_[index];
   }
 
+  // Changes the label of the item at |index| and removes the last item, to
+  // check how menus follow changes of the model.
+  void SetLabel(int index, const std::string& label) {
+    items_[index].label = ASCIIToUTF16(label);
+  }
+  void RemoveLastItem() {
+    items_.pop_back();
+  }
+
   // Access index argument to ActivatedAt().
   int last_activation() const { return last_activation_; }
   void set_last_activation(int last_activation) {
@@ -305,4 +314,31 @@ TEST_F(MenuModelAdapterTest, BasicTest) {
   static_cast<views::MenuDelegate*>(&delegate)->SelectionChanged(menu);
 }
 
+// Verifies that rebuilding a menu keeps the items that are still in the model
+// and only applies the changes.
+TEST_F(MenuModelAdapterTest, RebuildKeepsItems) {
+  RootModel model;
+  views::MenuModelAdapter delegate(&model);
+  MenuItemView* menu = new views::MenuItemView(&delegate);
+  scoped_ptr<MenuRunner> menu_runner(new MenuRunner(menu));
+  delegate.BuildMenu(menu);
+
+  views::SubmenuView* item_container = menu->GetSubmenu();
+  ASSERT_EQ(5, item_container->child_count());
+  std::vector<View*> items;
+  for (int i = 0; i < item_container->child_count(); ++i)
+    items.push_back(item_container->child_at(i));
+
+  model.SetLabel(0, "new command 0");
+  model.RemoveLastItem();
+  delegate.BuildMenu(menu);
+
+  ASSERT_EQ(4, item_container->child_count());
+  for (int i = 0; i < item_container->child_count(); ++i)
+    EXPECT_EQ(items[i], item_container->child_at(i));
+  EXPECT_EQ(ASCIIToUTF16("new command 0"),
+            static_cast<MenuItemView*>(items[0])->title());
+  EXPECT_TRUE(menu->GetMenuItemByID(kRootIdBase + 4) == NULL);
+}
+
 }  // namespace views
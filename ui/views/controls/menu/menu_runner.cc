@@ -79,6 +79,9 @@ class MenuRunnerImpl : public internal::MenuControllerDelegate {
   // Are we running for a drop?
   bool for_drop_;
 
+  // Are the windows of the menu kept when it closes?
+  bool keep_menu_hosts_;
+
   // The controller.
   MenuController* controller_;
 
@@ -93,6 +96,7 @@ MenuRunnerImpl::MenuRunnerImpl(MenuItemView* menu)
       running_(false),
       delete_after_run_(false),
       for_drop_(false),
+      keep_menu_hosts_(false),
       controller_(NULL),
       owns_controller_(false) {
 }
@@ -159,6 +163,7 @@ MenuRunner::RunResult MenuRunnerImpl::RunMenuAt(
   }
   running_ = true;
   for_drop_ = (types & MenuRunner::FOR_DROP) != 0;
+  keep_menu_hosts_ = (types & MenuRunner::KEEP_MENU_HOSTS) != 0;
   bool has_mnemonics = (types & MenuRunner::HAS_MNEMONICS) != 0 && !for_drop_;
   menu_->PrepareForRun(has_mnemonics,
                        !for_drop_ && ShouldShowMnemonics(button));
@@ -222,8 +227,11 @@ MenuRunner::RunResult MenuRunnerImpl::MenuDone(MenuItemView* result,
   }
   controller_ = NULL;
   // Make sure all the windows we created to show the menus have been
-  // destroyed.
-  menu_->DestroyAllMenuHosts();
+  // destroyed, or at least hidden if they're kept for the next run.
+  if (keep_menu_hosts_ && !delete_after_run_)
+    menu_->HideAllMenuHosts();
+  else
+    menu_->DestroyAllMenuHosts();
   if (delete_after_run_) {
     delete this;
     return MenuRunner::MENU_DELETED;
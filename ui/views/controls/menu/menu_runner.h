@@ -53,6 +53,12 @@ class VIEWS_EXPORT MenuRunner {
     // caller, instead the delegate is notified when the menu closes via the
     // DropMenuClosed method.
     FOR_DROP      = 1 << 2,
+
+    // Keeps the windows of the menu and its submenus, hidden, when the menu
+    // closes. Running the menu again shows them without creating the windows
+    // and laying out the items again. Use this for large menus that are shown
+    // often, and keep the MenuRunner around between runs.
+    KEEP_MENU_HOSTS = 1 << 3,
   };
 
   enum RunResult {
@@ -34,6 +34,8 @@ const char SubmenuView::kViewClassName[] = "views/SubmenuView";
 SubmenuView::SubmenuView(MenuItemView* parent)
     : parent_menu_item_(parent),
       host_(NULL),
+      host_parent_(NULL),
+      menu_start_notified_(false),
       drop_item_(NULL),
       drop_position_(MenuDelegate::DROP_NONE),
       scroll_view_container_(NULL),
@@ -277,9 +279,21 @@ bool SubmenuView::IsShowing() {
 void SubmenuView::ShowAt(Widget* parent,
                          const gfx::Rect& bounds,
                          bool do_capture) {
+  // A host kept from a previous run belongs to the window it was shown for.
+  if (host_ && host_parent_ != parent)
+    Close();
+
   if (host_) {
+    if (!host_->IsMenuHostVisible()) {
+      // The host may have been kept since the menu last ran. The items may
+      // have changed since, and the menu may open elsewhere.
+      Layout();
+      ScrollRectToVisible(gfx::Rect(gfx::Size(1, 1)));
+      host_->SetMenuHostBounds(bounds);
+    }
     host_->ShowMenuHost(do_capture);
   } else {
+    host_parent_ = parent;
     host_ = new MenuHost(this);
     // Force construction of the scroll view container.
     GetScrollViewContainer();
@@ -296,6 +310,7 @@ void SubmenuView::ShowAt(Widget* parent,
       this,
       ui::AccessibilityTypes::EVENT_MENUPOPUPSTART,
       true);
+  menu_start_notified_ = true;
 }
 
 void SubmenuView::Reposition(const gfx::Rect& bounds) {
@@ -305,17 +320,17 @@ void SubmenuView::Reposition(const gfx::Rect& bounds) {
 
 void SubmenuView::Close() {
   if (host_) {
-    GetWidget()->NotifyAccessibilityEvent(
-        this,
-        ui::AccessibilityTypes::EVENT_MENUPOPUPEND,
-        true);
-    GetScrollViewContainer()->GetWidget()->NotifyAccessibilityEvent(
-        GetScrollViewContainer(),
-        ui::AccessibilityTypes::EVENT_MENUEND,
-        true);
-
+    NotifyMenuEnd();
     host_->DestroyMenuHost();
     host_ = NULL;
+    host_parent_ = NULL;
+  }
+}
+
+void SubmenuView::CloseKeepingHost() {
+  if (host_) {
+    NotifyMenuEnd();
+    host_->HideMenuHost();
   }
 }
 
@@ -367,7 +382,12 @@ MenuScrollViewContainer* SubmenuView::GetScrollViewContainer() {
 
 void SubmenuView::MenuHostDestroyed() {
   host_ = NULL;
-  GetMenuItem()->GetMenuController()->Cancel(MenuController::EXIT_DESTROYED);
+  host_parent_ = NULL;
+  menu_start_notified_ = false;
+  // A host kept between runs may go away with its parent while no menu runs.
+  MenuController* controller = GetMenuItem()->GetMenuController();
+  if (controller)
+    controller->Cancel(MenuController::EXIT_DESTROYED);
 }
 
 std::string SubmenuView::GetClassName() const {
@@ -436,4 +456,18 @@ void SubmenuView::OnScroll(float dx, float dy) {
     ScrollRectToVisible(new_vis_bounds);
 }
 
+void SubmenuView::NotifyMenuEnd() {
+  if (!menu_start_notified_)
+    return;
+  menu_start_notified_ = false;
+  GetWidget()->NotifyAccessibilityEvent(
+      this,
+      ui::AccessibilityTypes::EVENT_MENUPOPUPEND,
+      true);
+  GetScrollViewContainer()->GetWidget()->NotifyAccessibilityEvent(
+      GetScrollViewContainer(),
+      ui::AccessibilityTypes::EVENT_MENUEND,
+      true);
+}
+
 }  // namespace views
@@ -94,6 +94,11 @@ class VIEWS_EXPORT SubmenuView : public View,
   // Closes the menu, destroying the host.
   void Close();
 
+  // Closes the menu, but only hides the host, so that showing the menu again
+  // doesn't create the window and lay out the items again. The host is
+  // destroyed by Close(), or if the menu is shown for a different parent.
+  void CloseKeepingHost();
+
   // Hides the hosting window.
   //
   // The hosting window is hidden first, then deleted (Close) when the menu is
@@ -175,6 +180,9 @@ class VIEWS_EXPORT SubmenuView : public View,
   // Implementation of ScrollDelegate
   virtual void OnScroll(float dx, float dy) OVERRIDE;
 
+  // Announces the end of the menu to accessibility, if its start was.
+  void NotifyMenuEnd();
+
   // Parent menu item.
   MenuItemView* parent_menu_item_;
 
@@ -182,6 +190,13 @@ class VIEWS_EXPORT SubmenuView : public View,
   // |DestroyMenuHost|, or |MenuHostDestroyed| is invoked back on us.
   MenuHost* host_;
 
+  // The parent |host_| was created for.
+  Widget* host_parent_;
+
+  // True if the start of the menu was announced to accessibility and its end
+  // hasn't been yet.
+  bool menu_start_notified_;
+
   // If non-null, indicates a drop is in progress and drop_item is the item
   // the drop is over.
   MenuItemView* drop_item_;
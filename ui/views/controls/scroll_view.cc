@@ -4,20 +4,67 @@
 
 #include "ui/views/controls/scroll_view.h"
 
+#include "base/auto_reset.h"
 #include "base/logging.h"
+#include "skia/ext/platform_canvas.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "ui/gfx/blit.h"
+#include "ui/gfx/canvas.h"
 #include "ui/views/controls/scrollbar/native_scroll_bar.h"
 #include "ui/views/widget/root_view.h"
 
+#if defined(USE_UI_LAYER)
+#include "ui/compositor/layer.h"
+#endif
+
 namespace views {
 
 const char* const ScrollView::kViewClassName = "views/ScrollView";
 
 // Viewport contains the contents View of the ScrollView.
+//
+// With a backing store, the viewport paints the contents into a canvas of its
+// own size and paints itself from that canvas. Scrolling shifts the pixels of
+// the backing store with gfx::ScrollCanvas(), so that only the strip
+// scrolled into view, and whatever the contents invalidated, are painted
+// again.
 class Viewport : public View {
  public:
-  Viewport() {}
+  Viewport() : backing_store_enabled_(false), scrolling_(false) {}
   virtual ~Viewport() {}
 
+  void EnableBackingStore() { backing_store_enabled_ = true; }
+
+  // Moves the contents to |origin|, in the coordinates of the viewport.
+  void ScrollContentsTo(const gfx::Point& origin) {
+    View* contents = child_at(0);
+    gfx::Point amount(origin.x() - contents->x(), origin.y() - contents->y());
+    if (!backing_store_.get()) {
+      contents->SetPosition(origin);
+      return;
+    }
+
+    {
+      // Moving the contents invalidates all of them. The pixels already
+      // painted move along instead.
+      AutoReset<bool> scrolling(&scrolling_, true);
+      contents->SetPosition(origin);
+    }
+    gfx::Rect bounds(GetLocalBounds());
+    gfx::ScrollCanvas(backing_store_->sk_canvas(), bounds, amount);
+
+    // The damage not repainted yet moves with the pixels, and the pixels
+    // scrolled into view must be painted. Scrolling along one axis exposes a
+    // strip; otherwise, the whole viewport is painted again.
+    gfx::Rect moved_bounds(bounds);
+    moved_bounds.Offset(amount);
+    gfx::Rect exposed = bounds.Subtract(moved_bounds.Intersect(bounds));
+    dirty_rect_.Offset(amount);
+    dirty_rect_ = dirty_rect_.Intersect(bounds).Union(exposed);
+  }
+
+  bool has_backing_store() const { return backing_store_.get() != NULL; }
+
   virtual std::string GetClassName() const OVERRIDE {
     return "views/Viewport";
   }
@@ -38,7 +85,67 @@ class Viewport : public View {
       parent()->Layout();
   }
 
+  virtual void SchedulePaintInRect(const gfx::Rect& rect) OVERRIDE {
+    if (!scrolling_)
+      dirty_rect_ = dirty_rect_.Union(rect.Intersect(GetLocalBounds()));
+    View::SchedulePaintInRect(rect);
+  }
+
+ protected:
+  virtual void OnBoundsChanged(const gfx::Rect& previous_bounds) OVERRIDE {
+    if (backing_store_.get() && previous_bounds.size() != size())
+      backing_store_.reset();
+  }
+
+  virtual void PaintChildren(gfx::Canvas* canvas) OVERRIDE {
+    if (!CanUseBackingStore(canvas)) {
+      backing_store_.reset();
+      View::PaintChildren(canvas);
+      return;
+    }
+
+    if (!backing_store_.get()) {
+      backing_store_.reset(new gfx::Canvas(size(), false));
+      dirty_rect_ = GetLocalBounds();
+    }
+    if (!dirty_rect_.IsEmpty()) {
+      backing_store_->Save();
+      backing_store_->ClipRect(dirty_rect_);
+      backing_store_->DrawColor(SK_ColorBLACK, SkXfermode::kClear_Mode);
+      dirty_rect_ = gfx::Rect();
+      View::PaintChildren(backing_store_.get());
+      backing_store_->Restore();
+    }
+    canvas->sk_canvas()->drawBitmap(
+        skia::GetTopDevice(*backing_store_->sk_canvas())->accessBitmap(false),
+        0, 0);
+  }
+
  private:
+  // Returns true if the contents can be painted through the backing store
+  // onto |canvas|: the backing store is enabled, the viewport doesn't have a
+  // layer, and |canvas| maps the pixels of the backing store one to one.
+  bool CanUseBackingStore(gfx::Canvas* canvas) const {
+    if (!backing_store_enabled_ || !has_children() || size().IsEmpty())
+      return false;
+#if defined(USE_UI_LAYER)
+    if (layer())
+      return false;
+#endif
+    const SkMatrix& matrix = canvas->sk_canvas()->getTotalMatrix();
+    return (matrix.getType() & ~SkMatrix::kTranslate_Mask) == 0;
+  }
+
+  bool backing_store_enabled_;
+  scoped_ptr<gfx::Canvas> backing_store_;
+
+  // The part of the backing store that must be painted again, in the
+  // coordinates of the viewport.
+  gfx::Rect dirty_rect_;
+
+  // True while the contents are moved by ScrollContentsTo().
+  bool scrolling_;
+
   DISALLOW_COPY_AND_ASSIGN(Viewport);
 };
 
@@ -75,6 +182,7 @@ void ScrollView::SetContents(View* a_view) {
   if (a_view) {
     contents_ = a_view;
     viewport_->AddChildView(contents_);
+    UpdateContentsLayer();
   }
 
   Layout();
@@ -84,12 +192,32 @@ View* ScrollView::GetContents() const {
   return contents_;
 }
 
+void ScrollView::EnableViewPortLayer() {
+#if defined(USE_UI_LAYER)
+  if (viewport_layer_enabled_)
+    return;
+  viewport_layer_enabled_ = true;
+  viewport_->SetPaintToLayer(true);
+  // The viewport clips the contents layer, which is as big as the contents.
+  viewport_->layer()->SetMasksToBounds(true);
+  viewport_->SetFillsBoundsOpaquely(false);
+  UpdateContentsLayer();
+#endif
+}
+
+void ScrollView::EnableBackingStore() {
+  if (viewport_layer_enabled_)
+    return;
+  viewport_->EnableBackingStore();
+}
+
 void ScrollView::Init(ScrollBar* horizontal_scrollbar,
                       ScrollBar* vertical_scrollbar,
                       View* resize_corner) {
   DCHECK(horizontal_scrollbar && vertical_scrollbar);
 
   contents_ = NULL;
+  viewport_layer_enabled_ = false;
   horiz_sb_ = horizontal_scrollbar;
   vert_sb_ = vertical_scrollbar;
   resize_corner_ = resize_corner;
@@ -257,6 +385,7 @@ void ScrollView::CheckScrollBounds() {
 
     // This is no op if bounds are the same
     contents_->SetBounds(-x, -y, contents_->width(), contents_->height());
+    UpdatePaintPriorityRect(0, 0);
   }
 }
 
@@ -309,8 +438,11 @@ void ScrollView::ScrollContentsRegionToBeVisible(const gfx::Rect& rect) {
   const int new_y =
       (vis_rect.y() > y) ? y : std::max(0, max_y - viewport_->height());
 
+  const int dx = new_x + contents_->x();
+  const int dy = new_y + contents_->y();
   contents_->SetX(-new_x);
   contents_->SetY(-new_y);
+  UpdatePaintPriorityRect(dx, dy);
   UpdateScrollBarPositions();
 }
 
@@ -348,8 +480,12 @@ void ScrollView::ScrollToPosition(ScrollBar* source, int position) {
         position = 0;
       else if (position > max_pos)
         position = max_pos;
-      contents_->SetX(-position);
-      contents_->SchedulePaintInRect(contents_->GetVisibleBounds());
+      viewport_->ScrollContentsTo(gfx::Point(-position, contents_->y()));
+      UpdatePaintPriorityRect(position + origin, 0);
+      // With a layer the compositor moves the contents, which are already
+      // painted, and with a backing store the viewport shifts them.
+      if (!viewport_layer_enabled_ && !viewport_->has_backing_store())
+        contents_->SchedulePaintInRect(contents_->GetVisibleBounds());
     }
   } else if (source == vert_sb_ && vert_sb_->visible()) {
     int vh = viewport_->height();
@@ -361,12 +497,44 @@ void ScrollView::ScrollToPosition(ScrollBar* source, int position) {
         position = 0;
       else if (position > max_pos)
         position = max_pos;
-      contents_->SetY(-position);
-      contents_->SchedulePaintInRect(contents_->GetVisibleBounds());
+      viewport_->ScrollContentsTo(gfx::Point(contents_->x(), -position));
+      UpdatePaintPriorityRect(0, position + origin);
+      if (!viewport_layer_enabled_ && !viewport_->has_backing_store())
+        contents_->SchedulePaintInRect(contents_->GetVisibleBounds());
     }
   }
 }
 
+void ScrollView::UpdateContentsLayer() {
+#if defined(USE_UI_LAYER)
+  if (!viewport_layer_enabled_ || !contents_)
+    return;
+  contents_->SetPaintToLayer(true);
+  contents_->SetFillsBoundsOpaquely(false);
+  contents_->layer()->SetPaintInTiles(true);
+  UpdatePaintPriorityRect(0, 0);
+#endif
+}
+
+void ScrollView::UpdatePaintPriorityRect(int dx, int dy) {
+#if defined(USE_UI_LAYER)
+  if (!viewport_layer_enabled_ || !contents_ || !contents_->layer())
+    return;
+  gfx::Rect priority(-contents_->x(), -contents_->y(), viewport_->width(),
+                     viewport_->height());
+  if (dx < 0)
+    priority.set_x(priority.x() - viewport_->width());
+  if (dx != 0)
+    priority.set_width(priority.width() + viewport_->width());
+  if (dy < 0)
+    priority.set_y(priority.y() - viewport_->height());
+  if (dy != 0)
+    priority.set_height(priority.height() + viewport_->height());
+  contents_->layer()->SetPaintPriorityRect(
+      priority.Intersect(contents_->GetLocalBounds()));
+#endif
+}
+
 int ScrollView::GetScrollIncrement(ScrollBar* source, bool is_page,
                                    bool is_positive) {
   bool is_horizontal = source->IsHorizontal();
@@ -13,6 +13,8 @@
 
 namespace views {
 
+class Viewport;
+
 /////////////////////////////////////////////////////////////////////////////
 //
 // ScrollView class
@@ -43,6 +45,19 @@ class VIEWS_EXPORT ScrollView : public View, public ScrollBarController {
   void SetContents(View* a_view);
   View* GetContents() const;
 
+  // Gives the viewport and the contents their own layers, so that scrolling
+  // moves the contents layer instead of repainting the viewport. The contents
+  // layer paints in tiles, and the damaged tiles in view and in the viewport
+  // ahead of the last scroll are painted first. Does nothing in builds
+  // without layers.
+  void EnableViewPortLayer();
+
+  // Makes the viewport paint the contents through a backing store, so that
+  // scrolling shifts the pixels already painted and only paints the strip
+  // scrolled into view. Meant for views painted in software without layers;
+  // does nothing once EnableViewPortLayer() has been called.
+  void EnableBackingStore();
+
   // Overridden to layout the viewport and scrollbars.
   virtual void Layout() OVERRIDE;
 
@@ -115,8 +130,16 @@ class VIEWS_EXPORT ScrollView : public View, public ScrollBarController {
   // Make sure the content is not scrolled out of bounds in one dimension
   int CheckScrollBounds(int viewport_size, int content_size, int current_pos);
 
+  // Gives |contents_| a layer that paints in tiles if the viewport has one.
+  void UpdateContentsLayer();
+
+  // Updates the paint priority rect of the contents layer after a scroll by
+  // |dx|, |dy|: the visible rect, extended by a viewport in the direction of
+  // the scroll.
+  void UpdatePaintPriorityRect(int dx, int dy);
+
   // The clipping viewport. Content is added to that view.
-  View* viewport_;
+  Viewport* viewport_;
 
   // The current contents
   View* contents_;
@@ -130,6 +153,9 @@ class VIEWS_EXPORT ScrollView : public View, public ScrollBarController {
   // Resize corner.
   View* resize_corner_;
 
+  // True once EnableViewPortLayer() has been called.
+  bool viewport_layer_enabled_;
+
   DISALLOW_COPY_AND_ASSIGN(ScrollView);
 };
 
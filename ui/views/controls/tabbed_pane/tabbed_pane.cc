@@ -10,10 +10,43 @@
 #include "ui/views/controls/native/native_view_host.h"
 #include "ui/views/controls/tabbed_pane/native_tabbed_pane_wrapper.h"
 #include "ui/views/controls/tabbed_pane/tabbed_pane_listener.h"
+#include "ui/views/layout/fill_layout.h"
 #include "ui/views/widget/widget.h"
 
 namespace views {
 
+namespace {
+
+// The contents of a tab added with AddLazyTab(). The native tabbed panes show
+// the selected tab's contents, so these create the real contents the first
+// time they are shown.
+class LazyTabContents : public View {
+ public:
+  explicit LazyTabContents(const TabbedPane::ContentsFactory& factory)
+      : factory_(factory) {
+    SetLayoutManager(new FillLayout);
+  }
+
+  // Overridden from View:
+  virtual void VisibilityChanged(View* starting_from,
+                                 bool is_visible) OVERRIDE {
+    if (starting_from != this || !is_visible || factory_.is_null())
+      return;
+
+    AddChildView(factory_.Run());
+    factory_.Reset();
+    PreferredSizeChanged();
+    Layout();
+  }
+
+ private:
+  TabbedPane::ContentsFactory factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(LazyTabContents);
+};
+
+}  // namespace
+
 // static
 const char TabbedPane::kViewClassName[] = "views/TabbedPane";
 
@@ -41,6 +74,11 @@ void TabbedPane::AddTab(const string16& title, View* contents) {
   PreferredSizeChanged();
 }
 
+void TabbedPane::AddLazyTab(const string16& title,
+                            const ContentsFactory& factory) {
+  AddTab(title, new LazyTabContents(factory));
+}
+
 void TabbedPane::AddTabAtIndex(int index,
                                const string16& title,
                                View* contents,
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "base/basictypes.h"
+#include "base/callback.h"
 #include "base/compiler_specific.h"
 #include "base/string16.h"
 #include "ui/views/view.h"
@@ -20,6 +21,9 @@ class TabbedPaneListener;
 // associated view is displayed.
 class VIEWS_EXPORT TabbedPane : public View {
  public:
+  // Creates the contents of a tab added with AddLazyTab().
+  typedef base::Callback<View*(void)> ContentsFactory;
+
   TabbedPane();
   virtual ~TabbedPane();
 
@@ -40,6 +44,15 @@ class VIEWS_EXPORT TabbedPane : public View {
   // the TabbedPane.
   void AddTab(const string16& title, View* contents);
 
+  // Adds a new tab at the end of this TabbedPane with the specified |title|,
+  // whose contents |factory| creates the first time the tab is selected, so
+  // that dialogs with many pages only build the ones the user looks at. The
+  // contents are owned by the TabbedPane, and become the only child of the
+  // view that GetSelectedTab() and RemoveTabAtIndex() return for the tab.
+  // As a page that isn't created yet has no preferred size, the TabbedPane
+  // should be given a fixed size.
+  void AddLazyTab(const string16& title, const ContentsFactory& factory);
+
   // Adds a new tab at |index| with |title|.
   // |contents| is the view displayed when the tab is selected and is owned by
   // the TabbedPane. If |select_if_first_tab| is true and the tabbed pane is
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/bind.h"
 #include "base/message_loop.h"
 #include "base/utf_string_conversions.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -29,6 +30,12 @@ class FixedSizeView : public View {
   DISALLOW_COPY_AND_ASSIGN(FixedSizeView);
 };
 
+// Creates the contents of a lazy tab, counting them in |count|.
+View* CreateCountedView(int* count) {
+  ++*count;
+  return new View;
+}
+
 class TabbedPaneTest : public ViewsTestBase,
                        public WidgetDelegate {
  public:
@@ -133,4 +140,25 @@ TEST_F(TabbedPaneTest, AddRemove) {
   EXPECT_EQ(0, tabbed_pane_->GetSelectedTabIndex());
 }
 
+// Tests that the contents of a lazy tab are created when it is first selected.
+TEST_F(TabbedPaneTest, LazyTab) {
+  tabbed_pane_->AddTab(ASCIIToUTF16("tab0"), new View);
+  int created = 0;
+  tabbed_pane_->AddLazyTab(ASCIIToUTF16("tab1"),
+                           base::Bind(&CreateCountedView, &created));
+  EXPECT_EQ(0, created);
+
+  tabbed_pane_->SelectTabAt(1);
+  EXPECT_EQ(1, created);
+  View* contents = tabbed_pane_->GetSelectedTab();
+  ASSERT_EQ(1, contents->child_count());
+  EXPECT_EQ(contents->GetLocalBounds(), contents->child_at(0)->bounds());
+
+  // Selecting the tab again keeps its contents.
+  tabbed_pane_->SelectTabAt(0);
+  tabbed_pane_->SelectTabAt(1);
+  EXPECT_EQ(1, created);
+  EXPECT_EQ(1, contents->child_count());
+}
+
 } // namespace views
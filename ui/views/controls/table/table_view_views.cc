@@ -28,6 +28,10 @@ static const int kImageSize = 16;
 // Padding between the image and text.
 static const int kImageToTextPadding = 4;
 
+// The number of rows whose text is kept. A few screens of rows, so that
+// scrolling back and forth doesn't ask the model again.
+static const size_t kRowTextCacheSize = 256;
+
 namespace views {
 
 
@@ -41,7 +45,8 @@ TableView::TableView(ui::TableModel* model,
       table_type_(table_type),
       table_view_observer_(NULL),
       selected_row_(-1),
-      row_height_(font_.GetHeight() + kTextVerticalPadding * 2) {
+      row_height_(font_.GetHeight() + kTextVerticalPadding * 2),
+      row_text_cache_(kRowTextCacheSize) {
   // This implementation only shows a single column.
   DCHECK_EQ(1u, columns.size());
   // CHECK_BOX_AND_TEXT is not supported.
@@ -63,6 +68,7 @@ void TableView::SetModel(ui::TableModel* model) {
   if (model_)
     model_->SetObserver(NULL);
   model_ = model;
+  row_text_cache_.Clear();
   if (RowCount())
     selected_row_ = 0;
   if (model_)
@@ -151,8 +157,8 @@ bool TableView::OnKeyPressed(const KeyEvent& event) {
 
 bool TableView::OnMousePressed(const MouseEvent& event) {
   RequestFocus();
-  int row = event.y() / row_height_;
-  if (row >= 0 && row < RowCount()) {
+  int row = GetRowAt(event.y());
+  if (row != -1) {
     Select(row);
     if (table_view_observer_ && event.flags() & ui::EF_IS_DOUBLE_CLICK)
       table_view_observer_->OnDoubleClick();
@@ -161,6 +167,7 @@ bool TableView::OnMousePressed(const MouseEvent& event) {
 }
 
 void TableView::OnModelChanged() {
+  row_text_cache_.Clear();
   if (RowCount())
     selected_row_ = 0;
   else
@@ -169,16 +176,22 @@ void TableView::OnModelChanged() {
 }
 
 void TableView::OnItemsChanged(int start, int length) {
-  SchedulePaint();
+  UpdateRowTextCache(start, length, length);
+  gfx::Rect changed_bounds(GetRowBounds(start));
+  if (length > 1)
+    changed_bounds = changed_bounds.Union(GetRowBounds(start + length - 1));
+  SchedulePaintInRect(changed_bounds);
 }
 
 void TableView::OnItemsAdded(int start, int length) {
+  UpdateRowTextCache(start, 0, length);
   if (selected_row_ >= start)
     selected_row_ += length;
   NumRowsChanged();
 }
 
 void TableView::OnItemsRemoved(int start, int length) {
+  UpdateRowTextCache(start, length, 0);
   bool notify_selection_changed = false;
   if (selected_row_ >= (start + length)) {
     selected_row_ -= length;
@@ -192,6 +205,7 @@ void TableView::OnItemsRemoved(int start, int length) {
       selected_row_--;
     notify_selection_changed = true;
   }
+  NumRowsChanged();
   if (table_view_observer_ && notify_selection_changed)
     table_view_observer_->OnSelectionChanged();
 }
@@ -235,6 +249,7 @@ void TableView::OnPaint(gfx::Canvas* canvas) {
     }
   }
 
+  // Only the rows in the clip are painted, and only their text is asked for.
   int min_row = std::min(RowCount() - 1, std::max(0, min_y / row_height_));
   int max_row = max_y / row_height_;
   if (max_y % row_height_ != 0)
@@ -260,7 +275,7 @@ void TableView::OnPaint(gfx::Canvas* canvas) {
       text_x += kImageSize + kImageToTextPadding;
     }
     canvas->DrawStringInt(
-        model_->GetText(i, 0), font_, kTextColor,
+        GetRowText(i), font_, kTextColor,
         GetMirroredXWithWidthInView(text_x, row_bounds.width() - text_x),
         row_bounds.y() + kTextVerticalPadding,
         row_bounds.width() - text_x,
@@ -287,4 +302,37 @@ gfx::Rect TableView::GetRowBounds(int row) {
   return gfx::Rect(0, row * row_height_, width(), row_height_);
 }
 
+int TableView::GetRowAt(int y) {
+  if (y < 0)
+    return -1;
+  int row = y / row_height_;
+  return row < RowCount() ? row : -1;
+}
+
+const string16& TableView::GetRowText(int row) {
+  RowTextCache::iterator i = row_text_cache_.Get(row);
+  if (i == row_text_cache_.end())
+    i = row_text_cache_.Put(row, model_->GetText(row, 0));
+  return i->second;
+}
+
+void TableView::UpdateRowTextCache(int start, int removed, int added) {
+  if (row_text_cache_.empty())
+    return;
+
+  // Put the entries back from the least recently used, to keep their order.
+  std::vector<std::pair<int, string16> > entries;
+  for (RowTextCache::reverse_iterator i = row_text_cache_.rbegin();
+       i != row_text_cache_.rend(); ++i) {
+    int row = i->first;
+    if (row >= start + removed)
+      entries.push_back(std::make_pair(row - removed + added, i->second));
+    else if (row < start)
+      entries.push_back(*i);
+  }
+  row_text_cache_.Clear();
+  for (size_t i = 0; i < entries.size(); ++i)
+    row_text_cache_.Put(entries[i].first, entries[i].second);
+}
+
 }  // namespace views
@@ -8,6 +8,8 @@
 
 #include <vector>
 
+#include "base/memory/mru_cache.h"
+#include "base/string16.h"
 #include "ui/base/keycodes/keyboard_codes.h"
 #include "ui/base/models/table_model_observer.h"
 #include "ui/gfx/font.h"
@@ -127,12 +129,26 @@ class VIEWS_EXPORT TableView : public views::View,
   virtual void OnBlur() OVERRIDE;
 
  private:
+  typedef base::MRUCache<int, string16> RowTextCache;
+
   // Invoked when the number of rows changes in some way.
   void NumRowsChanged();
 
   // Returns the bounds of the specified row.
   gfx::Rect GetRowBounds(int row);
 
+  // Returns the row at |y|, or -1 if there is none.
+  int GetRowAt(int y);
+
+  // Returns the text of |row|. It is kept for the rows painted last, so that
+  // the model is asked again only when the row changes.
+  const string16& GetRowText(int row);
+
+  // Updates the cached text after the |removed| rows from |start| were
+  // replaced with |added| rows: drops the text of the replaced rows and moves
+  // the text of the rows after them, so the rows that didn't change keep it.
+  void UpdateRowTextCache(int start, int removed, int added);
+
   ui::TableModel* model_;
 
   const TableTypes table_type_;
@@ -145,6 +161,8 @@ class VIEWS_EXPORT TableView : public views::View,
 
   int row_height_;
 
+  RowTextCache row_text_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(TableView);
 };
 
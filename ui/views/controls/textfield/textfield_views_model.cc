@@ -56,16 +56,17 @@ class Edit {
                       new_cursor_pos_);
   }
 
-  // Try to merge the |edit| into this edit. Returns true if merge was
-  // successful, or false otherwise. Merged edit will be deleted after
-  // redo and should not be reused.
-  bool Merge(const Edit* edit) {
+  // Try to merge the |edit| into this edit. |text| is the text after this
+  // edit, before |edit|. Returns true if merge was successful, or false
+  // otherwise. Merged edit will be deleted after redo and should not be
+  // reused.
+  bool Merge(const Edit* edit, const string16& text) {
     // Don't merge if previous edit is DELETE. This happens when a
     // user deletes characters then hits return. In this case, the
     // delete should be treated as separate edit that can be undone
     // and should not be merged with the replace edit.
     if (type_ != DELETE_EDIT && edit->merge_with_previous()) {
-      MergeReplace(edit);
+      MergeReplace(edit, text);
       return true;
     }
     return mergeable() && edit->mergeable() && DoMerge(edit);
@@ -121,22 +122,29 @@ class Edit {
 
   // Merge the replace edit into the current edit. This is a special case to
   // handle an omnibox setting autocomplete string after new character is
-  // typed in.
-  void MergeReplace(const Edit* edit) {
+  // typed in. |text| is the text between the two edits.
+  void MergeReplace(const Edit* edit, const string16& text) {
     CHECK_EQ(REPLACE_EDIT, edit->type_);
-    CHECK_EQ(0U, edit->old_text_start_);
-    CHECK_EQ(0U, edit->new_text_start_);
-    string16 old_text = edit->old_text_;
-    old_text.erase(new_text_start_, new_text_.length());
-    old_text.insert(old_text_start_, old_text_);
-    // SetText() replaces entire text. Set |old_text_| to the entire
-    // replaced text with |this| edit undone.
+    DCHECK_EQ(old_text_start_, new_text_start_);
+    DCHECK_EQ(edit->old_text_start_, edit->new_text_start_);
+    // SetText() only replaces the part of the text that changed. Make this
+    // edit replace the span of |text| both edits touch: |old_text_| becomes
+    // that span with |this| edit undone, and |new_text_| becomes it with
+    // |edit| done.
+    size_t start = std::min(new_text_start_, edit->old_text_start_);
+    size_t end = std::max(new_text_end(), edit->old_text_end());
+    string16 old_text =
+        text.substr(start, new_text_start_ - start) + old_text_ +
+        text.substr(new_text_end(), end - new_text_end());
+    string16 new_text =
+        text.substr(start, edit->old_text_start_ - start) + edit->new_text_ +
+        text.substr(edit->old_text_end(), end - edit->old_text_end());
     old_text_ = old_text;
-    old_text_start_ = edit->old_text_start_;
+    old_text_start_ = start;
     delete_backward_ = false;
 
-    new_text_ = edit->new_text_;
-    new_text_start_ = edit->new_text_start_;
+    new_text_ = new_text;
+    new_text_start_ = start;
     merge_type_ = DO_NOT_MERGE;
   }
 
@@ -317,15 +325,28 @@ bool TextfieldViewsModel::SetText(const string16& text) {
     size_t old_cursor = GetCursorPosition();
     // SetText moves the cursor to the end.
     size_t new_cursor = text.length();
-    SelectAll();
+    // Only replace the part that changed, so the edit history keeps the
+    // difference rather than both texts, and the word breaker and style
+    // ranges only see the edit.
+    const string16& old_text = GetText();
+    size_t common_length = std::min(old_text.length(), text.length());
+    size_t prefix = 0;
+    while (prefix < common_length && old_text[prefix] == text[prefix])
+      ++prefix;
+    size_t suffix = 0;
+    while (suffix < common_length - prefix &&
+           old_text[old_text.length() - suffix - 1] ==
+               text[text.length() - suffix - 1])
+      ++suffix;
+    render_text_->SelectRange(ui::Range(prefix, old_text.length() - suffix));
     // If there is a composition text, don't merge with previous edit.
     // Otherwise, force merge the edits.
     ExecuteAndRecordReplace(
         changed ? DO_NOT_MERGE : MERGE_WITH_PREVIOUS,
         old_cursor,
         new_cursor,
-        text,
-        0U);
+        text.substr(prefix, text.length() - prefix - suffix),
+        prefix);
     render_text_->SetCursorPosition(new_cursor);
   }
   ClearSelection();
@@ -588,8 +609,7 @@ void TextfieldViewsModel::SetCompositionText(
     return;
 
   size_t cursor = GetCursorPosition();
-  string16 new_text = GetText();
-  render_text_->SetText(new_text.insert(cursor, composition.text));
+  render_text_->ReplaceText(ui::Range(cursor, cursor), composition.text);
   ui::Range range(cursor, cursor + composition.text.length());
   render_text_->SetCompositionRange(range);
   // TODO(msw): Support multiple composition underline ranges.
@@ -622,8 +642,7 @@ void TextfieldViewsModel::CancelCompositionText() {
   DCHECK(HasCompositionText());
   ui::Range range = render_text_->GetCompositionRange();
   ClearComposition();
-  string16 new_text = GetText();
-  render_text_->SetText(new_text.erase(range.start(), range.length()));
+  render_text_->ReplaceText(range, string16());
   render_text_->SetCursorPosition(range.start());
   if (delegate_)
     delegate_->OnCompositionTextConfirmedOrCleared();
@@ -751,7 +770,8 @@ void TextfieldViewsModel::ExecuteAndRecordInsert(const string16& text,
 bool TextfieldViewsModel::AddOrMergeEditHistory(Edit* edit) {
   ClearRedoHistory();
 
-  if (current_edit_ != edit_history_.end() && (*current_edit_)->Merge(edit)) {
+  if (current_edit_ != edit_history_.end() &&
+      (*current_edit_)->Merge(edit, GetText())) {
     // If a current edit exists and has been merged with a new edit,
     // don't add to the history, and return true to delete |edit| after
     // redo.
@@ -775,12 +795,19 @@ void TextfieldViewsModel::ModifyText(size_t delete_from,
                                      size_t new_text_insert_at,
                                      size_t new_cursor_pos) {
   DCHECK_LE(delete_from, delete_to);
-  string16 text = GetText();
   ClearComposition();
-  if (delete_from != delete_to)
-    render_text_->SetText(text.erase(delete_from, delete_to - delete_from));
-  if (!new_text.empty())
-    render_text_->SetText(text.insert(new_text_insert_at, new_text));
+  // Splice the text in place rather than setting the whole text, which would
+  // copy it and have the render text compare it with the old one.
+  if (delete_from == new_text_insert_at) {
+    render_text_->ReplaceText(ui::Range(delete_from, delete_to), new_text);
+  } else {
+    if (delete_from != delete_to)
+      render_text_->ReplaceText(ui::Range(delete_from, delete_to), string16());
+    if (!new_text.empty()) {
+      render_text_->ReplaceText(
+          ui::Range(new_text_insert_at, new_text_insert_at), new_text);
+    }
+  }
   render_text_->SetCursorPosition(new_cursor_pos);
   // TODO(oshima): mac selects the text that is just undone (but gtk doesn't).
   // This looks fine feature and we may want to do the same.
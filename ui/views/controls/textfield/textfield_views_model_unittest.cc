@@ -1159,6 +1159,30 @@ TEST_F(TextfieldViewsModelTest, UndoRedo_SetText) {
   EXPECT_FALSE(model.Redo());
 }
 
+TEST_F(TextfieldViewsModelTest, UndoRedo_SetTextInMiddle) {
+  // SetText() only replaces what changed, and is still merged with the edit
+  // before it.
+  TextfieldViewsModel model(NULL);
+  model.SetText(ASCIIToUTF16("www.google.com"));
+  model.SelectRange(ui::Range(4, 10));
+  model.InsertChar('y');
+  EXPECT_STR_EQ("www.y.com", model.GetText());
+  model.SetText(ASCIIToUTF16("www.youtube.com"));
+  EXPECT_STR_EQ("www.youtube.com", model.GetText());
+  EXPECT_EQ(15U, model.GetCursorPosition());
+
+  EXPECT_TRUE(model.Undo());
+  EXPECT_STR_EQ("www.google.com", model.GetText());
+  EXPECT_TRUE(model.Undo());
+  EXPECT_STR_EQ("", model.GetText());
+  EXPECT_FALSE(model.Undo());
+  EXPECT_TRUE(model.Redo());
+  EXPECT_STR_EQ("www.google.com", model.GetText());
+  EXPECT_TRUE(model.Redo());
+  EXPECT_STR_EQ("www.youtube.com", model.GetText());
+  EXPECT_FALSE(model.Redo());
+}
+
 TEST_F(TextfieldViewsModelTest, UndoRedo_BackspaceThenSetText) {
   // This is to test the undo/redo behavior of omnibox.
   TextfieldViewsModel model(NULL);
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 
+#include "base/bind.h"
 #include "base/i18n/rtl.h"
 #include "base/message_loop.h"
 #include "grit/ui_resources.h"
@@ -55,7 +56,8 @@ TreeView::TreeView()
       controller_(NULL),
       root_shown_(true),
       has_custom_icons_(false),
-      row_height_(font_.GetHeight() + kTextVerticalPadding * 2) {
+      row_height_(font_.GetHeight() + kTextVerticalPadding * 2),
+      ALLOW_THIS_IN_INITIALIZER_LIST(widen_factory_(this)) {
   set_focusable(true);
   set_background(Background::CreateSolidBackground(SK_ColorWHITE));
   closed_icon_ = *ui::ResourceBundle::GetSharedInstance().GetImageNamed(
@@ -102,6 +104,7 @@ void TreeView::SetModel(TreeModel* model) {
     model_->GetIcons(&icons_);
 
     root_.RemoveAll();
+    root_.InvalidateRowCounts();
     ConfigureInternalNode(model_->GetRoot(), &root_);
     LoadChildren(&root_);
     root_.set_is_expanded(true);
@@ -365,11 +368,14 @@ void TreeView::TreeNodesAdded(TreeModel* model,
       GetInternalNodeForModelNode(parent, DONT_CREATE_IF_NOT_LOADED);
   if (!parent_node || !parent_node->loaded_children())
     return;
+  ScopedVector<InternalNode> children;
+  children.reserve(count);
   for (int i = 0; i < count; ++i) {
     InternalNode* child = new InternalNode;
     ConfigureInternalNode(model_->GetChild(parent, start + i), child);
-    parent_node->Add(child, start + i);
+    children.push_back(child);
   }
+  parent_node->AddChildren(children.Pass(), start);
   if (IsExpanded(parent))
     DrawnNodesChanged();
 }
@@ -383,12 +389,13 @@ void TreeView::TreeNodesRemoved(TreeModel* model,
   if (!parent_node || !parent_node->loaded_children())
     return;
   bool reset_selection = false;
-  for (int i = 0; i < count; ++i) {
-    InternalNode* child_removing = parent_node->GetChild(start);
-    if (selected_node_ && selected_node_->HasAncestor(child_removing))
+  for (int i = 0; i < count && !reset_selection; ++i) {
+    if (selected_node_ &&
+        selected_node_->HasAncestor(parent_node->GetChild(start + i))) {
       reset_selection = true;
-    delete parent_node->Remove(child_removing);
+    }
   }
+  parent_node->RemoveChildren(start, count);
   if (reset_selection) {
     // selected_node_ is no longer valid (at the time we enter this function
     // its model_node() is likely deleted). Explicitly NULL out the field
@@ -530,8 +537,25 @@ void TreeView::OnPaint(gfx::Canvas* canvas) {
   int max_row = (max_y - kVerticalInset) / row_height_;
   if ((max_y - kVerticalInset) % row_height_ != 0)
     max_row++;
-  int current_row = root_row();
-  PaintRows(canvas, min_row, max_row, &root_, root_depth(), &current_row);
+  int depth = 0;
+  int max_width = 0;
+  InternalNode* node = GetNodeByRow(min_row, &depth);
+  for (int row = min_row; node && row < max_row; ++row) {
+    PaintRow(canvas, node, row, depth);
+    // Matches the width computed by UpdatePreferredSize().
+    max_width = std::max(max_width, node->text_width() +
+                         text_offset_ * (depth + 1) +
+                         kTextHorizontalPadding * 2);
+    node = GetNextRowNode(node, &depth);
+  }
+  // Nodes are measured as they are painted, so the preferred size may have
+  // been too narrow. Update it once painting is done.
+  if (max_width > preferred_size_.width() && !widen_factory_.HasWeakPtrs()) {
+    MessageLoop::current()->PostTask(
+        FROM_HERE,
+        base::Bind(&TreeView::OnMeasuredNodesWidened,
+                   widen_factory_.GetWeakPtr()));
+  }
 }
 
 void TreeView::OnFocus() {
@@ -556,8 +580,8 @@ void TreeView::LoadChildren(InternalNode* node) {
 
 void TreeView::ConfigureInternalNode(TreeModelNode* model_node,
                                      InternalNode* node) {
+  // The text is measured lazily, see GetTextWidth().
   node->Reset(model_node);
-  UpdateNodeTextWidth(node);
 }
 
 void TreeView::UpdateNodeTextWidth(InternalNode* node) {
@@ -567,6 +591,16 @@ void TreeView::UpdateNodeTextWidth(InternalNode* node) {
   node->set_text_width(width);
 }
 
+int TreeView::GetTextWidth(InternalNode* node) {
+  if (node->text_width() < 0)
+    UpdateNodeTextWidth(node);
+  return node->text_width();
+}
+
+void TreeView::OnMeasuredNodesWidened() {
+  DrawnNodesChanged();
+}
+
 void TreeView::DrawnNodesChanged() {
   UpdatePreferredSize();
   PreferredSizeChanged();
@@ -610,23 +644,21 @@ void TreeView::SchedulePaintForNode(InternalNode* node) {
   SchedulePaintInRect(GetBoundsForNode(node));
 }
 
-void TreeView::PaintRows(gfx::Canvas* canvas,
-                         int min_row,
-                         int max_row,
-                         InternalNode* node,
-                         int depth,
-                         int* row) {
-  if (*row >= max_row)
-    return;
-
-  if (*row >= min_row && *row < max_row)
-    PaintRow(canvas, node, *row, depth);
-  (*row)++;
-  if (!node->is_expanded())
-    return;
-  depth++;
-  for (int i = 0; i < node->child_count() && *row < max_row; ++i)
-    PaintRows(canvas, min_row, max_row, node->GetChild(i), depth, row);
+TreeView::InternalNode* TreeView::GetNextRowNode(InternalNode* node,
+                                                 int* depth) {
+  if (node->is_expanded() && node->child_count()) {
+    (*depth)++;
+    return node->GetChild(0);
+  }
+  while (node->parent()) {
+    InternalNode* parent = node->parent();
+    int index = node->GetIndexInParent();
+    if (index + 1 < parent->child_count())
+      return parent->GetChild(index + 1);
+    node = parent;
+    (*depth)--;
+  }
+  return NULL;
 }
 
 void TreeView::PaintRow(gfx::Canvas* canvas,
@@ -732,7 +764,7 @@ gfx::Rect TreeView::GetBoundsForNodeImpl(InternalNode* node,
                                          int depth) {
   gfx::Rect rect(depth * kIndent + kHorizontalInset,
                  row * row_height_ + kVerticalInset,
-                 text_offset_ + node->text_width() +
+                 text_offset_ + GetTextWidth(node) +
                  kTextHorizontalPadding * 2,
                  row_height_);
   rect.set_x(GetMirroredXWithWidthInView(rect.x(), rect.width()));
@@ -752,12 +784,11 @@ int TreeView::GetRowForNode(InternalNode* node, int* depth) {
   int row = -1;
   InternalNode* tmp_node = node;
   while (tmp_node->parent()) {
-    int index_in_parent = tmp_node->parent()->GetIndexOf(tmp_node);
+    InternalNode* parent = tmp_node->parent();
     (*depth)++;
     row++;  // For node.
-    for (int i = 0; i < index_in_parent; ++i)
-      row += tmp_node->parent()->GetChild(i)->NumExpandedNodes();
-    tmp_node = tmp_node->parent();
+    row += parent->GetRowOffsetOfChild(tmp_node->GetIndexInParent());
+    tmp_node = parent;
   }
   if (root_shown_) {
     (*depth)++;
@@ -767,32 +798,22 @@ int TreeView::GetRowForNode(InternalNode* node, int* depth) {
 }
 
 TreeView::InternalNode* TreeView::GetNodeByRow(int row, int* depth) {
-  int current_row = root_row();
   *depth = 0;
-  return GetNodeByRowImpl(&root_, row, root_depth(), &current_row, depth);
-}
-
-TreeView::InternalNode* TreeView::GetNodeByRowImpl(InternalNode* node,
-                                                   int target_row,
-                                                   int current_depth,
-                                                   int* current_row,
-                                                   int* node_depth) {
-  if (*current_row == target_row) {
-    *node_depth = current_depth;
-    return node;
-  }
-  (*current_row)++;
-  if (node->is_expanded()) {
-    current_depth++;
-    for (int i = 0; i < node->child_count(); ++i) {
-      InternalNode* result = GetNodeByRowImpl(
-          node->GetChild(i), target_row, current_depth, current_row,
-          node_depth);
-      if (result)
-        return result;
-    }
+  InternalNode* node = &root_;
+  int node_row = root_row();
+  int node_depth = root_depth();
+  // Descend into the child whose rows contain |row| until reaching it.
+  while (node_row != row) {
+    int offset = row - node_row - 1;
+    if (offset < 0 || offset >= node->NumExpandedNodes() - 1)
+      return NULL;
+    int index = node->GetChildIndexAtRowOffset(offset);
+    node_row += 1 + node->GetRowOffsetOfChild(index);
+    node = node->GetChild(index);
+    node_depth++;
   }
-  return NULL;
+  *depth = node_depth;
+  return node;
 }
 
 void TreeView::IncrementSelection(IncrementType type) {
@@ -874,7 +895,8 @@ TreeView::InternalNode::InternalNode()
     : model_node_(NULL),
       loaded_children_(false),
       is_expanded_(false),
-      text_width_(0) {
+      text_width_(-1),
+      row_count_(-1) {
 }
 
 TreeView::InternalNode::~InternalNode() {
@@ -884,20 +906,50 @@ void TreeView::InternalNode::Reset(ui::TreeModelNode* node) {
   model_node_ = node;
   loaded_children_ = false;
   is_expanded_ = false;
-  text_width_ = 0;
+  text_width_ = -1;
+  InvalidateRowCounts();
+}
+
+void TreeView::InternalNode::set_is_expanded(bool expanded) {
+  if (expanded == is_expanded_)
+    return;
+  is_expanded_ = expanded;
+  InvalidateRowCounts();
 }
 
 int TreeView::InternalNode::NumExpandedNodes() {
-  int result = 1;  // For this.
-  if (!is_expanded_)
-    return result;
-  for (int i = 0; i < child_count(); ++i)
-    result += GetChild(i)->NumExpandedNodes();
-  return result;
+  if (row_count_ == -1) {
+    row_count_ = 1;  // For this.
+    if (is_expanded_) {
+      UpdateChildRowOffsets();
+      row_count_ += child_row_offsets_.back();
+    }
+  }
+  return row_count_;
+}
+
+int TreeView::InternalNode::GetRowOffsetOfChild(int index) {
+  DCHECK(index >= 0 && index < child_count());
+  UpdateChildRowOffsets();
+  return child_row_offsets_[index];
+}
+
+int TreeView::InternalNode::GetChildIndexAtRowOffset(int offset) {
+  UpdateChildRowOffsets();
+  DCHECK(offset >= 0 && offset < child_row_offsets_.back());
+  return static_cast<int>(std::upper_bound(child_row_offsets_.begin(),
+                                           child_row_offsets_.end(),
+                                           offset) -
+                          child_row_offsets_.begin()) - 1;
+}
+
+int TreeView::InternalNode::GetIndexInParent() {
+  DCHECK(parent());
+  return parent()->GetIndexOf(this);
 }
 
 int TreeView::InternalNode::GetMaxWidth(int indent, int depth) {
-  int max_width = text_width_ + indent * depth;
+  int max_width = std::max(text_width_, 0) + indent * depth;
   if (!is_expanded_)
     return max_width;
   for (int i = 0; i < child_count(); ++i) {
@@ -907,4 +959,48 @@ int TreeView::InternalNode::GetMaxWidth(int indent, int depth) {
   return max_width;
 }
 
+void TreeView::InternalNode::InvalidateRowCounts() {
+  for (InternalNode* node = this; node; node = node->parent()) {
+    node->row_count_ = -1;
+    node->child_row_offsets_.clear();
+  }
+}
+
+void TreeView::InternalNode::Add(InternalNode* node, int index) {
+  ui::TreeNode<InternalNode>::Add(node, index);
+  InvalidateRowCounts();
+}
+
+TreeView::InternalNode* TreeView::InternalNode::Remove(InternalNode* node) {
+  InternalNode* removed = ui::TreeNode<InternalNode>::Remove(node);
+  InvalidateRowCounts();
+  return removed;
+}
+
+void TreeView::InternalNode::AddChildren(ScopedVector<InternalNode> nodes,
+                                         int index) {
+  ui::TreeNode<InternalNode>::AddChildren(nodes.Pass(), index);
+  InvalidateRowCounts();
+}
+
+ScopedVector<TreeView::InternalNode> TreeView::InternalNode::RemoveChildren(
+    int start,
+    int count) {
+  ScopedVector<InternalNode> removed(
+      ui::TreeNode<InternalNode>::RemoveChildren(start, count));
+  InvalidateRowCounts();
+  return removed.Pass();
+}
+
+void TreeView::InternalNode::UpdateChildRowOffsets() {
+  if (!child_row_offsets_.empty())
+    return;
+  child_row_offsets_.resize(child_count() + 1);
+  child_row_offsets_[0] = 0;
+  for (int i = 0; i < child_count(); ++i) {
+    child_row_offsets_[i + 1] = child_row_offsets_[i] +
+        GetChild(i)->NumExpandedNodes();
+  }
+}
+
 }  // namespace views
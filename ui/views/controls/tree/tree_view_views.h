@@ -10,6 +10,8 @@
 
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/memory/scoped_vector.h"
+#include "base/memory/weak_ptr.h"
 #include "ui/base/models/tree_node_model.h"
 #include "ui/gfx/font.h"
 #include "ui/gfx/image/image_skia.h"
@@ -26,9 +28,12 @@ class TreeViewController;
 // can expand, collapse and edit the items. A Controller may be attached to
 // receive notification of selection changes and restrict editing.
 //
-// Note on implementation. This implementation doesn't scale well. In particular
-// it does not store any row information, but instead calculates it as
-// necessary. But it's more than adequate for current uses.
+// Note on implementation. Each node caches the number of rows it and its
+// expanded descendants take, and the row offset of each of its children, so
+// mapping between rows and nodes takes time proportional to the depth of the
+// tree (times log of the child count) rather than to the number of rows. The
+// width of the text of a node is only measured once the node is painted or
+// its bounds are needed.
 class VIEWS_EXPORT TreeView : public View,
                               public ui::TreeModelObserver,
                               public TextfieldController,
@@ -162,26 +167,54 @@ class VIEWS_EXPORT TreeView : public View,
     ui::TreeModelNode* model_node() { return model_node_; }
 
     // Whether the node is expanded.
-    void set_is_expanded(bool expanded) { is_expanded_ = expanded; }
+    void set_is_expanded(bool expanded);
     bool is_expanded() const { return is_expanded_; }
 
     // Whether children have been loaded.
     void set_loaded_children(bool value) { loaded_children_ = value; }
     bool loaded_children() const { return loaded_children_; }
 
-    // Width needed to display the string.
+    // Width needed to display the string, or -1 if it hasn't been measured
+    // yet. See TreeView::GetTextWidth().
     void set_text_width(int width) { text_width_ = width; }
     int text_width() const { return text_width_; }
 
-    // Returns the total number of descendants (including this node).
+    // Returns the total number of expanded descendants (including this node).
+    // This is cached until the set of expanded descendants changes.
     int NumExpandedNodes();
 
+    // Returns the number of rows between this node and the child at |index|,
+    // that is the number of rows the children before |index| take.
+    int GetRowOffsetOfChild(int index);
+
+    // Returns the index of the child whose rows contain |offset|, which is
+    // relative to the row after this node.
+    int GetChildIndexAtRowOffset(int offset);
+
+    // Returns the index of this node in its parent.
+    int GetIndexInParent();
+
     // Returns the max width of all descendants (including this node). |indent|
     // is how many pixels each child is indented and |depth| is the depth of
-    // this node from its parent.
+    // this node from its parent. Nodes that haven't been measured are ignored.
     int GetMaxWidth(int indent, int depth);
 
+    // Forgets the row counts of this node and its ancestors. Invoked when the
+    // rows below this node change.
+    void InvalidateRowCounts();
+
+    // TreeNode overrides:
+    virtual void Add(InternalNode* node, int index) OVERRIDE;
+    virtual InternalNode* Remove(InternalNode* node) OVERRIDE;
+    virtual void AddChildren(ScopedVector<InternalNode> nodes,
+                             int index) OVERRIDE;
+    virtual ScopedVector<InternalNode> RemoveChildren(int start,
+                                                      int count) OVERRIDE;
+
    private:
+    // Computes |child_row_offsets_| if it isn't valid.
+    void UpdateChildRowOffsets();
+
     // The node from the model.
     ui::TreeModelNode* model_node_;
 
@@ -192,6 +225,13 @@ class VIEWS_EXPORT TreeView : public View,
 
     int text_width_;
 
+    // Cached result of NumExpandedNodes(), or -1 if not valid.
+    int row_count_;
+
+    // Entry i is the number of rows the first i children take; there is one
+    // more entry than there are children. Empty if not valid.
+    std::vector<int> child_row_offsets_;
+
     DISALLOW_COPY_AND_ASSIGN(InternalNode);
   };
 
@@ -230,6 +270,14 @@ class VIEWS_EXPORT TreeView : public View,
   // Sets |node|s text_width.
   void UpdateNodeTextWidth(InternalNode* node);
 
+  // Returns the text width of |node|, measuring it if it hasn't been measured
+  // yet.
+  int GetTextWidth(InternalNode* node);
+
+  // Invoked after painting measured nodes that are wider than the preferred
+  // size.
+  void OnMeasuredNodesWidened();
+
   // Invoked when the set of drawn nodes changes.
   void DrawnNodesChanged();
 
@@ -242,15 +290,9 @@ class VIEWS_EXPORT TreeView : public View,
   // Schedules a paint for |node|.
   void SchedulePaintForNode(InternalNode* node);
 
-  // Recursively paints rows from |min_row| to |max_row|. |node| is the node for
-  // the row |*row|. |row| is updated as this walks the tree. Depth is the depth
-  // of |*row|.
-  void PaintRows(gfx::Canvas* canvas,
-                 int min_row,
-                 int max_row,
-                 InternalNode* node,
-                 int depth,
-                 int* row);
+  // Returns the node for the row after |node|, or NULL if |node| is the last
+  // row. |depth| is the depth of |node| and is updated to that of the result.
+  InternalNode* GetNextRowNode(InternalNode* node, int* depth);
 
   // Invoked to paint a single node.
   void PaintRow(gfx::Canvas* canvas,
@@ -282,16 +324,10 @@ class VIEWS_EXPORT TreeView : public View,
   // Returns the row and depth of a node.
   int GetRowForNode(InternalNode* node, int* depth);
 
-  // Returns the row and depth of the specified node.
+  // Returns the node and depth of the specified row, or NULL if there is no
+  // such row.
   InternalNode* GetNodeByRow(int row, int* depth);
 
-  // Implementation of GetNodeByRow. |curent_row| is updated as we iterate.
-  InternalNode* GetNodeByRowImpl(InternalNode* node,
-                                 int target_row,
-                                 int current_depth,
-                                 int* current_row,
-                                 int* node_depth);
-
   // Increments the selection. Invoked in response to up/down arrow.
   void IncrementSelection(IncrementType type);
 
@@ -361,6 +397,9 @@ class VIEWS_EXPORT TreeView : public View,
   // control, icon and offsets.
   int text_offset_;
 
+  // Used to update the preferred size once after painting.
+  base::WeakPtrFactory<TreeView> widen_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(TreeView);
 };
 
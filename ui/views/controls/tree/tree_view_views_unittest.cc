@@ -59,6 +59,13 @@ class TreeViewViewsTest : public ViewsTestBase {
   void ExpandOrSelectChild();
   int GetRowCount();
 
+  // Returns the titles of the nodes of each row, mapping each row to its node
+  // and back.
+  std::string RowsAsString();
+
+  // Returns true if there is a node at |row|.
+  bool HasNodeAtRow(int row);
+
   ui::TreeNodeModel<TestNode > model_;
   TreeView tree_;
 
@@ -114,6 +121,28 @@ int TreeViewViewsTest::GetRowCount() {
   return tree_.GetRowCount();
 }
 
+bool TreeViewViewsTest::HasNodeAtRow(int row) {
+  int depth;
+  return tree_.GetNodeByRow(row, &depth) != NULL;
+}
+
+std::string TreeViewViewsTest::RowsAsString() {
+  std::string result;
+  for (int row = 0; row < tree_.GetRowCount(); ++row) {
+    int depth;
+    TreeView::InternalNode* node = tree_.GetNodeByRow(row, &depth);
+    if (!node)
+      return result + " <missing>";
+    int node_depth;
+    if (tree_.GetRowForNode(node, &node_depth) != row || node_depth != depth)
+      return result + " <mismatch>";
+    if (row > 0)
+      result += " ";
+    result += UTF16ToASCII(node->model_node()->GetTitle());
+  }
+  return result;
+}
+
 TestNode* TreeViewViewsTest::GetNodeByTitleImpl(TestNode* node,
                                                 const string16& title) {
   if (node->GetTitle() == title)
@@ -381,4 +410,39 @@ TEST_F(TreeViewViewsTest, ExpandOrSelectChild) {
   EXPECT_EQ("b1", GetSelectedNodeTitle());
 }
 
+// Verifies rows map to nodes and back as the tree changes.
+TEST_F(TreeViewViewsTest, RowMapping) {
+  tree_.SetModel(&model_);
+  EXPECT_EQ("root a b c", RowsAsString());
+
+  tree_.Expand(GetNodeByTitle("b"));
+  EXPECT_EQ("root a b b1 c", RowsAsString());
+
+  Add(GetNodeByTitle("b"), 0, "b0");
+  Add(model_.GetRoot(), 0, "A");
+  EXPECT_EQ("root A a b b0 b1 c", RowsAsString());
+
+  delete model_.Remove(model_.GetRoot(), GetNodeByTitle("a"));
+  EXPECT_EQ("root A b b0 b1 c", RowsAsString());
+
+  tree_.SetRootShown(false);
+  EXPECT_EQ("A b b0 b1 c", RowsAsString());
+
+  tree_.Collapse(GetNodeByTitle("b"));
+  EXPECT_EQ("A b c", RowsAsString());
+  EXPECT_FALSE(HasNodeAtRow(3));
+
+  // A range of nodes added at once.
+  ScopedVector<TestNode> nodes;
+  for (int i = 0; i < 2; ++i) {
+    nodes.push_back(new TestNode);
+    nodes[i]->SetTitle(ASCIIToUTF16(i == 0 ? "x" : "y"));
+  }
+  model_.AddChildren(model_.GetRoot(), nodes.Pass(), 1);
+  EXPECT_EQ("A x y b c", RowsAsString());
+
+  model_.RemoveChildren(model_.GetRoot(), 0, 3);
+  EXPECT_EQ("b c", RowsAsString());
+}
+
 }  // namespace views
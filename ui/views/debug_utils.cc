@@ -4,8 +4,11 @@
 
 #include "ui/views/debug_utils.h"
 
+#include "base/basictypes.h"
 #include "base/logging.h"
 #include "base/utf_string_conversions.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "ui/gfx/canvas.h"
 #include "ui/views/view.h"
 
 #ifndef NDEBUG
@@ -14,6 +17,37 @@
 
 namespace views {
 
+namespace {
+
+// The colors of the repaint overlay, used in turn.
+const SkColor kRepaintOverlayColors[] = {
+  SkColorSetARGB(0x60, 0xFF, 0x00, 0x00),
+  SkColorSetARGB(0x60, 0x00, 0xFF, 0x00),
+  SkColorSetARGB(0x60, 0x00, 0x00, 0xFF),
+  SkColorSetARGB(0x60, 0xFF, 0xFF, 0x00),
+};
+
+bool g_show_repaint_overlay = false;
+size_t g_repaint_overlay_color = 0;
+
+}  // namespace
+
+void SetShowRepaintOverlay(bool show) {
+  g_show_repaint_overlay = show;
+}
+
+bool ShouldShowRepaintOverlay() {
+  return g_show_repaint_overlay;
+}
+
+void PaintRepaintOverlay(gfx::Canvas* canvas) {
+  if (!g_show_repaint_overlay)
+    return;
+  g_repaint_overlay_color =
+      (g_repaint_overlay_color + 1) % arraysize(kRepaintOverlayColors);
+  canvas->DrawColor(kRepaintOverlayColors[g_repaint_overlay_color]);
+}
+
 #ifndef NDEBUG
 
 namespace {
@@ -35,7 +69,7 @@ void PrintViewHierarchyImp(const View* view, int indent) {
   std::cout << buf.str() << std::endl;
 
   for (int i = 0, count = view->child_count(); i < count; ++i)
-    PrintViewHierarchyImp(view->GetChildViewAt(i), indent + 2);
+    PrintViewHierarchyImp(view->child_at(i), indent + 2);
 }
 
 void PrintFocusHierarchyImp(const View* view, int indent) {
@@ -55,7 +89,7 @@ void PrintFocusHierarchyImp(const View* view, int indent) {
   std::cout << buf.str() << std::endl;
 
   if (view->child_count() > 0)
-    PrintFocusHierarchyImp(view->GetChildViewAt(0), indent + 2);
+    PrintFocusHierarchyImp(view->child_at(0), indent + 2);
 
   const View* next_focusable = view->GetNextFocusableView();
   if (next_focusable)
@@ -71,6 +105,6 @@ void PrintFocusHierarchy(const View* view) {
   PrintFocusHierarchyImp(view, 0);
 }
 
-}  // namespace views
-
 #endif  // NDEBUG
+
+}  // namespace views
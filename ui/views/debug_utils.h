@@ -6,10 +6,27 @@
 #define UI_VIEWS_DEBUG_UTILS_H_
 #pragma once
 
+#include "ui/views/views_export.h"
+
+namespace gfx {
+class Canvas;
+}
+
 namespace views {
 
 class View;
 
+// Turns on or off an overlay that shows which regions the views repaint.
+// Each paint of a widget or of a view with a layer covers the region it
+// repainted with a translucent color that changes at every paint, so the
+// repainted regions flash.
+VIEWS_EXPORT void SetShowRepaintOverlay(bool show);
+VIEWS_EXPORT bool ShouldShowRepaintOverlay();
+
+// Covers the clip of |canvas|, the region just repainted, with the overlay if
+// it is on.
+VIEWS_EXPORT void PaintRepaintOverlay(gfx::Canvas* canvas);
+
 #ifndef NDEBUG
 
 // Log the view hierarchy.
@@ -62,6 +62,7 @@ void ScrollViewExample::CreateExampleView(View* container) {
   scrollable_ = new ScrollableView();
   scroll_view_ = new ScrollView();
   scroll_view_->SetContents(scrollable_);
+  scroll_view_->EnableViewPortLayer();
   scrollable_->SetBounds(0, 0, 1000, 100);
   scrollable_->SetColor(SK_ColorYELLOW, SK_ColorCYAN);
 
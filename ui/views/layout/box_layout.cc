@@ -4,6 +4,8 @@
 
 #include "ui/views/layout/box_layout.h"
 
+#include <vector>
+
 #include "ui/gfx/insets.h"
 #include "ui/gfx/rect.h"
 #include "ui/views/view.h"
@@ -32,38 +34,39 @@ void BoxLayout::Layout(View* host) {
   int x = child_area.x();
   int y = child_area.y();
 
-  int padding = 0;
-  if (spread_blank_space_) {
-    int total = 0;
-    int visible = 0;
-    for (int i = 0; i < host->child_count(); ++i) {
-      View* child = host->child_at(i);
-      if (!child->visible())
-        continue;
-      if (orientation_ == kHorizontal)
-        total += child->GetPreferredSize().width() + between_child_spacing_;
-      else
-        total += child->GetPreferredSize().height() + between_child_spacing_;
-      ++visible;
-    }
+  // Measure the children once, then arrange them.
+  std::vector<gfx::Size> sizes(host->child_count());
+  int total = 0;
+  int visible = 0;
+  for (int i = 0; i < host->child_count(); ++i) {
+    View* child = host->child_at(i);
+    if (!child->visible())
+      continue;
+    sizes[i] = child->GetPreferredSize();
+    if (orientation_ == kHorizontal)
+      total += sizes[i].width() + between_child_spacing_;
+    else
+      total += sizes[i].height() + between_child_spacing_;
+    ++visible;
+  }
 
-    if (visible) {
-      total -= between_child_spacing_;
-      if (orientation_ == kHorizontal)
-        padding = (child_area.width() - total) / visible;
-      else
-        padding = (child_area.height() - total) / visible;
+  int padding = 0;
+  if (spread_blank_space_ && visible) {
+    total -= between_child_spacing_;
+    if (orientation_ == kHorizontal)
+      padding = (child_area.width() - total) / visible;
+    else
+      padding = (child_area.height() - total) / visible;
 
-      if (padding < 0)
-        padding = 0;
-    }
+    if (padding < 0)
+      padding = 0;
   }
 
   for (int i = 0; i < host->child_count(); ++i) {
     View* child = host->child_at(i);
     if (child->visible()) {
       gfx::Rect bounds(x, y, child_area.width(), child_area.height());
-      gfx::Size size(child->GetPreferredSize());
+      const gfx::Size& size = sizes[i];
       if (orientation_ == kHorizontal) {
         bounds.set_width(size.width() + padding);
         x += size.width() + between_child_spacing_ + padding;
@@ -376,7 +376,7 @@ static bool CompareByRowSpan(const ViewState* v1, const ViewState* v2) {
 
 // ColumnSet -------------------------------------------------------------
 
-ColumnSet::ColumnSet(int id) : id_(id) {
+ColumnSet::ColumnSet(View* host, int id) : host_(host), id_(id) {
 }
 
 ColumnSet::~ColumnSet() {
@@ -410,6 +410,7 @@ void ColumnSet::LinkColumnSizes(int first, ...) {
     last = next;
   }
   va_end(marker);
+  host_->InvalidateLayout();
 }
 
 void ColumnSet::AddColumn(GridLayout::Alignment h_align,
@@ -423,6 +424,7 @@ void ColumnSet::AddColumn(GridLayout::Alignment h_align,
                               fixed_width, min_width, columns_.size(),
                               is_padding);
   columns_.push_back(column);
+  host_->InvalidateLayout();
 }
 
 void ColumnSet::AddViewState(ViewState* view_state) {
@@ -689,6 +691,7 @@ void GridLayout::SetInsets(int top, int left, int bottom, int right) {
   bottom_inset_ = bottom;
   left_inset_ = left;
   right_inset_ = right;
+  host_->InvalidateLayout();
 }
 
 void GridLayout::SetInsets(const gfx::Insets& insets) {
@@ -697,7 +700,7 @@ void GridLayout::SetInsets(const gfx::Insets& insets) {
 
 ColumnSet* GridLayout::AddColumnSet(int id) {
   DCHECK(GetColumnSet(id) == NULL);
-  ColumnSet* column_set = new ColumnSet(id);
+  ColumnSet* column_set = new ColumnSet(host_, id);
   column_sets_.push_back(column_set);
   return column_set;
 }
@@ -781,6 +784,11 @@ static void CalculateSize(int pref_size, GridLayout::Alignment alignment,
   }
 }
 
+void GridLayout::set_minimum_size(const gfx::Size& size) {
+  minimum_size_ = size;
+  host_->InvalidateLayout();
+}
+
 void GridLayout::Installed(View* host) {
   DCHECK(host_ == host);
 }
@@ -979,6 +987,9 @@ void GridLayout::AddViewState(ViewState* view_state) {
                                                     CompareByRowSpan);
   view_states_.insert(i, view_state);
   SkipPaddingColumns();
+  // The view may have been a child of the host already, which then didn't
+  // invalidate its preferred size.
+  host_->InvalidateLayout();
 }
 
 ColumnSet* GridLayout::GetColumnSet(int id) {
@@ -1001,6 +1012,7 @@ void GridLayout::AddRow(Row* row) {
   rows_.push_back(row);
   current_row_col_set_ = row->column_set();
   SkipPaddingColumns();
+  host_->InvalidateLayout();
 }
 
 void GridLayout::UpdateRemainingHeightFromRows(ViewState* view_state) {
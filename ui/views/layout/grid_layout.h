@@ -183,7 +183,7 @@ class VIEWS_EXPORT GridLayout : public LayoutManager {
 
   virtual int GetPreferredHeightForWidth(View* host, int width) OVERRIDE;
 
-  void set_minimum_size(const gfx::Size& size) { minimum_size_ = size; }
+  void set_minimum_size(const gfx::Size& size);
 
  private:
   // As both Layout and GetPreferredSize need to do nearly the same thing,
@@ -311,7 +311,7 @@ class VIEWS_EXPORT ColumnSet {
  private:
   friend class GridLayout;
 
-  explicit ColumnSet(int id);
+  ColumnSet(View* host, int id);
 
   void AddColumn(GridLayout::Alignment h_align,
                  GridLayout::Alignment v_align,
@@ -355,6 +355,10 @@ class VIEWS_EXPORT ColumnSet {
   // Distributes delta amoung the resizable columns.
   void Resize(int delta);
 
+  // The view the GridLayout is laid out in, whose preferred size the columns
+  // change.
+  View* const host_;
+
   // ID for this columnset.
   const int id_;
 
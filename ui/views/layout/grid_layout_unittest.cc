@@ -622,3 +622,30 @@ TEST_F(GridLayoutTest, MinimumPreferredSize) {
 
   RemoveAll();
 }
+
+// Tests that changing the grid drops the preferred size its host keeps.
+TEST_F(GridLayoutTest, HostPreferredSizeFollowsGridChanges) {
+  View grid_host;
+  GridLayout* grid = new GridLayout(&grid_host);
+  grid_host.SetLayoutManager(grid);
+  // A view that is already a child isn't added to the host again.
+  View* v1 = new SettableSizeView(gfx::Size(10, 20));
+  grid_host.AddChildView(v1);
+  ColumnSet* set = grid->AddColumnSet(0);
+  set->AddColumn(GridLayout::FILL, GridLayout::FILL,
+                 0, GridLayout::USE_PREF, 0, 0);
+  grid->StartRow(0, 0);
+  EXPECT_EQ(gfx::Size(0, 0), grid_host.GetPreferredSize());
+
+  grid->AddView(v1);
+  EXPECT_EQ(gfx::Size(10, 20), grid_host.GetPreferredSize());
+
+  grid->AddPaddingRow(0, 5);
+  EXPECT_EQ(gfx::Size(10, 25), grid_host.GetPreferredSize());
+
+  grid->SetInsets(1, 2, 3, 4);
+  EXPECT_EQ(gfx::Size(16, 29), grid_host.GetPreferredSize());
+
+  grid->set_minimum_size(gfx::Size(40, 40));
+  EXPECT_EQ(gfx::Size(40, 40), grid_host.GetPreferredSize());
+}
@@ -78,66 +78,8 @@ class ImagePainter : public Painter {
       canvas->DrawImageInt(image_, 0, 0);
       return;
     }
-    // Upper left.
-    canvas->DrawImageInt(image_, 0, 0, insets_.left(), insets_.top(),
-                         0, 0, insets_.left(), insets_.top(), true);
-    // Top edge.
-    canvas->DrawImageInt(
-        image_,
-        insets_.left(), 0, image_.width() - insets_.width(), insets_.top(),
-        insets_.left(), 0, size.width() - insets_.width(), insets_.top(), true);
-    // Upper right.
-    canvas->DrawImageInt(
-        image_,
-        image_.width() - insets_.right(), 0, insets_.right(), insets_.top(),
-        size.width() - insets_.right(), 0, insets_.right(), insets_.top(),
-        true);
-    // Right edge.
-    canvas->DrawImageInt(
-        image_,
-        image_.width() - insets_.right(), insets_.top(),
-        insets_.right(), image_.height() - insets_.height(),
-        size.width() - insets_.right(), insets_.top(), insets_.right(),
-        size.height() - insets_.height(), true);
-    // Bottom right.
-    canvas->DrawImageInt(
-        image_,
-        image_.width() - insets_.right(), image_.height() - insets_.bottom(),
-        insets_.right(), insets_.bottom(),
-        size.width() - insets_.right(),
-        size.height() - insets_.bottom(), insets_.right(),
-        insets_.bottom(), true);
-    // Bottom edge.
-    canvas->DrawImageInt(
-        image_,
-        insets_.left(), image_.height() - insets_.bottom(),
-        image_.width() - insets_.width(), insets_.bottom(),
-        insets_.left(), size.height() - insets_.bottom(),
-        size.width() - insets_.width(),
-        insets_.bottom(), true);
-    // Bottom left.
-    canvas->DrawImageInt(
-        image_,
-        0, image_.height() - insets_.bottom(), insets_.left(),
-        insets_.bottom(),
-        0, size.height() - insets_.bottom(), insets_.left(), insets_.bottom(),
-        true);
-    // Left.
-    canvas->DrawImageInt(
-        image_,
-        0, insets_.top(), insets_.left(), image_.height() - insets_.height(),
-        0, insets_.top(), insets_.left(), size.height() - insets_.height(),
-        true);
-    // Center.
-    if (paint_center_) {
-      canvas->DrawImageInt(
-          image_,
-          insets_.left(), insets_.top(),
-          image_.width() - insets_.width(), image_.height() - insets_.height(),
-          insets_.left(), insets_.top(),
-          size.width() - insets_.width(), size.height() - insets_.height(),
-          true);
-    }
+    canvas->DrawImageNine(image_, insets_, 0, 0, size.width(), size.height(),
+                          paint_center_);
   }
 
  private:
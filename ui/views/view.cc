@@ -5,13 +5,16 @@
 #include "ui/views/view.h"
 
 #include <algorithm>
+#include <cmath>
 
 #include "base/debug/trace_event.h"
 #include "base/logging.h"
+#include "base/memory/arena.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop.h"
 #include "base/stringprintf.h"
 #include "base/utf_string_conversions.h"
+#include "third_party/skia/include/core/SkPicture.h"
 #include "third_party/skia/include/core/SkRect.h"
 #include "ui/base/accessibility/accessibility_types.h"
 #include "ui/base/dragdrop/drag_drop_types.h"
@@ -27,7 +30,9 @@
 #include "ui/gfx/transform.h"
 #include "ui/views/background.h"
 #include "ui/views/context_menu_controller.h"
+#include "ui/views/debug_utils.h"
 #include "ui/views/drag_controller.h"
+#include "ui/views/view_index.h"
 #include "ui/views/layout/layout_manager.h"
 #include "ui/views/views_delegate.h"
 #include "ui/views/widget/native_widget_private.h"
@@ -89,6 +94,50 @@ namespace views {
 // static
 ViewsDelegate* ViewsDelegate::views_delegate = NULL;
 
+struct View::RareData {
+  RareData()
+      : clip_insets(0, 0, 0, 0),
+        display_list_scale_x(0),
+        display_list_scale_y(0),
+        accelerator_registration_delayed(false),
+        accelerator_focus_manager(NULL),
+        registered_accelerator_count(0),
+        context_menu_controller(NULL),
+        drag_controller(NULL) {
+  }
+
+  // List of descendants wanting notification when their visible bounds change.
+  Views descendants_to_notify;
+
+  // Clipping parameters. skia transformation matrix does not give us clipping.
+  // So we do it ourselves.
+  gfx::Insets clip_insets;
+
+  // The recorded output of OnPaint(), if still valid, and the scale of the
+  // canvas it was recorded for.
+  scoped_ptr<SkPicture> display_list;
+  float display_list_scale_x;
+  float display_list_scale_y;
+
+  // true if when we were added to hierarchy we were without focus manager
+  // attempt addition when ancestor chain changed.
+  bool accelerator_registration_delayed;
+
+  // Focus manager accelerators registered on.
+  FocusManager* accelerator_focus_manager;
+
+  // The list of accelerators. List elements in the range
+  // [0, registered_accelerator_count) are already registered to FocusManager,
+  // and the rest are not yet.
+  std::vector<ui::Accelerator> accelerators;
+  size_t registered_accelerator_count;
+
+  // The menu controller.
+  ContextMenuController* context_menu_controller;
+
+  DragController* drag_controller;
+};
+
 // static
 const char View::kViewClassName[] = "views/View";
 
@@ -107,19 +156,18 @@ View::View()
       painting_enabled_(true),
       notify_enter_exit_on_child_(false),
       registered_for_visible_bounds_notification_(false),
-      clip_insets_(0, 0, 0, 0),
       needs_layout_(true),
+      preferred_size_valid_(false),
+      height_for_width_valid_(false),
+      height_for_width_width_(0),
+      height_for_width_(0),
+      records_display_list_(false),
       flip_canvas_on_paint_for_rtl_ui_(false),
       paint_to_layer_(false),
-      accelerator_registration_delayed_(false),
-      accelerator_focus_manager_(NULL),
-      registered_accelerator_count_(0),
       next_focusable_view_(NULL),
       previous_focusable_view_(NULL),
       focusable_(false),
-      accessibility_focusable_(false),
-      context_menu_controller_(NULL),
-      drag_controller_(NULL) {
+      accessibility_focusable_(false) {
 }
 
 View::~View() {
@@ -176,6 +224,7 @@ void View::AddChildViewAt(View* view, int index) {
   // Let's insert the view.
   view->parent_ = this;
   children_.insert(children_.begin() + index, view);
+  InvalidateViewIndex();
 
   for (View* v = this; v; v = v->parent_)
     v->ViewHierarchyChangedImpl(false, true, this, view);
@@ -185,6 +234,7 @@ void View::AddChildViewAt(View* view, int index) {
   if (GetWidget())
     RegisterChildrenForVisibleBoundsNotification(view);
 
+  InvalidatePreferredSize();
   if (layout_manager_.get())
     layout_manager_->ViewAdded(this, view);
 
@@ -223,6 +273,8 @@ void View::ReorderChildView(View* view, int index) {
   InitFocusSiblings(view, index);
   children_.insert(children_.begin() + index, view);
 
+  InvalidateViewIndex();
+
   if (use_acceleration_when_possible)
     ReorderLayers();
 }
@@ -362,9 +414,15 @@ gfx::Rect View::GetScreenBounds() const {
 }
 
 gfx::Size View::GetPreferredSize() {
-  if (layout_manager_.get())
-    return layout_manager_->GetPreferredSize(this);
-  return gfx::Size();
+  if (!layout_manager_.get())
+    return gfx::Size();
+  // Nested layouts ask for the preferred size of the same views several times
+  // per pass, so it is kept until the layout is invalidated.
+  if (!preferred_size_valid_) {
+    preferred_size_ = layout_manager_->GetPreferredSize(this);
+    preferred_size_valid_ = true;
+  }
+  return preferred_size_;
 }
 
 int View::GetBaseline() const {
@@ -386,9 +444,14 @@ gfx::Size View::GetMaximumSize() {
 }
 
 int View::GetHeightForWidth(int w) {
-  if (layout_manager_.get())
-    return layout_manager_->GetPreferredHeightForWidth(this, w);
-  return GetPreferredSize().height();
+  if (!layout_manager_.get())
+    return GetPreferredSize().height();
+  if (!height_for_width_valid_ || height_for_width_width_ != w) {
+    height_for_width_ = layout_manager_->GetPreferredHeightForWidth(this, w);
+    height_for_width_width_ = w;
+    height_for_width_valid_ = true;
+  }
+  return height_for_width_;
 }
 
 void View::SetVisible(bool visible) {
@@ -401,8 +464,10 @@ void View::SetVisible(bool visible) {
     visible_ = visible;
 
     // Notify the parent.
-    if (parent_)
+    if (parent_) {
+      parent_->InvalidatePreferredSize();
       parent_->ChildVisibilityChanged(this);
+    }
 
     // This notifies all sub-views recursively.
     PropagateVisibilityNotifications(this, visible_);
@@ -440,6 +505,11 @@ const ui::Transform& View::GetTransform() const {
 #endif
 }
 
+void View::set_clip_insets(gfx::Insets clip_insets) {
+  if (rare_data_.get() || clip_insets != gfx::Insets())
+    EnsureRareData()->clip_insets = clip_insets;
+}
+
 void View::SetTransform(const ui::Transform& transform) {
 #if defined(USE_UI_LAYER)
   if (!transform.HasChange()) {
@@ -539,6 +609,8 @@ void View::InvalidateLayout() {
   // Always invalidate up. This is needed to handle the case of us already being
   // valid, but not our parent.
   needs_layout_ = true;
+  preferred_size_valid_ = false;
+  height_for_width_valid_ = false;
   if (parent_)
     parent_->InvalidateLayout();
 }
@@ -547,6 +619,13 @@ LayoutManager* View::GetLayoutManager() const {
   return layout_manager_.get();
 }
 
+void View::InvalidatePreferredSize() {
+  for (View* view = this; view; view = view->parent_) {
+    view->preferred_size_valid_ = false;
+    view->height_for_width_valid_ = false;
+  }
+}
+
 void View::SetLayoutManager(LayoutManager* layout_manager) {
   if (layout_manager_.get())
     layout_manager_->Uninstalled(this);
@@ -554,6 +633,7 @@ void View::SetLayoutManager(LayoutManager* layout_manager) {
   layout_manager_.reset(layout_manager);
   if (layout_manager_.get())
     layout_manager_->Installed(this);
+  InvalidatePreferredSize();
 }
 
 // Attributes ------------------------------------------------------------------
@@ -574,6 +654,11 @@ const View* View::GetViewByID(int id) const {
   if (id == id_)
     return const_cast<View*>(this);
 
+  // Nearly all views have the default id, so it isn't indexed.
+  ViewIndex* index = id != 0 ? GetViewIndex() : NULL;
+  if (index)
+    return index->GetViewByID(this, id);
+
   for (int i = 0, count = child_count(); i < count; ++i) {
     const View* view = child_at(i)->GetViewByID(id);
     if (view)
@@ -586,10 +671,20 @@ View* View::GetViewByID(int id) {
   return const_cast<View*>(const_cast<const View*>(this)->GetViewByID(id));
 }
 
+void View::set_id(int id) {
+  if (id == id_)
+    return;
+  id_ = id;
+  InvalidateViewIndex();
+}
+
 void View::SetGroup(int gid) {
   // Don't change the group id once it's set.
   DCHECK(group_ == -1 || group_ == gid);
+  if (gid == group_)
+    return;
   group_ = gid;
+  InvalidateViewIndex();
 }
 
 int View::GetGroup() const {
@@ -601,6 +696,12 @@ bool View::IsGroupFocusTraversable() const {
 }
 
 void View::GetViewsInGroup(int group, Views* views) {
+  ViewIndex* index = group != -1 ? GetViewIndex() : NULL;
+  if (index) {
+    index->GetViewsInGroup(this, group, views);
+    return;
+  }
+
   if (group_ == group)
     views->push_back(this);
 
@@ -706,6 +807,8 @@ void View::SchedulePaint() {
 }
 
 void View::SchedulePaintInRect(const gfx::Rect& rect) {
+  InvalidateDisplayList();
+
   if (!visible_ || !painting_enabled_)
     return;
 
@@ -724,6 +827,9 @@ void View::SchedulePaintInRect(const gfx::Rect& rect) {
 void View::Paint(gfx::Canvas* canvas) {
   TRACE_EVENT0("views", "View::Paint");
 
+  // Scratch memory of the views and text drawn in this pass comes from the
+  // arena of the thread, which the outermost Paint() resets.
+  base::ScopedArenaFrame frame(base::Arena::GetForCurrentThread());
   ScopedCanvas scoped_canvas(canvas);
 
   // Paint this View and its children, setting the clip rect to the bounds
@@ -733,10 +839,7 @@ void View::Paint(gfx::Canvas* canvas) {
   // Note that the X (or left) position we pass to ClipRectInt takes into
   // consideration whether or not the view uses a right-to-left layout so that
   // we paint our view in its mirrored position if need be.
-  gfx::Rect clip_rect = bounds();
-  clip_rect.Inset(clip_insets_);
-  if (parent_)
-    clip_rect.set_x(parent_->GetMirroredXForRect(clip_rect));
+  gfx::Rect clip_rect = GetPaintClipRectInParent();
   if (!canvas->ClipRect(clip_rect))
     return;
 
@@ -748,6 +851,11 @@ void View::Paint(gfx::Canvas* canvas) {
   PaintCommon(canvas);
 }
 
+void View::SetRecordsDisplayList(bool records) {
+  records_display_list_ = records;
+  InvalidateDisplayList();
+}
+
 ThemeProvider* View::GetThemeProvider() const {
   const Widget* widget = GetWidget();
   return widget ? widget->GetThemeProvider() : NULL;
@@ -877,45 +985,46 @@ InputMethod* View::GetInputMethod() {
 // Accelerators ----------------------------------------------------------------
 
 void View::AddAccelerator(const ui::Accelerator& accelerator) {
-  if (!accelerators_.get())
-    accelerators_.reset(new std::vector<ui::Accelerator>());
-
-  if (std::find(accelerators_->begin(), accelerators_->end(), accelerator) ==
-      accelerators_->end()) {
-    accelerators_->push_back(accelerator);
+  std::vector<ui::Accelerator>& accelerators = EnsureRareData()->accelerators;
+  if (std::find(accelerators.begin(), accelerators.end(), accelerator) ==
+      accelerators.end()) {
+    accelerators.push_back(accelerator);
   }
   RegisterPendingAccelerators();
 }
 
 void View::RemoveAccelerator(const ui::Accelerator& accelerator) {
-  if (!accelerators_.get()) {
+  if (!rare_data_.get()) {
     NOTREACHED() << "Removing non-existing accelerator";
     return;
   }
 
+  std::vector<ui::Accelerator>& accelerators = rare_data_->accelerators;
   std::vector<ui::Accelerator>::iterator i(
-      std::find(accelerators_->begin(), accelerators_->end(), accelerator));
-  if (i == accelerators_->end()) {
+      std::find(accelerators.begin(), accelerators.end(), accelerator));
+  if (i == accelerators.end()) {
     NOTREACHED() << "Removing non-existing accelerator";
     return;
   }
 
-  size_t index = i - accelerators_->begin();
-  accelerators_->erase(i);
-  if (index >= registered_accelerator_count_) {
+  size_t index = i - accelerators.begin();
+  accelerators.erase(i);
+  if (index >= rare_data_->registered_accelerator_count) {
     // The accelerator is not registered to FocusManager.
     return;
   }
-  --registered_accelerator_count_;
+  --rare_data_->registered_accelerator_count;
 
   // Providing we are attached to a Widget and registered with a focus manager,
   // we should de-register from that focus manager now.
-  if (GetWidget() && accelerator_focus_manager_)
-    accelerator_focus_manager_->UnregisterAccelerator(accelerator, this);
+  if (GetWidget() && rare_data_->accelerator_focus_manager) {
+    rare_data_->accelerator_focus_manager->UnregisterAccelerator(accelerator,
+                                                                 this);
+  }
 }
 
 void View::ResetAccelerators() {
-  if (accelerators_.get())
+  if (rare_data_.get())
     UnregisterAccelerators(false);
 }
 
@@ -1000,11 +1109,21 @@ bool View::GetTooltipTextOrigin(const gfx::Point& p, gfx::Point* loc) const {
 
 // Context menus ---------------------------------------------------------------
 
+ContextMenuController* View::context_menu_controller() {
+  return rare_data_.get() ? rare_data_->context_menu_controller : NULL;
+}
+
+void View::set_context_menu_controller(ContextMenuController* menu_controller) {
+  if (rare_data_.get() || menu_controller)
+    EnsureRareData()->context_menu_controller = menu_controller;
+}
+
 void View::ShowContextMenu(const gfx::Point& p, bool is_mouse_gesture) {
-  if (!context_menu_controller_)
+  ContextMenuController* menu_controller = context_menu_controller();
+  if (!menu_controller)
     return;
 
-  context_menu_controller_->ShowContextMenuForView(this, p);
+  menu_controller->ShowContextMenuForView(this, p);
 }
 
 // Drag and drop ---------------------------------------------------------------
@@ -1101,17 +1220,20 @@ void View::VisibilityChanged(View* starting_from, bool is_visible) {
 void View::NativeViewHierarchyChanged(bool attached,
                                       gfx::NativeView native_view,
                                       internal::RootView* root_view) {
+  // Only views with accelerators have any to register again.
+  if (!rare_data_.get())
+    return;
   FocusManager* focus_manager = GetFocusManager();
-  if (!accelerator_registration_delayed_ &&
-      accelerator_focus_manager_ &&
-      accelerator_focus_manager_ != focus_manager) {
+  if (!rare_data_->accelerator_registration_delayed &&
+      rare_data_->accelerator_focus_manager &&
+      rare_data_->accelerator_focus_manager != focus_manager) {
     UnregisterAccelerators(true);
-    accelerator_registration_delayed_ = true;
+    rare_data_->accelerator_registration_delayed = true;
   }
-  if (accelerator_registration_delayed_ && attached) {
+  if (rare_data_->accelerator_registration_delayed && attached) {
     if (focus_manager) {
       RegisterPendingAccelerators();
-      accelerator_registration_delayed_ = false;
+      rare_data_->accelerator_registration_delayed = false;
     }
   }
 }
@@ -1120,11 +1242,29 @@ void View::NativeViewHierarchyChanged(bool attached,
 
 void View::PaintChildren(gfx::Canvas* canvas) {
   TRACE_EVENT0("views", "View::PaintChildren");
-  for (int i = 0, count = child_count(); i < count; ++i)
+  // The clip of the canvas is the region being repainted. Children that are
+  // entirely outside of it are skipped before Paint() saves the canvas, so
+  // long lists of children only pay for those that are repainted.
+  SkRect clip;
+  if (!canvas->sk_canvas()->getClipBounds(&clip))
+    return;
+  SkIRect rounded_clip;
+  clip.roundOut(&rounded_clip);
+  gfx::Rect dirty_rect(rounded_clip.x(), rounded_clip.y(),
+                       rounded_clip.width(), rounded_clip.height());
+
+  for (int i = 0, count = child_count(); i < count; ++i) {
+    View* child = child_at(i);
 #if defined(USE_UI_LAYER)
-    if (!child_at(i)->layer())
+    if (child->layer())
+      continue;
 #endif
-      child_at(i)->Paint(canvas);
+    if (!child->visible() ||
+        !child->GetPaintClipRectInParent().Intersects(dirty_rect)) {
+      continue;
+    }
+    child->Paint(canvas);
+  }
 }
 
 void View::OnPaint(gfx::Canvas* canvas) {
@@ -1259,6 +1399,7 @@ void View::OnPaintLayer(gfx::Canvas* canvas) {
   if (!layer() || !layer()->fills_bounds_opaquely())
     canvas->DrawColor(SK_ColorBLACK, SkXfermode::kClear_Mode);
   PaintCommon(canvas);
+  PaintRepaintOverlay(canvas);
 }
 
 void View::OnDeviceScaleFactorChanged(float device_scale_factor) {
@@ -1365,15 +1506,25 @@ gfx::Point View::GetKeyboardContextMenuLocation() {
 
 // Drag and drop ---------------------------------------------------------------
 
+DragController* View::drag_controller() {
+  return rare_data_.get() ? rare_data_->drag_controller : NULL;
+}
+
+void View::set_drag_controller(DragController* drag_controller) {
+  if (rare_data_.get() || drag_controller)
+    EnsureRareData()->drag_controller = drag_controller;
+}
+
 int View::GetDragOperations(const gfx::Point& press_pt) {
-  return drag_controller_ ?
-      drag_controller_->GetDragOperationsForView(this, press_pt) :
+  DragController* drag_controller = this->drag_controller();
+  return drag_controller ?
+      drag_controller->GetDragOperationsForView(this, press_pt) :
       ui::DragDropTypes::DRAG_NONE;
 }
 
 void View::WriteDragData(const gfx::Point& press_pt, OSExchangeData* data) {
-  DCHECK(drag_controller_);
-  drag_controller_->WriteDragDataForView(this, press_pt, data);
+  DCHECK(drag_controller());
+  drag_controller()->WriteDragDataForView(this, press_pt, data);
 }
 
 bool View::InDrag() {
@@ -1516,6 +1667,14 @@ void View::DragInfo::PossibleDrag(const gfx::Point& p) {
   start_pt = p;
 }
 
+// RareData --------------------------------------------------------------------
+
+View::RareData* View::EnsureRareData() {
+  if (!rare_data_.get())
+    rare_data_.reset(new RareData);
+  return rare_data_.get();
+}
+
 // Painting --------------------------------------------------------------------
 
 void View::SchedulePaintBoundsChanged(SchedulePaintType type) {
@@ -1557,12 +1716,66 @@ void View::PaintCommon(gfx::Canvas* canvas) {
       canvas->Scale(-1, 1);
     }
 
-    OnPaint(canvas);
+    PaintSelf(canvas);
   }
 
   PaintChildren(canvas);
 }
 
+gfx::Rect View::GetPaintClipRectInParent() const {
+  gfx::Rect clip_rect = bounds();
+  if (rare_data_.get())
+    clip_rect.Inset(rare_data_->clip_insets);
+  if (parent_)
+    clip_rect.set_x(parent_->GetMirroredXForRect(clip_rect));
+  return clip_rect;
+}
+
+void View::PaintSelf(gfx::Canvas* canvas) {
+  // The bitmaps of images are picked by the scale of the canvas, so the
+  // display list is recorded at that scale, and played back unscaled.
+  const SkMatrix& matrix = canvas->sk_canvas()->getTotalMatrix();
+  float scale_x = SkScalarToFloat(SkScalarAbs(matrix.getScaleX()));
+  float scale_y = SkScalarToFloat(SkScalarAbs(matrix.getScaleY()));
+  if (!records_display_list_ || bounds_.IsEmpty() || scale_x == 0 ||
+      scale_y == 0) {
+    OnPaint(canvas);
+    return;
+  }
+
+  RareData* rare_data = EnsureRareData();
+  scoped_ptr<SkPicture>& display_list = rare_data->display_list;
+  if (display_list.get() && (rare_data->display_list_scale_x != scale_x ||
+                             rare_data->display_list_scale_y != scale_y)) {
+    display_list.reset();
+  }
+  if (!display_list.get()) {
+    TRACE_EVENT0("views", "View::RecordDisplayList");
+    display_list.reset(new SkPicture);
+    SkCanvas* recording_canvas = display_list->beginRecording(
+        static_cast<int>(std::ceil(width() * scale_x)),
+        static_cast<int>(std::ceil(height() * scale_y)));
+    recording_canvas->scale(SkFloatToScalar(scale_x),
+                            SkFloatToScalar(scale_y));
+    gfx::Canvas recording(recording_canvas);
+    OnPaint(&recording);
+    display_list->endRecording();
+    rare_data->display_list_scale_x = scale_x;
+    rare_data->display_list_scale_y = scale_y;
+  }
+
+  canvas->sk_canvas()->save();
+  canvas->sk_canvas()->scale(SkFloatToScalar(1.0f / scale_x),
+                             SkFloatToScalar(1.0f / scale_y));
+  canvas->sk_canvas()->drawPicture(*display_list);
+  canvas->sk_canvas()->restore();
+}
+
+void View::InvalidateDisplayList() {
+  if (rare_data_.get())
+    rare_data_->display_list.reset();
+}
+
 // Tree operations -------------------------------------------------------------
 
 void View::DoRemoveChildView(View* view,
@@ -1593,15 +1806,34 @@ void View::DoRemoveChildView(View* view,
       view_to_be_deleted.reset(view);
 
     children_.erase(i);
+    InvalidateViewIndex();
   }
 
   if (update_tool_tip)
     UpdateTooltip();
 
+  InvalidatePreferredSize();
   if (layout_manager_.get())
     layout_manager_->ViewRemoved(this, view);
 }
 
+ViewIndex* View::GetViewIndex() const {
+  const View* top = this;
+  while (top->parent_)
+    top = top->parent_;
+  // Only the RootView of a Widget has the Widget without having a parent.
+  const Widget* widget = top->GetWidget();
+  if (!widget || widget->GetRootView() != top)
+    return NULL;
+  return &static_cast<const internal::RootView*>(top)->view_index_;
+}
+
+void View::InvalidateViewIndex() {
+  ViewIndex* index = GetViewIndex();
+  if (index)
+    index->Invalidate();
+}
+
 void View::PropagateRemoveNotifications(View* parent) {
   for (int i = 0, count = child_count(); i < count; ++i)
     child_at(i)->PropagateRemoveNotifications(parent);
@@ -1633,13 +1865,16 @@ void View::ViewHierarchyChangedImpl(bool register_accelerators,
   if (register_accelerators) {
     if (is_add) {
       // If you get this registration, you are part of a subtree that has been
-      // added to the view hierarchy.
-      if (GetFocusManager()) {
+      // added to the view hierarchy. Views without accelerators don't ask for
+      // the focus manager, which some widgets only create when it is needed.
+      if (!rare_data_.get() || rare_data_->accelerators.empty()) {
+        // Nothing to register.
+      } else if (GetFocusManager()) {
         RegisterPendingAccelerators();
       } else {
         // Delay accelerator registration until visible as we do not have
         // focus manager until then.
-        accelerator_registration_delayed_ = true;
+        rare_data_->accelerator_registration_delayed = true;
       }
     } else {
       if (child == this)
@@ -1682,6 +1917,9 @@ void View::VisibilityChangedImpl(View* starting_from, bool is_visible) {
 }
 
 void View::BoundsChanged(const gfx::Rect& previous_bounds) {
+  if (bounds_.size() != previous_bounds.size())
+    InvalidateDisplayList();
+
   if (visible_) {
     // Paint the new bounds.
     SchedulePaintBoundsChanged(
@@ -1730,9 +1968,10 @@ void View::BoundsChanged(const gfx::Rect& previous_bounds) {
 
   // Notify interested Views that visible bounds within the root view may have
   // changed.
-  if (descendants_to_notify_.get()) {
-    for (Views::iterator i(descendants_to_notify_->begin());
-         i != descendants_to_notify_->end(); ++i) {
+  if (rare_data_.get()) {
+    const Views& descendants = rare_data_->descendants_to_notify;
+    for (Views::const_iterator i(descendants.begin()); i != descendants.end();
+         ++i) {
       (*i)->OnVisibleBoundsChanged();
     }
   }
@@ -1774,19 +2013,15 @@ void View::UnregisterForVisibleBoundsNotification() {
 
 void View::AddDescendantToNotify(View* view) {
   DCHECK(view);
-  if (!descendants_to_notify_.get())
-    descendants_to_notify_.reset(new Views);
-  descendants_to_notify_->push_back(view);
+  EnsureRareData()->descendants_to_notify.push_back(view);
 }
 
 void View::RemoveDescendantToNotify(View* view) {
-  DCHECK(view && descendants_to_notify_.get());
-  Views::iterator i(std::find(
-      descendants_to_notify_->begin(), descendants_to_notify_->end(), view));
-  DCHECK(i != descendants_to_notify_->end());
-  descendants_to_notify_->erase(i);
-  if (descendants_to_notify_->empty())
-    descendants_to_notify_.reset();
+  DCHECK(view && rare_data_.get());
+  Views& descendants = rare_data_->descendants_to_notify;
+  Views::iterator i(std::find(descendants.begin(), descendants.end(), view));
+  DCHECK(i != descendants.end());
+  descendants.erase(i);
 }
 
 void View::SetLayerBounds(const gfx::Rect& bounds) {
@@ -1959,7 +2194,7 @@ bool View::ProcessMousePressed(const MouseEvent& event, DragInfo* drag_info) {
       (enabled_ && event.IsOnlyLeftMouseButton() && HitTest(event.location())) ?
       GetDragOperations(event.location()) : 0;
   ContextMenuController* context_menu_controller = event.IsRightMouseButton() ?
-      context_menu_controller_ : 0;
+      this->context_menu_controller() : 0;
 
   const bool enabled = enabled_;
   const bool result = OnMousePressed(event);
@@ -1978,13 +2213,15 @@ bool View::ProcessMousePressed(const MouseEvent& event, DragInfo* drag_info) {
 bool View::ProcessMouseDragged(const MouseEvent& event, DragInfo* drag_info) {
   // Copy the field, that way if we're deleted after drag and drop no harm is
   // done.
-  ContextMenuController* context_menu_controller = context_menu_controller_;
+  ContextMenuController* context_menu_controller =
+      this->context_menu_controller();
+  DragController* drag_controller = this->drag_controller();
   const bool possible_drag = drag_info->possible_drag;
   if (possible_drag && ExceededDragThreshold(
       drag_info->start_pt.x() - event.x(),
       drag_info->start_pt.y() - event.y())) {
-    if (!drag_controller_ ||
-        drag_controller_->CanStartDragForView(
+    if (!drag_controller ||
+        drag_controller->CanStartDragForView(
             this, drag_info->start_pt, event.location()))
       DoDrag(event, drag_info->start_pt);
   } else {
@@ -1997,7 +2234,7 @@ bool View::ProcessMouseDragged(const MouseEvent& event, DragInfo* drag_info) {
 }
 
 void View::ProcessMouseReleased(const MouseEvent& event) {
-  if (context_menu_controller_ && event.IsOnlyRightMouseButton()) {
+  if (context_menu_controller() && event.IsOnlyRightMouseButton()) {
     // Assume that if there is a context menu controller we won't be deleted
     // from mouse released.
     gfx::Point location(event.location());
@@ -2019,7 +2256,8 @@ ui::TouchStatus View::ProcessTouchEvent(const TouchEvent& event) {
 }
 
 ui::GestureStatus View::ProcessGestureEvent(const GestureEvent& event) {
-  if (context_menu_controller_ && event.type() == ui::ET_GESTURE_LONG_PRESS) {
+  if (context_menu_controller() &&
+      event.type() == ui::ET_GESTURE_LONG_PRESS) {
     gfx::Point location(event.location());
     ConvertPointToScreen(this, &location);
     ShowContextMenu(location, true);
@@ -2031,8 +2269,9 @@ ui::GestureStatus View::ProcessGestureEvent(const GestureEvent& event) {
 // Accelerators ----------------------------------------------------------------
 
 void View::RegisterPendingAccelerators() {
-  if (!accelerators_.get() ||
-      registered_accelerator_count_ == accelerators_->size()) {
+  if (!rare_data_.get() ||
+      rare_data_->registered_accelerator_count ==
+          rare_data_->accelerators.size()) {
     // No accelerators are waiting for registration.
     return;
   }
@@ -2042,40 +2281,40 @@ void View::RegisterPendingAccelerators() {
     return;
   }
 
-  accelerator_focus_manager_ = GetFocusManager();
-  if (!accelerator_focus_manager_) {
+  FocusManager* focus_manager = GetFocusManager();
+  rare_data_->accelerator_focus_manager = focus_manager;
+  if (!focus_manager) {
     // Some crash reports seem to show that we may get cases where we have no
     // focus manager (see bug #1291225).  This should never be the case, just
     // making sure we don't crash.
     NOTREACHED();
     return;
   }
+  const std::vector<ui::Accelerator>& accelerators = rare_data_->accelerators;
   for (std::vector<ui::Accelerator>::const_iterator i(
-           accelerators_->begin() + registered_accelerator_count_);
-       i != accelerators_->end(); ++i) {
-    accelerator_focus_manager_->RegisterAccelerator(
+           accelerators.begin() + rare_data_->registered_accelerator_count);
+       i != accelerators.end(); ++i) {
+    focus_manager->RegisterAccelerator(
         *i, ui::AcceleratorManager::kNormalPriority, this);
   }
-  registered_accelerator_count_ = accelerators_->size();
+  rare_data_->registered_accelerator_count = accelerators.size();
 }
 
 void View::UnregisterAccelerators(bool leave_data_intact) {
-  if (!accelerators_.get())
+  if (!rare_data_.get())
     return;
 
   if (GetWidget()) {
-    if (accelerator_focus_manager_) {
+    if (rare_data_->accelerator_focus_manager) {
       // We may not have a FocusManager if the window containing us is being
       // closed, in which case the FocusManager is being deleted so there is
       // nothing to unregister.
-      accelerator_focus_manager_->UnregisterAccelerators(this);
-      accelerator_focus_manager_ = NULL;
-    }
-    if (!leave_data_intact) {
-      accelerators_->clear();
-      accelerators_.reset();
+      rare_data_->accelerator_focus_manager->UnregisterAccelerators(this);
+      rare_data_->accelerator_focus_manager = NULL;
     }
-    registered_accelerator_count_ = 0;
+    if (!leave_data_intact)
+      rare_data_->accelerators.clear();
+    rare_data_->registered_accelerator_count = 0;
   }
 }
 
@@ -2128,12 +2367,16 @@ void View::InitFocusSiblings(View* v, int index) {
 void View::PropagateThemeChanged() {
   for (int i = child_count() - 1; i >= 0; --i)
     child_at(i)->PropagateThemeChanged();
+  InvalidateDisplayList();
+  InvalidatePreferredSize();
   OnThemeChanged();
 }
 
 void View::PropagateLocaleChanged() {
   for (int i = child_count() - 1; i >= 0; --i)
     child_at(i)->PropagateLocaleChanged();
+  InvalidateDisplayList();
+  InvalidatePreferredSize();
   OnLocaleChanged();
 }
 
@@ -67,6 +67,7 @@ class FocusTraversable;
 class InputMethod;
 class LayoutManager;
 class ScrollView;
+class ViewIndex;
 class Widget;
 
 namespace internal {
@@ -222,6 +223,9 @@ class VIEWS_EXPORT View :
   virtual int GetBaseline() const;
 
   // Get the size the View would like to be, if enough space were available.
+  // View's implementation asks the layout manager, and keeps the answer until
+  // the layout of the view or of one of its descendants is invalidated, or
+  // its children, their visibility, its border or its layout manager change.
   virtual gfx::Size GetPreferredSize();
 
   // Convenience method that sizes this view to its preferred size.
@@ -238,7 +242,8 @@ class VIEWS_EXPORT View :
   // Return the height necessary to display this view with the provided width.
   // View's implementation returns the value from getPreferredSize.cy.
   // Override if your View's preferred height depends upon the width (such
-  // as with Labels).
+  // as with Labels). The answer of the layout manager for the last width is
+  // kept like the preferred size.
   virtual int GetHeightForWidth(int w);
 
   // Set whether this view is visible. Painting is scheduled as needed.
@@ -272,7 +277,7 @@ class VIEWS_EXPORT View :
   const ui::Transform& GetTransform() const;
 
   // Clipping parameters. Clipping is done relative to the view bounds.
-  void set_clip_insets(gfx::Insets clip_insets) { clip_insets_ = clip_insets; }
+  void set_clip_insets(gfx::Insets clip_insets);
 
   // Sets the transform to the supplied transform.
   void SetTransform(const ui::Transform& transform);
@@ -376,14 +381,15 @@ class VIEWS_EXPORT View :
 
   // Recursively descends the view tree starting at this view, and returns
   // the first child that it encounters that has the given ID.
-  // Returns NULL if no matching child view is found.
+  // Returns NULL if no matching child view is found. Views in a Widget are
+  // found through the index of the RootView rather than by walking the tree.
   virtual const View* GetViewByID(int id) const;
   virtual View* GetViewByID(int id);
 
   // Gets and sets the ID for this view. ID should be unique within the subtree
   // that you intend to search for it. 0 is the default ID for views.
   int id() const { return id_; }
-  void set_id(int id) { id_ = id; }
+  void set_id(int id);
 
   // A group id is used to tag views which are part of the same logical group.
   // Focus can be moved between views with the same group using the arrow keys.
@@ -461,13 +467,30 @@ class VIEWS_EXPORT View :
   // the hierarchy beneath it.
   virtual void Paint(gfx::Canvas* canvas);
 
+  // Whether the output of OnPaint() is recorded into a display list, which
+  // later paints play back instead of calling OnPaint() again. The display list
+  // is dropped when the view schedules a paint of itself, or when its size,
+  // background, border, theme or locale changes. Only suits views that call
+  // SchedulePaint() on themselves whenever what they paint changes, and that
+  // paint within their bounds. The children are painted as usual. Off by
+  // default.
+  void SetRecordsDisplayList(bool records);
+  bool records_display_list() const { return records_display_list_; }
+
   // The background object is owned by this object and may be NULL.
-  void set_background(Background* b) { background_.reset(b); }
+  void set_background(Background* b) {
+    background_.reset(b);
+    InvalidateDisplayList();
+  }
   const Background* background() const { return background_.get(); }
   Background* background() { return background_.get(); }
 
   // The border object is owned by this object and may be NULL.
-  void set_border(Border* b) { border_.reset(b); }
+  void set_border(Border* b) {
+    border_.reset(b);
+    InvalidateDisplayList();
+    InvalidatePreferredSize();
+  }
   const Border* border() const { return border_.get(); }
   Border* border() { return border_.get(); }
 
@@ -762,12 +785,8 @@ class VIEWS_EXPORT View :
 
   // Sets the ContextMenuController. Setting this to non-null makes the View
   // process mouse events.
-  ContextMenuController* context_menu_controller() {
-    return context_menu_controller_;
-  }
-  void set_context_menu_controller(ContextMenuController* menu_controller) {
-    context_menu_controller_ = menu_controller;
-  }
+  ContextMenuController* context_menu_controller();
+  void set_context_menu_controller(ContextMenuController* menu_controller);
 
   // Provides default implementation for context menu handling. The default
   // implementation calls the ShowContextMenu of the current
@@ -779,10 +798,8 @@ class VIEWS_EXPORT View :
 
   // Drag and drop -------------------------------------------------------------
 
-  DragController* drag_controller() { return drag_controller_; }
-  void set_drag_controller(DragController* drag_controller) {
-    drag_controller_ = drag_controller;
-  }
+  DragController* drag_controller();
+  void set_drag_controller(DragController* drag_controller);
 
   // During a drag and drop session when the mouse moves the view under the
   // mouse is queried for the drop types it supports by way of the
@@ -1137,6 +1154,13 @@ class VIEWS_EXPORT View :
     gfx::Point start_pt;
   };
 
+  // The members most views never set, allocated by EnsureRareData() when one
+  // of them is first set. Keeps views small and cheap to create.
+  struct RareData;
+
+  // Returns |rare_data_|, allocating it if needed.
+  RareData* EnsureRareData();
+
   // Painting  -----------------------------------------------------------------
 
   enum SchedulePaintType {
@@ -1155,6 +1179,17 @@ class VIEWS_EXPORT View :
   // invoke OnPaint() on the View.
   void PaintCommon(gfx::Canvas* canvas);
 
+  // Returns the rect, in the parent's coordinates, that Paint() clips this
+  // view to. Nothing the view or its children paint lands outside of it.
+  gfx::Rect GetPaintClipRectInParent() const;
+
+  // Calls OnPaint(), or plays back the display list recorded from it when the
+  // view records one.
+  void PaintSelf(gfx::Canvas* canvas);
+
+  // Drops the recorded display list, so that the next paint calls OnPaint().
+  void InvalidateDisplayList();
+
   // Tree operations -----------------------------------------------------------
 
   // Removes |view| from the hierarchy tree.  If |update_focus_cycle| is true,
@@ -1167,6 +1202,14 @@ class VIEWS_EXPORT View :
                          bool update_tool_tip,
                          bool delete_removed_view);
 
+  // Returns the index of the views of the RootView this view is in, or NULL
+  // if this view isn't in a Widget.
+  ViewIndex* GetViewIndex() const;
+
+  // Invalidates the index of the views of the RootView this view is in, if
+  // any.
+  void InvalidateViewIndex();
+
   // Call ViewHierarchyChanged for all child views on all parents
   void PropagateRemoveNotifications(View* parent);
 
@@ -1199,6 +1242,10 @@ class VIEWS_EXPORT View :
   // views.
   void BoundsChanged(const gfx::Rect& previous_bounds);
 
+  // Drops the preferred size kept by this view and its ancestors, for changes
+  // that affect it without invalidating the layout.
+  void InvalidatePreferredSize();
+
   // Visible bounds notification registration.
   // When a view is added to a hierarchy, it and all its children are asked if
   // they need to be registered for "visible bounds within root" notifications
@@ -1301,7 +1348,7 @@ class VIEWS_EXPORT View :
   void RegisterPendingAccelerators();
 
   // Unregisters all the keyboard accelerators associated with this view.
-  // |leave_data_intact| if true does not remove data from accelerators_ array,
+  // |leave_data_intact| if true does not remove data from the accelerators,
   // so it could be re-registered with other focus manager
   void UnregisterAccelerators(bool leave_data_intact);
 
@@ -1398,20 +1445,19 @@ class VIEWS_EXPORT View :
   // has been invoked.
   bool registered_for_visible_bounds_notification_;
 
-  // List of descendants wanting notification when their visible bounds change.
-  scoped_ptr<Views> descendants_to_notify_;
-
-  // Transformations -----------------------------------------------------------
-
-  // Clipping parameters. skia transformation matrix does not give us clipping.
-  // So we do it ourselves.
-  gfx::Insets clip_insets_;
-
   // Layout --------------------------------------------------------------------
 
   // Whether the view needs to be laid out.
   bool needs_layout_;
 
+  // The preferred size, and the preferred height for |height_for_width_width_|,
+  // answered by the layout manager, if still valid.
+  bool preferred_size_valid_;
+  gfx::Size preferred_size_;
+  bool height_for_width_valid_;
+  int height_for_width_width_;
+  int height_for_width_;
+
   // The View's LayoutManager defines the sizing heuristics applied to child
   // Views. The default is absolute positioning according to bounds_.
   scoped_ptr<LayoutManager> layout_manager_;
@@ -1424,6 +1470,9 @@ class VIEWS_EXPORT View :
   // Border.
   scoped_ptr<Border> border_;
 
+  // Whether the output of OnPaint() is recorded, see SetRecordsDisplayList().
+  bool records_display_list_;
+
   // RTL painting --------------------------------------------------------------
 
   // Indicates whether or not the gfx::Canvas object passed to View::Paint()
@@ -1435,21 +1484,6 @@ class VIEWS_EXPORT View :
 
   bool paint_to_layer_;
 
-  // Accelerators --------------------------------------------------------------
-
-  // true if when we were added to hierarchy we were without focus manager
-  // attempt addition when ancestor chain changed.
-  bool accelerator_registration_delayed_;
-
-  // Focus manager accelerators registered on.
-  FocusManager* accelerator_focus_manager_;
-
-  // The list of accelerators. List elements in the range
-  // [0, registered_accelerator_count_) are already registered to FocusManager,
-  // and the rest are not yet.
-  scoped_ptr<std::vector<ui::Accelerator> > accelerators_;
-  size_t registered_accelerator_count_;
-
   // Focus ---------------------------------------------------------------------
 
   // Next view to be focused when the Tab key is pressed.
@@ -1465,14 +1499,12 @@ class VIEWS_EXPORT View :
   // even though it may not be normally focusable.
   bool accessibility_focusable_;
 
-  // Context menus -------------------------------------------------------------
-
-  // The menu controller.
-  ContextMenuController* context_menu_controller_;
-
-  // Drag and drop -------------------------------------------------------------
+  // Rarely used members ------------------------------------------------------
 
-  DragController* drag_controller_;
+  // The accelerators, the descendants to notify of visible bounds changes,
+  // the clip insets, the display list and the context menu and drag
+  // controllers, or NULL if none was ever set.
+  scoped_ptr<RareData> rare_data_;
 
   // Accessibility -------------------------------------------------------------
 
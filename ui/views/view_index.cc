@@ -0,0 +1,91 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/views/view_index.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "ui/views/view.h"
+
+namespace views {
+
+ViewIndex::ViewIndex(View* root) : root_(root), valid_(false) {
+}
+
+ViewIndex::~ViewIndex() {
+}
+
+void ViewIndex::Invalidate() {
+  if (!valid_)
+    return;
+  valid_ = false;
+  subtrees_.clear();
+  ids_.clear();
+  groups_.clear();
+}
+
+View* ViewIndex::GetViewByID(const View* view, int id) {
+  DCHECK_NE(0, id);
+  EnsureBuilt();
+  EntriesMap::const_iterator i = ids_.find(id);
+  if (i == ids_.end())
+    return NULL;
+  std::pair<Entries::const_iterator, Entries::const_iterator> range =
+      GetSubtreeRange(i->second, view);
+  return range.first == range.second ? NULL : range.first->second;
+}
+
+void ViewIndex::GetViewsInGroup(const View* view,
+                                int group,
+                                std::vector<View*>* views) {
+  DCHECK_NE(-1, group);
+  EnsureBuilt();
+  EntriesMap::const_iterator i = groups_.find(group);
+  if (i == groups_.end())
+    return;
+  std::pair<Entries::const_iterator, Entries::const_iterator> range =
+      GetSubtreeRange(i->second, view);
+  for (Entries::const_iterator j = range.first; j != range.second; ++j)
+    views->push_back(j->second);
+}
+
+void ViewIndex::EnsureBuilt() {
+  if (valid_)
+    return;
+  int position = 0;
+  AddSubtree(root_, &position);
+  valid_ = true;
+}
+
+void ViewIndex::AddSubtree(View* view, int* position) {
+  int start = (*position)++;
+  if (view->id() != 0)
+    ids_[view->id()].push_back(Entry(start, view));
+  if (view->GetGroup() != -1)
+    groups_[view->GetGroup()].push_back(Entry(start, view));
+  for (int i = 0, count = view->child_count(); i < count; ++i)
+    AddSubtree(view->child_at(i), position);
+  subtrees_[view] = std::make_pair(start, *position);
+}
+
+std::pair<ViewIndex::Entries::const_iterator,
+          ViewIndex::Entries::const_iterator>
+ViewIndex::GetSubtreeRange(const Entries& entries, const View* view) const {
+  std::map<const View*, std::pair<int, int> >::const_iterator i =
+      subtrees_.find(view);
+  if (i == subtrees_.end()) {
+    NOTREACHED() << "The view is not in the tree";
+    return std::make_pair(entries.end(), entries.end());
+  }
+  // The entries are sorted by position, and no view shares a position.
+  Entries::const_iterator first = std::lower_bound(
+      entries.begin(), entries.end(),
+      Entry(i->second.first, static_cast<View*>(NULL)));
+  Entries::const_iterator last = std::lower_bound(
+      first, entries.end(), Entry(i->second.second, static_cast<View*>(NULL)));
+  return std::make_pair(first, last);
+}
+
+}  // namespace views
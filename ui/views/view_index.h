@@ -0,0 +1,82 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_VIEWS_VIEW_INDEX_H_
+#define UI_VIEWS_VIEW_INDEX_H_
+#pragma once
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "ui/views/views_export.h"
+
+namespace views {
+
+class View;
+
+// ViewIndex finds the views of a tree by id and by group without walking the
+// tree. Each RootView keeps one, so that View::GetViewByID() and
+// View::GetViewsInGroup(), which focus traversal calls for each view of a
+// group it passes, don't cost a walk of the whole hierarchy of the widget.
+//
+// The index is built the first time it is used after being invalidated. It
+// must be invalidated when views are added to, removed from or reordered in
+// the tree, and when their ids or groups change. Views with the default id
+// (0) and views with no group (-1) are not indexed.
+class VIEWS_EXPORT ViewIndex {
+ public:
+  explicit ViewIndex(View* root);
+  ~ViewIndex();
+
+  // Forgets the index. It is rebuilt when next used.
+  void Invalidate();
+
+  // Returns the first view with id |id| in the subtree rooted at |view|, in
+  // the order View::GetViewByID() searches it. |view| must be in the tree and
+  // |id| must not be 0.
+  View* GetViewByID(const View* view, int id);
+
+  // Appends to |views| the views of the subtree rooted at |view| whose group
+  // is |group|, in the order of the tree. |view| must be in the tree and
+  // |group| must not be -1.
+  void GetViewsInGroup(const View* view, int group, std::vector<View*>* views);
+
+ private:
+  // The position of a view in a depth first walk of the tree, and the view.
+  typedef std::pair<int, View*> Entry;
+  typedef std::vector<Entry> Entries;
+  typedef std::map<int, Entries> EntriesMap;
+
+  // Rebuilds the index if it has been invalidated.
+  void EnsureBuilt();
+
+  // Adds |view| and its descendants, numbering them from |*position|.
+  void AddSubtree(View* view, int* position);
+
+  // Returns the range of entries of |entries| that are in the subtree rooted
+  // at |view|.
+  std::pair<Entries::const_iterator, Entries::const_iterator> GetSubtreeRange(
+      const Entries& entries,
+      const View* view) const;
+
+  View* root_;
+
+  bool valid_;
+
+  // Maps each view to its position in the walk and to the position that
+  // follows its last descendant.
+  std::map<const View*, std::pair<int, int> > subtrees_;
+
+  // The views with each id and group, sorted by their position.
+  EntriesMap ids_;
+  EntriesMap groups_;
+
+  DISALLOW_COPY_AND_ASSIGN(ViewIndex);
+};
+
+}  // namespace views
+
+#endif  // UI_VIEWS_VIEW_INDEX_H_
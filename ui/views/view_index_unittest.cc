@@ -0,0 +1,83 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/views/view_index.h"
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/views/view.h"
+
+namespace views {
+
+namespace {
+
+View* AddChild(View* parent, int id, int group) {
+  View* child = new View;
+  child->set_id(id);
+  if (group != -1)
+    child->SetGroup(group);
+  parent->AddChildView(child);
+  return child;
+}
+
+}  // namespace
+
+// Verifies the index finds the same views as walking the tree.
+TEST(ViewIndexTest, MatchesTreeWalk) {
+  View root;
+  View* a = AddChild(&root, 1, 10);
+  View* a1 = AddChild(a, 2, 10);
+  View* a2 = AddChild(a, 3, -1);
+  View* b = AddChild(&root, 2, 10);
+  View* b1 = AddChild(b, 3, 11);
+
+  ViewIndex index(&root);
+  EXPECT_EQ(a, index.GetViewByID(&root, 1));
+  EXPECT_EQ(a1, index.GetViewByID(&root, 2));
+  EXPECT_EQ(a2, index.GetViewByID(&root, 3));
+  EXPECT_EQ(b, index.GetViewByID(b, 2));
+  EXPECT_EQ(b1, index.GetViewByID(b, 3));
+  EXPECT_TRUE(index.GetViewByID(b, 1) == NULL);
+  EXPECT_TRUE(index.GetViewByID(a1, 3) == NULL);
+  EXPECT_TRUE(index.GetViewByID(&root, 4) == NULL);
+
+  std::vector<View*> views;
+  index.GetViewsInGroup(&root, 10, &views);
+  ASSERT_EQ(3u, views.size());
+  EXPECT_EQ(a, views[0]);
+  EXPECT_EQ(a1, views[1]);
+  EXPECT_EQ(b, views[2]);
+
+  views.clear();
+  index.GetViewsInGroup(b, 10, &views);
+  ASSERT_EQ(1u, views.size());
+  EXPECT_EQ(b, views[0]);
+
+  views.clear();
+  index.GetViewsInGroup(a, 11, &views);
+  EXPECT_TRUE(views.empty());
+}
+
+// Verifies the index only sees changes to the tree once invalidated.
+TEST(ViewIndexTest, Invalidate) {
+  View root;
+  View* a = AddChild(&root, 1, -1);
+  ViewIndex index(&root);
+  EXPECT_EQ(a, index.GetViewByID(&root, 1));
+
+  View* b = AddChild(&root, 2, -1);
+  root.ReorderChildView(b, 0);
+  a->set_id(2);
+  index.Invalidate();
+  EXPECT_EQ(b, index.GetViewByID(&root, 2));
+  EXPECT_TRUE(index.GetViewByID(&root, 1) == NULL);
+
+  root.RemoveChildView(b);
+  delete b;
+  index.Invalidate();
+  EXPECT_EQ(a, index.GetViewByID(&root, 2));
+}
+
+}  // namespace views
@@ -0,0 +1,57 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/scoped_ptr.h"
+#include "base/perftimer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/views/layout/box_layout.h"
+#include "ui/views/view.h"
+
+namespace views {
+
+namespace {
+
+// Views are made in groups of kViewsPerGroup, the way dialogs lay out rows of
+// controls, kViews in all.
+const int kViews = 10000;
+const int kViewsPerGroup = 100;
+
+// Makes a tree of kViews views laid out in boxes.
+View* CreateViewTree() {
+  View* root = new View;
+  root->SetLayoutManager(new BoxLayout(BoxLayout::kVertical, 0, 0, 0));
+  for (int i = 0; i < kViews / kViewsPerGroup; ++i) {
+    View* group = new View;
+    group->SetLayoutManager(new BoxLayout(BoxLayout::kHorizontal, 0, 0, 0));
+    root->AddChildView(group);
+    for (int j = 0; j < kViewsPerGroup - 1; ++j)
+      group->AddChildView(new View);
+  }
+  return root;
+}
+
+}  // namespace
+
+// Logs the cost of creating, laying out and destroying kViews views.
+TEST(ViewPerfTest, CreateLayoutDestroy) {
+  LogPerfResult("View_size", sizeof(View), "bytes");
+
+  PerfTimer timer;
+  scoped_ptr<View> root(CreateViewTree());
+  LogPerfResult("View_create_10k", timer.Elapsed().InMillisecondsF(), "ms");
+
+  PerfTimer layout_timer;
+  root->SetBounds(0, 0, 1000, 1000);
+  root->Layout();
+  LogPerfResult("View_layout_10k", layout_timer.Elapsed().InMillisecondsF(),
+                "ms");
+  EXPECT_EQ(kViews / kViewsPerGroup, root->child_count());
+
+  PerfTimer destroy_timer;
+  root.reset();
+  LogPerfResult("View_destroy_10k", destroy_timer.Elapsed().InMillisecondsF(),
+                "ms");
+}
+
+}  // namespace views
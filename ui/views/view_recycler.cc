@@ -0,0 +1,124 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/views/view_recycler.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/stl_util.h"
+#include "ui/views/view.h"
+
+namespace views {
+
+ViewRecycler::ViewRecycler(View* parent, Delegate* delegate)
+    : parent_(parent),
+      delegate_(delegate),
+      start_(0) {
+}
+
+ViewRecycler::~ViewRecycler() {
+  // The views in the range are owned by the parent.
+  STLDeleteElements(&pool_);
+}
+
+void ViewRecycler::SetRange(int start, int end) {
+  DCHECK_LE(start, end);
+  if (start == start_ && end == this->end())
+    return;
+
+  std::vector<View*> views(end - start, static_cast<View*>(NULL));
+  for (size_t i = 0; i < views_.size(); ++i) {
+    int index = start_ + static_cast<int>(i);
+    if (index >= start && index < end)
+      views[index - start] = views_[i];
+    else
+      Recycle(views_[i]);
+  }
+  for (size_t i = 0; i < views.size(); ++i) {
+    if (!views[i])
+      views[i] = GetBoundView(start + static_cast<int>(i));
+  }
+  views_.swap(views);
+  start_ = start;
+}
+
+View* ViewRecycler::GetViewForIndex(int index) const {
+  if (index < start_ || index >= end())
+    return NULL;
+  return views_[index - start_];
+}
+
+int ViewRecycler::GetIndexOfView(const View* view) const {
+  std::vector<View*>::const_iterator i =
+      std::find(views_.begin(), views_.end(), view);
+  return i == views_.end() ? -1 : start_ + static_cast<int>(i - views_.begin());
+}
+
+void ViewRecycler::ItemsAdded(int start, int count) {
+  if (start < start_ || (start == start_ && views_.empty())) {
+    start_ += count;
+    return;
+  }
+  if (start > end())
+    return;
+
+  std::vector<View*> added;
+  for (int i = 0; i < count; ++i)
+    added.push_back(GetBoundView(start + i));
+  views_.insert(views_.begin() + (start - start_), added.begin(), added.end());
+}
+
+void ViewRecycler::ItemsRemoved(int start, int count) {
+  int removed_start = std::max(start, start_);
+  int removed_end = std::min(start + count, end());
+  if (removed_start < removed_end) {
+    std::vector<View*>::iterator first =
+        views_.begin() + (removed_start - start_);
+    std::vector<View*>::iterator last = views_.begin() + (removed_end - start_);
+    for (std::vector<View*>::iterator i = first; i != last; ++i)
+      Recycle(*i);
+    views_.erase(first, last);
+  }
+  // Items before the range shift it back.
+  start_ -= std::max(0, std::min(start + count, start_) - start);
+}
+
+void ViewRecycler::ItemsChanged(int start, int count) {
+  int changed_start = std::max(start, start_);
+  int changed_end = std::min(start + count, end());
+  for (int index = changed_start; index < changed_end; ++index) {
+    View* view = views_[index - start_];
+    delegate_->UnbindView(view);
+    delegate_->BindView(view, index);
+  }
+}
+
+void ViewRecycler::Clear() {
+  for (size_t i = 0; i < views_.size(); ++i)
+    Recycle(views_[i]);
+  views_.clear();
+  start_ = 0;
+}
+
+View* ViewRecycler::GetBoundView(int index) {
+  View* view;
+  if (pool_.empty()) {
+    view = delegate_->CreateRecyclableView();
+  } else {
+    view = pool_.back();
+    pool_.pop_back();
+  }
+  delegate_->BindView(view, index);
+  parent_->AddChildView(view);
+  return view;
+}
+
+void ViewRecycler::Recycle(View* view) {
+  delegate_->UnbindView(view);
+  parent_->RemoveChildView(view);
+  pool_.push_back(view);
+}
+
+}  // namespace views
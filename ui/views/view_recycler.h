@@ -0,0 +1,104 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_VIEWS_VIEW_RECYCLER_H_
+#define UI_VIEWS_VIEW_RECYCLER_H_
+#pragma once
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "ui/views/views_export.h"
+
+namespace views {
+
+class View;
+
+// ViewRecycler shows the items of a list with views, but only keeps views for
+// a range of the items, typically the ones that are visible. As the range
+// moves, the views of items that leave it are removed from the parent and
+// kept in a pool, and are rebound to the items that enter it. This way a
+// list of thousands of items only costs as many views as fit on screen.
+//
+// The views in the range are children of the parent and are owned by it. The
+// views in the pool are owned by the recycler.
+class VIEWS_EXPORT ViewRecycler {
+ public:
+  class Delegate {
+   public:
+    // Creates a new view. It is bound before it is added to the parent.
+    virtual View* CreateRecyclableView() = 0;
+
+    // Makes |view| show the item at |index|.
+    virtual void BindView(View* view, int index) = 0;
+
+    // Invoked before |view| is put back in the pool. Views should drop what
+    // they hold on to from their item here.
+    virtual void UnbindView(View* view) = 0;
+
+   protected:
+    virtual ~Delegate() {}
+  };
+
+  ViewRecycler(View* parent, Delegate* delegate);
+  ~ViewRecycler();
+
+  // Makes the items in [|start|, |end|) have views. Views of items outside of
+  // the range are recycled.
+  void SetRange(int start, int end);
+
+  int start() const { return start_; }
+  int end() const { return start_ + static_cast<int>(views_.size()); }
+
+  // Returns the view for the item at |index|, or NULL if |index| is outside
+  // of the range.
+  View* GetViewForIndex(int index) const;
+
+  // Returns the index of the item |view| shows, or -1 if |view| isn't one of
+  // the views in the range.
+  int GetIndexOfView(const View* view) const;
+
+  // Invoked when |count| items are added at |start|. New items inside the
+  // range get views, and the range grows to include them. Views stay bound to
+  // the same items.
+  void ItemsAdded(int start, int count);
+
+  // Invoked when |count| items are removed at |start|. The views of the
+  // removed items are recycled.
+  void ItemsRemoved(int start, int count);
+
+  // Invoked when |count| items at |start| change. Their views are rebound.
+  void ItemsChanged(int start, int count);
+
+  // Recycles all the views in the range, which becomes empty.
+  void Clear();
+
+  // Number of views in the pool.
+  size_t pool_size() const { return pool_.size(); }
+
+ private:
+  // Returns a view bound to the item at |index| and added to the parent.
+  View* GetBoundView(int index);
+
+  // Unbinds |view|, removes it from the parent and adds it to the pool.
+  void Recycle(View* view);
+
+  View* parent_;
+  Delegate* delegate_;
+
+  // Index of the item of the first view in |views_|.
+  int start_;
+
+  // The views of the items in the range, in order.
+  std::vector<View*> views_;
+
+  // Views that aren't bound to any item.
+  std::vector<View*> pool_;
+
+  DISALLOW_COPY_AND_ASSIGN(ViewRecycler);
+};
+
+}  // namespace views
+
+#endif  // UI_VIEWS_VIEW_RECYCLER_H_
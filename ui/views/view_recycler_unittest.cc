@@ -0,0 +1,133 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/views/view_recycler.h"
+
+#include <string>
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "base/string_number_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/views/view.h"
+
+namespace views {
+
+namespace {
+
+// Binds each view to an item by setting its id to the value of the item, and
+// resets it to 0 when unbinding.
+class TestDelegate : public ViewRecycler::Delegate {
+ public:
+  TestDelegate() : created_count_(0) {}
+  virtual ~TestDelegate() {}
+
+  std::vector<int>& items() { return items_; }
+  int created_count() const { return created_count_; }
+
+  // ViewRecycler::Delegate:
+  virtual View* CreateRecyclableView() OVERRIDE {
+    created_count_++;
+    return new View;
+  }
+  virtual void BindView(View* view, int index) OVERRIDE {
+    EXPECT_EQ(0, view->id());
+    view->set_id(items_[index]);
+  }
+  virtual void UnbindView(View* view) OVERRIDE {
+    view->set_id(0);
+  }
+
+ private:
+  std::vector<int> items_;
+  int created_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestDelegate);
+};
+
+// Returns the ids of the views in the range of |recycler|.
+std::string BoundIDsString(const ViewRecycler& recycler) {
+  std::string result;
+  for (int i = recycler.start(); i < recycler.end(); ++i) {
+    if (i != recycler.start())
+      result += " ";
+    result += base::IntToString(recycler.GetViewForIndex(i)->id());
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(ViewRecycler, ReusesViews) {
+  View parent;
+  TestDelegate delegate;
+  for (int i = 0; i < 100; ++i)
+    delegate.items().push_back(i);
+  ViewRecycler recycler(&parent, &delegate);
+
+  recycler.SetRange(0, 4);
+  EXPECT_EQ("0 1 2 3", BoundIDsString(recycler));
+  EXPECT_EQ(4, parent.child_count());
+  EXPECT_EQ(4, delegate.created_count());
+
+  // Scrolling by two items rebinds two views.
+  recycler.SetRange(2, 6);
+  EXPECT_EQ("2 3 4 5", BoundIDsString(recycler));
+  EXPECT_EQ(4, parent.child_count());
+  EXPECT_EQ(4, delegate.created_count());
+  EXPECT_EQ(0u, recycler.pool_size());
+
+  // Jumping far away rebinds them all.
+  recycler.SetRange(90, 94);
+  EXPECT_EQ("90 91 92 93", BoundIDsString(recycler));
+  EXPECT_EQ(4, delegate.created_count());
+
+  View* view = recycler.GetViewForIndex(91);
+  EXPECT_EQ(91, recycler.GetIndexOfView(view));
+  EXPECT_TRUE(recycler.GetViewForIndex(94) == NULL);
+
+  recycler.SetRange(90, 92);
+  EXPECT_EQ(2u, recycler.pool_size());
+  EXPECT_EQ(2, parent.child_count());
+  EXPECT_EQ(-1, recycler.GetIndexOfView(recycler.GetViewForIndex(93)));
+}
+
+TEST(ViewRecycler, ItemsAddedAndRemoved) {
+  View parent;
+  TestDelegate delegate;
+  for (int i = 0; i < 10; ++i)
+    delegate.items().push_back(i);
+  ViewRecycler recycler(&parent, &delegate);
+  recycler.SetRange(2, 5);
+
+  // Adding before the range shifts it.
+  delegate.items().insert(delegate.items().begin(), 100);
+  recycler.ItemsAdded(0, 1);
+  EXPECT_EQ(3, recycler.start());
+  EXPECT_EQ("2 3 4", BoundIDsString(recycler));
+
+  // Adding inside the range grows it.
+  delegate.items().insert(delegate.items().begin() + 4, 101);
+  recycler.ItemsAdded(4, 1);
+  EXPECT_EQ("2 101 3 4", BoundIDsString(recycler));
+
+  // Removing across the start of the range recycles the removed views.
+  delegate.items().erase(delegate.items().begin() + 2,
+                         delegate.items().begin() + 5);
+  recycler.ItemsRemoved(2, 3);
+  EXPECT_EQ(2, recycler.start());
+  EXPECT_EQ("3 4", BoundIDsString(recycler));
+  EXPECT_EQ(2u, recycler.pool_size());
+  EXPECT_EQ(2, parent.child_count());
+
+  delegate.items()[3] = 200;
+  recycler.ItemsChanged(3, 1);
+  EXPECT_EQ("3 200", BoundIDsString(recycler));
+
+  recycler.Clear();
+  EXPECT_EQ(0, parent.child_count());
+  EXPECT_EQ(4u, recycler.pool_size());
+}
+
+}  // namespace views
@@ -4,9 +4,14 @@
 
 #include <map>
 
+#include "base/base_paths.h"
+#include "base/file_path.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/path_service.h"
 #include "base/rand_util.h"
 #include "base/string_util.h"
+#include "base/test/trace_budget.h"
+#include "base/test/trace_event_analyzer.h"
 #include "base/utf_string_conversions.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "ui/base/accelerators/accelerator.h"
@@ -31,6 +36,7 @@
 #include "ui/views/events/event.h"
 #include "ui/views/focus/accelerator_handler.h"
 #include "ui/views/focus/view_storage.h"
+#include "ui/views/layout/layout_manager.h"
 #include "ui/views/test/views_test_base.h"
 #include "ui/views/view.h"
 #include "ui/views/views_delegate.h"
@@ -329,6 +335,65 @@ TEST_F(ViewTest, OnBoundsChanged) {
   EXPECT_EQ(v.bounds(), new_rect);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Preferred size
+////////////////////////////////////////////////////////////////////////////////
+
+// A layout manager that counts how many times it is asked for the preferred
+// size of its host.
+class CountingLayoutManager : public LayoutManager {
+ public:
+  CountingLayoutManager() : preferred_size_count_(0) {}
+
+  int preferred_size_count() const { return preferred_size_count_; }
+
+  virtual void Layout(View* host) OVERRIDE {}
+
+  virtual gfx::Size GetPreferredSize(View* host) OVERRIDE {
+    preferred_size_count_++;
+    return gfx::Size(host->child_count(), host->child_count());
+  }
+
+ private:
+  int preferred_size_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingLayoutManager);
+};
+
+// Makes sure the preferred size answered by the layout manager is kept until
+// something that may change it happens.
+TEST_F(ViewTest, PreferredSizeIsCached) {
+  View parent;
+  CountingLayoutManager* parent_layout = new CountingLayoutManager;
+  parent.SetLayoutManager(parent_layout);
+  View* child = new View;
+  parent.AddChildView(child);
+  View* grandchild = new View;
+  child->AddChildView(grandchild);
+
+  EXPECT_EQ(gfx::Size(1, 1), parent.GetPreferredSize());
+  EXPECT_EQ(gfx::Size(1, 1), parent.GetPreferredSize());
+  EXPECT_EQ(1, parent_layout->preferred_size_count());
+
+  // A change deeper in the tree invalidates the ancestors.
+  grandchild->InvalidateLayout();
+  parent.GetPreferredSize();
+  EXPECT_EQ(2, parent_layout->preferred_size_count());
+
+  parent.AddChildView(new View);
+  EXPECT_EQ(gfx::Size(2, 2), parent.GetPreferredSize());
+  EXPECT_EQ(3, parent_layout->preferred_size_count());
+
+  child->SetVisible(false);
+  parent.GetPreferredSize();
+  EXPECT_EQ(4, parent_layout->preferred_size_count());
+
+  parent.RemoveChildView(child);
+  delete child;
+  EXPECT_EQ(gfx::Size(1, 1), parent.GetPreferredSize());
+  EXPECT_EQ(5, parent_layout->preferred_size_count());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // MouseEvent
 ////////////////////////////////////////////////////////////////////////////////
@@ -718,6 +783,116 @@ TEST_F(ViewTest, DISABLED_Painting) {
 }
 */
 
+class DisplayListView : public View {
+ public:
+  DisplayListView() : paint_count_(0) {}
+
+  int paint_count() const { return paint_count_; }
+
+  virtual void OnPaint(gfx::Canvas* canvas) OVERRIDE {
+    paint_count_++;
+    canvas->FillRect(gfx::Rect(0, 0, 5, 5), SK_ColorRED);
+    View::OnPaint(canvas);
+  }
+
+ private:
+  int paint_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(DisplayListView);
+};
+
+// Makes sure a view that records a display list only calls OnPaint() again
+// once it is invalidated, and that playing the display list back paints the
+// same pixels.
+TEST_F(ViewTest, RecordsDisplayList) {
+  DisplayListView view;
+  view.SetBoundsRect(gfx::Rect(0, 0, 10, 10));
+
+  gfx::Canvas canvas(gfx::Size(10, 10), true);
+  view.Paint(&canvas);
+  view.Paint(&canvas);
+  EXPECT_EQ(2, view.paint_count());
+
+  view.SetRecordsDisplayList(true);
+  view.Paint(&canvas);
+  EXPECT_EQ(3, view.paint_count());
+
+  gfx::Canvas replayed(gfx::Size(10, 10), true);
+  replayed.FillRect(gfx::Rect(0, 0, 10, 10), SK_ColorBLACK);
+  view.Paint(&replayed);
+  EXPECT_EQ(3, view.paint_count());
+  SkBitmap bitmap = replayed.ExtractBitmap();
+  SkAutoLockPixels lock(bitmap);
+  EXPECT_EQ(SK_ColorRED, bitmap.getColor(2, 2));
+  EXPECT_EQ(SK_ColorBLACK, bitmap.getColor(7, 7));
+
+  view.SchedulePaint();
+  view.Paint(&canvas);
+  view.Paint(&canvas);
+  EXPECT_EQ(4, view.paint_count());
+
+  view.set_background(Background::CreateSolidBackground(SK_ColorBLUE));
+  view.Paint(&canvas);
+  EXPECT_EQ(5, view.paint_count());
+
+  view.SetBoundsRect(gfx::Rect(0, 0, 8, 8));
+  view.Paint(&canvas);
+  EXPECT_EQ(6, view.paint_count());
+
+  view.SetRecordsDisplayList(false);
+  view.Paint(&canvas);
+  EXPECT_EQ(7, view.paint_count());
+}
+
+// Makes sure the children outside of the region being repainted aren't
+// painted.
+TEST_F(ViewTest, PaintSkipsChildrenOutsideOfClip) {
+  View parent;
+  parent.SetBoundsRect(gfx::Rect(0, 0, 100, 100));
+  DisplayListView* inside = new DisplayListView;
+  inside->SetBoundsRect(gfx::Rect(0, 0, 10, 10));
+  parent.AddChildView(inside);
+  DisplayListView* outside = new DisplayListView;
+  outside->SetBoundsRect(gfx::Rect(50, 50, 10, 10));
+  parent.AddChildView(outside);
+
+  gfx::Canvas canvas(gfx::Size(100, 100), true);
+  canvas.ClipRect(gfx::Rect(0, 0, 20, 20));
+  parent.Paint(&canvas);
+  EXPECT_EQ(1, inside->paint_count());
+  EXPECT_EQ(0, outside->paint_count());
+}
+
+// Makes sure repainting two children of a long row stays within the budgets
+// of ui/views/test/data/paint_budgets.json.
+TEST_F(ViewTest, PartialRepaintTraceBudgets) {
+  View parent;
+  parent.SetBoundsRect(gfx::Rect(0, 0, 200, 10));
+  for (int i = 0; i < 20; ++i) {
+    View* child = new View;
+    child->SetBoundsRect(gfx::Rect(i * 10, 0, 10, 10));
+    parent.AddChildView(child);
+  }
+
+  FilePath path;
+  ASSERT_TRUE(PathService::Get(base::DIR_SOURCE_ROOT, &path));
+  path = path.AppendASCII("ui").AppendASCII("views").AppendASCII("test")
+      .AppendASCII("data").AppendASCII("paint_budgets.json");
+  std::vector<trace_analyzer::TraceBudget> budgets;
+  std::string error;
+  ASSERT_TRUE(trace_analyzer::LoadTraceBudgets(path, "partial_repaint",
+                                               &budgets, &error)) << error;
+
+  gfx::Canvas canvas(gfx::Size(200, 10), true);
+  canvas.ClipRect(gfx::Rect(45, 0, 10, 10));
+  trace_analyzer::TraceRecorder recorder;
+  recorder.Start("views");
+  parent.Paint(&canvas);
+  scoped_ptr<trace_analyzer::TraceAnalyzer> analyzer(recorder.Stop());
+  ASSERT_TRUE(analyzer.get());
+  EXPECT_TRUE(trace_analyzer::CheckTraceBudgets(analyzer.get(), budgets));
+}
+
 #if defined(OS_WIN)
 TEST_F(ViewTest, RemoveNotification) {
 #else
@@ -45,6 +45,8 @@
       ],
       'sources': [
         # All .cc, .h under views, except unittests
+        'accessibility/accessibility_event_queue.cc',
+        'accessibility/accessibility_event_queue.h',
         'accessibility/native_view_accessibility_win.cc',
         'accessibility/native_view_accessibility_win.h',
         'accessible_pane_view.cc',
@@ -233,8 +235,8 @@
         'controls/tree/tree_view_win.h',
 #        'controls/webview/webview.cc',
 #        'controls/webview/webview.h',
-        #'debug_utils.cc',
-        #'debug_utils.h',
+        'debug_utils.cc',
+        'debug_utils.h',
         'drag_controller.h',
         'drag_utils.cc',
         'drag_utils.h',
@@ -306,6 +308,10 @@
         'view_model.h',
         'view_model_utils.cc',
         'view_model_utils.h',
+        'view_index.cc',
+        'view_index.h',
+        'view_recycler.cc',
+        'view_recycler.h',
         'view_text_utils.cc',
         'view_text_utils.h',
         'view_win.cc',
@@ -508,6 +514,7 @@
         '..',
       ],
       'sources': [
+        'accessibility/accessibility_event_queue_unittest.cc',
         'accessible_pane_view_unittest.cc',
         'animation/bounds_animator_unittest.cc',
         'bubble/bubble_delegate_unittest.cc',
@@ -535,6 +542,8 @@
         'layout/grid_layout_unittest.cc',
         'view_model_unittest.cc',
         'view_model_utils_unittest.cc',
+        'view_index_unittest.cc',
+        'view_recycler_unittest.cc',
         'view_unittest.cc',
         'widget/native_widget_aura_unittest.cc',
         'widget/native_widget_test_utils.h',
@@ -589,6 +598,24 @@
         }],
       ],
     },  # target_name: views_unittests
+    {
+      'target_name': 'views_perftests',
+      'type': 'executable',
+      'dependencies': [
+        '../../base/base.gyp:base',
+        '../../base/base.gyp:test_support_perf',
+        '../../skia/skia.gyp:skia',
+        '../../testing/gtest.gyp:gtest',
+        '../ui.gyp:ui',
+        'views',
+      ],
+      'include_dirs': [
+        '..',
+      ],
+      'sources': [
+        'view_perftest.cc',
+      ],
+    },  # target_name: views_perftests
     {
       'target_name': 'views_examples_lib',
       'type': 'static_library',
@@ -233,8 +233,8 @@
         'controls/tree/tree_view_win.h',
 #        'controls/webview/webview.cc',
 #        'controls/webview/webview.h',
-        #'debug_utils.cc',
-        #'debug_utils.h',
+        'debug_utils.cc',
+        'debug_utils.h',
         'drag_controller.h',
         'drag_utils.cc',
         'drag_utils.h',
@@ -60,6 +60,7 @@ const char RootView::kViewClassName[] = "views/RootView";
 
 RootView::RootView(Widget* widget)
     : widget_(widget),
+      ALLOW_THIS_IN_INITIALIZER_LIST(view_index_(this)),
       mouse_pressed_handler_(NULL),
       mouse_move_handler_(NULL),
       last_click_handler_(NULL),
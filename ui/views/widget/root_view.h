@@ -12,6 +12,7 @@
 #include "ui/views/focus/focus_manager.h"
 #include "ui/views/focus/focus_search.h"
 #include "ui/views/view.h"
+#include "ui/views/view_index.h"
 
 namespace ui {
 enum TouchStatus;
@@ -149,6 +150,10 @@ class VIEWS_EXPORT RootView : public View, public FocusTraversable {
   // The host Widget
   Widget* widget_;
 
+  // Finds the views of this tree by id and group. Mutable as it is built by
+  // lookups on const views.
+  mutable ViewIndex view_index_;
+
   // Input ---------------------------------------------------------------------
 
   // The view currently handing down - drag - up
@@ -14,6 +14,15 @@
 
 namespace views {
 
+namespace {
+
+// How long the mouse has to rest before the tooltip text is asked of the view
+// under it. This is shorter than the delay of the tooltip client, so that the
+// text is known by the time the tooltip shows.
+const int kHoverDelayMs = 100;
+
+}  // namespace
+
 // static
 int TooltipManager::GetTooltipHeight() {
   // Not used for linux and chromeos.
@@ -38,7 +47,8 @@ int TooltipManager::GetMaxWidth(int x, int y) {
 // TooltipManagerAura public:
 
 TooltipManagerAura::TooltipManagerAura(NativeWidgetAura* native_widget_aura)
-    : native_widget_aura_(native_widget_aura) {
+    : native_widget_aura_(native_widget_aura),
+      hover_view_(NULL) {
   aura::client::SetTooltipText(native_widget_aura_->GetNativeView(),
                                &tooltip_text_);
 }
@@ -57,14 +67,22 @@ void TooltipManagerAura::UpdateTooltip() {
     gfx::Point view_point = root_window->last_mouse_location();
     aura::Window::ConvertPointToWindow(root_window, window, &view_point);
     View* view = GetViewUnderPoint(view_point);
-    if (view) {
-      View::ConvertPointFromWidget(view, &view_point);
-      if (!view->GetTooltipText(view_point, &tooltip_text_))
+    if (view != hover_view_) {
+      // The text of the previous view no longer applies; the text of the new
+      // view is fetched once the mouse rests.
+      hover_view_ = view;
+      if (!tooltip_text_.empty()) {
         tooltip_text_.clear();
+        aura::client::GetTooltipClient(root_window)->UpdateTooltip(window);
+      }
+    }
+    if (view) {
+      hover_timer_.Start(FROM_HERE,
+                         base::TimeDelta::FromMilliseconds(kHoverDelayMs),
+                         this, &TooltipManagerAura::FetchTooltipText);
     } else {
-      tooltip_text_.clear();
+      hover_timer_.Stop();
     }
-    aura::client::GetTooltipClient(root_window)->UpdateTooltip(window);
   }
 }
 
@@ -74,17 +92,10 @@ void TooltipManagerAura::TooltipTextChanged(View* view)  {
   if (aura::client::GetTooltipClient(root_window)) {
     gfx::Point view_point = root_window->last_mouse_location();
     aura::Window::ConvertPointToWindow(root_window, window, &view_point);
-    View* target = GetViewUnderPoint(view_point);
-    if (target != view)
+    if (GetViewUnderPoint(view_point) != view)
       return;
-    if (target) {
-      View::ConvertPointFromWidget(view, &view_point);
-      if (!view->GetTooltipText(view_point, &tooltip_text_))
-        tooltip_text_.clear();
-    } else {
-      tooltip_text_.clear();
-    }
-    aura::client::GetTooltipClient(root_window)->UpdateTooltip(window);
+    hover_timer_.Stop();
+    FetchTooltipText();
   }
 }
 
@@ -101,4 +112,28 @@ View* TooltipManagerAura::GetViewUnderPoint(const gfx::Point& point) {
   return root_view->GetEventHandlerForPoint(point);
 }
 
+void TooltipManagerAura::FetchTooltipText() {
+  aura::Window* window = native_widget_aura_->GetNativeView();
+  aura::RootWindow* root_window = window->GetRootWindow();
+  if (!aura::client::GetTooltipClient(root_window))
+    return;
+
+  // The view is looked up again, since the one the timer was started for may
+  // have gone away.
+  gfx::Point view_point = root_window->last_mouse_location();
+  aura::Window::ConvertPointToWindow(root_window, window, &view_point);
+  View* view = GetViewUnderPoint(view_point);
+  hover_view_ = view;
+  string16 tooltip_text;
+  if (view) {
+    View::ConvertPointFromWidget(view, &view_point);
+    if (!view->GetTooltipText(view_point, &tooltip_text))
+      tooltip_text.clear();
+  }
+  if (tooltip_text == tooltip_text_)
+    return;
+  tooltip_text_ = tooltip_text;
+  aura::client::GetTooltipClient(root_window)->UpdateTooltip(window);
+}
+
 }  // namespace views.
@@ -8,6 +8,7 @@
 
 #include "base/compiler_specific.h"
 #include "base/string16.h"
+#include "base/timer.h"
 #include "ui/gfx/point.h"
 #include "ui/views/widget/tooltip_manager.h"
 
@@ -17,6 +18,10 @@ class NativeWidgetAura;
 class View;
 
 // TooltipManager implementation for Aura.
+//
+// The tooltip text isn't asked of the views as the mouse moves. It is asked
+// once the mouse has rested for a short delay, or when the view under the
+// mouse reports that its text changed.
 class TooltipManagerAura : public TooltipManager {
  public:
   explicit TooltipManagerAura(NativeWidgetAura* native_widget_aura);
@@ -31,9 +36,20 @@ class TooltipManagerAura : public TooltipManager {
  private:
   View* GetViewUnderPoint(const gfx::Point& point);
 
+  // Asks the view under the mouse for its tooltip text and tells the tooltip
+  // client if the text changed.
+  void FetchTooltipText();
+
   NativeWidgetAura* native_widget_aura_;
   string16 tooltip_text_;
 
+  // The view that was under the mouse when the tooltip was last updated. Only
+  // compared against, never dereferenced: it may have been deleted since.
+  const View* hover_view_;
+
+  // Runs FetchTooltipText() once the mouse has rested.
+  base::OneShotTimer<TooltipManagerAura> hover_timer_;
+
   DISALLOW_COPY_AND_ASSIGN(TooltipManagerAura);
 };
 
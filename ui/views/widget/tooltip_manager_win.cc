@@ -32,6 +32,10 @@ static int tooltip_height_ = 0;
 // Timeout is mentioned in milliseconds.
 static const int kDefaultTimeout = 4000;
 
+// How long the mouse has to rest over the view of a showing tooltip before the
+// view is asked whether its text changed.
+static const int kTextCheckDelayMs = 100;
+
 // static
 int TooltipManager::GetTooltipHeight() {
   DCHECK_GT(tooltip_height_, 0);
@@ -276,21 +280,35 @@ void TooltipManagerWin::UpdateTooltip(const gfx::Point& mouse_pos) {
     // It triggers Windows to ask for the tooltip again.
     SendMessage(tooltip_hwnd_, TTM_POP, 0, 0);
     last_tooltip_view_ = view;
-  } else if (last_tooltip_view_ != NULL) {
-    // Tooltip is showing, and mouse is over the same view. See if the tooltip
-    // text has changed.
-    gfx::Point view_point = mouse_pos;
-    View::ConvertPointToView(root_view, last_tooltip_view_, &view_point);
-    string16 new_tooltip_text;
-    bool has_tooltip_text =
-        last_tooltip_view_->GetTooltipText(view_point, &new_tooltip_text);
-    if (!has_tooltip_text || (new_tooltip_text != tooltip_text_)) {
-      // The text has changed, hide the popup.
-      SendMessage(tooltip_hwnd_, TTM_POP, 0, 0);
-      if (has_tooltip_text && !new_tooltip_text.empty() && tooltip_showing_) {
-        // New text is valid, show the popup.
-        SendMessage(tooltip_hwnd_, TTM_POPUP, 0, 0);
-      }
+    text_check_timer_.Stop();
+  } else if (last_tooltip_view_ != NULL && tooltip_showing_) {
+    // Tooltip is showing, and mouse is over the same view. Once the mouse
+    // rests, see if the tooltip text has changed. If the tooltip isn't
+    // showing, the text is asked for when it shows.
+    text_check_timer_.Start(
+        FROM_HERE, base::TimeDelta::FromMilliseconds(kTextCheckDelayMs),
+        this, &TooltipManagerWin::CheckTooltipTextChanged);
+  }
+}
+
+void TooltipManagerWin::CheckTooltipTextChanged() {
+  View* root_view = widget_->GetRootView();
+  if (last_view_out_of_sync_ || !tooltip_showing_ ||
+      root_view->GetEventHandlerForPoint(last_mouse_pos_) !=
+          last_tooltip_view_) {
+    return;
+  }
+  gfx::Point view_point = last_mouse_pos_;
+  View::ConvertPointToView(root_view, last_tooltip_view_, &view_point);
+  string16 new_tooltip_text;
+  bool has_tooltip_text =
+      last_tooltip_view_->GetTooltipText(view_point, &new_tooltip_text);
+  if (!has_tooltip_text || (new_tooltip_text != tooltip_text_)) {
+    // The text has changed, hide the popup.
+    SendMessage(tooltip_hwnd_, TTM_POP, 0, 0);
+    if (has_tooltip_text && !new_tooltip_text.empty()) {
+      // New text is valid, show the popup.
+      SendMessage(tooltip_hwnd_, TTM_POPUP, 0, 0);
     }
   }
 }
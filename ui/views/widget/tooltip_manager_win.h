@@ -14,6 +14,7 @@
 #include "base/compiler_specific.h"
 #include "base/memory/weak_ptr.h"
 #include "base/string16.h"
+#include "base/timer.h"
 #include "ui/gfx/native_widget_types.h"
 #include "ui/gfx/point.h"
 #include "ui/views/widget/tooltip_manager.h"
@@ -115,6 +116,10 @@ class TooltipManagerWin : public TooltipManager {
   // Invoked when the timer elapses and tooltip has to be destroyed.
   void DestroyKeyboardTooltipWindow(HWND window_to_destroy);
 
+  // Asks the view under the mouse for its tooltip text again and pops the
+  // showing tooltip up again if the text changed.
+  void CheckTooltipTextChanged();
+
   // Hosting Widget.
   Widget* widget_;
 
@@ -146,6 +151,10 @@ class TooltipManagerWin : public TooltipManager {
   // function.
   base::WeakPtrFactory<TooltipManagerWin> keyboard_tooltip_factory_;
 
+  // Runs CheckTooltipTextChanged() once the mouse has rested over the view of
+  // the showing tooltip, rather than asking the view on each move.
+  base::OneShotTimer<TooltipManagerWin> text_check_timer_;
+
   DISALLOW_COPY_AND_ASSIGN(TooltipManagerWin);
 };
 
@@ -4,6 +4,7 @@
 
 #include "ui/views/widget/widget.h"
 
+#include "base/bind.h"
 #include "base/logging.h"
 #include "base/message_loop.h"
 #include "base/utf_string_conversions.h"
@@ -15,6 +16,8 @@
 #include "ui/compositor/layer.h"
 #endif
 #include "ui/gfx/screen.h"
+#include "ui/views/accessibility/accessibility_event_queue.h"
+#include "ui/views/debug_utils.h"
 #include "ui/views/focus/focus_manager.h"
 #include "ui/views/focus/focus_manager_factory.h"
 #include "ui/views/focus/view_storage.h"
@@ -188,6 +191,7 @@ Widget::Widget()
       saved_show_state_(ui::SHOW_STATE_DEFAULT),
       focus_on_creation_(true),
       is_top_level_(false),
+      create_focus_manager_lazily_(false),
       native_widget_initialized_(false),
       native_widget_destroyed_(false),
       is_mouse_button_pressed_(false),
@@ -310,6 +314,7 @@ void Widget::Init(const InitParams& params) {
       (!params.child &&
        params.type != InitParams::TYPE_CONTROL &&
        params.type != InitParams::TYPE_TOOLTIP);
+  create_focus_manager_lazily_ = is_top_level_ && !params.can_activate;
   widget_delegate_ = params.delegate ?
       params.delegate : new DefaultWidgetDelegate(this, params);
   ownership_ = params.ownership;
@@ -373,18 +378,21 @@ void Widget::ViewHierarchyChanged(bool is_add, View* parent, View* child) {
   if (!is_add) {
     if (child == dragged_view_)
       dragged_view_ = NULL;
-    FocusManager* focus_manager = GetFocusManager();
+    // Nothing can have been focused before the focus manager exists.
+    FocusManager* focus_manager = GetFocusManagerIfCreated();
     if (focus_manager)
       focus_manager->ViewRemoved(child);
     ViewStorage::GetInstance()->ViewRemoved(child);
     native_widget_->ViewRemoved(child);
+    if (accessibility_event_queue_.get())
+      accessibility_event_queue_->ViewRemoved(child);
   }
 }
 
 void Widget::NotifyNativeViewHierarchyChanged(bool attached,
                                               gfx::NativeView native_view) {
   if (!attached) {
-    FocusManager* focus_manager = GetFocusManager();
+    FocusManager* focus_manager = GetFocusManagerIfCreated();
     // We are being removed from a window hierarchy.  Treat this as
     // the root_view_ being removed.
     if (focus_manager)
@@ -652,7 +660,14 @@ ThemeProvider* Widget::GetThemeProvider() const {
 
 FocusManager* Widget::GetFocusManager() {
   Widget* toplevel_widget = GetTopLevelWidget();
-  return toplevel_widget ? toplevel_widget->focus_manager_.get() : NULL;
+  if (!toplevel_widget)
+    return NULL;
+  if (toplevel_widget->create_focus_manager_lazily_ &&
+      !toplevel_widget->focus_manager_.get()) {
+    toplevel_widget->focus_manager_.reset(
+        FocusManagerFactory::Create(toplevel_widget));
+  }
+  return toplevel_widget->focus_manager_.get();
 }
 
 const FocusManager* Widget::GetFocusManager() const {
@@ -843,12 +858,12 @@ void Widget::NotifyAccessibilityEvent(
     View* view,
     ui::AccessibilityTypes::Event event_type,
     bool send_native_event) {
-  // Send the notification to the delegate.
-  if (ViewsDelegate::views_delegate)
-    ViewsDelegate::views_delegate->NotifyAccessibilityEvent(view, event_type);
-
-  if (send_native_event)
-    native_widget_->SendNativeAccessibilityEvent(view, event_type);
+  if (!accessibility_event_queue_.get()) {
+    accessibility_event_queue_.reset(new internal::AccessibilityEventQueue(
+        base::Bind(&Widget::DeliverAccessibilityEvent,
+                   base::Unretained(this))));
+  }
+  accessibility_event_queue_->AddEvent(view, event_type, send_native_event);
 }
 
 const NativeWidget* Widget::native_widget() const {
@@ -961,7 +976,7 @@ void Widget::OnNativeWidgetVisibilityChanged(bool visible) {
 }
 
 void Widget::OnNativeWidgetCreated() {
-  if (is_top_level())
+  if (is_top_level() && !create_focus_manager_lazily_)
     focus_manager_.reset(FocusManagerFactory::Create(this));
 
   native_widget_->SetAccessibleRole(
@@ -973,10 +988,19 @@ void Widget::OnNativeWidgetCreated() {
 }
 
 void Widget::OnNativeWidgetDestroying() {
+  // Deliver the events still queued, such as the end of a menu, while the
+  // views and the native widget are still around.
+  if (accessibility_event_queue_.get()) {
+    accessibility_event_queue_->Flush();
+    accessibility_event_queue_->Clear();
+  }
   // Tell the focus manager (if any) that root_view is being removed
   // in case that the focused view is under this root view.
-  if (GetFocusManager())
-    GetFocusManager()->ViewRemoved(root_view_.get());
+  // Views being torn down must not create the focus manager.
+  create_focus_manager_lazily_ = false;
+  FocusManager* focus_manager = GetFocusManagerIfCreated();
+  if (focus_manager)
+    focus_manager->ViewRemoved(root_view_.get());
   FOR_EACH_OBSERVER(Observer, observers_, OnWidgetClosing(this));
   if (non_client_view_)
     non_client_view_->WindowClosing();
@@ -1064,6 +1088,7 @@ bool Widget::OnNativeWidgetPaintAccelerated(const gfx::Rect& dirty_region) {
 
 void Widget::OnNativeWidgetPaint(gfx::Canvas* canvas) {
   GetRootView()->Paint(canvas);
+  PaintRepaintOverlay(canvas);
 }
 
 int Widget::GetNonClientComponent(const gfx::Point& point) {
@@ -1240,6 +1265,22 @@ bool Widget::ShouldReleaseCaptureOnMouseReleased() const {
   return true;
 }
 
+FocusManager* Widget::GetFocusManagerIfCreated() {
+  Widget* toplevel_widget = GetTopLevelWidget();
+  return toplevel_widget ? toplevel_widget->focus_manager_.get() : NULL;
+}
+
+void Widget::DeliverAccessibilityEvent(View* view,
+                                       ui::AccessibilityTypes::Event event_type,
+                                       bool send_native_event) {
+  // Send the notification to the delegate.
+  if (ViewsDelegate::views_delegate)
+    ViewsDelegate::views_delegate->NotifyAccessibilityEvent(view, event_type);
+
+  if (send_native_event)
+    native_widget_->SendNativeAccessibilityEvent(view, event_type);
+}
+
 void Widget::SetInactiveRenderingDisabled(bool value) {
   disable_inactive_rendering_ = value;
   // We need to always notify the NonClientView so that it can trigger a paint.
@@ -62,6 +62,7 @@ class ScopedEvent;
 class View;
 class WidgetDelegate;
 namespace internal {
+class AccessibilityEventQueue;
 class NativeWidgetPrivate;
 class RootView;
 }
@@ -432,6 +433,9 @@ class VIEWS_EXPORT Widget : public internal::NativeWidgetDelegate,
 
   // Returns the FocusManager for this widget.
   // Note that all widgets in a widget hierarchy share the same focus manager.
+  // Top-level widgets that can't be activated, such as popups and menus,
+  // create their focus manager the first time the non-const version is
+  // called; the const version returns NULL until then.
   FocusManager* GetFocusManager();
   const FocusManager* GetFocusManager() const;
 
@@ -561,6 +565,10 @@ class VIEWS_EXPORT Widget : public internal::NativeWidgetDelegate,
   // cases where the view is a native control that's already sending a
   // native accessibility event and the duplicate event would cause
   // problems.
+  //
+  // The events are delivered in a batch once the current task is done.
+  // Repeated state changes of a view are delivered once, and only if the
+  // state differs from when it was last delivered.
   void NotifyAccessibilityEvent(
       View* view,
       ui::AccessibilityTypes::Event event_type,
@@ -692,6 +700,15 @@ class VIEWS_EXPORT Widget : public internal::NativeWidgetDelegate,
   // both the NonClientView and WidgetDelegate are notified.
   void SetInactiveRenderingDisabled(bool value);
 
+  // Returns the focus manager of the top-level widget if it has been created,
+  // without creating it.
+  FocusManager* GetFocusManagerIfCreated();
+
+  // Sends an accessibility event queued by NotifyAccessibilityEvent().
+  void DeliverAccessibilityEvent(View* view,
+                                 ui::AccessibilityTypes::Event event_type,
+                                 bool send_native_event);
+
   // Persists the window's restored position and "show" state using the
   // window delegate.
   void SaveWindowPlacement();
@@ -779,9 +796,19 @@ class VIEWS_EXPORT Widget : public internal::NativeWidgetDelegate,
 
   scoped_ptr<InputMethod> input_method_;
 
+  // Holds the accessibility events until they are delivered. Created with the
+  // first event.
+  scoped_ptr<internal::AccessibilityEventQueue> accessibility_event_queue_;
+
   // See |is_top_level()| accessor.
   bool is_top_level_;
 
+  // True if the focus manager is only created when first asked for, which is
+  // the case for top-level widgets that can't be activated. Most of them never
+  // take focus, and creating views and the widget doesn't need the focus
+  // manager. Cleared when the widget starts being destroyed.
+  bool create_focus_manager_lazily_;
+
   // Tracks whether native widget has been initialized.
   bool native_widget_initialized_;
 
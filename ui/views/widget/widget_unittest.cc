@@ -323,6 +323,32 @@ TEST_F(WidgetTest, Visibility_ChildPopup) {
 }
 #endif
 
+// Verifies that popups, which can't be activated, only create their focus
+// manager when it is asked for, and that their views don't ask for it.
+TEST_F(WidgetTest, PopupCreatesFocusManagerLazily) {
+  Widget* popup = new Widget;
+  Widget::InitParams params(Widget::InitParams::TYPE_POPUP);
+  params.native_widget = CreatePlatformNativeWidget(popup);
+  popup->Init(params);
+  View* contents = new View;
+  popup->SetContentsView(contents);
+  contents->AddChildView(new View);
+  popup->Show();
+
+  const Widget* const_popup = popup;
+  EXPECT_FALSE(const_popup->GetFocusManager());
+  EXPECT_TRUE(popup->GetFocusManager());
+  EXPECT_TRUE(const_popup->GetFocusManager());
+
+  // Windows still create theirs with the native widget.
+  Widget* toplevel = CreateTopLevelPlatformWidget();
+  const Widget* const_toplevel = toplevel;
+  EXPECT_TRUE(const_toplevel->GetFocusManager());
+
+  popup->CloseNow();
+  toplevel->CloseNow();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Widget ownership tests.
 //
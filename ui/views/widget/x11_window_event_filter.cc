@@ -71,6 +71,8 @@ X11WindowEventFilter::X11WindowEventFilter(
       x_root_window_(DefaultRootWindow(xdisplay_)),
       atom_cache_(xdisplay_, kAtomsToCache),
       is_active_(false) {
+  // Only mouse presses on the non-client area are handled.
+  set_handled_events(MOUSE_EVENTS);
   static_cast<aura::DispatcherLinux*>(
       aura::Env::GetInstance()->GetDispatcher())->
       AddDispatcherForRootWindow(this);